@@ -169,6 +169,11 @@ public:
     typedef typename Decoder::factory decoder_factory;
     typedef typename Decoder::pointer decoder_ptr;
 
+    /// Constructor
+    operations_benchmark()
+        : m_timing_interval(0)
+    { }
+
     /// Starts a measurement and saves the counter
     void start()
     {
@@ -186,10 +191,12 @@ public:
         if(type == "encoder")
         {
             m_counter = m_encoder->get_operations_counter();
+            m_profile = m_encoder->get_operations_profile();
         }
         else if(type == "decoder")
         {
             m_counter = m_decoder->get_operations_counter();
+            m_profile = m_decoder->get_operations_profile();
         }
         else
         {
@@ -216,6 +223,54 @@ public:
 
         results.set_value("invert(value)",
                           m_counter.m_invert);
+
+        store_profile(results, "dest[i] = dest[i] + src[i]",
+                      m_profile.m_add);
+
+        store_profile(results, "dest[i] = dest[i] - src[i]",
+                      m_profile.m_subtract);
+
+        store_profile(results, "dest[i] = dest[i] * constant",
+                      m_profile.m_multiply);
+
+        store_profile(results, "dest[i] = dest[i] + (constant * src[i])",
+                      m_profile.m_multiply_add);
+
+        store_profile(results, "dest[i] = dest[i] - (constant * src[i])",
+                      m_profile.m_multiply_subtract);
+    }
+
+    /// Stores the bytes processed by an operation on the symbol data and
+    /// the coefficient vectors and, if the operations are timed, the
+    /// estimated cycles and cycles per byte
+    /// @param results The table of the results
+    /// @param operation The name of the operation
+    /// @param profile The profile of the operation
+    void store_profile(gauge::table& results, const std::string &operation,
+                       const kodo::operation_profile &profile)
+    {
+        store_cost(results, operation + " symbol", profile.m_symbol);
+        store_cost(results, operation + " coefficient",
+                   profile.m_coefficient);
+    }
+
+    /// Stores the cost of an operation on one type of buffer
+    /// @param results The table of the results
+    /// @param name The name prefix of the columns
+    /// @param cost The cost of the operation
+    void store_cost(gauge::table& results, const std::string &name,
+                    const kodo::operation_cost &cost)
+    {
+        results.set_value(name + " bytes", cost.m_bytes);
+
+        if(m_timing_interval == 0)
+            return;
+
+        double cycles = cost.estimated_ticks();
+        results.set_value(name + " cycles", cycles);
+
+        double cycles_per_byte = cost.m_bytes > 0 ? cycles / cost.m_bytes : 0;
+        results.set_value(name + " cycles per byte", cycles_per_byte);
     }
 
 
@@ -242,6 +297,9 @@ public:
         m_encoder = m_encoder_factory->build();
         m_decoder = m_decoder_factory->build();
 
+        m_encoder->set_timing_sample_interval(m_timing_interval);
+        m_decoder->set_timing_sample_interval(m_timing_interval);
+
         m_payload_buffer.resize(m_encoder->payload_size(), 0);
         m_encoded_data.resize(m_encoder->block_size(), 'x');
 
@@ -283,6 +341,8 @@ public:
         auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
         auto types = options["type"].as<std::vector<std::string> >();
 
+        m_timing_interval = options["timing_interval"].as<uint32_t>();
+
         assert(symbols.size() > 0);
         assert(symbol_size.size() > 0);
         assert(types.size() > 0);
@@ -331,6 +391,12 @@ protected:
     /// The counter containing the measurement results
     kodo::operations_counter m_counter;
 
+    /// The bytes processed and timings of the measurement
+    kodo::operations_profile m_profile;
+
+    /// Every m_timing_interval'th operation is timed, zero for none
+    uint32_t m_timing_interval;
+
 };
 
 /// Using this macro we may specify options. For specifying options
@@ -374,6 +440,12 @@ BENCHMARK_OPTION(count_operations_options)
     options.add_options()
         ("type", default_types, "Set type [encoder|decoder]");
 
+    options.add_options()
+        ("timing_interval",
+         gauge::po::value<uint32_t>()->default_value(0),
+         "Time every n'th operation with the cycle counter, 0 disables "
+         "the timing");
+
     gauge::runner::instance().register_options(options);
 }
 
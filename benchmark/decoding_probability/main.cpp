@@ -4,6 +4,7 @@
 // http://www.steinwurf.com/licensing
 
 #include <ctime>
+#include <functional>
 
 #include <boost/make_shared.hpp>
 #include <boost/random/mersenne_twister.hpp>
@@ -14,10 +15,13 @@
 #include <gauge/python_printer.hpp>
 #include <gauge/csv_printer.hpp>
 
+#include <fifi/fifi_utils.hpp>
+
 #include <kodo/rlnc/full_vector_codes.hpp>
 #include <kodo/rlnc/seed_codes.hpp>
 #include <kodo/rs/reed_solomon_codes.hpp>
 #include <kodo/has_deep_symbol_storage.hpp>
+#include <kodo/monte_carlo_engine.hpp>
 
 #include "codes.hpp"
 
@@ -30,6 +34,16 @@ inline std::string to_string(T t)
     return ss.str();
 }
 
+/// The result of decoding one generation
+struct decoding_trial_result
+{
+    /// The number of symbols used to decode
+    uint32_t m_symbols_used;
+
+    /// The number of symbols used to decode indexed by the rank of the
+    /// decoder
+    std::vector<uint32_t> m_rank_used;
+};
 
 /// A test block represents an encoder and decoder pair
 template<class Encoder, class Decoder>
@@ -43,14 +57,24 @@ public:
     typedef typename Decoder::factory decoder_factory;
     typedef typename Decoder::pointer decoder_ptr;
 
+    typedef typename Encoder::field_type field_type;
+
+    /// The engine running the trials of a run in parallel
+    typedef kodo::monte_carlo_engine<decoding_trial_result> engine_type;
+
+    /// The random generator of a trial
+    typedef engine_type::generator_type generator_type;
+
+    /// The function decoding one generation
+    typedef std::function<decoding_trial_result (uint32_t, generator_type&)>
+        trial_type;
+
     static_assert(kodo::has_deep_symbol_storage<Decoder>::value,
                   "The decoder should bring its own memory");
 
     decoding_probability_benchmark()
-    {
-        // Seed the random generator controlling the erasures
-        m_random_generator.seed((uint64_t)time(0));
-    }
+        : m_seed((uint64_t)time(0))
+    { }
 
     void start()
     { }
@@ -60,17 +84,17 @@ public:
 
     void store_run(gauge::table& results)
     {
-        assert(m_encoder->block_size() ==
-               m_decoder->block_size());
-
         assert(m_symbols_used > 0);
-        assert(m_symbols_used >= m_encoder->symbols());
+        assert(m_symbols_used >= m_trials * m_symbols);
 
-        results.set_value("used", m_symbols_used);
+        // With several trials per run the mean of the trials is stored
+        results.set_value("used", double(m_symbols_used) / m_trials);
+        results.set_value("trials", m_trials);
 
         for(uint32_t i = 0; i < m_rank_used.size(); ++i)
         {
-            results.set_value("rank " + to_string(i), m_rank_used[i]);
+            results.set_value("rank " + to_string(i),
+                              double(m_rank_used[i]) / m_trials);
         }
 
     }
@@ -80,10 +104,33 @@ public:
         return "symbols";
     }
 
+    /// Reads the options shared by the decoding probability benchmarks
+    /// @return The symbol sizes to benchmark
+    std::vector<uint32_t> get_engine_options(
+        gauge::po::variables_map& options)
+    {
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+
+        m_trials = options["trials"].as<uint32_t>();
+        assert(m_trials > 0);
+
+        m_engine = std::make_shared<engine_type>(
+            options["threads"].as<uint32_t>());
+
+        // The measurements only depend on the coefficients, so the
+        // symbol data can be shrunk to a single field element
+        if(options["coefficients_only"].as<bool>())
+        {
+            symbol_size.assign(1, fifi::elements_to_size<field_type>(1));
+        }
+
+        return symbol_size;
+    }
+
     void get_options(gauge::po::variables_map& options)
     {
         auto symbols = options["symbols"].as<std::vector<uint32_t> >();
-        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto symbol_size = get_engine_options(options);
         auto erasure = options["erasure"].as<std::vector<double> >();
         auto systematic = options["systematic"].as<bool>();
 
@@ -91,21 +138,6 @@ public:
         assert(symbol_size.size() > 0);
         assert(erasure.size() > 0);
 
-        m_max_symbols = *std::max_element(symbols.begin(),
-                                          symbols.end());
-
-        m_max_symbol_size = *std::max_element(symbol_size.begin(),
-                                              symbol_size.end());
-
-        // Make the factories fit perfectly otherwise there seems to
-        // be problems with memory access i.e. when using a factory
-        // with max symbols 1024 with a symbols 16
-        m_decoder_factory = std::make_shared<decoder_factory>(
-            m_max_symbols, m_max_symbol_size);
-
-        m_encoder_factory = std::make_shared<encoder_factory>(
-            m_max_symbols, m_max_symbol_size);
-
         for(uint32_t i = 0; i < symbols.size(); ++i)
         {
             for(uint32_t j = 0; j < symbol_size.size(); ++j)
@@ -127,116 +159,140 @@ public:
     {
         gauge::config_set cs = get_current_configuration();
 
-        uint32_t symbols = cs.get_value<uint32_t>("symbols");
-        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
-        bool systematic = cs.get_value<bool>("systematic");
+        m_symbols = cs.get_value<uint32_t>("symbols");
+        m_symbol_size = cs.get_value<uint32_t>("symbol_size");
+        m_systematic = cs.get_value<bool>("systematic");
+        m_erasure = cs.get_value<double>("erasure");
 
-        m_decoder_factory->set_symbols(symbols);
-        m_decoder_factory->set_symbol_size(symbol_size);
-
-        m_encoder_factory->set_symbols(symbols);
-        m_encoder_factory->set_symbol_size(symbol_size);
-
-        m_encoder = m_encoder_factory->build();
-        m_decoder = m_decoder_factory->build();
+        m_symbols_used = 0;
+        m_rank_used.resize(m_symbols);
+        std::fill(m_rank_used.begin(), m_rank_used.end(), 0);
+    }
 
+    /// Sets up an encoder built for a trial
+    /// @param encoder The encoder
+    virtual void configure_encoder(encoder_ptr &encoder) const
+    {
         // We switch any systematic operations off so we code
         // symbols from the beginning
-        if(kodo::is_systematic_encoder(m_encoder))
+        if(kodo::is_systematic_encoder(encoder))
         {
-            if(systematic)
+            if(m_systematic)
             {
-                kodo::set_systematic_on(m_encoder);
+                kodo::set_systematic_on(encoder);
             }
             else
             {
-                kodo::set_systematic_off(m_encoder);
+                kodo::set_systematic_off(encoder);
             }
         }
+    }
 
+    /// Makes the function decoding a generation in a lane of the
+    /// engine, the lane has its own factories
+    trial_type make_trial() const
+    {
+        auto encoders = std::make_shared<encoder_factory>(
+            m_symbols, m_symbol_size);
 
-        // Prepare the data to be encoded
-        m_encoded_data.resize(m_encoder->block_size());
+        auto decoders = std::make_shared<decoder_factory>(
+            m_symbols, m_symbol_size);
 
-        for(uint8_t &e : m_encoded_data)
+        return [this, encoders, decoders](uint32_t, generator_type &random)
         {
-            e = rand() % 256;
-        }
+            encoder_ptr encoder = encoders->build();
+            decoder_ptr decoder = decoders->build();
 
-        m_encoder->set_symbols(sak::storage(m_encoded_data));
+            configure_encoder(encoder);
 
-        m_symbols_used = 0;
-        m_rank_used.resize(symbols);
-        std::fill(m_rank_used.begin(), m_rank_used.end(), 0);
+            // Prepare the data to be encoded
+            std::vector<uint8_t> data(encoder->block_size());
+
+            for(uint8_t &e : data)
+            {
+                e = random() % 256;
+            }
+
+            encoder->set_symbols(sak::storage(data));
+            encoder->seed((uint32_t)random());
+
+            boost::random::bernoulli_distribution<> erasure(m_erasure);
+
+            decoding_trial_result result;
+            result.m_symbols_used = 0;
+            result.m_rank_used.resize(m_symbols, 0);
+
+            std::vector<uint8_t> payload(encoder->payload_size());
 
-        double erasure = cs.get_value<double>("erasure");
-        m_distribution = boost::random::bernoulli_distribution<>(erasure);
+            while(!decoder->is_complete())
+            {
+                encoder->encode(&payload[0]);
+
+                if(erasure(random))
+                    continue;
+
+                ++result.m_symbols_used;
+                ++result.m_rank_used[decoder->rank()];
+                decoder->decode(&payload[0]);
+            }
+
+            return result;
+        };
     }
 
     /// Run the benchmark
     void run_benchmark()
     {
         assert(m_symbols_used == 0);
-        assert(m_encoder);
-        assert(m_decoder);
-
-        std::vector<uint8_t> payload(m_encoder->payload_size());
-
-        m_encoder->seed((uint32_t)time(0));
+        assert(m_engine);
 
         // The clock is running
         RUN{
 
-            while(!m_decoder->is_complete())
-            {
-                m_encoder->encode(&payload[0]);
+            auto results = m_engine->run(
+                m_trials, m_seed++, [this] { return make_trial(); });
 
-                if(m_distribution(m_random_generator))
-                    continue;
+            for(const auto &r : results)
+            {
+                m_symbols_used += r.m_symbols_used;
 
-                ++m_symbols_used;
-                ++m_rank_used[m_decoder->rank()];
-                m_decoder->decode(&payload[0]);
+                for(uint32_t i = 0; i < m_symbols; ++i)
+                {
+                    m_rank_used[i] += r.m_rank_used[i];
+                }
             }
         }
     }
 
 protected:
 
-    /// The maximum number of symbols
-    uint32_t m_max_symbols;
+    /// The number of trials per run
+    uint32_t m_trials;
 
-    /// The maximum symbol size
-    uint32_t m_max_symbol_size;
+    /// The engine running the trials
+    std::shared_ptr<engine_type> m_engine;
 
-    /// The decoder factory
-    std::shared_ptr<decoder_factory> m_decoder_factory;
+    /// The seed of the next run
+    uint64_t m_seed;
 
-    /// The encoder factory
-    std::shared_ptr<encoder_factory> m_encoder_factory;
+    /// The number of symbols
+    uint32_t m_symbols;
 
-    /// The encoder to use
-    encoder_ptr m_encoder;
+    /// The symbol size
+    uint32_t m_symbol_size;
 
-    /// The encoder to use
-    decoder_ptr m_decoder;
+    /// Whether the encoder is systematic
+    bool m_systematic;
 
-    /// The data to encode
-    std::vector<uint8_t> m_encoded_data;
+    /// The erasure probability
+    double m_erasure;
 
-    /// The number of symbols used to decode
-    uint32_t m_symbols_used;
+    /// The number of symbols used to decode in all trials
+    uint64_t m_symbols_used;
 
     /// The number of symbols used to decoder indexed by the rank of the
-    /// decoder
-    std::vector<uint32_t> m_rank_used;
-
-    // The random generator
-    boost::random::mt19937 m_random_generator;
-
-    // The distribution wrapping the random generator
-    boost::random::bernoulli_distribution<> m_distribution;
-
+    /// decoder, summed over the trials
+    std::vector<uint64_t> m_rank_used;
 
 };
 
@@ -246,27 +302,18 @@ struct sparse_decoding_probability_benchmark :
 {
 public:
 
-    /// The encoder and decoder factories
-    typedef typename Encoder::factory encoder_factory;
-    typedef typename Decoder::factory decoder_factory;
+    /// The encoder pointer
+    typedef typename Encoder::pointer encoder_ptr;
 
     /// The type of the base benchmark
     typedef decoding_probability_benchmark<Encoder,Decoder> Super;
 
-    /// We need to access a couple of member variables from the
-    /// base benchmark to setup the benchmark correctly
-    using Super::m_encoder;
-    using Super::m_decoder_factory;
-    using Super::m_encoder_factory;
-    using Super::m_max_symbols;
-    using Super::m_max_symbol_size;
-
 public:
 
     void get_options(gauge::po::variables_map& options)
     {
         auto symbols = options["symbols"].as<std::vector<uint32_t> >();
-        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto symbol_size = Super::get_engine_options(options);
         auto erasure = options["erasure"].as<std::vector<double> >();
         auto density = options["density"].as<std::vector<double> >();
         auto systematic = options["systematic"].as<bool>();
@@ -276,21 +323,6 @@ public:
         assert(erasure.size() > 0);
         assert(density.size() > 0);
 
-        m_max_symbols = *std::max_element(symbols.begin(),
-                                          symbols.end());
-
-        m_max_symbol_size = *std::max_element(symbol_size.begin(),
-                                              symbol_size.end());
-
-        // Make the factories fit perfectly otherwise there seems to
-        // be problems with memory access i.e. when using a factory
-        // with max symbols 1024 with a symbols 16
-        m_decoder_factory = std::make_shared<decoder_factory>(
-            m_max_symbols, m_max_symbol_size);
-
-        m_encoder_factory = std::make_shared<encoder_factory>(
-            m_max_symbols, m_max_symbol_size);
-
         for(const auto& s : symbols)
         {
             for(const auto& p : symbol_size)
@@ -317,15 +349,22 @@ public:
         Super::setup();
 
         gauge::config_set cs = Super::get_current_configuration();
+        m_density = cs.get_value<double>("density");
+    }
 
-        double density = cs.get_value<double>("density");
-
-        assert(m_encoder);
-        m_encoder->set_density(density);
+    /// @copydoc decoding_probability_benchmark::configure_encoder
+    void configure_encoder(encoder_ptr &encoder) const
+    {
+        Super::configure_encoder(encoder);
+        encoder->set_density(m_density);
     }
 
-};
+protected:
+
+    /// The density of the encoder
+    double m_density;
 
+};
 
 /// Using this macro we may specify options. For specifying options
 /// we use the boost program options library. So you may additional
@@ -362,6 +401,20 @@ BENCHMARK_OPTION(overhead_options)
         ("systematic", gauge::po::value<bool>()->default_value(
             true, ""), "Set the encoder systematic");
 
+    options.add_options()
+        ("trials", gauge::po::value<uint32_t>()->default_value(1),
+         "Set the number of trials per run, the mean is stored");
+
+    options.add_options()
+        ("threads", gauge::po::value<uint32_t>()->default_value(0),
+         "Set the number of threads running the trials, zero for one "
+         "per hardware thread");
+
+    options.add_options()
+        ("coefficients_only", gauge::po::value<bool>()->default_value(
+            false, ""), "Code symbols of a single field element, as "
+         "only the coefficients determine the result");
+
     gauge::runner::instance().register_options(options);
 }
 
@@ -395,6 +448,15 @@ BENCHMARK_F(setup_rlnc_overhead, FullRLNC, Binary, 5)
     run_benchmark();
 }
 
+typedef decoding_probability_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary4>,
+    kodo::full_rlnc_decoder<fifi::binary4> > setup_rlnc_overhead4;
+
+BENCHMARK_F(setup_rlnc_overhead4, FullRLNC, Binary4, 5)
+{
+    run_benchmark();
+}
+
 typedef decoding_probability_benchmark<
     kodo::full_rlnc_encoder<fifi::binary8>,
     kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_overhead8;
@@ -0,0 +1,773 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+
+#if defined(KODO_HAS_ISAL)
+#include <isa-l/erasure_code.h>
+#endif
+
+#if defined(KODO_HAS_JERASURE)
+#include <jerasure.h>
+#include <jerasure/reed_sol.h>
+#endif
+
+/// A stripe of k source shards and m parity shards coded with a kodo
+/// encoder and decoder. The parity shards are the coded payloads
+/// produced after the systematic ones, and a reconstruction decodes the
+/// surviving source payloads followed by the parity payloads.
+template<class Encoder, class Decoder>
+class kodo_stripe
+{
+public:
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+
+public:
+
+    /// Prepares the coders of a stripe
+    /// @param symbols The number of source shards k
+    /// @param repair The number of parity shards m
+    /// @param symbol_size The size of a shard in bytes
+    /// @param data The k source shards
+    void setup(uint32_t symbols, uint32_t repair, uint32_t symbol_size,
+               const std::vector<uint8_t> &data)
+    {
+        m_symbols = symbols;
+        m_repair = repair;
+
+        m_encoder_factory = std::make_shared<encoder_factory>(
+            symbols, symbol_size);
+
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            symbols, symbol_size);
+
+        m_encoder = m_encoder_factory->build();
+        m_decoder = m_decoder_factory->build();
+
+        m_data = data;
+        m_encoder->set_symbols(sak::storage(m_data));
+
+        m_parity.resize(repair);
+
+        for(auto &p : m_parity)
+        {
+            p.resize(m_encoder->payload_size());
+        }
+
+        m_temp_payload.resize(m_encoder->payload_size());
+    }
+
+    /// Computes the parity shards of the stripe
+    void encode()
+    {
+        // The encoder keeps producing coded payloads, re-initializing
+        // it would copy the block again
+        kodo::set_systematic_off(m_encoder);
+
+        for(auto &p : m_parity)
+        {
+            m_encoder->encode(&p[0]);
+        }
+    }
+
+    /// Produces the payloads of the stripe and loses source shards
+    /// @param erasures The number of source shards lost, at most the
+    ///        number of parity shards
+    void prepare_decode(uint32_t erasures)
+    {
+        assert(erasures <= m_repair);
+        assert(erasures <= m_symbols);
+
+        m_encoder->initialize(*m_encoder_factory);
+        m_encoder->set_symbols(sak::storage(m_data));
+
+        m_payloads.clear();
+
+        for(uint32_t i = 0; i < m_symbols + m_repair; ++i)
+        {
+            std::vector<uint8_t> payload(m_encoder->payload_size());
+            m_encoder->encode(&payload[0]);
+
+            // The first source shards are lost
+            if(i >= erasures)
+                m_payloads.push_back(payload);
+        }
+    }
+
+    /// Reconstructs the source shards from the surviving shards
+    void decode()
+    {
+        m_decoder->initialize(*m_decoder_factory);
+
+        for(const auto &p : m_payloads)
+        {
+            std::copy(p.begin(), p.end(), m_temp_payload.begin());
+            m_decoder->decode(&m_temp_payload[0]);
+
+            if(m_decoder->is_complete())
+                return;
+        }
+    }
+
+    /// @return True if the last reconstruction restored the source
+    ///         shards
+    bool verify()
+    {
+        if(!m_decoder->is_complete())
+            return false;
+
+        std::vector<uint8_t> data_out(m_decoder->block_size());
+        m_decoder->copy_symbols(sak::storage(data_out));
+
+        return data_out == m_data;
+    }
+
+protected:
+
+    /// The number of source shards
+    uint32_t m_symbols;
+
+    /// The number of parity shards
+    uint32_t m_repair;
+
+    /// The encoder factory
+    std::shared_ptr<encoder_factory> m_encoder_factory;
+
+    /// The decoder factory
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The encoder
+    encoder_ptr m_encoder;
+
+    /// The decoder
+    decoder_ptr m_decoder;
+
+    /// The source shards
+    std::vector<uint8_t> m_data;
+
+    /// The parity payloads computed by encode()
+    std::vector<std::vector<uint8_t> > m_parity;
+
+    /// The surviving payloads of the stripe
+    std::vector<std::vector<uint8_t> > m_payloads;
+
+    /// The payload passed to the decoder, which decodes in place
+    std::vector<uint8_t> m_temp_payload;
+
+};
+
+/// A Reed-Solomon stripe computing the parity shards in one pass over
+/// the source shards, see kodo::reed_solomon_parity_encoder
+template<class Encoder, class Decoder>
+class rs_stripe : public kodo_stripe<Encoder, Decoder>
+{
+public:
+
+    typedef kodo_stripe<Encoder, Decoder> Super;
+
+public:
+
+    /// @copydoc kodo_stripe::encode()
+    void encode()
+    {
+        m_pointers.resize(Super::m_repair);
+
+        for(uint32_t i = 0; i < Super::m_repair; ++i)
+        {
+            m_pointers[i] = &Super::m_parity[i][0];
+        }
+
+        Super::m_encoder->encode_parity_symbols(
+            &m_pointers[0], 0, Super::m_repair);
+    }
+
+private:
+
+    /// The buffers of the parity shards
+    std::vector<uint8_t*> m_pointers;
+
+};
+
+#if defined(KODO_HAS_ISAL)
+
+/// A stripe coded with the Cauchy Reed-Solomon code of ISA-L. As the
+/// kodo decoders, a reconstruction inverts the matrix of the surviving
+/// rows every time.
+class isal_stripe
+{
+public:
+
+    /// @copydoc kodo_stripe::setup()
+    void setup(uint32_t symbols, uint32_t repair, uint32_t symbol_size,
+               const std::vector<uint8_t> &data)
+    {
+        m_symbols = symbols;
+        m_repair = repair;
+        m_symbol_size = symbol_size;
+
+        uint32_t rows = symbols + repair;
+
+        m_matrix.resize(rows * symbols);
+        gf_gen_cauchy1_matrix(&m_matrix[0], rows, symbols);
+
+        m_tables.resize(32 * symbols * repair);
+        ec_init_tables(symbols, repair, &m_matrix[symbols * symbols],
+                       &m_tables[0]);
+
+        m_shards.assign(rows, std::vector<uint8_t>(symbol_size));
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            std::copy_n(&data[i * symbol_size], symbol_size,
+                        m_shards[i].begin());
+        }
+
+        m_data = data;
+        m_pointers.resize(rows);
+
+        for(uint32_t i = 0; i < rows; ++i)
+        {
+            m_pointers[i] = &m_shards[i][0];
+        }
+    }
+
+    /// @copydoc kodo_stripe::encode()
+    void encode()
+    {
+        ec_encode_data(m_symbol_size, m_symbols, m_repair, &m_tables[0],
+                       &m_pointers[0], &m_pointers[m_symbols]);
+    }
+
+    /// @copydoc kodo_stripe::prepare_decode()
+    void prepare_decode(uint32_t erasures)
+    {
+        assert(erasures <= m_repair);
+        assert(erasures <= m_symbols);
+
+        encode();
+
+        m_erasures = erasures;
+
+        // The surviving shards, the first source shards are lost
+        m_survivors.clear();
+
+        for(uint32_t i = erasures; i < m_symbols + erasures; ++i)
+        {
+            m_survivors.push_back(m_pointers[i]);
+        }
+
+        m_recovered.assign(erasures, std::vector<uint8_t>(m_symbol_size));
+        m_recovered_pointers.resize(erasures);
+
+        for(uint32_t i = 0; i < erasures; ++i)
+        {
+            m_recovered_pointers[i] = &m_recovered[i][0];
+        }
+    }
+
+    /// @copydoc kodo_stripe::decode()
+    void decode()
+    {
+        if(m_erasures == 0)
+            return;
+
+        uint32_t k = m_symbols;
+
+        std::vector<uint8_t> rows(k * k);
+        std::vector<uint8_t> inverse(k * k);
+
+        for(uint32_t i = 0; i < k; ++i)
+        {
+            std::copy_n(&m_matrix[(i + m_erasures) * k], k, &rows[i * k]);
+        }
+
+        int failed = gf_invert_matrix(&rows[0], &inverse[0], k);
+        assert(failed == 0);
+        (void) failed;
+
+        // The rows of the inverse producing the lost source shards
+        std::vector<uint8_t> tables(32 * k * m_erasures);
+        ec_init_tables(k, m_erasures, &inverse[0], &tables[0]);
+
+        ec_encode_data(m_symbol_size, k, m_erasures, &tables[0],
+                       &m_survivors[0], &m_recovered_pointers[0]);
+    }
+
+    /// @copydoc kodo_stripe::verify()
+    bool verify()
+    {
+        for(uint32_t i = 0; i < m_erasures; ++i)
+        {
+            if(!std::equal(m_recovered[i].begin(), m_recovered[i].end(),
+                           &m_data[i * m_symbol_size]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+
+    /// The number of source shards
+    uint32_t m_symbols;
+
+    /// The number of parity shards
+    uint32_t m_repair;
+
+    /// The size of a shard
+    uint32_t m_symbol_size;
+
+    /// The number of lost source shards
+    uint32_t m_erasures;
+
+    /// The generator matrix, the identity followed by the parity rows
+    std::vector<uint8_t> m_matrix;
+
+    /// The expanded tables of the parity rows
+    std::vector<uint8_t> m_tables;
+
+    /// The source and parity shards
+    std::vector<std::vector<uint8_t> > m_shards;
+
+    /// The source shards
+    std::vector<uint8_t> m_data;
+
+    /// The buffers of the source and parity shards
+    std::vector<uint8_t*> m_pointers;
+
+    /// The buffers of the surviving shards
+    std::vector<uint8_t*> m_survivors;
+
+    /// The reconstructed source shards
+    std::vector<std::vector<uint8_t> > m_recovered;
+
+    /// The buffers of the reconstructed source shards
+    std::vector<uint8_t*> m_recovered_pointers;
+
+};
+
+#endif
+
+#if defined(KODO_HAS_JERASURE)
+
+/// A stripe coded with the Vandermonde Reed-Solomon code of Jerasure
+/// over GF(2^8)
+class jerasure_stripe
+{
+public:
+
+    /// The word size of the code in bits
+    static const int word_size = 8;
+
+public:
+
+    /// Constructor
+    jerasure_stripe()
+        : m_matrix(0)
+    { }
+
+    /// Frees the coding matrix
+    ~jerasure_stripe()
+    {
+        free(m_matrix);
+    }
+
+    /// @copydoc kodo_stripe::setup()
+    void setup(uint32_t symbols, uint32_t repair, uint32_t symbol_size,
+               const std::vector<uint8_t> &data)
+    {
+        // Jerasure codes whole machine words
+        assert(symbol_size % sizeof(long) == 0);
+
+        m_symbols = symbols;
+        m_repair = repair;
+        m_symbol_size = symbol_size;
+
+        free(m_matrix);
+        m_matrix = reed_sol_vandermonde_coding_matrix(
+            symbols, repair, word_size);
+
+        m_data = data;
+
+        m_shards.assign(symbols + repair, std::vector<char>(symbol_size));
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            std::copy_n(&data[i * symbol_size], symbol_size,
+                        m_shards[i].begin());
+        }
+
+        m_pointers.resize(symbols + repair);
+
+        for(uint32_t i = 0; i < symbols + repair; ++i)
+        {
+            m_pointers[i] = &m_shards[i][0];
+        }
+    }
+
+    /// @copydoc kodo_stripe::encode()
+    void encode()
+    {
+        jerasure_matrix_encode(m_symbols, m_repair, word_size, m_matrix,
+                               &m_pointers[0], &m_pointers[m_symbols],
+                               m_symbol_size);
+    }
+
+    /// @copydoc kodo_stripe::prepare_decode()
+    void prepare_decode(uint32_t erasures)
+    {
+        assert(erasures <= m_repair);
+        assert(erasures <= m_symbols);
+
+        encode();
+
+        // The list of the lost shards is terminated by -1
+        m_erasures.clear();
+
+        for(uint32_t i = 0; i < erasures; ++i)
+        {
+            m_erasures.push_back(i);
+        }
+
+        m_erasures.push_back(-1);
+    }
+
+    /// @copydoc kodo_stripe::decode()
+    void decode()
+    {
+        int failed = jerasure_matrix_decode(
+            m_symbols, m_repair, word_size, m_matrix, 1, &m_erasures[0],
+            &m_pointers[0], &m_pointers[m_symbols], m_symbol_size);
+
+        assert(failed == 0);
+        (void) failed;
+    }
+
+    /// @copydoc kodo_stripe::verify()
+    bool verify()
+    {
+        for(uint32_t i = 0; i < m_symbols; ++i)
+        {
+            if(!std::equal(m_shards[i].begin(), m_shards[i].end(),
+                           reinterpret_cast<const char*>(
+                               &m_data[i * m_symbol_size])))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+
+    /// The number of source shards
+    uint32_t m_symbols;
+
+    /// The number of parity shards
+    uint32_t m_repair;
+
+    /// The size of a shard
+    uint32_t m_symbol_size;
+
+    /// The coding matrix allocated by Jerasure
+    int *m_matrix;
+
+    /// The lost shards terminated by -1
+    std::vector<int> m_erasures;
+
+    /// The source shards
+    std::vector<uint8_t> m_data;
+
+    /// The source and parity shards, the lost shards are decoded in
+    /// place
+    std::vector<std::vector<char> > m_shards;
+
+    /// The buffers of the source and parity shards
+    std::vector<char*> m_pointers;
+
+};
+
+#endif
+
+/// Benchmark coding identical stripes of k source and m parity shards
+/// with kodo and the reference implementations found when configuring.
+/// The encoder computes the m parity shards, the decoder reconstructs
+/// the lost source shards from the k surviving shards. Both report the
+/// stripe data k * symbol_size coded per second in GB/s, and the time
+/// of coding one stripe, for the decoder the reconstruction latency.
+template<class Stripe>
+struct erasure_coding_benchmark : public gauge::time_benchmark
+{
+
+    void store_run(gauge::table& results)
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // The time per stripe in microseconds
+        double latency = gauge::time_benchmark::measurement();
+        uint64_t bytes = uint64_t(symbols) * symbol_size;
+
+        results.set_value("throughput", bytes / latency / 1000.0);
+        results.set_value("latency_us", latency);
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        // A decoder must reconstruct the stripe, the random codes may
+        // need another stripe
+        if(type == "decoder" && !m_stripe.verify())
+            return false;
+
+        return gauge::time_benchmark::accept_measurement();
+    }
+
+    std::string unit_text() const
+    {
+        return "GB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto repair = options["repair"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto types = options["type"].as<std::vector<std::string> >();
+
+        assert(symbols.size() > 0);
+        assert(repair.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(types.size() > 0);
+
+        for(const auto& k : symbols)
+        {
+            for(const auto& m : repair)
+            {
+                for(const auto& p : symbol_size)
+                {
+                    for(const auto& t : types)
+                    {
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("symbols", k);
+                        cs.set_value<uint32_t>("repair", m);
+                        cs.set_value<uint32_t>("symbol_size", p);
+                        cs.set_value<std::string>("type", t);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t repair = cs.get_value<uint32_t>("repair");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        std::string type = cs.get_value<std::string>("type");
+
+        std::vector<uint8_t> data(symbols * symbol_size);
+
+        for(uint8_t &e : data)
+        {
+            e = rand() % 256;
+        }
+
+        m_stripe.setup(symbols, repair, symbol_size, data);
+
+        if(type == "decoder")
+        {
+            // Lose as many source shards as the code can repair
+            m_stripe.prepare_decode(std::min(symbols, repair));
+        }
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        assert(type == "encoder" || type == "decoder");
+
+        if(type == "encoder")
+        {
+            RUN{
+                m_stripe.encode();
+            }
+        }
+        else
+        {
+            RUN{
+                m_stripe.decode();
+            }
+        }
+    }
+
+protected:
+
+    /// The stripe coded
+    Stripe m_stripe;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(erasure_coding_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(10);
+    symbols.push_back(32);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> repair;
+    repair.push_back(4);
+
+    auto default_repair =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            repair, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(4096);
+    symbol_size.push_back(65536);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of source shards k");
+
+    options.add_options()
+        ("repair", default_repair, "Set the number of parity shards m");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the shard size in bytes");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef erasure_coding_benchmark<
+    rs_stripe<kodo::rs_encoder<fifi::binary8>,
+              kodo::rs_decoder<fifi::binary8> > > setup_rs_stripe8;
+
+BENCHMARK_F(setup_rs_stripe8, RS, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef erasure_coding_benchmark<
+    rs_stripe<kodo::rs_encoder<fifi::binary8>,
+              kodo::rs_inverse_decoder<fifi::binary8> > >
+    setup_rs_inverse_stripe8;
+
+BENCHMARK_F(setup_rs_inverse_stripe8, RSInverse, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef erasure_coding_benchmark<
+    kodo_stripe<kodo::full_rlnc_encoder<fifi::binary8>,
+                kodo::full_rlnc_decoder<fifi::binary8> > >
+    setup_rlnc_stripe8;
+
+BENCHMARK_F(setup_rlnc_stripe8, FullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef erasure_coding_benchmark<
+    kodo_stripe<kodo::full_rlnc_encoder<fifi::binary16>,
+                kodo::full_rlnc_decoder<fifi::binary16> > >
+    setup_rlnc_stripe16;
+
+BENCHMARK_F(setup_rlnc_stripe16, FullRLNC, Binary16, 5)
+{
+    run_benchmark();
+}
+
+#if defined(KODO_HAS_ISAL)
+
+typedef erasure_coding_benchmark<isal_stripe> setup_isal_stripe;
+
+BENCHMARK_F(setup_isal_stripe, ISAL, Binary8, 5)
+{
+    run_benchmark();
+}
+
+#endif
+
+#if defined(KODO_HAS_JERASURE)
+
+typedef erasure_coding_benchmark<jerasure_stripe> setup_jerasure_stripe;
+
+BENCHMARK_F(setup_jerasure_stripe, Jerasure, Binary8, 5)
+{
+    run_benchmark();
+}
+
+#endif
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
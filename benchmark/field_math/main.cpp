@@ -0,0 +1,498 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <chrono>
+#include <algorithm>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <fifi/default_field.hpp>
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include <sak/aligned_allocator.hpp>
+
+#include <kodo/final_coder_factory.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/simd_finite_field_math.hpp>
+#include <kodo/storage_block_info.hpp>
+
+namespace kodo
+{
+
+    /// Stack holding only the plain finite field layer
+    template<class Field>
+    class field_math_stack
+        : public storage_block_info<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 field_math_stack<Field>
+                     > > > >
+    { };
+
+    /// Stack holding only the vectorized finite field layer
+    template<class Field>
+    class simd_field_math_stack
+        : public storage_block_info<
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 simd_field_math_stack<Field>
+                     > > > >
+    { };
+
+}
+
+/// Microbenchmark of the region operations of a finite field layer,
+/// called through the layer as the codecs call them, so a slowdown of
+/// the codecs can be attributed to the field kernels or to the rest of
+/// the stack. Every run repeats one operation on regions of the
+/// configured length until about repeat_bytes bytes are processed:
+///
+/// - The offset shifts the regions by a number of bytes from the 16
+///   byte aligned start of the buffers, e.g. as the symbols of a
+///   payload.
+/// - With the hot cache the same destination and source are used in
+///   every call. With the cold cache the calls cycle through buffers of
+///   cold_bytes bytes in total, which should exceed the last level
+///   cache.
+///
+/// The throughput is the number of destination bytes processed per
+/// second. The invert operation inverts every element of the region,
+/// it is not measured for the binary field.
+template<class Stack>
+struct field_math_benchmark : public gauge::benchmark
+{
+
+    typedef typename Stack::factory factory_type;
+    typedef typename Stack::pointer pointer_type;
+
+    typedef typename Stack::field_type field_type;
+    typedef typename field_type::value_type value_type;
+
+    typedef std::chrono::high_resolution_clock clock_type;
+
+    /// The type of the buffers
+    typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
+        aligned_vector;
+
+    void start()
+    {
+        m_bytes = 0;
+        m_time = 0;
+    }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        assert(m_time > 0);
+
+        // Bytes per nanosecond gives GB/s
+        results.set_value("throughput", m_bytes / m_time);
+    }
+
+    std::string unit_text() const
+    {
+        return "GB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto lengths = options["length"].as<std::vector<uint32_t> >();
+        auto offsets = options["offset"].as<std::vector<uint32_t> >();
+        auto operations = options["operation"].as<std::vector<std::string> >();
+        auto caches = options["cache"].as<std::vector<std::string> >();
+
+        assert(lengths.size() > 0);
+        assert(offsets.size() > 0);
+        assert(operations.size() > 0);
+        assert(caches.size() > 0);
+
+        m_repeat_bytes = options["repeat_bytes"].as<uint32_t>();
+        m_cold_bytes = options["cold_bytes"].as<uint32_t>();
+
+        for(const auto& l : lengths)
+        {
+            for(const auto& o : offsets)
+            {
+                // The regions must hold whole field elements
+                if(l % sizeof(value_type) != 0 ||
+                   o % sizeof(value_type) != 0)
+                {
+                    continue;
+                }
+
+                for(const auto& op : operations)
+                {
+                    // The values of the binary field pack several
+                    // elements which cannot be inverted as a value
+                    if(op == "invert" && fifi::is_binary<field_type>::value)
+                    {
+                        continue;
+                    }
+
+                    for(const auto& c : caches)
+                    {
+                        assert(c == "hot" || c == "cold");
+
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("length", l);
+                        cs.set_value<uint32_t>("offset", o);
+                        cs.set_value<std::string>("operation", op);
+                        cs.set_value<std::string>("cache", c);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    /// @return A random element of the field, non-zero unless the
+    ///         field is binary where the values pack several elements
+    value_type random_value() const
+    {
+        if(fifi::is_binary<field_type>::value)
+        {
+            return static_cast<value_type>(rand());
+        }
+
+        return static_cast<value_type>(
+            1 + rand() % uint64_t(field_type::max_value));
+    }
+
+    /// @return A random non-zero coefficient
+    value_type random_coefficient() const
+    {
+        if(fifi::is_binary<field_type>::value)
+        {
+            return 1;
+        }
+
+        return random_value();
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t length = cs.get_value<uint32_t>("length");
+        uint32_t offset = cs.get_value<uint32_t>("offset");
+        std::string cache = cs.get_value<std::string>("cache");
+
+        m_factory = std::make_shared<factory_type>(1, length);
+        m_stack = m_factory->build();
+
+        m_length = fifi::size_to_length<field_type>(length);
+        m_region_bytes = length;
+        m_offset = offset;
+
+        uint32_t buffer_size = length + offset;
+
+        uint32_t buffers = 2;
+
+        if(cache == "cold")
+        {
+            buffers = std::max<uint32_t>(2, m_cold_bytes / buffer_size);
+        }
+
+        m_buffers.resize(buffers);
+
+        for(auto& b : m_buffers)
+        {
+            b.resize(buffer_size);
+
+            value_type *values = reinterpret_cast<value_type*>(&b[0]);
+            uint32_t count = buffer_size / sizeof(value_type);
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                values[i] = random_value();
+            }
+        }
+
+        m_coefficient = random_coefficient();
+        m_next = 0;
+    }
+
+    /// @return The next region of the buffers
+    value_type* next_region()
+    {
+        uint8_t *data = &m_buffers[m_next][0] + m_offset;
+        m_next = (m_next + 1) % m_buffers.size();
+
+        return reinterpret_cast<value_type*>(data);
+    }
+
+    /// Runs an operation once
+    /// @param operation The name of the operation
+    void run_operation(const std::string &operation)
+    {
+        value_type *dest = next_region();
+        value_type *src = next_region();
+
+        if(operation == "multiply")
+        {
+            m_stack->multiply(dest, m_coefficient, m_length);
+        }
+        else if(operation == "multiply_add")
+        {
+            m_stack->multiply_add(dest, src, m_coefficient, m_length);
+        }
+        else if(operation == "multiply_subtract")
+        {
+            m_stack->multiply_subtract(dest, src, m_coefficient, m_length);
+        }
+        else if(operation == "add")
+        {
+            m_stack->add(dest, src, m_length);
+        }
+        else if(operation == "subtract")
+        {
+            m_stack->subtract(dest, src, m_length);
+        }
+        else
+        {
+            assert(operation == "invert");
+
+            for(uint32_t i = 0; i < m_length; ++i)
+            {
+                if(dest[i] != 0)
+                {
+                    dest[i] = m_stack->invert(dest[i]);
+                }
+            }
+        }
+    }
+
+    /// Repeats the operation of the configuration
+    void measure()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string operation = cs.get_value<std::string>("operation");
+
+        uint32_t repeats =
+            std::max<uint32_t>(1, m_repeat_bytes / m_region_bytes);
+
+        auto start = clock_type::now();
+
+        for(uint32_t i = 0; i < repeats; ++i)
+        {
+            run_operation(operation);
+        }
+
+        auto stop = clock_type::now();
+
+        m_time += std::chrono::duration<double, std::nano>(
+            stop - start).count();
+
+        m_bytes += double(repeats) * m_region_bytes;
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        RUN{
+            measure();
+        }
+    }
+
+protected:
+
+    /// The factory of the stack
+    std::shared_ptr<factory_type> m_factory;
+
+    /// The stack performing the operations
+    pointer_type m_stack;
+
+    /// The buffers holding the regions
+    std::vector<aligned_vector> m_buffers;
+
+    /// The next buffer used
+    uint32_t m_next;
+
+    /// The length of the regions in values
+    uint32_t m_length;
+
+    /// The length of the regions in bytes
+    uint32_t m_region_bytes;
+
+    /// The offset of the regions from the start of the buffers
+    uint32_t m_offset;
+
+    /// The coefficient of the multiplications
+    value_type m_coefficient;
+
+    /// The number of bytes processed in a run
+    uint32_t m_repeat_bytes;
+
+    /// The total size of the buffers of the cold cache
+    uint32_t m_cold_bytes;
+
+    /// The number of bytes processed
+    double m_bytes;
+
+    /// The time spent in nanoseconds
+    double m_time;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(field_math_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> lengths;
+    lengths.push_back(16);
+    lengths.push_back(256);
+    lengths.push_back(4096);
+    lengths.push_back(65536);
+    lengths.push_back(1048576);
+
+    auto default_lengths =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            lengths, "")->multitoken();
+
+    std::vector<uint32_t> offsets;
+    offsets.push_back(0);
+    offsets.push_back(4);
+
+    auto default_offsets =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            offsets, "")->multitoken();
+
+    std::vector<std::string> operations;
+    operations.push_back("multiply");
+    operations.push_back("multiply_add");
+    operations.push_back("multiply_subtract");
+    operations.push_back("add");
+    operations.push_back("subtract");
+    operations.push_back("invert");
+
+    auto default_operations =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            operations, "")->multitoken();
+
+    std::vector<std::string> caches;
+    caches.push_back("hot");
+    caches.push_back("cold");
+
+    auto default_caches =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            caches, "")->multitoken();
+
+    options.add_options()
+        ("length", default_lengths, "Set the region length in bytes");
+
+    options.add_options()
+        ("offset", default_offsets,
+         "Set the offset of the regions from an aligned address in bytes");
+
+    options.add_options()
+        ("operation", default_operations,
+         "Set the operation [multiply|multiply_add|multiply_subtract|"
+         "add|subtract|invert]");
+
+    options.add_options()
+        ("cache", default_caches, "Set the cache state [hot|cold]");
+
+    options.add_options()
+        ("repeat_bytes",
+         gauge::po::value<uint32_t>()->default_value(1 << 24),
+         "Set the number of bytes processed in a run");
+
+    options.add_options()
+        ("cold_bytes",
+         gauge::po::value<uint32_t>()->default_value(1 << 26),
+         "Set the size of the buffers cycled through with a cold cache");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef field_math_benchmark<kodo::field_math_stack<fifi::binary> >
+    setup_field_math;
+
+BENCHMARK_F(setup_field_math, FieldMath, Binary, 10)
+{
+    run_benchmark();
+}
+
+typedef field_math_benchmark<kodo::field_math_stack<fifi::binary8> >
+    setup_field_math8;
+
+BENCHMARK_F(setup_field_math8, FieldMath, Binary8, 10)
+{
+    run_benchmark();
+}
+
+typedef field_math_benchmark<kodo::field_math_stack<fifi::binary16> >
+    setup_field_math16;
+
+BENCHMARK_F(setup_field_math16, FieldMath, Binary16, 10)
+{
+    run_benchmark();
+}
+
+typedef field_math_benchmark<kodo::field_math_stack<fifi::prime2325> >
+    setup_field_math2325;
+
+BENCHMARK_F(setup_field_math2325, FieldMath, Prime2325, 10)
+{
+    run_benchmark();
+}
+
+typedef field_math_benchmark<kodo::simd_field_math_stack<fifi::binary8> >
+    setup_simd_field_math8;
+
+BENCHMARK_F(setup_simd_field_math8, SimdFieldMath, Binary8, 10)
+{
+    run_benchmark();
+}
+
+typedef field_math_benchmark<kodo::simd_field_math_stack<fifi::binary16> >
+    setup_simd_field_math16;
+
+BENCHMARK_F(setup_simd_field_math16, SimdFieldMath, Binary16, 10)
+{
+    run_benchmark();
+}
+
+typedef field_math_benchmark<kodo::simd_field_math_stack<fifi::prime2325> >
+    setup_simd_field_math2325;
+
+BENCHMARK_F(setup_simd_field_math2325, SimdFieldMath, Prime2325, 10)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
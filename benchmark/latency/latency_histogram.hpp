@@ -0,0 +1,169 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+/// Histogram of latencies in the style of an HDR histogram. Values
+/// below 128 are counted exactly, larger values in buckets of 64
+/// sub-buckets per power of two, so a recorded value is known with a
+/// relative error below 1/64 over the whole 64 bit range. Recording is
+/// a few instructions and the memory is fixed.
+class latency_histogram
+{
+public:
+
+    /// The number of bits resolved within a power of two
+    static const uint32_t sub_bucket_bits = 7;
+
+    /// The number of values counted exactly
+    static const uint32_t sub_bucket_count = 1U << sub_bucket_bits;
+
+    /// The number of sub-buckets of a power of two above the exact values
+    static const uint32_t half_count = sub_bucket_count / 2;
+
+public:
+
+    /// Constructor
+    latency_histogram()
+        : m_counts(sub_bucket_count + (64 - sub_bucket_bits) * half_count,
+                   0),
+          m_total(0),
+          m_max(0),
+          m_sum(0)
+    { }
+
+    /// Removes all recorded values
+    void clear()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_total = 0;
+        m_max = 0;
+        m_sum = 0;
+    }
+
+    /// Records a value
+    /// @param value The value
+    void record(uint64_t value)
+    {
+        ++m_counts[bucket_index(value)];
+        ++m_total;
+        m_max = std::max(m_max, value);
+        m_sum += static_cast<double>(value);
+    }
+
+    /// @return The number of recorded values
+    uint64_t total() const
+    {
+        return m_total;
+    }
+
+    /// @return The largest recorded value
+    uint64_t max() const
+    {
+        return m_max;
+    }
+
+    /// @return The mean of the recorded values
+    double mean() const
+    {
+        return m_total ? m_sum / m_total : 0;
+    }
+
+    /// @param percentile The percentile in the range [0,100]
+    /// @return The smallest value such that the given percentage of the
+    ///         recorded values are equal or below, up to the resolution
+    ///         of the histogram
+    uint64_t percentile(double percentile) const
+    {
+        assert(percentile >= 0.0);
+        assert(percentile <= 100.0);
+
+        if(m_total == 0)
+        {
+            return 0;
+        }
+
+        uint64_t target = static_cast<uint64_t>(
+            std::ceil(percentile / 100.0 * m_total));
+
+        target = std::max<uint64_t>(target, 1U);
+
+        uint64_t count = 0;
+
+        for(uint32_t i = 0; i < m_counts.size(); ++i)
+        {
+            count += m_counts[i];
+
+            if(count >= target)
+            {
+                return std::min(highest_value(i), m_max);
+            }
+        }
+
+        return m_max;
+    }
+
+    /// @param value The value
+    /// @return The index of the bucket counting the value
+    static uint32_t bucket_index(uint64_t value)
+    {
+        if(value < sub_bucket_count)
+        {
+            return static_cast<uint32_t>(value);
+        }
+
+        uint32_t msb = 63;
+        while(!(value >> msb & 1U))
+        {
+            --msb;
+        }
+
+        uint32_t shift = msb - (sub_bucket_bits - 1);
+        uint32_t sub = static_cast<uint32_t>(value >> shift);
+
+        assert(sub >= half_count);
+        assert(sub < sub_bucket_count);
+
+        return sub_bucket_count + (shift - 1) * half_count +
+            (sub - half_count);
+    }
+
+    /// @param index The index of a bucket
+    /// @return The largest value counted in the bucket
+    static uint64_t highest_value(uint32_t index)
+    {
+        if(index < sub_bucket_count)
+        {
+            return index;
+        }
+
+        uint32_t offset = index - sub_bucket_count;
+        uint32_t shift = offset / half_count + 1;
+        uint64_t sub = offset % half_count + half_count;
+
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+
+    /// The counts of the buckets
+    std::vector<uint64_t> m_counts;
+
+    /// The number of recorded values
+    uint64_t m_total;
+
+    /// The largest recorded value
+    uint64_t m_max;
+
+    /// The sum of the recorded values
+    double m_sum;
+
+};
@@ -0,0 +1,358 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/cycle_counter.hpp>
+
+#include "codes.hpp"
+#include "latency_histogram.hpp"
+
+/// Benchmark measuring the latency of every single call to encode() or
+/// decode() of an encoder and decoder pair. The calls are timed with the
+/// cycle counter and recorded in a latency_histogram, from which the
+/// percentiles are stored in the results. For the decoders the calls
+/// completing the decoding are also recorded on their own, since with
+/// e.g. the delayed decoders the backward substitution makes this call
+/// much slower than the others.
+template<class Encoder, class Decoder>
+struct latency_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+
+    void start()
+    {
+        m_latency.clear();
+        m_completion.clear();
+    }
+
+    void stop()
+    { }
+
+    /// Stores the percentiles of a histogram in nanoseconds
+    /// @param results The result table
+    /// @param prefix The prefix of the column names
+    /// @param histogram The histogram
+    void store_histogram(gauge::table& results, const std::string &prefix,
+                         const latency_histogram &histogram)
+    {
+        results.set_value(prefix + "p50", to_ns(histogram.percentile(50)));
+        results.set_value(prefix + "p90", to_ns(histogram.percentile(90)));
+        results.set_value(prefix + "p99", to_ns(histogram.percentile(99)));
+        results.set_value(prefix + "p999",
+                          to_ns(histogram.percentile(99.9)));
+        results.set_value(prefix + "max", to_ns(histogram.max()));
+        results.set_value(prefix + "mean", histogram.mean() / m_ticks_per_ns);
+    }
+
+    void store_run(gauge::table& results)
+    {
+        store_histogram(results, "", m_latency);
+
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        if(type == "decoder")
+        {
+            store_histogram(results, "completion_", m_completion);
+        }
+    }
+
+    std::string unit_text() const
+    {
+        return "ns";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto types = options["type"].as<std::vector<std::string> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(types.size() > 0);
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                for(const auto& t : types)
+                {
+                    gauge::config_set cs;
+                    cs.set_value<uint32_t>("symbols", s);
+                    cs.set_value<uint32_t>("symbol_size", p);
+                    cs.set_value<std::string>("type", t);
+
+                    add_configuration(cs);
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // Make the factories fit perfectly otherwise there seems to
+        // be problems with memory access i.e. when using a factory
+        // with max symbols 1024 with a symbols 16
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            symbols, symbol_size);
+
+        m_encoder_factory = std::make_shared<encoder_factory>(
+            symbols, symbol_size);
+
+        m_encoder = m_encoder_factory->build();
+        m_decoder = m_decoder_factory->build();
+
+        // Prepare the data to be encoded
+        m_encoded_data.resize(m_encoder->block_size());
+
+        for(uint8_t &e : m_encoded_data)
+        {
+            e = rand() % 256;
+        }
+
+        m_payload.resize(m_encoder->payload_size());
+
+        m_ticks_per_ns = kodo::cycle_counter_ticks_per_ns();
+    }
+
+    /// @param ticks A number of cycle counter ticks
+    /// @return The ticks in nanoseconds
+    uint64_t to_ns(uint64_t ticks) const
+    {
+        return static_cast<uint64_t>(ticks / m_ticks_per_ns);
+    }
+
+    /// Encodes and decodes a block recording the latency of every call
+    /// @param record_encoder True for recording the encode() calls,
+    ///        otherwise the decode() calls are recorded
+    void run_block(bool record_encoder)
+    {
+        m_encoder->initialize(*m_encoder_factory);
+        m_decoder->initialize(*m_decoder_factory);
+
+        m_encoder->set_symbols(sak::storage(m_encoded_data));
+
+        // We switch any systematic operations off so we code
+        // symbols from the beginning
+        if(kodo::is_systematic_encoder(m_encoder))
+            kodo::set_systematic_off(m_encoder);
+
+        while(!m_decoder->is_complete())
+        {
+            uint64_t start = kodo::read_cycle_counter();
+            m_encoder->encode(&m_payload[0]);
+            uint64_t stop = kodo::read_cycle_counter();
+
+            if(record_encoder)
+            {
+                m_latency.record(stop - start);
+            }
+
+            start = kodo::read_cycle_counter();
+            m_decoder->decode(&m_payload[0]);
+            stop = kodo::read_cycle_counter();
+
+            if(!record_encoder)
+            {
+                m_latency.record(stop - start);
+
+                if(m_decoder->is_complete())
+                {
+                    m_completion.record(stop - start);
+                }
+            }
+        }
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        assert(type == "encoder" || type == "decoder");
+
+        RUN{
+            run_block(type == "encoder");
+        }
+    }
+
+protected:
+
+    /// The decoder factory
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The encoder factory
+    std::shared_ptr<encoder_factory> m_encoder_factory;
+
+    /// The encoder to use
+    encoder_ptr m_encoder;
+
+    /// The decoder to use
+    decoder_ptr m_decoder;
+
+    /// The data encoded
+    std::vector<uint8_t> m_encoded_data;
+
+    /// The payload passed from the encoder to the decoder
+    std::vector<uint8_t> m_payload;
+
+    /// The latencies of the calls
+    latency_histogram m_latency;
+
+    /// The latencies of the decode() calls completing the decoding
+    latency_histogram m_completion;
+
+    /// The rate of the cycle counter
+    double m_ticks_per_ns;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(latency_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(32);
+    symbols.push_back(64);
+    symbols.push_back(128);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef latency_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_latency;
+
+BENCHMARK_F(setup_rlnc_latency, FullRLNC, Binary, 100)
+{
+    run_benchmark();
+}
+
+typedef latency_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_latency8;
+
+BENCHMARK_F(setup_rlnc_latency8, FullRLNC, Binary8, 100)
+{
+    run_benchmark();
+}
+
+typedef latency_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary16>,
+    kodo::full_rlnc_decoder<fifi::binary16> > setup_rlnc_latency16;
+
+BENCHMARK_F(setup_rlnc_latency16, FullRLNC, Binary16, 100)
+{
+    run_benchmark();
+}
+
+typedef latency_benchmark<
+   kodo::full_rlnc_encoder<fifi::binary>,
+   kodo::full_delayed_rlnc_decoder<fifi::binary> >
+   setup_delayed_rlnc_latency;
+
+BENCHMARK_F(setup_delayed_rlnc_latency, FullDelayedRLNC, Binary, 100)
+{
+   run_benchmark();
+}
+
+typedef latency_benchmark<
+   kodo::full_rlnc_encoder<fifi::binary8>,
+   kodo::full_delayed_rlnc_decoder<fifi::binary8> >
+   setup_delayed_rlnc_latency8;
+
+BENCHMARK_F(setup_delayed_rlnc_latency8, FullDelayedRLNC, Binary8, 100)
+{
+   run_benchmark();
+}
+
+typedef latency_benchmark<
+   kodo::full_rlnc_encoder<fifi::binary16>,
+   kodo::full_delayed_rlnc_decoder<fifi::binary16> >
+   setup_delayed_rlnc_latency16;
+
+BENCHMARK_F(setup_delayed_rlnc_latency16, FullDelayedRLNC, Binary16, 100)
+{
+   run_benchmark();
+}
+
+typedef latency_benchmark<
+   kodo::full_rlnc_encoder<fifi::binary8>,
+   kodo::full_rlnc_decoder_hybrid<fifi::binary8> >
+   setup_hybrid_rlnc_latency8;
+
+BENCHMARK_F(setup_hybrid_rlnc_latency8, FullHybridRLNC, Binary8, 100)
+{
+   run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
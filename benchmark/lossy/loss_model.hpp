@@ -0,0 +1,169 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+
+/// Decides which payloads of a link are lost. Three models are
+/// supported:
+///
+/// - bernoulli: every payload is lost independently with the erasure
+///   probability.
+/// - gilbert_elliott: a two state Markov chain, every payload sent in
+///   the bad state is lost and none in the good state. The transition
+///   probabilities are chosen so the average loss rate is the erasure
+///   probability and the mean length of a loss burst is the burst
+///   length.
+/// - trace: the losses are replayed from a captured trace, a text file
+///   where a '1' is a lost payload and a '0' a received payload, other
+///   characters are ignored. The trace is repeated when it ends.
+class loss_model
+{
+public:
+
+    /// Constructor
+    loss_model()
+        : m_type(bernoulli),
+          m_bad(false),
+          m_position(0)
+    { }
+
+    /// Seeds the random generator of the random models
+    /// @param seed The seed
+    void seed(uint32_t seed)
+    {
+        m_random_generator.seed(seed);
+    }
+
+    /// Uses independent losses
+    /// @param erasure The loss probability
+    void set_bernoulli(double erasure)
+    {
+        assert(erasure >= 0.0 && erasure < 1.0);
+
+        m_type = bernoulli;
+        m_loss = boost::random::bernoulli_distribution<>(erasure);
+    }
+
+    /// Uses bursts of losses
+    /// @param erasure The average loss probability
+    /// @param burst The mean number of consecutive losses, at least one
+    void set_gilbert_elliott(double erasure, double burst)
+    {
+        assert(erasure >= 0.0 && erasure < 1.0);
+        assert(burst >= 1.0);
+
+        // The chain leaves the bad state with 1 / burst, and enters it
+        // with the probability giving the stationary loss rate
+        double bad_to_good = 1.0 / burst;
+        double good_to_bad = erasure * bad_to_good / (1.0 - erasure);
+
+        assert(good_to_bad <= 1.0);
+
+        m_type = gilbert_elliott;
+        m_bad = false;
+        m_good_to_bad = boost::random::bernoulli_distribution<>(good_to_bad);
+        m_bad_to_good = boost::random::bernoulli_distribution<>(bad_to_good);
+    }
+
+    /// Replays the losses of a trace file
+    /// @param filename The trace file
+    /// @return True if the file was read and holds at least one payload
+    bool load_trace(const std::string &filename)
+    {
+        std::ifstream file(filename);
+
+        if(!file.is_open())
+            return false;
+
+        std::vector<bool> trace;
+        char c;
+
+        while(file.get(c))
+        {
+            if(c == '0' || c == '1')
+                trace.push_back(c == '1');
+        }
+
+        if(trace.empty())
+            return false;
+
+        m_type = replay;
+        m_trace.swap(trace);
+        m_position = 0;
+
+        return true;
+    }
+
+    /// @return True if the next payload is lost
+    bool lost()
+    {
+        switch(m_type)
+        {
+        case bernoulli:
+            return m_loss(m_random_generator);
+
+        case gilbert_elliott:
+            if(m_bad)
+            {
+                m_bad = !m_bad_to_good(m_random_generator);
+            }
+            else
+            {
+                m_bad = m_good_to_bad(m_random_generator);
+            }
+            return m_bad;
+
+        case replay:
+        default:
+            assert(!m_trace.empty());
+
+            bool is_lost = m_trace[m_position];
+            m_position = (m_position + 1) % m_trace.size();
+            return is_lost;
+        }
+    }
+
+private:
+
+    /// The models
+    enum model_type
+    {
+        bernoulli,
+        gilbert_elliott,
+        replay
+    };
+
+    /// The model used
+    model_type m_type;
+
+    /// The random generator of the random models
+    boost::random::mt19937 m_random_generator;
+
+    /// The losses of the Bernoulli model
+    boost::random::bernoulli_distribution<> m_loss;
+
+    /// The transitions of the Gilbert-Elliott model
+    boost::random::bernoulli_distribution<> m_good_to_bad;
+    boost::random::bernoulli_distribution<> m_bad_to_good;
+
+    /// True in the bad state of the Gilbert-Elliott model
+    bool m_bad;
+
+    /// The losses of the trace
+    std::vector<bool> m_trace;
+
+    /// The next payload of the trace
+    uint32_t m_position;
+
+};
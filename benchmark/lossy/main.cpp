@@ -0,0 +1,396 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/cycle_counter.hpp>
+
+#include "loss_model.hpp"
+
+/// Benchmark transferring blocks from a systematic encoder to a decoder
+/// over a lossy link, see loss_model. Unlike the throughput benchmark
+/// the decoder sees the mix of systematic and coded symbols of a lossy
+/// link, including the coded symbols arriving before systematic ones
+/// and the non-innovative symbols.
+///
+/// The encode() and decode() calls are timed with the cycle counter,
+/// and the cost is stored as cycles per byte of decoded data, i.e. per
+/// byte of goodput. The reception overhead is the number of received
+/// payloads beyond the number of symbols, relative to the number of
+/// symbols.
+template<class Encoder, class Decoder>
+struct lossy_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+
+    void start()
+    {
+        m_encode_cycles = 0;
+        m_decode_cycles = 0;
+        m_sent = 0;
+        m_received = 0;
+        m_non_innovative = 0;
+        m_blocks = 0;
+    }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+
+        assert(m_blocks > 0);
+
+        double blocks = double(m_blocks);
+        double goodput = blocks * m_encoder->block_size();
+
+        results.set_value("cycles_per_byte",
+            (m_encode_cycles + m_decode_cycles) / goodput);
+
+        results.set_value("encode_cycles_per_byte",
+                          m_encode_cycles / goodput);
+
+        results.set_value("decode_cycles_per_byte",
+                          m_decode_cycles / goodput);
+
+        results.set_value("overhead",
+            (m_received - blocks * symbols) / (blocks * symbols));
+
+        results.set_value("non_innovative", m_non_innovative / blocks);
+        results.set_value("sent", m_sent / blocks);
+        results.set_value("loss", 1.0 - m_received / double(m_sent));
+    }
+
+    std::string unit_text() const
+    {
+        return "cycles/byte";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto channels = options["channel"].as<std::vector<std::string> >();
+        auto erasure = options["erasure"].as<std::vector<double> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(channels.size() > 0);
+        assert(erasure.size() > 0);
+
+        m_burst = options["burst"].as<double>();
+        m_trace = options["trace"].as<std::string>();
+
+        assert(m_burst >= 1.0);
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                for(const auto& c : channels)
+                {
+                    assert(c == "bernoulli" || c == "gilbert_elliott" ||
+                           c == "trace");
+
+                    // The losses of a trace do not depend on the
+                    // erasure probability
+                    std::vector<double> rates = erasure;
+
+                    if(c == "trace")
+                    {
+                        rates.resize(1, 0.0);
+                    }
+
+                    for(const auto& e : rates)
+                    {
+                        assert(e < 1.0);
+
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("symbols", s);
+                        cs.set_value<uint32_t>("symbol_size", p);
+                        cs.set_value<std::string>("channel", c);
+                        cs.set_value<double>("erasure", e);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        std::string channel = cs.get_value<std::string>("channel");
+        double erasure = cs.get_value<double>("erasure");
+
+        m_encoder_factory = std::make_shared<encoder_factory>(
+            symbols, symbol_size);
+
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            symbols, symbol_size);
+
+        m_encoder = m_encoder_factory->build();
+        m_decoder = m_decoder_factory->build();
+
+        // Prepare the data to be encoded
+        m_encoded_data.resize(m_encoder->block_size());
+
+        for(uint8_t &e : m_encoded_data)
+        {
+            e = rand() % 256;
+        }
+
+        m_payload.resize(m_encoder->payload_size());
+
+        m_loss.seed(static_cast<uint32_t>(time(0)));
+
+        if(channel == "bernoulli")
+        {
+            m_loss.set_bernoulli(erasure);
+        }
+        else if(channel == "gilbert_elliott")
+        {
+            m_loss.set_gilbert_elliott(erasure, m_burst);
+        }
+        else
+        {
+            bool loaded = m_loss.load_trace(m_trace);
+            assert(loaded && "The --trace file could not be read");
+            (void) loaded;
+        }
+    }
+
+    /// Transfers a block over the link
+    void transfer_block()
+    {
+        m_encoder->initialize(*m_encoder_factory);
+        m_decoder->initialize(*m_decoder_factory);
+
+        m_encoder->set_symbols(sak::storage(m_encoded_data));
+
+        while(!m_decoder->is_complete())
+        {
+            uint64_t start = kodo::read_cycle_counter();
+            m_encoder->encode(&m_payload[0]);
+            uint64_t stop = kodo::read_cycle_counter();
+
+            m_encode_cycles += stop - start;
+            ++m_sent;
+
+            if(m_loss.lost())
+                continue;
+
+            uint32_t rank = m_decoder->rank();
+
+            start = kodo::read_cycle_counter();
+            m_decoder->decode(&m_payload[0]);
+            stop = kodo::read_cycle_counter();
+
+            m_decode_cycles += stop - start;
+            ++m_received;
+
+            if(m_decoder->rank() == rank)
+            {
+                ++m_non_innovative;
+            }
+        }
+
+        ++m_blocks;
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        RUN{
+            transfer_block();
+        }
+    }
+
+protected:
+
+    /// The encoder factory
+    std::shared_ptr<encoder_factory> m_encoder_factory;
+
+    /// The decoder factory
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The encoder
+    encoder_ptr m_encoder;
+
+    /// The decoder
+    decoder_ptr m_decoder;
+
+    /// The data encoded
+    std::vector<uint8_t> m_encoded_data;
+
+    /// The payload passed over the link
+    std::vector<uint8_t> m_payload;
+
+    /// The losses of the link
+    loss_model m_loss;
+
+    /// The mean burst length of the Gilbert-Elliott channel
+    double m_burst;
+
+    /// The trace file of the trace channel
+    std::string m_trace;
+
+    /// The cycles spent in encode()
+    double m_encode_cycles;
+
+    /// The cycles spent in decode()
+    double m_decode_cycles;
+
+    /// The number of payloads sent by the encoder
+    uint64_t m_sent;
+
+    /// The number of payloads received by the decoder
+    uint64_t m_received;
+
+    /// The number of received payloads which were not innovative
+    uint64_t m_non_innovative;
+
+    /// The number of blocks transferred
+    uint32_t m_blocks;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(lossy_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(64);
+    symbols.push_back(128);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> channels;
+    channels.push_back("bernoulli");
+    channels.push_back("gilbert_elliott");
+
+    auto default_channels =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            channels, "")->multitoken();
+
+    std::vector<double> erasure;
+    erasure.push_back(0.05);
+    erasure.push_back(0.2);
+
+    auto default_erasure =
+        gauge::po::value<std::vector<double> >()->default_value(
+            erasure, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("channel", default_channels,
+         "Set the loss model [bernoulli|gilbert_elliott|trace]");
+
+    options.add_options()
+        ("erasure", default_erasure,
+         "Set the average erasure probability of the link");
+
+    options.add_options()
+        ("burst", gauge::po::value<double>()->default_value(4.0),
+         "Set the mean burst length of the gilbert_elliott channel");
+
+    options.add_options()
+        ("trace", gauge::po::value<std::string>()->default_value(""),
+         "Set the loss trace file of the trace channel, a '1' is a "
+         "lost payload and a '0' a received payload");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef lossy_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_lossy;
+
+BENCHMARK_F(setup_rlnc_lossy, FullRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef lossy_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_lossy8;
+
+BENCHMARK_F(setup_rlnc_lossy8, FullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef lossy_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary16>,
+    kodo::full_rlnc_decoder<fifi::binary16> > setup_rlnc_lossy16;
+
+BENCHMARK_F(setup_rlnc_lossy16, FullRLNC, Binary16, 5)
+{
+    run_benchmark();
+}
+
+typedef lossy_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_delayed_rlnc_decoder<fifi::binary8> >
+    setup_delayed_rlnc_lossy8;
+
+BENCHMARK_F(setup_delayed_rlnc_lossy8, FullDelayedRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/// The number of bytes currently allocated with operator new. The
+/// counter is updated by the replacement operator new and operator
+/// delete, which must be defined once in the program by including
+/// heap_usage.hpp with KODO_DEFINE_TRACKING_ALLOCATOR defined.
+inline std::atomic<int64_t>& tracked_bytes()
+{
+    static std::atomic<int64_t> bytes(0);
+    return bytes;
+}
+
+/// The number of calls of operator new, updated by the replacement
+/// operator new like tracked_bytes()
+inline std::atomic<uint64_t>& tracked_allocations()
+{
+    static std::atomic<uint64_t> allocations(0);
+    return allocations;
+}
+
+/// @return The number of allocations done with operator new so far
+inline uint64_t tracked_allocation_count()
+{
+    return tracked_allocations().load();
+}
+
+/// @return The bytes allocated with operator new, i.e. by the
+///         std::allocator of the standard containers and by
+///         boost::make_shared
+inline int64_t tracked_heap_bytes()
+{
+    return tracked_bytes().load();
+}
+
+/// @return The bytes in use by the malloc heap with glibc, which also
+///         covers the aligned allocations not done through operator
+///         new and the allocator overheads, zero on other platforms
+inline int64_t process_heap_bytes()
+{
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 33)
+    return static_cast<int64_t>(mallinfo2().uordblks);
+#else
+    return static_cast<int64_t>(static_cast<unsigned int>(
+        mallinfo().uordblks));
+#endif
+#else
+    return 0;
+#endif
+}
+
+#if defined(KODO_DEFINE_TRACKING_ALLOCATOR)
+
+namespace
+{
+    /// The size in front of every allocation, keeping the alignment of
+    /// the allocations returned
+    const std::size_t tracking_header_size = 16;
+
+    void* tracking_allocate(std::size_t size)
+    {
+        void *data = std::malloc(size + tracking_header_size);
+
+        if(data == 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        *static_cast<std::size_t*>(data) = size;
+        tracked_bytes() += static_cast<int64_t>(size);
+        ++tracked_allocations();
+
+        return static_cast<uint8_t*>(data) + tracking_header_size;
+    }
+
+    void tracking_deallocate(void *ptr)
+    {
+        if(ptr == 0)
+        {
+            return;
+        }
+
+        void *data = static_cast<uint8_t*>(ptr) - tracking_header_size;
+        tracked_bytes() -= static_cast<int64_t>(
+            *static_cast<std::size_t*>(data));
+
+        std::free(data);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return tracking_allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return tracking_allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    tracking_deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    tracking_deallocate(ptr);
+}
+
+#endif
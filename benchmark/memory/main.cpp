@@ -0,0 +1,488 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+#include <kodo/nocode/carousel_codes.hpp>
+
+// Replaces the global operator new and delete of the benchmark with
+// the tracking allocator
+#define KODO_DEFINE_TRACKING_ALLOCATOR
+#include "heap_usage.hpp"
+
+/// Benchmark measuring the heap memory used by the factory of a coder
+/// stack and by the coders it builds. A number of coders are built
+/// and kept alive together, so the bytes per coder include everything
+/// a coder allocates in construct() and initialize(). The coders are
+/// then released into the pool of the factory and built again, which
+/// shows the memory kept by the pool and that the reused coders do not
+/// allocate.
+///
+/// The bytes are measured both with the tracking operator new of the
+/// benchmark, which sees the standard containers, and with the glibc
+/// malloc statistics, which also see the aligned allocations and the
+/// allocator overheads. The malloc statistics count the small chunks
+/// cached by malloc as free, so they are approximate for small
+/// allocations such as the factories.
+template<class Coder>
+struct memory_benchmark : public gauge::benchmark
+{
+
+    typedef typename Coder::factory factory_type;
+    typedef typename Coder::pointer pointer_type;
+
+    /// The heap usage at a point of the benchmark
+    struct heap_sample
+    {
+        heap_sample()
+            : m_tracked(tracked_heap_bytes()),
+              m_process(process_heap_bytes())
+        { }
+
+        /// The bytes allocated with operator new
+        int64_t m_tracked;
+
+        /// The bytes in use by the malloc heap
+        int64_t m_process;
+    };
+
+    void start()
+    { }
+
+    void stop()
+    { }
+
+    /// Stores the difference of two samples
+    /// @param results The result table
+    /// @param name The name of the column
+    /// @param before The sample before the allocations
+    /// @param after The sample after the allocations
+    /// @param count The number of objects allocated
+    void store_bytes(gauge::table& results, const std::string &name,
+                     const heap_sample &before, const heap_sample &after,
+                     uint32_t count)
+    {
+        assert(count > 0);
+
+        results.set_value(name,
+            (after.m_tracked - before.m_tracked) / double(count));
+
+        results.set_value(name + "_heap",
+            (after.m_process - before.m_process) / double(count));
+    }
+
+    void store_run(gauge::table& results)
+    {
+        results.set_value("block_size", m_block_size);
+
+        store_bytes(results, "factory", m_start, m_factory, 1);
+        store_bytes(results, "coder", m_factory, m_built, m_coders);
+        store_bytes(results, "pool", m_factory, m_released, m_coders);
+        store_bytes(results, "reused", m_released, m_rebuilt, m_coders);
+    }
+
+    std::string unit_text() const
+    {
+        return "byte";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+
+        m_coders = options["coders"].as<uint32_t>();
+        assert(m_coders > 0);
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("symbols", s);
+                cs.set_value<uint32_t>("symbol_size", p);
+                add_configuration(cs);
+            }
+        }
+    }
+
+    void setup()
+    { }
+
+    /// Builds and releases the coders and samples the heap usage
+    void measure()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        std::vector<pointer_type> coders;
+        coders.reserve(m_coders);
+
+        m_start = heap_sample();
+
+        {
+            // Make the factory fit perfectly, so the coders are sized
+            // for the measured configuration
+            auto factory =
+                std::make_shared<factory_type>(symbols, symbol_size);
+
+            m_factory = heap_sample();
+
+            for(uint32_t i = 0; i < m_coders; ++i)
+            {
+                coders.push_back(factory->build());
+            }
+
+            m_built = heap_sample();
+            m_block_size = coders[0]->block_size();
+
+            coders.clear();
+            m_released = heap_sample();
+
+            for(uint32_t i = 0; i < m_coders; ++i)
+            {
+                coders.push_back(factory->build());
+            }
+
+            m_rebuilt = heap_sample();
+
+            coders.clear();
+        }
+
+        // Everything should be released with the factory
+        assert(tracked_heap_bytes() == m_start.m_tracked);
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        RUN{
+            measure();
+        }
+    }
+
+protected:
+
+    /// The number of coders built from the factory
+    uint32_t m_coders;
+
+    /// The block size of the coders
+    uint32_t m_block_size;
+
+    /// The heap usage before the factory is constructed
+    heap_sample m_start;
+
+    /// The heap usage with the factory constructed
+    heap_sample m_factory;
+
+    /// The heap usage with the coders built
+    heap_sample m_built;
+
+    /// The heap usage with the coders released into the pool
+    heap_sample m_released;
+
+    /// The heap usage with the coders built again from the pool
+    heap_sample m_rebuilt;
+
+};
+
+/// Benchmark counting the allocations done per operation by an
+/// encoder and decoder built from warm factory pools. A first block is
+/// decoded to construct the coders, a second block is then decoded
+/// counting the allocations of build(), encode() and decode(). All
+/// the counts are expected to be zero.
+template<class Encoder, class Decoder>
+struct allocation_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Decoder::factory decoder_factory;
+
+    void start()
+    { }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        results.set_value("build", m_build / 2.0);
+        results.set_value("encode", m_encode / double(m_payloads));
+        results.set_value("decode", m_decode / double(m_payloads));
+    }
+
+    std::string unit_text() const
+    {
+        return "allocations";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("symbols", s);
+                cs.set_value<uint32_t>("symbol_size", p);
+                add_configuration(cs);
+            }
+        }
+    }
+
+    void setup()
+    { }
+
+    /// Decodes a block and counts the allocations of every operation
+    /// @param encoders The factory of the encoder
+    /// @param decoders The factory of the decoder
+    /// @param payload The buffer for the payloads
+    void run_block(encoder_factory &encoders, decoder_factory &decoders,
+                   std::vector<uint8_t> &payload)
+    {
+        m_build = 0;
+        m_encode = 0;
+        m_decode = 0;
+        m_payloads = 0;
+
+        uint64_t before = tracked_allocation_count();
+
+        auto encoder = encoders.build();
+        auto decoder = decoders.build();
+
+        m_build = tracked_allocation_count() - before;
+
+        // The content of the data does not change the allocations
+        encoder->set_symbols(sak::storage(m_data));
+
+        while(!decoder->is_complete())
+        {
+            before = tracked_allocation_count();
+            encoder->encode(&payload[0]);
+            m_encode += tracked_allocation_count() - before;
+
+            before = tracked_allocation_count();
+            decoder->decode(&payload[0]);
+            m_decode += tracked_allocation_count() - before;
+
+            ++m_payloads;
+        }
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        encoder_factory encoders(symbols, symbol_size);
+        decoder_factory decoders(symbols, symbol_size);
+
+        std::vector<uint8_t> payload(encoders.max_payload_size());
+        m_data.resize(symbols * symbol_size);
+
+        // Constructs the coders in the pools of the factories
+        run_block(encoders, decoders, payload);
+
+        RUN{
+            run_block(encoders, decoders, payload);
+        }
+    }
+
+protected:
+
+    /// The data encoded
+    std::vector<uint8_t> m_data;
+
+    /// The allocations of building the encoder and decoder
+    uint64_t m_build;
+
+    /// The allocations of the encode() calls
+    uint64_t m_encode;
+
+    /// The allocations of the decode() calls
+    uint64_t m_decode;
+
+    /// The number of payloads of the block
+    uint32_t m_payloads;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(memory_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(32);
+    symbols.push_back(64);
+    symbols.push_back(128);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("coders", gauge::po::value<uint32_t>()->default_value(16),
+         "Set the number of coders built from a factory");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef memory_benchmark<kodo::full_rlnc_encoder<fifi::binary8> >
+    setup_rlnc_encoder_memory8;
+
+BENCHMARK_F(setup_rlnc_encoder_memory8, FullRLNCEncoder, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::shared_full_rlnc_encoder<fifi::binary8> >
+    setup_shared_rlnc_encoder_memory8;
+
+BENCHMARK_F(setup_shared_rlnc_encoder_memory8,
+            SharedFullRLNCEncoder, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::full_rlnc_decoder<fifi::binary> >
+    setup_rlnc_decoder_memory;
+
+BENCHMARK_F(setup_rlnc_decoder_memory, FullRLNCDecoder, Binary, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::full_rlnc_decoder<fifi::binary8> >
+    setup_rlnc_decoder_memory8;
+
+BENCHMARK_F(setup_rlnc_decoder_memory8, FullRLNCDecoder, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::full_rlnc_decoder<fifi::binary16> >
+    setup_rlnc_decoder_memory16;
+
+BENCHMARK_F(setup_rlnc_decoder_memory16, FullRLNCDecoder, Binary16, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::seed_rlnc_decoder<fifi::binary8> >
+    setup_seed_rlnc_decoder_memory8;
+
+BENCHMARK_F(setup_seed_rlnc_decoder_memory8, SeedRLNCDecoder, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::rs_decoder<fifi::binary8> >
+    setup_rs_decoder_memory8;
+
+BENCHMARK_F(setup_rs_decoder_memory8, RSDecoder, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef memory_benchmark<kodo::nocode_carousel_decoder>
+    setup_carousel_decoder_memory;
+
+BENCHMARK_F(setup_carousel_decoder_memory, CarouselDecoder, Binary, 1)
+{
+    run_benchmark();
+}
+
+typedef allocation_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_allocations8;
+
+BENCHMARK_F(setup_rlnc_allocations8, FullRLNCAllocations, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef allocation_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary8>,
+    kodo::seed_rlnc_decoder<fifi::binary8> > setup_seed_rlnc_allocations8;
+
+BENCHMARK_F(setup_seed_rlnc_allocations8, SeedRLNCAllocations, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef allocation_benchmark<
+    kodo::rs_encoder<fifi::binary8>,
+    kodo::rs_decoder<fifi::binary8> > setup_rs_allocations8;
+
+BENCHMARK_F(setup_rs_allocations8, RSAllocations, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef allocation_benchmark<kodo::nocode_carousel_encoder,
+    kodo::nocode_carousel_decoder> setup_carousel_allocations;
+
+BENCHMARK_F(setup_carousel_allocations, CarouselAllocations, Binary, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
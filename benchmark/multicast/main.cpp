@@ -0,0 +1,602 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <fifi/fifi_utils.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/cycle_counter.hpp>
+
+/// Benchmark simulating one systematic encoder multicasting a block to
+/// a group of receivers, each losing payloads independently with the
+/// erasure probability. The result is the cost of the encoder for the
+/// group until the target fraction of the receivers has decoded the
+/// block, in payloads sent and in cycles spent encoding them.
+///
+/// The receivers only keep the coefficients of what they received, in
+/// a decoder with symbols of a single field element, so groups of up to
+/// some 100k receivers fit in memory. The encoder codes the real
+/// symbols, so its cycles are those of a real sender. The payloads are
+/// sent in batches and the receivers of a batch are simulated in
+/// parallel, a slice of the group on every core.
+///
+/// Two modes are compared:
+///
+/// - open: no feedback, the systematic symbols are followed by coded
+///   symbols of the whole block until enough receivers are done.
+/// - feedback: after every round the encoder learns the missing ranks
+///   of the receivers. The next round has as many coded symbols as the
+///   receiver at the target fraction misses, and the symbols only
+///   combine the source symbols some receiver still misses, so the
+///   encoder reads fewer source symbols than in the open mode.
+template<class Encoder, class Decoder>
+struct multicast_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+
+    typedef typename Encoder::field_type field_type;
+    typedef typename Encoder::value_type value_type;
+
+    /// A payload of a batch, as seen by the receivers
+    struct packet
+    {
+        /// True if the packet is the uncoded symbol of the index
+        bool m_systematic;
+
+        /// The index of an uncoded symbol
+        uint32_t m_index;
+
+        /// The coefficients of a coded symbol
+        std::vector<uint8_t> m_coefficients;
+    };
+
+    void start()
+    {
+        m_sent = 0;
+        m_needed = 0;
+        m_rounds = 0;
+        m_encode_cycles = 0;
+        m_simulations = 0;
+    }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+
+        assert(m_simulations > 0);
+
+        double simulations = double(m_simulations);
+        double block_size = double(m_encoder->block_size());
+
+        results.set_value("needed", m_needed / simulations);
+        results.set_value("sent", m_sent / simulations);
+        results.set_value("rounds", m_rounds / simulations);
+
+        results.set_value("overhead",
+            (m_needed / simulations - symbols) / symbols);
+
+        results.set_value("encode_cycles_per_byte",
+                          m_encode_cycles / (simulations * block_size));
+    }
+
+    std::string unit_text() const
+    {
+        return "payloads";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto receivers = options["receivers"].as<std::vector<uint32_t> >();
+        auto erasure = options["erasure"].as<std::vector<double> >();
+        auto modes = options["mode"].as<std::vector<std::string> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(receivers.size() > 0);
+        assert(erasure.size() > 0);
+        assert(modes.size() > 0);
+
+        m_target = options["target"].as<double>();
+        m_threads = options["threads"].as<uint32_t>();
+
+        assert(m_target > 0.0 && m_target <= 1.0);
+
+        if(m_threads == 0)
+        {
+            m_threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                for(const auto& r : receivers)
+                {
+                    for(const auto& e : erasure)
+                    {
+                        for(const auto& m : modes)
+                        {
+                            assert(r > 0);
+                            assert(e < 1.0);
+                            assert(m == "open" || m == "feedback");
+
+                            gauge::config_set cs;
+                            cs.set_value<uint32_t>("symbols", s);
+                            cs.set_value<uint32_t>("symbol_size", p);
+                            cs.set_value<uint32_t>("receivers", r);
+                            cs.set_value<double>("erasure", e);
+                            cs.set_value<std::string>("mode", m);
+
+                            add_configuration(cs);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t receivers = cs.get_value<uint32_t>("receivers");
+
+        m_encoder_factory = std::make_shared<encoder_factory>(
+            symbols, symbol_size);
+
+        m_encoder = m_encoder_factory->build();
+
+        // The receivers only decode the coefficients
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            symbols, uint32_t(sizeof(value_type)));
+
+        m_decoders.resize(receivers);
+
+        for(auto& d : m_decoders)
+        {
+            d = m_decoder_factory->build();
+        }
+
+        m_completed.resize(receivers);
+
+        m_encoded_data.resize(m_encoder->block_size());
+
+        for(uint8_t &e : m_encoded_data)
+        {
+            e = rand() % 256;
+        }
+
+        m_symbol.resize(m_encoder->symbol_size());
+    }
+
+    /// Encodes the payloads of a batch and times the encoder
+    /// @param count The number of payloads
+    /// @param sparse True if the coded symbols only combine the
+    ///        symbols in m_missing
+    void encode_batch(uint32_t count, bool sparse)
+    {
+        uint32_t symbols = m_encoder->symbols();
+
+        m_batch.resize(count);
+
+        for(auto& p : m_batch)
+        {
+            uint64_t start = kodo::read_cycle_counter();
+
+            if(m_systematic < symbols)
+            {
+                p.m_systematic = true;
+                p.m_index = m_systematic++;
+
+                m_encoder->encode_symbol(&m_symbol[0], p.m_index);
+            }
+            else
+            {
+                p.m_systematic = false;
+                p.m_coefficients.resize(m_encoder->coefficients_size());
+
+                value_type *c = reinterpret_cast<value_type*>(
+                    &p.m_coefficients[0]);
+
+                m_encoder->generate(&p.m_coefficients[0]);
+
+                // The encoder skips the zero coefficients
+                for(uint32_t i = 0; sparse && i < symbols; ++i)
+                {
+                    if(!m_missing[i])
+                        fifi::set_value<field_type>(c, i, 0);
+                }
+
+                m_encoder->encode_symbol(&m_symbol[0],
+                                         &p.m_coefficients[0]);
+            }
+
+            m_encode_cycles += kodo::read_cycle_counter() - start;
+        }
+    }
+
+    /// Delivers the batch to a slice of the receivers
+    /// @param first The first receiver of the slice
+    /// @param last The receiver after the slice
+    /// @param seed The seed of the losses of the slice
+    void receive_batch(uint32_t first, uint32_t last, uint32_t seed)
+    {
+        gauge::config_set cs = get_current_configuration();
+        double erasure = cs.get_value<double>("erasure");
+
+        boost::random::mt19937 generator(seed);
+        boost::random::bernoulli_distribution<> lost(erasure);
+
+        std::vector<uint8_t> symbol(sizeof(value_type), 0);
+        std::vector<uint8_t> coefficients;
+
+        for(uint32_t r = first; r < last; ++r)
+        {
+            decoder_ptr &decoder = m_decoders[r];
+
+            for(uint32_t i = 0; i < m_batch.size(); ++i)
+            {
+                if(decoder->is_complete())
+                    break;
+
+                if(lost(generator))
+                    continue;
+
+                const packet &p = m_batch[i];
+
+                if(p.m_systematic)
+                {
+                    decoder->decode_symbol(&symbol[0], p.m_index);
+                }
+                else
+                {
+                    // The decoder eliminates in the coefficients
+                    coefficients = p.m_coefficients;
+                    decoder->decode_symbol(&symbol[0], &coefficients[0]);
+                }
+
+                if(decoder->is_complete())
+                    m_completed[r] = m_sent + i + 1;
+            }
+        }
+    }
+
+    /// Delivers the batch to all receivers in parallel
+    void receive_batch()
+    {
+        uint32_t receivers = static_cast<uint32_t>(m_decoders.size());
+        uint32_t threads = std::min(m_threads, receivers);
+        uint32_t seed = rand();
+
+        std::vector<std::thread> workers;
+
+        for(uint32_t t = 0; t < threads; ++t)
+        {
+            uint32_t first = uint32_t(uint64_t(receivers) * t / threads);
+            uint32_t last =
+                uint32_t(uint64_t(receivers) * (t + 1) / threads);
+
+            workers.push_back(std::thread(
+                [this, first, last, seed, t]()
+                {
+                    receive_batch(first, last, seed + t);
+                }));
+        }
+
+        for(auto& w : workers)
+        {
+            w.join();
+        }
+
+        m_sent += static_cast<uint32_t>(m_batch.size());
+    }
+
+    /// @return The number of receivers that must decode the block
+    uint32_t target_receivers() const
+    {
+        return std::max(1U, static_cast<uint32_t>(
+            std::ceil(m_target * m_decoders.size())));
+    }
+
+    /// @return The number of receivers which decoded the block
+    uint32_t completed_receivers() const
+    {
+        uint32_t completed = 0;
+
+        for(const auto& d : m_decoders)
+        {
+            completed += d->is_complete() ? 1 : 0;
+        }
+
+        return completed;
+    }
+
+    /// Collects the feedback of the receivers: the source symbols some
+    /// incomplete receiver misses, in m_missing
+    /// @return The number of coded symbols the receiver at the target
+    ///         fraction misses, i.e. the size of the next round
+    uint32_t collect_feedback()
+    {
+        uint32_t symbols = m_encoder->symbols();
+
+        m_missing.assign(symbols, false);
+
+        std::vector<uint32_t> deficits;
+        deficits.reserve(m_decoders.size());
+
+        for(const auto& d : m_decoders)
+        {
+            deficits.push_back(symbols - d->rank());
+
+            if(d->is_complete())
+                continue;
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(!d->symbol_pivot(i))
+                    m_missing[i] = true;
+            }
+        }
+
+        auto target = deficits.begin() + (target_receivers() - 1);
+        std::nth_element(deficits.begin(), target, deficits.end());
+
+        return std::max(1U, *target);
+    }
+
+    /// Runs one simulation of the group
+    void simulate()
+    {
+        gauge::config_set cs = get_current_configuration();
+        bool feedback = cs.get_value<std::string>("mode") == "feedback";
+
+        m_encoder->initialize(*m_encoder_factory);
+        m_encoder->set_symbols(sak::storage(m_encoded_data));
+
+        for(auto& d : m_decoders)
+        {
+            d->initialize(*m_decoder_factory);
+        }
+
+        std::fill(m_completed.begin(), m_completed.end(),
+                  std::numeric_limits<uint64_t>::max());
+
+        uint32_t symbols = m_encoder->symbols();
+        uint64_t sent = m_sent;
+
+        m_systematic = 0;
+
+        // The first round is the systematic symbols
+        uint32_t round = symbols;
+
+        while(completed_receivers() < target_receivers())
+        {
+            encode_batch(round, feedback && m_systematic == symbols);
+            receive_batch();
+
+            ++m_rounds;
+
+            if(feedback)
+            {
+                round = collect_feedback();
+            }
+            else
+            {
+                // Without feedback the encoder streams, the batches
+                // only bound the time between the checks
+                round = std::max(1U, symbols / 4);
+            }
+        }
+
+        // The payloads after which the target fraction was done
+        std::vector<uint64_t> completed = m_completed;
+
+        auto target = completed.begin() + (target_receivers() - 1);
+        std::nth_element(completed.begin(), target, completed.end());
+
+        m_needed += *target - sent;
+        ++m_simulations;
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        RUN{
+            simulate();
+        }
+    }
+
+protected:
+
+    /// The encoder factory
+    std::shared_ptr<encoder_factory> m_encoder_factory;
+
+    /// The decoder factory of the receivers
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The encoder
+    encoder_ptr m_encoder;
+
+    /// The coefficient-only decoders of the receivers
+    std::vector<decoder_ptr> m_decoders;
+
+    /// The payload count after which every receiver decoded the block
+    std::vector<uint64_t> m_completed;
+
+    /// The data encoded
+    std::vector<uint8_t> m_encoded_data;
+
+    /// The symbol encoded by the encoder
+    std::vector<uint8_t> m_symbol;
+
+    /// The payloads of the current batch
+    std::vector<packet> m_batch;
+
+    /// The source symbols some incomplete receiver misses
+    std::vector<bool> m_missing;
+
+    /// The number of systematic symbols sent in the simulation
+    uint32_t m_systematic;
+
+    /// The fraction of the receivers which must decode the block
+    double m_target;
+
+    /// The number of threads simulating the receivers
+    uint32_t m_threads;
+
+    /// The number of payloads sent by the encoder
+    uint64_t m_sent;
+
+    /// The number of payloads sent until the target fraction of the
+    /// receivers decoded the block
+    double m_needed;
+
+    /// The number of batches sent
+    uint64_t m_rounds;
+
+    /// The cycles spent encoding
+    double m_encode_cycles;
+
+    /// The number of simulations run
+    uint32_t m_simulations;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(multicast_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(64);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1400);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<uint32_t> receivers;
+    receivers.push_back(1000);
+    receivers.push_back(10000);
+    receivers.push_back(100000);
+
+    auto default_receivers =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            receivers, "")->multitoken();
+
+    std::vector<double> erasure;
+    erasure.push_back(0.01);
+    erasure.push_back(0.1);
+
+    auto default_erasure =
+        gauge::po::value<std::vector<double> >()->default_value(
+            erasure, "")->multitoken();
+
+    std::vector<std::string> modes;
+    modes.push_back("open");
+    modes.push_back("feedback");
+
+    auto default_modes =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            modes, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("receivers", default_receivers, "Set the number of receivers");
+
+    options.add_options()
+        ("erasure", default_erasure,
+         "Set the erasure probability of every receiver");
+
+    options.add_options()
+        ("mode", default_modes, "Set the encoding mode [open|feedback]");
+
+    options.add_options()
+        ("target", gauge::po::value<double>()->default_value(0.99),
+         "Set the fraction of the receivers which must decode the block");
+
+    options.add_options()
+        ("threads", gauge::po::value<uint32_t>()->default_value(0),
+         "Set the threads simulating the receivers, 0 for one per core");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef multicast_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_multicast;
+
+BENCHMARK_F(setup_rlnc_multicast, FullRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef multicast_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_multicast8;
+
+BENCHMARK_F(setup_rlnc_multicast8, FullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
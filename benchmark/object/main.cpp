@@ -0,0 +1,575 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/object_encoder.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/file_encoder.hpp>
+#include <kodo/file_decoder.hpp>
+#include <kodo/random_annex_encoder.hpp>
+#include <kodo/random_annex_decoder.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+
+/// Accumulates the time spent in a phase of the transfer
+struct phase_timer
+{
+    typedef std::chrono::high_resolution_clock clock_type;
+
+    phase_timer()
+        : m_time(0)
+    { }
+
+    /// Starts timing the phase
+    void start()
+    {
+        m_start = clock_type::now();
+    }
+
+    /// Stops timing the phase and adds the elapsed time
+    void stop()
+    {
+        m_time += std::chrono::duration<double>(
+            clock_type::now() - m_start).count();
+    }
+
+    /// The start of the current timing
+    clock_type::time_point m_start;
+
+    /// The accumulated time in seconds
+    double m_time;
+};
+
+/// Benchmark transferring an object end-to-end through the object
+/// layers: the object is read into the encoders of its blocks, encoded,
+/// passed through a channel erasing the payloads with the erasure
+/// probability, decoded and written to the output. The source is a
+/// memory buffer through the object_encoder and storage_reader, a file
+/// through the file_encoder and file_decoder, or a memory buffer
+/// through the random_annex_encoder and random_annex_decoder.
+///
+/// Besides the end-to-end throughput the time spent reading, encoding,
+/// decoding and writing is stored, so the overhead of the partitioning
+/// and the I/O can be compared with the coding. Building the encoders
+/// counts as reading since the object data is read into them. The
+/// object size is limited to 4 GB by the 32 bit sizes of the object
+/// layers.
+template<class Encoder, class Decoder>
+struct object_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+
+    object_benchmark()
+    {
+        // Seed the random generator controlling the erasures
+        m_random_generator.seed((uint64_t)time(0));
+    }
+
+    void start()
+    {
+        m_read = phase_timer();
+        m_encode = phase_timer();
+        m_decode = phase_timer();
+        m_write = phase_timer();
+        m_total = phase_timer();
+        m_payloads = 0;
+    }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t object_size = cs.get_value<uint32_t>("object_size");
+
+        double megabytes = object_size / 1000000.0;
+
+        results.set_value("throughput", megabytes / m_total.m_time);
+        results.set_value("read_time", m_read.m_time);
+        results.set_value("encode_time", m_encode.m_time);
+        results.set_value("decode_time", m_decode.m_time);
+        results.set_value("write_time", m_write.m_time);
+        results.set_value("total_time", m_total.m_time);
+        results.set_value("payloads", m_payloads);
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto object_size =
+            options["object_size"].as<std::vector<uint32_t> >();
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto erasure = options["erasure"].as<std::vector<double> >();
+        auto sources = options["source"].as<std::vector<std::string> >();
+
+        assert(object_size.size() > 0);
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(erasure.size() > 0);
+        assert(sources.size() > 0);
+
+        m_filename = options["object_file"].as<std::string>();
+
+        for(const auto& o : object_size)
+        {
+            for(const auto& s : symbols)
+            {
+                for(const auto& p : symbol_size)
+                {
+                    for(const auto& e : erasure)
+                    {
+                        for(const auto& source : sources)
+                        {
+                            gauge::config_set cs;
+                            cs.set_value<uint32_t>("object_size", o);
+                            cs.set_value<uint32_t>("symbols", s);
+                            cs.set_value<uint32_t>("symbol_size", p);
+                            cs.set_value<double>("erasure", e);
+                            cs.set_value<std::string>("source", source);
+
+                            add_configuration(cs);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t object_size = cs.get_value<uint32_t>("object_size");
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        std::string source = cs.get_value<std::string>("source");
+
+        assert(object_size > 0);
+
+        m_encoder_factory = std::make_shared<encoder_factory>(
+            symbols, symbol_size);
+
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            symbols, symbol_size);
+
+        m_data_in.resize(object_size);
+
+        for(uint8_t &e : m_data_in)
+        {
+            e = rand() % 256;
+        }
+
+        m_data_out.resize(object_size);
+
+        if(source == "file")
+        {
+            std::ofstream file(m_filename.c_str(), std::ios::binary);
+            assert(file.is_open());
+
+            file.write(reinterpret_cast<const char*>(&m_data_in[0]),
+                       m_data_in.size());
+        }
+
+        double erasure = cs.get_value<double>("erasure");
+        m_distribution = boost::random::bernoulli_distribution<>(erasure);
+    }
+
+    void tear_down()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string source = cs.get_value<std::string>("source");
+
+        if(source == "file")
+        {
+            std::remove(m_filename.c_str());
+            std::remove(output_filename().c_str());
+        }
+    }
+
+    /// @return The name of the file written by the file decoder
+    std::string output_filename() const
+    {
+        return m_filename + ".out";
+    }
+
+    /// Encodes and decodes a block until the decoder is complete, the
+    /// encoded payloads are erased with the erasure probability
+    /// @param encoder The encoder of the block
+    /// @param decoder The decoder of the block
+    template<class EncoderPointer, class DecoderPointer>
+    void transfer_block(EncoderPointer &encoder, DecoderPointer &decoder)
+    {
+        assert(encoder->payload_size() == decoder->payload_size());
+
+        m_payload.resize(encoder->payload_size());
+
+        while(!decoder->is_complete())
+        {
+            m_encode.start();
+            encoder->encode(&m_payload[0]);
+            m_encode.stop();
+
+            ++m_payloads;
+
+            if(m_distribution(m_random_generator))
+                continue;
+
+            m_decode.start();
+            decoder->decode(&m_payload[0]);
+            m_decode.stop();
+        }
+    }
+
+    /// Transfers the object from and to memory buffers through the
+    /// object_encoder and object_decoder
+    void transfer_storage()
+    {
+        typedef kodo::object_encoder<
+            kodo::storage_reader<Encoder>, Encoder> object_encoder_type;
+
+        typedef kodo::object_decoder<Decoder> object_decoder_type;
+
+        m_read.start();
+        object_encoder_type object_encoder(
+            *m_encoder_factory,
+            kodo::storage_reader<Encoder>(sak::storage(m_data_in)));
+        m_read.stop();
+
+        object_decoder_type object_decoder(
+            *m_decoder_factory, object_encoder.object_size());
+
+        assert(object_encoder.encoders() == object_decoder.decoders());
+
+        uint32_t offset = 0;
+
+        for(uint32_t i = 0; i < object_encoder.encoders(); ++i)
+        {
+            m_read.start();
+            encoder_ptr encoder = object_encoder.build(i);
+            m_read.stop();
+
+            m_decode.start();
+            decoder_ptr decoder = object_decoder.build(i);
+            m_decode.stop();
+
+            transfer_block(encoder, decoder);
+
+            m_write.start();
+            decoder->copy_symbols(sak::storage(
+                &m_data_out[0] + offset, decoder->bytes_used()));
+            m_write.stop();
+
+            offset += decoder->bytes_used();
+        }
+
+        assert(offset == m_data_out.size());
+    }
+
+    /// Transfers the object between two files through the file_encoder
+    /// and file_decoder
+    void transfer_file()
+    {
+        typedef kodo::file_encoder<Encoder> file_encoder_type;
+        typedef kodo::file_decoder<Decoder> file_decoder_type;
+
+        m_read.start();
+        file_encoder_type file_encoder(*m_encoder_factory, m_filename);
+        m_read.stop();
+
+        m_write.start();
+        file_decoder_type file_decoder(*m_decoder_factory,
+                                       output_filename(),
+                                       file_encoder.object_size());
+        m_write.stop();
+
+        assert(file_encoder.encoders() == file_decoder.decoders());
+
+        for(uint32_t i = 0; i < file_encoder.encoders(); ++i)
+        {
+            m_read.start();
+            encoder_ptr encoder = file_encoder.build(i);
+            m_read.stop();
+
+            m_decode.start();
+            decoder_ptr decoder = file_decoder.build(i);
+            m_decode.stop();
+
+            transfer_block(encoder, decoder);
+
+            m_write.start();
+            file_decoder.write(i, decoder);
+            m_write.stop();
+        }
+    }
+
+    /// Transfers the object from and to memory buffers through the
+    /// random_annex_encoder and random_annex_decoder, with an annex of
+    /// a quarter of the symbols or the largest possible annex if smaller
+    void transfer_annex()
+    {
+        typedef kodo::random_annex_encoder<
+            Encoder, kodo::rfc5052_partitioning_scheme> annex_encoder_type;
+
+        typedef kodo::random_annex_decoder<
+            Decoder, kodo::rfc5052_partitioning_scheme> annex_decoder_type;
+
+        uint32_t annex_size = std::min(
+            m_encoder_factory->max_symbols() / 4,
+            kodo::max_annex_size(m_encoder_factory->max_symbols(),
+                                 m_encoder_factory->max_symbol_size(),
+                                 m_data_in.size()));
+
+        m_read.start();
+        annex_encoder_type annex_encoder(
+            annex_size, *m_encoder_factory, sak::storage(m_data_in));
+        m_read.stop();
+
+        annex_decoder_type annex_decoder(
+            annex_size, *m_decoder_factory, annex_encoder.object_size());
+
+        assert(annex_encoder.encoders() == annex_decoder.decoders());
+
+        uint32_t offset = 0;
+
+        for(uint32_t i = 0; i < annex_encoder.encoders(); ++i)
+        {
+            m_read.start();
+            encoder_ptr encoder = annex_encoder.build(i);
+            m_read.stop();
+
+            m_decode.start();
+            typename annex_decoder_type::pointer_type decoder =
+                annex_decoder.build(i);
+            m_decode.stop();
+
+            transfer_block(encoder, decoder);
+
+            m_write.start();
+            decoder.unwrap()->copy_symbols(sak::storage(
+                &m_data_out[0] + offset, decoder->bytes_used()));
+            m_write.stop();
+
+            offset += decoder->bytes_used();
+        }
+
+        assert(offset == m_data_out.size());
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string source = cs.get_value<std::string>("source");
+
+        RUN{
+            m_total.start();
+
+            if(source == "storage")
+            {
+                transfer_storage();
+            }
+            else if(source == "file")
+            {
+                transfer_file();
+            }
+            else if(source == "annex")
+            {
+                transfer_annex();
+            }
+            else
+            {
+                assert(0);
+            }
+
+            m_total.stop();
+        }
+
+        assert(source == "file" || m_data_in == m_data_out);
+    }
+
+protected:
+
+    /// The encoder factory
+    std::shared_ptr<encoder_factory> m_encoder_factory;
+
+    /// The decoder factory
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The object transferred
+    std::vector<uint8_t> m_data_in;
+
+    /// The object decoded into memory
+    std::vector<uint8_t> m_data_out;
+
+    /// The payload passed from the encoders to the decoders
+    std::vector<uint8_t> m_payload;
+
+    /// The file holding the object for the file source
+    std::string m_filename;
+
+    /// The time spent reading the object into the encoders
+    phase_timer m_read;
+
+    /// The time spent encoding
+    phase_timer m_encode;
+
+    /// The time spent decoding
+    phase_timer m_decode;
+
+    /// The time spent writing the decoded object
+    phase_timer m_write;
+
+    /// The time of the whole transfer
+    phase_timer m_total;
+
+    /// The number of payloads encoded
+    uint32_t m_payloads;
+
+    /// The random generator controlling the erasures
+    boost::random::mt19937 m_random_generator;
+
+    /// The distribution of the erasures
+    boost::random::bernoulli_distribution<> m_distribution;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(object_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> object_size;
+    object_size.push_back(64000000);
+
+    auto default_object_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            object_size, "")->multitoken();
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(64);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<double> erasure;
+    erasure.push_back(0.0);
+    erasure.push_back(0.1);
+
+    auto default_erasure =
+        gauge::po::value<std::vector<double> >()->default_value(
+            erasure, "")->multitoken();
+
+    std::vector<std::string> sources;
+    sources.push_back("storage");
+    sources.push_back("file");
+    sources.push_back("annex");
+
+    auto default_sources =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            sources, "")->multitoken();
+
+    options.add_options()
+        ("object_size", default_object_size,
+         "Set the object size in bytes");
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("erasure", default_erasure, "Set the symbol erasure probability");
+
+    options.add_options()
+        ("source", default_sources, "Set source [storage|file|annex]");
+
+    options.add_options()
+        ("object_file", gauge::po::value<std::string>()->default_value(
+            "kodo_object_benchmark.bin"),
+         "Set the file written and read by the file source");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef object_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_object;
+
+BENCHMARK_F(setup_rlnc_object, FullRLNC, Binary, 1)
+{
+    run_benchmark();
+}
+
+typedef object_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_object8;
+
+BENCHMARK_F(setup_rlnc_object8, FullRLNC, Binary8, 1)
+{
+    run_benchmark();
+}
+
+typedef object_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary8>,
+    kodo::seed_rlnc_decoder<fifi::binary8> > setup_seed_rlnc_object8;
+
+BENCHMARK_F(setup_seed_rlnc_object8, SeedRLNC, Binary8, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
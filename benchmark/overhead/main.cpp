@@ -4,6 +4,11 @@
 // http://www.steinwurf.com/licensing
 
 #include <ctime>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <string>
 
 #include <boost/make_shared.hpp>
 
@@ -12,12 +17,49 @@
 #include <gauge/python_printer.hpp>
 #include <gauge/csv_printer.hpp>
 
+#include <fifi/fifi_utils.hpp>
+
 #include <kodo/rlnc/full_vector_codes.hpp>
 #include <kodo/rlnc/seed_codes.hpp>
 #include <kodo/rs/reed_solomon_codes.hpp>
+#include <kodo/ldpc/ldpc_codes.hpp>
 #include <kodo/has_deep_symbol_storage.hpp>
+#include <kodo/monte_carlo_engine.hpp>
 
 #include "codes.hpp"
+#include "online_statistics.hpp"
+
+/// Opens the stream of the partial results shared by all benchmarks,
+/// a header line is written if the file is new
+/// @param path The file the results are appended to, "-" for the
+///        standard output or empty for no partial results
+/// @return The stream or null
+inline std::ostream* open_partial_results(const std::string &path)
+{
+    static std::ofstream file;
+
+    if(path.empty())
+        return 0;
+
+    if(path == "-")
+        return &std::cout;
+
+    if(!file.is_open())
+    {
+        bool is_new = std::ifstream(path.c_str()).peek() ==
+            std::ifstream::traits_type::eof();
+
+        file.open(path.c_str(), std::ios::app);
+
+        if(is_new)
+        {
+            file << "testcase,benchmark,symbols,symbol_size,trials,"
+                 << "mean,stddev,half_width,p50,p90,p99" << std::endl;
+        }
+    }
+
+    return &file;
+}
 
 /// A test block represents an encoder and decoder pair
 template<class Encoder, class Decoder>
@@ -30,9 +72,26 @@ struct overhead_benchmark : public gauge::benchmark
     typedef typename Decoder::factory decoder_factory;
     typedef typename Decoder::pointer decoder_ptr;
 
+    typedef typename Encoder::field_type field_type;
+
+    /// The engine running the trials of a run in parallel, a trial
+    /// returns the bytes used to decode
+    typedef kodo::monte_carlo_engine<uint64_t> engine_type;
+
+    /// The random generator of a trial
+    typedef engine_type::generator_type generator_type;
+
+    /// The function decoding one generation
+    typedef std::function<uint64_t (uint32_t, generator_type&)> trial_type;
+
     static_assert(kodo::has_deep_symbol_storage<Decoder>::value,
                   "The decoder should bring its own memory");
 
+    overhead_benchmark()
+        : m_partial_results(0),
+          m_seed((uint64_t)time(0))
+    { }
+
     void start()
     { }
 
@@ -41,14 +100,25 @@ struct overhead_benchmark : public gauge::benchmark
 
     void store_run(gauge::table& results)
     {
-        assert(m_encoder->block_size() ==
-               m_decoder->block_size());
+        uint64_t trials = m_statistics.moments().count();
+        uint64_t coded = trials * m_symbols * m_symbol_size;
 
         assert(m_bytes_used > 0);
-        assert(m_bytes_used >= m_encoder->block_size());
+        assert(m_bytes_used >= coded);
 
-        results.set_value("coded", m_encoder->block_size());
+        results.set_value("coded", coded);
         results.set_value("used", m_bytes_used);
+        results.set_value("trials", trials);
+
+        // The bytes used per trial
+        results.set_value("mean", m_statistics.moments().mean());
+        results.set_value("stddev",
+                          m_statistics.moments().standard_deviation());
+        results.set_value("half_width",
+                          m_statistics.moments().half_width(m_z));
+        results.set_value("p50", m_statistics.median());
+        results.set_value("p90", m_statistics.p90());
+        results.set_value("p99", m_statistics.p99());
     }
 
     std::string unit_text() const
@@ -64,20 +134,23 @@ struct overhead_benchmark : public gauge::benchmark
         assert(symbols.size() > 0);
         assert(symbol_size.size() > 0);
 
-        m_max_symbols = *std::max_element(symbols.begin(),
-                                          symbols.end());
+        m_trials = options["trials"].as<uint32_t>();
+        assert(m_trials > 0);
+
+        m_precision = options["precision"].as<double>();
+        m_max_trials = options["max_trials"].as<uint32_t>();
+        m_z = normal_quantile(options["confidence"].as<double>());
+
+        assert(m_precision >= 0);
+        assert(m_max_trials >= m_trials);
 
-        m_max_symbol_size = *std::max_element(symbol_size.begin(),
-                                              symbol_size.end());
+        m_partial_results = open_partial_results(
+            options["partial_results"].as<std::string>());
 
-        // Make the factories fit perfectly otherwise there seems to
-        // be problems with memory access i.e. when using a factory
-        // with max symbols 1024 with a symbols 16
-        m_decoder_factory = std::make_shared<decoder_factory>(
-            m_max_symbols, m_max_symbol_size);
+        m_coefficients_only = options["coefficients_only"].as<bool>();
 
-        m_encoder_factory = std::make_shared<encoder_factory>(
-            m_max_symbols, m_max_symbol_size);
+        m_engine = std::make_shared<engine_type>(
+            options["threads"].as<uint32_t>());
 
         for(uint32_t i = 0; i < symbols.size(); ++i)
         {
@@ -95,79 +168,247 @@ struct overhead_benchmark : public gauge::benchmark
     {
         gauge::config_set cs = get_current_configuration();
 
-        uint32_t symbols = cs.get_value<uint32_t>("symbols");
-        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        m_symbols = cs.get_value<uint32_t>("symbols");
+        m_symbol_size = cs.get_value<uint32_t>("symbol_size");
 
-        m_decoder_factory->set_symbols(symbols);
-        m_decoder_factory->set_symbol_size(symbol_size);
+        m_bytes_used = 0;
+        m_statistics.clear();
+    }
 
-        m_encoder_factory->set_symbols(symbols);
-        m_encoder_factory->set_symbol_size(symbol_size);
+    /// Writes the statistics of the trials run so far to the partial
+    /// results, if enabled
+    void write_partial_results()
+    {
+        if(!m_partial_results)
+            return;
+
+        const online_moments &moments = m_statistics.moments();
+
+        *m_partial_results
+            << testcase_name() << "," << benchmark_name() << ","
+            << m_symbols << "," << m_symbol_size << ","
+            << moments.count() << "," << moments.mean() << ","
+            << moments.standard_deviation() << ","
+            << moments.half_width(m_z) << "," << m_statistics.median()
+            << "," << m_statistics.p90() << "," << m_statistics.p99()
+            << std::endl;
+    }
 
-        m_encoder = m_encoder_factory->build();
-        m_decoder = m_decoder_factory->build();
+    /// @return True if the run should stop, i.e. the trials of a batch
+    ///         have run without a precision, or the mean is precise
+    ///         enough, or the largest number of trials has run
+    bool is_done() const
+    {
+        if(m_precision == 0)
+            return true;
+
+        if(m_statistics.moments().count() >= m_max_trials)
+            return true;
 
-        // Prepare the data to be encoded
-        m_encoded_data.resize(m_encoder->block_size());
+        return m_statistics.is_precise(m_z, m_precision);
+    }
 
-        for(uint8_t &e : m_encoded_data)
+    /// Makes the function decoding a generation in a lane of the
+    /// engine, the lane has its own factories
+    virtual trial_type make_trial() const
+    {
+        // Only the coefficients determine the number of payloads
+        // needed, so they may carry a single field element and count
+        // as payloads of the configured symbol size
+        uint32_t symbol_size = m_coefficients_only ?
+            fifi::elements_to_size<field_type>(1) : m_symbol_size;
+
+        auto encoders = std::make_shared<encoder_factory>(
+            m_symbols, symbol_size);
+
+        auto decoders = std::make_shared<decoder_factory>(
+            m_symbols, symbol_size);
+
+        return [this, encoders, decoders](uint32_t, generator_type &random)
         {
-            e = rand() % 256;
-        }
+            encoder_ptr encoder = encoders->build();
+            decoder_ptr decoder = decoders->build();
 
-        m_encoder->set_symbols(sak::storage(m_encoded_data));
+            // Prepare the data to be encoded
+            std::vector<uint8_t> data(encoder->block_size());
 
-        m_bytes_used = 0;
+            for(uint8_t &e : data)
+            {
+                e = random() % 256;
+            }
+
+            encoder->set_symbols(sak::storage(data));
+            encoder->seed((uint32_t)random());
+
+            std::vector<uint8_t> payload(encoder->payload_size());
+            uint64_t bytes_used = 0;
+
+            while(!decoder->is_complete())
+            {
+                uint32_t used = encoder->encode(&payload[0]);
+                bytes_used += m_coefficients_only ? m_symbol_size : used;
+
+                decoder->decode(&payload[0]);
+            }
+
+            return bytes_used;
+        };
     }
 
     /// Run the benchmark
     void run_benchmark()
     {
         assert(m_bytes_used == 0);
-        assert(m_encoder);
-        assert(m_decoder);
-
-        std::vector<uint8_t> payload(m_encoder->payload_size());
+        assert(m_engine);
 
         // The clock is running
         RUN{
 
-            while(!m_decoder->is_complete())
+            // The trials run in batches until the stopping rule holds,
+            // the statistics of every batch are streamed
+            do
             {
-                m_bytes_used += m_encoder->encode(&payload[0]);
-                m_decoder->decode(&payload[0]);
+                auto results = m_engine->run(
+                    m_trials, m_seed++, [this] { return make_trial(); });
+
+                for(uint64_t used : results)
+                {
+                    m_bytes_used += used;
+                    m_statistics.add(static_cast<double>(used));
+                }
+
+                write_partial_results();
             }
+            while(!is_done());
         }
     }
 
 protected:
 
-    /// The maximum number of symbols
-    uint32_t m_max_symbols;
+    /// The number of trials per batch
+    uint32_t m_trials;
+
+    /// The largest half width of the confidence interval of the mean
+    /// relative to the mean, zero to run a single batch
+    double m_precision;
+
+    /// The largest number of trials of a run
+    uint32_t m_max_trials;
+
+    /// The standard normal quantile of the confidence level
+    double m_z;
 
-    /// The maximum symbol size
-    uint32_t m_max_symbol_size;
+    /// The stream of the partial results or null
+    std::ostream* m_partial_results;
 
-    /// The decoder factory
-    std::shared_ptr<decoder_factory> m_decoder_factory;
+    /// The statistics of the bytes used per trial
+    online_statistics m_statistics;
 
-    /// The encoder factory
-    std::shared_ptr<encoder_factory> m_encoder_factory;
+    /// Whether the symbols carry a single field element
+    bool m_coefficients_only;
 
-    /// The encoder to use
-    encoder_ptr m_encoder;
+    /// The engine running the trials
+    std::shared_ptr<engine_type> m_engine;
 
-    /// The encoder to use
-    decoder_ptr m_decoder;
+    /// The seed of the next run
+    uint64_t m_seed;
 
-    /// The data to encode
-    std::vector<uint8_t> m_encoded_data;
+    /// The number of symbols
+    uint32_t m_symbols;
 
-    /// The number of bytes used
-    uint32_t m_bytes_used;
+    /// The symbol size
+    uint32_t m_symbol_size;
+
+    /// The number of bytes used in all trials
+    uint64_t m_bytes_used;
 
 };
 
+/// The overhead of a fixed rate code, whose encoder produces a limited
+/// number of symbols, the code_length() of the encoder. Every symbol of
+/// the code is encoded and the decoder receives them in a random order,
+/// as after random erasures, until it is complete.
+template<class Encoder, class Decoder>
+struct fixed_rate_overhead_benchmark :
+    public overhead_benchmark<Encoder, Decoder>
+{
+    typedef overhead_benchmark<Encoder, Decoder> Super;
+
+    typedef typename Super::encoder_factory encoder_factory;
+    typedef typename Super::encoder_ptr encoder_ptr;
+
+    typedef typename Super::decoder_factory decoder_factory;
+    typedef typename Super::decoder_ptr decoder_ptr;
+
+    typedef typename Super::field_type field_type;
+    typedef typename Super::generator_type generator_type;
+    typedef typename Super::trial_type trial_type;
+
+    trial_type make_trial() const
+    {
+        uint32_t symbol_size = this->m_coefficients_only ?
+            fifi::elements_to_size<field_type>(1) : this->m_symbol_size;
+
+        auto encoders = std::make_shared<encoder_factory>(
+            this->m_symbols, symbol_size);
+
+        auto decoders = std::make_shared<decoder_factory>(
+            this->m_symbols, symbol_size);
+
+        return [this, encoders, decoders](uint32_t, generator_type &random)
+        {
+            encoder_ptr encoder = encoders->build();
+            decoder_ptr decoder = decoders->build();
+
+            std::vector<uint8_t> data(encoder->block_size());
+
+            for(uint8_t &e : data)
+            {
+                e = random() % 256;
+            }
+
+            encoder->set_symbols(sak::storage(data));
+
+            uint32_t code_length = encoder->code_length();
+
+            std::vector<std::vector<uint8_t> > payloads(code_length);
+            std::vector<uint32_t> used(code_length);
+
+            for(uint32_t i = 0; i < code_length; ++i)
+            {
+                payloads[i].resize(encoder->payload_size());
+                used[i] = encoder->encode(&payloads[i][0]);
+            }
+
+            std::vector<uint32_t> order(code_length);
+
+            for(uint32_t i = 0; i < code_length; ++i)
+            {
+                order[i] = i;
+            }
+
+            std::shuffle(order.begin(), order.end(), random);
+
+            uint64_t bytes_used = 0;
+
+            for(uint32_t i : order)
+            {
+                if(decoder->is_complete())
+                    break;
+
+                bytes_used += this->m_coefficients_only ?
+                    this->m_symbol_size : used[i];
+
+                decoder->decode(&payloads[i][0]);
+            }
+
+            assert(decoder->is_complete());
+
+            return bytes_used;
+        };
+    }
+};
+
 /// Using this macro we may specify options. For specifying options
 /// we use the boost program options library. So you may additional
 /// details on how to do it in the manual for that library.
@@ -209,6 +450,40 @@ BENCHMARK_OPTION(overhead_options)
         ("symbol erasure probability", default_erasure,
          "Set the symbol erasure probability");
 
+    options.add_options()
+        ("trials", gauge::po::value<uint32_t>()->default_value(1),
+         "Set the number of trials per run, or per batch with a "
+         "precision, the bytes are summed");
+
+    options.add_options()
+        ("precision", gauge::po::value<double>()->default_value(0),
+         "Run batches of trials until the confidence interval of the "
+         "mean bytes used is within this fraction of the mean, zero for "
+         "a single batch");
+
+    options.add_options()
+        ("confidence", gauge::po::value<double>()->default_value(0.95),
+         "Set the confidence level of the interval of the mean");
+
+    options.add_options()
+        ("max_trials", gauge::po::value<uint32_t>()->default_value(
+            1000000), "Set the largest number of trials of a run");
+
+    options.add_options()
+        ("partial_results", gauge::po::value<std::string>()->default_value(
+            ""), "Append the statistics of every batch to this CSV file, "
+         "'-' for the standard output");
+
+    options.add_options()
+        ("threads", gauge::po::value<uint32_t>()->default_value(0),
+         "Set the number of threads running the trials, zero for one "
+         "per hardware thread");
+
+    options.add_options()
+        ("coefficients_only", gauge::po::value<bool>()->default_value(
+            false, ""), "Code symbols of a single field element and "
+         "count the payloads without their headers");
+
     gauge::runner::instance().register_options(options);
 }
 
@@ -270,6 +545,19 @@ BENCHMARK_F(setup_delayed_rlnc_overhead16, FullDelayedRLNC, Binary16, 5)
    run_benchmark();
 }
 
+//------------------------------------------------------------------
+// LDPC-staircase
+//------------------------------------------------------------------
+
+typedef fixed_rate_overhead_benchmark<
+   kodo::ldpc_encoder,
+   kodo::ldpc_decoder> setup_ldpc_overhead;
+
+BENCHMARK_F(setup_ldpc_overhead, LDPCStaircase, Binary, 5)
+{
+   run_benchmark();
+}
+
 //------------------------------------------------------------------
 // Unsystematic encoder and decoder
 //------------------------------------------------------------------
@@ -0,0 +1,360 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+/// Mean and variance of a stream of values, updated with Welford's
+/// method so the sums do not lose precision for long runs
+class online_moments
+{
+public:
+
+    /// Constructor
+    online_moments()
+    {
+        clear();
+    }
+
+    /// Removes all values
+    void clear()
+    {
+        m_count = 0;
+        m_mean = 0;
+        m_m2 = 0;
+    }
+
+    /// Adds a value
+    /// @param value The value
+    void add(double value)
+    {
+        ++m_count;
+
+        double delta = value - m_mean;
+        m_mean += delta / m_count;
+        m_m2 += delta * (value - m_mean);
+    }
+
+    /// @return The number of values
+    uint64_t count() const
+    {
+        return m_count;
+    }
+
+    /// @return The mean of the values
+    double mean() const
+    {
+        return m_mean;
+    }
+
+    /// @return The sample variance of the values, zero for less than
+    ///         two values
+    double variance() const
+    {
+        if(m_count < 2)
+            return 0;
+
+        return m_m2 / (m_count - 1);
+    }
+
+    /// @return The sample standard deviation of the values
+    double standard_deviation() const
+    {
+        return std::sqrt(variance());
+    }
+
+    /// @param z The standard normal quantile of the confidence level,
+    ///        see normal_quantile()
+    /// @return The half width of the confidence interval of the mean
+    double half_width(double z) const
+    {
+        if(m_count < 2)
+            return 0;
+
+        return z * standard_deviation() / std::sqrt(double(m_count));
+    }
+
+private:
+
+    /// The number of values
+    uint64_t m_count;
+
+    /// The running mean
+    double m_mean;
+
+    /// The running sum of the squared differences from the mean
+    double m_m2;
+
+};
+
+/// Estimates a quantile of a stream of values with the P-square
+/// algorithm of Jain and Chlamtac, keeping five markers instead of the
+/// values. The first five values are kept exactly.
+class p2_quantile
+{
+public:
+
+    /// Constructor
+    /// @param probability The probability of the quantile in ]0, 1[
+    explicit p2_quantile(double probability)
+        : m_probability(probability)
+    {
+        assert(probability > 0 && probability < 1);
+        clear();
+    }
+
+    /// Removes all values
+    void clear()
+    {
+        m_count = 0;
+
+        double p = m_probability;
+
+        m_increments[0] = 0;
+        m_increments[1] = p / 2;
+        m_increments[2] = p;
+        m_increments[3] = (1 + p) / 2;
+        m_increments[4] = 1;
+
+        for(uint32_t i = 0; i < 5; ++i)
+        {
+            m_heights[i] = 0;
+            m_positions[i] = i + 1;
+            m_desired[i] = 1 + 4 * m_increments[i];
+        }
+    }
+
+    /// Adds a value
+    /// @param value The value
+    void add(double value)
+    {
+        if(m_count < 5)
+        {
+            m_heights[m_count] = value;
+            ++m_count;
+
+            std::sort(m_heights, m_heights + m_count);
+            return;
+        }
+
+        ++m_count;
+
+        // The cell of the value, extending the extreme markers
+        uint32_t cell;
+
+        if(value < m_heights[0])
+        {
+            m_heights[0] = value;
+            cell = 0;
+        }
+        else if(value >= m_heights[4])
+        {
+            m_heights[4] = value;
+            cell = 3;
+        }
+        else
+        {
+            cell = 0;
+            while(value >= m_heights[cell + 1])
+                ++cell;
+        }
+
+        for(uint32_t i = cell + 1; i < 5; ++i)
+            m_positions[i] += 1;
+
+        for(uint32_t i = 0; i < 5; ++i)
+            m_desired[i] += m_increments[i];
+
+        // Move the middle markers towards their desired positions
+        for(uint32_t i = 1; i < 4; ++i)
+        {
+            double d = m_desired[i] - m_positions[i];
+
+            if((d >= 1 && m_positions[i + 1] - m_positions[i] > 1) ||
+               (d <= -1 && m_positions[i - 1] - m_positions[i] < -1))
+            {
+                double step = d > 0 ? 1.0 : -1.0;
+                double height = parabolic(i, step);
+
+                if(height <= m_heights[i - 1] || height >= m_heights[i + 1])
+                    height = linear(i, step);
+
+                m_heights[i] = height;
+                m_positions[i] += step;
+            }
+        }
+    }
+
+    /// @return The estimated quantile, zero if no value was added
+    double value() const
+    {
+        if(m_count == 0)
+            return 0;
+
+        if(m_count <= 5)
+        {
+            // The values are sorted, pick the nearest rank
+            uint32_t rank = static_cast<uint32_t>(
+                std::ceil(m_probability * m_count));
+
+            return m_heights[std::max(rank, 1U) - 1];
+        }
+
+        return m_heights[2];
+    }
+
+private:
+
+    /// @return The piecewise parabolic prediction of a marker height
+    double parabolic(uint32_t i, double step) const
+    {
+        double n0 = m_positions[i - 1];
+        double n1 = m_positions[i];
+        double n2 = m_positions[i + 1];
+
+        return m_heights[i] + step / (n2 - n0) *
+            ((n1 - n0 + step) * (m_heights[i + 1] - m_heights[i]) /
+             (n2 - n1) +
+             (n2 - n1 - step) * (m_heights[i] - m_heights[i - 1]) /
+             (n1 - n0));
+    }
+
+    /// @return The linear prediction of a marker height
+    double linear(uint32_t i, double step) const
+    {
+        uint32_t j = step > 0 ? i + 1 : i - 1;
+
+        return m_heights[i] + step * (m_heights[j] - m_heights[i]) /
+            (m_positions[j] - m_positions[i]);
+    }
+
+private:
+
+    /// The probability of the quantile
+    double m_probability;
+
+    /// The number of values
+    uint64_t m_count;
+
+    /// The heights of the markers
+    double m_heights[5];
+
+    /// The positions of the markers
+    double m_positions[5];
+
+    /// The desired positions of the markers
+    double m_desired[5];
+
+    /// The increments of the desired positions per value
+    double m_increments[5];
+
+};
+
+/// @param confidence A confidence level in ]0, 1[, e.g. 0.95
+/// @return The standard normal quantile of a two sided interval of the
+///         confidence level, e.g. 1.96 for 0.95. The rational
+///         approximation of Abramowitz and Stegun 26.2.23 is used, its
+///         error is below 5e-4.
+inline double normal_quantile(double confidence)
+{
+    assert(confidence > 0 && confidence < 1);
+
+    double tail = (1 - confidence) / 2;
+    double t = std::sqrt(-2 * std::log(tail));
+
+    return t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+        (1 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+}
+
+/// The mean, variance and quantiles of a stream of values in constant
+/// memory, so a configuration may run any number of trials
+class online_statistics
+{
+public:
+
+    /// Constructor
+    online_statistics()
+        : m_median(0.5),
+          m_p90(0.9),
+          m_p99(0.99)
+    { }
+
+    /// Removes all values
+    void clear()
+    {
+        m_moments.clear();
+        m_median.clear();
+        m_p90.clear();
+        m_p99.clear();
+    }
+
+    /// Adds a value
+    /// @param value The value
+    void add(double value)
+    {
+        m_moments.add(value);
+        m_median.add(value);
+        m_p90.add(value);
+        m_p99.add(value);
+    }
+
+    /// @return The mean and variance
+    const online_moments& moments() const
+    {
+        return m_moments;
+    }
+
+    /// @return The estimated median
+    double median() const
+    {
+        return m_median.value();
+    }
+
+    /// @return The estimated 90th percentile
+    double p90() const
+    {
+        return m_p90.value();
+    }
+
+    /// @return The estimated 99th percentile
+    double p99() const
+    {
+        return m_p99.value();
+    }
+
+    /// @param z The standard normal quantile of the confidence level
+    /// @param precision The largest half width of the confidence
+    ///        interval relative to the mean
+    /// @return True if the confidence interval of the mean is narrow
+    ///         enough
+    bool is_precise(double z, double precision) const
+    {
+        if(m_moments.count() < 2)
+            return false;
+
+        return m_moments.half_width(z) <=
+            precision * std::fabs(m_moments.mean());
+    }
+
+private:
+
+    /// The mean and variance
+    online_moments m_moments;
+
+    /// The median
+    p2_quantile m_median;
+
+    /// The 90th percentile
+    p2_quantile m_p90;
+
+    /// The 99th percentile
+    p2_quantile m_p99;
+
+};
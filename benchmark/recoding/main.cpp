@@ -0,0 +1,399 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <chrono>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+/// Benchmark of a chain of relays recoding the symbols of an encoder
+/// towards a decoder: encoder -> relay 1 -> ... -> relay R -> decoder.
+/// Every hop erases the payloads with the erasure probability. In every
+/// step the encoder sends a payload and every relay holding at least
+/// one symbol recodes a payload to the next node with the recode()
+/// function of the payload_recoder.
+///
+/// The benchmark stores the throughput of the recode() calls, the
+/// header bytes of the encoder and of the recoded payloads, whose
+/// encoding vectors are written by the recoding_symbol_id layer, and
+/// the linear dependency overhead at the decoder, i.e. the number of
+/// received payloads which were not innovative.
+template<class Encoder, class Decoder>
+struct recoding_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+
+    typedef std::chrono::high_resolution_clock clock_type;
+
+    recoding_benchmark()
+    {
+        // Seed the random generator controlling the erasures
+        m_random_generator.seed((uint64_t)time(0));
+    }
+
+    void start()
+    {
+        m_recoded = 0;
+        m_recode_time = 0;
+        m_received = 0;
+        m_non_innovative = 0;
+        m_steps = 0;
+    }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        double recode_throughput = 0;
+
+        if(m_recode_time > 0)
+        {
+            // Bytes per microsecond gives MB/s
+            recode_throughput =
+                (double(m_recoded) * symbol_size) / m_recode_time;
+        }
+
+        results.set_value("recode_throughput", recode_throughput);
+
+        results.set_value("encoder_header_bytes",
+                          m_encoder->payload_size() - symbol_size);
+
+        results.set_value("recode_header_bytes",
+                          m_decoder->payload_size() - symbol_size);
+
+        double iterations = double(m_iterations);
+
+        results.set_value("received", m_received / iterations);
+        results.set_value("non_innovative", m_non_innovative / iterations);
+        results.set_value("overhead",
+                          m_non_innovative / (iterations * symbols));
+        results.set_value("steps", m_steps / iterations);
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto relays = options["relays"].as<std::vector<uint32_t> >();
+        auto erasure = options["erasure"].as<std::vector<double> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(relays.size() > 0);
+        assert(erasure.size() > 0);
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                for(const auto& r : relays)
+                {
+                    for(const auto& e : erasure)
+                    {
+                        assert(e < 1.0);
+
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("symbols", s);
+                        cs.set_value<uint32_t>("symbol_size", p);
+                        cs.set_value<uint32_t>("relays", r);
+                        cs.set_value<double>("erasure", e);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t relays = cs.get_value<uint32_t>("relays");
+
+        m_encoder_factory = std::make_shared<encoder_factory>(
+            symbols, symbol_size);
+
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            symbols, symbol_size);
+
+        m_encoder = m_encoder_factory->build();
+        m_decoder = m_decoder_factory->build();
+
+        m_relays.resize(relays);
+
+        for(auto& relay : m_relays)
+        {
+            relay = m_decoder_factory->build();
+        }
+
+        // Prepare the data to be encoded
+        m_encoded_data.resize(m_encoder->block_size());
+
+        for(uint8_t &e : m_encoded_data)
+        {
+            e = rand() % 256;
+        }
+
+        m_payload.resize(
+            std::max(m_encoder->payload_size(), m_decoder->payload_size()));
+
+        double erasure = cs.get_value<double>("erasure");
+        m_distribution = boost::random::bernoulli_distribution<>(erasure);
+
+        m_iterations = 0;
+    }
+
+    /// Passes the payload to the next node of the chain unless it is
+    /// erased, the payloads reaching the decoder are counted
+    /// @param node The index of the receiving node, the relays come
+    ///        first and the decoder last
+    void send(uint32_t node)
+    {
+        if(m_distribution(m_random_generator))
+            return;
+
+        if(node < m_relays.size())
+        {
+            m_relays[node]->decode(&m_payload[0]);
+            return;
+        }
+
+        uint32_t rank = m_decoder->rank();
+        m_decoder->decode(&m_payload[0]);
+
+        ++m_received;
+
+        if(m_decoder->rank() == rank)
+        {
+            ++m_non_innovative;
+        }
+    }
+
+    /// Transfers a block over the chain of relays
+    void transfer_block()
+    {
+        m_encoder->initialize(*m_encoder_factory);
+        m_decoder->initialize(*m_decoder_factory);
+
+        for(auto& relay : m_relays)
+        {
+            relay->initialize(*m_decoder_factory);
+        }
+
+        m_encoder->set_symbols(sak::storage(m_encoded_data));
+
+        while(!m_decoder->is_complete())
+        {
+            ++m_steps;
+
+            m_encoder->encode(&m_payload[0]);
+            send(0);
+
+            // The relays holding symbols recode a payload each
+            for(uint32_t i = 0; i < m_relays.size(); ++i)
+            {
+                if(m_relays[i]->rank() == 0)
+                {
+                    continue;
+                }
+
+                auto start = clock_type::now();
+                m_relays[i]->recode(&m_payload[0]);
+                auto stop = clock_type::now();
+
+                m_recode_time += std::chrono::duration_cast<
+                    std::chrono::microseconds>(stop - start).count();
+
+                ++m_recoded;
+
+                send(i + 1);
+            }
+        }
+    }
+
+    /// Run the benchmark
+    void run_benchmark()
+    {
+        RUN{
+            transfer_block();
+            ++m_iterations;
+        }
+    }
+
+protected:
+
+    /// The encoder factory
+    std::shared_ptr<encoder_factory> m_encoder_factory;
+
+    /// The decoder factory, also building the relays
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The encoder
+    encoder_ptr m_encoder;
+
+    /// The relays between the encoder and the decoder
+    std::vector<decoder_ptr> m_relays;
+
+    /// The decoder at the end of the chain
+    decoder_ptr m_decoder;
+
+    /// The data encoded
+    std::vector<uint8_t> m_encoded_data;
+
+    /// The payload passed over the hops
+    std::vector<uint8_t> m_payload;
+
+    /// The number of recoded payloads
+    uint64_t m_recoded;
+
+    /// The time spent recoding in microseconds
+    double m_recode_time;
+
+    /// The number of payloads received by the decoder
+    uint64_t m_received;
+
+    /// The number of received payloads which were not innovative
+    uint64_t m_non_innovative;
+
+    /// The number of steps needed to decode
+    uint64_t m_steps;
+
+    /// The number of blocks transferred
+    uint32_t m_iterations;
+
+    /// The random generator controlling the erasures
+    boost::random::mt19937 m_random_generator;
+
+    /// The distribution of the erasures
+    boost::random::bernoulli_distribution<> m_distribution;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(recoding_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(32);
+    symbols.push_back(64);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<uint32_t> relays;
+    relays.push_back(1);
+    relays.push_back(2);
+    relays.push_back(4);
+
+    auto default_relays =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            relays, "")->multitoken();
+
+    std::vector<double> erasure;
+    erasure.push_back(0.1);
+
+    auto default_erasure =
+        gauge::po::value<std::vector<double> >()->default_value(
+            erasure, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("relays", default_relays, "Set the number of relays");
+
+    options.add_options()
+        ("erasure", default_erasure,
+         "Set the symbol erasure probability of every hop");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef recoding_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_recoding;
+
+BENCHMARK_F(setup_rlnc_recoding, FullRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef recoding_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_recoding8;
+
+BENCHMARK_F(setup_rlnc_recoding8, FullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef recoding_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary16>,
+    kodo::full_rlnc_decoder<fifi::binary16> > setup_rlnc_recoding16;
+
+BENCHMARK_F(setup_rlnc_recoding16, FullRLNC, Binary16, 5)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+#! /usr/bin/env python
+# encoding: utf-8
+
+# This script runs a fixed matrix of gauge benchmarks and compares the
+# results against a baseline recorded on the same machine, reporting the
+# configurations which became significantly slower.
+#
+# Typical use, from the directory of the built benchmarks
+# (e.g. build/linux/benchmark):
+#
+#   python regression.py baseline     # on the reference revision
+#   python regression.py compare      # on the revision to check
+#
+# The baselines are stored as JSON files tagged with the machine, since
+# results from different machines cannot be compared. The compare command
+# exits with status 1 if a regression was found, so it can gate a change.
+# The matrix of benchmarks is read from matrix.json next to this script.
+
+from __future__ import print_function
+
+import argparse
+import csv
+import json
+import math
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+# Two-sided critical values of the student t distribution for the
+# supported confidence levels, indexed by the degrees of freedom 1-30.
+# Above 30 degrees of freedom the normal distribution is used.
+T_TABLE = {
+    0.90: ([6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833,
+            1.812, 1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734,
+            1.729, 1.725, 1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703,
+            1.701, 1.699, 1.697], 1.645),
+    0.95: ([12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+            2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+            2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+            2.048, 2.045, 2.042], 1.960),
+    0.99: ([63.657, 9.925, 5.841, 4.604, 4.032, 3.707, 3.499, 3.355, 3.250,
+            3.169, 3.106, 3.055, 3.012, 2.977, 2.947, 2.921, 2.898, 2.878,
+            2.861, 2.845, 2.831, 2.819, 2.807, 2.797, 2.787, 2.779, 2.771,
+            2.763, 2.756, 2.750], 2.576)
+}
+
+
+def t_critical(confidence, degrees):
+    """Returns the two-sided critical value of the t distribution"""
+    table, normal = T_TABLE[confidence]
+    index = int(math.floor(degrees))
+
+    if index < 1:
+        return table[0]
+    if index > len(table):
+        return normal
+
+    return table[index - 1]
+
+
+def machine_tag():
+    """Returns a tag identifying the machine running the benchmarks"""
+    cpu = platform.processor()
+
+    try:
+        with open('/proc/cpuinfo') as f:
+            for line in f:
+                if line.startswith('model name'):
+                    cpu = line.split(':', 1)[1]
+                    break
+    except IOError:
+        pass
+
+    tag = '{}-{}-{}'.format(platform.node(), platform.machine(), cpu)
+    return re.sub('[^A-Za-z0-9.]+', '_', tag.strip()).strip('_')
+
+
+def load_matrix(matrix_file):
+    with open(matrix_file) as f:
+        return json.load(f)['benchmarks']
+
+
+def run_benchmark(benchmark, binary_dir, repeat):
+    """Runs one entry of the matrix and returns the samples of its metric
+    per configuration"""
+    binary = os.path.join(binary_dir, benchmark['binary'])
+
+    if not os.path.isfile(binary):
+        raise RuntimeError('benchmark binary {} not found'.format(binary))
+
+    samples = {}
+
+    for _ in range(repeat):
+        handle, csvfile = tempfile.mkstemp(suffix='.csv')
+        os.close(handle)
+
+        try:
+            command = [binary,
+                       '--gauge_filter={}'.format(benchmark['filter']),
+                       '--csvfile={}'.format(csvfile)]
+            command += benchmark.get('args', [])
+
+            with open(os.devnull, 'w') as devnull:
+                subprocess.check_call(command, stdout=devnull)
+
+            with open(csvfile) as f:
+                for row in csv.DictReader(f):
+                    key = configuration_key(benchmark, row)
+                    value = float(row[benchmark['metric']])
+                    samples.setdefault(key, []).append(value)
+        finally:
+            os.remove(csvfile)
+
+    return samples
+
+
+def configuration_key(benchmark, row):
+    """Returns the name of the configuration of a row of the results"""
+    name = '{}.{}'.format(row.get('testcase', ''), row.get('benchmark', ''))
+    keys = ['{}={}'.format(k, row.get(k, '')) for k in benchmark['keys']]
+
+    return ' '.join([name, benchmark['metric']] + keys)
+
+
+def run_matrix(matrix, binary_dir, repeat):
+    """Runs the matrix and returns the results tagged with the machine"""
+    results = {}
+
+    for benchmark in matrix:
+        print('Running {} {}'.format(benchmark['binary'],
+                                     benchmark['filter']))
+
+        samples = run_benchmark(benchmark, binary_dir, repeat)
+
+        for key, values in samples.items():
+            results[key] = {
+                'samples': values,
+                'higher_is_better': benchmark['higher_is_better']}
+
+    return {'machine': machine_tag(),
+            'time': time.strftime('%Y-%m-%d %H:%M:%S'),
+            'results': results}
+
+
+def mean_and_variance(values):
+    n = len(values)
+    mean = sum(values) / n
+
+    if n < 2:
+        return mean, 0.0
+
+    variance = sum((v - mean) ** 2 for v in values) / (n - 1)
+    return mean, variance
+
+
+def compare_samples(baseline, current, confidence):
+    """Computes the relative change of the mean of the current samples
+    against the baseline with the confidence interval of Welch's t-test.
+    Returns the change and the bounds of the interval"""
+    b_mean, b_var = mean_and_variance(baseline)
+    c_mean, c_var = mean_and_variance(current)
+
+    b_n = len(baseline)
+    c_n = len(current)
+
+    se2 = b_var / b_n + c_var / c_n
+    se = math.sqrt(se2)
+
+    # Welch-Satterthwaite degrees of freedom
+    if se2 > 0 and b_n > 1 and c_n > 1:
+        degrees = se2 ** 2 / ((b_var / b_n) ** 2 / (b_n - 1) +
+                              (c_var / c_n) ** 2 / (c_n - 1))
+    else:
+        degrees = max(1, b_n + c_n - 2)
+
+    margin = t_critical(confidence, degrees) * se
+    difference = c_mean - b_mean
+
+    if b_mean == 0:
+        return 0.0, 0.0, 0.0
+
+    return (difference / b_mean, (difference - margin) / b_mean,
+            (difference + margin) / b_mean)
+
+
+def compare(baseline, current, confidence, tolerance):
+    """Prints the comparison of every configuration and returns the
+    configurations which regressed"""
+    regressions = []
+
+    for key in sorted(current['results']):
+        if key not in baseline['results']:
+            print('  new      {}'.format(key))
+            continue
+
+        result = current['results'][key]
+        change, low, high = compare_samples(
+            baseline['results'][key]['samples'], result['samples'],
+            confidence)
+
+        # Express the change such that negative is always worse
+        if not result['higher_is_better']:
+            change, low, high = -change, -high, -low
+
+        if high < 0 and -change >= tolerance:
+            status = 'SLOWER'
+            regressions.append(key)
+        elif low > 0 and change >= tolerance:
+            status = 'faster'
+        else:
+            status = 'same'
+
+        print('  {:<8} {} {:+.1%} [{:+.1%}, {:+.1%}]'.format(
+            status, key, change, low, high))
+
+    return regressions
+
+
+def baseline_file(baseline_dir, tag):
+    return os.path.join(baseline_dir, '{}.json'.format(tag))
+
+
+def main():
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+
+    parser = argparse.ArgumentParser(
+        description='Detects performance regressions of the benchmarks')
+
+    parser.add_argument(
+        'command', choices=['baseline', 'compare'],
+        help='record a baseline or compare against the baseline')
+
+    parser.add_argument(
+        '--binary_dir', dest='binary_dir', action='store', default='.',
+        help='the directory of the built benchmarks')
+
+    parser.add_argument(
+        '--matrix', dest='matrix', action='store',
+        default=os.path.join(script_dir, 'matrix.json'),
+        help='the .json file listing the benchmarks to run')
+
+    parser.add_argument(
+        '--baseline_dir', dest='baseline_dir', action='store',
+        default='baselines', help='the directory of the baselines')
+
+    parser.add_argument(
+        '--results', dest='results', action='store', default=None,
+        help='compare a results .json file instead of running the matrix')
+
+    parser.add_argument(
+        '--repeat', dest='repeat', action='store', type=int, default=3,
+        help='the number of times every benchmark is run')
+
+    parser.add_argument(
+        '--confidence', dest='confidence', action='store', type=float,
+        choices=sorted(T_TABLE), default=0.95,
+        help='the confidence level of the intervals')
+
+    parser.add_argument(
+        '--tolerance', dest='tolerance', action='store', type=float,
+        default=0.02, help='the smallest relative change reported')
+
+    args = parser.parse_args()
+
+    if args.results:
+        with open(args.results) as f:
+            current = json.load(f)
+    else:
+        matrix = load_matrix(args.matrix)
+        current = run_matrix(matrix, args.binary_dir, args.repeat)
+
+    filename = baseline_file(args.baseline_dir, current['machine'])
+
+    if args.command == 'baseline':
+        if not os.path.isdir(args.baseline_dir):
+            os.makedirs(args.baseline_dir)
+
+        with open(filename, 'w') as f:
+            json.dump(current, f, indent=4, sort_keys=True)
+
+        print('Stored baseline {}'.format(filename))
+        return 0
+
+    if not os.path.isfile(filename):
+        print('No baseline {} for this machine'.format(filename))
+        return 2
+
+    with open(filename) as f:
+        baseline = json.load(f)
+
+    print('Comparing against the baseline from {}'.format(baseline['time']))
+
+    regressions = compare(baseline, current, args.confidence,
+                          args.tolerance)
+
+    if regressions:
+        print('{} configurations regressed'.format(len(regressions)))
+        return 1
+
+    print('No regressions')
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
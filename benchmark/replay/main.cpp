@@ -0,0 +1,419 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/cycle_counter.hpp>
+#include <kodo/payload_trace.hpp>
+
+#include "../latency/latency_histogram.hpp"
+
+/// Benchmark replaying a payload trace, captured with the
+/// trace_capture_decoder layer, into a decoder stack at full speed. The
+/// arrival order, the duplicates and the mix of systematic, coded and
+/// recoded payloads are the ones seen in production, so slowdowns which
+/// the synthetic benchmarks do not show can be reproduced and the
+/// stacks compared on the same input.
+///
+/// Every decode() call is timed with the cycle counter, the copy of the
+/// payload from the trace is not. The results are the throughput in
+/// decoded bytes, the percentiles of the latency of the calls and the
+/// wasted work: the payloads which did not increase the rank and the
+/// payloads received after their generation was decoded.
+///
+/// The trace does not hold the field, so a --trace file must only be
+/// replayed into the stacks of its field, e.g. with
+/// --gauge_filter=*.Binary8. Without a --trace file a synthetic trace
+/// of an encoder sending over a lossy link with duplicates is captured
+/// for every stack, so the benchmark runs out of the box.
+template<class Decoder>
+struct replay_benchmark : public gauge::benchmark
+{
+
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
+    typedef typename Decoder::field_type field_type;
+
+    void start()
+    {
+        m_latency.clear();
+        m_cycles = 0;
+        m_decoded_bytes = 0;
+        m_non_innovative = 0;
+        m_after_complete = 0;
+        m_incomplete = 0;
+        m_replays = 0;
+    }
+
+    void stop()
+    { }
+
+    void store_run(gauge::table& results)
+    {
+        assert(m_replays > 0);
+
+        double replays = double(m_replays);
+        double ns = m_cycles / m_ticks_per_ns;
+
+        // Bytes per nanosecond are GB/s
+        results.set_value("throughput", m_decoded_bytes / ns * 1000.0);
+
+        results.set_value("p50", to_ns(m_latency.percentile(50)));
+        results.set_value("p90", to_ns(m_latency.percentile(90)));
+        results.set_value("p99", to_ns(m_latency.percentile(99)));
+        results.set_value("p999", to_ns(m_latency.percentile(99.9)));
+        results.set_value("max", to_ns(m_latency.max()));
+        results.set_value("mean", m_latency.mean() / m_ticks_per_ns);
+
+        results.set_value("payloads", m_trace.payloads());
+        results.set_value("generations", m_trace.generations());
+        results.set_value("non_innovative", m_non_innovative / replays);
+        results.set_value("after_complete", m_after_complete / replays);
+        results.set_value("incomplete", m_incomplete / replays);
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        m_trace_file = options["trace"].as<std::string>();
+        m_symbols = options["symbols"].as<uint32_t>();
+        m_symbol_size = options["symbol_size"].as<uint32_t>();
+        m_erasure = options["erasure"].as<double>();
+        m_duplicates = options["duplicates"].as<double>();
+
+        assert(m_symbols > 0);
+        assert(m_symbol_size > 0);
+        assert(m_erasure >= 0.0 && m_erasure < 1.0);
+        assert(m_duplicates >= 0.0 && m_duplicates < 1.0);
+
+        gauge::config_set cs;
+        cs.set_value<std::string>("trace", m_trace_file.empty() ?
+                                  "synthetic" : m_trace_file);
+
+        add_configuration(cs);
+    }
+
+    void setup()
+    {
+        if(m_trace_file.empty())
+        {
+            capture_synthetic_trace();
+        }
+        else
+        {
+            std::ifstream in(m_trace_file.c_str(), std::ios::binary);
+
+            bool loaded = m_trace.load(in);
+            assert(loaded && "The --trace file could not be read");
+            (void) loaded;
+        }
+
+        assert(m_trace.generations() > 0);
+
+        uint32_t max_symbols = 0;
+        uint32_t max_symbol_size = 0;
+
+        for(uint32_t i = 0; i < m_trace.generations(); ++i)
+        {
+            const kodo::payload_trace::generation &g =
+                m_trace.generation_at(i);
+
+            max_symbols = std::max(max_symbols, g.m_symbols);
+            max_symbol_size = std::max(max_symbol_size, g.m_symbol_size);
+        }
+
+        m_decoder_factory = std::make_shared<decoder_factory>(
+            max_symbols, max_symbol_size);
+
+        m_payload.resize(std::max(m_trace.max_payload_size(),
+                                  m_decoder_factory->max_payload_size()));
+
+        m_ticks_per_ns = kodo::cycle_counter_ticks_per_ns();
+    }
+
+    /// Captures a trace of full RLNC payloads, the systematic and
+    /// coded payloads of an encoder sent over a link with independent
+    /// losses and duplicates
+    void capture_synthetic_trace()
+    {
+        typedef kodo::full_rlnc_encoder<field_type> encoder_type;
+        typedef kodo::trace_capture_full_rlnc_decoder<field_type>
+            capture_type;
+
+        typename encoder_type::factory encoder_factory(
+            m_symbols, m_symbol_size);
+        typename capture_type::factory capture_factory(
+            m_symbols, m_symbol_size);
+
+        std::stringstream stream;
+        kodo::payload_trace_writer writer(stream);
+        capture_factory.set_trace_writer(&writer);
+
+        boost::random::mt19937 random_generator(
+            static_cast<uint32_t>(time(0)));
+        boost::random::bernoulli_distribution<> lost(m_erasure);
+        boost::random::bernoulli_distribution<> duplicate(m_duplicates);
+
+        std::vector<uint8_t> data(m_symbols * m_symbol_size);
+
+        for(uint8_t &e : data)
+        {
+            e = rand() % 256;
+        }
+
+        auto encoder = encoder_factory.build();
+        std::vector<uint8_t> payload(encoder->payload_size());
+        std::vector<uint8_t> copy(encoder->payload_size());
+
+        for(uint32_t i = 0; i < synthetic_generations; ++i)
+        {
+            encoder->initialize(encoder_factory);
+            encoder->set_symbols(sak::storage(data));
+
+            auto decoder = capture_factory.build();
+
+            while(!decoder->is_complete())
+            {
+                encoder->encode(&payload[0]);
+
+                if(lost(random_generator))
+                    continue;
+
+                copy = payload;
+                decoder->decode(&copy[0]);
+
+                if(duplicate(random_generator))
+                {
+                    copy = payload;
+                    decoder->decode(&copy[0]);
+                }
+            }
+        }
+
+        bool loaded = m_trace.load(stream);
+        assert(loaded);
+        (void) loaded;
+    }
+
+    /// @param ticks A number of cycle counter ticks
+    /// @return The ticks in nanoseconds
+    uint64_t to_ns(uint64_t ticks) const
+    {
+        return static_cast<uint64_t>(ticks / m_ticks_per_ns);
+    }
+
+    /// Replays every generation of the trace into a decoder
+    void replay()
+    {
+        for(uint32_t i = 0; i < m_trace.generations(); ++i)
+        {
+            const kodo::payload_trace::generation &g =
+                m_trace.generation_at(i);
+
+            m_decoder_factory->set_symbols(g.m_symbols);
+            m_decoder_factory->set_symbol_size(g.m_symbol_size);
+
+            decoder_ptr decoder = m_decoder_factory->build();
+
+            for(uint32_t j = 0; j < g.m_payloads; ++j)
+            {
+                uint32_t index = g.m_first_payload + j;
+
+                // The decoder may modify the payload
+                std::copy_n(m_trace.payload_data(index),
+                            m_trace.payload_at(index).m_size,
+                            &m_payload[0]);
+
+                if(decoder->is_complete())
+                {
+                    ++m_after_complete;
+                }
+
+                uint32_t rank = decoder->rank();
+
+                uint64_t start = kodo::read_cycle_counter();
+                decoder->decode(&m_payload[0]);
+                uint64_t stop = kodo::read_cycle_counter();
+
+                m_cycles += stop - start;
+                m_latency.record(stop - start);
+
+                if(decoder->rank() == rank)
+                {
+                    ++m_non_innovative;
+                }
+            }
+
+            if(decoder->is_complete())
+            {
+                m_decoded_bytes += decoder->block_size();
+            }
+            else
+            {
+                ++m_incomplete;
+            }
+        }
+
+        ++m_replays;
+    }
+
+    void run_benchmark()
+    {
+        RUN{
+            replay();
+        }
+    }
+
+protected:
+
+    /// The number of generations of the synthetic trace
+    static const uint32_t synthetic_generations = 100;
+
+    /// The decoder factory
+    std::shared_ptr<decoder_factory> m_decoder_factory;
+
+    /// The trace replayed
+    kodo::payload_trace m_trace;
+
+    /// The copy of the payload passed to the decoder
+    std::vector<uint8_t> m_payload;
+
+    /// The latencies of the decode() calls
+    latency_histogram m_latency;
+
+    /// The cycles spent in decode()
+    uint64_t m_cycles;
+
+    /// The bytes of the decoded generations
+    uint64_t m_decoded_bytes;
+
+    /// The payloads which did not increase the rank, including the
+    /// payloads received after the generation was decoded
+    uint64_t m_non_innovative;
+
+    /// The payloads received after the generation was decoded
+    uint64_t m_after_complete;
+
+    /// The generations not decoded at the end of the trace
+    uint64_t m_incomplete;
+
+    /// The number of replays of the trace
+    uint32_t m_replays;
+
+    /// The rate of the cycle counter
+    double m_ticks_per_ns;
+
+    /// The trace file, empty for a synthetic trace
+    std::string m_trace_file;
+
+    /// The number of symbols of the synthetic trace
+    uint32_t m_symbols;
+
+    /// The symbol size of the synthetic trace
+    uint32_t m_symbol_size;
+
+    /// The loss probability of the synthetic trace
+    double m_erasure;
+
+    /// The duplicate probability of the synthetic trace
+    double m_duplicates;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(replay_options)
+{
+    gauge::po::options_description options;
+
+    options.add_options()
+        ("trace", gauge::po::value<std::string>()->default_value(""),
+         "Set the payload trace to replay, a synthetic trace if empty");
+
+    options.add_options()
+        ("symbols", gauge::po::value<uint32_t>()->default_value(64),
+         "Set the number of symbols of the synthetic trace");
+
+    options.add_options()
+        ("symbol_size", gauge::po::value<uint32_t>()->default_value(1600),
+         "Set the symbol size in bytes of the synthetic trace");
+
+    options.add_options()
+        ("erasure", gauge::po::value<double>()->default_value(0.1),
+         "Set the loss probability of the synthetic trace");
+
+    options.add_options()
+        ("duplicates", gauge::po::value<double>()->default_value(0.1),
+         "Set the duplicate probability of the synthetic trace");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef replay_benchmark<kodo::full_rlnc_decoder<fifi::binary8> >
+    setup_rlnc_replay8;
+
+BENCHMARK_F(setup_rlnc_replay8, FullRLNC, Binary8, 10)
+{
+    run_benchmark();
+}
+
+typedef replay_benchmark<kodo::blocked_full_rlnc_decoder<fifi::binary8> >
+    setup_blocked_rlnc_replay8;
+
+BENCHMARK_F(setup_blocked_rlnc_replay8, BlockedFullRLNC, Binary8, 10)
+{
+    run_benchmark();
+}
+
+typedef replay_benchmark<kodo::full_rlnc_decoder_hybrid<fifi::binary8> >
+    setup_hybrid_rlnc_replay8;
+
+BENCHMARK_F(setup_hybrid_rlnc_replay8, FullHybridRLNC, Binary8, 10)
+{
+    run_benchmark();
+}
+
+typedef replay_benchmark<kodo::full_rlnc_decoder<fifi::binary16> >
+    setup_rlnc_replay16;
+
+BENCHMARK_F(setup_rlnc_replay16, FullRLNC, Binary16, 10)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
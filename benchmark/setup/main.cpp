@@ -0,0 +1,370 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <chrono>
+#include <algorithm>
+
+#include <gauge/gauge.hpp>
+#include <gauge/console_printer.hpp>
+#include <gauge/python_printer.hpp>
+#include <gauge/csv_printer.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+
+/// Benchmark measuring the time it takes to set up a coder, i.e. the
+/// latency paid when a session starts rather than per payload. Every
+/// run measures:
+///
+/// - factory: constructing the factory
+/// - cold_build: the first build(), which constructs the coder
+/// - warm_build: a build() reusing the coder released into the pool
+/// - initialize: initialize() of a built coder
+///
+/// The factories are constructed with the largest number of symbols
+/// and symbol size of the configurations, and set_symbols() and
+/// set_symbol_size() select the measured configuration, so the
+/// initialize() cost is measured for the sizes actually used rather
+/// than for a perfectly fitting factory.
+template<class Encoder, class Decoder>
+struct setup_benchmark : public gauge::benchmark
+{
+
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Decoder::factory decoder_factory;
+
+    typedef std::chrono::high_resolution_clock clock_type;
+
+    void start()
+    { }
+
+    void stop()
+    { }
+
+    /// @param start The start of a measurement
+    /// @param stop The end of a measurement
+    /// @return The time between the two in nanoseconds
+    static double to_ns(const clock_type::time_point &start,
+                        const clock_type::time_point &stop)
+    {
+        return std::chrono::duration<double, std::nano>(
+            stop - start).count();
+    }
+
+    void store_run(gauge::table& results)
+    {
+        results.set_value("factory", m_factory);
+        results.set_value("cold_build", m_cold_build);
+        results.set_value("warm_build", m_warm_build);
+        results.set_value("initialize", m_initialize);
+    }
+
+    std::string unit_text() const
+    {
+        return "ns";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto types = options["type"].as<std::vector<std::string> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(types.size() > 0);
+
+        m_max_symbols =
+            *std::max_element(symbols.begin(), symbols.end());
+
+        m_max_symbol_size =
+            *std::max_element(symbol_size.begin(), symbol_size.end());
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                for(const auto& t : types)
+                {
+                    gauge::config_set cs;
+                    cs.set_value<uint32_t>("symbols", s);
+                    cs.set_value<uint32_t>("symbol_size", p);
+                    cs.set_value<std::string>("type", t);
+
+                    add_configuration(cs);
+                }
+            }
+        }
+    }
+
+    void setup()
+    { }
+
+    /// Sets up a coder from scratch and measures every step
+    template<class Factory>
+    void measure()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        clock_type::time_point start = clock_type::now();
+
+        auto factory = std::make_shared<Factory>(
+            m_max_symbols, m_max_symbol_size);
+
+        clock_type::time_point stop = clock_type::now();
+        m_factory = to_ns(start, stop);
+
+        factory->set_symbols(symbols);
+        factory->set_symbol_size(symbol_size);
+
+        start = clock_type::now();
+        auto coder = factory->build();
+        stop = clock_type::now();
+
+        m_cold_build = to_ns(start, stop);
+
+        // Release the coder into the pool of the factory
+        coder.reset();
+
+        start = clock_type::now();
+        coder = factory->build();
+        stop = clock_type::now();
+
+        m_warm_build = to_ns(start, stop);
+
+        start = clock_type::now();
+        coder->initialize(*factory);
+        stop = clock_type::now();
+
+        m_initialize = to_ns(start, stop);
+    }
+
+    /// Measures the encoder or decoder selected by the configuration
+    void measure_type()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        assert(type == "encoder" || type == "decoder");
+
+        if(type == "encoder")
+        {
+            measure<encoder_factory>();
+        }
+        else
+        {
+            measure<decoder_factory>();
+        }
+    }
+
+    void run_benchmark()
+    {
+        RUN{
+            measure_type();
+        }
+    }
+
+protected:
+
+    /// The number of symbols the factories are constructed with
+    uint32_t m_max_symbols;
+
+    /// The symbol size the factories are constructed with
+    uint32_t m_max_symbol_size;
+
+    /// The time of constructing the factory
+    double m_factory;
+
+    /// The time of the first build()
+    double m_cold_build;
+
+    /// The time of a build() from the pool
+    double m_warm_build;
+
+    /// The time of initialize()
+    double m_initialize;
+
+};
+
+/// The setup_benchmark of the Reed-Solomon codes, which also measures
+/// the construction of the generator matrix. The process-wide matrix
+/// cache is cleared before every run, so cold_build includes the
+/// construction of the matrix as for the first coder of a process. The
+/// matrix column is the construction of the matrix on its own.
+template<class Encoder, class Decoder>
+struct rs_setup_benchmark : public setup_benchmark<Encoder, Decoder>
+{
+
+    typedef setup_benchmark<Encoder, Decoder> Super;
+
+    typedef typename Super::encoder_factory encoder_factory;
+    typedef typename Super::clock_type clock_type;
+
+    /// The cache of the generator matrices shared by the stacks
+    typedef typename encoder_factory::cache_type cache_type;
+
+    void store_run(gauge::table& results)
+    {
+        Super::store_run(results);
+        results.set_value("matrix", m_matrix);
+    }
+
+    /// Measures the construction of the generator matrix
+    void measure_matrix()
+    {
+        gauge::config_set cs = Super::get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+
+        encoder_factory factory(Super::m_max_symbols,
+                                Super::m_max_symbol_size);
+
+        cache_type::instance().clear();
+
+        clock_type::time_point start = clock_type::now();
+        auto matrix = factory.construct_matrix(symbols);
+        clock_type::time_point stop = clock_type::now();
+
+        assert(matrix);
+        m_matrix = Super::to_ns(start, stop);
+
+        cache_type::instance().clear();
+    }
+
+    void run_benchmark()
+    {
+        RUN{
+            measure_matrix();
+            Super::measure_type();
+        }
+    }
+
+protected:
+
+    /// The time of constructing the generator matrix
+    double m_matrix;
+
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(setup_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(64);
+    symbols.push_back(128);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(160);
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef setup_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_setup;
+
+BENCHMARK_F(setup_rlnc_setup, FullRLNC, Binary, 100)
+{
+    run_benchmark();
+}
+
+typedef setup_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_setup8;
+
+BENCHMARK_F(setup_rlnc_setup8, FullRLNC, Binary8, 100)
+{
+    run_benchmark();
+}
+
+typedef setup_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary16>,
+    kodo::full_rlnc_decoder<fifi::binary16> > setup_rlnc_setup16;
+
+BENCHMARK_F(setup_rlnc_setup16, FullRLNC, Binary16, 100)
+{
+    run_benchmark();
+}
+
+typedef setup_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary8>,
+    kodo::seed_rlnc_decoder<fifi::binary8> > setup_seed_setup8;
+
+BENCHMARK_F(setup_seed_setup8, SeedRLNC, Binary8, 100)
+{
+    run_benchmark();
+}
+
+typedef rs_setup_benchmark<
+    kodo::rs_encoder<fifi::binary8>,
+    kodo::rs_decoder<fifi::binary8> > setup_rs_setup8;
+
+BENCHMARK_F(setup_rs_setup8, RS, Binary8, 100)
+{
+    run_benchmark();
+}
+
+typedef rs_setup_benchmark<
+    kodo::rs_encoder<fifi::binary16>,
+    kodo::rs_decoder<fifi::binary16> > setup_rs_setup16;
+
+BENCHMARK_F(setup_rs_setup16, RS, Binary16, 100)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::console_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::python_printer>());
+
+    gauge::runner::instance().printers().push_back(
+        std::make_shared<gauge::csv_printer>());
+
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+/// A data or unified cache of the processor
+struct cache_level
+{
+    /// The level, 1 for the L1 cache
+    uint32_t m_level;
+
+    /// The size in bytes
+    uint64_t m_size;
+};
+
+/// Parses a cache size of the sysfs, e.g. "32K" or "8M"
+/// @param text The size
+/// @return The size in bytes, zero if it cannot be parsed
+inline uint64_t parse_cache_size(const std::string &text)
+{
+    std::istringstream stream(text);
+
+    uint64_t size = 0;
+    std::string unit;
+
+    if(!(stream >> size))
+        return 0;
+
+    stream >> unit;
+
+    if(unit == "K")
+        size <<= 10;
+    else if(unit == "M")
+        size <<= 20;
+    else if(unit == "G")
+        size <<= 30;
+
+    return size;
+}
+
+/// Reads the data and unified caches of the first processor, from the
+/// sysfs on Linux, whose values come from cpuid on x86, or else from
+/// sysconf() where the C library provides the cache sizes
+/// @return The caches by increasing level, empty if unknown
+inline std::vector<cache_level> read_cache_hierarchy()
+{
+    std::vector<cache_level> caches;
+
+    const std::string base = "/sys/devices/system/cpu/cpu0/cache/index";
+
+    for(uint32_t i = 0; ; ++i)
+    {
+        std::ostringstream directory;
+        directory << base << i << "/";
+
+        std::ifstream level_file((directory.str() + "level").c_str());
+        std::ifstream type_file((directory.str() + "type").c_str());
+        std::ifstream size_file((directory.str() + "size").c_str());
+
+        if(!level_file || !type_file || !size_file)
+            break;
+
+        cache_level cache;
+        std::string type;
+        std::string size;
+
+        level_file >> cache.m_level;
+        type_file >> type;
+        size_file >> size;
+
+        cache.m_size = parse_cache_size(size);
+
+        if(type == "Instruction" || cache.m_size == 0)
+            continue;
+
+        caches.push_back(cache);
+    }
+
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    if(caches.empty())
+    {
+        const int names[] = { _SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE,
+                              _SC_LEVEL3_CACHE_SIZE };
+
+        for(uint32_t i = 0; i < 3; ++i)
+        {
+            long size = ::sysconf(names[i]);
+
+            if(size <= 0)
+                continue;
+
+            cache_level cache = { i + 1, static_cast<uint64_t>(size) };
+            caches.push_back(cache);
+        }
+    }
+#endif
+
+    std::sort(caches.begin(), caches.end(),
+              [](const cache_level &a, const cache_level &b)
+              { return a.m_level < b.m_level; });
+
+    return caches;
+}
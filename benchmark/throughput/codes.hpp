@@ -8,7 +8,10 @@
 
 #include <kodo/rlnc/full_vector_codes.hpp>
 #include <kodo/linear_block_decoder_delayed.hpp>
+#include <kodo/linear_block_decoder_m4ri.hpp>
 #include <kodo/sparse_uniform_generator.hpp>
+#include <kodo/sparse_geometric_generator.hpp>
+#include <kodo/sparse_symbol_id_encoder.hpp>
 
 
 namespace kodo
@@ -48,20 +51,55 @@ namespace kodo
                      > > > > > > > > > > > > > > > >
     { };
 
-    /// RLNC encoder using a density based random generator, which can be
-    /// used to control the density i.e. the number of non-zero elements in
-    /// the encoding vector.
+    /// RLNC decoder for the binary field using the Method of Four
+    /// Russians during the forward substitution. Like the delayed
+    /// decoder the backwards substitution is performed at full rank.
     template<class Field>
-    class sparse_full_rlnc_encoder :
+    class full_m4ri_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder_m4ri<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 full_m4ri_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// Sparse RLNC encoder where the positions of the non-zero
+    /// coefficients are drawn using geometric skips and passed directly
+    /// to the encoder, so the encoding cost depends on the density
+    /// rather than the number of symbols.
+    template<class Field>
+    class sparse_geometric_rlnc_encoder :
         public // Payload Codec API
                payload_encoder<
                // Codec Header API
                systematic_encoder<
-               symbol_id_encoder<
+               sparse_symbol_id_encoder<
                // Symbol ID API
                plain_symbol_id_writer<
                // Coefficient Generator API
-               sparse_uniform_generator<
+               sparse_geometric_generator<
                // Codec API
                encode_symbol_tracker<
                zero_symbol_encoder<
@@ -79,10 +117,9 @@ namespace kodo
                // Factory API
                final_coder_factory_pool<
                // Final type
-               sparse_full_rlnc_encoder<Field
+               sparse_geometric_rlnc_encoder<Field
                    > > > > > > > > > > > > > > > > >
     { };
 
 
 }
-
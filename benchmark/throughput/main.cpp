@@ -4,6 +4,15 @@
 // http://www.steinwurf.com/licensing
 
 #include <ctime>
+#include <cmath>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include <boost/make_shared.hpp>
 
@@ -15,8 +24,12 @@
 #include <kodo/rlnc/full_vector_codes.hpp>
 #include <kodo/rlnc/seed_codes.hpp>
 #include <kodo/rs/reed_solomon_codes.hpp>
+#include <kodo/ldpc/ldpc_codes.hpp>
+#include <kodo/nocode/carousel_codes.hpp>
 
 #include "codes.hpp"
+#include "perf_counters.hpp"
+#include "cache_hierarchy.hpp"
 
 /// A test block represents an encoder and decoder pair
 template<class Encoder, class Decoder>
@@ -29,6 +42,11 @@ struct throughput_benchmark : public gauge::time_benchmark
     typedef typename Decoder::factory decoder_factory;
     typedef typename Decoder::pointer decoder_ptr;
 
+    throughput_benchmark()
+        : m_perf_counters_enabled(false),
+          m_cache_sweep(false)
+    { }
+
     void init()
     {
         m_factor = 2;
@@ -39,49 +57,301 @@ struct throughput_benchmark : public gauge::time_benchmark
     {
         m_encoded_symbols = 0;
         m_decoded_symbols = 0;
+        m_encoded_bytes = 0;
+        m_decoded_bytes = 0;
         gauge::time_benchmark::start();
+
+        if(m_perf_counters_enabled)
+            m_perf_counters.start();
     }
 
     void stop()
     {
+        if(m_perf_counters_enabled)
+            m_perf_counters.stop();
+
         gauge::time_benchmark::stop();
     }
 
+    /// @return The number of bytes {en|de}coded in all iterations
+    uint64_t coded_bytes()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        if(type == "decoder")
+        {
+            return uint64_t(m_decoded_symbols) * symbol_size;
+        }
+        else if(type == "encoder")
+        {
+            return uint64_t(m_encoded_symbols) * symbol_size;
+        }
+        else
+        {
+            assert(0);
+            return 0;
+        }
+    }
+
     double measurement()
     {
         // Get the time spent per iteration
         double time = gauge::time_benchmark::measurement();
 
+        // The bytes per iteration
+        uint64_t bytes =
+            coded_bytes() / gauge::time_benchmark::iteration_count();
+
+        return bytes / time; // MB/s for each iteration
+    }
+
+    /// Opens the hardware performance counters if enabled by the
+    /// perf_counters option
+    /// @param options The benchmark options
+    void setup_perf_counters(gauge::po::variables_map& options)
+    {
+        m_perf_counters_enabled = options["perf_counters"].as<bool>();
+
+        if(!m_perf_counters_enabled)
+            return;
+
+        m_perf_counters.open();
+
+        if(!m_perf_counters.is_open())
+        {
+            std::cerr << "No hardware performance counters available, "
+                      << "the counters are stored as zero" << std::endl;
+        }
+    }
+
+    /// Stores the hardware counters per {en|de}coded byte, the counters
+    /// not available on the machine are stored as zero
+    /// @param results The result table
+    void store_perf_counters(gauge::table& results)
+    {
+        uint64_t bytes = coded_bytes();
+
+        for(uint32_t i = 0; i < perf_counters::event_count; ++i)
+        {
+            perf_counters::event e = static_cast<perf_counters::event>(i);
+
+            double per_byte = 0;
+
+            if(bytes > 0)
+            {
+                per_byte = m_perf_counters.value(e) /
+                    static_cast<double>(bytes);
+            }
+
+            results.set_value(perf_counters::name(e) + "_per_byte",
+                              per_byte);
+        }
+    }
+
+    /// @return The fraction of the bytes sent or received which are
+    ///         useful source data. For the encoder these are the symbol
+    ///         data of the payloads and for the decoder the decoded block
+    ///         of every iteration, so the headers and the non-innovative
+    ///         payloads reduce the fraction.
+    double goodput_fraction()
+    {
         gauge::config_set cs = get_current_configuration();
         std::string type = cs.get_value<std::string>("type");
         uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
 
-        // The number of bytes {en|de}coded
-        uint64_t total_bytes = 0;
-
         if(type == "decoder")
         {
-            total_bytes = m_decoded_symbols * symbol_size;
+            if(m_decoded_bytes == 0)
+                return 0;
+
+            uint64_t block_bytes = m_decoder->block_size() *
+                gauge::time_benchmark::iteration_count();
+
+            return block_bytes / static_cast<double>(m_decoded_bytes);
         }
         else if(type == "encoder")
         {
-            total_bytes = m_encoded_symbols * symbol_size;
+            if(m_encoded_bytes == 0)
+                return 0;
+
+            double symbol_bytes =
+                m_encoded_symbols * static_cast<double>(symbol_size);
+
+            return symbol_bytes / m_encoded_bytes;
         }
         else
         {
             assert(0);
+            return 0;
         }
+    }
 
-        // The bytes per iteration
-        uint64_t bytes =
-            total_bytes / gauge::time_benchmark::iteration_count();
+    /// @return The number of payloads received by the decoder beyond
+    ///         the number of symbols, relative to the number of
+    ///         symbols, i.e. the fraction of non-innovative payloads.
+    ///         The encoder does not know which payloads are innovative,
+    ///         so zero is returned for it.
+    double overhead()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
 
-        return bytes / time; // MB/s for each iteration
+        if(type != "decoder" || m_decoded_symbols == 0)
+            return 0;
+
+        double received = m_decoded_symbols /
+            static_cast<double>(gauge::time_benchmark::iteration_count());
+
+        return (received - symbols) / symbols;
     }
 
     void store_run(gauge::table& results)
     {
-        results.set_value("throughput", measurement());
+        double throughput = measurement();
+
+        results.set_value("throughput", throughput);
+
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // The bytes in front of the symbol data of the largest payload
+        results.set_value("header_bytes",
+                          m_encoder->payload_size() - symbol_size);
+
+        // The throughput of useful source data in MB/s
+        results.set_value("goodput", throughput * goodput_fraction());
+
+        // The fraction of non-innovative payloads
+        results.set_value("overhead", overhead());
+
+        if(m_perf_counters_enabled)
+            store_perf_counters(results);
+
+        if(m_cache_sweep)
+            store_cache_sweep(results);
+    }
+
+    /// @return The bytes used by a block of the coders, its symbols and
+    ///         a coefficient vector of one byte per symbol for every
+    ///         symbol, as in the binary8 field
+    /// @param symbols The number of symbols
+    /// @param symbol_size The symbol size in bytes
+    static uint64_t working_set(uint32_t symbols, uint32_t symbol_size)
+    {
+        return uint64_t(symbols) * (uint64_t(symbol_size) + symbols);
+    }
+
+    /// Stores the working set of the configuration and the sizes of the
+    /// caches, to plot the throughput against the working set with the
+    /// cache boundaries, see plot_cache_sweep.py
+    /// @param results The result table
+    void store_cache_sweep(gauge::table& results)
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        results.set_value("working_set", working_set(symbols, symbol_size));
+
+        // The columns are the same for every machine
+        for(uint32_t level = 1; level <= 3; ++level)
+        {
+            uint64_t size = 0;
+
+            for(const auto& c : m_caches)
+            {
+                if(c.m_level == level)
+                    size = c.m_size;
+            }
+
+            results.set_value("cache_l" + std::to_string(level), size);
+        }
+    }
+
+    /// Chooses the blocks to benchmark. Without the cache_sweep option
+    /// these are all combinations of the symbols and symbol_size
+    /// options. With it the symbol size is chosen for every number of
+    /// symbols so the working set grows in sweep_steps steps per
+    /// doubling from half the L1 cache to four times the last level
+    /// cache of the machine.
+    /// @param options The benchmark options
+    /// @return The number of symbols and the symbol size of the blocks
+    std::vector<std::pair<uint32_t, uint32_t> >
+    block_sizes(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+
+        std::vector<std::pair<uint32_t, uint32_t> > blocks;
+
+        m_cache_sweep = options["cache_sweep"].as<bool>();
+
+        if(!m_cache_sweep)
+        {
+            for(const auto& s : symbols)
+            {
+                for(const auto& p : symbol_size)
+                {
+                    blocks.push_back(std::make_pair(s, p));
+                }
+            }
+
+            return blocks;
+        }
+
+        uint32_t steps = options["sweep_steps"].as<uint32_t>();
+        assert(steps > 0);
+
+        m_caches = read_cache_hierarchy();
+
+        if(m_caches.empty())
+        {
+            std::cerr << "The cache sizes are unknown, sweeping from "
+                      << "16 KB to 32 MB" << std::endl;
+
+            cache_level l1 = { 1, 32 << 10 };
+            cache_level l3 = { 3, 8 << 20 };
+
+            m_caches.push_back(l1);
+            m_caches.push_back(l3);
+        }
+
+        for(const auto& c : m_caches)
+        {
+            std::cout << "L" << c.m_level << " cache: "
+                      << (c.m_size >> 10) << " KB" << std::endl;
+        }
+
+        double first = m_caches.front().m_size / 2.0;
+        double last = m_caches.back().m_size * 4.0;
+        double factor = std::pow(2.0, 1.0 / steps);
+
+        for(const auto& s : symbols)
+        {
+            uint32_t previous = 0;
+
+            for(double size = first; size <= last; size *= factor)
+            {
+                // A multiple of four bytes suits every field
+                double bytes = size / s - s;
+                uint32_t p = std::max<uint32_t>(
+                    4, static_cast<uint32_t>(bytes / 4) * 4);
+
+                if(p == previous)
+                    continue;
+
+                blocks.push_back(std::make_pair(s, p));
+                previous = p;
+            }
+        }
+
+        return blocks;
     }
 
     bool accept_measurement()
@@ -114,27 +384,22 @@ struct throughput_benchmark : public gauge::time_benchmark
 
     void get_options(gauge::po::variables_map& options)
     {
-        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
-        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
         auto types = options["type"].as<std::vector<std::string> >();
 
-        assert(symbols.size() > 0);
-        assert(symbol_size.size() > 0);
         assert(types.size() > 0);
 
-        for(uint32_t i = 0; i < symbols.size(); ++i)
+        setup_perf_counters(options);
+
+        for(const auto& b : block_sizes(options))
         {
-            for(uint32_t j = 0; j < symbol_size.size(); ++j)
+            for(uint32_t u = 0; u < types.size(); ++u)
             {
-                for(uint32_t u = 0; u < types.size(); ++u)
-                {
-                    gauge::config_set cs;
-                    cs.set_value<uint32_t>("symbols", symbols[i]);
-                    cs.set_value<uint32_t>("symbol_size", symbol_size[j]);
-                    cs.set_value<std::string>("type", types[u]);
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("symbols", b.first);
+                cs.set_value<uint32_t>("symbol_size", b.second);
+                cs.set_value<std::string>("type", types[u]);
 
-                    add_configuration(cs);
-                }
+                add_configuration(cs);
             }
         }
     }
@@ -183,6 +448,8 @@ struct throughput_benchmark : public gauge::time_benchmark
             m_payloads[i].resize( m_encoder->payload_size() );
         }
 
+        m_payload_bytes.resize(payload_count);
+
         m_temp_payload.resize( m_encoder->payload_size() );
     }
 
@@ -200,8 +467,9 @@ struct throughput_benchmark : public gauge::time_benchmark
         for(uint32_t i = 0; i < payload_count; ++i)
         {
             std::vector<uint8_t> &payload = m_payloads[i];
-            m_encoder->encode(&payload[0]);
+            m_payload_bytes[i] = m_encoder->encode(&payload[0]);
 
+            m_encoded_bytes += m_payload_bytes[i];
             ++m_encoded_symbols;
         }
     }
@@ -218,6 +486,7 @@ struct throughput_benchmark : public gauge::time_benchmark
 
             m_decoder->decode(&m_temp_payload[0]);
 
+            m_decoded_bytes += m_payload_bytes[i];
             ++m_decoded_symbols;
 
             if(m_decoder->is_complete())
@@ -250,7 +519,9 @@ struct throughput_benchmark : public gauge::time_benchmark
     /// Run the decoder
     void run_decode()
     {
-        // Encode some data
+        // Encode some data, starting a fresh generation since e.g. the
+        // tunable density generator depends on the symbols encoded
+        m_encoder->initialize(*m_encoder_factory);
         encode_payloads();
 
         gauge::config_set cs = get_current_configuration();
@@ -314,6 +585,12 @@ protected:
     /// The number of symbols decoded
     uint32_t m_decoded_symbols;
 
+    /// The number of payload bytes produced by the encoder
+    uint64_t m_encoded_bytes;
+
+    /// The number of payload bytes passed to the decoder
+    uint64_t m_decoded_bytes;
+
     /// The data encoded
     std::vector<uint8_t> m_encoded_data;
 
@@ -324,9 +601,24 @@ protected:
     /// Storage for encoded symbols
     std::vector< std::vector<uint8_t> > m_payloads;
 
+    /// The number of bytes used by each of the encoded payloads
+    std::vector<uint32_t> m_payload_bytes;
+
     /// Multiplication factor for payload_count
     uint32_t m_factor;
 
+    /// True if the hardware performance counters are collected
+    bool m_perf_counters_enabled;
+
+    /// The hardware performance counters of the benchmark thread
+    perf_counters m_perf_counters;
+
+    /// True if the block sizes sweep the caches
+    bool m_cache_sweep;
+
+    /// The caches of the machine, read for the cache sweep
+    std::vector<cache_level> m_caches;
+
 };
 
 
@@ -347,32 +639,27 @@ public:
 
     void get_options(gauge::po::variables_map& options)
     {
-        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
-        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
         auto types = options["type"].as<std::vector<std::string> >();
         auto density = options["density"].as<std::vector<double> >();
 
-        assert(symbols.size() > 0);
-        assert(symbol_size.size() > 0);
         assert(types.size() > 0);
         assert(density.size() > 0);
 
-        for(const auto& s : symbols)
+        Super::setup_perf_counters(options);
+
+        for(const auto& b : Super::block_sizes(options))
         {
-            for(const auto& p : symbol_size)
+            for(const auto& t : types)
             {
-                for(const auto& t : types)
+                for(const auto& d: density)
                 {
-                    for(const auto& d: density)
-                    {
-                        gauge::config_set cs;
-                        cs.set_value<uint32_t>("symbols", s);
-                        cs.set_value<uint32_t>("symbol_size", p);
-                        cs.set_value<std::string>("type", t);
-                        cs.set_value<double>("density", d);
+                    gauge::config_set cs;
+                    cs.set_value<uint32_t>("symbols", b.first);
+                    cs.set_value<uint32_t>("symbol_size", b.second);
+                    cs.set_value<std::string>("type", t);
+                    cs.set_value<double>("density", d);
 
-                        Super::add_configuration(cs);
-                    }
+                    Super::add_configuration(cs);
                 }
             }
         }
@@ -392,87 +679,582 @@ public:
 
 
 
-/// Using this macro we may specify options. For specifying options
-/// we use the boost program options library. So you may additional
-/// details on how to do it in the manual for that library.
-BENCHMARK_OPTION(throughput_options)
+/// Benchmark running independent encoder and decoder pairs on a number
+/// of threads, each pinned to its own core where supported. The
+/// benchmark reports the aggregate throughput of all threads, the mean
+/// throughput of a thread and the scaling efficiency, i.e. the
+/// aggregate throughput relative to the number of threads times the
+/// throughput of a single pair running alone. An efficiency well below
+/// one shows the saturation of the memory bandwidth, or with the
+/// shared_factory option the false sharing in the factory used by the
+/// coders of all threads.
+template<class Encoder, class Decoder>
+struct multicore_throughput_benchmark : public gauge::time_benchmark
 {
-    gauge::po::options_description options;
 
-    std::vector<uint32_t> symbols;
-    symbols.push_back(16);
-    symbols.push_back(32);
-    symbols.push_back(64);
-    symbols.push_back(128);
+    typedef typename Encoder::factory encoder_factory;
+    typedef typename Encoder::pointer encoder_ptr;
 
-    auto default_symbols =
-        gauge::po::value<std::vector<uint32_t> >()->default_value(
-            symbols, "")->multitoken();
+    typedef typename Decoder::factory decoder_factory;
+    typedef typename Decoder::pointer decoder_ptr;
 
-    std::vector<uint32_t> symbol_size;
-    symbol_size.push_back(1600);
+    /// The state of the encoder and decoder pair of a thread
+    struct coder_pair
+    {
+        /// The encoder factory
+        std::shared_ptr<encoder_factory> m_encoder_factory;
 
-    auto default_symbol_size =
-        gauge::po::value<std::vector<uint32_t> >()->default_value(
-            symbol_size, "")->multitoken();
+        /// The decoder factory
+        std::shared_ptr<decoder_factory> m_decoder_factory;
 
-    std::vector<std::string> types;
-    types.push_back("encoder");
-    types.push_back("decoder");
+        /// The encoder of the thread
+        encoder_ptr m_encoder;
 
-    auto default_types =
-        gauge::po::value<std::vector<std::string> >()->default_value(
-            types, "")->multitoken();
+        /// The decoder of the thread
+        decoder_ptr m_decoder;
 
-    options.add_options()
-        ("symbols", default_symbols, "Set the number of symbols");
+        /// The data encoded
+        std::vector<uint8_t> m_encoded_data;
 
-    options.add_options()
-        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+        /// Temporary payload to not destroy the already encoded payloads
+        /// when decoding
+        std::vector<uint8_t> m_temp_payload;
 
-    options.add_options()
-        ("type", default_types, "Set type [encoder|decoder]");
+        /// Storage for encoded symbols
+        std::vector< std::vector<uint8_t> > m_payloads;
 
-    gauge::runner::instance().register_options(options);
-}
+        /// The number of symbols encoded
+        uint64_t m_encoded_symbols;
 
-BENCHMARK_OPTION(throughput_density_options)
-{
-    gauge::po::options_description options;
+        /// The number of symbols decoded
+        uint64_t m_decoded_symbols;
 
-    std::vector<double> density;
-    density.push_back(0.1);
-    density.push_back(0.2);
-    density.push_back(0.3);
-    density.push_back(0.4);
-    density.push_back(0.5);
+        /// The time spent by the thread in microseconds
+        double m_time;
+    };
 
-    auto default_density =
-        gauge::po::value<std::vector<double> >()->default_value(
-            density, "")->multitoken();
+    typedef std::shared_ptr<coder_pair> coder_pair_ptr;
 
-    options.add_options()
-        ("density", default_density, "Set the density of the sparse codes");
+    void init()
+    {
+        m_factor = 2;
+        gauge::time_benchmark::init();
+    }
 
-    gauge::runner::instance().register_options(options);
-}
+    void start()
+    {
+        for(auto& p : m_pairs)
+        {
+            p->m_encoded_symbols = 0;
+            p->m_decoded_symbols = 0;
+            p->m_time = 0;
+        }
 
+        gauge::time_benchmark::start();
+    }
 
-typedef throughput_benchmark<
-    kodo::full_rlnc_encoder<fifi::binary>,
-    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_throughput;
+    void stop()
+    {
+        gauge::time_benchmark::stop();
+    }
 
-BENCHMARK_F(setup_rlnc_throughput, FullRLNC, Binary, 5)
-{
-    run_benchmark();
-}
+    /// @param pair The coder pair
+    /// @return The number of bytes coded by the pair
+    uint64_t coded_bytes(const coder_pair &pair)
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
 
-typedef throughput_benchmark<
-    kodo::full_rlnc_encoder<fifi::binary8>,
-    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_throughput8;
+        if(type == "decoder")
+        {
+            return pair.m_decoded_symbols * symbol_size;
+        }
+        else if(type == "encoder")
+        {
+            return pair.m_encoded_symbols * symbol_size;
+        }
+        else
+        {
+            assert(0);
+            return 0;
+        }
+    }
 
-BENCHMARK_F(setup_rlnc_throughput8, FullRLNC, Binary8, 5)
-{
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        uint64_t total_bytes = 0;
+
+        for(const auto& p : m_pairs)
+        {
+            total_bytes += coded_bytes(*p);
+        }
+
+        // The bytes per iteration
+        uint64_t bytes =
+            total_bytes / gauge::time_benchmark::iteration_count();
+
+        return bytes / time; // Aggregate MB/s for each iteration
+    }
+
+    /// @return The mean throughput of a thread in MB/s
+    double thread_measurement()
+    {
+        double throughput = 0;
+
+        for(const auto& p : m_pairs)
+        {
+            if(p->m_time > 0)
+            {
+                throughput += coded_bytes(*p) / p->m_time;
+            }
+        }
+
+        return throughput / m_pairs.size();
+    }
+
+    void store_run(gauge::table& results)
+    {
+        double aggregate = measurement();
+
+        results.set_value("throughput", aggregate);
+        results.set_value("thread_throughput", thread_measurement());
+
+        double efficiency = 0;
+
+        if(m_baseline > 0)
+        {
+            efficiency = aggregate / (m_pairs.size() * m_baseline);
+        }
+
+        results.set_value("efficiency", efficiency);
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        std::string type = cs.get_value<std::string>("type");
+
+        if(type == "decoder")
+        {
+            for(const auto& p : m_pairs)
+            {
+                // We did not generate enough payloads to decode
+                // successfully, so we will generate more payloads for
+                // next run
+                if(!p->m_decoder->is_complete())
+                {
+                    m_factor++;
+                    return false;
+                }
+            }
+        }
+
+        return gauge::time_benchmark::accept_measurement();
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto types = options["type"].as<std::vector<std::string> >();
+        auto threads = options["threads"].as<std::vector<uint32_t> >();
+        auto shared_factory = options["shared_factory"].as<bool>();
+
+        assert(symbols.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(types.size() > 0);
+        assert(threads.size() > 0);
+
+        for(const auto& s : symbols)
+        {
+            for(const auto& p : symbol_size)
+            {
+                for(const auto& t : types)
+                {
+                    for(const auto& n : threads)
+                    {
+                        assert(n > 0);
+
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("symbols", s);
+                        cs.set_value<uint32_t>("symbol_size", p);
+                        cs.set_value<std::string>("type", t);
+                        cs.set_value<uint32_t>("threads", n);
+                        cs.set_value<bool>("shared_factory", shared_factory);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t threads = cs.get_value<uint32_t>("threads");
+        bool shared_factory = cs.get_value<bool>("shared_factory");
+        std::string type = cs.get_value<std::string>("type");
+
+        m_pairs.resize(threads);
+
+        for(uint32_t i = 0; i < threads; ++i)
+        {
+            m_pairs[i] = std::make_shared<coder_pair>();
+            coder_pair &pair = *m_pairs[i];
+
+            if(shared_factory && i > 0)
+            {
+                pair.m_encoder_factory = m_pairs[0]->m_encoder_factory;
+                pair.m_decoder_factory = m_pairs[0]->m_decoder_factory;
+            }
+            else
+            {
+                pair.m_encoder_factory = std::make_shared<encoder_factory>(
+                    symbols, symbol_size);
+
+                pair.m_decoder_factory = std::make_shared<decoder_factory>(
+                    symbols, symbol_size);
+            }
+
+            pair.m_encoder_factory->set_symbols(symbols);
+            pair.m_encoder_factory->set_symbol_size(symbol_size);
+
+            pair.m_decoder_factory->set_symbols(symbols);
+            pair.m_decoder_factory->set_symbol_size(symbol_size);
+
+            pair.m_encoder = pair.m_encoder_factory->build();
+            pair.m_decoder = pair.m_decoder_factory->build();
+
+            // Prepare the data to be encoded
+            pair.m_encoded_data.resize(pair.m_encoder->block_size());
+
+            for(uint8_t &e : pair.m_encoded_data)
+            {
+                e = rand() % 256;
+            }
+
+            pair.m_encoder->set_symbols(sak::storage(pair.m_encoded_data));
+
+            // Prepare storage to the encoded payloads
+            uint32_t payload_count = symbols * m_factor;
+
+            pair.m_payloads.resize(payload_count);
+            for(uint32_t j = 0; j < payload_count; ++j)
+            {
+                pair.m_payloads[j].resize(pair.m_encoder->payload_size());
+            }
+
+            pair.m_temp_payload.resize(pair.m_encoder->payload_size());
+
+            // The decoders decode the same payloads in every iteration
+            if(type == "decoder")
+            {
+                encode_payloads(pair);
+            }
+        }
+
+        m_baseline = measure_baseline(type);
+    }
+
+    /// Measures the throughput of the first pair running alone, used as
+    /// the reference of the scaling efficiency
+    /// @param type The type of coder benchmarked [encoder|decoder]
+    /// @return The throughput in MB/s
+    double measure_baseline(const std::string &type)
+    {
+        coder_pair &pair = *m_pairs[0];
+
+        const uint32_t runs = 5;
+
+        // Warm up the caches before the measurement
+        run_pair(pair, type);
+
+        pair.m_encoded_symbols = 0;
+        pair.m_decoded_symbols = 0;
+        pair.m_time = 0;
+
+        for(uint32_t i = 0; i < runs; ++i)
+        {
+            run_pair(pair, type);
+        }
+
+        if(pair.m_time <= 0)
+        {
+            return 0;
+        }
+
+        return coded_bytes(pair) / pair.m_time;
+    }
+
+    /// Pins the calling thread to a core
+    /// @param core The index of the core, wrapped around the number of
+    ///        cores
+    static void pin_thread(uint32_t core)
+    {
+#if defined(__linux__)
+        uint32_t cores = std::max(1U, std::thread::hardware_concurrency());
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(core % cores, &cpu_set);
+
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+        (void) core;
+#endif
+    }
+
+    void encode_payloads(coder_pair &pair)
+    {
+        pair.m_encoder->set_symbols(sak::storage(pair.m_encoded_data));
+
+        // We switch any systematic operations off so we code
+        // symbols from the beginning
+        if(kodo::is_systematic_encoder(pair.m_encoder))
+            kodo::set_systematic_off(pair.m_encoder);
+
+        for(auto& payload : pair.m_payloads)
+        {
+            pair.m_encoder->encode(&payload[0]);
+            ++pair.m_encoded_symbols;
+        }
+    }
+
+    void decode_payloads(coder_pair &pair)
+    {
+        for(const auto& payload : pair.m_payloads)
+        {
+            std::copy(payload.begin(), payload.end(),
+                      pair.m_temp_payload.begin());
+
+            pair.m_decoder->decode(&pair.m_temp_payload[0]);
+
+            ++pair.m_decoded_symbols;
+
+            if(pair.m_decoder->is_complete())
+            {
+                return;
+            }
+        }
+    }
+
+    /// Runs one iteration of the pair and adds its time
+    /// @param pair The coder pair
+    /// @param type The type of coder benchmarked [encoder|decoder]
+    void run_pair(coder_pair &pair, const std::string &type)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        if(type == "encoder")
+        {
+            // We have to make sure the encoder is in a "clean" state
+            pair.m_encoder->initialize(*pair.m_encoder_factory);
+            encode_payloads(pair);
+        }
+        else if(type == "decoder")
+        {
+            // We have to make sure the decoder is in a "clean" state
+            // i.e. no symbols already decoded.
+            pair.m_decoder->initialize(*pair.m_decoder_factory);
+            decode_payloads(pair);
+        }
+        else
+        {
+            assert(0);
+        }
+
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        pair.m_time += std::chrono::duration_cast<
+            std::chrono::microseconds>(stop - start).count();
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        // The clock is running
+        RUN{
+            std::vector<std::thread> threads;
+
+            for(uint32_t i = 0; i < m_pairs.size(); ++i)
+            {
+                threads.push_back(std::thread([this, i, &type]()
+                    {
+                        pin_thread(i);
+                        run_pair(*m_pairs[i], type);
+                    }));
+            }
+
+            for(auto& t : threads)
+            {
+                t.join();
+            }
+        }
+    }
+
+protected:
+
+    /// The coder pairs, one per thread, allocated separately to keep
+    /// their counters on separate cache lines
+    std::vector<coder_pair_ptr> m_pairs;
+
+    /// The throughput of a single pair running alone in MB/s
+    double m_baseline;
+
+    /// Multiplication factor for payload_count
+    uint32_t m_factor;
+
+};
+
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(throughput_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+    symbols.push_back(32);
+    symbols.push_back(64);
+    symbols.push_back(128);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1600);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    options.add_options()
+        ("perf_counters", gauge::po::value<bool>()->default_value(
+            false, ""), "Store the hardware performance counters per "
+         "coded byte, cycles, instructions, L1 data and last level cache "
+         "misses and branch misses");
+
+    options.add_options()
+        ("cache_sweep", gauge::po::value<bool>()->default_value(
+            false, ""), "Sweep the symbol size of every number of symbols "
+         "so the working set crosses the caches of the machine, and store "
+         "the working set and the cache sizes, see plot_cache_sweep.py");
+
+    options.add_options()
+        ("sweep_steps", gauge::po::value<uint32_t>()->default_value(4),
+         "Set the steps per doubling of the working set of the "
+         "cache_sweep");
+
+    gauge::runner::instance().register_options(options);
+}
+
+BENCHMARK_OPTION(throughput_density_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<double> density;
+    density.push_back(0.1);
+    density.push_back(0.2);
+    density.push_back(0.3);
+    density.push_back(0.4);
+    density.push_back(0.5);
+
+    auto default_density =
+        gauge::po::value<std::vector<double> >()->default_value(
+            density, "")->multitoken();
+
+    options.add_options()
+        ("density", default_density, "Set the density of the sparse codes");
+
+    gauge::runner::instance().register_options(options);
+}
+
+
+BENCHMARK_OPTION(throughput_multicore_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> threads;
+    threads.push_back(1);
+    threads.push_back(2);
+    threads.push_back(4);
+
+    auto default_threads =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            threads, "")->multitoken();
+
+    options.add_options()
+        ("threads", default_threads,
+         "Set the number of threads of the multicore benchmarks");
+
+    options.add_options()
+        ("shared_factory", gauge::po::value<bool>()->default_value(
+            false, ""), "Set the threads of the multicore benchmarks to "
+         "build their coders with a shared factory");
+
+    gauge::runner::instance().register_options(options);
+}
+
+typedef throughput_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> > setup_rlnc_throughput;
+
+BENCHMARK_F(setup_rlnc_throughput, FullRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary4>,
+    kodo::full_rlnc_decoder<fifi::binary4> > setup_rlnc_throughput4;
+
+BENCHMARK_F(setup_rlnc_throughput4, FullRLNC, Binary4, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> > setup_rlnc_throughput8;
+
+BENCHMARK_F(setup_rlnc_throughput8, FullRLNC, Binary8, 5)
+{
     run_benchmark();
 }
 
@@ -494,6 +1276,48 @@ BENCHMARK_F(setup_rlnc_throughput2325, FullRLNC, Prime2325, 5)
     run_benchmark();
 }
 
+/// The vectorized region kernels
+
+typedef throughput_benchmark<
+    kodo::simd_full_rlnc_encoder<fifi::binary4>,
+    kodo::simd_full_rlnc_decoder<fifi::binary4> >
+    setup_simd_rlnc_throughput4;
+
+BENCHMARK_F(setup_simd_rlnc_throughput4, SimdFullRLNC, Binary4, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::simd_full_rlnc_encoder<fifi::binary8>,
+    kodo::simd_full_rlnc_decoder<fifi::binary8> >
+    setup_simd_rlnc_throughput8;
+
+BENCHMARK_F(setup_simd_rlnc_throughput8, SimdFullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::simd_full_rlnc_encoder<fifi::binary16>,
+    kodo::simd_full_rlnc_decoder<fifi::binary16> >
+    setup_simd_rlnc_throughput16;
+
+BENCHMARK_F(setup_simd_rlnc_throughput16, SimdFullRLNC, Binary16, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::simd_full_rlnc_encoder<fifi::prime2325>,
+    kodo::simd_full_rlnc_decoder<fifi::prime2325> >
+    setup_simd_rlnc_throughput2325;
+
+BENCHMARK_F(setup_simd_rlnc_throughput2325, SimdFullRLNC, Prime2325, 5)
+{
+    run_benchmark();
+}
+
 typedef throughput_benchmark<
    kodo::full_rlnc_encoder<fifi::binary>,
    kodo::full_delayed_rlnc_decoder<fifi::binary> >
@@ -534,6 +1358,16 @@ BENCHMARK_F(setup_delayed_rlnc_throughput2325, FullDelayedRLNC, Prime2325, 5)
    run_benchmark();
 }
 
+typedef throughput_benchmark<
+   kodo::full_rlnc_encoder<fifi::binary>,
+   kodo::full_m4ri_rlnc_decoder<fifi::binary> >
+   setup_m4ri_rlnc_throughput;
+
+BENCHMARK_F(setup_m4ri_rlnc_throughput, FullM4riRLNC, Binary, 5)
+{
+   run_benchmark();
+}
+
 /// Sparse
 
 typedef sparse_throughput_benchmark<
@@ -563,6 +1397,190 @@ BENCHMARK_F(setup_sparse_rlnc_throughput16, SparseFullRLNC, Binary16, 5)
     run_benchmark();
 }
 
+/// The Markowitz pivots lower the fill-in of the sparse symbols
+
+typedef sparse_throughput_benchmark<
+    kodo::sparse_full_rlnc_encoder<fifi::binary>,
+    kodo::markowitz_full_rlnc_decoder<fifi::binary> >
+    setup_markowitz_sparse_rlnc_throughput;
+
+BENCHMARK_F(setup_markowitz_sparse_rlnc_throughput,
+            SparseFullRLNCMarkowitz, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef sparse_throughput_benchmark<
+    kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+    kodo::markowitz_full_rlnc_decoder<fifi::binary8> >
+    setup_markowitz_sparse_rlnc_throughput8;
+
+BENCHMARK_F(setup_markowitz_sparse_rlnc_throughput8,
+            SparseFullRLNCMarkowitz, Binary8, 5)
+{
+    run_benchmark();
+}
+
+/// The density of the tunable sparse codes is the density option
+/// until the decoder approaches full rank
+
+typedef sparse_throughput_benchmark<
+    kodo::tunable_sparse_full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> >
+    setup_tunable_sparse_rlnc_throughput;
+
+BENCHMARK_F(setup_tunable_sparse_rlnc_throughput,
+            TunableSparseFullRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef sparse_throughput_benchmark<
+    kodo::tunable_sparse_full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> >
+    setup_tunable_sparse_rlnc_throughput8;
+
+BENCHMARK_F(setup_tunable_sparse_rlnc_throughput8,
+            TunableSparseFullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef sparse_throughput_benchmark<
+    kodo::sparse_geometric_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> >
+    setup_sparse_geometric_rlnc_throughput;
+
+BENCHMARK_F(setup_sparse_geometric_rlnc_throughput,
+            SparseGeometricRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef sparse_throughput_benchmark<
+    kodo::sparse_geometric_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> >
+    setup_sparse_geometric_rlnc_throughput8;
+
+BENCHMARK_F(setup_sparse_geometric_rlnc_throughput8,
+            SparseGeometricRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+
+/// Reed-Solomon
+
+typedef throughput_benchmark<
+    kodo::rs_encoder<fifi::binary8>,
+    kodo::rs_decoder<fifi::binary8> > setup_rs_throughput8;
+
+BENCHMARK_F(setup_rs_throughput8, RS, Binary8, 5)
+{
+    run_benchmark();
+}
+
+/// LDPC-staircase
+
+typedef throughput_benchmark<
+    kodo::ldpc_encoder,
+    kodo::ldpc_decoder> setup_ldpc_throughput;
+
+BENCHMARK_F(setup_ldpc_throughput, LDPCStaircase, Binary, 5)
+{
+    run_benchmark();
+}
+
+/// Seed
+
+typedef throughput_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary>,
+    kodo::seed_rlnc_decoder<fifi::binary> > setup_seed_rlnc_throughput;
+
+BENCHMARK_F(setup_seed_rlnc_throughput, SeedRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary4>,
+    kodo::seed_rlnc_decoder<fifi::binary4> > setup_seed_rlnc_throughput4;
+
+BENCHMARK_F(setup_seed_rlnc_throughput4, SeedRLNC, Binary4, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary8>,
+    kodo::seed_rlnc_decoder<fifi::binary8> > setup_seed_rlnc_throughput8;
+
+BENCHMARK_F(setup_seed_rlnc_throughput8, SeedRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::seed_rlnc_encoder<fifi::binary16>,
+    kodo::seed_rlnc_decoder<fifi::binary16> > setup_seed_rlnc_throughput16;
+
+BENCHMARK_F(setup_seed_rlnc_throughput16, SeedRLNC, Binary16, 5)
+{
+    run_benchmark();
+}
+
+typedef throughput_benchmark<
+    kodo::simd_seed_rlnc_encoder<fifi::binary4>,
+    kodo::simd_seed_rlnc_decoder<fifi::binary4> >
+    setup_simd_seed_rlnc_throughput4;
+
+BENCHMARK_F(setup_simd_seed_rlnc_throughput4, SimdSeedRLNC, Binary4, 5)
+{
+    run_benchmark();
+}
+
+/// Carousel
+
+typedef throughput_benchmark<
+    kodo::nocode_carousel_encoder,
+    kodo::nocode_carousel_decoder> setup_carousel_throughput;
+
+BENCHMARK_F(setup_carousel_throughput, Carousel, Binary, 5)
+{
+    run_benchmark();
+}
+
+/// Multicore
+
+typedef multicore_throughput_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary>,
+    kodo::full_rlnc_decoder<fifi::binary> >
+    setup_multicore_rlnc_throughput;
+
+BENCHMARK_F(setup_multicore_rlnc_throughput, MulticoreFullRLNC, Binary, 5)
+{
+    run_benchmark();
+}
+
+typedef multicore_throughput_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary8>,
+    kodo::full_rlnc_decoder<fifi::binary8> >
+    setup_multicore_rlnc_throughput8;
+
+BENCHMARK_F(setup_multicore_rlnc_throughput8, MulticoreFullRLNC, Binary8, 5)
+{
+    run_benchmark();
+}
+
+typedef multicore_throughput_benchmark<
+    kodo::full_rlnc_encoder<fifi::binary16>,
+    kodo::full_rlnc_decoder<fifi::binary16> >
+    setup_multicore_rlnc_throughput16;
+
+BENCHMARK_F(setup_multicore_rlnc_throughput16, MulticoreFullRLNC, Binary16, 5)
+{
+    run_benchmark();
+}
 
 
 
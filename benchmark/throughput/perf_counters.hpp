@@ -0,0 +1,213 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/// Hardware performance counters of the calling thread read with
+/// perf_event_open on Linux. Every counter is opened on its own, so a
+/// counter not supported by the processor or not permitted by the
+/// kernel (see /proc/sys/kernel/perf_event_paranoid) reads as zero
+/// without affecting the others. On other platforms all counters read
+/// as zero. Only the user space work is counted.
+class perf_counters : boost::noncopyable
+{
+public:
+
+    /// The counted events
+    enum event
+    {
+        cycles = 0,
+        instructions,
+        l1d_misses,
+        llc_misses,
+        branch_misses,
+        event_count
+    };
+
+public:
+
+    /// Constructor
+    perf_counters()
+        : m_fds(event_count, -1),
+          m_values(event_count, 0)
+    { }
+
+    /// Destructor
+    ~perf_counters()
+    {
+        close();
+    }
+
+    /// Opens the counters, the counters already open are kept
+    void open()
+    {
+#if defined(__linux__)
+        open_event(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+
+        open_event(instructions, PERF_TYPE_HARDWARE,
+                   PERF_COUNT_HW_INSTRUCTIONS);
+
+        open_event(l1d_misses, PERF_TYPE_HW_CACHE,
+                   cache_config(PERF_COUNT_HW_CACHE_L1D));
+
+        open_event(llc_misses, PERF_TYPE_HW_CACHE,
+                   cache_config(PERF_COUNT_HW_CACHE_LL));
+
+        open_event(branch_misses, PERF_TYPE_HARDWARE,
+                   PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    /// Closes the counters
+    void close()
+    {
+#if defined(__linux__)
+        for(auto& fd : m_fds)
+        {
+            if(fd >= 0)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+#endif
+    }
+
+    /// @return True if at least one counter is open
+    bool is_open() const
+    {
+        for(const auto& fd : m_fds)
+        {
+            if(fd >= 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    /// Resets and starts the counters
+    void start()
+    {
+        std::fill(m_values.begin(), m_values.end(), 0);
+
+#if defined(__linux__)
+        for(const auto& fd : m_fds)
+        {
+            if(fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    /// Stops the counters and reads their values
+    void stop()
+    {
+#if defined(__linux__)
+        for(uint32_t i = 0; i < m_fds.size(); ++i)
+        {
+            if(m_fds[i] < 0)
+                continue;
+
+            ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+            uint64_t value = 0;
+            if(read(m_fds[i], &value, sizeof(value)) == sizeof(value))
+            {
+                m_values[i] = value;
+            }
+        }
+#endif
+    }
+
+    /// @param e The event
+    /// @return The count of the event between the last start() and
+    ///         stop(), zero if the counter is not available
+    uint64_t value(event e) const
+    {
+        return m_values[e];
+    }
+
+    /// @param e The event
+    /// @return The name of the event used in the benchmark results
+    static std::string name(event e)
+    {
+        static const char *names[event_count] =
+            {
+                "cycles",
+                "instructions",
+                "l1d_misses",
+                "llc_misses",
+                "branch_misses"
+            };
+
+        return names[e];
+    }
+
+private:
+
+#if defined(__linux__)
+
+    /// @param cache The cache of a PERF_TYPE_HW_CACHE event
+    /// @return The configuration counting the read misses of the cache
+    static uint64_t cache_config(uint64_t cache)
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    /// Opens a counter
+    /// @param e The event of the counter
+    /// @param type The perf event type
+    /// @param config The perf event configuration
+    void open_event(event e, uint32_t type, uint64_t config)
+    {
+        if(m_fds[e] >= 0)
+            return;
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // The counter of the calling thread on any processor
+        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+        m_fds[e] = static_cast<int>(fd);
+    }
+
+#endif
+
+private:
+
+    /// The file descriptors of the counters, negative if not open
+    std::vector<int> m_fds;
+
+    /// The values read at the last stop()
+    std::vector<uint64_t> m_values;
+
+};
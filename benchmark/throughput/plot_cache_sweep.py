@@ -0,0 +1,56 @@
+# This simple script plots the csv file produced by the throughput
+# benchmark with the cache_sweep option: the throughput of every stack
+# against the working set of the block, with a vertical line at the size
+# of every cache of the machine.
+#
+# To ensure the plots look right you need to use pandas version >= 0.11.0.
+# You can check which version you are on by running:
+# >>> import pandas
+# >>> pandas.__version__
+
+import argparse
+import pandas as pd
+import pylab as plt
+
+def plot_cache_sweep(csvfile):
+
+    df = pd.read_csv(csvfile)
+
+    caches = [('L1', 'cache_l1'), ('L2', 'cache_l2'), ('L3', 'cache_l3')]
+
+    for (type, symbols), group in df.groupby(by=['type', 'symbols']):
+
+        group = group.copy()
+        group['test'] = group['testcase'] + ' ' + group['benchmark']
+
+        mean = group.groupby(by=['working_set', 'test'])['throughput']
+        mean = mean.mean().unstack(level=1)
+
+        ax = mean.plot(logx=True, title='Throughput {} {} symbols'.format(
+            type, symbols))
+
+        ax.set_xlabel('working set [B]')
+        ax.set_ylabel('MB/s')
+
+        for name, column in caches:
+            size = group[column].max()
+
+            if size > 0:
+                ax.axvline(size, color='grey', linestyle='--')
+                ax.text(size, ax.get_ylim()[1], ' ' + name,
+                        verticalalignment='top')
+
+    plt.show()
+
+if __name__ == '__main__':
+
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument(
+        '--csv_file', dest='csvfile', action='store',
+        help='the .csv file written by gauge benchmark',
+        default='out.csv')
+
+    args = parser.parse_args()
+
+    plot_cache_sweep(args.csvfile)
@@ -0,0 +1,178 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @example decode_trace.cpp
+///
+/// Offline tool printing a trace file written from the events of the
+/// trace_decoder layer, see kodo::trace_collector. For every decoder it
+/// prints the number of received, non-innovative and swap decoded
+/// symbols and the time from the first received symbol until the
+/// decoder completed. With --events every event is printed as well.
+///
+/// Usage: decode_trace <trace file> [--events]
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <kodo/trace_ring.hpp>
+
+/// The summary of the events of a decoder
+struct coder_summary
+{
+    coder_summary()
+        : m_received(0),
+          m_non_innovative(0),
+          m_swap_decodes(0),
+          m_completed(0),
+          m_first(0),
+          m_complete_ticks(0)
+    { }
+
+    /// The symbols received
+    uint32_t m_received;
+
+    /// The symbols which did not increase the rank
+    uint32_t m_non_innovative;
+
+    /// The coded symbols decoded again
+    uint32_t m_swap_decodes;
+
+    /// The number of times the decoder completed
+    uint32_t m_completed;
+
+    /// The time stamp of the first received symbol of the generation
+    uint64_t m_first;
+
+    /// The ticks from the first received symbol until complete, summed
+    /// over the completed generations
+    uint64_t m_complete_ticks;
+};
+
+/// @param type The event type
+/// @return The name of the event type
+const char* event_name(uint8_t type)
+{
+    switch(static_cast<kodo::trace_event_type>(type))
+    {
+    case kodo::trace_event_type::received:
+        return "received";
+    case kodo::trace_event_type::pivot_found:
+        return "pivot_found";
+    case kodo::trace_event_type::non_innovative:
+        return "non_innovative";
+    case kodo::trace_event_type::swap_decode:
+        return "swap_decode";
+    case kodo::trace_event_type::complete:
+        return "complete";
+    }
+
+    return "unknown";
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace file> [--events]"
+                  << std::endl;
+        return 1;
+    }
+
+    bool print_events = argc > 2 && std::strcmp(argv[2], "--events") == 0;
+
+    std::ifstream in(argv[1], std::ios::binary);
+
+    kodo::trace_file_header header;
+    std::vector<kodo::trace_event> events;
+
+    if(!in || !kodo::read_trace(in, header, events))
+    {
+        std::cerr << "Not a trace file: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << events.size() << " events, " << header.m_dropped
+              << " dropped" << std::endl;
+
+    if(events.empty())
+    {
+        return 0;
+    }
+
+    uint64_t start = events[0].m_timestamp;
+
+    for(const auto &event : events)
+    {
+        start = std::min(start, event.m_timestamp);
+    }
+
+    std::map<uint32_t, coder_summary> coders;
+
+    for(const auto &event : events)
+    {
+        coder_summary &summary = coders[event.m_coder];
+
+        switch(static_cast<kodo::trace_event_type>(event.m_type))
+        {
+        case kodo::trace_event_type::received:
+            // The first symbol of a generation is received at rank zero
+            if(event.m_value == 0 || summary.m_received == 0)
+            {
+                summary.m_first = event.m_timestamp;
+            }
+            ++summary.m_received;
+            break;
+        case kodo::trace_event_type::non_innovative:
+            ++summary.m_non_innovative;
+            break;
+        case kodo::trace_event_type::swap_decode:
+            ++summary.m_swap_decodes;
+            break;
+        case kodo::trace_event_type::complete:
+            ++summary.m_completed;
+            summary.m_complete_ticks += event.m_timestamp - summary.m_first;
+            break;
+        default:
+            break;
+        }
+
+        if(print_events)
+        {
+            double ns = (event.m_timestamp - start) / header.m_ticks_per_ns;
+
+            std::cout << ns << " ns coder " << event.m_coder << " "
+                      << event_name(event.m_type) << " "
+                      << event.m_value << std::endl;
+        }
+    }
+
+    std::cout << "coder received non_innovative swap_decodes completed "
+              << "mean_complete_us" << std::endl;
+
+    for(const auto &c : coders)
+    {
+        const coder_summary &summary = c.second;
+
+        double mean_us = 0;
+
+        if(summary.m_completed > 0)
+        {
+            mean_us = summary.m_complete_ticks / header.m_ticks_per_ns /
+                summary.m_completed / 1000.0;
+        }
+
+        std::cout << c.first << " " << summary.m_received << " "
+                  << summary.m_non_innovative << " "
+                  << summary.m_swap_decodes << " "
+                  << summary.m_completed << " " << mean_us << std::endl;
+    }
+
+    return 0;
+}
@@ -5,20 +5,25 @@
 
 #include <kodo/rlnc/full_vector_codes.hpp>
 #include <kodo/storage_aware_generator.hpp>
+#include <kodo/concurrent_storage_aware_encoder.hpp>
 
 /// @example encode_on_the_fly.cpp
 ///
 /// This example shows how to use a storage aware encoder which will
 /// allow you to encode from a block before all symbols have been
 /// specified. This can be useful in cases where the symbols that
-/// should be encoded are produced on-the-fly.
+/// should be encoded are produced on-the-fly. The symbols may also be
+/// set by another thread, e.g. a capture thread, while this thread
+/// encodes, as long as they are set in order.
 
 namespace kodo
 {
 
     /// Implementation of RLNC encoder using a storage aware generator
     /// and storage aware encoder. The two layers needed are marked with
-    /// "New layer" in the stack below.
+    /// "New layer" in the stack below. The concurrent_storage_aware_encoder
+    /// publishes the rank without a lock, the storage_aware_encoder may
+    /// be used instead if the symbols are set on the encoding thread.
     template<class Field>
     class on_the_fly_encoder
         : public // Payload Codec API
@@ -35,7 +40,7 @@ namespace kodo
                  encode_symbol_tracker<
                  zero_symbol_encoder<
                  linear_block_encoder<
-                 storage_aware_encoder<         // <--- New layer
+                 concurrent_storage_aware_encoder< // <--- New layer
                  // Coefficient Storage API
                  coefficient_info<
                  // Symbol Storage API
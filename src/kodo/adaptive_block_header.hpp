@@ -0,0 +1,79 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <sak/convert_endian.hpp>
+
+namespace kodo
+{
+
+    /// The header written in front of the payloads of an object coded
+    /// with generations of changing size, see adaptive_object_encoder.
+    /// Every payload carries the layout of its block, so a receiver
+    /// builds the decoder of a block from any of its payloads.
+    struct adaptive_block_header
+    {
+        /// Constructs a new header and zero initializes it
+        adaptive_block_header()
+            : m_block_id(0),
+              m_symbols(0),
+              m_byte_offset(0),
+              m_sequence(0)
+        { }
+
+        /// The index of the block in the object
+        uint32_t m_block_id;
+
+        /// The number of symbols of the block
+        uint32_t m_symbols;
+
+        /// The offset of the block in the object in bytes
+        uint64_t m_byte_offset;
+
+        /// The index of the payload among the payloads of the block
+        uint32_t m_sequence;
+    };
+
+    /// The size in bytes of an adaptive_block_header
+    const uint32_t adaptive_block_header_size = 20;
+
+    /// Writes a header in big endian byte order
+    /// @param header The header
+    /// @param buffer The buffer of at least adaptive_block_header_size
+    ///        bytes
+    inline void write_adaptive_block_header(
+        const adaptive_block_header &header, uint8_t *buffer)
+    {
+        assert(buffer != 0);
+
+        sak::big_endian::put<uint32_t>(header.m_block_id, buffer);
+        sak::big_endian::put<uint32_t>(header.m_symbols, buffer + 4);
+        sak::big_endian::put<uint64_t>(header.m_byte_offset, buffer + 8);
+        sak::big_endian::put<uint32_t>(header.m_sequence, buffer + 16);
+    }
+
+    /// Reads a header written by write_adaptive_block_header()
+    /// @param buffer The buffer holding the header
+    /// @return The header
+    inline adaptive_block_header read_adaptive_block_header(
+        const uint8_t *buffer)
+    {
+        assert(buffer != 0);
+
+        adaptive_block_header header;
+
+        header.m_block_id = sak::big_endian::get<uint32_t>(buffer);
+        header.m_symbols = sak::big_endian::get<uint32_t>(buffer + 4);
+        header.m_byte_offset = sak::big_endian::get<uint64_t>(buffer + 8);
+        header.m_sequence = sak::big_endian::get<uint32_t>(buffer + 16);
+
+        return header;
+    }
+
+}
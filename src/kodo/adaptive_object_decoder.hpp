@@ -0,0 +1,286 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "adaptive_block_header.hpp"
+#include "generation_size_controller.hpp"
+
+namespace kodo
+{
+
+    /// @brief Decodes an object encoded by an adaptive_object_encoder.
+    ///
+    /// The decoder of a block is built from the adaptive_block_header
+    /// of its first payload, so the number of symbols may change from
+    /// block to block. The symbol size is the max_symbol_size() of the
+    /// factory, which must equal the one of the encoder factory.
+    ///
+    /// For every block the decoder tracks the payloads received and
+    /// the time from the first payload until the block is decoded,
+    /// which feedback() returns for the sender to report to its
+    /// generation_size_controller.
+    ///
+    /// @tparam DecoderType A decoder stack which should be used
+    /// @tparam Clock The clock measuring the decoding latency
+    template
+    <
+        class DecoderType,
+        class Clock = std::chrono::steady_clock
+    >
+    class adaptive_object_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// A point in time of the clock
+        typedef typename Clock::time_point time_point;
+
+    public:
+
+        /// Constructs a new adaptive object decoder
+        /// @param decoder_factory The decoder factory to use
+        /// @param object_size The size in bytes of the object to be
+        ///        decoded
+        adaptive_object_decoder(factory &decoder_factory,
+                                uint64_t object_size)
+            : m_factory(decoder_factory),
+              m_object_size(object_size),
+              m_decoded_bytes(0)
+        {
+            assert(m_object_size > 0);
+        }
+
+        /// Decodes a payload written by the adaptive_object_encoder,
+        /// the decoder of its block is built if it does not exist
+        /// @param payload The payload
+        /// @return The index of the block of the payload
+        uint32_t decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            adaptive_block_header header =
+                read_adaptive_block_header(payload);
+
+            block &b = find_or_build(header);
+
+            ++b.m_received;
+            b.m_last_sequence = std::max(b.m_last_sequence,
+                                         header.m_sequence);
+
+            if(b.m_complete)
+            {
+                return header.m_block_id;
+            }
+
+            b.m_decoder->decode(payload + adaptive_block_header_size);
+
+            if(b.m_decoder->is_complete())
+            {
+                b.m_complete = true;
+                b.m_latency = std::chrono::duration<double>(
+                    Clock::now() - b.m_first_payload).count();
+
+                m_decoded_bytes += b.m_bytes_used;
+            }
+
+            return header.m_block_id;
+        }
+
+        /// @param block_id The block
+        /// @return True if a payload of the block has been received
+        bool has_block(uint32_t block_id) const
+        {
+            return m_blocks.find(block_id) != m_blocks.end();
+        }
+
+        /// @param block_id A received block
+        /// @return The decoder of the block, empty if it was released
+        const pointer& decoder(uint32_t block_id) const
+        {
+            return find(block_id).m_decoder;
+        }
+
+        /// @param block_id A received block
+        /// @return True if the block is decoded
+        bool is_block_complete(uint32_t block_id) const
+        {
+            return find(block_id).m_complete;
+        }
+
+        /// @param block_id A received block
+        /// @return The offset in bytes of the block in the object
+        uint64_t byte_offset(uint32_t block_id) const
+        {
+            return find(block_id).m_byte_offset;
+        }
+
+        /// @param block_id A received block
+        /// @return The number of bytes of the object in the block
+        uint32_t bytes_used(uint32_t block_id) const
+        {
+            return find(block_id).m_bytes_used;
+        }
+
+        /// @param block_id A decoded block
+        /// @return The loss and the decoding latency of the block
+        block_feedback feedback(uint32_t block_id) const
+        {
+            const block &b = find(block_id);
+
+            assert(b.m_complete);
+
+            // The payloads after the last one received are not counted
+            // as lost, they may have been sent after the block was
+            // decoded
+            double sent = double(b.m_last_sequence) + 1;
+
+            block_feedback f;
+            f.m_loss_rate =
+                std::max(0.0, 1.0 - double(b.m_received) / sent);
+            f.m_decode_latency = b.m_latency;
+
+            return f;
+        }
+
+        /// Releases the decoder of a decoded block, e.g. after its
+        /// data has been copied out. The feedback of the block is kept
+        /// and the payloads of the block received later are counted.
+        /// @param block_id A decoded block
+        void release_block(uint32_t block_id)
+        {
+            typename std::map<uint32_t, block>::iterator it =
+                m_blocks.find(block_id);
+
+            assert(it != m_blocks.end());
+            assert(it->second.m_complete);
+
+            it->second.m_decoder.reset();
+        }
+
+        /// @return True if every byte of the object has been decoded
+        bool is_complete() const
+        {
+            return m_decoded_bytes == m_object_size;
+        }
+
+        /// @return The total size of the object to decode in bytes
+        uint64_t object_size() const
+        {
+            return m_object_size;
+        }
+
+    protected:
+
+        /// The state of a received block
+        struct block
+        {
+            /// The decoder of the block
+            pointer m_decoder;
+
+            /// True if the block is decoded
+            bool m_complete;
+
+            /// The offset of the block in the object
+            uint64_t m_byte_offset;
+
+            /// The number of bytes of the object in the block
+            uint32_t m_bytes_used;
+
+            /// The number of payloads received
+            uint32_t m_received;
+
+            /// The highest sequence number received
+            uint32_t m_last_sequence;
+
+            /// The time the first payload was received
+            time_point m_first_payload;
+
+            /// The seconds from the first payload until the block was
+            /// decoded
+            double m_latency;
+        };
+
+        /// @param header The header of a payload
+        /// @return The block of the payload, built if it does not exist
+        block& find_or_build(const adaptive_block_header &header)
+        {
+            typename std::map<uint32_t, block>::iterator it =
+                m_blocks.find(header.m_block_id);
+
+            if(it != m_blocks.end())
+            {
+                return it->second;
+            }
+
+            assert(header.m_symbols > 0);
+            assert(header.m_byte_offset < m_object_size);
+
+            uint32_t symbol_size = m_factory.max_symbol_size();
+
+            block &b = m_blocks[header.m_block_id];
+
+            b.m_byte_offset = header.m_byte_offset;
+            b.m_bytes_used = static_cast<uint32_t>(
+                std::min<uint64_t>(
+                    uint64_t(header.m_symbols) * symbol_size,
+                    m_object_size - header.m_byte_offset));
+
+            m_factory.set_symbols(header.m_symbols);
+            m_factory.set_symbol_size(symbol_size);
+
+            b.m_decoder = m_factory.build();
+            b.m_decoder->set_bytes_used(b.m_bytes_used);
+
+            b.m_complete = false;
+            b.m_received = 0;
+            b.m_last_sequence = 0;
+            b.m_first_payload = Clock::now();
+            b.m_latency = 0;
+
+            return b;
+        }
+
+        /// @param block_id A received block
+        /// @return The block
+        const block& find(uint32_t block_id) const
+        {
+            typename std::map<uint32_t, block>::const_iterator it =
+                m_blocks.find(block_id);
+
+            assert(it != m_blocks.end());
+
+            return it->second;
+        }
+
+    protected:
+
+        /// The decoder factory
+        factory &m_factory;
+
+        /// Store the total object size in bytes
+        uint64_t m_object_size;
+
+        /// The number of bytes of the object decoded
+        uint64_t m_decoded_bytes;
+
+        /// The received blocks
+        std::map<uint32_t, block> m_blocks;
+    };
+
+}
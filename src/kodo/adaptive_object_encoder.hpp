@@ -0,0 +1,226 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+
+#include <boost/noncopyable.hpp>
+
+#include "adaptive_block_header.hpp"
+#include "generation_size_controller.hpp"
+
+namespace kodo
+{
+
+    /// @brief Encodes an object in blocks whose number of symbols is
+    ///        chosen by a generation_size_controller as the blocks are
+    ///        encoded.
+    ///
+    /// Unlike the object_encoder the object is not partitioned up
+    /// front: next_block() builds the encoder of the next block with
+    /// the number of symbols the controller chooses at that time, and
+    /// the symbol size of the factory. Every payload starts with an
+    /// adaptive_block_header holding the layout of its block, so the
+    /// adaptive_object_decoder follows the changes without any
+    /// signalling besides the payloads.
+    ///
+    /// The encoder measures its own CPU load, the share of the time
+    /// between two next_block() calls spent in next_block() and
+    /// encode(), and reports it to the controller for the block. The
+    /// feedback of the receivers, see
+    /// adaptive_object_decoder::feedback(), is reported to the
+    /// controller by the application.
+    ///
+    /// @tparam ObjectData object_data
+    /// @tparam EncoderType An encoder stack which should be used
+    /// @tparam Clock The clock measuring the CPU load
+    template
+    <
+        class ObjectData,
+        class EncoderType,
+        class Clock = std::chrono::steady_clock
+    >
+    class adaptive_object_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build encoders
+        typedef typename EncoderType::factory factory_type;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer_type;
+
+        /// The data source type
+        typedef ObjectData object_data;
+
+        /// A point in time of the clock
+        typedef typename Clock::time_point time_point;
+
+        /// A duration of the clock
+        typedef typename Clock::duration duration;
+
+    public:
+
+        /// Constructs a new adaptive object encoder
+        /// @param factory The encoder factory to use
+        /// @param data The object to encode
+        /// @param controller The controller choosing the number of
+        ///        symbols of the blocks, must outlive the encoder
+        adaptive_object_encoder(factory_type &factory,
+                                const object_data &data,
+                                generation_size_controller &controller)
+            : m_factory(factory),
+              m_data(data),
+              m_controller(controller),
+              m_next_offset(0),
+              m_busy(duration::zero())
+        {
+            assert(m_data.size() > 0);
+        }
+
+        /// Builds the encoder of the next block of the object, the
+        /// CPU load of the previous block is reported to the controller
+        /// @return False if the whole object has been encoded
+        bool next_block()
+        {
+            time_point start = Clock::now();
+
+            if(m_encoder)
+            {
+                duration elapsed = start - m_block_start;
+
+                if(elapsed > duration::zero())
+                {
+                    double load =
+                        std::chrono::duration<double>(m_busy).count() /
+                        std::chrono::duration<double>(elapsed).count();
+
+                    m_controller.report_cpu_load(
+                        m_header.m_symbols, std::min(load, 1.0));
+                }
+
+                ++m_header.m_block_id;
+            }
+
+            if(m_next_offset == m_data.size())
+            {
+                m_encoder.reset();
+                return false;
+            }
+
+            uint32_t symbol_size = m_factory.max_symbol_size();
+            uint64_t remaining = m_data.size() - m_next_offset;
+
+            uint64_t remaining_symbols =
+                (remaining + symbol_size - 1) / symbol_size;
+
+            uint32_t symbols = static_cast<uint32_t>(
+                std::min<uint64_t>(m_controller.symbols(),
+                                   remaining_symbols));
+
+            uint32_t bytes_used = static_cast<uint32_t>(
+                std::min<uint64_t>(uint64_t(symbols) * symbol_size,
+                                   remaining));
+
+            m_factory.set_symbols(symbols);
+            m_factory.set_symbol_size(symbol_size);
+
+            m_encoder = m_factory.build();
+            m_data.read(m_encoder, m_next_offset, bytes_used);
+
+            m_header.m_symbols = symbols;
+            m_header.m_byte_offset = m_next_offset;
+            m_header.m_sequence = 0;
+
+            m_next_offset += bytes_used;
+
+            m_block_start = start;
+            m_busy = Clock::now() - start;
+
+            return true;
+        }
+
+        /// Encodes a payload of the current block, the payload starts
+        /// with the adaptive_block_header
+        /// @param payload The buffer of at least payload_size() bytes
+        /// @return The number of bytes written to the payload
+        uint32_t encode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            // Did you forget to call next_block()?
+            assert(m_encoder);
+
+            time_point start = Clock::now();
+
+            write_adaptive_block_header(m_header, payload);
+            ++m_header.m_sequence;
+
+            uint32_t bytes_used =
+                m_encoder->encode(payload + adaptive_block_header_size);
+
+            m_busy += Clock::now() - start;
+
+            return adaptive_block_header_size + bytes_used;
+        }
+
+        /// @return The largest size of a payload in bytes
+        uint32_t payload_size() const
+        {
+            return adaptive_block_header_size +
+                m_factory.max_payload_size();
+        }
+
+        /// @return The encoder of the current block, empty after the
+        ///         whole object has been encoded
+        const pointer_type& encoder() const
+        {
+            return m_encoder;
+        }
+
+        /// @return The index of the current block
+        uint32_t block() const
+        {
+            return m_header.m_block_id;
+        }
+
+        /// @return The total size of the object to encode in bytes
+        uint64_t object_size() const
+        {
+            return m_data.size();
+        }
+
+    private:
+
+        /// The encoder factory
+        factory_type &m_factory;
+
+        /// Store the object storage
+        object_data m_data;
+
+        /// The controller choosing the number of symbols
+        generation_size_controller &m_controller;
+
+        /// The encoder of the current block
+        pointer_type m_encoder;
+
+        /// The header of the next payload
+        adaptive_block_header m_header;
+
+        /// The offset of the next block in the object
+        uint64_t m_next_offset;
+
+        /// The time the current block was built
+        time_point m_block_start;
+
+        /// The time spent coding the current block
+        duration m_busy;
+    };
+
+}
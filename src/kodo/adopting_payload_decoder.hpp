@@ -0,0 +1,75 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Decodes payloads received into buffers of the decoder's
+    ///        symbol_buffer_pool, letting the decoder adopt them.
+    ///
+    /// When an innovative symbol is stored, the decoder keeps the
+    /// received buffer as the symbol instead of copying the data, and
+    /// the buffer it held before is handed back to the caller. Payloads
+    /// which are not innovative are handed back as they are:
+    ///
+    /// @code
+    ///   uint8_t *buffer = decoder_factory.buffer_pool()->acquire();
+    ///   while(!decoder->is_complete())
+    ///   {
+    ///       socket.receive(buffer, decoder->payload_size());
+    ///       buffer = decoder->decode_adopt(buffer);
+    ///   }
+    ///   decoder_factory.buffer_pool()->release(buffer);
+    /// @endcode
+    ///
+    /// The layer is placed above the payload_decoder and needs the
+    /// adopting_symbol_storage. The symbol data must start the buffer,
+    /// as in the payloads of the payload_encoder.
+    template<class SuperCoder>
+    class adopting_payload_decoder : public SuperCoder
+    {
+    public:
+
+        /// Decodes a payload received into a buffer of the pool
+        /// @param payload The payload, a buffer of the buffer_pool()
+        /// @return The buffer now owned by the caller, either the
+        ///         payload or a buffer displaced by it
+        uint8_t* decode_adopt(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            SuperCoder::offer_symbol(payload);
+            SuperCoder::decode(payload);
+
+            return SuperCoder::reclaim_symbol();
+        }
+
+        /// Decodes a symbol received with scatter/gather, the symbol
+        /// data into a buffer of the pool
+        /// @param symbol_data The symbol data, a buffer of the
+        ///        buffer_pool()
+        /// @param symbol_header The symbol header
+        /// @return The buffer now owned by the caller, either the
+        ///         symbol data or a buffer displaced by it
+        uint8_t* decode_adopt(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            SuperCoder::offer_symbol(symbol_data);
+            SuperCoder::decode(symbol_data, symbol_header);
+
+            return SuperCoder::reclaim_symbol();
+        }
+
+    };
+
+}
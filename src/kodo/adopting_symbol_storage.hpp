@@ -0,0 +1,417 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include <sak/storage.hpp>
+
+#include "symbol_buffer_pool.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_storage_layers
+    /// @brief Symbol storage where every symbol is a buffer of a
+    ///        symbol_buffer_pool, so a decoder can adopt a received
+    ///        buffer as a symbol instead of copying it.
+    ///
+    /// Apart from the adoption the storage behaves as the
+    /// deep_symbol_storage, e.g. set_symbol() copies the data. A buffer
+    /// is offered with offer_symbol() before it is decoded. When the
+    /// linear_block_decoder stores the data of the offered buffer as a
+    /// symbol, the buffer replaces the buffer of the symbol, see
+    /// adopt_symbol(). The displaced buffer, or the offered buffer if it
+    /// was not adopted, is handed back by reclaim_symbol(). The per
+    /// payload copy into the storage disappears, and so does the pass
+    /// over the decoder storage polluting the cache.
+    ///
+    /// The offered buffers must be acquired from the buffer_pool() of
+    /// the factory, which all decoders built by the factory share, see
+    /// adopting_payload_decoder. The buffers of the symbols are kept
+    /// when the decoder is recycled and returned to the pool when it is
+    /// destroyed. The buffers used by a block are zeroed when the
+    /// decoder is initialized.
+    template<class SuperCoder>
+    class adopting_symbol_storage : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// Pointer to the pool of the symbol buffers
+        typedef boost::shared_ptr<symbol_buffer_pool> pool_pointer;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer holding the pool of the symbol buffers
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// Sets the pool of the symbol buffers, must be done before
+            /// the first decoder is built
+            /// @param pool The pool, its buffers must hold at least the
+            ///        largest payload of the decoders
+            void set_buffer_pool(const pool_pointer &pool)
+            {
+                assert(pool);
+                assert(pool->buffer_size() >=
+                       SuperCoder::factory::max_symbol_size());
+
+                m_pool = pool;
+            }
+
+            /// @return The pool of the symbol buffers, the receive
+            ///         buffers offered to the decoders must be acquired
+            ///         from it. Unless a pool was set, it is created when
+            ///         the first decoder is built.
+            const pool_pointer& buffer_pool() const
+            {
+                return m_pool;
+            }
+
+        private:
+
+            /// Give the layer access
+            friend class adopting_symbol_storage;
+
+            /// @param buffer_size The buffer size of the pool if it is
+            ///        created
+            /// @return The pool of the symbol buffers
+            const pool_pointer& symbol_pool(uint32_t buffer_size)
+            {
+                if(!m_pool)
+                {
+                    m_pool = boost::make_shared<symbol_buffer_pool>(
+                        buffer_size);
+                }
+
+                return m_pool;
+            }
+
+        private:
+
+            /// The pool of the symbol buffers
+            pool_pointer m_pool;
+        };
+
+    public:
+
+        /// Constructor
+        adopting_symbol_storage()
+            : m_offered(0),
+              m_displaced(0),
+              m_symbols_count(0)
+        { }
+
+        /// Returns the buffers of the symbols to the pool
+        ~adopting_symbol_storage()
+        {
+            for(uint8_t *buffer : m_buffers)
+            {
+                if(buffer != 0)
+                    m_pool->release(buffer);
+            }
+        }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_pool = the_factory.symbol_pool(the_factory.max_payload_size());
+            assert(m_pool->buffer_size() >= the_factory.max_symbol_size());
+
+            m_buffers.resize(the_factory.max_symbols(), 0);
+            m_symbols.resize(the_factory.max_symbols(), false);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(m_buffers[i] == 0)
+                {
+                    m_buffers[i] = m_pool->acquire();
+                }
+
+                std::fill_n(m_buffers[i], symbol_size, 0);
+            }
+
+            std::fill(m_symbols.begin(), m_symbols.end(), false);
+            m_symbols_count = 0;
+
+            assert(m_offered == 0);
+            assert(m_displaced == 0);
+        }
+
+        /// @copydoc layer::symbol(uint32_t)
+        uint8_t* symbol(uint32_t index)
+        {
+            assert(index < SuperCoder::symbols());
+            return m_buffers[index];
+        }
+
+        /// @copydoc layer::symbol_value(uint32_t)
+        value_type* symbol_value(uint32_t index)
+        {
+            return reinterpret_cast<value_type*>(symbol(index));
+        }
+
+        /// @copydoc layer::symbol(uint32_t) const
+        const uint8_t* symbol(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_buffers[index];
+        }
+
+        /// @copydoc layer::symbol_value(uint32_t) const
+        const value_type* symbol_value(uint32_t index) const
+        {
+            return reinterpret_cast<const value_type*>(symbol(index));
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            assert(symbol_storage.m_size > 0);
+            assert(symbol_storage.m_data != 0);
+            assert(symbol_storage.m_size <= SuperCoder::block_size());
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+            sak::const_storage src = symbol_storage;
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                uint32_t size = std::min(src.m_size, symbol_size);
+
+                if(size > 0)
+                {
+                    sak::copy_storage(
+                        sak::storage(m_buffers[i], size),
+                        sak::storage(src.m_data, size));
+
+                    src.m_data += size;
+                    src.m_size -= size;
+                }
+
+                m_symbols[i] = true;
+            }
+
+            // As for the deep_symbol_storage all symbols are specified,
+            // also in the case of partial data
+            m_symbols_count = SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::set_symbol(uint32_t, const sak::const_storage&)
+        void set_symbol(uint32_t index, const sak::const_storage &symbol)
+        {
+            assert(symbol.m_data != 0);
+            assert(symbol.m_size == SuperCoder::symbol_size());
+            assert(index < SuperCoder::symbols());
+
+            sak::copy_storage(
+                sak::storage(m_buffers[index], symbol.m_size), symbol);
+
+            if(m_symbols[index] == false)
+            {
+                ++m_symbols_count;
+                m_symbols[index] = true;
+            }
+        }
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        void copy_symbols(const sak::mutable_storage &dest) const
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            sak::mutable_storage storage = dest;
+
+            uint32_t data_to_copy =
+                std::min(storage.m_size, SuperCoder::block_size());
+
+            uint32_t symbol_index = 0;
+
+            while(data_to_copy > 0)
+            {
+                uint32_t copy_size =
+                    std::min(data_to_copy, SuperCoder::symbol_size());
+
+                sak::copy_storage(
+                    storage, sak::storage(symbol(symbol_index), copy_size));
+
+                data_to_copy -= copy_size;
+                storage.m_size -= copy_size;
+                storage.m_data += copy_size;
+
+                ++symbol_index;
+            }
+        }
+
+        /// @copydoc layer::copy_symbol(uint32_t,
+        ///                             const sak::mutable_storage&)
+        void copy_symbol(uint32_t index,
+                         const sak::mutable_storage &dest) const
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            uint32_t data_to_copy =
+                std::min(dest.m_size, SuperCoder::symbol_size());
+
+            sak::copy_storage(dest, sak::storage(symbol(index), data_to_copy));
+        }
+
+        /// @copydoc layer::symbols_available() const
+        uint32_t symbols_available() const
+        {
+            return SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::symbols_initialized() const
+        uint32_t symbols_initialized() const
+        {
+            return m_symbols_count;
+        }
+
+        /// @copydoc layer::is_symbols_available() const
+        bool is_symbols_available() const
+        {
+            return true;
+        }
+
+        /// @copydoc layer::is_symbols_initialized() const
+        bool is_symbols_initialized() const
+        {
+            return m_symbols_count == SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::is_symbol_available(uint32_t) const
+        bool is_symbol_available(uint32_t /*symbol_index*/) const
+        {
+            return true;
+        }
+
+        /// @copydoc layer::is_symbol_initialized(uint32_t) const
+        bool is_symbol_initialized(uint32_t symbol_index) const
+        {
+            return m_symbols[symbol_index];
+        }
+
+        /// Offers a buffer for adoption while it is decoded
+        /// @param buffer The buffer of the symbol data, acquired from
+        ///        the pool
+        void offer_symbol(uint8_t *buffer)
+        {
+            assert(buffer != 0);
+            assert(m_offered == 0);
+            assert(m_displaced == 0);
+
+            m_offered = buffer;
+        }
+
+        /// Replaces the buffer of a symbol with the offered buffer if
+        /// the data to store is the offered buffer
+        /// @param index The index of the symbol
+        /// @param symbol_data The data to store as the symbol
+        /// @return True if the buffer was adopted, otherwise the data
+        ///         must be copied
+        bool adopt_symbol(uint32_t index, const uint8_t *symbol_data)
+        {
+            assert(index < SuperCoder::symbols());
+
+            if(m_offered == 0 || symbol_data != m_offered)
+            {
+                return false;
+            }
+
+            m_displaced = m_buffers[index];
+            m_buffers[index] = m_offered;
+            m_offered = 0;
+
+            return true;
+        }
+
+        /// Ends the offer of a buffer
+        /// @return The buffer now owned by the caller, the displaced
+        ///         buffer if the offered buffer was adopted, otherwise
+        ///         the offered buffer
+        uint8_t* reclaim_symbol()
+        {
+            uint8_t *buffer = m_displaced ? m_displaced : m_offered;
+
+            assert(buffer != 0);
+
+            m_offered = 0;
+            m_displaced = 0;
+
+            return buffer;
+        }
+
+        /// @return The pool of the symbol buffers
+        const pool_pointer& buffer_pool() const
+        {
+            return m_pool;
+        }
+
+    private:
+
+        /// The pool of the symbol buffers
+        pool_pointer m_pool;
+
+        /// The buffers of the symbols
+        std::vector<uint8_t*> m_buffers;
+
+        /// The buffer offered for adoption
+        uint8_t *m_offered;
+
+        /// The buffer displaced by the adopted buffer
+        uint8_t *m_displaced;
+
+        /// Symbols count
+        uint32_t m_symbols_count;
+
+        /// Tracks which symbols have been set
+        std::vector<bool> m_symbols;
+
+    };
+
+    /// Type trait helper allows compile time detection of whether an
+    /// encoder / decoder contains the adopting_symbol_storage layer
+    template<class T>
+    struct has_adopting_symbol_storage
+    {
+        template<class U>
+        static uint8_t test(const kodo::adopting_symbol_storage<U> *);
+
+        static uint32_t test(...);
+
+        static const bool value = sizeof(test(static_cast<T*>(0))) == 1;
+    };
+
+}
@@ -0,0 +1,392 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <xdp/xsk.h>
+
+#include <boost/noncopyable.hpp>
+
+#include "frame_ring_transport.hpp"
+
+namespace kodo
+{
+
+    /// @brief The frame ring of an AF_XDP socket bound to one queue of a
+    ///        network interface (Linux, libxdp), used with the
+    ///        frame_ring_sender and frame_ring_receiver.
+    ///
+    /// The frames live in a UMEM shared with the NIC driver, so the
+    /// payloads are encoded into and decoded from the frames the NIC
+    /// sends and receives, bypassing the kernel network stack. Only
+    /// available when the library was configured with libxdp, which
+    /// defines KODO_HAS_XDP.
+    ///
+    /// Every frame starts with the protocol headers, e.g. Ethernet,
+    /// IPv4 and UDP, given as a template which is copied in front of
+    /// every datagram sent. The datagrams of the coders all have the
+    /// same size, so one template with fixed lengths and checksums, and
+    /// a zero UDP checksum, serves every frame. On receive the same
+    /// number of header bytes is stripped, the XDP program redirecting
+    /// to the socket must only pass the frames of the flow.
+    ///
+    /// The UMEM frames are split between the fill ring, the frames
+    /// free for sending, and the spare frames given to adopting
+    /// decoders, see add_spare_frames().
+    class af_xdp_ring : boost::noncopyable
+    {
+    public:
+
+        /// The size of a UMEM frame
+        static const uint32_t umem_frame_size =
+            XSK_UMEM__DEFAULT_FRAME_SIZE;
+
+    public:
+
+        /// Creates a UMEM and an AF_XDP socket on a queue
+        /// @param interface The name of the network interface
+        /// @param queue The queue of the interface
+        /// @param frames The number of UMEM frames
+        /// @param spare_frames The frames kept out of the rings for the
+        ///        storage of adopting decoders
+        /// @param header The protocol headers of every frame
+        af_xdp_ring(const std::string &interface, uint32_t queue,
+                    uint32_t frames, uint32_t spare_frames,
+                    const std::vector<uint8_t> &header)
+            : m_area(0),
+              m_area_size(uint64_t(frames) * umem_frame_size),
+              m_umem(0),
+              m_socket(0),
+              m_header(header)
+        {
+            assert(frames > spare_frames);
+            assert(m_header.size() < umem_frame_size);
+
+            void *area = ::mmap(0, m_area_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if(area == MAP_FAILED)
+                return;
+
+            m_area = static_cast<uint8_t*>(area);
+
+            if(::xsk_umem__create(&m_umem, m_area, m_area_size, &m_fill,
+                                  &m_completion, 0) != 0)
+            {
+                m_umem = 0;
+                return;
+            }
+
+            xsk_socket_config config;
+            std::memset(&config, 0, sizeof(config));
+            config.rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+            config.tx_size = XSK_RING_PROD__DEFAULT_NUM_DESCS;
+            config.bind_flags = XDP_USE_NEED_WAKEUP;
+
+            if(::xsk_socket__create(&m_socket, interface.c_str(), queue,
+                                    m_umem, &m_rx, &m_tx, &config) != 0)
+            {
+                m_socket = 0;
+                return;
+            }
+
+            // The spare frames first, then half of the rest on the fill
+            // ring and the others free for sending
+            for(uint32_t i = 0; i < spare_frames; ++i)
+            {
+                m_spare.push_back(uint64_t(i) * umem_frame_size);
+            }
+
+            uint32_t fill_frames = std::min<uint32_t>(
+                (frames - spare_frames) / 2,
+                XSK_RING_PROD__DEFAULT_NUM_DESCS);
+
+            for(uint32_t i = spare_frames; i < frames; ++i)
+            {
+                uint64_t address = uint64_t(i) * umem_frame_size;
+
+                if(i < spare_frames + fill_frames)
+                    m_refill.push_back(address);
+                else
+                    m_free.push_back(address);
+            }
+
+            flush_refill();
+        }
+
+        /// Closes the socket and frees the UMEM
+        ~af_xdp_ring()
+        {
+            if(m_socket != 0)
+                ::xsk_socket__delete(m_socket);
+
+            if(m_umem != 0)
+                ::xsk_umem__delete(m_umem);
+
+            if(m_area != 0)
+                ::munmap(m_area, m_area_size);
+        }
+
+        /// @return True if the socket was created, which needs the
+        ///        CAP_NET_RAW capability and a driver supporting AF_XDP
+        bool is_open() const
+        {
+            return m_socket != 0;
+        }
+
+        /// @return The socket, e.g. to poll() for received frames
+        int fd() const
+        {
+            assert(is_open());
+            return ::xsk_socket__fd(m_socket);
+        }
+
+        /// @return The capacity of a frame for a datagram
+        uint32_t frame_size() const
+        {
+            return umem_frame_size - static_cast<uint32_t>(m_header.size());
+        }
+
+        /// Reserves free frames for sending, frames whose transmission
+        /// completed are reclaimed first
+        /// @param frames The reserved frames
+        /// @param count The number of frames wanted
+        /// @return The number of frames reserved
+        uint32_t reserve(ring_frame *frames, uint32_t count)
+        {
+            reclaim();
+
+            count = std::min(count, static_cast<uint32_t>(m_free.size()));
+            count = std::min(count, ::xsk_prod_nb_free(&m_tx, count));
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                frames[i].m_data = datagram(m_free.back());
+                frames[i].m_size = frame_size();
+                m_free.pop_back();
+            }
+
+            return count;
+        }
+
+        /// Sends reserved frames
+        /// @param frames The frames with the sizes of their datagrams
+        /// @param count The number of frames
+        void submit(const ring_frame *frames, uint32_t count)
+        {
+            if(count == 0)
+                return;
+
+            uint32_t index = 0;
+            uint32_t reserved =
+                ::xsk_ring_prod__reserve(&m_tx, count, &index);
+
+            // reserve() only hands out frames with room on the ring
+            assert(reserved == count);
+            (void) reserved;
+
+            uint32_t header_size = static_cast<uint32_t>(m_header.size());
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                uint64_t address = frame_address(frames[i].m_data);
+
+                std::copy(m_header.begin(), m_header.end(),
+                          m_area + address);
+
+                xdp_desc *descriptor =
+                    ::xsk_ring_prod__tx_desc(&m_tx, index + i);
+
+                descriptor->addr = address;
+                descriptor->len = header_size + frames[i].m_size;
+            }
+
+            ::xsk_ring_prod__submit(&m_tx, count);
+
+            if(::xsk_ring_prod__needs_wakeup(&m_tx))
+            {
+                ::sendto(fd(), 0, 0, MSG_DONTWAIT, 0, 0);
+            }
+        }
+
+        /// Receives frames, the frames handed back since the last call
+        /// are put on the fill ring first
+        /// @param frames The received frames
+        /// @param count The largest number of frames to receive
+        /// @return The number of frames received
+        uint32_t receive(ring_frame *frames, uint32_t count)
+        {
+            flush_refill();
+
+            uint32_t index = 0;
+            uint32_t received =
+                ::xsk_ring_cons__peek(&m_rx, count, &index);
+
+            uint32_t header_size = static_cast<uint32_t>(m_header.size());
+            uint32_t frames_out = 0;
+
+            for(uint32_t i = 0; i < received; ++i)
+            {
+                const xdp_desc *descriptor =
+                    ::xsk_ring_cons__rx_desc(&m_rx, index + i);
+
+                uint8_t *data = static_cast<uint8_t*>(
+                    ::xsk_umem__get_data(m_area, descriptor->addr));
+
+                // Frames without room for the headers are not ours
+                if(descriptor->len <= header_size)
+                {
+                    m_refill.push_back(frame_address(data));
+                    continue;
+                }
+
+                frames[frames_out].m_data = data + header_size;
+                frames[frames_out].m_size = descriptor->len - header_size;
+                ++frames_out;
+            }
+
+            ::xsk_ring_cons__release(&m_rx, received);
+
+            if(received == 0 && ::xsk_ring_prod__needs_wakeup(&m_fill))
+            {
+                ::recvfrom(fd(), 0, 0, MSG_DONTWAIT, 0, 0);
+            }
+
+            return frames_out;
+        }
+
+        /// Hands a frame back to the fill ring, on the next receive()
+        /// @param data Data in the frame
+        void refill(uint8_t *data)
+        {
+            m_refill.push_back(frame_address(data));
+        }
+
+        /// @return The datagram of a spare frame, 0 if none is left
+        uint8_t* spare()
+        {
+            if(m_spare.empty())
+                return 0;
+
+            uint8_t *data = datagram(m_spare.back());
+            m_spare.pop_back();
+
+            return data;
+        }
+
+        /// @param data Some data
+        /// @return True if the data lies in the UMEM
+        bool owns(const uint8_t *data) const
+        {
+            return data >= m_area && data < m_area + m_area_size;
+        }
+
+    private:
+
+        /// @return The datagram of a frame, after the headers
+        uint8_t* datagram(uint64_t address) const
+        {
+            return m_area + address + m_header.size();
+        }
+
+        /// @return The address in the UMEM of the frame holding data
+        uint64_t frame_address(const uint8_t *data) const
+        {
+            assert(owns(data));
+
+            uint64_t offset = static_cast<uint64_t>(data - m_area);
+            return offset - offset % umem_frame_size;
+        }
+
+        /// Moves the frames whose transmission completed to the free
+        /// frames
+        void reclaim()
+        {
+            uint32_t index = 0;
+            uint32_t completed = ::xsk_ring_cons__peek(
+                &m_completion, XSK_RING_CONS__DEFAULT_NUM_DESCS, &index);
+
+            for(uint32_t i = 0; i < completed; ++i)
+            {
+                m_free.push_back(
+                    *::xsk_ring_cons__comp_addr(&m_completion, index + i));
+            }
+
+            ::xsk_ring_cons__release(&m_completion, completed);
+        }
+
+        /// Puts the frames handed back on the fill ring
+        void flush_refill()
+        {
+            if(m_refill.empty())
+                return;
+
+            uint32_t count = static_cast<uint32_t>(m_refill.size());
+            uint32_t index = 0;
+
+            // The fill ring may be full, the rest waits for a later call
+            count = ::xsk_ring_prod__reserve(&m_fill, count, &index);
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                *::xsk_ring_prod__fill_addr(&m_fill, index + i) =
+                    m_refill[m_refill.size() - 1 - i];
+            }
+
+            ::xsk_ring_prod__submit(&m_fill, count);
+            m_refill.resize(m_refill.size() - count);
+        }
+
+    private:
+
+        /// The UMEM area
+        uint8_t *m_area;
+
+        /// The size of the UMEM area in bytes
+        uint64_t m_area_size;
+
+        /// The UMEM
+        xsk_umem *m_umem;
+
+        /// The socket
+        xsk_socket *m_socket;
+
+        /// The ring of the frames given to the NIC for receiving
+        xsk_ring_prod m_fill;
+
+        /// The ring of the frames sent by the NIC
+        xsk_ring_cons m_completion;
+
+        /// The ring of the received frames
+        xsk_ring_cons m_rx;
+
+        /// The ring of the frames to send
+        xsk_ring_prod m_tx;
+
+        /// The protocol headers of every frame
+        std::vector<uint8_t> m_header;
+
+        /// The frames free for sending
+        std::vector<uint64_t> m_free;
+
+        /// The frames waiting for the fill ring
+        std::vector<uint64_t> m_refill;
+
+        /// The frames for adopting decoders
+        std::vector<uint64_t> m_spare;
+
+    };
+
+}
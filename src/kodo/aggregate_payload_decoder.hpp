@@ -0,0 +1,178 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <sak/convert_endian.hpp>
+
+#include "systematic_base_coder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Decodes the payloads of the aggregate_payload_encoder,
+    ///        all the symbols of a payload in one decode() call.
+    ///
+    /// The systematic symbols sharing the aggregate header are decoded
+    /// first, in the order of their indices, followed by the other
+    /// symbols. The symbols left in a payload are skipped once the
+    /// decoder is complete. The factory must use the number of symbols
+    /// per payload of the encoder.
+    template<class SuperCoder>
+    class aggregate_payload_decoder : public SuperCoder
+    {
+    public:
+
+        /// The type of the number of symbols and the header stride
+        typedef uint16_t count_type;
+
+        /// @copydoc systematic_base_coder::counter_type
+        typedef systematic_base_coder::counter_type counter_type;
+
+        /// @copydoc systematic_base_coder::flag_type
+        typedef systematic_base_coder::flag_type flag_type;
+
+        /// The size of the aggregate header in bytes
+        static const uint32_t aggregate_header_size =
+            2 * sizeof(count_type) + sizeof(counter_type);
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer setting the number of symbols per payload
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_payload_symbols(1)
+            { }
+
+            /// Sets the number of symbols in every payload decoded by the
+            /// coders built afterwards
+            /// @param symbols The number of symbols per payload
+            void set_payload_symbols(uint32_t symbols)
+            {
+                assert(symbols > 0);
+                assert(symbols <= 0xFFFFU);
+
+                m_payload_symbols = symbols;
+            }
+
+            /// @return The number of symbols per payload
+            uint32_t payload_symbols() const
+            {
+                return m_payload_symbols;
+            }
+
+            /// @copydoc layer::factory::max_payload_size() const
+            uint32_t max_payload_size() const
+            {
+                return m_payload_symbols *
+                    (SuperCoder::factory::max_symbol_size() +
+                     SuperCoder::factory::max_header_size()) +
+                    aggregate_header_size;
+            }
+
+        private:
+
+            /// The number of symbols per payload
+            uint32_t m_payload_symbols;
+        };
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_payload_symbols = the_factory.payload_symbols();
+        }
+
+        /// Decodes all the symbols of a payload, the symbol data is
+        /// decoded in place
+        /// @copydoc layer::decode(uint8_t*)
+        void decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            const uint8_t *aggregate =
+                payload + m_payload_symbols * symbol_size;
+
+            uint32_t systematic =
+                sak::big_endian::get<count_type>(aggregate);
+            uint32_t stride = sak::big_endian::get<count_type>(
+                aggregate + sizeof(count_type));
+            uint32_t first = sak::big_endian::get<counter_type>(
+                aggregate + 2 * sizeof(count_type));
+
+            assert(systematic <= m_payload_symbols);
+
+            // The systematic symbols are passed to the Codec Header API
+            // with the header the systematic_encoder would have written
+            uint8_t header[sizeof(flag_type) + sizeof(counter_type)];
+
+            sak::big_endian::put<flag_type>(
+                systematic_base_coder::systematic_flag, header);
+
+            for(uint32_t i = 0; i < systematic; ++i)
+            {
+                if(SuperCoder::is_complete())
+                {
+                    return;
+                }
+
+                sak::big_endian::put<counter_type>(
+                    first + i, header + sizeof(flag_type));
+
+                SuperCoder::decode(payload + i * symbol_size, header);
+            }
+
+            uint8_t *headers = payload + m_payload_symbols * symbol_size +
+                aggregate_header_size;
+
+            for(uint32_t i = systematic; i < m_payload_symbols; ++i)
+            {
+                if(SuperCoder::is_complete())
+                {
+                    return;
+                }
+
+                SuperCoder::decode(payload + i * symbol_size, headers);
+                headers += stride;
+            }
+        }
+
+        /// @copydoc layer::payload_size() const
+        uint32_t payload_size() const
+        {
+            return m_payload_symbols *
+                (SuperCoder::symbol_size() + SuperCoder::header_size()) +
+                aggregate_header_size;
+        }
+
+        /// @return The number of symbols in every payload
+        uint32_t payload_symbols() const
+        {
+            return m_payload_symbols;
+        }
+
+    protected:
+
+        /// The number of symbols per payload
+        uint32_t m_payload_symbols;
+
+    };
+}
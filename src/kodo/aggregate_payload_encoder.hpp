@@ -0,0 +1,234 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+
+#include "systematic_base_coder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Packs several symbols into one payload with a shared
+    ///        header, e.g. to fill a jumbo frame.
+    ///
+    /// Every payload holds factory::payload_symbols() symbols, encoded
+    /// by the Codec Header API as for the payload_encoder, using the
+    /// following layout:
+    ///
+    /// @code
+    ///   +--------+-----+----------+------------------+----------+-----+
+    ///   | data 0 | ... | data n-1 | aggregate header | header k | ... |
+    ///   +--------+-----+----------+------------------+----------+-----+
+    /// @endcode
+    ///
+    /// The aggregate header holds the number k of systematic symbols at
+    /// the start of the payload, the index of the first of them and the
+    /// stride of the headers which follow. The k systematic symbols have
+    /// consecutive indices, so their flags and indices are replaced by
+    /// the aggregate header. The headers of the other symbols are
+    /// written back to back, each using as many bytes as the longest of
+    /// them. The symbol data is placed first as in the payload_encoder,
+    /// so each symbol stays aligned if the symbol size is a multiple of
+    /// the alignment.
+    ///
+    /// The payloads are decoded by the aggregate_payload_decoder, whose
+    /// factory must use the same number of symbols per payload.
+    template<class SuperCoder>
+    class aggregate_payload_encoder : public SuperCoder
+    {
+    public:
+
+        /// The type of the number of symbols and the header stride
+        typedef uint16_t count_type;
+
+        /// @copydoc systematic_base_coder::counter_type
+        typedef systematic_base_coder::counter_type counter_type;
+
+        /// @copydoc systematic_base_coder::flag_type
+        typedef systematic_base_coder::flag_type flag_type;
+
+        /// The size of the aggregate header in bytes
+        static const uint32_t aggregate_header_size =
+            2 * sizeof(count_type) + sizeof(counter_type);
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer setting the number of symbols per payload
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_payload_symbols(1)
+            { }
+
+            /// Sets the number of symbols packed in every payload by the
+            /// coders built afterwards
+            /// @param symbols The number of symbols per payload
+            void set_payload_symbols(uint32_t symbols)
+            {
+                assert(symbols > 0);
+                assert(symbols <= 0xFFFFU);
+
+                m_payload_symbols = symbols;
+            }
+
+            /// @return The number of symbols per payload
+            uint32_t payload_symbols() const
+            {
+                return m_payload_symbols;
+            }
+
+            /// @copydoc layer::factory::max_payload_size() const
+            uint32_t max_payload_size() const
+            {
+                return m_payload_symbols *
+                    (SuperCoder::factory::max_symbol_size() +
+                     SuperCoder::factory::max_header_size()) +
+                    aggregate_header_size;
+            }
+
+        private:
+
+            /// The number of symbols per payload
+            uint32_t m_payload_symbols;
+        };
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_payload_symbols = the_factory.payload_symbols();
+
+            m_headers.resize(m_payload_symbols * SuperCoder::header_size());
+            m_header_bytes.resize(m_payload_symbols);
+        }
+
+        /// Encodes layer::payload_symbols() symbols to the payload
+        /// @copydoc layer::encode(uint8_t*)
+        uint32_t encode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+            uint32_t header_size = SuperCoder::header_size();
+
+            uint32_t systematic = 0;
+            uint32_t first = 0;
+            uint32_t stride = 0;
+
+            for(uint32_t i = 0; i < m_payload_symbols; ++i)
+            {
+                uint8_t *header = &m_headers[i * header_size];
+
+                m_header_bytes[i] = SuperCoder::encode(
+                    payload + i * symbol_size, header);
+
+                // Only a run of consecutive systematic symbols at the
+                // start of the payload shares the aggregate header
+                uint32_t index = 0;
+
+                if(systematic == i && systematic_index(header, &index) &&
+                   (i == 0 || index == first + i))
+                {
+                    first = (i == 0) ? index : first;
+                    ++systematic;
+                }
+                else
+                {
+                    stride = std::max(stride, m_header_bytes[i]);
+                }
+            }
+
+            uint8_t *aggregate = payload + m_payload_symbols * symbol_size;
+
+            sak::big_endian::put<count_type>(systematic, aggregate);
+            sak::big_endian::put<count_type>(
+                stride, aggregate + sizeof(count_type));
+            sak::big_endian::put<counter_type>(
+                first, aggregate + 2 * sizeof(count_type));
+
+            uint8_t *headers = aggregate + aggregate_header_size;
+
+            for(uint32_t i = systematic; i < m_payload_symbols; ++i)
+            {
+                const uint8_t *header = &m_headers[i * header_size];
+
+                std::copy_n(header, m_header_bytes[i], headers);
+                std::fill(headers + m_header_bytes[i], headers + stride, 0);
+
+                headers += stride;
+            }
+
+            return static_cast<uint32_t>(headers - payload);
+        }
+
+        /// @copydoc layer::payload_size() const
+        uint32_t payload_size() const
+        {
+            return m_payload_symbols *
+                (SuperCoder::symbol_size() + SuperCoder::header_size()) +
+                aggregate_header_size;
+        }
+
+        /// @return The number of symbols in every payload
+        uint32_t payload_symbols() const
+        {
+            return m_payload_symbols;
+        }
+
+    protected:
+
+        /// Reads the index of a systematic symbol header
+        /// @param header The header written by the Codec Header API
+        /// @param index Set to the index of the symbol if it is
+        ///        systematic
+        /// @return True if the symbol is systematic
+        bool systematic_index(const uint8_t *header, uint32_t *index) const
+        {
+            assert(header != 0);
+            assert(index != 0);
+
+            flag_type flag = sak::big_endian::get<flag_type>(header);
+
+            if(flag != systematic_base_coder::systematic_flag)
+            {
+                return false;
+            }
+
+            *index = sak::big_endian::get<counter_type>(
+                header + sizeof(flag_type));
+
+            return true;
+        }
+
+    protected:
+
+        /// The number of symbols per payload
+        uint32_t m_payload_symbols;
+
+        /// The headers of the symbols of the payload being encoded
+        std::vector<uint8_t> m_headers;
+
+        /// The bytes used in each of the headers
+        std::vector<uint32_t> m_header_bytes;
+
+    };
+}
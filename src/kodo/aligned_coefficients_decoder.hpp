@@ -10,24 +10,26 @@
 #include <sak/is_aligned.hpp>
 #include <sak/storage.hpp>
 
-#include "aligned_coefficients_buffer.hpp"
+#include "thread_scratch.hpp"
 
 namespace kodo
 {
 
+    /// Tag of the thread_scratch buffer holding the aligned copy of the
+    /// coefficients in the aligned_coefficients_decoder
+    struct aligned_coefficients_scratch { };
+
     /// @ingroup codec_layers
-    /// @brief Aligns the symbol coefficient buffer if necessary
+    /// @brief Aligns the symbol coefficient buffer if necessary. The
+    ///        aligned copy is only needed during the call, so it is
+    ///        kept in the scratch memory of the thread.
     template<class SuperCoder>
-    class aligned_coefficients_decoder
-        : public aligned_coefficients_buffer<SuperCoder>
+    class aligned_coefficients_decoder : public SuperCoder
     {
     public:
 
-        /// The actual SuperCoder type
-        typedef aligned_coefficients_buffer<SuperCoder> Super;
-
         /// Pull up the decode_symbol() functions
-        using Super::decode_symbol;
+        using SuperCoder::decode_symbol;
 
     public:
 
@@ -39,27 +41,26 @@ namespace kodo
 
             if(sak::is_aligned(coefficients) == false)
             {
-                uint32_t coefficients_size = Super::coefficients_size();
+                uint32_t coefficients_size =
+                    SuperCoder::coefficients_size();
+
+                uint8_t *aligned =
+                    thread_scratch<aligned_coefficients_scratch>::data(
+                        coefficients_size);
 
                 auto src = sak::storage(coefficients, coefficients_size);
-                auto dest = sak::storage(m_coefficients);
+                auto dest = sak::storage(aligned, coefficients_size);
 
                 sak::copy_storage(dest, src);
 
-                Super::decode_symbol(symbol_data, &m_coefficients[0]);
+                SuperCoder::decode_symbol(symbol_data, aligned);
             }
             else
             {
-                Super::decode_symbol(symbol_data, coefficients);
+                SuperCoder::decode_symbol(symbol_data, coefficients);
             }
         }
 
-    private:
-
-        /// Access the coefficients buffer in the
-        /// aligned_coefficients_buffer layer
-        using Super::m_coefficients;
-
     };
 
 }
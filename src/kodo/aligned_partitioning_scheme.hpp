@@ -0,0 +1,298 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#ifndef KODO_ALIGNED_PARTITIONING_SCHEME_HPP
+#define KODO_ALIGNED_PARTITIONING_SCHEME_HPP
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+
+namespace kodo
+{
+
+    /// @ingroup block_partitioning_implementation
+    /// @brief Block partitioning scheme using symbol sizes which are a
+    ///        multiple of an alignment.
+    ///
+    /// The rfc5052_partitioning_scheme uses the maximum symbol size,
+    /// which may be any number of bytes. When the symbol size is not a
+    /// multiple of the vector width, the region kernels process the
+    /// end of every symbol with scalar code, and the coefficients which
+    /// follow the symbol in a payload are not aligned, which makes the
+    /// aligned_coefficients_decoder copy them.
+    /// This scheme finds the number of symbols needed with the largest
+    /// multiple of the alignment below the maximum symbol size, and
+    /// then shrinks the symbol size to the smallest multiple of the
+    /// alignment which still covers the object with those symbols,
+    /// which minimizes the padding. The symbols are balanced over the
+    /// blocks as in the RFC 5052 scheme. The default
+    /// alignment of 32 bytes is the AVX2 vector width, 64 bytes matches
+    /// a cache line.
+    ///
+    /// If the maximum symbol size is below the alignment it is used
+    /// unaligned. The padding, i.e. the bytes of the blocks which are
+    /// not part of the object, is reported by padding().
+    template<uint32_t Alignment = 32>
+    class aligned_partitioning_scheme
+    {
+    public:
+
+        static_assert(Alignment > 0, "The alignment must be positive");
+
+        /// The alignment of the symbol sizes in bytes
+        static const uint32_t alignment = Alignment;
+
+    public:
+
+        /// Create an uninitialized partitioning scheme
+        aligned_partitioning_scheme();
+
+        /// Constructor
+        /// @param max_symbols the maximum number of symbols in a block
+        /// @param max_symbol_size the maximum size in bytes of a symbol
+        /// @param object_size the size in bytes of the whole object
+        aligned_partitioning_scheme(uint32_t max_symbols,
+                                    uint32_t max_symbol_size,
+                                    uint64_t object_size);
+
+        /// @copydoc block_partitioning::symbols(uint32_t) const
+        uint32_t symbols(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::symbol_size(uint32_t) const
+        uint32_t symbol_size(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::block_size(uint32_t) const
+        uint32_t block_size(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::bytes_offset(uint32_t) const
+        uint64_t byte_offset(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::bytes_used(uint32_t) const
+        uint32_t bytes_used(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::blocks() const
+        uint32_t blocks() const;
+
+        /// @copydoc block_partitioning::object_size() const
+        uint64_t object_size() const;
+
+        /// @copydoc block_partitioning::total_symbols() const
+        uint32_t total_symbols() const;
+
+        /// @copydoc block_partitioning::total_block_size() const
+        uint64_t total_block_size() const;
+
+        /// @return The number of bytes of the blocks which are not part
+        ///         of the object
+        uint32_t padding() const;
+
+        /// @return The padding relative to the object size
+        double padding_overhead() const;
+
+    private:
+
+        /// The size of the object to transfer in bytes
+        uint64_t m_object_size;
+
+        /// The size of a symbol in bytes
+        uint32_t m_symbol_size;
+
+        /// The total number of symbols in the object
+        uint32_t m_total_symbols;
+
+        /// The total number of blocks in the object
+        uint32_t m_total_blocks;
+
+        /// The number of large blocks in the object
+        uint32_t m_large_blocks;
+
+        /// The number of symbols in a large block
+        uint32_t m_large_block_symbols;
+
+        /// The number of symbols in a small block
+        uint32_t m_small_block_symbols;
+    };
+
+    template<uint32_t Alignment>
+    inline aligned_partitioning_scheme<Alignment>::
+        aligned_partitioning_scheme()
+        : m_object_size(0),
+          m_symbol_size(0),
+          m_total_symbols(0),
+          m_total_blocks(0),
+          m_large_blocks(0),
+          m_large_block_symbols(0),
+          m_small_block_symbols(0)
+    { }
+
+    template<uint32_t Alignment>
+    inline aligned_partitioning_scheme<Alignment>::
+        aligned_partitioning_scheme(uint32_t max_symbols,
+                                    uint32_t max_symbol_size,
+                                    uint64_t object_size)
+        : m_object_size(object_size)
+    {
+        assert(max_symbols > 0);
+        assert(max_symbol_size > 0);
+        assert(m_object_size > 0);
+
+        uint32_t aligned_size = max_symbol_size;
+
+        if(max_symbol_size >= Alignment)
+        {
+            aligned_size = (max_symbol_size / Alignment) * Alignment;
+        }
+
+        // ceil(x/y) = ((x - 1) / y) + 1
+        uint64_t aligned_symbols = ((m_object_size - 1) / aligned_size) + 1;
+
+        // The smallest aligned symbol size covering the object with
+        // the same number of symbols, at most the aligned size
+        m_symbol_size = static_cast<uint32_t>(
+            ((m_object_size - 1) / aligned_symbols) + 1);
+
+        if(max_symbol_size >= Alignment)
+        {
+            m_symbol_size = ((m_symbol_size - 1) / Alignment + 1) * Alignment;
+        }
+
+        // The rounding may leave whole symbols of padding, so the
+        // symbols are counted again which keeps the padding below a
+        // symbol
+        uint64_t total_symbols = ((m_object_size - 1) / m_symbol_size) + 1;
+
+        assert(total_symbols <= std::numeric_limits<uint32_t>::max());
+        m_total_symbols = static_cast<uint32_t>(total_symbols);
+
+        m_total_blocks  = ((m_total_symbols - 1) / max_symbols) + 1;
+
+        m_large_block_symbols = ((m_total_symbols - 1) / m_total_blocks) + 1;
+        m_small_block_symbols = m_total_symbols / m_total_blocks;
+
+        m_large_blocks = m_total_symbols -
+            (m_small_block_symbols * m_total_blocks);
+
+        assert(m_symbol_size <= aligned_size);
+        assert(total_block_size() >= m_object_size);
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::symbols(uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+        return block_id < m_large_blocks ?
+            m_large_block_symbols : m_small_block_symbols;
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::symbol_size(
+        uint32_t /*block_id*/) const
+    {
+        return m_symbol_size;
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::block_size(
+        uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+        return symbols(block_id) * symbol_size(block_id);
+    }
+
+    template<uint32_t Alignment>
+    inline uint64_t
+    aligned_partitioning_scheme<Alignment>::byte_offset(
+        uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+
+        if(block_id < m_large_blocks)
+        {
+            return uint64_t(block_id) * m_large_block_symbols *
+                m_symbol_size;
+        }
+
+        uint64_t offset = uint64_t(m_large_blocks) *
+            m_large_block_symbols * m_symbol_size;
+
+        offset += uint64_t(block_id - m_large_blocks) *
+            m_small_block_symbols * m_symbol_size;
+
+        return offset;
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::bytes_used(
+        uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+
+        uint64_t offset = byte_offset(block_id);
+
+        assert(offset < m_object_size);
+        uint64_t remaining = m_object_size - offset;
+
+        return static_cast<uint32_t>(
+            std::min<uint64_t>(remaining, block_size(block_id)));
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::blocks() const
+    {
+        assert(m_total_blocks > 0);
+        return m_total_blocks;
+    }
+
+    template<uint32_t Alignment>
+    inline uint64_t
+    aligned_partitioning_scheme<Alignment>::object_size() const
+    {
+        assert(m_object_size > 0);
+        return m_object_size;
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::total_symbols() const
+    {
+        assert(m_total_symbols > 0);
+        return m_total_symbols;
+    }
+
+    template<uint32_t Alignment>
+    inline uint64_t
+    aligned_partitioning_scheme<Alignment>::total_block_size() const
+    {
+        return uint64_t(m_total_symbols) * m_symbol_size;
+    }
+
+    template<uint32_t Alignment>
+    inline uint32_t
+    aligned_partitioning_scheme<Alignment>::padding() const
+    {
+        assert(total_block_size() >= m_object_size);
+
+        // Less than a symbol
+        return static_cast<uint32_t>(total_block_size() - m_object_size);
+    }
+
+    template<uint32_t Alignment>
+    inline double
+    aligned_partitioning_scheme<Alignment>::padding_overhead() const
+    {
+        assert(m_object_size > 0);
+        return static_cast<double>(padding()) / m_object_size;
+    }
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "payload_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Payload decoder for the layout of the
+    ///        aligned_payload_encoder.
+    ///
+    /// When the payload buffer is 16 byte aligned the symbol data and
+    /// the symbol id of a coded symbol are aligned, so the symbol is
+    /// decoded without copying the coding coefficients.
+    template<class SuperCoder>
+    class aligned_payload_decoder : public payload_decoder<SuperCoder>
+    {
+    public:
+
+        /// The layer we extend
+        typedef payload_decoder<SuperCoder> Super;
+
+        /// The alignment of the symbol data and the symbol id
+        static const uint32_t payload_alignment = 16;
+
+        /// Pull up the decode() functions
+        using Super::decode;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_payload_size() const
+            uint32_t max_payload_size() const
+            {
+                return Super::factory::max_payload_size() +
+                    payload_alignment - 1;
+            }
+        };
+
+    public:
+
+        /// Unpacks the symbol data and symbol header from the payload
+        /// buffer.
+        /// @copydoc layer::decode(uint8_t*)
+        void decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint8_t *symbol_data = payload;
+            uint8_t *symbol_header = payload + header_offset();
+
+            SuperCoder::decode(symbol_data, symbol_header);
+        }
+
+        /// @copydoc layer::payload_size() const
+        uint32_t payload_size() const
+        {
+            return header_offset() + SuperCoder::header_size();
+        }
+
+        /// @copydoc aligned_payload_encoder::header_offset() const
+        uint32_t header_offset() const
+        {
+            uint32_t id_offset = SuperCoder::symbol_id_offset();
+
+            uint32_t end = SuperCoder::symbol_size() + id_offset;
+            uint32_t aligned = ((end + payload_alignment - 1) /
+                                payload_alignment) * payload_alignment;
+
+            return aligned - id_offset;
+        }
+
+    };
+
+}
@@ -0,0 +1,106 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "payload_encoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Payload encoder padding the symbol data such that both
+    ///        the symbol data and the symbol id of a coded symbol are
+    ///        16 byte aligned in an aligned payload buffer.
+    ///
+    /// The layer is a drop-in replacement for the payload_encoder and
+    /// must be used together with the aligned_payload_decoder. With the
+    /// plain symbol id the coding coefficients are then aligned, and the
+    /// aligned_coefficients_decoder does not copy them.
+    template<class SuperCoder>
+    class aligned_payload_encoder : public payload_encoder<SuperCoder>
+    {
+    public:
+
+        /// The layer we extend
+        typedef payload_encoder<SuperCoder> Super;
+
+        /// The alignment of the symbol data and the symbol id
+        static const uint32_t payload_alignment = 16;
+
+        /// Pull up the encode() functions
+        using Super::encode;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_payload_size() const
+            uint32_t max_payload_size() const
+            {
+                return Super::factory::max_payload_size() +
+                    payload_alignment - 1;
+            }
+        };
+
+    public:
+
+        /// Encodes a symbol to the provided buffer using the following
+        /// layout:
+        ///
+        /// @code
+        ///   +-------------------+---------+---------------+
+        ///   |    symbol data    | padding | symbol header |
+        ///   +-------------------+---------+---------------+
+        /// @endcode
+        ///
+        /// The padding places the symbol id of a coded symbol on an
+        /// aligned address, when the payload buffer is aligned.
+        ///
+        /// @copydoc layer::encode(uint8_t*)
+        uint32_t encode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint8_t *symbol_data = payload;
+            uint8_t *symbol_header = payload + header_offset();
+
+            return SuperCoder::encode(symbol_data, symbol_header)
+                + header_offset();
+        }
+
+        /// @copydoc layer::payload_size() const
+        uint32_t payload_size() const
+        {
+            return header_offset() + SuperCoder::header_size();
+        }
+
+        /// @return The offset of the symbol header in the payload
+        uint32_t header_offset() const
+        {
+            uint32_t id_offset = SuperCoder::symbol_id_offset();
+
+            uint32_t end = SuperCoder::symbol_size() + id_offset;
+            uint32_t aligned = ((end + payload_alignment - 1) /
+                                payload_alignment) * payload_alignment;
+
+            return aligned - id_offset;
+        }
+
+    };
+
+}
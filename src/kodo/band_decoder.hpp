@@ -0,0 +1,478 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/aligned_allocator.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Decodes symbols whose non-zero coefficients are confined
+    ///        to a band, as produced by the band_generator, with the
+    ///        elimination kept within the bands.
+    ///
+    /// The linear_block_decoder keeps the stored symbols fully reduced,
+    /// so every pivot is subtracted from all stored symbols with a
+    /// non-zero in its column, and each subtraction spans the whole
+    /// coefficient vector. Here the stored symbols are only kept in
+    /// echelon form: the coefficients of the symbol with pivot p are
+    /// zero outside [p, e_p), where e_p is the end of its band. A
+    /// received symbol is reduced by the stored symbols of its non-zero
+    /// columns up to its first free column, which becomes its pivot,
+    /// and each subtraction of a coefficient vector only covers the
+    /// band of the stored symbol. The band of the received symbol grows
+    /// to the largest end of the subtracted bands. Once the decoder is
+    /// complete, the symbols are substituted from the last pivot to the
+    /// first, again only within their bands.
+    ///
+    /// For bands of width w the decoding thus costs O(k * w) symbol
+    /// operations for k symbols, instead of O(k^2). Like in the
+    /// linear_block_decoder_delayed the coded symbols are not decoded
+    /// before the decoder is complete, so the layer must not be
+    /// combined with layers inspecting the partially decoded symbols,
+    /// e.g. the symbol_decoded_callback_decoder.
+    ///
+    /// The layer is placed directly above the linear_block_decoder,
+    /// whose state it maintains.
+    template<class SuperCoder>
+    class band_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_band_end.resize(the_factory.max_symbols(), 0);
+
+            m_symbol_scratch.resize(
+                fifi::size_to_length<field_type>(
+                    the_factory.max_symbol_size()));
+
+            m_coefficients_scratch.resize(
+                fifi::elements_to_length<field_type>(
+                    the_factory.max_symbols()));
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *symbol_coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_coefficients != 0);
+
+            value_type *symbol
+                = reinterpret_cast<value_type*>(symbol_data);
+
+            value_type *coefficients
+                = reinterpret_cast<value_type*>(symbol_coefficients);
+
+            if(SuperCoder::is_complete())
+            {
+                return;
+            }
+
+            decode_band(symbol, coefficients, 0);
+
+            if(SuperCoder::is_complete())
+            {
+                final_backward_substitute();
+            }
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*, uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+            assert(symbol_data != 0);
+
+            if(SuperCoder::is_complete() ||
+               SuperCoder::m_uncoded[symbol_index])
+            {
+                return;
+            }
+
+            const value_type *symbol
+                = reinterpret_cast<const value_type*>(symbol_data);
+
+            if(SuperCoder::m_coded[symbol_index])
+            {
+                swap_decode(symbol, symbol_index);
+            }
+            else
+            {
+                SuperCoder::store_uncoded_symbol(symbol, symbol_index);
+
+                m_band_end[symbol_index] = symbol_index + 1;
+
+                ++SuperCoder::m_rank;
+
+                SuperCoder::set_symbol_uncoded(symbol_index);
+
+                if(symbol_index > SuperCoder::m_maximum_pivot)
+                {
+                    SuperCoder::m_maximum_pivot = symbol_index;
+                }
+            }
+
+            if(SuperCoder::is_complete())
+            {
+                final_backward_substitute();
+            }
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            // The bands are found from the restored coefficients
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(SuperCoder::m_coded[i])
+                {
+                    m_band_end[i] =
+                        band_end(SuperCoder::coefficients_value(i), i);
+                }
+                else if(SuperCoder::m_uncoded[i])
+                {
+                    m_band_end[i] = i + 1;
+                }
+            }
+
+            return buffer;
+        }
+
+        /// @param index The pivot of a stored symbol
+        /// @return The end of the band of the stored symbol, exclusive
+        uint32_t symbol_band_end(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            assert(SuperCoder::symbol_pivot(index));
+
+            return m_band_end[index];
+        }
+
+    protected:
+
+        /// Reduces a symbol by the stored symbols until a free pivot is
+        /// found, and stores it
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        /// @param begin The index before which all coefficients are zero
+        void decode_band(value_type *symbol_data, value_type *symbol_id,
+                         uint32_t begin)
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            uint32_t pivot_index = symbols;
+            uint32_t end = band_end(symbol_id, begin);
+
+            for(uint32_t i = SuperCoder::next_nonzero(symbol_id, begin);
+                i < end; i = SuperCoder::next_nonzero(symbol_id, i + 1))
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    pivot_index = i;
+                    break;
+                }
+
+                value_type coefficient =
+                    fifi::get_value<field_type>(symbol_id, i);
+
+                subtract_band(symbol_data, symbol_id, i, coefficient);
+
+                end = std::max(end, m_band_end[i]);
+            }
+
+            if(pivot_index == symbols)
+            {
+                // The symbol was not innovative
+                return;
+            }
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                normalize(symbol_data, symbol_id, pivot_index, end);
+            }
+
+            SuperCoder::store_coded_symbol(symbol_data, symbol_id,
+                                           pivot_index);
+
+            m_band_end[pivot_index] = end;
+
+            ++SuperCoder::m_rank;
+
+            SuperCoder::set_symbol_coded(pivot_index);
+
+            if(pivot_index > SuperCoder::m_maximum_pivot)
+            {
+                SuperCoder::m_maximum_pivot = pivot_index;
+            }
+        }
+
+        /// Replaces the coded symbol stored at a pivot by an uncoded
+        /// symbol, and decodes the rest of the coded symbol again
+        /// @param symbol_data The data of the uncoded symbol
+        /// @param pivot_index The index of the uncoded symbol
+        void swap_decode(const value_type *symbol_data,
+                         uint32_t pivot_index)
+        {
+            assert(SuperCoder::m_coded[pivot_index]);
+
+            uint32_t symbol_length = SuperCoder::symbol_length();
+            uint32_t coefficients_length = SuperCoder::coefficients_length();
+
+            // The stored symbol is moved out, since the uncoded symbol
+            // takes its place
+            const value_type *symbol_i =
+                SuperCoder::symbol_value(pivot_index);
+
+            const value_type *vector_i =
+                SuperCoder::coefficients_value(pivot_index);
+
+            assert(fifi::get_value<field_type>(vector_i, pivot_index) == 1);
+
+            std::copy_n(symbol_i, symbol_length, &m_symbol_scratch[0]);
+            std::copy_n(vector_i, coefficients_length,
+                        &m_coefficients_scratch[0]);
+
+            SuperCoder::clear_symbol_coded(pivot_index);
+            --SuperCoder::m_rank;
+
+            // Subtract the uncoded symbol at the pivot
+            fifi::set_value<field_type>(
+                &m_coefficients_scratch[0], pivot_index, 0);
+
+            SuperCoder::subtract(&m_symbol_scratch[0], symbol_data,
+                                 symbol_length);
+
+            SuperCoder::store_uncoded_symbol(symbol_data, pivot_index);
+
+            m_band_end[pivot_index] = pivot_index + 1;
+
+            ++SuperCoder::m_rank;
+
+            SuperCoder::set_symbol_uncoded(pivot_index);
+
+            // The rest has no non-zero coefficients before the pivot
+            decode_band(&m_symbol_scratch[0], &m_coefficients_scratch[0],
+                        pivot_index + 1);
+        }
+
+        /// Subtracts a multiple of a stored symbol, only the band of the
+        /// stored symbol is visited in the coefficients
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        /// @param index The pivot of the stored symbol
+        /// @param coefficient The multiple
+        void subtract_band(value_type *symbol_data, value_type *symbol_id,
+                           uint32_t index, value_type coefficient)
+        {
+            const value_type *symbol_i = SuperCoder::symbol_value(index);
+
+            if(SuperCoder::m_uncoded[index])
+            {
+                // An uncoded symbol has a single non-zero coefficient
+                fifi::set_value<field_type>(symbol_id, index, 0);
+            }
+            else
+            {
+                const value_type *vector_i =
+                    SuperCoder::coefficients_value(index);
+
+                uint32_t first = first_value(index);
+                uint32_t length = end_value(m_band_end[index]) - first;
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(symbol_id + first,
+                                         vector_i + first, length);
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        symbol_id + first, vector_i + first, coefficient,
+                        length);
+                }
+            }
+
+            if(fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::subtract(symbol_data, symbol_i,
+                                     SuperCoder::symbol_length());
+            }
+            else
+            {
+                SuperCoder::multiply_subtract(symbol_data, symbol_i,
+                                              coefficient,
+                                              SuperCoder::symbol_length());
+            }
+        }
+
+        /// Makes the pivot coefficient one, only the band of the symbol
+        /// is visited in the coefficients
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        /// @param pivot_index The pivot of the symbol
+        /// @param end The end of the band of the symbol
+        void normalize(value_type *symbol_data, value_type *symbol_id,
+                       uint32_t pivot_index, uint32_t end)
+        {
+            value_type coefficient =
+                fifi::get_value<field_type>(symbol_id, pivot_index);
+
+            assert(coefficient > 0);
+
+            value_type inverted_coefficient =
+                SuperCoder::invert(coefficient);
+
+            uint32_t first = first_value(pivot_index);
+
+            SuperCoder::multiply(symbol_id + first, inverted_coefficient,
+                                 end_value(end) - first);
+
+            SuperCoder::multiply(symbol_data, inverted_coefficient,
+                                 SuperCoder::symbol_length());
+        }
+
+        /// Substitutes the decoded symbols into the coded symbols, from
+        /// the last pivot to the first, so the symbols with a non-zero
+        /// coefficient in the band of a symbol are decoded when it is
+        /// visited
+        void final_backward_substitute()
+        {
+            assert(SuperCoder::is_complete());
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = symbols; i --> 0;)
+            {
+                if(!SuperCoder::m_coded[i])
+                {
+                    continue;
+                }
+
+                substitute_band(i);
+            }
+        }
+
+        /// Substitutes the decoded symbols in the band of a coded symbol
+        /// into it, which decodes it. The symbols in its band after its
+        /// pivot must be decoded.
+        /// @param index The pivot of the coded symbol
+        void substitute_band(uint32_t index)
+        {
+            assert(SuperCoder::m_coded[index]);
+
+            value_type *symbol_i = SuperCoder::symbol_value(index);
+            value_type *vector_i = SuperCoder::coefficients_value(index);
+
+            uint32_t end = m_band_end[index];
+
+            for(uint32_t j = SuperCoder::next_nonzero(vector_i, index + 1);
+                j < end; j = SuperCoder::next_nonzero(vector_i, j + 1))
+            {
+                value_type value = fifi::get_value<field_type>(vector_i, j);
+
+                const value_type *symbol_j = SuperCoder::symbol_value(j);
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(symbol_i, symbol_j,
+                                         SuperCoder::symbol_length());
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        symbol_i, symbol_j, value,
+                        SuperCoder::symbol_length());
+                }
+
+                fifi::set_value<field_type>(vector_i, j, 0);
+            }
+
+            m_band_end[index] = index + 1;
+        }
+
+        /// @param symbol_id The coefficients of a symbol
+        /// @param begin The index before which all coefficients are zero
+        /// @return The index after the last non-zero coefficient, or
+        ///         begin if there is none
+        uint32_t band_end(const value_type *symbol_id, uint32_t begin) const
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t end = begin;
+
+            for(uint32_t i = SuperCoder::next_nonzero(symbol_id, begin);
+                i < symbols; i = SuperCoder::next_nonzero(symbol_id, i + 1))
+            {
+                end = i + 1;
+            }
+
+            return end;
+        }
+
+        /// @param index The index of a coefficient
+        /// @return The index of the value_type holding the coefficient
+        static uint32_t first_value(uint32_t index)
+        {
+            return fifi::elements_to_length<field_type>(index + 1) - 1;
+        }
+
+        /// @param end The index after the last coefficient of a range
+        /// @return The index after the last value_type holding the
+        ///         coefficients
+        static uint32_t end_value(uint32_t end)
+        {
+            return fifi::elements_to_length<field_type>(end);
+        }
+
+    protected:
+
+        /// The end of the band of every stored symbol, exclusive
+        std::vector<uint32_t> m_band_end;
+
+        /// The storage type of the scratch buffers
+        typedef std::vector<value_type, sak::aligned_allocator<value_type> >
+            aligned_vector;
+
+        /// The data of a coded symbol decoded again after a swap
+        aligned_vector m_symbol_scratch;
+
+        /// The coefficients of a coded symbol decoded again after a swap
+        aligned_vector m_coefficients_scratch;
+
+    };
+
+}
@@ -0,0 +1,173 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Generates coefficients confined to a band of consecutive
+    ///        symbols, as used by band (perpetual) codes.
+    ///
+    /// The band of width w starts at a uniformly random offset o in
+    /// [-(w - 1), k - 1] and is cut at the edges of the block, so
+    /// every symbol is in the band of w out of the k + w - 1 offsets.
+    /// Unlike wrapping the band around, as in perpetual codes, this
+    /// keeps the non-zero coefficients of a vector consecutive, which
+    /// the band_decoder relies on. The first coefficient of the band is
+    /// non-zero and the rest are uniformly random.
+    ///
+    /// The width is provided by the band_info layer, the start of the
+    /// latest band is read by the band_symbol_id_writer with
+    /// band_offset().
+    template<class SuperCoder>
+    class band_generator : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The random generator used
+        typedef boost::random::mt19937 generator_type;
+
+        /// @copydoc layer::seed_type
+        typedef generator_type::result_type seed_type;
+
+    public:
+
+        /// Constructor
+        band_generator()
+            : m_value_distribution(field_type::min_value,
+                                   field_type::max_value),
+              m_nonzero_distribution(1, field_type::max_value),
+              m_band_offset(0)
+        { }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            // Only the band is set, the other coefficients are zero
+            std::fill_n(coefficients, SuperCoder::coefficients_size(), 0);
+
+            value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t end = select_band();
+
+            if(fifi::is_binary<field_type>::value)
+            {
+                fifi::set_value<field_type>(c, m_band_offset, 1);
+            }
+            else
+            {
+                fifi::set_value<field_type>(
+                    c, m_band_offset,
+                    m_nonzero_distribution(m_random_generator));
+            }
+
+            for(uint32_t i = m_band_offset + 1; i < end; ++i)
+            {
+                fifi::set_value<field_type>(
+                    c, i, m_value_distribution(m_random_generator));
+            }
+        }
+
+        /// @copydoc layer::generate_partial(uint8_t*)
+        void generate_partial(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            generate(coefficients);
+
+            value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t end = std::min(m_band_offset + SuperCoder::band_width(),
+                                    SuperCoder::symbols());
+
+            for(uint32_t i = m_band_offset; i < end; ++i)
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    fifi::set_value<field_type>(c, i, 0);
+                }
+            }
+        }
+
+        /// @copydoc layer::seed(seed_type)
+        void seed(seed_type seed_value)
+        {
+            m_random_generator.seed(seed_value);
+        }
+
+        /// @return The index of the first coefficient of the band of
+        ///         the latest generated vector, the band holds the
+        ///         coefficients up to band_offset() + band_width(),
+        ///         limited to the number of symbols
+        uint32_t band_offset() const
+        {
+            return m_band_offset;
+        }
+
+    protected:
+
+        /// Selects the band of the next vector and sets the band offset
+        /// @return The end of the band, exclusive
+        uint32_t select_band()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t width = SuperCoder::band_width();
+
+            assert(width > 0);
+            assert(width <= symbols);
+
+            // The offset is drawn shifted by w - 1 to stay unsigned
+            offset_distribution offsets(0, symbols + width - 2);
+            uint32_t shifted = offsets(m_random_generator);
+
+            m_band_offset = shifted >= width - 1 ? shifted - (width - 1) : 0;
+
+            return std::min(shifted + 1, symbols);
+        }
+
+    private:
+
+        /// The type of the value_type distribution
+        typedef boost::random::uniform_int_distribution<value_type>
+            value_type_distribution;
+
+        /// The type of the distribution of the band offsets
+        typedef boost::random::uniform_int_distribution<uint32_t>
+            offset_distribution;
+
+        /// Distribution that generates random values from a finite field
+        value_type_distribution m_value_distribution;
+
+        /// Distribution that generates the first coefficient of a band
+        value_type_distribution m_nonzero_distribution;
+
+        /// The random generator
+        boost::random::mt19937 m_random_generator;
+
+        /// The first coefficient of the latest band
+        uint32_t m_band_offset;
+
+    };
+}
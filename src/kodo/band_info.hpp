@@ -0,0 +1,106 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_storage_layers
+    /// @brief Provides the width of the band of non-zero coefficients
+    ///        used by the band codes.
+    ///
+    /// The width is set on the factory and is limited to the number of
+    /// symbols of a coder. It is shared by the band_generator and the
+    /// band symbol id reader and writer, so the encoder and decoder
+    /// factories must use the same width.
+    template<class SuperCoder>
+    class band_info : public SuperCoder
+    {
+    public:
+
+        /// The default width of the band
+        static const uint32_t default_band_width = 32;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t, uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_band_width(default_band_width)
+            { }
+
+            /// Sets the width of the band of the coders built
+            /// afterwards
+            /// @param band_width The number of coefficients in the band
+            void set_band_width(uint32_t band_width)
+            {
+                assert(band_width > 0);
+                m_band_width = band_width;
+            }
+
+            /// @return The width of the band of the coders built with the
+            ///         current number of symbols
+            uint32_t band_width() const
+            {
+                return std::min(m_band_width,
+                                SuperCoder::factory::symbols());
+            }
+
+            /// @return The largest width of the band of the coders built
+            ///         by the factory
+            uint32_t max_band_width() const
+            {
+                return std::min(m_band_width,
+                                SuperCoder::factory::max_symbols());
+            }
+
+        private:
+
+            /// The width of the band
+            uint32_t m_band_width;
+        };
+
+    public:
+
+        /// Constructor
+        band_info()
+            : m_band_width(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_band_width = the_factory.band_width();
+            assert(m_band_width > 0);
+        }
+
+        /// @return The number of coefficients in the band
+        uint32_t band_width() const
+        {
+            assert(m_band_width > 0);
+            return m_band_width;
+        }
+
+    private:
+
+        /// The width of the band
+        uint32_t m_band_width;
+    };
+
+}
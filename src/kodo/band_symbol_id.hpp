@@ -0,0 +1,91 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <fifi/fifi_utils.hpp>
+
+#include "aligned_coefficients_buffer.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Base layer for the band symbol id reader and writer
+    ///
+    /// The band symbol id holds the index of the first coefficient of
+    /// the band as a big endian 32 bit value, followed by the band
+    /// width coefficients of the band packed as in a coefficient
+    /// vector. Coefficients of a band extending beyond the last symbol
+    /// are zero. The width is provided by the band_info layer.
+    template<class SuperCoder>
+    class band_symbol_id
+        : public aligned_coefficients_buffer<SuperCoder>
+    {
+    public:
+
+        /// Type of SuperCoder with injected aligned_coefficient_buffer
+        typedef aligned_coefficients_buffer<SuperCoder> Super;
+
+        /// @copydoc layer::field_type
+        typedef typename Super::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// The type of the band offset
+        typedef uint32_t offset_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_id_size() const
+            uint32_t max_id_size() const
+            {
+                return sizeof(offset_type) +
+                    fifi::elements_to_size<field_type>(
+                        Super::factory::max_band_width());
+            }
+        };
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            Super::initialize(the_factory);
+
+            m_id_size = sizeof(offset_type) +
+                fifi::elements_to_size<field_type>(Super::band_width());
+        }
+
+        /// @copydoc layer::id_size()
+        uint32_t id_size() const
+        {
+            return m_id_size;
+        }
+
+    protected:
+
+        /// The size in bytes of the symbol id
+        uint32_t m_id_size;
+
+    };
+
+}
@@ -0,0 +1,87 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <sak/convert_endian.hpp>
+
+#include <fifi/fifi_utils.hpp>
+
+#include "band_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Reads a band symbol id written by the
+    ///        band_symbol_id_writer and expands the band into the
+    ///        aligned coefficients buffer, which the symbol coefficients
+    ///        pointer refers to.
+    template<class SuperCoder>
+    class base_band_symbol_id_reader : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// @copydoc band_symbol_id::offset_type
+        typedef typename SuperCoder::offset_type offset_type;
+
+    public:
+
+        /// @copydoc layer::read_id(uint8_t*,uint8_t**)
+        void read_id(uint8_t *symbol_id, uint8_t **symbol_coefficients)
+        {
+            assert(symbol_id != 0);
+            assert(symbol_coefficients != 0);
+
+            *symbol_coefficients = &m_coefficients[0];
+
+            // The decoder may have changed the whole vector during the
+            // elimination of the previous symbol
+            std::fill_n(m_coefficients.begin(),
+                        SuperCoder::coefficients_size(), 0);
+
+            uint32_t offset = sak::big_endian::get<offset_type>(symbol_id);
+            assert(offset < SuperCoder::symbols());
+
+            const value_type *b = reinterpret_cast<const value_type*>(
+                symbol_id + sizeof(offset_type));
+
+            value_type *c = reinterpret_cast<value_type*>(&m_coefficients[0]);
+
+            uint32_t end = std::min(offset + SuperCoder::band_width(),
+                                    SuperCoder::symbols());
+
+            for(uint32_t i = offset; i < end; ++i)
+            {
+                fifi::set_value<field_type>(
+                    c, i, fifi::get_value<field_type>(b, i - offset));
+            }
+        }
+
+    protected:
+
+        /// The aligned coefficients buffer
+        using SuperCoder::m_coefficients;
+
+    };
+
+    /// @copydoc base_band_symbol_id_reader
+    template<class SuperCoder>
+    class band_symbol_id_reader
+        : public base_band_symbol_id_reader<
+                 band_symbol_id<SuperCoder> >
+    { };
+
+}
@@ -0,0 +1,92 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <sak/convert_endian.hpp>
+
+#include <fifi/fifi_utils.hpp>
+
+#include "band_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Writes the offset and the coefficients of the band
+    ///        instead of the whole coefficient vector.
+    ///
+    /// The coefficients are generated into the aligned coefficients
+    /// buffer, which the coefficients pointer refers to. The layer is
+    /// placed above the band_generator.
+    template<class SuperCoder>
+    class base_band_symbol_id_writer : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// @copydoc band_symbol_id::offset_type
+        typedef typename SuperCoder::offset_type offset_type;
+
+    public:
+
+        /// @copydoc layer::write_id(uint8_t*, uint8_t**)
+        uint32_t write_id(uint8_t *symbol_id, uint8_t **coefficients)
+        {
+            assert(symbol_id != 0);
+            assert(coefficients != 0);
+
+            SuperCoder::generate(&m_coefficients[0]);
+            *coefficients = &m_coefficients[0];
+
+            const value_type *c =
+                reinterpret_cast<const value_type*>(&m_coefficients[0]);
+
+            uint32_t offset = SuperCoder::band_offset();
+            uint32_t width = SuperCoder::band_width();
+
+            sak::big_endian::put<offset_type>(offset, symbol_id);
+
+            uint8_t *band = symbol_id + sizeof(offset_type);
+
+            std::fill_n(band, fifi::elements_to_size<field_type>(width), 0);
+
+            value_type *b = reinterpret_cast<value_type*>(band);
+
+            uint32_t end = std::min(offset + width, SuperCoder::symbols());
+
+            for(uint32_t i = offset; i < end; ++i)
+            {
+                fifi::set_value<field_type>(
+                    b, i - offset, fifi::get_value<field_type>(c, i));
+            }
+
+            return SuperCoder::id_size();
+        }
+
+    protected:
+
+        /// The aligned coefficients buffer
+        using SuperCoder::m_coefficients;
+
+    };
+
+    /// @copydoc base_band_symbol_id_writer
+    template<class SuperCoder>
+    class band_symbol_id_writer
+        : public base_band_symbol_id_writer<
+                 band_symbol_id<SuperCoder> >
+    { };
+
+}
@@ -0,0 +1,74 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace kodo
+{
+
+    /// @param word The word to scan, must be non-zero
+    /// @return The index of the lowest set bit in the word
+    inline uint32_t count_trailing_zeros(uint64_t word)
+    {
+        assert(word != 0);
+
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint32_t>(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<uint32_t>(index);
+#else
+        uint32_t index = 0;
+        while((word & 1U) == 0)
+        {
+            word >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /// Loads up to eight bytes into a word, the first byte being the
+    /// least significant one
+    /// @param data The bytes to load
+    /// @param size The number of bytes, at most eight
+    /// @return The word, with zeros in place of the missing bytes
+    inline uint64_t load_word(const uint8_t *data, uint32_t size)
+    {
+        assert(data != 0);
+        assert(size <= 8);
+
+        if(size == 8)
+        {
+            // Spelled out, which compilers turn into a single load
+            return uint64_t(data[0]) |
+                (uint64_t(data[1]) << 8) |
+                (uint64_t(data[2]) << 16) |
+                (uint64_t(data[3]) << 24) |
+                (uint64_t(data[4]) << 32) |
+                (uint64_t(data[5]) << 40) |
+                (uint64_t(data[6]) << 48) |
+                (uint64_t(data[7]) << 56);
+        }
+
+        uint64_t word = 0;
+
+        for(uint32_t i = 0; i < size; ++i)
+        {
+            word |= uint64_t(data[i]) << (8 * i);
+        }
+
+        return word;
+    }
+
+}
@@ -0,0 +1,105 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+namespace kodo
+{
+
+    /// The number of bit planes of a bit sliced symbol, one per bit of
+    /// a byte
+    const uint32_t bit_planes = 8;
+
+    /// Transposes the 8 x 8 bit matrix held in a word, where row r is
+    /// byte r and column c is bit c of the byte
+    /// @param x The matrix
+    /// @return The transposed matrix
+    inline uint64_t transpose_bits(uint64_t x)
+    {
+        uint64_t t;
+
+        t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+        x = x ^ t ^ (t << 7);
+
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+        x = x ^ t ^ (t << 14);
+
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+        x = x ^ t ^ (t << 28);
+
+        return x;
+    }
+
+    /// Converts a symbol of bytes to 8 bit planes. Plane i holds bit i
+    /// of every byte, bit e of the plane, i.e. bit e % 8 of its byte
+    /// e / 8, being bit i of byte e of the symbol. This is the layout
+    /// of the packets used by the bitmatrix_math layer for binary8,
+    /// where a multiplication by a constant only XORs planes.
+    /// @param dest The bit planes, one after the other, size bytes
+    /// @param src The symbol, size bytes
+    /// @param size The size of the symbol, a multiple of 8
+    inline void bit_slice(uint8_t *dest, const uint8_t *src, uint32_t size)
+    {
+        assert(dest != 0);
+        assert(src != 0);
+        assert(dest != src);
+        assert((size % bit_planes) == 0);
+
+        uint32_t plane_size = size / bit_planes;
+
+        for(uint32_t q = 0; q < plane_size; ++q)
+        {
+            uint64_t x = 0;
+
+            for(uint32_t t = 0; t < bit_planes; ++t)
+            {
+                x |= uint64_t(src[q * bit_planes + t]) << (8 * t);
+            }
+
+            x = transpose_bits(x);
+
+            for(uint32_t i = 0; i < bit_planes; ++i)
+            {
+                dest[i * plane_size + q] = uint8_t(x >> (8 * i));
+            }
+        }
+    }
+
+    /// Converts 8 bit planes back to a symbol of bytes, the inverse of
+    /// bit_slice()
+    /// @param dest The symbol, size bytes
+    /// @param src The bit planes, size bytes
+    /// @param size The size of the symbol, a multiple of 8
+    inline void bit_unslice(uint8_t *dest, const uint8_t *src, uint32_t size)
+    {
+        assert(dest != 0);
+        assert(src != 0);
+        assert(dest != src);
+        assert((size % bit_planes) == 0);
+
+        uint32_t plane_size = size / bit_planes;
+
+        for(uint32_t q = 0; q < plane_size; ++q)
+        {
+            uint64_t x = 0;
+
+            for(uint32_t i = 0; i < bit_planes; ++i)
+            {
+                x |= uint64_t(src[i * plane_size + q]) << (8 * i);
+            }
+
+            x = transpose_bits(x);
+
+            for(uint32_t t = 0; t < bit_planes; ++t)
+            {
+                dest[q * bit_planes + t] = uint8_t(x >> (8 * t));
+            }
+        }
+    }
+
+}
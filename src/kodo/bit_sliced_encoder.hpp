@@ -0,0 +1,217 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <fifi/field_types.hpp>
+
+#include <sak/storage.hpp>
+#include <sak/aligned_allocator.hpp>
+
+#include "bit_slice.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Keeps the symbols of a binary8 encoder as bit planes, so
+    ///        the coded symbols are computed with XORs only.
+    ///
+    /// With the symbols stored as bytes every multiply-add of the
+    /// encoder is a table driven GF(2^8) multiplication. This layer
+    /// converts the symbols to 8 bit planes in set_symbols() and
+    /// set_symbol(), see bit_slice(), and the bitmatrix_math layer below
+    /// then multiplies a plane symbol by a coefficient as XORs of whole
+    /// planes, which the add kernels run at full register width. The
+    /// coded symbol is converted back to bytes as it is written to the
+    /// payload, so the payloads are those of the stack without the
+    /// layer and are decoded by any decoder of the code. The
+    /// conversion costs one pass over the coded symbol, against one
+    /// table driven pass per source symbol.
+    ///
+    /// The layer is placed above the linear_block_encoder, symbol()
+    /// below it returns the bit planes while copy_symbols() and
+    /// copy_symbol() return the bytes. The symbol size must be a
+    /// multiple of 8.
+    template<class SuperCoder>
+    class bit_sliced_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        static_assert(std::is_same<field_type, fifi::binary8>::value,
+                      "The bit planes are the bits of binary8 elements");
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_planes.resize(the_factory.max_symbol_size());
+            m_bytes.resize(the_factory.max_symbol_size());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            // The planes hold whole bytes
+            assert((SuperCoder::symbol_size() % bit_planes) == 0);
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            assert(symbol_storage.m_size > 0);
+            assert(symbol_storage.m_data != 0);
+            assert(symbol_storage.m_size <= SuperCoder::block_size());
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+            sak::const_storage src = symbol_storage;
+
+            // As for the deep_symbol_storage all symbols are set, the
+            // symbols beyond partial data are zero
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                uint32_t size = std::min(src.m_size, symbol_size);
+
+                std::copy_n(src.m_data, size, &m_bytes[0]);
+                std::fill(&m_bytes[0] + size, &m_bytes[0] + symbol_size, 0);
+
+                src.m_data += size;
+                src.m_size -= size;
+
+                set_sliced_symbol(i, &m_bytes[0]);
+            }
+        }
+
+        /// @copydoc layer::set_symbol(uint32_t, const sak::const_storage&)
+        void set_symbol(uint32_t index, const sak::const_storage &symbol)
+        {
+            assert(symbol.m_data != 0);
+            assert(symbol.m_size == SuperCoder::symbol_size());
+
+            set_sliced_symbol(index, symbol.m_data);
+        }
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        void copy_symbols(const sak::mutable_storage &dest)
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            sak::mutable_storage storage = dest;
+            uint32_t symbol_index = 0;
+
+            while(storage.m_size > 0 &&
+                  symbol_index < SuperCoder::symbols())
+            {
+                uint32_t size =
+                    std::min(storage.m_size, SuperCoder::symbol_size());
+
+                copy_symbol(symbol_index, sak::storage(storage.m_data, size));
+
+                storage.m_data += size;
+                storage.m_size -= size;
+
+                ++symbol_index;
+            }
+        }
+
+        /// @copydoc layer::copy_symbol(uint32_t,
+        ///                             const sak::mutable_storage&)
+        void copy_symbol(uint32_t index, const sak::mutable_storage &dest)
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            uint32_t size = std::min(dest.m_size, SuperCoder::symbol_size());
+
+            bit_unslice(&m_bytes[0], SuperCoder::symbol(index),
+                        SuperCoder::symbol_size());
+
+            std::copy_n(&m_bytes[0], size, dest.m_data);
+        }
+
+        /// Computes the coded symbol on the bit planes and writes it as
+        /// bytes
+        /// @copydoc layer::encode_symbol(uint8_t*, uint8_t*)
+        void encode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            SuperCoder::encode_symbol(&m_planes[0], coefficients);
+
+            bit_unslice(symbol_data, &m_planes[0],
+                        SuperCoder::symbol_size());
+        }
+
+        /// @copydoc layer::encode_symbol(uint8_t*,uint32_t)
+        void encode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            bit_unslice(symbol_data, SuperCoder::symbol(symbol_index),
+                        SuperCoder::symbol_size());
+        }
+
+        /// The symbol is stored as bit planes, so it is converted into
+        /// a buffer of the layer, which is valid until the next call
+        /// @copydoc linear_block_encoder::encode_symbol_in_place(uint32_t)
+        const uint8_t* encode_symbol_in_place(uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            bit_unslice(&m_bytes[0], SuperCoder::symbol(symbol_index),
+                        SuperCoder::symbol_size());
+
+            return &m_bytes[0];
+        }
+
+    private:
+
+        /// Stores a symbol as bit planes
+        /// @param index The index of the symbol
+        /// @param data The bytes of the symbol
+        void set_sliced_symbol(uint32_t index, const uint8_t *data)
+        {
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            bit_slice(&m_planes[0], data, symbol_size);
+
+            SuperCoder::set_symbol(
+                index, sak::storage(&m_planes[0], symbol_size));
+        }
+
+    private:
+
+        /// The storage type
+        typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
+            aligned_vector;
+
+        /// The bit planes of a symbol
+        aligned_vector m_planes;
+
+        /// The bytes of a symbol
+        aligned_vector m_bytes;
+
+    };
+
+}
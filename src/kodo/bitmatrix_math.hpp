@@ -0,0 +1,212 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <fifi/is_binary.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup finite_field_layers
+    /// @brief Performs the multiply-add operations on symbols as XORs
+    ///        of packets, using the binary matrix expansion of the
+    ///        coefficients.
+    ///
+    /// A symbol is split into w = field_type::degree packets, and bit b
+    /// of the packets p_0,...,p_{w-1} is read as the element
+    /// sum_i p_i[b] x^i of GF(2^w). Multiplying such a symbol by a
+    /// coefficient c is then a linear map over GF(2) given by the w x w
+    /// bit matrix whose column j holds the bits of c x^j. Applying it
+    /// only takes the XOR of the source packets selected by the bit
+    /// matrix into the destination packets, no table lookups or field
+    /// multiplications are made on the data.
+    ///
+    /// The layer replaces multiply_add(), multiply_copy(),
+    /// multiply_add_sources() and multiply_sources(), all the layers
+    /// producing or consuming symbol data must therefore use only these
+    /// operations and additions. The other operations of the
+    /// finite_field_math layer are left unchanged, so that they can still
+    /// be used on coefficient vectors, where every value is one field
+    /// element. The symbol length must be a multiple of the degree of the
+    /// field.
+    template<class SuperCoder>
+    class bitmatrix_math : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The number of packets per symbol
+        static const uint32_t packets = field_type::degree;
+
+        static_assert(!fifi::is_binary<field_type>::value,
+                      "The binary field needs no bit matrix expansion");
+
+    public:
+
+        /// @copydoc layer::multipy_add(value_type *, const value_type*,
+        ///                             value_type, uint32_t)
+        void multiply_add(value_type *symbol_dest,
+                          const value_type *symbol_src,
+                          value_type coefficient, uint32_t symbol_length)
+        {
+            multiply_add_sources(symbol_dest, &symbol_src, &coefficient,
+                                 1, symbol_length);
+        }
+
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(value_type *symbol_dest,
+                                  const value_type **symbols_src,
+                                  const value_type *coefficients,
+                                  uint32_t sources, uint32_t symbol_length)
+        {
+            assert(symbol_dest != 0);
+            assert(symbols_src != 0);
+            assert(coefficients != 0);
+            assert(symbol_length > 0);
+            assert((symbol_length % packets) == 0);
+
+            uint32_t packet_length = symbol_length / packets;
+
+            for(uint32_t i = 0; i < sources; ++i)
+            {
+                assert(symbols_src[i] != 0);
+
+                value_type columns[packets];
+                expand(coefficients[i], columns);
+
+                for(uint32_t j = 0; j < packets; ++j)
+                {
+                    const value_type *src =
+                        symbols_src[i] + j * packet_length;
+
+                    for(uint32_t r = 0; r < packets; ++r)
+                    {
+                        if((columns[j] >> r) & 1U)
+                        {
+                            SuperCoder::add(
+                                symbol_dest + r * packet_length, src,
+                                packet_length);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// @copydoc layer::multiply_copy(value_type*, const value_type*,
+        ///                              value_type, uint32_t)
+        void multiply_copy(value_type *symbol_dest,
+                           const value_type *symbol_src,
+                           value_type coefficient, uint32_t symbol_length)
+        {
+            multiply_sources(symbol_dest, &symbol_src, &coefficient,
+                             1, symbol_length);
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(value_type *symbol_dest,
+                              const value_type **symbols_src,
+                              const value_type *coefficients,
+                              uint32_t sources, uint32_t symbol_length)
+        {
+            assert(symbol_dest != 0);
+            assert(sources == 0 || symbols_src != 0);
+            assert(sources == 0 || coefficients != 0);
+            assert(symbol_length > 0);
+            assert((symbol_length % packets) == 0);
+
+            uint32_t packet_length = symbol_length / packets;
+
+            // The first source packet selected for a destination packet
+            // is copied to it, only the packets never selected are zeroed
+            bool written[packets] = { false };
+
+            for(uint32_t i = 0; i < sources; ++i)
+            {
+                assert(symbols_src[i] != 0);
+
+                value_type columns[packets];
+                expand(coefficients[i], columns);
+
+                for(uint32_t j = 0; j < packets; ++j)
+                {
+                    const value_type *src =
+                        symbols_src[i] + j * packet_length;
+
+                    for(uint32_t r = 0; r < packets; ++r)
+                    {
+                        if(((columns[j] >> r) & 1U) == 0)
+                        {
+                            continue;
+                        }
+
+                        value_type *dest = symbol_dest + r * packet_length;
+
+                        if(written[r])
+                        {
+                            SuperCoder::add(dest, src, packet_length);
+                        }
+                        else
+                        {
+                            std::copy_n(src, packet_length, dest);
+                            written[r] = true;
+                        }
+                    }
+                }
+            }
+
+            for(uint32_t r = 0; r < packets; ++r)
+            {
+                if(!written[r])
+                {
+                    std::fill_n(symbol_dest + r * packet_length,
+                                packet_length, 0);
+                }
+            }
+        }
+
+    protected:
+
+        /// Computes the columns of the bit matrix of a coefficient
+        /// @param coefficient The coefficient
+        /// @param columns Receives the column j as the element
+        ///        coefficient * x^j, one bit per row
+        void expand(value_type coefficient, value_type *columns) const
+        {
+            assert(columns != 0);
+            assert(SuperCoder::m_field);
+
+            columns[0] = coefficient;
+
+            for(uint32_t j = 1; j < packets; ++j)
+            {
+                // Multiplying with 2U corresponds to multiplying
+                // with x
+                columns[j] = SuperCoder::m_field->multiply(
+                    columns[j - 1], 2U);
+            }
+        }
+
+    };
+
+    template<class SuperCoder>
+    const uint32_t bitmatrix_math<SuperCoder>::packets;
+
+}
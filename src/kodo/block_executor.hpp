@@ -0,0 +1,275 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// @brief Work-stealing executor running tasks on a fixed set of
+    ///        worker threads, used to process the blocks of an object
+    ///        in parallel.
+    ///
+    /// Every task is identified by a number, typically the index of a
+    /// block, and is queued at the worker given by the number modulo the
+    /// number of workers. Processing the same block on the same worker
+    /// in consecutive runs keeps the data of the coder in the caches of
+    /// that core. A worker which runs out of tasks steals from the other
+    /// workers, so uneven blocks or workers delayed by the operating
+    /// system do not stall the run.
+    ///
+    /// The tasks of one run must be independent i.e. no two tasks may
+    /// use the same coder.
+    class block_executor : boost::noncopyable
+    {
+    public:
+
+        /// The task type, invoked with the task number
+        typedef std::function<void (uint32_t)> task_type;
+
+    public:
+
+        /// Starts the worker threads
+        /// @param threads The number of worker threads, zero means one
+        ///        per hardware thread
+        block_executor(uint32_t threads = 0)
+            : m_generation(0),
+              m_pending(0),
+              m_stop(false)
+        {
+            if(threads == 0)
+            {
+                threads = std::thread::hardware_concurrency();
+            }
+
+            threads = std::max(threads, 1U);
+
+            for(uint32_t i = 0; i < threads; ++i)
+            {
+                m_queues.push_back(
+                    std::unique_ptr<task_queue>(new task_queue));
+            }
+
+            for(uint32_t i = 0; i < threads; ++i)
+            {
+                m_threads.push_back(
+                    std::thread(&block_executor::work, this, i));
+            }
+        }
+
+        /// Stops and joins the worker threads
+        ~block_executor()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+
+            m_start.notify_all();
+
+            for(auto &thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        /// @return The number of worker threads
+        uint32_t threads() const
+        {
+            return static_cast<uint32_t>(m_threads.size());
+        }
+
+        /// Runs the tasks 0 to count - 1 and waits for them to
+        /// complete
+        /// @param count The number of tasks
+        /// @param task The function invoked for every task
+        void run(uint32_t count, const task_type &task)
+        {
+            std::vector<uint32_t> tasks(count);
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                tasks[i] = i;
+            }
+
+            run(tasks, task);
+        }
+
+        /// Runs a list of tasks and waits for them to complete
+        /// @param tasks The task numbers, each task is queued at the
+        ///        worker given by its number modulo the number of
+        ///        workers
+        /// @param task The function invoked for every task
+        void run(const std::vector<uint32_t> &tasks, const task_type &task)
+        {
+            assert(task);
+
+            if(tasks.empty())
+            {
+                return;
+            }
+
+            // Only one run at a time
+            std::lock_guard<std::mutex> run_lock(m_run_mutex);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            assert(m_pending == 0);
+
+            m_task = task;
+
+            for(uint32_t t : tasks)
+            {
+                task_queue &queue = *m_queues[t % m_queues.size()];
+
+                std::lock_guard<std::mutex> queue_lock(queue.m_mutex);
+                queue.m_tasks.push_back(t);
+            }
+
+            m_pending = static_cast<uint32_t>(tasks.size());
+            ++m_generation;
+
+            m_start.notify_all();
+            m_done.wait(lock, [this] { return m_pending == 0; });
+
+            m_task = task_type();
+        }
+
+    private:
+
+        /// The tasks queued at a worker
+        struct task_queue
+        {
+            /// Protects the tasks
+            std::mutex m_mutex;
+
+            /// The tasks
+            std::deque<uint32_t> m_tasks;
+        };
+
+    private:
+
+        /// The worker thread function
+        /// @param index The index of the worker
+        void work(uint32_t index)
+        {
+            uint64_t generation = 0;
+
+            while(true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+
+                    m_start.wait(lock, [&] {
+                        return m_stop || m_generation != generation; });
+
+                    if(m_stop)
+                    {
+                        return;
+                    }
+
+                    generation = m_generation;
+                }
+
+                uint32_t task;
+                while(next_task(index, task))
+                {
+                    m_task(task);
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    assert(m_pending > 0);
+
+                    if(--m_pending == 0)
+                    {
+                        m_done.notify_all();
+                    }
+                }
+            }
+        }
+
+        /// Takes the next task of a worker, first from the front of its
+        /// own queue and otherwise from the back of the other queues
+        /// @param index The index of the worker
+        /// @param task Set to the task taken
+        /// @return true if a task was taken
+        bool next_task(uint32_t index, uint32_t &task)
+        {
+            uint32_t workers = static_cast<uint32_t>(m_queues.size());
+
+            {
+                task_queue &own = *m_queues[index];
+                std::lock_guard<std::mutex> lock(own.m_mutex);
+
+                if(!own.m_tasks.empty())
+                {
+                    task = own.m_tasks.front();
+                    own.m_tasks.pop_front();
+                    return true;
+                }
+            }
+
+            for(uint32_t i = 1; i < workers; ++i)
+            {
+                task_queue &victim = *m_queues[(index + i) % workers];
+                std::lock_guard<std::mutex> lock(victim.m_mutex);
+
+                if(!victim.m_tasks.empty())
+                {
+                    task = victim.m_tasks.back();
+                    victim.m_tasks.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+
+        /// The task queues of the workers
+        std::vector<std::unique_ptr<task_queue> > m_queues;
+
+        /// The worker threads
+        std::vector<std::thread> m_threads;
+
+        /// Serializes the runs
+        std::mutex m_run_mutex;
+
+        /// Protects the run state
+        std::mutex m_mutex;
+
+        /// Signals the workers that a run started or the executor stops
+        std::condition_variable m_start;
+
+        /// Signals that all tasks of a run completed
+        std::condition_variable m_done;
+
+        /// The function invoked for the tasks of the current run
+        task_type m_task;
+
+        /// Incremented for every run
+        uint64_t m_generation;
+
+        /// The number of tasks of the current run not yet completed
+        uint32_t m_pending;
+
+        /// True when the executor is stopping
+        bool m_stop;
+
+    };
+
+}
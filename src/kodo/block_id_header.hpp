@@ -0,0 +1,79 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <sak/convert_endian.hpp>
+
+namespace kodo
+{
+
+    /// @return The size in bytes of the block id written in front of
+    ///         the payloads of an object, the smallest of 1, 2 or 4
+    ///         bytes holding the largest block id
+    /// @param blocks The number of blocks of the object
+    inline uint32_t block_id_size(uint32_t blocks)
+    {
+        assert(blocks > 0);
+
+        if(blocks <= (1U << 8))
+            return 1;
+
+        if(blocks <= (1U << 16))
+            return 2;
+
+        return 4;
+    }
+
+    /// Writes a block id in big endian byte order
+    /// @param block_id The block id
+    /// @param id_size The size of the block id, see block_id_size()
+    /// @param buffer The buffer of at least id_size bytes
+    inline void write_block_id(uint32_t block_id, uint32_t id_size,
+                               uint8_t *buffer)
+    {
+        assert(buffer != 0);
+
+        switch(id_size)
+        {
+        case 1:
+            assert(block_id < (1U << 8));
+            sak::big_endian::put<uint8_t>(block_id, buffer);
+            break;
+        case 2:
+            assert(block_id < (1U << 16));
+            sak::big_endian::put<uint16_t>(block_id, buffer);
+            break;
+        default:
+            assert(id_size == 4);
+            sak::big_endian::put<uint32_t>(block_id, buffer);
+            break;
+        }
+    }
+
+    /// Reads a block id written by write_block_id()
+    /// @param id_size The size of the block id, see block_id_size()
+    /// @param buffer The buffer holding the block id
+    /// @return The block id
+    inline uint32_t read_block_id(uint32_t id_size, const uint8_t *buffer)
+    {
+        assert(buffer != 0);
+
+        switch(id_size)
+        {
+        case 1:
+            return sak::big_endian::get<uint8_t>(buffer);
+        case 2:
+            return sak::big_endian::get<uint16_t>(buffer);
+        default:
+            assert(id_size == 4);
+            return sak::big_endian::get<uint32_t>(buffer);
+        }
+    }
+
+}
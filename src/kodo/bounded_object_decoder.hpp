@@ -0,0 +1,512 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <sak/storage.hpp>
+
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Decodes an object split over multiple decoders while
+    ///        keeping the memory of the decoders within a budget.
+    ///
+    /// Contrary to the object_decoder, which leaves it to the caller to
+    /// keep one decoder per block, the decoders are managed by this
+    /// class. A decoder is built when the first payload of its block
+    /// arrives and as soon as the block is complete it is copied to the
+    /// object buffer and released, which recycles the decoder to the
+    /// pool of the factory.
+    ///
+    /// The memory of a live decoder is counted as its block and its
+    /// coefficient vectors. When a decoder would exceed the budget, the
+    /// least recently active partial decoders are spilled: the pivot
+    /// rows, i.e. the symbol and coefficients of every pivot, are
+    /// written to a file in the spill directory, or if no directory is
+    /// set or the file cannot be written to a compact buffer holding
+    /// only the pivot rows. When a payload of a spilled block arrives
+    /// the decoder is rebuilt by decoding the pivot rows again.
+    ///
+    /// The DecoderType must provide the decode_symbol() functions for
+    /// coded and uncoded symbols, symbol_pivot(), symbol_coded() and
+    /// access to the symbol and coefficient storage, as e.g. the
+    /// full_rlnc_decoder.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class bounded_object_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+    public:
+
+        /// Constructs a new bounded object decoder
+        /// @param decoder_factory The decoder factory to use
+        /// @param object The buffer receiving the decoded object
+        /// @param memory_budget The maximum memory in bytes of the live
+        ///        decoders, at least one decoder is always kept
+        bounded_object_decoder(factory &decoder_factory,
+                               const sak::mutable_storage &object,
+                               uint64_t memory_budget)
+            : m_factory(decoder_factory),
+              m_object(object),
+              m_memory_budget(memory_budget),
+              m_memory_used(0),
+              m_completed(0),
+              m_spills(0)
+        {
+            assert(m_object.m_data != 0);
+            assert(m_object.m_size > 0);
+
+            m_partitioning = block_partitioning(
+                m_factory.max_symbols(),
+                m_factory.max_symbol_size(),
+                m_object.m_size);
+
+            m_blocks.resize(m_partitioning.blocks());
+        }
+
+        /// Removes the spill files
+        ~bounded_object_decoder()
+        {
+            for(uint32_t i = 0; i < m_blocks.size(); ++i)
+            {
+                if(m_blocks[i].m_spilled_to_file)
+                {
+                    std::remove(spill_file(i).c_str());
+                }
+            }
+        }
+
+        /// Sets the directory of the spill files, if not set the
+        /// spilled decoders are kept in compact buffers
+        /// @param directory The directory, which must exist
+        void set_spill_directory(const std::string &directory)
+        {
+            m_spill_directory = directory;
+        }
+
+        /// @return The number of blocks of the object
+        uint32_t blocks() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// Decodes a payload of a block. If the block is completed the
+        /// decoded data is copied to the object buffer and the decoder
+        /// released.
+        /// @param block_id The block of the payload
+        /// @param payload The payload, which is modified by the decoder
+        /// @return True if the block is complete
+        bool decode(uint32_t block_id, uint8_t *payload)
+        {
+            assert(block_id < m_blocks.size());
+            assert(payload != 0);
+
+            block_state &block = m_blocks[block_id];
+
+            if(block.m_complete)
+            {
+                return true;
+            }
+
+            pointer decoder = activate(block_id);
+            decoder->decode(payload);
+
+            if(decoder->is_complete())
+            {
+                complete(block_id);
+                return true;
+            }
+
+            return false;
+        }
+
+        /// @return True if all blocks of the object are decoded
+        bool is_complete() const
+        {
+            return m_completed == m_blocks.size();
+        }
+
+        /// @param block_id The block
+        /// @return True if the block is decoded
+        bool is_block_complete(uint32_t block_id) const
+        {
+            assert(block_id < m_blocks.size());
+            return m_blocks[block_id].m_complete;
+        }
+
+        /// @param block_id The block
+        /// @return True if the partial decoder of the block is spilled
+        bool is_block_spilled(uint32_t block_id) const
+        {
+            assert(block_id < m_blocks.size());
+            return m_blocks[block_id].m_spilled;
+        }
+
+        /// @return The number of live decoders
+        uint32_t live_decoders() const
+        {
+            return static_cast<uint32_t>(m_active.size());
+        }
+
+        /// @return The memory in bytes of the live decoders
+        uint64_t memory_used() const
+        {
+            return m_memory_used;
+        }
+
+        /// @return The maximum memory in bytes of the live decoders
+        uint64_t memory_budget() const
+        {
+            return m_memory_budget;
+        }
+
+        /// @return The number of times a decoder was spilled
+        uint32_t spills() const
+        {
+            return m_spills;
+        }
+
+    protected:
+
+        /// The state of one block of the object
+        struct block_state
+        {
+            block_state()
+                : m_complete(false),
+                  m_spilled(false),
+                  m_spilled_to_file(false),
+                  m_memory(0)
+            { }
+
+            /// The live decoder of the block
+            pointer m_decoder;
+
+            /// The position of the block in the activity list
+            typename std::list<uint32_t>::iterator m_active;
+
+            /// True if the block is decoded
+            bool m_complete;
+
+            /// True if the pivot rows of the block are spilled
+            bool m_spilled;
+
+            /// True if the pivot rows are in the spill file
+            bool m_spilled_to_file;
+
+            /// The pivot rows if spilled to memory
+            std::vector<uint8_t> m_rows;
+
+            /// The memory of the live decoder
+            uint64_t m_memory;
+        };
+
+    protected:
+
+        /// @return The live decoder of a block, building or restoring
+        ///         it if needed, the block becomes the most recently
+        ///         active
+        /// @param block_id The block
+        pointer activate(uint32_t block_id)
+        {
+            block_state &block = m_blocks[block_id];
+
+            if(block.m_decoder)
+            {
+                m_active.splice(m_active.begin(), m_active,
+                                block.m_active);
+                return block.m_decoder;
+            }
+
+            uint64_t memory = decoder_memory(block_id);
+
+            while(!m_active.empty() &&
+                  m_memory_used + memory > m_memory_budget)
+            {
+                spill(m_active.back());
+            }
+
+            block.m_decoder = build(block_id);
+            block.m_memory = memory;
+            m_memory_used += memory;
+
+            m_active.push_front(block_id);
+            block.m_active = m_active.begin();
+
+            if(block.m_spilled)
+            {
+                restore(block_id);
+            }
+
+            return block.m_decoder;
+        }
+
+        /// Copies a completed block to the object and releases the
+        /// decoder
+        /// @param block_id The block
+        void complete(uint32_t block_id)
+        {
+            block_state &block = m_blocks[block_id];
+            assert(block.m_decoder);
+
+            // The object is a storage object, so the offset fits in
+            // 32 bit
+            uint32_t offset = static_cast<uint32_t>(
+                m_partitioning.byte_offset(block_id));
+            uint32_t bytes_used = m_partitioning.bytes_used(block_id);
+
+            block.m_decoder->copy_symbols(
+                sak::storage(m_object.m_data + offset, bytes_used));
+
+            release(block_id);
+
+            block.m_complete = true;
+            ++m_completed;
+        }
+
+        /// Releases the live decoder of a block
+        /// @param block_id The block
+        void release(uint32_t block_id)
+        {
+            block_state &block = m_blocks[block_id];
+
+            assert(m_memory_used >= block.m_memory);
+            m_memory_used -= block.m_memory;
+
+            m_active.erase(block.m_active);
+            block.m_decoder.reset();
+            block.m_memory = 0;
+        }
+
+        /// Spills the pivot rows of a live decoder and releases it. The
+        /// rows are stored as the row index, a coded flag, the symbol
+        /// and for coded rows the coefficients.
+        /// @param block_id The block
+        void spill(uint32_t block_id)
+        {
+            block_state &block = m_blocks[block_id];
+            pointer decoder = block.m_decoder;
+            assert(decoder);
+
+            uint32_t symbol_size = decoder->symbol_size();
+            uint32_t coefficients_size = decoder->coefficients_size();
+
+            std::vector<uint8_t> rows;
+
+            for(uint32_t i = 0; i < decoder->symbols(); ++i)
+            {
+                if(!decoder->symbol_pivot(i))
+                {
+                    continue;
+                }
+
+                bool coded = decoder->symbol_coded(i);
+
+                const uint8_t *index =
+                    reinterpret_cast<const uint8_t*>(&i);
+
+                rows.insert(rows.end(), index, index + sizeof(i));
+                rows.push_back(coded ? 1 : 0);
+
+                const uint8_t *symbol = decoder->symbol(i);
+                rows.insert(rows.end(), symbol, symbol + symbol_size);
+
+                if(coded)
+                {
+                    const uint8_t *coefficients = decoder->coefficients(i);
+                    rows.insert(rows.end(), coefficients,
+                                coefficients + coefficients_size);
+                }
+            }
+
+            block.m_spilled = true;
+            block.m_spilled_to_file = false;
+            block.m_rows.clear();
+
+            if(!m_spill_directory.empty())
+            {
+                std::ofstream file(spill_file(block_id).c_str(),
+                                   std::ios::binary | std::ios::trunc);
+
+                file.write(reinterpret_cast<const char*>(rows.data()),
+                           rows.size());
+
+                block.m_spilled_to_file = file.good();
+            }
+
+            if(!block.m_spilled_to_file)
+            {
+                block.m_rows.swap(rows);
+            }
+
+            ++m_spills;
+            release(block_id);
+        }
+
+        /// Restores the spilled pivot rows into the newly built decoder
+        /// of a block
+        /// @param block_id The block
+        void restore(uint32_t block_id)
+        {
+            block_state &block = m_blocks[block_id];
+            pointer decoder = block.m_decoder;
+            assert(decoder);
+            assert(block.m_spilled);
+
+            std::vector<uint8_t> rows;
+
+            if(block.m_spilled_to_file)
+            {
+                std::ifstream file(spill_file(block_id).c_str(),
+                                   std::ios::binary);
+
+                rows.assign(std::istreambuf_iterator<char>(file),
+                            std::istreambuf_iterator<char>());
+
+                file.close();
+                std::remove(spill_file(block_id).c_str());
+            }
+            else
+            {
+                rows.swap(block.m_rows);
+            }
+
+            block.m_spilled = false;
+            block.m_spilled_to_file = false;
+
+            uint32_t symbol_size = decoder->symbol_size();
+            uint32_t coefficients_size = decoder->coefficients_size();
+
+            uint32_t offset = 0;
+
+            while(offset < rows.size())
+            {
+                uint32_t index;
+                std::copy(&rows[offset], &rows[offset] + sizeof(index),
+                          reinterpret_cast<uint8_t*>(&index));
+                offset += sizeof(index);
+
+                bool coded = rows[offset] != 0;
+                offset += 1;
+
+                uint8_t *symbol = &rows[offset];
+                offset += symbol_size;
+
+                if(coded)
+                {
+                    uint8_t *coefficients = &rows[offset];
+                    offset += coefficients_size;
+
+                    decoder->decode_symbol(symbol, coefficients);
+                }
+                else
+                {
+                    decoder->decode_symbol(symbol, index);
+                }
+
+                assert(offset <= rows.size());
+            }
+        }
+
+        /// Builds the decoder of a block
+        /// @param block_id The block
+        /// @return The initialized decoder
+        pointer build(uint32_t block_id)
+        {
+            m_factory.set_symbols(m_partitioning.symbols(block_id));
+            m_factory.set_symbol_size(m_partitioning.symbol_size(block_id));
+
+            pointer decoder = m_factory.build();
+            decoder->set_bytes_used(m_partitioning.bytes_used(block_id));
+
+            return decoder;
+        }
+
+        /// @return The memory in bytes of the decoder of a block, its
+        ///         symbols and coefficient vectors
+        /// @param block_id The block
+        uint64_t decoder_memory(uint32_t block_id) const
+        {
+            uint64_t symbols = m_partitioning.symbols(block_id);
+            uint64_t block_size = m_partitioning.block_size(block_id);
+
+            // The coefficient vectors are symbols elements long, and
+            // rounded up to whole bytes for the fields with several
+            // elements per byte
+            uint64_t coefficients_size =
+                (symbols * DecoderType::field_type::degree + 7) / 8;
+
+            return block_size + symbols * coefficients_size;
+        }
+
+        /// @return The spill file of a block
+        /// @param block_id The block
+        std::string spill_file(uint32_t block_id) const
+        {
+            return m_spill_directory + "/kodo_block_" +
+                boost::lexical_cast<std::string>(block_id) + ".spill";
+        }
+
+    protected:
+
+        /// The decoder factory
+        factory &m_factory;
+
+        /// The buffer receiving the decoded object
+        sak::mutable_storage m_object;
+
+        /// The block partitioning scheme used
+        block_partitioning m_partitioning;
+
+        /// The state of the blocks
+        std::vector<block_state> m_blocks;
+
+        /// The blocks with live decoders, most recently active first
+        std::list<uint32_t> m_active;
+
+        /// The directory of the spill files
+        std::string m_spill_directory;
+
+        /// The maximum memory of the live decoders
+        uint64_t m_memory_budget;
+
+        /// The memory of the live decoders
+        uint64_t m_memory_used;
+
+        /// The number of completed blocks
+        uint32_t m_completed;
+
+        /// The number of times a decoder was spilled
+        uint32_t m_spills;
+    };
+
+}
@@ -0,0 +1,239 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+
+#include "checksum_encoder.hpp"
+#include "crc32c.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Verifies the decoded symbols against the checksums
+    ///        computed by the checksum_encoder.
+    ///
+    /// Instead of checksumming the block after it is copied out of the
+    /// decoder, which streams the block through the cache once more,
+    /// a symbol is verified when it becomes decoded and was just
+    /// written: an uncoded symbol as soon as it is stored, and the
+    /// remaining symbols when the decoder completes, right after the
+    /// final backward substitution has updated them.
+    ///
+    /// The checksums are set with read_checksums(), symbols decoded
+    /// before that are verified by read_checksums(). A symbol failing
+    /// the verification is reported by symbol_failed() and counted by
+    /// checksum_failures(), the decoding itself is not affected. The
+    /// layer must be placed above the linear_block_decoder.
+    template<class SuperCoder>
+    class checksum_decoder : public SuperCoder
+    {
+    public:
+
+        /// Constructor
+        checksum_decoder()
+            : m_has_checksums(false),
+              m_verified_count(0),
+              m_failures(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_checksums.resize(the_factory.max_symbols(), 0);
+            m_verified.resize(the_factory.max_symbols(), false);
+            m_failed.resize(the_factory.max_symbols(), false);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill(m_verified.begin(), m_verified.end(), false);
+            std::fill(m_failed.begin(), m_failed.end(), false);
+
+            m_has_checksums = false;
+            m_verified_count = 0;
+            m_failures = 0;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+
+            if(SuperCoder::is_complete())
+            {
+                verify_all();
+            }
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(SuperCoder::is_complete())
+            {
+                verify_all();
+                return;
+            }
+
+            // The symbol was just stored, unless the decoder already
+            // had it uncoded
+            if(SuperCoder::symbol_pivot(symbol_index) &&
+               !SuperCoder::symbol_coded(symbol_index))
+            {
+                verify(symbol_index);
+            }
+        }
+
+        /// Sets the checksums written by
+        /// checksum_encoder::write_checksums() and verifies the symbols
+        /// already decoded
+        /// @param buffer The buffer of checksums_size() bytes
+        void read_checksums(const uint8_t *buffer)
+        {
+            assert(buffer != 0);
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                m_checksums[i] = sak::big_endian::get<uint32_t>(
+                    buffer + i * sizeof(uint32_t));
+            }
+
+            m_has_checksums = true;
+
+            if(SuperCoder::is_complete())
+            {
+                verify_all();
+                return;
+            }
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(SuperCoder::symbol_pivot(i) && !SuperCoder::symbol_coded(i))
+                {
+                    verify(i);
+                }
+            }
+        }
+
+        /// @return The size in bytes of the checksums of the block
+        uint32_t checksums_size() const
+        {
+            return kodo::checksums_size(SuperCoder::symbols());
+        }
+
+        /// @param index The index of a symbol
+        /// @return True if the symbol has been verified, whether or not
+        ///         it matched its checksum
+        bool is_symbol_verified(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_verified[index];
+        }
+
+        /// @param index The index of a symbol
+        /// @return True if the symbol did not match its checksum
+        bool symbol_failed(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_failed[index];
+        }
+
+        /// @return The number of symbols which did not match their
+        ///         checksum
+        uint32_t checksum_failures() const
+        {
+            return m_failures;
+        }
+
+        /// @return True if every symbol of the block is verified and
+        ///         matched its checksum
+        bool is_intact() const
+        {
+            return m_verified_count == SuperCoder::symbols() &&
+                m_failures == 0;
+        }
+
+    protected:
+
+        /// Verifies a decoded symbol once
+        /// @param index The index of the symbol
+        void verify(uint32_t index)
+        {
+            assert(index < SuperCoder::symbols());
+
+            if(!m_has_checksums || m_verified[index])
+            {
+                return;
+            }
+
+            const uint8_t *symbol = SuperCoder::symbol(index);
+            assert(symbol != 0);
+
+            m_verified[index] = true;
+            ++m_verified_count;
+
+            if(crc32c(symbol, SuperCoder::symbol_size()) != m_checksums[index])
+            {
+                m_failed[index] = true;
+                ++m_failures;
+            }
+        }
+
+        /// Verifies all the symbols not verified yet, the decoder must
+        /// be complete
+        void verify_all()
+        {
+            assert(SuperCoder::is_complete());
+
+            if(!m_has_checksums || m_verified_count == SuperCoder::symbols())
+            {
+                return;
+            }
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                verify(i);
+            }
+        }
+
+    protected:
+
+        /// The checksums of the symbols
+        std::vector<uint32_t> m_checksums;
+
+        /// The symbols which have been verified
+        std::vector<bool> m_verified;
+
+        /// The symbols which did not match their checksum
+        std::vector<bool> m_failed;
+
+        /// True once the checksums are set
+        bool m_has_checksums;
+
+        /// The number of verified symbols
+        uint32_t m_verified_count;
+
+        /// The number of symbols which did not match their checksum
+        uint32_t m_failures;
+
+    };
+
+}
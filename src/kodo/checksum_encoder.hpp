@@ -0,0 +1,131 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+
+#include "crc32c.hpp"
+
+namespace kodo
+{
+
+    /// @return The size in bytes of the checksums of a block
+    /// @param symbols The number of symbols of the block
+    inline uint32_t checksums_size(uint32_t symbols)
+    {
+        return symbols * sizeof(uint32_t);
+    }
+
+    /// @ingroup codec_layers
+    /// @brief Computes a CRC32C of every source symbol when the symbols
+    ///        are set on the encoder.
+    ///
+    /// The checksums are computed right after the symbols are stored,
+    /// while a copied symbol is still in the cache, instead of in a
+    /// separate pass over the block. They are serialized with
+    /// write_checksums() and sent with the metadata of the object, the
+    /// checksum_decoder verifies the decoded symbols against them. A
+    /// checksum covers the whole symbol as stored by the encoder,
+    /// including the zero padding of the last symbol.
+    template<class SuperCoder>
+    class checksum_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_checksums.resize(the_factory.max_symbols(), 0);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill(m_checksums.begin(), m_checksums.end(), 0);
+        }
+
+        /// Sets the symbols and computes their checksums
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        template<class Storage>
+        void set_symbols(const Storage &symbol_storage)
+        {
+            SuperCoder::set_symbols(symbol_storage);
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                update_checksum(i);
+            }
+        }
+
+        /// Sets a symbol and computes its checksum
+        /// @copydoc layer::set_symbol(uint32_t, const sak::const_storage&)
+        template<class Storage>
+        void set_symbol(uint32_t index, const Storage &symbol)
+        {
+            SuperCoder::set_symbol(index, symbol);
+            update_checksum(index);
+        }
+
+        /// @param index The index of a symbol
+        /// @return The checksum of the symbol
+        uint32_t symbol_checksum(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_checksums[index];
+        }
+
+        /// @return The size in bytes of the checksums of the block
+        uint32_t checksums_size() const
+        {
+            return kodo::checksums_size(SuperCoder::symbols());
+        }
+
+        /// Writes the checksums of the block in big endian
+        /// @param buffer The buffer of checksums_size() bytes
+        void write_checksums(uint8_t *buffer) const
+        {
+            assert(buffer != 0);
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                sak::big_endian::put<uint32_t>(
+                    m_checksums[i], buffer + i * sizeof(uint32_t));
+            }
+        }
+
+    protected:
+
+        /// Computes the checksum of a stored symbol
+        /// @param index The index of the symbol
+        void update_checksum(uint32_t index)
+        {
+            assert(index < SuperCoder::symbols());
+
+            const uint8_t *symbol = SuperCoder::symbol(index);
+            assert(symbol != 0);
+
+            m_checksums[index] = crc32c(symbol, SuperCoder::symbol_size());
+        }
+
+    protected:
+
+        /// The checksums of the symbols
+        std::vector<uint32_t> m_checksums;
+
+    };
+
+}
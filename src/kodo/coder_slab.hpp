@@ -0,0 +1,306 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <new>
+
+namespace kodo
+{
+
+    /// @brief A contiguous region of memory holding a coder and the
+    ///        buffers allocated while the coder is constructed.
+    ///
+    /// The final_coder_factory_pool places a coder at the start of a
+    /// slab when slabs are enabled, and makes the slab active while the
+    /// coder is constructed. The buffers allocated with the
+    /// slab_allocator during the construction are then carved from the
+    /// slab with a bump pointer, so the coder and its storage are
+    /// adjacent in memory instead of scattered over the heap. The slab
+    /// is freed as a whole with the coder.
+    class coder_slab
+    {
+    public:
+
+        /// The alignment of the slab and of every allocation in it
+        static const std::size_t alignment = 64;
+
+    public:
+
+        /// Creates a slab
+        /// @param capacity The number of bytes available in the slab
+        /// @return The slab, which must be freed with destroy()
+        static coder_slab* create(std::size_t capacity)
+        {
+            capacity = round_up(capacity);
+
+            void *memory =
+                ::operator new(header_size() + capacity + alignment);
+
+            uint8_t *aligned = static_cast<uint8_t*>(memory);
+            aligned += alignment -
+                (reinterpret_cast<std::uintptr_t>(aligned) % alignment);
+
+            return new (aligned) coder_slab(memory, capacity);
+        }
+
+        /// Frees a slab, the objects in the slab must be destroyed
+        /// @param slab The slab
+        static void destroy(coder_slab *slab)
+        {
+            assert(slab != 0);
+            assert(active() != slab);
+
+            void *memory = slab->m_memory;
+            slab->~coder_slab();
+
+            ::operator delete(memory);
+        }
+
+        /// @param first The first allocation of a slab
+        /// @return The slab holding the allocation
+        static coder_slab* from_first(void *first)
+        {
+            assert(first != 0);
+
+            coder_slab *slab = reinterpret_cast<coder_slab*>(
+                static_cast<uint8_t*>(first) - header_size());
+
+            assert(slab->m_begin == first);
+            return slab;
+        }
+
+        /// @return The slab used by the slab_allocator on this thread,
+        ///         or null
+        static coder_slab*& active()
+        {
+            static thread_local coder_slab *slab = 0;
+            return slab;
+        }
+
+        /// Makes a slab the active slab on this thread for the lifetime
+        /// of the scope object, null uses the heap
+        class scope
+        {
+        public:
+
+            /// Constructor
+            /// @param slab The slab to activate, may be null
+            scope(coder_slab *slab)
+                : m_previous(active())
+            {
+                active() = slab;
+            }
+
+            /// Destructor, restores the previous slab
+            ~scope()
+            {
+                active() = m_previous;
+            }
+
+        private:
+
+            /// Copy constructor
+            scope(const scope&);
+
+            /// Copy assignment
+            const scope& operator=(const scope&);
+
+        private:
+
+            /// The slab active before the scope
+            coder_slab *m_previous;
+        };
+
+    public:
+
+        /// Allocates from the slab
+        /// @param size The number of bytes
+        /// @return The memory, aligned to the slab alignment, or null if
+        ///         the slab is full. The size is counted in requested()
+        ///         in both cases.
+        void* allocate(std::size_t size)
+        {
+            size = round_up(size);
+            m_requested += size;
+
+            if(size > m_capacity - m_used)
+            {
+                return 0;
+            }
+
+            void *data = m_begin + m_used;
+            m_used += size;
+
+            return data;
+        }
+
+        /// @return The number of bytes available in the slab
+        std::size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        /// @return The number of bytes allocated from the slab
+        std::size_t used() const
+        {
+            return m_used;
+        }
+
+        /// @return The number of bytes requested from the slab, which
+        ///         exceeds capacity() if some allocations did not fit
+        std::size_t requested() const
+        {
+            return m_requested;
+        }
+
+    private:
+
+        /// Constructor
+        /// @param memory The memory holding the slab
+        /// @param capacity The number of bytes following the header
+        coder_slab(void *memory, std::size_t capacity)
+            : m_memory(memory),
+              m_begin(reinterpret_cast<uint8_t*>(this) + header_size()),
+              m_capacity(capacity),
+              m_used(0),
+              m_requested(0)
+        { }
+
+        /// @return The size of the slab object rounded up to the
+        ///         alignment, the allocations follow the header
+        static std::size_t header_size()
+        {
+            return round_up(sizeof(coder_slab));
+        }
+
+        /// @param size A number of bytes
+        /// @return The size rounded up to the alignment
+        static std::size_t round_up(std::size_t size)
+        {
+            return ((size + alignment - 1) / alignment) * alignment;
+        }
+
+    private:
+
+        /// The memory of the slab as returned by operator new
+        void *m_memory;
+
+        /// The start of the allocations
+        uint8_t *m_begin;
+
+        /// The number of bytes available
+        std::size_t m_capacity;
+
+        /// The number of bytes allocated
+        std::size_t m_used;
+
+        /// The number of bytes requested
+        std::size_t m_requested;
+    };
+
+    /// @brief Allocator taking the memory from the active coder_slab,
+    ///        or from the heap when no slab is active or the slab is
+    ///        full.
+    ///
+    /// Every allocation is preceded by a header of coder_slab::alignment
+    /// bytes recording where the memory came from, so memory from a
+    /// slab is not freed individually and the allocator is stateless.
+    /// It may be used as the Allocator of the basic_deep_symbol_storage
+    /// and basic_coefficient_storage layers.
+    template<class T>
+    class slab_allocator
+    {
+    public:
+
+        /// The allocated type
+        typedef T value_type;
+
+        /// Rebinds the allocator to another type
+        template<class U>
+        struct rebind
+        {
+            /// The rebound allocator
+            typedef slab_allocator<U> other;
+        };
+
+    public:
+
+        /// Constructor
+        slab_allocator()
+        { }
+
+        /// Converting constructor
+        template<class U>
+        slab_allocator(const slab_allocator<U>&)
+        { }
+
+        /// @param n The number of elements
+        /// @return The memory, aligned to coder_slab::alignment
+        T* allocate(std::size_t n)
+        {
+            std::size_t size = n * sizeof(T) + coder_slab::alignment;
+
+            uint8_t *data = 0;
+            void *heap = 0;
+
+            if(coder_slab *slab = coder_slab::active())
+            {
+                data = static_cast<uint8_t*>(slab->allocate(size));
+            }
+
+            if(data == 0)
+            {
+                heap = ::operator new(size + coder_slab::alignment);
+
+                data = static_cast<uint8_t*>(heap);
+                data += coder_slab::alignment -
+                    (reinterpret_cast<std::uintptr_t>(data) %
+                     coder_slab::alignment);
+            }
+
+            // The header holds the heap memory, null for a slab
+            *reinterpret_cast<void**>(data) = heap;
+
+            return reinterpret_cast<T*>(data + coder_slab::alignment);
+        }
+
+        /// Releases memory, memory from a slab is freed with the slab
+        /// @param data The memory
+        /// @param n The number of elements
+        void deallocate(T *data, std::size_t n)
+        {
+            (void) n;
+
+            uint8_t *header =
+                reinterpret_cast<uint8_t*>(data) - coder_slab::alignment;
+
+            void *heap = *reinterpret_cast<void**>(header);
+
+            if(heap != 0)
+            {
+                ::operator delete(heap);
+            }
+        }
+
+        /// @return True, the allocators are stateless
+        template<class U>
+        bool operator==(const slab_allocator<U>&) const
+        {
+            return true;
+        }
+
+        /// @return False, the allocators are stateless
+        template<class U>
+        bool operator!=(const slab_allocator<U>&) const
+        {
+            return false;
+        }
+    };
+
+}
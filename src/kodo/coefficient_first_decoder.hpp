@@ -0,0 +1,214 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <utility>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Checks whether an encoded symbol is innovative by running
+    ///        the forward substitution on the coding coefficients only,
+    ///        before any work is done on the symbol data.
+    ///
+    /// The linear_block_decoder performs the forward substitution on the
+    /// coding coefficients and the symbol data at the same time. This
+    /// means that a non-innovative symbol costs up to rank() operations
+    /// on the full symbol before it is discarded. This layer records the
+    /// subtractions made on the coding coefficients, and only when a
+    /// pivot is found are the recorded operations replayed on the symbol
+    /// data. The reduced symbol is then passed on to the decoder below,
+    /// which will find the pivot without any further substitutions.
+    ///
+    /// The layer should be placed directly above a linear_block_decoder
+    /// or linear_block_decoder_delayed layer.
+    template<class SuperCoder>
+    class coefficient_first_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// Pull up the decode_symbol() functions
+        using SuperCoder::decode_symbol;
+
+    public:
+
+        /// Constructor
+        coefficient_first_decoder()
+            : m_skipped_operations(0),
+              m_non_innovative_symbols(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            // At most one substitution per symbol can be recorded
+            m_operations.reserve(the_factory.max_symbols());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_operations.clear();
+            m_skipped_operations = 0;
+            m_non_innovative_symbols = 0;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *symbol_coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_coefficients != 0);
+
+            value_type *symbol =
+                reinterpret_cast<value_type*>(symbol_data);
+
+            value_type *coefficients =
+                reinterpret_cast<value_type*>(symbol_coefficients);
+
+            if(!forward_substitute_coefficients(coefficients))
+            {
+                // The symbol was not innovative, the recorded
+                // operations never have to touch the symbol data
+                m_skipped_operations += m_operations.size();
+                ++m_non_innovative_symbols;
+                return;
+            }
+
+            replay_operations(symbol);
+
+            SuperCoder::decode_symbol(symbol_data, symbol_coefficients);
+        }
+
+        /// @return The number of operations on symbol data that were
+        ///         avoided because the symbol turned out to be
+        ///         non-innovative. Each operation corresponds to one
+        ///         subtract() or multiply_subtract() of symbol_length()
+        ///         elements.
+        uint32_t skipped_operations() const
+        {
+            return m_skipped_operations;
+        }
+
+        /// @return The number of non-innovative symbols detected
+        uint32_t non_innovative_symbols() const
+        {
+            return m_non_innovative_symbols;
+        }
+
+    protected:
+
+        /// Runs the forward substitution on the coding coefficients
+        /// until a pivot is found. Every substitution made is recorded
+        /// so that it can later be applied to the symbol data.
+        /// @param coefficients The coding coefficients of the symbol
+        /// @return true if a pivot was found i.e. the symbol is
+        ///         innovative
+        bool forward_substitute_coefficients(value_type *coefficients)
+        {
+            assert(coefficients != 0);
+
+            m_operations.clear();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                value_type current_coefficient
+                    = fifi::get_value<field_type>(coefficients, i);
+
+                if(!current_coefficient)
+                {
+                    continue;
+                }
+
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    // We found a pivot, the remaining substitutions
+                    // are identical to those the decoder below would
+                    // perform
+                    return true;
+                }
+
+                const value_type *vector_i =
+                    SuperCoder::coefficients_value(i);
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(
+                        coefficients, vector_i,
+                        SuperCoder::coefficients_length());
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        coefficients, vector_i, current_coefficient,
+                        SuperCoder::coefficients_length());
+                }
+
+                m_operations.push_back(
+                    std::make_pair(i, current_coefficient));
+            }
+
+            return false;
+        }
+
+        /// Applies the recorded substitutions to the symbol data
+        /// @param symbol The data of the encoded symbol
+        void replay_operations(value_type *symbol)
+        {
+            assert(symbol != 0);
+
+            for(const auto& operation : m_operations)
+            {
+                const value_type *symbol_i =
+                    SuperCoder::symbol_value(operation.first);
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(
+                        symbol, symbol_i, SuperCoder::symbol_length());
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        symbol, symbol_i, operation.second,
+                        SuperCoder::symbol_length());
+                }
+            }
+        }
+
+    protected:
+
+        /// The substitutions recorded for the current symbol, stored as
+        /// the pivot index and the coefficient used
+        std::vector<std::pair<uint32_t, value_type> > m_operations;
+
+        /// The number of symbol data operations skipped
+        uint32_t m_skipped_operations;
+
+        /// The number of non-innovative symbols seen
+        uint32_t m_non_innovative_symbols;
+    };
+
+}
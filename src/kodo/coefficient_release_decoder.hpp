@@ -0,0 +1,81 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Returns the coefficient vectors which are no longer
+    ///        needed to the pooled_coefficient_storage.
+    ///
+    /// The vector of an uncoded symbol, also when it replaces a coded
+    /// symbol, is released as soon as the symbol is stored, and all
+    /// vectors are released when the decoder is complete. Thereby a
+    /// decoder only holds the vectors of its coded symbols, e.g. about
+    /// the number of lost symbols with systematic encoding.
+    ///
+    /// The layer is placed above the codec layer, which must leave the
+    /// vectors of a complete decoder as unit vectors, as the
+    /// linear_block_decoder does.
+    template<class SuperCoder>
+    class coefficient_release_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *symbol_coefficients)
+        {
+            SuperCoder::decode_symbol(symbol_data, symbol_coefficients);
+            release_complete();
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*, uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(release_complete())
+            {
+                return;
+            }
+
+            if(SuperCoder::symbol_pivot(symbol_index) &&
+               !SuperCoder::symbol_coded(symbol_index))
+            {
+                SuperCoder::release_coefficients(symbol_index);
+            }
+        }
+
+    protected:
+
+        /// Releases all vectors if the decoder is complete
+        /// @return true if the decoder is complete
+        bool release_complete()
+        {
+            if(!SuperCoder::is_complete())
+            {
+                return false;
+            }
+
+            if(SuperCoder::coefficient_rows() > 0)
+            {
+                SuperCoder::release_all_coefficients();
+            }
+
+            return true;
+        }
+
+    };
+
+}
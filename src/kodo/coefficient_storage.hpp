@@ -6,17 +6,29 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <vector>
+
 #include <fifi/fifi_utils.hpp>
+#include <sak/aligned_allocator.hpp>
 #include <sak/storage.hpp>
 
+#include "snapshot.hpp"
+
 namespace kodo
 {
 
     /// @ingroup coefficient_storage_layers
     /// @brief Provides storage and access to the coding coefficients
     ///        used during encoding and decoding.
-    template<class SuperCoder>
-    class coefficient_storage : public SuperCoder
+    ///
+    /// The coefficient vectors are stored in a single aligned buffer,
+    /// with the distance between two vectors rounded up to a multiple of
+    /// the alignment. This keeps every vector aligned while the whole
+    /// matrix is available in one contiguous allocation, which is
+    /// allocated with the Allocator.
+    template<class Allocator, class SuperCoder>
+    class basic_coefficient_storage : public SuperCoder
     {
     public:
 
@@ -40,27 +52,32 @@ namespace kodo
         {
             SuperCoder::construct(the_factory);
 
-            m_coefficients_storage.resize(the_factory.max_symbols());
-            for(uint32_t i = 0; i < the_factory.max_symbols(); ++i)
-            {
-                m_coefficients_storage[i].resize(
-                    the_factory.max_coefficients_size());
-            }
+            uint32_t max_coefficients_size =
+                the_factory.max_coefficients_size();
 
+            m_stride = ((max_coefficients_size + alignment - 1)
+                        / alignment) * alignment;
+
+            assert(m_stride >= max_coefficients_size);
+
+            // Value initialized i.e. zero, an allocator may do so
+            // without touching the memory
+            m_coefficients_storage.resize(
+                the_factory.max_symbols() * m_stride);
         }
 
         /// @copydoc layer::coefficients(uint32_t)
         uint8_t* coefficients(uint32_t index)
         {
             assert(index < SuperCoder::symbols());
-            return &(m_coefficients_storage[index])[0];
+            return &m_coefficients_storage[index * m_stride];
         }
 
         /// @copydoc layer::coefficients(uint32_t) const
         const uint8_t* coefficients(uint32_t index) const
         {
             assert(index < SuperCoder::symbols());
-            return &(m_coefficients_storage[index])[0];
+            return &m_coefficients_storage[index * m_stride];
         }
 
         /// @copydoc layer::coefficients_value(uint32_t)
@@ -91,15 +108,75 @@ namespace kodo
             sak::copy_storage(dest, storage);
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() +
+                SuperCoder::symbols() * SuperCoder::coefficients_size();
+        }
+
+        /// Writes the coefficient vectors without the alignment padding
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            buffer = SuperCoder::write_snapshot(buffer);
+
+            uint32_t size = SuperCoder::coefficients_size();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                std::copy_n(coefficients(i), size, buffer);
+                buffer += size;
+            }
+
+            return buffer;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            uint32_t size = SuperCoder::coefficients_size();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                std::copy_n(buffer, size, coefficients(i));
+                buffer += size;
+            }
+
+            return buffer;
+        }
+
+    protected:
+
+        /// The alignment of the individual coefficient vectors, this is
+        /// needed when using SSE etc. instructions for fast computations
+        /// with the coefficients
+        static const uint32_t alignment = 16;
+
     private:
 
-        /// Stores the encoding vectors, we do a vector of vectors
-        /// to maximize chances of proper alignment of individual
-        /// coefficient vectors. This is needed when using SSE etc.
-        /// instructions for fast computations with the coefficients
-        std::vector< std::vector<uint8_t> > m_coefficients_storage;
+        /// The type of the aligned buffer
+        typedef std::vector<uint8_t, Allocator> aligned_vector;
 
-    };
-}
+        /// Stores all the encoding vectors
+        aligned_vector m_coefficients_storage;
 
+        /// The distance in bytes between two encoding vectors
+        uint32_t m_stride;
 
+    };
+
+    /// @ingroup coefficient_storage_layers
+    /// @brief The coefficient storage using an aligned heap allocation,
+    ///        see basic_coefficient_storage.
+    template<class SuperCoder>
+    class coefficient_storage : public basic_coefficient_storage<
+        sak::aligned_allocator<uint8_t>, SuperCoder>
+    { };
+}
@@ -0,0 +1,115 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "aligned_coefficients_buffer.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Base layer for the compact symbol id reader and writer
+    ///
+    /// The compact symbol id starts with a flag byte. A dense symbol id
+    /// is followed by the coding coefficients as written by the plain
+    /// symbol id. A sparse symbol id is followed by the number of
+    /// non-zero coefficients and a list of (index, value) entries, all
+    /// big endian. For the binary field the values are always one and
+    /// are omitted. The writer picks the smaller of the two per symbol.
+    template<class SuperCoder>
+    class compact_symbol_id
+        : public aligned_coefficients_buffer<SuperCoder>
+    {
+    public:
+
+        /// Type of SuperCoder with injected aligned_coefficient_buffer
+        typedef aligned_coefficients_buffer<SuperCoder> Super;
+
+        /// @copydoc layer::field_type
+        typedef typename Super::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// The type of the count and indices of a sparse symbol id
+        typedef uint16_t index_type;
+
+        /// The flag of a dense symbol id
+        static const uint8_t dense_flag = 0;
+
+        /// The flag of a sparse symbol id
+        static const uint8_t sparse_flag = 1;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size)
+            {
+                // The indices must fit the index type
+                assert(max_symbols <= 65536U);
+            }
+
+            /// @copydoc layer::factory::max_id_size() const
+            uint32_t max_id_size() const
+            {
+                return sizeof(uint8_t) +
+                    Super::factory::max_coefficients_size();
+            }
+        };
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            Super::initialize(the_factory);
+
+            m_id_size = sizeof(uint8_t) + Super::coefficients_size();
+        }
+
+        /// @copydoc layer::id_size()
+        uint32_t id_size() const
+        {
+            return m_id_size;
+        }
+
+        /// @return The size in bytes of an entry of a sparse symbol id
+        static uint32_t entry_size()
+        {
+            return fifi::is_binary<field_type>::value ?
+                sizeof(index_type) : sizeof(index_type) + sizeof(value_type);
+        }
+
+        /// @param nonzeros The number of non-zero coefficients
+        /// @return The size in bytes of a sparse symbol id
+        static uint32_t sparse_id_size(uint32_t nonzeros)
+        {
+            return sizeof(uint8_t) + sizeof(index_type) +
+                nonzeros * entry_size();
+        }
+
+    protected:
+
+        /// The size in bytes of a dense symbol id
+        uint32_t m_id_size;
+
+    };
+
+}
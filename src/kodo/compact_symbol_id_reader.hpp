@@ -0,0 +1,106 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <sak/convert_endian.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "compact_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Reads a dense or sparse symbol id written by the
+    ///        compact_symbol_id_writer and expands the coding
+    ///        coefficients into the aligned coefficients buffer, which
+    ///        the symbol coefficients pointer refers to.
+    template<class SuperCoder>
+    class base_compact_symbol_id_reader : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// @copydoc compact_symbol_id::index_type
+        typedef typename SuperCoder::index_type index_type;
+
+    public:
+
+        /// @copydoc layer::read_id(uint8_t*,uint8_t**)
+        void read_id(uint8_t *symbol_id, uint8_t **symbol_coefficients)
+        {
+            assert(symbol_id != 0);
+            assert(symbol_coefficients != 0);
+
+            uint32_t coefficients_size = SuperCoder::coefficients_size();
+
+            *symbol_coefficients = &m_coefficients[0];
+
+            if(symbol_id[0] == SuperCoder::dense_flag)
+            {
+                std::copy_n(symbol_id + 1, coefficients_size,
+                            m_coefficients.begin());
+                return;
+            }
+
+            assert(symbol_id[0] == SuperCoder::sparse_flag);
+
+            std::fill_n(m_coefficients.begin(), coefficients_size, 0);
+
+            const uint8_t *entry = symbol_id + 1;
+
+            uint32_t nonzeros = sak::big_endian::get<index_type>(entry);
+            entry += sizeof(index_type);
+
+            assert(nonzeros <= SuperCoder::symbols());
+
+            for(uint32_t i = 0; i < nonzeros; ++i)
+            {
+                uint32_t index = sak::big_endian::get<index_type>(entry);
+                entry += sizeof(index_type);
+
+                assert(index < SuperCoder::symbols());
+
+                value_type value = 1;
+
+                if(!fifi::is_binary<field_type>::value)
+                {
+                    value = sak::big_endian::get<value_type>(entry);
+                    entry += sizeof(value_type);
+                }
+
+                fifi::set_value<field_type>(
+                    reinterpret_cast<value_type*>(&m_coefficients[0]),
+                    index, value);
+            }
+        }
+
+    protected:
+
+        /// The aligned coefficients buffer
+        using SuperCoder::m_coefficients;
+
+    };
+
+    /// @copydoc base_compact_symbol_id_reader
+    template<class SuperCoder>
+    class compact_symbol_id_reader
+        : public base_compact_symbol_id_reader<
+                 compact_symbol_id<SuperCoder> >
+    { };
+
+}
@@ -0,0 +1,120 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <sak/convert_endian.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "compact_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Writes the coding coefficients as a dense vector or as a
+    ///        list of the non-zero coefficients, whichever is smaller.
+    ///
+    /// The coefficients are generated into the aligned coefficients
+    /// buffer, which the coefficients pointer refers to.
+    template<class SuperCoder>
+    class base_compact_symbol_id_writer : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// @copydoc compact_symbol_id::index_type
+        typedef typename SuperCoder::index_type index_type;
+
+    public:
+
+        /// @copydoc layer::write_id(uint8_t*, uint8_t**)
+        uint32_t write_id(uint8_t *symbol_id, uint8_t **coefficients)
+        {
+            assert(symbol_id != 0);
+            assert(coefficients != 0);
+
+            SuperCoder::generate(&m_coefficients[0]);
+            *coefficients = &m_coefficients[0];
+
+            const value_type *c =
+                reinterpret_cast<const value_type*>(&m_coefficients[0]);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            uint32_t nonzeros = 0;
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(fifi::get_value<field_type>(c, i))
+                    ++nonzeros;
+            }
+
+            uint32_t sparse_size = SuperCoder::sparse_id_size(nonzeros);
+
+            if(sparse_size >= SuperCoder::id_size())
+            {
+                symbol_id[0] = SuperCoder::dense_flag;
+
+                std::copy_n(m_coefficients.begin(),
+                            SuperCoder::coefficients_size(), symbol_id + 1);
+
+                return SuperCoder::id_size();
+            }
+
+            symbol_id[0] = SuperCoder::sparse_flag;
+
+            uint8_t *entry = symbol_id + 1;
+
+            sak::big_endian::put<index_type>(nonzeros, entry);
+            entry += sizeof(index_type);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                value_type value =
+                    fifi::get_value<field_type>(c, i);
+
+                if(!value)
+                    continue;
+
+                sak::big_endian::put<index_type>(i, entry);
+                entry += sizeof(index_type);
+
+                if(!fifi::is_binary<field_type>::value)
+                {
+                    sak::big_endian::put<value_type>(value, entry);
+                    entry += sizeof(value_type);
+                }
+            }
+
+            assert(uint32_t(entry - symbol_id) == sparse_size);
+            return sparse_size;
+        }
+
+    protected:
+
+        /// The aligned coefficients buffer
+        using SuperCoder::m_coefficients;
+
+    };
+
+    /// @copydoc base_compact_symbol_id_writer
+    template<class SuperCoder>
+    class compact_symbol_id_writer
+        : public base_compact_symbol_id_writer<
+                 compact_symbol_id<SuperCoder> >
+    { };
+
+}
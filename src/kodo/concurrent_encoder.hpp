@@ -0,0 +1,137 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// @brief Encodes one block on several threads without locks.
+    ///
+    /// The block is shared read-only by one encoding context per
+    /// thread. A context is an encoder with the shared_symbol_storage,
+    /// so it only holds the symbol pointers, and the
+    /// concurrent_systematic_encoder, so the contexts claim the
+    /// systematic symbols from an atomic index and every systematic
+    /// symbol is sent once. Every context has its own generator seeded
+    /// with a distinct seed, so the coded symbols of the contexts are
+    /// independent. Thread i only calls the functions of context(i),
+    /// e.g. encode() and encode_in_place().
+    ///
+    /// The contexts are built and released with the concurrent_encoder
+    /// on the thread owning the factory, since the factory pool is not
+    /// thread-safe. The EncoderType must be e.g. the
+    /// concurrent_full_rlnc_encoder.
+    template<class EncoderType>
+    class concurrent_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build encoders
+        typedef typename EncoderType::factory factory;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer;
+
+        /// The block shared by the contexts
+        typedef typename EncoderType::block_type block_type;
+
+        /// Pointer to the shared block
+        typedef typename EncoderType::block_pointer block_pointer;
+
+        /// The shared systematic index
+        typedef typename EncoderType::index_type index_type;
+
+        /// Pointer to the shared systematic index
+        typedef typename EncoderType::index_pointer index_pointer;
+
+        /// The seed type of the generators
+        typedef typename EncoderType::seed_type seed_type;
+
+    public:
+
+        /// Constructs a new concurrent encoder and builds the contexts
+        /// @param encoder_factory The factory, set to the size of the
+        ///        block
+        /// @param block The block to encode
+        /// @param contexts The number of contexts, e.g. threads
+        /// @param seed The seed of the generator of the first context,
+        ///        the following contexts use the following seeds
+        concurrent_encoder(factory &encoder_factory,
+                           const block_pointer &block,
+                           uint32_t contexts, seed_type seed = 0)
+            : m_block(block),
+              m_index(boost::make_shared<index_type>(0))
+        {
+            assert(m_block);
+            assert(contexts > 0);
+
+            m_contexts.resize(contexts);
+
+            for(uint32_t i = 0; i < contexts; ++i)
+            {
+                pointer &context = m_contexts[i];
+
+                context = encoder_factory.build();
+                context->set_shared_symbols(m_block);
+                context->set_systematic_index(m_index);
+                context->seed(seed + i);
+            }
+        }
+
+        /// @return The number of contexts
+        uint32_t contexts() const
+        {
+            return static_cast<uint32_t>(m_contexts.size());
+        }
+
+        /// @param index The context
+        /// @return The encoder of a context, which may only be used by
+        ///         one thread at a time
+        const pointer& context(uint32_t index) const
+        {
+            assert(index < m_contexts.size());
+            return m_contexts[index];
+        }
+
+        /// @return The number of systematic symbols claimed by the
+        ///         contexts, at most the number of symbols
+        uint32_t systematic_count() const
+        {
+            return m_index->load();
+        }
+
+        /// Restarts the systematic symbols, no context may be encoding
+        void reset_systematic()
+        {
+            m_index->store(0);
+        }
+
+        /// @return The shared block
+        const block_pointer& block() const
+        {
+            return m_block;
+        }
+
+    private:
+
+        /// The shared block
+        block_pointer m_block;
+
+        /// The systematic index shared by the contexts
+        index_pointer m_index;
+
+        /// The encoders of the contexts
+        std::vector<pointer> m_contexts;
+    };
+
+}
@@ -0,0 +1,277 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <memory>
+
+#include <sak/storage.hpp>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Publishes the decoded symbols so other threads may read
+    ///        them without a lock while the decoding continues.
+    ///
+    /// With the Gauss-Jordan elimination of the linear_block_decoder a
+    /// decoded symbol, whose coefficient vector is the unit vector, is
+    /// never changed by the later symbols: the backward substitution
+    /// only changes the rows with a non-zero coefficient for the new
+    /// pivot. The only exception is a systematic symbol received for a
+    /// pivot holding a coded symbol, which the swap_decode() writes over
+    /// the stored symbol, so this layer drops the systematic symbols of
+    /// published symbols. The published symbols are thereby immutable
+    /// until the decoder is initialized again.
+    ///
+    /// After each decoded symbol the new decoded symbols are marked in
+    /// a bitmap with a release store, so a reader which sees the mark
+    /// with is_symbol_ready() also sees the data of the symbol. Only the
+    /// functions documented as thread safe may be called while the
+    /// decoding thread uses the decoder, and the readers must be done
+    /// before the decoder is initialized again, e.g. recycled by the
+    /// factory.
+    ///
+    /// The layer must be placed above the codec layer and requires the
+    /// coefficient storage API.
+    template<class SuperCoder>
+    class concurrent_read_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The word type of the bitmap of published symbols
+        typedef uint32_t word_type;
+
+        /// The number of symbols per word of the bitmap
+        static const uint32_t word_bits = 32;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_words = (the_factory.max_symbols() + word_bits - 1) /
+                word_bits;
+
+            m_ready.reset(new std::atomic<word_type>[m_words]);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            for(uint32_t i = 0; i < m_words; ++i)
+            {
+                m_ready[i].store(0, std::memory_order_relaxed);
+            }
+
+            m_symbols_ready.store(0, std::memory_order_release);
+        }
+
+        /// Publishes the symbols decoded by the new symbol
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *coefficients)
+        {
+            uint32_t rank = SuperCoder::rank();
+
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+
+            if(rank < SuperCoder::rank())
+            {
+                publish_decoded();
+            }
+        }
+
+        /// Drops the symbol if it is already published, otherwise
+        /// publishes the symbols decoded by it
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            if(is_published(symbol_index, std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            uint32_t rank = SuperCoder::rank();
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(rank < SuperCoder::rank())
+            {
+                publish_decoded();
+            }
+        }
+
+        /// Thread safe.
+        /// @param index The index of a symbol
+        /// @return True if the symbol is decoded, its data may then be
+        ///         read with ready_symbol() at any time until the
+        ///         decoder is initialized again
+        bool is_symbol_ready(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return is_published(index, std::memory_order_acquire);
+        }
+
+        /// Thread safe.
+        /// @param index The index of a symbol
+        /// @return The data of the symbol if it is decoded, otherwise
+        ///         zero
+        const uint8_t* ready_symbol(uint32_t index) const
+        {
+            if(!is_symbol_ready(index))
+            {
+                return 0;
+            }
+
+            return SuperCoder::symbol(index);
+        }
+
+        /// Thread safe. Copies a decoded symbol.
+        /// @param index The index of a symbol
+        /// @param dest The destination buffer, at least
+        ///        layer::symbol_size() bytes
+        /// @return True if the symbol is decoded and was copied
+        bool copy_ready_symbol(uint32_t index,
+                               const sak::mutable_storage &dest) const
+        {
+            const uint8_t *symbol = ready_symbol(index);
+
+            if(symbol == 0)
+            {
+                return false;
+            }
+
+            assert(dest.m_size >= SuperCoder::symbol_size());
+
+            sak::copy_storage(
+                dest, sak::storage(symbol, SuperCoder::symbol_size()));
+
+            return true;
+        }
+
+        /// Thread safe.
+        /// @return The number of decoded symbols published
+        uint32_t symbols_ready() const
+        {
+            return m_symbols_ready.load(std::memory_order_acquire);
+        }
+
+    protected:
+
+        /// @param index The index of a symbol
+        /// @param order The memory order of the load
+        /// @return True if the symbol is published
+        bool is_published(uint32_t index, std::memory_order order) const
+        {
+            word_type word = m_ready[index / word_bits].load(order);
+            return (word >> (index % word_bits)) & 1;
+        }
+
+        /// Publishes the decoded symbols not published yet. The bitmap
+        /// is only written by the decoding thread, so the load of the
+        /// word needs no ordering.
+        void publish_decoded()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t published = 0;
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(is_published(i, std::memory_order_relaxed) ||
+                   !is_unit_vector(i))
+                {
+                    continue;
+                }
+
+                std::atomic<word_type> &word = m_ready[i / word_bits];
+
+                word.store(
+                    word.load(std::memory_order_relaxed) |
+                    (word_type(1) << (i % word_bits)),
+                    std::memory_order_release);
+
+                ++published;
+            }
+
+            if(published > 0)
+            {
+                m_symbols_ready.store(
+                    m_symbols_ready.load(std::memory_order_relaxed) +
+                    published, std::memory_order_release);
+            }
+        }
+
+        /// @param index The pivot index
+        /// @return true if the symbol at the pivot index is decoded
+        bool is_unit_vector(uint32_t index) const
+        {
+            if(!SuperCoder::symbol_pivot(index))
+            {
+                return false;
+            }
+
+            if(!SuperCoder::symbol_coded(index))
+            {
+                return true;
+            }
+
+            // The elimination keeps the pivot columns of the other rows
+            // zero, so only the non-pivot columns needs to be checked
+            const value_type *coefficients =
+                SuperCoder::coefficients_value(index);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t j = 0; j < symbols; ++j)
+            {
+                if(j == index || SuperCoder::symbol_pivot(j))
+                {
+                    continue;
+                }
+
+                if(fifi::get_value<field_type>(coefficients, j))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    protected:
+
+        /// The number of words of the bitmap
+        uint32_t m_words;
+
+        /// The bitmap of the published symbols
+        std::unique_ptr<std::atomic<word_type>[]> m_ready;
+
+        /// The number of published symbols
+        std::atomic<uint32_t> m_symbols_ready;
+
+    };
+
+}
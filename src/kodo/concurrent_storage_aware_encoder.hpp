@@ -0,0 +1,93 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief The storage_aware_encoder for an encoder whose symbols are
+    ///        set by a producer thread while another thread encodes.
+    ///
+    /// The producer sets the symbols in order, i.e. calls
+    /// layer::set_symbol(uint32_t, const sak::const_storage&) with the
+    /// index rank(), and the encoding thread only encodes. Once a symbol
+    /// is copied to the storage the rank is published with a release
+    /// store, and layer::rank() and layer::symbol_pivot() load it with
+    /// an acquire load. The encoding thread therefore only uses symbols
+    /// whose data it sees completely, without a lock. It may see the
+    /// rank grow between two calls, e.g. between the generation of the
+    /// coefficients and the encoding, which is fine since a symbol once
+    /// set is never changed.
+    ///
+    /// The zeroing of the storage delayed by the deep_symbol_storage is
+    /// done in initialize(), so neither thread writes the storage state
+    /// afterwards. The encoder must be built, and initialized, before the
+    /// two threads use it.
+    template<class SuperCoder>
+    class concurrent_storage_aware_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            // Zeroes the storage now on the building thread
+            SuperCoder::symbol(0);
+
+            m_rank.store(0, std::memory_order_release);
+        }
+
+        /// @copydoc layer::set_symbol(uint32_t, const sak::const_storage&)
+        void set_symbol(uint32_t index, const sak::const_storage &symbol)
+        {
+            // Only the producer changes the rank
+            uint32_t rank = m_rank.load(std::memory_order_relaxed);
+
+            // The symbols must be set in order
+            assert(index == rank);
+
+            SuperCoder::set_symbol(index, symbol);
+            m_rank.store(rank + 1, std::memory_order_release);
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            SuperCoder::set_symbols(symbol_storage);
+            m_rank.store(SuperCoder::symbols(), std::memory_order_release);
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_rank.load(std::memory_order_acquire);
+        }
+
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return index < rank();
+        }
+
+    private:
+
+        /// The number of symbols set, the symbols 0 to rank - 1
+        std::atomic<uint32_t> m_rank;
+
+    };
+
+}
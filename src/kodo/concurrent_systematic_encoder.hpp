@@ -0,0 +1,218 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+
+#include <boost/shared_ptr.hpp>
+
+#include "systematic_encoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_header_layers
+    /// @brief Systematic encoding layer where several encoders of the
+    ///        same block share the systematic symbols.
+    ///
+    /// When several threads encode the same block, each with its own
+    /// encoder, every systematic symbol should still be sent once. The
+    /// encoders sharing a systematic index, set with
+    /// set_systematic_index(), claim the next systematic symbol with an
+    /// atomic increment of the index, so no lock is needed. Once all
+    /// systematic symbols are claimed the encoders produce coded
+    /// symbols. Without a shared index the layer behaves as the
+    /// systematic_encoder. The shared index is cleared when the encoder
+    /// is initialized.
+    template<class SuperCoder>
+    class concurrent_systematic_encoder
+        : public base_systematic_encoder<true, SuperCoder>
+    {
+    public:
+
+        /// The actual SuperCoder type
+        typedef base_systematic_encoder<true, SuperCoder> Super;
+
+        /// The index of the next systematic symbol shared by encoders
+        typedef std::atomic<uint32_t> index_type;
+
+        /// Pointer to a shared systematic index
+        typedef boost::shared_ptr<index_type> index_pointer;
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            Super::initialize(the_factory);
+            m_shared_index.reset();
+        }
+
+        /// @copydoc layer::encode(uint8_t*, uint8_t*)
+        uint32_t encode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            if(claim_systematic_symbol())
+            {
+                return Super::encode_systematic(symbol_data, symbol_header);
+            }
+            else
+            {
+                return Super::encode_non_systematic(symbol_data,
+                                                    symbol_header);
+            }
+        }
+
+        /// @copydoc payload_encoder::encode_in_place(
+        ///     uint8_t*,uint8_t*,const uint8_t**)
+        uint32_t encode_in_place(uint8_t *symbol_data,
+                                 uint8_t *symbol_header,
+                                 const uint8_t **symbol_reference)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+            assert(symbol_reference != 0);
+
+            if(claim_systematic_symbol())
+            {
+                uint32_t header_bytes =
+                    Super::write_systematic_header(symbol_header);
+
+                *symbol_reference = SuperCoder::encode_symbol_in_place(
+                    Super::m_systematic_count);
+
+                ++Super::m_systematic_count;
+
+                return header_bytes;
+            }
+            else
+            {
+                *symbol_reference = symbol_data;
+
+                return Super::encode_non_systematic(symbol_data,
+                                                    symbol_header);
+            }
+        }
+
+        /// Shares the systematic symbols with the other encoders using
+        /// the same index, the index is the next systematic symbol
+        /// @param index The shared index
+        void set_systematic_index(const index_pointer &index)
+        {
+            assert(index);
+            m_shared_index = index;
+        }
+
+        /// @return The shared systematic index, or an empty pointer
+        const index_pointer& systematic_index() const
+        {
+            return m_shared_index;
+        }
+
+    protected:
+
+        /// Selects the systematic symbol of the next encoded symbol
+        /// @return True if a systematic symbol should be encoded, its
+        ///         index is then stored in the systematic count
+        bool claim_systematic_symbol()
+        {
+            if(!Super::m_systematic)
+            {
+                return false;
+            }
+
+            if(!m_shared_index)
+            {
+                return Super::m_systematic_count < SuperCoder::rank();
+            }
+
+            // Stop incrementing once all symbols are claimed, so the
+            // index cannot wrap around
+            uint32_t index = m_shared_index->load(std::memory_order_relaxed);
+
+            while(index < SuperCoder::rank())
+            {
+                if(m_shared_index->compare_exchange_weak(
+                       index, index + 1, std::memory_order_relaxed))
+                {
+                    Super::m_systematic_count = index;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    protected:
+
+        /// The systematic index shared with other encoders
+        index_pointer m_shared_index;
+
+    };
+
+    /// Overload for the generic is_systematic_encoder_dispatch(...) function
+    ///
+    /// \ingroup g_systematic_coding
+    /// \ingroup g_generic_api
+    ///
+    /// @param e the encoder
+    /// @return true since this is an systematic encoder
+    template<class SuperCoder>
+    inline bool is_systematic_encoder_dispatch(
+        const concurrent_systematic_encoder<SuperCoder> *)
+    {
+        return true;
+    }
+
+    /// Overload for the generic is_systematic_on_dispatch(...) function
+    ///
+    /// \ingroup g_systematic_coding
+    /// \ingroup g_generic_api
+    ///
+    /// @param e the encoder
+    /// @return true if the encoder currently produces systematic symbols
+    template<class SuperCoder>
+    inline bool is_systematic_on_dispatch(
+        concurrent_systematic_encoder<SuperCoder> *e)
+    {
+        assert(e != 0);
+        return e->is_systematic_on();
+    }
+
+    /// Overload for the generic set_systematic_off_dispatch(...) function
+    ///
+    /// \ingroup g_systematic_coding
+    /// \ingroup g_generic_api
+    ///
+    /// @param e the encoder
+    template<class SuperCoder>
+    inline void set_systematic_off_dispatch(
+        concurrent_systematic_encoder<SuperCoder> *e)
+    {
+        assert(e != 0);
+        e->set_systematic_off();
+    }
+
+    /// Overload for the generic set_systematic_on_dispatch(...) function
+    ///
+    /// \ingroup g_systematic_coding
+    /// \ingroup g_generic_api
+    ///
+    /// @param e the encoder
+    template<class SuperCoder>
+    inline void set_systematic_on_dispatch(
+        concurrent_systematic_encoder<SuperCoder> *e)
+    {
+        assert(e != 0);
+        e->set_systematic_on();
+    }
+
+}
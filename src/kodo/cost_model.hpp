@@ -0,0 +1,463 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/storage.hpp>
+
+#include "cycle_counter.hpp"
+#include "operations_profile.hpp"
+#include "systematic_operations.hpp"
+
+namespace kodo
+{
+
+    /// The estimated cost of a coder per delivered byte
+    struct cost_estimate
+    {
+
+        /// Constructs a zero cost
+        cost_estimate()
+            : m_nanoseconds(0),
+              m_memory_bytes(0)
+            { }
+
+        /// The CPU time in nanoseconds
+        double m_nanoseconds;
+
+        /// The bytes read and written by the finite field operations
+        double m_memory_bytes;
+
+    };
+
+    /// @brief Estimates the cost of a coder stack from the number of
+    ///        symbols and the symbol size.
+    ///
+    /// The model is calibrated with operations_profile samples recorded
+    /// by the finite_field_counter layer while coding a generation, as
+    /// in the count_operations benchmark. For a generation of k symbols
+    /// of s bytes
+    ///
+    ///   - the bytes of symbol data processed per delivered byte grow
+    ///     linearly, a0 + a1 * k, as each symbol is combined with up to
+    ///     k others,
+    ///   - the bytes of coefficient vectors processed per symbol grow
+    ///     with b0 * k + b1 * k^2, i.e. per delivered byte they are
+    ///     divided by s.
+    ///
+    /// The parameters are fitted by least squares over the samples,
+    /// which should cover at least two generation sizes. The CPU time is
+    /// the processed bytes times the nanoseconds per byte of the symbol
+    /// and the coefficient operations, which are taken from the sampled
+    /// timings of the profiles or set from measurements elsewhere. The
+    /// memory traffic counts the destination and source of each
+    /// operation read and the destination written.
+    class cost_model
+    {
+    public:
+
+        /// Constructor
+        cost_model()
+            : m_ticks_per_ns(1.0),
+              m_symbol_ns_per_byte(0),
+              m_coefficient_ns_per_byte(0),
+              m_symbol_traffic(0),
+              m_symbol_bytes(0),
+              m_coefficient_traffic(0),
+              m_coefficient_bytes(0),
+              m_symbol_ticks(0),
+              m_symbol_timed_bytes(0),
+              m_coefficient_ticks(0),
+              m_coefficient_timed_bytes(0)
+        {
+            m_symbol_fit[0] = m_symbol_fit[1] = 0;
+            m_coefficient_fit[0] = m_coefficient_fit[1] = 0;
+        }
+
+        /// Sets the rate of the cycle counter used for the sampled
+        /// timings, see cycle_counter_ticks_per_ns()
+        /// @param ticks_per_ns The counter ticks per nanosecond
+        void set_ticks_per_ns(double ticks_per_ns)
+        {
+            assert(ticks_per_ns > 0);
+            m_ticks_per_ns = ticks_per_ns;
+        }
+
+        /// Adds the profile of coding a number of generations
+        /// @param symbols The number of symbols
+        /// @param symbol_size The symbol size
+        /// @param profile The operations recorded while coding
+        /// @param generations The number of generations coded
+        void add_sample(uint32_t symbols, uint32_t symbol_size,
+                        const operations_profile &profile,
+                        uint32_t generations = 1)
+        {
+            assert(symbols > 0);
+            assert(symbol_size > 0);
+            assert(generations > 0);
+
+            double delivered =
+                double(generations) * symbols * symbol_size;
+
+            const operation_profile *operations[] =
+                { &profile.m_multiply, &profile.m_multiply_add,
+                  &profile.m_add, &profile.m_multiply_subtract,
+                  &profile.m_subtract };
+
+            double symbol_bytes = 0;
+            double coefficient_bytes = 0;
+
+            for(const operation_profile *operation : operations)
+            {
+                // The multiply only reads and writes the destination
+                double traffic = operation == &profile.m_multiply ? 2 : 3;
+
+                add_cost(operation->m_symbol, traffic, m_symbol_traffic,
+                         m_symbol_ticks, m_symbol_timed_bytes);
+
+                add_cost(operation->m_coefficient, traffic,
+                         m_coefficient_traffic, m_coefficient_ticks,
+                         m_coefficient_timed_bytes);
+
+                symbol_bytes += operation->m_symbol.m_bytes;
+                coefficient_bytes += operation->m_coefficient.m_bytes;
+            }
+
+            m_symbol_bytes += symbol_bytes;
+            m_coefficient_bytes += coefficient_bytes;
+
+            sample s;
+            s.m_symbols = symbols;
+            s.m_symbol_bytes = symbol_bytes / delivered;
+            s.m_coefficient_bytes =
+                coefficient_bytes / (double(generations) * symbols);
+
+            m_samples.push_back(s);
+
+            fit();
+        }
+
+        /// Sets the nanoseconds per byte of the operations, replacing the
+        /// rates of the sampled timings until the next sample is added
+        /// @param symbol_ns_per_byte The rate of the operations on the
+        ///        symbol data
+        /// @param coefficient_ns_per_byte The rate of the operations on
+        ///        the coefficient vectors
+        void set_rates(double symbol_ns_per_byte,
+                       double coefficient_ns_per_byte)
+        {
+            assert(symbol_ns_per_byte >= 0);
+            assert(coefficient_ns_per_byte >= 0);
+
+            m_symbol_ns_per_byte = symbol_ns_per_byte;
+            m_coefficient_ns_per_byte = coefficient_ns_per_byte;
+        }
+
+        /// @return The nanoseconds per byte of the operations on the
+        ///         symbol data
+        double symbol_ns_per_byte() const
+        {
+            return m_symbol_ns_per_byte;
+        }
+
+        /// @return The nanoseconds per byte of the operations on the
+        ///         coefficient vectors
+        double coefficient_ns_per_byte() const
+        {
+            return m_coefficient_ns_per_byte;
+        }
+
+        /// @param symbols The number of symbols
+        /// @param symbol_size The symbol size
+        /// @return The bytes of symbol data processed per delivered byte
+        double symbol_bytes(uint32_t symbols, uint32_t symbol_size) const
+        {
+            (void) symbol_size;
+            return std::max(
+                0.0, m_symbol_fit[0] + m_symbol_fit[1] * symbols);
+        }
+
+        /// @param symbols The number of symbols
+        /// @param symbol_size The symbol size
+        /// @return The bytes of coefficient vectors processed per
+        ///         delivered byte
+        double coefficient_bytes(uint32_t symbols,
+                                 uint32_t symbol_size) const
+        {
+            assert(symbol_size > 0);
+
+            double per_symbol = m_coefficient_fit[0] * symbols +
+                m_coefficient_fit[1] * double(symbols) * symbols;
+
+            return std::max(0.0, per_symbol / symbol_size);
+        }
+
+        /// @param symbols The number of symbols
+        /// @param symbol_size The symbol size
+        /// @return The estimated cost per delivered byte
+        cost_estimate estimate(uint32_t symbols, uint32_t symbol_size) const
+        {
+            assert(symbols > 0);
+            assert(symbol_size > 0);
+
+            double symbol = symbol_bytes(symbols, symbol_size);
+            double coefficient = coefficient_bytes(symbols, symbol_size);
+
+            cost_estimate cost;
+            cost.m_nanoseconds = symbol * m_symbol_ns_per_byte +
+                coefficient * m_coefficient_ns_per_byte;
+
+            cost.m_memory_bytes =
+                symbol * traffic_ratio(m_symbol_traffic, m_symbol_bytes) +
+                coefficient * traffic_ratio(m_coefficient_traffic,
+                                            m_coefficient_bytes);
+
+            return cost;
+        }
+
+        /// Finds the largest generation within a CPU budget
+        /// @param symbol_size The symbol size
+        /// @param max_ns_per_byte The budget per delivered byte
+        /// @param max_symbols The largest number of symbols considered
+        /// @return The largest number of symbols within the budget, or
+        ///         zero if even a single symbol exceeds it
+        uint32_t max_symbols(uint32_t symbol_size, double max_ns_per_byte,
+                             uint32_t max_symbols) const
+        {
+            uint32_t symbols = 0;
+
+            for(uint32_t k = 1; k <= max_symbols; ++k)
+            {
+                if(estimate(k, symbol_size).m_nanoseconds <= max_ns_per_byte)
+                {
+                    symbols = k;
+                }
+            }
+
+            return symbols;
+        }
+
+    private:
+
+        /// A calibration sample
+        struct sample
+        {
+            /// The number of symbols
+            uint32_t m_symbols;
+
+            /// The symbol data processed per delivered byte
+            double m_symbol_bytes;
+
+            /// The coefficient bytes processed per delivered symbol
+            double m_coefficient_bytes;
+        };
+
+        /// Accumulates the traffic and the timing of an operation
+        void add_cost(const operation_cost &cost, double traffic,
+                      double &total_traffic, double &ticks,
+                      double &timed_bytes)
+        {
+            total_traffic += traffic * cost.m_bytes;
+
+            if(cost.m_samples > 0)
+            {
+                ticks += cost.estimated_ticks();
+                timed_bytes += cost.m_bytes;
+            }
+        }
+
+        /// @return The bytes of memory traffic per processed byte
+        static double traffic_ratio(double traffic, double bytes)
+        {
+            return bytes > 0 ? traffic / bytes : 3.0;
+        }
+
+        /// Fits y = p[0] * x0 + p[1] * x1 by least squares, with only
+        /// p[1] if the samples do not tell the terms apart
+        template<class X0, class X1, class Y>
+        void least_squares(double *p, const X0 &x0, const X1 &x1,
+                           const Y &y) const
+        {
+            double s00 = 0, s01 = 0, s11 = 0, s0y = 0, s1y = 0;
+
+            for(const sample &s : m_samples)
+            {
+                double a = x0(s), b = x1(s), v = y(s);
+                s00 += a * a;
+                s01 += a * b;
+                s11 += b * b;
+                s0y += a * v;
+                s1y += b * v;
+            }
+
+            double det = s00 * s11 - s01 * s01;
+
+            if(det > 1e-9 * s00 * s11)
+            {
+                p[0] = (s0y * s11 - s1y * s01) / det;
+                p[1] = (s1y * s00 - s0y * s01) / det;
+            }
+            else
+            {
+                p[0] = 0;
+                p[1] = s11 > 0 ? s1y / s11 : 0;
+            }
+        }
+
+        /// Fits the model to the samples and updates the rates
+        void fit()
+        {
+            least_squares(m_symbol_fit,
+                [](const sample &) { return 1.0; },
+                [](const sample &s) { return double(s.m_symbols); },
+                [](const sample &s) { return s.m_symbol_bytes; });
+
+            least_squares(m_coefficient_fit,
+                [](const sample &s) { return double(s.m_symbols); },
+                [](const sample &s)
+                    { return double(s.m_symbols) * s.m_symbols; },
+                [](const sample &s) { return s.m_coefficient_bytes; });
+
+            if(m_symbol_timed_bytes > 0)
+            {
+                m_symbol_ns_per_byte =
+                    m_symbol_ticks / m_ticks_per_ns / m_symbol_timed_bytes;
+            }
+
+            if(m_coefficient_timed_bytes > 0)
+            {
+                m_coefficient_ns_per_byte = m_coefficient_ticks /
+                    m_ticks_per_ns / m_coefficient_timed_bytes;
+            }
+        }
+
+    private:
+
+        /// The calibration samples
+        std::vector<sample> m_samples;
+
+        /// The rate of the cycle counter
+        double m_ticks_per_ns;
+
+        /// The parameters a0 and a1 of the symbol data processed
+        double m_symbol_fit[2];
+
+        /// The parameters b0 and b1 of the coefficients processed
+        double m_coefficient_fit[2];
+
+        /// The nanoseconds per byte of the symbol operations
+        double m_symbol_ns_per_byte;
+
+        /// The nanoseconds per byte of the coefficient operations
+        double m_coefficient_ns_per_byte;
+
+        /// The memory traffic of the symbol operations
+        double m_symbol_traffic;
+
+        /// The bytes processed by the symbol operations
+        double m_symbol_bytes;
+
+        /// The memory traffic of the coefficient operations
+        double m_coefficient_traffic;
+
+        /// The bytes processed by the coefficient operations
+        double m_coefficient_bytes;
+
+        /// The estimated ticks of the timed symbol operations
+        double m_symbol_ticks;
+
+        /// The bytes of the timed symbol operations
+        double m_symbol_timed_bytes;
+
+        /// The estimated ticks of the timed coefficient operations
+        double m_coefficient_ticks;
+
+        /// The bytes of the timed coefficient operations
+        double m_coefficient_timed_bytes;
+
+    };
+
+    /// Calibrates the cost models of an encoder and a decoder stack by
+    /// coding one generation per generation size with systematic
+    /// coding off. Both stacks must contain the finite_field_counter
+    /// layer.
+    /// @param encoder_model The model of the encoder
+    /// @param decoder_model The model of the decoder
+    /// @param symbols The generation sizes to sample
+    /// @param symbol_size The symbol size
+    /// @param timing_sample_interval Every n'th operation is timed, see
+    ///        finite_field_counter::set_timing_sample_interval(uint32_t)
+    template<class Encoder, class Decoder>
+    inline void calibrate_cost_models(cost_model &encoder_model,
+                                      cost_model &decoder_model,
+                                      const std::vector<uint32_t> &symbols,
+                                      uint32_t symbol_size,
+                                      uint32_t timing_sample_interval = 16)
+    {
+        assert(!symbols.empty());
+
+        uint32_t max_symbols = 0;
+        for(uint32_t k : symbols)
+        {
+            max_symbols = std::max(max_symbols, k);
+        }
+
+        typename Encoder::factory encoder_factory(max_symbols, symbol_size);
+        typename Decoder::factory decoder_factory(max_symbols, symbol_size);
+
+        double ticks_per_ns = cycle_counter_ticks_per_ns();
+        encoder_model.set_ticks_per_ns(ticks_per_ns);
+        decoder_model.set_ticks_per_ns(ticks_per_ns);
+
+        std::vector<uint8_t> data(max_symbols * symbol_size);
+        for(uint32_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 2654435761U >> 24);
+        }
+
+        std::vector<uint8_t> payload(encoder_factory.max_payload_size());
+
+        for(uint32_t k : symbols)
+        {
+            encoder_factory.set_symbols(k);
+            decoder_factory.set_symbols(k);
+
+            auto encoder = encoder_factory.build();
+            auto decoder = decoder_factory.build();
+
+            if(is_systematic_encoder(encoder))
+            {
+                set_systematic_off(encoder);
+            }
+
+            encoder->set_timing_sample_interval(timing_sample_interval);
+            decoder->set_timing_sample_interval(timing_sample_interval);
+
+            encoder->set_symbols(
+                sak::storage(&data[0], encoder->block_size()));
+
+            // Only the coding is counted
+            encoder->reset_operations_counter();
+            decoder->reset_operations_counter();
+
+            while(!decoder->is_complete())
+            {
+                encoder->encode(&payload[0]);
+                decoder->decode(&payload[0]);
+            }
+
+            encoder_model.add_sample(k, symbol_size,
+                                     encoder->get_operations_profile());
+            decoder_model.add_sample(k, symbol_size,
+                                     decoder->get_operations_profile());
+        }
+    }
+
+}
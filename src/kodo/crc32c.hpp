@@ -0,0 +1,162 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "region_kernels.hpp"
+
+namespace kodo
+{
+
+    /// The type of the functions computing a CRC32C
+    /// @param crc The CRC of the preceding data, zero for the first
+    ///        buffer
+    /// @param data The buffer
+    /// @param size The size of the buffer in bytes
+    /// @return The CRC of the preceding data and the buffer
+    typedef uint32_t (*crc32c_function)(uint32_t crc, const uint8_t *data,
+                                        uint32_t size);
+
+    /// The reflected Castagnoli polynomial
+    static const uint32_t crc32c_polynomial = 0x82f63b78;
+
+    /// The tables of the portable CRC32C, table k holds the CRC of a
+    /// byte followed by k zero bytes, so eight bytes are processed per
+    /// step (slicing-by-8)
+    struct crc32c_tables
+    {
+        /// Builds the tables
+        crc32c_tables()
+        {
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t crc = i;
+
+                for(uint32_t j = 0; j < 8; ++j)
+                {
+                    crc = (crc >> 1) ^ (crc32c_polynomial & (0U - (crc & 1)));
+                }
+
+                m_table[0][i] = crc;
+            }
+
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                for(uint32_t k = 1; k < 8; ++k)
+                {
+                    uint32_t crc = m_table[k - 1][i];
+                    m_table[k][i] = (crc >> 8) ^ m_table[0][crc & 0xff];
+                }
+            }
+        }
+
+        /// @return The tables shared by all threads
+        static const crc32c_tables& instance()
+        {
+            static const crc32c_tables tables;
+            return tables;
+        }
+
+        /// The tables
+        uint32_t m_table[8][256];
+    };
+
+    /// Portable CRC32C
+    /// @copydoc crc32c_function
+    inline uint32_t crc32c_portable(uint32_t crc, const uint8_t *data,
+                                    uint32_t size)
+    {
+        const uint32_t (&t)[8][256] = crc32c_tables::instance().m_table;
+
+        crc = ~crc;
+
+        for(; size >= 8; size -= 8, data += 8)
+        {
+            // The words are assembled from the bytes, so the result
+            // does not depend on the byte order of the host
+            uint32_t low = uint32_t(data[0]) | uint32_t(data[1]) << 8 |
+                uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+            uint32_t high = uint32_t(data[4]) | uint32_t(data[5]) << 8 |
+                uint32_t(data[6]) << 16 | uint32_t(data[7]) << 24;
+
+            low ^= crc;
+
+            crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+                t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+                t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^
+                t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+        }
+
+        for(; size > 0; --size, ++data)
+        {
+            crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+        }
+
+        return ~crc;
+    }
+
+#if defined(KODO_REGION_KERNELS_X86) && defined(__x86_64__)
+
+    /// CRC32C using the SSE4.2 crc32 instruction
+    /// @copydoc crc32c_function
+    KODO_REGION_TARGET("sse4.2")
+    inline uint32_t crc32c_sse42(uint32_t crc, const uint8_t *data,
+                                 uint32_t size)
+    {
+        uint64_t c = ~crc;
+
+        for(; size >= 8; size -= 8, data += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data, 8);
+            c = _mm_crc32_u64(c, word);
+        }
+
+        uint32_t c32 = static_cast<uint32_t>(c);
+
+        for(; size > 0; --size, ++data)
+        {
+            c32 = _mm_crc32_u8(c32, *data);
+        }
+
+        return ~c32;
+    }
+
+#endif
+
+    /// @return The fastest CRC32C implementation of the running CPU
+    inline crc32c_function detect_crc32c()
+    {
+#if defined(KODO_REGION_KERNELS_X86) && defined(__x86_64__)
+        __builtin_cpu_init();
+
+        if(__builtin_cpu_supports("sse4.2"))
+        {
+            return &crc32c_sse42;
+        }
+#endif
+        return &crc32c_portable;
+    }
+
+    /// Computes the CRC32C (Castagnoli) of a buffer, using the crc32
+    /// instruction if the running CPU has it. A buffer may be processed
+    /// in parts by passing the CRC of the preceding parts.
+    /// @copydoc crc32c_function
+    inline uint32_t crc32c(uint32_t crc, const uint8_t *data, uint32_t size)
+    {
+        static const crc32c_function function = detect_crc32c();
+        return function(crc, data, size);
+    }
+
+    /// @copydoc crc32c(uint32_t, const uint8_t*, uint32_t)
+    inline uint32_t crc32c(const uint8_t *data, uint32_t size)
+    {
+        return crc32c(0, data, size);
+    }
+
+}
@@ -0,0 +1,60 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace kodo
+{
+
+    /// @return The current value of the time stamp counter on x86 or the
+    ///         nanoseconds of the steady clock on other platforms. Reading
+    ///         the counter costs a few tens of cycles, so single calls to
+    ///         encode() and decode() can be timed.
+    inline uint64_t read_cycle_counter()
+    {
+    #if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+    }
+
+    /// Measures the rate of the cycle counter against the steady clock
+    /// @return The number of counter ticks per nanosecond
+    inline double cycle_counter_ticks_per_ns()
+    {
+        typedef std::chrono::steady_clock clock_type;
+
+        auto start_time = clock_type::now();
+        uint64_t start_ticks = read_cycle_counter();
+
+        auto elapsed = clock_type::duration::zero();
+
+        // Busy wait for 10 ms, long enough to hide the cost of the reads
+        while(elapsed < std::chrono::milliseconds(10))
+        {
+            elapsed = clock_type::now() - start_time;
+        }
+
+        uint64_t ticks = read_cycle_counter() - start_ticks;
+
+        double ns = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                elapsed).count());
+
+        return ticks / ns;
+    }
+
+}
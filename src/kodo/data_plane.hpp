@@ -0,0 +1,243 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <fifi/arithmetics.hpp>
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "operation_log.hpp"
+#include "shared_field.hpp"
+
+namespace kodo
+{
+
+    /// @brief Backend performing the bulk operations on symbol data for
+    ///        the coders, e.g. on an accelerator.
+    ///
+    /// The coders keep the coefficients and all control logic, and only
+    /// hand the operations touching whole symbols of a block to the data
+    /// plane: the product of a coefficient matrix and a block of source
+    /// symbols, used for batches of coded symbols and matrix encoding,
+    /// and the replay of an operation_log recorded by a decoder. A
+    /// device backend, e.g. on CUDA or OpenCL, implements this interface
+    /// outside kodo. The calls are synchronous, a backend may split the
+    /// symbols into chunks to overlap the transfers of one chunk with the
+    /// computation of the previous one. Buffers which are used again,
+    /// e.g. the block of an encoder, are announced with
+    /// register_buffer(), so a backend may pin them for fast transfers.
+    ///
+    /// The host_data_plane is the reference implementation on the CPU,
+    /// see also the data_plane_finite_field_math layer.
+    template<class Field>
+    class data_plane : boost::noncopyable
+    {
+    public:
+
+        /// The finite field
+        typedef Field field_type;
+
+        /// The value type of the field
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// Destructor
+        virtual ~data_plane()
+        { }
+
+        /// Announces a buffer holding symbols which is used in many
+        /// operations, it must be unregistered before it is freed
+        /// @param data The buffer
+        /// @param size The size of the buffer in bytes
+        virtual void register_buffer(const uint8_t *data, uint64_t size)
+        {
+            (void) data;
+            (void) size;
+        }
+
+        /// Withdraws a buffer announced with register_buffer()
+        /// @param data The buffer
+        virtual void unregister_buffer(const uint8_t *data)
+        {
+            (void) data;
+        }
+
+        /// Computes destination j as the sum over i of
+        /// matrix[j * sources + i] * source i. The matrix holds one value
+        /// per entry, also for the binary field, and zero entries are
+        /// allowed. A destination may not be a source.
+        /// @param destinations The destination symbols
+        /// @param count The number of destination symbols
+        /// @param symbols_src The source symbols
+        /// @param sources The number of source symbols
+        /// @param matrix The coefficients, count rows of sources values
+        /// @param symbol_length The length of a symbol in value_type
+        virtual void multiply_block(value_type **destinations,
+                                    uint32_t count,
+                                    const value_type **symbols_src,
+                                    uint32_t sources,
+                                    const value_type *matrix,
+                                    uint32_t symbol_length) = 0;
+
+        /// Replays operations of a log on the symbol data of its slots
+        /// @param log The operation log
+        /// @param slots The symbol data of the slots
+        /// @param symbol_size The size of a symbol in bytes
+        /// @param first The first operation to replay
+        /// @param last The operation following the last one to replay
+        virtual void replay(const operation_log<field_type> &log,
+                            uint8_t **slots, uint32_t symbol_size,
+                            uint32_t first, uint32_t last) = 0;
+
+    };
+
+    /// @brief The data_plane running on the calling thread, using the
+    ///        finite field implementation of the coders.
+    ///
+    /// The destinations are computed in tiles: all sources are added to
+    /// a tile of every destination before moving on to the next tile,
+    /// so each source is read once and the tiles of the destinations
+    /// stay in the cache, as an accelerator would process the block in
+    /// tiles of its local memory.
+    template<class FieldImpl>
+    class host_data_plane
+        : public data_plane<typename FieldImpl::field_type>
+    {
+    public:
+
+        /// The finite field implementation
+        typedef FieldImpl field_impl;
+
+        /// @copydoc data_plane::field_type
+        typedef typename field_impl::field_type field_type;
+
+        /// @copydoc data_plane::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// The default size of a tile in bytes
+        static const uint32_t default_tile_size = 16384;
+
+    public:
+
+        /// Constructor
+        /// @param tile_size The size of a tile of a destination in bytes
+        host_data_plane(uint32_t tile_size = default_tile_size)
+            : m_field(shared_field<field_impl>()),
+              m_tile_length(std::max<uint32_t>(
+                  1U, fifi::size_to_length<field_type>(tile_size)))
+        {
+            m_temp.resize(m_tile_length);
+        }
+
+        /// @copydoc data_plane::multiply_block(value_type**, uint32_t,
+        ///                                     const value_type**,
+        ///                                     uint32_t,
+        ///                                     const value_type*, uint32_t)
+        void multiply_block(value_type **destinations, uint32_t count,
+                            const value_type **symbols_src,
+                            uint32_t sources, const value_type *matrix,
+                            uint32_t symbol_length)
+        {
+            assert(destinations != 0);
+            assert(sources == 0 || symbols_src != 0);
+            assert(sources == 0 || matrix != 0);
+
+            m_written.resize(count);
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += m_tile_length)
+            {
+                uint32_t length =
+                    std::min(m_tile_length, symbol_length - offset);
+
+                std::fill(m_written.begin(), m_written.end(), false);
+
+                for(uint32_t i = 0; i < sources; ++i)
+                {
+                    const value_type *src = symbols_src[i] + offset;
+
+                    for(uint32_t j = 0; j < count; ++j)
+                    {
+                        value_type coefficient = matrix[j * sources + i];
+
+                        if(coefficient == 0)
+                        {
+                            continue;
+                        }
+
+                        value_type *dest = destinations[j] + offset;
+
+                        if(!m_written[j])
+                        {
+                            std::copy_n(src, length, dest);
+
+                            if(coefficient != 1)
+                            {
+                                fifi::multiply_constant(
+                                    *m_field, coefficient, dest, length);
+                            }
+
+                            m_written[j] = true;
+                        }
+                        else if(fifi::is_binary<field_type>::value ||
+                                coefficient == 1)
+                        {
+                            fifi::add(*m_field, dest, src, length);
+                        }
+                        else
+                        {
+                            fifi::multiply_add(*m_field, coefficient, dest,
+                                               src, &m_temp[0], length);
+                        }
+                    }
+                }
+
+                // Rows of zeros
+                for(uint32_t j = 0; j < count; ++j)
+                {
+                    if(!m_written[j])
+                    {
+                        std::fill_n(destinations[j] + offset, length, 0);
+                    }
+                }
+            }
+        }
+
+        /// @copydoc data_plane::replay(const operation_log<field_type>&,
+        ///                             uint8_t**, uint32_t, uint32_t,
+        ///                             uint32_t)
+        void replay(const operation_log<field_type> &log, uint8_t **slots,
+                    uint32_t symbol_size, uint32_t first, uint32_t last)
+        {
+            log.replay(*m_field, slots, symbol_size, first, last);
+        }
+
+    private:
+
+        /// The finite field implementation
+        boost::shared_ptr<field_impl> m_field;
+
+        /// The length of a tile in value_type
+        uint32_t m_tile_length;
+
+        /// The temporary values of a multiply_add()
+        std::vector<value_type> m_temp;
+
+        /// True for the destinations written in the current tile
+        std::vector<bool> m_written;
+
+    };
+
+}
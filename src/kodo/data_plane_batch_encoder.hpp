@@ -0,0 +1,145 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+
+#include "linear_block_batch_encoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Produces the symbols of a batch as one matrix product,
+    ///        which may run on a data_plane.
+    ///
+    /// Like the linear_block_batch_encoder the coded symbols between
+    /// begin_batch() and end_batch() are collected, but end_batch()
+    /// hands the whole batch to multiply_block() of the
+    /// data_plane_finite_field_math layer: the coefficient vectors form
+    /// the rows of a matrix over the source symbols used by the batch.
+    /// The layer replaces the linear_block_batch_encoder, directly above
+    /// the linear_block_encoder, and requires the
+    /// data_plane_finite_field_math layer.
+    template<class SuperCoder>
+    class data_plane_batch_encoder
+        : public linear_block_batch_encoder<SuperCoder>
+    {
+    public:
+
+        /// The layer we extend
+        typedef linear_block_batch_encoder<SuperCoder> Super;
+
+        /// @copydoc layer::field_type
+        typedef typename Super::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename Super::value_type value_type;
+
+    public:
+
+        /// Produces all the encoded symbols of the current batch.
+        void end_batch()
+        {
+            assert(Super::m_batching);
+            Super::m_batching = false;
+
+            if(Super::m_symbols.empty())
+            {
+                return;
+            }
+
+            encode_block();
+
+            Super::m_symbols.clear();
+            Super::m_coefficients.clear();
+        }
+
+    protected:
+
+        /// Builds the coefficient matrix of the batch over the source
+        /// symbols used and computes the batch with multiply_block()
+        void encode_block()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t coefficients_size = SuperCoder::coefficients_size();
+            uint32_t count = static_cast<uint32_t>(Super::m_symbols.size());
+
+            // The sources with a non-zero coefficient in the batch
+            m_sources.clear();
+            m_columns.clear();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                for(uint32_t j = 0; j < count; ++j)
+                {
+                    if(coefficient(j, i, coefficients_size) != 0)
+                    {
+                        const value_type *symbol_i =
+                            SuperCoder::symbol_value(i);
+
+                        // Did you forget to set the data on the encoder?
+                        assert(symbol_i != 0);
+                        assert(SuperCoder::symbol_pivot(i));
+
+                        m_sources.push_back(symbol_i);
+                        m_columns.push_back(i);
+                        break;
+                    }
+                }
+            }
+
+            uint32_t sources = static_cast<uint32_t>(m_sources.size());
+
+            m_matrix.resize(count * sources);
+
+            for(uint32_t j = 0; j < count; ++j)
+            {
+                for(uint32_t s = 0; s < sources; ++s)
+                {
+                    m_matrix[j * sources + s] =
+                        coefficient(j, m_columns[s], coefficients_size);
+                }
+            }
+
+            SuperCoder::multiply_block(
+                &Super::m_symbols[0], count,
+                sources ? &m_sources[0] : 0, sources,
+                sources ? &m_matrix[0] : 0,
+                SuperCoder::symbol_length());
+        }
+
+        /// @param row A symbol of the batch
+        /// @param column The index of a source symbol
+        /// @param coefficients_size The size of a coefficient vector
+        /// @return The coefficient of the source in the symbol
+        value_type coefficient(uint32_t row, uint32_t column,
+                               uint32_t coefficients_size) const
+        {
+            const value_type *c = reinterpret_cast<const value_type*>(
+                &Super::m_coefficients[row * coefficients_size]);
+
+            return fifi::get_value<field_type>(c, column);
+        }
+
+    protected:
+
+        /// The source symbols used by the batch
+        std::vector<const value_type*> m_sources;
+
+        /// The index of each source symbol used
+        std::vector<uint32_t> m_columns;
+
+        /// The coefficients of the batch over the sources used
+        std::vector<value_type> m_matrix;
+
+    };
+
+}
@@ -0,0 +1,262 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+
+#include "data_plane.hpp"
+#include "finite_field_math.hpp"
+#include "operation_log.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup finite_field_layers
+    /// @brief Finite field layer handing the bulk operations on large
+    ///        symbols to a data_plane, e.g. an accelerator.
+    ///
+    /// The layer adds multiply_block(), the product of a coefficient
+    /// matrix and a block of symbols, e.g. used by the
+    /// data_plane_batch_encoder, and replay() of an operation_log. These
+    /// and multiply_sources() are passed to the data plane set on the
+    /// factory when the symbols are at least the offload size, 64 kB by
+    /// default, since smaller symbols do not pay for the transfers.
+    /// Otherwise, and without a data plane, they run on the calling
+    /// thread. The operations on single symbols, e.g. during the
+    /// elimination of a decoder, stay on the CPU. The layer is a
+    /// drop-in replacement for the finite_field_math layer.
+    template<class FieldImpl, class SuperCoder>
+    class data_plane_finite_field_math
+        : public finite_field_math<FieldImpl, SuperCoder>
+    {
+    public:
+
+        /// The layer we extend
+        typedef finite_field_math<FieldImpl, SuperCoder> Super;
+
+        /// @copydoc layer::field_type
+        typedef typename Super::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename Super::value_type value_type;
+
+        /// The data plane type
+        typedef kodo::data_plane<field_type> data_plane_type;
+
+        /// The default offload size in bytes
+        static const uint32_t default_offload_size = 65536;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer holding the data plane and offload size
+        /// used by the coders it builds
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size),
+                  m_data_plane(0),
+                  m_offload_size(default_offload_size)
+            { }
+
+            /// Sets the data plane of the coders built after this call
+            /// @param plane The data plane, or null for processing the
+            ///        operations on the calling thread
+            void set_data_plane(data_plane_type *plane)
+            {
+                m_data_plane = plane;
+            }
+
+            /// @return The data plane or null if none is set
+            data_plane_type* data_plane() const
+            {
+                return m_data_plane;
+            }
+
+            /// Sets the offload size of the coders built after this call
+            /// @param offload_size The smallest symbol size in bytes
+            ///        whose operations are passed to the data plane
+            void set_offload_size(uint32_t offload_size)
+            {
+                m_offload_size = offload_size;
+            }
+
+            /// @return The smallest symbol size in bytes whose operations
+            ///         are passed to the data plane
+            uint32_t offload_size() const
+            {
+                return m_offload_size;
+            }
+
+        protected:
+
+            /// The data plane
+            data_plane_type *m_data_plane;
+
+            /// The offload size in bytes
+            uint32_t m_offload_size;
+        };
+
+    public:
+
+        /// Constructor
+        data_plane_finite_field_math()
+            : m_data_plane(0),
+              m_offload_length(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            Super::initialize(the_factory);
+
+            m_data_plane = the_factory.data_plane();
+            m_offload_length =
+                fifi::size_to_length<field_type>(the_factory.offload_size());
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(value_type *symbol_dest,
+                              const value_type **symbols_src,
+                              const value_type *coefficients,
+                              uint32_t sources, uint32_t symbol_length)
+        {
+            if(sources == 0 || !is_offloaded(symbol_length))
+            {
+                Super::multiply_sources(symbol_dest, symbols_src,
+                                        coefficients, sources,
+                                        symbol_length);
+                return;
+            }
+
+            m_data_plane->multiply_block(&symbol_dest, 1, symbols_src,
+                                         sources, coefficients,
+                                         symbol_length);
+        }
+
+        /// Computes destination j as the sum over i of
+        /// matrix[j * sources + i] * source i, see
+        /// data_plane::multiply_block()
+        /// @param symbols_dest The destination symbols
+        /// @param count The number of destination symbols
+        /// @param symbols_src The source symbols
+        /// @param sources The number of source symbols
+        /// @param matrix The coefficients, count rows of sources values
+        /// @param symbol_length The length of a symbol in value_type
+        void multiply_block(value_type **symbols_dest, uint32_t count,
+                            const value_type **symbols_src,
+                            uint32_t sources, const value_type *matrix,
+                            uint32_t symbol_length)
+        {
+            if(is_offloaded(symbol_length))
+            {
+                m_data_plane->multiply_block(symbols_dest, count,
+                                             symbols_src, sources, matrix,
+                                             symbol_length);
+                return;
+            }
+
+            // Each source is read once and added to every destination
+            m_written.assign(count, false);
+
+            for(uint32_t i = 0; i < sources; ++i)
+            {
+                for(uint32_t j = 0; j < count; ++j)
+                {
+                    value_type coefficient = matrix[j * sources + i];
+
+                    if(coefficient == 0)
+                    {
+                        continue;
+                    }
+
+                    if(!m_written[j])
+                    {
+                        Super::multiply_copy(symbols_dest[j], symbols_src[i],
+                                             coefficient, symbol_length);
+
+                        m_written[j] = true;
+                    }
+                    else
+                    {
+                        Super::multiply_add(symbols_dest[j], symbols_src[i],
+                                            coefficient, symbol_length);
+                    }
+                }
+            }
+
+            for(uint32_t j = 0; j < count; ++j)
+            {
+                if(!m_written[j])
+                {
+                    std::fill_n(symbols_dest[j], symbol_length, 0);
+                }
+            }
+        }
+
+        /// Replays the operations of a log on the symbol data of its
+        /// slots, see operation_log::replay()
+        /// @param log The operation log
+        /// @param slots The symbol data of the slots
+        /// @param symbol_size The size of a symbol in bytes
+        void replay(const operation_log<field_type> &log, uint8_t **slots,
+                    uint32_t symbol_size)
+        {
+            uint32_t symbol_length =
+                fifi::size_to_length<field_type>(symbol_size);
+
+            if(is_offloaded(symbol_length))
+            {
+                m_data_plane->replay(log, slots, symbol_size, 0,
+                                     log.size());
+                return;
+            }
+
+            log.replay(*Super::m_field, slots, symbol_size);
+        }
+
+        /// @return The data plane of the coder or null if none is set
+        data_plane_type* data_plane() const
+        {
+            return m_data_plane;
+        }
+
+    protected:
+
+        /// @param symbol_length The length of the symbols of an
+        ///        operation in value_type
+        /// @return True if the operation is passed to the data plane
+        bool is_offloaded(uint32_t symbol_length) const
+        {
+            return m_data_plane != 0 && symbol_length >= m_offload_length;
+        }
+
+    protected:
+
+        /// The data plane
+        data_plane_type *m_data_plane;
+
+        /// The offload size in value_type
+        uint32_t m_offload_length;
+
+        /// True for the destinations written by multiply_block()
+        std::vector<bool> m_written;
+
+    };
+
+}
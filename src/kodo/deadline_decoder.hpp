@@ -0,0 +1,408 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// The load handled and shed by a deadline_decoder, in payloads
+    struct deadline_statistics
+    {
+
+        /// Constructs new statistics with all counters zero
+        deadline_statistics()
+            : m_received(0),
+              m_decoded(0),
+              m_shed_expired(0),
+              m_shed_complete(0),
+              m_completed_blocks(0),
+              m_expired_blocks(0)
+        { }
+
+        /// @return The payloads dropped without being decoded
+        uint64_t shed() const
+        {
+            return m_shed_expired + m_shed_complete;
+        }
+
+        /// The payloads received
+        uint64_t m_received;
+
+        /// The payloads passed to a decoder
+        uint64_t m_decoded;
+
+        /// The payloads dropped since the deadline of their block passed
+        uint64_t m_shed_expired;
+
+        /// The payloads dropped since their block was complete
+        uint64_t m_shed_complete;
+
+        /// The blocks completed before their deadline
+        uint64_t m_completed_blocks;
+
+        /// The blocks whose deadline passed before they were complete
+        uint64_t m_expired_blocks;
+
+    };
+
+    /// @brief Decodes the blocks of an object earliest deadline first
+    ///        within a time budget, shedding the payloads which cannot
+    ///        be useful.
+    ///
+    /// The payloads received are queued per block, and run() decodes
+    /// the queued payloads of the block with the earliest deadline
+    /// first until the queues are empty or the budget of the call is
+    /// spent. Under overload the blocks with distant deadlines wait
+    /// instead of the blocks about to be played out.
+    ///
+    /// A payload is dropped before any field operation if its block is
+    /// complete, e.g. completed through the annex of a
+    /// random_annex_decoder, or if the deadline of its block has
+    /// passed. The queue of a block is dropped the same way when it
+    /// expires or completes. The dropped payloads are counted in the
+    /// statistics().
+    ///
+    /// The ObjectDecoder is e.g. an object_decoder or a
+    /// random_annex_decoder, whose decoders are built when their first
+    /// payload is received. A block without a deadline never expires.
+    template<class ObjectDecoder, class Clock = std::chrono::steady_clock>
+    class deadline_decoder : boost::noncopyable
+    {
+    public:
+
+        /// Pointer to a decoder of the object decoder
+        typedef decltype(std::declval<ObjectDecoder&>().build(0)) pointer;
+
+        /// A point in time of the clock
+        typedef typename Clock::time_point time_point;
+
+        /// A time budget
+        typedef typename Clock::duration duration;
+
+    public:
+
+        /// Constructor
+        /// @param object_decoder The object decoder, must outlive the
+        ///        deadline decoder
+        explicit deadline_decoder(ObjectDecoder &object_decoder)
+            : m_object_decoder(object_decoder),
+              m_blocks(object_decoder.decoders()),
+              m_queued(0)
+        { }
+
+        /// @return The number of blocks of the object
+        uint32_t blocks() const
+        {
+            return static_cast<uint32_t>(m_blocks.size());
+        }
+
+        /// Sets the deadline of a block
+        /// @param block_id The block
+        /// @param deadline The time by which the block must be decoded
+        void set_deadline(uint32_t block_id, time_point deadline)
+        {
+            assert(block_id < blocks());
+
+            block &b = m_blocks[block_id];
+
+            if(!b.m_queue.empty())
+            {
+                m_ready.erase(std::make_pair(b.m_deadline, block_id));
+                m_ready.insert(std::make_pair(deadline, block_id));
+            }
+
+            b.m_deadline = deadline;
+        }
+
+        /// @param block_id The block
+        /// @return The deadline of the block, time_point::max() if it
+        ///         has none
+        time_point deadline(uint32_t block_id) const
+        {
+            assert(block_id < blocks());
+            return m_blocks[block_id].m_deadline;
+        }
+
+        /// Queues a payload of a block
+        /// @param block_id The block of the payload
+        /// @param payload The payload, copied into the queue
+        /// @param size The size of the payload in bytes
+        /// @param now The current time
+        /// @return False if the payload was shed since its block is
+        ///         complete or expired
+        bool receive(uint32_t block_id, const uint8_t *payload,
+                     uint32_t size, time_point now)
+        {
+            assert(block_id < blocks());
+            assert(payload != 0);
+            assert(size > 0);
+
+            ++m_statistics.m_received;
+
+            block &b = m_blocks[block_id];
+
+            if(is_complete(block_id))
+            {
+                ++m_statistics.m_shed_complete;
+                return false;
+            }
+
+            if(is_expired(block_id, now))
+            {
+                ++m_statistics.m_shed_expired;
+                return false;
+            }
+
+            if(b.m_queue.empty())
+            {
+                m_ready.insert(std::make_pair(b.m_deadline, block_id));
+            }
+
+            std::vector<uint8_t> buffer = acquire();
+            buffer.assign(payload, payload + size);
+
+            b.m_queue.push_back(std::move(buffer));
+            ++m_queued;
+
+            return true;
+        }
+
+        /// Decodes the queued payloads earliest deadline first
+        /// @param now The current time, the deadlines are compared with
+        ///        it advanced by the time spent in the call
+        /// @param budget The time the call may spend decoding, it
+        ///        returns after the payload exceeding it
+        /// @param max_payloads The largest number of payloads to decode
+        /// @return The number of payloads decoded
+        uint32_t run(time_point now, duration budget,
+                     uint32_t max_payloads =
+                         std::numeric_limits<uint32_t>::max())
+        {
+            typename Clock::time_point start = Clock::now();
+
+            uint32_t decoded = 0;
+
+            while(!m_ready.empty() && decoded < max_payloads)
+            {
+                duration elapsed = Clock::now() - start;
+
+                if(elapsed >= budget)
+                    break;
+
+                uint32_t block_id = m_ready.begin()->second;
+                block &b = m_blocks[block_id];
+
+                if(is_complete(block_id))
+                {
+                    m_statistics.m_shed_complete += b.m_queue.size();
+                    drop_queue(block_id);
+                    continue;
+                }
+
+                if(is_expired(block_id, now + elapsed))
+                {
+                    m_statistics.m_shed_expired += b.m_queue.size();
+                    drop_queue(block_id);
+                    continue;
+                }
+
+                std::vector<uint8_t> payload = std::move(b.m_queue.front());
+                b.m_queue.pop_front();
+                --m_queued;
+
+                if(b.m_queue.empty())
+                {
+                    m_ready.erase(m_ready.begin());
+                }
+
+                decoder(block_id)->decode(&payload[0]);
+                ++m_statistics.m_decoded;
+                ++decoded;
+
+                release(std::move(payload));
+
+                if(!b.m_counted && is_complete(block_id))
+                {
+                    ++m_statistics.m_completed_blocks;
+                    b.m_counted = true;
+                }
+            }
+
+            return decoded;
+        }
+
+        /// @param block_id The block
+        /// @return True if the decoder of the block is complete
+        bool is_complete(uint32_t block_id) const
+        {
+            assert(block_id < blocks());
+
+            const block &b = m_blocks[block_id];
+            return b.m_decoder_built && b.m_decoder->is_complete();
+        }
+
+        /// @param block_id The block
+        /// @param now The current time
+        /// @return True if the deadline of the block has passed before
+        ///         it was complete. The first call seeing a block expire
+        ///         counts it in the statistics.
+        bool is_expired(uint32_t block_id, time_point now)
+        {
+            assert(block_id < blocks());
+
+            block &b = m_blocks[block_id];
+
+            if(now < b.m_deadline || is_complete(block_id))
+                return false;
+
+            if(!b.m_counted)
+            {
+                ++m_statistics.m_expired_blocks;
+                b.m_counted = true;
+            }
+
+            return true;
+        }
+
+        /// @param block_id The block
+        /// @return The decoder of the block, built if needed
+        pointer& decoder(uint32_t block_id)
+        {
+            assert(block_id < blocks());
+
+            block &b = m_blocks[block_id];
+
+            if(!b.m_decoder_built)
+            {
+                b.m_decoder = m_object_decoder.build(block_id);
+                b.m_decoder_built = true;
+            }
+
+            return b.m_decoder;
+        }
+
+        /// @param block_id The block
+        /// @return The number of payloads queued for the block
+        uint32_t queued(uint32_t block_id) const
+        {
+            assert(block_id < blocks());
+            return static_cast<uint32_t>(m_blocks[block_id].m_queue.size());
+        }
+
+        /// @return The number of payloads queued for all blocks
+        uint32_t queued() const
+        {
+            return m_queued;
+        }
+
+        /// @return The load handled and shed
+        const deadline_statistics& statistics() const
+        {
+            return m_statistics;
+        }
+
+    private:
+
+        /// The state of a block
+        struct block
+        {
+            /// Constructor
+            block()
+                : m_deadline(time_point::max()),
+                  m_decoder_built(false),
+                  m_counted(false)
+            { }
+
+            /// The deadline of the block
+            time_point m_deadline;
+
+            /// The decoder of the block, once built
+            pointer m_decoder;
+
+            /// True if the decoder is built
+            bool m_decoder_built;
+
+            /// True if the block was counted as completed or expired
+            bool m_counted;
+
+            /// The queued payloads
+            std::deque<std::vector<uint8_t> > m_queue;
+        };
+
+        /// Drops the queued payloads of a block
+        /// @param block_id The block
+        void drop_queue(uint32_t block_id)
+        {
+            block &b = m_blocks[block_id];
+
+            if(b.m_queue.empty())
+                return;
+
+            m_ready.erase(std::make_pair(b.m_deadline, block_id));
+            m_queued -= static_cast<uint32_t>(b.m_queue.size());
+
+            for(auto &payload : b.m_queue)
+            {
+                release(std::move(payload));
+            }
+
+            b.m_queue.clear();
+        }
+
+        /// @return A payload buffer, reused if one was released
+        std::vector<uint8_t> acquire()
+        {
+            if(m_free.empty())
+                return std::vector<uint8_t>();
+
+            std::vector<uint8_t> buffer = std::move(m_free.back());
+            m_free.pop_back();
+
+            return buffer;
+        }
+
+        /// Keeps a payload buffer for reuse
+        /// @param buffer The buffer
+        void release(std::vector<uint8_t> &&buffer)
+        {
+            m_free.push_back(std::move(buffer));
+        }
+
+    private:
+
+        /// The object decoder building the decoders
+        ObjectDecoder &m_object_decoder;
+
+        /// The blocks of the object
+        std::vector<block> m_blocks;
+
+        /// The blocks with queued payloads by deadline
+        std::set<std::pair<time_point, uint32_t> > m_ready;
+
+        /// The released payload buffers
+        std::vector<std::vector<uint8_t> > m_free;
+
+        /// The number of payloads queued
+        uint32_t m_queued;
+
+        /// The load handled and shed
+        deadline_statistics m_statistics;
+
+    };
+
+}
@@ -0,0 +1,55 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+namespace kodo
+{
+
+    /// Snapshot of the counters of the telemetry_decoder layer for the
+    /// generation being decoded. The struct is plain data, so it can be
+    /// copied out of the decoder and exported as is.
+    struct decoder_telemetry
+    {
+
+        /// Constructs a new snapshot and zero initializes the counters
+        decoder_telemetry()
+            : m_received(0),
+              m_coded(0),
+              m_systematic(0),
+              m_non_innovative(0),
+              m_swap_decodes(0),
+              m_bytes(0),
+              m_non_innovative_bytes(0)
+            { }
+
+        /// The number of symbols passed to the decoder
+        uint32_t m_received;
+
+        /// The number of coded symbols, i.e. symbols with coefficients
+        uint32_t m_coded;
+
+        /// The number of systematic symbols, i.e. symbols with an index
+        uint32_t m_systematic;
+
+        /// The number of symbols which did not increase the rank
+        uint32_t m_non_innovative;
+
+        /// The number of systematic symbols replacing a coded symbol
+        /// at the same pivot, which is decoded again
+        uint32_t m_swap_decodes;
+
+        /// The bytes processed by the finite field operations
+        uint64_t m_bytes;
+
+        /// The bytes processed by the finite field operations on symbols
+        /// which did not increase the rank
+        uint64_t m_non_innovative_bytes;
+
+    };
+
+}
@@ -0,0 +1,509 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <boost/noncopyable.hpp>
+
+#include "payload_ring.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Decodes the objects of many concurrent sessions on a pool
+    ///        of worker threads.
+    ///
+    /// Every generation, i.e. a (session id, block id) pair, is owned by
+    /// one worker thread, so the coefficient and symbol matrices of a
+    /// decoder are only touched by one core and stay in its caches. The
+    /// worker threads are pinned to a core each where supported.
+    ///
+    /// Each worker has its own decoder factory, so building and
+    /// recycling decoders through the final_coder_factory_pool happens
+    /// without locks on the worker, and a payload_ring through which the
+    /// payloads are passed from the network thread. Since the rings are
+    /// single-producer, open_session(), decode() and close_session()
+    /// must all be called from the same thread.
+    ///
+    /// When a generation is complete the callback is invoked on its
+    /// worker with the decoder. The decoder is released to the pool of
+    /// the worker after the callback returns, so the callback must not
+    /// keep a reference to it. Further payloads for a completed
+    /// generation are dropped until the session is closed.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class decoding_service : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory_type;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+        /// The callback invoked when a generation is complete, called
+        /// as callback(session_id, block_id, decoder) on the worker
+        /// thread owning the generation
+        typedef std::function<void (uint32_t, uint32_t, const pointer&)>
+            complete_callback;
+
+    public:
+
+        /// Starts the worker threads
+        /// @param max_symbols The maximum number of symbols of the
+        ///        decoders
+        /// @param max_symbol_size The maximum symbol size of the
+        ///        decoders
+        /// @param callback Invoked when a generation is complete
+        /// @param threads The number of worker threads, zero means one
+        ///        per hardware thread
+        /// @param queue_size The number of payloads which may be queued
+        ///        at each worker
+        decoding_service(uint32_t max_symbols, uint32_t max_symbol_size,
+                         const complete_callback &callback,
+                         uint32_t threads = 0, uint32_t queue_size = 1024)
+            : m_max_symbols(max_symbols),
+              m_max_symbol_size(max_symbol_size),
+              m_callback(callback)
+        {
+            assert(m_callback);
+
+            if(threads == 0)
+            {
+                threads = std::thread::hardware_concurrency();
+            }
+
+            threads = std::max(threads, 1U);
+
+            // Only used to find the payload size of the decoders
+            factory_type factory(max_symbols, max_symbol_size);
+
+            uint32_t slot_size = message_size + factory.max_payload_size();
+
+            for(uint32_t i = 0; i < threads; ++i)
+            {
+                m_workers.emplace_back(new worker(queue_size, slot_size));
+            }
+
+            for(uint32_t i = 0; i < threads; ++i)
+            {
+                worker &w = *m_workers[i];
+                w.m_thread = std::thread(&decoding_service::work, this, i);
+
+                pin_thread(w.m_thread, i);
+            }
+        }
+
+        /// Stops and joins the worker threads, the generations which are
+        /// not complete are dropped
+        ~decoding_service()
+        {
+            for(uint32_t i = 0; i < workers(); ++i)
+            {
+                post(i, message_stop, 0, 0);
+            }
+
+            for(auto &w : m_workers)
+            {
+                w->m_thread.join();
+            }
+        }
+
+        /// @return The number of worker threads
+        uint32_t workers() const
+        {
+            return static_cast<uint32_t>(m_workers.size());
+        }
+
+        /// @param session_id The session
+        /// @param block_id The block of the session
+        /// @return The worker owning a generation
+        uint32_t worker_index(uint32_t session_id, uint32_t block_id) const
+        {
+            // Spread the blocks of a session over the workers
+            uint32_t hash = session_id * 2654435761U + block_id;
+            return hash % workers();
+        }
+
+        /// Opens a session, must be called before the payloads of the
+        /// session are passed to decode()
+        /// @param session_id The session
+        /// @param object_size The size in bytes of the object decoded in
+        ///        the session
+        void open_session(uint32_t session_id, uint32_t object_size)
+        {
+            assert(object_size > 0);
+
+            for(uint32_t i = 0; i < workers(); ++i)
+            {
+                post(i, message_open, session_id, object_size);
+            }
+        }
+
+        /// Closes a session and drops its decoders
+        /// @param session_id The session
+        void close_session(uint32_t session_id)
+        {
+            for(uint32_t i = 0; i < workers(); ++i)
+            {
+                post(i, message_close, session_id, 0);
+            }
+        }
+
+        /// Queues a payload at the worker owning the generation. The
+        /// payload must be of the payload_size() of the decoder of the
+        /// generation, zero padded as in the udp_datagram, otherwise
+        /// the worker drops it.
+        /// @param session_id The session
+        /// @param block_id The block of the session
+        /// @param payload The payload, copied into the queue
+        /// @param size The size of the payload in bytes
+        /// @return false if the payload was dropped because the queue
+        ///         of the worker was full, or because the payload is
+        ///         larger than the payloads of any decoder
+        bool decode(uint32_t session_id, uint32_t block_id,
+                    const uint8_t *payload, uint32_t size)
+        {
+            assert(payload != 0);
+
+            worker &w = *m_workers[worker_index(session_id, block_id)];
+
+            // A datagram from the network may have any size, and would
+            // overflow into the next slot
+            if(size > w.m_ring.max_payload_size() - message_size)
+            {
+                return false;
+            }
+
+            uint8_t *slot = w.m_ring.begin_write();
+
+            if(slot == 0)
+            {
+                return false;
+            }
+
+            write_message(slot, message_payload, session_id, block_id);
+            std::memcpy(slot + message_size, payload, size);
+
+            commit(w, message_size + size);
+            return true;
+        }
+
+    private:
+
+        /// The message types passed to the workers
+        enum message_type
+        {
+            message_payload,
+            message_open,
+            message_close,
+            message_stop
+        };
+
+        /// The size of the message header in front of a payload, a
+        /// cache line to keep the payload aligned
+        static const uint32_t message_size =
+            payload_ring::cache_line_size;
+
+        /// The state of a worker thread
+        struct worker
+        {
+            /// @param queue_size The number of slots of the ring
+            /// @param slot_size The size of the slots of the ring
+            worker(uint32_t queue_size, uint32_t slot_size)
+                : m_ring(queue_size, slot_size),
+                  m_sleeping(false)
+            { }
+
+            /// The messages to the worker
+            payload_ring m_ring;
+
+            /// True while the worker waits for messages
+            std::atomic<bool> m_sleeping;
+
+            /// Protects the waiting of the worker
+            std::mutex m_mutex;
+
+            /// Signals the worker
+            std::condition_variable m_wakeup;
+
+            /// The worker thread
+            std::thread m_thread;
+        };
+
+        /// The generations of a worker, only used on the worker thread
+        struct generations
+        {
+            /// The object sizes of the open sessions
+            std::map<uint32_t, uint32_t> m_sessions;
+
+            /// The decoders of the generations, by key()
+            std::map<uint64_t, pointer> m_decoders;
+
+            /// The completed generations, by key()
+            std::set<uint64_t> m_completed;
+        };
+
+        /// @return The key of a generation
+        static uint64_t key(uint32_t session_id, uint32_t block_id)
+        {
+            return (uint64_t(session_id) << 32) | block_id;
+        }
+
+        /// Writes the header of a message
+        static void write_message(uint8_t *slot, uint32_t type,
+                                  uint32_t first, uint32_t second)
+        {
+            uint32_t header[3] = { type, first, second };
+            std::memcpy(slot, header, sizeof(header));
+        }
+
+        /// Posts a control message to a worker, waits while the queue
+        /// of the worker is full
+        void post(uint32_t index, uint32_t type, uint32_t first,
+                  uint32_t second)
+        {
+            worker &w = *m_workers[index];
+
+            uint8_t *slot;
+            while((slot = w.m_ring.begin_write()) == 0)
+            {
+                std::this_thread::yield();
+            }
+
+            write_message(slot, type, first, second);
+            commit(w, message_size);
+        }
+
+        /// Commits a message and wakes the worker if it is waiting
+        void commit(worker &w, uint32_t size)
+        {
+            w.m_ring.commit_write(size);
+
+            if(w.m_sleeping.load())
+            {
+                std::lock_guard<std::mutex> lock(w.m_mutex);
+                w.m_wakeup.notify_one();
+            }
+        }
+
+        /// Pins a thread to a core
+        static void pin_thread(std::thread &thread, uint32_t index)
+        {
+#if defined(__linux__)
+            uint32_t cores =
+                std::max(std::thread::hardware_concurrency(), 1U);
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(index % cores, &set);
+
+            // Pinning is only a hint, e.g. the core may be excluded from
+            // the process, so errors are ignored
+            ::pthread_setaffinity_np(thread.native_handle(),
+                                     sizeof(set), &set);
+#else
+            (void) thread;
+            (void) index;
+#endif
+        }
+
+        /// The worker thread function
+        /// @param index The index of the worker
+        void work(uint32_t index)
+        {
+            worker &w = *m_workers[index];
+
+            // The factory is created on the worker, so its memory and
+            // the memory of the decoders is local to the core
+            factory_type factory(m_max_symbols, m_max_symbol_size);
+            generations state;
+
+            while(true)
+            {
+                uint32_t size = 0;
+                uint8_t *slot = w.m_ring.begin_read(&size);
+
+                if(slot == 0)
+                {
+                    wait(w);
+                    continue;
+                }
+
+                uint32_t header[3];
+                std::memcpy(header, slot, sizeof(header));
+
+                switch(header[0])
+                {
+                case message_payload:
+                    decode_payload(factory, state, header[1], header[2],
+                                   slot + message_size,
+                                   size - message_size);
+                    break;
+                case message_open:
+                    state.m_sessions[header[1]] = header[2];
+                    break;
+                case message_close:
+                    close(state, header[1]);
+                    break;
+                case message_stop:
+                    w.m_ring.commit_read();
+                    return;
+                default:
+                    assert(0 && "Unknown message type");
+                }
+
+                w.m_ring.commit_read();
+            }
+        }
+
+        /// Waits for a message, first by yielding and then by sleeping
+        void wait(worker &w)
+        {
+            for(uint32_t i = 0; i < 64; ++i)
+            {
+                if(w.m_ring.begin_read() != 0)
+                {
+                    return;
+                }
+
+                std::this_thread::yield();
+            }
+
+            std::unique_lock<std::mutex> lock(w.m_mutex);
+            w.m_sleeping = true;
+
+            if(w.m_ring.begin_read() == 0)
+            {
+                // The timeout covers a wakeup racing with the flag
+                w.m_wakeup.wait_for(lock, std::chrono::milliseconds(1));
+            }
+
+            w.m_sleeping = false;
+        }
+
+        /// Passes a payload to the decoder of its generation
+        void decode_payload(factory_type &factory, generations &state,
+                            uint32_t session_id, uint32_t block_id,
+                            uint8_t *payload, uint32_t size)
+        {
+            uint64_t generation = key(session_id, block_id);
+
+            if(state.m_completed.count(generation))
+            {
+                return;
+            }
+
+            pointer &decoder = state.m_decoders[generation];
+
+            if(!decoder)
+            {
+                auto session = state.m_sessions.find(session_id);
+
+                if(session == state.m_sessions.end())
+                {
+                    state.m_decoders.erase(generation);
+                    return;
+                }
+
+                block_partitioning partitioning(
+                    m_max_symbols, m_max_symbol_size, session->second);
+
+                if(block_id >= partitioning.blocks())
+                {
+                    state.m_decoders.erase(generation);
+                    return;
+                }
+
+                factory.set_symbols(partitioning.symbols(block_id));
+                factory.set_symbol_size(partitioning.symbol_size(block_id));
+
+                decoder = factory.build();
+                decoder->set_bytes_used(partitioning.bytes_used(block_id));
+            }
+
+            // A short payload would be decoded with the stale bytes of
+            // the slot, so as in the frame_ring_receiver the payload
+            // is dropped
+            if(size != decoder->payload_size())
+            {
+                return;
+            }
+
+            decoder->decode(payload);
+
+            if(!decoder->is_complete())
+            {
+                return;
+            }
+
+            m_callback(session_id, block_id, decoder);
+
+            // Releases the decoder to the pool of the factory
+            state.m_decoders.erase(generation);
+            state.m_completed.insert(generation);
+        }
+
+        /// Drops the generations of a session
+        static void close(generations &state, uint32_t session_id)
+        {
+            state.m_sessions.erase(session_id);
+
+            uint64_t begin = key(session_id, 0);
+            uint64_t end = key(session_id, 0xffffffffU);
+
+            state.m_decoders.erase(
+                state.m_decoders.lower_bound(begin),
+                state.m_decoders.upper_bound(end));
+
+            state.m_completed.erase(
+                state.m_completed.lower_bound(begin),
+                state.m_completed.upper_bound(end));
+        }
+
+    private:
+
+        /// The maximum number of symbols
+        uint32_t m_max_symbols;
+
+        /// The maximum symbol size
+        uint32_t m_max_symbol_size;
+
+        /// The complete callback
+        complete_callback m_callback;
+
+        /// The workers
+        std::vector<std::unique_ptr<worker> > m_workers;
+
+    };
+}
@@ -6,11 +6,15 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include <fifi/fifi_utils.hpp>
 #include <sak/storage.hpp>
 
+#include "snapshot.hpp"
+
 namespace kodo
 {
 
@@ -21,14 +25,27 @@ namespace kodo
     ///
     /// This is useful in cases where incoming data is to be
     /// decoded and no existing decoding buffer exist.
-    template<class SuperCoder>
-    class deep_symbol_storage : public SuperCoder
+    ///
+    /// When a coder is reused the buffer is not zeroed in
+    /// layer::initialize(Factory&). Instead only the part of the buffer
+    /// used by the current block is zeroed the first time the symbols
+    /// are accessed, and the zeroing is skipped entirely when all the
+    /// symbols are provided using set_symbols().
+    ///
+    /// The buffer is allocated with the Allocator, e.g. a
+    /// page_allocator to use huge pages or to place the buffer on the
+    /// NUMA node where the coder is used.
+    template<class Allocator, class SuperCoder>
+    class basic_deep_symbol_storage : public SuperCoder
     {
     public:
 
         /// @copydoc layer::value_type
         typedef typename SuperCoder::value_type value_type;
 
+        /// The type of the buffer holding the symbols
+        typedef std::vector<uint8_t, Allocator> data_vector;
+
     public:
 
         /// @copydoc layer::construct(Factory&)
@@ -45,9 +62,13 @@ namespace kodo
             // Construct should only be called once so
             // m_data.size() should be zero
             assert(m_data.size() == 0);
-            m_data.resize(max_data_needed, 0);
+
+            // The buffer is value initialized i.e. zero, an allocator
+            // may do so without touching the memory
+            m_data.resize(max_data_needed);
 
             m_symbols.resize(the_factory.max_symbols(), false);
+            m_zero_pending = false;
         }
 
         /// @copydoc layer::initialize(Factory&)
@@ -56,10 +77,9 @@ namespace kodo
         {
             SuperCoder::initialize(the_factory);
 
-            /// @todo This should not be necessary - we should not
-            ///       use data which has not been initialized yet
-            ///       anyway
-            std::fill(m_data.begin(), m_data.end(), 0);
+            // The zeroing of the active part of the buffer is delayed
+            // until the symbols are accessed
+            m_zero_pending = true;
             std::fill(m_symbols.begin(), m_symbols.end(), false);
 
             m_symbols_count = 0;
@@ -69,6 +89,7 @@ namespace kodo
         uint8_t* symbol(uint32_t index)
         {
             assert(index < SuperCoder::symbols());
+            zero_if_pending();
             return &m_data[index * SuperCoder::symbol_size()];
         }
 
@@ -82,6 +103,7 @@ namespace kodo
         const uint8_t* symbol(uint32_t index) const
         {
             assert(index < SuperCoder::symbols());
+            zero_if_pending();
             return &m_data[index * SuperCoder::symbol_size()];
         }
 
@@ -92,10 +114,11 @@ namespace kodo
         }
 
         /// @copydoc layer::swap_symbols(std::vector<uint8_t> &)
-        void swap_symbols(std::vector<uint8_t> &symbols)
+        void swap_symbols(data_vector &symbols)
         {
             assert(m_data.size() == symbols.size());
             m_data.swap(symbols);
+            m_zero_pending = false;
 
             m_symbols_count = SuperCoder::symbols();
             std::fill(m_symbols.begin(), m_symbols.end(), true);
@@ -109,6 +132,19 @@ namespace kodo
             assert(symbol_storage.m_size <=
                    SuperCoder::symbols() * SuperCoder::symbol_size());
 
+            // Only the part of the block not covered by the new data
+            // needs to be zeroed
+            if(m_zero_pending)
+            {
+                uint32_t block_size =
+                    SuperCoder::symbols() * SuperCoder::symbol_size();
+
+                std::fill(m_data.begin() + symbol_storage.m_size,
+                          m_data.begin() + block_size, 0);
+
+                m_zero_pending = false;
+            }
+
             // Use the copy function
             copy_storage(sak::storage(m_data), symbol_storage);
 
@@ -126,6 +162,8 @@ namespace kodo
             assert(symbol.m_size == SuperCoder::symbol_size());
             assert(index < SuperCoder::symbols());
 
+            zero_if_pending();
+
             sak::mutable_storage dest_data = sak::storage(m_data);
 
             uint32_t offset = index * SuperCoder::symbol_size();
@@ -150,6 +188,8 @@ namespace kodo
             assert(dest_storage.m_size > 0);
             assert(dest_storage.m_data != 0);
 
+            zero_if_pending();
+
             uint32_t data_to_copy =
                 std::min(dest_storage.m_size, SuperCoder::block_size());
 
@@ -214,10 +254,83 @@ namespace kodo
             return m_symbols[symbol_index];
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() +
+                snapshot_bitmap_size(SuperCoder::symbols()) +
+                SuperCoder::block_size();
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            buffer = SuperCoder::write_snapshot(buffer);
+            buffer = write_snapshot_bitmap(
+                m_symbols, SuperCoder::symbols(), buffer);
+
+            zero_if_pending();
+
+            uint32_t block_size = SuperCoder::block_size();
+            std::copy_n(m_data.begin(), block_size, buffer);
+
+            return buffer + block_size;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            buffer = read_snapshot_bitmap(
+                buffer, SuperCoder::symbols(), m_symbols);
+
+            m_symbols_count = static_cast<uint32_t>(
+                std::count(m_symbols.begin(), m_symbols.end(), true));
+
+            uint32_t block_size = SuperCoder::block_size();
+            std::copy_n(buffer, block_size, m_data.begin());
+            m_zero_pending = false;
+
+            return buffer + block_size;
+        }
+
+    protected:
+
+        /// Zeroes the part of the buffer used by the current block if
+        /// the coder was initialized since the buffer was last
+        /// zeroed. The function is const since it is also used from the
+        /// const accessors, it does not change the symbols seen through
+        /// the layer API.
+        void zero_if_pending() const
+        {
+            if(!m_zero_pending)
+            {
+                return;
+            }
+
+            uint32_t block_size =
+                SuperCoder::symbols() * SuperCoder::symbol_size();
+
+            assert(block_size <= m_data.size());
+            std::fill_n(m_data.begin(), block_size, 0);
+
+            m_zero_pending = false;
+        }
+
     private:
 
-        /// Storage for the symbol data
-        std::vector<uint8_t> m_data;
+        /// Storage for the symbol data, mutable since it is zeroed
+        /// lazily also from the const accessors
+        mutable data_vector m_data;
+
+        /// True if the part of the buffer used by the current block
+        /// has not been zeroed since the coder was initialized
+        mutable bool m_zero_pending;
 
         /// Symbols count
         uint32_t m_symbols_count;
@@ -226,6 +339,14 @@ namespace kodo
         std::vector<bool> m_symbols;
 
     };
+
+    /// @ingroup symbol_storage_layers
+    /// @brief The deep storage using the default allocator, see
+    ///        basic_deep_symbol_storage.
+    template<class SuperCoder>
+    class deep_symbol_storage : public basic_deep_symbol_storage<
+        std::allocator<uint8_t>, SuperCoder>
+    { };
 }
 
 
@@ -0,0 +1,172 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <unordered_set>
+
+#include <sak/convert_endian.hpp>
+
+#include "systematic_base_coder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_header_layers
+    /// @brief Rejects packets which cannot increase the rank before
+    ///        the symbol id is read.
+    ///
+    /// Packets received after the decoder is complete are dropped, as
+    /// are coded packets carrying a symbol id which was already
+    /// received. A repeated id is detected by a 64 bit hash of the id,
+    /// which for plain symbol ids is the coefficient vector and for
+    /// seed based ids is the seed, so the duplicate is rejected before
+    /// the seed is expanded or the vector is eliminated. The rejection
+    /// only reads the header and never touches the symbol data.
+    /// Duplicate systematic packets are already cheap to reject in the
+    /// codec layers, so they are passed on.
+    ///
+    /// Two different ids with the same hash would make the layer drop
+    /// an innovative packet, which happens with a probability of about
+    /// n^2 / 2^65 for n received packets.
+    ///
+    /// The layer is placed above the systematic_decoder, or above the
+    /// symbol_id_decoder in a non-systematic stack.
+    template<class SuperCoder>
+    class duplicate_rejection_decoder : public SuperCoder
+    {
+    public:
+
+        /// The flag type
+        typedef typename systematic_base_coder::flag_type
+            flag_type;
+
+    public:
+
+        /// Constructor
+        duplicate_rejection_decoder()
+            : m_rejected(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+            m_ids.reserve(the_factory.max_symbols());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_ids.clear();
+            m_rejected = 0;
+        }
+
+        /// @copydoc layer::decode(uint8_t*, uint8_t*)
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            if(SuperCoder::is_complete())
+            {
+                ++m_rejected;
+                return;
+            }
+
+            uint32_t offset = SuperCoder::symbol_id_offset();
+
+            if(offset > 0 && sak::big_endian::get<flag_type>(
+                   symbol_header) == systematic_base_coder::systematic_flag)
+            {
+                SuperCoder::decode(symbol_data, symbol_header);
+                return;
+            }
+
+            uint64_t hash =
+                hash_id(symbol_header + offset, SuperCoder::id_size());
+
+            if(!m_ids.insert(hash).second)
+            {
+                ++m_rejected;
+                return;
+            }
+
+            SuperCoder::decode(symbol_data, symbol_header);
+        }
+
+        /// @return The number of packets rejected since the decoder was
+        ///         built
+        uint32_t rejected_packets() const
+        {
+            return m_rejected;
+        }
+
+    protected:
+
+        /// Hashes a symbol id a 64 bit word at a time
+        /// @param id The symbol id
+        /// @param size The size of the symbol id in bytes
+        /// @return The hash of the symbol id
+        static uint64_t hash_id(const uint8_t *id, uint32_t size)
+        {
+            assert(id != 0);
+
+            // Multiplier and finalizer of the 64 bit MurmurHash
+            const uint64_t multiplier = 0xc6a4a7935bd1e995ULL;
+
+            uint64_t hash = size * multiplier;
+
+            uint32_t i = 0;
+            for(; i + 8 <= size; i += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, id + i, sizeof(word));
+                hash = (hash ^ mix(word)) * multiplier;
+            }
+
+            if(i < size)
+            {
+                uint64_t word = 0;
+                std::memcpy(&word, id + i, size - i);
+                hash = (hash ^ mix(word)) * multiplier;
+            }
+
+            hash ^= hash >> 47;
+            hash *= multiplier;
+            hash ^= hash >> 47;
+
+            return hash;
+        }
+
+        /// @param word A word of a symbol id
+        /// @return The word mixed so every bit affects the hash
+        static uint64_t mix(uint64_t word)
+        {
+            const uint64_t multiplier = 0xc6a4a7935bd1e995ULL;
+
+            word *= multiplier;
+            word ^= word >> 47;
+            return word * multiplier;
+        }
+
+    protected:
+
+        /// The hashes of the coded symbol ids received
+        std::unordered_set<uint64_t> m_ids;
+
+        /// The number of packets rejected
+        uint32_t m_rejected;
+
+    };
+
+}
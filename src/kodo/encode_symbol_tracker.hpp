@@ -44,6 +44,24 @@ namespace kodo
             ++m_counter;
         }
 
+        /// @copydoc layer::encode_symbol(uint8_t*, const uint32_t*,
+        ///                              const value_type*, uint32_t)
+        void encode_symbol(uint8_t *symbol_data, const uint32_t *indices,
+                           const typename SuperCoder::value_type *coefficients,
+                           uint32_t count)
+        {
+            SuperCoder::encode_symbol(symbol_data, indices,
+                                      coefficients, count);
+            ++m_counter;
+        }
+
+        /// @copydoc linear_block_encoder::encode_symbol_in_place(uint32_t)
+        const uint8_t* encode_symbol_in_place(uint32_t symbol_index)
+        {
+            ++m_counter;
+            return SuperCoder::encode_symbol_in_place(symbol_index);
+        }
+
         /// @return the symbol encoded counter
         uint32_t encode_symbol_count() const
         {
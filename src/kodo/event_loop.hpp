@@ -0,0 +1,253 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cerrno>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// @brief A single threaded event loop based on epoll (Linux).
+    ///
+    /// Handlers are invoked when their file descriptors are ready, and
+    /// tasks posted with post() are run once in the next iteration,
+    /// which lets a long running job, e.g. the transfer of an object,
+    /// yield to the other jobs of the loop. Many jobs may thereby share
+    /// one thread without a thread and its context switches per job.
+    /// For more threads run a loop on each of them.
+    ///
+    /// The loop is not thread safe, all functions must be called on
+    /// the thread running the loop or before it is run. The handlers
+    /// and tasks may add, modify and remove file descriptors and post
+    /// tasks. The file descriptors are level triggered, so a handler
+    /// which leaves data to be read is invoked again.
+    class event_loop : boost::noncopyable
+    {
+    public:
+
+        /// The handler of a file descriptor, called with the ready
+        /// epoll events, e.g. EPOLLIN
+        typedef std::function<void (uint32_t)> handler;
+
+        /// A task run by the loop
+        typedef std::function<void ()> task;
+
+    public:
+
+        /// Constructs a new event loop
+        /// @param max_events The maximum number of events handled per
+        ///        epoll_wait() call
+        event_loop(uint32_t max_events = 64)
+            : m_stopped(false)
+        {
+            assert(max_events > 0);
+
+            m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+            assert(m_epoll >= 0);
+
+            m_events.resize(max_events);
+        }
+
+        /// Destructor
+        ~event_loop()
+        {
+            ::close(m_epoll);
+        }
+
+        /// Adds a file descriptor to the loop
+        /// @param fd The file descriptor, which must not be in the loop
+        /// @param events The epoll events to wait for, e.g. EPOLLIN
+        /// @param fd_handler The handler invoked when the fd is ready
+        /// @return True if the fd was added, false on an epoll error
+        bool add(int fd, uint32_t events, const handler &fd_handler)
+        {
+            assert(fd >= 0);
+            assert(fd_handler);
+            assert(m_handlers.find(fd) == m_handlers.end());
+
+            if(!control(EPOLL_CTL_ADD, fd, events))
+            {
+                return false;
+            }
+
+            m_handlers[fd] = std::make_shared<handler>(fd_handler);
+            return true;
+        }
+
+        /// Changes the events a file descriptor waits for
+        /// @param fd A file descriptor in the loop
+        /// @param events The epoll events to wait for
+        /// @return True if the events were changed
+        bool modify(int fd, uint32_t events)
+        {
+            assert(m_handlers.find(fd) != m_handlers.end());
+            return control(EPOLL_CTL_MOD, fd, events);
+        }
+
+        /// Removes a file descriptor from the loop, its handler is not
+        /// invoked again, even for events already returned by epoll
+        /// @param fd A file descriptor in the loop
+        void remove(int fd)
+        {
+            auto it = m_handlers.find(fd);
+            assert(it != m_handlers.end());
+
+            control(EPOLL_CTL_DEL, fd, 0);
+            m_handlers.erase(it);
+        }
+
+        /// @param fd A file descriptor
+        /// @return True if the file descriptor is in the loop
+        bool contains(int fd) const
+        {
+            return m_handlers.find(fd) != m_handlers.end();
+        }
+
+        /// Posts a task run once in the next iteration of the loop
+        /// @param loop_task The task
+        void post(const task &loop_task)
+        {
+            assert(loop_task);
+            m_tasks.push_back(loop_task);
+        }
+
+        /// Runs the tasks posted before the call, then waits for the file
+        /// descriptors and invokes the handlers of the ready ones
+        /// @param timeout_ms The maximum time to wait in milliseconds,
+        ///        -1 waits until a file descriptor is ready. The loop
+        ///        does not wait if tasks are posted.
+        /// @return The number of tasks and handlers invoked
+        uint32_t run_once(int timeout_ms)
+        {
+            uint32_t invoked = 0;
+
+            // Tasks posted by the tasks run in the next iteration
+            uint32_t tasks = static_cast<uint32_t>(m_tasks.size());
+
+            for(uint32_t i = 0; i < tasks; ++i)
+            {
+                task loop_task;
+                loop_task.swap(m_tasks.front());
+                m_tasks.pop_front();
+
+                loop_task();
+                ++invoked;
+            }
+
+            if(m_handlers.empty())
+            {
+                return invoked;
+            }
+
+            if(!m_tasks.empty())
+            {
+                timeout_ms = 0;
+            }
+
+            int ready;
+
+            do
+            {
+                ready = ::epoll_wait(m_epoll, &m_events[0],
+                                     static_cast<int>(m_events.size()),
+                                     timeout_ms);
+            }
+            while(ready < 0 && errno == EINTR);
+
+            for(int i = 0; i < ready; ++i)
+            {
+                auto it = m_handlers.find(m_events[i].data.fd);
+
+                // Removed by an earlier handler
+                if(it == m_handlers.end())
+                {
+                    continue;
+                }
+
+                // The handler may remove itself while it runs
+                std::shared_ptr<handler> fd_handler = it->second;
+                (*fd_handler)(m_events[i].events);
+
+                ++invoked;
+            }
+
+            return invoked;
+        }
+
+        /// Runs the loop until stop() is called or there are neither
+        /// file descriptors nor tasks left
+        void run()
+        {
+            m_stopped = false;
+
+            while(!m_stopped && !empty())
+            {
+                run_once(-1);
+            }
+        }
+
+        /// Makes run() return after the current iteration
+        void stop()
+        {
+            m_stopped = true;
+        }
+
+        /// @return True if there are neither file descriptors nor tasks
+        ///         in the loop
+        bool empty() const
+        {
+            return m_handlers.empty() && m_tasks.empty();
+        }
+
+    private:
+
+        /// Calls epoll_ctl() for a file descriptor
+        /// @param operation The operation, e.g. EPOLL_CTL_ADD
+        /// @param fd The file descriptor
+        /// @param events The epoll events
+        /// @return True on success
+        bool control(int operation, int fd, uint32_t events)
+        {
+            epoll_event event;
+            event.events = events;
+            event.data.u64 = 0;
+            event.data.fd = fd;
+
+            return ::epoll_ctl(m_epoll, operation, fd, &event) == 0;
+        }
+
+    private:
+
+        /// The epoll instance
+        int m_epoll;
+
+        /// True when stop() has been called
+        bool m_stopped;
+
+        /// The handlers by file descriptor
+        std::map<int, std::shared_ptr<handler> > m_handlers;
+
+        /// The posted tasks
+        std::deque<task> m_tasks;
+
+        /// The events returned by epoll_wait()
+        std::vector<epoll_event> m_events;
+
+    };
+
+}
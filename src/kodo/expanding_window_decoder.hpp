@@ -0,0 +1,331 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Decodes the prefixes of a block as soon as they are
+    ///        solvable, for the expanding window codes.
+    ///
+    /// The symbols are eliminated as in the band_decoder, so the symbol
+    /// stored at pivot p is zero outside [p, e_p). A vector of the
+    /// expanding_window_generator reaches to the end of its window
+    /// only, but reducing it by a stored symbol of a larger window
+    /// would widen it to that window. Therefore, when a received symbol
+    /// meets a stored coded symbol with a wider band, the two swap
+    /// places: the received symbol is stored at the pivot and the
+    /// stored one is reduced further. Every pivot thus keeps the
+    /// narrowest band seen, and the symbols of a window stay within the
+    /// window.
+    ///
+    /// After each received symbol the layer looks for the shortest
+    /// prefix [0, n) past the decoded symbols where every symbol has a
+    /// pivot and no band reaches past n. The prefix is then solvable on
+    /// its own and is decoded right away, from its last pivot to its
+    /// first, and its symbols are marked as uncoded. A high priority
+    /// window is thereby decoded once enough vectors of the windows up
+    /// to it are received, long before the block is complete, and its
+    /// elimination stays within the window.
+    ///
+    /// The layer is placed directly above the band_decoder.
+    template<class SuperCoder>
+    class expanding_window_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// Constructor
+        expanding_window_decoder()
+            : m_decoded_prefix(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_decoded_prefix = 0;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *symbol_coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_coefficients != 0);
+
+            if(SuperCoder::is_complete())
+            {
+                return;
+            }
+
+            decode_window(
+                reinterpret_cast<value_type*>(symbol_data),
+                reinterpret_cast<value_type*>(symbol_coefficients));
+
+            decode_prefix();
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*, uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+            assert(symbol_data != 0);
+
+            if(!SuperCoder::m_coded[symbol_index])
+            {
+                SuperCoder::decode_symbol(symbol_data, symbol_index);
+                decode_prefix();
+                return;
+            }
+
+            if(SuperCoder::is_complete())
+            {
+                return;
+            }
+
+            // The uncoded symbol is the narrowest possible band at its
+            // pivot, so it takes the place of the coded symbol
+            value_type *symbol = &SuperCoder::m_symbol_scratch[0];
+            value_type *coefficients =
+                &SuperCoder::m_coefficients_scratch[0];
+
+            std::copy_n(reinterpret_cast<const value_type*>(symbol_data),
+                        SuperCoder::symbol_length(), symbol);
+
+            std::fill_n(coefficients, SuperCoder::coefficients_length(),
+                        0);
+
+            fifi::set_value<field_type>(coefficients, symbol_index, 1U);
+
+            decode_window(symbol, coefficients);
+            decode_prefix();
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            m_decoded_prefix = 0;
+            decode_prefix();
+
+            return buffer;
+        }
+
+        /// @return The number of symbols at the start of the block
+        ///         which are decoded, e.g. the size of the largest
+        ///         decoded window
+        uint32_t decoded_prefix() const
+        {
+            return m_decoded_prefix;
+        }
+
+        /// @param window_size The number of symbols in a window
+        /// @return True if the symbols of the window are decoded
+        bool is_window_decoded(uint32_t window_size) const
+        {
+            return window_size <= m_decoded_prefix;
+        }
+
+    protected:
+
+        /// Reduces a symbol by the stored symbols until a free pivot is
+        /// found, and stores it. At a stored coded symbol with a wider
+        /// band the two symbols are swapped.
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        void decode_window(value_type *symbol_data, value_type *symbol_id)
+        {
+            uint32_t end = SuperCoder::band_end(symbol_id, 0);
+
+            for(uint32_t i = SuperCoder::next_nonzero(symbol_id, 0);
+                i < end; i = SuperCoder::next_nonzero(symbol_id, i + 1))
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    store_window(symbol_data, symbol_id, i, end);
+                    return;
+                }
+
+                if(SuperCoder::m_coded[i] && end < SuperCoder::m_band_end[i])
+                {
+                    swap_window(symbol_data, symbol_id, i, end);
+                }
+
+                value_type coefficient =
+                    fifi::get_value<field_type>(symbol_id, i);
+
+                SuperCoder::subtract_band(symbol_data, symbol_id, i,
+                                          coefficient);
+
+                end = std::max(end, SuperCoder::m_band_end[i]);
+            }
+
+            // The symbol was not innovative
+        }
+
+        /// Stores a symbol at a free pivot
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        /// @param pivot_index The pivot of the symbol
+        /// @param end The end of the band of the symbol
+        void store_window(value_type *symbol_data, value_type *symbol_id,
+                          uint32_t pivot_index, uint32_t end)
+        {
+            if(!fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::normalize(symbol_data, symbol_id, pivot_index,
+                                      end);
+            }
+
+            SuperCoder::store_coded_symbol(symbol_data, symbol_id,
+                                           pivot_index);
+
+            SuperCoder::m_band_end[pivot_index] = end;
+
+            ++SuperCoder::m_rank;
+
+            SuperCoder::set_symbol_coded(pivot_index);
+
+            if(pivot_index > SuperCoder::m_maximum_pivot)
+            {
+                SuperCoder::m_maximum_pivot = pivot_index;
+            }
+
+            if(SuperCoder::is_complete())
+            {
+                SuperCoder::final_backward_substitute();
+            }
+        }
+
+        /// Stores a symbol at the pivot of a stored coded symbol with a
+        /// wider band, the stored symbol is moved to the buffers of the
+        /// symbol
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        /// @param pivot_index The pivot of the stored symbol
+        /// @param end The end of the band of the symbol, which is
+        ///        updated to the end of the band of the stored symbol
+        void swap_window(value_type *symbol_data, value_type *symbol_id,
+                         uint32_t pivot_index, uint32_t &end)
+        {
+            assert(SuperCoder::m_coded[pivot_index]);
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::normalize(symbol_data, symbol_id, pivot_index,
+                                      end);
+            }
+
+            value_type *symbol_i = SuperCoder::symbol_value(pivot_index);
+            value_type *vector_i =
+                SuperCoder::coefficients_value(pivot_index);
+
+            uint32_t stored_end = SuperCoder::m_band_end[pivot_index];
+
+            // Both vectors are zero outside the wider band
+            uint32_t first = SuperCoder::first_value(pivot_index);
+            uint32_t last = SuperCoder::end_value(stored_end);
+
+            std::swap_ranges(symbol_data,
+                             symbol_data + SuperCoder::symbol_length(),
+                             symbol_i);
+
+            std::swap_ranges(symbol_id + first, symbol_id + last,
+                             vector_i + first);
+
+            SuperCoder::m_band_end[pivot_index] = end;
+            end = stored_end;
+        }
+
+        /// Extends the decoded prefix by the following prefixes which
+        /// are solvable
+        void decode_prefix()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            if(SuperCoder::is_complete())
+            {
+                // The band_decoder has substituted the block
+                m_decoded_prefix = symbols;
+                return;
+            }
+
+            uint32_t end = m_decoded_prefix;
+
+            for(uint32_t i = m_decoded_prefix; i < symbols; ++i)
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    return;
+                }
+
+                end = std::max(end, SuperCoder::m_band_end[i]);
+
+                if(end == i + 1)
+                {
+                    substitute_prefix(end);
+                }
+            }
+        }
+
+        /// Decodes the symbols after the decoded prefix up to an end,
+        /// their bands must be within the end
+        /// @param end The end of the new decoded prefix, exclusive
+        void substitute_prefix(uint32_t end)
+        {
+            assert(end > m_decoded_prefix);
+
+            for(uint32_t i = end; i --> m_decoded_prefix;)
+            {
+                assert(SuperCoder::symbol_pivot(i));
+                assert(SuperCoder::m_band_end[i] <= end);
+
+                if(!SuperCoder::m_coded[i])
+                {
+                    continue;
+                }
+
+                SuperCoder::substitute_band(i);
+
+                SuperCoder::clear_symbol_coded(i);
+                SuperCoder::set_symbol_uncoded(i);
+            }
+
+            m_decoded_prefix = end;
+        }
+
+    protected:
+
+        /// The number of decoded symbols at the start of the block
+        uint32_t m_decoded_prefix;
+
+    };
+
+}
@@ -0,0 +1,282 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Generates coefficients for expanding window codes, where
+    ///        every vector only combines a prefix of the block.
+    ///
+    /// The symbols of a block are ordered by importance, e.g. the base
+    /// layer of a scalable video first, and the windows are the nested
+    /// prefixes of the priority classes: window i holds the first w_i
+    /// symbols. Each vector is drawn for a window chosen at random in
+    /// proportion to the window weights, and its coefficients are
+    /// uniformly random within the window and zero after it. A decoder
+    /// can therefore solve a window from about w_i vectors of the
+    /// windows up to i, without waiting for the whole block, see the
+    /// expanding_window_decoder.
+    ///
+    /// The windows are set on the factory. Windows larger than the
+    /// block are cut to the block, and the last window always spans the
+    /// whole block so every symbol is coded. By default there is a
+    /// single window, which codes like the uniform_generator.
+    template<class SuperCoder>
+    class expanding_window_generator : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The random generator used
+        typedef boost::random::mt19937 generator_type;
+
+        /// @copydoc layer::seed_type
+        typedef generator_type::result_type seed_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t, uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// Sets the windows of the coders built afterwards, each
+            /// window is chosen for a vector with weight one
+            /// @param windows The number of symbols in each window, in
+            ///        increasing order
+            void set_windows(const std::vector<uint32_t> &windows)
+            {
+                set_windows(windows,
+                            std::vector<uint32_t>(windows.size(), 1));
+            }
+
+            /// Sets the windows of the coders built afterwards
+            /// @param windows The number of symbols in each window, in
+            ///        increasing order
+            /// @param weights The weight with which each window is
+            ///        chosen for a vector
+            void set_windows(const std::vector<uint32_t> &windows,
+                             const std::vector<uint32_t> &weights)
+            {
+                assert(windows.size() == weights.size());
+                assert(std::is_sorted(windows.begin(), windows.end()));
+
+                m_windows = windows;
+                m_weights = weights;
+            }
+
+            /// @return The number of symbols in each window as set
+            const std::vector<uint32_t>& windows() const
+            {
+                return m_windows;
+            }
+
+            /// @return The weight of each window as set
+            const std::vector<uint32_t>& weights() const
+            {
+                return m_weights;
+            }
+
+        private:
+
+            /// The number of symbols in each window
+            std::vector<uint32_t> m_windows;
+
+            /// The weight of each window
+            std::vector<uint32_t> m_weights;
+        };
+
+    public:
+
+        /// Constructor
+        expanding_window_generator()
+            : m_value_distribution(field_type::min_value,
+                                   field_type::max_value),
+              m_total_weight(0),
+              m_window(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            const std::vector<uint32_t> &windows = the_factory.windows();
+            const std::vector<uint32_t> &weights = the_factory.weights();
+
+            m_window_ends.clear();
+            m_cumulative_weights.clear();
+            m_total_weight = 0;
+
+            for(uint32_t i = 0; i < windows.size(); ++i)
+            {
+                assert(windows[i] > 0);
+
+                if(weights[i] == 0)
+                {
+                    continue;
+                }
+
+                m_total_weight += weights[i];
+
+                m_window_ends.push_back(std::min(windows[i], symbols));
+                m_cumulative_weights.push_back(m_total_weight);
+            }
+
+            if(m_window_ends.empty())
+            {
+                m_total_weight = 1;
+
+                m_window_ends.push_back(symbols);
+                m_cumulative_weights.push_back(m_total_weight);
+            }
+
+            m_window_ends.back() = symbols;
+            m_window = 0;
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            // Only the window is set, the other coefficients are zero
+            std::fill_n(coefficients, SuperCoder::coefficients_size(), 0);
+
+            value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t end = select_window();
+
+            for(uint32_t i = 0; i < end; ++i)
+            {
+                fifi::set_value<field_type>(
+                    c, i, m_value_distribution(m_random_generator));
+            }
+        }
+
+        /// @copydoc layer::generate_partial(uint8_t*)
+        void generate_partial(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            generate(coefficients);
+
+            value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t end = m_window_ends[m_window];
+
+            for(uint32_t i = 0; i < end; ++i)
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    fifi::set_value<field_type>(c, i, 0);
+                }
+            }
+        }
+
+        /// @copydoc layer::seed(seed_type)
+        void seed(seed_type seed_value)
+        {
+            m_random_generator.seed(seed_value);
+        }
+
+        /// @return The number of windows of the coder
+        uint32_t windows() const
+        {
+            return static_cast<uint32_t>(m_window_ends.size());
+        }
+
+        /// @param window The index of a window
+        /// @return The number of symbols in the window
+        uint32_t window_size(uint32_t window) const
+        {
+            assert(window < m_window_ends.size());
+            return m_window_ends[window];
+        }
+
+        /// @return The index of the window of the latest generated
+        ///         vector
+        uint32_t window() const
+        {
+            return m_window;
+        }
+
+    protected:
+
+        /// Selects the window of the next vector
+        /// @return The end of the window, exclusive
+        uint32_t select_window()
+        {
+            assert(m_total_weight > 0);
+
+            weight_distribution weights(0, m_total_weight - 1);
+            uint32_t weight = weights(m_random_generator);
+
+            m_window = static_cast<uint32_t>(
+                std::upper_bound(m_cumulative_weights.begin(),
+                                 m_cumulative_weights.end(), weight) -
+                m_cumulative_weights.begin());
+
+            assert(m_window < m_window_ends.size());
+            return m_window_ends[m_window];
+        }
+
+    private:
+
+        /// The type of the value_type distribution
+        typedef boost::random::uniform_int_distribution<value_type>
+            value_type_distribution;
+
+        /// The type of the distribution of the weights
+        typedef boost::random::uniform_int_distribution<uint32_t>
+            weight_distribution;
+
+        /// Distribution that generates random values from a finite field
+        value_type_distribution m_value_distribution;
+
+        /// The random generator
+        boost::random::mt19937 m_random_generator;
+
+        /// The end of each window, exclusive
+        std::vector<uint32_t> m_window_ends;
+
+        /// The sum of the weights up to and including each window
+        std::vector<uint32_t> m_cumulative_weights;
+
+        /// The sum of the weights
+        uint32_t m_total_weight;
+
+        /// The window of the latest generated vector
+        uint32_t m_window;
+
+    };
+}
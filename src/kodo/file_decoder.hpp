@@ -0,0 +1,110 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <string>
+
+#include "object_decoder.hpp"
+#include "file_writer.hpp"
+#include "mmap_file_writer.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief A file decoder creates a number of decoders for a file
+    ///        and writes the blocks to the file as they complete.
+    ///
+    /// Instead of copying every decoded block to a caller buffer the
+    /// blocks are written to the file straight from the decoders, which
+    /// may then be released to the factory. Only the blocks currently
+    /// being decoded are held in memory. The blocks are written with
+    /// the file_writer, or e.g. the mmap_file_writer to keep the caches
+    /// of the decoders.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme,
+        class FileWriter = file_writer<DecoderType>
+    >
+    class file_decoder : public
+            object_decoder
+            <
+                DecoderType,
+                BlockPartitioning
+            >
+    {
+    public:
+
+        /// The object decoder type
+        typedef object_decoder<DecoderType, BlockPartitioning> Super;
+
+        /// The decoder factory type
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+    public:
+
+        /// Constructs a new file decoder
+        /// @param factory the decoder factory to use
+        /// @param filename the file to write, an existing file is
+        ///        truncated
+        /// @param object_size the size in bytes of the file
+        file_decoder(factory &decoder_factory, const std::string &filename,
+                     uint64_t object_size)
+            : Super(decoder_factory, object_size),
+              m_writer(filename, object_size)
+        { }
+
+        /// Writes a complete decoder to the file and releases it
+        /// @param decoder_id the decoder
+        /// @param decoder the decoder built for decoder_id, reset after
+        ///        the data has been written
+        void write(uint32_t decoder_id, pointer &decoder)
+        {
+            assert(decoder_id < Super::decoders());
+            assert(decoder);
+            assert(decoder->is_complete());
+
+            m_writer.write(decoder,
+                           Super::m_partitioning.byte_offset(decoder_id),
+                           Super::m_partitioning.bytes_used(decoder_id));
+
+            decoder.reset();
+        }
+
+        /// Passes a payload to a decoder and writes the decoder to the
+        /// file as soon as it is complete
+        /// @param decoder_id the decoder
+        /// @param decoder the decoder built for decoder_id, reset when
+        ///        it has been written
+        /// @param payload the payload to decode
+        /// @return true if the decoder completed and was written
+        bool decode(uint32_t decoder_id, pointer &decoder, uint8_t *payload)
+        {
+            assert(decoder);
+            assert(payload != 0);
+
+            decoder->decode(payload);
+
+            if(!decoder->is_complete())
+            {
+                return false;
+            }
+
+            write(decoder_id, decoder);
+            return true;
+        }
+
+    private:
+
+        /// The file writer
+        FileWriter m_writer;
+
+    };
+}
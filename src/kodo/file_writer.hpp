@@ -0,0 +1,213 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace kodo
+{
+
+    /// @brief File opened for writing (POSIX), the file is closed when
+    ///        the object is destroyed.
+    ///
+    /// Errors reported by the operating system, e.g. a full disk, are
+    /// thrown as std::system_error.
+    class writable_file : boost::noncopyable
+    {
+    public:
+
+        /// Creates or truncates a file and sets its size
+        /// @param filename The file to write
+        /// @param size The size of the file in bytes
+        /// @throws std::system_error if the file could not be created
+        writable_file(const std::string &filename, uint64_t size)
+            : m_size(size)
+        {
+            m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+            if(m_fd < 0)
+            {
+                throw std::system_error(errno, std::system_category(),
+                                        "open " + filename);
+            }
+
+            if(::ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+            {
+                int error = errno;
+                ::close(m_fd);
+
+                throw std::system_error(error, std::system_category(),
+                                        "ftruncate " + filename);
+            }
+        }
+
+        /// Closes the file
+        ~writable_file()
+        {
+            ::close(m_fd);
+        }
+
+        /// @return The size of the file in bytes
+        uint64_t size() const
+        {
+            return m_size;
+        }
+
+        /// Writes a buffer at a given offset
+        /// @param data The buffer
+        /// @param size The number of bytes to write
+        /// @param offset The offset in bytes into the file
+        /// @throws std::system_error if the buffer could not be written
+        void write(const uint8_t *data, uint32_t size, uint64_t offset)
+        {
+            assert(data != 0);
+            assert(offset + size <= m_size);
+
+            while(size > 0)
+            {
+                ssize_t written = ::pwrite(m_fd, data, size,
+                                           static_cast<off_t>(offset));
+
+                if(written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                if(written < 0)
+                {
+                    throw std::system_error(errno, std::system_category(),
+                                            "pwrite");
+                }
+
+                // A regular file only writes nothing if it cannot grow
+                if(written == 0)
+                {
+                    throw std::system_error(
+                        std::make_error_code(std::errc::no_space_on_device),
+                        "pwrite");
+                }
+
+                data += written;
+                size -= static_cast<uint32_t>(written);
+                offset += static_cast<uint64_t>(written);
+            }
+        }
+
+    private:
+
+        /// The file descriptor
+        int m_fd;
+
+        /// The size of the file in bytes
+        uint64_t m_size;
+
+    };
+
+    /// @ingroup object_data_implementation
+    ///
+    /// @brief The file writer class writes the data of decoders to a
+    ///        local file at a specific offset within the file. This class
+    ///        is the counterpart of the file_reader and can be used in
+    ///        conjunction with object decoders.
+    ///
+    /// The data is written directly from the symbol storage of the
+    /// decoder, symbols which are adjacent in memory, as in the
+    /// deep_symbol_storage, are written in a single call. Once a
+    /// decoder is written it can be released, so the memory used while
+    /// receiving a file is bounded by the number of blocks being decoded.
+    template<class DecoderType>
+    class file_writer
+    {
+    public:
+
+        /// Pointer to the decoders
+        typedef typename DecoderType::pointer pointer;
+
+    public:
+
+        /// Construct a new file writer
+        /// @param filename of the file to write, an existing file is
+        ///        truncated
+        /// @param size the size of the object in bytes
+        /// @throws std::system_error if the file could not be created
+        file_writer(const std::string &filename, uint64_t size)
+            : m_file(boost::make_shared<writable_file>(filename, size))
+        {
+            assert(size > 0);
+        }
+
+        /// @return the size in bytes of the file
+        uint64_t size() const
+        {
+            return m_file->size();
+        }
+
+        /// Writes the data of a complete decoder to the file.
+        /// @param decoder the decoder
+        /// @param offset in bytes into the file
+        /// @param size the number of bytes to write
+        /// @throws std::system_error if the data could not be written
+        void write(const pointer &decoder, uint64_t offset, uint32_t size)
+        {
+            assert(decoder);
+            assert(decoder->is_complete());
+            assert(offset < m_file->size());
+            assert(size > 0);
+            assert(size <= decoder->block_size());
+
+            uint64_t remaining_bytes = m_file->size() - offset;
+            assert(size <= remaining_bytes);
+            (void) remaining_bytes;
+
+            uint32_t symbol_size = decoder->symbol_size();
+
+            // The current run of symbols which are adjacent in memory
+            const uint8_t *run = decoder->symbol(0);
+            uint32_t run_size = 0;
+
+            for(uint32_t i = 0; size > 0; ++i)
+            {
+                const uint8_t *symbol = decoder->symbol(i);
+                uint32_t symbol_bytes = std::min(size, symbol_size);
+
+                if(symbol != run + run_size)
+                {
+                    m_file->write(run, run_size, offset);
+
+                    offset += run_size;
+                    run = symbol;
+                    run_size = 0;
+                }
+
+                run_size += symbol_bytes;
+                size -= symbol_bytes;
+            }
+
+            m_file->write(run, run_size, offset);
+        }
+
+    private:
+
+        /// The file
+        boost::shared_ptr<writable_file> m_file;
+
+    };
+
+}
@@ -86,6 +86,25 @@ namespace kodo
             (void) the_factory;
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            // This is the final factory layer so there is no state
+            return 0;
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            return buffer;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            return buffer;
+        }
+
     protected:
 
         /// Constructor
@@ -6,11 +6,20 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 
-#include <sak/resource_pool.hpp>
+#include "coder_slab.hpp"
+#include "memory_pressure.hpp"
 
 namespace kodo
 {
@@ -19,6 +28,28 @@ namespace kodo
     /// Terminates the layered coder and contains the coder final
     /// factory. The pool factory uses a memory pool to recycle
     /// encoders/decoders, and thereby minimize memory consumption.
+    ///
+    /// Building a coder from the pool does not allocate: the unused
+    /// coders are kept in a vector with room for every coder of the
+    /// factory, and the control blocks of the returned shared pointers
+    /// are recycled by the pool as well.
+    ///
+    /// With coder_pool::enable_slabs() every coder is placed in a
+    /// coder_slab together with the buffers its layers allocate with the
+    /// slab_allocator during the construction, e.g. the symbol and
+    /// coefficient storage of the slab_full_rlnc_decoder. The slabs are
+    /// sized from the memory requested by the coders built before, a
+    /// coder which did not fit its slab, e.g. the first one, is
+    /// constructed again in a larger slab.
+    ///
+    /// By default the pool keeps every coder it created. After a peak
+    /// of coders in use the memory may be returned with
+    /// coder_pool::shrink(), with coder_pool::trim() called
+    /// periodically, which deletes the coders unused since the last
+    /// call, or by limiting the unused coders with
+    /// coder_pool::set_max_unused(). With
+    /// factory::release_on_memory_pressure() the pool shrinks when
+    /// memory_pressure::signal() is called.
     template<class FinalType>
     class final_coder_factory_pool
     {
@@ -27,6 +58,464 @@ namespace kodo
         /// Pointer type to the constructed coder
         typedef boost::shared_ptr<FinalType> pointer;
 
+        /// The pool of the coders built by a factory
+        class coder_pool
+        {
+        public:
+
+            /// Constructor
+            coder_pool()
+                : m_total_resources(0),
+                  m_max_unused(std::numeric_limits<uint32_t>::max()),
+                  m_low_water(0),
+                  m_block_size(0),
+                  m_open(true),
+                  m_slabs(false),
+                  m_slab_size(0)
+            { }
+
+            /// Destructor, deletes the unused coders and control blocks
+            ~coder_pool()
+            {
+                close();
+
+                for(void *block : m_blocks)
+                {
+                    ::operator delete(block);
+                }
+            }
+
+            /// @return The number of coders created by the pool
+            uint32_t total_resources() const
+            {
+                return m_total_resources;
+            }
+
+            /// @return The number of coders currently in the pool
+            uint32_t unused_resources() const
+            {
+                return static_cast<uint32_t>(m_unused.size());
+            }
+
+            /// Deletes the unused coders
+            void free_unused_resources()
+            {
+                shrink(0);
+            }
+
+            /// Deletes unused coders, the ones released the longest time
+            /// ago first
+            /// @param keep The number of unused coders to keep
+            /// @return The number of coders deleted
+            uint32_t shrink(uint32_t keep)
+            {
+                if(unused_resources() <= keep)
+                {
+                    return 0;
+                }
+
+                uint32_t count = unused_resources() - keep;
+
+                // The coders are reused from the back, so the ones at
+                // the front have been unused the longest
+                for(uint32_t i = 0; i < count; ++i)
+                {
+                    destroy(m_unused[i]);
+                }
+
+                m_unused.erase(m_unused.begin(), m_unused.begin() + count);
+                m_total_resources -= count;
+
+                // The control blocks of the deleted coders are not
+                // needed either
+                while(m_blocks.size() > m_total_resources)
+                {
+                    ::operator delete(m_blocks.back());
+                    m_blocks.pop_back();
+                }
+
+                m_low_water = std::min(m_low_water, unused_resources());
+
+                return count;
+            }
+
+            /// Deletes the coders which stayed unused since the previous
+            /// call. Called periodically, e.g. once a minute, the pool
+            /// follows the number of coders in use over that period.
+            /// @return The number of coders deleted
+            uint32_t trim()
+            {
+                // The low water mark of the unused coders is the number
+                // of coders at the front which were not used
+                uint32_t deleted = shrink(unused_resources() - m_low_water);
+                m_low_water = unused_resources();
+
+                return deleted;
+            }
+
+            /// Limits the number of unused coders, coders released
+            /// while the limit is reached are deleted
+            /// @param max_unused The maximum number of unused coders
+            void set_max_unused(uint32_t max_unused)
+            {
+                m_max_unused = max_unused;
+                shrink(max_unused);
+            }
+
+            /// @return The maximum number of unused coders
+            uint32_t max_unused() const
+            {
+                return m_max_unused;
+            }
+
+            /// @return An unused coder or null if the pool is empty
+            FinalType* pop()
+            {
+                if(m_unused.empty())
+                {
+                    return 0;
+                }
+
+                FinalType *coder = m_unused.back();
+                m_unused.pop_back();
+
+                m_low_water = std::min(m_low_water, unused_resources());
+
+                return coder;
+            }
+
+            /// Registers a new coder, which will be returned to the
+            /// pool
+            void add_resource()
+            {
+                ++m_total_resources;
+
+                m_unused.reserve(m_total_resources);
+                m_blocks.reserve(m_total_resources);
+            }
+
+            /// Returns a released coder to the pool, or deletes it if
+            /// the factory no longer exists
+            /// @param coder The coder
+            void push(FinalType *coder)
+            {
+                assert(coder != 0);
+
+                if(!m_open || unused_resources() >= m_max_unused)
+                {
+                    destroy(coder);
+                    --m_total_resources;
+                    return;
+                }
+
+                m_unused.push_back(coder);
+            }
+
+            /// Deletes the unused coders, the coders released later are
+            /// deleted as well
+            void close()
+            {
+                free_unused_resources();
+                m_open = false;
+            }
+
+            /// Places the coders constructed afterwards in slabs, must be
+            /// called before the first coder is constructed
+            void enable_slabs()
+            {
+                assert(m_total_resources == 0);
+                m_slabs = true;
+            }
+
+            /// @return True if the coders are placed in slabs
+            bool uses_slabs() const
+            {
+                return m_slabs;
+            }
+
+            /// @return The size in bytes of the slabs of the coders
+            ///         constructed next, zero before the first coder
+            std::size_t slab_size() const
+            {
+                return m_slab_size;
+            }
+
+            /// Constructs a coder, in a slab if slabs are enabled
+            /// @param the_factory The factory constructing the coder
+            /// @return The coder
+            template<class Factory>
+            FinalType* make_coder(Factory &the_factory)
+            {
+                if(!m_slabs)
+                {
+                    // The buffers of a coder without a slab must not
+                    // be taken from a slab active further up
+                    coder_slab::scope heap(0);
+
+                    std::unique_ptr<FinalType> coder(new FinalType());
+                    coder->construct(the_factory);
+
+                    return coder.release();
+                }
+
+                static_assert(
+                    std::alignment_of<FinalType>::value <=
+                    coder_slab::alignment,
+                    "The coder must fit the alignment of the slab");
+
+                while(true)
+                {
+                    std::size_t size = std::max<std::size_t>(
+                        m_slab_size, sizeof(FinalType));
+
+                    coder_slab *slab = coder_slab::create(size);
+                    FinalType *coder = construct_in_slab(slab, the_factory);
+
+                    // The next slabs hold everything this coder requested
+                    m_slab_size = std::max(m_slab_size, slab->requested());
+
+                    if(slab->requested() <= slab->capacity())
+                    {
+                        return coder;
+                    }
+
+                    // Some buffers did not fit, e.g. for the first coder
+                    // which sizes the slabs, so the coder is constructed
+                    // again in a slab of the size now known. Otherwise
+                    // the undersized coder would stay in the pool.
+                    destroy(coder);
+                }
+            }
+
+            /// @param size The size of the control block
+            /// @return Memory for the control block of a coder
+            void* allocate_block(std::size_t size)
+            {
+                if(m_block_size == 0)
+                {
+                    m_block_size = size;
+                }
+
+                if(size != m_block_size || m_blocks.empty())
+                {
+                    return ::operator new(size);
+                }
+
+                void *block = m_blocks.back();
+                m_blocks.pop_back();
+
+                return block;
+            }
+
+            /// Returns the memory of a control block to the pool
+            /// @param block The memory of the control block
+            /// @param size The size of the control block
+            void deallocate_block(void *block, std::size_t size)
+            {
+                if(size != m_block_size)
+                {
+                    ::operator delete(block);
+                    return;
+                }
+
+                m_blocks.push_back(block);
+            }
+
+        private:
+
+            /// Constructs a coder at the start of a slab, the buffers
+            /// the layers allocate during the construction are taken
+            /// from the slab as far as they fit
+            /// @param slab The slab, which is destroyed on failure
+            /// @param the_factory The factory constructing the coder
+            /// @return The coder
+            template<class Factory>
+            FinalType* construct_in_slab(coder_slab *slab,
+                                         Factory &the_factory)
+            {
+                void *memory = slab->allocate(sizeof(FinalType));
+                assert(memory != 0);
+
+                FinalType *coder = 0;
+
+                try
+                {
+                    coder_slab::scope active(slab);
+
+                    coder = new (memory) FinalType();
+                    coder->construct(the_factory);
+                }
+                catch(...)
+                {
+                    if(coder)
+                    {
+                        coder->~FinalType();
+                    }
+
+                    coder_slab::destroy(slab);
+                    throw;
+                }
+
+                return coder;
+            }
+
+            /// Deletes a coder constructed by make_coder()
+            /// @param coder The coder
+            void destroy(FinalType *coder)
+            {
+                if(!m_slabs)
+                {
+                    delete coder;
+                    return;
+                }
+
+                coder_slab *slab = coder_slab::from_first(coder);
+
+                coder->~FinalType();
+                coder_slab::destroy(slab);
+            }
+
+        private:
+
+            /// The unused coders
+            std::vector<FinalType*> m_unused;
+
+            /// The unused control blocks
+            std::vector<void*> m_blocks;
+
+            /// The number of coders created and not deleted
+            uint32_t m_total_resources;
+
+            /// The maximum number of unused coders
+            uint32_t m_max_unused;
+
+            /// The lowest number of unused coders since the last trim()
+            uint32_t m_low_water;
+
+            /// The size of the recycled control blocks
+            std::size_t m_block_size;
+
+            /// False once the factory is destroyed
+            bool m_open;
+
+            /// True if the coders are placed in slabs
+            bool m_slabs;
+
+            /// The size of the next slab
+            std::size_t m_slab_size;
+
+        };
+
+        /// Allocator of the control blocks of the shared pointers,
+        /// which keeps the pool alive until the last coder is released
+        template<class T>
+        class block_allocator
+        {
+        public:
+
+            /// @copydoc std::allocator::value_type
+            typedef T value_type;
+
+            /// @copydoc std::allocator::pointer
+            typedef T* pointer;
+
+            /// @copydoc std::allocator::const_pointer
+            typedef const T* const_pointer;
+
+            /// @copydoc std::allocator::reference
+            typedef T& reference;
+
+            /// @copydoc std::allocator::const_reference
+            typedef const T& const_reference;
+
+            /// @copydoc std::allocator::size_type
+            typedef std::size_t size_type;
+
+            /// @copydoc std::allocator::difference_type
+            typedef std::ptrdiff_t difference_type;
+
+            /// @copydoc std::allocator::rebind
+            template<class U>
+            struct rebind
+            {
+                typedef block_allocator<U> other;
+            };
+
+        public:
+
+            /// Constructor
+            /// @param pool The pool of the control blocks
+            block_allocator(const boost::shared_ptr<coder_pool> &pool)
+                : m_pool(pool)
+            { }
+
+            /// Converting constructor used by the rebind
+            template<class U>
+            block_allocator(const block_allocator<U> &other)
+                : m_pool(other.m_pool)
+            { }
+
+            /// @param n The number of objects
+            /// @return Memory for the objects
+            T* allocate(std::size_t n, const void* = 0)
+            {
+                return static_cast<T*>(m_pool->allocate_block(n * sizeof(T)));
+            }
+
+            /// @param p The memory of the objects
+            /// @param n The number of objects
+            void deallocate(T *p, std::size_t n)
+            {
+                m_pool->deallocate_block(p, n * sizeof(T));
+            }
+
+            /// @return True if the allocators use the same pool
+            template<class U>
+            bool operator==(const block_allocator<U> &other) const
+            {
+                return m_pool == other.m_pool;
+            }
+
+            /// @return True if the allocators use different pools
+            template<class U>
+            bool operator!=(const block_allocator<U> &other) const
+            {
+                return m_pool != other.m_pool;
+            }
+
+        public:
+
+            /// The pool of the control blocks
+            boost::shared_ptr<coder_pool> m_pool;
+
+        };
+
+        /// Deleter returning the coders to the pool, the pool is kept
+        /// alive by the allocator of the control block
+        class recycler
+        {
+        public:
+
+            /// Constructor
+            /// @param pool The pool the coder is returned to
+            recycler(coder_pool *pool)
+                : m_pool(pool)
+            { }
+
+            /// Releases the coder
+            /// @param coder The coder
+            void operator()(FinalType *coder) const
+            {
+                m_pool->push(coder);
+            }
+
+        private:
+
+            /// The pool the coder belongs to
+            coder_pool *m_pool;
+
+        };
+
         /// @ingroup factory_layers
         /// The final factory
         class factory
@@ -38,34 +527,104 @@ namespace kodo
 
             /// @copydoc layer::factory::factory(uint32_t,uint32_t)
             factory(uint32_t max_symbols, uint32_t max_symbol_size) :
-                m_pool(boost::bind(&factory::make_coder, this))
+                m_pool(boost::make_shared<coder_pool>()),
+                m_pressure(memory_pressure::no_subscription)
             {
                 (void) max_symbols;
                 (void) max_symbol_size;
             }
 
+            /// Destructor, the coders still in use are deleted when
+            /// they are released
+            ~factory()
+            {
+                if(m_pressure != memory_pressure::no_subscription)
+                {
+                    memory_pressure::unsubscribe(m_pressure);
+                }
+
+                m_pool->close();
+            }
+
+            /// Shrinks the pool when memory_pressure::signal() is
+            /// called, which must be on the thread using the factory
+            /// @param keep The number of unused coders to keep
+            void release_on_memory_pressure(uint32_t keep = 0)
+            {
+                if(m_pressure != memory_pressure::no_subscription)
+                {
+                    memory_pressure::unsubscribe(m_pressure);
+                }
+
+                coder_pool *pool = m_pool.get();
+
+                m_pressure = memory_pressure::subscribe(
+                    [pool, keep]() { pool->shrink(keep); });
+            }
+
             /// @copydoc layer::factory::build()
             pointer build()
             {
                 factory_type *this_factory =
                     static_cast<factory_type*>(this);
 
-                pointer coder = m_pool.allocate();
+                FinalType *unused = m_pool->pop();
+
+                if(!unused)
+                {
+                    unused = make_coder();
+                }
+
+                pointer coder(unused, recycler(m_pool.get()),
+                              block_allocator<FinalType>(m_pool));
+
                 coder->initialize(*this_factory);
 
                 return coder;
             }
 
+            /// Constructs coders up front so that at least a number of
+            /// unused coders are ready in the pool. The construction
+            /// allocates and writes all the memory of a coder, so a
+            /// later build() only initializes a recycled coder and does
+            /// not stall on allocations and page faults.
+            /// @param coders The number of unused coders to keep ready
+            void reserve(uint32_t coders)
+            {
+                // The pool does not keep more unused coders
+                coders = std::min(coders, m_pool->max_unused());
+
+                while(m_pool->unused_resources() < coders)
+                {
+                    m_pool->push(make_coder());
+                }
+
+                // Warm up the control blocks of the coders, so the
+                // first builds do not allocate them
+                std::vector<pointer> reserved;
+                reserved.reserve(coders);
+
+                for(uint32_t i = 0; i < coders; ++i)
+                {
+                    FinalType *unused = m_pool->pop();
+                    assert(unused != 0);
+
+                    reserved.push_back(pointer(unused,
+                        recycler(m_pool.get()),
+                        block_allocator<FinalType>(m_pool)));
+                }
+            }
+
             /// @return A reference to the internal resource pool
-            const sak::resource_pool<FinalType>& pool() const
+            const coder_pool& pool() const
             {
-                return m_pool;
+                return *m_pool;
             }
 
             /// @return A reference to the internal resource pool
-            sak::resource_pool<FinalType>& pool()
+            coder_pool& pool()
             {
-                return m_pool;
+                return *m_pool;
             }
 
 
@@ -79,26 +638,28 @@ namespace kodo
 
         private:
 
-            /// Factory function used by the resource pool to
-            /// build new coders if needed.
-            /// @param max_symbols The maximum symbols that are supported
-            /// @param max_symbol_size The maximum size of a symbol in
-            ///        bytes
-            static pointer make_coder(factory *f_ptr)
+            /// Constructs a new coder, which belongs to the pool
+            /// @return The coder
+            FinalType* make_coder()
             {
                 factory_type *this_factory =
-                    static_cast<factory_type*>(f_ptr);
+                    static_cast<factory_type*>(this);
+
+                FinalType *coder = m_pool->make_coder(*this_factory);
 
-                pointer coder = boost::make_shared<FinalType>();
-                coder->construct(*this_factory);
+                m_pool->add_resource();
 
                 return coder;
             }
 
         private:
 
-            /// Resource pool for the coders
-            sak::resource_pool<FinalType> m_pool;
+            /// Pool for the unused coders, shared with the control
+            /// blocks of the coders
+            boost::shared_ptr<coder_pool> m_pool;
+
+            /// The memory pressure subscription, if any
+            uint32_t m_pressure;
 
         };
 
@@ -120,6 +681,25 @@ namespace kodo
             (void) the_factory;
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            // This is the final factory layer so there is no state
+            return 0;
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            return buffer;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            return buffer;
+        }
+
     protected:
 
         /// Constructor
@@ -0,0 +1,605 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup factory_layers
+    /// Terminates the layered coder and contains the coder final
+    /// factory. Like the final_coder_factory_pool the factory recycles
+    /// encoders/decoders, but the pool may be used from several threads
+    /// at the same time. This allows a single factory, and thereby a
+    /// single copy of e.g. the finite field tables, to serve all the
+    /// worker threads of an application.
+    ///
+    /// Unused coders are kept in a number of shards, each thread is
+    /// assigned one shard, so threads building and releasing coders
+    /// normally do not compete for the same lock. When the shard of a
+    /// thread is full, released coders go to a lock-free overflow stack
+    /// shared by all threads, which is also where a thread looks for a
+    /// coder if its own shard is empty. Every coder has a node linking
+    /// it in the overflow stack, allocated once with the coder, so
+    /// building and releasing coders does not allocate once the pool
+    /// is warm. A coder released on a different thread than the one
+    /// which built it is returned to the shard of the releasing thread.
+    ///
+    /// Only build() may be called concurrently, changing the factory
+    /// e.g. using set_symbols() must be done while no other thread
+    /// builds coders. The layers of the stack must also not change the
+    /// factory in layer::construct(Factory&) or
+    /// layer::initialize(Factory&), which rules out e.g. the
+    /// payload_recoder layer.
+    template<class FinalType>
+    class final_coder_factory_sharded_pool
+    {
+    public:
+
+        /// Pointer type to the constructed coder
+        typedef boost::shared_ptr<FinalType> pointer;
+
+        /// The pool storing the unused coders
+        class coder_pool
+        {
+        public:
+
+            /// The number of shards
+            static const uint32_t shards = 16;
+
+            /// The maximum number of coders kept in a shard, further
+            /// coders go to the overflow stack
+            static const uint32_t shard_capacity = 8;
+
+            /// The number of nodes allocated at a time
+            static const uint32_t chunk_size = 64;
+
+            /// The maximum number of chunks, which bounds the number of
+            /// pooled coders to chunk_size * max_chunks. Coders built
+            /// beyond that are not pooled but deleted when released.
+            static const uint32_t max_chunks = 1024;
+
+            /// The index of a node, see coder_pool::node_at()
+            typedef uint32_t node_index;
+
+            /// The index of no node
+            static node_index no_node()
+            {
+                return 0xffffffffU;
+            }
+
+        public:
+
+            /// Constructor
+            coder_pool()
+                : m_overflow(no_node()),
+                  m_nodes(0),
+                  m_total_coders(0),
+                  m_unused_coders(0)
+            {
+                for(uint32_t i = 0; i < max_chunks; ++i)
+                {
+                    m_chunks[i].store(0, std::memory_order_relaxed);
+                }
+            }
+
+            /// Destructor, deletes the unused coders and the nodes
+            ~coder_pool()
+            {
+                for(uint32_t i = 0; i < shards; ++i)
+                {
+                    for(node_index index : m_shards[i].m_nodes)
+                    {
+                        delete node_at(index)->m_coder;
+                    }
+                }
+
+                node_index index = top(m_overflow.load());
+
+                while(index != no_node())
+                {
+                    node *n = node_at(index);
+                    delete n->m_coder;
+                    index = n->m_next.load();
+                }
+
+                for(uint32_t i = 0; i < max_chunks; ++i)
+                {
+                    delete[] m_chunks[i].load();
+                }
+            }
+
+            /// Registers a new coder, the node of the coder is kept with
+            /// the coder until the pool is destroyed
+            /// @param coder The coder
+            /// @return The node of the coder or no_node() if all nodes
+            ///         are in use, in which case the coder is not
+            ///         registered
+            node_index add_coder(FinalType *coder)
+            {
+                assert(coder != 0);
+
+                std::lock_guard<std::mutex> lock(m_nodes_mutex);
+
+                node_index index = m_nodes;
+                uint32_t chunk = index / chunk_size;
+
+                // Too many coders in use at the same time, the chunk
+                // table cannot grow since other threads read it
+                // without holding the lock
+                if(chunk >= max_chunks)
+                {
+                    return no_node();
+                }
+
+                if(index % chunk_size == 0)
+                {
+                    m_chunks[chunk].store(new node[chunk_size],
+                                          std::memory_order_release);
+                }
+
+                node_at(index)->m_coder = coder;
+
+                ++m_nodes;
+                ++m_total_coders;
+
+                return index;
+            }
+
+            /// @param index The node of a coder
+            /// @return The coder
+            FinalType* coder(node_index index) const
+            {
+                return node_at(index)->m_coder;
+            }
+
+            /// @return The node of an unused coder or no_node() if the
+            ///         pool is empty
+            node_index pop()
+            {
+                shard &s = m_shards[shard_index()];
+
+                {
+                    std::lock_guard<std::mutex> lock(s.m_mutex);
+
+                    if(!s.m_nodes.empty())
+                    {
+                        node_index index = s.m_nodes.back();
+                        s.m_nodes.pop_back();
+
+                        --m_unused_coders;
+                        return index;
+                    }
+                }
+
+                // The tag of the top is changed by every push and pop,
+                // so a top which was popped and pushed again since it
+                // was read fails the exchange, i.e. the stack does not
+                // suffer from the ABA problem. The nodes are never
+                // freed while the pool exists, so reading the next node
+                // of a node popped by another thread is safe.
+                uint64_t head = m_overflow.load(std::memory_order_acquire);
+
+                while(top(head) != no_node())
+                {
+                    node_index index = top(head);
+                    node_index next =
+                        node_at(index)->m_next.load(
+                            std::memory_order_relaxed);
+
+                    if(m_overflow.compare_exchange_weak(
+                           head, make_head(head, next),
+                           std::memory_order_acquire,
+                           std::memory_order_acquire))
+                    {
+                        --m_unused_coders;
+                        return index;
+                    }
+                }
+
+                return no_node();
+            }
+
+            /// Returns an unused coder to the pool
+            /// @param index The node of the coder
+            void push(node_index index)
+            {
+                assert(index != no_node());
+
+                ++m_unused_coders;
+
+                shard &s = m_shards[shard_index()];
+
+                {
+                    std::lock_guard<std::mutex> lock(s.m_mutex);
+
+                    if(s.m_nodes.size() < shard_capacity)
+                    {
+                        s.m_nodes.push_back(index);
+                        return;
+                    }
+                }
+
+                node *n = node_at(index);
+                uint64_t head = m_overflow.load(std::memory_order_relaxed);
+
+                do
+                {
+                    n->m_next.store(top(head), std::memory_order_relaxed);
+                }
+                while(!m_overflow.compare_exchange_weak(
+                          head, make_head(head, index),
+                          std::memory_order_release,
+                          std::memory_order_relaxed));
+            }
+
+            /// @return The number of coders created by the pool
+            uint32_t total_coders() const
+            {
+                return m_total_coders;
+            }
+
+            /// @return The number of coders currently in the pool
+            uint32_t unused_coders() const
+            {
+                return m_unused_coders;
+            }
+
+        private:
+
+            /// Node of a coder, linking it in the overflow stack
+            struct node
+            {
+                /// Constructor
+                node()
+                    : m_coder(0),
+                      m_next(no_node())
+                { }
+
+                /// The coder
+                FinalType *m_coder;
+
+                /// The next node in the overflow stack
+                std::atomic<node_index> m_next;
+            };
+
+            /// The unused coders of a shard
+            struct shard
+            {
+                /// Constructor
+                shard()
+                {
+                    m_nodes.reserve(shard_capacity);
+                }
+
+                /// Protects the coders
+                std::mutex m_mutex;
+
+                /// The nodes of the unused coders
+                std::vector<node_index> m_nodes;
+
+                /// Padding to avoid false sharing between the shards
+                uint8_t m_padding[64];
+            };
+
+        private:
+
+            /// @param index The index of a node
+            /// @return The node
+            node* node_at(node_index index) const
+            {
+                assert(index != no_node());
+
+                node *chunk = m_chunks[index / chunk_size].load(
+                    std::memory_order_acquire);
+
+                assert(chunk != 0);
+                return chunk + index % chunk_size;
+            }
+
+            /// @param head The top of the overflow stack and its tag
+            /// @return The node at the top
+            static node_index top(uint64_t head)
+            {
+                return static_cast<node_index>(head);
+            }
+
+            /// @param head The current top of the overflow stack
+            /// @param index The node of the new top
+            /// @return The new top with the next tag
+            static uint64_t make_head(uint64_t head, node_index index)
+            {
+                uint64_t tag = (head >> 32) + 1;
+                return (tag << 32) | index;
+            }
+
+            /// @return The shard of the calling thread, threads are
+            ///         assigned a shard in a round robin fashion the
+            ///         first time they use a pool
+            static uint32_t shard_index()
+            {
+                static std::atomic<uint32_t> next_index(0);
+                static thread_local uint32_t index = next_index++ % shards;
+
+                return index;
+            }
+
+        private:
+
+            /// The shards
+            shard m_shards[shards];
+
+            /// The top of the overflow stack in the low 32 bits and a
+            /// tag counting the changes of the top in the high 32 bits
+            std::atomic<uint64_t> m_overflow;
+
+            /// The chunks of nodes
+            std::atomic<node*> m_chunks[max_chunks];
+
+            /// Protects the allocation of nodes
+            std::mutex m_nodes_mutex;
+
+            /// The number of nodes allocated
+            uint32_t m_nodes;
+
+            /// The number of coders created
+            std::atomic<uint32_t> m_total_coders;
+
+            /// The number of coders in the pool
+            std::atomic<uint32_t> m_unused_coders;
+
+        };
+
+        /// Deleter used for the coders, returning them to the pool or
+        /// deleting them if the pool no longer exists or the coder has
+        /// no node in the pool
+        class recycler
+        {
+        public:
+
+            /// Constructor
+            /// @param pool The pool the coder should be returned to
+            /// @param index The node of the coder in the pool or
+            ///        coder_pool::no_node() if the coder is not pooled
+            recycler(const boost::shared_ptr<coder_pool> &pool,
+                     typename coder_pool::node_index index)
+                : m_pool(pool),
+                  m_index(index)
+            { }
+
+            /// Releases the coder
+            /// @param coder The coder
+            void operator()(FinalType *coder) const
+            {
+                if(m_index == coder_pool::no_node())
+                {
+                    delete coder;
+                }
+                else if(boost::shared_ptr<coder_pool> pool = m_pool.lock())
+                {
+                    assert(pool->coder(m_index) == coder);
+                    pool->push(m_index);
+                }
+                else
+                {
+                    delete coder;
+                }
+            }
+
+        private:
+
+            /// The pool the coder belongs to
+            boost::weak_ptr<coder_pool> m_pool;
+
+            /// The node of the coder in the pool
+            typename coder_pool::node_index m_index;
+
+        };
+
+        /// @ingroup factory_layers
+        /// The final factory
+        class factory
+        {
+        public:
+
+            /// The factory type
+            typedef typename FinalType::factory factory_type;
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size) :
+                m_pool(boost::make_shared<coder_pool>())
+            {
+                (void) max_symbols;
+                (void) max_symbol_size;
+            }
+
+            /// @copydoc layer::factory::build()
+            pointer build()
+            {
+                factory_type *this_factory =
+                    static_cast<factory_type*>(this);
+
+                typename coder_pool::node_index index = m_pool->pop();
+
+                FinalType *new_coder = 0;
+
+                if(index == coder_pool::no_node())
+                {
+                    new_coder = create_coder(index);
+                }
+                else
+                {
+                    new_coder = m_pool->coder(index);
+                }
+
+                pointer coder(new_coder, recycler(m_pool, index));
+
+                coder->initialize(*this_factory);
+
+                return coder;
+            }
+
+            /// Constructs coders up front so that at least a number of
+            /// unused coders are ready in the pool, see
+            /// final_coder_factory_pool::factory::reserve(uint32_t). The
+            /// coders are placed in the shard of the calling thread and
+            /// the overflow stack, so they are available to all threads.
+            /// @param coders The number of unused coders to keep ready
+            void reserve(uint32_t coders)
+            {
+                std::vector<typename coder_pool::node_index> reserved;
+                reserved.reserve(coders);
+
+                while(reserved.size() < coders)
+                {
+                    typename coder_pool::node_index index = m_pool->pop();
+
+                    if(index == coder_pool::no_node())
+                    {
+                        break;
+                    }
+
+                    reserved.push_back(index);
+                }
+
+                while(reserved.size() < coders)
+                {
+                    typename coder_pool::node_index index;
+                    FinalType *new_coder = create_coder(index);
+
+                    // The pool is full, so the coder could not be kept
+                    if(index == coder_pool::no_node())
+                    {
+                        delete new_coder;
+                        break;
+                    }
+
+                    reserved.push_back(index);
+                }
+
+                for(typename coder_pool::node_index index : reserved)
+                {
+                    m_pool->push(index);
+                }
+            }
+
+            /// @return The number of coders created by the factory
+            uint32_t total_coders() const
+            {
+                return m_pool->total_coders();
+            }
+
+            /// @return The number of coders available for reuse
+            uint32_t unused_coders() const
+            {
+                return m_pool->unused_coders();
+            }
+
+        private:
+
+            /// Constructs a new coder
+            /// @param index Set to the node of the coder in the pool or
+            ///        coder_pool::no_node() if the pool is full and the
+            ///        coder is not pooled
+            /// @return The coder
+            FinalType* create_coder(typename coder_pool::node_index &index)
+            {
+                factory_type *this_factory =
+                    static_cast<factory_type*>(this);
+
+                std::unique_ptr<FinalType> new_coder(new FinalType());
+                new_coder->construct(*this_factory);
+
+                index = m_pool->add_coder(new_coder.get());
+
+                return new_coder.release();
+            }
+
+        private: // Make non-copyable
+
+            /// Copy constructor
+            factory(const factory&);
+
+            /// Copy assignment
+            const factory& operator=(const factory&);
+
+        private:
+
+            /// Pool for the unused coders, shared with the deleters of
+            /// the coders
+            boost::shared_ptr<coder_pool> m_pool;
+
+        };
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory& the_factory)
+        {
+            // This is the final factory layer so we do nothing
+            (void) the_factory;
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            // This is the final factory layer so we do nothing
+            (void) the_factory;
+        }
+
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            // This is the final factory layer so there is no state
+            return 0;
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            return buffer;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            return buffer;
+        }
+
+    protected:
+
+        /// Constructor
+        final_coder_factory_sharded_pool()
+        { }
+
+        /// Destructor
+        ~final_coder_factory_sharded_pool()
+        { }
+
+    private: // Make non-copyable
+
+        /// Copy constructor
+        final_coder_factory_sharded_pool(
+            const final_coder_factory_sharded_pool&);
+
+        /// Copy assignment
+        const final_coder_factory_sharded_pool& operator=(
+            const final_coder_factory_sharded_pool&);
+
+    };
+}
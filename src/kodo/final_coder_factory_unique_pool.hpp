@@ -0,0 +1,441 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @ingroup factory_layers
+    /// Terminates the layered coder and contains the coder final
+    /// factory. Like the final_coder_factory_pool the factory recycles
+    /// encoders/decoders, but build() returns a move-only handle
+    /// instead of a boost::shared_ptr. The handle holds the coder and
+    /// its pool, and returns the coder to the pool when destroyed, so
+    /// building and releasing a coder needs neither a control block nor
+    /// atomic reference counting.
+    ///
+    /// The reference count of the pool is not atomic, so like the
+    /// final_coder_factory_pool the factory and the handles must be
+    /// used from a single thread at a time. The handles may outlive
+    /// the factory, the coders are then deleted when released.
+    ///
+    /// The layers of the stack must not copy the pointer type, which
+    /// rules out e.g. the payload_recoder layer and the layers
+    /// converting the pointer to a boost::shared_ptr in their factory.
+    template<class FinalType>
+    class final_coder_factory_unique_pool
+    {
+    public:
+
+        /// The pool storing the unused coders, which is deleted when
+        /// the factory and every handle have released it
+        class coder_pool
+        {
+        public:
+
+            /// Constructor, the factory holds the first reference
+            coder_pool()
+                : m_references(1),
+                  m_total_coders(0),
+                  m_open(true)
+            { }
+
+            /// Destructor, deletes the unused coders
+            ~coder_pool()
+            {
+                for(FinalType *coder : m_unused)
+                {
+                    delete coder;
+                }
+            }
+
+            /// Adds a reference to the pool
+            void acquire()
+            {
+                ++m_references;
+            }
+
+            /// Removes a reference, the pool is deleted with the last
+            /// reference
+            void release()
+            {
+                assert(m_references > 0);
+
+                if(--m_references == 0)
+                {
+                    delete this;
+                }
+            }
+
+            /// @return An unused coder or null if the pool is empty
+            FinalType* pop()
+            {
+                if(m_unused.empty())
+                {
+                    return 0;
+                }
+
+                FinalType *coder = m_unused.back();
+                m_unused.pop_back();
+
+                return coder;
+            }
+
+            /// Returns a released coder to the pool, or deletes it if
+            /// the factory no longer exists
+            /// @param coder The coder
+            void push(FinalType *coder)
+            {
+                assert(coder != 0);
+
+                if(!m_open)
+                {
+                    delete coder;
+                    return;
+                }
+
+                m_unused.push_back(coder);
+            }
+
+            /// Registers that a new coder was created, the unused
+            /// coders always fit in the pool without allocating
+            void add_coder()
+            {
+                ++m_total_coders;
+                m_unused.reserve(m_total_coders);
+            }
+
+            /// Deletes the unused coders, the coders released later are
+            /// deleted as well
+            void close()
+            {
+                for(FinalType *coder : m_unused)
+                {
+                    delete coder;
+                }
+
+                m_unused.clear();
+                m_open = false;
+            }
+
+            /// @return The number of coders created by the pool
+            uint32_t total_coders() const
+            {
+                return m_total_coders;
+            }
+
+            /// @return The number of coders currently in the pool
+            uint32_t unused_coders() const
+            {
+                return static_cast<uint32_t>(m_unused.size());
+            }
+
+        private: // Make non-copyable
+
+            /// Copy constructor
+            coder_pool(const coder_pool&);
+
+            /// Copy assignment
+            const coder_pool& operator=(const coder_pool&);
+
+        private:
+
+            /// The unused coders
+            std::vector<FinalType*> m_unused;
+
+            /// The factory and the handles using the pool
+            uint32_t m_references;
+
+            /// The number of coders created
+            uint32_t m_total_coders;
+
+            /// False once the factory is destroyed
+            bool m_open;
+
+        };
+
+        /// Move-only handle to a built coder, which returns the coder
+        /// to its pool when destroyed or reset
+        class pointer
+        {
+        public:
+
+            /// Constructs an empty handle
+            pointer()
+                : m_coder(0),
+                  m_pool(0)
+            { }
+
+            /// Constructor
+            /// @param coder The coder
+            /// @param pool The pool the coder is returned to
+            pointer(FinalType *coder, coder_pool *pool)
+                : m_coder(coder),
+                  m_pool(pool)
+            {
+                assert(m_coder != 0);
+                assert(m_pool != 0);
+
+                m_pool->acquire();
+            }
+
+            /// Move constructor
+            /// @param other The handle taken over
+            pointer(pointer &&other)
+                : m_coder(other.m_coder),
+                  m_pool(other.m_pool)
+            {
+                other.m_coder = 0;
+                other.m_pool = 0;
+            }
+
+            /// Move assignment, releases the current coder
+            /// @param other The handle taken over
+            pointer& operator=(pointer &&other)
+            {
+                if(this != &other)
+                {
+                    reset();
+
+                    m_coder = other.m_coder;
+                    m_pool = other.m_pool;
+
+                    other.m_coder = 0;
+                    other.m_pool = 0;
+                }
+
+                return *this;
+            }
+
+            /// Destructor, releases the coder
+            ~pointer()
+            {
+                reset();
+            }
+
+            /// Returns the coder to the pool and empties the handle
+            void reset()
+            {
+                if(m_coder == 0)
+                {
+                    return;
+                }
+
+                m_pool->push(m_coder);
+                m_pool->release();
+
+                m_coder = 0;
+                m_pool = 0;
+            }
+
+            /// @return The coder or null if the handle is empty
+            FinalType* get() const
+            {
+                return m_coder;
+            }
+
+            /// @return The coder
+            FinalType* operator->() const
+            {
+                assert(m_coder != 0);
+                return m_coder;
+            }
+
+            /// @return The coder
+            FinalType& operator*() const
+            {
+                assert(m_coder != 0);
+                return *m_coder;
+            }
+
+            /// @return True if the handle holds a coder
+            explicit operator bool() const
+            {
+                return m_coder != 0;
+            }
+
+        private: // Make non-copyable
+
+            /// Copy constructor
+            pointer(const pointer&);
+
+            /// Copy assignment
+            const pointer& operator=(const pointer&);
+
+        private:
+
+            /// The coder
+            FinalType *m_coder;
+
+            /// The pool the coder belongs to
+            coder_pool *m_pool;
+
+        };
+
+        /// @ingroup factory_layers
+        /// The final factory
+        class factory
+        {
+        public:
+
+            /// The factory type
+            typedef typename FinalType::factory factory_type;
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size) :
+                m_pool(new coder_pool())
+            {
+                (void) max_symbols;
+                (void) max_symbol_size;
+            }
+
+            /// Destructor, the coders still in use are deleted when
+            /// they are released
+            ~factory()
+            {
+                m_pool->close();
+                m_pool->release();
+            }
+
+            /// @copydoc layer::factory::build()
+            pointer build()
+            {
+                factory_type *this_factory =
+                    static_cast<factory_type*>(this);
+
+                FinalType *unused = m_pool->pop();
+
+                if(!unused)
+                {
+                    unused = make_coder();
+                }
+
+                pointer coder(unused, m_pool);
+                coder->initialize(*this_factory);
+
+                return coder;
+            }
+
+            /// Constructs coders up front so that at least a number of
+            /// unused coders are ready in the pool, see
+            /// final_coder_factory_pool::factory::reserve(uint32_t)
+            /// @param coders The number of unused coders to keep ready
+            void reserve(uint32_t coders)
+            {
+                while(m_pool->unused_coders() < coders)
+                {
+                    m_pool->push(make_coder());
+                }
+            }
+
+            /// @return The number of coders created by the factory
+            uint32_t total_coders() const
+            {
+                return m_pool->total_coders();
+            }
+
+            /// @return The number of coders available for reuse
+            uint32_t unused_coders() const
+            {
+                return m_pool->unused_coders();
+            }
+
+        private: // Make non-copyable
+
+            /// Copy constructor
+            factory(const factory&);
+
+            /// Copy assignment
+            const factory& operator=(const factory&);
+
+        private:
+
+            /// Constructs a new coder, which belongs to the pool
+            /// @return The coder
+            FinalType* make_coder()
+            {
+                factory_type *this_factory =
+                    static_cast<factory_type*>(this);
+
+                std::unique_ptr<FinalType> coder(new FinalType());
+                coder->construct(*this_factory);
+
+                m_pool->add_coder();
+
+                return coder.release();
+            }
+
+        private:
+
+            /// Pool for the unused coders, shared with the handles
+            coder_pool *m_pool;
+
+        };
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory& the_factory)
+        {
+            // This is the final factory layer so we do nothing
+            (void) the_factory;
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            // This is the final factory layer so we do nothing
+            (void) the_factory;
+        }
+
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            // This is the final factory layer so there is no state
+            return 0;
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            return buffer;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            return buffer;
+        }
+
+    protected:
+
+        /// Constructor
+        final_coder_factory_unique_pool()
+        { }
+
+        /// Destructor
+        ~final_coder_factory_unique_pool()
+        { }
+
+    private: // Make non-copyable
+
+        /// Copy constructor
+        final_coder_factory_unique_pool(
+            const final_coder_factory_unique_pool&);
+
+        /// Copy assignment
+        const final_coder_factory_unique_pool& operator=(
+            const final_coder_factory_unique_pool&);
+
+    };
+}
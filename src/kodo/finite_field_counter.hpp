@@ -7,7 +7,12 @@
 
 #include <cstdint>
 
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "cycle_counter.hpp"
 #include "operations_counter.hpp"
+#include "operations_profile.hpp"
 
 namespace kodo
 {
@@ -15,6 +20,14 @@ namespace kodo
     /// @ingroup debug
     /// This layer "intercepts" all calls to the finite_field_math
     /// layer counting the different operations
+    ///
+    /// Besides the operations_counter the layer records an
+    /// operations_profile with the bytes processed by every operation,
+    /// split into operations on buffers of the symbol length and
+    /// operations on the coefficient vectors. If the coefficient
+    /// vectors have the symbol length they are counted as symbol data.
+    /// Optionally every n'th call of an operation is timed with the
+    /// cycle counter, see set_timing_sample_interval(uint32_t).
     template<class SuperCoder>
     class finite_field_counter : public SuperCoder
     {
@@ -31,14 +44,24 @@ namespace kodo
 
     public:
 
+        /// Constructor
+        finite_field_counter()
+            : m_symbol_length(0),
+              m_timing_sample_interval(0)
+        { }
+
         /// @copydoc layer::initialize(Factory&)
         template<class Factory>
         void initialize(Factory& the_factory)
         {
             SuperCoder::initialize(the_factory);
 
+            m_symbol_length =
+                fifi::size_to_length<field_type>(the_factory.symbol_size());
+
             // Reset the counter
             m_counter = operations_counter();
+            m_profile = operations_profile();
         }
 
         /// @copydoc layer::multiply(value_type*,value_type,uint32_t)
@@ -46,7 +69,12 @@ namespace kodo
                       uint32_t symbol_length)
         {
             ++m_counter.m_multiply;
-            SuperCoder::multiply(symbol_dest, coefficient, symbol_length);
+
+            profile(m_profile.m_multiply, symbol_length, 1, [&]()
+                {
+                    SuperCoder::multiply(symbol_dest, coefficient,
+                                         symbol_length);
+                });
         }
 
         /// @copydoc layer::multipy_add(value_type *, const value_type*,
@@ -56,9 +84,89 @@ namespace kodo
                           value_type coefficient, uint32_t symbol_length)
         {
             ++m_counter.m_multiply_add;
-            SuperCoder::multiply_add(symbol_dest, symbol_src,
-                                     coefficient,
-                                     symbol_length);
+
+            profile(m_profile.m_multiply_add, symbol_length, 1, [&]()
+                {
+                    SuperCoder::multiply_add(symbol_dest, symbol_src,
+                                             coefficient,
+                                             symbol_length);
+                });
+        }
+
+        /// @copydoc layer::multiply_copy(value_type*, const value_type*,
+        ///                              value_type, uint32_t)
+        void multiply_copy(value_type *symbol_dest,
+                           const value_type *symbol_src,
+                           value_type coefficient, uint32_t symbol_length)
+        {
+            ++m_counter.m_multiply;
+
+            profile(m_profile.m_multiply, symbol_length, 1, [&]()
+                {
+                    SuperCoder::multiply_copy(symbol_dest, symbol_src,
+                                              coefficient, symbol_length);
+                });
+        }
+
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(value_type *symbol_dest,
+                                  const value_type **symbols_src,
+                                  const value_type *coefficients,
+                                  uint32_t sources, uint32_t symbol_length)
+        {
+            // Counted as the individual operations it replaces
+            if(fifi::is_binary<field_type>::value)
+            {
+                m_counter.m_add += sources;
+            }
+            else
+            {
+                m_counter.m_multiply_add += sources;
+            }
+
+            operation_profile &operation = fifi::is_binary<field_type>::value
+                ? m_profile.m_add : m_profile.m_multiply_add;
+
+            profile(operation, symbol_length, sources, [&]()
+                {
+                    SuperCoder::multiply_add_sources(
+                        symbol_dest, symbols_src, coefficients, sources,
+                        symbol_length);
+                });
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(value_type *symbol_dest,
+                              const value_type **symbols_src,
+                              const value_type *coefficients,
+                              uint32_t sources, uint32_t symbol_length)
+        {
+            // Counted like multiply_add_sources(), writing the first
+            // source costs at most as much as adding it
+            if(fifi::is_binary<field_type>::value)
+            {
+                m_counter.m_add += sources;
+            }
+            else
+            {
+                m_counter.m_multiply_add += sources;
+            }
+
+            operation_profile &operation = fifi::is_binary<field_type>::value
+                ? m_profile.m_add : m_profile.m_multiply_add;
+
+            profile(operation, symbol_length, sources, [&]()
+                {
+                    SuperCoder::multiply_sources(
+                        symbol_dest, symbols_src, coefficients, sources,
+                        symbol_length);
+                });
         }
 
         /// @copydoc layer::add(value_type*, const value_type *, uint32_t)
@@ -66,7 +174,11 @@ namespace kodo
                  uint32_t symbol_length)
         {
             ++m_counter.m_add;
-            SuperCoder::add(symbol_dest, symbol_src, symbol_length);
+
+            profile(m_profile.m_add, symbol_length, 1, [&]()
+                {
+                    SuperCoder::add(symbol_dest, symbol_src, symbol_length);
+                });
         }
 
         /// @copydoc layer::multiply_subtract(
@@ -78,8 +190,13 @@ namespace kodo
                                uint32_t symbol_length)
         {
             ++m_counter.m_multiply_subtract;
-            SuperCoder::multiply_subtract(symbol_dest, symbol_src,
-                                          coefficient, symbol_length);
+
+            profile(m_profile.m_multiply_subtract, symbol_length, 1, [&]()
+                {
+                    SuperCoder::multiply_subtract(symbol_dest, symbol_src,
+                                                  coefficient,
+                                                  symbol_length);
+                });
         }
 
         /// @copydoc layer::subtract(
@@ -88,8 +205,12 @@ namespace kodo
                       uint32_t symbol_length)
         {
             ++m_counter.m_subtract;
-            SuperCoder::subtract(symbol_dest, symbol_src,
-                                 symbol_length);
+
+            profile(m_profile.m_subtract, symbol_length, 1, [&]()
+                {
+                    SuperCoder::subtract(symbol_dest, symbol_src,
+                                         symbol_length);
+                });
         }
 
         /// @copydoc layer::invert(value_type)
@@ -105,10 +226,67 @@ namespace kodo
             return m_counter;
         }
 
-        /// Reset the operation counter
+        /// @return The operations profile
+        operations_profile get_operations_profile() const
+        {
+            return m_profile;
+        }
+
+        /// Reset the operation counter and the operations profile
         void reset_operations_counter()
         {
             m_counter = operations_counter();
+            m_profile = operations_profile();
+        }
+
+        /// Sets how often the operations are timed, the interval is kept
+        /// when the coder is initialized
+        /// @param interval Every interval'th call of an operation on the
+        ///        symbol data respectively the coefficient vectors is
+        ///        timed, zero disables the timing
+        void set_timing_sample_interval(uint32_t interval)
+        {
+            m_timing_sample_interval = interval;
+        }
+
+        /// @return The interval at which the operations are timed, zero
+        ///         if they are not timed
+        uint32_t timing_sample_interval() const
+        {
+            return m_timing_sample_interval;
+        }
+
+    private:
+
+        /// Records the cost of an operation and invokes it
+        /// @param operation The profile of the operation
+        /// @param symbol_length The length of the destination buffer
+        /// @param sources The number of times the destination is processed
+        /// @param function The function performing the operation
+        template<class Function>
+        void profile(operation_profile &operation, uint32_t symbol_length,
+                     uint32_t sources, const Function &function)
+        {
+            operation_cost &cost = symbol_length == m_symbol_length
+                ? operation.m_symbol : operation.m_coefficient;
+
+            ++cost.m_calls;
+            cost.m_bytes += uint64_t(sources) *
+                fifi::length_to_size<field_type>(symbol_length);
+
+            if(m_timing_sample_interval == 0 ||
+               cost.m_calls % m_timing_sample_interval != 0)
+            {
+                function();
+                return;
+            }
+
+            uint64_t start = read_cycle_counter();
+            function();
+            uint64_t stop = read_cycle_counter();
+
+            ++cost.m_samples;
+            cost.m_sampled_ticks += stop - start;
         }
 
     private:
@@ -116,6 +294,15 @@ namespace kodo
         /// Operations counter
         operations_counter m_counter;
 
+        /// The bytes processed and timings of the operations
+        operations_profile m_profile;
+
+        /// The length of a symbol in field elements
+        uint32_t m_symbol_length;
+
+        /// The interval at which the operations are timed
+        uint32_t m_timing_sample_interval;
+
     };
 
 }
@@ -6,14 +6,23 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
 #include <type_traits>
 
 #include <fifi/arithmetics.hpp>
+#include <fifi/is_binary.hpp>
 #include <fifi/fifi_utils.hpp>
 
+#include "thread_scratch.hpp"
+#include "shared_field.hpp"
+
 namespace kodo
 {
 
+    /// Tag of the thread_scratch buffer holding the temp. symbol of the
+    /// finite field layers
+    struct temp_symbol_scratch { };
+
     /// @ingroup finite_field_layers
     /// @brief Basic layer performing common finite field operation
     template<class FieldImpl, class SuperCoder>
@@ -48,18 +57,18 @@ namespace kodo
     public:
 
         /// @ingroup factory_layers
-        /// The factory layer associated with this coder. We create
-        /// an instance of the used field and share this with all coders
+        /// The factory layer associated with this coder. The instance
+        /// of the used field is shared by all factories and coders of
+        /// the process, see shared_field()
         class factory : public SuperCoder::factory
         {
         public:
 
             /// @copydoc layer::factory::factory(uint32_t,uint32_t)
             factory(uint32_t max_symbols, uint32_t max_symbol_size) :
-                SuperCoder::factory(max_symbols, max_symbol_size)
-            {
-                m_field = boost::make_shared<field_impl>();
-            }
+                SuperCoder::factory(max_symbols, max_symbol_size),
+                m_field(shared_field<field_impl>())
+            { }
 
         private:
 
@@ -85,22 +94,6 @@ namespace kodo
         void construct(Factory &the_factory)
         {
             SuperCoder::construct(the_factory);
-
-            // The maximum symbol length needed for the temp symbol.
-            // We expect this will be one value per symbol
-            // (for the encoding vector) or the number of symbols
-            // needed for the actual data.
-
-            uint32_t data_symbol_length =
-                fifi::size_to_length<field_type>(
-                    the_factory.max_symbol_size());
-
-            uint32_t max_symbol_length =
-                std::max(the_factory.max_symbols(), data_symbol_length);
-
-            assert(max_symbol_length > 0);
-            m_temp_symbol.resize(max_symbol_length, 0);
-
             m_field = the_factory.field();
         }
 
@@ -112,6 +105,10 @@ namespace kodo
             assert(symbol_dest != 0);
             assert(symbol_length > 0);
 
+            // E.g. the pivots of subfield coefficients need no work
+            if(coefficient == 1)
+                return;
+
             fifi::multiply_constant(*m_field, coefficient,
                                     symbol_dest, symbol_length);
         }
@@ -127,11 +124,82 @@ namespace kodo
             assert(symbol_src != 0);
             assert(symbol_length > 0);
 
+            // Coefficients of the binary subfield only need an XOR
+            if(coefficient == 0)
+                return;
+
+            if(coefficient == 1)
+            {
+                fifi::add(*m_field, symbol_dest, symbol_src, symbol_length);
+                return;
+            }
+
             fifi::multiply_add(*m_field, coefficient, symbol_dest,
-                               symbol_src, &m_temp_symbol[0],
+                               symbol_src, temp_symbol(symbol_length),
                                symbol_length);
         }
 
+        /// @copydoc layer::multiply_copy(value_type*, const value_type*,
+        ///                              value_type, uint32_t)
+        void multiply_copy(value_type *symbol_dest,
+                           const value_type *symbol_src,
+                           value_type coefficient, uint32_t symbol_length)
+        {
+            assert(m_field);
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+            assert(symbol_length > 0);
+
+            if(coefficient == 0)
+            {
+                std::fill_n(symbol_dest, symbol_length, 0);
+                return;
+            }
+
+            // The copy leaves the destination in the cache, so the
+            // multiplication does not add a pass over memory
+            std::copy_n(symbol_src, symbol_length, symbol_dest);
+
+            if(!fifi::is_binary<field_type>::value && coefficient != 1)
+            {
+                fifi::multiply_constant(*m_field, coefficient,
+                                        symbol_dest, symbol_length);
+            }
+        }
+
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(value_type *symbol_dest,
+                                  const value_type **symbols_src,
+                                  const value_type *coefficients,
+                                  uint32_t sources, uint32_t symbol_length)
+        {
+            combine_sources(symbol_dest, symbols_src, coefficients,
+                            sources, symbol_length, false);
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(value_type *symbol_dest,
+                              const value_type **symbols_src,
+                              const value_type *coefficients,
+                              uint32_t sources, uint32_t symbol_length)
+        {
+            if(sources == 0)
+            {
+                assert(symbol_dest != 0);
+                std::fill_n(symbol_dest, symbol_length, 0);
+                return;
+            }
+
+            combine_sources(symbol_dest, symbols_src, coefficients,
+                            sources, symbol_length, true);
+        }
+
         /// @copydoc layer::add(value_type*, const value_type *, uint32_t)
         void add(value_type *symbol_dest, const value_type *symbol_src,
                  uint32_t symbol_length)
@@ -155,12 +223,21 @@ namespace kodo
             assert(symbol_dest != 0);
             assert(symbol_src  != 0);
             assert(symbol_length > 0);
-            assert(symbol_length <= m_temp_symbol.size());
             assert(symbol_dest != symbol_src);
 
+            if(coefficient == 0)
+                return;
+
+            if(coefficient == 1)
+            {
+                fifi::subtract(*m_field, symbol_dest, symbol_src,
+                               symbol_length);
+                return;
+            }
+
             fifi::multiply_subtract(
                 *m_field, coefficient, symbol_dest, symbol_src,
-                &m_temp_symbol[0], symbol_length);
+                temp_symbol(symbol_length), symbol_length);
         }
 
         /// @copydoc layer::subtract(value_type*,const value_type*, uint32_t)
@@ -182,13 +259,84 @@ namespace kodo
             return m_field->invert( value );
         }
 
-    private:
+    protected:
+
+        /// Implements multiply_add_sources() and multiply_sources()
+        /// @param symbol_dest The destination symbol
+        /// @param symbols_src The source symbols
+        /// @param coefficients The coefficients of the sources
+        /// @param sources The number of sources
+        /// @param symbol_length The length of the symbols
+        /// @param copy_first If true the first source is copied to the
+        ///        destination instead of added to it
+        void combine_sources(value_type *symbol_dest,
+                             const value_type **symbols_src,
+                             const value_type *coefficients,
+                             uint32_t sources, uint32_t symbol_length,
+                             bool copy_first)
+        {
+            assert(m_field);
+            assert(symbol_dest != 0);
+            assert(symbols_src != 0);
+            assert(coefficients != 0);
+            assert(symbol_length > 0);
+
+            // The destination is processed in tiles small enough to stay
+            // in the L1 cache while all the sources are added to it
+            const uint32_t tile_length =
+                std::max<uint32_t>(1U, tile_size / sizeof(value_type));
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += tile_length)
+            {
+                uint32_t length =
+                    std::min(tile_length, symbol_length - offset);
+
+                value_type *dest = symbol_dest + offset;
+
+                for(uint32_t i = 0; i < sources; ++i)
+                {
+                    assert(symbols_src[i] != 0);
+                    assert(coefficients[i] != 0);
+
+                    const value_type *src = symbols_src[i] + offset;
+
+                    if(copy_first && i == 0)
+                    {
+                        finite_field_math::multiply_copy(
+                            dest, src, coefficients[i], length);
+                    }
+                    else if(fifi::is_binary<field_type>::value ||
+                            coefficients[i] == 1)
+                    {
+                        fifi::add(*m_field, dest, src, length);
+                    }
+                    else
+                    {
+                        fifi::multiply_add(*m_field, coefficients[i], dest,
+                                           src, temp_symbol(length), length);
+                    }
+                }
+            }
+        }
+
+        /// @param length The number of values needed
+        /// @return The temp. symbol used in various compound
+        ///         operations, which is shared by all coders on the
+        ///         calling thread
+        static value_type* temp_symbol(uint32_t length)
+        {
+            return thread_scratch<temp_symbol_scratch>::template
+                values<value_type>(length);
+        }
+
+        /// The size in bytes of the destination tiles used by
+        /// multiply_add_sources() and multiply_sources()
+        static const uint32_t tile_size = 4096;
 
         /// The selected field
         field_pointer m_field;
 
-        /// Temp. symbol used in various compound operations
-        std::vector<value_type> m_temp_symbol;
 
     };
 
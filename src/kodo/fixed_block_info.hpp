@@ -0,0 +1,166 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+namespace kodo
+{
+
+    /// @ingroup symbol_storage_layers
+    ///
+    /// @brief Alternative to storage_block_info where the number of
+    ///        symbols and the symbol size are fixed at compile-time.
+    ///
+    /// All lengths returned by the layer are compile-time constants so
+    /// the loops of the layers above, which are bounded by the symbols,
+    /// the symbol length or the block size, get constant trip counts
+    /// which the compiler may unroll and vectorize. The factory accepts
+    /// the usual constructor arguments, but they must match the fixed
+    /// geometry.
+    ///
+    /// @tparam Symbols The number of symbols in a block
+    /// @tparam SymbolSize The size of a symbol in bytes
+    template<uint32_t Symbols, uint32_t SymbolSize, class SuperCoder>
+    class fixed_block_info : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// The number of symbols
+        static const uint32_t fixed_symbols = Symbols;
+
+        /// The size of a symbol in bytes
+        static const uint32_t fixed_symbol_size = SymbolSize;
+
+        /// The length of a symbol in value_type elements
+        static const uint32_t fixed_symbol_length =
+            SymbolSize / sizeof(value_type);
+
+        /// The size of a block in bytes
+        static const uint32_t fixed_block_size = Symbols * SymbolSize;
+
+        static_assert(Symbols > 0, "A block must contain symbols");
+        static_assert(SymbolSize > 0, "The symbol size must be non-zero");
+        static_assert(SymbolSize % sizeof(value_type) == 0,
+                      "The symbol size must be a multiple of the size "
+                      "of the field value_type");
+
+    public:
+
+        /// @ingroup factory_layers
+        /// @brief Provides the fixed symbols and symbol size
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// Constructor
+            /// @param max_symbols must equal Symbols
+            /// @param max_symbol_size must equal SymbolSize
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            {
+                assert(max_symbols == Symbols);
+                assert(max_symbol_size == SymbolSize);
+            }
+
+            /// @copydoc layer::factory::max_symbols() const
+            uint32_t max_symbols() const
+            {
+                return Symbols;
+            }
+
+            /// @copydoc layer::factory::max_symbol_size() const
+            uint32_t max_symbol_size() const
+            {
+                return SymbolSize;
+            }
+
+            /// @copydoc layer::factory::max_block_size() const
+            uint32_t max_block_size() const
+            {
+                return fixed_block_size;
+            }
+
+            /// @copydoc layer::factory::symbols() const;
+            uint32_t symbols() const
+            {
+                return Symbols;
+            }
+
+            /// @copydoc layer::factory::symbol_size() const;
+            uint32_t symbol_size() const
+            {
+                return SymbolSize;
+            }
+
+            /// @copydoc layer::factory::set_symbols(uint32_t)
+            void set_symbols(uint32_t symbols)
+            {
+                assert(symbols == Symbols);
+                (void) symbols;
+            }
+
+            /// @copydoc layer::factory::set_symbol_size(uint32_t)
+            void set_symbol_size(uint32_t symbol_size)
+            {
+                assert(symbol_size == SymbolSize);
+                (void) symbol_size;
+            }
+
+        };
+
+    public:
+
+        /// @copydoc layer::symbols() const
+        uint32_t symbols() const
+        {
+            return Symbols;
+        }
+
+        /// @copydoc layer::symbol_size() const
+        uint32_t symbol_size() const
+        {
+            return SymbolSize;
+        }
+
+        /// @copydoc layer::symbol_length() const
+        uint32_t symbol_length() const
+        {
+            return fixed_symbol_length;
+        }
+
+        /// @copydoc layer::block_size() const
+        uint32_t block_size() const
+        {
+            return fixed_block_size;
+        }
+
+    };
+
+    template<uint32_t Symbols, uint32_t SymbolSize, class SuperCoder>
+    const uint32_t
+    fixed_block_info<Symbols, SymbolSize, SuperCoder>::fixed_symbols;
+
+    template<uint32_t Symbols, uint32_t SymbolSize, class SuperCoder>
+    const uint32_t
+    fixed_block_info<Symbols, SymbolSize, SuperCoder>::fixed_symbol_size;
+
+    template<uint32_t Symbols, uint32_t SymbolSize, class SuperCoder>
+    const uint32_t
+    fixed_block_info<Symbols, SymbolSize, SuperCoder>::fixed_symbol_length;
+
+    template<uint32_t Symbols, uint32_t SymbolSize, class SuperCoder>
+    const uint32_t
+    fixed_block_info<Symbols, SymbolSize, SuperCoder>::fixed_block_size;
+
+}
@@ -0,0 +1,71 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_storage_layers
+    /// @brief Alternative to coefficient_info for stacks using the
+    ///        fixed_block_info layer.
+    ///
+    /// The coefficient length and size are computed inline from the
+    /// fixed number of symbols instead of being stored in the coder, so
+    /// the compiler can fold them into constants.
+    template<class SuperCoder>
+    class fixed_coefficient_info : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t, uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_coefficients_size() const
+            uint32_t max_coefficients_size() const
+            {
+                return fifi::elements_to_size<field_type>(
+                    SuperCoder::fixed_symbols);
+            }
+        };
+
+    public:
+
+        /// @copydoc layer::coefficients_length() const
+        uint32_t coefficients_length() const
+        {
+            return fifi::elements_to_length<field_type>(
+                SuperCoder::fixed_symbols);
+        }
+
+        /// @copydoc layer::coefficients_size() const
+        uint32_t coefficients_size() const
+        {
+            return fifi::elements_to_size<field_type>(
+                SuperCoder::fixed_symbols);
+        }
+
+    };
+
+}
@@ -0,0 +1,244 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup symbol_storage_layers
+    /// @brief Deep symbol storage for stacks using the fixed_block_info
+    ///        layer.
+    ///
+    /// Works like deep_symbol_storage, but the coding buffer is a
+    /// std::array embedded in the coder, sized by the fixed block
+    /// size. This saves the indirection through the heap allocated
+    /// vector and lets the symbol offsets be computed from constants.
+    /// As in deep_symbol_storage the buffer is zeroed lazily when the
+    /// coder is reused.
+    template<class SuperCoder>
+    class fixed_symbol_storage : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The alignment of the coding buffer in bytes
+        static const uint32_t buffer_alignment = 16;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory& the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_data.fill(0);
+            m_symbols.fill(false);
+
+            m_zero_pending = false;
+            m_symbols_count = 0;
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            // The zeroing of the buffer is delayed until the symbols
+            // are accessed
+            m_zero_pending = true;
+            m_symbols.fill(false);
+
+            m_symbols_count = 0;
+        }
+
+        /// @copydoc layer::symbol(uint32_t)
+        uint8_t* symbol(uint32_t index)
+        {
+            assert(index < SuperCoder::fixed_symbols);
+            zero_if_pending();
+            return &m_data[index * SuperCoder::fixed_symbol_size];
+        }
+
+        /// @copydoc layer::symbol_value(uint32_t)
+        value_type* symbol_value(uint32_t index)
+        {
+            return reinterpret_cast<value_type*>(symbol(index));
+        }
+
+        /// @copydoc layer::symbol(uint32_t) const
+        const uint8_t* symbol(uint32_t index) const
+        {
+            assert(index < SuperCoder::fixed_symbols);
+            zero_if_pending();
+            return &m_data[index * SuperCoder::fixed_symbol_size];
+        }
+
+        /// @copydoc layer::symbol_value(uint32_t) const
+        const value_type* symbol_value(uint32_t index) const
+        {
+            return reinterpret_cast<const value_type*>(symbol(index));
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            assert(symbol_storage.m_size > 0);
+            assert(symbol_storage.m_data != 0);
+            assert(symbol_storage.m_size <= SuperCoder::fixed_block_size);
+
+            // Only the part of the block not covered by the new data
+            // needs to be zeroed
+            if(m_zero_pending)
+            {
+                std::fill(m_data.begin() + symbol_storage.m_size,
+                          m_data.end(), 0);
+
+                m_zero_pending = false;
+            }
+
+            std::copy_n(symbol_storage.m_data, symbol_storage.m_size,
+                        m_data.begin());
+
+            // This will specify all symbols, also in the case
+            // of partial data.
+            m_symbols_count = SuperCoder::fixed_symbols;
+            m_symbols.fill(true);
+        }
+
+        /// @copydoc layer::set_symbol(uint32_t, const sak::const_storage&)
+        void set_symbol(uint32_t index, const sak::const_storage &symbol)
+        {
+            assert(symbol.m_data != 0);
+            assert(symbol.m_size == SuperCoder::fixed_symbol_size);
+            assert(index < SuperCoder::fixed_symbols);
+
+            zero_if_pending();
+
+            std::copy_n(symbol.m_data, SuperCoder::fixed_symbol_size,
+                        m_data.begin() +
+                        index * SuperCoder::fixed_symbol_size);
+
+            if(m_symbols[index] == false)
+            {
+                ++m_symbols_count;
+                m_symbols[index] = true;
+            }
+        }
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        void copy_symbols(const sak::mutable_storage &dest_storage)
+        {
+            assert(dest_storage.m_size > 0);
+            assert(dest_storage.m_data != 0);
+
+            zero_if_pending();
+
+            uint32_t data_to_copy =
+                std::min(dest_storage.m_size, SuperCoder::fixed_block_size);
+
+            std::copy_n(m_data.begin(), data_to_copy, dest_storage.m_data);
+        }
+
+        /// @copydoc layer::copy_symbol(uint32_t,
+        ///                             const sak::mutable_storage&)
+        void copy_symbol(uint32_t index,
+                         const sak::mutable_storage &dest) const
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            uint32_t data_to_copy =
+                std::min(dest.m_size, SuperCoder::fixed_symbol_size);
+
+            std::copy_n(symbol(index), data_to_copy, dest.m_data);
+        }
+
+        /// @copydoc layer::symbols_available() const
+        uint32_t symbols_available() const
+        {
+            return SuperCoder::fixed_symbols;
+        }
+
+        /// @copydoc layer::symbols_initialized() const
+        uint32_t symbols_initialized() const
+        {
+            return m_symbols_count;
+        }
+
+        /// @copydoc layer::is_symbols_available() const
+        bool is_symbols_available() const
+        {
+            return true;
+        }
+
+        /// @copydoc layer::is_symbols_initialized() const
+        bool is_symbols_initialized() const
+        {
+            return m_symbols_count == SuperCoder::fixed_symbols;
+        }
+
+        /// @copydoc layer::is_symbol_available(uint32_t) const
+        bool is_symbol_available(uint32_t /*symbol_index*/) const
+        {
+            return true;
+        }
+
+        /// @copydoc layer::is_symbol_initialized(uint32_t) const
+        bool is_symbol_initialized(uint32_t symbol_index) const
+        {
+            assert(symbol_index < SuperCoder::fixed_symbols);
+            return m_symbols[symbol_index];
+        }
+
+    protected:
+
+        /// Zeroes the buffer if the coder was initialized since the
+        /// buffer was last zeroed. The function is const since it is
+        /// also used from the const accessors.
+        void zero_if_pending() const
+        {
+            if(!m_zero_pending)
+            {
+                return;
+            }
+
+            m_data.fill(0);
+            m_zero_pending = false;
+        }
+
+    private:
+
+        /// Storage for the symbol data, mutable since it is zeroed
+        /// lazily also from the const accessors
+        alignas(buffer_alignment) mutable
+        std::array<uint8_t, SuperCoder::fixed_block_size> m_data;
+
+        /// Tracks which symbols have been set
+        std::array<bool, SuperCoder::fixed_symbols> m_symbols;
+
+        /// True if the buffer has not been zeroed since the coder was
+        /// initialized
+        mutable bool m_zero_pending;
+
+        /// Symbols count
+        uint32_t m_symbols_count;
+
+    };
+
+    template<class SuperCoder>
+    const uint32_t fixed_symbol_storage<SuperCoder>::buffer_alignment;
+
+}
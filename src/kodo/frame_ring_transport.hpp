@@ -0,0 +1,353 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/convert_endian.hpp>
+
+#include "symbol_buffer_pool.hpp"
+#include "udp_transport.hpp"
+
+namespace kodo
+{
+
+    /// @brief A frame of a NIC ring, seen from the coders.
+    ///
+    /// The data points to the start of the datagram in the frame, after
+    /// the protocol headers handled by the ring. The datagrams use the
+    /// udp_datagram format, so the symbol data starts the frame data.
+    struct ring_frame
+    {
+        /// The datagram in the frame
+        uint8_t *m_data;
+
+        /// The size of the datagram in bytes, or the capacity of a
+        /// frame reserved for sending
+        uint32_t m_size;
+    };
+
+    /// @brief Encodes payloads directly into the transmit frames of a
+    ///        kernel-bypass ring, e.g. an af_xdp_ring.
+    ///
+    /// The FrameRing provides:
+    ///
+    /// @code
+    ///   // The capacity of a frame for a datagram
+    ///   uint32_t frame_size() const;
+    ///   // Reserves up to count transmit frames, returns the number
+    ///   uint32_t reserve(ring_frame *frames, uint32_t count);
+    ///   // Sends reserved frames, m_size set to the datagram sizes
+    ///   void submit(const ring_frame *frames, uint32_t count);
+    ///   // Receives up to count frames, returns the number
+    ///   uint32_t receive(ring_frame *frames, uint32_t count);
+    ///   // Hands the frame holding a datagram back to the receive ring
+    ///   void refill(uint8_t *data);
+    ///   // A frame on neither ring for the decoder storage, 0 if none
+    ///   uint8_t* spare();
+    ///   // True if the data lies in a frame of the ring
+    ///   bool owns(const uint8_t *data) const;
+    /// @endcode
+    ///
+    /// The udp_sender encodes into its own buffer which the kernel then
+    /// copies. Here the encoder writes the payloads in the frames the
+    /// NIC sends from, so a payload is never copied.
+    template<class FrameRing>
+    class frame_ring_sender : boost::noncopyable
+    {
+    public:
+
+        /// Constructs a new sender
+        /// @param ring The ring, owned by the caller
+        /// @param batch_size The maximum number of frames submitted at
+        ///        once
+        frame_ring_sender(FrameRing &ring, uint32_t batch_size = 64)
+            : m_ring(ring),
+              m_frames(batch_size)
+        {
+            assert(batch_size > 0);
+        }
+
+        /// Encodes and sends a number of payloads from an encoder
+        /// @param encoder The encoder
+        /// @param block_id The id of the block
+        /// @param count The number of payloads to send
+        /// @return The number of payloads sent, less than count if the
+        ///         ring has no free frames
+        template<class EncoderPointer>
+        uint32_t send(const EncoderPointer &encoder, uint32_t block_id,
+                      uint32_t count)
+        {
+            assert(encoder);
+
+            uint32_t payload_size = encoder->payload_size();
+            uint32_t datagram_size = udp_datagram::size(payload_size);
+
+            assert(datagram_size <= m_ring.frame_size());
+
+            uint32_t sent = 0;
+
+            while(sent < count)
+            {
+                uint32_t batch = std::min(
+                    static_cast<uint32_t>(m_frames.size()), count - sent);
+
+                uint32_t reserved = m_ring.reserve(&m_frames[0], batch);
+
+                for(uint32_t i = 0; i < reserved; ++i)
+                {
+                    uint8_t *datagram = m_frames[i].m_data;
+
+                    uint32_t used = encoder->encode(datagram);
+                    assert(used <= payload_size);
+
+                    std::fill(datagram + used, datagram + payload_size, 0);
+
+                    sak::big_endian::put<udp_datagram::block_id_type>(
+                        block_id, datagram + payload_size);
+
+                    m_frames[i].m_size = datagram_size;
+                }
+
+                m_ring.submit(&m_frames[0], reserved);
+                sent += reserved;
+
+                if(reserved < batch)
+                {
+                    break;
+                }
+            }
+
+            return sent;
+        }
+
+        /// Sends payloads from all the encoders of an object encoder
+        /// @param object_encoder The object encoder
+        /// @param count The number of payloads to send per encoder
+        /// @return The number of payloads sent
+        template<class ObjectEncoder>
+        uint32_t send_object(ObjectEncoder &object_encoder, uint32_t count)
+        {
+            uint32_t sent = 0;
+
+            for(uint32_t i = 0; i < object_encoder.encoders(); ++i)
+            {
+                auto encoder = object_encoder.build(i);
+
+                uint32_t block_sent = send(encoder, i, count);
+                sent += block_sent;
+
+                if(block_sent < count)
+                {
+                    break;
+                }
+            }
+
+            return sent;
+        }
+
+    private:
+
+        /// The ring
+        FrameRing &m_ring;
+
+        /// The frames of a batch
+        std::vector<ring_frame> m_frames;
+
+    };
+
+    /// @brief Decodes payloads in the receive frames of a kernel-bypass
+    ///        ring, see frame_ring_sender for the FrameRing.
+    ///
+    /// With receive() the payloads are decoded from the frames, which
+    /// go straight back to the ring. With receive_adopt() decoders using
+    /// the adopting_symbol_storage keep the frames holding innovative
+    /// symbols as their symbols, and the frames they displace go back
+    /// to the ring instead. The buffer pool of the decoders must then
+    /// only hold frames of the ring, see add_spare_frames(), and enough
+    /// of them for the symbols of all decoders alive at once.
+    template<class FrameRing>
+    class frame_ring_receiver : boost::noncopyable
+    {
+    public:
+
+        /// Constructs a new receiver
+        /// @param ring The ring, owned by the caller
+        /// @param batch_size The maximum number of frames received at
+        ///        once
+        frame_ring_receiver(FrameRing &ring, uint32_t batch_size = 64)
+            : m_ring(ring),
+              m_frames(batch_size)
+        {
+            assert(batch_size > 0);
+        }
+
+        /// Receives a batch of frames
+        /// @param function Invoked as function(block_id, payload, size)
+        ///        for every datagram, returns the buffer to hand back to
+        ///        the ring, the payload or a frame displaced by it
+        /// @return The number of frames received
+        template<class Function>
+        uint32_t receive_frames(const Function &function)
+        {
+            uint32_t received = m_ring.receive(
+                &m_frames[0], static_cast<uint32_t>(m_frames.size()));
+
+            for(uint32_t i = 0; i < received; ++i)
+            {
+                uint8_t *payload = m_frames[i].m_data;
+                uint32_t size = m_frames[i].m_size;
+
+                // Too short to carry a block id
+                if(size <= sizeof(udp_datagram::block_id_type))
+                {
+                    m_ring.refill(payload);
+                    continue;
+                }
+
+                size -= sizeof(udp_datagram::block_id_type);
+
+                uint32_t block_id =
+                    sak::big_endian::get<udp_datagram::block_id_type>(
+                        payload + size);
+
+                uint8_t *buffer = function(block_id, payload, size);
+
+                assert(m_ring.owns(buffer));
+                m_ring.refill(buffer);
+            }
+
+            return received;
+        }
+
+        /// Receives a batch of frames and decodes the payloads in place
+        /// @param object_decoder The object decoder
+        /// @param decoders The decoders, indexed by block id. Resized
+        ///        to the number of decoders of the object decoder.
+        /// @return The number of frames received
+        template<class ObjectDecoder>
+        uint32_t receive(ObjectDecoder &object_decoder,
+                         std::vector<typename ObjectDecoder::pointer>
+                             &decoders)
+        {
+            decoders.resize(object_decoder.decoders());
+
+            return receive_frames([&](uint32_t block_id, uint8_t *payload,
+                                      uint32_t size) -> uint8_t*
+                {
+                    auto *decoder = find(object_decoder, decoders,
+                                         block_id, size);
+
+                    if(decoder != 0)
+                    {
+                        (*decoder)->decode(payload);
+                    }
+
+                    return payload;
+                });
+        }
+
+        /// Receives a batch of frames and lets the decoders adopt the
+        /// frames holding innovative symbols
+        /// @copydetails receive(ObjectDecoder&,
+        ///              std::vector<typename ObjectDecoder::pointer>&)
+        template<class ObjectDecoder>
+        uint32_t receive_adopt(ObjectDecoder &object_decoder,
+                               std::vector<typename ObjectDecoder::pointer>
+                                   &decoders)
+        {
+            decoders.resize(object_decoder.decoders());
+
+            return receive_frames([&](uint32_t block_id, uint8_t *payload,
+                                      uint32_t size) -> uint8_t*
+                {
+                    auto *decoder = find(object_decoder, decoders,
+                                         block_id, size);
+
+                    if(decoder == 0)
+                    {
+                        return payload;
+                    }
+
+                    return (*decoder)->decode_adopt(payload);
+                });
+        }
+
+    private:
+
+        /// @return The decoder of a block, built on its first payload,
+        ///         or 0 if the payload cannot be decoded
+        template<class ObjectDecoder, class Pointer>
+        static Pointer* find(ObjectDecoder &object_decoder,
+                             std::vector<Pointer> &decoders,
+                             uint32_t block_id, uint32_t size)
+        {
+            if(block_id >= decoders.size())
+            {
+                return 0;
+            }
+
+            Pointer &decoder = decoders[block_id];
+
+            if(!decoder)
+            {
+                decoder = object_decoder.build(block_id);
+            }
+
+            if(size != decoder->payload_size() || decoder->is_complete())
+            {
+                return 0;
+            }
+
+            return &decoder;
+        }
+
+    private:
+
+        /// The ring
+        FrameRing &m_ring;
+
+        /// The frames of a batch
+        std::vector<ring_frame> m_frames;
+
+    };
+
+    /// Moves spare frames of a ring into the buffer pool of adopting
+    /// decoders, see frame_ring_receiver::receive_adopt()
+    /// @param ring The ring
+    /// @param pool The buffer pool, e.g. the buffer_pool() of the
+    ///        decoder factory
+    /// @param count The number of frames to add
+    /// @return The number of frames added, less than count if the ring
+    ///         has no more spare frames
+    template<class FrameRing>
+    inline uint32_t add_spare_frames(FrameRing &ring,
+                                     symbol_buffer_pool &pool,
+                                     uint32_t count)
+    {
+        assert(pool.buffer_size() <= ring.frame_size());
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            uint8_t *frame = ring.spare();
+
+            if(frame == 0)
+            {
+                return i;
+            }
+
+            pool.add_buffer(frame);
+        }
+
+        return count;
+    }
+
+}
@@ -0,0 +1,544 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <fifi/default_field.hpp>
+#include <fifi/fifi_utils.hpp>
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @brief Decodes many small generations in lockstep.
+    ///
+    /// The state of all the generations is kept in structure-of-arrays
+    /// form where element (row, column) of every generation is stored
+    /// contiguously, one byte lane per generation. Every call to
+    /// decode() eliminates one staged symbol per generation, and all the
+    /// generations are advanced with the same sequence of operations on
+    /// whole lanes: for every pivot row the symbols are updated with the
+    /// lane-wise coefficients, which are zero for the generations where
+    /// the row does not apply. This makes the divergent pivot decisions
+    /// masked operations, and the inner loops are straight byte loops
+    /// over the lanes which the compiler vectorizes. The coefficients of
+    /// the lane-wise multiplications differ per lane, so the
+    /// multiplication is computed with shifts and masks from the
+    /// reduction polynomial instead of table lookups.
+    ///
+    /// The decoder is intended for generations of a few symbols where
+    /// the per call overhead of the linear_block_decoder dominates, and
+    /// works best when most generations receive a symbol per step. Only
+    /// fields with one element per byte, or the binary field, are
+    /// supported.
+    template<class Field>
+    class generation_batch_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The field type
+        typedef Field field_type;
+
+        /// The value type of the field
+        typedef typename field_type::value_type value_type;
+
+        /// The finite field implementation
+        typedef typename fifi::default_field<field_type>::type field_impl;
+
+        static_assert(sizeof(value_type) == 1,
+                      "Only fields with byte sized values are supported");
+
+        static_assert(field_type::degree == 1 || field_type::degree == 8,
+                      "Only the binary and binary8 fields are supported");
+
+    public:
+
+        /// Constructor
+        /// @param generations The number of generations
+        /// @param symbols The number of symbols in a generation
+        /// @param symbol_size The size of a symbol in bytes
+        generation_batch_decoder(uint32_t generations, uint32_t symbols,
+                                 uint32_t symbol_size)
+            : m_generations(generations),
+              m_symbols(symbols),
+              m_symbol_size(symbol_size),
+              m_coefficients(symbols * symbols * generations, 0),
+              m_data(symbols * symbol_size * generations, 0),
+              m_pivots(symbols * generations, 0),
+              m_ranks(generations, 0),
+              m_staged_coefficients(symbols * generations, 0),
+              m_staged_data(symbol_size * generations, 0),
+              m_staged(generations, 0),
+              m_lane_coefficients(generations, 0),
+              m_lane_pivots(generations, symbols)
+        {
+            assert(m_generations > 0);
+            assert(m_symbols > 0);
+            assert(m_symbol_size > 0);
+
+            // Multiplying with x the highest element of the field gives
+            // the reduction of the overflowing bit
+            value_type high = value_type(1U << (field_type::degree - 1));
+            m_reduction = field_type::degree == 1 ?
+                0 : m_field.multiply(high, 2U);
+        }
+
+        /// @return The number of generations
+        uint32_t generations() const
+        {
+            return m_generations;
+        }
+
+        /// @return The number of symbols in a generation
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// @return The size of a symbol in bytes
+        uint32_t symbol_size() const
+        {
+            return m_symbol_size;
+        }
+
+        /// Stages a coded symbol of a generation to be eliminated by
+        /// the next call to decode(). At most one symbol per generation
+        /// can be staged, symbols for complete generations are ignored.
+        /// @param generation The generation
+        /// @param symbol_data The symbol data
+        /// @param coefficients The coding coefficients as given to
+        ///        layer::decode_symbol(uint8_t*,uint8_t*)
+        void stage_symbol(uint32_t generation, const uint8_t *symbol_data,
+                          const uint8_t *coefficients)
+        {
+            assert(generation < m_generations);
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            if(!stage(generation))
+            {
+                return;
+            }
+
+            const value_type *c =
+                reinterpret_cast<const value_type*>(coefficients);
+
+            for(uint32_t i = 0; i < m_symbols; ++i)
+            {
+                staged_coefficient(i)[generation] =
+                    fifi::get_value<field_type>(c, i);
+            }
+
+            for(uint32_t b = 0; b < m_symbol_size; ++b)
+            {
+                staged_data(b)[generation] = symbol_data[b];
+            }
+        }
+
+        /// Stages an uncoded symbol of a generation
+        /// @copydetails stage_symbol(uint32_t,const uint8_t*,
+        ///                           const uint8_t*)
+        /// @param symbol_index The index of the symbol
+        void stage_uncoded_symbol(uint32_t generation,
+                                  const uint8_t *symbol_data,
+                                  uint32_t symbol_index)
+        {
+            assert(generation < m_generations);
+            assert(symbol_data != 0);
+            assert(symbol_index < m_symbols);
+
+            if(!stage(generation))
+            {
+                return;
+            }
+
+            staged_coefficient(symbol_index)[generation] = 1U;
+
+            for(uint32_t b = 0; b < m_symbol_size; ++b)
+            {
+                staged_data(b)[generation] = symbol_data[b];
+            }
+        }
+
+        /// Eliminates the staged symbols of all the generations
+        void decode()
+        {
+            forward_substitute();
+            find_pivots();
+            normalize();
+            backward_substitute();
+            store_pivots();
+
+            std::fill(m_staged_coefficients.begin(),
+                      m_staged_coefficients.end(), 0);
+
+            std::fill(m_staged_data.begin(), m_staged_data.end(), 0);
+            std::fill(m_staged.begin(), m_staged.end(), 0);
+        }
+
+        /// @param generation The generation
+        /// @return The rank of the generation
+        uint32_t rank(uint32_t generation) const
+        {
+            assert(generation < m_generations);
+            return m_ranks[generation];
+        }
+
+        /// @param generation The generation
+        /// @return True if the generation is decoded
+        bool is_complete(uint32_t generation) const
+        {
+            return rank(generation) == m_symbols;
+        }
+
+        /// @return The number of decoded generations
+        uint32_t complete_generations() const
+        {
+            return static_cast<uint32_t>(
+                std::count(m_ranks.begin(), m_ranks.end(), m_symbols));
+        }
+
+        /// Copies the symbols of a decoded generation
+        /// @param generation The generation
+        /// @param dest The destination, at most the size of a generation
+        ///        is copied
+        void copy_symbols(uint32_t generation,
+                          const sak::mutable_storage &dest) const
+        {
+            assert(is_complete(generation));
+            assert(dest.m_data != 0);
+
+            uint32_t size = std::min(dest.m_size, m_symbols * m_symbol_size);
+
+            for(uint32_t offset = 0; offset < size; ++offset)
+            {
+                uint32_t j = offset / m_symbol_size;
+                uint32_t b = offset % m_symbol_size;
+
+                dest.m_data[offset] =
+                    m_data[(j * m_symbol_size + b) * m_generations +
+                           generation];
+            }
+        }
+
+        /// Discards the state of all the generations
+        void reset()
+        {
+            std::fill(m_coefficients.begin(), m_coefficients.end(), 0);
+            std::fill(m_data.begin(), m_data.end(), 0);
+            std::fill(m_pivots.begin(), m_pivots.end(), 0);
+            std::fill(m_ranks.begin(), m_ranks.end(), 0);
+        }
+
+    protected:
+
+        /// Marks a generation as staged
+        /// @return False if the generation is complete
+        bool stage(uint32_t generation)
+        {
+            // Only one symbol per generation and step
+            assert(!m_staged[generation]);
+
+            if(is_complete(generation))
+            {
+                return false;
+            }
+
+            m_staged[generation] = 1U;
+            return true;
+        }
+
+        /// Subtracts the existing pivot rows from the staged symbols
+        void forward_substitute()
+        {
+            for(uint32_t j = 0; j < m_symbols; ++j)
+            {
+                const uint8_t *pivot = pivots(j);
+                const uint8_t *value = staged_coefficient(j);
+
+                uint8_t any = 0;
+
+                for(uint32_t g = 0; g < m_generations; ++g)
+                {
+                    uint8_t c = value[g] & uint8_t(0U - pivot[g]);
+                    m_lane_coefficients[g] = c;
+                    any |= c;
+                }
+
+                if(!any)
+                {
+                    continue;
+                }
+
+                for(uint32_t i = 0; i < m_symbols; ++i)
+                {
+                    multiply_add_lanes(staged_coefficient(i),
+                                       &m_lane_coefficients[0],
+                                       coefficient(j, i));
+                }
+
+                for(uint32_t b = 0; b < m_symbol_size; ++b)
+                {
+                    multiply_add_lanes(staged_data(b),
+                                       &m_lane_coefficients[0],
+                                       data(j, b));
+                }
+            }
+        }
+
+        /// Finds the pivot of the staged symbol of every generation, and
+        /// the inverse of the pivot element used to normalize the symbol
+        void find_pivots()
+        {
+            for(uint32_t g = 0; g < m_generations; ++g)
+            {
+                m_lane_pivots[g] = m_symbols;
+                m_lane_coefficients[g] = 0;
+
+                if(!m_staged[g])
+                {
+                    continue;
+                }
+
+                for(uint32_t i = 0; i < m_symbols; ++i)
+                {
+                    value_type value = staged_coefficient(i)[g];
+
+                    if(value)
+                    {
+                        m_lane_pivots[g] = i;
+                        m_lane_coefficients[g] = m_field.invert(value);
+                        break;
+                    }
+                }
+            }
+        }
+
+        /// Multiplies the staged symbols with the inverse of their
+        /// pivot element, the symbols without a pivot become zero
+        void normalize()
+        {
+            for(uint32_t i = 0; i < m_symbols; ++i)
+            {
+                multiply_lanes(staged_coefficient(i),
+                               &m_lane_coefficients[0]);
+            }
+
+            for(uint32_t b = 0; b < m_symbol_size; ++b)
+            {
+                multiply_lanes(staged_data(b), &m_lane_coefficients[0]);
+            }
+        }
+
+        /// Subtracts the new pivot symbols from the existing rows
+        void backward_substitute()
+        {
+            for(uint32_t j = 0; j < m_symbols; ++j)
+            {
+                const uint8_t *pivot = pivots(j);
+
+                uint8_t any = 0;
+
+                for(uint32_t g = 0; g < m_generations; ++g)
+                {
+                    uint32_t p = m_lane_pivots[g];
+                    uint8_t c = 0;
+
+                    if(p < m_symbols && pivot[g])
+                    {
+                        c = coefficient(j, p)[g];
+                    }
+
+                    m_lane_coefficients[g] = c;
+                    any |= c;
+                }
+
+                if(!any)
+                {
+                    continue;
+                }
+
+                for(uint32_t i = 0; i < m_symbols; ++i)
+                {
+                    multiply_add_lanes(coefficient(j, i),
+                                       &m_lane_coefficients[0],
+                                       staged_coefficient(i));
+                }
+
+                for(uint32_t b = 0; b < m_symbol_size; ++b)
+                {
+                    multiply_add_lanes(data(j, b),
+                                       &m_lane_coefficients[0],
+                                       staged_data(b));
+                }
+            }
+        }
+
+        /// Stores the new pivot symbols in their rows
+        void store_pivots()
+        {
+            for(uint32_t g = 0; g < m_generations; ++g)
+            {
+                uint32_t p = m_lane_pivots[g];
+
+                if(p == m_symbols)
+                {
+                    continue;
+                }
+
+                assert(!pivots(p)[g]);
+
+                for(uint32_t i = 0; i < m_symbols; ++i)
+                {
+                    coefficient(p, i)[g] = staged_coefficient(i)[g];
+                }
+
+                for(uint32_t b = 0; b < m_symbol_size; ++b)
+                {
+                    data(p, b)[g] = staged_data(b)[g];
+                }
+
+                pivots(p)[g] = 1U;
+                ++m_ranks[g];
+            }
+        }
+
+        /// Computes dest[g] += c[g] * src[g] for all the lanes
+        /// @param dest The destination lanes
+        /// @param c The coefficient of every lane
+        /// @param src The source lanes
+        void multiply_add_lanes(uint8_t *dest, const uint8_t *c,
+                                const uint8_t *src) const
+        {
+            const uint8_t reduction = m_reduction;
+
+            for(uint32_t g = 0; g < m_generations; ++g)
+            {
+                uint8_t a = c[g];
+                uint8_t x = src[g];
+                uint8_t product = 0;
+
+                // Shift-and-add multiplication, without branches so
+                // the loop over the lanes vectorizes
+                for(uint32_t bit = 0; bit < field_type::degree; ++bit)
+                {
+                    product ^= x & uint8_t(0U - (a & 1U));
+                    a >>= 1;
+                    x = uint8_t(x << 1) ^ (reduction & uint8_t(0U - (x >> 7)));
+                }
+
+                dest[g] ^= product;
+            }
+        }
+
+        /// Computes dest[g] = c[g] * dest[g] for all the lanes
+        /// @param dest The lanes
+        /// @param c The coefficient of every lane
+        void multiply_lanes(uint8_t *dest, const uint8_t *c) const
+        {
+            const uint8_t reduction = m_reduction;
+
+            for(uint32_t g = 0; g < m_generations; ++g)
+            {
+                uint8_t a = c[g];
+                uint8_t x = dest[g];
+                uint8_t product = 0;
+
+                for(uint32_t bit = 0; bit < field_type::degree; ++bit)
+                {
+                    product ^= x & uint8_t(0U - (a & 1U));
+                    a >>= 1;
+                    x = uint8_t(x << 1) ^ (reduction & uint8_t(0U - (x >> 7)));
+                }
+
+                dest[g] = product;
+            }
+        }
+
+        /// @return The lanes of a coefficient of a pivot row
+        uint8_t* coefficient(uint32_t row, uint32_t column)
+        {
+            return &m_coefficients[(row * m_symbols + column) *
+                                   m_generations];
+        }
+
+        /// @return The lanes of a byte of the symbol of a pivot row
+        uint8_t* data(uint32_t row, uint32_t byte)
+        {
+            return &m_data[(row * m_symbol_size + byte) * m_generations];
+        }
+
+        /// @return The lanes telling whether a pivot row is present
+        uint8_t* pivots(uint32_t row)
+        {
+            return &m_pivots[row * m_generations];
+        }
+
+        /// @return The lanes of a coefficient of the staged symbols
+        uint8_t* staged_coefficient(uint32_t column)
+        {
+            return &m_staged_coefficients[column * m_generations];
+        }
+
+        /// @return The lanes of a byte of the staged symbols
+        uint8_t* staged_data(uint32_t byte)
+        {
+            return &m_staged_data[byte * m_generations];
+        }
+
+    private:
+
+        /// The number of generations
+        uint32_t m_generations;
+
+        /// The number of symbols in a generation
+        uint32_t m_symbols;
+
+        /// The size of a symbol in bytes
+        uint32_t m_symbol_size;
+
+        /// The finite field implementation
+        field_impl m_field;
+
+        /// The reduction of the bit overflowing when multiplying with x
+        uint8_t m_reduction;
+
+        /// The coefficients of the pivot rows, [row][column][lane]
+        std::vector<uint8_t> m_coefficients;
+
+        /// The symbols of the pivot rows, [row][byte][lane]
+        std::vector<uint8_t> m_data;
+
+        /// The presence of the pivot rows, [row][lane]
+        std::vector<uint8_t> m_pivots;
+
+        /// The rank of every generation
+        std::vector<uint32_t> m_ranks;
+
+        /// The coefficients of the staged symbols, [column][lane]
+        std::vector<uint8_t> m_staged_coefficients;
+
+        /// The staged symbols, [byte][lane]
+        std::vector<uint8_t> m_staged_data;
+
+        /// The generations with a staged symbol
+        std::vector<uint8_t> m_staged;
+
+        /// Scratch lane coefficients
+        std::vector<uint8_t> m_lane_coefficients;
+
+        /// The pivots of the staged symbols, symbols() if none
+        std::vector<uint32_t> m_lane_pivots;
+
+    };
+
+}
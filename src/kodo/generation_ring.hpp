@@ -0,0 +1,228 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/aligned_allocator.hpp>
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @brief A ring buffer holding the blocks of the latest generations
+    ///        of a continuous stream.
+    ///
+    /// Generation g is kept in slot g % slots(), so a slot is reused for
+    /// a new generation once the generation slots() before it is done.
+    /// The producer of a stream writes the data of a generation directly
+    /// into its slot, where the encoder reads it, and the decoders
+    /// decode into the slots of their own ring, so the data is neither
+    /// copied into nor out of the coders. The buffer is allocated once
+    /// and never zeroed, see generation_stream.
+    class generation_ring : boost::noncopyable
+    {
+    public:
+
+        /// Constructs a new ring
+        /// @param slots The number of generations held
+        /// @param symbols The number of symbols of a generation
+        /// @param symbol_size The size of a symbol in bytes
+        generation_ring(uint32_t slots, uint32_t symbols,
+                        uint32_t symbol_size)
+            : m_slots(slots),
+              m_symbols(symbols),
+              m_symbol_size(symbol_size)
+        {
+            assert(m_slots > 0);
+            assert(m_symbols > 0);
+            assert(m_symbol_size > 0);
+
+            m_data.resize(uint64_t(m_slots) * block_size());
+        }
+
+        /// @return The number of generations held
+        uint32_t slots() const
+        {
+            return m_slots;
+        }
+
+        /// @return The number of symbols of a generation
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// @return The size of a symbol in bytes
+        uint32_t symbol_size() const
+        {
+            return m_symbol_size;
+        }
+
+        /// @return The size of a generation in bytes
+        uint32_t block_size() const
+        {
+            return m_symbols * m_symbol_size;
+        }
+
+        /// @param generation A generation of the stream
+        /// @return The slot of the generation
+        sak::mutable_storage slot(uint64_t generation)
+        {
+            return sak::storage(slot_data(generation), block_size());
+        }
+
+        /// @param generation A generation of the stream
+        /// @param index The index of a symbol of the generation
+        /// @return The symbol in the slot of the generation
+        sak::mutable_storage symbol(uint64_t generation, uint32_t index)
+        {
+            assert(index < m_symbols);
+
+            return sak::storage(
+                slot_data(generation) + index * m_symbol_size,
+                m_symbol_size);
+        }
+
+    private:
+
+        /// @param generation A generation of the stream
+        /// @return The first byte of the slot of the generation
+        uint8_t* slot_data(uint64_t generation)
+        {
+            uint64_t offset = (generation % m_slots) * block_size();
+            return &m_data[offset];
+        }
+
+    private:
+
+        /// The number of generations held
+        uint32_t m_slots;
+
+        /// The number of symbols of a generation
+        uint32_t m_symbols;
+
+        /// The size of a symbol in bytes
+        uint32_t m_symbol_size;
+
+        /// The slots
+        std::vector<uint8_t, sak::aligned_allocator<uint8_t> > m_data;
+
+    };
+
+    /// @brief Codes the generations of a continuous stream with a single
+    ///        coder bound to the slots of a generation_ring.
+    ///
+    /// Building a coder per generation and copying the data into its
+    /// storage costs a pool round trip and a copy of every generation.
+    /// Here one coder with shallow symbol storage, e.g. the
+    /// ring_full_rlnc_encoder or ring_full_rlnc_decoder, is built once
+    /// and rebind() moves it to the next generation by initializing it
+    /// again: only the decoding and systematic state of the symbols is
+    /// cleared, nothing is allocated and the data is not zeroed. The
+    /// symbols of the generation are then pointers into its slot.
+    ///
+    /// An encoder gets the symbols of a generation as the producer
+    /// writes them to the slot, with set_symbol(), and codes the symbols
+    /// it has, see the storage_aware_encoder. A decoder is bound to the
+    /// whole slot with set_symbols() and decodes into it.
+    template<class CoderType>
+    class generation_stream : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build the coder
+        typedef typename CoderType::factory factory;
+
+        /// Pointer to the coder
+        typedef typename CoderType::pointer pointer;
+
+    public:
+
+        /// Constructs a new stream and builds its coder
+        /// @param the_factory The factory building the coder, its
+        ///        maximum symbols and symbol size must fit the ring
+        /// @param ring The ring of the generations
+        generation_stream(factory &the_factory, generation_ring &ring)
+            : m_factory(the_factory),
+              m_ring(ring),
+              m_generation(0)
+        {
+            assert(ring.symbols() <= m_factory.max_symbols());
+            assert(ring.symbol_size() <= m_factory.max_symbol_size());
+
+            m_factory.set_symbols(ring.symbols());
+            m_factory.set_symbol_size(ring.symbol_size());
+
+            m_coder = m_factory.build();
+        }
+
+        /// Moves the coder to a generation, the symbols of the previous
+        /// generation are dropped. The factory must not be used for
+        /// coders of another size in between.
+        /// @param generation The new generation
+        void rebind(uint64_t generation)
+        {
+            assert(m_coder->symbols() == m_ring.symbols());
+            assert(m_coder->symbol_size() == m_ring.symbol_size());
+
+            m_coder->initialize(m_factory);
+            m_generation = generation;
+        }
+
+        /// Sets a symbol of the coder to its place in the slot of the
+        /// generation, e.g. when the producer has written it
+        /// @param index The index of the symbol
+        void set_symbol(uint32_t index)
+        {
+            m_coder->set_symbol(index, m_ring.symbol(m_generation, index));
+        }
+
+        /// Sets the symbols of the coder to the slot of the generation
+        void set_symbols()
+        {
+            m_coder->set_symbols(m_ring.slot(m_generation));
+        }
+
+        /// @return The coder
+        const pointer& coder() const
+        {
+            return m_coder;
+        }
+
+        /// @return The generation of the coder
+        uint64_t generation() const
+        {
+            return m_generation;
+        }
+
+        /// @return The slot of the generation of the coder
+        sak::mutable_storage slot()
+        {
+            return m_ring.slot(m_generation);
+        }
+
+    private:
+
+        /// The factory building the coder
+        factory &m_factory;
+
+        /// The ring of the generations
+        generation_ring &m_ring;
+
+        /// The generation of the coder
+        uint64_t m_generation;
+
+        /// The coder
+        pointer m_coder;
+
+    };
+
+}
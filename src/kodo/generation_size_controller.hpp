@@ -0,0 +1,271 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+namespace kodo
+{
+
+    /// The feedback of a receiver on a decoded block, see
+    /// adaptive_object_decoder::feedback()
+    struct block_feedback
+    {
+        /// Constructs a new feedback and zero initializes it
+        block_feedback()
+            : m_loss_rate(0),
+              m_decode_latency(0)
+        { }
+
+        /// The fraction of the payloads of the block lost before the
+        /// block was decoded
+        double m_loss_rate;
+
+        /// The seconds from the first payload of the block until it was
+        /// decoded
+        double m_decode_latency;
+    };
+
+    /// @brief Chooses the number of symbols of the next generation from
+    ///        the feedback of the receivers and the local CPU load.
+    ///
+    /// Larger generations lower the overhead of the coding, while the
+    /// coding cost per byte grows with the number of symbols and the
+    /// decoding latency of a block with its square. The controller
+    /// keeps the smoothed latency and CPU load normalized by these
+    /// costs, so it predicts them for any generation size, and moves
+    /// towards the largest size meeting the limits:
+    /// - If the predicted latency or CPU load of the current size is
+    ///   above its limit the size shrinks to meet it, by at most half
+    ///   per step.
+    /// - Otherwise, if the smoothed loss rate is at most the loss
+    ///   threshold, the size grows by the growth factor per step.
+    ///
+    /// The size stays within the minimum and maximum number of symbols,
+    /// the maximum is usually the max_symbols() of the factory. The
+    /// controller is used by the adaptive_object_encoder between
+    /// blocks.
+    class generation_size_controller
+    {
+    public:
+
+        /// Constructor, the first generations use the maximum size
+        /// @param min_symbols The smallest number of symbols
+        /// @param max_symbols The largest number of symbols
+        generation_size_controller(uint32_t min_symbols,
+                                   uint32_t max_symbols)
+            : m_min_symbols(min_symbols),
+              m_max_symbols(max_symbols),
+              m_symbols(max_symbols),
+              m_max_latency(0),
+              m_max_cpu_load(0.8),
+              m_loss_threshold(0.05),
+              m_growth(1.25),
+              m_smoothing(0.25),
+              m_feedback_reports(0),
+              m_cpu_reports(0),
+              m_loss_rate(0),
+              m_latency(0),
+              m_cpu_load(0)
+        {
+            assert(m_min_symbols > 0);
+            assert(m_min_symbols <= m_max_symbols);
+        }
+
+        /// Sets the largest decoding latency of a generation
+        /// @param seconds The latency in seconds, zero for no limit
+        void set_max_latency(double seconds)
+        {
+            assert(seconds >= 0);
+            m_max_latency = seconds;
+        }
+
+        /// Sets the largest share of the CPU time spent coding
+        /// @param load The load in (0, 1]
+        void set_max_cpu_load(double load)
+        {
+            assert(load > 0 && load <= 1);
+            m_max_cpu_load = load;
+        }
+
+        /// Sets the loss rate up to which the generations grow
+        /// @param loss_rate The loss rate in [0, 1)
+        void set_loss_threshold(double loss_rate)
+        {
+            assert(loss_rate >= 0 && loss_rate < 1);
+            m_loss_threshold = loss_rate;
+        }
+
+        /// Sets the factor by which the generations grow per step
+        /// @param growth The factor, larger than one
+        void set_growth(double growth)
+        {
+            assert(growth > 1);
+            m_growth = growth;
+        }
+
+        /// Sets the weight of a new report in the smoothed values
+        /// @param weight The weight in (0, 1], one for no smoothing
+        void set_smoothing(double weight)
+        {
+            assert(weight > 0 && weight <= 1);
+            m_smoothing = weight;
+        }
+
+        /// Sets the number of symbols of the next generation
+        /// @param symbols The number of symbols
+        void set_symbols(uint32_t symbols)
+        {
+            m_symbols = std::min(std::max(symbols, m_min_symbols),
+                                 m_max_symbols);
+        }
+
+        /// @return The number of symbols of the next generation
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// Reports the feedback of a receiver on a block
+        /// @param symbols The number of symbols of the block
+        /// @param feedback The feedback
+        void report_feedback(uint32_t symbols,
+                             const block_feedback &feedback)
+        {
+            assert(symbols > 0);
+            assert(feedback.m_loss_rate >= 0);
+            assert(feedback.m_decode_latency >= 0);
+
+            double s = symbols;
+
+            m_loss_rate = smooth(m_loss_rate, feedback.m_loss_rate,
+                                 m_feedback_reports);
+            m_latency = smooth(m_latency,
+                               feedback.m_decode_latency / (s * s),
+                               m_feedback_reports);
+
+            ++m_feedback_reports;
+
+            adapt();
+        }
+
+        /// Reports the share of the CPU time spent coding a block, e.g.
+        /// measured by the adaptive_object_encoder
+        /// @param symbols The number of symbols of the block
+        /// @param load The load in [0, 1]
+        void report_cpu_load(uint32_t symbols, double load)
+        {
+            assert(symbols > 0);
+            assert(load >= 0);
+
+            m_cpu_load = smooth(m_cpu_load, load / symbols, m_cpu_reports);
+
+            ++m_cpu_reports;
+
+            adapt();
+        }
+
+        /// @return The smoothed loss rate
+        double loss_rate() const
+        {
+            return m_loss_rate;
+        }
+
+    protected:
+
+        /// @param average The smoothed value
+        /// @param value The reported value
+        /// @param reports The number of earlier reports
+        /// @return The new smoothed value
+        double smooth(double average, double value, uint32_t reports) const
+        {
+            if(reports == 0)
+            {
+                return value;
+            }
+
+            return average + m_smoothing * (value - average);
+        }
+
+        /// Moves the size towards the largest size meeting the limits
+        void adapt()
+        {
+            double symbols = m_symbols;
+            double limit = m_max_symbols;
+
+            if(m_max_latency > 0 && m_latency > 0)
+            {
+                limit = std::min(limit,
+                                 std::sqrt(m_max_latency / m_latency));
+            }
+
+            if(m_cpu_load > 0)
+            {
+                limit = std::min(limit, m_max_cpu_load / m_cpu_load);
+            }
+
+            double target = symbols;
+
+            if(limit < symbols)
+            {
+                target = std::max(limit, symbols / 2);
+            }
+            else if(m_loss_rate <= m_loss_threshold)
+            {
+                target = std::min(limit, std::max(symbols + 1,
+                                                  symbols * m_growth));
+            }
+
+            set_symbols(static_cast<uint32_t>(target));
+        }
+
+    protected:
+
+        /// The smallest number of symbols
+        uint32_t m_min_symbols;
+
+        /// The largest number of symbols
+        uint32_t m_max_symbols;
+
+        /// The number of symbols of the next generation
+        uint32_t m_symbols;
+
+        /// The largest latency in seconds, zero for no limit
+        double m_max_latency;
+
+        /// The largest CPU load
+        double m_max_cpu_load;
+
+        /// The loss rate up to which the generations grow
+        double m_loss_threshold;
+
+        /// The growth factor per step
+        double m_growth;
+
+        /// The weight of a new report in the smoothed values
+        double m_smoothing;
+
+        /// The number of feedback reports
+        uint32_t m_feedback_reports;
+
+        /// The number of CPU load reports
+        uint32_t m_cpu_reports;
+
+        /// The smoothed loss rate
+        double m_loss_rate;
+
+        /// The smoothed latency per squared symbol
+        double m_latency;
+
+        /// The smoothed CPU load per symbol
+        double m_cpu_load;
+
+    };
+
+}
@@ -0,0 +1,39 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <type_traits>
+
+#include "storage_reader.hpp"
+
+namespace kodo
+{
+    /// Type trait helper which is true if the read() function of an
+    /// object_data implementation may be called from several threads at
+    /// the same time for different blocks. The parallel object coders
+    /// serialize the reads of other implementations, e.g. the
+    /// file_reader which shares a single file stream and buffer.
+    ///
+    /// Example:
+    ///
+    /// typedef kodo::storage_reader<encoder_t> reader_t;
+    ///
+    /// if(kodo::has_concurrent_read<reader_t>::value)
+    /// {
+    ///     // Do something here
+    /// }
+    ///
+    template<class ObjectData>
+    struct has_concurrent_read : std::false_type
+    { };
+
+    /// The storage_reader only reads the memory buffer it wraps
+    template<class EncoderType>
+    struct has_concurrent_read<storage_reader<EncoderType> >
+        : std::true_type
+    { };
+
+}
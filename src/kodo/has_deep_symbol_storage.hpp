@@ -24,8 +24,8 @@ namespace kodo
     template<class T>
     struct has_deep_symbol_storage
     {
-        template<class U>
-        static uint8_t test(const kodo::deep_symbol_storage<U> *);
+        template<class A, class U>
+        static uint8_t test(const kodo::basic_deep_symbol_storage<A, U> *);
 
         static uint32_t test(...);
 
@@ -0,0 +1,36 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include "payload_batch_encoder.hpp"
+
+namespace kodo
+{
+    /// Type trait helper allows compile time detection of whether an
+    /// encoder contains the payload_batch_encoder layer
+    ///
+    /// Example:
+    ///
+    /// typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    ///
+    /// if(kodo::has_payload_batch_encoder<encoder_t>::value)
+    /// {
+    ///     // Do something here
+    /// }
+    ///
+    template<class T>
+    struct has_payload_batch_encoder
+    {
+        template<class U>
+        static uint8_t test(const kodo::payload_batch_encoder<U> *);
+
+        static uint32_t test(...);
+
+        static const bool value = sizeof(test(static_cast<T*>(0))) == 1;
+    };
+}
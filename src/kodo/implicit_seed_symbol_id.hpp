@@ -0,0 +1,123 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "aligned_coefficients_buffer.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    /// @brief Base layer for the implicit seed symbol id reader and
+    ///        writer.
+    ///
+    /// Unlike the seed_symbol_id, the seed is not carried in the
+    /// payload but derived from a sequence number supplied by the
+    /// caller, e.g. the packet sequence number of the transport, so the
+    /// symbol id is empty. The sequence number is mixed into the seed,
+    /// so consecutive numbers yield unrelated coefficient vectors also
+    /// for generators whose output correlates for close seeds.
+    template<class SuperCoder>
+    class implicit_seed_symbol_id
+        : public aligned_coefficients_buffer<SuperCoder>
+    {
+    public:
+
+        /// Type of SuperCoder with injected aligned_coefficient_buffer
+        typedef aligned_coefficients_buffer<SuperCoder> Super;
+
+        /// The seed type from the generator used
+        typedef typename Super::seed_type seed_type;
+
+        /// The seed should be integral
+        static_assert(std::is_integral<seed_type>::value,
+                      "Seed must have an integral type");
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_id_size() const
+            uint32_t max_id_size() const
+            {
+                return 0;
+            }
+
+        };
+
+    public:
+
+        /// Constructor
+        implicit_seed_symbol_id()
+            : m_sequence_number(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            Super::initialize(the_factory);
+            m_sequence_number = 0;
+        }
+
+        /// @copydoc layer::id_size() const
+        uint32_t id_size() const
+        {
+            return 0;
+        }
+
+        /// Sets the sequence number of the next symbol to encode or
+        /// decode, the encoder and decoder must use the same number for
+        /// a symbol
+        /// @param sequence_number The sequence number of the symbol
+        void set_sequence_number(uint32_t sequence_number)
+        {
+            m_sequence_number = sequence_number;
+        }
+
+        /// @return The sequence number of the next symbol
+        uint32_t sequence_number() const
+        {
+            return m_sequence_number;
+        }
+
+        /// Mixes a sequence number into a seed, using the finalizer of
+        /// MurmurHash3 which maps every 32 bit value to a distinct value
+        /// @param sequence_number The sequence number
+        /// @return The seed of the symbol with the sequence number
+        static seed_type mix_seed(uint32_t sequence_number)
+        {
+            uint32_t h = sequence_number;
+
+            h ^= h >> 16;
+            h *= 0x85ebca6bU;
+            h ^= h >> 13;
+            h *= 0xc2b2ae35U;
+            h ^= h >> 16;
+
+            return (seed_type) h;
+        }
+
+    protected:
+
+        /// The sequence number of the next symbol
+        uint32_t m_sequence_number;
+
+    };
+
+}
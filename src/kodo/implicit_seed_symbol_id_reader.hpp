@@ -0,0 +1,56 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "implicit_seed_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @brief Seeds the generator layer from the sequence number set by
+    ///        the caller, which produces the coding coefficients of a
+    ///        symbol encoded by the implicit_seed_symbol_id_writer.
+    ///
+    /// The sequence number received with the payload must be set with
+    /// set_sequence_number() before the payload is decoded. Nothing is
+    /// read from the symbol id.
+    ///
+    /// @ingroup symbol_id_layers
+    template<class SuperCoder>
+    class implicit_seed_symbol_id_reader
+        : public implicit_seed_symbol_id<SuperCoder>
+    {
+    public:
+
+        /// Type of SuperCoder with injected symbol_coefficient_buffer
+        typedef implicit_seed_symbol_id<SuperCoder> Super;
+
+    public:
+
+        /// @copydoc layer::read_id(uint8_t*, uint8_t**)
+        void read_id(uint8_t *symbol_id, uint8_t **symbol_coefficients)
+        {
+            assert(symbol_id != 0);
+            assert(symbol_coefficients != 0);
+
+            Super::seed(Super::mix_seed(Super::sequence_number()));
+            Super::generate(&m_coefficients[0]);
+
+            *symbol_coefficients = &m_coefficients[0];
+        }
+
+    private:
+
+        /// Access the buffer in the coefficients buffer
+        /// layer used by the implicit_seed_symbol_id layer
+        using Super::m_coefficients;
+
+    };
+
+}
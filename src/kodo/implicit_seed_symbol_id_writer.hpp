@@ -0,0 +1,59 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "implicit_seed_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @brief Seeds the generator layer from the sequence number set by
+    ///        the caller and writes nothing as the symbol id.
+    ///
+    /// The sequence number must be set with set_sequence_number()
+    /// before every coded symbol is encoded, and must be sent along
+    /// with the payload, e.g. as the packet sequence number of the
+    /// transport, so the implicit_seed_symbol_id_reader can reproduce
+    /// the coefficients.
+    ///
+    /// @ingroup symbol_id_layers
+    template<class SuperCoder>
+    class implicit_seed_symbol_id_writer
+        : public implicit_seed_symbol_id<SuperCoder>
+    {
+    public:
+
+        /// Type of SuperCoder with injected symbol_coefficient_buffer
+        typedef implicit_seed_symbol_id<SuperCoder> Super;
+
+    public:
+
+        /// @copydoc layer::write_id(uint8_t*, uint8_t**)
+        uint32_t write_id(uint8_t *symbol_id, uint8_t **coefficients)
+        {
+            assert(symbol_id != 0);
+            assert(coefficients != 0);
+
+            Super::seed(Super::mix_seed(Super::sequence_number()));
+            Super::generate(&m_coefficients[0]);
+
+            *coefficients = &m_coefficients[0];
+
+            return 0;
+        }
+
+    private:
+
+        /// Access the buffer in the coefficients buffer
+        /// layer used by the implicit_seed_symbol_id layer
+        using Super::m_coefficients;
+
+    };
+
+}
@@ -0,0 +1,170 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <sak/convert_endian.hpp>
+#include <sak/storage.hpp>
+
+#include "systematic_base_coder.hpp"
+#include "thread_scratch.hpp"
+
+namespace kodo
+{
+
+    /// Tag of the thread_scratch buffer holding the symbols which the
+    /// in_place_systematic_decoder moves out of the decoding buffer
+    struct in_place_symbol_scratch { };
+
+    /// @ingroup codec_header_layers
+    /// @brief Receives systematic symbols directly into the symbol
+    ///        storage of a decoder.
+    ///
+    /// On links with few losses nearly all symbols are systematic and
+    /// arrive in order. The layer predicts where the next systematic
+    /// symbol belongs, so the caller can receive its data straight
+    /// into that symbol, e.g. with recvmsg() and an iovec pointing to
+    /// systematic_destination() followed by one for the header. If
+    /// the prediction holds, the decoder only marks the pivot, and the
+    /// symbol is neither copied nor touched by a field operation.
+    /// Otherwise the data is moved out of the storage and decoded as
+    /// usual.
+    ///
+    /// The layer is placed above the systematic_decoder and only works
+    /// with mutable shallow symbol storage, e.g. as used by the
+    /// shallow_storage_decoder, or other storage where the symbols are
+    /// not moved while decoding.
+    template<class SuperCoder>
+    class in_place_systematic_decoder : public SuperCoder
+    {
+    public:
+
+        /// The symbol count type
+        typedef typename systematic_base_coder::counter_type
+            counter_type;
+
+        /// The flag type
+        typedef typename systematic_base_coder::flag_type
+            flag_type;
+
+    public:
+
+        /// Constructor
+        in_place_systematic_decoder()
+            : m_next_systematic(0),
+              m_destination(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_next_systematic = 0;
+            m_destination = 0;
+        }
+
+        /// Predicts the storage of the next systematic symbol, which is
+        /// the first symbol after the last systematic symbol received
+        /// that is not yet decoded or partially decoded. The prediction
+        /// remains the same until decode_in_place() is called.
+        /// @return The symbol storage to receive the data of the next
+        ///         symbol into, or null if there is no such symbol
+        uint8_t* systematic_destination()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            while(m_next_systematic < symbols &&
+                  (SuperCoder::symbol_pivot(m_next_systematic) ||
+                   !SuperCoder::is_symbol_available(m_next_systematic)))
+            {
+                ++m_next_systematic;
+            }
+
+            if(m_next_systematic == symbols)
+            {
+                m_destination = 0;
+                return 0;
+            }
+
+            m_destination = SuperCoder::symbol(m_next_systematic);
+            return m_destination;
+        }
+
+        /// Decodes a symbol whose data may have been received into the
+        /// storage returned by systematic_destination(). Otherwise the
+        /// symbol data is any buffer, as for layer::decode(uint8_t*,
+        /// uint8_t*).
+        /// @param symbol_data The symbol data
+        /// @param symbol_header The symbol header
+        void decode_in_place(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            bool in_place = symbol_data == m_destination;
+
+            m_destination = 0;
+
+            flag_type flag =
+                sak::big_endian::get<flag_type>(symbol_header);
+
+            if(flag == systematic_base_coder::systematic_flag)
+            {
+                counter_type symbol_index =
+                    sak::big_endian::get<counter_type>(
+                        symbol_header + sizeof(flag_type));
+
+                assert(symbol_index < SuperCoder::symbols());
+
+                // The next systematic symbol is predicted to follow this
+                // one, also after a loss
+                m_next_systematic = symbol_index + 1;
+
+                if(in_place && symbol_data ==
+                   SuperCoder::symbol(symbol_index))
+                {
+                    // The prediction held. The symbol is stored where
+                    // it belongs, so the decoder only marks the pivot
+                    SuperCoder::decode_symbol(symbol_data, symbol_index);
+                    return;
+                }
+            }
+
+            if(in_place)
+            {
+                // The data occupies the storage of a symbol which is
+                // not decoded, and the decoder may write that symbol
+                // while it reads the data, so the data is moved out
+                uint32_t symbol_size = SuperCoder::symbol_size();
+
+                uint8_t *copy =
+                    thread_scratch<in_place_symbol_scratch>::data(
+                        symbol_size);
+
+                sak::copy_storage(sak::storage(copy, symbol_size),
+                                  sak::storage(symbol_data, symbol_size));
+
+                symbol_data = copy;
+            }
+
+            SuperCoder::decode(symbol_data, symbol_header);
+        }
+
+    protected:
+
+        /// The first symbol which may be the next systematic symbol
+        uint32_t m_next_systematic;
+
+        /// The storage returned by systematic_destination()
+        uint8_t *m_destination;
+
+    };
+
+}
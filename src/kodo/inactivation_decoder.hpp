@@ -0,0 +1,919 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Decoder for sparse codes using peeling and inactivation
+    ///        decoding.
+    ///
+    /// The linear_block_decoder keeps the symbols in reduced form,
+    /// which fills in the coefficient vectors of sparse codes so the
+    /// cost ends up as dense elimination over the generation. This
+    /// decoder instead keeps the received coefficient vectors sparse:
+    ///
+    /// - Peeling: a symbol with a single unresolved column becomes the
+    ///   pivot of that column, and the column is eliminated from the
+    ///   symbols containing it, which may produce new such symbols.
+    /// - Inactivation: once a generation worth of symbols has been
+    ///   received and the peeling stops, the unresolved column found in
+    ///   the most symbols is inactivated, i.e. treated as an unknown to
+    ///   be solved later, after which the peeling continues.
+    /// - When every column is either a pivot or inactive, the symbols
+    ///   left only contain inactive columns. This dense core is solved
+    ///   by Gauss-Jordan elimination, after which the inactive symbols
+    ///   are substituted into the pivot symbols.
+    ///
+    /// Only the core is dense, so when few columns are inactivated the
+    /// cost is close to linear in the number of non-zero coefficients.
+    /// How many columns are inactivated depends on the code, e.g. for
+    /// uniformly sparse encoding vectors with a few non-zero
+    /// coefficients about a third of the columns end up in the core,
+    /// whereas degree distributions made for peeling need only few.
+    /// The symbols are only decoded when the whole generation is, so
+    /// this layer does not support partial decoding or recoding.
+    template<class SuperCoder>
+    class inactivation_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// @copydoc layer::factory
+        typedef typename SuperCoder::factory factory;
+
+        /// A sparse coefficient vector, the non-zero coefficients
+        /// sorted by column
+        typedef std::vector<std::pair<uint32_t, value_type> >
+            sparse_vector;
+
+    protected:
+
+        /// The state of a column (i.e. a source symbol)
+        enum column_state
+        {
+            /// Not yet resolved
+            active_column,
+            /// Has a pivot symbol from the peeling
+            pivot_column,
+            /// Solved by the dense core
+            inactive_column
+        };
+
+        /// A received symbol which has not become a pivot
+        struct pending_row
+        {
+            /// The non-zero coefficients
+            sparse_vector m_coefficients;
+
+            /// The symbol data
+            std::vector<uint8_t> m_data;
+
+            /// The number of active columns in the coefficients
+            uint32_t m_degree;
+
+            /// True while the row is in use
+            bool m_pending;
+        };
+
+    public:
+
+        /// Constructor
+        inactivation_decoder()
+            : m_active(0),
+              m_pivots(0),
+              m_core_rank(0),
+              m_received(0),
+              m_classified(false)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            uint32_t max_symbols = the_factory.max_symbols();
+
+            uint32_t max_length =
+                fifi::elements_to_length<field_type>(max_symbols);
+
+            m_states.resize(max_symbols, active_column);
+            m_pivot_rows.resize(max_symbols);
+            m_column_rows.resize(max_symbols);
+            m_core_index.resize(max_symbols, 0);
+            m_core_coefficients.resize(max_symbols);
+
+            // The sparse vectors are swapped between the rows, the pivot
+            // rows and the scratch vectors, so all of them hold room for
+            // every column and decoding does not allocate
+            for(uint32_t i = 0; i < max_symbols; ++i)
+            {
+                m_pivot_rows[i].reserve(max_symbols);
+                m_core_coefficients[i].reserve(max_length);
+            }
+
+            m_merge.reserve(max_symbols);
+            m_incoming.reserve(max_symbols);
+
+            // Room for a pending row per column and the received row
+            m_rows.reserve(max_symbols + 1);
+            m_free_rows.reserve(max_symbols + 1);
+
+            m_peelable.reserve(max_symbols + 1);
+            m_core_rows.reserve(max_symbols + 1);
+            m_inactive_columns.reserve(max_symbols);
+            m_core_pivots.reserve(max_symbols);
+            m_dense.reserve(max_length);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            uint32_t symbols = the_factory.symbols();
+
+            std::fill_n(m_states.begin(), symbols, active_column);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                m_pivot_rows[i].clear();
+                m_column_rows[i].clear();
+            }
+
+            m_free_rows.clear();
+
+            for(uint32_t i = 0; i < m_rows.size(); ++i)
+            {
+                m_rows[i].m_pending = false;
+                m_free_rows.push_back(i);
+            }
+
+            m_peelable.clear();
+            m_core_rows.clear();
+            m_inactive_columns.clear();
+            m_core_pivots.clear();
+
+            m_active = symbols;
+            m_pivots = 0;
+            m_core_rank = 0;
+            m_received = 0;
+            m_classified = false;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *symbol_coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_coefficients != 0);
+
+            if(is_complete())
+            {
+                return;
+            }
+
+            const value_type *coefficients =
+                reinterpret_cast<const value_type*>(symbol_coefficients);
+
+            uint32_t r = allocate_row();
+            sparse_vector &row = m_rows[r].m_coefficients;
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                value_type value =
+                    fifi::get_value<field_type>(coefficients, i);
+
+                if(value)
+                {
+                    row.push_back(std::make_pair(i, value));
+                }
+            }
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        &m_rows[r].m_data[0]);
+
+            add_row(r);
+        }
+
+        /// Decodes a symbol from the list of its non-zero coefficients,
+        /// which avoids scanning the coefficient vector
+        /// @param symbol_data The encoded symbol
+        /// @param indices The symbol indices of the non-zero
+        ///        coefficients in increasing order
+        /// @param coefficients The values of the non-zero coefficients
+        /// @param count The number of non-zero coefficients
+        void decode_symbol(uint8_t *symbol_data, const uint32_t *indices,
+                           const value_type *coefficients, uint32_t count)
+        {
+            assert(symbol_data != 0);
+            assert(count == 0 || indices != 0);
+            assert(count == 0 || coefficients != 0);
+
+            if(is_complete())
+            {
+                return;
+            }
+
+            uint32_t r = allocate_row();
+            sparse_vector &row = m_rows[r].m_coefficients;
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                assert(indices[i] < SuperCoder::symbols());
+                assert(i == 0 || indices[i - 1] < indices[i]);
+                assert(coefficients[i] != 0);
+
+                row.push_back(std::make_pair(indices[i], coefficients[i]));
+            }
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        &m_rows[r].m_data[0]);
+
+            add_row(r);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*, uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            if(is_complete())
+            {
+                return;
+            }
+
+            uint32_t r = allocate_row();
+
+            value_type one = 1U;
+            m_rows[r].m_coefficients.push_back(
+                std::make_pair(symbol_index, one));
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        &m_rows[r].m_data[0]);
+
+            add_row(r);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return rank() == SuperCoder::symbols();
+        }
+
+        /// The rank only counts the pivots from the peeling and the
+        /// rank of the dense core, so until the decoding completes it
+        /// may be lower than the rank of the received symbols.
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_pivots + m_core_rank;
+        }
+
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+
+            if(m_states[index] == pivot_column)
+            {
+                return true;
+            }
+
+            return m_states[index] == inactive_column && m_classified &&
+                m_core_pivots[m_core_index[index]];
+        }
+
+        /// @return The number of inactivated symbols, i.e. the size of
+        ///         the dense core
+        uint32_t inactive_symbols() const
+        {
+            return static_cast<uint32_t>(m_inactive_columns.size());
+        }
+
+    protected:
+
+        /// @return The index of an unused pending row
+        uint32_t allocate_row()
+        {
+            uint32_t r;
+
+            if(m_free_rows.empty())
+            {
+                r = static_cast<uint32_t>(m_rows.size());
+                m_rows.push_back(pending_row());
+                m_rows[r].m_coefficients.reserve(m_pivot_rows.size());
+            }
+            else
+            {
+                r = m_free_rows.back();
+                m_free_rows.pop_back();
+            }
+
+            pending_row &row = m_rows[r];
+
+            row.m_coefficients.clear();
+            row.m_data.resize(SuperCoder::symbol_size());
+            row.m_degree = 0;
+            row.m_pending = true;
+
+            return r;
+        }
+
+        /// Returns a pending row to the unused rows
+        /// @param r The row
+        void release_row(uint32_t r)
+        {
+            assert(m_rows[r].m_pending);
+
+            m_rows[r].m_pending = false;
+            m_free_rows.push_back(r);
+        }
+
+        /// Adds a received symbol and continues the decoding
+        /// @param r The row holding the symbol
+        void add_row(uint32_t r)
+        {
+            ++m_received;
+
+            eliminate_pivots(r);
+
+            pending_row &row = m_rows[r];
+
+            if(row.m_coefficients.empty())
+            {
+                // Linearly dependent
+                release_row(r);
+            }
+            else if(m_classified)
+            {
+                insert_core(r);
+                release_row(r);
+            }
+            else
+            {
+                for(const auto &entry : row.m_coefficients)
+                {
+                    if(m_states[entry.first] == active_column)
+                    {
+                        m_column_rows[entry.first].push_back(r);
+                        ++row.m_degree;
+                    }
+                }
+
+                update_degree(r);
+            }
+
+            solve();
+        }
+
+        /// Eliminates the pivot columns from a received symbol, which
+        /// only adds inactive columns since the pivot rows do not
+        /// contain other active or pivot columns
+        /// @param r The row holding the symbol
+        void eliminate_pivots(uint32_t r)
+        {
+            pending_row &row = m_rows[r];
+
+            m_incoming.clear();
+            m_incoming.swap(row.m_coefficients);
+
+            for(const auto &entry : m_incoming)
+            {
+                if(m_states[entry.first] != pivot_column)
+                {
+                    row.m_coefficients.push_back(entry);
+                }
+            }
+
+            value_type *symbol = reinterpret_cast<value_type*>(&row.m_data[0]);
+
+            for(const auto &entry : m_incoming)
+            {
+                if(m_states[entry.first] != pivot_column)
+                {
+                    continue;
+                }
+
+                subtract(row.m_coefficients, m_pivot_rows[entry.first],
+                         entry.second);
+
+                subtract(symbol, SuperCoder::symbol_value(entry.first),
+                         entry.second, SuperCoder::symbol_length());
+            }
+        }
+
+        /// Queues a pending row for peeling or for the dense core
+        /// depending on its number of active columns
+        /// @param r The row
+        void update_degree(uint32_t r)
+        {
+            if(m_rows[r].m_degree == 1)
+            {
+                m_peelable.push_back(r);
+            }
+            else if(m_rows[r].m_degree == 0)
+            {
+                m_core_rows.push_back(r);
+            }
+        }
+
+        /// Runs the peeling and inactivation as far as possible, and
+        /// completes the decoding when the dense core has full rank
+        void solve()
+        {
+            peel();
+
+            while(!m_classified)
+            {
+                if(m_active == 0)
+                {
+                    classify();
+                    break;
+                }
+
+                // Inactivating before a generation worth of symbols is
+                // received would make the core needlessly large
+                if(m_received < SuperCoder::symbols())
+                {
+                    return;
+                }
+
+                inactivate();
+                peel();
+            }
+
+            if(m_core_rank == m_inactive_columns.size())
+            {
+                finish();
+            }
+        }
+
+        /// Turns the pending rows with a single active column into
+        /// pivots
+        void peel()
+        {
+            while(!m_peelable.empty())
+            {
+                uint32_t r = m_peelable.back();
+                m_peelable.pop_back();
+
+                // The row may have become a pivot or lost its last
+                // active column since it was queued
+                if(m_rows[r].m_pending && m_rows[r].m_degree == 1)
+                {
+                    pivot(r);
+                }
+            }
+        }
+
+        /// Makes a row with a single active column the pivot of that
+        /// column, and eliminates the column from the pending rows
+        /// @param r The row
+        void pivot(uint32_t r)
+        {
+            pending_row &row = m_rows[r];
+
+            auto it = std::find_if(
+                row.m_coefficients.begin(), row.m_coefficients.end(),
+                [this](const std::pair<uint32_t, value_type> &entry)
+                {
+                    return m_states[entry.first] == active_column;
+                });
+
+            assert(it != row.m_coefficients.end());
+
+            uint32_t column = it->first;
+            value_type coefficient = it->second;
+
+            row.m_coefficients.erase(it);
+
+            if(!fifi::is_binary<field_type>::value && coefficient != 1U)
+            {
+                value_type inverted = SuperCoder::invert(coefficient);
+
+                for(auto &entry : row.m_coefficients)
+                {
+                    entry.second =
+                        SuperCoder::m_field->multiply(entry.second, inverted);
+                }
+
+                SuperCoder::multiply(
+                    reinterpret_cast<value_type*>(&row.m_data[0]),
+                    inverted, SuperCoder::symbol_length());
+            }
+
+            // The pivot row keeps its inactive columns, the coefficient
+            // of the pivot column is one
+            m_pivot_rows[column].swap(row.m_coefficients);
+
+            std::copy_n(&row.m_data[0], SuperCoder::symbol_size(),
+                        SuperCoder::symbol(column));
+
+            m_states[column] = pivot_column;
+            --m_active;
+            ++m_pivots;
+
+            release_row(r);
+
+            const value_type *symbol = SuperCoder::symbol_value(column);
+
+            for(uint32_t q : m_column_rows[column])
+            {
+                pending_row &other = m_rows[q];
+
+                if(!other.m_pending)
+                {
+                    continue;
+                }
+
+                auto entry = std::lower_bound(
+                    other.m_coefficients.begin(),
+                    other.m_coefficients.end(),
+                    std::make_pair(column, value_type(0)));
+
+                assert(entry != other.m_coefficients.end());
+                assert(entry->first == column);
+
+                value_type value = entry->second;
+                other.m_coefficients.erase(entry);
+
+                subtract(other.m_coefficients, m_pivot_rows[column], value);
+
+                subtract(reinterpret_cast<value_type*>(&other.m_data[0]),
+                         symbol, value, SuperCoder::symbol_length());
+
+                --other.m_degree;
+                update_degree(q);
+            }
+
+            m_column_rows[column].clear();
+        }
+
+        /// Inactivates the active column contained in the most pending
+        /// rows
+        void inactivate()
+        {
+            uint32_t best = SuperCoder::symbols();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(m_states[i] != active_column)
+                {
+                    continue;
+                }
+
+                if(best == SuperCoder::symbols() ||
+                   m_column_rows[i].size() > m_column_rows[best].size())
+                {
+                    best = i;
+                }
+            }
+
+            assert(best < SuperCoder::symbols());
+            inactivate_column(best);
+        }
+
+        /// Inactivates a column
+        /// @param column The column
+        void inactivate_column(uint32_t column)
+        {
+            assert(m_states[column] == active_column);
+
+            m_states[column] = inactive_column;
+            --m_active;
+
+            m_inactive_columns.push_back(column);
+
+            for(uint32_t q : m_column_rows[column])
+            {
+                if(!m_rows[q].m_pending)
+                {
+                    continue;
+                }
+
+                --m_rows[q].m_degree;
+                update_degree(q);
+            }
+
+            m_column_rows[column].clear();
+        }
+
+        /// Sets up the dense core once every column is either a pivot or
+        /// inactive, and moves the remaining rows into it
+        void classify()
+        {
+            assert(m_active == 0);
+            assert(m_peelable.empty());
+
+            m_classified = true;
+
+            uint32_t inactive = inactive_symbols();
+
+            for(uint32_t i = 0; i < inactive; ++i)
+            {
+                m_core_index[m_inactive_columns[i]] = i;
+            }
+
+            uint32_t length = fifi::elements_to_length<field_type>(inactive);
+
+            for(uint32_t i = 0; i < inactive; ++i)
+            {
+                m_core_coefficients[i].assign(length, 0);
+            }
+
+            m_core_pivots.assign(inactive, false);
+            m_dense.resize(length);
+
+            for(uint32_t r : m_core_rows)
+            {
+                assert(m_rows[r].m_pending);
+                assert(m_rows[r].m_degree == 0);
+
+                insert_core(r);
+                release_row(r);
+            }
+
+            m_core_rows.clear();
+        }
+
+        /// Adds a row with only inactive columns to the dense core using
+        /// Gauss-Jordan elimination
+        /// @param r The row
+        void insert_core(uint32_t r)
+        {
+            assert(m_classified);
+
+            uint32_t inactive = inactive_symbols();
+            uint32_t length = fifi::elements_to_length<field_type>(inactive);
+
+            value_type *coefficients = &m_dense[0];
+            std::fill_n(coefficients, length, 0);
+
+            for(const auto &entry : m_rows[r].m_coefficients)
+            {
+                assert(m_states[entry.first] == inactive_column);
+
+                fifi::set_value<field_type>(
+                    coefficients, m_core_index[entry.first], entry.second);
+            }
+
+            value_type *symbol =
+                reinterpret_cast<value_type*>(&m_rows[r].m_data[0]);
+
+            // The core pivot rows are reduced, so subtracting them
+            // clears all the pivot columns in one pass
+            for(uint32_t i = 0; i < inactive; ++i)
+            {
+                value_type value =
+                    fifi::get_value<field_type>(coefficients, i);
+
+                if(!value || !m_core_pivots[i])
+                {
+                    continue;
+                }
+
+                subtract(coefficients, &m_core_coefficients[i][0], value,
+                         length);
+
+                subtract(symbol,
+                         SuperCoder::symbol_value(m_inactive_columns[i]),
+                         value, SuperCoder::symbol_length());
+            }
+
+            uint32_t pivot = inactive;
+
+            for(uint32_t i = 0; i < inactive; ++i)
+            {
+                if(fifi::get_value<field_type>(coefficients, i))
+                {
+                    pivot = i;
+                    break;
+                }
+            }
+
+            if(pivot == inactive)
+            {
+                // Linearly dependent
+                return;
+            }
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                value_type inverted = SuperCoder::invert(
+                    fifi::get_value<field_type>(coefficients, pivot));
+
+                SuperCoder::multiply(coefficients, inverted, length);
+                SuperCoder::multiply(symbol, inverted,
+                                     SuperCoder::symbol_length());
+            }
+
+            for(uint32_t i = 0; i < inactive; ++i)
+            {
+                if(!m_core_pivots[i])
+                {
+                    continue;
+                }
+
+                value_type value = fifi::get_value<field_type>(
+                    &m_core_coefficients[i][0], pivot);
+
+                if(!value)
+                {
+                    continue;
+                }
+
+                subtract(&m_core_coefficients[i][0], coefficients, value,
+                         length);
+
+                subtract(SuperCoder::symbol_value(m_inactive_columns[i]),
+                         symbol, value, SuperCoder::symbol_length());
+            }
+
+            std::copy_n(coefficients, length,
+                        m_core_coefficients[pivot].begin());
+
+            std::copy_n(&m_rows[r].m_data[0], SuperCoder::symbol_size(),
+                        SuperCoder::symbol(m_inactive_columns[pivot]));
+
+            m_core_pivots[pivot] = true;
+            ++m_core_rank;
+        }
+
+        /// Substitutes the solved inactive symbols into the pivot
+        /// symbols
+        void finish()
+        {
+            assert(m_classified);
+            assert(is_complete());
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(m_states[i] != pivot_column)
+                {
+                    continue;
+                }
+
+                value_type *symbol = SuperCoder::symbol_value(i);
+
+                for(const auto &entry : m_pivot_rows[i])
+                {
+                    subtract(symbol, SuperCoder::symbol_value(entry.first),
+                             entry.second, SuperCoder::symbol_length());
+                }
+
+                m_pivot_rows[i].clear();
+            }
+        }
+
+        /// Computes dest = dest - coefficient * src for sparse vectors
+        /// @param dest The destination vector
+        /// @param src The source vector
+        /// @param coefficient The coefficient
+        void subtract(sparse_vector &dest, const sparse_vector &src,
+                      value_type coefficient)
+        {
+            if(src.empty())
+            {
+                return;
+            }
+
+            // The result has at most one entry per column, which the
+            // capacity reserved in construct() covers
+            m_merge.clear();
+
+            auto d = dest.begin();
+            auto s = src.begin();
+
+            while(d != dest.end() || s != src.end())
+            {
+                if(s == src.end() || (d != dest.end() && d->first < s->first))
+                {
+                    m_merge.push_back(*d++);
+                    continue;
+                }
+
+                value_type product =
+                    SuperCoder::m_field->multiply(coefficient, s->second);
+
+                value_type value = 0;
+
+                if(d != dest.end() && d->first == s->first)
+                {
+                    value = d++->second;
+                }
+
+                value = SuperCoder::m_field->subtract(value, product);
+
+                if(value)
+                {
+                    m_merge.push_back(std::make_pair(s->first, value));
+                }
+
+                ++s;
+            }
+
+            dest.swap(m_merge);
+        }
+
+        /// Computes dest = dest - coefficient * src
+        /// @param dest The destination buffer
+        /// @param src The source buffer
+        /// @param coefficient The coefficient
+        /// @param length The length of the buffers in value_type elements
+        void subtract(value_type *dest, const value_type *src,
+                      value_type coefficient, uint32_t length)
+        {
+            if(fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::subtract(dest, src, length);
+            }
+            else
+            {
+                SuperCoder::multiply_subtract(dest, src, coefficient, length);
+            }
+        }
+
+    protected:
+
+        /// The states of the columns
+        std::vector<uint8_t> m_states;
+
+        /// The inactive columns of the pivot row of every pivot column
+        std::vector<sparse_vector> m_pivot_rows;
+
+        /// The pending rows containing every active column
+        std::vector<std::vector<uint32_t> > m_column_rows;
+
+        /// The received symbols which have not become pivots
+        std::vector<pending_row> m_rows;
+
+        /// The unused pending rows
+        std::vector<uint32_t> m_free_rows;
+
+        /// Pending rows queued for peeling
+        std::vector<uint32_t> m_peelable;
+
+        /// Pending rows with only inactive columns
+        std::vector<uint32_t> m_core_rows;
+
+        /// The inactive columns, in the order of the core columns
+        std::vector<uint32_t> m_inactive_columns;
+
+        /// The core column of every inactive column
+        std::vector<uint32_t> m_core_index;
+
+        /// The coefficients of the core pivot rows
+        std::vector<std::vector<value_type> > m_core_coefficients;
+
+        /// The core columns with a pivot row
+        std::vector<bool> m_core_pivots;
+
+        /// Scratch dense coefficient vector of the core
+        std::vector<value_type> m_dense;
+
+        /// Scratch sparse vector
+        sparse_vector m_merge;
+
+        /// Scratch copy of the coefficients of a received symbol
+        sparse_vector m_incoming;
+
+        /// The number of active columns
+        uint32_t m_active;
+
+        /// The number of pivots from the peeling
+        uint32_t m_pivots;
+
+        /// The rank of the dense core
+        uint32_t m_core_rank;
+
+        /// The number of symbols received
+        uint32_t m_received;
+
+        /// True once every column is a pivot or inactive
+        bool m_classified;
+
+    };
+
+}
@@ -0,0 +1,117 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <limits>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+#include "block_id_header.hpp"
+#include "bounded_object_decoder.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Decodes the stream of payloads of an
+    ///        interleaved_object_encoder.
+    ///
+    /// The block id in front of every payload selects the decoder of
+    /// the block, which is looked up by index in constant time. The
+    /// decoders are managed by a bounded_object_decoder: they are built
+    /// on the first payload of their block and released as soon as the
+    /// block is decoded into the object buffer. By default their memory
+    /// is unbounded.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class interleaved_object_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// The decoder managing the block decoders
+        typedef bounded_object_decoder<DecoderType, BlockPartitioning>
+            object_decoder_type;
+
+    public:
+
+        /// Constructs a new interleaved object decoder
+        /// @param decoder_factory The decoder factory to use
+        /// @param object The buffer receiving the decoded object
+        /// @param memory_budget The maximum memory in bytes of the live
+        ///        decoders, see bounded_object_decoder
+        interleaved_object_decoder(
+            factory &decoder_factory, const sak::mutable_storage &object,
+            uint64_t memory_budget = std::numeric_limits<uint64_t>::max())
+            : m_object_decoder(decoder_factory, object, memory_budget),
+              m_id_size(block_id_size(m_object_decoder.blocks()))
+        { }
+
+        /// Decodes a payload produced by the interleaved_object_encoder
+        /// @param payload The payload, which is modified by the decoder
+        /// @return The block id of the payload
+        uint32_t decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint32_t block_id = read_block_id(m_id_size, payload);
+            assert(block_id < m_object_decoder.blocks());
+
+            m_object_decoder.decode(block_id, payload + m_id_size);
+            return block_id;
+        }
+
+        /// @return The size in bytes of the block id of a payload
+        uint32_t id_size() const
+        {
+            return m_id_size;
+        }
+
+        /// @return The number of blocks of the object
+        uint32_t blocks() const
+        {
+            return m_object_decoder.blocks();
+        }
+
+        /// @return True if all blocks of the object are decoded
+        bool is_complete() const
+        {
+            return m_object_decoder.is_complete();
+        }
+
+        /// @param block_id The block
+        /// @return True if the block is decoded
+        bool is_block_complete(uint32_t block_id) const
+        {
+            return m_object_decoder.is_block_complete(block_id);
+        }
+
+        /// @return The decoder managing the block decoders, e.g. to set
+        ///         the spill directory
+        object_decoder_type& block_decoders()
+        {
+            return m_object_decoder;
+        }
+
+    private:
+
+        /// The decoder managing the block decoders
+        object_decoder_type m_object_decoder;
+
+        /// The size of the block id
+        uint32_t m_id_size;
+    };
+
+}
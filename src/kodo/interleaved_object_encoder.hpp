@@ -0,0 +1,215 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "block_id_header.hpp"
+#include "object_encoder.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Encodes an object split over multiple encoders as a
+    ///        single stream of payloads.
+    ///
+    /// Every payload starts with the id of its block, see
+    /// block_id_size(), followed by the payload of the block encoder.
+    /// The blocks are scheduled with a smooth weighted round-robin, each
+    /// block has a priority, by default one, and is picked in
+    /// proportion to it with the picks of the blocks spread evenly over
+    /// the stream. With equal priorities consecutive payloads belong to
+    /// consecutive blocks, so a burst of losses is spread over the
+    /// blocks instead of erasing one of them. A block with priority zero
+    /// is not scheduled, e.g. when the receiver acknowledged it.
+    ///
+    /// The payloads are decoded with the interleaved_object_decoder.
+    template
+    <
+        class ObjectData,
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class interleaved_object_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build encoders
+        typedef typename EncoderType::factory factory_type;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer_type;
+
+        /// The object encoder building the block encoders
+        typedef object_encoder<ObjectData, EncoderType, BlockPartitioning>
+            object_encoder_type;
+
+    public:
+
+        /// Constructs a new interleaved object encoder and builds the
+        /// encoders of all the blocks
+        /// @param factory The encoder factory to use
+        /// @param data The object to encode
+        interleaved_object_encoder(factory_type &factory,
+                                   const ObjectData &data)
+            : m_object_encoder(factory, data),
+              m_payload_size(0)
+        {
+            uint32_t blocks = m_object_encoder.encoders();
+
+            m_id_size = block_id_size(blocks);
+
+            m_encoders.resize(blocks);
+            m_priorities.resize(blocks, 1);
+            m_credits.resize(blocks, 0);
+
+            for(uint32_t i = 0; i < blocks; ++i)
+            {
+                m_encoders[i] = m_object_encoder.build(i);
+                m_payload_size = std::max(
+                    m_payload_size, m_encoders[i]->payload_size());
+            }
+        }
+
+        /// @return The number of blocks of the object
+        uint32_t blocks() const
+        {
+            return static_cast<uint32_t>(m_encoders.size());
+        }
+
+        /// @return The size in bytes of the block id of a payload
+        uint32_t id_size() const
+        {
+            return m_id_size;
+        }
+
+        /// @return The size of the largest payload including the block id
+        uint32_t payload_size() const
+        {
+            return m_id_size + m_payload_size;
+        }
+
+        /// @return The encoder of a block, e.g. to change its settings
+        /// @param block_id The block
+        pointer_type encoder(uint32_t block_id) const
+        {
+            assert(block_id < m_encoders.size());
+            return m_encoders[block_id];
+        }
+
+        /// Sets the priority of a block, a block is scheduled in
+        /// proportion to its priority and zero stops the scheduling
+        /// @param block_id The block
+        /// @param priority The priority
+        void set_priority(uint32_t block_id, uint32_t priority)
+        {
+            assert(block_id < m_priorities.size());
+
+            m_priorities[block_id] = priority;
+            m_credits[block_id] = 0;
+        }
+
+        /// @return The priority of a block
+        /// @param block_id The block
+        uint32_t priority(uint32_t block_id) const
+        {
+            assert(block_id < m_priorities.size());
+            return m_priorities[block_id];
+        }
+
+        /// @return True if a block with a non-zero priority is left
+        bool has_scheduled_blocks() const
+        {
+            return std::find_if(m_priorities.begin(), m_priorities.end(),
+                                [](uint32_t p) { return p > 0; })
+                != m_priorities.end();
+        }
+
+        /// Encodes a payload of the next scheduled block
+        /// @param payload The buffer of at least payload_size() bytes
+        /// @return The number of bytes used
+        uint32_t encode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint32_t block_id = next_block();
+            return encode(block_id, payload);
+        }
+
+        /// Encodes a payload of a specific block
+        /// @param block_id The block
+        /// @param payload The buffer of at least payload_size() bytes
+        /// @return The number of bytes used
+        uint32_t encode(uint32_t block_id, uint8_t *payload)
+        {
+            assert(block_id < m_encoders.size());
+            assert(payload != 0);
+
+            write_block_id(block_id, m_id_size, payload);
+
+            return m_id_size +
+                m_encoders[block_id]->encode(payload + m_id_size);
+        }
+
+        /// @return The block of the next payload, and advances the
+        ///         schedule
+        uint32_t next_block()
+        {
+            assert(has_scheduled_blocks());
+
+            // Smooth weighted round-robin: every block earns its
+            // priority, the richest block is picked and pays the total
+            int64_t total = 0;
+            uint32_t best = 0;
+
+            for(uint32_t i = 0; i < m_priorities.size(); ++i)
+            {
+                if(m_priorities[i] == 0)
+                {
+                    continue;
+                }
+
+                m_credits[i] += m_priorities[i];
+                total += m_priorities[i];
+
+                if(m_priorities[best] == 0 || m_credits[i] > m_credits[best])
+                {
+                    best = i;
+                }
+            }
+
+            m_credits[best] -= total;
+            return best;
+        }
+
+    private:
+
+        /// The object encoder building the block encoders
+        object_encoder_type m_object_encoder;
+
+        /// The encoders of the blocks
+        std::vector<pointer_type> m_encoders;
+
+        /// The priorities of the blocks
+        std::vector<uint32_t> m_priorities;
+
+        /// The scheduling credits of the blocks
+        std::vector<int64_t> m_credits;
+
+        /// The size of the block id
+        uint32_t m_id_size;
+
+        /// The size of the largest block payload
+        uint32_t m_payload_size;
+    };
+
+}
@@ -0,0 +1,104 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../coefficient_info.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../linear_block_encoder.hpp"
+
+#include "ldpc_staircase_encoder.hpp"
+#include "ldpc_staircase_decoder.hpp"
+#include "ldpc_staircase_symbol_id.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Complete stack implementing an LDPC-staircase encoder,
+    ///        RFC 5170.
+    ///
+    /// The key features of this configuration is the following:
+    /// - Systematic encoding (uncoded symbols produced before switching
+    ///   to coding)
+    /// - A fixed rate code, set with factory::set_code_rate(), whose
+    ///   repair symbols are sums of a few source symbols. Encoding only
+    ///   uses XOR and costs a few symbol additions per source symbol
+    ///   whatever the size of the block, so large objects may be
+    ///   encoded as a single block.
+    /// - The symbol id is the index of the symbol in the code.
+    class ldpc_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 ldpc_staircase_encoder<
+                 // Symbol ID API
+                 ldpc_staircase_symbol_id<
+                 // Codec API
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<fifi::default_field<fifi::binary>::type,
+                 finite_field_info<fifi::binary,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 ldpc_encoder
+                     > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Implementation of a complete LDPC-staircase decoder
+    ///
+    /// The ldpc_staircase_decoder decodes the symbols by iterative
+    /// peeling, falling back to Gaussian elimination of the equations
+    /// left when the peeling stops. The factory must use the code rate,
+    /// left degree and seed of the encoder.
+    class ldpc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 ldpc_staircase_decoder<
+                 // Symbol ID API
+                 ldpc_staircase_symbol_id<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<fifi::default_field<fifi::binary>::type,
+                 finite_field_info<fifi::binary,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 ldpc_decoder
+                     > > > > > > > > > > >
+    { };
+
+}
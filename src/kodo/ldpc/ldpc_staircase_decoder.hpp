@@ -0,0 +1,619 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+
+#include "ldpc_staircase_matrix.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Decodes the symbols of an LDPC-staircase code, RFC 5170,
+    ///        by iterative peeling with a Gaussian elimination fallback.
+    ///
+    /// The unknowns are the source and the repair symbols, and every row
+    /// of the ldpc_staircase_matrix is an equation whose symbols sum to
+    /// zero. The repair symbols are kept in the layer, the source
+    /// symbols in the symbol storage.
+    ///
+    /// - Peeling: a received symbol is known, and an equation with a
+    ///   single unknown symbol left gives that symbol as the sum of the
+    ///   known ones, which may leave other equations with a single
+    ///   unknown. This is the iterative decoding of RFC 5170 and only
+    ///   uses XOR of a few symbols per decoded symbol.
+    /// - Gaussian elimination: once layer::symbols() symbols have been
+    ///   received and the peeling stops, the equations left are solved
+    ///   for all unknown symbols over GF(2). The equations are first
+    ///   eliminated as bit vectors to find an independent set, so only
+    ///   a solvable system is eliminated on the symbol data. If the
+    ///   equations do not determine the unknowns, the elimination gives
+    ///   the number of undetermined unknowns. A received symbol
+    ///   determines at most one more unknown, so the elimination is
+    ///   only retried once that many new symbols have been received.
+    ///
+    /// The layer provides the Codec Header API below the
+    /// systematic_decoder and is only used with the binary field.
+    template<class SuperCoder>
+    class ldpc_staircase_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// @copydoc ldpc_staircase_symbol_id::symbol_id_type
+        typedef typename SuperCoder::symbol_id_type symbol_id_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer providing the header size
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_header_size() const
+            uint32_t max_header_size() const
+            {
+                return SuperCoder::factory::max_id_size();
+            }
+        };
+
+    public:
+
+        /// Constructor
+        ldpc_staircase_decoder()
+            : m_decoded(0),
+              m_received(0),
+              m_undetermined(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            const ldpc_staircase_matrix &matrix =
+                SuperCoder::parity_check_matrix();
+
+            uint32_t repair_symbols = matrix.repair_symbols();
+
+            m_known.assign(matrix.code_length(), false);
+            m_arrived.assign(matrix.code_length(), false);
+            m_core_index.resize(matrix.code_length());
+
+            // Every row has its sources, its own repair symbol and the
+            // previous repair symbol except for the first row
+            m_unknowns.resize(repair_symbols);
+
+            for(uint32_t r = 0; r < repair_symbols; ++r)
+            {
+                m_unknowns[r] = static_cast<uint32_t>(
+                    matrix.row(r).size()) + (r > 0 ? 2 : 1);
+            }
+
+            m_repair_data.resize(repair_symbols * SuperCoder::symbol_size());
+
+            m_peelable.clear();
+            m_decoded = 0;
+            m_received = 0;
+            m_undetermined = 0;
+        }
+
+        /// Decodes a symbol, the header contains its symbol id
+        /// @copydoc layer::decode(uint8_t*, uint8_t*)
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint32_t symbol_id =
+                sak::big_endian::get<symbol_id_type>(symbol_header);
+
+            assert(symbol_id < SuperCoder::code_length());
+
+            receive(symbol_id, symbol_data);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            receive(symbol_index, symbol_data);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_decoded == SuperCoder::symbols();
+        }
+
+        /// The rank only counts the decoded source symbols, so until
+        /// the decoding completes it may be lower than the rank of the
+        /// received symbols.
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_decoded;
+        }
+
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_known[index];
+        }
+
+        /// @copydoc layer::header_size() const
+        uint32_t header_size() const
+        {
+            return SuperCoder::id_size();
+        }
+
+        /// @return The number of distinct symbols received until the
+        ///         decoding completed, including the symbols which were
+        ///         already decoded when they arrived
+        uint32_t received_symbols() const
+        {
+            return m_received;
+        }
+
+    protected:
+
+        /// @param index The symbol id of a source or repair symbol
+        /// @return The data of the symbol
+        value_type* symbol_data(uint32_t index)
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            if(index < symbols)
+            {
+                return SuperCoder::symbol_value(index);
+            }
+
+            return reinterpret_cast<value_type*>(
+                &m_repair_data[(index - symbols) * SuperCoder::symbol_size()]);
+        }
+
+        /// Calls a function with the rows containing a symbol
+        /// @param index The symbol id of a source or repair symbol
+        /// @param function The function called with every row
+        template<class Function>
+        void for_each_row(uint32_t index, Function function) const
+        {
+            const ldpc_staircase_matrix &matrix =
+                SuperCoder::parity_check_matrix();
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            if(index < symbols)
+            {
+                for(uint32_t r : matrix.column(index))
+                    function(r);
+
+                return;
+            }
+
+            uint32_t r = index - symbols;
+
+            function(r);
+
+            if(r + 1 < matrix.repair_symbols())
+                function(r + 1);
+        }
+
+        /// Calls a function with the symbols of a row
+        /// @param row The row
+        /// @param function The function called with the symbol id of
+        ///        every symbol of the row
+        template<class Function>
+        void for_each_symbol(uint32_t row, Function function) const
+        {
+            const ldpc_staircase_matrix &matrix =
+                SuperCoder::parity_check_matrix();
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t j : matrix.row(row))
+                function(j);
+
+            if(row > 0)
+                function(symbols + row - 1);
+
+            function(symbols + row);
+        }
+
+        /// Stores a received symbol and continues the decoding
+        /// @param index The symbol id
+        /// @param data The symbol data
+        void receive(uint32_t index, const uint8_t *data)
+        {
+            if(is_complete() || m_arrived[index])
+            {
+                return;
+            }
+
+            m_arrived[index] = true;
+            ++m_received;
+
+            // A symbol decoded by the peeling adds no equation
+            if(m_known[index])
+            {
+                return;
+            }
+
+            std::copy_n(data, SuperCoder::symbol_size(),
+                        reinterpret_cast<uint8_t*>(symbol_data(index)));
+
+            set_known(index);
+            peel();
+
+            if(m_undetermined > 0)
+            {
+                --m_undetermined;
+            }
+
+            if(!is_complete() && m_received >= SuperCoder::symbols() &&
+               m_undetermined == 0)
+            {
+                solve_core();
+            }
+        }
+
+        /// Marks a symbol as known and queues the rows left with a
+        /// single unknown symbol
+        /// @param index The symbol id
+        void set_known(uint32_t index)
+        {
+            assert(!m_known[index]);
+
+            m_known[index] = true;
+
+            if(index < SuperCoder::symbols())
+            {
+                ++m_decoded;
+            }
+
+            for_each_row(index, [this](uint32_t r)
+            {
+                assert(m_unknowns[r] > 0);
+
+                if(--m_unknowns[r] == 1)
+                    m_peelable.push_back(r);
+            });
+        }
+
+        /// Decodes the single unknown symbol of the queued rows until
+        /// no such row is left
+        void peel()
+        {
+            while(!m_peelable.empty() && !is_complete())
+            {
+                uint32_t r = m_peelable.back();
+                m_peelable.pop_back();
+
+                // The last unknown may have been decoded by another row
+                if(m_unknowns[r] != 1)
+                    continue;
+
+                uint32_t unknown = 0;
+
+                for_each_symbol(r, [this, &unknown](uint32_t c)
+                {
+                    if(!m_known[c])
+                        unknown = c;
+                });
+
+                sum_known(r, symbol_data(unknown));
+                set_known(unknown);
+            }
+        }
+
+        /// Sums the known symbols of a row
+        /// @param row The row
+        /// @param dest The buffer of the sum
+        void sum_known(uint32_t row, value_type *dest)
+        {
+            uint32_t length = SuperCoder::symbol_length();
+            bool first = true;
+
+            for_each_symbol(row, [&](uint32_t c)
+            {
+                if(!m_known[c])
+                    return;
+
+                if(first)
+                {
+                    std::copy_n(symbol_data(c), length, dest);
+                    first = false;
+                }
+                else
+                {
+                    SuperCoder::add(dest, symbol_data(c), length);
+                }
+            });
+
+            if(first)
+            {
+                std::fill_n(dest, length, 0);
+            }
+        }
+
+        /// Solves the rows with unknown symbols by Gaussian elimination,
+        /// if they determine all unknown symbols
+        void solve_core()
+        {
+            const ldpc_staircase_matrix &matrix =
+                SuperCoder::parity_check_matrix();
+
+            m_core_columns.clear();
+            m_core_rows.clear();
+
+            for(uint32_t c = 0; c < matrix.code_length(); ++c)
+            {
+                if(m_known[c])
+                    continue;
+
+                m_core_index[c] = static_cast<uint32_t>(m_core_columns.size());
+                m_core_columns.push_back(c);
+            }
+
+            for(uint32_t r = 0; r < matrix.repair_symbols(); ++r)
+            {
+                if(m_unknowns[r] > 0)
+                    m_core_rows.push_back(r);
+            }
+
+            uint32_t columns = static_cast<uint32_t>(m_core_columns.size());
+            uint32_t rows = static_cast<uint32_t>(m_core_rows.size());
+
+            // At least the unknown symbols beyond the rows are not
+            // determined
+            if(rows < columns)
+            {
+                m_undetermined = columns - rows;
+                return;
+            }
+
+            uint32_t words = (columns + 63) / 64;
+
+            // The unknown symbols of every row as a bit vector
+            m_core_bits.assign(rows * words, 0);
+
+            for(uint32_t i = 0; i < rows; ++i)
+            {
+                uint64_t *bits = &m_core_bits[i * words];
+
+                for_each_symbol(m_core_rows[i], [&](uint32_t c)
+                {
+                    if(!m_known[c])
+                    {
+                        uint32_t k = m_core_index[c];
+                        bits[k / 64] |= uint64_t(1) << (k % 64);
+                    }
+                });
+            }
+
+            m_undetermined = select_core_rows(rows, columns, words);
+
+            if(m_undetermined > 0)
+            {
+                return;
+            }
+
+            // Gauss-Jordan elimination of the selected rows, which are
+            // independent, with the sums of their known symbols
+            uint32_t symbol_size = SuperCoder::symbol_size();
+            uint32_t length = SuperCoder::symbol_length();
+
+            m_square_bits.resize(columns * words);
+            m_core_data.resize(columns * symbol_size);
+            m_order.resize(columns);
+
+            for(uint32_t k = 0; k < columns; ++k)
+            {
+                uint32_t i = m_selected[k];
+
+                std::copy_n(&m_core_bits[i * words], words,
+                            &m_square_bits[k * words]);
+
+                sum_known(m_core_rows[i], core_data(k));
+
+                m_order[k] = k;
+            }
+
+            for(uint32_t col = 0; col < columns; ++col)
+            {
+                uint32_t word = col / 64;
+                uint64_t mask = uint64_t(1) << (col % 64);
+
+                uint32_t p = col;
+
+                while(!(m_square_bits[m_order[p] * words + word] & mask))
+                {
+                    ++p;
+                    assert(p < columns);
+                }
+
+                std::swap(m_order[col], m_order[p]);
+
+                uint32_t pivot = m_order[col];
+                const uint64_t *pivot_bits = &m_square_bits[pivot * words];
+
+                for(uint32_t k = 0; k < columns; ++k)
+                {
+                    if(k == pivot)
+                        continue;
+
+                    uint64_t *bits = &m_square_bits[k * words];
+
+                    if(!(bits[word] & mask))
+                        continue;
+
+                    for(uint32_t w = word; w < words; ++w)
+                        bits[w] ^= pivot_bits[w];
+
+                    SuperCoder::add(core_data(k), core_data(pivot), length);
+                }
+            }
+
+            // Every unknown symbol is now the sum of its row
+            for(uint32_t col = 0; col < columns; ++col)
+            {
+                std::copy_n(core_data(m_order[col]), length,
+                            symbol_data(m_core_columns[col]));
+            }
+
+            for(uint32_t col = 0; col < columns; ++col)
+            {
+                set_known(m_core_columns[col]);
+            }
+
+            m_peelable.clear();
+
+            assert(is_complete());
+        }
+
+        /// Selects one independent row per unknown symbol by forward
+        /// elimination of the bit vectors of the rows
+        /// @param rows The number of rows
+        /// @param columns The number of unknown symbols
+        /// @param words The number of words of a bit vector
+        /// @return The number of unknown symbols without a row, zero if
+        ///         the rows determine all unknown symbols
+        uint32_t select_core_rows(uint32_t rows, uint32_t columns,
+                                  uint32_t words)
+        {
+            m_work_bits = m_core_bits;
+            m_used.assign(rows, false);
+            m_selected.clear();
+
+            for(uint32_t col = 0; col < columns; ++col)
+            {
+                uint32_t word = col / 64;
+                uint64_t mask = uint64_t(1) << (col % 64);
+
+                uint32_t pivot = rows;
+
+                for(uint32_t i = 0; i < rows; ++i)
+                {
+                    if(!m_used[i] && (m_work_bits[i * words + word] & mask))
+                    {
+                        pivot = i;
+                        break;
+                    }
+                }
+
+                // The elimination continues to count the unknown
+                // symbols which are not determined
+                if(pivot == rows)
+                {
+                    continue;
+                }
+
+                m_used[pivot] = true;
+                m_selected.push_back(pivot);
+
+                const uint64_t *pivot_bits = &m_work_bits[pivot * words];
+
+                for(uint32_t i = pivot + 1; i < rows; ++i)
+                {
+                    uint64_t *bits = &m_work_bits[i * words];
+
+                    if(m_used[i] || !(bits[word] & mask))
+                        continue;
+
+                    for(uint32_t w = word; w < words; ++w)
+                        bits[w] ^= pivot_bits[w];
+                }
+            }
+
+            return columns - static_cast<uint32_t>(m_selected.size());
+        }
+
+        /// @param k A row of the square system
+        /// @return The sum of the known symbols of the row
+        value_type* core_data(uint32_t k)
+        {
+            return reinterpret_cast<value_type*>(
+                &m_core_data[k * SuperCoder::symbol_size()]);
+        }
+
+    protected:
+
+        /// The number of decoded source symbols
+        uint32_t m_decoded;
+
+        /// The number of distinct symbols received
+        uint32_t m_received;
+
+        /// The number of unknown symbols the last elimination did not
+        /// determine, less the symbols received since
+        uint32_t m_undetermined;
+
+        /// Whether every source and repair symbol is known
+        std::vector<bool> m_known;
+
+        /// Whether every source and repair symbol has been received
+        std::vector<bool> m_arrived;
+
+        /// The number of unknown symbols of every row
+        std::vector<uint32_t> m_unknowns;
+
+        /// The rows which may have a single unknown symbol
+        std::vector<uint32_t> m_peelable;
+
+        /// The repair symbols
+        std::vector<uint8_t> m_repair_data;
+
+        /// The unknown symbols while solving the core
+        std::vector<uint32_t> m_core_columns;
+
+        /// The position of every unknown symbol in the core columns
+        std::vector<uint32_t> m_core_index;
+
+        /// The rows with unknown symbols while solving the core
+        std::vector<uint32_t> m_core_rows;
+
+        /// The unknown symbols of the core rows as bit vectors
+        std::vector<uint64_t> m_core_bits;
+
+        /// The bit vectors eliminated to select the independent rows
+        std::vector<uint64_t> m_work_bits;
+
+        /// The core rows used as pivots
+        std::vector<bool> m_used;
+
+        /// The selected core row of every unknown symbol
+        std::vector<uint32_t> m_selected;
+
+        /// The bit vectors of the selected rows
+        std::vector<uint64_t> m_square_bits;
+
+        /// The sums of the known symbols of the selected rows
+        std::vector<uint8_t> m_core_data;
+
+        /// The row of the square system solving every unknown symbol
+        std::vector<uint32_t> m_order;
+
+    };
+
+}
@@ -0,0 +1,231 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+#include <sak/storage.hpp>
+
+#include "ldpc_staircase_matrix.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Encodes the symbols of an LDPC-staircase code, RFC 5170.
+    ///
+    /// The layer provides the Codec Header API below the
+    /// systematic_encoder. The symbols are produced in the order of
+    /// their symbol ids, i.e. the source symbols followed by the repair
+    /// symbols, and the code is repeated once all have been produced.
+    /// The systematic symbols produced above the layer count as the
+    /// first source symbols.
+    ///
+    /// The repair symbols only use XOR: repair symbol r is repair
+    /// symbol r - 1 plus the few source symbols of row r of the
+    /// ldpc_staircase_matrix, so encoding all of them costs N1 symbol
+    /// additions per source symbol, N1 being the left degree of the
+    /// code. They are computed in one pass when the first repair symbol
+    /// is requested.
+    template<class SuperCoder>
+    class ldpc_staircase_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// @copydoc ldpc_staircase_symbol_id::symbol_id_type
+        typedef typename SuperCoder::symbol_id_type symbol_id_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer providing the header size
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_header_size() const
+            uint32_t max_header_size() const
+            {
+                return SuperCoder::factory::max_id_size();
+            }
+        };
+
+    public:
+
+        /// Constructor
+        ldpc_staircase_encoder()
+            : m_encoded(0),
+              m_repair_ready(false)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_repair_data.resize(
+                SuperCoder::repair_symbols() * SuperCoder::symbol_size());
+
+            m_encoded = 0;
+            m_repair_ready = false;
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            SuperCoder::set_symbols(symbol_storage);
+            m_repair_ready = false;
+        }
+
+        /// @copydoc layer::set_symbol(uint32_t,const sak::const_storage&)
+        void set_symbol(uint32_t index, const sak::const_storage &symbol)
+        {
+            SuperCoder::set_symbol(index, symbol);
+            m_repair_ready = false;
+        }
+
+        /// Encodes the symbol with the next symbol id, which is written
+        /// to the header
+        /// @copydoc layer::encode(uint8_t*, uint8_t*)
+        uint32_t encode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint32_t symbol_id = m_encoded % SuperCoder::code_length();
+            ++m_encoded;
+
+            sak::big_endian::put<symbol_id_type>(symbol_id, symbol_header);
+
+            if(symbol_id < SuperCoder::symbols())
+            {
+                SuperCoder::encode_symbol(symbol_data, symbol_id);
+            }
+            else
+            {
+                const uint8_t *repair =
+                    repair_symbol(symbol_id - SuperCoder::symbols());
+
+                std::copy_n(repair, SuperCoder::symbol_size(), symbol_data);
+            }
+
+            return sizeof(symbol_id_type);
+        }
+
+        /// Counts the systematic symbols
+        /// @copydoc layer::encode_symbol(uint8_t*,uint32_t)
+        void encode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            ++m_encoded;
+            SuperCoder::encode_symbol(symbol_data, symbol_index);
+        }
+
+        /// Counts the systematic symbols
+        /// @copydoc linear_block_encoder::encode_symbol_in_place(uint32_t)
+        const uint8_t* encode_symbol_in_place(uint32_t symbol_index)
+        {
+            ++m_encoded;
+            return SuperCoder::encode_symbol_in_place(symbol_index);
+        }
+
+        /// @copydoc layer::header_size() const
+        uint32_t header_size() const
+        {
+            return SuperCoder::id_size();
+        }
+
+        /// @return The offset of the symbol id in the header of a coded
+        ///         symbol, the id is written at the start of the header
+        uint32_t symbol_id_offset() const
+        {
+            return 0;
+        }
+
+        /// Returns a repair symbol, computing all repair symbols of the
+        /// block if the symbols of the encoder have been set since. The
+        /// symbols of the encoder must be set.
+        /// @param index The index of the repair symbol, its symbol id
+        ///        minus layer::symbols()
+        /// @return The repair symbol of layer::symbol_size() bytes
+        const uint8_t* repair_symbol(uint32_t index)
+        {
+            assert(index < SuperCoder::repair_symbols());
+
+            if(!m_repair_ready)
+            {
+                encode_repair_symbols();
+            }
+
+            return &m_repair_data[index * SuperCoder::symbol_size()];
+        }
+
+        /// Computes all repair symbols of the block, the symbols of the
+        /// encoder must be set. Called by repair_symbol(), but may be
+        /// called again if the data of the symbols changed in place.
+        void encode_repair_symbols()
+        {
+            const ldpc_staircase_matrix &matrix =
+                SuperCoder::parity_check_matrix();
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+            uint32_t symbol_length = SuperCoder::symbol_length();
+
+            for(uint32_t r = 0; r < matrix.repair_symbols(); ++r)
+            {
+                value_type *repair = reinterpret_cast<value_type*>(
+                    &m_repair_data[r * symbol_size]);
+
+                if(r == 0)
+                {
+                    std::fill_n(repair, symbol_length, 0);
+                }
+                else
+                {
+                    std::copy_n(repair - symbol_length, symbol_length,
+                                repair);
+                }
+
+                for(uint32_t j : matrix.row(r))
+                {
+                    const value_type *symbol = SuperCoder::symbol_value(j);
+
+                    // Did you forget to set the data on the encoder?
+                    assert(symbol != 0);
+
+                    SuperCoder::add(repair, symbol, symbol_length);
+                }
+            }
+
+            m_repair_ready = true;
+        }
+
+    protected:
+
+        /// The number of symbols produced
+        uint32_t m_encoded;
+
+        /// True if the repair symbols have been computed
+        bool m_repair_ready;
+
+        /// The repair symbols
+        std::vector<uint8_t> m_repair_data;
+
+    };
+
+}
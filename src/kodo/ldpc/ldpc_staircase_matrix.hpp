@@ -0,0 +1,258 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @brief The pseudo-random generator of RFC 5170, the "minimal
+    ///        standard" generator of Park and Miller.
+    ///
+    /// The parity check matrix is built from this generator so that the
+    /// encoder and decoder, or another RFC 5170 implementation, produce
+    /// the same matrix from the same seed.
+    class ldpc_staircase_random
+    {
+    public:
+
+        /// Constructs the generator
+        /// @param seed The seed, in [1, 0x7FFFFFFE]
+        explicit ldpc_staircase_random(uint32_t seed)
+            : m_seed(seed)
+        {
+            assert(seed > 0);
+            assert(seed < 0x7FFFFFFF);
+        }
+
+        /// @return The next value in [1, 0x7FFFFFFE]
+        uint32_t next31()
+        {
+            uint32_t hi = 16807 * (m_seed >> 16);
+            uint32_t lo = 16807 * (m_seed & 0xFFFF);
+
+            lo += (hi & 0x7FFF) << 16;
+            lo += hi >> 15;
+
+            if(lo > 0x7FFFFFFF)
+                lo -= 0x7FFFFFFF;
+
+            m_seed = lo;
+            return lo;
+        }
+
+        /// @param max_value The upper bound
+        /// @return The next value in [0, max_value)
+        uint32_t next(uint32_t max_value)
+        {
+            return static_cast<uint32_t>(
+                static_cast<double>(next31()) * max_value / 0x7FFFFFFF);
+        }
+
+    private:
+
+        /// The state of the generator
+        uint32_t m_seed;
+
+    };
+
+    /// @brief The parity check matrix of an LDPC-staircase code, RFC 5170.
+    ///
+    /// The matrix has one row per repair symbol and one column per
+    /// source and repair symbol, H = [H1 | H2]. In H1 every source
+    /// column has left_degree() ones, spread evenly over the rows, and
+    /// H2 is the staircase, i.e. row r contains repair symbols r - 1 and
+    /// r. The repair symbols are therefore encoded in one pass:
+    ///
+    /// @code
+    ///   p_0 = sum of the sources of row 0
+    ///   p_r = p_(r-1) + sum of the sources of row r
+    /// @endcode
+    ///
+    /// Only H1 is stored, as the sources of every row and the rows of
+    /// every source.
+    class ldpc_staircase_matrix
+    {
+    public:
+
+        /// Builds the matrix as in section 5.5 of RFC 5170
+        /// @param symbols The number of source symbols k
+        /// @param repair_symbols The number of repair symbols n - k
+        /// @param left_degree The number of ones per source column N1,
+        ///        at most the number of repair symbols are used
+        /// @param seed The seed of the ldpc_staircase_random generator
+        ldpc_staircase_matrix(uint32_t symbols, uint32_t repair_symbols,
+                              uint32_t left_degree, uint32_t seed)
+            : m_symbols(symbols),
+              m_repair_symbols(repair_symbols),
+              m_rows(repair_symbols),
+              m_columns(symbols)
+        {
+            assert(m_symbols > 0);
+            assert(m_repair_symbols > 0);
+            assert(left_degree > 0);
+
+            // A column cannot have more distinct rows than the matrix
+            uint32_t degree = std::min(left_degree, m_repair_symbols);
+
+            ldpc_staircase_random random(seed);
+
+            // The row of every one still to place, so the ones are
+            // spread evenly over the rows
+            uint32_t choices = degree * m_symbols;
+            std::vector<uint32_t> u(choices);
+
+            for(uint32_t h = 0; h < choices; ++h)
+            {
+                u[h] = h % m_repair_symbols;
+            }
+
+            // The choices before t have been used
+            uint32_t t = 0;
+
+            for(uint32_t j = 0; j < m_symbols; ++j)
+            {
+                for(uint32_t h = 0; h < degree; ++h)
+                {
+                    uint32_t i = t;
+
+                    while(i < choices && has_entry(u[i], j))
+                        ++i;
+
+                    if(i < choices)
+                    {
+                        do
+                        {
+                            i = t + random.next(choices - t);
+                        }
+                        while(has_entry(u[i], j));
+
+                        insert_entry(u[i], j);
+
+                        u[i] = u[t];
+                        ++t;
+                    }
+                    else
+                    {
+                        do
+                        {
+                            i = random.next(m_repair_symbols);
+                        }
+                        while(has_entry(i, j));
+
+                        insert_entry(i, j);
+                    }
+                }
+            }
+
+            // Every row gets at least two sources, or one if the block
+            // has a single source symbol
+            for(uint32_t i = 0; i < m_repair_symbols; ++i)
+            {
+                if(m_rows[i].empty())
+                {
+                    insert_entry(i, random.next(m_symbols));
+                }
+
+                if(m_rows[i].size() == 1 && m_symbols > 1)
+                {
+                    uint32_t j;
+
+                    do
+                    {
+                        j = random.next(m_symbols);
+                    }
+                    while(has_entry(i, j));
+
+                    insert_entry(i, j);
+                }
+            }
+
+            for(auto &row : m_rows)
+            {
+                std::sort(row.begin(), row.end());
+            }
+
+            for(auto &column : m_columns)
+            {
+                std::sort(column.begin(), column.end());
+            }
+        }
+
+        /// @return The number of source symbols
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// @return The number of repair symbols, i.e. the rows
+        uint32_t repair_symbols() const
+        {
+            return m_repair_symbols;
+        }
+
+        /// @return The number of source and repair symbols
+        uint32_t code_length() const
+        {
+            return m_symbols + m_repair_symbols;
+        }
+
+        /// @param index The row
+        /// @return The source symbols of the row in increasing order
+        const std::vector<uint32_t>& row(uint32_t index) const
+        {
+            assert(index < m_repair_symbols);
+            return m_rows[index];
+        }
+
+        /// @param index The source symbol
+        /// @return The rows containing the source symbol in increasing
+        ///         order
+        const std::vector<uint32_t>& column(uint32_t index) const
+        {
+            assert(index < m_symbols);
+            return m_columns[index];
+        }
+
+    private:
+
+        /// @return True if the source symbol is in the row
+        bool has_entry(uint32_t row, uint32_t column) const
+        {
+            const auto &rows = m_columns[column];
+            return std::find(rows.begin(), rows.end(), row) != rows.end();
+        }
+
+        /// Adds a source symbol to a row
+        void insert_entry(uint32_t row, uint32_t column)
+        {
+            assert(!has_entry(row, column));
+
+            m_rows[row].push_back(column);
+            m_columns[column].push_back(row);
+        }
+
+    private:
+
+        /// The number of source symbols
+        uint32_t m_symbols;
+
+        /// The number of repair symbols
+        uint32_t m_repair_symbols;
+
+        /// The source symbols of every row
+        std::vector<std::vector<uint32_t> > m_rows;
+
+        /// The rows of every source symbol
+        std::vector<std::vector<uint32_t> > m_columns;
+
+    };
+
+}
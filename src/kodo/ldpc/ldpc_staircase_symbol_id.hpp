@@ -0,0 +1,213 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <map>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "ldpc_staircase_matrix.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_id_layers
+    ///
+    /// @brief Provides the parity check matrix of an LDPC-staircase code
+    ///        to the encoder and decoder layers. The symbol id is the
+    ///        index of the symbol in the code, the encoding symbol id of
+    ///        RFC 5170, where the source symbols come first.
+    ///
+    /// The matrices are cached in the factory by the number of symbols,
+    /// a block gets its matrix when it is initialized.
+    /// The encoder and decoder factories must use the same code rate,
+    /// left degree and seed.
+    template<class SuperCoder>
+    class ldpc_staircase_symbol_id : public SuperCoder
+    {
+    public:
+
+        /// The type of the symbol id
+        typedef uint32_t symbol_id_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer building and caching the matrices
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_code_rate(2.0 / 3.0),
+                  m_left_degree(3),
+                  m_seed(1)
+            { }
+
+            /// Returns the parity check matrix of a block, building and
+            /// caching it if it is not already cached
+            /// @param symbols The number of source symbols
+            /// @return The parity check matrix
+            boost::shared_ptr<ldpc_staircase_matrix>
+            parity_check_matrix(uint32_t symbols)
+            {
+                auto it = m_cache.find(symbols);
+
+                if(it != m_cache.end())
+                {
+                    return it->second;
+                }
+
+                auto matrix = boost::make_shared<ldpc_staircase_matrix>(
+                    symbols, repair_symbols(symbols), m_left_degree,
+                    m_seed);
+
+                m_cache[symbols] = matrix;
+
+                return matrix;
+            }
+
+            /// @copydoc layer::max_id_size() const
+            uint32_t max_id_size() const
+            {
+                return sizeof(symbol_id_type);
+            }
+
+            /// Sets the code rate k / n of the blocks built afterwards
+            /// @param code_rate The code rate in (0, 1)
+            void set_code_rate(double code_rate)
+            {
+                assert(code_rate > 0.0);
+                assert(code_rate < 1.0);
+
+                m_code_rate = code_rate;
+                m_cache.clear();
+            }
+
+            /// @return The code rate k / n
+            double code_rate() const
+            {
+                return m_code_rate;
+            }
+
+            /// Sets the number of rows of every source symbol, N1 in
+            /// RFC 5170
+            /// @param left_degree The left degree, at least 1
+            void set_left_degree(uint32_t left_degree)
+            {
+                assert(left_degree > 0);
+
+                m_left_degree = left_degree;
+                m_cache.clear();
+            }
+
+            /// @return The number of rows of every source symbol
+            uint32_t left_degree() const
+            {
+                return m_left_degree;
+            }
+
+            /// Sets the seed of the parity check matrix
+            /// @param seed The seed, in [1, 0x7FFFFFFE]
+            void set_seed(uint32_t seed)
+            {
+                assert(seed > 0);
+                assert(seed < 0x7FFFFFFF);
+
+                m_seed = seed;
+                m_cache.clear();
+            }
+
+            /// @return The seed of the parity check matrix
+            uint32_t seed() const
+            {
+                return m_seed;
+            }
+
+            /// @param symbols The number of source symbols
+            /// @return The number of repair symbols of a block at the
+            ///         code rate, at least one
+            uint32_t repair_symbols(uint32_t symbols) const
+            {
+                uint32_t code_length = static_cast<uint32_t>(
+                    std::ceil(symbols / m_code_rate - 1e-9));
+
+                return std::max(code_length, symbols + 1) - symbols;
+            }
+
+        private:
+
+            /// The code rate k / n
+            double m_code_rate;
+
+            /// The number of rows of every source symbol
+            uint32_t m_left_degree;
+
+            /// The seed of the matrices
+            uint32_t m_seed;
+
+            /// The matrices by the number of symbols
+            std::map<uint32_t,
+                     boost::shared_ptr<ldpc_staircase_matrix> > m_cache;
+
+        };
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_matrix = the_factory.parity_check_matrix(
+                the_factory.symbols());
+
+            assert(m_matrix->symbols() == SuperCoder::symbols());
+        }
+
+        /// @copydoc layer::id_size() const
+        uint32_t id_size() const
+        {
+            return sizeof(symbol_id_type);
+        }
+
+        /// @return The number of repair symbols of the block
+        uint32_t repair_symbols() const
+        {
+            assert(m_matrix);
+            return m_matrix->repair_symbols();
+        }
+
+        /// @return The number of source and repair symbols of the block
+        uint32_t code_length() const
+        {
+            assert(m_matrix);
+            return m_matrix->code_length();
+        }
+
+        /// @return The parity check matrix of the block
+        const ldpc_staircase_matrix& parity_check_matrix() const
+        {
+            assert(m_matrix);
+            return *m_matrix;
+        }
+
+    protected:
+
+        /// The parity check matrix
+        boost::shared_ptr<ldpc_staircase_matrix> m_matrix;
+
+    };
+
+}
@@ -0,0 +1,211 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Allows a number of encoded symbols to be produced in one
+    ///        pass over the source symbols.
+    ///
+    /// Between calls to begin_batch() and end_batch() the coded
+    /// layer::encode_symbol(uint8_t*,uint8_t*) calls are not forwarded,
+    /// instead the symbol buffer and a copy of the coefficients are
+    /// stored. When end_batch() is called every source symbol is read
+    /// once and added to all the stored symbol buffers using it. This
+    /// means that the block is only streamed from memory once per batch
+    /// instead of once per encoded symbol.
+    ///
+    /// The first source symbol used by a symbol buffer is written to it
+    /// with multiply_copy(), so like for the linear_block_encoder the
+    /// buffers do not have to be zeroed. The layer should be placed
+    /// directly above the linear_block_encoder.
+    template<class SuperCoder>
+    class linear_block_batch_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// Pull up the encode_symbol() functions
+        using SuperCoder::encode_symbol;
+
+    public:
+
+        /// Constructor
+        linear_block_batch_encoder()
+            : m_batching(false)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_batching = false;
+            m_symbols.clear();
+            m_coefficients.clear();
+        }
+
+        /// Starts a new batch, encoded symbols will not be produced
+        /// until end_batch() is called.
+        void begin_batch()
+        {
+            assert(!m_batching);
+
+            m_batching = true;
+            m_symbols.clear();
+            m_coefficients.clear();
+        }
+
+        /// Produces all the encoded symbols of the current batch.
+        void end_batch()
+        {
+            assert(m_batching);
+            m_batching = false;
+
+            if(m_symbols.empty())
+            {
+                return;
+            }
+
+            encode_batch();
+
+            m_symbols.clear();
+            m_coefficients.clear();
+        }
+
+        /// @return true if a batch is in progress
+        bool is_batching() const
+        {
+            return m_batching;
+        }
+
+        /// @copydoc layer::encode_symbol(uint8_t*, uint8_t*)
+        void encode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            if(!m_batching)
+            {
+                SuperCoder::encode_symbol(symbol_data, coefficients);
+                return;
+            }
+
+            // The coefficients may be stored in a buffer which is reused
+            // for the next symbol, so we keep a copy
+            uint32_t coefficients_size = SuperCoder::coefficients_size();
+            uint32_t offset = static_cast<uint32_t>(m_coefficients.size());
+
+            m_coefficients.resize(offset + coefficients_size);
+            std::copy_n(coefficients, coefficients_size,
+                        &m_coefficients[offset]);
+
+            m_symbols.push_back(reinterpret_cast<value_type*>(symbol_data));
+        }
+
+    protected:
+
+        /// Walks the source symbols once adding each of them to the
+        /// symbols of the batch with a non-zero coefficient
+        void encode_batch()
+        {
+            uint32_t coefficients_size = SuperCoder::coefficients_size();
+            uint32_t symbol_length = SuperCoder::symbol_length();
+
+            // Tracks the symbols of the batch which are still
+            // uninitialised, i.e. which have not used a source yet
+            m_initialized.assign(m_symbols.size(), false);
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                const value_type *symbol_i = 0;
+
+                for(uint32_t j = 0; j < m_symbols.size(); ++j)
+                {
+                    const value_type *c =
+                        reinterpret_cast<const value_type*>(
+                            &m_coefficients[j * coefficients_size]);
+
+                    value_type value = fifi::get_value<field_type>(c, i);
+
+                    if(!value)
+                    {
+                        continue;
+                    }
+
+                    if(symbol_i == 0)
+                    {
+                        symbol_i = SuperCoder::symbol_value(i);
+
+                        // Did you forget to set the data on the encoder?
+                        assert(symbol_i != 0);
+                        assert(SuperCoder::symbol_pivot(i));
+                    }
+
+                    if(!m_initialized[j])
+                    {
+                        SuperCoder::multiply_copy(
+                            m_symbols[j], symbol_i, value, symbol_length);
+
+                        m_initialized[j] = true;
+                    }
+                    else if(fifi::is_binary<field_type>::value)
+                    {
+                        SuperCoder::add(m_symbols[j], symbol_i,
+                                        symbol_length);
+                    }
+                    else
+                    {
+                        SuperCoder::multiply_add(
+                            m_symbols[j], symbol_i, value, symbol_length);
+                    }
+                }
+            }
+
+            // Symbols with only zero coefficients
+            for(uint32_t j = 0; j < m_symbols.size(); ++j)
+            {
+                if(!m_initialized[j])
+                {
+                    std::fill_n(m_symbols[j], symbol_length, 0);
+                }
+            }
+        }
+
+    protected:
+
+        /// True while a batch is in progress
+        bool m_batching;
+
+        /// The symbol buffers of the current batch
+        std::vector<value_type*> m_symbols;
+
+        /// The coefficients of the symbols in the current batch stored
+        /// back to back
+        std::vector<uint8_t> m_coefficients;
+
+        /// True for the symbols of the batch which have been written
+        std::vector<bool> m_initialized;
+
+    };
+
+}
@@ -6,6 +6,9 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
@@ -17,6 +20,10 @@
 #include <fifi/is_binary.hpp>
 #include <fifi/fifi_utils.hpp>
 
+#include "adopting_symbol_storage.hpp"
+#include "bit_scan.hpp"
+#include "snapshot.hpp"
+
 namespace kodo
 {
 
@@ -57,6 +64,12 @@ namespace kodo
 
             m_uncoded.resize(the_factory.max_symbols(), false);
             m_coded.resize(the_factory.max_symbols(), false);
+
+            m_pivots.resize((the_factory.max_symbols() + 63) / 64, 0);
+            m_nonzero_columns.resize(m_pivots.size(), 0);
+
+            m_coded_rows.reserve(the_factory.max_symbols());
+            m_coded_position.resize(the_factory.max_symbols(), 0);
         }
 
         /// @copydoc layer::initialize(Factory&)
@@ -68,6 +81,11 @@ namespace kodo
             std::fill_n(m_uncoded.begin(), the_factory.symbols(), false);
             std::fill_n(m_coded.begin(), the_factory.symbols(), false);
 
+            std::fill(m_pivots.begin(), m_pivots.end(), 0);
+            std::fill(m_nonzero_columns.begin(), m_nonzero_columns.end(), 0);
+
+            m_coded_rows.clear();
+
             m_rank = 0;
             m_maximum_pivot = 0;
         }
@@ -123,7 +141,7 @@ namespace kodo
                 // backwards substitution
                 ++m_rank;
 
-                m_uncoded[ symbol_index ] = true;
+                set_symbol_uncoded(symbol_index);
 
                 if(symbol_index > m_maximum_pivot)
                 {
@@ -149,7 +167,10 @@ namespace kodo
         bool symbol_pivot(uint32_t index) const
         {
             assert(index < SuperCoder::symbols());
-            return m_coded[index] || m_uncoded[index];
+            assert(bool((m_pivots[index / 64] >> (index % 64)) & 1U) ==
+                   (m_coded[index] || m_uncoded[index]));
+
+            return (m_pivots[index / 64] >> (index % 64)) & 1U;
         }
 
         /// @todo Add unit test
@@ -160,6 +181,79 @@ namespace kodo
             return m_coded[index];
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() + 2 * sizeof(uint32_t) +
+                2 * snapshot_bitmap_size(SuperCoder::symbols());
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            buffer = SuperCoder::write_snapshot(buffer);
+            buffer = write_snapshot_value(m_rank, buffer);
+            buffer = write_snapshot_value(m_maximum_pivot, buffer);
+            buffer = write_snapshot_bitmap(m_uncoded, symbols, buffer);
+            return write_snapshot_bitmap(m_coded, symbols, buffer);
+        }
+
+        /// Restores the decoding state, the pivot bitmap is rebuilt
+        /// from the coded and uncoded symbols
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            buffer = read_snapshot_value(buffer, m_rank);
+            buffer = read_snapshot_value(buffer, m_maximum_pivot);
+            buffer = read_snapshot_bitmap(buffer, symbols, m_uncoded);
+            buffer = read_snapshot_bitmap(buffer, symbols, m_coded);
+
+            std::fill(m_pivots.begin(), m_pivots.end(), 0);
+            std::fill(m_nonzero_columns.begin(), m_nonzero_columns.end(), 0);
+            m_coded_rows.clear();
+
+            uint32_t pivots = 0;
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(m_uncoded[i] && m_coded[i])
+                {
+                    return 0;
+                }
+
+                if(m_uncoded[i])
+                {
+                    m_pivots[i / 64] |= uint64_t(1) << (i % 64);
+                    ++pivots;
+                }
+
+                if(m_coded[i])
+                {
+                    // Rebuilds the coded rows and the column tracking
+                    // from the restored coefficients
+                    set_symbol_coded(i);
+                    ++pivots;
+                }
+            }
+
+            if(pivots != m_rank || m_maximum_pivot >= symbols)
+            {
+                return 0;
+            }
+
+            return buffer;
+        }
+
     protected:
 
         /// Decodes a symbol based on the coefficients
@@ -201,7 +295,7 @@ namespace kodo
             // We have increased the rank
             ++m_rank;
 
-            m_coded[ *pivot_index ] = true;
+            set_symbol_coded(*pivot_index);
 
             if(*pivot_index > m_maximum_pivot)
             {
@@ -221,7 +315,7 @@ namespace kodo
             assert(m_coded[pivot_index] == true);
             assert(m_uncoded[pivot_index] == false);
 
-            m_coded[pivot_index] = false;
+            clear_symbol_coded(pivot_index);
 
             value_type *symbol_i =
                 SuperCoder::symbol_value(pivot_index);
@@ -250,7 +344,7 @@ namespace kodo
             // Stores the symbol and sets the pivot in the vector
             store_uncoded_symbol(symbol_data, pivot_index);
 
-            m_uncoded[pivot_index] = true;
+            set_symbol_uncoded(pivot_index);
 
             // No need to backwards substitute since we are
             // replacing an existing symbol. I.e. backwards
@@ -304,50 +398,60 @@ namespace kodo
             assert(symbol_id != 0);
             assert(symbol_data != 0);
 
-            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
-            {
+            uint32_t symbols = SuperCoder::symbols();
 
+            // Only the non-zero coefficients are visited, a pivot row
+            // has no non-zero coefficients before its pivot so the
+            // subtraction does not change the coefficients already
+            // visited
+            for(uint32_t i = next_nonzero(symbol_id, 0); i < symbols;
+                i = next_nonzero(symbol_id, i + 1))
+            {
                 value_type current_coefficient
                     = fifi::get_value<field_type>(symbol_id, i);
 
-                if( current_coefficient )
+                assert(current_coefficient);
+
+                // A coefficient without a symbol is the pivot
+                if( !symbol_pivot( i ) )
                 {
-                    // If symbol exists
-                    if( symbol_pivot( i ) )
-                    {
-                        value_type *vector_i =
-                            SuperCoder::coefficients_value( i );
-
-                        value_type *symbol_i =
-                            SuperCoder::symbol_value( i );
-
-                        if(fifi::is_binary<field_type>::value)
-                        {
-                            SuperCoder::subtract(
-                                symbol_id, vector_i,
-                                SuperCoder::coefficients_length());
-
-                            SuperCoder::subtract(
-                                symbol_data, symbol_i,
-                                SuperCoder::symbol_length());
-                        }
-                        else
-                        {
-                            SuperCoder::multiply_subtract(
-                                symbol_id, vector_i,
-                                current_coefficient,
-                                SuperCoder::coefficients_length());
-
-                            SuperCoder::multiply_subtract(
-                                symbol_data, symbol_i,
-                                current_coefficient,
-                                SuperCoder::symbol_length());
-                        }
-                    }
-                    else
-                    {
-                        return boost::optional<uint32_t>( i );
-                    }
+                    return boost::optional<uint32_t>( i );
+                }
+
+                value_type *symbol_i =
+                    SuperCoder::symbol_value( i );
+
+                if(m_uncoded[i])
+                {
+                    subtract_uncoded(symbol_data, symbol_id, symbol_i,
+                                     current_coefficient, i);
+                    continue;
+                }
+
+                value_type *vector_i =
+                    SuperCoder::coefficients_value( i );
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(
+                        symbol_id, vector_i,
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::subtract(
+                        symbol_data, symbol_i,
+                        SuperCoder::symbol_length());
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        symbol_id, vector_i,
+                        current_coefficient,
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::multiply_subtract(
+                        symbol_data, symbol_i,
+                        current_coefficient,
+                        SuperCoder::symbol_length());
                 }
             }
 
@@ -378,27 +482,30 @@ namespace kodo
             // If this pivot index was smaller than the maximum pivot
             // index we have, we might also need to backward
             // substitute the higher pivot values into the new packet
-            for(uint32_t i = pivot_index + 1; i <= m_maximum_pivot; ++i)
+            for(uint32_t i = next_nonzero(symbol_id, pivot_index + 1);
+                i <= m_maximum_pivot && i < SuperCoder::symbols();
+                i = next_nonzero(symbol_id, i + 1))
             {
-                // Do we have a non-zero value here?
-
                 value_type value =
                     fifi::get_value<field_type>(symbol_id, i);
 
-
-                if( !value )
-                {
-                    continue;
-                }
+                assert(value);
 
                 if( symbol_pivot(i) )
                 {
-                    value_type *vector_i =
-                        SuperCoder::coefficients_value(i);
-
                     value_type *symbol_i =
                         SuperCoder::symbol_value(i);
 
+                    if(m_uncoded[i])
+                    {
+                        subtract_uncoded(symbol_data, symbol_id, symbol_i,
+                                         value, i);
+                        continue;
+                    }
+
+                    value_type *vector_i =
+                        SuperCoder::coefficients_value(i);
+
                     if(fifi::is_binary<field_type>::value)
                     {
                         SuperCoder::subtract(
@@ -423,6 +530,38 @@ namespace kodo
             }
         }
 
+        /// Subtracts an uncoded symbol, whose vector is the unit
+        /// vector, so only the coefficient at its pivot is cleared and
+        /// the stored vector is not read
+        /// @param symbol_data the data of the encoded symbol
+        /// @param symbol_id the data constituting the encoding vector
+        /// @param symbol_i the data of the uncoded symbol
+        /// @param coefficient the coefficient at the pivot
+        /// @param index the pivot of the uncoded symbol
+        void subtract_uncoded(value_type *symbol_data,
+                              value_type *symbol_id,
+                              const value_type *symbol_i,
+                              value_type coefficient,
+                              uint32_t index)
+        {
+            assert(m_uncoded[index]);
+
+            fifi::set_value<field_type>(symbol_id, index, 0);
+
+            if(fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::subtract(
+                    symbol_data, symbol_i,
+                    SuperCoder::symbol_length());
+            }
+            else
+            {
+                SuperCoder::multiply_subtract(
+                    symbol_data, symbol_i, coefficient,
+                    SuperCoder::symbol_length());
+            }
+        }
+
         /// Backward substitute the found symbol into the
         /// existing symbols.
         /// @param symbol_data buffer containing the encoding symbol
@@ -438,64 +577,199 @@ namespace kodo
 
             assert(pivot_index < SuperCoder::symbols());
 
+            // Only columns where a coded row may have a non-zero need
+            // to be visited, e.g. none while only uncoded symbols have
+            // been received
+            if(!is_nonzero_column(pivot_index))
+            {
+                return;
+            }
+
             // We found a "1" that nobody else had as pivot, we now
-            // substract this packet from other coded packets
-            // - if they have a "1" on our pivot place
-            for(uint32_t i = 0; i <= m_maximum_pivot; ++i)
+            // substract this packet from the coded packets - if they
+            // have a "1" on our pivot place. The uncoded symbols have
+            // no non-zero elements outside the pivot position so only
+            // the coded rows are visited.
+            for(uint32_t i : m_coded_rows)
             {
-                if( m_uncoded[i] )
+                if(i == pivot_index)
                 {
-                    // We know that we have no non-zero elements
-                    // outside the pivot position.
+                    // We cannot backward substitute into ourself
                     continue;
                 }
 
-                if(i == pivot_index)
+                value_type *vector_i =
+                    SuperCoder::coefficients_value(i);
+
+                value_type value =
+                    fifi::get_value<field_type>(vector_i, pivot_index);
+
+                if(!value)
                 {
-                    // We cannot backward substitute into ourself
                     continue;
                 }
 
-                if( m_coded[i] )
+                value_type *symbol_i =
+                    SuperCoder::symbol_value(i);
+
+                if(fifi::is_binary<field_type>::value)
                 {
-                    value_type *vector_i =
-                        SuperCoder::coefficients_value(i);
+                    SuperCoder::subtract(
+                        vector_i, symbol_id,
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::subtract(
+                        symbol_i, symbol_data,
+                        SuperCoder::symbol_length());
+                }
+                else
+                {
+                    // Update symbol and corresponding vector
+                    SuperCoder::multiply_subtract(
+                        vector_i, symbol_id, value,
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::multiply_subtract(
+                        symbol_i, symbol_data, value,
+                        SuperCoder::symbol_length());
+                }
+            }
+
+            // The pivot now has a one in its column and the other rows
+            // a zero
+            m_nonzero_columns[pivot_index / 64] &=
+                ~(uint64_t(1) << (pivot_index % 64));
+        }
 
-                    value_type value =
-                        fifi::get_value<field_type>(
-                            vector_i, pivot_index);
+        /// Marks a symbol as partially decoded, the coefficients of the
+        /// symbol must be stored
+        /// @param index The pivot index of the symbol
+        void set_symbol_coded(uint32_t index)
+        {
+            m_coded[index] = true;
+            m_pivots[index / 64] |= uint64_t(1) << (index % 64);
 
-                    if( value )
-                    {
+            m_coded_position[index] = m_coded_rows.size();
+            m_coded_rows.push_back(index);
+
+            // The columns where the row has a non-zero, except for its
+            // own pivot, may need backward substitution later
+            const value_type *coefficients =
+                SuperCoder::coefficients_value(index);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = next_nonzero(coefficients, 0); i < symbols;
+                i = next_nonzero(coefficients, i + 1))
+            {
+                if(i != index)
+                {
+                    m_nonzero_columns[i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+        }
+
+        /// Marks a symbol as fully decoded
+        /// @param index The pivot index of the symbol
+        void set_symbol_uncoded(uint32_t index)
+        {
+            m_uncoded[index] = true;
+            m_pivots[index / 64] |= uint64_t(1) << (index % 64);
+        }
+
+        /// Removes a partially decoded symbol
+        /// @param index The pivot index of the symbol
+        void clear_symbol_coded(uint32_t index)
+        {
+            m_coded[index] = false;
+            m_pivots[index / 64] &= ~(uint64_t(1) << (index % 64));
+
+            // The last coded row takes the place of the removed row
+            uint32_t position = m_coded_position[index];
+            assert(position < m_coded_rows.size());
+            assert(m_coded_rows[position] == index);
+
+            uint32_t last = m_coded_rows.back();
+            m_coded_rows[position] = last;
+            m_coded_position[last] = position;
+            m_coded_rows.pop_back();
+        }
+
+        /// @param column The index of a column
+        /// @return false if no coded row has a non-zero in the column,
+        ///         apart from the row with the column as pivot
+        bool is_nonzero_column(uint32_t column) const
+        {
+            return (m_nonzero_columns[column / 64] >> (column % 64)) & 1;
+        }
+
+        /// Finds the next non-zero coefficient of an encoding vector.
+        /// The vector is scanned a 64 bit word at a time, and only the
+        /// byte of the first non-zero word which holds a non-zero value
+        /// is inspected by element.
+        /// @param symbol_id The encoding vector
+        /// @param index The index at which the scan starts
+        /// @return The index of the next non-zero coefficient, or a value
+        ///         of at least layer::symbols() if there is none
+        uint32_t next_nonzero(const value_type *symbol_id,
+                              uint32_t index) const
+        {
+            assert(symbol_id != 0);
+
+            const uint32_t symbols = SuperCoder::symbols();
+
+            // The number of elements in a byte, zero if an element
+            // spans several bytes
+            const uint32_t byte_elements =
+                fifi::size_to_elements<field_type>(1);
+
+            const uint32_t value_size = sizeof(value_type);
+
+            const uint8_t *data =
+                reinterpret_cast<const uint8_t*>(symbol_id);
+
+            const uint32_t size = SuperCoder::coefficients_size();
+
+            while(index < symbols)
+            {
+                // The first byte holding the element
+                uint32_t byte = byte_elements ?
+                    index / byte_elements : index * value_size;
 
-                        value_type *symbol_i =
-                            SuperCoder::symbol_value(i);
-
-                        if(fifi::is_binary<field_type>::value)
-                        {
-                            SuperCoder::subtract(
-                                vector_i, symbol_id,
-                                SuperCoder::coefficients_length());
-
-                            SuperCoder::subtract(
-                                symbol_i, symbol_data,
-                                SuperCoder::symbol_length());
-                        }
-                        else
-                        {
-
-                            // Update symbol and corresponding vector
-                            SuperCoder::multiply_subtract(
-                                vector_i, symbol_id, value,
-                                SuperCoder::coefficients_length());
-
-                            SuperCoder::multiply_subtract(
-                                symbol_i, symbol_data, value,
-                                SuperCoder::symbol_length());
-                        }
+                uint32_t word_end = std::min(size, (byte / 8 + 1) * 8);
+
+                uint64_t word = load_word(data + byte, word_end - byte);
+
+                if(word == 0)
+                {
+                    // Continue with the first element of the next word
+                    index = byte_elements ?
+                        word_end * byte_elements : word_end / value_size;
+                    continue;
+                }
+
+                byte += count_trailing_zeros(word) / 8;
+
+                // The first and last element held by the byte
+                uint32_t first = byte_elements ?
+                    byte * byte_elements : byte / value_size;
+
+                uint32_t last = byte_elements ?
+                    first + byte_elements : first + 1;
+
+                for(uint32_t i = std::max(first, index);
+                    i < std::min(last, symbols); ++i)
+                {
+                    if(fifi::get_value<field_type>(symbol_id, i))
+                    {
+                        return i;
                     }
                 }
+
+                index = last;
             }
+
+            return symbols;
         }
 
         /// Store an encoded symbol and encoding vector with the specified
@@ -521,15 +795,7 @@ namespace kodo
             SuperCoder::set_coefficients(
                 pivot_index, coefficient_storage);
 
-            // Copy it into the symbol storage
-            sak::mutable_storage dest =
-                sak::storage(SuperCoder::symbol(pivot_index),
-                             SuperCoder::symbol_size());
-
-            sak::const_storage src =
-                sak::storage(symbol_data, SuperCoder::symbol_size());
-
-            sak::copy_storage(dest, src);
+            store_symbol_data(symbol_data, pivot_index);
         }
 
         /// Stores an uncoded or fully decoded symbol
@@ -552,7 +818,34 @@ namespace kodo
 
             fifi::set_value<field_type>(vector_dest, pivot_index, 1U);
 
-            // Copy it into the symbol storage
+            uint8_t *symbol = SuperCoder::symbol(pivot_index);
+
+            // The symbol may have been received in place, see the
+            // in_place_systematic_decoder
+            if(reinterpret_cast<const uint8_t*>(symbol_data) == symbol)
+            {
+                return;
+            }
+
+            store_symbol_data(symbol_data, pivot_index);
+        }
+
+        /// Stores the data of a symbol in the symbol storage
+        /// @param symbol_data the data for the symbol
+        /// @param pivot_index the pivot index of the symbol
+        void store_symbol_data(const value_type *symbol_data,
+                               uint32_t pivot_index)
+        {
+            store_symbol_data(symbol_data, pivot_index,
+                std::integral_constant<bool,
+                    has_adopting_symbol_storage<SuperCoder>::value>());
+        }
+
+        /// Copies the data of a symbol into the symbol storage
+        /// @copydetails store_symbol_data(const value_type*, uint32_t)
+        void store_symbol_data(const value_type *symbol_data,
+                               uint32_t pivot_index, std::false_type)
+        {
             sak::mutable_storage dest =
                 sak::storage(SuperCoder::symbol(pivot_index),
                              SuperCoder::symbol_size());
@@ -561,7 +854,23 @@ namespace kodo
                 sak::storage(symbol_data, SuperCoder::symbol_size());
 
             sak::copy_storage(dest, src);
+        }
 
+        /// Lets the adopting_symbol_storage adopt the buffer of the
+        /// data as the symbol, the data is only copied if the buffer is
+        /// not offered for adoption
+        /// @copydetails store_symbol_data(const value_type*, uint32_t)
+        void store_symbol_data(const value_type *symbol_data,
+                               uint32_t pivot_index, std::true_type)
+        {
+            if(SuperCoder::adopt_symbol(
+                   pivot_index,
+                   reinterpret_cast<const uint8_t*>(symbol_data)))
+            {
+                return;
+            }
+
+            store_symbol_data(symbol_data, pivot_index, std::false_type());
         }
 
     protected:
@@ -578,6 +887,22 @@ namespace kodo
 
         /// Tracks whether a symbol is partially decoded
         std::vector<bool> m_coded;
+
+        /// Packed bitmap of the pivots i.e. the symbols which are
+        /// partially or fully decoded
+        std::vector<uint64_t> m_pivots;
+
+        /// The pivot indices of the partially decoded symbols, in no
+        /// particular order
+        std::vector<uint32_t> m_coded_rows;
+
+        /// The position of a partially decoded symbol in m_coded_rows
+        std::vector<uint32_t> m_coded_position;
+
+        /// Packed bitmap of the columns where a partially decoded
+        /// symbol may have a non-zero coefficient outside its pivot.
+        /// A set bit may be stale, a cleared bit is exact.
+        std::vector<uint64_t> m_nonzero_columns;
     };
 
 }
@@ -0,0 +1,307 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+#include <fifi/arithmetics.hpp>
+
+#include <sak/aligned_allocator.hpp>
+
+#include "matrix.hpp"
+#include "matrix_operations.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Linear block decoder solving the block with one matrix
+    ///        product on the symbol data once full rank is reached.
+    ///
+    /// The linear_block_decoder subtracts every pivot symbol from every
+    /// received symbol, so with generations of 512 to 2048 symbols each
+    /// row operation streams two symbols from memory for a single
+    /// multiply-add, and decoding is bound by the memory bandwidth.
+    /// This decoder delays all work on the symbol data:
+    ///
+    /// - The received symbols are buffered in the order they arrive,
+    ///   only their coefficient vectors are eliminated to detect the
+    ///   innovative symbols and the rank.
+    /// - At full rank the k x k matrix of the coefficient vectors of the
+    ///   buffered symbols is inverted, see invert_matrix().
+    /// - The symbols are the product of the inverse with the buffered
+    ///   symbols, computed by multiply_matrix_rows() in tiles of the
+    ///   symbol data and blocks of source rows, which are reused from
+    ///   the cache by all the destination rows.
+    ///
+    /// Every byte of symbol data is thereby combined in the cache with a
+    /// block of rows instead of being streamed once per row operation.
+    /// The work on the coefficients grows with k^3 and does not touch
+    /// the symbol data. The received symbols are buffered besides the
+    /// symbol storage, so the decoder uses twice the memory of the
+    /// block, and the symbol data is only decoded when the decoder is
+    /// complete. The layer replaces the linear_block_decoder and the
+    /// coefficient_storage.
+    template<class SuperCoder>
+    class linear_block_decoder_blocked : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The matrix of the coefficient vectors
+        typedef matrix<field_type> matrix_type;
+
+    public:
+
+        /// Constructor
+        linear_block_decoder_blocked()
+            : m_rank(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            uint32_t max_symbols = the_factory.max_symbols();
+
+            m_echelon.reset(new matrix_type(max_symbols, max_symbols));
+            m_received.reset(new matrix_type(max_symbols, max_symbols));
+
+            m_pivots.resize(max_symbols, false);
+            m_data.resize(max_symbols * the_factory.max_symbol_size());
+
+            m_vector.resize(m_echelon->row_length());
+            m_unit.resize(m_echelon->row_length());
+            m_temp.resize(m_echelon->row_length());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill(m_pivots.begin(), m_pivots.end(), false);
+            m_rank = 0;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            receive(symbol_data, reinterpret_cast<value_type*>(coefficients));
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            // An uncoded symbol is buffered as a unit vector
+            uint32_t length = SuperCoder::coefficients_length();
+            std::fill_n(&m_unit[0], length, 0);
+
+            fifi::set_value<field_type>(&m_unit[0], symbol_index, 1U);
+
+            receive(symbol_data, &m_unit[0]);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_rank == SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_rank;
+        }
+
+        /// The symbol data is only decoded when the decoder is complete
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_pivots[index];
+        }
+
+    protected:
+
+        /// Buffers a symbol if its coefficient vector is innovative and
+        /// solves the block at full rank
+        /// @param symbol_data The symbol data
+        /// @param coefficients The coefficient vector of the symbol
+        void receive(const uint8_t *symbol_data,
+                     const value_type *coefficients)
+        {
+            if(is_complete())
+                return;
+
+            if(!reduce(coefficients))
+                return;
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            std::copy_n(coefficients, SuperCoder::coefficients_length(),
+                        m_received->row_value(m_rank));
+
+            std::copy_n(symbol_data, symbol_size,
+                        &m_data[m_rank * symbol_size]);
+
+            ++m_rank;
+
+            if(is_complete())
+            {
+                solve();
+            }
+        }
+
+        /// Eliminates a coefficient vector against the pivot rows, and
+        /// adds it as a pivot row if it is innovative
+        /// @param coefficients The coefficient vector
+        /// @return True if the vector is innovative
+        bool reduce(const value_type *coefficients)
+        {
+            auto &field = *SuperCoder::m_field;
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t length = SuperCoder::coefficients_length();
+
+            value_type *v = &m_vector[0];
+            std::copy_n(coefficients, length, v);
+
+            for(uint32_t j = 0; j < symbols; ++j)
+            {
+                value_type value = fifi::get_value<field_type>(v, j);
+
+                if(!value)
+                    continue;
+
+                value_type *pivot_row = m_echelon->row_value(j);
+
+                if(m_pivots[j])
+                {
+                    // The pivot row has no non-zero before column j
+                    matrix_multiply_subtract(
+                        field, value, v, pivot_row, &m_temp[0], length);
+
+                    continue;
+                }
+
+                if(value != 1)
+                {
+                    fifi::multiply_constant(
+                        field, field.invert(value), v, length);
+                }
+
+                std::copy_n(v, length, pivot_row);
+                m_pivots[j] = true;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        /// Decodes the symbols as the product of the inverse of the
+        /// received coefficient vectors with the received symbols
+        void solve()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            assert(m_rank == symbols);
+
+            // The square matrices are kept while the number of symbols
+            // does not change, so a recycled decoder does not allocate
+            if(!m_square || m_square->rows() != symbols)
+            {
+                m_square.reset(new matrix_type(symbols, symbols));
+                m_inverse.reset(new matrix_type(symbols, symbols));
+            }
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                std::copy_n(m_received->row(i), m_square->row_size(),
+                            m_square->row(i));
+            }
+
+            // The received vectors are independent since every one was
+            // innovative when it was buffered
+            bool invertible =
+                invert_matrix(*SuperCoder::m_field, *m_square, *m_inverse);
+
+            assert(invertible);
+            (void) invertible;
+
+            // The symbols of the deep_symbol_storage are contiguous
+            assert(symbols == 1 ||
+                   SuperCoder::symbol(1) ==
+                   SuperCoder::symbol(0) + symbol_size);
+
+            multiply_matrix_rows(
+                *SuperCoder::m_field, *m_inverse, &m_data[0], symbol_size,
+                SuperCoder::symbol(0), symbol_size,
+                SuperCoder::symbol_length());
+        }
+
+    protected:
+
+        /// The storage type
+        typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
+            aligned_vector;
+
+        /// The pivot rows of the eliminated coefficient vectors, row j
+        /// has its first non-zero, which is one, in column j
+        std::unique_ptr<matrix_type> m_echelon;
+
+        /// The coefficient vectors of the buffered symbols
+        std::unique_ptr<matrix_type> m_received;
+
+        /// The square matrix of the received coefficient vectors
+        std::unique_ptr<matrix_type> m_square;
+
+        /// The inverse of the square matrix
+        std::unique_ptr<matrix_type> m_inverse;
+
+        /// Tracks the columns with a pivot row
+        std::vector<bool> m_pivots;
+
+        /// The buffered symbols in the order they were received
+        aligned_vector m_data;
+
+        /// The coefficient vector being eliminated
+        std::vector<value_type> m_vector;
+
+        /// The coefficient vector of an uncoded symbol
+        std::vector<value_type> m_unit;
+
+        /// Temporary buffer of a coefficient vector
+        std::vector<value_type> m_temp;
+
+        /// The rank of the buffered symbols
+        uint32_t m_rank;
+
+    };
+
+}
@@ -6,12 +6,20 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/optional.hpp>
 
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "block_executor.hpp"
+
 namespace kodo
 {
 
@@ -22,6 +30,30 @@ namespace kodo
     /// effect and can therefore improve the decoding throughput when
     /// decoding sparse symbols, in particular if the generation size
     /// is large.
+    ///
+    /// If a block_executor is set on the factory the final backward
+    /// substitution of large symbols is split in two: the operations
+    /// are first determined on the coefficients, after which the
+    /// workers apply them to disjoint stripes of the symbol data. The
+    /// executor must not be the one running the decoder, e.g. in a
+    /// parallel_object_decoder, since the runs of an executor cannot
+    /// be nested.
+    ///
+    /// With a progressive stripe size set on the factory the symbols
+    /// are instead decoded a stripe at a time: once the final backward
+    /// substitution is done on the coefficients, the operations are
+    /// applied to the first stripe of every symbol, then the second and
+    /// so on. The callback set with set_stripe_decoded_callback() is
+    /// invoked as soon as a stripe is decoded, so e.g. headers at the
+    /// start of large symbols can be consumed before the remaining
+    /// stripes are decoded.
+    ///
+    /// With on demand decoding set on the factory the final backward
+    /// substitution is skipped when the decoder is complete. A consumer
+    /// needing only a few symbols, e.g. for random access into a large
+    /// block, computes them with decode_symbol_on_demand(), which only
+    /// combines the symbols the requested one depends on, and may still
+    /// decode the remaining symbols with decode_remaining().
     template<class SuperCoder>
     class linear_block_decoder_delayed : public SuperCoder
     {
@@ -33,8 +65,141 @@ namespace kodo
         /// The value_type used to store the field elements
         typedef typename field_type::value_type value_type;
 
+        /// The smallest stripe of a symbol in bytes handled by a worker
+        static const uint32_t min_stripe_size = 1024;
+
     public:
 
+        /// @ingroup factory_layers
+        /// The factory layer associated with this coder.
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_executor(0),
+                  m_progressive_stripe_size(0),
+                  m_on_demand(false)
+            { }
+
+            /// Sets the executor used for the final backward
+            /// substitution of the decoders built afterwards
+            /// @param executor The executor, or null for the final
+            ///        backward substitution on the decoding thread
+            void set_backward_substitution_executor(
+                block_executor *executor)
+            {
+                m_executor = executor;
+            }
+
+            /// @return The executor used for the final backward
+            ///         substitution or null if none is set
+            block_executor* backward_substitution_executor() const
+            {
+                return m_executor;
+            }
+
+            /// Sets the size of the stripes decoded one at a time by
+            /// the decoders built afterwards, the progressive decoding
+            /// takes precedence over the executor
+            /// @param stripe_size The size of a stripe in bytes, or zero
+            ///        to decode the whole symbols at once
+            void set_progressive_stripe_size(uint32_t stripe_size)
+            {
+                m_progressive_stripe_size = stripe_size;
+            }
+
+            /// @return The size of the progressively decoded stripes in
+            ///         bytes or zero if the symbols are decoded at once
+            uint32_t progressive_stripe_size() const
+            {
+                return m_progressive_stripe_size;
+            }
+
+            /// Sets whether the decoders built afterwards skip the final
+            /// backward substitution, see decode_symbol_on_demand()
+            /// @param on_demand True to decode the symbols on demand
+            void set_on_demand_decoding(bool on_demand)
+            {
+                m_on_demand = on_demand;
+            }
+
+            /// @return True if the symbols are decoded on demand
+            bool on_demand_decoding() const
+            {
+                return m_on_demand;
+            }
+
+        private:
+
+            /// The executor of the final backward substitution
+            block_executor *m_executor;
+
+            /// The size of the progressively decoded stripes
+            uint32_t m_progressive_stripe_size;
+
+            /// True if the symbols are decoded on demand
+            bool m_on_demand;
+
+        };
+
+    public:
+
+        /// The stripe decoded callback function, invoked with the index
+        /// of a stripe when it is decoded in all the symbols
+        typedef std::function<void (uint32_t)> stripe_decoded_callback;
+
+    public:
+
+        /// Constructor
+        linear_block_decoder_delayed()
+            : m_executor(0),
+              m_stripe_length(0),
+              m_stripes_decoded(0),
+              m_on_demand(false),
+              m_substituted(false)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_demand_vector.resize(
+                fifi::elements_to_length<field_type>(
+                    the_factory.max_symbols()));
+
+            m_demand_sources.reserve(the_factory.max_symbols());
+            m_demand_values.reserve(the_factory.max_symbols());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_executor = the_factory.backward_substitution_executor();
+
+            m_stripe_length = 0;
+            m_stripes_decoded = 0;
+            m_stripe_callback = nullptr;
+
+            m_on_demand = the_factory.on_demand_decoding();
+            m_substituted = false;
+
+            if(the_factory.progressive_stripe_size() > 0)
+            {
+                // A stripe holds at least one field element
+                m_stripe_length = std::max<uint32_t>(
+                    1U, fifi::size_to_length<field_type>(
+                        the_factory.progressive_stripe_size()));
+            }
+        }
+
         /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
         void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
         {
@@ -75,7 +240,7 @@ namespace kodo
                 // We have increased the rank
                 ++m_rank;
 
-                m_uncoded[ symbol_index ] = true;
+                SuperCoder::set_symbol_uncoded(symbol_index);
 
                 if(symbol_index > m_maximum_pivot)
                 {
@@ -86,9 +251,149 @@ namespace kodo
 
             if(SuperCoder::is_complete())
             {
-                final_backward_substitute();
+                complete_decoding();
+            }
+
+        }
+
+        /// Sets the callback invoked when a stripe is decoded, the
+        /// callback is reset when the decoder is initialized
+        /// @param callback The stripe decoded callback function
+        void set_stripe_decoded_callback(
+            const stripe_decoded_callback &callback)
+        {
+            assert(callback);
+            m_stripe_callback = callback;
+        }
+
+        /// Resets the stripe decoded callback
+        void reset_stripe_decoded_callback()
+        {
+            m_stripe_callback = nullptr;
+        }
+
+        /// @return The size of the progressively decoded stripes in
+        ///         bytes, the last stripe may be shorter, or zero if the
+        ///         symbols are decoded at once
+        uint32_t stripe_size() const
+        {
+            return fifi::length_to_size<field_type>(m_stripe_length);
+        }
+
+        /// @return The number of stripes of a symbol, one if the symbols
+        ///         are decoded at once
+        uint32_t stripe_count() const
+        {
+            if(m_stripe_length == 0)
+            {
+                return 1;
             }
 
+            uint32_t length = SuperCoder::symbol_length();
+            return (length + m_stripe_length - 1) / m_stripe_length;
+        }
+
+        /// @return The number of stripes decoded in all the symbols, the
+        ///         stripes are decoded in order
+        uint32_t stripes_decoded() const
+        {
+            return m_stripes_decoded;
+        }
+
+        /// @return True if the final backward substitution is skipped,
+        ///         see decode_symbol_on_demand()
+        bool is_on_demand() const
+        {
+            return m_on_demand;
+        }
+
+        /// Computes a single decoded symbol from the eliminated
+        /// coefficients, without decoding the other symbols in the
+        /// storage. The pivot rows are in echelon form, so decoded
+        /// symbol i is the combination w * S of the stored symbols S
+        /// where w is row i of the inverse of the coefficient matrix.
+        /// Only the entries of w, found on the coefficients alone, are
+        /// computed, and the data of the symbols with a non-zero entry
+        /// is combined once into the destination. A symbol can be
+        /// computed before the decoder is complete if all the symbols it
+        /// depends on have a pivot.
+        /// @param index The index of the symbol
+        /// @param dest The destination of layer::symbol_size() bytes
+        /// @return False if the symbol cannot be decoded yet
+        bool decode_symbol_on_demand(uint32_t index, uint8_t *dest)
+        {
+            assert(index < SuperCoder::symbols());
+            assert(dest != 0);
+
+            if(!SuperCoder::symbol_pivot(index))
+                return false;
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t length = SuperCoder::coefficients_length();
+
+            value_type *w = &m_demand_vector[0];
+
+            std::fill_n(w, length, 0);
+            fifi::set_value<field_type>(w, index, 1U);
+
+            m_demand_sources.clear();
+            m_demand_values.clear();
+
+            // Row i only holds non-zeros right of its pivot, so entry i
+            // of w is final once the rows left of i are subtracted
+            for(uint32_t i = index; i < symbols; ++i)
+            {
+                value_type value = fifi::get_value<field_type>(w, i);
+
+                if(!value)
+                    continue;
+
+                if(!SuperCoder::symbol_pivot(i))
+                    return false;
+
+                m_demand_sources.push_back(SuperCoder::symbol_value(i));
+                m_demand_values.push_back(value);
+
+                if(m_coded[i])
+                {
+                    const value_type *vector_i =
+                        SuperCoder::coefficients_value(i);
+
+                    if(fifi::is_binary<field_type>::value)
+                    {
+                        SuperCoder::subtract(w, vector_i, length);
+                    }
+                    else
+                    {
+                        SuperCoder::multiply_subtract(
+                            w, vector_i, value, length);
+                    }
+
+                    // The subtraction also cleared the pivot
+                    fifi::set_value<field_type>(w, i, value);
+                }
+            }
+
+            SuperCoder::multiply_sources(
+                reinterpret_cast<value_type*>(dest), &m_demand_sources[0],
+                &m_demand_values[0],
+                static_cast<uint32_t>(m_demand_sources.size()),
+                SuperCoder::symbol_length());
+
+            return true;
+        }
+
+        /// Performs the final backward substitution skipped by on
+        /// demand decoding, after which the storage holds the decoded
+        /// symbols
+        void decode_remaining()
+        {
+            assert(SuperCoder::is_complete());
+
+            if(m_substituted)
+                return;
+
+            final_backward_substitute();
         }
 
     protected:
@@ -98,6 +403,7 @@ namespace kodo
         using SuperCoder::m_maximum_pivot;
         using SuperCoder::m_coded;
         using SuperCoder::m_uncoded;
+        using SuperCoder::m_coded_rows;
 
     protected:
 
@@ -134,7 +440,7 @@ namespace kodo
             // We have increased the rank
             ++m_rank;
 
-            m_coded[ *pivot_index ] = true;
+            SuperCoder::set_symbol_coded(*pivot_index);
 
             if(*pivot_index > m_maximum_pivot)
             {
@@ -143,12 +449,22 @@ namespace kodo
 
             if(SuperCoder::is_complete())
             {
-                final_backward_substitute();
+                complete_decoding();
             }
         }
 
     protected:
 
+        /// Decodes the symbols when the decoder becomes complete, unless
+        /// they are decoded on demand
+        void complete_decoding()
+        {
+            if(m_on_demand)
+                return;
+
+            final_backward_substitute();
+        }
+
         /// Performs the final backward substitution that transform the
         /// coding matrix from echelon form to reduce echelon form and
         /// hence fully decode the generation
@@ -156,6 +472,29 @@ namespace kodo
         {
             assert(SuperCoder::is_complete());
 
+            m_substituted = true;
+
+            if(m_stripe_length > 0)
+            {
+                final_backward_substitute_progressive();
+                return;
+            }
+
+            uint32_t stripes = 0;
+
+            if(m_executor)
+            {
+                stripes = std::min(m_executor->threads(),
+                                   SuperCoder::symbol_size() /
+                                   min_stripe_size);
+            }
+
+            if(stripes > 1)
+            {
+                final_backward_substitute_striped(stripes);
+                return;
+            }
+
             uint32_t symbols = SuperCoder::symbols();
 
             for(uint32_t i = symbols; i --> 0;)
@@ -169,8 +508,252 @@ namespace kodo
                 SuperCoder::backward_substitute(
                     symbol_i, vector_i, i);
             }
+
+            notify_stripes_decoded();
         }
-    };
-}
 
+        /// Performs the final backward substitution a stripe of the
+        /// symbol data at a time, see final_backward_substitute_striped()
+        /// for the recorded operations
+        void final_backward_substitute_progressive()
+        {
+            assert(m_stripe_length > 0);
+
+            m_operations.clear();
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = symbols; i --> 0;)
+            {
+                record_backward_substitute(i);
+            }
+
+            uint32_t length = SuperCoder::symbol_length();
+            m_stripe_temp.resize(length);
+
+            uint32_t stripe = 0;
+
+            for(uint32_t offset = 0; offset < length;
+                offset += m_stripe_length, ++stripe)
+            {
+                apply_operations(
+                    offset, std::min(m_stripe_length, length - offset));
+
+                notify_stripe_decoded(stripe);
+            }
+        }
+
+        /// Marks all the stripes decoded when the symbols were decoded
+        /// at once
+        void notify_stripes_decoded()
+        {
+            uint32_t stripes = stripe_count();
+
+            for(uint32_t s = 0; s < stripes; ++s)
+            {
+                notify_stripe_decoded(s);
+            }
+        }
+
+        /// Marks a stripe decoded and invokes the callback, unless the
+        /// stripe was decoded before i.e. the final backward
+        /// substitution is repeated after a swap of a coded symbol
+        /// @param stripe The index of the stripe
+        void notify_stripe_decoded(uint32_t stripe)
+        {
+            if(stripe < m_stripes_decoded)
+            {
+                return;
+            }
+
+            assert(stripe == m_stripes_decoded);
+            ++m_stripes_decoded;
+
+            if(m_stripe_callback)
+            {
+                m_stripe_callback(stripe);
+            }
+        }
+
+        /// Performs the final backward substitution with the symbol data
+        /// divided into stripes processed by the executor. The
+        /// operations are the ones of final_backward_substitute(), the
+        /// coefficients are updated first and every worker then applies
+        /// the recorded operations, in order, to its stripe.
+        /// @param stripes The number of stripes
+        void final_backward_substitute_striped(uint32_t stripes)
+        {
+            assert(m_executor);
+            assert(stripes > 0);
+
+            m_operations.clear();
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = symbols; i --> 0;)
+            {
+                record_backward_substitute(i);
+            }
+
+            // The stripes are kept to whole cache lines
+            uint32_t line = std::max<uint32_t>(
+                1U, fifi::size_to_length<field_type>(64));
+
+            uint32_t length = SuperCoder::symbol_length();
+            m_stripe_temp.resize(length);
+
+            uint32_t stripe = (length + stripes - 1) / stripes;
+            stripe = ((stripe + line - 1) / line) * line;
+
+            m_executor->run(stripes, [&](uint32_t s)
+                {
+                    uint32_t offset = s * stripe;
+
+                    if(offset >= length)
+                    {
+                        return;
+                    }
+
+                    apply_operations(
+                        offset, std::min(stripe, length - offset));
+                });
 
+            notify_stripes_decoded();
+        }
+
+        /// Backward substitutes the coefficients of a symbol into the
+        /// other coded symbols and records the operations for the
+        /// symbol data, as backward_substitute() of the
+        /// linear_block_decoder
+        /// @param pivot_index The pivot of the symbol
+        void record_backward_substitute(uint32_t pivot_index)
+        {
+            // Like in backward_substitute() only the coded symbols are
+            // visited, and none if the column has no non-zero
+            if(!SuperCoder::is_nonzero_column(pivot_index))
+            {
+                return;
+            }
+
+            const value_type *symbol_id =
+                SuperCoder::coefficients_value(pivot_index);
+
+            for(uint32_t i : m_coded_rows)
+            {
+                if(i == pivot_index)
+                {
+                    continue;
+                }
+
+                value_type *vector_i = SuperCoder::coefficients_value(i);
+
+                value_type value =
+                    fifi::get_value<field_type>(vector_i, pivot_index);
+
+                if(!value)
+                {
+                    continue;
+                }
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(
+                        vector_i, symbol_id,
+                        SuperCoder::coefficients_length());
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        vector_i, symbol_id, value,
+                        SuperCoder::coefficients_length());
+                }
+
+                operation o = { i, pivot_index, value };
+                m_operations.push_back(o);
+            }
+        }
+
+        /// Applies the recorded operations to a stripe of the symbols
+        /// @param offset The offset of the stripe in field elements
+        /// @param length The length of the stripe in field elements
+        void apply_operations(uint32_t offset, uint32_t length)
+        {
+            for(const auto &o : m_operations)
+            {
+                value_type *dest =
+                    SuperCoder::symbol_value(o.m_dest) + offset;
+
+                const value_type *src =
+                    SuperCoder::symbol_value(o.m_src) + offset;
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(dest, src, length);
+                }
+                else
+                {
+                    // The multiply_subtract() of the finite field math
+                    // uses a temporary buffer shared by the coder, so
+                    // every stripe uses its part of a buffer instead
+                    value_type *temp = &m_stripe_temp[offset];
+
+                    std::copy_n(src, length, temp);
+                    SuperCoder::multiply(temp, o.m_value, length);
+                    SuperCoder::subtract(dest, temp, length);
+                }
+            }
+        }
+
+    protected:
+
+        /// A row operation of the backward substitution, the source
+        /// symbol multiplied by the value is subtracted from the
+        /// destination symbol
+        struct operation
+        {
+            /// The destination symbol
+            uint32_t m_dest;
+
+            /// The source symbol
+            uint32_t m_src;
+
+            /// The multiplier
+            value_type m_value;
+        };
+
+        /// The executor of the final backward substitution
+        block_executor *m_executor;
+
+        /// The operations of the final backward substitution
+        std::vector<operation> m_operations;
+
+        /// Temporary buffer for the multiplications of the stripes
+        std::vector<value_type> m_stripe_temp;
+
+        /// The length of the progressively decoded stripes in field
+        /// elements, zero if the symbols are decoded at once
+        uint32_t m_stripe_length;
+
+        /// The number of stripes decoded
+        uint32_t m_stripes_decoded;
+
+        /// The stripe decoded callback
+        stripe_decoded_callback m_stripe_callback;
+
+        /// True if the final backward substitution is skipped
+        bool m_on_demand;
+
+        /// True if the final backward substitution was done
+        bool m_substituted;
+
+        /// The row of the inverse computed by decode_symbol_on_demand()
+        std::vector<value_type> m_demand_vector;
+
+        /// The symbols combined by decode_symbol_on_demand()
+        std::vector<const value_type*> m_demand_sources;
+
+        /// The coefficients of the combined symbols
+        std::vector<value_type> m_demand_values;
+
+    };
+}
@@ -0,0 +1,310 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Linear block decoder spreading the backward substitution
+    ///        over the received symbols.
+    ///
+    /// The linear_block_decoder backward substitutes every innovative
+    /// symbol, while the linear_block_decoder_delayed performs all the
+    /// backward substitution when the full rank is reached, which makes
+    /// the last symbol much more expensive to decode than the others.
+    /// This layer delays the backward substitution while the rank is
+    /// below a threshold, by default half the symbols, where most of the
+    /// fill-in would occur. Above the threshold every received symbol
+    /// backward substitutes a chunk of the pending pivots, highest pivot
+    /// first, sized such that the pending pivots are spread evenly over
+    /// the symbols still needed. The work per symbol is thereby flat
+    /// and the full rank completes the decoding with at most a chunk.
+    ///
+    /// A pivot is reduced when no other symbol has a non-zero
+    /// coefficient at its position, which is kept through the decoding
+    /// by also subtracting the reduced pivots from the received symbols.
+    /// The layer must be placed above the linear_block_decoder.
+    template<class SuperCoder>
+    class linear_block_decoder_hybrid : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_reduced.resize(the_factory.max_symbols(), false);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill_n(m_reduced.begin(), the_factory.symbols(), false);
+            m_reduced_count = 0;
+
+            m_threshold = the_factory.symbols() / 2;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            value_type *s =
+                reinterpret_cast<value_type*>(symbol_data);
+
+            value_type *c =
+                reinterpret_cast<value_type*>(coefficients);
+
+            decode_coefficients(s, c);
+            backward_substitute_chunk();
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+            assert(symbol_data != 0);
+
+            if(m_uncoded[symbol_index])
+                return;
+
+            const value_type *symbol
+                = reinterpret_cast<const value_type*>( symbol_data );
+
+            if(m_coded[symbol_index])
+            {
+                // The replaced symbol is decoded by the eager
+                // decode_coefficients() of the linear_block_decoder,
+                // which keeps the reduced pivots reduced
+                SuperCoder::swap_decode(symbol, symbol_index);
+            }
+            else
+            {
+                // Stores the symbol and updates the corresponding
+                // encoding vector, the coded symbols may still depend
+                // on the symbol so it is not reduced
+                SuperCoder::store_uncoded_symbol(symbol, symbol_index);
+
+                // We have increased the rank
+                ++m_rank;
+
+                SuperCoder::set_symbol_uncoded(symbol_index);
+
+                if(symbol_index > m_maximum_pivot)
+                {
+                    m_maximum_pivot = symbol_index;
+                }
+            }
+
+            backward_substitute_chunk();
+        }
+
+        /// Sets the rank from which the backward substitution is
+        /// spread over the received symbols, zero gives a decoder close
+        /// to the linear_block_decoder and the number of symbols the
+        /// linear_block_decoder_delayed
+        /// @param rank The threshold rank
+        void set_backward_substitution_threshold(uint32_t rank)
+        {
+            assert(rank <= SuperCoder::symbols());
+            m_threshold = rank;
+        }
+
+        /// @return The rank from which the backward substitution is
+        ///         spread over the received symbols
+        uint32_t backward_substitution_threshold() const
+        {
+            return m_threshold;
+        }
+
+        /// @return The number of pivots which are not yet known to be
+        ///         backward substituted
+        uint32_t pending_backward_substitutions() const
+        {
+            assert(m_rank >= m_reduced_count);
+            return m_rank - m_reduced_count;
+        }
+
+    protected:
+
+        // Fetch the variables needed
+        using SuperCoder::m_rank;
+        using SuperCoder::m_maximum_pivot;
+        using SuperCoder::m_coded;
+        using SuperCoder::m_uncoded;
+
+    protected:
+
+        /// Performs the forward substitution and subtracts the reduced
+        /// pivots, the backward substitution of the symbol is delayed
+        /// @param symbol_data The buffer of the encoded symbol
+        /// @param coefficients The coding coefficients used to encode the
+        ///        symbol
+        void decode_coefficients(value_type *symbol_data,
+                                 value_type *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            // See if we can find a pivot
+            boost::optional<uint32_t> pivot_index
+                = SuperCoder::forward_substitute_to_pivot(
+                    symbol_data, coefficients);
+
+            if(!pivot_index)
+                return;
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                // Normalize symbol and vector
+                SuperCoder::normalize(
+                    symbol_data, coefficients, *pivot_index);
+            }
+
+            forward_substitute_reduced(
+                symbol_data, coefficients, *pivot_index);
+
+            // Now save the received symbol
+            SuperCoder::store_coded_symbol(
+                symbol_data, coefficients, *pivot_index);
+
+            // We have increased the rank
+            ++m_rank;
+
+            SuperCoder::set_symbol_coded(*pivot_index);
+
+            if(*pivot_index > m_maximum_pivot)
+            {
+                m_maximum_pivot = *pivot_index;
+            }
+        }
+
+        /// Subtracts the reduced pivots above the pivot of a received
+        /// symbol. The reduced symbols have no non-zero coefficients at
+        /// the other reduced pivots, so a single pass is enough.
+        /// @param symbol_data The data of the symbol
+        /// @param coefficients The coefficients of the symbol
+        /// @param pivot_index The pivot of the symbol
+        void forward_substitute_reduced(value_type *symbol_data,
+                                        value_type *coefficients,
+                                        uint32_t pivot_index)
+        {
+            for(uint32_t i = pivot_index + 1; i <= m_maximum_pivot; ++i)
+            {
+                if(!m_reduced[i])
+                {
+                    continue;
+                }
+
+                value_type value =
+                    fifi::get_value<field_type>(coefficients, i);
+
+                if(!value)
+                {
+                    continue;
+                }
+
+                value_type *vector_i =
+                    SuperCoder::coefficients_value(i);
+
+                value_type *symbol_i =
+                    SuperCoder::symbol_value(i);
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(
+                        coefficients, vector_i,
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::subtract(
+                        symbol_data, symbol_i,
+                        SuperCoder::symbol_length());
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        coefficients, vector_i, value,
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::multiply_subtract(
+                        symbol_data, symbol_i, value,
+                        SuperCoder::symbol_length());
+                }
+            }
+        }
+
+        /// Backward substitutes the pending pivots due for the current
+        /// rank, or all of them when the decoding is complete
+        void backward_substitute_chunk()
+        {
+            uint32_t pending = pending_backward_substitutions();
+
+            if(pending == 0 || m_rank < m_threshold)
+            {
+                return;
+            }
+
+            // The chunk spreads the pending pivots over this and the
+            // remaining symbols needed
+            uint32_t remaining = SuperCoder::symbols() - m_rank + 1;
+            uint32_t chunk = (pending + remaining - 1) / remaining;
+
+            for(uint32_t i = m_maximum_pivot + 1; i --> 0 && chunk > 0;)
+            {
+                if(!SuperCoder::symbol_pivot(i) || m_reduced[i])
+                {
+                    continue;
+                }
+
+                SuperCoder::backward_substitute(
+                    SuperCoder::symbol_value(i),
+                    SuperCoder::coefficients_value(i), i);
+
+                m_reduced[i] = true;
+                ++m_reduced_count;
+                --chunk;
+            }
+        }
+
+    protected:
+
+        /// Tracks the pivots which are backward substituted
+        std::vector<bool> m_reduced;
+
+        /// The number of pivots which are backward substituted
+        uint32_t m_reduced_count;
+
+        /// The rank from which the backward substitution starts
+        uint32_t m_threshold;
+
+    };
+}
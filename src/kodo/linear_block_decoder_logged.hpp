@@ -0,0 +1,393 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+#include <fifi/arithmetics.hpp>
+
+#include "matrix.hpp"
+#include "matrix_operations.hpp"
+#include "operation_log.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Linear block decoder eliminating the coefficient vectors
+    ///        only and recording the operations on the symbol data in an
+    ///        operation_log, which is replayed separately.
+    ///
+    /// The linear_block_decoder performs every row operation on the
+    /// coefficients and the symbol data at the same time. This decoder
+    /// splits the control plane from the data plane: the Gauss-Jordan
+    /// elimination runs on the coefficient vectors, and its row
+    /// operations are recorded as operations on slots, see
+    /// operation_log. An innovative symbol is copied to the next slot,
+    /// the symbol storage, without any field operation, and a
+    /// non-innovative symbol is discarded without touching its data.
+    ///
+    /// By default the log is replayed on the symbol storage when the
+    /// decoder is complete, so the decoder behaves as any other. With
+    /// set_replay_deferred() the log is only replayed by
+    /// replay_log(), e.g. in batches or from another thread, or the
+    /// decoding_log() is replayed on the node holding the received
+    /// symbols instead. The symbol data is only decoded once the log
+    /// has been replayed at full rank. The layer replaces the
+    /// linear_block_decoder and the coefficient_storage, and needs the
+    /// deep_symbol_storage.
+    template<class SuperCoder>
+    class linear_block_decoder_logged : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The matrix of the coefficient vectors
+        typedef matrix<field_type> matrix_type;
+
+        /// The log of the operations on the symbol data
+        typedef kodo::operation_log<field_type> log_type;
+
+    public:
+
+        /// Constructor
+        linear_block_decoder_logged()
+            : m_rank(0),
+              m_received(0),
+              m_replayed(0),
+              m_replay_deferred(false),
+              m_permuted(false)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            uint32_t max_symbols = the_factory.max_symbols();
+
+            m_rows.reset(new matrix_type(max_symbols, max_symbols));
+
+            m_vector.resize(m_rows->row_length());
+            m_unit.resize(m_rows->row_length());
+            m_temp.resize(m_rows->row_length());
+            m_slots.resize(max_symbols);
+            m_symbol.resize(the_factory.max_symbol_size());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_log.reset(SuperCoder::symbols());
+
+            m_rank = 0;
+            m_received = 0;
+            m_replayed = 0;
+            m_permuted = false;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            receive(symbol_data, reinterpret_cast<value_type*>(coefficients));
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            // An uncoded symbol is eliminated as a unit vector
+            uint32_t length = SuperCoder::coefficients_length();
+
+            std::fill_n(&m_unit[0], length, 0);
+
+            fifi::set_value<field_type>(&m_unit[0], symbol_index, 1U);
+
+            receive(symbol_data, &m_unit[0]);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_rank == SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_rank;
+        }
+
+        /// The symbol data is only decoded once the log is replayed at
+        /// full rank
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_log.pivot_slot(index) != log_type::no_slot;
+        }
+
+        /// @param deferred If true the log is only replayed by
+        ///        replay_log(), otherwise it is replayed when the
+        ///        decoder is complete
+        void set_replay_deferred(bool deferred)
+        {
+            m_replay_deferred = deferred;
+        }
+
+        /// @return True if the log is only replayed by replay_log()
+        bool is_replay_deferred() const
+        {
+            return m_replay_deferred;
+        }
+
+        /// @return The operations recorded for the current block. Slot s
+        ///         holds the received symbol log.slot_source(s), the
+        ///         index among all symbols passed to the decoder.
+        const log_type& decoding_log() const
+        {
+            return m_log;
+        }
+
+        /// @return The number of operations replayed on the symbol
+        ///         storage
+        uint32_t operations_replayed() const
+        {
+            return m_replayed;
+        }
+
+        /// Replays the operations recorded since the last replay on the
+        /// symbol storage. At full rank the symbols are then moved from
+        /// their slots to their positions, after which the storage holds
+        /// the decoded block.
+        void replay_log()
+        {
+            if(m_permuted)
+                return;
+
+            for(uint32_t i = 0; i < m_log.slots(); ++i)
+            {
+                m_slots[i] = SuperCoder::symbol(i);
+            }
+
+            m_log.replay(*SuperCoder::m_field, &m_slots[0],
+                         SuperCoder::symbol_size(), m_replayed, m_log.size());
+
+            m_replayed = m_log.size();
+
+            if(is_complete())
+            {
+                permute();
+                m_permuted = true;
+            }
+        }
+
+    protected:
+
+        /// Eliminates the coefficient vector of a symbol and stores the
+        /// symbol in a new slot if it is innovative
+        /// @param symbol_data The symbol data
+        /// @param coefficients The coefficient vector of the symbol
+        void receive(const uint8_t *symbol_data,
+                     const value_type *coefficients)
+        {
+            uint32_t source = m_received++;
+
+            if(is_complete())
+                return;
+
+            auto &field = *SuperCoder::m_field;
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t length = SuperCoder::coefficients_length();
+
+            value_type *v = &m_vector[0];
+            std::copy_n(coefficients, length, v);
+
+            m_staged.clear();
+
+            // The pivot rows are fully reduced, so subtracting one only
+            // changes the columns without a pivot
+            for(uint32_t j = 0; j < symbols; ++j)
+            {
+                value_type value = fifi::get_value<field_type>(v, j);
+
+                if(!value || m_log.pivot_slot(j) == log_type::no_slot)
+                    continue;
+
+                uint32_t slot = m_log.pivot_slot(j);
+
+                matrix_multiply_subtract(
+                    field, value, v, m_rows->row_value(slot), &m_temp[0],
+                    length);
+
+                m_staged.push_back(std::make_pair(slot, value));
+            }
+
+            uint32_t pivot = symbols;
+
+            for(uint32_t j = 0; j < symbols; ++j)
+            {
+                if(fifi::get_value<field_type>(v, j))
+                {
+                    pivot = j;
+                    break;
+                }
+            }
+
+            // A symbol which is not innovative leaves no trace
+            if(pivot == symbols)
+                return;
+
+            uint32_t slot = m_log.add_slot(source);
+
+            for(const auto &s : m_staged)
+            {
+                m_log.subtract(slot, s.first, s.second);
+            }
+
+            value_type value = fifi::get_value<field_type>(v, pivot);
+
+            if(value != 1)
+            {
+                value_type inverse = field.invert(value);
+
+                fifi::multiply_constant(field, inverse, v, length);
+                m_log.scale(slot, inverse);
+            }
+
+            // Clear the new pivot column from the other rows
+            for(uint32_t i = 0; i < slot; ++i)
+            {
+                value_type *row = m_rows->row_value(i);
+                value_type c = fifi::get_value<field_type>(row, pivot);
+
+                if(!c)
+                    continue;
+
+                matrix_multiply_subtract(field, c, row, v, &m_temp[0],
+                                         length);
+
+                m_log.subtract(i, slot, c);
+            }
+
+            std::copy_n(v, length, m_rows->row_value(slot));
+            m_log.set_pivot(pivot, slot);
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        SuperCoder::symbol(slot));
+
+            ++m_rank;
+
+            if(is_complete() && !m_replay_deferred)
+            {
+                replay_log();
+            }
+        }
+
+        /// Moves every decoded symbol from its slot to its position by
+        /// following the cycles of the permutation
+        void permute()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            std::vector<bool> done(symbols, false);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(done[i] || m_log.pivot_slot(i) == i)
+                {
+                    done[i] = true;
+                    continue;
+                }
+
+                // Position j receives the symbol in slot pivot_slot(j)
+                std::copy_n(SuperCoder::symbol(i), symbol_size, &m_symbol[0]);
+
+                uint32_t j = i;
+
+                while(m_log.pivot_slot(j) != i)
+                {
+                    uint32_t next = m_log.pivot_slot(j);
+
+                    std::copy_n(SuperCoder::symbol(next), symbol_size,
+                                SuperCoder::symbol(j));
+
+                    done[j] = true;
+                    j = next;
+                }
+
+                std::copy_n(&m_symbol[0], symbol_size, SuperCoder::symbol(j));
+                done[j] = true;
+            }
+        }
+
+    protected:
+
+        /// The reduced coefficient vectors of the slots
+        std::unique_ptr<matrix_type> m_rows;
+
+        /// The operations on the symbol data
+        log_type m_log;
+
+        /// The coefficient vector being eliminated
+        std::vector<value_type> m_vector;
+
+        /// The coefficient vector of an uncoded symbol
+        std::vector<value_type> m_unit;
+
+        /// Temporary buffer of a coefficient vector
+        std::vector<value_type> m_temp;
+
+        /// The subtractions from the vector being eliminated, kept until
+        /// it is known to be innovative
+        std::vector<std::pair<uint32_t, value_type> > m_staged;
+
+        /// The symbol data of the slots passed to the replay
+        std::vector<uint8_t*> m_slots;
+
+        /// Temporary buffer of a symbol
+        std::vector<uint8_t> m_symbol;
+
+        /// The rank of the decoder
+        uint32_t m_rank;
+
+        /// The number of symbols received in the current block
+        uint32_t m_received;
+
+        /// The number of operations replayed on the symbol storage
+        uint32_t m_replayed;
+
+        /// True if the log is only replayed by replay_log()
+        bool m_replay_deferred;
+
+        /// True if the decoded symbols are in their positions
+        bool m_permuted;
+
+    };
+
+}
@@ -0,0 +1,464 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+#include <boost/optional.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Linear block decoder for the binary field using the
+    ///        Method of Four Russians (M4RI) during forward substitution.
+    ///
+    /// The pivot positions are grouped in blocks of BlockWidth
+    /// consecutive symbols. Once all symbols in a block have a pivot a
+    /// table containing all 2^BlockWidth combinations of the block's rows
+    /// is built. An incoming symbol can then be reduced by an entire block
+    /// with a single subtraction (a table lookup) instead of up to
+    /// BlockWidth subtractions.
+    ///
+    /// Like the linear_block_decoder_delayed layer the backward
+    /// substitution is postponed until full rank is reached. This keeps
+    /// the stored symbols unchanged while decoding, which means that a
+    /// table only has to be built once. The tables require
+    /// 2^BlockWidth * (coefficients_size() + symbol_size()) bytes per
+    /// block, which is allocated the first time a block becomes full.
+    ///
+    /// The layer should be placed directly above a linear_block_decoder
+    /// layer and only supports the binary field.
+    template<uint32_t BlockWidth, class SuperCoder>
+    class base_linear_block_decoder_m4ri : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// The number of entries in a combination table
+        static const uint32_t table_entries = 1U << BlockWidth;
+
+        static_assert(fifi::is_binary<field_type>::value,
+                      "The M4RI decoder only supports the binary field");
+
+        static_assert(BlockWidth > 0 && BlockWidth <= 8,
+                      "The block width must be between 1 and 8");
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            uint32_t max_blocks =
+                (the_factory.max_symbols() + BlockWidth - 1) / BlockWidth;
+
+            m_tables.resize(max_blocks);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_blocks = (the_factory.symbols() + BlockWidth - 1) / BlockWidth;
+            invalidate_tables();
+        }
+
+        /// The restored symbols may differ from the symbols the tables
+        /// were built from, so the tables are invalidated
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            invalidate_tables();
+            return SuperCoder::read_snapshot(buffer);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            value_type *s =
+                reinterpret_cast<value_type*>(symbol_data);
+
+            value_type *c =
+                reinterpret_cast<value_type*>(coefficients);
+
+            decode_coefficients(s, c);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+            assert(symbol_data != 0);
+
+            if(m_uncoded[symbol_index])
+                return;
+
+            const value_type *symbol
+                = reinterpret_cast<const value_type*>( symbol_data );
+
+            if(m_coded[symbol_index])
+            {
+                // The swap may change the stored symbols
+                SuperCoder::swap_decode(symbol, symbol_index);
+                invalidate_tables();
+            }
+            else
+            {
+                SuperCoder::store_uncoded_symbol(symbol, symbol_index);
+
+                ++m_rank;
+
+                SuperCoder::set_symbol_uncoded(symbol_index);
+
+                if(symbol_index > m_maximum_pivot)
+                {
+                    m_maximum_pivot = symbol_index;
+                }
+            }
+
+            if(SuperCoder::is_complete())
+            {
+                final_backward_substitute();
+            }
+        }
+
+    protected:
+
+        // Fetch the variables needed
+        using SuperCoder::m_rank;
+        using SuperCoder::m_maximum_pivot;
+        using SuperCoder::m_coded;
+        using SuperCoder::m_uncoded;
+
+    protected:
+
+        /// Performs the forward substitution using the combination
+        /// tables, and stores the symbol if a pivot was found.
+        /// @param symbol_data The buffer of the encoded symbol
+        /// @param coefficients The coding coefficients of the symbol
+        void decode_coefficients(value_type *symbol_data,
+                                 value_type *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            boost::optional<uint32_t> pivot_index =
+                forward_substitute_to_pivot(symbol_data, coefficients);
+
+            if(!pivot_index)
+                return;
+
+            SuperCoder::store_coded_symbol(
+                symbol_data, coefficients, *pivot_index);
+
+            ++m_rank;
+
+            SuperCoder::set_symbol_coded(*pivot_index);
+
+            if(*pivot_index > m_maximum_pivot)
+            {
+                m_maximum_pivot = *pivot_index;
+            }
+
+            if(SuperCoder::is_complete())
+            {
+                final_backward_substitute();
+            }
+        }
+
+        /// Iterates the coding coefficients block by block and subtracts
+        /// existing symbols until a pivot is found. Blocks where all
+        /// symbols have a pivot are handled with a single table lookup.
+        /// @param symbol_data The data of the encoded symbol
+        /// @param coefficients The coding coefficients of the symbol
+        /// @return the pivot index if found.
+        boost::optional<uint32_t> forward_substitute_to_pivot(
+            value_type *symbol_data, value_type *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            for(uint32_t block = 0; block < m_blocks; ++block)
+            {
+                uint32_t start = block * BlockWidth;
+
+                if(is_block_full(block))
+                {
+                    uint32_t index = block_bits(coefficients, start);
+
+                    if(index == 0)
+                        continue;
+
+                    if(!m_tables[block].m_valid)
+                    {
+                        build_table(block);
+                    }
+
+                    subtract_entry(symbol_data, coefficients, block, index);
+                    continue;
+                }
+
+                uint32_t stop =
+                    std::min(start + BlockWidth, SuperCoder::symbols());
+
+                for(uint32_t i = start; i < stop; ++i)
+                {
+                    if(!fifi::get_value<field_type>(coefficients, i))
+                        continue;
+
+                    if(!SuperCoder::symbol_pivot(i))
+                        return boost::optional<uint32_t>(i);
+
+                    SuperCoder::subtract(
+                        coefficients, SuperCoder::coefficients_value(i),
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::subtract(
+                        symbol_data, SuperCoder::symbol_value(i),
+                        SuperCoder::symbol_length());
+                }
+            }
+
+            return boost::none;
+        }
+
+        /// Performs the final backward substitution that transform the
+        /// coding matrix from echelon form to reduce echelon form and
+        /// hence fully decode the generation
+        void final_backward_substitute()
+        {
+            assert(SuperCoder::is_complete());
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = symbols; i --> 0;)
+            {
+                value_type *symbol_i =
+                    SuperCoder::symbol_value(i);
+
+                value_type *vector_i =
+                    SuperCoder::coefficients_value(i);
+
+                SuperCoder::backward_substitute(
+                    symbol_i, vector_i, i);
+            }
+
+            // The stored symbols have changed
+            invalidate_tables();
+        }
+
+        /// @param block The block index
+        /// @return true if all symbols in the block have a pivot
+        bool is_block_full(uint32_t block) const
+        {
+            assert(block < m_blocks);
+
+            if(m_tables[block].m_valid)
+                return true;
+
+            uint32_t start = block * BlockWidth;
+
+            if(start + BlockWidth > SuperCoder::symbols())
+                return false;
+
+            for(uint32_t i = start; i < start + BlockWidth; ++i)
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// @param coefficients The coding coefficients
+        /// @param start The first symbol index of the block
+        /// @return The coefficients of the block packed in an integer
+        uint32_t block_bits(const value_type *coefficients,
+                            uint32_t start) const
+        {
+            uint32_t bits = 0;
+
+            for(uint32_t j = 0; j < BlockWidth; ++j)
+            {
+                if(fifi::get_value<field_type>(coefficients, start + j))
+                {
+                    bits |= 1U << j;
+                }
+            }
+
+            return bits;
+        }
+
+        /// Builds the combination table of a block. Entry b of the table
+        /// holds the sum of stored symbols which the forward substitution
+        /// would subtract from a symbol having the coefficients b in the
+        /// block. Since a stored symbol at pivot j contains no non-zero
+        /// coefficients before j, the entries can be computed in order of
+        /// decreasing lowest set bit, each using a single subtraction.
+        /// @param block The block index
+        void build_table(uint32_t block)
+        {
+            assert(block < m_blocks);
+            assert(is_block_full(block));
+
+            table &t = m_tables[block];
+
+            uint32_t coefficients_size = SuperCoder::coefficients_size();
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            t.m_coefficients.resize(table_entries * coefficients_size);
+            t.m_symbols.resize(table_entries * symbol_size);
+
+            uint32_t start = block * BlockWidth;
+
+            for(uint32_t j = BlockWidth; j --> 0;)
+            {
+                uint32_t pivot = start + j;
+
+                const value_type *vector_j =
+                    SuperCoder::coefficients_value(pivot);
+
+                const value_type *symbol_j =
+                    SuperCoder::symbol_value(pivot);
+
+                uint32_t row_bits = block_bits(vector_j, start);
+                assert(row_bits & (1U << j));
+                assert((row_bits & ((1U << j) - 1)) == 0);
+
+                // All indices with lowest set bit j
+                for(uint32_t index = 1U << j; index < table_entries;
+                    index += 2U << j)
+                {
+                    uint32_t previous = index ^ row_bits;
+                    assert((previous & ((2U << j) - 1)) == 0);
+
+                    value_type *c = entry_coefficients(block, index);
+                    value_type *s = entry_symbol(block, index);
+
+                    sak::copy_storage(
+                        sak::storage(c, coefficients_size),
+                        sak::storage(vector_j, coefficients_size));
+
+                    sak::copy_storage(
+                        sak::storage(s, symbol_size),
+                        sak::storage(symbol_j, symbol_size));
+
+                    if(previous == 0)
+                        continue;
+
+                    SuperCoder::add(
+                        c, entry_coefficients(block, previous),
+                        SuperCoder::coefficients_length());
+
+                    SuperCoder::add(
+                        s, entry_symbol(block, previous),
+                        SuperCoder::symbol_length());
+                }
+            }
+
+            t.m_valid = true;
+        }
+
+        /// Subtracts a table entry from the encoded symbol
+        /// @param symbol_data The data of the encoded symbol
+        /// @param coefficients The coding coefficients of the symbol
+        /// @param block The block index
+        /// @param index The table entry
+        void subtract_entry(value_type *symbol_data,
+                            value_type *coefficients,
+                            uint32_t block, uint32_t index)
+        {
+            assert(m_tables[block].m_valid);
+            assert(index > 0 && index < table_entries);
+
+            SuperCoder::subtract(
+                coefficients, entry_coefficients(block, index),
+                SuperCoder::coefficients_length());
+
+            SuperCoder::subtract(
+                symbol_data, entry_symbol(block, index),
+                SuperCoder::symbol_length());
+        }
+
+        /// @return The coding coefficients of a table entry
+        value_type* entry_coefficients(uint32_t block, uint32_t index)
+        {
+            uint32_t offset = index * SuperCoder::coefficients_size();
+            return reinterpret_cast<value_type*>(
+                &m_tables[block].m_coefficients[offset]);
+        }
+
+        /// @return The symbol data of a table entry
+        value_type* entry_symbol(uint32_t block, uint32_t index)
+        {
+            uint32_t offset = index * SuperCoder::symbol_size();
+            return reinterpret_cast<value_type*>(
+                &m_tables[block].m_symbols[offset]);
+        }
+
+        /// Marks all tables as out of date
+        void invalidate_tables()
+        {
+            for(auto &t : m_tables)
+            {
+                t.m_valid = false;
+            }
+        }
+
+    protected:
+
+        /// The combination table of a block
+        struct table
+        {
+            table()
+                : m_valid(false)
+            { }
+
+            /// True if the table matches the stored symbols
+            bool m_valid;
+
+            /// The coding coefficients of the entries
+            std::vector<uint8_t> m_coefficients;
+
+            /// The symbol data of the entries
+            std::vector<uint8_t> m_symbols;
+        };
+
+        /// The number of blocks used for the current number of symbols
+        uint32_t m_blocks;
+
+        /// The tables for each block
+        std::vector<table> m_tables;
+    };
+
+    /// @copydoc base_linear_block_decoder_m4ri
+    template<class SuperCoder>
+    class linear_block_decoder_m4ri
+        : public base_linear_block_decoder_m4ri<4, SuperCoder>
+    { };
+
+}
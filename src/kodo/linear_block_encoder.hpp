@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include <fifi/is_binary.hpp>
 #include <fifi/fifi_utils.hpp>
@@ -20,7 +21,8 @@ namespace kodo
     ///
     /// This type of encoder iterates
     /// over a coefficient vector and combines symbols according
-    /// to the coefficients selected.
+    /// to the coefficients selected. The combination overwrites the
+    /// symbol buffer, so the buffer does not have to be zeroed.
     template<class SuperCoder>
     class linear_block_encoder : public SuperCoder
     {
@@ -34,6 +36,16 @@ namespace kodo
 
     public:
 
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_sources.reserve(the_factory.max_symbols());
+            m_coefficients.reserve(the_factory.max_symbols());
+        }
+
         /// @copydoc layer::encode_symbol(uint8_t*,uint32_t)
         void encode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
         {
@@ -48,6 +60,21 @@ namespace kodo
             SuperCoder::copy_symbol(symbol_index, dest);
         }
 
+        /// Provides an uncoded symbol without copying it
+        /// @param symbol_index The index of the symbol
+        /// @return The symbol in the storage of the encoder
+        const uint8_t* encode_symbol_in_place(uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            const uint8_t *symbol = SuperCoder::symbol(symbol_index);
+
+            // Did you forget to set the data on the encoder?
+            assert(symbol != 0);
+
+            return symbol;
+        }
+
         /// @copydoc layer::encode_symbol(uint8_t*, uint8_t*)
         void encode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
         {
@@ -60,6 +87,9 @@ namespace kodo
             const value_type *c =
                 reinterpret_cast<const value_type*>(coefficients);
 
+            m_sources.clear();
+            m_coefficients.clear();
+
             for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
             {
                 value_type value = fifi::get_value<field_type>(c, i);
@@ -76,23 +106,94 @@ namespace kodo
                 assert(symbol_i != 0);
                 assert(SuperCoder::symbol_pivot(i));
 
-                if(fifi::is_binary<field_type>::value)
-                {
-                    SuperCoder::add(symbol, symbol_i,
-                                    SuperCoder::symbol_length());
-                }
-                else
-                {
-                    SuperCoder::multiply_add(
-                        symbol, symbol_i, value,
-                        SuperCoder::symbol_length());
-                }
+                m_sources.push_back(symbol_i);
+                m_coefficients.push_back(value);
             }
+
+            // All sources are combined in a single pass over the
+            // destination symbol, the first source initialises it so the
+            // symbol buffer does not have to be zeroed
+            SuperCoder::multiply_sources(
+                symbol, m_sources.data(), m_coefficients.data(),
+                static_cast<uint32_t>(m_sources.size()),
+                SuperCoder::symbol_length());
         }
 
-    };
+        /// @copydoc layer::encode_symbol(uint8_t*, const uint32_t*,
+        ///                              const value_type*, uint32_t)
+        void encode_symbol(uint8_t *symbol_data, const uint32_t *indices,
+                           const value_type *coefficients, uint32_t count)
+        {
+            assert(symbol_data != 0);
+            assert(count == 0 || indices != 0);
+            assert(count == 0 || coefficients != 0);
 
-}
+            m_sources.clear();
 
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                assert(indices[i] < SuperCoder::symbols());
+                assert(coefficients[i] != 0);
 
+                const value_type *symbol_i =
+                    SuperCoder::symbol_value(indices[i]);
 
+                // Did you forget to set the data on the encoder?
+                assert(symbol_i != 0);
+                assert(SuperCoder::symbol_pivot(indices[i]));
+
+                m_sources.push_back(symbol_i);
+            }
+
+            SuperCoder::multiply_sources(
+                reinterpret_cast<value_type*>(symbol_data),
+                m_sources.data(), coefficients, count,
+                SuperCoder::symbol_length());
+        }
+
+        /// Updates a coded symbol in place after a source symbol changed,
+        /// without encoding it again. Coding is linear, so the symbol
+        /// changes by the coefficient of the source times the change of
+        /// the source, in the binary extension fields the XOR of the old
+        /// and new source. Only the source changed is read, so keeping
+        /// e.g. cached repair symbols up to date after a small write
+        /// costs one symbol operation per coded symbol instead of a full
+        /// encoding.
+        /// @param symbol_data The coded symbol of layer::symbol_size()
+        ///        bytes
+        /// @param coefficients The coefficients the symbol was coded
+        ///        with
+        /// @param symbol_index The index of the source symbol changed
+        /// @param delta The new source symbol minus the old one
+        void update_symbol(uint8_t *symbol_data, const uint8_t *coefficients,
+                           uint32_t symbol_index, const uint8_t *delta)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+            assert(delta != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            value_type coefficient = fifi::get_value<field_type>(
+                reinterpret_cast<const value_type*>(coefficients),
+                symbol_index);
+
+            if(!coefficient)
+                return;
+
+            SuperCoder::multiply_add(
+                reinterpret_cast<value_type*>(symbol_data),
+                reinterpret_cast<const value_type*>(delta),
+                coefficient, SuperCoder::symbol_length());
+        }
+
+    protected:
+
+        /// The source symbols used in the current encoding
+        std::vector<const value_type*> m_sources;
+
+        /// The coefficients of the source symbols in m_sources
+        std::vector<value_type> m_coefficients;
+
+    };
+
+}
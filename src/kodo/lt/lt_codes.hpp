@@ -0,0 +1,122 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../sparse_symbol_id_encoder.hpp"
+#include "../sparse_symbol_id_decoder.hpp"
+#include "../coefficient_info.hpp"
+#include "../seed_symbol_id_writer.hpp"
+#include "../seed_symbol_id_reader.hpp"
+#include "../robust_soliton_generator.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+
+#include "../linear_block_encoder.hpp"
+#include "../inactivation_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Fountain encoder in the style of the LT codes.
+    ///
+    /// The key features of this configuration is the following:
+    /// - Systematic encoding (uncoded symbols produced before switching
+    ///   to coding)
+    /// - The number of symbols combined in an encoded symbol is drawn from
+    ///   the robust soliton distribution, so encoding a symbol costs
+    ///   O(log k) symbol operations on average.
+    /// - A seed is sent instead of the encoding vector, and the symbol is
+    ///   encoded from the list of non-zero coefficients.
+    ///
+    /// The low cost per symbol allows encoding large objects as a single
+    /// block, e.g. several thousand symbols, instead of partitioning
+    /// them into generations. The binary field gives the LT codes,
+    /// larger fields reduce the number of symbols needed to decode.
+    template<class Field>
+    class lt_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 sparse_symbol_id_encoder<
+                 // Symbol ID API
+                 seed_symbol_id_writer<
+                 // Coefficient Generator API
+                 robust_soliton_generator<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 lt_encoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Decoder for the symbols of the lt_encoder.
+    ///
+    /// The generator reproduces the non-zero coefficients from the seed,
+    /// and the inactivation_decoder decodes the symbols mostly by
+    /// peeling. When the peeling stops, the few inactivated symbols are
+    /// solved by Gaussian elimination, which as in the Raptor codes
+    /// makes the decoding succeed with fewer extra symbols than peeling
+    /// alone.
+    template<class Field>
+    class lt_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 sparse_symbol_id_decoder<
+                 // Symbol ID API
+                 seed_symbol_id_reader<
+                 // Coefficient Generator API
+                 robust_soliton_generator<
+                 // Codec API
+                 inactivation_decoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 lt_decoder<Field>
+                     > > > > > > > > > > > > >
+    { };
+
+}
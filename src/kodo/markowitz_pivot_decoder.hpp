@@ -0,0 +1,353 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Chooses the pivot of a coded symbol to minimise the
+    ///        fill-in of the linear_block_decoder.
+    ///
+    /// The linear_block_decoder uses the first non-zero coefficient
+    /// without a pivot as the pivot of a received symbol, and then
+    /// subtracts the symbol from every stored symbol with a non-zero
+    /// coefficient in that column. Each of those subtractions copies
+    /// the non-zero coefficients of the new symbol into the stored
+    /// one, so for sparse encoding vectors the stored vectors soon
+    /// become dense and every following symbol is eliminated against
+    /// dense rows.
+    ///
+    /// This layer keeps the number of stored coded symbols with a
+    /// non-zero coefficient in every column. After the received symbol
+    /// is reduced by all its pivot columns, the remaining non-zero
+    /// column found in the fewest stored symbols becomes the pivot,
+    /// which is the Markowitz choice as the number of non-zero
+    /// coefficients of the new row is the same for every column. If
+    /// the column is in no stored symbol the backward substitution is
+    /// skipped entirely.
+    ///
+    /// The pivots are no longer increasing along the rows, but the
+    /// stored symbols stay reduced, i.e. every pivot column is zero in
+    /// the other symbols, so the decoding state can be used as before
+    /// e.g. for recoding. The coefficient vectors are kept in the dense
+    /// storage of the decoder, their non-zero coefficients are found
+    /// with linear_block_decoder::next_nonzero() which skips zero words.
+    ///
+    /// The layer is placed directly above the linear_block_decoder.
+    template<class SuperCoder>
+    class markowitz_pivot_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+            m_column_counts.resize(the_factory.max_symbols(), 0);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill_n(m_column_counts.begin(), the_factory.symbols(), 0);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *symbol_coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_coefficients != 0);
+
+            value_type *symbol
+                = reinterpret_cast<value_type*>(symbol_data);
+
+            value_type *coefficients
+                = reinterpret_cast<value_type*>(symbol_coefficients);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            eliminate_pivots(symbol, coefficients);
+
+            uint32_t pivot_index = select_pivot(coefficients);
+
+            if(pivot_index == symbols)
+            {
+                // The symbol was not innovative
+                return;
+            }
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::normalize(symbol, coefficients, pivot_index);
+            }
+
+            substitute(symbol, coefficients, pivot_index);
+
+            SuperCoder::store_coded_symbol(symbol, coefficients,
+                                           pivot_index);
+
+            count_nonzeros(coefficients, true);
+
+            ++SuperCoder::m_rank;
+
+            SuperCoder::set_symbol_coded(pivot_index);
+
+            if(pivot_index > SuperCoder::m_maximum_pivot)
+            {
+                SuperCoder::m_maximum_pivot = pivot_index;
+            }
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*, uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            bool swap = SuperCoder::m_coded[symbol_index];
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(swap)
+            {
+                // The coded symbol stored at the index was decoded
+                // again, which is rare, so the counts are rebuilt
+                recount();
+            }
+            else
+            {
+                // The uncoded symbol only removed its own column from
+                // the coded symbols
+                m_column_counts[symbol_index] = 0;
+            }
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+
+            if(buffer != 0)
+            {
+                recount();
+            }
+
+            return buffer;
+        }
+
+        /// @param index The index of a column
+        /// @return The number of stored coded symbols with a non-zero
+        ///         coefficient in the column
+        uint32_t column_count(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_column_counts[index];
+        }
+
+    protected:
+
+        /// Subtracts the stored symbols of all pivot columns in which
+        /// the received symbol has a non-zero coefficient. A stored
+        /// symbol is zero in the other pivot columns, so a subtraction
+        /// only changes columns without a pivot and each pivot column
+        /// is visited once.
+        /// @param symbol_data The symbol data
+        /// @param symbol_id The coefficients of the symbol
+        void eliminate_pivots(value_type *symbol_data,
+                              value_type *symbol_id)
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = SuperCoder::next_nonzero(symbol_id, 0);
+                i < symbols; i = SuperCoder::next_nonzero(symbol_id, i + 1))
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    continue;
+                }
+
+                value_type coefficient =
+                    fifi::get_value<field_type>(symbol_id, i);
+
+                subtract_row(symbol_data, symbol_id,
+                             SuperCoder::symbol_value(i),
+                             SuperCoder::coefficients_value(i),
+                             coefficient);
+            }
+        }
+
+        /// @param symbol_id The coefficients of a symbol reduced by all
+        ///        pivot columns
+        /// @return The non-zero column found in the fewest stored coded
+        ///         symbols, the first one on a tie, or layer::symbols()
+        ///         if the coefficients are all zero
+        uint32_t select_pivot(const value_type *symbol_id) const
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t pivot_index = symbols;
+
+            for(uint32_t i = SuperCoder::next_nonzero(symbol_id, 0);
+                i < symbols; i = SuperCoder::next_nonzero(symbol_id, i + 1))
+            {
+                assert(!SuperCoder::symbol_pivot(i));
+
+                if(pivot_index == symbols ||
+                   m_column_counts[i] < m_column_counts[pivot_index])
+                {
+                    pivot_index = i;
+
+                    if(m_column_counts[i] == 0)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            return pivot_index;
+        }
+
+        /// Subtracts the new symbol from the stored coded symbols with a
+        /// non-zero coefficient in its pivot column, the search stops
+        /// once the counted number of symbols is found
+        /// @param symbol_data The symbol data
+        /// @param symbol_id The normalized coefficients of the symbol
+        /// @param pivot_index The pivot of the symbol
+        void substitute(const value_type *symbol_data,
+                        const value_type *symbol_id, uint32_t pivot_index)
+        {
+            uint32_t remaining = m_column_counts[pivot_index];
+
+            for(uint32_t i = 0;
+                remaining > 0 && i <= SuperCoder::m_maximum_pivot; ++i)
+            {
+                if(!SuperCoder::m_coded[i])
+                {
+                    continue;
+                }
+
+                value_type *vector_i = SuperCoder::coefficients_value(i);
+
+                value_type value =
+                    fifi::get_value<field_type>(vector_i, pivot_index);
+
+                if(!value)
+                {
+                    continue;
+                }
+
+                --remaining;
+
+                count_nonzeros(vector_i, false);
+
+                subtract_row(SuperCoder::symbol_value(i), vector_i,
+                             symbol_data, symbol_id, value);
+
+                count_nonzeros(vector_i, true);
+            }
+
+            assert(remaining == 0);
+        }
+
+        /// Subtracts a multiple of a source row from a destination row
+        /// @param dest_data The data of the destination
+        /// @param dest_id The coefficients of the destination
+        /// @param src_data The data of the source
+        /// @param src_id The coefficients of the source
+        /// @param coefficient The multiple
+        void subtract_row(value_type *dest_data, value_type *dest_id,
+                          const value_type *src_data,
+                          const value_type *src_id, value_type coefficient)
+        {
+            if(fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::subtract(dest_id, src_id,
+                                     SuperCoder::coefficients_length());
+
+                SuperCoder::subtract(dest_data, src_data,
+                                     SuperCoder::symbol_length());
+            }
+            else
+            {
+                SuperCoder::multiply_subtract(
+                    dest_id, src_id, coefficient,
+                    SuperCoder::coefficients_length());
+
+                SuperCoder::multiply_subtract(
+                    dest_data, src_data, coefficient,
+                    SuperCoder::symbol_length());
+            }
+        }
+
+        /// Adds or removes the non-zero coefficients of a stored coded
+        /// symbol to the column counts
+        /// @param symbol_id The coefficients of the symbol
+        /// @param add True to add the symbol, false to remove it
+        void count_nonzeros(const value_type *symbol_id, bool add)
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = SuperCoder::next_nonzero(symbol_id, 0);
+                i < symbols; i = SuperCoder::next_nonzero(symbol_id, i + 1))
+            {
+                if(add)
+                {
+                    ++m_column_counts[i];
+                }
+                else
+                {
+                    assert(m_column_counts[i] > 0);
+                    --m_column_counts[i];
+                }
+            }
+        }
+
+        /// Rebuilds the column counts from the stored coded symbols
+        void recount()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            std::fill_n(m_column_counts.begin(), symbols, 0);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(SuperCoder::m_coded[i])
+                {
+                    count_nonzeros(SuperCoder::coefficients_value(i), true);
+                }
+            }
+        }
+
+    protected:
+
+        /// The number of stored coded symbols with a non-zero
+        /// coefficient in each column
+        std::vector<uint32_t> m_column_counts;
+
+    };
+
+}
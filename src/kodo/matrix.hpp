@@ -5,13 +5,24 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
 #include <fifi/fifi_utils.hpp>
 
+#include <sak/aligned_allocator.hpp>
+
 namespace kodo
 {
 
     /// @brief Simple storage class with a matrix API for finite
     ///        field elements.
+    ///
+    /// The rows start on row_alignment byte boundaries, the row stride
+    /// is the row size padded to a multiple of the alignment, so the
+    /// region operations used by the kernels in matrix_operations.hpp
+    /// work on aligned rows. The padding is always zero.
     template<class Field>
     class matrix
     {
@@ -23,6 +34,9 @@ namespace kodo
         /// The value type used in the finite field
         typedef typename field_type::value_type value_type;
 
+        /// The alignment in bytes of the rows
+        static const uint32_t row_alignment = 16;
+
     public:
 
         /// Constructor
@@ -38,7 +52,10 @@ namespace kodo
             m_row_size = fifi::elements_to_size<field_type>(m_columns);
             m_row_length = fifi::size_to_length<field_type>(m_row_size);
 
-            m_data.resize(rows * m_row_size, '\0');
+            m_row_stride = ((m_row_size + row_alignment - 1) /
+                            row_alignment) * row_alignment;
+
+            m_data.resize(rows * m_row_stride, '\0');
         }
 
         /// Returns the element at the specific row and column in
@@ -81,20 +98,27 @@ namespace kodo
             return m_row_length;
         }
 
+        /// @return The distance in bytes between the start of two rows,
+        ///         at least row_size() and a multiple of row_alignment
+        uint32_t row_stride() const
+        {
+            return m_row_stride;
+        }
+
         /// Return the bytes of a row at a specific index
         /// @param index The index of the row to return
         /// @return The byte corresponding to the selected row.
         uint8_t* row(uint32_t index)
         {
             assert(index < m_rows);
-            return &m_data[index * m_row_size];
+            return &m_data[index * m_row_stride];
         }
 
         /// @copydoc row(uint32_t)
         const uint8_t* row(uint32_t index) const
         {
             assert(index < m_rows);
-            return &m_data[index * m_row_size];
+            return &m_data[index * m_row_stride];
         }
 
         /// Return a value_type pointer to a row at a specific index
@@ -157,8 +181,11 @@ namespace kodo
         /// The length of a row in value_type elements
         uint32_t m_row_length;
 
+        /// The distance in bytes between two rows
+        uint32_t m_row_stride;
+
         /// The buffer storing the data of the matrix
-        std::vector<uint8_t> m_data;
+        std::vector<uint8_t, sak::aligned_allocator<uint8_t> > m_data;
 
     };
 
@@ -0,0 +1,283 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <fifi/arithmetics.hpp>
+
+#include "matrix.hpp"
+
+namespace kodo
+{
+
+    /// The size in bytes of the column tiles of the matrix kernels, a
+    /// tile of the destination rows stays in the L1 cache while the
+    /// source rows are added to it
+    const uint32_t matrix_tile_size = 1024;
+
+    /// The number of source rows added to a destination tile before the
+    /// next destination row is processed, so a block of source tiles is
+    /// reused from the L1 cache by all destination rows
+    const uint32_t matrix_block_rows = 32;
+
+    /// Adds a multiple of a region to another region
+    /// @param field The finite field implementation
+    /// @param coefficient The coefficient of the source, non-zero
+    /// @param dest The destination region
+    /// @param src The source region
+    /// @param temp Temporary buffer of at least length values
+    /// @param length The length of the regions in value_type elements
+    template<class FieldImpl>
+    inline void matrix_multiply_add(
+        FieldImpl &field, typename FieldImpl::value_type coefficient,
+        typename FieldImpl::value_type *dest,
+        const typename FieldImpl::value_type *src,
+        typename FieldImpl::value_type *temp, uint32_t length)
+    {
+        assert(coefficient != 0);
+
+        if(coefficient == 1)
+        {
+            fifi::add(field, dest, src, length);
+        }
+        else
+        {
+            fifi::multiply_add(field, coefficient, dest, src, temp, length);
+        }
+    }
+
+    /// Subtracts a multiple of a region from another region
+    /// @copydetails matrix_multiply_add(FieldImpl&,
+    ///     typename FieldImpl::value_type, typename FieldImpl::value_type*,
+    ///     const typename FieldImpl::value_type*,
+    ///     typename FieldImpl::value_type*, uint32_t)
+    template<class FieldImpl>
+    inline void matrix_multiply_subtract(
+        FieldImpl &field, typename FieldImpl::value_type coefficient,
+        typename FieldImpl::value_type *dest,
+        const typename FieldImpl::value_type *src,
+        typename FieldImpl::value_type *temp, uint32_t length)
+    {
+        assert(coefficient != 0);
+
+        if(coefficient == 1)
+        {
+            fifi::subtract(field, dest, src, length);
+        }
+        else
+        {
+            fifi::multiply_subtract(
+                field, coefficient, dest, src, temp, length);
+        }
+    }
+
+    /// Multiplies a matrix with a set of rows, row i of the destination
+    /// is the sum of the source rows multiplied with row i of the
+    /// matrix. The destination is processed in tiles of
+    /// matrix_tile_size bytes and the source rows in blocks of
+    /// matrix_block_rows rows.
+    /// @param field The finite field implementation
+    /// @param a The matrix, with one column per source row
+    /// @param src The first source row
+    /// @param src_stride The distance in bytes between two source rows
+    /// @param dest The first destination row, one per row of the matrix
+    /// @param dest_stride The distance in bytes between two destination
+    ///        rows
+    /// @param length The length of the rows in value_type elements
+    template<class FieldImpl>
+    inline void multiply_matrix_rows(
+        FieldImpl &field, const matrix<typename FieldImpl::field_type> &a,
+        const uint8_t *src, uint32_t src_stride,
+        uint8_t *dest, uint32_t dest_stride, uint32_t length)
+    {
+        typedef typename FieldImpl::value_type value_type;
+
+        assert(src != 0);
+        assert(dest != 0);
+        assert(length > 0);
+
+        const uint32_t tile_length =
+            std::max<uint32_t>(1U, matrix_tile_size / sizeof(value_type));
+
+        std::vector<value_type> temp(std::min(tile_length, length));
+
+        for(uint32_t offset = 0; offset < length; offset += tile_length)
+        {
+            uint32_t tile = std::min(tile_length, length - offset);
+
+            for(uint32_t i = 0; i < a.rows(); ++i)
+            {
+                value_type *d = reinterpret_cast<value_type*>(
+                    dest + i * dest_stride) + offset;
+
+                std::fill_n(d, tile, 0);
+            }
+
+            for(uint32_t first = 0; first < a.columns();
+                first += matrix_block_rows)
+            {
+                uint32_t last =
+                    std::min(first + matrix_block_rows, a.columns());
+
+                for(uint32_t i = 0; i < a.rows(); ++i)
+                {
+                    value_type *d = reinterpret_cast<value_type*>(
+                        dest + i * dest_stride) + offset;
+
+                    for(uint32_t j = first; j < last; ++j)
+                    {
+                        value_type coefficient = a.element(i, j);
+
+                        if(coefficient == 0)
+                            continue;
+
+                        const value_type *s =
+                            reinterpret_cast<const value_type*>(
+                                src + j * src_stride) + offset;
+
+                        matrix_multiply_add(
+                            field, coefficient, d, s, &temp[0], tile);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Computes the matrix product a * b
+    /// @param field The finite field implementation
+    /// @param a The left matrix
+    /// @param b The right matrix, with a.columns() rows
+    /// @param result The product, with a.rows() rows and b.columns()
+    ///        columns, must not be a or b
+    template<class FieldImpl>
+    inline void multiply_matrices(
+        FieldImpl &field, const matrix<typename FieldImpl::field_type> &a,
+        const matrix<typename FieldImpl::field_type> &b,
+        matrix<typename FieldImpl::field_type> &result)
+    {
+        assert(a.columns() == b.rows());
+        assert(result.rows() == a.rows());
+        assert(result.columns() == b.columns());
+        assert(&result != &a);
+        assert(&result != &b);
+
+        multiply_matrix_rows(field, a, b.row(0), b.row_stride(),
+                             result.row(0), result.row_stride(),
+                             b.row_length());
+    }
+
+    /// Multiplies a matrix with a block of symbols, e.g. produces the
+    /// coded symbols of a stripe from a generator matrix or the erased
+    /// symbols from a decoding matrix
+    /// @param field The finite field implementation
+    /// @param a The matrix, with one column per source symbol
+    /// @param src The source symbols stored one after the other
+    /// @param dest The buffer of a.rows() destination symbols
+    /// @param symbol_size The size in bytes of a symbol
+    template<class FieldImpl>
+    inline void multiply_block(
+        FieldImpl &field, const matrix<typename FieldImpl::field_type> &a,
+        const uint8_t *src, uint8_t *dest, uint32_t symbol_size)
+    {
+        typedef typename FieldImpl::value_type value_type;
+
+        assert(symbol_size > 0);
+        assert(symbol_size % sizeof(value_type) == 0);
+
+        multiply_matrix_rows(field, a, src, symbol_size, dest, symbol_size,
+                             symbol_size / sizeof(value_type));
+    }
+
+    /// Inverts a square matrix using Gauss-Jordan elimination
+    /// @param field The finite field implementation
+    /// @param a The matrix to invert
+    /// @param inverse The inverse of a, with the dimensions of a, must
+    ///        not be a
+    /// @return False if a is singular, the inverse is then undefined
+    template<class FieldImpl>
+    inline bool invert_matrix(
+        FieldImpl &field, const matrix<typename FieldImpl::field_type> &a,
+        matrix<typename FieldImpl::field_type> &inverse)
+    {
+        typedef typename FieldImpl::value_type value_type;
+        typedef matrix<typename FieldImpl::field_type> matrix_type;
+
+        assert(a.rows() == a.columns());
+        assert(inverse.rows() == a.rows());
+        assert(inverse.columns() == a.columns());
+        assert(&inverse != &a);
+
+        uint32_t size = a.rows();
+        uint32_t row_size = a.row_size();
+        uint32_t length = a.row_length();
+
+        matrix_type t(size, size);
+
+        for(uint32_t i = 0; i < size; ++i)
+        {
+            std::copy_n(a.row(i), row_size, t.row(i));
+            std::fill_n(inverse.row(i), row_size, 0);
+
+            value_type one = 1U;
+            inverse.set_element(i, i, one);
+        }
+
+        std::vector<value_type> temp(length);
+
+        for(uint32_t i = 0; i < size; ++i)
+        {
+            uint32_t pivot = i;
+
+            while(pivot < size && t.element(pivot, i) == 0)
+            {
+                ++pivot;
+            }
+
+            if(pivot == size)
+                return false;
+
+            if(pivot != i)
+            {
+                std::swap_ranges(t.row(i), t.row(i) + row_size,
+                                 t.row(pivot));
+
+                std::swap_ranges(inverse.row(i), inverse.row(i) + row_size,
+                                 inverse.row(pivot));
+            }
+
+            value_type scale = field.invert(t.element(i, i));
+
+            if(scale != 1)
+            {
+                fifi::multiply_constant(field, scale, t.row_value(i), length);
+                fifi::multiply_constant(
+                    field, scale, inverse.row_value(i), length);
+            }
+
+            for(uint32_t j = 0; j < size; ++j)
+            {
+                value_type value = t.element(j, i);
+
+                if(j == i || value == 0)
+                    continue;
+
+                matrix_multiply_subtract(field, value, t.row_value(j),
+                                         t.row_value(i), &temp[0], length);
+
+                matrix_multiply_subtract(field, value, inverse.row_value(j),
+                                         inverse.row_value(i), &temp[0],
+                                         length);
+            }
+        }
+
+        return true;
+    }
+
+}
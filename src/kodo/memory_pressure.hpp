@@ -0,0 +1,122 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @brief Process-wide callbacks releasing cached memory, e.g. the
+    ///        unused coders of the factory pools, when the application
+    ///        detects memory pressure.
+    ///
+    /// Kodo does not watch the memory itself. The application calls
+    /// signal(), e.g. when a Linux pressure stall (PSI) trigger or the
+    /// memory.events of its cgroup fires, or when its own accounting
+    /// reaches a limit. The callbacks run on the thread calling
+    /// signal(), a factory which is not thread-safe must therefore be
+    /// signalled from the thread using it.
+    class memory_pressure
+    {
+    public:
+
+        /// The callback type
+        typedef std::function<void()> callback;
+
+        /// A subscription never returned by subscribe()
+        static const uint32_t no_subscription = 0;
+
+    public:
+
+        /// Adds a callback
+        /// @param function The callback
+        /// @return The subscription, passed to unsubscribe()
+        static uint32_t subscribe(const callback &function)
+        {
+            registry &r = instance();
+            std::lock_guard<std::mutex> lock(r.m_mutex);
+
+            uint32_t id = ++r.m_next;
+            r.m_callbacks[id] = function;
+
+            return id;
+        }
+
+        /// Removes a callback
+        /// @param subscription The subscription returned by subscribe()
+        static void unsubscribe(uint32_t subscription)
+        {
+            registry &r = instance();
+            std::lock_guard<std::mutex> lock(r.m_mutex);
+
+            r.m_callbacks.erase(subscription);
+        }
+
+        /// Invokes all callbacks
+        static void signal()
+        {
+            std::vector<callback> callbacks;
+
+            {
+                registry &r = instance();
+                std::lock_guard<std::mutex> lock(r.m_mutex);
+
+                for(const auto &c : r.m_callbacks)
+                {
+                    callbacks.push_back(c.second);
+                }
+            }
+
+            for(const callback &c : callbacks)
+            {
+                c();
+            }
+        }
+
+        /// @return The number of callbacks
+        static uint32_t subscriptions()
+        {
+            registry &r = instance();
+            std::lock_guard<std::mutex> lock(r.m_mutex);
+
+            return static_cast<uint32_t>(r.m_callbacks.size());
+        }
+
+    private:
+
+        /// The callbacks of the process
+        struct registry
+        {
+            /// Constructor
+            registry()
+                : m_next(0)
+            { }
+
+            /// Protects the callbacks
+            std::mutex m_mutex;
+
+            /// The callbacks by subscription
+            std::map<uint32_t, callback> m_callbacks;
+
+            /// The last subscription handed out
+            uint32_t m_next;
+        };
+
+        /// @return The registry of the process
+        static registry& instance()
+        {
+            static registry r;
+            return r;
+        }
+
+    };
+
+}
@@ -0,0 +1,158 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/aligned_allocator.hpp>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Merges the symbols received by another decoder of the
+    ///        same block into this decoder.
+    ///
+    /// When a block is received over several paths, e.g. on a thread
+    /// per network interface, each path may decode into a decoder of
+    /// its own in parallel instead of passing every payload to a single
+    /// decoding thread. Once the paths are done, merge() folds the
+    /// stored symbols of the other decoders into one of them: the
+    /// decoded symbols of the other decoder are passed as uncoded
+    /// symbols, and its coded symbols are first reduced on their
+    /// coefficients only, see the coefficient_first_decoder, so the
+    /// data of a symbol is only read and substituted when it adds to
+    /// the rank.
+    ///
+    /// Neither decoder may decode while they are merged. The layer is
+    /// placed directly above the coefficient_first_decoder.
+    template<class SuperCoder>
+    class merging_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_symbol_scratch.resize(
+                fifi::size_to_length<field_type>(
+                    the_factory.max_symbol_size()));
+
+            m_coefficients_scratch.resize(
+                fifi::elements_to_length<field_type>(
+                    the_factory.max_symbols()));
+        }
+
+        /// Folds the symbols stored by another decoder of the same block
+        /// into this decoder, the other decoder is not changed
+        /// @param other The other decoder, which must use the same
+        ///        field, number of symbols and symbol size
+        /// @return The number of symbols of the other decoder which
+        ///         increased the rank
+        template<class Decoder>
+        uint32_t merge(Decoder &other)
+        {
+            assert(other.symbols() == SuperCoder::symbols());
+            assert(other.symbol_size() == SuperCoder::symbol_size());
+            assert(other.coefficients_length() ==
+                   SuperCoder::coefficients_length());
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t rank = SuperCoder::rank();
+
+            // The decoded symbols need no elimination, so they go first
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(SuperCoder::is_complete())
+                {
+                    break;
+                }
+
+                if(other.symbol_pivot(i) && !other.symbol_coded(i))
+                {
+                    SuperCoder::decode_symbol(other.symbol(i), i);
+                }
+            }
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(SuperCoder::is_complete())
+                {
+                    break;
+                }
+
+                if(other.symbol_pivot(i) && other.symbol_coded(i))
+                {
+                    merge_coded(other.symbol_value(i),
+                                other.coefficients_value(i));
+                }
+            }
+
+            return SuperCoder::rank() - rank;
+        }
+
+    protected:
+
+        /// Decodes a coded symbol of another decoder if it is innovative
+        /// @param symbol_data The data of the symbol
+        /// @param symbol_id The coefficients of the symbol
+        void merge_coded(const value_type *symbol_data,
+                         const value_type *symbol_id)
+        {
+            value_type *symbol = &m_symbol_scratch[0];
+            value_type *coefficients = &m_coefficients_scratch[0];
+
+            std::copy_n(symbol_id, SuperCoder::coefficients_length(),
+                        coefficients);
+
+            if(!SuperCoder::forward_substitute_coefficients(coefficients))
+            {
+                // The data of the symbol is never read
+                return;
+            }
+
+            std::copy_n(symbol_data, SuperCoder::symbol_length(), symbol);
+
+            SuperCoder::replay_operations(symbol);
+
+            // The coefficients are reduced up to the pivot, so the
+            // decoder below finds it without further substitutions
+            SuperCoder::decode_symbol(reinterpret_cast<uint8_t*>(symbol),
+                                      reinterpret_cast<uint8_t*>(
+                                          coefficients));
+        }
+
+    protected:
+
+        /// The storage type of the scratch buffers
+        typedef std::vector<value_type, sak::aligned_allocator<value_type> >
+            aligned_vector;
+
+        /// The data of a coded symbol of the other decoder
+        aligned_vector m_symbol_scratch;
+
+        /// The coefficients of a coded symbol of the other decoder
+        aligned_vector m_coefficients_scratch;
+
+    };
+
+}
@@ -0,0 +1,57 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include "object_encoder.hpp"
+#include "mmap_file_reader.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief A memory mapped file encoder creates a number of shallow
+    ///        storage encoders over the data of a file.
+    ///
+    /// Same as the file_encoder but the encoders point directly into a
+    /// memory mapping of the file, see mmap_file_reader.
+    template
+    <
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class mmap_file_encoder : public
+            object_encoder
+            <
+                mmap_file_reader<EncoderType>,
+                EncoderType,
+                BlockPartitioning
+            >
+    {
+    public:
+
+        /// The encoder factory type
+        typedef typename EncoderType::factory factory;
+
+    public:
+
+        /// Constructs a new memory mapped file encoder
+        /// @param factory the encoder factory to use
+        /// @param filename the file to encode
+        /// @param access the expected order in which the encoders are
+        ///        built
+        mmap_file_encoder(typename EncoderType::factory &factory,
+                          const std::string &filename,
+                          mmap_access access = mmap_access::sequential)
+            : object_encoder
+                  <
+                  mmap_file_reader<EncoderType>,
+                  EncoderType,
+                  BlockPartitioning
+                  >
+              (factory, mmap_file_reader<EncoderType>(filename, access))
+            { }
+    };
+}
@@ -0,0 +1,209 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <sak/storage.hpp>
+
+#include "has_concurrent_read.hpp"
+#include "has_shallow_symbol_storage.hpp"
+
+namespace kodo
+{
+
+    /// The expected order in which the blocks of a memory mapped file
+    /// are read, used to give the kernel hints about the read-ahead
+    enum class mmap_access
+    {
+        /// The blocks are read in order of their offset
+        sequential,
+
+        /// The blocks are read in an unpredictable order
+        random
+    };
+
+    /// @brief Read-only memory mapping of an entire file (POSIX).
+    ///
+    /// The mapping is removed when the object is destroyed.
+    class mapped_file : boost::noncopyable
+    {
+    public:
+
+        /// Maps a file into memory
+        /// @param filename The file to map
+        /// @param access The expected access pattern
+        mapped_file(const std::string &filename, mmap_access access)
+            : m_data(0),
+              m_size(0)
+        {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            assert(fd >= 0);
+
+            struct stat info;
+            int result = ::fstat(fd, &info);
+            assert(result == 0);
+            (void) result;
+
+            assert(info.st_size > 0);
+            m_size = static_cast<uint64_t>(info.st_size);
+
+            void *data = ::mmap(0, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            assert(data != MAP_FAILED);
+
+            // The mapping stays valid after the file is closed
+            ::close(fd);
+
+            m_data = static_cast<const uint8_t*>(data);
+
+            int advice = access == mmap_access::sequential ?
+                MADV_SEQUENTIAL : MADV_RANDOM;
+
+            ::madvise(data, m_size, advice);
+        }
+
+        /// Unmaps the file
+        ~mapped_file()
+        {
+            ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+
+        /// @return The mapped data
+        const uint8_t* data() const
+        {
+            return m_data;
+        }
+
+        /// @return The size of the file in bytes
+        uint64_t size() const
+        {
+            return m_size;
+        }
+
+        /// Asks the kernel to start reading a range of the file, so
+        /// that the pages are resident when the encoder accesses them
+        /// @param offset The offset in bytes of the range
+        /// @param size The size in bytes of the range
+        void will_need(uint64_t offset, uint32_t size) const
+        {
+            assert(offset + size <= m_size);
+
+            uint64_t page_size =
+                static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+            uint64_t begin = offset - (offset % page_size);
+
+            ::madvise(const_cast<uint8_t*>(m_data + begin),
+                      offset + size - begin, MADV_WILLNEED);
+        }
+
+    private:
+
+        /// The mapped data
+        const uint8_t *m_data;
+
+        /// The size of the mapping in bytes
+        uint64_t m_size;
+
+    };
+
+    /// @ingroup object_data_implementation
+    ///
+    /// @brief The memory mapped file reader maps a local file into
+    ///        memory and initializes shallow storage encoders with
+    ///        pointers directly into the mapping. This class can be used
+    ///        in conjunction with object encoders.
+    ///
+    /// Compared to the file_reader no data is copied and no buffer is
+    /// allocated per block, the pages of the file are read on demand by
+    /// the kernel. The last block of a file is normally only partially
+    /// filled, so the encoders should use the
+    /// partial_shallow_symbol_storage layer.
+    ///
+    /// Copies of a reader share the mapping, which is kept until the
+    /// last copy is destroyed. The encoders point into the mapping, so
+    /// a reader must outlive the encoders initialized by it.
+    template<class EncoderType>
+    class mmap_file_reader
+    {
+    public:
+
+        static_assert(has_const_shallow_symbol_storage<EncoderType>::value,
+                      "Memory mapped file reader only works with encoders "
+                      "using const shallow storage");
+
+    public:
+
+        /// Pointer to the encoders
+        typedef typename EncoderType::pointer pointer;
+
+    public:
+
+        /// Construct a new memory mapped file reader
+        /// @param filename of the file to use
+        /// @param access the expected order in which the blocks are
+        ///        read
+        mmap_file_reader(const std::string &filename,
+                         mmap_access access = mmap_access::sequential)
+            : m_file(boost::make_shared<mapped_file>(filename, access))
+        { }
+
+        /// @return the size in bytes of the file
+        uint64_t size() const
+        {
+            return m_file->size();
+        }
+
+        /// Initializes the encoder with data from the file.
+        /// @param encoder to be initialized
+        /// @param offset in bytes into the file
+        /// @param size the number of bytes to use
+        void read(pointer &encoder, uint64_t offset, uint32_t size)
+        {
+            assert(encoder);
+            assert(offset < m_file->size());
+            assert(size > 0);
+
+            uint64_t remaining_bytes = m_file->size() - offset;
+            assert(size <= remaining_bytes);
+
+            m_file->will_need(offset, size);
+
+            sak::const_storage storage;
+            storage.m_data = m_file->data() + offset;
+            storage.m_size = size;
+
+            encoder->set_symbols(storage);
+
+            // We require that encoders includes the has_bytes_used
+            // layer to support partially filled encoders
+            encoder->set_bytes_used(size);
+        }
+
+    private:
+
+        /// The memory mapping of the file
+        boost::shared_ptr<mapped_file> m_file;
+
+    };
+
+    /// The memory mapped file reader only reads the shared mapping
+    template<class EncoderType>
+    struct has_concurrent_read<mmap_file_reader<EncoderType> >
+        : std::true_type
+    { };
+
+}
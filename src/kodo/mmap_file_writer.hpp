@@ -0,0 +1,176 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "streaming_copy.hpp"
+
+namespace kodo
+{
+
+    /// @brief Writable memory mapping of an entire file (POSIX).
+    ///
+    /// The file is created or truncated to its size, the mapping is
+    /// removed when the object is destroyed and the kernel writes the
+    /// pages back to the file.
+    class writable_mapped_file : boost::noncopyable
+    {
+    public:
+
+        /// Creates a file of a given size and maps it into memory
+        /// @param filename The file to write
+        /// @param size The size of the file in bytes
+        writable_mapped_file(const std::string &filename, uint64_t size)
+            : m_data(0),
+              m_size(size)
+        {
+            assert(size > 0);
+
+            int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+                            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+            assert(fd >= 0);
+
+            int result = ::ftruncate(fd, static_cast<off_t>(size));
+            assert(result == 0);
+            (void) result;
+
+            void *data = ::mmap(0, m_size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+            assert(data != MAP_FAILED);
+
+            // The mapping stays valid after the file is closed
+            ::close(fd);
+
+            m_data = static_cast<uint8_t*>(data);
+        }
+
+        /// Unmaps the file
+        ~writable_mapped_file()
+        {
+            ::munmap(m_data, m_size);
+        }
+
+        /// @return The mapped data
+        uint8_t* data() const
+        {
+            return m_data;
+        }
+
+        /// @return The size of the file in bytes
+        uint64_t size() const
+        {
+            return m_size;
+        }
+
+    private:
+
+        /// The mapped data
+        uint8_t *m_data;
+
+        /// The size of the mapping in bytes
+        uint64_t m_size;
+
+    };
+
+    /// @ingroup object_data_implementation
+    ///
+    /// @brief The memory mapped file writer copies the data of decoders
+    ///        into a writable mapping of a local file, with the interface
+    ///        of the file_writer.
+    ///
+    /// The file_writer hands the symbols to pwrite(), which copies them
+    /// in the kernel. This writer instead copies them into the page
+    /// cache itself, with streaming_copy(), so writing the decoded
+    /// blocks does not evict the working sets of the decoders still
+    /// decoding on the core. Copies of a writer share the mapping,
+    /// different decoders may be written concurrently.
+    template<class DecoderType>
+    class mmap_file_writer
+    {
+    public:
+
+        /// Pointer to the decoders
+        typedef typename DecoderType::pointer pointer;
+
+    public:
+
+        /// Construct a new memory mapped file writer
+        /// @param filename of the file to write, an existing file is
+        ///        truncated
+        /// @param size the size of the object in bytes
+        mmap_file_writer(const std::string &filename, uint64_t size)
+            : m_file(boost::make_shared<writable_mapped_file>(
+                         filename, size))
+        { }
+
+        /// @return the size in bytes of the file
+        uint64_t size() const
+        {
+            return m_file->size();
+        }
+
+        /// Writes the data of a complete decoder to the file.
+        /// @param decoder the decoder
+        /// @param offset in bytes into the file
+        /// @param size the number of bytes to write
+        void write(const pointer &decoder, uint64_t offset, uint32_t size)
+        {
+            assert(decoder);
+            assert(decoder->is_complete());
+            assert(offset < m_file->size());
+            assert(size > 0);
+            assert(size <= decoder->block_size());
+            assert(size <= m_file->size() - offset);
+
+            uint8_t *out = m_file->data() + offset;
+            uint32_t symbol_size = decoder->symbol_size();
+
+            // The current run of symbols which are adjacent in memory
+            const uint8_t *run = decoder->symbol(0);
+            uint32_t run_size = 0;
+
+            for(uint32_t i = 0; size > 0; ++i)
+            {
+                const uint8_t *symbol = decoder->symbol(i);
+                uint32_t symbol_bytes = std::min(size, symbol_size);
+
+                if(symbol != run + run_size)
+                {
+                    streaming_copy(out, run, run_size);
+
+                    out += run_size;
+                    run = symbol;
+                    run_size = 0;
+                }
+
+                run_size += symbol_bytes;
+                size -= symbol_bytes;
+            }
+
+            streaming_copy(out, run, run_size);
+        }
+
+    private:
+
+        /// The mapped file
+        boost::shared_ptr<writable_mapped_file> m_file;
+
+    };
+
+}
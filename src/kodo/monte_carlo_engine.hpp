@@ -0,0 +1,116 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include "block_executor.hpp"
+
+namespace kodo
+{
+
+    /// Derives the seed of one trial from the seed of a run, the seeds
+    /// of consecutive trials are scrambled with the splitmix64 finalizer
+    /// so their random streams are independent
+    /// @param seed The seed of the run
+    /// @param trial The index of the trial
+    /// @return The seed of the trial
+    inline uint32_t trial_seed(uint64_t seed, uint32_t trial)
+    {
+        uint64_t z = seed + (uint64_t(trial) + 1) * 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+
+        return static_cast<uint32_t>(z ^ (z >> 32));
+    }
+
+    /// @brief Runs independent Monte Carlo trials, e.g. the encoding and
+    ///        decoding of the decoding probability and overhead
+    ///        benchmarks, on the threads of a block_executor.
+    ///
+    /// The trials of a run are divided between a lane per thread. Each
+    /// lane makes its own trial function once per run, so the coders
+    /// and factories it builds are never shared between threads, and
+    /// then takes the next trial until all are done. Every trial gets
+    /// a random generator seeded from the seed of the run and the
+    /// index of the trial, so the results only depend on the seed and
+    /// not on the number of threads or the order the trials ran in.
+    ///
+    /// @tparam Result The default constructible result of a trial
+    template<class Result>
+    class monte_carlo_engine : boost::noncopyable
+    {
+    public:
+
+        /// The random generator of a trial
+        typedef boost::random::mt19937 generator_type;
+
+    public:
+
+        /// Starts the threads
+        /// @param threads The number of threads, zero means one per
+        ///        hardware thread
+        monte_carlo_engine(uint32_t threads = 0)
+            : m_executor(threads)
+        { }
+
+        /// @return The number of threads
+        uint32_t threads() const
+        {
+            return m_executor.threads();
+        }
+
+        /// Runs a number of trials and waits for them to complete
+        /// @param trials The number of trials
+        /// @param seed The seed of the run
+        /// @param make_trial Invoked once per lane, returns the function
+        ///        computing the result of a trial as
+        ///        Result trial(uint32_t index, generator_type& generator)
+        /// @return The results indexed by trial
+        template<class MakeTrial>
+        std::vector<Result> run(uint32_t trials, uint64_t seed,
+                                const MakeTrial &make_trial)
+        {
+            std::vector<Result> results(trials);
+
+            if(trials == 0)
+            {
+                return results;
+            }
+
+            uint32_t lanes = std::min(trials, threads());
+            std::atomic<uint32_t> next(0);
+
+            m_executor.run(lanes, [&](uint32_t)
+                {
+                    auto trial = make_trial();
+
+                    for(uint32_t i = next++; i < trials; i = next++)
+                    {
+                        generator_type generator(trial_seed(seed, i));
+                        results[i] = trial(i, generator);
+                    }
+                });
+
+            return results;
+        }
+
+    private:
+
+        /// The threads running the lanes
+        block_executor m_executor;
+
+    };
+
+}
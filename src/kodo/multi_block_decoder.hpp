@@ -0,0 +1,193 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @brief Decodes several blocks which are encoded with the same
+    ///        coding coefficients, performing the elimination once for
+    ///        all of them.
+    ///
+    /// This is the case for blocks of the same geometry encoded by the
+    /// seed codes, e.g. the seed_rlnc_encoder, where the seed of a
+    /// payload only depends on the number of symbols encoded. The
+    /// payloads with the same header of the B blocks are then combined
+    /// into one wide symbol, symbol i of block b being the bytes
+    /// [b * symbol_size, (b + 1) * symbol_size) of wide symbol i, and
+    /// decoded by a single decoder with a symbol size of B * symbol_size.
+    /// Every row operation of the elimination is thereby applied to the
+    /// data of all blocks in one pass.
+    ///
+    /// The blocks must have the same number of symbols and symbol size,
+    /// as produced by the stripe_partitioning_scheme, and the payloads
+    /// passed together must have identical headers.
+    template<class DecoderType>
+    class multi_block_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The factory building the decoder of the wide symbols
+        typedef typename DecoderType::factory factory_type;
+
+        /// Pointer to the decoder of the wide symbols
+        typedef typename DecoderType::pointer pointer_type;
+
+    public:
+
+        /// Constructor
+        /// @param blocks The number of blocks decoded together
+        /// @param symbols The number of symbols in a block
+        /// @param symbol_size The size of a symbol of a block in bytes
+        multi_block_decoder(uint32_t blocks, uint32_t symbols,
+                            uint32_t symbol_size)
+            : m_blocks(blocks),
+              m_symbol_size(symbol_size),
+              m_factory(symbols, symbol_size * blocks)
+        {
+            assert(m_blocks > 0);
+            assert(m_symbol_size > 0);
+
+            m_decoder = m_factory.build();
+            m_wide_symbol.resize(m_decoder->symbol_size());
+        }
+
+        /// Starts decoding a new set of blocks
+        void reset()
+        {
+            // The decoder is returned to the pool before building a
+            // new one so it is reused
+            m_decoder.reset();
+            m_decoder = m_factory.build();
+        }
+
+        /// @return The number of blocks decoded together
+        uint32_t blocks() const
+        {
+            return m_blocks;
+        }
+
+        /// @return The number of symbols in a block
+        uint32_t symbols() const
+        {
+            return m_decoder->symbols();
+        }
+
+        /// @return The size of a symbol of a block in bytes
+        uint32_t symbol_size() const
+        {
+            return m_symbol_size;
+        }
+
+        /// @return The size of the payload of a block in bytes
+        uint32_t payload_size() const
+        {
+            return m_symbol_size + m_decoder->header_size();
+        }
+
+        /// Decodes one payload of every block
+        /// @param payloads The payloads of the blocks, all with the same
+        ///        header
+        void decode(uint8_t **payloads)
+        {
+            assert(payloads != 0);
+
+            uint8_t *header = payloads[0] + m_symbol_size;
+
+            for(uint32_t i = 0; i < m_blocks; ++i)
+            {
+                assert(payloads[i] != 0);
+
+                // Did you pass payloads with different coefficients?
+                assert(std::equal(header, header + m_decoder->header_size(),
+                                  payloads[i] + m_symbol_size));
+
+                std::copy_n(payloads[i], m_symbol_size,
+                            &m_wide_symbol[i * m_symbol_size]);
+            }
+
+            m_decoder->decode(&m_wide_symbol[0], header);
+        }
+
+        /// @return True if all the blocks are decoded
+        bool is_complete() const
+        {
+            return m_decoder->is_complete();
+        }
+
+        /// @return The rank shared by all the blocks
+        uint32_t rank() const
+        {
+            return m_decoder->rank();
+        }
+
+        /// @param block The block
+        /// @param index The index of the symbol in the block
+        /// @return The symbol of a block
+        const uint8_t* symbol(uint32_t block, uint32_t index) const
+        {
+            assert(block < m_blocks);
+            return m_decoder->symbol(index) + block * m_symbol_size;
+        }
+
+        /// Copies the symbols of a block
+        /// @param block The block
+        /// @param dest The destination, at most the size of a block is
+        ///        copied
+        void copy_symbols(uint32_t block,
+                          const sak::mutable_storage &dest) const
+        {
+            assert(block < m_blocks);
+            assert(dest.m_data != 0);
+
+            uint8_t *data = dest.m_data;
+            uint32_t size = dest.m_size;
+
+            for(uint32_t i = 0; i < symbols() && size > 0; ++i)
+            {
+                uint32_t bytes = std::min(size, m_symbol_size);
+                std::copy_n(symbol(block, i), bytes, data);
+
+                data += bytes;
+                size -= bytes;
+            }
+        }
+
+        /// @return The decoder of the wide symbols
+        const pointer_type& decoder() const
+        {
+            return m_decoder;
+        }
+
+    private:
+
+        /// The number of blocks
+        uint32_t m_blocks;
+
+        /// The size of a symbol of a block
+        uint32_t m_symbol_size;
+
+        /// The factory of the decoder of the wide symbols
+        factory_type m_factory;
+
+        /// The decoder of the wide symbols
+        pointer_type m_decoder;
+
+        /// The symbols of one payload of every block
+        std::vector<uint8_t> m_wide_symbol;
+
+    };
+
+}
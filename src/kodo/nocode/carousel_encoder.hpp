@@ -6,6 +6,7 @@
 #pragma once
 
 #include <sak/convert_endian.hpp>
+#include <sak/storage.hpp>
 
 #include "carousel_common.hpp"
 
@@ -80,6 +81,56 @@ namespace kodo
             return sizeof(id_type);
         }
 
+        /// Encodes a symbol without copying it. The symbol view is set
+        /// to the current symbol in the storage of the encoder, which
+        /// e.g. allows a transport to send the symbol directly from the
+        /// storage. The view is valid until the data of the encoder is
+        /// changed.
+        /// @param symbol_header The buffer for the symbol header, must
+        ///        be at least layer::header_size() bytes
+        /// @param symbol_view Set to the layer::symbol_size() bytes of
+        ///        symbol data to send
+        /// @return The number of bytes used in the symbol header
+        uint32_t encode_view(uint8_t *symbol_header,
+                             sak::const_storage &symbol_view)
+        {
+            assert(symbol_header != 0);
+
+            // Write the symbol id in the header
+            sak::big_endian::put<id_type>(
+                m_current_symbol, symbol_header);
+
+            assert(m_current_symbol < SuperCoder::symbols());
+
+            symbol_view = sak::storage(
+                SuperCoder::encode_symbol_in_place(m_current_symbol),
+                SuperCoder::symbol_size());
+
+            m_current_symbol =
+                (m_current_symbol + 1) % SuperCoder::symbols();
+
+            return sizeof(id_type);
+        }
+
+        /// Encodes a symbol without copying it
+        /// @copydoc payload_encoder::encode_in_place(
+        ///     uint8_t*,uint8_t*,const uint8_t**)
+        uint32_t encode_in_place(uint8_t *symbol_data,
+                                 uint8_t *symbol_header,
+                                 const uint8_t **symbol_reference)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+            assert(symbol_reference != 0);
+
+            sak::const_storage symbol_view;
+            uint32_t header_bytes = encode_view(symbol_header, symbol_view);
+
+            *symbol_reference = symbol_view.m_data;
+
+            return header_bytes;
+        }
+
         /// @copydoc layer::header_size() const
         uint32_t header_size() const
         {
@@ -32,6 +32,21 @@ namespace kodo
             SuperCoder::copy_symbol(symbol_index, dest);
         }
 
+        /// Provides an uncoded symbol without copying it
+        /// @param symbol_index The index of the symbol
+        /// @return The symbol in the storage of the encoder
+        const uint8_t* encode_symbol_in_place(uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            const uint8_t *symbol = SuperCoder::symbol(symbol_index);
+
+            // Did you forget to set the data on the encoder?
+            assert(symbol != 0);
+
+            return symbol;
+        }
+
     };
 
 }
@@ -45,7 +45,7 @@ namespace kodo
         /// Constructs a new object decoder
         /// @param factory The decoder factory to use
         /// @param object_size The size in bytes of the object to be decoded
-        object_decoder(factory &decoder_factory, uint32_t object_size)
+        object_decoder(factory &decoder_factory, uint64_t object_size)
             : m_factory(decoder_factory),
               m_object_size(object_size)
         {
@@ -92,8 +92,26 @@ namespace kodo
             return decoder;
         }
 
+        /// @param decoder_id The decoder
+        /// @return The offset in bytes of the block of a decoder in the
+        ///         object
+        uint64_t byte_offset(uint32_t decoder_id) const
+        {
+            assert(decoder_id < m_partitioning.blocks());
+            return m_partitioning.byte_offset(decoder_id);
+        }
+
+        /// @param decoder_id The decoder
+        /// @return The number of bytes of the object in the block of a
+        ///         decoder
+        uint32_t bytes_used(uint32_t decoder_id) const
+        {
+            assert(decoder_id < m_partitioning.blocks());
+            return m_partitioning.bytes_used(decoder_id);
+        }
+
         /// @return The total size of the object to decode in bytes
-        uint32_t object_size() const
+        uint64_t object_size() const
         {
             return m_object_size;
         }
@@ -107,7 +125,7 @@ namespace kodo
         block_partitioning m_partitioning;
 
         /// Store the total object size in bytes
-        uint32_t m_object_size;
+        uint64_t m_object_size;
     };
 
 }
@@ -117,8 +117,9 @@ namespace kodo
 
             pointer_type encoder = m_factory.build();
 
-            // Initialize encoder with data
-            uint32_t offset =
+            // Initialize encoder with data, the offset in the object
+            // may exceed 32 bit while the block does not
+            uint64_t offset =
                 m_partitioning.byte_offset(encoder_id);
 
             uint32_t bytes_used =
@@ -130,7 +131,7 @@ namespace kodo
         }
 
         /// @return The total size of the object to encode in bytes
-        uint32_t object_size() const
+        uint64_t object_size() const
         {
             return m_data.size();
         }
@@ -0,0 +1,524 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+#include "event_loop.hpp"
+#include "udp_transport.hpp"
+
+namespace kodo
+{
+
+    /// Sets a socket to non-blocking mode, as required by the object
+    /// transfers
+    /// @param socket The socket
+    /// @return True on success
+    inline bool set_nonblocking(int socket)
+    {
+        int flags = ::fcntl(socket, F_GETFL, 0);
+
+        if(flags < 0)
+        {
+            return false;
+        }
+
+        return ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    /// @brief Sends an object over a UDP socket as a job of an
+    ///        event_loop, without a thread of its own.
+    ///
+    /// The transfer is a state machine going through two steps for
+    /// every block of the object encoder: read_block() builds the
+    /// encoder of the block, which reads its data, and encode_burst()
+    /// sends a burst of payloads with the udp_sender. After each step
+    /// the transfer posts the next one to the loop, so the transfers of
+    /// a loop take turns. When the socket buffer is full the transfer
+    /// waits for the socket to be writable, the payloads of the batch
+    /// which were encoded but not sent are skipped, as if lost.
+    ///
+    /// The socket is owned by the caller, it must be connected and is
+    /// set to non-blocking mode by start(). The object encoder and the
+    /// transfer must exist until the completion handler is invoked or
+    /// cancel() is called.
+    template<class ObjectEncoder>
+    class object_send_transfer : boost::noncopyable
+    {
+    public:
+
+        /// The completion handler, called with true if all payloads
+        /// were sent and false on a socket error
+        typedef std::function<void (bool)> completion;
+
+    public:
+
+        /// Constructs a new transfer
+        /// @param loop The event loop running the transfer
+        /// @param socket A connected UDP socket
+        /// @param object_encoder The object encoder
+        /// @param max_payload_size The maximum payload size of the
+        ///        encoders
+        /// @param payloads The number of payloads sent per block
+        /// @param burst The number of payloads sent per step
+        object_send_transfer(event_loop &loop, int socket,
+                             ObjectEncoder &object_encoder,
+                             uint32_t max_payload_size,
+                             uint32_t payloads, uint32_t burst = 16)
+            : m_loop(loop),
+              m_socket(socket),
+              m_object_encoder(object_encoder),
+              m_sender(socket, max_payload_size, burst),
+              m_payloads(payloads),
+              m_burst(burst),
+              m_block(0),
+              m_remaining(0),
+              m_complete(false)
+        {
+            assert(m_socket >= 0);
+            assert(m_payloads > 0);
+            assert(m_burst > 0);
+        }
+
+        /// Starts the transfer
+        /// @param handler Invoked on the loop thread when the transfer
+        ///        completes, may destroy the transfer
+        void start(const completion &handler)
+        {
+            assert(handler);
+
+            m_handler = handler;
+            m_block = 0;
+            m_complete = false;
+
+            bool nonblocking = set_nonblocking(m_socket);
+            assert(nonblocking);
+            (void) nonblocking;
+
+            m_loop.post(std::bind(&object_send_transfer::read_block, this));
+        }
+
+        /// Stops the transfer without invoking the completion handler.
+        /// A step already posted still runs, so the transfer must exist
+        /// until the next iteration of the loop.
+        void cancel()
+        {
+            if(m_loop.contains(m_socket))
+            {
+                m_loop.remove(m_socket);
+            }
+
+            m_complete = true;
+        }
+
+        /// @return True if the transfer is complete or cancelled
+        bool is_complete() const
+        {
+            return m_complete;
+        }
+
+        /// @return The block being sent
+        uint32_t block() const
+        {
+            return m_block;
+        }
+
+    private:
+
+        /// Builds the encoder of the current block
+        void read_block()
+        {
+            if(m_complete)
+            {
+                return;
+            }
+
+            m_encoder = m_object_encoder.build(m_block);
+            m_remaining = m_payloads;
+
+            encode_burst();
+        }
+
+        /// Sends a burst of payloads of the current block
+        void encode_burst()
+        {
+            if(m_complete)
+            {
+                return;
+            }
+
+            uint32_t burst = std::min(m_burst, m_remaining);
+            uint32_t sent = m_sender.send(m_encoder, m_block, burst);
+
+            m_remaining -= sent;
+
+            if(sent < burst)
+            {
+                if(errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    finish(false);
+                    return;
+                }
+
+                // The skipped payloads count as sent, a rateless code
+                // replaces them with the following payloads
+                m_remaining -= std::min(m_remaining, burst - sent);
+
+                m_loop.add(m_socket, EPOLLOUT,
+                           std::bind(&object_send_transfer::writable,
+                                     this, std::placeholders::_1));
+                return;
+            }
+
+            next_step();
+        }
+
+        /// Resumes the sending when the socket is writable
+        void writable(uint32_t events)
+        {
+            m_loop.remove(m_socket);
+
+            if(events & EPOLLERR)
+            {
+                finish(false);
+                return;
+            }
+
+            next_step();
+        }
+
+        /// Posts the next step of the transfer
+        void next_step()
+        {
+            if(m_remaining > 0)
+            {
+                m_loop.post(
+                    std::bind(&object_send_transfer::encode_burst, this));
+                return;
+            }
+
+            m_encoder.reset();
+            ++m_block;
+
+            if(m_block == m_object_encoder.encoders())
+            {
+                finish(true);
+                return;
+            }
+
+            m_loop.post(std::bind(&object_send_transfer::read_block, this));
+        }
+
+        /// Completes the transfer
+        /// @param success True if all payloads were sent
+        void finish(bool success)
+        {
+            m_complete = true;
+            m_encoder.reset();
+
+            // The handler may destroy the transfer
+            completion handler;
+            handler.swap(m_handler);
+            handler(success);
+        }
+
+    private:
+
+        /// The event loop
+        event_loop &m_loop;
+
+        /// The socket
+        int m_socket;
+
+        /// The object encoder
+        ObjectEncoder &m_object_encoder;
+
+        /// The sender of the payloads
+        udp_sender m_sender;
+
+        /// The number of payloads per block
+        uint32_t m_payloads;
+
+        /// The number of payloads per step
+        uint32_t m_burst;
+
+        /// The current block
+        uint32_t m_block;
+
+        /// The payloads left of the current block
+        uint32_t m_remaining;
+
+        /// True if the transfer is complete
+        bool m_complete;
+
+        /// The encoder of the current block
+        typename ObjectEncoder::pointer_type m_encoder;
+
+        /// The completion handler
+        completion m_handler;
+
+    };
+
+    /// @brief Receives an object over a UDP socket as a job of an
+    ///        event_loop, without a thread of its own.
+    ///
+    /// When the socket is readable decode_until_complete() receives a
+    /// few batches of payloads with the udp_receiver and passes them to
+    /// the decoders of the blocks, which are built when the first
+    /// payload of a block arrives. As soon as a block is complete
+    /// write_block() copies it to the object buffer and releases the
+    /// decoder, the later payloads of the block are dropped. When all
+    /// blocks are written the completion handler is invoked.
+    ///
+    /// The socket is owned by the caller, it must be bound and is set
+    /// to non-blocking mode by start(). The object decoder and the
+    /// transfer must exist until the completion handler is invoked or
+    /// cancel() is called.
+    template<class ObjectDecoder>
+    class object_receive_transfer : boost::noncopyable
+    {
+    public:
+
+        /// The completion handler, called with true when the object is
+        /// decoded
+        typedef std::function<void (bool)> completion;
+
+        /// Pointer to a decoder
+        typedef typename ObjectDecoder::pointer pointer;
+
+    public:
+
+        /// Constructs a new transfer
+        /// @param loop The event loop running the transfer
+        /// @param socket A bound UDP socket
+        /// @param object_decoder The object decoder
+        /// @param max_payload_size The maximum payload size of the
+        ///        decoders
+        /// @param object The buffer of the decoded object, at least
+        ///        object_decoder.object_size() bytes
+        /// @param batch_size The number of payloads received per call
+        /// @param batches The number of receive calls per readiness of
+        ///        the socket before yielding to the other jobs
+        object_receive_transfer(event_loop &loop, int socket,
+                                ObjectDecoder &object_decoder,
+                                uint32_t max_payload_size,
+                                const sak::mutable_storage &object,
+                                uint32_t batch_size = 16,
+                                uint32_t batches = 4)
+            : m_loop(loop),
+              m_socket(socket),
+              m_object_decoder(object_decoder),
+              m_receiver(socket, max_payload_size, batch_size),
+              m_object(object),
+              m_batches(batches),
+              m_written(0),
+              m_complete(false)
+        {
+            assert(m_socket >= 0);
+            assert(m_batches > 0);
+            assert(m_object.m_size >= m_object_decoder.object_size());
+        }
+
+        /// Starts the transfer
+        /// @param handler Invoked on the loop thread when the transfer
+        ///        completes, may destroy the transfer
+        void start(const completion &handler)
+        {
+            assert(handler);
+
+            m_handler = handler;
+            m_complete = false;
+            m_written = 0;
+
+            m_decoders.assign(m_object_decoder.decoders(), pointer());
+            m_block_written.assign(m_object_decoder.decoders(), false);
+
+            bool nonblocking = set_nonblocking(m_socket);
+            assert(nonblocking);
+            (void) nonblocking;
+
+            m_loop.add(m_socket, EPOLLIN,
+                       std::bind(&object_receive_transfer::readable,
+                                 this, std::placeholders::_1));
+        }
+
+        /// Stops the transfer without invoking the completion handler
+        void cancel()
+        {
+            if(m_loop.contains(m_socket))
+            {
+                m_loop.remove(m_socket);
+            }
+
+            m_decoders.clear();
+            m_complete = true;
+        }
+
+        /// @return True if the transfer is complete or cancelled
+        bool is_complete() const
+        {
+            return m_complete;
+        }
+
+        /// @return The number of blocks decoded and written
+        uint32_t blocks_written() const
+        {
+            return m_written;
+        }
+
+    private:
+
+        /// Handles the readiness of the socket
+        void readable(uint32_t events)
+        {
+            if(events & EPOLLERR)
+            {
+                finish(false);
+                return;
+            }
+
+            decode_until_complete();
+        }
+
+        /// Receives and decodes a few batches of payloads, the loop
+        /// invokes the transfer again while the socket is readable
+        void decode_until_complete()
+        {
+            for(uint32_t i = 0; i < m_batches && !m_complete; ++i)
+            {
+                uint32_t received = m_receiver.receive(
+                    std::bind(&object_receive_transfer::decode, this,
+                              std::placeholders::_1,
+                              std::placeholders::_2,
+                              std::placeholders::_3));
+
+                if(received == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        /// Decodes a payload
+        /// @param block_id The block of the payload
+        /// @param payload The payload
+        /// @param size The size of the payload in bytes
+        void decode(uint32_t block_id, uint8_t *payload, uint32_t size)
+        {
+            if(m_complete || block_id >= m_decoders.size() ||
+               m_block_written[block_id])
+            {
+                return;
+            }
+
+            pointer &decoder = m_decoders[block_id];
+
+            if(!decoder)
+            {
+                decoder = m_object_decoder.build(block_id);
+            }
+
+            if(size < decoder->payload_size())
+            {
+                return;
+            }
+
+            decoder->decode(payload);
+
+            if(decoder->is_complete())
+            {
+                write_block(block_id);
+            }
+        }
+
+        /// Copies a decoded block to the object and releases its decoder
+        /// @param block_id The block
+        void write_block(uint32_t block_id)
+        {
+            pointer &decoder = m_decoders[block_id];
+            assert(decoder && decoder->is_complete());
+
+            uint64_t offset = m_object_decoder.byte_offset(block_id);
+
+            decoder->copy_symbols(
+                sak::storage(m_object.m_data + offset,
+                             m_object_decoder.bytes_used(block_id)));
+
+            decoder.reset();
+            m_block_written[block_id] = true;
+            ++m_written;
+
+            if(m_written == m_decoders.size())
+            {
+                finish(true);
+            }
+        }
+
+        /// Completes the transfer
+        /// @param success True if the object is decoded
+        void finish(bool success)
+        {
+            m_loop.remove(m_socket);
+
+            m_complete = true;
+            m_decoders.clear();
+
+            // The handler may destroy the transfer
+            completion handler;
+            handler.swap(m_handler);
+            handler(success);
+        }
+
+    private:
+
+        /// The event loop
+        event_loop &m_loop;
+
+        /// The socket
+        int m_socket;
+
+        /// The object decoder
+        ObjectDecoder &m_object_decoder;
+
+        /// The receiver of the payloads
+        udp_receiver m_receiver;
+
+        /// The buffer of the decoded object
+        sak::mutable_storage m_object;
+
+        /// The number of receive calls per readiness of the socket
+        uint32_t m_batches;
+
+        /// The number of blocks written
+        uint32_t m_written;
+
+        /// True if the transfer is complete
+        bool m_complete;
+
+        /// The decoders of the blocks being decoded
+        std::vector<pointer> m_decoders;
+
+        /// True for the blocks written to the object
+        std::vector<bool> m_block_written;
+
+        /// The completion handler
+        completion m_handler;
+
+    };
+
+}
@@ -0,0 +1,222 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// Observer with empty hooks for the observer_decoder. Observers
+    /// derive from it and hide the hooks they need, the remaining
+    /// hooks are inlined away by the compiler.
+    struct null_decoder_observer
+    {
+        /// Set to true in an observer using on_symbol_decoded(). The
+        /// decoded symbols are only tracked when it is set.
+        static const bool observes_symbols = false;
+
+        /// Invoked when the rank of the decoder increased
+        /// @param rank The new rank
+        void on_rank_changed(uint32_t rank)
+        {
+            (void) rank;
+        }
+
+        /// Invoked once for every symbol when it becomes decoded
+        /// @param index The index of the symbol
+        void on_symbol_decoded(uint32_t index)
+        {
+            (void) index;
+        }
+
+        /// Invoked when the decoder is complete
+        void on_complete()
+        { }
+    };
+
+    /// @ingroup codec_layers
+    /// @brief Invokes the hooks of a statically chosen observer when
+    ///        the decoding state changes.
+    ///
+    /// Unlike the rank_callback_decoder and the
+    /// symbol_decoded_callback_decoder, the observer is a template
+    /// argument, so the hooks are called directly and an observer with
+    /// empty hooks, e.g. the null_decoder_observer, costs nothing. This
+    /// allows instrumentation to stay in production stacks.
+    ///
+    /// The hooks are invoked after the state of the decoder is updated
+    /// in the order on_rank_changed(), on_symbol_decoded() and
+    /// on_complete(). Like in the symbol_decoded_callback_decoder a
+    /// symbol is decoded when the coefficient vector stored for its
+    /// pivot is the unit vector, which requires the layer to be placed
+    /// above the codec layer with the coefficient storage API when
+    /// Observer::observes_symbols is set.
+    ///
+    /// The observer is default constructed when the decoder is
+    /// initialized and may be accessed using observer().
+    template<class Observer, class SuperCoder>
+    class observer_decoder : public SuperCoder
+    {
+    public:
+
+        /// The type of the observer
+        typedef Observer observer_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            if(Observer::observes_symbols)
+            {
+                m_decoded.resize(the_factory.max_symbols(), false);
+            }
+        }
+
+        /// Resets the observer and the decoded symbols
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            if(Observer::observes_symbols)
+            {
+                std::fill(m_decoded.begin(), m_decoded.end(), false);
+            }
+
+            m_observer = Observer();
+        }
+
+        /// Invokes the hooks if the rank changed
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *coefficients)
+        {
+            uint32_t rank = SuperCoder::rank();
+
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+
+            if(rank < SuperCoder::rank())
+            {
+                notify_observer();
+            }
+        }
+
+        /// Invokes the hooks if the rank changed
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            uint32_t rank = SuperCoder::rank();
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(rank < SuperCoder::rank())
+            {
+                notify_observer();
+            }
+        }
+
+        /// @return The observer of the decoder
+        Observer& observer()
+        {
+            return m_observer;
+        }
+
+        /// @return The observer of the decoder
+        const Observer& observer() const
+        {
+            return m_observer;
+        }
+
+    private:
+
+        /// Invokes the hooks after the rank increased
+        void notify_observer()
+        {
+            m_observer.on_rank_changed(SuperCoder::rank());
+
+            notify_decoded(std::integral_constant<
+                bool, Observer::observes_symbols>());
+
+            if(SuperCoder::is_complete())
+            {
+                m_observer.on_complete();
+            }
+        }
+
+        /// Used when the observer does not observe the symbols, so the
+        /// stack does not need the coefficient storage API
+        void notify_decoded(std::false_type)
+        { }
+
+        /// Invokes on_symbol_decoded() for the symbols which became
+        /// decoded, in order of the symbol index
+        void notify_decoded(std::true_type)
+        {
+            typedef typename SuperCoder::field_type field_type;
+            typedef typename SuperCoder::value_type value_type;
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(m_decoded[i] || !SuperCoder::symbol_pivot(i))
+                {
+                    continue;
+                }
+
+                bool decoded = true;
+
+                if(SuperCoder::symbol_coded(i))
+                {
+                    // The elimination keeps the pivot columns of the
+                    // other rows zero, so only the non-pivot columns
+                    // needs to be checked
+                    const value_type *coefficients =
+                        SuperCoder::coefficients_value(i);
+
+                    for(uint32_t j = 0; j < symbols && decoded; ++j)
+                    {
+                        if(j != i && !SuperCoder::symbol_pivot(j) &&
+                           fifi::get_value<field_type>(coefficients, j))
+                        {
+                            decoded = false;
+                        }
+                    }
+                }
+
+                if(decoded)
+                {
+                    m_decoded[i] = true;
+                    m_observer.on_symbol_decoded(i);
+                }
+            }
+        }
+
+    private:
+
+        /// The observer
+        Observer m_observer;
+
+        /// Tracks which symbols are decoded, only used if the observer
+        /// observes the symbols
+        std::vector<bool> m_decoded;
+
+    };
+
+}
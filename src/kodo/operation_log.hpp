@@ -0,0 +1,242 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+#include <fifi/arithmetics.hpp>
+
+#include "matrix_operations.hpp"
+
+namespace kodo
+{
+
+    /// @brief The row operations of a decoding on the symbol data,
+    ///        recorded from the coefficients only, see
+    ///        linear_block_decoder_logged.
+    ///
+    /// The rows of the log are slots holding the innovative symbols in
+    /// the order they were received. An operation either subtracts a
+    /// multiple of one slot from another, row dest -= c * row src, or
+    /// scales a slot, row dest *= c. Replaying the operations in order
+    /// on the slots, in batches, on another thread or on the node
+    /// holding the data, leaves decoded symbol i in slot pivot_slot(i).
+    /// The received symbol stored in a slot is given by slot_source().
+    template<class Field>
+    class operation_log
+    {
+    public:
+
+        /// The finite field
+        typedef Field field_type;
+
+        /// The value type of the field
+        typedef typename field_type::value_type value_type;
+
+        /// Marks a pivot without a slot
+        static const uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+        /// A row operation
+        struct operation
+        {
+            /// The slot changed
+            uint32_t m_dest;
+
+            /// The slot subtracted, equal to m_dest for a scaling
+            uint32_t m_src;
+
+            /// The coefficient, non-zero
+            value_type m_coefficient;
+
+            /// @return True if the operation scales its slot
+            bool is_scale() const
+            {
+                return m_src == m_dest;
+            }
+        };
+
+    public:
+
+        /// Constructor
+        operation_log()
+            : m_slots(0)
+        { }
+
+        /// Clears the log
+        /// @param symbols The number of symbols of the block
+        void reset(uint32_t symbols)
+        {
+            m_operations.clear();
+            m_pivot_slots.assign(symbols, no_slot);
+            m_slot_sources.assign(symbols, no_slot);
+            m_slots = 0;
+        }
+
+        /// Adds a slot for an innovative symbol
+        /// @param source The index of the symbol among all received
+        ///        symbols
+        /// @return The slot
+        uint32_t add_slot(uint32_t source)
+        {
+            assert(m_slots < m_slot_sources.size());
+
+            m_slot_sources[m_slots] = source;
+            return m_slots++;
+        }
+
+        /// Records row dest -= coefficient * row src
+        /// @param dest The slot changed
+        /// @param src The slot subtracted
+        /// @param coefficient The coefficient, non-zero
+        void subtract(uint32_t dest, uint32_t src, value_type coefficient)
+        {
+            assert(dest != src);
+            assert(dest < m_slots && src < m_slots);
+            assert(coefficient != 0);
+
+            operation op = { dest, src, coefficient };
+            m_operations.push_back(op);
+        }
+
+        /// Records row dest *= coefficient
+        /// @param dest The slot changed
+        /// @param coefficient The coefficient, non-zero
+        void scale(uint32_t dest, value_type coefficient)
+        {
+            assert(dest < m_slots);
+            assert(coefficient != 0);
+
+            operation op = { dest, dest, coefficient };
+            m_operations.push_back(op);
+        }
+
+        /// Records the slot where a symbol is decoded
+        /// @param pivot The index of the symbol
+        /// @param slot The slot
+        void set_pivot(uint32_t pivot, uint32_t slot)
+        {
+            assert(pivot < m_pivot_slots.size());
+            assert(slot < m_slots);
+
+            m_pivot_slots[pivot] = slot;
+        }
+
+        /// @return The number of operations
+        uint32_t size() const
+        {
+            return static_cast<uint32_t>(m_operations.size());
+        }
+
+        /// @param index The index of an operation
+        /// @return The operation
+        const operation& at(uint32_t index) const
+        {
+            assert(index < m_operations.size());
+            return m_operations[index];
+        }
+
+        /// @return The number of slots
+        uint32_t slots() const
+        {
+            return m_slots;
+        }
+
+        /// @param pivot The index of a symbol
+        /// @return The slot where the symbol is decoded, no_slot if the
+        ///         symbol has no pivot yet
+        uint32_t pivot_slot(uint32_t pivot) const
+        {
+            assert(pivot < m_pivot_slots.size());
+            return m_pivot_slots[pivot];
+        }
+
+        /// @param slot A slot
+        /// @return The index among all received symbols of the symbol
+        ///         stored in the slot
+        uint32_t slot_source(uint32_t slot) const
+        {
+            assert(slot < m_slots);
+            return m_slot_sources[slot];
+        }
+
+        /// Replays operations on the symbol data
+        /// @param field The finite field implementation
+        /// @param slots The symbol data of the slots
+        /// @param symbol_size The size of a symbol in bytes
+        /// @param first The first operation to replay
+        /// @param last The operation following the last one to replay
+        template<class FieldImpl>
+        void replay(FieldImpl &field, uint8_t **slots, uint32_t symbol_size,
+                    uint32_t first, uint32_t last) const
+        {
+            assert(first <= last);
+            assert(last <= size());
+
+            uint32_t length =
+                fifi::size_to_length<field_type>(symbol_size);
+
+            // A local buffer, so several threads may replay the log
+            std::vector<value_type> temp(length);
+
+            for(uint32_t i = first; i < last; ++i)
+            {
+                const operation &op = m_operations[i];
+
+                value_type *dest =
+                    reinterpret_cast<value_type*>(slots[op.m_dest]);
+
+                if(op.is_scale())
+                {
+                    fifi::multiply_constant(
+                        field, op.m_coefficient, dest, length);
+                }
+                else
+                {
+                    const value_type *src =
+                        reinterpret_cast<const value_type*>(
+                            slots[op.m_src]);
+
+                    matrix_multiply_subtract(
+                        field, op.m_coefficient, dest, src, &temp[0],
+                        length);
+                }
+            }
+        }
+
+        /// Replays all operations on the symbol data
+        /// @copydetails replay(FieldImpl&, uint8_t**, uint32_t, uint32_t,
+        ///              uint32_t) const
+        template<class FieldImpl>
+        void replay(FieldImpl &field, uint8_t **slots,
+                    uint32_t symbol_size) const
+        {
+            replay(field, slots, symbol_size, 0, size());
+        }
+
+    private:
+
+        /// The operations
+        std::vector<operation> m_operations;
+
+        /// The slot of every pivot
+        std::vector<uint32_t> m_pivot_slots;
+
+        /// The received symbol of every slot
+        std::vector<uint32_t> m_slot_sources;
+
+        /// The number of slots
+        uint32_t m_slots;
+
+    };
+
+    template<class Field>
+    const uint32_t operation_log<Field>::no_slot;
+
+}
@@ -0,0 +1,216 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+namespace kodo
+{
+
+    /// Helper class used by the finite_field_counter layer to record
+    /// the cost of one type of operation on one type of buffer: the
+    /// number of calls, the bytes processed and the cycle counter ticks
+    /// of the calls which were timed.
+    struct operation_cost
+    {
+
+        /// Constructs a new cost and zero initializes the counters
+        operation_cost()
+            : m_calls(0),
+              m_bytes(0),
+              m_samples(0),
+              m_sampled_ticks(0)
+            { }
+
+        /// @return The estimated ticks of all the calls, extrapolated
+        ///         from the timed calls, or zero if no call was timed
+        double estimated_ticks() const
+        {
+            if(m_samples == 0)
+                return 0.0;
+
+            return static_cast<double>(m_sampled_ticks) *
+                static_cast<double>(m_calls) / m_samples;
+        }
+
+        /// The number of calls
+        uint64_t m_calls;
+
+        /// The bytes of the destination buffers processed, a fused
+        /// operation on several sources counts the destination once per
+        /// source
+        uint64_t m_bytes;
+
+        /// The number of calls which were timed
+        uint64_t m_samples;
+
+        /// The cycle counter ticks of the timed calls
+        uint64_t m_sampled_ticks;
+
+    };
+
+    /// Helper class used by the finite_field_counter layer to split the
+    /// cost of an operation on the symbol data from the cost on the
+    /// coefficient vectors.
+    struct operation_profile
+    {
+
+        /// @return The bytes processed on all buffers
+        uint64_t bytes() const
+        {
+            return m_symbol.m_bytes + m_coefficient.m_bytes;
+        }
+
+        /// The cost of the operations on buffers of the symbol length
+        operation_cost m_symbol;
+
+        /// The cost of the operations on all other buffers, i.e. the
+        /// coefficient vectors
+        operation_cost m_coefficient;
+
+    };
+
+    /// Helper class used by the finite_field_counter layer to record
+    /// the cost profile of the operations performed. Contrary to the
+    /// operations_counter the profile counts the bytes processed, which
+    /// makes the cost of coders with different symbol sizes and
+    /// coefficient vector lengths comparable.
+    struct operations_profile
+    {
+
+        /// @return The bytes processed by all operations
+        uint64_t bytes() const
+        {
+            return m_multiply.bytes() + m_multiply_add.bytes() +
+                m_add.bytes() + m_multiply_subtract.bytes() +
+                m_subtract.bytes();
+        }
+
+        /// Profile of dest[i] = dest[i] * constant
+        operation_profile m_multiply;
+
+        /// Profile of dest[i] = dest[i] + (constant * src[i])
+        operation_profile m_multiply_add;
+
+        /// Profile of dest[i] = dest[i] + src[i]
+        operation_profile m_add;
+
+        /// Profile of dest[i] = dest[i] - (constant * src[i])
+        operation_profile m_multiply_subtract;
+
+        /// Profile of dest[i] = dest[i] - src[i]
+        operation_profile m_subtract;
+
+    };
+
+    /// Subtract two operation costs ala. a - b
+    /// @param a The operation cost to be reduced
+    /// @param b The operation cost subtracted from a
+    inline operation_cost operator-(const operation_cost &a,
+                                    const operation_cost &b)
+    {
+        operation_cost res;
+
+        // Added asserts to detect underflow
+
+        assert(a.m_calls >= b.m_calls);
+        res.m_calls = a.m_calls - b.m_calls;
+
+        assert(a.m_bytes >= b.m_bytes);
+        res.m_bytes = a.m_bytes - b.m_bytes;
+
+        assert(a.m_samples >= b.m_samples);
+        res.m_samples = a.m_samples - b.m_samples;
+
+        assert(a.m_sampled_ticks >= b.m_sampled_ticks);
+        res.m_sampled_ticks = a.m_sampled_ticks - b.m_sampled_ticks;
+
+        return res;
+    }
+
+    /// Add two operation costs ala. a + b
+    /// @param a The first operation cost
+    /// @param b The operation cost added to a
+    inline operation_cost operator+(const operation_cost &a,
+                                    const operation_cost &b)
+    {
+        operation_cost res;
+
+        // Added asserts to detect overflow
+
+        res.m_calls = a.m_calls + b.m_calls;
+        assert(res.m_calls >= a.m_calls);
+
+        res.m_bytes = a.m_bytes + b.m_bytes;
+        assert(res.m_bytes >= a.m_bytes);
+
+        res.m_samples = a.m_samples + b.m_samples;
+        assert(res.m_samples >= a.m_samples);
+
+        res.m_sampled_ticks = a.m_sampled_ticks + b.m_sampled_ticks;
+        assert(res.m_sampled_ticks >= a.m_sampled_ticks);
+
+        return res;
+    }
+
+    /// Subtract two operation profiles ala. a - b
+    /// @param a The operation profile to be reduced
+    /// @param b The operation profile subtracted from a
+    inline operation_profile operator-(const operation_profile &a,
+                                       const operation_profile &b)
+    {
+        operation_profile res;
+        res.m_symbol = a.m_symbol - b.m_symbol;
+        res.m_coefficient = a.m_coefficient - b.m_coefficient;
+        return res;
+    }
+
+    /// Add two operation profiles ala. a + b
+    /// @param a The first operation profile
+    /// @param b The operation profile added to a
+    inline operation_profile operator+(const operation_profile &a,
+                                       const operation_profile &b)
+    {
+        operation_profile res;
+        res.m_symbol = a.m_symbol + b.m_symbol;
+        res.m_coefficient = a.m_coefficient + b.m_coefficient;
+        return res;
+    }
+
+    /// Subtract two operations profiles ala. a - b
+    /// @param a The operations profile to be reduced
+    /// @param b The operations profile subtracted from a
+    inline operations_profile operator-(const operations_profile &a,
+                                        const operations_profile &b)
+    {
+        operations_profile res;
+        res.m_multiply = a.m_multiply - b.m_multiply;
+        res.m_multiply_add = a.m_multiply_add - b.m_multiply_add;
+        res.m_add = a.m_add - b.m_add;
+        res.m_multiply_subtract =
+            a.m_multiply_subtract - b.m_multiply_subtract;
+        res.m_subtract = a.m_subtract - b.m_subtract;
+        return res;
+    }
+
+    /// Add two operations profiles ala. a + b
+    /// @param a The first operations profile
+    /// @param b The operations profile added to a
+    inline operations_profile operator+(const operations_profile &a,
+                                        const operations_profile &b)
+    {
+        operations_profile res;
+        res.m_multiply = a.m_multiply + b.m_multiply;
+        res.m_multiply_add = a.m_multiply_add + b.m_multiply_add;
+        res.m_add = a.m_add + b.m_add;
+        res.m_multiply_subtract =
+            a.m_multiply_subtract + b.m_multiply_subtract;
+        res.m_subtract = a.m_subtract + b.m_subtract;
+        return res;
+    }
+
+}
@@ -0,0 +1,317 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+#include "overlapping_generation_scheme.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Decodes an object encoded by the
+    ///        overlapping_generation_encoder, passing the decoded shared
+    ///        symbols between adjacent generations.
+    ///
+    /// The random_annex_decoder only passes the annex of a block to
+    /// the other blocks once the block is complete. Here a shared
+    /// symbol is passed to the neighbouring generation as soon as it
+    /// is decoded, e.g. when it is received uncoded or when the coded
+    /// symbols stop depending on the missing symbols, and the
+    /// neighbour receives it as an uncoded symbol. This may decode
+    /// further shared symbols in the neighbour, which are passed on in
+    /// turn, so a generation which is a few payloads short is completed
+    /// by the spare rank of the generations around it.
+    ///
+    /// The decoders of all generations are built when the object
+    /// decoder is constructed. They must include the
+    /// symbol_decoded_callback_decoder layer, e.g. the
+    /// overlapping_full_rlnc_decoder. The decoded symbols are queued
+    /// by the callbacks and passed on after the payload is decoded,
+    /// so a decoder is never entered from within one of its own
+    /// callbacks.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class overlapping_generation_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// The scheme of the generations
+        typedef overlapping_generation_scheme<BlockPartitioning>
+            generation_scheme;
+
+    public:
+
+        /// Constructs a new overlapping generation decoder and builds
+        /// the decoders of all generations
+        /// @param overlap The number of symbols a generation shares with
+        ///        the next generation
+        /// @param decoder_factory The decoder factory to use
+        /// @param object_size The size in bytes of the object to be
+        ///        decoded
+        overlapping_generation_decoder(uint32_t overlap,
+                                       factory &decoder_factory,
+                                       uint64_t object_size)
+            : m_completed(0),
+              m_symbols_forwarded(0)
+        {
+            assert(object_size > 0);
+
+            m_scheme = generation_scheme(
+                overlap, decoder_factory.max_symbols(),
+                decoder_factory.max_symbol_size(), object_size);
+
+            build_decoders(decoder_factory);
+        }
+
+        /// @return The number of decoders for this object
+        uint32_t decoders() const
+        {
+            return m_scheme.generations();
+        }
+
+        /// @param decoder_id Specifies the decoder
+        /// @return The decoder of a specific generation, payloads must
+        ///         be passed to decode() so the shared symbols are
+        ///         propagated
+        pointer& decoder(uint32_t decoder_id)
+        {
+            assert(decoder_id < m_decoders.size());
+            return m_decoders[decoder_id];
+        }
+
+        /// Decodes a payload of a generation and passes the shared
+        /// symbols it decoded to the adjacent generations, payloads for
+        /// a complete generation are ignored
+        /// @param decoder_id The generation of the payload
+        /// @param payload The payload
+        void decode(uint32_t decoder_id, uint8_t *payload)
+        {
+            assert(decoder_id < m_decoders.size());
+            assert(payload != 0);
+
+            pointer &decoder = m_decoders[decoder_id];
+
+            if(decoder->is_complete())
+            {
+                return;
+            }
+
+            decoder->decode(payload);
+
+            if(decoder->is_complete())
+            {
+                ++m_completed;
+            }
+
+            propagate();
+        }
+
+        /// @return true if all decoders are complete
+        bool is_complete() const
+        {
+            return m_completed == m_decoders.size();
+        }
+
+        /// @param decoder_id Specifies the decoder
+        /// @return true if the decoder is complete
+        bool is_complete(uint32_t decoder_id) const
+        {
+            assert(decoder_id < m_decoders.size());
+            return m_decoders[decoder_id]->is_complete();
+        }
+
+        /// Copies the decoded object to the destination buffer, the
+        /// shared symbols are copied from the generation they belong to
+        /// @param dest_storage The destination buffer, must be at least
+        ///        object_size() bytes
+        void copy_symbols(const sak::mutable_storage &dest_storage)
+        {
+            assert(dest_storage.m_data != 0);
+            assert(dest_storage.m_size >= object_size());
+
+            for(uint32_t i = 0; i < m_decoders.size(); ++i)
+            {
+                sak::mutable_storage storage;
+                storage.m_data = dest_storage.m_data +
+                    m_scheme.byte_offset(i);
+                storage.m_size = m_scheme.base_bytes_used(i);
+
+                m_decoders[i]->copy_symbols(storage);
+            }
+        }
+
+        /// @return The number of symbols passed between the generations
+        uint32_t symbols_forwarded() const
+        {
+            return m_symbols_forwarded;
+        }
+
+        /// @return The scheme of the generations
+        const generation_scheme& scheme() const
+        {
+            return m_scheme;
+        }
+
+        /// @return The total size of the object to decode in bytes
+        uint64_t object_size() const
+        {
+            return m_scheme.object_size();
+        }
+
+    private:
+
+        /// A decoded symbol not yet passed to the adjacent generations
+        struct decoded_symbol
+        {
+            /// The generation which decoded the symbol
+            uint32_t m_decoder_id;
+
+            /// The index of the symbol in the generation
+            uint32_t m_symbol;
+        };
+
+    private:
+
+        /// Builds the decoders of all the generations
+        /// @param decoder_factory The decoder factory to use
+        void build_decoders(factory &decoder_factory)
+        {
+            uint32_t generations = m_scheme.generations();
+
+            m_decoders.resize(generations);
+
+            for(uint32_t i = 0; i < generations; ++i)
+            {
+                decoder_factory.set_symbols(m_scheme.symbols(i));
+                decoder_factory.set_symbol_size(m_scheme.symbol_size(i));
+
+                pointer decoder = decoder_factory.build();
+                decoder->set_bytes_used(m_scheme.bytes_used(i));
+
+                decoder->set_symbol_decoded_callback(
+                    [this, i](uint32_t index)
+                    {
+                        symbol_decoded(i, index);
+                    });
+
+                m_decoders[i] = decoder;
+            }
+        }
+
+        /// Invoked by the decoders when a symbol is decoded, queues the
+        /// shared symbols
+        /// @param decoder_id The generation
+        /// @param index The index of the decoded symbol
+        void symbol_decoded(uint32_t decoder_id, uint32_t index)
+        {
+            bool shared_previous = decoder_id > 0 &&
+                index < m_scheme.shared_symbols(decoder_id - 1);
+
+            bool shared_next = index >= m_scheme.base_symbols(decoder_id);
+
+            if(shared_previous || shared_next)
+            {
+                m_pending.push_back(decoded_symbol{decoder_id, index});
+            }
+        }
+
+        /// Passes the queued symbols to the adjacent generations until
+        /// no more shared symbols are decoded
+        void propagate()
+        {
+            while(!m_pending.empty())
+            {
+                decoded_symbol decoded = m_pending.back();
+                m_pending.pop_back();
+
+                uint32_t from = decoded.m_decoder_id;
+                uint32_t index = decoded.m_symbol;
+
+                if(from > 0 && index < m_scheme.shared_symbols(from - 1))
+                {
+                    forward_symbol(from, index, from - 1,
+                                   m_scheme.base_symbols(from - 1) + index);
+                }
+
+                uint32_t base_symbols = m_scheme.base_symbols(from);
+
+                if(index >= base_symbols)
+                {
+                    forward_symbol(from, index, from + 1,
+                                   index - base_symbols);
+                }
+            }
+        }
+
+        /// Passes a decoded symbol to another decoder as an uncoded
+        /// symbol, unless it is already decoded there
+        /// @param from_decoder The decoder holding the symbol
+        /// @param from_symbol The index of the symbol in that decoder
+        /// @param to_decoder The receiving decoder
+        /// @param to_symbol The index of the symbol in the receiving
+        ///        decoder
+        void forward_symbol(uint32_t from_decoder, uint32_t from_symbol,
+                            uint32_t to_decoder, uint32_t to_symbol)
+        {
+            assert(from_decoder < m_decoders.size());
+            assert(to_decoder < m_decoders.size());
+
+            pointer &to = m_decoders[to_decoder];
+            assert(to_symbol < to->symbols());
+
+            if(to->is_complete() || to->is_symbol_decoded(to_symbol))
+            {
+                return;
+            }
+
+            uint8_t *symbol_data =
+                m_decoders[from_decoder]->symbol(from_symbol);
+
+            to->decode_symbol(symbol_data, to_symbol);
+            ++m_symbols_forwarded;
+
+            if(to->is_complete())
+            {
+                ++m_completed;
+            }
+        }
+
+    private:
+
+        /// The scheme of the generations
+        generation_scheme m_scheme;
+
+        /// The decoders of the generations
+        std::vector<pointer> m_decoders;
+
+        /// The decoded shared symbols not yet passed on
+        std::vector<decoded_symbol> m_pending;
+
+        /// The number of complete decoders
+        uint32_t m_completed;
+
+        /// The number of symbols passed between the generations
+        uint32_t m_symbols_forwarded;
+    };
+
+}
@@ -0,0 +1,130 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+#include "overlapping_generation_scheme.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Encodes an object as generations where adjacent
+    ///        generations share symbols.
+    ///
+    /// Unlike the object_encoder, where every block is decoded in
+    /// isolation, generation g also encodes the first symbols of
+    /// generation g + 1, see the overlapping_generation_scheme. The
+    /// overlapping_generation_decoder passes the shared symbols decoded
+    /// in one generation to its neighbours, so a generation which is
+    /// a few payloads short is completed by the spare rank of the
+    /// adjacent generations.
+    ///
+    /// A generation is a contiguous range of the object, so the
+    /// encoders are set up without copying the shared symbols between
+    /// them. The encoders must include the has_bytes_used layer to
+    /// support partially filled generations.
+    template
+    <
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class overlapping_generation_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build encoders
+        typedef typename EncoderType::factory factory_type;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer_type;
+
+        /// The scheme of the generations
+        typedef overlapping_generation_scheme<BlockPartitioning>
+            generation_scheme;
+
+    public:
+
+        /// Constructs a new overlapping generation encoder
+        /// @param overlap The number of symbols a generation shares with
+        ///        the next generation
+        /// @param factory The encoder factory to use
+        /// @param object The object to encode
+        overlapping_generation_encoder(uint32_t overlap,
+                                       factory_type &factory,
+                                       const sak::const_storage &object)
+            : m_factory(factory),
+              m_object(object)
+        {
+            assert(m_object.m_size > 0);
+            assert(m_object.m_data != 0);
+
+            m_scheme = generation_scheme(
+                overlap, m_factory.max_symbols(),
+                m_factory.max_symbol_size(), m_object.m_size);
+        }
+
+        /// @return The number of encoders which may be created for
+        ///         this object
+        uint32_t encoders() const
+        {
+            return m_scheme.generations();
+        }
+
+        /// Builds the encoder of a specific generation
+        /// @param encoder_id Specifies the encoder to build
+        /// @return The initialized encoder
+        pointer_type build(uint32_t encoder_id)
+        {
+            assert(encoder_id < m_scheme.generations());
+
+            m_factory.set_symbols(m_scheme.symbols(encoder_id));
+            m_factory.set_symbol_size(m_scheme.symbol_size(encoder_id));
+
+            pointer_type encoder = m_factory.build();
+
+            sak::const_storage storage;
+            storage.m_data = m_object.m_data +
+                m_scheme.byte_offset(encoder_id);
+            storage.m_size = m_scheme.bytes_used(encoder_id);
+
+            encoder->set_symbols(storage);
+            encoder->set_bytes_used(storage.m_size);
+
+            return encoder;
+        }
+
+        /// @return The scheme of the generations
+        const generation_scheme& scheme() const
+        {
+            return m_scheme;
+        }
+
+        /// @return The total size of the object to encode in bytes
+        uint32_t object_size() const
+        {
+            return m_object.m_size;
+        }
+
+    private:
+
+        /// The encoder factory
+        factory_type &m_factory;
+
+        /// The object to encode
+        sak::const_storage m_object;
+
+        /// The scheme of the generations
+        generation_scheme m_scheme;
+    };
+
+}
@@ -0,0 +1,165 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Splits an object into generations where adjacent
+    ///        generations share symbols.
+    ///
+    /// The object is partitioned into base blocks of at most
+    /// max_symbols - overlap symbols by the block partitioning scheme.
+    /// Generation g consists of base block g followed by the first
+    /// overlap symbols of base block g + 1, the last generation is just
+    /// its base block. Since the base blocks are consecutive in the
+    /// object, a generation covers a contiguous range of the object,
+    /// and symbol base_symbols(g) + i of generation g is symbol i of
+    /// generation g + 1 for i < shared_symbols(g).
+    ///
+    /// The scheme is used by the overlapping_generation_encoder and
+    /// the overlapping_generation_decoder, which must be constructed
+    /// with the same parameters.
+    template<class BlockPartitioning = rfc5052_partitioning_scheme>
+    class overlapping_generation_scheme
+    {
+    public:
+
+        /// The block partitioning scheme of the base blocks
+        typedef BlockPartitioning block_partitioning;
+
+    public:
+
+        /// Create an uninitialized scheme
+        overlapping_generation_scheme()
+            : m_overlap(0)
+        { }
+
+        /// Constructor
+        /// @param overlap The number of symbols a generation shares with
+        ///        the next generation, must be less than max_symbols
+        /// @param max_symbols The maximum number of symbols in a
+        ///        generation
+        /// @param max_symbol_size The size in bytes of a symbol
+        /// @param object_size The size in bytes of the whole object
+        overlapping_generation_scheme(uint32_t overlap,
+                                      uint32_t max_symbols,
+                                      uint32_t max_symbol_size,
+                                      uint64_t object_size)
+            : m_overlap(overlap)
+        {
+            assert(m_overlap < max_symbols);
+
+            m_partitioning = block_partitioning(
+                max_symbols - m_overlap, max_symbol_size, object_size);
+        }
+
+        /// @return The number of generations of the object
+        uint32_t generations() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// @param generation The index of a generation
+        /// @return The number of symbols in the generation
+        uint32_t symbols(uint32_t generation) const
+        {
+            return base_symbols(generation) + shared_symbols(generation);
+        }
+
+        /// @param generation The index of a generation
+        /// @return The number of symbols of the base block of the
+        ///         generation, the symbols not shared with the next
+        ///         generation
+        uint32_t base_symbols(uint32_t generation) const
+        {
+            return m_partitioning.symbols(generation);
+        }
+
+        /// @param generation The index of a generation
+        /// @return The number of symbols at the end of the generation
+        ///         which are the first symbols of the next generation
+        uint32_t shared_symbols(uint32_t generation) const
+        {
+            assert(generation < generations());
+
+            if(generation + 1 == generations())
+            {
+                return 0;
+            }
+
+            return std::min(m_overlap, m_partitioning.symbols(generation + 1));
+        }
+
+        /// @param generation The index of a generation
+        /// @return The size in bytes of a symbol of the generation
+        uint32_t symbol_size(uint32_t generation) const
+        {
+            // Shared symbols must have the same size in both generations
+            assert(generation + 1 == generations() ||
+                   m_partitioning.symbol_size(generation) ==
+                   m_partitioning.symbol_size(generation + 1));
+
+            return m_partitioning.symbol_size(generation);
+        }
+
+        /// @param generation The index of a generation
+        /// @return The offset in bytes of the generation in the object
+        uint64_t byte_offset(uint32_t generation) const
+        {
+            return m_partitioning.byte_offset(generation);
+        }
+
+        /// @param generation The index of a generation
+        /// @return The number of bytes of the object in the generation,
+        ///         including the shared symbols
+        uint32_t bytes_used(uint32_t generation) const
+        {
+            uint64_t offset = byte_offset(generation);
+            uint64_t remaining = m_partitioning.object_size() - offset;
+
+            return static_cast<uint32_t>(std::min<uint64_t>(remaining,
+                symbols(generation) * symbol_size(generation)));
+        }
+
+        /// @param generation The index of a generation
+        /// @return The number of bytes of the object in the base block
+        ///         of the generation, the generations are copied to
+        ///         the object without the shared symbols
+        uint32_t base_bytes_used(uint32_t generation) const
+        {
+            return m_partitioning.bytes_used(generation);
+        }
+
+        /// @return The number of symbols a generation shares with the
+        ///         next generation
+        uint32_t overlap() const
+        {
+            return m_overlap;
+        }
+
+        /// @return The size in bytes of the whole object
+        uint64_t object_size() const
+        {
+            return m_partitioning.object_size();
+        }
+
+    private:
+
+        /// The number of symbols shared with the next generation
+        uint32_t m_overlap;
+
+        /// The partitioning of the base blocks
+        block_partitioning m_partitioning;
+    };
+
+}
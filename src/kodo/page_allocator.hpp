@@ -0,0 +1,327 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kodo
+{
+
+    /// @brief Memory policy placing the pages of an allocation on the
+    ///        NUMA node of the thread which first writes them.
+    ///
+    /// Large allocations are mapped directly from the operating system
+    /// and are not written when allocated, so the storage of a coder
+    /// built by one thread and decoded on another ends up on the node
+    /// of the decoding thread. On other platforms the memory is taken
+    /// from the heap.
+    struct first_touch_memory
+    {
+        /// Allocations of at least this size are mapped
+        static const std::size_t mapping_threshold = 64 * 1024;
+
+        /// @return The alignment and granularity of mapped allocations
+        static std::size_t page_size()
+        {
+            return 4096;
+        }
+
+        /// Called on every new mapping
+        /// @param data The mapping
+        /// @param size The size of the mapping
+        static void advise(void *data, std::size_t size)
+        {
+            (void) data;
+            (void) size;
+        }
+    };
+
+    /// @brief Memory policy using 2 MB transparent huge pages for large
+    ///        allocations, which reduces the TLB misses when walking
+    ///        blocks of several MB.
+    ///
+    /// Smaller allocations come from the heap. The pages are placed on
+    /// first touch as in the first_touch_memory policy.
+    struct huge_page_memory : first_touch_memory
+    {
+        /// Smaller allocations are not worth a huge page
+        static const std::size_t mapping_threshold = 2 * 1024 * 1024;
+
+        /// @copydoc first_touch_memory::page_size()
+        static std::size_t page_size()
+        {
+            return 2 * 1024 * 1024;
+        }
+
+        /// @copydoc first_touch_memory::advise(void*,std::size_t)
+        static void advise(void *data, std::size_t size)
+        {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+            // Huge pages are only a hint, so errors are ignored
+            ::madvise(data, size, MADV_HUGEPAGE);
+#else
+            (void) data;
+            (void) size;
+#endif
+        }
+    };
+
+    /// @brief Memory policy binding the pages of large allocations to
+    ///        a NUMA node.
+    ///
+    /// This is useful when the coders of a factory are always used on
+    /// one node, e.g. with a factory per worker thread as in the
+    /// decoding_service, where each factory pool then is the free list
+    /// of its node.
+    template<uint32_t Node, class BasePolicy = first_touch_memory>
+    struct numa_node_memory : BasePolicy
+    {
+        /// @copydoc first_touch_memory::advise(void*,std::size_t)
+        static void advise(void *data, std::size_t size)
+        {
+            BasePolicy::advise(data, size);
+
+#if defined(__linux__) && defined(SYS_mbind)
+            static_assert(Node < 64, "Only the first 64 nodes are supported");
+
+            // MPOL_BIND from numaif.h, which needs libnuma
+            const int bind_policy = 2;
+            unsigned long mask = 1UL << Node;
+
+            // The binding is a hint, e.g. the node may not exist, so
+            // errors are ignored
+            ::syscall(SYS_mbind, data, size, bind_policy, &mask,
+                      sizeof(mask) * 8, 0);
+#else
+            (void) data;
+            (void) size;
+#endif
+        }
+    };
+
+    /// @brief Allocator serving large allocations by mapping pages
+    ///        according to a memory policy.
+    ///
+    /// The memory is zero initialized, and elements constructed without
+    /// a value are not written, so the vectors of the storage layers do
+    /// not touch the pages before they are used. Allocations below the
+    /// mapping threshold of the policy come from the heap.
+    template<class T, class MemoryPolicy = first_touch_memory>
+    class page_allocator
+    {
+    public:
+
+        /// The allocated type
+        typedef T value_type;
+
+        /// Rebinds the allocator to another type
+        template<class U>
+        struct rebind
+        {
+            /// The rebound allocator
+            typedef page_allocator<U, MemoryPolicy> other;
+        };
+
+    public:
+
+        /// Constructor
+        page_allocator()
+        { }
+
+        /// Converting constructor
+        template<class U>
+        page_allocator(const page_allocator<U, MemoryPolicy>&)
+        { }
+
+        /// Allocates zero initialized memory
+        /// @param n The number of elements
+        /// @return The memory
+        T* allocate(std::size_t n)
+        {
+            std::size_t size = n * sizeof(T);
+
+            if(!is_mapped(size))
+            {
+                void *data = std::calloc(n, sizeof(T));
+                if(data == 0)
+                {
+                    throw std::bad_alloc();
+                }
+
+                return static_cast<T*>(data);
+            }
+
+            return static_cast<T*>(map(size));
+        }
+
+        /// Releases memory
+        /// @param data The memory
+        /// @param n The number of elements
+        void deallocate(T *data, std::size_t n)
+        {
+            std::size_t size = n * sizeof(T);
+
+            if(!is_mapped(size))
+            {
+                std::free(data);
+                return;
+            }
+
+            unmap(data, size);
+        }
+
+        /// Constructs an element without a value, which leaves the zero
+        /// initialized memory of a trivial type untouched
+        /// @param data The element
+        template<class U>
+        void construct(U *data)
+        {
+            construct_default(data, std::is_trivial<U>());
+        }
+
+        /// Constructs an element from arguments
+        /// @param data The element
+        /// @param args The arguments
+        template<class U, class... Args>
+        void construct(U *data, Args&&... args)
+        {
+            ::new(static_cast<void*>(data)) U(std::forward<Args>(args)...);
+        }
+
+        /// Destroys an element
+        /// @param data The element
+        template<class U>
+        void destroy(U *data)
+        {
+            data->~U();
+        }
+
+        /// All allocators of a policy are interchangeable
+        bool operator==(const page_allocator&) const
+        {
+            return true;
+        }
+
+        /// All allocators of a policy are interchangeable
+        bool operator!=(const page_allocator&) const
+        {
+            return false;
+        }
+
+    private:
+
+        /// Leaves a trivial element as the zero initialized memory
+        template<class U>
+        static void construct_default(U*, std::true_type)
+        { }
+
+        /// Value initializes an element
+        template<class U>
+        static void construct_default(U *data, std::false_type)
+        {
+            ::new(static_cast<void*>(data)) U();
+        }
+
+        /// @return true if an allocation of a size is mapped
+        static bool is_mapped(std::size_t size)
+        {
+#if defined(__linux__)
+            return size >= MemoryPolicy::mapping_threshold;
+#else
+            (void) size;
+            return false;
+#endif
+        }
+
+        /// @return The size rounded up to whole pages of the policy
+        static std::size_t mapping_size(std::size_t size)
+        {
+            std::size_t page = MemoryPolicy::page_size();
+            return ((size + page - 1) / page) * page;
+        }
+
+#if defined(__linux__)
+
+        /// Maps an allocation aligned to a page of the policy
+        /// @param size The size of the allocation
+        /// @return The mapping
+        static void* map(std::size_t size)
+        {
+            std::size_t page = MemoryPolicy::page_size();
+            std::size_t length = mapping_size(size);
+
+            // Over-allocate by a page, and trim the mapping to the
+            // alignment
+            std::size_t reserved = length + page;
+
+            void *base = ::mmap(0, reserved, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if(base == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+
+            uintptr_t start = reinterpret_cast<uintptr_t>(base);
+            uintptr_t aligned = ((start + page - 1) / page) * page;
+
+            std::size_t head = aligned - start;
+            std::size_t tail = reserved - head - length;
+
+            if(head > 0)
+            {
+                ::munmap(base, head);
+            }
+
+            if(tail > 0)
+            {
+                ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+            }
+
+            void *data = reinterpret_cast<void*>(aligned);
+            MemoryPolicy::advise(data, length);
+
+            return data;
+        }
+
+        /// Unmaps an allocation
+        /// @param data The mapping
+        /// @param size The size of the allocation
+        static void unmap(void *data, std::size_t size)
+        {
+            ::munmap(data, mapping_size(size));
+        }
+
+#else
+
+        static void* map(std::size_t)
+        {
+            assert(0 && "Mappings are only used on Linux");
+            throw std::bad_alloc();
+        }
+
+        static void unmap(void*, std::size_t)
+        {
+            assert(0 && "Mappings are only used on Linux");
+        }
+
+#endif
+
+    };
+
+}
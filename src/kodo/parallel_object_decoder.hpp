@@ -0,0 +1,225 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+#include "block_executor.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Object decoder which owns the decoders of all the blocks
+    ///        of an object and uses a block_executor to decode the
+    ///        blocks in parallel.
+    ///
+    /// Incoming payloads are grouped by the block they belong to and
+    /// every group is decoded by a single task, in the order the
+    /// payloads were given. The task of decoder i is always queued at
+    /// the same worker, so each decoder is mostly used from one core.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class parallel_object_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+    public:
+
+        /// Constructs a new parallel object decoder and builds the
+        /// decoders of all blocks
+        /// @param decoder_factory The decoder factory to use
+        /// @param object_size The size in bytes of the object to be
+        ///        decoded
+        /// @param executor The executor running the blocks, must
+        ///        outlive the parallel object decoder
+        parallel_object_decoder(factory &decoder_factory,
+                                uint64_t object_size,
+                                block_executor &executor)
+            : m_executor(executor),
+              m_object_size(object_size)
+        {
+            assert(m_object_size > 0);
+
+            m_partitioning = block_partitioning(
+                decoder_factory.max_symbols(),
+                decoder_factory.max_symbol_size(),
+                m_object_size);
+
+            uint32_t blocks = m_partitioning.blocks();
+
+            m_decoders.resize(blocks);
+            m_payloads.resize(blocks);
+
+            for(uint32_t i = 0; i < blocks; ++i)
+            {
+                decoder_factory.set_symbols(m_partitioning.symbols(i));
+                decoder_factory.set_symbol_size(
+                    m_partitioning.symbol_size(i));
+
+                m_decoders[i] = decoder_factory.build();
+                m_decoders[i]->set_bytes_used(m_partitioning.bytes_used(i));
+            }
+        }
+
+        /// @return The number of decoders for this object
+        uint32_t decoders() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// @param decoder_id Specifies the decoder
+        /// @return The decoder of a specific block
+        pointer& decoder(uint32_t decoder_id)
+        {
+            assert(decoder_id < m_decoders.size());
+            return m_decoders[decoder_id];
+        }
+
+        /// Invokes a function for every decoder in parallel and waits
+        /// for the calls to complete.
+        /// @param function Invoked as function(decoder_id, decoder)
+        template<class Function>
+        void for_each_decoder(const Function &function)
+        {
+            m_executor.run(decoders(), [&](uint32_t decoder_id)
+                {
+                    function(decoder_id, m_decoders[decoder_id]);
+                });
+        }
+
+        /// Decodes a number of payloads in parallel, payloads for
+        /// decoders which are already complete are ignored.
+        /// @param decoder_ids The decoder of every payload
+        /// @param payloads The payloads
+        /// @param count The number of payloads
+        void decode(const uint32_t *decoder_ids, uint8_t **payloads,
+                    uint32_t count)
+        {
+            assert(decoder_ids != 0);
+            assert(payloads != 0);
+
+            m_active.clear();
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t decoder_id = decoder_ids[i];
+                assert(decoder_id < m_decoders.size());
+                assert(payloads[i] != 0);
+
+                if(m_payloads[decoder_id].empty())
+                {
+                    m_active.push_back(decoder_id);
+                }
+
+                m_payloads[decoder_id].push_back(payloads[i]);
+            }
+
+            m_executor.run(m_active, [this](uint32_t decoder_id)
+                {
+                    pointer &decoder = m_decoders[decoder_id];
+
+                    for(uint8_t *payload : m_payloads[decoder_id])
+                    {
+                        if(decoder->is_complete())
+                        {
+                            break;
+                        }
+
+                        decoder->decode(payload);
+                    }
+
+                    m_payloads[decoder_id].clear();
+                });
+        }
+
+        /// @return true if all decoders are complete
+        bool is_complete() const
+        {
+            return std::all_of(m_decoders.begin(), m_decoders.end(),
+                               [](const pointer &decoder)
+                               { return decoder->is_complete(); });
+        }
+
+        /// Copies the decoded object to the destination buffer, the
+        /// blocks are copied in parallel
+        /// @param dest_storage The destination buffer, must be at least
+        ///        object_size() bytes
+        void copy_symbols(const sak::mutable_storage &dest_storage)
+        {
+            copy_symbols(dest_storage.m_data, dest_storage.m_size);
+        }
+
+        /// Copies the decoded object to a destination buffer larger
+        /// than a storage object can hold, e.g. a mapped file
+        /// @param dest The destination buffer
+        /// @param dest_size The size of the destination buffer in bytes,
+        ///        at least object_size()
+        void copy_symbols(uint8_t *dest, uint64_t dest_size)
+        {
+            assert(dest != 0);
+            assert(dest_size >= m_object_size);
+            (void) dest_size;
+
+            for_each_decoder([&](uint32_t decoder_id, pointer &decoder)
+                {
+                    sak::mutable_storage storage;
+                    storage.m_data = dest +
+                        m_partitioning.byte_offset(decoder_id);
+                    storage.m_size = m_partitioning.bytes_used(decoder_id);
+
+                    decoder->copy_symbols(storage);
+                });
+        }
+
+        /// @return The total size of the object to decode in bytes
+        uint64_t object_size() const
+        {
+            return m_object_size;
+        }
+
+    protected:
+
+        /// The executor
+        block_executor &m_executor;
+
+        /// The block partitioning scheme used
+        block_partitioning m_partitioning;
+
+        /// Store the total object size in bytes
+        uint64_t m_object_size;
+
+        /// The decoders of the blocks
+        std::vector<pointer> m_decoders;
+
+        /// The payloads of the current decode() call grouped by decoder
+        std::vector<std::vector<uint8_t*> > m_payloads;
+
+        /// The decoders which received payloads in the current
+        /// decode() call
+        std::vector<uint32_t> m_active;
+    };
+
+}
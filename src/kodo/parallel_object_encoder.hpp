@@ -0,0 +1,187 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <mutex>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "block_executor.hpp"
+#include "has_concurrent_read.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Object encoder which owns the encoders of all the blocks
+    ///        of an object and uses a block_executor to initialize and
+    ///        run them in parallel.
+    ///
+    /// Where the object_encoder hands out one encoder at a time and
+    /// leaves it to the caller to drive them, this class builds the
+    /// encoders of all blocks up front and spreads the work over the
+    /// worker threads of the executor. Encoder i is always queued at
+    /// the same worker, so each encoder is mostly used from one core.
+    ///
+    /// The encoders are built on the calling thread since the factory
+    /// is not thread-safe, afterwards the blocks are read from the
+    /// object data in parallel.
+    ///
+    /// @tparam ObjectData object_data
+    /// @tparam EncoderType An encoder stack which should be used
+    /// @tparam BlockParitioning block_partitioning
+    template
+    <
+        class ObjectData,
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class parallel_object_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build encoders
+        typedef typename EncoderType::factory factory_type;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer_type;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+        /// The data source type
+        typedef ObjectData object_data;
+
+    public:
+
+        /// Constructs a new parallel object encoder and initializes the
+        /// encoders of all blocks with data
+        /// @param factory The encoder factory to use
+        /// @param data The object to encode
+        /// @param executor The executor running the blocks, must
+        ///        outlive the parallel object encoder
+        parallel_object_encoder(factory_type &factory,
+                                const object_data &data,
+                                block_executor &executor) :
+            m_data(data),
+            m_executor(executor)
+        {
+            assert(m_data.size() > 0);
+
+            m_partitioning = block_partitioning(
+                factory.max_symbols(),
+                factory.max_symbol_size(),
+                m_data.size());
+
+            uint32_t blocks = m_partitioning.blocks();
+            m_encoders.resize(blocks);
+
+            for(uint32_t i = 0; i < blocks; ++i)
+            {
+                factory.set_symbols(m_partitioning.symbols(i));
+                factory.set_symbol_size(m_partitioning.symbol_size(i));
+
+                m_encoders[i] = factory.build();
+            }
+
+            m_executor.run(blocks, [this](uint32_t encoder_id)
+                {
+                    read_block(encoder_id);
+                });
+        }
+
+        /// @return The number of encoders for this object
+        uint32_t encoders() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// @param encoder_id Specifies the encoder
+        /// @return The encoder of a specific block
+        pointer_type& encoder(uint32_t encoder_id)
+        {
+            assert(encoder_id < m_encoders.size());
+            return m_encoders[encoder_id];
+        }
+
+        /// Invokes a function for every encoder in parallel and waits
+        /// for the calls to complete.
+        /// @param function Invoked as function(encoder_id, encoder)
+        template<class Function>
+        void for_each_encoder(const Function &function)
+        {
+            m_executor.run(encoders(), [&](uint32_t encoder_id)
+                {
+                    function(encoder_id, m_encoders[encoder_id]);
+                });
+        }
+
+        /// Produces one encoded payload from each of the encoders in
+        /// parallel
+        /// @param payloads The payload buffers, payloads[i] receives
+        ///        the payload of encoder i and must be at least
+        ///        payload_size() of that encoder
+        void encode(uint8_t **payloads)
+        {
+            assert(payloads != 0);
+
+            for_each_encoder([payloads](uint32_t encoder_id,
+                                        pointer_type &encoder)
+                {
+                    assert(payloads[encoder_id] != 0);
+                    encoder->encode(payloads[encoder_id]);
+                });
+        }
+
+        /// @return The total size of the object to encode in bytes
+        uint64_t object_size() const
+        {
+            return m_data.size();
+        }
+
+    private:
+
+        /// Initializes an encoder with its data
+        /// @param encoder_id Specifies the encoder
+        void read_block(uint32_t encoder_id)
+        {
+            uint64_t offset = m_partitioning.byte_offset(encoder_id);
+            uint32_t bytes_used = m_partitioning.bytes_used(encoder_id);
+
+            if(has_concurrent_read<object_data>::value)
+            {
+                m_data.read(m_encoders[encoder_id], offset, bytes_used);
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(m_read_mutex);
+                m_data.read(m_encoders[encoder_id], offset, bytes_used);
+            }
+        }
+
+    private:
+
+        /// Store the object storage
+        object_data m_data;
+
+        /// The executor
+        block_executor &m_executor;
+
+        /// The block partitioning scheme used
+        block_partitioning m_partitioning;
+
+        /// The encoders of the blocks
+        std::vector<pointer_type> m_encoders;
+
+        /// Serializes the reads if the object data does not support
+        /// concurrent reads
+        std::mutex m_read_mutex;
+    };
+
+}
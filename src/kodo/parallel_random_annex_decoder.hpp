@@ -0,0 +1,477 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <sak/storage.hpp>
+
+#include "block_executor.hpp"
+#include "random_annex_base.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Random annex decoder which decodes the blocks of an object
+    ///        in parallel on a block_executor.
+    ///
+    /// The random_annex_decoder detects that a decoder completed in the
+    /// destructor of a call proxy and then passes the decoded annex
+    /// symbols to the other decoders from within that call, so all
+    /// decoders must be used from one thread. Here every decoder is
+    /// only used by the task of its block, and a completed block
+    /// instead pushes the symbols shared with other blocks onto their
+    /// inboxes. An inbox is a lock-free list which is drained by the
+    /// task of its block before and after the payloads are decoded.
+    ///
+    /// The symbols are not copied: a message refers to the symbol in
+    /// the storage of the completed decoder, which is not changed
+    /// anymore. A message exists for every annex entry in both
+    /// directions and is pushed at most once, so all messages are
+    /// allocated when the decoder is built.
+    ///
+    /// The annex is built as in the random_annex_encoder, which
+    /// produces the payloads.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class parallel_random_annex_decoder
+        : random_annex_base<BlockPartitioning>
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+        /// The base
+        typedef random_annex_base<BlockPartitioning> Base;
+
+        /// Pull up the annex
+        using Base::m_annex;
+
+    public:
+
+        /// Constructs a new parallel random annex decoder and builds
+        /// the decoders of all blocks
+        /// @param annex_size The number of symbols used for the random
+        ///        annex
+        /// @param decoder_factory The decoder factory to use
+        /// @param object_size The size in bytes of the object to be
+        ///        decoded
+        /// @param executor The executor running the blocks, must
+        ///        outlive the decoder
+        parallel_random_annex_decoder(uint32_t annex_size,
+                                      factory &decoder_factory,
+                                      uint32_t object_size,
+                                      block_executor &executor)
+            : m_executor(executor),
+              m_annex_size(annex_size),
+              m_object_size(object_size),
+              m_completed(0)
+        {
+            assert(m_object_size > 0);
+
+            // As in the random_annex_decoder the base blocks are made
+            // smaller to accommodate the annex
+            assert(m_annex_size < decoder_factory.max_symbols());
+
+            m_partitioning = block_partitioning(
+                decoder_factory.max_symbols() - m_annex_size,
+                decoder_factory.max_symbol_size(),
+                m_object_size);
+
+            Base::build_annex(m_annex_size, m_partitioning);
+
+            build_decoders(decoder_factory);
+            build_messages();
+        }
+
+        /// @return The number of decoders for this object
+        uint32_t decoders() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// @param decoder_id Specifies the decoder
+        /// @return The decoder of a specific block, must not be used
+        ///         while decode() runs
+        pointer& decoder(uint32_t decoder_id)
+        {
+            assert(decoder_id < m_decoders.size());
+            return m_decoders[decoder_id];
+        }
+
+        /// Decodes a number of payloads in parallel, payloads for
+        /// decoders which are already complete are ignored. When the
+        /// call returns the annex symbols of all completed blocks have
+        /// been passed to the other blocks.
+        /// @param decoder_ids The decoder of every payload
+        /// @param payloads The payloads
+        /// @param count The number of payloads
+        void decode(const uint32_t *decoder_ids, uint8_t **payloads,
+                    uint32_t count)
+        {
+            assert(decoder_ids != 0);
+            assert(payloads != 0);
+
+            m_active.clear();
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t decoder_id = decoder_ids[i];
+                assert(decoder_id < m_decoders.size());
+                assert(payloads[i] != 0);
+
+                if(m_payloads[decoder_id].empty())
+                {
+                    m_active.push_back(decoder_id);
+                }
+
+                m_payloads[decoder_id].push_back(payloads[i]);
+            }
+
+            m_executor.run(m_active, [this](uint32_t decoder_id)
+                {
+                    decode_block(decoder_id);
+                    m_payloads[decoder_id].clear();
+                });
+
+            // Blocks which received annex symbols after their task
+            // finished drain their inbox, which may complete them and
+            // fill other inboxes
+            while(true)
+            {
+                m_active.clear();
+
+                for(uint32_t i = 0; i < m_decoders.size(); ++i)
+                {
+                    block_state &block = m_blocks[i];
+
+                    if(!block.m_complete.load(std::memory_order_relaxed) &&
+                       block.m_inbox.load(std::memory_order_relaxed) != 0)
+                    {
+                        m_active.push_back(i);
+                    }
+                }
+
+                if(m_active.empty())
+                {
+                    break;
+                }
+
+                m_executor.run(m_active, [this](uint32_t decoder_id)
+                    {
+                        decode_block(decoder_id);
+                    });
+            }
+        }
+
+        /// @return true if all decoders are complete
+        bool is_complete() const
+        {
+            return m_completed.load(std::memory_order_acquire) ==
+                m_decoders.size();
+        }
+
+        /// @param decoder_id Specifies the decoder
+        /// @return true if the decoder is complete
+        bool is_complete(uint32_t decoder_id) const
+        {
+            assert(decoder_id < m_decoders.size());
+            return m_blocks[decoder_id].m_complete.load(
+                std::memory_order_acquire);
+        }
+
+        /// Copies the decoded object to the destination buffer, the
+        /// blocks are copied in parallel
+        /// @param dest_storage The destination buffer, must be at least
+        ///        object_size() bytes
+        void copy_symbols(const sak::mutable_storage &dest_storage)
+        {
+            assert(dest_storage.m_data != 0);
+            assert(dest_storage.m_size >= m_object_size);
+
+            m_executor.run(decoders(), [&](uint32_t decoder_id)
+                {
+                    sak::mutable_storage storage;
+                    storage.m_data = dest_storage.m_data +
+                        m_partitioning.byte_offset(decoder_id);
+                    storage.m_size = m_partitioning.bytes_used(decoder_id);
+
+                    m_decoders[decoder_id]->copy_symbols(storage);
+                });
+        }
+
+        /// @return The total size of the object to decode in bytes
+        uint32_t object_size() const
+        {
+            return m_object_size;
+        }
+
+    private:
+
+        /// A decoded symbol passed from one block to another
+        struct annex_message
+        {
+            /// The completed decoder holding the symbol
+            uint32_t m_from_decoder;
+
+            /// The index of the symbol in the completed decoder
+            uint32_t m_from_symbol;
+
+            /// The index of the symbol in the receiving decoder
+            uint32_t m_to_symbol;
+
+            /// The next message in the inbox
+            annex_message *m_next;
+        };
+
+        /// A message to send when a block completes
+        struct outgoing_message
+        {
+            /// The receiving decoder
+            uint32_t m_to_decoder;
+
+            /// The message
+            annex_message *m_message;
+        };
+
+        /// The state of a block shared between the tasks
+        struct block_state
+        {
+            block_state()
+                : m_inbox(0),
+                  m_complete(false)
+            { }
+
+            /// The messages received and not yet decoded
+            std::atomic<annex_message*> m_inbox;
+
+            /// True once the decoder is complete and its messages were
+            /// sent
+            std::atomic<bool> m_complete;
+        };
+
+    private:
+
+        /// Builds the decoders of all the blocks
+        /// @param decoder_factory The decoder factory to use
+        void build_decoders(factory &decoder_factory)
+        {
+            uint32_t blocks = m_partitioning.blocks();
+
+            m_decoders.resize(blocks);
+            m_payloads.resize(blocks);
+            m_blocks.reset(new block_state[blocks]);
+
+            for(uint32_t i = 0; i < blocks; ++i)
+            {
+                decoder_factory.set_symbols(
+                    m_partitioning.symbols(i) + m_annex_size);
+                decoder_factory.set_symbol_size(
+                    m_partitioning.symbol_size(i));
+
+                m_decoders[i] = decoder_factory.build();
+                m_decoders[i]->set_bytes_used(m_partitioning.bytes_used(i));
+            }
+        }
+
+        /// Allocates the messages of all annex entries. The annex
+        /// symbol j of block b equals symbol s of block c, so the
+        /// message to c is sent when b completes and the message to b
+        /// when c completes.
+        void build_messages()
+        {
+            uint32_t blocks = m_partitioning.blocks();
+
+            uint32_t entries = 0;
+            for(uint32_t b = 0; b < blocks; ++b)
+            {
+                entries += static_cast<uint32_t>(m_annex[b].size());
+            }
+
+            m_messages.resize(2 * entries);
+            m_outgoing.resize(blocks);
+
+            uint32_t next = 0;
+
+            for(uint32_t b = 0; b < blocks; ++b)
+            {
+                uint32_t annex_symbol = m_partitioning.symbols(b);
+
+                for(const annex_info &info : m_annex[b])
+                {
+                    uint32_t c = info.m_coder_id;
+                    assert(c != b);
+
+                    annex_message &forward = m_messages[next++];
+                    forward.m_from_decoder = b;
+                    forward.m_from_symbol = annex_symbol;
+                    forward.m_to_symbol = info.m_symbol_id;
+                    forward.m_next = 0;
+
+                    annex_message &reverse = m_messages[next++];
+                    reverse.m_from_decoder = c;
+                    reverse.m_from_symbol = info.m_symbol_id;
+                    reverse.m_to_symbol = annex_symbol;
+                    reverse.m_next = 0;
+
+                    m_outgoing[b].push_back(outgoing_message{c, &forward});
+                    m_outgoing[c].push_back(outgoing_message{b, &reverse});
+
+                    ++annex_symbol;
+                }
+            }
+
+            assert(next == m_messages.size());
+        }
+
+        /// The task of a block: drains the inbox, decodes the payloads
+        /// and sends the annex symbols if the block completed
+        /// @param decoder_id The block
+        void decode_block(uint32_t decoder_id)
+        {
+            block_state &block = m_blocks[decoder_id];
+
+            if(block.m_complete.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            pointer &decoder = m_decoders[decoder_id];
+
+            receive(decoder_id);
+
+            for(uint8_t *payload : m_payloads[decoder_id])
+            {
+                if(decoder->is_complete())
+                {
+                    break;
+                }
+
+                decoder->decode(payload);
+            }
+
+            // Symbols may have arrived while decoding
+            receive(decoder_id);
+
+            if(decoder->is_complete())
+            {
+                send(decoder_id);
+            }
+        }
+
+        /// Decodes the messages in the inbox of a block
+        /// @param decoder_id The block
+        void receive(uint32_t decoder_id)
+        {
+            pointer &decoder = m_decoders[decoder_id];
+
+            // Taking the whole list at once means a message is never
+            // popped while it is pushed again
+            annex_message *message = m_blocks[decoder_id].m_inbox.exchange(
+                0, std::memory_order_acquire);
+
+            for(; message != 0; message = message->m_next)
+            {
+                if(decoder->is_complete())
+                {
+                    break;
+                }
+
+                // The sender is complete and no longer changes the
+                // symbol
+                uint8_t *symbol_data =
+                    m_decoders[message->m_from_decoder]->symbol(
+                        message->m_from_symbol);
+
+                decoder->decode_symbol(symbol_data, message->m_to_symbol);
+            }
+        }
+
+        /// Marks a block complete and pushes its annex symbols onto the
+        /// inboxes of the other blocks
+        /// @param decoder_id The completed block
+        void send(uint32_t decoder_id)
+        {
+            m_blocks[decoder_id].m_complete.store(
+                true, std::memory_order_release);
+
+            for(const outgoing_message &outgoing : m_outgoing[decoder_id])
+            {
+                block_state &to = m_blocks[outgoing.m_to_decoder];
+
+                if(to.m_complete.load(std::memory_order_relaxed))
+                {
+                    continue;
+                }
+
+                annex_message *message = outgoing.m_message;
+                message->m_next = to.m_inbox.load(std::memory_order_relaxed);
+
+                // The release makes the decoded symbol visible to the
+                // receiver
+                while(!to.m_inbox.compare_exchange_weak(
+                          message->m_next, message,
+                          std::memory_order_release,
+                          std::memory_order_relaxed))
+                { }
+            }
+
+            m_completed.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+    private:
+
+        /// The executor
+        block_executor &m_executor;
+
+        /// The annex size
+        uint32_t m_annex_size;
+
+        /// The block partitioning scheme used
+        block_partitioning m_partitioning;
+
+        /// Store the total object size in bytes
+        uint32_t m_object_size;
+
+        /// The decoders of the blocks
+        std::vector<pointer> m_decoders;
+
+        /// The inboxes and completion of the blocks
+        std::unique_ptr<block_state[]> m_blocks;
+
+        /// The messages of all annex entries
+        std::vector<annex_message> m_messages;
+
+        /// The messages sent by every block when it completes
+        std::vector<std::vector<outgoing_message> > m_outgoing;
+
+        /// The number of completed blocks
+        std::atomic<uint32_t> m_completed;
+
+        /// The payloads of the current decode() call grouped by decoder
+        std::vector<std::vector<uint8_t*> > m_payloads;
+
+        /// The decoders which have work in the current run
+        std::vector<uint32_t> m_active;
+    };
+
+}
@@ -110,21 +110,29 @@ namespace kodo
         /// @copydoc layer::set_symbols(const sak::const_storage &)
         void set_symbols(const sak::const_storage &symbol_storage)
         {
-            auto symbol_sequence =
-                sak::split_storage(symbol_storage, Super::symbol_size());
+            uint32_t symbol_size = Super::symbol_size();
+
+            assert(symbol_storage.m_size > 0);
+            assert(symbol_storage.m_size <= Super::symbols() * symbol_size);
 
-            uint32_t sequence_size = symbol_sequence.size();
+            // The symbols are sliced from the storage in place, so
+            // setting the symbols does not allocate
+            uint32_t sequence_size =
+                (symbol_storage.m_size + symbol_size - 1) / symbol_size;
             uint32_t last_index = sequence_size - 1;
 
+            sak::const_storage symbol = symbol_storage;
+            symbol.m_size = symbol_size;
+
             for(uint32_t i = 0; i < last_index; ++i)
             {
-                Super::set_symbol(i, symbol_sequence[i]);
+                Super::set_symbol(i, symbol);
+                symbol.m_data += symbol_size;
             }
 
-            auto last_symbol =
-                symbol_sequence[last_index];
-
-            uint32_t symbol_size = Super::symbol_size();
+            sak::const_storage last_symbol = symbol;
+            last_symbol.m_size =
+                symbol_storage.m_size - last_index * symbol_size;
 
             auto partial_symbol =
                 sak::storage(&m_partial_symbol->at(0), symbol_size);
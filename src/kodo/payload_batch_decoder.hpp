@@ -0,0 +1,145 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Adds a decode() function decoding a number of payloads in
+    ///        one call, e.g. as received by recvmmsg().
+    ///
+    /// Decoded one at a time in arrival order, a coded symbol received
+    /// before the systematic symbols of its pivots is stored first, and
+    /// is decoded again by the swap_decode() of the linear_block_decoder
+    /// when the systematic symbol arrives. Here the headers of all the
+    /// payloads are read first, and the systematic symbols are decoded
+    /// before the coded symbols, in the order of their indices. The
+    /// systematic symbols already decoded or repeated in the batch are
+    /// skipped, as are all payloads once the decoder is complete. The
+    /// coded symbols are decoded in arrival order, since their pivots
+    /// are only known after the elimination.
+    ///
+    /// The layer is placed above the payload_decoder and requires the
+    /// systematic_decoder, whose header is read, and the
+    /// symbol_pivot() and symbol_coded() functions of the codec layer.
+    template<class SuperCoder>
+    class payload_batch_decoder : public SuperCoder
+    {
+    public:
+
+        /// Pull up the decode() functions
+        using SuperCoder::decode;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+            m_systematic.reserve(the_factory.max_symbols());
+        }
+
+        /// Decodes a number of payloads. The payloads may be modified,
+        /// as by decode(uint8_t*).
+        /// @param payloads The payload buffers, each must be at least
+        ///        layer::payload_size() bytes
+        /// @param count The number of payloads
+        /// @return The number of payloads passed to the decoder, the
+        ///         others were skipped as redundant
+        uint32_t decode(uint8_t **payloads, uint32_t count)
+        {
+            assert(payloads != 0);
+
+            m_systematic.clear();
+            m_coded.clear();
+
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                assert(payloads[i] != 0);
+
+                uint32_t index = 0;
+
+                if(SuperCoder::read_systematic_index(
+                       payloads[i] + symbol_size, &index))
+                {
+                    m_systematic.push_back(std::make_pair(index, i));
+                }
+                else
+                {
+                    m_coded.push_back(i);
+                }
+            }
+
+            // The stable sort keeps the first of repeated symbols
+            std::stable_sort(
+                m_systematic.begin(), m_systematic.end(),
+                [](const systematic_payload &a, const systematic_payload &b)
+                { return a.first < b.first; });
+
+            uint32_t decoded = 0;
+
+            for(uint32_t i = 0; i < m_systematic.size(); ++i)
+            {
+                if(SuperCoder::is_complete())
+                {
+                    return decoded;
+                }
+
+                uint32_t index = m_systematic[i].first;
+
+                if(i > 0 && m_systematic[i - 1].first == index)
+                {
+                    continue;
+                }
+
+                if(index < SuperCoder::symbols() &&
+                   SuperCoder::symbol_pivot(index) &&
+                   !SuperCoder::symbol_coded(index))
+                {
+                    continue;
+                }
+
+                SuperCoder::decode(payloads[m_systematic[i].second]);
+                ++decoded;
+            }
+
+            for(uint32_t i : m_coded)
+            {
+                if(SuperCoder::is_complete())
+                {
+                    return decoded;
+                }
+
+                SuperCoder::decode(payloads[i]);
+                ++decoded;
+            }
+
+            return decoded;
+        }
+
+    private:
+
+        /// The index of a systematic symbol and its payload
+        typedef std::pair<uint32_t, uint32_t> systematic_payload;
+
+        /// The systematic payloads of the batch
+        std::vector<systematic_payload> m_systematic;
+
+        /// The coded payloads of the batch
+        std::vector<uint32_t> m_coded;
+
+    };
+}
@@ -0,0 +1,61 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    /// @brief Adds an encode() function producing a number of payloads
+    ///        in one call.
+    ///
+    /// The payloads are encoded as if encode(uint8_t*) was called for
+    /// each of them, but the symbol data is produced in one pass over
+    /// the block by a linear_block_batch_encoder layer further down
+    /// the stack.
+    template<class SuperCoder>
+    class payload_batch_encoder : public SuperCoder
+    {
+    public:
+
+        /// Pull up the encode() functions
+        using SuperCoder::encode;
+
+    public:
+
+        /// Encodes a number of payloads.
+        /// @param payloads The payload buffers, each must be at least
+        ///        layer::payload_size() bytes
+        /// @param count The number of payloads to encode
+        /// @param bytes_used If not zero, the number of bytes used in
+        ///        each payload is written here
+        void encode(uint8_t **payloads, uint32_t count,
+                    uint32_t *bytes_used = 0)
+        {
+            assert(payloads != 0);
+
+            SuperCoder::begin_batch();
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                assert(payloads[i] != 0);
+
+                uint32_t used = SuperCoder::encode(payloads[i]);
+
+                if(bytes_used)
+                {
+                    bytes_used[i] = used;
+                }
+            }
+
+            SuperCoder::end_batch();
+        }
+
+    };
+}
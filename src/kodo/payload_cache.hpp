@@ -0,0 +1,252 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// @brief Bounded cache of encoded payloads filled by a background
+    ///        thread.
+    ///
+    /// The cache owns the use of an encoder while it exists: a
+    /// background thread encodes payloads whenever the cache is not
+    /// full, so the sending thread takes finished payloads without
+    /// encoding them, and bursts of requests are served from the cache.
+    /// The payloads are taken in the order in which they were encoded,
+    /// so a systematic encoder still sends the systematic symbols
+    /// first. The data of the encoder must be set before the cache is
+    /// created, and the encoder must not be used by other threads until
+    /// the cache is destroyed.
+    ///
+    /// Payloads are either copied with take() or used in place with
+    /// front() and pop().
+    template<class Encoder>
+    class payload_cache : boost::noncopyable
+    {
+    public:
+
+        /// The pointer type of the encoder
+        typedef typename Encoder::pointer pointer;
+
+    public:
+
+        /// Starts the background thread
+        /// @param encoder The encoder producing the payloads
+        /// @param capacity The maximum number of cached payloads
+        payload_cache(const pointer &encoder, uint32_t capacity)
+            : m_encoder(encoder),
+              m_payloads(capacity),
+              m_bytes_used(capacity, 0),
+              m_head(0),
+              m_count(0),
+              m_stop(false)
+        {
+            assert(m_encoder);
+            assert(capacity > 0);
+
+            for(auto &payload : m_payloads)
+            {
+                payload.resize(m_encoder->payload_size());
+            }
+
+            m_thread = std::thread(&payload_cache::fill, this);
+        }
+
+        /// Stops and joins the background thread
+        ~payload_cache()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+
+            m_not_full.notify_all();
+            m_thread.join();
+        }
+
+        /// @return The maximum number of cached payloads
+        uint32_t capacity() const
+        {
+            return static_cast<uint32_t>(m_payloads.size());
+        }
+
+        /// @return The number of payloads ready to be taken
+        uint32_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_count;
+        }
+
+        /// @return The size of a payload buffer
+        uint32_t payload_size() const
+        {
+            return static_cast<uint32_t>(m_payloads[0].size());
+        }
+
+        /// Copies the oldest payload into a buffer, waiting for it to be
+        /// encoded if the cache is empty
+        /// @param payload The buffer, must be at least payload_size()
+        ///        bytes
+        /// @return The number of bytes used in the payload
+        uint32_t take(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            const uint8_t *cached = 0;
+            uint32_t bytes_used = front(&cached);
+
+            std::copy(cached, cached + bytes_used, payload);
+            pop();
+
+            return bytes_used;
+        }
+
+        /// Copies the oldest payload into a buffer if one is ready
+        /// @param payload The buffer, must be at least payload_size()
+        ///        bytes
+        /// @return The number of bytes used in the payload, zero if the
+        ///         cache was empty
+        uint32_t try_take(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint32_t bytes_used = 0;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                if(m_count == 0)
+                {
+                    return 0;
+                }
+
+                bytes_used = m_bytes_used[m_head];
+                const uint8_t *cached = &m_payloads[m_head][0];
+
+                std::copy(cached, cached + bytes_used, payload);
+
+                m_head = (m_head + 1) % capacity();
+                --m_count;
+            }
+
+            m_not_full.notify_one();
+            return bytes_used;
+        }
+
+        /// Provides the oldest payload without copying it, waiting for
+        /// it to be encoded if the cache is empty. The payload stays
+        /// valid until pop() is called.
+        /// @param payload Set to the payload in the cache
+        /// @return The number of bytes used in the payload
+        uint32_t front(const uint8_t **payload)
+        {
+            assert(payload != 0);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [this] { return m_count > 0; });
+
+            *payload = &m_payloads[m_head][0];
+            return m_bytes_used[m_head];
+        }
+
+        /// Releases the payload provided by front() such that its buffer
+        /// is encoded again
+        void pop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                assert(m_count > 0);
+
+                m_head = (m_head + 1) % capacity();
+                --m_count;
+            }
+
+            m_not_full.notify_one();
+        }
+
+    private:
+
+        /// The background thread function, encoding into the free
+        /// buffers. The buffer after the cached payloads is never the
+        /// one provided by front(), so it is encoded without the lock.
+        void fill()
+        {
+            while(true)
+            {
+                uint32_t index;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+
+                    m_not_full.wait(lock, [this] {
+                        return m_stop || m_count < capacity(); });
+
+                    if(m_stop)
+                    {
+                        return;
+                    }
+
+                    index = (m_head + m_count) % capacity();
+                }
+
+                uint32_t bytes_used = m_encoder->encode(&m_payloads[index][0]);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    m_bytes_used[index] = bytes_used;
+                    ++m_count;
+                }
+
+                m_not_empty.notify_one();
+            }
+        }
+
+    private:
+
+        /// The encoder producing the payloads
+        pointer m_encoder;
+
+        /// The payload buffers
+        std::vector<std::vector<uint8_t> > m_payloads;
+
+        /// The number of bytes used in every payload buffer
+        std::vector<uint32_t> m_bytes_used;
+
+        /// The buffer of the oldest cached payload
+        uint32_t m_head;
+
+        /// The number of cached payloads
+        uint32_t m_count;
+
+        /// True when the cache is being destroyed
+        bool m_stop;
+
+        /// Protects the cache state
+        mutable std::mutex m_mutex;
+
+        /// Signals that a payload was cached
+        std::condition_variable m_not_empty;
+
+        /// Signals that a payload was taken or the cache stops
+        std::condition_variable m_not_full;
+
+        /// The background thread
+        std::thread m_thread;
+
+    };
+
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
 
 namespace kodo
 {
@@ -53,6 +54,20 @@ namespace kodo
             SuperCoder::decode(symbol_data, symbol_id);
         }
 
+        /// Decodes a symbol received in separate symbol data and symbol
+        /// header buffers, e.g. by a scatter/gather call such as
+        /// recvmsg(). The symbol data is decoded in place.
+        /// @param symbol_data The symbol data, must be at least
+        ///        layer::symbol_size() bytes
+        /// @param symbol_header The symbol header
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            SuperCoder::decode(symbol_data, symbol_header);
+        }
+
         /// @copydoc layer::payload_size() const
         uint32_t payload_size() const
         {
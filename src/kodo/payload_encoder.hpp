@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
 
 namespace kodo
 {
@@ -70,6 +71,48 @@ namespace kodo
                 + SuperCoder::symbol_size();
         }
 
+        /// Encodes a symbol into separate symbol data and symbol header
+        /// buffers. This allows the buffers to be passed directly to
+        /// a scatter/gather call such as sendmsg() with the header
+        /// first, without copying them into one payload buffer.
+        /// @param symbol_data The buffer for the symbol data, must be
+        ///        at least layer::symbol_size() bytes
+        /// @param symbol_header The buffer for the symbol header, must
+        ///        be at least layer::header_size() bytes
+        /// @return The number of bytes used in the symbol header
+        uint32_t encode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            return SuperCoder::encode(symbol_data, symbol_header);
+        }
+
+        /// Encodes a symbol as encode(uint8_t*,uint8_t*), except that
+        /// systematic symbols are not copied. Instead the symbol
+        /// reference is set to point at the symbol in the storage of
+        /// the encoder, otherwise it points at the symbol data buffer.
+        /// The referenced symbol data is valid until the data of the
+        /// encoder is changed.
+        /// @param symbol_data The buffer for coded symbol data, must be
+        ///        at least layer::symbol_size() bytes
+        /// @param symbol_header The buffer for the symbol header, must
+        ///        be at least layer::header_size() bytes
+        /// @param symbol_reference Set to the layer::symbol_size()
+        ///        bytes of symbol data to send
+        /// @return The number of bytes used in the symbol header
+        uint32_t encode_in_place(uint8_t *symbol_data,
+                                 uint8_t *symbol_header,
+                                 const uint8_t **symbol_reference)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+            assert(symbol_reference != 0);
+
+            return SuperCoder::encode_in_place(
+                symbol_data, symbol_header, symbol_reference);
+        }
+
         /// @copydoc layer::payload_size() const
         uint32_t payload_size() const
         {
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
+#include <algorithm>
 
 namespace kodo
 {
@@ -20,6 +22,12 @@ namespace kodo
     /// encoder. The only difference being that the a special Symbol ID
     /// layer generating the recoding coefficients and creating the
     /// recoded symbol id (or encoding vector).
+    ///
+    /// The recoding stack is only built when the coder recodes for the
+    /// first time, or when enable_recoding() is called, so a decoder
+    /// which never recodes does not hold the buffers of a recoder. A
+    /// coder recycled by the factory pool keeps its recoding stack
+    /// unless factory::set_keep_recode_stack() is set to false.
     template<template <class> class RecodingStack, class SuperCoder>
     class payload_recoder : public SuperCoder
     {
@@ -47,11 +55,27 @@ namespace kodo
             /// @copydoc layer::factory::factory(uint32_t,uint32_t)
             factory(uint32_t max_symbols, uint32_t max_symbol_size)
                 : SuperCoder::factory(max_symbols, max_symbol_size),
-                  m_stack_factory(max_symbols, max_symbol_size)
+                  m_stack_factory(max_symbols, max_symbol_size),
+                  m_keep_recode_stack(true)
             {
                 m_stack_factory.set_factory_proxy(this);
             }
 
+            /// Sets whether the coders built afterwards keep a recoding
+            /// stack built in an earlier use of the coder, or drop it
+            /// and build it again only if they recode
+            /// @param keep True for keeping the recoding stack
+            void set_keep_recode_stack(bool keep)
+            {
+                m_keep_recode_stack = keep;
+            }
+
+            /// @return True if the coders keep their recoding stack
+            bool keep_recode_stack() const
+            {
+                return m_keep_recode_stack;
+            }
+
             /// Make sure we have enough space for both the payload
             /// produced by the main stack and the recoding stack.
             /// @copydoc layer::factory::max_payload_size() const
@@ -61,11 +85,9 @@ namespace kodo
                                 m_stack_factory.max_payload_size());
             }
 
-        private:
-
-            /// Give the layer access
-            friend class payload_recoder;
-
+            /// The recoding stacks are built by this factory, it may be
+            /// used to configure the recoding, e.g. with
+            /// recoding_symbol_id::factory::set_recoding_rows()
             /// @return A reference to recoding stack factory
             typename recode_stack::factory& recode_factory()
             {
@@ -74,75 +96,108 @@ namespace kodo
 
         private:
 
+            /// The factory of the recoding stacks
             typename recode_stack::factory m_stack_factory;
 
+            /// True if the coders keep their recoding stack
+            bool m_keep_recode_stack;
+
         };
 
     public:
 
+        /// Constructor
+        payload_recoder()
+            : m_recode_factory(0)
+        { }
+
         /// @copydoc layer::initialize(Factory&)
         template<class Factory>
         void initialize(Factory& the_factory)
         {
             SuperCoder::initialize(the_factory);
 
-            // We have to postpone building the recoding stack to the
-            // initialize function, since we have to ensure that the
-            // main stack has been constructed and initialized.
-
-            auto& stack_factory = the_factory.recode_factory();
+            // The recoding stack is built when it is first used, since
+            // it needs the main stack to be constructed and initialized
+            m_recode_factory = &the_factory.recode_factory();
 
             if(!m_recode_stack)
             {
-                stack_factory.set_stack_proxy(this);
-                m_recode_stack = stack_factory.build();
+                return;
+            }
+
+            if(the_factory.keep_recode_stack())
+            {
+                m_recode_stack->initialize(*m_recode_factory);
             }
             else
             {
+                m_recode_stack.reset();
+            }
+        }
 
-                m_recode_stack->initialize(the_factory.recode_factory());
+        /// Builds the recoding stack if it is not built yet, this must
+        /// be done while the factory which built the coder exists
+        void enable_recoding()
+        {
+            if(m_recode_stack)
+            {
+                return;
             }
+
+            assert(m_recode_factory != 0);
+
+            m_recode_factory->set_stack_proxy(this);
+            m_recode_stack = m_recode_factory->build();
+        }
+
+        /// @return True if the recoding stack is built
+        bool is_recoding_enabled() const
+        {
+            return m_recode_stack.get() != 0;
         }
 
+        /// @return The recoding stack, which is null until recoding is
+        ///         enabled, see enable_recoding()
+        const recode_pointer& recoder() const
+        {
+            return m_recode_stack;
+        }
+
+        /// Recodes a payload, the first call builds the recoding stack,
+        /// see enable_recoding()
         /// @copydoc layer::recode(uint8_t*)
         void recode(uint8_t *payload)
         {
-            assert(m_recode_stack);
+            enable_recoding();
             m_recode_stack->encode(payload);
         }
 
         /// Make sure we have enough space for both the payload
-        /// produced by the main stack and the recoding stack.
+        /// produced by the main stack and the recoding stack. Before
+        /// the recoding stack is built only the payload of the main
+        /// stack is known, the recoding stacks of the library produce
+        /// payloads of the same size as the coded payloads.
         /// @copydoc layer::payload_size() const
         uint32_t payload_size() const
         {
-            assert(m_recode_stack);
+            if(!m_recode_stack)
+            {
+                return SuperCoder::payload_size();
+            }
+
             return std::max(SuperCoder::payload_size(),
                             m_recode_stack->payload_size());
         }
 
-    private:
-
-        /// Sets the recoding stack on the coder
-        /// @param recoder The recoding stack.
-        void set_recode_stack(const recode_pointer &recoder)
-        {
-            assert(!m_recode_stack);
-            m_recode_stack = recoder;
-        }
-
-        /// @return True if the coder already has already been initialized
-        ///         with an recoding stack
-        bool has_recode_stack() const
-        {
-            return m_recode_stack.get() != 0;
-        }
-
     protected:
 
         /// Store the recode stack
         recode_pointer m_recode_stack;
 
+        /// The factory of the recoding stack, set by initialize()
+        typename recode_stack::factory *m_recode_factory;
+
     };
 
 }
@@ -0,0 +1,256 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// @brief Lock-free single-producer/single-consumer ring of fixed
+    ///        size payload slots.
+    ///
+    /// The ring passes payloads from one thread, e.g. a socket thread,
+    /// to another thread, e.g. a decoding thread, without allocating or
+    /// locking per payload. The producer receives directly into a slot
+    /// and commits it, the consumer then decodes directly out of the
+    /// slot and releases it:
+    ///
+    /// @code
+    ///   uint8_t *slot = ring.begin_write();
+    ///   if(slot) { /* fill up to max_payload_size() bytes */
+    ///              ring.commit_write(size); }
+    ///
+    ///   uint32_t size;
+    ///   uint8_t *payload = ring.begin_read(&size);
+    ///   if(payload) { decoder->decode(payload);
+    ///                 ring.commit_read(); }
+    /// @endcode
+    ///
+    /// Decoders decode the payload in place, which is allowed since the
+    /// slot belongs to the consumer until commit_read() is called.
+    ///
+    /// The slots are aligned to the cache line, so the symbol data of
+    /// a payload keeps its alignment and neighbouring slots do not share
+    /// cache lines. The producer and consumer positions are kept on
+    /// separate cache lines as well.
+    class payload_ring : boost::noncopyable
+    {
+    public:
+
+        /// The size of a cache line in bytes
+        static const uint32_t cache_line_size = 64;
+
+    public:
+
+        /// Constructs a new ring
+        /// @param slots The minimum number of slots, rounded up to a
+        ///        power of two
+        /// @param max_payload_size The size of a slot in bytes, e.g.
+        ///        layer::factory::max_payload_size() of the decoders
+        payload_ring(uint32_t slots, uint32_t max_payload_size)
+            : m_max_payload_size(max_payload_size)
+        {
+            assert(slots > 0);
+            assert(max_payload_size > 0);
+
+            uint32_t capacity = 1;
+            while(capacity < slots)
+            {
+                capacity *= 2;
+            }
+
+            m_mask = capacity - 1;
+
+            m_slot_size = ((max_payload_size + cache_line_size - 1) /
+                           cache_line_size) * cache_line_size;
+
+            m_buffer.resize(capacity * m_slot_size + cache_line_size);
+            m_sizes.resize(capacity, 0);
+
+            // Align the first slot to the cache line
+            uintptr_t address = reinterpret_cast<uintptr_t>(&m_buffer[0]);
+            uint32_t offset = static_cast<uint32_t>(
+                (cache_line_size - address % cache_line_size) %
+                cache_line_size);
+
+            m_slots = &m_buffer[offset];
+
+            m_producer.m_position.store(0, std::memory_order_relaxed);
+            m_producer.m_cached = 0;
+            m_consumer.m_position.store(0, std::memory_order_relaxed);
+            m_consumer.m_cached = 0;
+        }
+
+        /// @return The number of slots
+        uint32_t slots() const
+        {
+            return m_mask + 1;
+        }
+
+        /// @return The size of a slot in bytes
+        uint32_t max_payload_size() const
+        {
+            return m_max_payload_size;
+        }
+
+        /// Producer: provides the next free slot
+        /// @return The slot of max_payload_size() bytes, or zero if the
+        ///         ring is full
+        uint8_t* begin_write()
+        {
+            uint32_t position =
+                m_producer.m_position.load(std::memory_order_relaxed);
+
+            // Only read the position of the consumer if the cached
+            // value says the ring is full
+            if(position - m_producer.m_cached > m_mask)
+            {
+                m_producer.m_cached =
+                    m_consumer.m_position.load(std::memory_order_acquire);
+
+                if(position - m_producer.m_cached > m_mask)
+                {
+                    return 0;
+                }
+            }
+
+            return slot(position);
+        }
+
+        /// Producer: passes the slot returned by begin_write() to the
+        /// consumer
+        /// @param size The number of bytes used in the slot
+        void commit_write(uint32_t size)
+        {
+            assert(size <= m_max_payload_size);
+
+            uint32_t position =
+                m_producer.m_position.load(std::memory_order_relaxed);
+
+            assert(position - m_producer.m_cached <= m_mask);
+
+            m_sizes[position & m_mask] = size;
+
+            m_producer.m_position.store(
+                position + 1, std::memory_order_release);
+        }
+
+        /// Consumer: provides the oldest committed slot
+        /// @param size If not zero, the number of bytes used in the slot
+        ///        is written here
+        /// @return The slot, or zero if the ring is empty
+        uint8_t* begin_read(uint32_t *size = 0)
+        {
+            uint32_t position =
+                m_consumer.m_position.load(std::memory_order_relaxed);
+
+            // Only read the position of the producer if the cached
+            // value says the ring is empty
+            if(position == m_consumer.m_cached)
+            {
+                m_consumer.m_cached =
+                    m_producer.m_position.load(std::memory_order_acquire);
+
+                if(position == m_consumer.m_cached)
+                {
+                    return 0;
+                }
+            }
+
+            if(size)
+            {
+                *size = m_sizes[position & m_mask];
+            }
+
+            return slot(position);
+        }
+
+        /// Consumer: returns the slot returned by begin_read() to the
+        /// producer
+        void commit_read()
+        {
+            uint32_t position =
+                m_consumer.m_position.load(std::memory_order_relaxed);
+
+            assert(position != m_consumer.m_cached);
+
+            m_consumer.m_position.store(
+                position + 1, std::memory_order_release);
+        }
+
+        /// @return true if the ring has no committed slots, only exact
+        ///         while the producer and consumer are idle
+        bool empty() const
+        {
+            return m_producer.m_position.load(std::memory_order_acquire) ==
+                m_consumer.m_position.load(std::memory_order_acquire);
+        }
+
+    private:
+
+        /// @param position A producer or consumer position
+        /// @return The slot at the position
+        uint8_t* slot(uint32_t position) const
+        {
+            return m_slots + (position & m_mask) * m_slot_size;
+        }
+
+    private:
+
+        /// The position of one side of the ring, and the last seen
+        /// position of the other side, on a cache line of its own
+        struct side
+        {
+            /// The number of slots written (producer) or read (consumer)
+            std::atomic<uint32_t> m_position;
+
+            /// The last position seen of the other side, only used by
+            /// the owning thread
+            uint32_t m_cached;
+
+            /// Keeps the other side off this cache line
+            uint8_t m_padding[cache_line_size -
+                              sizeof(std::atomic<uint32_t>) -
+                              sizeof(uint32_t)];
+        };
+
+        /// Mask selecting the slot of a position
+        uint32_t m_mask;
+
+        /// The size of a slot in bytes, a multiple of the cache line
+        uint32_t m_slot_size;
+
+        /// The maximum payload size
+        uint32_t m_max_payload_size;
+
+        /// The first slot
+        uint8_t *m_slots;
+
+        /// The number of bytes used in each slot
+        std::vector<uint32_t> m_sizes;
+
+        /// The memory of the slots
+        std::vector<uint8_t> m_buffer;
+
+        /// Keeps the positions off the cache lines of the members above,
+        /// which are only read after construction
+        uint8_t m_padding[cache_line_size];
+
+        /// The producer position
+        side m_producer;
+
+        /// The consumer position
+        side m_consumer;
+
+    };
+
+}
@@ -0,0 +1,368 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @brief The format of a payload trace, the payloads received by
+    ///        the decoders of a process in the order they were decoded.
+    ///
+    /// A trace starts with the four magic bytes "KPTR" and a version
+    /// byte, followed by records starting with a type byte:
+    ///
+    /// - generation: the symbols and the symbol size of a decoder
+    ///   initialized for a new generation. The payloads which follow
+    ///   belong to this generation.
+    /// - payload: the microseconds since the previous record, the size
+    ///   and the bytes of a payload.
+    ///
+    /// The numbers are unsigned LEB128 varints, so a payload costs a
+    /// few bytes besides its data. The trace does not hold the field or
+    /// the layers of the stack, it must be replayed with stacks reading
+    /// the same payload format.
+    struct payload_trace_format
+    {
+        /// The version written by the payload_trace_writer
+        static const uint8_t version = 1;
+
+        /// The type byte of a generation record
+        static const uint8_t generation_record = 'G';
+
+        /// The type byte of a payload record
+        static const uint8_t payload_record = 'P';
+
+        /// @return The magic bytes starting a trace
+        static const char* magic()
+        {
+            return "KPTR";
+        }
+    };
+
+    /// @brief Writes a payload trace to a stream, see
+    ///        payload_trace_format.
+    ///
+    /// The stream must be opened in binary mode and outlive the writer.
+    /// The writer is used by the trace_capture_decoder layer, and may
+    /// be shared by several decoders of a single thread, e.g. the
+    /// decoders of an object.
+    class payload_trace_writer
+    {
+    public:
+
+        /// The clock timing the arrival of the payloads
+        typedef std::chrono::steady_clock clock_type;
+
+    public:
+
+        /// Constructor, writes the magic bytes and the version
+        /// @param out The stream receiving the trace
+        payload_trace_writer(std::ostream &out)
+            : m_out(out),
+              m_last(clock_type::now()),
+              m_payloads(0)
+        {
+            m_out.write(payload_trace_format::magic(), 4);
+            m_out.put(payload_trace_format::version);
+        }
+
+        /// Records that a decoder starts a new generation
+        /// @param symbols The number of symbols of the generation
+        /// @param symbol_size The size of a symbol in bytes
+        void write_generation(uint32_t symbols, uint32_t symbol_size)
+        {
+            m_out.put(payload_trace_format::generation_record);
+            write_varint(symbols);
+            write_varint(symbol_size);
+        }
+
+        /// Records a payload passed to a decoder
+        /// @param payload The payload
+        /// @param size The size of the payload in bytes
+        void write_payload(const uint8_t *payload, uint32_t size)
+        {
+            assert(payload != 0);
+            assert(size > 0);
+
+            clock_type::time_point now = clock_type::now();
+
+            uint64_t delay = std::chrono::duration_cast<
+                std::chrono::microseconds>(now - m_last).count();
+
+            m_last = now;
+
+            m_out.put(payload_trace_format::payload_record);
+            write_varint(delay);
+            write_varint(size);
+            m_out.write(reinterpret_cast<const char*>(payload), size);
+
+            ++m_payloads;
+        }
+
+        /// @return The number of payloads written
+        uint64_t payloads() const
+        {
+            return m_payloads;
+        }
+
+        /// @return False if writing to the stream failed
+        bool good() const
+        {
+            return m_out.good();
+        }
+
+    protected:
+
+        /// Writes an unsigned LEB128 varint
+        /// @param value The value
+        void write_varint(uint64_t value)
+        {
+            while(value >= 0x80)
+            {
+                m_out.put(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+
+            m_out.put(static_cast<char>(value));
+        }
+
+    protected:
+
+        /// The stream receiving the trace
+        std::ostream &m_out;
+
+        /// The time of the last payload
+        clock_type::time_point m_last;
+
+        /// The number of payloads written
+        uint64_t m_payloads;
+    };
+
+    /// @brief A payload trace loaded in memory for replaying it, see
+    ///        payload_trace_format.
+    ///
+    /// The payloads are kept in a single buffer, so replaying the
+    /// trace touches no other memory than the decoders.
+    class payload_trace
+    {
+    public:
+
+        /// A generation of the trace
+        struct generation
+        {
+            /// The number of symbols
+            uint32_t m_symbols;
+
+            /// The size of a symbol in bytes
+            uint32_t m_symbol_size;
+
+            /// The index of the first payload of the generation
+            uint32_t m_first_payload;
+
+            /// The number of payloads of the generation
+            uint32_t m_payloads;
+        };
+
+        /// A payload of the trace
+        struct payload
+        {
+            /// The offset of the payload in the data of the trace
+            uint64_t m_offset;
+
+            /// The size of the payload in bytes
+            uint32_t m_size;
+
+            /// The microseconds since the previous payload was captured
+            uint64_t m_delay;
+        };
+
+    public:
+
+        /// Loads a trace, the trace previously loaded is discarded
+        /// @param in The stream holding the trace, opened in binary mode
+        /// @return False if the stream does not hold a valid trace
+        bool load(std::istream &in)
+        {
+            m_generations.clear();
+            m_payloads.clear();
+            m_data.clear();
+
+            char magic[4];
+
+            if(!in.read(magic, 4) ||
+               !std::equal(magic, magic + 4, payload_trace_format::magic()))
+            {
+                return false;
+            }
+
+            if(in.get() != payload_trace_format::version)
+            {
+                return false;
+            }
+
+            int type;
+
+            while((type = in.get()) != std::istream::traits_type::eof())
+            {
+                if(type == payload_trace_format::generation_record)
+                {
+                    generation g;
+                    uint64_t symbols, symbol_size;
+
+                    if(!read_varint(in, symbols) ||
+                       !read_varint(in, symbol_size) ||
+                       symbols == 0 || symbol_size == 0)
+                    {
+                        return false;
+                    }
+
+                    g.m_symbols = static_cast<uint32_t>(symbols);
+                    g.m_symbol_size = static_cast<uint32_t>(symbol_size);
+                    g.m_first_payload =
+                        static_cast<uint32_t>(m_payloads.size());
+                    g.m_payloads = 0;
+
+                    m_generations.push_back(g);
+                }
+                else if(type == payload_trace_format::payload_record)
+                {
+                    // A payload before any generation is invalid
+                    if(m_generations.empty())
+                    {
+                        return false;
+                    }
+
+                    payload p;
+                    uint64_t size;
+
+                    if(!read_varint(in, p.m_delay) ||
+                       !read_varint(in, size) || size == 0)
+                    {
+                        return false;
+                    }
+
+                    p.m_offset = m_data.size();
+                    p.m_size = static_cast<uint32_t>(size);
+
+                    m_data.resize(m_data.size() + p.m_size);
+
+                    if(!in.read(reinterpret_cast<char*>(&m_data[p.m_offset]),
+                                p.m_size))
+                    {
+                        return false;
+                    }
+
+                    m_payloads.push_back(p);
+                    ++m_generations.back().m_payloads;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// @return The number of generations of the trace
+        uint32_t generations() const
+        {
+            return static_cast<uint32_t>(m_generations.size());
+        }
+
+        /// @param index The index of a generation
+        /// @return The generation
+        const generation& generation_at(uint32_t index) const
+        {
+            assert(index < m_generations.size());
+            return m_generations[index];
+        }
+
+        /// @return The number of payloads of the trace
+        uint32_t payloads() const
+        {
+            return static_cast<uint32_t>(m_payloads.size());
+        }
+
+        /// @param index The index of a payload
+        /// @return The payload
+        const payload& payload_at(uint32_t index) const
+        {
+            assert(index < m_payloads.size());
+            return m_payloads[index];
+        }
+
+        /// @param index The index of a payload
+        /// @return The data of the payload
+        const uint8_t* payload_data(uint32_t index) const
+        {
+            return &m_data[payload_at(index).m_offset];
+        }
+
+        /// @return The largest size of a payload in bytes
+        uint32_t max_payload_size() const
+        {
+            uint32_t size = 0;
+
+            for(const payload &p : m_payloads)
+            {
+                size = std::max(size, p.m_size);
+            }
+
+            return size;
+        }
+
+    protected:
+
+        /// Reads an unsigned LEB128 varint
+        /// @param in The stream
+        /// @param value The value read
+        /// @return False if the stream ended or the varint is too long
+        static bool read_varint(std::istream &in, uint64_t &value)
+        {
+            value = 0;
+
+            for(uint32_t shift = 0; shift < 64; shift += 7)
+            {
+                int byte = in.get();
+
+                if(byte == std::istream::traits_type::eof())
+                {
+                    return false;
+                }
+
+                value |= uint64_t(byte & 0x7f) << shift;
+
+                if((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    protected:
+
+        /// The generations of the trace
+        std::vector<generation> m_generations;
+
+        /// The payloads of the trace
+        std::vector<payload> m_payloads;
+
+        /// The data of the payloads
+        std::vector<uint8_t> m_data;
+    };
+
+}
@@ -0,0 +1,167 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+
+#include "pivot_feedback_writer.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Restricts the generated coefficients to the symbols a
+    ///        decoder is missing, according to its feedback.
+    ///
+    /// The feedback is produced by the pivot_feedback_writer layer of
+    /// the decoder. After a feedback is read, the coefficients of the
+    /// symbols the decoder has a pivot for are set to zero, so the
+    /// encoder skips those symbols. Since the pivots of the decoder are
+    /// distinct, any non-zero combination of the missing symbols is
+    /// innovative for it, if the generated coefficients of the missing
+    /// symbols are all zero the first missing symbol is used instead.
+    ///
+    /// The coefficients are changed after they are generated, so the
+    /// layer only works with stacks sending the full encoding vector,
+    /// e.g. with the plain_symbol_id_writer, and it must be placed
+    /// between the symbol id writer and the coefficient generator. The
+    /// feedback is cleared when the encoder is initialized.
+    template<class SuperCoder>
+    class pivot_feedback_reader : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_received.resize(the_factory.max_symbols(), false);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            clear_feedback();
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            SuperCoder::generate(coefficients);
+
+            if(!m_has_feedback)
+            {
+                return;
+            }
+
+            value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t first_missing = SuperCoder::symbols();
+            bool non_zero = false;
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(m_received[i])
+                {
+                    fifi::set_value<field_type>(c, i, 0U);
+                    continue;
+                }
+
+                if(first_missing == SuperCoder::symbols())
+                {
+                    first_missing = i;
+                }
+
+                if(fifi::get_value<field_type>(c, i))
+                {
+                    non_zero = true;
+                }
+            }
+
+            if(!non_zero && first_missing < SuperCoder::symbols())
+            {
+                fifi::set_value<field_type>(c, first_missing, 1U);
+            }
+        }
+
+        /// Reads the feedback of a decoder, the following encoded
+        /// symbols only combine the symbols it is missing
+        /// @param feedback The feedback written by the
+        ///        pivot_feedback_writer::write_feedback() function
+        void read_feedback(const uint8_t *feedback)
+        {
+            assert(feedback != 0);
+
+            m_missing = 0;
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                m_received[i] = (feedback[i / 8] >> (i % 8)) & 1U;
+
+                if(!m_received[i])
+                {
+                    ++m_missing;
+                }
+            }
+
+            m_has_feedback = true;
+        }
+
+        /// Clears the feedback, the encoder codes over all symbols
+        void clear_feedback()
+        {
+            std::fill_n(m_received.begin(), SuperCoder::symbols(), false);
+            m_missing = SuperCoder::symbols();
+            m_has_feedback = false;
+        }
+
+        /// @return The size in bytes of the feedback of the block
+        uint32_t feedback_size() const
+        {
+            return pivot_feedback_size(SuperCoder::symbols());
+        }
+
+        /// @return The number of symbols the decoder is missing according
+        ///         to the last feedback, or the number of symbols if no
+        ///         feedback was read
+        uint32_t feedback_missing_symbols() const
+        {
+            return m_missing;
+        }
+
+    protected:
+
+        /// Tracks the symbols the decoder has a pivot for
+        std::vector<bool> m_received;
+
+        /// The number of symbols the decoder is missing
+        uint32_t m_missing;
+
+        /// True if a feedback was read since the initialization
+        bool m_has_feedback;
+
+    };
+
+}
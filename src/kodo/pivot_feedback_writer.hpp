@@ -0,0 +1,88 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace kodo
+{
+
+    /// @return The size in bytes of the pivot feedback of a block
+    /// @param symbols The number of symbols of the block
+    inline uint32_t pivot_feedback_size(uint32_t symbols)
+    {
+        return (symbols + 7) / 8;
+    }
+
+    /// @ingroup codec_layers
+    /// @brief Serializes the pivots of a decoder as feedback for the
+    ///        encoder.
+    ///
+    /// The feedback is a bitmap with one bit per symbol, bit i % 8 of
+    /// byte i / 8 is set if the decoder has a pivot for symbol i. The
+    /// pivot_feedback_reader layer of an encoder uses the feedback to
+    /// only code over the symbols the decoder has no pivot for, the
+    /// encoded symbols are then innovative for the decoder unless all
+    /// the coefficients are zero. The layer must be placed above a
+    /// decoder providing symbol_pivot().
+    template<class SuperCoder>
+    class pivot_feedback_writer : public SuperCoder
+    {
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer provides the size of the largest feedback
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @return The size in bytes of the largest feedback
+            uint32_t max_feedback_size() const
+            {
+                return pivot_feedback_size(SuperCoder::factory::max_symbols());
+            }
+        };
+
+    public:
+
+        /// @return The size in bytes of the feedback of the block
+        uint32_t feedback_size() const
+        {
+            return pivot_feedback_size(SuperCoder::symbols());
+        }
+
+        /// Writes the pivots of the decoder to the feedback buffer
+        /// @param feedback The buffer, must be at least feedback_size()
+        ///        bytes
+        /// @return The number of bytes written
+        uint32_t write_feedback(uint8_t *feedback) const
+        {
+            assert(feedback != 0);
+
+            uint32_t size = feedback_size();
+            std::fill_n(feedback, size, 0);
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(SuperCoder::symbol_pivot(i))
+                {
+                    feedback[i / 8] |= static_cast<uint8_t>(1U << (i % 8));
+                }
+            }
+
+            return size;
+        }
+
+    };
+
+}
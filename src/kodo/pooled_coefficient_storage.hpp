@@ -0,0 +1,313 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+#include <sak/aligned_allocator.hpp>
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_storage_layers
+    /// @brief Coefficient storage where a coefficient vector is only
+    ///        allocated while it is needed.
+    ///
+    /// The coefficient_storage allocates a vector for every symbol,
+    /// although the vectors of the uncoded symbols are unit vectors and
+    /// a complete decoder needs no vectors at all. Here the vectors are
+    /// taken from a pool of rows, allocated in chunks of rows_per_chunk
+    /// rows, when they are first accessed. A vector which is a unit
+    /// vector, e.g. of an uncoded symbol, is returned to the pool with
+    /// release_coefficients() and is rebuilt as a unit vector if it is
+    /// accessed again. The chunks are only freed when all vectors are
+    /// released with release_all_coefficients(), e.g. when the decoder
+    /// is complete.
+    ///
+    /// The vectors are released by the coefficient_release_decoder, so
+    /// a decoder only holds the vectors of its coded symbols. Accessing
+    /// a released vector, also through the const accessors, allocates
+    /// it again, e.g. when recoding.
+    template<class SuperCoder>
+    class pooled_coefficient_storage : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+        /// The number of rows allocated at a time
+        static const uint32_t rows_per_chunk = 16;
+
+    public:
+
+        /// Constructor
+        pooled_coefficient_storage()
+            : m_stride(0),
+              m_allocated_rows(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            uint32_t max_coefficients_size =
+                the_factory.max_coefficients_size();
+
+            m_stride = ((max_coefficients_size + alignment - 1)
+                        / alignment) * alignment;
+
+            assert(m_stride >= max_coefficients_size);
+
+            m_rows.resize(the_factory.max_symbols(), 0);
+            m_unit_rows.resize(the_factory.max_symbols(), false);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            // The vectors of a recycled coder are not used again
+            release_all_coefficients();
+            std::fill(m_unit_rows.begin(), m_unit_rows.end(), false);
+        }
+
+        /// @copydoc layer::coefficients(uint32_t)
+        uint8_t* coefficients(uint32_t index)
+        {
+            assert(index < SuperCoder::symbols());
+            return row(index);
+        }
+
+        /// @copydoc layer::coefficients(uint32_t) const
+        const uint8_t* coefficients(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return row(index);
+        }
+
+        /// @copydoc layer::coefficients_value(uint32_t)
+        value_type* coefficients_value(uint32_t index)
+        {
+            return reinterpret_cast<value_type*>(
+                coefficients(index));
+        }
+
+        /// @copydoc layer::coefficients_value(uint32_t) const
+        const value_type* coefficients_value(uint32_t index) const
+        {
+            return reinterpret_cast<const value_type*>(
+                coefficients(index));
+        }
+
+        /// @copydoc layer::set_coefficients(
+        ///              uint32_t,const sak::const_storage&)
+        void set_coefficients(uint32_t index,
+                              const sak::const_storage &storage)
+        {
+            assert(storage.m_size == SuperCoder::coefficients_size());
+            assert(storage.m_data != 0);
+
+            auto dest = sak::storage(
+                coefficients(index), SuperCoder::coefficients_size());
+
+            sak::copy_storage(dest, storage);
+        }
+
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() +
+                SuperCoder::symbols() * SuperCoder::coefficients_size();
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            buffer = SuperCoder::write_snapshot(buffer);
+
+            uint32_t size = SuperCoder::coefficients_size();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                std::copy_n(coefficients(i), size, buffer);
+                buffer += size;
+            }
+
+            return buffer;
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            uint32_t size = SuperCoder::coefficients_size();
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                std::copy_n(buffer, size, coefficients(i));
+                buffer += size;
+            }
+
+            return buffer;
+        }
+
+        /// Returns the vector of a symbol to the pool, the vector must
+        /// be the unit vector of the symbol
+        /// @param index The index of the symbol
+        void release_coefficients(uint32_t index)
+        {
+            assert(index < SuperCoder::symbols());
+
+            m_unit_rows[index] = true;
+
+            if(m_rows[index] == 0)
+            {
+                return;
+            }
+
+            assert(fifi::get_value<field_type>(
+                       coefficients_value(index), index) == 1);
+
+            m_free_rows.push_back(m_rows[index]);
+            m_rows[index] = 0;
+
+            --m_allocated_rows;
+        }
+
+        /// Returns all vectors to the pool and frees the pool, all
+        /// vectors must be unit vectors, as in a complete decoder
+        void release_all_coefficients()
+        {
+            std::fill(m_unit_rows.begin(), m_unit_rows.end(), true);
+            std::fill(m_rows.begin(), m_rows.end(), (uint8_t*) 0);
+
+            m_allocated_rows = 0;
+            free_chunks();
+        }
+
+        /// @return The number of coefficient vectors currently allocated
+        uint32_t coefficient_rows() const
+        {
+            return m_allocated_rows;
+        }
+
+        /// @return The number of coefficient vectors held by the pool,
+        ///         including the free ones
+        uint32_t coefficient_pool_rows() const
+        {
+            return m_chunks.size() * rows_per_chunk;
+        }
+
+    protected:
+
+        /// The alignment of the individual coefficient vectors, this is
+        /// needed when using SSE etc. instructions for fast computations
+        /// with the coefficients
+        static const uint32_t alignment = 16;
+
+        /// @param index The index of a symbol
+        /// @return The vector of the symbol, allocated if needed
+        uint8_t* row(uint32_t index) const
+        {
+            if(m_rows[index] != 0)
+            {
+                return m_rows[index];
+            }
+
+            if(m_free_rows.empty())
+            {
+                allocate_chunk();
+            }
+
+            uint8_t *data = m_free_rows.back();
+            m_free_rows.pop_back();
+
+            std::fill_n(data, m_stride, 0);
+
+            if(m_unit_rows[index])
+            {
+                fifi::set_value<field_type>(
+                    reinterpret_cast<value_type*>(data), index, 1U);
+            }
+
+            m_rows[index] = data;
+            ++m_allocated_rows;
+
+            return data;
+        }
+
+        /// Allocates a chunk of rows and adds them to the free rows
+        void allocate_chunk() const
+        {
+            assert(m_stride > 0);
+
+            m_chunks.push_back(aligned_vector(rows_per_chunk * m_stride));
+
+            uint8_t *data = &m_chunks.back()[0];
+
+            for(uint32_t i = rows_per_chunk; i --> 0;)
+            {
+                m_free_rows.push_back(data + i * m_stride);
+            }
+        }
+
+        /// Frees the chunks, no row may be allocated
+        void free_chunks()
+        {
+            assert(m_allocated_rows == 0);
+
+            m_free_rows.clear();
+            m_chunks.clear();
+        }
+
+    private:
+
+        /// The type of the aligned buffer
+        typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
+            aligned_vector;
+
+        /// The distance in bytes between two rows of a chunk
+        uint32_t m_stride;
+
+        /// The chunks of rows, a list so the rows never move. The pool
+        /// is mutable since the const accessors may allocate a row.
+        mutable std::list<aligned_vector> m_chunks;
+
+        /// The rows not used by a symbol
+        mutable std::vector<uint8_t*> m_free_rows;
+
+        /// The row of every symbol, null if not allocated
+        mutable std::vector<uint8_t*> m_rows;
+
+        /// The number of rows used by a symbol
+        mutable uint32_t m_allocated_rows;
+
+        /// True for the symbols whose vector is a unit vector when it
+        /// is allocated again
+        std::vector<bool> m_unit_rows;
+
+    };
+
+}
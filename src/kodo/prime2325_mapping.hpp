@@ -0,0 +1,308 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#include <sak/storage.hpp>
+
+#include <fifi/field_types.hpp>
+
+#include "thread_scratch.hpp"
+
+namespace kodo
+{
+
+    /// Tag of the thread_scratch buffer holding the bitmap of the
+    /// prime2325_mask_search
+    struct prime2325_mask_scratch { };
+
+    /// @brief Finds a mask which maps arbitrary 32 bit words to
+    ///        elements of the prime2325 field in a single pass.
+    ///
+    /// The words 2^32 - 5 and above are not field elements. For n
+    /// words at least one of the 2^k values of the k top bits, with
+    /// 2^k > n, does not occur in the data. With b such a value, the
+    /// mask ~b in the top k bits maps every word w to w ^ mask, whose
+    /// top k bits are never all ones, so the mapped word is below
+    /// 2^32 - 2^(32 - k) and an element as k is at most 29. The same
+    /// XOR maps the elements back to the data.
+    ///
+    /// Unlike a binary search for an unused prefix, which reads the
+    /// data once per bit of the prefix, the search marks the top bits
+    /// of every word in a bitmap of at most n / 4 bytes.
+    class prime2325_mask_search
+    {
+    public:
+
+        /// Constructor
+        /// @param words The maximum number of words searched, must be
+        ///        below 2^29
+        explicit prime2325_mask_search(uint32_t words)
+        {
+            assert(words < (1U << 29));
+
+            // At least 64 buckets so the bitmap is whole 64 bit words
+            m_bits = 6;
+            while((1U << m_bits) <= words)
+            {
+                ++m_bits;
+            }
+
+            uint32_t bitmap_size = (1U << m_bits) / 8;
+
+            m_bitmap = thread_scratch<prime2325_mask_scratch>::values<
+                uint64_t>(bitmap_size / 8);
+
+            std::memset(m_bitmap, 0, bitmap_size);
+
+            m_words = 0;
+            m_max_words = words;
+        }
+
+        /// Marks the words of a buffer
+        /// @param data The buffer
+        /// @param size The size of the buffer in bytes, must be a
+        ///        multiple of 4
+        void insert(const uint8_t *data, uint32_t size)
+        {
+            assert(data != 0);
+            assert((size % 4) == 0);
+
+            m_words += size / 4;
+            assert(m_words <= m_max_words);
+
+            uint32_t shift = 32 - m_bits;
+
+            for(uint32_t i = 0; i < size; i += 4)
+            {
+                uint32_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+
+                uint32_t bucket = word >> shift;
+                m_bitmap[bucket / 64] |= uint64_t(1) << (bucket % 64);
+            }
+        }
+
+        /// @return The mask for the words inserted
+        uint32_t mask() const
+        {
+            uint32_t entries = (1U << m_bits) / 64;
+
+            for(uint32_t i = 0; i < entries; ++i)
+            {
+                uint64_t unused = ~m_bitmap[i];
+                if(unused == 0)
+                    continue;
+
+                uint32_t bit = 0;
+                while(((unused >> bit) & 1U) == 0)
+                {
+                    ++bit;
+                }
+
+                uint32_t bucket = i * 64 + bit;
+                return ~bucket << (32 - m_bits);
+            }
+
+            // More buckets than words, so one is always unused
+            assert(0);
+            return 0;
+        }
+
+    private:
+
+        /// The number of top bits marked
+        uint32_t m_bits;
+
+        /// The bitmap of the top bits occurring in the data
+        uint64_t *m_bitmap;
+
+        /// The number of words inserted
+        uint32_t m_words;
+
+        /// The maximum number of words
+        uint32_t m_max_words;
+    };
+
+    /// XORs a mask onto every 32 bit word of a buffer, eight bytes at a
+    /// time so the loop is vectorized by the compiler. A trailing
+    /// partial word is masked bytewise.
+    /// @param data The buffer
+    /// @param size The size of the buffer in bytes
+    /// @param mask The mask
+    inline void prime2325_apply_mask(uint8_t *data, uint32_t size,
+                                     uint32_t mask)
+    {
+        assert(data != 0);
+
+        uint64_t wide = (uint64_t(mask) << 32) | mask;
+
+        uint32_t i = 0;
+        for(; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            word ^= wide;
+            std::memcpy(data + i, &word, sizeof(word));
+        }
+
+        uint8_t bytes[sizeof(mask)];
+        std::memcpy(bytes, &mask, sizeof(mask));
+
+        for(; i < size; ++i)
+        {
+            data[i] ^= bytes[i % 4];
+        }
+    }
+
+    /// @ingroup symbol_storage_layers
+    /// @brief Maps the block of a prime2325 encoder to field elements.
+    ///
+    /// When the symbols are set the layer finds a mask with the
+    /// prime2325_mask_search and applies it to the symbol storage. The
+    /// mask must be delivered to the decoders, e.g. with the object
+    /// description, which unmap the data with the
+    /// prime2325_mapping_decoder. Symbols set individually with
+    /// set_symbol() are not mapped.
+    ///
+    /// The layer is placed above the payload layers of an encoder
+    /// using mutable deep symbol storage.
+    template<class SuperCoder>
+    class prime2325_mapping_encoder : public SuperCoder
+    {
+    public:
+
+        static_assert(std::is_same<typename SuperCoder::field_type,
+                                   fifi::prime2325>::value,
+                      "The mapping is only used with the prime2325 field");
+
+    public:
+
+        /// Constructor
+        prime2325_mapping_encoder()
+            : m_mask(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_mask = 0;
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            SuperCoder::set_symbols(symbol_storage);
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            prime2325_mask_search search(symbols * (symbol_size / 4));
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                search.insert(SuperCoder::symbol(i), symbol_size);
+            }
+
+            m_mask = search.mask();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                prime2325_apply_mask(SuperCoder::symbol(i), symbol_size,
+                                     m_mask);
+            }
+        }
+
+        /// @return The mask applied to the symbols, which the decoders
+        ///         set with prime2325_mapping_decoder::set_prime2325_mask()
+        uint32_t prime2325_mask() const
+        {
+            return m_mask;
+        }
+
+    protected:
+
+        /// The mask applied to the symbols
+        uint32_t m_mask;
+
+    };
+
+    /// @ingroup symbol_storage_layers
+    /// @brief Unmaps the data of a block mapped by the
+    ///        prime2325_mapping_encoder when it is copied out of a
+    ///        decoder.
+    ///
+    /// The symbol storage of the decoder holds the mapped elements,
+    /// the mask is only applied to the copies.
+    template<class SuperCoder>
+    class prime2325_mapping_decoder : public SuperCoder
+    {
+    public:
+
+        static_assert(std::is_same<typename SuperCoder::field_type,
+                                   fifi::prime2325>::value,
+                      "The mapping is only used with the prime2325 field");
+
+    public:
+
+        /// Constructor
+        prime2325_mapping_decoder()
+            : m_mask(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_mask = 0;
+        }
+
+        /// Sets the mask used by the encoder of the block
+        /// @param mask The mask from
+        ///        prime2325_mapping_encoder::prime2325_mask()
+        void set_prime2325_mask(uint32_t mask)
+        {
+            m_mask = mask;
+        }
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        void copy_symbols(const sak::mutable_storage &dest_storage)
+        {
+            SuperCoder::copy_symbols(dest_storage);
+
+            uint32_t size =
+                std::min(dest_storage.m_size, SuperCoder::block_size());
+
+            prime2325_apply_mask(dest_storage.m_data, size, m_mask);
+        }
+
+        /// @copydoc layer::copy_symbol(uint32_t,
+        ///                             const sak::mutable_storage&)
+        void copy_symbol(uint32_t index,
+                         const sak::mutable_storage &dest) const
+        {
+            SuperCoder::copy_symbol(index, dest);
+
+            uint32_t size = std::min(dest.m_size, SuperCoder::symbol_size());
+            prime2325_apply_mask(dest.m_data, size, m_mask);
+        }
+
+    protected:
+
+        /// The mask applied by the encoder
+        uint32_t m_mask;
+
+    };
+
+}
@@ -0,0 +1,281 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include "cycle_counter.hpp"
+#include "operations_profile.hpp"
+
+namespace kodo
+{
+
+    /// The costs of the calls made through one profiling_layer
+    struct layer_profile
+    {
+
+        /// Constructs a new profile timing no calls
+        layer_profile()
+            : m_sample_interval(0)
+        { }
+
+        /// @return The estimated ticks of all the calls, the sum of the
+        ///         estimates of the functions
+        double estimated_ticks() const
+        {
+            return m_encode.estimated_ticks() +
+                m_decode.estimated_ticks() +
+                m_encode_symbol.estimated_ticks() +
+                m_decode_symbol.estimated_ticks() +
+                m_encode_uncoded.estimated_ticks() +
+                m_decode_uncoded.estimated_ticks() +
+                m_read_id.estimated_ticks() +
+                m_write_id.estimated_ticks();
+        }
+
+        /// Clears the costs, keeping the sample interval
+        void reset()
+        {
+            uint32_t interval = m_sample_interval;
+            *this = layer_profile();
+            m_sample_interval = interval;
+        }
+
+        /// The cost of encode(), the bytes are the symbol bytes
+        operation_cost m_encode;
+
+        /// The cost of decode(), the bytes are the symbol bytes
+        operation_cost m_decode;
+
+        /// The cost of encode_symbol() with coefficients
+        operation_cost m_encode_symbol;
+
+        /// The cost of decode_symbol() with coefficients
+        operation_cost m_decode_symbol;
+
+        /// The cost of encode_symbol() of an uncoded symbol
+        operation_cost m_encode_uncoded;
+
+        /// The cost of decode_symbol() of an uncoded symbol
+        operation_cost m_decode_uncoded;
+
+        /// The cost of read_id(), no bytes are counted
+        operation_cost m_read_id;
+
+        /// The cost of write_id(), no bytes are counted
+        operation_cost m_write_id;
+
+        /// Every n'th call of a function is timed with the cycle
+        /// counter, zero if no call is timed
+        uint32_t m_sample_interval;
+
+    };
+
+    /// @ingroup debug
+    /// @brief Counts and samples the cycle cost of the calls to the
+    ///        layers below it, wherever it is placed in a stack.
+    ///
+    /// Contrary to the finite_field_counter, which only sees the math
+    /// layer, the layer intercepts the payload, codec header, symbol id
+    /// and codec API: encode(), decode(), read_id(), write_id(),
+    /// encode_symbol() and decode_symbol(), i.e. all overloads of these
+    /// functions, so it may be placed between any two layers, e.g.
+    /// between the payload_decoder and the systematic_decoder and again
+    /// around the symbol_id_decoder:
+    ///
+    /// @code
+    ///   payload_decoder<
+    ///   profiling_layer<payload_tag,
+    ///   systematic_decoder<
+    ///   symbol_id_decoder<
+    ///   profiling_layer<symbol_id_tag,
+    ///   plain_symbol_id_reader< ...
+    /// @endcode
+    ///
+    /// The Tag tells the layers of a stack apart, see
+    /// kodo::layer_costs<Tag>(coder). The costs are inclusive, they
+    /// contain the layers below, so the share of a layer is the
+    /// difference to the next profiling layer below it. Every n'th call
+    /// of a function is timed, see layer_profile::m_sample_interval,
+    /// and the costs are cleared when the coder is initialized.
+    template<class Tag, class SuperCoder>
+    class profiling_layer : public SuperCoder
+    {
+    public:
+
+        /// The tag of the layer
+        typedef Tag profiling_tag;
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_profile.reset();
+        }
+
+        /// @copydoc layer::encode(uint8_t*)
+        uint32_t encode(uint8_t *payload)
+        {
+            uint32_t used = 0;
+
+            measure(m_profile.m_encode, [&]()
+                { used = SuperCoder::encode(payload); });
+
+            return used;
+        }
+
+        /// @copydoc layer::encode(uint8_t*, uint8_t*)
+        uint32_t encode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            uint32_t used = 0;
+
+            measure(m_profile.m_encode, [&]()
+                { used = SuperCoder::encode(symbol_data, symbol_header); });
+
+            return used;
+        }
+
+        /// @copydoc layer::decode(uint8_t*)
+        void decode(uint8_t *payload)
+        {
+            measure(m_profile.m_decode, [&]()
+                { SuperCoder::decode(payload); });
+        }
+
+        /// @copydoc layer::decode(uint8_t*, uint8_t*)
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            measure(m_profile.m_decode, [&]()
+                { SuperCoder::decode(symbol_data, symbol_header); });
+        }
+
+        /// @copydoc layer::encode_symbol(uint8_t*, uint8_t*)
+        void encode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            measure(m_profile.m_encode_symbol, [&]()
+                { SuperCoder::encode_symbol(symbol_data, coefficients); });
+        }
+
+        /// @copydoc layer::encode_symbol(uint8_t*,uint32_t)
+        void encode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            measure(m_profile.m_encode_uncoded, [&]()
+                { SuperCoder::encode_symbol(symbol_data, symbol_index); });
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            measure(m_profile.m_decode_symbol, [&]()
+                { SuperCoder::decode_symbol(symbol_data, coefficients); });
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            measure(m_profile.m_decode_uncoded, [&]()
+                { SuperCoder::decode_symbol(symbol_data, symbol_index); });
+        }
+
+        /// @copydoc layer::read_id(uint8_t*, uint8_t**)
+        void read_id(uint8_t *symbol_id, uint8_t **coefficients)
+        {
+            measure(m_profile.m_read_id, [&]()
+                { SuperCoder::read_id(symbol_id, coefficients); }, 0);
+        }
+
+        /// @copydoc layer::write_id(uint8_t*, uint8_t**)
+        uint32_t write_id(uint8_t *symbol_id, uint8_t **coefficients)
+        {
+            uint32_t used = 0;
+
+            measure(m_profile.m_write_id, [&]()
+                { used = SuperCoder::write_id(symbol_id, coefficients); },
+                0);
+
+            return used;
+        }
+
+        /// @return The costs of the calls through this layer
+        const layer_profile& costs() const
+        {
+            return m_profile;
+        }
+
+        /// @return The costs of the calls through this layer, e.g. to
+        ///         set the sample interval
+        layer_profile& costs()
+        {
+            return m_profile;
+        }
+
+    private:
+
+        /// Records the cost of a call and makes it
+        /// @param cost The cost of the function
+        /// @param function The call
+        /// @param bytes The bytes processed by the call
+        template<class Function>
+        void measure(operation_cost &cost, const Function &function,
+                     uint32_t bytes)
+        {
+            ++cost.m_calls;
+            cost.m_bytes += bytes;
+
+            uint32_t interval = m_profile.m_sample_interval;
+
+            if(interval == 0 || cost.m_calls % interval != 0)
+            {
+                function();
+                return;
+            }
+
+            uint64_t start = read_cycle_counter();
+            function();
+            uint64_t stop = read_cycle_counter();
+
+            ++cost.m_samples;
+            cost.m_sampled_ticks += stop - start;
+        }
+
+        /// Records the cost of a call processing a symbol
+        /// @param cost The cost of the function
+        /// @param function The call
+        template<class Function>
+        void measure(operation_cost &cost, const Function &function)
+        {
+            measure(cost, function, SuperCoder::symbol_size());
+        }
+
+    private:
+
+        /// The costs of the calls
+        layer_profile m_profile;
+
+    };
+
+    /// @param layer The profiling layer with the tag, found in a coder by
+    ///        the conversion to its base class
+    /// @return The profiling layer
+    template<class Tag, class SuperCoder>
+    inline profiling_layer<Tag, SuperCoder>& find_profiling_layer(
+        profiling_layer<Tag, SuperCoder> &layer)
+    {
+        return layer;
+    }
+
+    /// @param coder A coder with a profiling_layer with the tag
+    /// @return The costs of the calls through the layer
+    template<class Tag, class Coder>
+    inline layer_profile& layer_costs(Coder &coder)
+    {
+        return find_profiling_layer<Tag>(coder).costs();
+    }
+
+}
@@ -373,6 +373,47 @@ namespace kodo
                                   coefficient, symbol_length);
         }
 
+        /// @copydoc layer::multiply_copy(value_type*, const value_type*,
+        ///                              value_type, uint32_t)
+        void multiply_copy(
+            value_type *symbol_dest, const value_type *symbol_src,
+            value_type coefficient, uint32_t symbol_length)
+        {
+            assert(m_proxy);
+            m_proxy->multiply_copy(symbol_dest, symbol_src,
+                                   coefficient, symbol_length);
+        }
+
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(
+            value_type *symbol_dest, const value_type **symbols_src,
+            const value_type *coefficients, uint32_t sources,
+            uint32_t symbol_length)
+        {
+            assert(m_proxy);
+            m_proxy->multiply_add_sources(symbol_dest, symbols_src,
+                                          coefficients, sources,
+                                          symbol_length);
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(
+            value_type *symbol_dest, const value_type **symbols_src,
+            const value_type *coefficients, uint32_t sources,
+            uint32_t symbol_length)
+        {
+            assert(m_proxy);
+            m_proxy->multiply_sources(symbol_dest, symbols_src,
+                                      coefficients, sources,
+                                      symbol_length);
+        }
+
         /// @copydoc layer::add(value_type*, const value_type *, uint32_t)
         void add(value_type *symbol_dest, const value_type *symbol_src,
                  uint32_t symbol_length)
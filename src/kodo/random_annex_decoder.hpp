@@ -10,8 +10,6 @@
 
 #include <boost/make_shared.hpp>
 #include <boost/noncopyable.hpp>
-#include <boost/function.hpp>
-#include <boost/bind.hpp>
 
 #include <sak/storage.hpp>
 
@@ -47,11 +45,41 @@ namespace kodo
         /// The annex iterator type
         typedef typename std::set<annex_info>::iterator annex_iterator;
 
-        /// The callback function to invoke when a decoder completes
-        typedef boost::function<void ()> is_complete_handler;
-
     public:
 
+        /// The callback to invoke when a decoder completes. The handler
+        /// only holds the random annex decoder and the decoder id, so
+        /// it is copied on every access to a decoder without
+        /// allocating
+        class is_complete_handler
+        {
+        public:
+
+            is_complete_handler()
+                : m_decoder(0),
+                  m_decoder_id(0)
+                { }
+
+            is_complete_handler(random_annex_decoder *decoder,
+                                uint32_t decoder_id)
+                : m_decoder(decoder),
+                  m_decoder_id(decoder_id)
+                { }
+
+            void operator()() const
+                {
+                    assert(m_decoder);
+                    m_decoder->decoder_complete(m_decoder_id);
+                }
+
+        private:
+
+            random_annex_decoder *m_decoder;
+
+            uint32_t m_decoder_id;
+
+        };
+
         class call_proxy
         {
         public:
@@ -304,9 +332,7 @@ namespace kodo
 
                     decoder->set_bytes_used(bytes_used);
 
-                    is_complete_handler handler =
-                        boost::bind(&random_annex_decoder::decoder_complete,
-                                    this, i);
+                    is_complete_handler handler(this, i);
 
                     wrap_coder wrap(decoder, handler);
 
@@ -0,0 +1,275 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Tracks the rank of the coding coefficients received by a
+    ///        decoder without storing or decoding any symbol data.
+    ///
+    /// Components which only need to know whether a symbol would be
+    /// innovative, e.g. a sender simulating its receivers or the
+    /// probability benchmarks, would otherwise build a full decoder
+    /// with storage for the block. This layer only keeps the
+    /// coefficient vectors in echelon form: a received vector is
+    /// reduced by the stored vector of every pivot column where it is
+    /// non-zero, and if a non-zero column without a pivot remains the
+    /// normalized vector is stored with that column as its pivot. No
+    /// backward substitution is done, as the stored vectors are never
+    /// used to solve the block.
+    ///
+    /// The coefficients are read from symbol ids through the read_id()
+    /// of the symbol id layer below, so the same stack works with the
+    /// plain, seed and Reed-Solomon symbol ids. The stored vectors are
+    /// kept in the coefficient_storage layer.
+    template<class SuperCoder>
+    class rank_tracker : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename field_type::value_type value_type;
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_pivots.resize(the_factory.max_symbols(), false);
+            m_scratch.resize(the_factory.max_coefficients_size());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill_n(m_pivots.begin(), the_factory.symbols(), false);
+            m_rank = 0;
+        }
+
+        /// Adds a coefficient vector, the vector is modified
+        /// @param coefficients The coefficients of the symbol
+        /// @return True if the vector increased the rank
+        bool decode_coefficients(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            return eliminate(reinterpret_cast<value_type*>(coefficients),
+                             true);
+        }
+
+        /// @param coefficients The coefficients of the symbol, they are
+        ///        not modified
+        /// @return True if the vector would increase the rank
+        bool is_innovative(const uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            std::copy_n(coefficients, SuperCoder::coefficients_size(),
+                        m_scratch.begin());
+
+            return eliminate(
+                reinterpret_cast<value_type*>(&m_scratch[0]), false);
+        }
+
+        /// Adds the coefficients of a symbol id
+        /// @param symbol_id The symbol id
+        /// @return True if the symbol increased the rank
+        bool decode_id(uint8_t *symbol_id)
+        {
+            assert(symbol_id != 0);
+
+            uint8_t *coefficients = 0;
+            SuperCoder::read_id(symbol_id, &coefficients);
+
+            return decode_coefficients(coefficients);
+        }
+
+        /// Note that a seed reader rejecting duplicate seeds records
+        /// the seed, so the symbol id would be rejected by a following
+        /// decode_id()
+        /// @param symbol_id The symbol id
+        /// @return True if the symbol would increase the rank
+        bool is_innovative_id(uint8_t *symbol_id)
+        {
+            assert(symbol_id != 0);
+
+            uint8_t *coefficients = 0;
+            SuperCoder::read_id(symbol_id, &coefficients);
+
+            return is_innovative(coefficients);
+        }
+
+        /// Adds the coefficients of several symbol ids
+        /// @param symbol_ids The symbol ids
+        /// @param count The number of symbol ids
+        /// @return The number of symbols which increased the rank
+        uint32_t decode_ids(uint8_t **symbol_ids, uint32_t count)
+        {
+            assert(symbol_ids != 0);
+
+            uint32_t innovative = 0;
+
+            for(uint32_t i = 0; i < count && !is_complete(); ++i)
+            {
+                if(decode_id(symbol_ids[i]))
+                {
+                    ++innovative;
+                }
+            }
+
+            return innovative;
+        }
+
+        /// Adds an uncoded symbol, e.g. a systematic symbol
+        /// @param symbol_index The index of the symbol
+        /// @return True if the symbol increased the rank
+        bool decode_uncoded(uint32_t symbol_index)
+        {
+            assert(symbol_index < SuperCoder::symbols());
+
+            std::fill_n(m_scratch.begin(), SuperCoder::coefficients_size(),
+                        0);
+
+            value_type *coefficients =
+                reinterpret_cast<value_type*>(&m_scratch[0]);
+
+            fifi::set_value<field_type>(coefficients, symbol_index, 1U);
+
+            return eliminate(coefficients, true);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_rank == SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_rank;
+        }
+
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_pivots[index];
+        }
+
+    protected:
+
+        /// Reduces a vector by the stored vectors
+        /// @param coefficients The vector to reduce
+        /// @param store If true an innovative vector is stored
+        /// @return True if the vector is innovative
+        bool eliminate(value_type *coefficients, bool store)
+        {
+            assert(coefficients != 0);
+
+            if(is_complete())
+            {
+                return false;
+            }
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t length = SuperCoder::coefficients_length();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                value_type coefficient =
+                    fifi::get_value<field_type>(coefficients, i);
+
+                if(!coefficient)
+                {
+                    continue;
+                }
+
+                if(!m_pivots[i])
+                {
+                    if(store)
+                    {
+                        store_vector(coefficients, coefficient, i);
+                    }
+
+                    return true;
+                }
+
+                const value_type *vector_i =
+                    SuperCoder::coefficients_value(i);
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::subtract(coefficients, vector_i, length);
+                }
+                else
+                {
+                    SuperCoder::multiply_subtract(
+                        coefficients, vector_i, coefficient, length);
+                }
+            }
+
+            return false;
+        }
+
+        /// Normalizes and stores a vector with a new pivot
+        /// @param coefficients The reduced vector
+        /// @param coefficient The coefficient of the pivot column
+        /// @param pivot The pivot column
+        void store_vector(value_type *coefficients, value_type coefficient,
+                          uint32_t pivot)
+        {
+            assert(!m_pivots[pivot]);
+
+            uint32_t length = SuperCoder::coefficients_length();
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                SuperCoder::multiply(coefficients,
+                                     SuperCoder::invert(coefficient),
+                                     length);
+            }
+
+            std::copy_n(coefficients, length,
+                        SuperCoder::coefficients_value(pivot));
+
+            m_pivots[pivot] = true;
+            ++m_rank;
+        }
+
+    protected:
+
+        /// Tracks the columns with a stored vector
+        std::vector<bool> m_pivots;
+
+        /// Buffer for the vectors which are not stored
+        std::vector<uint8_t> m_scratch;
+
+        /// The number of stored vectors
+        uint32_t m_rank;
+
+    };
+
+}
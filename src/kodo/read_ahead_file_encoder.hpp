@@ -0,0 +1,65 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include "object_encoder.hpp"
+#include "read_ahead_file_reader.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief A read-ahead file encoder creates a number of encoders
+    ///        over the data of a file, reading the following blocks in
+    ///        the background.
+    ///
+    /// Same as the file_encoder but the blocks are read ahead on an
+    /// I/O thread, see read_ahead_file_reader.
+    template
+    <
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class read_ahead_file_encoder : public
+            object_encoder
+            <
+                read_ahead_file_reader<EncoderType, BlockPartitioning>,
+                EncoderType,
+                BlockPartitioning
+            >
+    {
+    public:
+
+        /// The encoder factory type
+        typedef typename EncoderType::factory factory;
+
+        /// The reader type
+        typedef read_ahead_file_reader<EncoderType, BlockPartitioning>
+            reader_type;
+
+    public:
+
+        /// Constructs a new read-ahead file encoder
+        /// @param factory the encoder factory to use
+        /// @param filename the file to encode
+        /// @param depth the number of blocks to read ahead
+        read_ahead_file_encoder(typename EncoderType::factory &factory,
+                                const std::string &filename,
+                                uint32_t depth = 4)
+            : object_encoder
+                  <
+                  reader_type,
+                  EncoderType,
+                  BlockPartitioning
+                  >
+              (factory, reader_type(
+                  filename,
+                  factory.max_symbols(),
+                  factory.max_symbol_size(),
+                  depth))
+            { }
+    };
+}
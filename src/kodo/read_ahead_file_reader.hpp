@@ -0,0 +1,393 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "has_deep_symbol_storage.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup object_data_implementation
+    ///
+    /// @brief File reader which reads the following blocks of a file
+    ///        on a background thread while the current block is being
+    ///        encoded.
+    ///
+    /// The file_reader reads a block when the encoder is built, so a
+    /// sender stalls on the disk at every block boundary. This reader
+    /// uses the same block partitioning as the object encoder, and after
+    /// block i has been read it queues blocks i+1 to i+depth on an I/O
+    /// thread. When the encoder for one of these blocks is built the
+    /// data is swapped into the encoder without waiting for the disk.
+    /// Blocks requested out of order are read as soon as the I/O thread
+    /// is idle, and read-ahead then continues from that block.
+    ///
+    /// The blocks are read into a pool of depth + 1 buffers, which are
+    /// swapped with the buffers of the encoders. Like the file_reader
+    /// this only works with deep_symbol_storage encoders.
+    template
+    <
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class read_ahead_file_reader
+    {
+    public:
+
+        static_assert(has_deep_symbol_storage<EncoderType>::value,
+                      "Read-ahead file reader only works with encoders "
+                      "using deep storage");
+
+    public:
+
+        /// Pointer to the encoders
+        typedef typename EncoderType::pointer pointer;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+    public:
+
+        /// Construct a new read-ahead file reader
+        /// @param filename of the file to use
+        /// @param max_symbols the maximum number of symbols of the
+        ///        encoder factory used by the object encoder
+        /// @param max_symbol_size the maximum symbol size of the encoder
+        ///        factory used by the object encoder
+        /// @param depth the number of blocks to read ahead
+        read_ahead_file_reader(const std::string &filename,
+                               uint32_t max_symbols,
+                               uint32_t max_symbol_size,
+                               uint32_t depth)
+            : m_state(boost::make_shared<state>(
+                          filename, max_symbols, max_symbol_size, depth))
+        { }
+
+        /// @return the size in bytes of the file
+        uint64_t size() const
+        {
+            return m_state->m_file_size;
+        }
+
+        /// Initializes the encoder with data from the file.
+        /// @param encoder to be initialized
+        /// @param offset in bytes into the file, must be the offset of
+        ///        a block
+        /// @param size the number of bytes to use
+        void read(pointer &encoder, uint64_t offset, uint32_t size)
+        {
+            assert(encoder);
+            assert(offset < m_state->m_file_size);
+            assert(size > 0);
+
+            uint32_t block = m_state->block_index(offset);
+            assert(size == m_state->m_partitioning.bytes_used(block));
+
+            std::vector<uint8_t> data = m_state->take_block(block);
+            uint32_t data_size = data.size();
+
+            encoder->swap_symbols(data);
+
+            // Check that the swapped vector has the same size
+            assert(data.size() == data_size);
+            (void) data_size;
+
+            m_state->release_buffer(data);
+
+            // We require that encoders includes the has_bytes_used
+            // layer to support partially filled encoders
+            encoder->set_bytes_used(size);
+        }
+
+    private:
+
+        /// The state shared between the copies of a reader and the I/O
+        /// thread
+        class state : boost::noncopyable
+        {
+        public:
+
+            /// @copydoc read_ahead_file_reader::read_ahead_file_reader(
+            ///     const std::string&,uint32_t,uint32_t,uint32_t)
+            state(const std::string &filename, uint32_t max_symbols,
+                  uint32_t max_symbol_size, uint32_t depth)
+                : m_depth(depth),
+                  m_reading(false),
+                  m_stop(false)
+            {
+                assert(depth > 0);
+
+                m_file.open(filename, std::ios::binary);
+                assert(m_file.is_open());
+
+                m_file.seekg(0, std::ios::end);
+                auto position = m_file.tellg();
+                assert(position >= 0);
+
+                m_file_size = static_cast<uint64_t>(position);
+                assert(m_file_size > 0);
+
+                m_partitioning = block_partitioning(
+                    max_symbols, max_symbol_size, m_file_size);
+
+                for(uint32_t i = 0; i < m_partitioning.blocks(); ++i)
+                {
+                    m_offsets.push_back(m_partitioning.byte_offset(i));
+                }
+
+                uint32_t data_size = max_symbols * max_symbol_size;
+                assert(data_size > 0);
+
+                m_free.resize(depth + 1, std::vector<uint8_t>(data_size));
+
+                // Start reading the first blocks right away
+                for(uint32_t i = 0; i < depth && i < m_offsets.size(); ++i)
+                {
+                    m_requests.push_back(i);
+                }
+
+                m_thread = std::thread(&state::work, this);
+            }
+
+            /// Stops and joins the I/O thread
+            ~state()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+
+                m_io.notify_all();
+                m_thread.join();
+            }
+
+            /// @param offset The byte offset of a block
+            /// @return The index of the block
+            uint32_t block_index(uint64_t offset) const
+            {
+                auto it = std::lower_bound(
+                    m_offsets.begin(), m_offsets.end(), offset);
+
+                assert(it != m_offsets.end());
+                assert(*it == offset);
+
+                return static_cast<uint32_t>(it - m_offsets.begin());
+            }
+
+            /// Waits for a block to be read and queues the following
+            /// blocks
+            /// @param block The block index
+            /// @return The buffer with the data of the block
+            std::vector<uint8_t> take_block(uint32_t block)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+
+                uint32_t end = std::min<uint32_t>(
+                    block + m_depth + 1, m_offsets.size());
+
+                // Drop the requests outside the new read-ahead window
+                m_requests.clear();
+
+                if(!is_pending(block))
+                {
+                    m_requests.push_back(block);
+                }
+
+                for(uint32_t i = block + 1; i < end; ++i)
+                {
+                    if(!is_pending(i))
+                    {
+                        m_requests.push_back(i);
+                    }
+                }
+
+                while(m_ready.find(block) == m_ready.end())
+                {
+                    // Recycling the buffers outside the window ensures
+                    // that the pool has a buffer for the requested block
+                    recycle_buffers(block, end);
+
+                    m_io.notify_all();
+                    m_done.wait(lock);
+                }
+
+                std::vector<uint8_t> data;
+                data.swap(m_ready[block]);
+                m_ready.erase(block);
+
+                return data;
+            }
+
+            /// Returns a buffer to the pool
+            /// @param buffer The buffer
+            void release_buffer(std::vector<uint8_t> &buffer)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_free.push_back(std::vector<uint8_t>());
+                m_free.back().swap(buffer);
+
+                m_io.notify_all();
+            }
+
+        private:
+
+            /// Returns the buffers of blocks which have been read but are
+            /// outside the read-ahead window to the pool
+            /// @param begin The first block of the window
+            /// @param end The block after the last block of the window
+            void recycle_buffers(uint32_t begin, uint32_t end)
+            {
+                for(auto it = m_ready.begin(); it != m_ready.end();)
+                {
+                    if(it->first < begin || it->first >= end)
+                    {
+                        m_free.push_back(std::vector<uint8_t>());
+                        m_free.back().swap(it->second);
+                        it = m_ready.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+
+            /// @param block The block index
+            /// @return true if the block is read or being read
+            bool is_pending(uint32_t block) const
+            {
+                return m_ready.find(block) != m_ready.end() ||
+                    (m_reading && m_reading_block == block);
+            }
+
+            /// The I/O thread function
+            void work()
+            {
+                while(true)
+                {
+                    std::vector<uint8_t> buffer;
+                    uint32_t block;
+
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+
+                        m_io.wait(lock, [this] {
+                            return m_stop ||
+                                (!m_requests.empty() && !m_free.empty()); });
+
+                        if(m_stop)
+                        {
+                            return;
+                        }
+
+                        block = m_requests.front();
+                        m_requests.pop_front();
+
+                        buffer.swap(m_free.back());
+                        m_free.pop_back();
+
+                        m_reading = true;
+                        m_reading_block = block;
+                    }
+
+                    uint64_t offset = m_partitioning.byte_offset(block);
+                    uint32_t size = m_partitioning.bytes_used(block);
+                    assert(size <= buffer.size());
+
+                    m_file.seekg(static_cast<std::streamoff>(offset),
+                                 std::ios::beg);
+                    assert(m_file);
+
+                    m_file.read(reinterpret_cast<char*>(&buffer[0]), size);
+                    assert(size == static_cast<uint32_t>(m_file.gcount()));
+
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+
+                        m_ready[block].swap(buffer);
+                        m_reading = false;
+                    }
+
+                    m_done.notify_all();
+                }
+            }
+
+        public:
+
+            /// The size of the file in bytes
+            uint64_t m_file_size;
+
+            /// The block partitioning scheme used
+            block_partitioning m_partitioning;
+
+        private:
+
+            /// The number of blocks to read ahead
+            uint32_t m_depth;
+
+            /// The file, only used by the I/O thread after construction
+            std::ifstream m_file;
+
+            /// The byte offsets of the blocks
+            std::vector<uint64_t> m_offsets;
+
+            /// Protects the buffers and requests
+            std::mutex m_mutex;
+
+            /// Signals the I/O thread
+            std::condition_variable m_io;
+
+            /// Signals that a block has been read
+            std::condition_variable m_done;
+
+            /// The blocks to read in order
+            std::deque<uint32_t> m_requests;
+
+            /// The blocks which have been read
+            std::map<uint32_t, std::vector<uint8_t> > m_ready;
+
+            /// The unused buffers
+            std::vector<std::vector<uint8_t> > m_free;
+
+            /// True while the I/O thread reads a block
+            bool m_reading;
+
+            /// The block being read
+            uint32_t m_reading_block;
+
+            /// True when the I/O thread should stop
+            bool m_stop;
+
+            /// The I/O thread
+            std::thread m_thread;
+        };
+
+    private:
+
+        /// The shared state
+        boost::shared_ptr<state> m_state;
+
+    };
+
+}
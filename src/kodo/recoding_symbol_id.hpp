@@ -6,18 +6,49 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <vector>
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
+#include <sak/is_aligned.hpp>
+#include <sak/storage.hpp>
+
 #include <fifi/fifi_utils.hpp>
 
+#include "thread_scratch.hpp"
+
 namespace kodo
 {
 
+    /// Tag of the thread_scratch buffer holding the recoding
+    /// coefficients of the recoding_symbol_id layer
+    struct recoding_coefficients_scratch { };
+
+    /// Tag of the thread_scratch buffer holding the recoded symbol id
+    /// of the recoding_symbol_id layer when the payload is not aligned
+    struct recoding_id_scratch { };
+
     /// @ingroup symbol_id_layers
     /// @brief Randomly recombines existing coding coefficients to
     ///        allow a decoder to produce recoded packets.
+    ///
+    /// The recoding coefficients and the recoded id are kept in the
+    /// scratch memory of the thread, so the coefficients returned by
+    /// write_id() are valid until the next call to write_id() of a
+    /// recoder on the same thread.
+    ///
+    /// By default every stored symbol is combined with a coefficient
+    /// from the generator, so the recoded symbols are dense even if the
+    /// received ones are sparse. With factory::set_recoding_rows() each
+    /// recoded symbol instead combines a few stored symbols picked at
+    /// random, with random non-zero coefficients, so a relay forwarding
+    /// the symbols of e.g. the sparse_full_rlnc_encoder keeps them
+    /// sparse for the decoders downstream. The density of these recoded
+    /// symbol ids is tracked, see recoded_density(). The rows and
+    /// coefficients are drawn from a generator seeded with the
+    /// coefficient generator below, see seed().
     template<class SuperCoder>
     class recoding_symbol_id : public SuperCoder
     {
@@ -29,6 +60,9 @@ namespace kodo
         /// @copydoc layer::field_type
         typedef typename SuperCoder::field_type field_type;
 
+        /// @copydoc layer::seed_type
+        typedef typename SuperCoder::seed_type seed_type;
+
     public:
 
         /// @ingroup factory_layers
@@ -39,7 +73,8 @@ namespace kodo
 
             /// @copydoc layer::factory::factory(uint32_t,uint32_t)
             factory(uint32_t max_symbols, uint32_t max_symbol_size)
-                : SuperCoder::factory(max_symbols, max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_recoding_rows(0)
             { }
 
             /// @copydoc layer::factory::max_id_size() const
@@ -48,18 +83,44 @@ namespace kodo
                 return SuperCoder::factory::max_coefficients_size();
             }
 
+            /// Sets the number of stored symbols combined in a recoded
+            /// symbol, used by the recoders initialized afterwards
+            /// @param rows The number of stored symbols, zero to combine
+            ///        all stored symbols with coefficients from the
+            ///        generator
+            void set_recoding_rows(uint32_t rows)
+            {
+                m_recoding_rows = rows;
+            }
+
+            /// @return The number of stored symbols combined in a
+            ///         recoded symbol, zero for all
+            uint32_t recoding_rows() const
+            {
+                return m_recoding_rows;
+            }
+
+        private:
+
+            /// The number of stored symbols combined in a recoded symbol
+            uint32_t m_recoding_rows;
+
         };
 
     public:
 
+        /// Constructor
+        recoding_symbol_id()
+            : m_value_distribution(1, field_type::max_value)
+        { }
+
         /// @copydoc layer::construct(Factory&)
         template<class Factory>
         void construct(Factory& the_factory)
         {
             SuperCoder::construct(the_factory);
 
-            m_coefficients.resize(the_factory.max_coefficients_size());
-            m_recode_id.resize(the_factory.max_coefficients_size());
+            m_stored_rows.reserve(the_factory.max_symbols());
         }
 
         /// @copydoc layer::initialize(Factory&)
@@ -70,6 +131,10 @@ namespace kodo
 
             m_id_size = SuperCoder::coefficients_size();
             assert(m_id_size > 0);
+
+            m_recoding_rows = the_factory.recoding_rows();
+            m_recoded = 0;
+            m_recoded_nonzeros = 0;
         }
 
         /// Will write the recoded encoding vector (symbol id) into the
@@ -83,13 +148,6 @@ namespace kodo
             assert(symbol_id != 0);
             assert(coefficients != 0);
 
-            // Zero the symbol id
-            std::fill_n(m_recode_id.begin(), m_id_size, 0);
-
-            // Prepare the symbol id storage
-            sak::mutable_storage id_storage =
-                sak::storage(symbol_id, m_id_size);
-
             // Check the number of symbols stored
             uint32_t symbol_count = SuperCoder::rank();
 
@@ -97,27 +155,122 @@ namespace kodo
             {
                 // Nothing we can do - we just return the zero'ed
                 // symbol coefficients and id
+                std::fill_n(symbol_id, m_id_size, 0);
                 *coefficients = symbol_id;
-                sak::copy_storage(
-                    id_storage, sak::storage(&m_recode_id[0], m_id_size));
 
                 return m_id_size;
             }
+
+            uint8_t *coefficients_buffer =
+                thread_scratch<recoding_coefficients_scratch>::data(
+                    m_id_size);
+
+            bool sparse = m_recoding_rows > 0;
+
+            if(sparse)
+            {
+                generate_sparse(coefficients_buffer);
+            }
             else if(symbol_count < SuperCoder::symbols())
             {
-                SuperCoder::generate_partial(&m_coefficients[0]);
+                SuperCoder::generate_partial(coefficients_buffer);
             }
             else
             {
-                SuperCoder::generate(&m_coefficients[0]);
+                SuperCoder::generate(coefficients_buffer);
+            }
+
+            // The recoded id is built directly in the payload, unless
+            // the payload is not aligned for the field operations
+            uint8_t *recode_buffer = symbol_id;
+
+            if(sak::is_aligned(symbol_id) == false)
+            {
+                recode_buffer =
+                    thread_scratch<recoding_id_scratch>::data(m_id_size);
             }
 
             // Create the recoded symbol id
             value_type *recode_id
-                = reinterpret_cast<value_type*>(&m_recode_id[0]);
+                = reinterpret_cast<value_type*>(recode_buffer);
 
             value_type *recode_coefficients
-                = reinterpret_cast<value_type*>(&m_coefficients[0]);
+                = reinterpret_cast<value_type*>(coefficients_buffer);
+
+            build_recode_id(recode_id, recode_coefficients);
+
+            if(recode_buffer != symbol_id)
+            {
+                sak::copy_storage(sak::storage(symbol_id, m_id_size),
+                                  sak::storage(recode_buffer, m_id_size));
+            }
+
+            // The scan over the id is only spent where the density is of
+            // interest, a dense recoded id is dense anyway
+            if(sparse)
+            {
+                count_nonzeros(recode_id);
+            }
+
+            *coefficients = coefficients_buffer;
+
+            return m_id_size;
+        }
+
+
+        /// @copydoc layer::id_size()
+        uint32_t id_size() const
+        {
+            return m_id_size;
+        }
+
+        /// @return The number of stored symbols combined in a recoded
+        ///         symbol, zero for all
+        uint32_t recoding_rows() const
+        {
+            return m_recoding_rows;
+        }
+
+        /// Seeds the coefficient generator and the generator picking the
+        /// recoded rows
+        /// @copydoc layer::seed(seed_type)
+        void seed(seed_type seed_value)
+        {
+            SuperCoder::seed(seed_value);
+            m_random_generator.seed(seed_value);
+        }
+
+        /// @return The average fraction of non-zero coefficients in the
+        ///         ids of the symbols recoded from recoding_rows() rows
+        ///         since the recoder was initialized, zero if none were
+        ///         recoded or all stored symbols are combined
+        double recoded_density() const
+        {
+            if(m_recoded == 0)
+            {
+                return 0.0;
+            }
+
+            return m_recoded_nonzeros /
+                (double(m_recoded) * SuperCoder::symbols());
+        }
+
+    protected:
+
+        /// Combines the coefficient vectors of the stored symbols. The
+        /// first vector used is written to the recoded id with
+        /// multiply_copy(), so the id is not zeroed before the other
+        /// vectors are added.
+        /// @param recode_id The recoded id
+        /// @param recode_coefficients The recoding coefficients
+        void build_recode_id(value_type *recode_id,
+                             const value_type *recode_coefficients)
+        {
+            assert(recode_id != 0);
+            assert(recode_coefficients != 0);
+
+            uint32_t length = SuperCoder::coefficients_length();
+            bool empty = true;
 
             for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
             {
@@ -134,33 +287,89 @@ namespace kodo
                 const value_type *source_id =
                     SuperCoder::coefficients_value( i );
 
-                if(fifi::is_binary<field_type>::value)
+                if(empty)
                 {
-                    SuperCoder::add(
-                        recode_id, source_id,
-                        SuperCoder::coefficients_length());
+                    SuperCoder::multiply_copy(recode_id, source_id, c,
+                                              length);
+                    empty = false;
+                }
+                else if(fifi::is_binary<field_type>::value)
+                {
+                    SuperCoder::add(recode_id, source_id, length);
                 }
                 else
                 {
                     SuperCoder::multiply_add(
-                        recode_id, source_id, c,
-                        SuperCoder::coefficients_length());
+                        recode_id, source_id, c, length);
                 }
             }
 
+            if(empty)
+            {
+                std::fill_n(recode_id, length, 0);
+            }
+        }
 
-            *coefficients = &m_coefficients[0];
-            sak::copy_storage(
-                id_storage, sak::storage(&m_recode_id[0], m_id_size));
+        /// Generates recoding coefficients which are non-zero for
+        /// recoding_rows() of the stored symbols picked at random, or
+        /// for all of them if fewer are stored
+        /// @param coefficients_buffer The recoding coefficients
+        void generate_sparse(uint8_t *coefficients_buffer)
+        {
+            assert(coefficients_buffer != 0);
 
-            return m_id_size;
-        }
+            std::fill_n(coefficients_buffer, m_id_size, 0);
 
+            m_stored_rows.clear();
 
-        /// @copydoc layer::id_size()
-        uint32_t id_size() const
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(SuperCoder::symbol_pivot(i))
+                {
+                    m_stored_rows.push_back(i);
+                }
+            }
+
+            uint32_t pivots = static_cast<uint32_t>(m_stored_rows.size());
+            uint32_t rows = std::min(m_recoding_rows, pivots);
+
+            value_type *recode_coefficients =
+                reinterpret_cast<value_type*>(coefficients_buffer);
+
+            // The first rows of a partial Fisher-Yates shuffle
+            for(uint32_t i = 0; i < rows; ++i)
+            {
+                boost::random::uniform_int_distribution<uint32_t>
+                    pick(i, pivots - 1);
+
+                std::swap(m_stored_rows[i],
+                          m_stored_rows[pick(m_random_generator)]);
+
+                fifi::set_value<field_type>(
+                    recode_coefficients, m_stored_rows[i],
+                    m_value_distribution(m_random_generator));
+            }
+        }
+
+        /// Adds the non-zero coefficients of a recoded id to the density
+        /// statistics
+        /// @param recode_id The recoded id
+        void count_nonzeros(const value_type *recode_id)
         {
-            return m_id_size;
+            assert(recode_id != 0);
+
+            uint32_t nonzeros = 0;
+
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+            {
+                if(fifi::get_value<field_type>(recode_id, i))
+                {
+                    ++nonzeros;
+                }
+            }
+
+            ++m_recoded;
+            m_recoded_nonzeros += nonzeros;
         }
 
     protected:
@@ -169,17 +378,25 @@ namespace kodo
         /// coding coefficients
         uint32_t m_id_size;
 
-        /// The storage type - we use aligned storage for both buffers
-        /// since if the coefficients are multibyte data types was have
-        /// to ensure the de-referencing the pointers are safe.
-        typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
-        aligned_vector;
+        /// The number of stored symbols combined in a recoded symbol,
+        /// zero for all
+        uint32_t m_recoding_rows;
+
+        /// The number of symbols recoded since the initialization
+        uint64_t m_recoded;
+
+        /// The non-zero coefficients of the recoded ids
+        uint64_t m_recoded_nonzeros;
+
+        /// The stored symbols while picking the recoded rows
+        std::vector<uint32_t> m_stored_rows;
 
-        /// Buffer for the recoding coefficients
-        aligned_vector m_coefficients;
+        /// The random generator picking the rows and coefficients
+        boost::random::mt19937 m_random_generator;
 
-        /// Buffer for the recoded id
-        aligned_vector m_recode_id;
+        /// The distribution of the non-zero coefficients
+        boost::random::uniform_int_distribution<value_type>
+            m_value_distribution;
     };
 
 }
@@ -0,0 +1,757 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define KODO_REGION_KERNELS_X86
+    #include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__) && defined(__ARM_NEON)
+    #define KODO_REGION_KERNELS_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(KODO_REGION_KERNELS_X86)
+    #define KODO_REGION_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define KODO_REGION_TARGET(isa)
+#endif
+
+namespace kodo
+{
+
+    /// The instruction sets for which region kernels are available
+    enum class simd_level
+    {
+        none,
+        ssse3,
+        avx2,
+        avx512,
+        neon
+    };
+
+    /// @return true if the instruction set can be used on the running
+    ///         CPU
+    /// @param level The instruction set to check
+    inline bool is_simd_level_supported(simd_level level)
+    {
+        switch(level)
+        {
+        case simd_level::none:
+            return true;
+#if defined(KODO_REGION_KERNELS_X86)
+        case simd_level::ssse3:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3");
+        case simd_level::avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case simd_level::avx512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512bw");
+#endif
+#if defined(KODO_REGION_KERNELS_NEON)
+        case simd_level::neon:
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
+
+    /// @return The fastest instruction set supported by the running CPU
+    inline simd_level detect_simd_level()
+    {
+        const simd_level levels[] =
+            {
+                simd_level::avx512,
+                simd_level::avx2,
+                simd_level::ssse3,
+                simd_level::neon
+            };
+
+        for(auto level : levels)
+        {
+            if(is_simd_level_supported(level))
+                return level;
+        }
+
+        return simd_level::none;
+    }
+
+    /// The region kernels multiply a buffer of field elements with a
+    /// constant using split lookup tables. Every input byte is split in
+    /// two nibbles and each nibble is looked up in a 16 entry table, the
+    /// results are combined with XOR. A 16 entry table exactly fits a
+    /// vector register which allows the lookups to be done with a
+    /// single byte shuffle instruction (PSHUFB / TBL).
+    ///
+    /// The "w1" kernels handle fields where one element fits in a byte,
+    /// they use two tables: entries 0-15 for the low nibble and entries
+    /// 16-31 for the high nibble. The "w2" kernels handle two byte
+    /// little-endian elements, they use eight tables: entry
+    /// (o * 4 + k) * 16 + x holds output byte o for the value of input
+    /// nibble k, where nibbles 0 and 1 are from the low byte and 2 and 3
+    /// from the high byte.
+    ///
+    /// If Add is true the result is added to the destination, otherwise
+    /// it overwrites it. The destination and source may be identical.
+    typedef void (*region_kernel)(const uint8_t *tables, uint8_t *dest,
+                                  const uint8_t *src, uint32_t size);
+
+    /// The size of the tables used by the w1 kernels
+    const uint32_t region_w1_tables_size = 32;
+
+    /// The size of the tables used by the w2 kernels
+    const uint32_t region_w2_tables_size = 128;
+
+    /// Portable one byte element kernel, also used for the tails of the
+    /// vectorized kernels
+    template<bool Add>
+    inline void region_scalar_w1(const uint8_t *tables, uint8_t *dest,
+                                 const uint8_t *src, uint32_t size)
+    {
+        for(uint32_t i = 0; i < size; ++i)
+        {
+            uint8_t v = tables[src[i] & 0x0f] ^ tables[16 + (src[i] >> 4)];
+            dest[i] = Add ? (dest[i] ^ v) : v;
+        }
+    }
+
+    /// Portable two byte element kernel, also used for the tails of the
+    /// vectorized kernels
+    template<bool Add>
+    inline void region_scalar_w2(const uint8_t *tables, uint8_t *dest,
+                                 const uint8_t *src, uint32_t size)
+    {
+        assert((size % 2) == 0);
+
+        uint16_t *d = reinterpret_cast<uint16_t*>(dest);
+        const uint16_t *s = reinterpret_cast<const uint16_t*>(src);
+
+        for(uint32_t i = 0; i < size / 2; ++i)
+        {
+            uint8_t l = s[i] & 0xff;
+            uint8_t h = s[i] >> 8;
+
+            uint8_t lo = tables[0 + (l & 0x0f)] ^ tables[16 + (l >> 4)] ^
+                tables[32 + (h & 0x0f)] ^ tables[48 + (h >> 4)];
+
+            uint8_t hi = tables[64 + (l & 0x0f)] ^ tables[80 + (l >> 4)] ^
+                tables[96 + (h & 0x0f)] ^ tables[112 + (h >> 4)];
+
+            uint16_t v = static_cast<uint16_t>(lo | (hi << 8));
+            d[i] = Add ? (d[i] ^ v) : v;
+        }
+    }
+
+    /// The operations of the prime2325 region kernels
+    enum class prime_region_op
+    {
+        /// dest = c * dest, the source is ignored
+        multiply,
+
+        /// dest = dest + c * src
+        multiply_add,
+
+        /// dest = dest + src, the coefficient is ignored
+        add,
+
+        /// dest = dest - src, the coefficient is ignored
+        subtract
+    };
+
+    /// The prime2325 region kernels work directly on 32 bit elements
+    /// modulo p = 2^32 - 5. The products are computed in 64 bits and
+    /// reduced using 2^32 = 5 mod p, i.e. x = hi * 2^32 + lo is folded
+    /// to lo + 5 * hi. Two folds bring any 64 bit value below
+    /// 2^32 + 25, and a final conditional subtraction of p gives the
+    /// element. The elements must be smaller than p, the destination
+    /// and source may be identical.
+    typedef void (*prime_region_kernel)(uint32_t coefficient, uint32_t *dest,
+                                        const uint32_t *src, uint32_t length);
+
+    /// The prime of the prime2325 field
+    const uint32_t region_prime2325 = 4294967291U;
+
+    /// Reduces a 64 bit value modulo 2^32 - 5
+    /// @param x The value
+    /// @return The element congruent to x
+    inline uint32_t region_prime2325_reduce(uint64_t x)
+    {
+        x = (x & 0xffffffffULL) + 5 * (x >> 32);
+        x = (x & 0xffffffffULL) + 5 * (x >> 32);
+
+        // Adding 5 carries into bit 32 exactly when x >= p, and the
+        // truncation then gives x - p
+        x += 5 * ((x + 5) >> 32);
+        return static_cast<uint32_t>(x);
+    }
+
+    /// Portable prime2325 kernel, also used for the tails of the
+    /// vectorized kernels
+    template<prime_region_op Op>
+    inline void region_scalar_prime(uint32_t coefficient, uint32_t *dest,
+                                    const uint32_t *src, uint32_t length)
+    {
+        for(uint32_t i = 0; i < length; ++i)
+        {
+            uint64_t d = dest[i];
+
+            if(Op == prime_region_op::multiply)
+                d = d * coefficient;
+            else if(Op == prime_region_op::multiply_add)
+                d += uint64_t(src[i]) * coefficient;
+            else if(Op == prime_region_op::add)
+                d += src[i];
+            else
+                d += region_prime2325 - src[i];
+
+            dest[i] = region_prime2325_reduce(d);
+        }
+    }
+
+#if defined(KODO_REGION_KERNELS_X86)
+
+    template<bool Add>
+    KODO_REGION_TARGET("ssse3")
+    void region_ssse3_w1(const uint8_t *tables, uint8_t *dest,
+                         const uint8_t *src, uint32_t size)
+    {
+        const __m128i *t = reinterpret_cast<const __m128i*>(tables);
+        __m128i t_low = _mm_loadu_si128(t);
+        __m128i t_high = _mm_loadu_si128(t + 1);
+        __m128i mask = _mm_set1_epi8(0x0f);
+
+        uint32_t i = 0;
+        for(; i + 16 <= size; i += 16)
+        {
+            __m128i *d = reinterpret_cast<__m128i*>(dest + i);
+            __m128i s = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + i));
+
+            __m128i low = _mm_and_si128(s, mask);
+            __m128i high = _mm_and_si128(_mm_srli_epi64(s, 4), mask);
+
+            __m128i r = _mm_xor_si128(_mm_shuffle_epi8(t_low, low),
+                                      _mm_shuffle_epi8(t_high, high));
+            if(Add)
+                r = _mm_xor_si128(r, _mm_loadu_si128(d));
+
+            _mm_storeu_si128(d, r);
+        }
+
+        region_scalar_w1<Add>(tables, dest + i, src + i, size - i);
+    }
+
+    template<bool Add>
+    KODO_REGION_TARGET("ssse3")
+    void region_ssse3_w2(const uint8_t *tables, uint8_t *dest,
+                         const uint8_t *src, uint32_t size)
+    {
+        const __m128i *t = reinterpret_cast<const __m128i*>(tables);
+        __m128i tl[4], th[4];
+        for(uint32_t k = 0; k < 4; ++k)
+        {
+            tl[k] = _mm_loadu_si128(t + k);
+            th[k] = _mm_loadu_si128(t + 4 + k);
+        }
+
+        __m128i mask = _mm_set1_epi8(0x0f);
+        __m128i low_bytes = _mm_set1_epi16(0x00ff);
+
+        uint32_t i = 0;
+        for(; i + 32 <= size; i += 32)
+        {
+            __m128i *d = reinterpret_cast<__m128i*>(dest + i);
+            __m128i a = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + i));
+            __m128i b = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + i + 16));
+
+            // Separate the low and high bytes of the 16 elements
+            __m128i l = _mm_packus_epi16(_mm_and_si128(a, low_bytes),
+                                         _mm_and_si128(b, low_bytes));
+            __m128i h = _mm_packus_epi16(_mm_srli_epi16(a, 8),
+                                         _mm_srli_epi16(b, 8));
+
+            __m128i n[4];
+            n[0] = _mm_and_si128(l, mask);
+            n[1] = _mm_and_si128(_mm_srli_epi64(l, 4), mask);
+            n[2] = _mm_and_si128(h, mask);
+            n[3] = _mm_and_si128(_mm_srli_epi64(h, 4), mask);
+
+            __m128i rl = _mm_shuffle_epi8(tl[0], n[0]);
+            __m128i rh = _mm_shuffle_epi8(th[0], n[0]);
+            for(uint32_t k = 1; k < 4; ++k)
+            {
+                rl = _mm_xor_si128(rl, _mm_shuffle_epi8(tl[k], n[k]));
+                rh = _mm_xor_si128(rh, _mm_shuffle_epi8(th[k], n[k]));
+            }
+
+            __m128i r0 = _mm_unpacklo_epi8(rl, rh);
+            __m128i r1 = _mm_unpackhi_epi8(rl, rh);
+            if(Add)
+            {
+                r0 = _mm_xor_si128(r0, _mm_loadu_si128(d));
+                r1 = _mm_xor_si128(r1, _mm_loadu_si128(d + 1));
+            }
+
+            _mm_storeu_si128(d, r0);
+            _mm_storeu_si128(d + 1, r1);
+        }
+
+        region_scalar_w2<Add>(tables, dest + i, src + i, size - i);
+    }
+
+    template<bool Add>
+    KODO_REGION_TARGET("avx2")
+    void region_avx2_w1(const uint8_t *tables, uint8_t *dest,
+                        const uint8_t *src, uint32_t size)
+    {
+        const __m128i *t = reinterpret_cast<const __m128i*>(tables);
+        __m256i t_low = _mm256_broadcastsi128_si256(_mm_loadu_si128(t));
+        __m256i t_high =
+            _mm256_broadcastsi128_si256(_mm_loadu_si128(t + 1));
+        __m256i mask = _mm256_set1_epi8(0x0f);
+
+        uint32_t i = 0;
+        for(; i + 32 <= size; i += 32)
+        {
+            __m256i *d = reinterpret_cast<__m256i*>(dest + i);
+            __m256i s = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + i));
+
+            __m256i low = _mm256_and_si256(s, mask);
+            __m256i high = _mm256_and_si256(_mm256_srli_epi64(s, 4), mask);
+
+            __m256i r = _mm256_xor_si256(
+                _mm256_shuffle_epi8(t_low, low),
+                _mm256_shuffle_epi8(t_high, high));
+            if(Add)
+                r = _mm256_xor_si256(r, _mm256_loadu_si256(d));
+
+            _mm256_storeu_si256(d, r);
+        }
+
+        region_scalar_w1<Add>(tables, dest + i, src + i, size - i);
+    }
+
+    template<bool Add>
+    KODO_REGION_TARGET("avx2")
+    void region_avx2_w2(const uint8_t *tables, uint8_t *dest,
+                        const uint8_t *src, uint32_t size)
+    {
+        const __m128i *t = reinterpret_cast<const __m128i*>(tables);
+        __m256i tl[4], th[4];
+        for(uint32_t k = 0; k < 4; ++k)
+        {
+            tl[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(t + k));
+            th[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(t + 4 + k));
+        }
+
+        __m256i mask = _mm256_set1_epi8(0x0f);
+        __m256i low_bytes = _mm256_set1_epi16(0x00ff);
+
+        uint32_t i = 0;
+        for(; i + 64 <= size; i += 64)
+        {
+            __m256i *d = reinterpret_cast<__m256i*>(dest + i);
+            __m256i a = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + i));
+            __m256i b = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + i + 32));
+
+            // The pack and unpack instructions work within 128 bit
+            // lanes, so the element order is restored by the unpack
+            __m256i l = _mm256_packus_epi16(_mm256_and_si256(a, low_bytes),
+                                            _mm256_and_si256(b, low_bytes));
+            __m256i h = _mm256_packus_epi16(_mm256_srli_epi16(a, 8),
+                                            _mm256_srli_epi16(b, 8));
+
+            __m256i n[4];
+            n[0] = _mm256_and_si256(l, mask);
+            n[1] = _mm256_and_si256(_mm256_srli_epi64(l, 4), mask);
+            n[2] = _mm256_and_si256(h, mask);
+            n[3] = _mm256_and_si256(_mm256_srli_epi64(h, 4), mask);
+
+            __m256i rl = _mm256_shuffle_epi8(tl[0], n[0]);
+            __m256i rh = _mm256_shuffle_epi8(th[0], n[0]);
+            for(uint32_t k = 1; k < 4; ++k)
+            {
+                rl = _mm256_xor_si256(rl, _mm256_shuffle_epi8(tl[k], n[k]));
+                rh = _mm256_xor_si256(rh, _mm256_shuffle_epi8(th[k], n[k]));
+            }
+
+            __m256i r0 = _mm256_unpacklo_epi8(rl, rh);
+            __m256i r1 = _mm256_unpackhi_epi8(rl, rh);
+            if(Add)
+            {
+                r0 = _mm256_xor_si256(r0, _mm256_loadu_si256(d));
+                r1 = _mm256_xor_si256(r1, _mm256_loadu_si256(d + 1));
+            }
+
+            _mm256_storeu_si256(d, r0);
+            _mm256_storeu_si256(d + 1, r1);
+        }
+
+        region_scalar_w2<Add>(tables, dest + i, src + i, size - i);
+    }
+
+    /// Reduces the four 64 bit lanes modulo 2^32 - 5, see
+    /// region_prime2325_reduce()
+    KODO_REGION_TARGET("avx2")
+    inline __m256i region_avx2_prime_reduce(__m256i x)
+    {
+        const __m256i low = _mm256_set1_epi64x(0xffffffffLL);
+        const __m256i five = _mm256_set1_epi64x(5);
+
+        // 5 * hi is computed as (hi << 2) + hi
+        __m256i hi = _mm256_srli_epi64(x, 32);
+        x = _mm256_add_epi64(_mm256_and_si256(x, low),
+                             _mm256_add_epi64(_mm256_slli_epi64(hi, 2), hi));
+
+        hi = _mm256_srli_epi64(x, 32);
+        x = _mm256_add_epi64(_mm256_and_si256(x, low),
+                             _mm256_add_epi64(_mm256_slli_epi64(hi, 2), hi));
+
+        __m256i carry = _mm256_srli_epi64(_mm256_add_epi64(x, five), 32);
+        x = _mm256_add_epi64(
+            x, _mm256_add_epi64(_mm256_slli_epi64(carry, 2), carry));
+
+        return _mm256_and_si256(x, low);
+    }
+
+    /// The even and odd elements are handled in separate 64 bit lanes,
+    /// since the 32 x 32 -> 64 bit multiply (VPMULUDQ) only reads the
+    /// low half of each lane
+    template<prime_region_op Op>
+    KODO_REGION_TARGET("avx2")
+    void region_avx2_prime(uint32_t coefficient, uint32_t *dest,
+                           const uint32_t *src, uint32_t length)
+    {
+        const __m256i low = _mm256_set1_epi64x(0xffffffffLL);
+        const __m256i prime = _mm256_set1_epi32(int32_t(region_prime2325));
+        const __m256i c = _mm256_set1_epi64x(coefficient);
+
+        uint32_t i = 0;
+        for(; i + 8 <= length; i += 8)
+        {
+            __m256i *d = reinterpret_cast<__m256i*>(dest + i);
+            __m256i v = _mm256_loadu_si256(d);
+
+            __m256i even;
+            __m256i odd;
+
+            if(Op == prime_region_op::multiply)
+            {
+                even = _mm256_mul_epu32(v, c);
+                odd = _mm256_mul_epu32(_mm256_srli_epi64(v, 32), c);
+            }
+            else
+            {
+                __m256i s = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(src + i));
+
+                if(Op == prime_region_op::multiply_add)
+                {
+                    even = _mm256_mul_epu32(s, c);
+                    odd = _mm256_mul_epu32(_mm256_srli_epi64(s, 32), c);
+                }
+                else
+                {
+                    // Subtraction adds p - src, which does not wrap
+                    // since src < p
+                    if(Op == prime_region_op::subtract)
+                        s = _mm256_sub_epi32(prime, s);
+
+                    even = _mm256_and_si256(s, low);
+                    odd = _mm256_srli_epi64(s, 32);
+                }
+
+                even = _mm256_add_epi64(even, _mm256_and_si256(v, low));
+                odd = _mm256_add_epi64(odd, _mm256_srli_epi64(v, 32));
+            }
+
+            even = region_avx2_prime_reduce(even);
+            odd = region_avx2_prime_reduce(odd);
+
+            _mm256_storeu_si256(
+                d, _mm256_or_si256(even, _mm256_slli_epi64(odd, 32)));
+        }
+
+        region_scalar_prime<Op>(coefficient, dest + i, src + i, length - i);
+    }
+
+    template<bool Add>
+    KODO_REGION_TARGET("avx512f,avx512bw")
+    void region_avx512_w1(const uint8_t *tables, uint8_t *dest,
+                          const uint8_t *src, uint32_t size)
+    {
+        const __m128i *t = reinterpret_cast<const __m128i*>(tables);
+        __m512i t_low = _mm512_broadcast_i32x4(_mm_loadu_si128(t));
+        __m512i t_high = _mm512_broadcast_i32x4(_mm_loadu_si128(t + 1));
+        __m512i mask = _mm512_set1_epi8(0x0f);
+
+        uint32_t i = 0;
+        for(; i + 64 <= size; i += 64)
+        {
+            __m512i s = _mm512_loadu_si512(src + i);
+
+            __m512i low = _mm512_and_si512(s, mask);
+            __m512i high = _mm512_and_si512(_mm512_srli_epi64(s, 4), mask);
+
+            __m512i r = _mm512_xor_si512(
+                _mm512_shuffle_epi8(t_low, low),
+                _mm512_shuffle_epi8(t_high, high));
+            if(Add)
+                r = _mm512_xor_si512(r, _mm512_loadu_si512(dest + i));
+
+            _mm512_storeu_si512(dest + i, r);
+        }
+
+        region_scalar_w1<Add>(tables, dest + i, src + i, size - i);
+    }
+
+    template<bool Add>
+    KODO_REGION_TARGET("avx512f,avx512bw")
+    void region_avx512_w2(const uint8_t *tables, uint8_t *dest,
+                          const uint8_t *src, uint32_t size)
+    {
+        const __m128i *t = reinterpret_cast<const __m128i*>(tables);
+        __m512i tl[4], th[4];
+        for(uint32_t k = 0; k < 4; ++k)
+        {
+            tl[k] = _mm512_broadcast_i32x4(_mm_loadu_si128(t + k));
+            th[k] = _mm512_broadcast_i32x4(_mm_loadu_si128(t + 4 + k));
+        }
+
+        __m512i mask = _mm512_set1_epi8(0x0f);
+        __m512i low_bytes = _mm512_set1_epi16(0x00ff);
+
+        uint32_t i = 0;
+        for(; i + 128 <= size; i += 128)
+        {
+            __m512i a = _mm512_loadu_si512(src + i);
+            __m512i b = _mm512_loadu_si512(src + i + 64);
+
+            __m512i l = _mm512_packus_epi16(_mm512_and_si512(a, low_bytes),
+                                            _mm512_and_si512(b, low_bytes));
+            __m512i h = _mm512_packus_epi16(_mm512_srli_epi16(a, 8),
+                                            _mm512_srli_epi16(b, 8));
+
+            __m512i n[4];
+            n[0] = _mm512_and_si512(l, mask);
+            n[1] = _mm512_and_si512(_mm512_srli_epi64(l, 4), mask);
+            n[2] = _mm512_and_si512(h, mask);
+            n[3] = _mm512_and_si512(_mm512_srli_epi64(h, 4), mask);
+
+            __m512i rl = _mm512_shuffle_epi8(tl[0], n[0]);
+            __m512i rh = _mm512_shuffle_epi8(th[0], n[0]);
+            for(uint32_t k = 1; k < 4; ++k)
+            {
+                rl = _mm512_xor_si512(rl, _mm512_shuffle_epi8(tl[k], n[k]));
+                rh = _mm512_xor_si512(rh, _mm512_shuffle_epi8(th[k], n[k]));
+            }
+
+            __m512i r0 = _mm512_unpacklo_epi8(rl, rh);
+            __m512i r1 = _mm512_unpackhi_epi8(rl, rh);
+            if(Add)
+            {
+                r0 = _mm512_xor_si512(r0, _mm512_loadu_si512(dest + i));
+                r1 = _mm512_xor_si512(r1, _mm512_loadu_si512(dest + i + 64));
+            }
+
+            _mm512_storeu_si512(dest + i, r0);
+            _mm512_storeu_si512(dest + i + 64, r1);
+        }
+
+        region_scalar_w2<Add>(tables, dest + i, src + i, size - i);
+    }
+
+#endif
+
+#if defined(KODO_REGION_KERNELS_NEON)
+
+    template<bool Add>
+    void region_neon_w1(const uint8_t *tables, uint8_t *dest,
+                        const uint8_t *src, uint32_t size)
+    {
+        uint8x16_t t_low = vld1q_u8(tables);
+        uint8x16_t t_high = vld1q_u8(tables + 16);
+        uint8x16_t mask = vdupq_n_u8(0x0f);
+
+        uint32_t i = 0;
+        for(; i + 16 <= size; i += 16)
+        {
+            uint8x16_t s = vld1q_u8(src + i);
+
+            uint8x16_t r = veorq_u8(
+                vqtbl1q_u8(t_low, vandq_u8(s, mask)),
+                vqtbl1q_u8(t_high, vshrq_n_u8(s, 4)));
+            if(Add)
+                r = veorq_u8(r, vld1q_u8(dest + i));
+
+            vst1q_u8(dest + i, r);
+        }
+
+        region_scalar_w1<Add>(tables, dest + i, src + i, size - i);
+    }
+
+    template<bool Add>
+    void region_neon_w2(const uint8_t *tables, uint8_t *dest,
+                        const uint8_t *src, uint32_t size)
+    {
+        uint8x16_t tl[4], th[4];
+        for(uint32_t k = 0; k < 4; ++k)
+        {
+            tl[k] = vld1q_u8(tables + k * 16);
+            th[k] = vld1q_u8(tables + 64 + k * 16);
+        }
+
+        uint8x16_t mask = vdupq_n_u8(0x0f);
+
+        uint32_t i = 0;
+        for(; i + 32 <= size; i += 32)
+        {
+            // De-interleaving load, val[0] holds the low bytes and
+            // val[1] the high bytes of the 16 elements
+            uint8x16x2_t s = vld2q_u8(src + i);
+
+            uint8x16_t n[4];
+            n[0] = vandq_u8(s.val[0], mask);
+            n[1] = vshrq_n_u8(s.val[0], 4);
+            n[2] = vandq_u8(s.val[1], mask);
+            n[3] = vshrq_n_u8(s.val[1], 4);
+
+            uint8x16x2_t r;
+            r.val[0] = vqtbl1q_u8(tl[0], n[0]);
+            r.val[1] = vqtbl1q_u8(th[0], n[0]);
+            for(uint32_t k = 1; k < 4; ++k)
+            {
+                r.val[0] = veorq_u8(r.val[0], vqtbl1q_u8(tl[k], n[k]));
+                r.val[1] = veorq_u8(r.val[1], vqtbl1q_u8(th[k], n[k]));
+            }
+
+            if(Add)
+            {
+                uint8x16x2_t d = vld2q_u8(dest + i);
+                r.val[0] = veorq_u8(r.val[0], d.val[0]);
+                r.val[1] = veorq_u8(r.val[1], d.val[1]);
+            }
+
+            vst2q_u8(dest + i, r);
+        }
+
+        region_scalar_w2<Add>(tables, dest + i, src + i, size - i);
+    }
+
+#endif
+
+    /// The kernels selected for an instruction set
+    struct region_kernels
+    {
+        /// Constructs the kernels for the given instruction set, for
+        /// simd_level::none all kernels are zero.
+        /// @param level The instruction set to use
+        explicit region_kernels(simd_level level = simd_level::none)
+            : m_w1_multiply(0),
+              m_w1_multiply_add(0),
+              m_w2_multiply(0),
+              m_w2_multiply_add(0),
+              m_prime_multiply(0),
+              m_prime_multiply_add(0),
+              m_prime_add(0),
+              m_prime_subtract(0)
+        {
+            assert(is_simd_level_supported(level));
+
+            switch(level)
+            {
+#if defined(KODO_REGION_KERNELS_X86)
+            case simd_level::ssse3:
+                m_w1_multiply = &region_ssse3_w1<false>;
+                m_w1_multiply_add = &region_ssse3_w1<true>;
+                m_w2_multiply = &region_ssse3_w2<false>;
+                m_w2_multiply_add = &region_ssse3_w2<true>;
+                break;
+            case simd_level::avx2:
+                m_w1_multiply = &region_avx2_w1<false>;
+                m_w1_multiply_add = &region_avx2_w1<true>;
+                m_w2_multiply = &region_avx2_w2<false>;
+                m_w2_multiply_add = &region_avx2_w2<true>;
+                set_avx2_prime_kernels();
+                break;
+            case simd_level::avx512:
+                m_w1_multiply = &region_avx512_w1<false>;
+                m_w1_multiply_add = &region_avx512_w1<true>;
+                m_w2_multiply = &region_avx512_w2<false>;
+                m_w2_multiply_add = &region_avx512_w2<true>;
+
+                // The AVX2 kernels are used, the reduction dominates
+                // and gains little from the wider registers
+                set_avx2_prime_kernels();
+                break;
+#endif
+#if defined(KODO_REGION_KERNELS_NEON)
+            case simd_level::neon:
+                m_w1_multiply = &region_neon_w1<false>;
+                m_w1_multiply_add = &region_neon_w1<true>;
+                m_w2_multiply = &region_neon_w2<false>;
+                m_w2_multiply_add = &region_neon_w2<true>;
+                break;
+#endif
+            default:
+                break;
+            }
+        }
+
+        /// One byte elements, dest = c * src
+        region_kernel m_w1_multiply;
+
+        /// One byte elements, dest = dest + c * src
+        region_kernel m_w1_multiply_add;
+
+        /// Two byte elements, dest = c * src
+        region_kernel m_w2_multiply;
+
+        /// Two byte elements, dest = dest + c * src
+        region_kernel m_w2_multiply_add;
+
+        /// prime2325 elements, dest = c * dest
+        prime_region_kernel m_prime_multiply;
+
+        /// prime2325 elements, dest = dest + c * src
+        prime_region_kernel m_prime_multiply_add;
+
+        /// prime2325 elements, dest = dest + src
+        prime_region_kernel m_prime_add;
+
+        /// prime2325 elements, dest = dest - src
+        prime_region_kernel m_prime_subtract;
+
+    private:
+
+#if defined(KODO_REGION_KERNELS_X86)
+
+        /// Selects the AVX2 prime2325 kernels
+        void set_avx2_prime_kernels()
+        {
+            m_prime_multiply = &region_avx2_prime<prime_region_op::multiply>;
+            m_prime_multiply_add =
+                &region_avx2_prime<prime_region_op::multiply_add>;
+            m_prime_add = &region_avx2_prime<prime_region_op::add>;
+            m_prime_subtract = &region_avx2_prime<prime_region_op::subtract>;
+        }
+
+#endif
+    };
+
+}
@@ -7,6 +7,9 @@
 #define KODO_RFC5052_PARTITIONING_SCHEME_HPP
 
 #include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <limits>
 
 namespace kodo
 {
@@ -17,7 +20,11 @@ namespace kodo
     /// Takes as input the number of symbols the symbol size
     /// and the total length of an object and returns the number
     /// the number blocks to use and the symbols and symbol size
-    /// needed to encode/decode an object of the given size
+    /// needed to encode/decode an object of the given size.
+    ///
+    /// The object size and the byte offsets of the blocks are 64 bit,
+    /// so objects larger than 4 GB are partitioned directly, while the
+    /// sizes within a block remain 32 bit.
     class rfc5052_partitioning_scheme
     {
     public:
@@ -31,7 +38,7 @@ namespace kodo
         /// @param object_size the size in bytes of the whole object
         rfc5052_partitioning_scheme(uint32_t max_symbols,
                                     uint32_t max_symbol_size,
-                                    uint32_t object_size);
+                                    uint64_t object_size);
 
         /// @copydoc block_partitioning::symbols(uint32_t) const
         uint32_t symbols(uint32_t block_id) const;
@@ -43,7 +50,7 @@ namespace kodo
         uint32_t block_size(uint32_t block_id) const;
 
         /// @copydoc block_partitioning::bytes_offset(uint32_t) const
-        uint32_t byte_offset(uint32_t block_id) const;
+        uint64_t byte_offset(uint32_t block_id) const;
 
         /// @copydoc block_partitioning::bytes_used(uint32_t) const
         uint32_t bytes_used(uint32_t block_id) const;
@@ -52,13 +59,13 @@ namespace kodo
         uint32_t blocks() const;
 
         /// @copydoc block_partitioning::object_size() const
-        uint32_t object_size() const;
+        uint64_t object_size() const;
 
         /// @copydoc block_partitioning::total_symbols() const
         uint32_t total_symbols() const;
 
         /// @copydoc block_partitioning::total_block_size() const
-        uint32_t total_block_size() const;
+        uint64_t total_block_size() const;
 
     private:
 
@@ -69,7 +76,7 @@ namespace kodo
         uint32_t m_max_symbol_size;
 
         /// The size of the object to transfer in bytes
-        uint32_t m_object_size;
+        uint64_t m_object_size;
 
         /// The total number of symbols in the object
         uint32_t m_total_symbols;
@@ -105,7 +112,7 @@ namespace kodo
     inline rfc5052_partitioning_scheme::rfc5052_partitioning_scheme(
         uint32_t max_symbols,
         uint32_t max_symbol_size,
-        uint32_t object_size)
+        uint64_t object_size)
         : m_max_symbols(max_symbols),
           m_max_symbol_size(max_symbol_size),
           m_object_size(object_size)
@@ -115,7 +122,12 @@ namespace kodo
         assert(m_object_size > 0);
 
         // ceil(x/y) = ((x - 1) / y) + 1
-        m_total_symbols = ((m_object_size - 1) / m_max_symbol_size) + 1;
+        uint64_t total_symbols =
+            ((m_object_size - 1) / m_max_symbol_size) + 1;
+
+        assert(total_symbols <= std::numeric_limits<uint32_t>::max());
+        m_total_symbols = static_cast<uint32_t>(total_symbols);
+
         m_total_blocks  = ((m_total_symbols - 1) / m_max_symbols) + 1;
 
         m_large_block_symbols = ((m_total_symbols - 1) / m_total_blocks) + 1;
@@ -148,22 +160,23 @@ namespace kodo
         return symbols(block_id) * symbol_size(block_id);
     }
 
-    inline uint32_t
+    inline uint64_t
     rfc5052_partitioning_scheme::byte_offset(uint32_t block_id) const
     {
         assert(block_id < m_total_blocks);
 
         if(block_id < m_large_blocks)
         {
-            return block_id * m_large_block_symbols * m_max_symbol_size;
+            return uint64_t(block_id) * m_large_block_symbols *
+                m_max_symbol_size;
         }
 
         // Calculating the largeblock offset
-        uint32_t offset =
-            m_large_blocks * m_large_block_symbols * m_max_symbol_size;
+        uint64_t offset = uint64_t(m_large_blocks) *
+            m_large_block_symbols * m_max_symbol_size;
 
         // Calculating the smallblock offset
-        offset += (block_id - m_large_blocks) *
+        offset += uint64_t(block_id - m_large_blocks) *
             m_small_block_symbols * m_max_symbol_size;
 
         return offset;
@@ -174,13 +187,15 @@ namespace kodo
     {
         assert(block_id < m_total_blocks);
 
-        uint32_t offset = byte_offset(block_id);
+        uint64_t offset = byte_offset(block_id);
 
         assert(offset < m_object_size);
-        uint32_t remaining =  m_object_size - offset;
+        uint64_t remaining =  m_object_size - offset;
         uint32_t the_block_size = block_size(block_id);
 
-        return std::min(remaining, the_block_size);
+        // The bytes used of a block always fit in 32 bit
+        return static_cast<uint32_t>(
+            std::min<uint64_t>(remaining, the_block_size));
     }
 
     inline uint32_t
@@ -190,7 +205,7 @@ namespace kodo
         return m_total_blocks;
     }
 
-    inline uint32_t
+    inline uint64_t
     rfc5052_partitioning_scheme::object_size() const
     {
         assert(m_object_size > 0);
@@ -204,10 +219,10 @@ namespace kodo
         return m_total_symbols;
     }
 
-    inline uint32_t
+    inline uint64_t
     rfc5052_partitioning_scheme::total_block_size() const
     {
-        return m_total_symbols * m_max_symbol_size;
+        return uint64_t(m_total_symbols) * m_max_symbol_size;
     }
 
 }
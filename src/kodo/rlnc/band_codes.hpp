@@ -0,0 +1,123 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../symbol_id_encoder.hpp"
+#include "../symbol_id_decoder.hpp"
+#include "../coefficient_storage.hpp"
+#include "../coefficient_info.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+#include "../band_info.hpp"
+#include "../band_generator.hpp"
+#include "../band_symbol_id_writer.hpp"
+#include "../band_symbol_id_reader.hpp"
+#include "../band_decoder.hpp"
+
+#include "../linear_block_encoder.hpp"
+#include "../linear_block_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Complete stack implementing a band RLNC encoder.
+    ///
+    /// The key features of this configuration is the following:
+    /// - Systematic encoding (uncoded symbols produced before switching
+    ///   to coding)
+    /// - The non-zero coefficients of an encoding vector are confined
+    ///   to a band of consecutive symbols, the width of the band is set
+    ///   with factory::set_band_width().
+    /// - Only the offset and the coefficients of the band are sent,
+    ///   which reduces the overhead per symbol.
+    /// - Deep symbol storage which makes the encoder allocate its own
+    ///   internal memory.
+    template<class Field>
+    class band_rlnc_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 band_symbol_id_writer<
+                 // Coefficient Generator API
+                 band_generator<
+                 band_info<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 band_rlnc_encoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Implementation of a band RLNC decoder.
+    ///
+    /// Adds the following features (including those described for
+    /// the encoder):
+    /// - Band decoder, the elimination only visits the bands of the
+    ///   stored symbols, so k symbols are decoded with O(k * w) symbol
+    ///   operations for a band of width w.
+    template<class Field>
+    class band_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 band_symbol_id_reader<
+                 band_info<
+                 // Codec API
+                 band_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 band_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+}
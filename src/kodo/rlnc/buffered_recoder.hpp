@@ -0,0 +1,325 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <fifi/arithmetics.hpp>
+#include <fifi/default_field.hpp>
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include <sak/convert_endian.hpp>
+
+#include "../systematic_base_coder.hpp"
+
+namespace kodo
+{
+
+    /// @brief Recoder for relays keeping a bounded number of the coded
+    ///        symbols of a full_rlnc_encoder.
+    ///
+    /// The payload_recoder recodes from a full decoder, i.e. the relay
+    /// stores a whole generation and recoding combines the coefficients
+    /// of all its symbols. This recoder instead keeps the last received
+    /// payloads up to its capacity, the oldest being replaced when it is
+    /// full, and recodes random combinations of those alone. The memory
+    /// and the work per recoded symbol thereby depend on the capacity
+    /// and not on the number of symbols, apart from the size of the
+    /// coefficient vectors.
+    ///
+    /// The payloads received and produced use the layout of the
+    /// full_rlnc_encoder and full_rlnc_decoder stacks, with the symbol
+    /// data followed by the systematic flag and either the index of an
+    /// uncoded symbol or the coding coefficients.
+    template<class Field>
+    class buffered_recoder : boost::noncopyable
+    {
+    public:
+
+        /// The finite field type
+        typedef Field field_type;
+
+        /// The value type of the field
+        typedef typename field_type::value_type value_type;
+
+        /// The finite field implementation
+        typedef typename fifi::default_field<field_type>::type field_impl;
+
+        /// The flag type of the payloads
+        typedef systematic_base_coder::flag_type flag_type;
+
+        /// The type of the index of an uncoded symbol
+        typedef systematic_base_coder::counter_type counter_type;
+
+    public:
+
+        /// Constructor
+        /// @param symbols The number of symbols in a generation
+        /// @param symbol_size The size of a symbol in bytes
+        /// @param capacity The maximum number of buffered payloads
+        buffered_recoder(uint32_t symbols, uint32_t symbol_size,
+                         uint32_t capacity)
+            : m_symbols(symbols),
+              m_symbol_size(symbol_size),
+              m_symbol_length(fifi::size_to_length<field_type>(symbol_size)),
+              m_coefficients_size(
+                  fifi::elements_to_size<field_type>(symbols)),
+              m_coefficients_length(
+                  fifi::elements_to_length<field_type>(symbols)),
+              m_capacity(capacity),
+              m_buffered(0),
+              m_next(0),
+              m_symbol_data(capacity * m_symbol_length, 0),
+              m_coefficients(capacity * m_coefficients_length, 0),
+              m_temp(std::max(m_symbol_length, m_coefficients_length), 0),
+              m_value_distribution(field_type::min_value,
+                                   field_type::max_value)
+        {
+            assert(m_symbols > 0);
+            assert(m_symbol_size > 0);
+            assert(m_capacity > 0);
+
+            // The symbol must hold a whole number of field values
+            assert(fifi::length_to_size<field_type>(m_symbol_length) ==
+                   m_symbol_size);
+        }
+
+        /// @return The number of symbols in a generation
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// @return The size of a symbol in bytes
+        uint32_t symbol_size() const
+        {
+            return m_symbol_size;
+        }
+
+        /// @return The maximum number of buffered payloads
+        uint32_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        /// @return The number of buffered payloads
+        uint32_t buffered() const
+        {
+            return m_buffered;
+        }
+
+        /// @return The size of a payload in bytes, equal to the payload
+        ///         size of the full_rlnc_encoder
+        uint32_t payload_size() const
+        {
+            return m_symbol_size + sizeof(flag_type) +
+                sizeof(counter_type) + m_coefficients_size;
+        }
+
+        /// Seeds the generator of the recoding coefficients
+        /// @param seed_value The seed
+        void seed(uint32_t seed_value)
+        {
+            m_random_generator.seed(seed_value);
+        }
+
+        /// Buffers a payload, replacing the oldest payload if the buffer
+        /// is full. Payloads with an all-zero coefficient vector are not
+        /// buffered.
+        /// @param payload The payload
+        void receive(const uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            const uint8_t *header = payload + m_symbol_size;
+            flag_type flag = sak::big_endian::get<flag_type>(header);
+            header += sizeof(flag_type);
+
+            value_type *coefficients = &m_coefficients[
+                m_next * m_coefficients_length];
+
+            if(flag == systematic_base_coder::systematic_flag)
+            {
+                counter_type index =
+                    sak::big_endian::get<counter_type>(header);
+
+                assert(index < m_symbols);
+
+                std::fill_n(coefficients, m_coefficients_length, 0);
+                fifi::set_value<field_type>(coefficients, index, 1U);
+            }
+            else
+            {
+                assert(flag == systematic_base_coder::non_systematic_flag);
+
+                std::copy(header, header + m_coefficients_size,
+                          reinterpret_cast<uint8_t*>(coefficients));
+
+                bool nonzero = false;
+                for(uint32_t i = 0; i < m_coefficients_length; ++i)
+                {
+                    if(coefficients[i])
+                    {
+                        nonzero = true;
+                        break;
+                    }
+                }
+
+                if(!nonzero)
+                {
+                    return;
+                }
+            }
+
+            std::copy(payload, payload + m_symbol_size,
+                      reinterpret_cast<uint8_t*>(
+                          &m_symbol_data[m_next * m_symbol_length]));
+
+            m_next = (m_next + 1) % m_capacity;
+            m_buffered = std::min(m_buffered + 1, m_capacity);
+        }
+
+        /// Writes a random combination of the buffered payloads, an
+        /// all-zero symbol if no payload is buffered
+        /// @param payload The buffer of payload_size() bytes
+        /// @return The number of bytes used in the payload
+        uint32_t recode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            value_type *symbol_data = reinterpret_cast<value_type*>(payload);
+
+            uint8_t *header = payload + m_symbol_size;
+            sak::big_endian::put<flag_type>(
+                systematic_base_coder::non_systematic_flag, header);
+
+            value_type *coefficients =
+                reinterpret_cast<value_type*>(header + sizeof(flag_type));
+
+            // The first buffered symbol used initialises the payload,
+            // which is only zeroed if no symbol is used
+            bool empty = true;
+
+            for(uint32_t i = 0; i < m_buffered; ++i)
+            {
+                value_type c = m_value_distribution(m_random_generator);
+
+                if(!c)
+                {
+                    continue;
+                }
+
+                const value_type *src_data =
+                    &m_symbol_data[i * m_symbol_length];
+
+                const value_type *src_coefficients =
+                    &m_coefficients[i * m_coefficients_length];
+
+                if(empty)
+                {
+                    std::copy_n(src_data, m_symbol_length, symbol_data);
+                    std::copy_n(src_coefficients, m_coefficients_length,
+                                coefficients);
+
+                    if(!fifi::is_binary<field_type>::value && c != 1)
+                    {
+                        fifi::multiply_constant(m_field, c, symbol_data,
+                                                m_symbol_length);
+
+                        fifi::multiply_constant(m_field, c, coefficients,
+                                                m_coefficients_length);
+                    }
+
+                    empty = false;
+                }
+                else if(fifi::is_binary<field_type>::value)
+                {
+                    fifi::add(m_field, symbol_data, src_data,
+                              m_symbol_length);
+
+                    fifi::add(m_field, coefficients, src_coefficients,
+                              m_coefficients_length);
+                }
+                else
+                {
+                    fifi::multiply_add(m_field, c, symbol_data, src_data,
+                                       &m_temp[0], m_symbol_length);
+
+                    fifi::multiply_add(m_field, c, coefficients,
+                                       src_coefficients, &m_temp[0],
+                                       m_coefficients_length);
+                }
+            }
+
+            if(empty)
+            {
+                std::fill_n(payload, m_symbol_size, 0);
+                std::fill_n(header + sizeof(flag_type),
+                            m_coefficients_size, 0);
+            }
+
+            return m_symbol_size + sizeof(flag_type) + m_coefficients_size;
+        }
+
+    private:
+
+        /// The number of symbols in a generation
+        uint32_t m_symbols;
+
+        /// The size of a symbol in bytes
+        uint32_t m_symbol_size;
+
+        /// The length of a symbol in field values
+        uint32_t m_symbol_length;
+
+        /// The size of a coefficient vector in bytes
+        uint32_t m_coefficients_size;
+
+        /// The length of a coefficient vector in field values
+        uint32_t m_coefficients_length;
+
+        /// The maximum number of buffered payloads
+        uint32_t m_capacity;
+
+        /// The number of buffered payloads
+        uint32_t m_buffered;
+
+        /// The buffer receiving the next payload
+        uint32_t m_next;
+
+        /// The symbol data of the buffered payloads
+        std::vector<value_type> m_symbol_data;
+
+        /// The coefficient vectors of the buffered payloads
+        std::vector<value_type> m_coefficients;
+
+        /// Temporary buffer used by the field arithmetics
+        std::vector<value_type> m_temp;
+
+        /// The finite field implementation
+        field_impl m_field;
+
+        /// The type of the value_type distribution
+        typedef boost::random::uniform_int_distribution<value_type>
+            value_type_distribution;
+
+        /// The distribution of the recoding coefficients
+        value_type_distribution m_value_distribution;
+
+        /// The random generator of the recoding coefficients
+        boost::random::mt19937 m_random_generator;
+
+    };
+
+}
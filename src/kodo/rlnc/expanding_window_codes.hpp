@@ -0,0 +1,126 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../symbol_id_encoder.hpp"
+#include "../symbol_id_decoder.hpp"
+#include "../plain_symbol_id_reader.hpp"
+#include "../plain_symbol_id_writer.hpp"
+#include "../coefficient_storage.hpp"
+#include "../coefficient_info.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+#include "../aligned_coefficients_decoder.hpp"
+#include "../expanding_window_generator.hpp"
+#include "../expanding_window_decoder.hpp"
+#include "../band_decoder.hpp"
+
+#include "../linear_block_encoder.hpp"
+#include "../linear_block_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Complete stack implementing an expanding window RLNC
+    ///        encoder, e.g. for the layers of a scalable video.
+    ///
+    /// The key features of this configuration is the following:
+    /// - Systematic encoding (uncoded symbols produced before switching
+    ///   to coding)
+    /// - Every encoding vector only combines the symbols of a window,
+    ///   a prefix of the block chosen per vector, the windows and their
+    ///   weights are set with factory::set_windows().
+    /// - Full encoding vectors, so any decoder of the full RLNC codes
+    ///   may also decode the payloads.
+    /// - Deep symbol storage which makes the encoder allocate its own
+    ///   internal memory.
+    template<class Field>
+    class expanding_window_rlnc_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 plain_symbol_id_writer<
+                 // Coefficient Generator API
+                 expanding_window_generator<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 expanding_window_rlnc_encoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Implementation of an expanding window RLNC decoder.
+    ///
+    /// Adds the following features (including those described for
+    /// the encoder):
+    /// - Band decoder, the elimination of a vector only visits the
+    ///   stored symbols within its window.
+    /// - Expanding window decoder, a prefix of the block is decoded as
+    ///   soon as it is solvable, see decoded_prefix().
+    template<class Field>
+    class expanding_window_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 expanding_window_decoder<
+                 band_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 expanding_window_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+}
@@ -0,0 +1,121 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#ifndef KODO_RLNC_FIXED_FULL_VECTOR_CODES_HPP
+#define KODO_RLNC_FIXED_FULL_VECTOR_CODES_HPP
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../aligned_coefficients_decoder.hpp"
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../fixed_block_info.hpp"
+#include "../fixed_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_batch_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../symbol_id_encoder.hpp"
+#include "../symbol_id_decoder.hpp"
+#include "../coefficient_storage.hpp"
+#include "../fixed_coefficient_info.hpp"
+#include "../plain_symbol_id_reader.hpp"
+#include "../plain_symbol_id_writer.hpp"
+#include "../uniform_generator.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+
+#include "../linear_block_encoder.hpp"
+#include "../linear_block_batch_encoder.hpp"
+#include "../linear_block_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder with the number of symbols and the symbol
+    ///        size fixed at compile-time.
+    ///
+    /// Same configuration as the full_rlnc_encoder, but using the
+    /// fixed_block_info, fixed_coefficient_info and fixed_symbol_storage
+    /// layers. Intended for deployments where a single block geometry
+    /// dominates, e.g. 32 symbols of 1280 bytes, where the compiler can
+    /// specialize the coding loops for the constant lengths.
+    template<class Field, uint32_t Symbols, uint32_t SymbolSize>
+    class fixed_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               fixed_coefficient_info<
+               // Symbol Storage API
+               fixed_symbol_storage<
+               storage_bytes_used<
+               fixed_block_info<Symbols, SymbolSize,
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               fixed_full_rlnc_encoder<Field, Symbols, SymbolSize>
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder with the number of symbols and the symbol
+    ///        size fixed at compile-time.
+    ///
+    /// Same configuration as the full_rlnc_decoder using the fixed
+    /// layers, except that recoding is not supported.
+    template<class Field, uint32_t Symbols, uint32_t SymbolSize>
+    class fixed_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 fixed_coefficient_info<
+                 // Storage API
+                 fixed_symbol_storage<
+                 storage_bytes_used<
+                 fixed_block_info<Symbols, SymbolSize,
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 fixed_full_rlnc_decoder<Field, Symbols, SymbolSize>
+                     > > > > > > > > > > > > > >
+    { };
+
+}
+
+#endif
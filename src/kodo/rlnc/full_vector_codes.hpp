@@ -14,31 +14,70 @@
 #include "../final_coder_factory_pool.hpp"
 #include "../final_coder_factory.hpp"
 #include "../finite_field_math.hpp"
+#include "../simd_finite_field_math.hpp"
+#include "../data_plane_finite_field_math.hpp"
+#include "../bitmatrix_math.hpp"
 #include "../finite_field_info.hpp"
 #include "../zero_symbol_encoder.hpp"
 #include "../systematic_encoder.hpp"
+#include "../concurrent_systematic_encoder.hpp"
 #include "../systematic_decoder.hpp"
 #include "../storage_bytes_used.hpp"
 #include "../storage_block_info.hpp"
 #include "../deep_symbol_storage.hpp"
+#include "../streaming_copy_symbols.hpp"
+#include "../shared_symbol_storage.hpp"
+#include "../adopting_symbol_storage.hpp"
+#include "../shallow_symbol_storage.hpp"
+#include "../partial_shallow_symbol_storage.hpp"
 #include "../payload_encoder.hpp"
+#include "../payload_batch_encoder.hpp"
 #include "../payload_recoder.hpp"
 #include "../payload_decoder.hpp"
+#include "../payload_batch_decoder.hpp"
+#include "../trace_capture_decoder.hpp"
+#include "../adopting_payload_decoder.hpp"
+#include "../aggregate_payload_encoder.hpp"
+#include "../aggregate_payload_decoder.hpp"
 #include "../symbol_id_encoder.hpp"
 #include "../symbol_id_decoder.hpp"
 #include "../coefficient_storage.hpp"
+#include "../pooled_coefficient_storage.hpp"
+#include "../coefficient_release_decoder.hpp"
 #include "../coefficient_info.hpp"
 #include "../plain_symbol_id_reader.hpp"
 #include "../plain_symbol_id_writer.hpp"
+#include "../pivot_feedback_reader.hpp"
+#include "../pivot_feedback_writer.hpp"
+#include "../checksum_encoder.hpp"
+#include "../checksum_decoder.hpp"
+#include "../symbol_decoded_callback_decoder.hpp"
+#include "../concurrent_read_decoder.hpp"
+#include "../coefficient_first_decoder.hpp"
+#include "../merging_decoder.hpp"
 #include "../uniform_generator.hpp"
+#include "../sparse_uniform_generator.hpp"
+#include "../tunable_density_generator.hpp"
 #include "../recoding_symbol_id.hpp"
 #include "../proxy_layer.hpp"
 #include "../storage_aware_encoder.hpp"
+#include "../storage_aware_generator.hpp"
 #include "../encode_symbol_tracker.hpp"
 
 #include "../linear_block_encoder.hpp"
+#include "../bit_sliced_encoder.hpp"
+#include "../linear_block_batch_encoder.hpp"
+#include "../data_plane_batch_encoder.hpp"
 #include "../linear_block_decoder.hpp"
 #include "../linear_block_decoder_delayed.hpp"
+#include "../linear_block_decoder_blocked.hpp"
+#include "../linear_block_decoder_logged.hpp"
+#include "../linear_block_decoder_hybrid.hpp"
+#include "../inactivation_decoder.hpp"
+#include "../markowitz_pivot_decoder.hpp"
+#include "../rank_tracker.hpp"
+#include "../page_allocator.hpp"
+#include "../coder_slab.hpp"
 
 namespace kodo
 {
@@ -54,9 +93,12 @@ namespace kodo
     ///   Encoding vectors are generated using a random uniform generator.
     /// - Deep symbol storage which makes the encoder allocate its own
     ///   internal memory.
+    /// - Batch encoding where a number of payloads are produced in one
+    ///   pass over the symbols.
     template<class Field>
     class full_rlnc_encoder :
         public // Payload Codec API
+               payload_batch_encoder<
                payload_encoder<
                // Codec Header API
                systematic_encoder<
@@ -67,7 +109,7 @@ namespace kodo
                uniform_generator<
                // Codec API
                encode_symbol_tracker<
-               zero_symbol_encoder<
+               linear_block_batch_encoder<
                linear_block_encoder<
                storage_aware_encoder<
                // Coefficient Storage API
@@ -83,7 +125,90 @@ namespace kodo
                final_coder_factory_pool<
                // Final type
                full_rlnc_encoder<Field
-                   > > > > > > > > > > > > > > > > >
+                   > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder sharing a read-only block with other encoders.
+    ///
+    /// Identical to the full_rlnc_encoder except that the symbols are
+    /// set with set_shared_symbols() to a reference counted block, which
+    /// several encoders e.g. one per receiver use without copying it.
+    /// Every encoder has its own generator, which should be seeded per
+    /// receiver for independent coded streams.
+    template<class Field>
+    class shared_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               shared_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               shared_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder for encoding a shared block on several
+    ///        threads.
+    ///
+    /// Identical to the shared_full_rlnc_encoder except that the
+    /// encoders of the threads may share a systematic index, see the
+    /// concurrent_systematic_encoder layer, so every systematic symbol
+    /// is sent by one of them. The encoders are set up by the
+    /// concurrent_encoder.
+    template<class Field>
+    class concurrent_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               concurrent_systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               shared_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               concurrent_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > >
     { };
 
     /// Intermediate stack implementing the recoding functionality of a
@@ -108,11 +233,10 @@ namespace kodo
                  uniform_generator<
                  // Codec API
                  encode_symbol_tracker<
-                 zero_symbol_encoder<
                  linear_block_encoder<
                  // Proxy
                  proxy_layer<
-                 recoding_stack<MainStack>, MainStack> > > > > > > > >
+                 recoding_stack<MainStack>, MainStack> > > > > > > >
     { };
 
     /// @ingroup fec_stacks
@@ -122,9 +246,12 @@ namespace kodo
     /// described for the encoder):
     /// - Recoding using the recoding_stack
     /// - Linear block decoder using Gauss-Jordan elimination.
+    /// - Decoding a batch of payloads with the systematic symbols first,
+    ///   see payload_batch_decoder.
     template<class Field>
     class full_rlnc_decoder
         : public // Payload API
+                 payload_batch_decoder<
                  payload_recoder<recoding_stack,
                  payload_decoder<
                  // Codec Header API
@@ -149,10 +276,1142 @@ namespace kodo
                  final_coder_factory_pool<
                  // Final type
                  full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder adopting the received buffers as symbols
+    ///
+    /// Identical to the full_rlnc_decoder except that the symbols are
+    /// buffers of a symbol_buffer_pool shared with the receiver. A
+    /// payload decoded with decode_adopt() becomes a symbol without
+    /// being copied, see the adopting_payload_decoder and the
+    /// adopting_symbol_storage layers.
+    template<class Field>
+    class adopting_full_rlnc_decoder
+        : public // Payload API
+                 adopting_payload_decoder<
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 adopting_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 adopting_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder with a flat decoding cost per symbol
+    ///
+    /// The stack is the full_rlnc_decoder where the backward
+    /// substitution is spread over the received symbols by the
+    /// linear_block_decoder_hybrid layer.
+    template<class Field>
+    class full_rlnc_decoder_hybrid
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder_hybrid<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 full_rlnc_decoder_hybrid<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder for large generations solving the block with
+    ///        matrix products
+    ///
+    /// Identical to the full_rlnc_decoder except that the symbols are
+    /// decoded by the linear_block_decoder_blocked at full rank, with
+    /// one blocked product of the inverted coefficient matrix and the
+    /// received symbols, instead of a row operation per pivot. Suited
+    /// for generations of hundreds to thousands of symbols in
+    /// fifi::binary8 or fifi::binary16.
+    template<class Field>
+    class blocked_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 linear_block_decoder_blocked<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 blocked_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder recording the decoding as an operation log
+    ///
+    /// Identical to the full_rlnc_decoder except that the
+    /// linear_block_decoder_logged only eliminates the coefficient
+    /// vectors and records the operations on the symbol data, which
+    /// are replayed when the decoder is complete, or separately with
+    /// set_replay_deferred().
+    template<class Field>
+    class logged_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 linear_block_decoder_logged<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 logged_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder allocating its storage with a memory policy
+    ///
+    /// Identical to the full_rlnc_decoder except that the symbol and
+    /// coefficient storage use a page_allocator, e.g. with the
+    /// huge_page_memory policy for blocks of several MB, or the
+    /// first_touch_memory or numa_node_memory policies to place the
+    /// storage on the NUMA node where the decoder runs.
+    template<class Field, class MemoryPolicy = huge_page_memory>
+    class paged_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 basic_coefficient_storage<
+                     page_allocator<uint8_t, MemoryPolicy>,
+                 coefficient_info<
+                 // Storage API
+                 basic_deep_symbol_storage<
+                     page_allocator<uint8_t, MemoryPolicy>,
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 paged_full_rlnc_decoder<Field, MemoryPolicy>
                      > > > > > > > > > > > > > > >
     { };
 
-}
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder only storing the coefficient vectors of the
+    ///        coded symbols
+    ///
+    /// Identical to the full_rlnc_decoder except that the coefficient
+    /// vectors are taken from the pooled_coefficient_storage and are
+    /// returned to it by the coefficient_release_decoder when a symbol
+    /// is uncoded or the decoder is complete. With systematic encoding
+    /// the memory of the coefficients follows the number of lost
+    /// symbols instead of the number of symbols.
+    template<class Field>
+    class pooled_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 coefficient_release_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 pooled_coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 pooled_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
 
-#endif
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder whose storage may be placed in the slab of
+    ///        the decoder
+    ///
+    /// Identical to the full_rlnc_decoder except that the symbol and
+    /// coefficient storage use the slab_allocator. When slabs are
+    /// enabled on the pool of the factory, see
+    /// final_coder_factory_pool::coder_pool::enable_slabs(), the
+    /// decoder and its storage are allocated as one region.
+    template<class Field>
+    class slab_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 basic_coefficient_storage<slab_allocator<uint8_t>,
+                 coefficient_info<
+                 // Storage API
+                 basic_deep_symbol_storage<slab_allocator<uint8_t>,
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 slab_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
 
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder copying the decoded block out with
+    ///        non-temporal stores
+    ///
+    /// Identical to the full_rlnc_decoder except that copy_symbols()
+    /// and copy_symbol() use the streaming_copy_symbols layer, so the
+    /// copy of a decoded block into e.g. an object buffer does not
+    /// evict the working sets of the other decoders on the core.
+    template<class Field>
+    class streaming_full_rlnc_decoder
+        : public // Payload API
+                 payload_batch_decoder<
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 streaming_copy_symbols<
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 streaming_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder using the vectorized region kernels
+    ///
+    /// Identical to the full_rlnc_encoder except that the finite field
+    /// operations use the simd_finite_field_math layer. With
+    /// fifi::binary4 the packed nibbles are multiplied with one table
+    /// lookup per 4 bits, e.g. PSHUFB, which gives almost the decoding
+    /// probability of fifi::binary8 with half the size of the encoding
+    /// vectors.
+    template<class Field>
+    class simd_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               simd_finite_field_math<
+                   typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               simd_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder matching the simd_full_rlnc_encoder
+    ///
+    /// Identical to the full_rlnc_decoder except that the elimination
+    /// uses the simd_finite_field_math layer.
+    template<class Field>
+    class simd_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 simd_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder combining the symbols with XORs only
+    ///
+    /// Identical to the full_rlnc_encoder for fifi::binary8, except that
+    /// the symbols are stored as bit planes by the bit_sliced_encoder
+    /// and multiplied with the bitmatrix_math layer, so encoding makes
+    /// no table lookups. The payloads are the same as those of the
+    /// full_rlnc_encoder and are decoded by the full_rlnc_decoder.
+    template<class Field>
+    class bit_sliced_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               bit_sliced_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               bitmatrix_math<
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               bit_sliced_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder coding over the symbols a decoder is missing
+    ///
+    /// Identical to the full_rlnc_encoder except that the feedback of a
+    /// feedback_full_rlnc_decoder can be passed to read_feedback(),
+    /// after which the encoding vectors only cover the symbols the
+    /// decoder has no pivot for, see the pivot_feedback_reader layer.
+    template<class Field>
+    class feedback_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               pivot_feedback_reader<
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               feedback_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder producing feedback for the
+    ///        feedback_full_rlnc_encoder
+    ///
+    /// The stack is the full_rlnc_decoder where write_feedback()
+    /// serializes the pivots of the decoder, see the
+    /// pivot_feedback_writer layer.
+    template<class Field>
+    class feedback_full_rlnc_decoder
+        : public // Feedback API
+                 pivot_feedback_writer<
+                 // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 feedback_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder computing a checksum of every symbol
+    ///
+    /// Identical to the full_rlnc_encoder except that a CRC32C of every
+    /// symbol is computed when the symbols are set, see the
+    /// checksum_encoder layer. The checksums written by
+    /// write_checksums() are sent with the object metadata and verified
+    /// by the checksum_full_rlnc_decoder.
+    template<class Field>
+    class checksum_full_rlnc_encoder :
+        public // Checksum API
+               checksum_encoder<
+               // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               checksum_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder verifying the symbols against the checksums
+    ///        of the checksum_full_rlnc_encoder
+    ///
+    /// The stack is the full_rlnc_decoder where the checksums are set
+    /// with read_checksums(), the symbols are verified while they are
+    /// decoded, see the checksum_decoder layer.
+    template<class Field>
+    class checksum_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 checksum_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 checksum_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder reporting the symbols as they are decoded
+    ///
+    /// The stack is the full_rlnc_decoder with the
+    /// symbol_decoded_callback_decoder layer, which is required by the
+    /// overlapping_generation_decoder to pass the decoded shared
+    /// symbols between the generations. The symbols are encoded by the
+    /// full_rlnc_encoder.
+    template<class Field>
+    class overlapping_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 symbol_decoded_callback_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 overlapping_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder producing sparse encoding vectors.
+    ///
+    /// The stack is the full_rlnc_encoder using the
+    /// sparse_uniform_generator, the density of the encoding vectors is
+    /// set with set_density(double). The symbols can be decoded by the
+    /// full_rlnc_decoder, or for large generations by the
+    /// sparse_full_rlnc_decoder.
+    template<class Field>
+    class sparse_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               sparse_uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               sparse_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder producing sparse encoding vectors which
+    ///        become denser as the receiver approaches full rank.
+    ///
+    /// The stack is the sparse_full_rlnc_encoder with the
+    /// tunable_density_generator, which uses the density set with
+    /// set_density(double) while the receiver misses many symbols. The
+    /// symbols can be decoded by the full_rlnc_decoder or the
+    /// sparse_full_rlnc_decoder.
+    template<class Field>
+    class tunable_sparse_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               tunable_density_generator<
+               sparse_uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               tunable_sparse_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder for large generations of sparse symbols.
+    ///
+    /// The stack decodes the symbols of the sparse_full_rlnc_encoder,
+    /// or of the full_rlnc_encoder, with the inactivation_decoder which
+    /// avoids the fill-in of the Gauss-Jordan elimination for sparse
+    /// encoding vectors. The symbols are only available once the
+    /// decoding is complete, so recoding is not supported.
+    template<class Field>
+    class sparse_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 inactivation_decoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 sparse_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder choosing the pivots to keep sparse symbols
+    ///        sparse.
+    ///
+    /// The stack is the full_rlnc_decoder with the
+    /// markowitz_pivot_decoder, which lowers the fill-in when decoding
+    /// the symbols of the sparse_full_rlnc_encoder. Unlike the
+    /// sparse_full_rlnc_decoder it decodes symbols progressively and
+    /// supports recoding.
+    template<class Field>
+    class markowitz_full_rlnc_decoder
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 markowitz_pivot_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 markowitz_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder whose decoded symbols may be read by other
+    ///        threads while the decoding continues.
+    ///
+    /// The stack is the full_rlnc_decoder with the
+    /// concurrent_read_decoder layer, which publishes the decoded
+    /// symbols, see concurrent_read_decoder::is_symbol_ready() and
+    /// concurrent_read_decoder::ready_symbol(). Recoding is not
+    /// supported.
+    template<class Field>
+    class concurrent_read_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 concurrent_read_decoder<
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 concurrent_read_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder which may merge the symbols received by
+    ///        other decoders of the same block.
+    ///
+    /// The stack is the full_rlnc_decoder with the
+    /// coefficient_first_decoder and the merging_decoder layers, so a
+    /// block received over several paths may be decoded by a decoder
+    /// per path in parallel and then merged into one of them, see
+    /// merging_decoder::merge(). Recoding is not supported.
+    template<class Field>
+    class merging_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 merging_decoder<
+                 coefficient_first_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 merging_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder producing batches of coded symbols on a
+    ///        data_plane, e.g. an accelerator, for large symbols.
+    ///
+    /// Identical to the full_rlnc_encoder except that a batch of coded
+    /// symbols, see payload_batch_encoder, is computed as one matrix
+    /// product by the data plane set with factory::set_data_plane(),
+    /// see the data_plane_batch_encoder and the
+    /// data_plane_finite_field_math layers.
+    template<class Field>
+    class data_plane_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_batch_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               data_plane_batch_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               data_plane_finite_field_math<
+                   typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               data_plane_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder coding the generations of a stream in the
+    ///        slots of a generation_ring.
+    ///
+    /// The symbols are pointers into the slot of the generation, set as
+    /// the producer writes them, and the encoder codes the symbols it
+    /// has so far, see the storage_aware_encoder and the
+    /// storage_aware_generator. This is the on_the_fly_encoder of the
+    /// encode_on_the_fly example with shallow instead of deep storage.
+    /// The encoder is moved from generation to generation by a
+    /// generation_stream.
+    template<class Field>
+    class ring_full_rlnc_encoder :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               storage_aware_generator<
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               partial_shallow_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               ring_full_rlnc_encoder<Field>
+                   > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder decoding the generations of a stream into the
+    ///        slots of a generation_ring.
+    ///
+    /// The full_rlnc_decoder with mutable shallow storage, so the
+    /// symbols are decoded in place in the slot of the generation. The
+    /// decoder is moved from generation to generation by a
+    /// generation_stream.
+    template<class Field>
+    class ring_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 mutable_shallow_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 ring_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC encoder packing several symbols into each payload.
+    ///
+    /// Identical to the full_rlnc_encoder except that every payload
+    /// holds factory::set_payload_symbols() symbols with a shared
+    /// header, see the aggregate_payload_encoder, e.g. to send several
+    /// symbols in one jumbo frame.
+    template<class Field>
+    class aggregate_full_rlnc_encoder :
+        public // Payload Codec API
+               aggregate_payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               aggregate_full_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder for the payloads of the
+    ///        aggregate_full_rlnc_encoder.
+    ///
+    /// All the symbols of a payload are decoded in one decode() call,
+    /// see the aggregate_payload_decoder. Recoding is not supported,
+    /// since a recoded payload would hold a single symbol.
+    template<class Field>
+    class aggregate_full_rlnc_decoder
+        : public // Payload API
+                 aggregate_payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 aggregate_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Tracks the rank of the symbols of a full_rlnc_encoder
+    ///        received by a decoder.
+    ///
+    /// Only the coefficient vectors are stored, see rank_tracker, the
+    /// symbols are added from their symbol ids, i.e. the coefficients
+    /// written by the plain_symbol_id_writer. The symbol size of the
+    /// factory is not used.
+    template<class Field>
+    class plain_rank_tracker
+        : public // Codec API
+                 rank_tracker<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 plain_rank_tracker<Field>
+                     > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief RLNC decoder recording the payloads it decodes in a
+    ///        payload trace.
+    ///
+    /// Identical to the full_rlnc_decoder except that the payloads are
+    /// written to the payload_trace_writer set with
+    /// factory::set_trace_writer(), in the order they are decoded, see
+    /// the trace_capture_decoder layer. The trace can be replayed into
+    /// any decoder of the full RLNC payload format.
+    template<class Field>
+    class trace_capture_full_rlnc_decoder
+        : public // Payload API
+                 payload_batch_decoder<
+                 trace_capture_decoder<
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 trace_capture_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > > >
+    { };
+
+}
+
+#endif
@@ -14,8 +14,8 @@
 #include "../final_coder_factory_pool.hpp"
 #include "../final_coder_factory.hpp"
 #include "../finite_field_math.hpp"
+#include "../simd_finite_field_math.hpp"
 #include "../finite_field_info.hpp"
-#include "../zero_symbol_encoder.hpp"
 #include "../systematic_encoder.hpp"
 #include "../systematic_decoder.hpp"
 #include "../storage_bytes_used.hpp"
@@ -31,7 +31,10 @@
 #include "../plain_symbol_id_reader.hpp"
 #include "../seed_symbol_id_writer.hpp"
 #include "../seed_symbol_id_reader.hpp"
+#include "../implicit_seed_symbol_id_writer.hpp"
+#include "../implicit_seed_symbol_id_reader.hpp"
 #include "../uniform_generator.hpp"
+#include "../xorshift_uniform_generator.hpp"
 #include "../recoding_symbol_id.hpp"
 #include "../proxy_layer.hpp"
 #include "../storage_aware_encoder.hpp"
@@ -39,6 +42,7 @@
 
 #include "../linear_block_encoder.hpp"
 #include "../linear_block_decoder.hpp"
+#include "../rank_tracker.hpp"
 
 namespace kodo
 {
@@ -67,7 +71,6 @@ namespace kodo
                  uniform_generator<
                  // Codec API
                  encode_symbol_tracker<
-                 zero_symbol_encoder<
                  linear_block_encoder<
                  storage_aware_encoder<
                  // Coefficient Storage API
@@ -83,7 +86,7 @@ namespace kodo
                  final_coder_factory_pool<
                  // Final type
                  seed_rlnc_encoder<Field>
-                     > > > > > > > > > > > > > > > >
+                     > > > > > > > > > > > > > > >
     { };
 
     /// @ingroup fec_stacks
@@ -123,6 +126,258 @@ namespace kodo
                      > > > > > > > > > > > > > > >
     { };
 
+    /// @ingroup fec_stacks
+    /// @brief Seed based RLNC encoder using the xorshift_uniform_generator.
+    ///
+    /// Identical to the seed_rlnc_encoder except for the faster
+    /// coefficient generator. Must be used together with the
+    /// seed_rlnc_xorshift_decoder.
+    template<class Field>
+    class seed_rlnc_xorshift_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 seed_symbol_id_writer<
+                 // Coefficient Generator API
+                 xorshift_uniform_generator<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 seed_rlnc_xorshift_encoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Seed based RLNC decoder using the xorshift_uniform_generator.
+    ///
+    /// Decodes symbols produced by the seed_rlnc_xorshift_encoder.
+    template<class Field>
+    class seed_rlnc_xorshift_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 seed_symbol_id_reader<
+                 // Coefficient Generator API
+                 xorshift_uniform_generator<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 seed_rlnc_xorshift_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Seed based RLNC encoder using the vectorized region
+    ///        kernels
+    ///
+    /// Identical to the seed_rlnc_encoder except that the finite field
+    /// operations use the simd_finite_field_math layer, see the
+    /// simd_full_rlnc_encoder.
+    template<class Field>
+    class simd_seed_rlnc_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 seed_symbol_id_writer<
+                 // Coefficient Generator API
+                 uniform_generator<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 simd_seed_rlnc_encoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Seed based RLNC decoder matching the
+    ///        simd_seed_rlnc_encoder
+    template<class Field>
+    class simd_seed_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 seed_symbol_id_reader<
+                 // Coefficient Generator API
+                 uniform_generator<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 simd_seed_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Seed based RLNC encoder where the seed is not sent.
+    ///
+    /// Identical to the seed_rlnc_encoder except that the seed is
+    /// derived from a sequence number set with set_sequence_number()
+    /// before every encode, see implicit_seed_symbol_id_writer. A coded
+    /// payload only carries the systematic flag besides the symbol.
+    /// Must be used together with the implicit_seed_rlnc_decoder.
+    template<class Field>
+    class implicit_seed_rlnc_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 implicit_seed_symbol_id_writer<
+                 // Coefficient Generator API
+                 uniform_generator<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 implicit_seed_rlnc_encoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Seed based RLNC decoder where the seed is not received.
+    ///
+    /// Decodes symbols produced by the implicit_seed_rlnc_encoder, the
+    /// sequence number of a payload must be set with
+    /// set_sequence_number() before it is decoded.
+    template<class Field>
+    class implicit_seed_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 implicit_seed_symbol_id_reader<
+                 // Coefficient Generator API
+                 uniform_generator<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 implicit_seed_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Tracks the rank of the symbols of a seed_rlnc_encoder
+    ///        received by a decoder.
+    ///
+    /// Only the coefficient vectors are stored, see rank_tracker, the
+    /// symbols are added from their symbol ids, i.e. the seeds. The
+    /// symbol size of the factory is not used.
+    template<class Field>
+    class seed_rank_tracker
+        : public // Codec API
+                 rank_tracker<
+                 // Symbol ID API
+                 seed_symbol_id_reader<
+                 // Coefficient Generator API
+                 uniform_generator<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 seed_rank_tracker<Field>
+                     > > > > > > > > >
+    { };
+
 }
 
 #endif
@@ -0,0 +1,368 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Generates coefficients as the LT codes, the number of
+    ///        non-zero coefficients is drawn from the robust soliton
+    ///        distribution.
+    ///
+    /// For k symbols the degree d is drawn with probability
+    /// (rho(d) + tau(d)) / Z, where rho is the ideal soliton
+    /// distribution, rho(1) = 1/k and rho(d) = 1/(d(d-1)), and tau adds
+    /// weight to the small degrees and a spike at k/R with
+    /// R = c ln(k/delta) sqrt(k). The d symbols are then selected
+    /// uniformly, and their coefficients are one in the binary field
+    /// and uniformly drawn non-zero values otherwise. The
+    /// distribution keeps most encoded symbols sparse while releasing
+    /// symbols of degree one throughout the decoding, so the symbols are
+    /// decoded mostly by peeling, see the inactivation_decoder.
+    ///
+    /// As the sparse_geometric_generator the non-zero coefficients of
+    /// the last call to generate() or generate_partial() are kept in a
+    /// compact list, in increasing order of the symbol indices.
+    template<class SuperCoder>
+    class robust_soliton_generator : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The random generator used
+        typedef boost::random::mt19937 generator_type;
+
+        /// @copydoc layer::seed_type
+        typedef generator_type::result_type seed_type;
+
+    public:
+
+        /// Constructor
+        robust_soliton_generator()
+            : m_c(0.1),
+              m_delta(0.5),
+              m_value_distribution(1, field_type::max_value),
+              m_table_symbols(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_indices.reserve(the_factory.max_symbols());
+            m_values.reserve(the_factory.max_symbols());
+            m_selected.resize(the_factory.max_symbols(), 0);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            if(m_table_symbols != the_factory.symbols())
+            {
+                compute_table(the_factory.symbols());
+            }
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            generate_coefficients(coefficients, false);
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate_partial(uint8_t *coefficients)
+        {
+            generate_coefficients(coefficients, true);
+        }
+
+        /// @copydoc layer::seed(seed_type)
+        void seed(seed_type seed_value)
+        {
+            m_random_generator.seed(seed_value);
+        }
+
+        /// Sets the parameters of the robust soliton distribution, the
+        /// encoder and decoder must use the same parameters
+        /// @param c The constant of the spike position, typically
+        ///        between 0.01 and 0.5
+        /// @param delta The bound on the probability of the decoding
+        ///        failing after the expected number of symbols
+        void set_soliton_parameters(double c, double delta)
+        {
+            assert(c > 0);
+            assert(delta > 0);
+            assert(delta < 1.0);
+
+            m_c = c;
+            m_delta = delta;
+
+            compute_table(SuperCoder::symbols());
+        }
+
+        /// @return The c parameter of the distribution
+        double soliton_c() const
+        {
+            return m_c;
+        }
+
+        /// @return The delta parameter of the distribution
+        double soliton_delta() const
+        {
+            return m_delta;
+        }
+
+        /// @return The expected number of non-zero coefficients
+        double average_degree() const
+        {
+            double average = 0;
+            double previous = 0;
+
+            for(uint32_t d = 0; d < m_table.size(); ++d)
+            {
+                average += (d + 1) * (m_table[d] - previous);
+                previous = m_table[d];
+            }
+
+            return average;
+        }
+
+        /// @copydoc sparse_geometric_generator::nonzero_count() const
+        uint32_t nonzero_count() const
+        {
+            return static_cast<uint32_t>(m_indices.size());
+        }
+
+        /// @copydoc sparse_geometric_generator::nonzero_indices() const
+        const uint32_t* nonzero_indices() const
+        {
+            return m_indices.empty() ? 0 : &m_indices[0];
+        }
+
+        /// @copydoc sparse_geometric_generator::nonzero_values() const
+        const value_type* nonzero_values() const
+        {
+            return m_values.empty() ? 0 : &m_values[0];
+        }
+
+    protected:
+
+        /// Computes the cumulative robust soliton distribution
+        /// @param symbols The number of symbols
+        void compute_table(uint32_t symbols)
+        {
+            assert(symbols > 0);
+
+            m_table_symbols = symbols;
+            m_table.resize(symbols);
+
+            double k = symbols;
+            double r = m_c * std::log(k / m_delta) * std::sqrt(k);
+
+            // The spike of tau is at k/R, R is at least one so the
+            // spike stays within the degrees
+            r = std::max(r, 1.0);
+            uint32_t spike = std::max(1U, std::min(
+                symbols, static_cast<uint32_t>(std::floor(k / r))));
+
+            double sum = 0;
+
+            for(uint32_t d = 1; d <= symbols; ++d)
+            {
+                double rho = d == 1 ? 1.0 / k : 1.0 / (double(d) * (d - 1));
+                double tau = 0;
+
+                if(d < spike)
+                {
+                    tau = r / (d * k);
+                }
+                else if(d == spike)
+                {
+                    tau = r * std::log(r / m_delta) / k;
+                }
+
+                sum += rho + std::max(tau, 0.0);
+                m_table[d - 1] = sum;
+            }
+
+            for(auto &value : m_table)
+            {
+                value /= sum;
+            }
+
+            m_table.back() = 1.0;
+        }
+
+        /// Generates the coefficients and the list of non-zero
+        /// coefficients
+        /// @param coefficients The coefficient buffer
+        /// @param partial If true only coefficients for symbols which
+        ///        are pivots are generated
+        void generate_coefficients(uint8_t *coefficients, bool partial)
+        {
+            assert(coefficients != 0);
+            assert(m_table_symbols == SuperCoder::symbols());
+
+            // Since we will not set all coefficients we should ensure
+            // that the non specified ones are zero
+            std::fill_n(coefficients, SuperCoder::coefficients_size(), 0);
+
+            m_indices.clear();
+            m_values.clear();
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            m_candidates.clear();
+
+            if(partial)
+            {
+                for(uint32_t i = 0; i < symbols; ++i)
+                {
+                    if(SuperCoder::symbol_pivot(i))
+                    {
+                        m_candidates.push_back(i);
+                    }
+                }
+            }
+
+            uint32_t candidates = partial ?
+                static_cast<uint32_t>(m_candidates.size()) : symbols;
+
+            if(candidates == 0)
+            {
+                return;
+            }
+
+            double u = m_uniform(m_random_generator);
+
+            uint32_t degree = 1 + static_cast<uint32_t>(
+                std::upper_bound(m_table.begin(), m_table.end() - 1, u) -
+                m_table.begin());
+
+            degree = std::min(degree, candidates);
+
+            select(degree, candidates);
+
+            if(partial)
+            {
+                for(auto &index : m_indices)
+                {
+                    index = m_candidates[index];
+                }
+            }
+
+            std::sort(m_indices.begin(), m_indices.end());
+
+            value_type* c = reinterpret_cast<value_type*>(coefficients);
+
+            for(uint32_t index : m_indices)
+            {
+                value_type coefficient = 1;
+
+                if(!fifi::is_binary<field_type>::value)
+                {
+                    coefficient = m_value_distribution(m_random_generator);
+                }
+
+                fifi::set_value<field_type>(c, index, coefficient);
+                m_values.push_back(coefficient);
+            }
+        }
+
+        /// Selects distinct values uniformly using Floyd's algorithm,
+        /// in time proportional to the number of values selected
+        /// @param count The number of values to select
+        /// @param range The values are selected from [0, range)
+        void select(uint32_t count, uint32_t range)
+        {
+            assert(count <= range);
+
+            for(uint32_t j = range - count; j < range; ++j)
+            {
+                index_distribution distribution(0, j);
+                uint32_t t = distribution(m_random_generator);
+
+                uint32_t value = m_selected[t] ? j : t;
+
+                m_selected[value] = 1;
+                m_indices.push_back(value);
+            }
+
+            for(uint32_t index : m_indices)
+            {
+                m_selected[index] = 0;
+            }
+        }
+
+    private:
+
+        /// The c parameter of the distribution
+        double m_c;
+
+        /// The delta parameter of the distribution
+        double m_delta;
+
+        /// Distribution used for drawing the degree
+        boost::random::uniform_01<double> m_uniform;
+
+        /// The type of the index distribution
+        typedef boost::random::uniform_int_distribution<uint32_t>
+            index_distribution;
+
+        /// The type of the value_type distribution
+        typedef boost::random::uniform_int_distribution<value_type>
+            value_type_distribution;
+
+        /// Distribution that generates random values from a finite field
+        value_type_distribution m_value_distribution;
+
+        /// The random generator
+        boost::random::mt19937 m_random_generator;
+
+        /// The number of symbols of the distribution table
+        uint32_t m_table_symbols;
+
+        /// The cumulative degree distribution, entry d - 1 is the
+        /// probability of a degree of at most d
+        std::vector<double> m_table;
+
+        /// Marks the selected values during the selection
+        std::vector<uint8_t> m_selected;
+
+        /// The pivot symbols for the partial generation
+        std::vector<uint32_t> m_candidates;
+
+        /// The indices of the non-zero coefficients
+        std::vector<uint32_t> m_indices;
+
+        /// The values of the non-zero coefficients
+        std::vector<value_type> m_values;
+
+    };
+}
@@ -0,0 +1,493 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @brief The additive fast Fourier transform over GF(2^16) of Lin,
+    ///        Chung and Han, used by the FFT based Reed-Solomon codes.
+    ///
+    /// The transform evaluates a polynomial of size n, a power of two,
+    /// given in the novel polynomial basis of Lin, Chung and Han at the
+    /// n points of a coset of a subspace of the field, and the inverse
+    /// transform interpolates the polynomial, both in O(n log n) field
+    /// operations. The points are the elements whose coordinates in the
+    /// Cantor basis are offset, ..., offset + n - 1. The field is
+    /// represented in the Cantor basis as well, i.e. a value is the
+    /// coordinates of the element, so the tables of this class are not
+    /// compatible with the fifi::binary16 field. The field is defined by
+    /// x^16 + x^5 + x^3 + x^2 + 1.
+    ///
+    /// The transforms work on whole symbols, each point is a symbol of
+    /// length values which are transformed independently. Besides the
+    /// log and exp tables, the class holds the skew factors of the
+    /// transforms, the factors of the formal derivative and the logs
+    /// needed to evaluate an error locator polynomial with the fast
+    /// Walsh-Hadamard transform. It is immutable once constructed, see
+    /// shared_field().
+    class additive_fft
+    {
+    public:
+
+        /// The value type of the field
+        typedef uint16_t value_type;
+
+        /// The number of elements in the field
+        static const uint32_t order = 65536;
+
+        /// The order of the multiplicative group, the logs are taken
+        /// modulo this value
+        static const uint32_t modulus = 65535;
+
+        /// The number of bits in a value
+        static const uint32_t degree = 16;
+
+    public:
+
+        /// Constructor, builds the tables
+        additive_fft()
+            : m_log(order),
+              m_exp(2 * order),
+              m_skew(order),
+              m_derivative(order / 2),
+              m_log_walsh(order)
+        {
+            build_log_exp();
+            build_factors();
+        }
+
+        /// @param value A non-zero value
+        /// @return The discrete log of the value
+        value_type log(value_type value) const
+        {
+            assert(value != 0);
+            return m_log[value];
+        }
+
+        /// @param a A value
+        /// @param log_b The log of a non-zero value
+        /// @return The product of a and the value with log log_b
+        value_type multiply(value_type a, uint32_t log_b) const
+        {
+            assert(log_b <= modulus);
+            return a == 0 ? 0 : m_exp[m_log[a] + log_b];
+        }
+
+        /// Multiplies a symbol with a constant
+        /// @param symbol The symbol
+        /// @param log_b The log of the constant
+        /// @param length The length of the symbol in values
+        void multiply(value_type *symbol, uint32_t log_b,
+                      uint32_t length) const
+        {
+            assert(symbol != 0);
+
+            if(log_b == 0 || log_b == modulus)
+            {
+                return;
+            }
+
+            for(uint32_t i = 0; i < length; ++i)
+            {
+                symbol[i] = multiply(symbol[i], log_b);
+            }
+        }
+
+        /// Adds a symbol to another
+        /// @param dest The symbol added to
+        /// @param src The symbol added
+        /// @param length The length of the symbols in values
+        void add(value_type *dest, const value_type *src,
+                 uint32_t length) const
+        {
+            assert(dest != 0);
+            assert(src != 0);
+
+            for(uint32_t i = 0; i < length; ++i)
+            {
+                dest[i] ^= src[i];
+            }
+        }
+
+        /// Adds the product of a symbol and a constant to another
+        /// @param dest The symbol added to
+        /// @param src The symbol multiplied and added
+        /// @param log_b The log of the constant
+        /// @param length The length of the symbols in values
+        void multiply_add(value_type *dest, const value_type *src,
+                          uint32_t log_b, uint32_t length) const
+        {
+            assert(dest != 0);
+            assert(src != 0);
+
+            for(uint32_t i = 0; i < length; ++i)
+            {
+                dest[i] ^= multiply(src[i], log_b);
+            }
+        }
+
+        /// Interpolates the polynomial, in the novel basis, whose
+        /// evaluations at the points offset, ..., offset + size - 1 are
+        /// the symbols. The symbols are replaced by the coefficients.
+        /// @param symbols The symbols
+        /// @param size The number of symbols, a power of two
+        /// @param offset The first point, a multiple of size
+        /// @param length The length of the symbols in values
+        void inverse_transform(value_type **symbols, uint32_t size,
+                               uint32_t offset, uint32_t length) const
+        {
+            assert(symbols != 0);
+            assert(is_power_of_two(size));
+            assert(offset % size == 0);
+            assert(offset + size <= order);
+
+            for(uint32_t width = 1; width < size; width <<= 1)
+            {
+                for(uint32_t j = width; j < size; j += width << 1)
+                {
+                    uint32_t skew = m_skew[j + offset - 1];
+
+                    for(uint32_t i = j - width; i < j; ++i)
+                    {
+                        add(symbols[i + width], symbols[i], length);
+
+                        if(skew != modulus)
+                        {
+                            multiply_add(symbols[i], symbols[i + width],
+                                         skew, length);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// Evaluates the polynomial of size coefficients in the novel
+        /// basis given by the symbols at the points offset, ...,
+        /// offset + size - 1. The symbols are replaced by the
+        /// evaluations.
+        /// @copydetails inverse_transform(value_type**, uint32_t,
+        ///                                uint32_t, uint32_t) const
+        void transform(value_type **symbols, uint32_t size,
+                       uint32_t offset, uint32_t length) const
+        {
+            assert(symbols != 0);
+            assert(is_power_of_two(size));
+            assert(offset % size == 0);
+            assert(offset + size <= order);
+
+            for(uint32_t width = size >> 1; width > 0; width >>= 1)
+            {
+                for(uint32_t j = width; j < size; j += width << 1)
+                {
+                    uint32_t skew = m_skew[j + offset - 1];
+
+                    for(uint32_t i = j - width; i < j; ++i)
+                    {
+                        if(skew != modulus)
+                        {
+                            multiply_add(symbols[i], symbols[i + width],
+                                         skew, length);
+                        }
+
+                        add(symbols[i + width], symbols[i], length);
+                    }
+                }
+            }
+        }
+
+        /// Replaces the coefficients of a polynomial in the novel basis
+        /// with the coefficients of its formal derivative
+        /// @param symbols The coefficients
+        /// @param size The number of coefficients, a power of two
+        /// @param length The length of the symbols in values
+        void formal_derivative(value_type **symbols, uint32_t size,
+                               uint32_t length) const
+        {
+            assert(symbols != 0);
+            assert(is_power_of_two(size));
+
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                multiply(symbols[i], modulus - m_derivative[i >> 1],
+                         length);
+            }
+
+            for(uint32_t i = 1; i < size; ++i)
+            {
+                // The lowest set bit of i
+                uint32_t width = ((i ^ (i - 1)) + 1) >> 1;
+
+                for(uint32_t j = i - width; j < i; ++j)
+                {
+                    add(symbols[j], symbols[j + width], length);
+                }
+            }
+
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                multiply(symbols[i], m_derivative[i >> 1], length);
+            }
+        }
+
+        /// Computes the logs of the evaluations of the error locator
+        /// polynomial, the product of x - p over the erased points p.
+        /// At a point which is not erased the log of the evaluation is
+        /// returned, and at an erased point the log of the inverse of
+        /// the evaluation of the derivative.
+        /// @param erased For every point, true if it is erased
+        /// @param logs The logs, resized to the number of points
+        void error_locator(const std::vector<bool> &erased,
+                           std::vector<uint32_t> &logs) const
+        {
+            assert(erased.size() <= order);
+
+            logs.assign(order, 0);
+
+            for(uint32_t i = 0; i < erased.size(); ++i)
+            {
+                logs[i] = erased[i] ? 1 : 0;
+            }
+
+            // The sum of the logs of x - p over the erased points is a
+            // convolution over XOR, computed with two transforms. The
+            // second transform scales by order, which is 1 modulo the
+            // modulus.
+            walsh(logs);
+
+            for(uint32_t i = 0; i < order; ++i)
+            {
+                logs[i] = static_cast<uint32_t>(
+                    (static_cast<uint64_t>(logs[i]) * m_log_walsh[i]) %
+                    modulus);
+            }
+
+            walsh(logs);
+
+            logs.resize(erased.size());
+
+            for(uint32_t i = 0; i < erased.size(); ++i)
+            {
+                if(erased[i])
+                {
+                    logs[i] = modulus - logs[i];
+                }
+            }
+        }
+
+        /// @param value A number
+        /// @return True if the number is a power of two
+        static bool is_power_of_two(uint32_t value)
+        {
+            return value != 0 && (value & (value - 1)) == 0;
+        }
+
+        /// @param value A number no larger than order
+        /// @return The smallest power of two not less than the number
+        static uint32_t ceil_power_of_two(uint32_t value)
+        {
+            assert(value <= order);
+
+            uint32_t power = 1;
+
+            while(power < value)
+            {
+                power <<= 1;
+            }
+
+            return power;
+        }
+
+    protected:
+
+        /// Builds the log and exp tables of the values in the Cantor
+        /// basis
+        void build_log_exp()
+        {
+            // The Cantor basis in the polynomial basis
+            static const value_type cantor_basis[degree] =
+                {
+                    1, 44234, 15374, 5694, 50562, 60718, 37196, 16402,
+                    27800, 4312, 27250, 47360, 64952, 64308, 65336, 39198
+                };
+
+            // The log of the elements in the polynomial basis
+            std::vector<uint32_t> polynomial_log(order);
+
+            uint32_t state = 1;
+
+            for(uint32_t i = 0; i < modulus; ++i)
+            {
+                polynomial_log[state] = i;
+
+                state <<= 1;
+
+                if(state & order)
+                {
+                    state ^= 0x1002D;
+                }
+            }
+
+            polynomial_log[0] = modulus;
+
+            // The elements of the Cantor basis coordinates
+            std::vector<uint32_t> element(order, 0);
+
+            for(uint32_t i = 0; i < degree; ++i)
+            {
+                uint32_t bit = 1U << i;
+
+                for(uint32_t j = 0; j < bit; ++j)
+                {
+                    element[j + bit] = element[j] ^ cantor_basis[i];
+                }
+            }
+
+            for(uint32_t i = 0; i < order; ++i)
+            {
+                m_log[i] = polynomial_log[element[i]];
+            }
+
+            for(uint32_t i = 0; i < order; ++i)
+            {
+                m_exp[m_log[i]] = static_cast<value_type>(i);
+            }
+
+            m_exp[modulus] = m_exp[0];
+
+            // The exp table is doubled so a sum of two logs needs no
+            // reduction
+            for(uint32_t i = modulus + 1; i < 2 * order; ++i)
+            {
+                m_exp[i] = m_exp[i - modulus];
+            }
+        }
+
+        /// Builds the skew factors of the transforms, the factors of
+        /// the formal derivative and the logs for the error locator
+        void build_factors()
+        {
+            uint32_t base[degree - 1];
+
+            for(uint32_t i = 1; i < degree; ++i)
+            {
+                base[i - 1] = 1U << i;
+            }
+
+            std::vector<uint32_t> skew(order, 0);
+
+            for(uint32_t m = 0; m < degree - 1; ++m)
+            {
+                uint32_t step = 1U << (m + 1);
+
+                skew[(1U << m) - 1] = 0;
+
+                for(uint32_t i = m; i < degree - 1; ++i)
+                {
+                    uint32_t s = 1U << (i + 1);
+
+                    for(uint32_t j = (1U << m) - 1; j < s; j += step)
+                    {
+                        skew[j + s] = skew[j] ^ base[i];
+                    }
+                }
+
+                base[m] = modulus - m_log[multiply(
+                    static_cast<value_type>(base[m]),
+                    m_log[base[m] ^ 1])];
+
+                for(uint32_t i = m + 1; i < degree - 1; ++i)
+                {
+                    base[i] = multiply(
+                        static_cast<value_type>(base[i]),
+                        (m_log[base[i] ^ 1] + base[m]) % modulus);
+                }
+            }
+
+            // The log of a zero skew factor is the modulus, which marks
+            // the multiplications skipped by the transforms
+            for(uint32_t i = 0; i < order; ++i)
+            {
+                m_skew[i] = m_log[skew[i]];
+            }
+
+            base[0] = modulus - base[0];
+
+            for(uint32_t i = 1; i < degree - 1; ++i)
+            {
+                base[i] = (modulus - base[i] + base[i - 1]) % modulus;
+            }
+
+            m_derivative[0] = 0;
+
+            for(uint32_t i = 0; i < degree - 1; ++i)
+            {
+                uint32_t bit = 1U << i;
+
+                for(uint32_t j = 0; j < bit; ++j)
+                {
+                    m_derivative[j + bit] =
+                        (m_derivative[j] + base[i]) % modulus;
+                }
+            }
+
+            for(uint32_t i = 0; i < order; ++i)
+            {
+                m_log_walsh[i] = m_log[i];
+            }
+
+            m_log_walsh[0] = 0;
+
+            walsh(m_log_walsh);
+        }
+
+        /// The fast Walsh-Hadamard transform modulo the modulus
+        /// @param data The order values transformed in place
+        static void walsh(std::vector<uint32_t> &data)
+        {
+            assert(data.size() == order);
+
+            for(uint32_t width = 1; width < order; width <<= 1)
+            {
+                for(uint32_t j = 0; j < order; j += width << 1)
+                {
+                    for(uint32_t i = j; i < j + width; ++i)
+                    {
+                        uint32_t a = data[i];
+                        uint32_t b = data[i + width];
+
+                        data[i] = (a + b) % modulus;
+                        data[i + width] = (a + modulus - b) % modulus;
+                    }
+                }
+            }
+        }
+
+    protected:
+
+        /// The logs of the values, the log of zero is the modulus
+        std::vector<uint32_t> m_log;
+
+        /// The values of the logs, doubled
+        std::vector<value_type> m_exp;
+
+        /// The logs of the skew factors of the transforms
+        std::vector<uint32_t> m_skew;
+
+        /// The logs of the factors of the formal derivative
+        std::vector<uint32_t> m_derivative;
+
+        /// The transformed logs used by the error locator
+        std::vector<uint32_t> m_log_walsh;
+
+    };
+
+}
@@ -0,0 +1,110 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "../matrix.hpp"
+#include "reed_solomon_code_length.hpp"
+
+namespace kodo
+{
+
+    /// @brief Computes a systematic Cauchy generator matrix for the
+    ///        coding coefficients.
+    ///
+    /// The first k rows of the matrix form the identity, followed by
+    /// the rows of the Cauchy matrix C with C[i][j] = 1 / (x_i + y_j)
+    /// where y_j = j for 0 <= j < k and x_i = k + i. Since every square
+    /// submatrix of a Cauchy matrix is non-singular, any k rows of the
+    /// generator matrix are linearly independent, which makes the code
+    /// maximum distance separable as the Vandermonde based code. The
+    /// matrix is stored in row major order, one row per encoded symbol.
+    template<class SuperCoder>
+    class cauchy_matrix : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The generator matrix
+        typedef matrix<field_type> generator_matrix;
+
+    public:
+
+        /// The factory layer associated with this coder. Constructs the
+        /// generator matrix needed for the encoding vectors.
+        class factory : public SuperCoder::factory
+        {
+        protected:
+
+            /// Access to the finite field implementation used stored in
+            /// the finite_field_math layer
+            using SuperCoder::factory::m_field;
+
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t, uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            {
+                // At least one Cauchy row must be available
+                assert(max_symbols < field_type::order - 1);
+            }
+
+            /// Constructs the systematic Cauchy matrix
+            /// @param symbols The number of source symbols to encode
+            /// @return The generator matrix with one row per encoded
+            ///         symbol, see reed_solomon_code_length(), and
+            ///         symbols columns
+            boost::shared_ptr<generator_matrix> construct_matrix(
+                uint32_t symbols)
+            {
+                assert(symbols > 0);
+                assert(symbols < field_type::order - 1);
+                assert(m_field);
+
+                uint32_t rows =
+                    reed_solomon_code_length<field_type>(symbols);
+
+                auto m = boost::make_shared<generator_matrix>(
+                    rows, symbols);
+
+                for(uint32_t i = 0; i < symbols; ++i)
+                {
+                    value_type one = 1U;
+                    m->set_element(i, i, one);
+                }
+
+                for(uint32_t i = symbols; i < rows; ++i)
+                {
+                    for(uint32_t j = 0; j < symbols; ++j)
+                    {
+                        // The x_i and y_j are distinct so the sum,
+                        // which is the XOR, is non-zero
+                        value_type sum = static_cast<value_type>(i ^ j);
+                        assert(sum != 0);
+
+                        value_type c = m_field->invert(sum);
+                        m->set_element(i, j, c);
+                    }
+                }
+
+                return m;
+            }
+
+        };
+
+    };
+
+}
@@ -0,0 +1,113 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../bitmatrix_math.hpp"
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../symbol_id_encoder.hpp"
+#include "../coefficient_info.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+#include "../linear_block_encoder.hpp"
+
+#include "cauchy_matrix.hpp"
+#include "reed_solomon_inverse_decoder.hpp"
+#include "reed_solomon_symbol_id.hpp"
+#include "reed_solomon_symbol_id_writer.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Implementation of a complete Cauchy RS encoder
+    ///
+    /// This configuration has the following features:
+    /// - Systematic encoding (uncoded symbols produced before switching
+    ///   to coding)
+    /// - The coefficients come from a systematic Cauchy matrix.
+    /// - The symbols are combined with the bitmatrix_math layer, so
+    ///   encoding only XORs packets of the symbols. The symbol size must
+    ///   be a multiple of the degree of the field.
+    template<class Field>
+    class cauchy_rs_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id_writer<
+                 cauchy_matrix<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 bitmatrix_math<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 cauchy_rs_encoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Implementation of a complete Cauchy RS decoder
+    ///
+    /// The block is solved with the reed_solomon_inverse_decoder once k
+    /// symbols have been received, and the product of the decoding
+    /// matrix and the received symbols is computed with the
+    /// bitmatrix_math layer, i.e. only with XORs of packets.
+    template<class Field>
+    class cauchy_rs_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 // Codec API
+                 reed_solomon_inverse_decoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id<
+                 cauchy_matrix<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 bitmatrix_math<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 cauchy_rs_decoder<Field>
+                     > > > > > > > > > > > > >
+    { };
+
+}
@@ -0,0 +1,102 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+#include <fifi/field_types.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+#include "../linear_block_encoder.hpp"
+
+#include "fft_reed_solomon_info.hpp"
+#include "fft_reed_solomon_encoder.hpp"
+#include "fft_reed_solomon_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Reed-Solomon encoder over binary16 using the additive FFT,
+    ///        for generations of thousands of symbols.
+    ///
+    /// Produces the source symbols followed by the parity symbols, see
+    /// fft_reed_solomon_info for the number of parity symbols. Instead
+    /// of a generator matrix the parity symbols are computed with the
+    /// additive_fft in O(k log m) field operations per value, see
+    /// fft_reed_solomon_encoder. All parity symbols of a block can be
+    /// read with encode_parity_symbols(). The field arithmetic of the
+    /// transform uses its own representation of binary16, so the code
+    /// is only decoded by the fft_rs_decoder.
+    template<class Field = fifi::binary16>
+    class fft_rs_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 fft_reed_solomon_encoder<
+                 fft_reed_solomon_info<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 fft_rs_encoder<Field>
+                     > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Reed-Solomon decoder matching the fft_rs_encoder
+    ///
+    /// The received symbols are buffered until the block can be
+    /// decoded, the erased source symbols are then recovered with the
+    /// additive_fft in O(n log n) field operations per value, where n
+    /// is the number of source and parity symbols rounded up to a power
+    /// of two, see fft_reed_solomon_decoder.
+    template<class Field = fifi::binary16>
+    class fft_rs_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 fft_reed_solomon_decoder<
+                 fft_reed_solomon_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 fft_rs_decoder<Field>
+                     > > > > > > > > > >
+    { };
+
+}
@@ -0,0 +1,317 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Decodes a block of an FFT based Reed-Solomon code, see
+    ///        fft_reed_solomon_info and fft_reed_solomon_encoder.
+    ///
+    /// The received symbols are buffered until k of them have been
+    /// received, the erased source symbols are then recovered with the
+    /// erasure decoding of Lin, Chung and Han: the received symbols are
+    /// multiplied with the error locator polynomial, whose evaluations
+    /// are computed with the fast Walsh-Hadamard transform, the product
+    /// is interpolated with an inverse transform, its formal derivative
+    /// is evaluated with a transform and divided by the derivative of
+    /// the error locator at the erased points. For a transform of n
+    /// points this costs O(n log n) field operations per value of a
+    /// symbol, and O(65536 log 65536) operations to locate the erasures
+    /// of the block, independent of the symbol size.
+    ///
+    /// The layer provides the Codec Header API below the
+    /// systematic_decoder.
+    template<class SuperCoder>
+    class fft_reed_solomon_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer providing the size of the header
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_header_size() const
+            uint32_t max_header_size() const
+            {
+                return sizeof(value_type);
+            }
+        };
+
+    public:
+
+        /// Constructor
+        fft_reed_solomon_decoder()
+            : m_rank(0),
+              m_coded(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            uint32_t symbols = the_factory.symbols();
+            uint32_t parity_symbols = SuperCoder::parity_symbols();
+
+            m_received.assign(symbols + parity_symbols, false);
+            m_parity_data.resize(
+                parity_symbols * SuperCoder::symbol_length());
+
+            m_rank = 0;
+            m_coded = 0;
+        }
+
+        /// Buffers a symbol, the header contains its index
+        /// @copydoc layer::decode(uint8_t*, uint8_t*)
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint32_t index =
+                sak::big_endian::get<value_type>(symbol_header);
+
+            assert(index < m_received.size());
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            if(index < symbols)
+            {
+                decode_symbol(symbol_data, index);
+                return;
+            }
+
+            if(is_complete() || m_received[index])
+            {
+                return;
+            }
+
+            uint32_t symbol_length = SuperCoder::symbol_length();
+
+            std::copy_n(reinterpret_cast<const value_type*>(symbol_data),
+                        symbol_length,
+                        &m_parity_data[(index - symbols) * symbol_length]);
+
+            ++m_coded;
+            receive(index);
+        }
+
+        /// Stores an uncoded symbol directly in the symbol storage
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            if(is_complete() || m_received[symbol_index])
+            {
+                return;
+            }
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        SuperCoder::symbol(symbol_index));
+
+            receive(symbol_index);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_rank == SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_rank;
+        }
+
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return is_complete() || m_received[index];
+        }
+
+        /// @copydoc layer::header_size() const
+        uint32_t header_size() const
+        {
+            return sizeof(value_type);
+        }
+
+    protected:
+
+        /// Records a received symbol and recovers the block when k
+        /// symbols have been received
+        /// @param index The index of the received symbol
+        void receive(uint32_t index)
+        {
+            m_received[index] = true;
+            ++m_rank;
+
+            if(is_complete() && m_coded > 0)
+            {
+                recover();
+            }
+        }
+
+        /// Recovers the erased source symbols, tile by tile
+        void recover()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t parity_symbols = SuperCoder::parity_symbols();
+            uint32_t parity_size = SuperCoder::m_parity_size;
+            uint32_t size = SuperCoder::m_transform_size;
+            uint32_t symbol_length = SuperCoder::symbol_length();
+
+            // The points of the parity symbols which are not encoded
+            // are erased, the zero points after the source symbols are
+            // known
+            m_erased.assign(size, false);
+
+            for(uint32_t j = 0; j < parity_size; ++j)
+            {
+                m_erased[j] = j >= parity_symbols ||
+                    !m_received[symbols + j];
+            }
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                m_erased[parity_size + i] = !m_received[i];
+            }
+
+            SuperCoder::m_fft->error_locator(m_erased, m_locator);
+
+            uint32_t tile_length = SuperCoder::tile_length(size);
+
+            m_work.resize(size * tile_length);
+            m_tiles.resize(size);
+
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                m_tiles[i] = &m_work[i * tile_length];
+            }
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += tile_length)
+            {
+                uint32_t length = std::min(tile_length,
+                                           symbol_length - offset);
+
+                for(uint32_t p = 0; p < size; ++p)
+                {
+                    if(m_erased[p] || p >= parity_size + symbols)
+                    {
+                        std::fill_n(m_tiles[p], length, 0);
+                        continue;
+                    }
+
+                    std::copy_n(point_symbol(p) + offset, length,
+                                m_tiles[p]);
+
+                    SuperCoder::m_fft->multiply(m_tiles[p], m_locator[p],
+                                                length);
+                }
+
+                SuperCoder::m_fft->inverse_transform(
+                    &m_tiles[0], size, 0, length);
+
+                SuperCoder::m_fft->formal_derivative(
+                    &m_tiles[0], size, length);
+
+                SuperCoder::m_fft->transform(&m_tiles[0], size, 0, length);
+
+                for(uint32_t i = 0; i < symbols; ++i)
+                {
+                    uint32_t p = parity_size + i;
+
+                    if(!m_erased[p])
+                    {
+                        continue;
+                    }
+
+                    SuperCoder::m_fft->multiply(m_tiles[p], m_locator[p],
+                                                length);
+
+                    std::copy_n(m_tiles[p], length,
+                                SuperCoder::symbol_value(i) + offset);
+                }
+            }
+        }
+
+        /// @param point A received point of the transform
+        /// @return The symbol received at the point
+        const value_type* point_symbol(uint32_t point) const
+        {
+            assert(!m_erased[point]);
+
+            uint32_t parity_size = SuperCoder::m_parity_size;
+
+            if(point < parity_size)
+            {
+                return &m_parity_data[point * SuperCoder::symbol_length()];
+            }
+
+            assert(point < parity_size + SuperCoder::symbols());
+
+            return SuperCoder::symbol_value(point - parity_size);
+        }
+
+    protected:
+
+        /// The number of symbols received
+        uint32_t m_rank;
+
+        /// The number of parity symbols received
+        uint32_t m_coded;
+
+        /// Tracks which symbols have been received, the source symbols
+        /// followed by the parity symbols
+        std::vector<bool> m_received;
+
+        /// The received parity symbols
+        std::vector<value_type> m_parity_data;
+
+        /// The erased points of the transform
+        std::vector<bool> m_erased;
+
+        /// The logs of the error locator at the points
+        std::vector<uint32_t> m_locator;
+
+        /// The tiles of the points of the transform
+        std::vector<value_type> m_work;
+
+        /// The tiles of the points
+        std::vector<value_type*> m_tiles;
+
+    };
+
+}
@@ -0,0 +1,287 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Encodes a block of an FFT based Reed-Solomon code, see
+    ///        fft_reed_solomon_info.
+    ///
+    /// The parity symbols are the evaluations, at the parity points, of
+    /// the polynomial through the source symbols. They are computed
+    /// together with the additive_fft: the source symbols are split in
+    /// chunks of the parity size, each chunk is interpolated with an
+    /// inverse transform, the sum of the chunks is evaluated with a
+    /// transform. For k source symbols and m parity symbols this costs
+    /// O(k log m) field operations per value of a symbol instead of the
+    /// O(k m) of the generator matrix.
+    ///
+    /// The parity symbols of the block are computed when the first one
+    /// is encoded, after the symbols of the block are set, and kept
+    /// until the symbols change. The symbol id is the index of the
+    /// encoded symbol, the source symbols followed by the parity
+    /// symbols. The layer provides the Codec Header API below the
+    /// systematic_encoder.
+    template<class SuperCoder>
+    class fft_reed_solomon_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer providing the size of the header
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// @copydoc layer::factory::max_header_size() const
+            uint32_t max_header_size() const
+            {
+                return sizeof(value_type);
+            }
+        };
+
+    public:
+
+        /// Constructor
+        fft_reed_solomon_encoder()
+            : m_parity_count(0),
+              m_parity_ready(false)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_parity_count = 0;
+            m_parity_ready = false;
+        }
+
+        /// Encodes the next symbol of the block, the source symbols are
+        /// copied and the parity symbols are read from the parity
+        /// computed with the additive_fft
+        /// @copydoc layer::encode(uint8_t*, uint8_t*)
+        uint32_t encode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t index =
+                SuperCoder::encode_symbol_count() + m_parity_count;
+
+            // A Reed-Solomon code is not rate-less
+            assert(index < symbols + SuperCoder::parity_symbols());
+
+            sak::big_endian::put<value_type>(index, symbol_header);
+
+            if(index < symbols)
+            {
+                SuperCoder::encode_symbol(symbol_data, index);
+            }
+            else
+            {
+                const uint8_t *parity = parity_symbol(index - symbols);
+
+                std::copy_n(parity, SuperCoder::symbol_size(),
+                            symbol_data);
+
+                ++m_parity_count;
+            }
+
+            return sizeof(value_type);
+        }
+
+        /// @copydoc layer::header_size() const
+        uint32_t header_size() const
+        {
+            return sizeof(value_type);
+        }
+
+        /// @return The number of parity symbols of the block
+        uint32_t max_parity_symbols() const
+        {
+            return SuperCoder::parity_symbols();
+        }
+
+        /// Copies parity symbols of the block, the symbols of the
+        /// encoder must be set
+        /// @param parity_symbols The buffers of the parity symbols, each
+        ///        of layer::symbol_size() bytes
+        /// @param first The index of the first parity symbol
+        /// @param count The number of parity symbols to copy
+        void encode_parity_symbols(uint8_t **parity_symbols,
+                                   uint32_t first, uint32_t count)
+        {
+            assert(parity_symbols != 0);
+            assert(first + count <= max_parity_symbols());
+
+            for(uint32_t j = 0; j < count; ++j)
+            {
+                assert(parity_symbols[j] != 0);
+
+                std::copy_n(parity_symbol(first + j),
+                            SuperCoder::symbol_size(), parity_symbols[j]);
+            }
+        }
+
+        /// @param index The index of a parity symbol
+        /// @return The parity symbol, computed with all the other parity
+        ///         symbols of the block if it is not yet computed
+        const uint8_t* parity_symbol(uint32_t index)
+        {
+            assert(index < max_parity_symbols());
+
+            if(!m_parity_ready)
+            {
+                compute_parity();
+            }
+
+            return reinterpret_cast<const uint8_t*>(
+                &m_parity[index * SuperCoder::symbol_length()]);
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            SuperCoder::set_symbols(symbol_storage);
+            m_parity_ready = false;
+        }
+
+        /// @copydoc layer::set_symbol(uint32_t, const sak::const_storage&)
+        void set_symbol(uint32_t index, const sak::const_storage &symbol)
+        {
+            SuperCoder::set_symbol(index, symbol);
+            m_parity_ready = false;
+        }
+
+    protected:
+
+        /// Computes all the parity symbols of the block, tile by tile
+        void compute_parity()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t symbol_length = SuperCoder::symbol_length();
+            uint32_t parity_size = SuperCoder::m_parity_size;
+
+            uint32_t tile_length = SuperCoder::tile_length(parity_size);
+
+            // Every point of the parity size is computed, but only the
+            // first parity_symbols() are encoded
+            m_parity.resize(parity_size * symbol_length);
+            m_chunk.resize(parity_size * tile_length);
+            m_parity_tiles.resize(parity_size);
+            m_chunk_tiles.resize(parity_size);
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += tile_length)
+            {
+                uint32_t length = std::min(tile_length,
+                                           symbol_length - offset);
+
+                for(uint32_t i = 0; i < parity_size; ++i)
+                {
+                    m_parity_tiles[i] =
+                        &m_parity[i * symbol_length + offset];
+                    m_chunk_tiles[i] = &m_chunk[i * tile_length];
+                }
+
+                // The first chunk is interpolated in the parity, the
+                // others are added to it
+                for(uint32_t first = 0; first < symbols;
+                    first += parity_size)
+                {
+                    value_type **tiles = first == 0 ?
+                        &m_parity_tiles[0] : &m_chunk_tiles[0];
+
+                    for(uint32_t i = 0; i < parity_size; ++i)
+                    {
+                        if(first + i < symbols)
+                        {
+                            const value_type *symbol =
+                                SuperCoder::symbol_value(first + i);
+
+                            // Did you forget to set the data on the
+                            // encoder?
+                            assert(symbol != 0);
+
+                            std::copy_n(symbol + offset, length, tiles[i]);
+                        }
+                        else
+                        {
+                            std::fill_n(tiles[i], length, 0);
+                        }
+                    }
+
+                    SuperCoder::m_fft->inverse_transform(
+                        tiles, parity_size, parity_size + first, length);
+
+                    if(first == 0)
+                    {
+                        continue;
+                    }
+
+                    for(uint32_t i = 0; i < parity_size; ++i)
+                    {
+                        SuperCoder::m_fft->add(m_parity_tiles[i],
+                                               m_chunk_tiles[i], length);
+                    }
+                }
+
+                SuperCoder::m_fft->transform(
+                    &m_parity_tiles[0], parity_size, 0, length);
+            }
+
+            m_parity_ready = true;
+        }
+
+    protected:
+
+        /// The number of parity symbols encoded
+        uint32_t m_parity_count;
+
+        /// True if the parity symbols are computed
+        bool m_parity_ready;
+
+        /// The parity symbols of the block
+        std::vector<value_type> m_parity;
+
+        /// The tiles of a chunk of source symbols
+        std::vector<value_type> m_chunk;
+
+        /// The tiles of the parity symbols
+        std::vector<value_type*> m_parity_tiles;
+
+        /// The tiles of the chunk
+        std::vector<value_type*> m_chunk_tiles;
+
+    };
+
+}
@@ -0,0 +1,206 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+
+#include <boost/shared_ptr.hpp>
+
+#include <fifi/field_types.hpp>
+
+#include "../shared_field.hpp"
+#include "additive_fft.hpp"
+#include "reed_solomon_code_length.hpp"
+
+namespace kodo
+{
+
+    /// Returns the default number of parity symbols of an FFT based
+    /// Reed-Solomon code, see fft_reed_solomon_info.
+    ///
+    /// The code has the length of the wide Reed-Solomon codes, see
+    /// reed_solomon_code_length(), unless the parity symbols rounded up
+    /// to a power of two and the source symbols do not fit in the field,
+    /// then the largest power of two which fits is used.
+    /// @param symbols The number of source symbols
+    /// @return The number of parity symbols
+    inline uint32_t fft_reed_solomon_parity_symbols(uint32_t symbols)
+    {
+        assert(symbols > 0);
+        assert(symbols < additive_fft::order);
+
+        uint32_t parity =
+            reed_solomon_code_length<fifi::binary16>(symbols) - symbols;
+
+        uint32_t limit = additive_fft::order - symbols;
+
+        if(additive_fft::ceil_power_of_two(parity) <= limit)
+        {
+            return parity;
+        }
+
+        uint32_t power = 1;
+
+        while(2 * power <= limit)
+        {
+            power *= 2;
+        }
+
+        return power;
+    }
+
+    /// @ingroup codec_layers
+    /// @brief Holds the layout of a block of an FFT based Reed-Solomon
+    ///        code over binary16 on the points of the additive_fft.
+    ///
+    /// The parity symbols are placed on the first points, rounded up to
+    /// a power of two, and the source symbols follow, so the code is
+    /// systematic. The points after the source symbols, up to the size
+    /// of the transform, are zero. The number of parity symbols is set
+    /// on the factory and must be the same for the encoder and the
+    /// decoder of a block.
+    template<class SuperCoder>
+    class fft_reed_solomon_info : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        static_assert(std::is_same<field_type, fifi::binary16>::value,
+                      "The FFT based Reed-Solomon codes use binary16");
+
+        /// The size in bytes of the tiles of all the points of a
+        /// transform, which should fit in the L2 cache
+        static const uint32_t transform_tile_size = 262144;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer holding the number of parity symbols
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_parity_symbols(0)
+            { }
+
+            /// Sets the number of parity symbols of the coders built
+            /// after this call
+            /// @param parity_symbols The number of parity symbols, or
+            ///        zero for fft_reed_solomon_parity_symbols()
+            void set_parity_symbols(uint32_t parity_symbols)
+            {
+                m_parity_symbols = parity_symbols;
+            }
+
+            /// @return The number of parity symbols of the next coder
+            uint32_t parity_symbols() const
+            {
+                if(m_parity_symbols == 0)
+                {
+                    return fft_reed_solomon_parity_symbols(
+                        SuperCoder::factory::symbols());
+                }
+
+                return m_parity_symbols;
+            }
+
+        protected:
+
+            /// The number of parity symbols, zero for the default
+            uint32_t m_parity_symbols;
+
+        };
+
+    public:
+
+        /// Constructor
+        fft_reed_solomon_info()
+            : m_parity_symbols(0),
+              m_parity_size(0),
+              m_transform_size(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_fft = shared_field<additive_fft>();
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            uint32_t symbols = the_factory.symbols();
+
+            m_parity_symbols = the_factory.parity_symbols();
+            m_parity_size =
+                additive_fft::ceil_power_of_two(m_parity_symbols);
+
+            // The parity and source symbols must fit in the field
+            assert(m_parity_size + symbols <= additive_fft::order);
+
+            m_transform_size =
+                additive_fft::ceil_power_of_two(m_parity_size + symbols);
+        }
+
+        /// @return The number of parity symbols of the block
+        uint32_t parity_symbols() const
+        {
+            return m_parity_symbols;
+        }
+
+    protected:
+
+        /// The symbols are transformed in tiles, so the tiles of all the
+        /// points stay in the cache during the log n passes of a
+        /// transform
+        /// @param points The number of points of the transform
+        /// @return The length in values of the tile of a symbol
+        uint32_t tile_length(uint32_t points) const
+        {
+            assert(points > 0);
+
+            // At least a cache line of every symbol
+            uint32_t length = std::max<uint32_t>(
+                32U, transform_tile_size / (points * sizeof(value_type)));
+
+            return std::min(length, SuperCoder::symbol_length());
+        }
+
+    protected:
+
+        /// The additive FFT
+        boost::shared_ptr<additive_fft> m_fft;
+
+        /// The number of parity symbols
+        uint32_t m_parity_symbols;
+
+        /// The number of points of the parity symbols, the first
+        /// source symbol is at this point
+        uint32_t m_parity_size;
+
+        /// The number of points of the transforms of the block
+        uint32_t m_transform_size;
+
+    };
+
+}
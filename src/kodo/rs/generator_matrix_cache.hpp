@@ -0,0 +1,225 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <string>
+#include <fstream>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "../matrix.hpp"
+
+namespace kodo
+{
+
+    /// @brief Process-wide cache of generator matrices.
+    ///
+    /// The cache holds the generator matrices of one type, identified by
+    /// the Tag, for every number of symbols. The matrices can be saved
+    /// to and loaded from a file, so a process can start with matrices
+    /// computed by an earlier run or at build time. The file stores a
+    /// header followed by the rows, columns, number of symbols and the
+    /// raw data of every matrix in the byte order of the machine.
+    template<class Field, class Tag>
+    class generator_matrix_cache : boost::noncopyable
+    {
+    public:
+
+        /// The finite field type used
+        typedef Field field_type;
+
+        /// The value type used in the finite field
+        typedef typename field_type::value_type value_type;
+
+        /// The generator matrix type
+        typedef matrix<field_type> generator_matrix;
+
+        /// The pointer to a generator matrix
+        typedef boost::shared_ptr<generator_matrix> matrix_pointer;
+
+        /// Identifies the files written by save(const std::string&)
+        static const uint32_t file_magic = 0x4b474d31;
+
+    public:
+
+        /// @return The cache of the process
+        static generator_matrix_cache& instance()
+        {
+            static generator_matrix_cache cache;
+            return cache;
+        }
+
+        /// @param symbols The number of symbols of the matrix
+        /// @return The cached matrix or null if it is not cached
+        matrix_pointer find(uint32_t symbols) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = m_matrices.find(symbols);
+
+            if(it == m_matrices.end())
+                return matrix_pointer();
+
+            return it->second;
+        }
+
+        /// Adds a matrix to the cache unless a matrix for the number of
+        /// symbols was added in the meantime
+        /// @param symbols The number of symbols of the matrix
+        /// @param m The matrix
+        /// @return The cached matrix
+        matrix_pointer insert(uint32_t symbols, const matrix_pointer &m)
+        {
+            assert(m);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_matrices.insert(std::make_pair(symbols, m)).first->second;
+        }
+
+        /// @return The number of cached matrices
+        uint32_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return static_cast<uint32_t>(m_matrices.size());
+        }
+
+        /// Removes all matrices from the cache, the coders keep the
+        /// matrices they use
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_matrices.clear();
+        }
+
+        /// Writes the cached matrices to a file
+        /// @param filename The file to write
+        /// @return True if the file was written
+        bool save(const std::string &filename) const
+        {
+            std::ofstream file(filename, std::ios::binary);
+
+            if(!file.is_open())
+                return false;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            write_value(file, file_magic);
+            write_value(file, uint32_t(sizeof(value_type)));
+            write_value(file, uint32_t(m_matrices.size()));
+
+            for(const auto &entry : m_matrices)
+            {
+                const generator_matrix &m = *entry.second;
+
+                write_value(file, entry.first);
+                write_value(file, m.rows());
+                write_value(file, m.columns());
+
+                for(uint32_t i = 0; i < m.rows(); ++i)
+                {
+                    file.write(reinterpret_cast<const char*>(m.row(i)),
+                               m.row_size());
+                }
+            }
+
+            return bool(file);
+        }
+
+        /// Adds the matrices of a file written by save() to the cache,
+        /// matrices already cached are kept. Nothing is added if the
+        /// file cannot be read or was written for another field.
+        /// @param filename The file to read
+        /// @return True if the file was read
+        bool load(const std::string &filename)
+        {
+            std::ifstream file(filename, std::ios::binary);
+
+            if(!file.is_open())
+                return false;
+
+            uint32_t magic = 0;
+            uint32_t value_size = 0;
+            uint32_t count = 0;
+
+            if(!read_value(file, magic) || magic != file_magic ||
+               !read_value(file, value_size) ||
+               value_size != sizeof(value_type) ||
+               !read_value(file, count))
+            {
+                return false;
+            }
+
+            std::map<uint32_t, matrix_pointer> matrices;
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t symbols = 0;
+                uint32_t rows = 0;
+                uint32_t columns = 0;
+
+                if(!read_value(file, symbols) || !read_value(file, rows) ||
+                   !read_value(file, columns) || rows == 0 || columns == 0)
+                {
+                    return false;
+                }
+
+                auto m = boost::make_shared<generator_matrix>(rows, columns);
+
+                for(uint32_t j = 0; j < rows; ++j)
+                {
+                    file.read(reinterpret_cast<char*>(m->row(j)),
+                              m->row_size());
+                }
+
+                if(!file)
+                    return false;
+
+                matrices[symbols] = m;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_matrices.insert(matrices.begin(), matrices.end());
+
+            return true;
+        }
+
+    private:
+
+        /// Only the instance() is used
+        generator_matrix_cache()
+        { }
+
+        /// Writes a value to a file
+        static void write_value(std::ofstream &file, uint32_t value)
+        {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        /// Reads a value from a file
+        /// @return True if the value was read
+        static bool read_value(std::ifstream &file, uint32_t &value)
+        {
+            file.read(reinterpret_cast<char*>(&value), sizeof(value));
+            return bool(file);
+        }
+
+    private:
+
+        /// Protects the matrices
+        mutable std::mutex m_mutex;
+
+        /// The matrices by number of symbols
+        std::map<uint32_t, matrix_pointer> m_matrices;
+
+    };
+
+}
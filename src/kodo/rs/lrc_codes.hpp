@@ -0,0 +1,124 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../symbol_id_encoder.hpp"
+#include "../symbol_id_decoder.hpp"
+#include "../coefficient_storage.hpp"
+#include "../coefficient_info.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+#include "../linear_block_encoder.hpp"
+#include "../linear_block_decoder.hpp"
+#include "../symbol_decoded_callback_decoder.hpp"
+
+#include "reed_solomon_parity_encoder.hpp"
+#include "reed_solomon_symbol_id_writer.hpp"
+#include "reed_solomon_symbol_id_reader.hpp"
+#include "lrc_matrix.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Complete stack implementing a locally repairable code
+    ///        (LRC) encoder.
+    ///
+    /// The encoder works as the rs_encoder with the generator matrix of
+    /// the lrc_matrix: the systematic symbols are followed by one local
+    /// parity per group of GroupSize source symbols and then by the
+    /// global parities. The local and global parities of a block are
+    /// computed in one pass with encode_parity_symbols(), where parity
+    /// symbol g < layout().groups() is the local parity of group g.
+    template<class Field, uint32_t GroupSize = 4>
+    class lrc_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Codec API
+                 reed_solomon_parity_encoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id_writer<
+                 lrc_matrix<GroupSize,
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 lrc_encoder<Field, GroupSize>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Implementation of a complete LRC decoder
+    ///
+    /// The decoder is the rs_decoder with the lrc_matrix and the
+    /// symbol_decoded_callback_decoder, so a lost source symbol is known
+    /// to be repaired before the block is complete. Local repair is
+    /// preferred by feeding the payloads in the order given by
+    /// layout().read_order(): a source symbol lost alone in its group is
+    /// decoded, see is_symbol_decoded(), once the other rows of its
+    /// group, layout().repair_rows(), have been received. Otherwise the
+    /// decoding falls back to the global parities, reading until the
+    /// block is complete as for the rs_decoder.
+    template<class Field, uint32_t GroupSize = 4>
+    class lrc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id_reader<
+                 lrc_matrix<GroupSize,
+                 // Codec API
+                 symbol_decoded_callback_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 lrc_decoder<Field, GroupSize>
+                     > > > > > > > > > > > > > > >
+    { };
+
+}
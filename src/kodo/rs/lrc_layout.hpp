@@ -0,0 +1,218 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+namespace kodo
+{
+
+    /// @brief The rows of the generator matrix of a locally repairable
+    ///        code, see lrc_matrix.
+    ///
+    /// The k source symbols are split into local groups of at most
+    /// group_size() consecutive symbols. Row i < k of the generator
+    /// matrix is source symbol i, row k + g is the local parity of
+    /// group g, the sum of the symbols of the group, and the rows that
+    /// follow are the global parities over all source symbols. A lost
+    /// source symbol or local parity is repaired from the other rows of
+    /// its group, i.e. from group_size() symbols instead of k.
+    class lrc_layout
+    {
+    public:
+
+        /// Constructs the layout of a block
+        /// @param symbols The number of source symbols
+        /// @param group_size The largest number of source symbols in a
+        ///        local group
+        lrc_layout(uint32_t symbols, uint32_t group_size)
+            : m_symbols(symbols),
+              m_group_size(group_size)
+        {
+            assert(m_symbols > 0);
+            assert(m_group_size > 0);
+
+            m_groups = (m_symbols + m_group_size - 1) / m_group_size;
+        }
+
+        /// @return The number of source symbols
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// @return The largest number of source symbols in a group
+        uint32_t group_size() const
+        {
+            return m_group_size;
+        }
+
+        /// @return The number of local groups, i.e. local parities
+        uint32_t groups() const
+        {
+            return m_groups;
+        }
+
+        /// @return The row of the first global parity
+        uint32_t first_global_row() const
+        {
+            return m_symbols + m_groups;
+        }
+
+        /// @param row A row of the generator matrix
+        /// @return True if the row is a global parity
+        bool is_global_row(uint32_t row) const
+        {
+            return row >= first_global_row();
+        }
+
+        /// @param row A row of the generator matrix
+        /// @return True if the row is a local parity
+        bool is_local_row(uint32_t row) const
+        {
+            return row >= m_symbols && row < first_global_row();
+        }
+
+        /// @param row A source symbol or local parity row
+        /// @return The local group of the row
+        uint32_t group(uint32_t row) const
+        {
+            assert(!is_global_row(row));
+
+            if(row < m_symbols)
+                return row / m_group_size;
+
+            return row - m_symbols;
+        }
+
+        /// @param group A local group
+        /// @return The row of the local parity of the group
+        uint32_t local_row(uint32_t group) const
+        {
+            assert(group < m_groups);
+            return m_symbols + group;
+        }
+
+        /// @param group A local group
+        /// @return The first source symbol of the group
+        uint32_t group_begin(uint32_t group) const
+        {
+            assert(group < m_groups);
+            return group * m_group_size;
+        }
+
+        /// @param group A local group
+        /// @return The source symbol following the last one of the group
+        uint32_t group_end(uint32_t group) const
+        {
+            assert(group < m_groups);
+            return std::min(m_symbols, (group + 1) * m_group_size);
+        }
+
+        /// @param row A source symbol or local parity row
+        /// @return The rows to read to repair the row locally, the other
+        ///         source symbols of its group followed by the local
+        ///         parity, unless the row is the local parity itself
+        std::vector<uint32_t> repair_rows(uint32_t row) const
+        {
+            uint32_t g = group(row);
+
+            std::vector<uint32_t> rows;
+
+            for(uint32_t i = group_begin(g); i < group_end(g); ++i)
+            {
+                if(i != row)
+                    rows.push_back(i);
+            }
+
+            if(row != local_row(g))
+                rows.push_back(local_row(g));
+
+            return rows;
+        }
+
+        /// @param row The row to repair
+        /// @param lost Flags the lost rows, at least first_global_row()
+        ///        entries
+        /// @return True if the row can be repaired from its group, i.e.
+        ///         no other row of the group is lost
+        bool is_locally_repairable(uint32_t row,
+                                   const std::vector<bool> &lost) const
+        {
+            if(is_global_row(row))
+                return false;
+
+            assert(lost.size() >= first_global_row());
+
+            for(uint32_t r : repair_rows(row))
+            {
+                if(lost[r])
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// Orders the rows to read to decode the lost source symbols,
+        /// preferring local repair. The rows repairing a lost source
+        /// symbol from its group come first, followed by all other rows
+        /// which are not lost for the global decoding. The rows are read
+        /// until the lost source symbols are decoded, so a block where
+        /// every lost source symbol is locally repairable only reads the
+        /// groups of the lost symbols.
+        /// @param lost Flags the lost rows, one entry per row of the
+        ///        generator matrix
+        /// @return The rows to read in order
+        std::vector<uint32_t> read_order(const std::vector<bool> &lost) const
+        {
+            assert(lost.size() > first_global_row());
+
+            uint32_t rows = static_cast<uint32_t>(lost.size());
+
+            std::vector<bool> chosen(rows, false);
+            std::vector<uint32_t> order;
+
+            for(uint32_t i = 0; i < m_symbols; ++i)
+            {
+                if(!lost[i] || !is_locally_repairable(i, lost))
+                    continue;
+
+                for(uint32_t r : repair_rows(i))
+                {
+                    if(!chosen[r])
+                    {
+                        chosen[r] = true;
+                        order.push_back(r);
+                    }
+                }
+            }
+
+            for(uint32_t r = 0; r < rows; ++r)
+            {
+                if(!lost[r] && !chosen[r])
+                    order.push_back(r);
+            }
+
+            return order;
+        }
+
+    private:
+
+        /// The number of source symbols
+        uint32_t m_symbols;
+
+        /// The largest number of source symbols in a group
+        uint32_t m_group_size;
+
+        /// The number of local groups
+        uint32_t m_groups;
+
+    };
+
+}
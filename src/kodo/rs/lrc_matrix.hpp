@@ -0,0 +1,155 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "../matrix.hpp"
+#include "lrc_layout.hpp"
+#include "reed_solomon_code_length.hpp"
+
+namespace kodo
+{
+
+    /// @brief Computes the generator matrix of a systematic locally
+    ///        repairable code (LRC).
+    ///
+    /// The rows are laid out as described by the lrc_layout: the
+    /// identity, one local parity per group of GroupSize source
+    /// symbols, whose coefficients are one for the symbols of the group,
+    /// and global parities. The global parities are rows of a Cauchy
+    /// matrix as in the cauchy_matrix, C[i][j] = 1 / (x_i + y_j) with
+    /// y_j = j and x_i = i, the row index, so x_i is never a y_j.
+    ///
+    /// A single lost symbol of a group is repaired by reading the
+    /// GroupSize other rows of the group instead of k rows, which is the
+    /// common case for storage where repair traffic dominates. Other
+    /// erasures are decoded with the global parities, the rows are not
+    /// all independent, so the matrix must be used with the
+    /// linear_block_decoder and not the reed_solomon_inverse_decoder.
+    template<uint32_t GroupSize, class SuperCoder>
+    class lrc_matrix : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The generator matrix
+        typedef matrix<field_type> generator_matrix;
+
+        /// The number of source symbols of a local group
+        static const uint32_t group_size = GroupSize;
+
+        static_assert(GroupSize > 0, "A local group must not be empty");
+
+    public:
+
+        /// The factory layer associated with this coder. Constructs the
+        /// generator matrix needed for the encoding vectors.
+        class factory : public SuperCoder::factory
+        {
+        protected:
+
+            /// Access to the finite field implementation used stored in
+            /// the finite_field_math layer
+            using SuperCoder::factory::m_field;
+
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t, uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            {
+                // At least one global parity must be available
+                assert(lrc_layout(max_symbols, GroupSize).first_global_row()
+                       < reed_solomon_code_length<field_type>(max_symbols));
+            }
+
+            /// @param symbols The number of source symbols
+            /// @return The layout of the rows of a block
+            lrc_layout layout(uint32_t symbols) const
+            {
+                return lrc_layout(symbols, GroupSize);
+            }
+
+            /// Constructs the LRC generator matrix
+            /// @param symbols The number of source symbols to encode
+            /// @return The generator matrix with one row per encoded
+            ///         symbol, see reed_solomon_code_length(), and
+            ///         symbols columns
+            boost::shared_ptr<generator_matrix> construct_matrix(
+                uint32_t symbols)
+            {
+                assert(symbols > 0);
+                assert(m_field);
+
+                lrc_layout rows_layout = layout(symbols);
+
+                uint32_t rows =
+                    reed_solomon_code_length<field_type>(symbols);
+
+                assert(rows > rows_layout.first_global_row());
+
+                auto m = boost::make_shared<generator_matrix>(
+                    rows, symbols);
+
+                value_type one = 1U;
+
+                for(uint32_t i = 0; i < symbols; ++i)
+                {
+                    m->set_element(i, i, one);
+                }
+
+                for(uint32_t g = 0; g < rows_layout.groups(); ++g)
+                {
+                    uint32_t row = rows_layout.local_row(g);
+
+                    for(uint32_t j = rows_layout.group_begin(g);
+                        j < rows_layout.group_end(g); ++j)
+                    {
+                        m->set_element(row, j, one);
+                    }
+                }
+
+                for(uint32_t i = rows_layout.first_global_row();
+                    i < rows; ++i)
+                {
+                    for(uint32_t j = 0; j < symbols; ++j)
+                    {
+                        // The x_i and y_j are distinct so the sum,
+                        // which is the XOR, is non-zero
+                        value_type sum = static_cast<value_type>(i ^ j);
+                        assert(sum != 0);
+
+                        value_type c = m_field->invert(sum);
+                        m->set_element(i, j, c);
+                    }
+                }
+
+                return m;
+            }
+
+        };
+
+    public:
+
+        /// @return The layout of the rows of the current block
+        lrc_layout layout() const
+        {
+            return lrc_layout(SuperCoder::symbols(), GroupSize);
+        }
+
+    };
+
+}
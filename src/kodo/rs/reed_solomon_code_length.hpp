@@ -0,0 +1,51 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace kodo
+{
+
+    /// The smallest number of encoded symbols of a Reed-Solomon code
+    /// over a field with more than 256 elements, which keeps the code
+    /// length of the small generations the same as over binary8
+    const uint32_t reed_solomon_min_code_length = 255;
+
+    /// Returns the number of encoded symbols, i.e. the rows of the
+    /// generator matrix, of a Reed-Solomon code over the field.
+    ///
+    /// Over fields with at most 256 elements the code has the full
+    /// length of field_type::order - 1 symbols. Over larger fields the
+    /// full length would make the generator matrix impractical, over
+    /// binary16 it has 65535 rows, so the length is limited to twice
+    /// the number of source symbols i.e. a code rate of one half.
+    /// Since the length only depends on the number of source symbols
+    /// encoders and decoders agree on it, and the rows of a shorter
+    /// code are a prefix of the rows of the full length code.
+    ///
+    /// @param symbols The number of source symbols
+    /// @return The number of encoded symbols
+    template<class Field>
+    inline uint32_t reed_solomon_code_length(uint32_t symbols)
+    {
+        assert(symbols > 0);
+        assert(symbols < Field::order);
+
+        uint32_t full_length = Field::order - 1;
+
+        if(full_length <= reed_solomon_min_code_length)
+            return full_length;
+
+        uint32_t length = std::max(reed_solomon_min_code_length,
+                                   2 * symbols);
+
+        return std::min(full_length, length);
+    }
+
+}
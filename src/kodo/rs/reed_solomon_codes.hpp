@@ -12,7 +12,6 @@
 #include "../final_coder_factory_pool.hpp"
 #include "../finite_field_math.hpp"
 #include "../finite_field_info.hpp"
-#include "../zero_symbol_encoder.hpp"
 #include "../systematic_encoder.hpp"
 #include "../systematic_decoder.hpp"
 #include "../storage_bytes_used.hpp"
@@ -28,9 +27,13 @@
 #include "../encode_symbol_tracker.hpp"
 #include "../linear_block_encoder.hpp"
 #include "../linear_block_decoder.hpp"
+#include "../rank_tracker.hpp"
 
+#include "reed_solomon_parity_encoder.hpp"
 #include "reed_solomon_symbol_id_writer.hpp"
 #include "reed_solomon_symbol_id_reader.hpp"
+#include "reed_solomon_symbol_id.hpp"
+#include "reed_solomon_inverse_decoder.hpp"
 #include "systematic_vandermonde_matrix.hpp"
 
 namespace kodo
@@ -44,6 +47,8 @@ namespace kodo
     ///   to coding)
     /// - Deep symbol storage which makes the encoder allocate its own
     ///   internal memory.
+    /// - All parity symbols of a block can be computed in one pass over
+    ///   the block with encode_parity_symbols().
     template<class Field>
     class rs_encoder
         : public // Payload Codec API
@@ -51,12 +56,13 @@ namespace kodo
                  // Codec Header API
                  systematic_encoder<
                  symbol_id_encoder<
+                 // Codec API
+                 reed_solomon_parity_encoder<
                  // Symbol ID API
                  reed_solomon_symbol_id_writer<
                  systematic_vandermonde_matrix<
                  // Codec API
                  encode_symbol_tracker<
-                 zero_symbol_encoder<
                  linear_block_encoder<
                  storage_aware_encoder<
                  // Coefficient Storage API
@@ -110,6 +116,72 @@ namespace kodo
                      > > > > > > > > > > > > > >
     { };
 
+    /// @ingroup fec_stacks
+    /// @brief Implementation of a RS decoder using cached decoding
+    ///        matrices
+    ///
+    /// Produces the same result as the rs_decoder, but instead of
+    /// eliminating every received symbol the block is solved once k
+    /// symbols have been received, by multiplying them with the inverse
+    /// of their generator matrix rows, see reed_solomon_inverse_decoder.
+    /// The inverses are cached in the factory, so blocks which lose the
+    /// same symbols are decoded without any inversion.
+    template<class Field>
+    class rs_inverse_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 // Codec API
+                 reed_solomon_inverse_decoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id<
+                 systematic_vandermonde_matrix<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 rs_inverse_decoder<Field>
+                     > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Tracks the rank of the symbols of a rs_encoder received
+    ///        by a decoder.
+    ///
+    /// Only the coefficient vectors are stored, see rank_tracker, the
+    /// symbols are added from their symbol ids, i.e. the rows of the
+    /// generator matrix. The symbol size of the factory is not used.
+    template<class Field>
+    class rs_rank_tracker
+        : public // Codec API
+                 rank_tracker<
+                 // Symbol ID API
+                 reed_solomon_symbol_id_reader<
+                 systematic_vandermonde_matrix<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 rs_rank_tracker<Field>
+                     > > > > > > > > >
+    { };
+
 }
 
 
@@ -0,0 +1,477 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include <sak/convert_endian.hpp>
+
+#include "../matrix_operations.hpp"
+#include "reed_solomon_code_length.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Reed-Solomon decoder which solves a block with a single
+    ///        cached decoding matrix instead of Gaussian elimination.
+    ///
+    /// The received symbols are buffered until k distinct rows of the
+    /// generator matrix have been seen. The k x k submatrix of those
+    /// rows is then inverted, and the rows of the inverse belonging to
+    /// the erased source symbols are kept as the decoding matrix. The
+    /// erased symbols are produced by multiplying the decoding matrix
+    /// with the received symbols.
+    ///
+    /// The decoding matrices are cached in the factory, keyed by the
+    /// received row indices, so blocks with a repeated erasure pattern
+    /// skip the inversion. When the cache reaches its maximum size it is
+    /// cleared.
+    ///
+    /// The layer provides the Codec Header API below the
+    /// systematic_decoder and expects the generator_matrix to be
+    /// systematic, i.e. that the first k rows are the identity.
+    template<class SuperCoder>
+    class reed_solomon_inverse_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// @copydoc layer::pointer
+        typedef typename SuperCoder::pointer pointer;
+
+        /// The generator matrix type
+        typedef typename SuperCoder::generator_matrix generator_matrix;
+
+        /// Pointer to this layer
+        typedef boost::shared_ptr<
+            reed_solomon_inverse_decoder<SuperCoder> > this_pointer;
+
+        /// The decoding matrices keyed by the sorted received rows
+        struct inverse_cache
+        {
+            /// The cached decoding matrices
+            std::map<std::vector<uint32_t>,
+                     boost::shared_ptr<generator_matrix> > m_inverses;
+
+            /// The maximum number of cached decoding matrices
+            uint32_t m_max_inverses;
+        };
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer owning the cache of decoding matrices
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// The default maximum number of cached decoding matrices
+            static const uint32_t default_max_inverses = 1024;
+
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_cache(boost::make_shared<inverse_cache>())
+            {
+                m_cache->m_max_inverses = default_max_inverses;
+            }
+
+            /// @copydoc layer::factory::build()
+            pointer build()
+            {
+                pointer coder = SuperCoder::factory::build();
+
+                this_pointer this_coder = coder;
+                this_coder->m_cache = m_cache;
+
+                return coder;
+            }
+
+            /// @copydoc layer::factory::max_header_size() const
+            uint32_t max_header_size() const
+            {
+                return SuperCoder::factory::max_id_size();
+            }
+
+            /// Sets the maximum number of cached decoding matrices
+            /// @param max_inverses The maximum number of matrices
+            void set_max_cached_inverses(uint32_t max_inverses)
+            {
+                assert(max_inverses > 0);
+                m_cache->m_max_inverses = max_inverses;
+            }
+
+            /// @return The number of cached decoding matrices
+            uint32_t cached_inverses() const
+            {
+                return m_cache->m_inverses.size();
+            }
+
+        private:
+
+            /// The cache shared with the built decoders
+            boost::shared_ptr<inverse_cache> m_cache;
+
+        };
+
+    public:
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_received.resize(reed_solomon_code_length<field_type>(
+                the_factory.max_symbols()), false);
+            m_rows.reserve(the_factory.max_symbols());
+            m_coded_rows.reserve(the_factory.max_symbols());
+
+            m_coded_data.resize(
+                the_factory.max_symbols() * the_factory.max_symbol_size());
+
+            // The buffers used to solve a block are sized once, so
+            // decoding a block from a cached matrix does not allocate
+            m_sources.reserve(the_factory.max_symbols());
+            m_key.reserve(the_factory.max_symbols());
+            m_symbols_src.resize(the_factory.max_symbols());
+            m_coefficients.resize(the_factory.max_symbols());
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            for(uint32_t row : m_rows)
+            {
+                m_received[row] = false;
+            }
+
+            m_rows.clear();
+            m_coded_rows.clear();
+        }
+
+        /// Buffers a coded symbol, the header contains the index of the
+        /// generator matrix row used to produce it.
+        /// @copydoc layer::decode(uint8_t*, uint8_t*)
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint32_t row = sak::big_endian::get<value_type>(symbol_header);
+
+            assert(row < m_received.size());
+
+            if(row < SuperCoder::symbols())
+            {
+                decode_symbol(symbol_data, row);
+                return;
+            }
+
+            if(is_complete() || m_received[row])
+            {
+                return;
+            }
+
+            uint32_t offset = m_coded_rows.size() * SuperCoder::symbol_size();
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        &m_coded_data[offset]);
+
+            m_coded_rows.push_back(row);
+            receive_row(row);
+        }
+
+        /// Stores an uncoded symbol directly in the symbol storage
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data, uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            if(is_complete() || m_received[symbol_index])
+            {
+                return;
+            }
+
+            std::copy_n(symbol_data, SuperCoder::symbol_size(),
+                        SuperCoder::symbol(symbol_index));
+
+            receive_row(symbol_index);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_rows.size() == SuperCoder::symbols();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_rows.size();
+        }
+
+        /// @copydoc layer::symbol_pivot(uint32_t) const
+        bool symbol_pivot(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return is_complete() || m_received[index];
+        }
+
+        /// @copydoc layer::header_size() const
+        uint32_t header_size() const
+        {
+            return SuperCoder::id_size();
+        }
+
+    protected:
+
+        /// Records a received row and solves the block when k rows have
+        /// been received
+        /// @param row The generator matrix row of the received symbol
+        void receive_row(uint32_t row)
+        {
+            m_received[row] = true;
+            m_rows.push_back(row);
+
+            if(is_complete())
+            {
+                solve();
+            }
+        }
+
+        /// Produces the erased source symbols from the received symbols
+        void solve()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            if(m_coded_rows.empty())
+            {
+                // All source symbols were received uncoded
+                return;
+            }
+
+            // The received symbols in the order of their rows, the
+            // uncoded symbols are stored in place and come first
+            auto &sources = m_sources;
+            sources.clear();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(m_received[i])
+                {
+                    sources.push_back(
+                        std::make_pair(i, SuperCoder::symbol_value(i)));
+                }
+            }
+
+            for(uint32_t i = 0; i < m_coded_rows.size(); ++i)
+            {
+                const uint8_t *data =
+                    &m_coded_data[i * SuperCoder::symbol_size()];
+
+                sources.push_back(std::make_pair(
+                    m_coded_rows[i],
+                    reinterpret_cast<const value_type*>(data)));
+            }
+
+            std::sort(sources.begin(), sources.end());
+
+            m_key.resize(symbols);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                m_key[i] = sources[i].first;
+            }
+
+            boost::shared_ptr<generator_matrix> inverse =
+                find_inverse(m_key);
+
+            // Each erased symbol is one row of the decoding matrix
+            // multiplied with the received symbols
+            uint32_t erased = 0;
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(m_received[i])
+                {
+                    continue;
+                }
+
+                uint32_t used = 0;
+
+                for(uint32_t j = 0; j < symbols; ++j)
+                {
+                    value_type c = inverse->element(erased, j);
+
+                    if(c)
+                    {
+                        m_symbols_src[used] = sources[j].second;
+                        m_coefficients[used] = c;
+                        ++used;
+                    }
+                }
+
+                value_type *symbol_dest = SuperCoder::symbol_value(i);
+
+                assert(used > 0);
+
+                SuperCoder::multiply_sources(
+                    symbol_dest, &m_symbols_src[0], &m_coefficients[0], used,
+                    SuperCoder::symbol_length());
+
+                ++erased;
+            }
+
+            assert(erased == m_coded_rows.size());
+        }
+
+        /// Returns the decoding matrix of a set of received rows,
+        /// computing and caching it if it is not already cached
+        /// @param rows The sorted received rows
+        /// @return The decoding matrix with one row per erased source
+        ///         symbol and one column per received row
+        boost::shared_ptr<generator_matrix> find_inverse(
+            const std::vector<uint32_t> &rows)
+        {
+            assert(m_cache);
+
+            auto it = m_cache->m_inverses.find(rows);
+
+            if(it != m_cache->m_inverses.end())
+            {
+                return it->second;
+            }
+
+            if(m_cache->m_inverses.size() >= m_cache->m_max_inverses)
+            {
+                m_cache->m_inverses.clear();
+            }
+
+            boost::shared_ptr<generator_matrix> inverse =
+                compute_inverse(rows);
+
+            m_cache->m_inverses[rows] = inverse;
+
+            return inverse;
+        }
+
+        /// Inverts the submatrix of the received rows using Gauss-Jordan
+        /// elimination and keeps the rows of the erased symbols
+        /// @copydetails find_inverse(const std::vector<uint32_t>&)
+        boost::shared_ptr<generator_matrix> compute_inverse(
+            const std::vector<uint32_t> &rows)
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            assert(rows.size() == symbols);
+            assert(SuperCoder::m_matrix);
+
+            generator_matrix a(symbols, symbols);
+            generator_matrix b(symbols, symbols);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                std::copy_n(SuperCoder::m_matrix->row(rows[i]),
+                            a.row_size(), a.row(i));
+            }
+
+            // Any k rows of the generator matrix are independent so the
+            // submatrix is always invertible
+            bool invertible = invert_matrix(*SuperCoder::m_field, a, b);
+
+            assert(invertible);
+            (void) invertible;
+
+            // The erased symbols are the source rows which were not
+            // received
+            uint32_t erased = symbols - static_cast<uint32_t>(
+                std::lower_bound(rows.begin(), rows.end(), symbols) -
+                rows.begin());
+
+            assert(erased > 0);
+
+            auto inverse = boost::make_shared<generator_matrix>(
+                erased, symbols);
+
+            uint32_t next = 0;
+            uint32_t current = 0;
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(next < symbols && rows[next] == i)
+                {
+                    ++next;
+                    continue;
+                }
+
+                std::copy_n(b.row(i), b.row_size(),
+                            inverse->row(current));
+
+                ++current;
+            }
+
+            assert(current == erased);
+
+            return inverse;
+        }
+
+    private:
+
+        /// The cache of decoding matrices shared with the factory
+        boost::shared_ptr<inverse_cache> m_cache;
+
+        /// Tracks which generator matrix rows have been received
+        std::vector<bool> m_received;
+
+        /// The received rows in the order they were received
+        std::vector<uint32_t> m_rows;
+
+        /// The rows of the buffered coded symbols
+        std::vector<uint32_t> m_coded_rows;
+
+        /// Buffer for the coded symbols
+        std::vector<uint8_t> m_coded_data;
+
+        /// The received symbols sorted by row while solving a block
+        std::vector<std::pair<uint32_t, const value_type*> > m_sources;
+
+        /// The sorted received rows used as key of the cache
+        std::vector<uint32_t> m_key;
+
+        /// The symbols combined into an erased symbol
+        std::vector<const value_type*> m_symbols_src;
+
+        /// The coefficients of the combined symbols
+        std::vector<value_type> m_coefficients;
+
+    };
+
+    template<class SuperCoder>
+    const uint32_t
+    reed_solomon_inverse_decoder<SuperCoder>::factory::default_max_inverses;
+
+}
@@ -0,0 +1,203 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    ///
+    /// @brief Computes the parity symbols of a systematic Reed-Solomon
+    ///        code as one product of the parity rows of the generator
+    ///        matrix with the block.
+    ///
+    /// Encoding the parity symbols one by one streams the whole block
+    /// from memory for every parity symbol. This layer instead walks the
+    /// block in tiles and computes the tile of every requested parity
+    /// symbol with a fused multiply_sources() over the source tiles,
+    /// which therefore stay in the cache while they are used by all the
+    /// parity symbols. The parity symbols are the symbols produced by
+    /// the encoder after the systematic symbols, i.e. parity symbol j
+    /// uses row symbols() + j of the generator matrix. The layer must be
+    /// placed above the reed_solomon_symbol_id_writer and does not
+    /// change the state of the encoder.
+    template<class SuperCoder>
+    class reed_solomon_parity_encoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The size in bytes of the tiles of the source symbols, the
+        /// tiles of the sources and the parity symbols of e.g. a 10 + 4
+        /// code should fit in the L2 cache
+        static const uint32_t parity_tile_size = 4096;
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_tile_sources.resize(the_factory.symbols());
+        }
+
+        /// @return The largest number of parity symbols of the block
+        uint32_t max_parity_symbols() const
+        {
+            assert(m_matrix);
+            assert(m_matrix->rows() >= SuperCoder::symbols());
+
+            return m_matrix->rows() - SuperCoder::symbols();
+        }
+
+        /// Computes parity symbols of the block, the symbols of the
+        /// encoder must be set
+        /// @param parity_symbols The buffers of the parity symbols, each
+        ///        of layer::symbol_size() bytes
+        /// @param first The index of the first parity symbol
+        /// @param count The number of parity symbols to compute
+        void encode_parity_symbols(uint8_t **parity_symbols,
+                                   uint32_t first, uint32_t count)
+        {
+            assert(parity_symbols != 0);
+            assert(first + count <= max_parity_symbols());
+
+            uint32_t symbols = SuperCoder::symbols();
+            uint32_t symbol_length = SuperCoder::symbol_length();
+
+            // The non-zero coefficients and their sources for every
+            // parity symbol, stored row after row
+            m_indices.clear();
+            m_coefficients.clear();
+            m_row_offsets.assign(1, 0);
+
+            for(uint32_t j = 0; j < count; ++j)
+            {
+                assert(parity_symbols[j] != 0);
+
+                const value_type *row =
+                    m_matrix->row_value(symbols + first + j);
+
+                for(uint32_t i = 0; i < symbols; ++i)
+                {
+                    value_type value = fifi::get_value<field_type>(row, i);
+
+                    if(!value)
+                        continue;
+
+                    m_indices.push_back(i);
+                    m_coefficients.push_back(value);
+                }
+
+                m_row_offsets.push_back(
+                    static_cast<uint32_t>(m_indices.size()));
+            }
+
+            const uint32_t tile_length = std::max<uint32_t>(
+                1U, parity_tile_size / sizeof(value_type));
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += tile_length)
+            {
+                uint32_t length = std::min(tile_length,
+                                           symbol_length - offset);
+
+                for(uint32_t j = 0; j < count; ++j)
+                {
+                    value_type *dest = reinterpret_cast<value_type*>(
+                        parity_symbols[j]) + offset;
+
+                    uint32_t begin = m_row_offsets[j];
+                    uint32_t sources = m_row_offsets[j + 1] - begin;
+
+                    for(uint32_t s = 0; s < sources; ++s)
+                    {
+                        uint32_t index = m_indices[begin + s];
+
+                        const value_type *symbol_i =
+                            SuperCoder::symbol_value(index);
+
+                        // Did you forget to set the data on the encoder?
+                        assert(symbol_i != 0);
+                        assert(SuperCoder::symbol_pivot(index));
+
+                        m_tile_sources[s] = symbol_i + offset;
+                    }
+
+                    // The first source initialises the tile, which
+                    // is zeroed by multiply_sources() if it has none
+                    SuperCoder::multiply_sources(
+                        dest, m_tile_sources.data(),
+                        m_coefficients.data() + begin, sources, length);
+                }
+            }
+        }
+
+        /// Updates parity symbols in place after a source symbol of the
+        /// block changed, reading only the change instead of the whole
+        /// block. The new source symbol is set on the encoder separately,
+        /// if the encoder is kept for later updates.
+        /// @param parity_symbols The buffers of the parity symbols, as
+        ///        computed by encode_parity_symbols()
+        /// @param first The index of the first parity symbol
+        /// @param count The number of parity symbols to update
+        /// @param symbol_index The index of the source symbol changed
+        /// @param delta The new source symbol minus the old one, i.e.
+        ///        their XOR, of layer::symbol_size() bytes
+        void update_parity_symbols(uint8_t **parity_symbols,
+                                   uint32_t first, uint32_t count,
+                                   uint32_t symbol_index,
+                                   const uint8_t *delta)
+        {
+            assert(parity_symbols != 0);
+            assert(first + count <= max_parity_symbols());
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t j = 0; j < count; ++j)
+            {
+                SuperCoder::update_symbol(
+                    parity_symbols[j], m_matrix->row(symbols + first + j),
+                    symbol_index, delta);
+            }
+        }
+
+    protected:
+
+        /// Access the generator matrix
+        using SuperCoder::m_matrix;
+
+    protected:
+
+        /// The sources of the current tile
+        std::vector<const value_type*> m_tile_sources;
+
+        /// The indices of the sources with non-zero coefficients
+        std::vector<uint32_t> m_indices;
+
+        /// The non-zero coefficients of the parity rows
+        std::vector<value_type> m_coefficients;
+
+        /// The offset of the coefficients of every parity row
+        std::vector<uint32_t> m_row_offsets;
+
+    };
+
+}
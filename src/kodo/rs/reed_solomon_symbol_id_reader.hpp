@@ -41,6 +41,8 @@ namespace kodo
             value_type row_index =
                 sak::big_endian::get<value_type>(symbol_id);
 
+            assert(row_index < m_matrix->rows());
+
             sak::const_storage src =
                 sak::storage(m_matrix->row(row_index),
                              m_matrix->row_size());
@@ -59,7 +59,7 @@ namespace kodo
             uint32_t symbol_index = Super::encode_symbol_count();
 
             // An Reed-Solomon code is not rate-less
-            assert(symbol_index < field_type::order - 1);
+            assert(symbol_index < m_matrix->rows());
 
             // Store the index as the symbol id
             sak::big_endian::put<value_type>(symbol_index, symbol_id);
@@ -0,0 +1,100 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include "generator_matrix_cache.hpp"
+
+namespace kodo
+{
+
+    /// @brief Shares the generator matrices constructed by the layers
+    ///        below between all factories of the process.
+    ///
+    /// The matrices are kept in the generator_matrix_cache of the field
+    /// and Tag, so only the first factory of the process constructing
+    /// a matrix for a number of symbols pays for it. The cache may also
+    /// be filled from a file with load_matrices(const std::string&).
+    template<class Tag, class SuperCoder>
+    class shared_generator_matrix : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// The generator matrix type
+        typedef typename SuperCoder::generator_matrix generator_matrix;
+
+        /// The process-wide cache of the matrices
+        typedef generator_matrix_cache<field_type, Tag> cache_type;
+
+    public:
+
+        /// The factory layer associated with this coder. Looks up the
+        /// matrices in the process-wide cache.
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t, uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size)
+            { }
+
+            /// Returns the cached matrix or constructs and caches it
+            /// @param symbols The number of source symbols to encode
+            /// @return The generator matrix
+            boost::shared_ptr<generator_matrix> construct_matrix(
+                uint32_t symbols)
+            {
+                cache_type &cache = cache_type::instance();
+
+                auto m = cache.find(symbols);
+
+                if(m)
+                    return m;
+
+                // Constructed without holding the lock, if another
+                // factory was faster its matrix is used
+                return cache.insert(
+                    symbols, SuperCoder::factory::construct_matrix(symbols));
+            }
+
+            /// Constructs the matrices for all numbers of symbols up to
+            /// a maximum, e.g. before saving them with save_matrices()
+            /// @param max_symbols The largest number of symbols
+            void precompute_matrices(uint32_t max_symbols)
+            {
+                for(uint32_t i = 1; i <= max_symbols; ++i)
+                {
+                    construct_matrix(i);
+                }
+            }
+
+            /// Adds the matrices of a file to the process-wide cache
+            /// @copydoc generator_matrix_cache::load(const std::string&)
+            static bool load_matrices(const std::string &filename)
+            {
+                return cache_type::instance().load(filename);
+            }
+
+            /// Writes the matrices of the process-wide cache to a file
+            /// @copydoc generator_matrix_cache::save(const std::string&)
+            static bool save_matrices(const std::string &filename)
+            {
+                return cache_type::instance().save(filename);
+            }
+
+        };
+
+    };
+
+}
@@ -8,16 +8,25 @@
 #include "systematic_vandermonde_matrix_base.hpp"
 #include "vandermonde_matrix_base.hpp"
 #include "transpose_vandermonde_matrix.hpp"
+#include "shared_generator_matrix.hpp"
 
 namespace kodo
 {
 
+    /// Identifies the systematic Vandermonde matrices in the
+    /// generator_matrix_cache
+    struct systematic_vandermonde_matrix_tag
+    { };
+
+    /// The matrices are shared by all factories of the process, see
+    /// shared_generator_matrix.
     /// @copydoc systematic_vandermonde_matrix_base
     template<class SuperCoder>
     class systematic_vandermonde_matrix
-        : public transpose_vandermonde_matrix<
+        : public shared_generator_matrix<systematic_vandermonde_matrix_tag,
+                 transpose_vandermonde_matrix<
                  systematic_vandermonde_matrix_base<
-                 vandermonde_matrix_base<SuperCoder> > >
+                 vandermonde_matrix_base<SuperCoder> > > >
     { };
 
 }
@@ -5,8 +5,13 @@
 
 #pragma once
 
-#include <fifi/arithmetics.hpp>
+#include <cstdint>
+#include <cassert>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "../matrix_operations.hpp"
 #include "vandermonde_matrix.hpp"
 
 namespace kodo
@@ -77,31 +82,33 @@ namespace kodo
         boost::shared_ptr<generator_matrix> m =
             SuperCoder::factory::construct_matrix(symbols);
 
-        std::vector<value_type> temp_row(m->row_length());
+        // Any k columns of the Vandermonde matrix are independent, so
+        // multiplying with the inverse of the first k columns makes
+        // them the identity
+        generator_matrix left(symbols, symbols);
 
-        for(uint32_t i = 0; i < m->rows(); ++i)
+        for(uint32_t i = 0; i < symbols; ++i)
         {
-            value_type pivot = m->element(i,i);
-            pivot = m_field->invert(pivot);
+            for(uint32_t j = 0; j < symbols; ++j)
+            {
+                value_type v = m->element(i, j);
+                left.set_element(i, j, v);
+            }
+        }
 
-            fifi::multiply_constant(
-                *m_field, pivot, m->row(i), m->row_length());
+        generator_matrix inverse(symbols, symbols);
 
-            for(uint32_t j = 0; j < m->rows(); ++j)
-            {
-                if(j == i)
-                    continue;
+        bool invertible = invert_matrix(*m_field, left, inverse);
 
-                value_type scale = m->element(j, i);
-                fifi::multiply_subtract(
-                    *m_field, scale, m->row(j), m->row(i),
-                    &temp_row[0], m->row_length());
+        assert(invertible);
+        (void) invertible;
 
-            }
-        }
+        auto systematic =
+            boost::make_shared<generator_matrix>(m->rows(), m->columns());
 
-        return m;
+        multiply_matrices(*m_field, inverse, *m, *systematic);
 
+        return systematic;
     }
 
 }
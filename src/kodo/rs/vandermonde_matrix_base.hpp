@@ -9,6 +9,7 @@
 #include <boost/make_shared.hpp>
 
 #include "../matrix.hpp"
+#include "reed_solomon_code_length.hpp"
 #include "transpose_vandermonde_matrix.hpp"
 
 namespace kodo
@@ -79,8 +80,9 @@ namespace kodo
         assert(symbols > 0);
         assert(m_field);
 
-        /// The maximum number of encoding symbols
-        uint32_t max_symbols = field_type::order - 1;
+        /// The number of encoding symbols
+        uint32_t max_symbols =
+            reed_solomon_code_length<field_type>(symbols);
 
         // Create the Vandermonde matrix as suggested in
         // RFC 5510.
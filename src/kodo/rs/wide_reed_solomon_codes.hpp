@@ -0,0 +1,126 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#include <fifi/default_field.hpp>
+#include <fifi/field_types.hpp>
+
+#include "../final_coder_factory_pool.hpp"
+#include "../simd_finite_field_math.hpp"
+#include "../finite_field_info.hpp"
+#include "../systematic_encoder.hpp"
+#include "../systematic_decoder.hpp"
+#include "../storage_bytes_used.hpp"
+#include "../storage_block_info.hpp"
+#include "../deep_symbol_storage.hpp"
+#include "../payload_encoder.hpp"
+#include "../payload_decoder.hpp"
+#include "../symbol_id_encoder.hpp"
+#include "../symbol_id_decoder.hpp"
+#include "../coefficient_storage.hpp"
+#include "../coefficient_info.hpp"
+#include "../storage_aware_encoder.hpp"
+#include "../encode_symbol_tracker.hpp"
+#include "../linear_block_encoder.hpp"
+#include "../linear_block_decoder.hpp"
+
+#include "cauchy_matrix.hpp"
+#include "reed_solomon_parity_encoder.hpp"
+#include "reed_solomon_symbol_id_writer.hpp"
+#include "reed_solomon_symbol_id_reader.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup fec_stacks
+    /// @brief Reed-Solomon encoder for generations of more than 255
+    ///        symbols.
+    ///
+    /// Over binary8 a Reed-Solomon generation is limited to 255
+    /// symbols, this stack is meant for binary16 where a generation may
+    /// hold thousands of symbols. The key features of this
+    /// configuration are the following:
+    /// - The coefficients come from a systematic Cauchy matrix, which
+    ///   is built without the Gauss-Jordan elimination of the
+    ///   systematic Vandermonde matrix. The number of encoded symbols
+    ///   is given by reed_solomon_code_length().
+    /// - The symbols are combined with the split table kernels of the
+    ///   simd_finite_field_math layer.
+    /// - All parity symbols of a block can be computed in one pass over
+    ///   the block with encode_parity_symbols().
+    template<class Field = fifi::binary16>
+    class wide_rs_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Codec API
+                 reed_solomon_parity_encoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id_writer<
+                 cauchy_matrix<
+                 // Codec API
+                 encode_symbol_tracker<
+                 linear_block_encoder<
+                 storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 wide_rs_encoder<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+    /// @ingroup fec_stacks
+    /// @brief Reed-Solomon decoder matching the wide_rs_encoder
+    ///
+    /// The received symbols are eliminated with the
+    /// linear_block_decoder, the elimination of both the symbols and
+    /// the coefficient vectors uses the split table kernels of the
+    /// simd_finite_field_math layer.
+    template<class Field = fifi::binary16>
+    class wide_rs_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 reed_solomon_symbol_id_reader<
+                 cauchy_matrix<
+                 // Codec API
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 wide_rs_decoder<Field>
+                     > > > > > > > > > > > > > >
+    { };
+
+}
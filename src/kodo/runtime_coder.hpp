@@ -0,0 +1,465 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <sak/storage.hpp>
+
+#include "has_payload_batch_encoder.hpp"
+
+namespace kodo
+{
+
+    /// @brief Encoder interface hiding the type of the encoder stack.
+    ///
+    /// The stacks are selected at compile time, so choosing e.g. the
+    /// field at run-time means carrying every instantiation around. The
+    /// runtime_encoder hides the stack behind a virtual interface, where
+    /// the payload functions work on a batch of payloads so the cost of
+    /// the virtual call is paid once per batch and not once per payload.
+    /// Within the batch the calls to the stack are resolved at compile
+    /// time and inlined as usual.
+    class runtime_encoder : boost::noncopyable
+    {
+    public:
+
+        /// Pointer to an encoder
+        typedef boost::shared_ptr<runtime_encoder> pointer;
+
+    public:
+
+        /// Destructor
+        virtual ~runtime_encoder()
+        { }
+
+        /// Encodes a number of payloads
+        /// @param payloads The payload buffers, each must be at least
+        ///        payload_size() bytes
+        /// @param count The number of payloads to encode
+        /// @param bytes_used If not zero, the number of bytes used in
+        ///        each payload is written here
+        virtual void encode(uint8_t **payloads, uint32_t count,
+                            uint32_t *bytes_used = 0) = 0;
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        virtual void set_symbols(const sak::const_storage &symbol_storage) = 0;
+
+        /// @copydoc layer::set_bytes_used(uint32_t)
+        virtual void set_bytes_used(uint32_t bytes_used) = 0;
+
+        /// @copydoc layer::payload_size() const
+        virtual uint32_t payload_size() const = 0;
+
+        /// @copydoc layer::symbols() const
+        virtual uint32_t symbols() const = 0;
+
+        /// @copydoc layer::symbol_size() const
+        virtual uint32_t symbol_size() const = 0;
+
+        /// @copydoc layer::block_size() const
+        virtual uint32_t block_size() const = 0;
+
+        /// @copydoc layer::rank() const
+        virtual uint32_t rank() const = 0;
+
+    };
+
+    /// @brief Decoder interface hiding the type of the decoder stack.
+    ///
+    /// @copydetails runtime_encoder
+    class runtime_decoder : boost::noncopyable
+    {
+    public:
+
+        /// Pointer to a decoder
+        typedef boost::shared_ptr<runtime_decoder> pointer;
+
+    public:
+
+        /// Destructor
+        virtual ~runtime_decoder()
+        { }
+
+        /// Decodes a number of payloads, the payloads are decoded in
+        /// place i.e. the buffers are modified
+        /// @param payloads The payload buffers
+        /// @param count The number of payloads to decode
+        virtual void decode(uint8_t **payloads, uint32_t count) = 0;
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        virtual void copy_symbols(const sak::mutable_storage &dest) = 0;
+
+        /// @copydoc layer::set_bytes_used(uint32_t)
+        virtual void set_bytes_used(uint32_t bytes_used) = 0;
+
+        /// @copydoc layer::is_complete() const
+        virtual bool is_complete() const = 0;
+
+        /// @copydoc layer::payload_size() const
+        virtual uint32_t payload_size() const = 0;
+
+        /// @copydoc layer::symbols() const
+        virtual uint32_t symbols() const = 0;
+
+        /// @copydoc layer::symbol_size() const
+        virtual uint32_t symbol_size() const = 0;
+
+        /// @copydoc layer::block_size() const
+        virtual uint32_t block_size() const = 0;
+
+        /// @copydoc layer::rank() const
+        virtual uint32_t rank() const = 0;
+
+    };
+
+    /// @brief Factory interface building runtime_encoder or
+    ///        runtime_decoder objects.
+    template<class RuntimeCoder>
+    class runtime_factory : boost::noncopyable
+    {
+    public:
+
+        /// Pointer to the coders built
+        typedef typename RuntimeCoder::pointer pointer;
+
+    public:
+
+        /// Destructor
+        virtual ~runtime_factory()
+        { }
+
+        /// @copydoc layer::factory::build()
+        virtual pointer build() = 0;
+
+        /// @copydoc layer::factory::set_symbols(uint32_t)
+        virtual void set_symbols(uint32_t symbols) = 0;
+
+        /// @copydoc layer::factory::set_symbol_size(uint32_t)
+        virtual void set_symbol_size(uint32_t symbol_size) = 0;
+
+        /// @copydoc layer::factory::max_symbols() const
+        virtual uint32_t max_symbols() const = 0;
+
+        /// @copydoc layer::factory::max_symbol_size() const
+        virtual uint32_t max_symbol_size() const = 0;
+
+        /// @copydoc layer::factory::max_payload_size() const
+        virtual uint32_t max_payload_size() const = 0;
+
+    };
+
+    /// The factory interface of runtime encoders
+    typedef runtime_factory<runtime_encoder> runtime_encoder_factory;
+
+    /// The factory interface of runtime decoders
+    typedef runtime_factory<runtime_decoder> runtime_decoder_factory;
+
+    /// @brief Wraps an encoder stack in the runtime_encoder interface
+    template<class EncoderType>
+    class runtime_encoder_wrapper : public runtime_encoder
+    {
+    public:
+
+        /// Pointer to the wrapped encoder
+        typedef typename EncoderType::pointer encoder_pointer;
+
+    public:
+
+        /// @param encoder The encoder to wrap
+        runtime_encoder_wrapper(const encoder_pointer &encoder)
+            : m_encoder(encoder)
+        {
+            assert(m_encoder);
+        }
+
+        /// @copydoc runtime_encoder::encode(uint8_t**,uint32_t,uint32_t*)
+        void encode(uint8_t **payloads, uint32_t count,
+                    uint32_t *bytes_used = 0)
+        {
+            assert(payloads != 0);
+
+            encode_batch(payloads, count, bytes_used,
+                std::integral_constant<bool,
+                    has_payload_batch_encoder<EncoderType>::value>());
+        }
+
+        /// @copydoc layer::set_symbols(const sak::const_storage&)
+        void set_symbols(const sak::const_storage &symbol_storage)
+        {
+            m_encoder->set_symbols(symbol_storage);
+        }
+
+        /// @copydoc layer::set_bytes_used(uint32_t)
+        void set_bytes_used(uint32_t bytes_used)
+        {
+            m_encoder->set_bytes_used(bytes_used);
+        }
+
+        /// @copydoc layer::payload_size() const
+        uint32_t payload_size() const
+        {
+            return m_encoder->payload_size();
+        }
+
+        /// @copydoc layer::symbols() const
+        uint32_t symbols() const
+        {
+            return m_encoder->symbols();
+        }
+
+        /// @copydoc layer::symbol_size() const
+        uint32_t symbol_size() const
+        {
+            return m_encoder->symbol_size();
+        }
+
+        /// @copydoc layer::block_size() const
+        uint32_t block_size() const
+        {
+            return m_encoder->block_size();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_encoder->rank();
+        }
+
+        /// @return The wrapped encoder
+        const encoder_pointer& encoder() const
+        {
+            return m_encoder;
+        }
+
+    private:
+
+        /// Encodes the batch in one pass over the block using the
+        /// payload_batch_encoder layer
+        void encode_batch(uint8_t **payloads, uint32_t count,
+                          uint32_t *bytes_used, std::true_type)
+        {
+            m_encoder->encode(payloads, count, bytes_used);
+        }
+
+        /// Encodes the payloads one at a time
+        void encode_batch(uint8_t **payloads, uint32_t count,
+                          uint32_t *bytes_used, std::false_type)
+        {
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                assert(payloads[i] != 0);
+
+                uint32_t used = m_encoder->encode(payloads[i]);
+
+                if(bytes_used)
+                {
+                    bytes_used[i] = used;
+                }
+            }
+        }
+
+    private:
+
+        /// The wrapped encoder
+        encoder_pointer m_encoder;
+
+    };
+
+    /// @brief Wraps a decoder stack in the runtime_decoder interface
+    template<class DecoderType>
+    class runtime_decoder_wrapper : public runtime_decoder
+    {
+    public:
+
+        /// Pointer to the wrapped decoder
+        typedef typename DecoderType::pointer decoder_pointer;
+
+    public:
+
+        /// @param decoder The decoder to wrap
+        runtime_decoder_wrapper(const decoder_pointer &decoder)
+            : m_decoder(decoder)
+        {
+            assert(m_decoder);
+        }
+
+        /// @copydoc runtime_decoder::decode(uint8_t**,uint32_t)
+        void decode(uint8_t **payloads, uint32_t count)
+        {
+            assert(payloads != 0);
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                assert(payloads[i] != 0);
+                m_decoder->decode(payloads[i]);
+            }
+        }
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        void copy_symbols(const sak::mutable_storage &dest)
+        {
+            m_decoder->copy_symbols(dest);
+        }
+
+        /// @copydoc layer::set_bytes_used(uint32_t)
+        void set_bytes_used(uint32_t bytes_used)
+        {
+            m_decoder->set_bytes_used(bytes_used);
+        }
+
+        /// @copydoc layer::is_complete() const
+        bool is_complete() const
+        {
+            return m_decoder->is_complete();
+        }
+
+        /// @copydoc layer::payload_size() const
+        uint32_t payload_size() const
+        {
+            return m_decoder->payload_size();
+        }
+
+        /// @copydoc layer::symbols() const
+        uint32_t symbols() const
+        {
+            return m_decoder->symbols();
+        }
+
+        /// @copydoc layer::symbol_size() const
+        uint32_t symbol_size() const
+        {
+            return m_decoder->symbol_size();
+        }
+
+        /// @copydoc layer::block_size() const
+        uint32_t block_size() const
+        {
+            return m_decoder->block_size();
+        }
+
+        /// @copydoc layer::rank() const
+        uint32_t rank() const
+        {
+            return m_decoder->rank();
+        }
+
+        /// @return The wrapped decoder
+        const decoder_pointer& decoder() const
+        {
+            return m_decoder;
+        }
+
+    private:
+
+        /// The wrapped decoder
+        decoder_pointer m_decoder;
+
+    };
+
+    /// @brief Wraps the factory of a coder stack in the runtime_factory
+    ///        interface
+    /// @tparam CoderType The coder stack
+    /// @tparam RuntimeCoder The runtime_encoder or runtime_decoder
+    /// @tparam Wrapper The wrapper implementing RuntimeCoder
+    template<class CoderType, class RuntimeCoder, class Wrapper>
+    class runtime_factory_wrapper : public runtime_factory<RuntimeCoder>
+    {
+    public:
+
+        /// Pointer to the coders built
+        typedef typename RuntimeCoder::pointer pointer;
+
+    public:
+
+        /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+        runtime_factory_wrapper(uint32_t max_symbols,
+                                uint32_t max_symbol_size)
+            : m_factory(max_symbols, max_symbol_size)
+        { }
+
+        /// @copydoc layer::factory::build()
+        pointer build()
+        {
+            return boost::make_shared<Wrapper>(m_factory.build());
+        }
+
+        /// @copydoc layer::factory::set_symbols(uint32_t)
+        void set_symbols(uint32_t symbols)
+        {
+            m_factory.set_symbols(symbols);
+        }
+
+        /// @copydoc layer::factory::set_symbol_size(uint32_t)
+        void set_symbol_size(uint32_t symbol_size)
+        {
+            m_factory.set_symbol_size(symbol_size);
+        }
+
+        /// @copydoc layer::factory::max_symbols() const
+        uint32_t max_symbols() const
+        {
+            return m_factory.max_symbols();
+        }
+
+        /// @copydoc layer::factory::max_symbol_size() const
+        uint32_t max_symbol_size() const
+        {
+            return m_factory.max_symbol_size();
+        }
+
+        /// @copydoc layer::factory::max_payload_size() const
+        uint32_t max_payload_size() const
+        {
+            return m_factory.max_payload_size();
+        }
+
+    private:
+
+        /// The factory of the stack
+        typename CoderType::factory m_factory;
+
+    };
+
+    /// Creates a runtime encoder factory for an encoder stack
+    /// @param max_symbols The maximum number of symbols
+    /// @param max_symbol_size The maximum symbol size
+    /// @return The factory
+    template<class EncoderType>
+    inline boost::shared_ptr<runtime_encoder_factory>
+    make_runtime_encoder_factory(uint32_t max_symbols,
+                                 uint32_t max_symbol_size)
+    {
+        typedef runtime_factory_wrapper<EncoderType, runtime_encoder,
+            runtime_encoder_wrapper<EncoderType> > factory_type;
+
+        return boost::make_shared<factory_type>(
+            max_symbols, max_symbol_size);
+    }
+
+    /// Creates a runtime decoder factory for a decoder stack
+    /// @param max_symbols The maximum number of symbols
+    /// @param max_symbol_size The maximum symbol size
+    /// @return The factory
+    template<class DecoderType>
+    inline boost::shared_ptr<runtime_decoder_factory>
+    make_runtime_decoder_factory(uint32_t max_symbols,
+                                 uint32_t max_symbol_size)
+    {
+        typedef runtime_factory_wrapper<DecoderType, runtime_decoder,
+            runtime_decoder_wrapper<DecoderType> > factory_type;
+
+        return boost::make_shared<factory_type>(
+            max_symbols, max_symbol_size);
+    }
+
+}
@@ -0,0 +1,171 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <boost/shared_ptr.hpp>
+
+#include <fifi/field_types.hpp>
+
+#include "runtime_coder.hpp"
+#include "rlnc/full_vector_codes.hpp"
+#include "rlnc/seed_codes.hpp"
+#include "rs/reed_solomon_codes.hpp"
+
+namespace kodo
+{
+
+    /// The codes which may be selected at run-time
+    enum class runtime_code
+    {
+        /// full_rlnc_encoder and full_rlnc_decoder
+        full_rlnc,
+
+        /// seed_rlnc_encoder and seed_rlnc_decoder
+        seed_rlnc,
+
+        /// rs_encoder and rs_decoder, only with binary8
+        reed_solomon
+    };
+
+    /// The finite fields which may be selected at run-time
+    enum class runtime_field
+    {
+        /// fifi::binary
+        binary,
+
+        /// fifi::binary8
+        binary8,
+
+        /// fifi::binary16
+        binary16
+    };
+
+    /// Creates the encoder factory of a code and field selected at
+    /// run-time. This is the only place where the selection is made,
+    /// the encoders built by the factory then only pay a virtual call
+    /// per batch of payloads.
+    /// @param code The code
+    /// @param field The finite field
+    /// @param max_symbols The maximum number of symbols
+    /// @param max_symbol_size The maximum symbol size
+    /// @return The factory, or an empty pointer if the code does not
+    ///         support the field
+    inline boost::shared_ptr<runtime_encoder_factory>
+    make_runtime_encoder_factory(runtime_code code, runtime_field field,
+                                 uint32_t max_symbols,
+                                 uint32_t max_symbol_size)
+    {
+        switch(code)
+        {
+        case runtime_code::full_rlnc:
+            switch(field)
+            {
+            case runtime_field::binary:
+                return make_runtime_encoder_factory<
+                    full_rlnc_encoder<fifi::binary> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary8:
+                return make_runtime_encoder_factory<
+                    full_rlnc_encoder<fifi::binary8> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary16:
+                return make_runtime_encoder_factory<
+                    full_rlnc_encoder<fifi::binary16> >(
+                        max_symbols, max_symbol_size);
+            }
+            break;
+        case runtime_code::seed_rlnc:
+            switch(field)
+            {
+            case runtime_field::binary:
+                return make_runtime_encoder_factory<
+                    seed_rlnc_encoder<fifi::binary> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary8:
+                return make_runtime_encoder_factory<
+                    seed_rlnc_encoder<fifi::binary8> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary16:
+                return make_runtime_encoder_factory<
+                    seed_rlnc_encoder<fifi::binary16> >(
+                        max_symbols, max_symbol_size);
+            }
+            break;
+        case runtime_code::reed_solomon:
+            if(field == runtime_field::binary8)
+            {
+                return make_runtime_encoder_factory<
+                    rs_encoder<fifi::binary8> >(
+                        max_symbols, max_symbol_size);
+            }
+            break;
+        }
+
+        return boost::shared_ptr<runtime_encoder_factory>();
+    }
+
+    /// Creates the decoder factory of a code and field selected at
+    /// run-time.
+    /// @copydetails make_runtime_encoder_factory(runtime_code,
+    ///     runtime_field,uint32_t,uint32_t)
+    inline boost::shared_ptr<runtime_decoder_factory>
+    make_runtime_decoder_factory(runtime_code code, runtime_field field,
+                                 uint32_t max_symbols,
+                                 uint32_t max_symbol_size)
+    {
+        switch(code)
+        {
+        case runtime_code::full_rlnc:
+            switch(field)
+            {
+            case runtime_field::binary:
+                return make_runtime_decoder_factory<
+                    full_rlnc_decoder<fifi::binary> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary8:
+                return make_runtime_decoder_factory<
+                    full_rlnc_decoder<fifi::binary8> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary16:
+                return make_runtime_decoder_factory<
+                    full_rlnc_decoder<fifi::binary16> >(
+                        max_symbols, max_symbol_size);
+            }
+            break;
+        case runtime_code::seed_rlnc:
+            switch(field)
+            {
+            case runtime_field::binary:
+                return make_runtime_decoder_factory<
+                    seed_rlnc_decoder<fifi::binary> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary8:
+                return make_runtime_decoder_factory<
+                    seed_rlnc_decoder<fifi::binary8> >(
+                        max_symbols, max_symbol_size);
+            case runtime_field::binary16:
+                return make_runtime_decoder_factory<
+                    seed_rlnc_decoder<fifi::binary16> >(
+                        max_symbols, max_symbol_size);
+            }
+            break;
+        case runtime_code::reed_solomon:
+            if(field == runtime_field::binary8)
+            {
+                return make_runtime_decoder_factory<
+                    rs_decoder<fifi::binary8> >(
+                        max_symbols, max_symbol_size);
+            }
+            break;
+        }
+
+        return boost::shared_ptr<runtime_decoder_factory>();
+    }
+
+}
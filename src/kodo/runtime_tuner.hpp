@@ -0,0 +1,527 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "runtime_codes.hpp"
+
+namespace kodo
+{
+
+    /// @return The name of a code as written in a runtime_profile
+    inline const char* runtime_code_name(runtime_code code)
+    {
+        switch(code)
+        {
+        case runtime_code::full_rlnc:
+            return "full_rlnc";
+        case runtime_code::seed_rlnc:
+            return "seed_rlnc";
+        case runtime_code::reed_solomon:
+            return "reed_solomon";
+        }
+
+        assert(0);
+        return "";
+    }
+
+    /// @return The name of a field as written in a runtime_profile
+    inline const char* runtime_field_name(runtime_field field)
+    {
+        switch(field)
+        {
+        case runtime_field::binary:
+            return "binary";
+        case runtime_field::binary8:
+            return "binary8";
+        case runtime_field::binary16:
+            return "binary16";
+        }
+
+        assert(0);
+        return "";
+    }
+
+    /// A code configuration and its measured performance, as chosen by
+    /// the runtime_tuner and loaded by the runtime factories
+    struct runtime_profile
+    {
+
+        /// Constructs the default configuration
+        runtime_profile()
+            : m_code(runtime_code::full_rlnc),
+              m_field(runtime_field::binary8),
+              m_symbols(32),
+              m_symbol_size(1400),
+              m_goodput(0),
+              m_latency(0)
+            { }
+
+        /// The code
+        runtime_code m_code;
+
+        /// The finite field
+        runtime_field m_field;
+
+        /// The number of symbols of a generation
+        uint32_t m_symbols;
+
+        /// The symbol size in bytes
+        uint32_t m_symbol_size;
+
+        /// The decoded bytes per second, including the payloads lost
+        /// and the non-innovative payloads, or zero if not measured
+        double m_goodput;
+
+        /// The seconds from the first payload of a generation until it
+        /// is decoded, or zero if not measured
+        double m_latency;
+
+    };
+
+    /// Writes a profile as one "key value" pair per line
+    /// @param out The stream to write to
+    /// @param profile The profile
+    inline void write_runtime_profile(std::ostream &out,
+                                      const runtime_profile &profile)
+    {
+        out << "code " << runtime_code_name(profile.m_code) << "\n"
+            << "field " << runtime_field_name(profile.m_field) << "\n"
+            << "symbols " << profile.m_symbols << "\n"
+            << "symbol_size " << profile.m_symbol_size << "\n"
+            << "goodput " << profile.m_goodput << "\n"
+            << "latency " << profile.m_latency << "\n";
+    }
+
+    /// Reads a profile written by write_runtime_profile(), keys which
+    /// are missing keep their value
+    /// @param in The stream to read from
+    /// @param profile The profile read
+    /// @return True if the stream held a valid profile
+    inline bool read_runtime_profile(std::istream &in,
+                                     runtime_profile &profile)
+    {
+        runtime_profile result = profile;
+        std::string key;
+
+        while(in >> key)
+        {
+            if(key == "code")
+            {
+                std::string value;
+                in >> value;
+
+                bool found = false;
+                for(runtime_code c : { runtime_code::full_rlnc,
+                                       runtime_code::seed_rlnc,
+                                       runtime_code::reed_solomon })
+                {
+                    if(value == runtime_code_name(c))
+                    {
+                        result.m_code = c;
+                        found = true;
+                    }
+                }
+
+                if(!found)
+                    return false;
+            }
+            else if(key == "field")
+            {
+                std::string value;
+                in >> value;
+
+                bool found = false;
+                for(runtime_field f : { runtime_field::binary,
+                                        runtime_field::binary8,
+                                        runtime_field::binary16 })
+                {
+                    if(value == runtime_field_name(f))
+                    {
+                        result.m_field = f;
+                        found = true;
+                    }
+                }
+
+                if(!found)
+                    return false;
+            }
+            else if(key == "symbols")
+                in >> result.m_symbols;
+            else if(key == "symbol_size")
+                in >> result.m_symbol_size;
+            else if(key == "goodput")
+                in >> result.m_goodput;
+            else if(key == "latency")
+                in >> result.m_latency;
+            else
+                return false;
+
+            if(in.fail())
+                return false;
+        }
+
+        if(result.m_symbols == 0 || result.m_symbol_size == 0)
+            return false;
+
+        profile = result;
+        return true;
+    }
+
+    /// Writes a profile to a file
+    /// @param path The path of the file
+    /// @param profile The profile
+    /// @return True if the file was written
+    inline bool save_runtime_profile(const std::string &path,
+                                     const runtime_profile &profile)
+    {
+        std::ofstream out(path.c_str());
+        write_runtime_profile(out, profile);
+        return out.good();
+    }
+
+    /// Reads a profile from a file
+    /// @param path The path of the file
+    /// @param profile The profile read, unchanged on failure
+    /// @return True if the file held a valid profile
+    inline bool load_runtime_profile(const std::string &path,
+                                     runtime_profile &profile)
+    {
+        std::ifstream in(path.c_str());
+
+        if(!in)
+            return false;
+
+        return read_runtime_profile(in, profile);
+    }
+
+    /// Creates the encoder factory of a profile
+    /// @param profile The profile
+    /// @return The factory, or an empty pointer if the code does not
+    ///         support the field
+    inline boost::shared_ptr<runtime_encoder_factory>
+    make_runtime_encoder_factory(const runtime_profile &profile)
+    {
+        return make_runtime_encoder_factory(
+            profile.m_code, profile.m_field,
+            profile.m_symbols, profile.m_symbol_size);
+    }
+
+    /// Creates the decoder factory of a profile
+    /// @copydetails make_runtime_encoder_factory(const runtime_profile&)
+    inline boost::shared_ptr<runtime_decoder_factory>
+    make_runtime_decoder_factory(const runtime_profile &profile)
+    {
+        return make_runtime_decoder_factory(
+            profile.m_code, profile.m_field,
+            profile.m_symbols, profile.m_symbol_size);
+    }
+
+    /// @brief Chooses the code configuration from short encoding and
+    ///        decoding runs on the machine.
+    ///
+    /// The fastest field, generation size and code differ a lot between
+    /// platforms, e.g. with and without SIMD kernels, so the tuner
+    /// measures a list of candidates at start-up or install time and
+    /// keeps the fastest one meeting the constraints. Each candidate
+    /// codes whole generations, as the throughput benchmark does, until
+    /// the calibration time has passed. The payloads are erased at the
+    /// target loss rate before decoding, so the extra payloads needed
+    /// with small fields or lost systematic symbols count against the
+    /// goodput of a candidate.
+    ///
+    /// If a link rate is set the goodput is also limited by the payloads
+    /// sent per generation and the latency includes the time to send
+    /// them, otherwise only the computation is measured.
+    class runtime_tuner
+    {
+    public:
+
+        /// The clock timing the runs
+        typedef std::chrono::steady_clock clock_type;
+
+    public:
+
+        /// Constructor
+        runtime_tuner()
+            : m_loss_rate(0.0),
+              m_max_latency(0.0),
+              m_link_rate(0.0),
+              m_calibration_time(0.02)
+        { }
+
+        /// Sets the expected fraction of payloads lost
+        /// @param loss_rate The loss rate in [0, 1)
+        void set_loss_rate(double loss_rate)
+        {
+            assert(loss_rate >= 0.0);
+            assert(loss_rate < 1.0);
+            m_loss_rate = loss_rate;
+        }
+
+        /// Sets the largest latency allowed for a generation
+        /// @param seconds The latency in seconds, zero for no limit
+        void set_max_latency(double seconds)
+        {
+            assert(seconds >= 0.0);
+            m_max_latency = seconds;
+        }
+
+        /// Sets the rate of the link carrying the payloads
+        /// @param bytes_per_second The rate, zero to only measure the
+        ///        computation
+        void set_link_rate(double bytes_per_second)
+        {
+            assert(bytes_per_second >= 0.0);
+            m_link_rate = bytes_per_second;
+        }
+
+        /// Sets the time each candidate is run
+        /// @param seconds The calibration time in seconds
+        void set_calibration_time(double seconds)
+        {
+            assert(seconds > 0.0);
+            m_calibration_time = seconds;
+        }
+
+        /// Adds a configuration to measure
+        /// @param code The code
+        /// @param field The finite field
+        /// @param symbols The number of symbols
+        /// @param symbol_size The symbol size
+        void add_candidate(runtime_code code, runtime_field field,
+                           uint32_t symbols, uint32_t symbol_size)
+        {
+            assert(symbols > 0);
+            assert(symbol_size > 0);
+
+            runtime_profile candidate;
+            candidate.m_code = code;
+            candidate.m_field = field;
+            candidate.m_symbols = symbols;
+            candidate.m_symbol_size = symbol_size;
+
+            m_candidates.push_back(candidate);
+        }
+
+        /// Adds every code and field with generation sizes of powers of
+        /// two from 16 and the symbol size, half and a quarter of it
+        /// @param max_symbols The largest number of symbols
+        /// @param max_symbol_size The largest symbol size
+        void add_default_candidates(uint32_t max_symbols,
+                                    uint32_t max_symbol_size)
+        {
+            assert(max_symbols > 0);
+            assert(max_symbol_size > 0);
+
+            const runtime_field fields[] = { runtime_field::binary,
+                                             runtime_field::binary8,
+                                             runtime_field::binary16 };
+
+            for(uint32_t symbols = std::min(16U, max_symbols);
+                symbols <= max_symbols; symbols *= 2)
+            {
+                for(uint32_t size = max_symbol_size;
+                    size >= max_symbol_size / 4 && size > 0; size /= 2)
+                {
+                    for(runtime_field field : fields)
+                    {
+                        add_candidate(runtime_code::full_rlnc, field,
+                                      symbols, size);
+                        add_candidate(runtime_code::seed_rlnc, field,
+                                      symbols, size);
+                    }
+
+                    // The Reed-Solomon codes only use binary8 and a
+                    // generation within the field
+                    if(symbols < 256)
+                    {
+                        add_candidate(runtime_code::reed_solomon,
+                                      runtime_field::binary8,
+                                      symbols, size);
+                    }
+                }
+            }
+        }
+
+        /// @return The configurations to measure
+        const std::vector<runtime_profile>& candidates() const
+        {
+            return m_candidates;
+        }
+
+        /// Measures every candidate and chooses the one with the highest
+        /// goodput within the latency limit
+        /// @param profile The profile chosen, unchanged if no candidate
+        ///        met the constraints
+        /// @return True if a candidate met the constraints
+        bool tune(runtime_profile &profile)
+        {
+            m_results.clear();
+
+            const runtime_profile *best = 0;
+
+            for(const auto &candidate : m_candidates)
+            {
+                runtime_profile result = candidate;
+
+                if(!measure(result))
+                    continue;
+
+                m_results.push_back(result);
+            }
+
+            for(const auto &result : m_results)
+            {
+                if(m_max_latency > 0 && result.m_latency > m_max_latency)
+                    continue;
+
+                if(best == 0 || result.m_goodput > best->m_goodput)
+                    best = &result;
+            }
+
+            if(best == 0)
+                return false;
+
+            profile = *best;
+            return true;
+        }
+
+        /// @return The measured candidates of the last call to tune()
+        const std::vector<runtime_profile>& results() const
+        {
+            return m_results;
+        }
+
+    protected:
+
+        /// Codes generations of a candidate for the calibration time
+        /// @param candidate The candidate, its goodput and latency are
+        ///        set
+        /// @return False if the code does not support the field or the
+        ///         generations could not be decoded
+        bool measure(runtime_profile &candidate)
+        {
+            auto encoder_factory = make_runtime_encoder_factory(candidate);
+            auto decoder_factory = make_runtime_decoder_factory(candidate);
+
+            if(!encoder_factory || !decoder_factory)
+                return false;
+
+            uint32_t block_size =
+                candidate.m_symbols * candidate.m_symbol_size;
+
+            std::vector<uint8_t> data(block_size);
+            for(auto &d : data)
+            {
+                d = static_cast<uint8_t>(m_random());
+            }
+
+            std::vector<uint8_t> payload(
+                encoder_factory->max_payload_size());
+            uint8_t *payloads = &payload[0];
+
+            uint64_t generations = 0;
+            uint64_t sent = 0;
+
+            auto duration = std::chrono::duration_cast<clock_type::duration>(
+                std::chrono::duration<double>(m_calibration_time));
+
+            auto start = clock_type::now();
+            auto elapsed = clock_type::duration::zero();
+
+            while(generations == 0 || elapsed < duration)
+            {
+                auto encoder = encoder_factory->build();
+                auto decoder = decoder_factory->build();
+
+                encoder->set_symbols(sak::storage(data));
+
+                uint32_t generation_sent = 0;
+
+                while(!decoder->is_complete())
+                {
+                    encoder->encode(&payloads, 1);
+                    ++generation_sent;
+
+                    if(generation_sent > 100 * candidate.m_symbols)
+                        return false;
+
+                    if(m_uniform(m_random) < m_loss_rate)
+                        continue;
+
+                    decoder->decode(&payloads, 1);
+                }
+
+                sent += generation_sent;
+                ++generations;
+
+                elapsed = clock_type::now() - start;
+            }
+
+            double seconds =
+                std::chrono::duration<double>(elapsed).count();
+
+            candidate.m_goodput = generations * block_size / seconds;
+            candidate.m_latency = seconds / generations;
+
+            if(m_link_rate > 0)
+            {
+                double link_bytes =
+                    double(sent) * payload.size() / generations;
+
+                double link_seconds = link_bytes / m_link_rate;
+
+                candidate.m_latency += link_seconds;
+                candidate.m_goodput = std::min(
+                    candidate.m_goodput, block_size / link_seconds);
+            }
+
+            return true;
+        }
+
+    protected:
+
+        /// The expected fraction of payloads lost
+        double m_loss_rate;
+
+        /// The latency limit in seconds, zero for no limit
+        double m_max_latency;
+
+        /// The link rate in bytes per second, zero if not set
+        double m_link_rate;
+
+        /// The time each candidate is run in seconds
+        double m_calibration_time;
+
+        /// The configurations to measure
+        std::vector<runtime_profile> m_candidates;
+
+        /// The measured candidates
+        std::vector<runtime_profile> m_results;
+
+        /// The generator of the data and the erasures
+        boost::random::mt19937 m_random;
+
+        /// The distribution of the erasures
+        boost::random::uniform_01<double> m_uniform;
+
+    };
+
+}
@@ -10,6 +10,8 @@
 
 #include <fifi/fifi_utils.hpp>
 
+#include "aligned_coefficients_buffer.hpp"
+
 namespace kodo
 {
 
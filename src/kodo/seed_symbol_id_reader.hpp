@@ -6,6 +6,13 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <sak/convert_endian.hpp>
 
 #include <fifi/fifi_utils.hpp>
 
@@ -18,6 +25,15 @@ namespace kodo
     ///        the generator layer, which produces the corresponding coding
     ///        coefficients.
     ///
+    /// Optionally the coding coefficients of the most recently used
+    /// seeds are kept in a cache, so that a seed received again, e.g. in
+    /// a later block using the same seed schedule, is not generated
+    /// again. The cache is kept as long as the number of symbols is
+    /// unchanged, i.e. the coefficients must only depend on the seed and
+    /// the number of symbols. Also optionally, a seed already read in
+    /// the current block yields an all-zero coding vector, which the
+    /// decoder rejects as non-innovative without touching the symbols.
+    ///
     /// @ingroup symbol_id_layers
     template<class SuperCoder>
     class seed_symbol_id_reader : public seed_symbol_id<SuperCoder>
@@ -32,6 +48,96 @@ namespace kodo
 
     public:
 
+        /// @ingroup factory_layers
+        /// The factory layer holding the seed cache settings
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size),
+                  m_seed_cache_size(0),
+                  m_reject_duplicate_seeds(false)
+            { }
+
+            /// Sets the number of coefficient vectors cached by the
+            /// decoders built after this call
+            /// @param cache_size The number of vectors, zero disables
+            ///        the cache
+            void set_seed_cache_size(uint32_t cache_size)
+            {
+                m_seed_cache_size = cache_size;
+            }
+
+            /// @return The number of coefficient vectors cached
+            uint32_t seed_cache_size() const
+            {
+                return m_seed_cache_size;
+            }
+
+            /// Sets whether the decoders built after this call reject the
+            /// seeds already read in a block
+            /// @param reject True for rejecting the duplicate seeds
+            void set_reject_duplicate_seeds(bool reject)
+            {
+                m_reject_duplicate_seeds = reject;
+            }
+
+            /// @return True if the duplicate seeds are rejected
+            bool reject_duplicate_seeds() const
+            {
+                return m_reject_duplicate_seeds;
+            }
+
+        protected:
+
+            /// The number of coefficient vectors cached
+            uint32_t m_seed_cache_size;
+
+            /// True if the duplicate seeds are rejected
+            bool m_reject_duplicate_seeds;
+        };
+
+    public:
+
+        /// Constructor
+        seed_symbol_id_reader()
+            : m_cache_symbols(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            Super::initialize(the_factory);
+
+            uint32_t cache_size = the_factory.seed_cache_size();
+
+            if(cache_size != m_cache_coefficients.size() ||
+               the_factory.symbols() != m_cache_symbols)
+            {
+                m_cache_coefficients.resize(cache_size);
+                m_cache_seeds.resize(cache_size);
+                m_cache_order.clear();
+                m_cache_index.clear();
+
+                for(uint32_t i = 0; i < cache_size; ++i)
+                {
+                    m_cache_coefficients[i].resize(
+                        the_factory.max_coefficients_size());
+                }
+
+                m_cache_symbols = the_factory.symbols();
+            }
+
+            m_reject_duplicate_seeds = the_factory.reject_duplicate_seeds();
+            m_read_seeds.clear();
+
+            m_seed_cache_hits = 0;
+            m_duplicate_seeds = 0;
+        }
+
         /// @copydoc layer::read_id(uint8_t*, uint8_t**)
         void read_id(uint8_t *symbol_id, uint8_t **symbol_coefficients)
         {
@@ -40,10 +146,78 @@ namespace kodo
 
             seed_type seed = sak::big_endian::get<seed_type>(symbol_id);
 
+            *symbol_coefficients = &m_coefficients[0];
+
+            uint32_t coefficients_size = Super::coefficients_size();
+
+            if(m_reject_duplicate_seeds && !m_read_seeds.insert(seed).second)
+            {
+                std::fill_n(m_coefficients.begin(), coefficients_size, 0);
+                ++m_duplicate_seeds;
+                return;
+            }
+
+            if(m_cache_coefficients.empty())
+            {
+                Super::seed(seed);
+                Super::generate(&m_coefficients[0]);
+                return;
+            }
+
+            auto cached = m_cache_index.find(seed);
+
+            if(cached != m_cache_index.end())
+            {
+                // The decoder modifies the coefficients, so the cached
+                // vector is copied
+                uint32_t entry = *cached->second;
+                m_cache_order.splice(m_cache_order.begin(), m_cache_order,
+                                     cached->second);
+
+                std::copy_n(m_cache_coefficients[entry].begin(),
+                            coefficients_size, m_coefficients.begin());
+
+                ++m_seed_cache_hits;
+                return;
+            }
+
             Super::seed(seed);
             Super::generate(&m_coefficients[0]);
 
-            *symbol_coefficients = &m_coefficients[0];
+            uint32_t entry;
+
+            if(m_cache_order.size() < m_cache_coefficients.size())
+            {
+                entry = m_cache_order.size();
+            }
+            else
+            {
+                // Evict the least recently used seed
+                entry = m_cache_order.back();
+                m_cache_order.pop_back();
+                m_cache_index.erase(m_cache_seeds[entry]);
+            }
+
+            std::copy_n(m_coefficients.begin(), coefficients_size,
+                        m_cache_coefficients[entry].begin());
+
+            m_cache_seeds[entry] = seed;
+            m_cache_order.push_front(entry);
+            m_cache_index[seed] = m_cache_order.begin();
+        }
+
+        /// @return The number of seeds read from the cache since the
+        ///         decoder was initialized
+        uint32_t seed_cache_hits() const
+        {
+            return m_seed_cache_hits;
+        }
+
+        /// @return The number of duplicate seeds rejected since the
+        ///         decoder was initialized
+        uint32_t duplicate_seeds() const
+        {
+            return m_duplicate_seeds;
         }
 
     private:
@@ -52,8 +226,38 @@ namespace kodo
         /// layer used by the seed_symbol_id layer
         using Super::m_coefficients;
 
-    };
+        /// The storage type of the cached coefficients
+        typedef typename Super::aligned_vector aligned_vector;
 
-}
+    private:
+
+        /// The cached coefficient vectors
+        std::vector<aligned_vector> m_cache_coefficients;
+
+        /// The seed of every cached coefficient vector
+        std::vector<seed_type> m_cache_seeds;
+
+        /// The cache entries, most recently used first
+        std::list<uint32_t> m_cache_order;
+
+        /// The position in the cache order of every cached seed
+        std::map<seed_type, std::list<uint32_t>::iterator> m_cache_index;
 
+        /// The number of symbols of the cached coefficient vectors
+        uint32_t m_cache_symbols;
 
+        /// The seeds read in the current block
+        std::set<seed_type> m_read_seeds;
+
+        /// True if the duplicate seeds are rejected
+        bool m_reject_duplicate_seeds;
+
+        /// The number of seeds read from the cache
+        uint32_t m_seed_cache_hits;
+
+        /// The number of duplicate seeds rejected
+        uint32_t m_duplicate_seeds;
+
+    };
+
+}
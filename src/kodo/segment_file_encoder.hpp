@@ -0,0 +1,275 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/convert_endian.hpp>
+
+#include "file_encoder.hpp"
+#include "systematic_base_coder.hpp"
+#include "systematic_operations.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief The part of a file holding the data of a systematic
+    ///        symbol, see segment_file_encoder.
+    struct file_segment
+    {
+        /// The offset of the data in the file
+        uint64_t m_offset;
+
+        /// The number of bytes of the file, zero for a coded symbol
+        uint32_t m_length;
+
+        /// The number of zero bytes following the data of the file to
+        /// complete the symbol, e.g. at the end of the file
+        uint32_t m_padding;
+    };
+
+    /// @brief Encodes a file where the systematic symbols are never
+    ///        read into user space.
+    ///
+    /// The data of a systematic symbol is the data of the file
+    /// unchanged, so for the systematic symbols only the header is
+    /// written and the data is described by a file_segment, which the
+    /// transport sends straight from the file with sendfile(), splice()
+    /// or MSG_ZEROCOPY. The payload of a systematic symbol is the
+    /// segment, followed by the padding and the header, which is the
+    /// layout of the payloads of the payload_encoder. The encoder of a
+    /// block is only built, reading the block with the file_reader,
+    /// when the first coded symbol of the block is needed, and it
+    /// produces coded symbols only, since the systematic symbols were
+    /// already sent.
+    ///
+    /// The systematic header is the header of the systematic_encoder,
+    /// so the payloads are decoded by the decoders of the EncoderType,
+    /// which must use the systematic_encoder and deep storage.
+    template
+    <
+        class EncoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class segment_file_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The encoder factory type
+        typedef typename EncoderType::factory factory;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer;
+
+        /// The block partitioning scheme used
+        typedef BlockPartitioning block_partitioning;
+
+        /// The file encoder building the encoders of the coded symbols
+        typedef file_encoder<EncoderType, BlockPartitioning>
+            file_encoder_type;
+
+        /// The type of the systematic flag
+        typedef systematic_base_coder::flag_type flag_type;
+
+        /// The type of the systematic symbol index
+        typedef systematic_base_coder::counter_type counter_type;
+
+    public:
+
+        /// Constructs a new segment file encoder, no data is read
+        /// @param encoder_factory The encoder factory to use
+        /// @param filename The file to encode
+        segment_file_encoder(factory &encoder_factory,
+                             const std::string &filename)
+            : m_file_encoder(encoder_factory, filename),
+              m_partitioning(encoder_factory.max_symbols(),
+                             encoder_factory.max_symbol_size(),
+                             m_file_encoder.object_size()),
+              m_max_header_size(encoder_factory.max_header_size())
+        {
+            uint32_t blocks = m_partitioning.blocks();
+
+            assert(blocks == m_file_encoder.encoders());
+
+            m_systematic_count.resize(blocks, 0);
+            m_encoders.resize(blocks);
+        }
+
+        /// @return The number of blocks of the file
+        uint32_t blocks() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// @return The size in bytes of the file
+        uint64_t object_size() const
+        {
+            return m_file_encoder.object_size();
+        }
+
+        /// @param block_id The block
+        /// @return The number of symbols of the block
+        uint32_t symbols(uint32_t block_id) const
+        {
+            return m_partitioning.symbols(block_id);
+        }
+
+        /// @param block_id The block
+        /// @return The size of the symbols of the block
+        uint32_t symbol_size(uint32_t block_id) const
+        {
+            return m_partitioning.symbol_size(block_id);
+        }
+
+        /// @return The size of the largest header of a symbol
+        uint32_t max_header_size() const
+        {
+            return m_max_header_size;
+        }
+
+        /// @param block_id The block
+        /// @return The number of systematic symbols of the block encoded
+        uint32_t systematic_count(uint32_t block_id) const
+        {
+            assert(block_id < blocks());
+            return m_systematic_count[block_id];
+        }
+
+        /// @param block_id The block
+        /// @return True if the encoder of the block was built, i.e. its
+        ///         data was read into user space
+        bool has_encoder(uint32_t block_id) const
+        {
+            assert(block_id < blocks());
+            return static_cast<bool>(m_encoders[block_id]);
+        }
+
+        /// Encodes the next symbol of a block. The systematic symbols
+        /// of the block come first, for those only the header is written
+        /// and the segment describes the data, afterwards coded symbols
+        /// are written to the symbol data buffer and the length of the
+        /// segment is zero.
+        /// @param block_id The block
+        /// @param symbol_data The buffer for coded symbol data, must be
+        ///        at least symbol_size() bytes
+        /// @param symbol_header The buffer for the symbol header, must
+        ///        be at least max_header_size() bytes
+        /// @param segment Set to the data of a systematic symbol
+        /// @return The number of bytes used in the symbol header
+        uint32_t encode(uint32_t block_id, uint8_t *symbol_data,
+                        uint8_t *symbol_header, file_segment &segment)
+        {
+            assert(block_id < blocks());
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint32_t index = m_systematic_count[block_id];
+
+            if(index < m_partitioning.symbols(block_id))
+            {
+                ++m_systematic_count[block_id];
+
+                describe_symbol(block_id, index, segment);
+                return write_systematic_header(index, symbol_header);
+            }
+
+            segment.m_offset = 0;
+            segment.m_length = 0;
+            segment.m_padding = 0;
+
+            return encoder(block_id)->encode(symbol_data, symbol_header);
+        }
+
+        /// Releases the encoder of a block, e.g. when the receivers
+        /// have decoded the block
+        /// @param block_id The block
+        void release_encoder(uint32_t block_id)
+        {
+            assert(block_id < blocks());
+            m_encoders[block_id].reset();
+        }
+
+    private:
+
+        /// @param block_id The block
+        /// @return The encoder of the coded symbols of the block, built
+        ///         on the first call
+        const pointer& encoder(uint32_t block_id)
+        {
+            pointer &e = m_encoders[block_id];
+
+            if(!e)
+            {
+                e = m_file_encoder.build(block_id);
+
+                // The systematic symbols were sent from the file
+                if(is_systematic_encoder(e))
+                    set_systematic_off(e);
+            }
+
+            return e;
+        }
+
+        /// Describes the data of a systematic symbol
+        /// @param block_id The block
+        /// @param index The index of the symbol in the block
+        /// @param segment The segment
+        void describe_symbol(uint32_t block_id, uint32_t index,
+                             file_segment &segment) const
+        {
+            uint32_t symbol_size = m_partitioning.symbol_size(block_id);
+            uint32_t bytes_used = m_partitioning.bytes_used(block_id);
+            uint32_t start = index * symbol_size;
+
+            segment.m_offset = m_partitioning.byte_offset(block_id) + start;
+            segment.m_length = start < bytes_used ?
+                std::min(symbol_size, bytes_used - start) : 0;
+            segment.m_padding = symbol_size - segment.m_length;
+        }
+
+        /// Writes the header of a systematic symbol as the
+        /// systematic_encoder
+        /// @param index The index of the symbol
+        /// @param symbol_header The buffer for the symbol header
+        /// @return The number of bytes used in the symbol header
+        static uint32_t write_systematic_header(uint32_t index,
+                                                uint8_t *symbol_header)
+        {
+            sak::big_endian::put<flag_type>(
+                systematic_base_coder::systematic_flag, symbol_header);
+
+            sak::big_endian::put<counter_type>(
+                index, symbol_header + sizeof(flag_type));
+
+            return sizeof(flag_type) + sizeof(counter_type);
+        }
+
+    private:
+
+        /// The file encoder building the encoders of the coded symbols
+        file_encoder_type m_file_encoder;
+
+        /// The block partitioning scheme used
+        block_partitioning m_partitioning;
+
+        /// The size of the largest header
+        uint32_t m_max_header_size;
+
+        /// The number of systematic symbols encoded for every block
+        std::vector<uint32_t> m_systematic_count;
+
+        /// The encoders of the blocks with coded symbols
+        std::vector<pointer> m_encoders;
+    };
+
+}
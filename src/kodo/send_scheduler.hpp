@@ -0,0 +1,450 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace kodo
+{
+
+    /// @brief A token bucket limiting a byte rate, used by the
+    ///        send_scheduler.
+    ///
+    /// The bucket fills with rate() bytes per second up to burst()
+    /// bytes. A payload may be sent when the bucket holds its size, or
+    /// is full for a payload larger than the burst. Its size is then
+    /// taken from the bucket, which only goes negative for a payload
+    /// larger than the burst, so such payloads still pass and the
+    /// average rate is kept.
+    class token_bucket
+    {
+    public:
+
+        /// The clock of the time stamps
+        typedef std::chrono::steady_clock clock_type;
+
+        /// A time stamp
+        typedef clock_type::time_point time_point;
+
+    public:
+
+        /// Constructs a bucket which is full
+        /// @param rate The rate in bytes per second, zero for no limit
+        /// @param burst The largest number of bytes sent back to back
+        /// @param now The current time
+        token_bucket(uint64_t rate, uint64_t burst, time_point now)
+            : m_rate(rate),
+              m_burst(static_cast<double>(burst)),
+              m_tokens(static_cast<double>(burst)),
+              m_last(now)
+        {
+            assert(m_rate == 0 || m_burst > 0);
+        }
+
+        /// @return The rate in bytes per second, zero for no limit
+        uint64_t rate() const
+        {
+            return m_rate;
+        }
+
+        /// @return The size of the bucket in bytes
+        uint64_t burst() const
+        {
+            return static_cast<uint64_t>(m_burst);
+        }
+
+        /// Adds the tokens accumulated since the last refill
+        /// @param now The current time
+        void refill(time_point now)
+        {
+            if(now <= m_last)
+                return;
+
+            std::chrono::duration<double> elapsed = now - m_last;
+            m_last = now;
+
+            if(m_rate == 0)
+                return;
+
+            m_tokens = std::min(
+                m_burst, m_tokens + elapsed.count() * double(m_rate));
+        }
+
+        /// @param bytes The size of the payload
+        /// @return True if the payload may be sent
+        bool is_ready(uint32_t bytes) const
+        {
+            return m_rate == 0 || m_tokens >= required(bytes);
+        }
+
+        /// Takes the size of a sent payload from the bucket
+        /// @param bytes The size of the payload
+        void consume(uint32_t bytes)
+        {
+            if(m_rate > 0)
+                m_tokens -= bytes;
+        }
+
+        /// @param now The current time, the bucket must be refilled
+        /// @param bytes The size of the payload
+        /// @return The time when the payload may be sent
+        time_point ready_time(time_point now, uint32_t bytes) const
+        {
+            if(is_ready(bytes))
+                return now;
+
+            std::chrono::duration<double> wait(
+                (required(bytes) - m_tokens) / m_rate);
+
+            return now +
+                std::chrono::duration_cast<clock_type::duration>(wait) +
+                clock_type::duration(1);
+        }
+
+    private:
+
+        /// @param bytes The size of a payload
+        /// @return The tokens needed to send the payload
+        double required(uint32_t bytes) const
+        {
+            return std::min(m_burst, double(bytes));
+        }
+
+    private:
+
+        /// The rate in bytes per second
+        uint64_t m_rate;
+
+        /// The size of the bucket in bytes
+        double m_burst;
+
+        /// The bytes which may be sent
+        double m_tokens;
+
+        /// The time of the last refill
+        time_point m_last;
+
+    };
+
+    /// @brief Interleaves and paces the payloads of many encoders, e.g.
+    ///        one per session or block, sending them just in time.
+    ///
+    /// Looping over encode() for one session after the other sends
+    /// bursts which overflow the queues of the network card and the
+    /// switches, and the resulting losses cost repair payloads. The
+    /// scheduler instead shares the link by weighted fair queuing: the
+    /// next payload comes from the session with the smallest virtual
+    /// finish time, which advances by payload_size() / weight() per
+    /// payload, so the sessions get bandwidth in proportion to their
+    /// weights. The link and every session are paced by token buckets.
+    ///
+    /// A payload is only encoded when it may be sent, directly into the
+    /// buffer handed to the send function, so no coded payloads are
+    /// queued and the encoders always use their latest state:
+    ///
+    /// @code
+    ///   while(scheduler.sessions() > 0)
+    ///   {
+    ///       auto now = kodo::send_scheduler<pointer>::clock_type::now();
+    ///       scheduler.send(now, [&](uint32_t id, const uint8_t *payload,
+    ///                               uint32_t size)
+    ///           { sender.send(id, payload, size); });
+    ///       std::this_thread::sleep_until(scheduler.next_send_time(now));
+    ///   }
+    /// @endcode
+    ///
+    /// The scheduler is not thread safe, all calls must be made from the
+    /// sending thread.
+    template<class EncoderPointer>
+    class send_scheduler : boost::noncopyable
+    {
+    public:
+
+        /// The clock of the time stamps
+        typedef token_bucket::clock_type clock_type;
+
+        /// A time stamp
+        typedef token_bucket::time_point time_point;
+
+        /// The budget of a session without a limit on its payloads
+        static const uint32_t unlimited = 0xffffffffU;
+
+    public:
+
+        /// Constructs a new scheduler
+        /// @param max_payload_size The maximum payload size of the
+        ///        encoders, see layer::factory::max_payload_size()
+        /// @param rate The rate of the link in bytes per second, zero
+        ///        for no limit
+        /// @param burst The largest number of bytes sent back to back on
+        ///        the link
+        /// @param now The current time
+        send_scheduler(uint32_t max_payload_size, uint64_t rate,
+                       uint64_t burst, time_point now = clock_type::now())
+            : m_link(rate, burst, now),
+              m_next_id(0),
+              m_virtual_time(0)
+        {
+            assert(max_payload_size > 0);
+            m_payload.resize(max_payload_size);
+        }
+
+        /// Adds a session
+        /// @param encoder The encoder producing the payloads
+        /// @param weight The share of the link of the session relative
+        ///        to the other sessions
+        /// @param budget The number of payloads to send before the
+        ///        session is removed, or unlimited
+        /// @param rate The rate of the session in bytes per second, zero
+        ///        for no limit other than the link
+        /// @param burst The largest number of bytes the session sends
+        ///        back to back
+        /// @param now The current time
+        /// @return The id of the session
+        uint32_t add_session(const EncoderPointer &encoder,
+                             uint32_t weight = 1,
+                             uint32_t budget = unlimited,
+                             uint64_t rate = 0, uint64_t burst = 0,
+                             time_point now = clock_type::now())
+        {
+            assert(encoder);
+            assert(encoder->payload_size() <= m_payload.size());
+            assert(weight > 0);
+
+            session s(encoder, token_bucket(rate, burst, now));
+            s.m_id = m_next_id++;
+            s.m_weight = weight;
+            s.m_budget = budget;
+
+            // A new session starts at the current virtual time so it
+            // does not get the bandwidth it missed before it was added
+            s.m_finish = m_virtual_time;
+
+            m_sessions.push_back(s);
+
+            return s.m_id;
+        }
+
+        /// Removes a session, e.g. when its block was acknowledged
+        /// @param id The id of the session
+        /// @return True if the session was found
+        bool remove_session(uint32_t id)
+        {
+            for(uint32_t i = 0; i < m_sessions.size(); ++i)
+            {
+                if(m_sessions[i].m_id == id)
+                {
+                    remove(i);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /// Changes the number of payloads a session sends before it is
+        /// removed, e.g. when feedback reports the losses of a block
+        /// @param id The id of the session
+        /// @param budget The number of payloads, or unlimited
+        /// @return True if the session was found
+        bool set_budget(uint32_t id, uint32_t budget)
+        {
+            for(auto &s : m_sessions)
+            {
+                if(s.m_id == id)
+                {
+                    s.m_budget = budget;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /// @return The number of sessions
+        uint32_t sessions() const
+        {
+            return static_cast<uint32_t>(m_sessions.size());
+        }
+
+        /// Sends the payloads which are due, encoding each one right
+        /// before it is handed to the function
+        /// @param now The current time
+        /// @param function Invoked as function(id, payload, size) for
+        ///        every payload, the payload is only valid during the
+        ///        call and the function must not add or remove sessions
+        /// @param max_count The largest number of payloads to send
+        /// @return The number of payloads sent
+        template<class Function>
+        uint32_t send(time_point now, const Function &function,
+                      uint32_t max_count = unlimited)
+        {
+            m_link.refill(now);
+
+            for(auto &s : m_sessions)
+            {
+                s.m_bucket.refill(now);
+            }
+
+            uint32_t sent = 0;
+
+            while(sent < max_count)
+            {
+                uint32_t next = select();
+
+                if(next == m_sessions.size())
+                    break;
+
+                session &s = m_sessions[next];
+
+                // The encoded payload is at most payload_size() bytes
+                if(!m_link.is_ready(s.m_encoder->payload_size()))
+                    break;
+
+                uint32_t size = s.m_encoder->encode(&m_payload[0]);
+                assert(size <= m_payload.size());
+
+                m_link.consume(size);
+                s.m_bucket.consume(size);
+
+                m_virtual_time = s.m_finish;
+                s.m_finish += double(size) / s.m_weight;
+
+                if(s.m_budget != unlimited)
+                    --s.m_budget;
+
+                function(s.m_id, &m_payload[0], size);
+                ++sent;
+
+                if(m_sessions[next].m_budget == 0)
+                    remove(next);
+            }
+
+            return sent;
+        }
+
+        /// @param now The time of the last call to send()
+        /// @return The time when the next payload may be sent, the
+        ///         scheduler has no payloads to send if there are no
+        ///         sessions
+        time_point next_send_time(time_point now) const
+        {
+            time_point send_time = time_point::max();
+
+            for(const auto &s : m_sessions)
+            {
+                uint32_t size = s.m_encoder->payload_size();
+
+                time_point ready = std::max(
+                    s.m_bucket.ready_time(now, size),
+                    m_link.ready_time(now, size));
+
+                send_time = std::min(send_time, ready);
+            }
+
+            return send_time;
+        }
+
+    private:
+
+        /// The state of a session
+        struct session
+        {
+            session(const EncoderPointer &encoder,
+                    const token_bucket &bucket)
+                : m_encoder(encoder),
+                  m_bucket(bucket)
+            { }
+
+            /// The encoder of the session
+            EncoderPointer m_encoder;
+
+            /// The pacing of the session
+            token_bucket m_bucket;
+
+            /// The id of the session
+            uint32_t m_id;
+
+            /// The weight of the session
+            uint32_t m_weight;
+
+            /// The number of payloads left to send
+            uint32_t m_budget;
+
+            /// The virtual finish time of the last payload
+            double m_finish;
+        };
+
+        /// @return The index of the session sending next, or the number
+        ///         of sessions if no session may send
+        uint32_t select()
+        {
+            uint32_t next = static_cast<uint32_t>(m_sessions.size());
+            double finish = std::numeric_limits<double>::max();
+
+            for(uint32_t i = 0; i < m_sessions.size(); ++i)
+            {
+                const session &s = m_sessions[i];
+
+                if(s.m_budget == 0 ||
+                   !s.m_bucket.is_ready(s.m_encoder->payload_size()))
+                {
+                    continue;
+                }
+
+                // A session held back by its own bucket does not get
+                // ahead of the virtual time
+                double start = std::max(s.m_finish, m_virtual_time);
+
+                if(start < finish)
+                {
+                    finish = start;
+                    next = i;
+                }
+            }
+
+            // The finish time of an idle session catches up with the
+            // virtual time
+            if(next < m_sessions.size())
+                m_sessions[next].m_finish = finish;
+
+            return next;
+        }
+
+        /// Removes a session keeping the order of the others
+        /// @param index The index of the session
+        void remove(uint32_t index)
+        {
+            m_sessions.erase(m_sessions.begin() + index);
+        }
+
+    private:
+
+        /// The pacing of the link
+        token_bucket m_link;
+
+        /// The sessions
+        std::vector<session> m_sessions;
+
+        /// The id of the next session
+        uint32_t m_next_id;
+
+        /// The virtual time, the start of the last payload sent
+        double m_virtual_time;
+
+        /// The buffer the payloads are encoded into
+        std::vector<uint8_t> m_payload;
+
+    };
+
+}
@@ -104,15 +104,19 @@ namespace kodo
         /// @copydoc layer::set_symbols()
         void set_symbols(const storage_type &symbol_storage)
         {
-            auto symbol_sequence = sak::split_storage(
-                symbol_storage, SuperCoder::symbol_size());
+            uint32_t symbol_size = SuperCoder::symbol_size();
+            assert(symbol_storage.m_size ==
+                   SuperCoder::symbols() * symbol_size);
 
-            uint32_t sequence_size = symbol_sequence.size();
-            assert(sequence_size == SuperCoder::symbols());
+            // The symbols are sliced from the storage in place, so
+            // setting the symbols does not allocate
+            storage_type symbol = symbol_storage;
+            symbol.m_size = symbol_size;
 
-            for(uint32_t i = 0; i < sequence_size; ++i)
+            for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
             {
-                set_symbol(i, symbol_sequence[i]);
+                set_symbol(i, symbol);
+                symbol.m_data += symbol_size;
             }
         }
 
@@ -0,0 +1,364 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "block_executor.hpp"
+#include "stripe_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief File opened for reading (POSIX) at arbitrary offsets
+    ///        from several threads, the file is closed when the object
+    ///        is destroyed.
+    class readable_file : boost::noncopyable
+    {
+    public:
+
+        /// Opens a file, a file which does not exist is not an error
+        /// but leaves the object closed
+        /// @param filename The file to read
+        readable_file(const std::string &filename)
+            : m_fd(-1),
+              m_size(0)
+        {
+            m_fd = ::open(filename.c_str(), O_RDONLY);
+
+            if(m_fd < 0)
+            {
+                return;
+            }
+
+            struct stat info;
+            int result = ::fstat(m_fd, &info);
+            assert(result == 0);
+            (void) result;
+
+            m_size = static_cast<uint64_t>(info.st_size);
+        }
+
+        /// Closes the file
+        ~readable_file()
+        {
+            if(m_fd >= 0)
+            {
+                ::close(m_fd);
+            }
+        }
+
+        /// @return True if the file was opened
+        bool is_open() const
+        {
+            return m_fd >= 0;
+        }
+
+        /// @return The size of the file in bytes
+        uint64_t size() const
+        {
+            return m_size;
+        }
+
+        /// Reads into a buffer from a given offset
+        /// @param data The buffer
+        /// @param size The number of bytes to read
+        /// @param offset The offset in bytes into the file
+        /// @return True if all the bytes were read
+        bool read(uint8_t *data, uint32_t size, uint64_t offset) const
+        {
+            assert(is_open());
+            assert(data != 0);
+
+            while(size > 0)
+            {
+                ssize_t bytes = ::pread(m_fd, data, size,
+                                        static_cast<off_t>(offset));
+
+                if(bytes <= 0)
+                {
+                    return false;
+                }
+
+                data += bytes;
+                size -= static_cast<uint32_t>(bytes);
+                offset += static_cast<uint64_t>(bytes);
+            }
+
+            return true;
+        }
+
+    private:
+
+        /// The file descriptor
+        int m_fd;
+
+        /// The size of the file in bytes
+        uint64_t m_size;
+
+    };
+
+    /// @brief Reconstructs an object from the shards written by the
+    ///        shard_encoder.
+    ///
+    /// Every stripe is decoded from the records of the available
+    /// shards, using the data shards first so that a systematic code
+    /// only decodes the stripes when data shards are lost. With a
+    /// Reed-Solomon decoder, e.g. the rs_decoder, any k shards are
+    /// enough. Lost shards are given as empty file names or files which
+    /// do not exist or do not have the expected size.
+    ///
+    /// The decoders are built in batches on the calling thread, after
+    /// which reading the shards, decoding and writing the object are
+    /// spread over the threads of a block_executor. The decoders of a
+    /// factory share the generator matrix, and all stripes are decoded
+    /// from the same shards. The first stripe is decoded before the
+    /// others, so decoders caching their decoding matrices in the
+    /// factory, e.g. the rs_inverse_decoder, only read the cache when
+    /// the stripes are decoded concurrently.
+    template<class DecoderType>
+    class shard_decoder : boost::noncopyable
+    {
+    public:
+
+        /// The factory used to build the decoders
+        typedef typename DecoderType::factory factory_type;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer_type;
+
+    public:
+
+        /// Constructor
+        /// @param factory The decoder factory, it must match the factory
+        ///        of the shard_encoder
+        /// @param object_size The size in bytes of the object
+        /// @param parity_shards The number of parity shards
+        /// @param executor The executor running the decoding
+        /// @param batch The number of stripes decoded at a time, if zero
+        ///        four stripes per thread of the executor are used
+        shard_decoder(factory_type &factory, uint64_t object_size,
+                      uint32_t parity_shards, block_executor &executor,
+                      uint32_t batch = 0)
+            : m_factory(factory),
+              m_partitioning(factory.max_symbols(),
+                             factory.max_symbol_size(), object_size),
+              m_data_shards(factory.max_symbols()),
+              m_parity_shards(parity_shards),
+              m_record_size(factory.max_payload_size()),
+              m_executor(executor),
+              m_batch(batch ? batch : 4 * executor.threads())
+        {
+            assert(m_data_shards > 0);
+            assert(m_parity_shards > 0);
+            assert(m_record_size > 0);
+            assert(m_batch > 0);
+        }
+
+        /// @copydoc shard_encoder::data_shards() const
+        uint32_t data_shards() const
+        {
+            return m_data_shards;
+        }
+
+        /// @copydoc shard_encoder::parity_shards() const
+        uint32_t parity_shards() const
+        {
+            return m_parity_shards;
+        }
+
+        /// @copydoc shard_encoder::shards() const
+        uint32_t shards() const
+        {
+            return m_data_shards + m_parity_shards;
+        }
+
+        /// @copydoc shard_encoder::stripes() const
+        uint32_t stripes() const
+        {
+            return m_partitioning.blocks();
+        }
+
+        /// @copydoc shard_encoder::shard_size() const
+        uint64_t shard_size() const
+        {
+            return uint64_t(stripes()) * m_record_size;
+        }
+
+        /// @copydoc shard_encoder::object_size() const
+        uint64_t object_size() const
+        {
+            return m_partitioning.object_size();
+        }
+
+        /// Reconstructs the object from the available shards
+        /// @param filenames The files of the shards, the data shards
+        ///        first
+        /// @param writer Receives the decoded stripes through
+        ///        write(decoder, offset, size) as the file_writer, the
+        ///        writer is called concurrently for disjoint parts of
+        ///        the object
+        /// @return True if every stripe was decoded
+        template<class ObjectWriter>
+        bool decode(const std::vector<std::string> &filenames,
+                    ObjectWriter &writer)
+        {
+            assert(filenames.size() == shards());
+
+            std::vector<boost::shared_ptr<readable_file> > files;
+
+            for(const auto &filename : filenames)
+            {
+                if(filename.empty())
+                {
+                    continue;
+                }
+
+                auto file = boost::make_shared<readable_file>(filename);
+
+                if(file->is_open() && file->size() == shard_size())
+                {
+                    files.push_back(file);
+                }
+            }
+
+            if(files.size() < m_data_shards)
+            {
+                return false;
+            }
+
+            std::atomic<bool> failed(false);
+
+            std::vector<pointer_type> decoders(m_batch);
+
+            std::vector<std::vector<uint8_t> > payloads(
+                m_batch, std::vector<uint8_t>(m_record_size));
+
+            auto decode_one = [&](uint32_t stripe, uint32_t i)
+                {
+                    if(!decode_stripe(stripe, decoders[i], &payloads[i][0],
+                                      files))
+                    {
+                        failed = true;
+                        return;
+                    }
+
+                    writer.write(decoders[i],
+                                 m_partitioning.byte_offset(stripe),
+                                 m_partitioning.bytes_used(stripe));
+                };
+
+            decoders[0] = build();
+            decode_one(0, 0);
+
+            for(uint32_t first = 1; first < stripes(); first += m_batch)
+            {
+                if(failed)
+                {
+                    break;
+                }
+
+                uint32_t count = std::min(m_batch, stripes() - first);
+
+                // The factory is not thread-safe, so the decoders are
+                // built on this thread
+                for(uint32_t i = 0; i < count; ++i)
+                {
+                    decoders[i] = build();
+                }
+
+                m_executor.run(count, [&](uint32_t i)
+                    {
+                        decode_one(first + i, i);
+                    });
+            }
+
+            return !failed;
+        }
+
+    private:
+
+        /// @return A decoder for a stripe
+        pointer_type build()
+        {
+            m_factory.set_symbols(m_partitioning.symbols(0));
+            m_factory.set_symbol_size(m_partitioning.symbol_size(0));
+
+            return m_factory.build();
+        }
+
+        /// Decodes a stripe from the records of the shards
+        /// @param stripe The stripe
+        /// @param decoder The decoder of the stripe
+        /// @param payload Buffer for a record
+        /// @param files The available shard files
+        /// @return True if the stripe was decoded
+        bool decode_stripe(
+            uint32_t stripe, pointer_type &decoder, uint8_t *payload,
+            const std::vector<boost::shared_ptr<readable_file> > &files)
+        {
+            assert(decoder);
+            assert(payload != 0);
+
+            uint64_t offset = uint64_t(stripe) * m_record_size;
+
+            for(uint32_t i = 0; i < files.size(); ++i)
+            {
+                if(decoder->is_complete())
+                {
+                    break;
+                }
+
+                if(!files[i]->read(payload, m_record_size, offset))
+                {
+                    continue;
+                }
+
+                decoder->decode(payload);
+            }
+
+            return decoder->is_complete();
+        }
+
+    private:
+
+        /// The factory building the decoders
+        factory_type &m_factory;
+
+        /// The partitioning of the object into stripes
+        stripe_partitioning_scheme m_partitioning;
+
+        /// The number of data shards
+        uint32_t m_data_shards;
+
+        /// The number of parity shards
+        uint32_t m_parity_shards;
+
+        /// The size of a record in bytes
+        uint32_t m_record_size;
+
+        /// The executor running the decoding
+        block_executor &m_executor;
+
+        /// The number of stripes decoded at a time
+        uint32_t m_batch;
+
+    };
+
+}
@@ -0,0 +1,219 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "block_executor.hpp"
+#include "file_writer.hpp"
+#include "object_encoder.hpp"
+#include "stripe_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief Stores an object as k data shards and m parity shards,
+    ///        e.g. on separate files or devices.
+    ///
+    /// The object is cut into stripes of k = max_symbols symbols with
+    /// the stripe_partitioning_scheme, and one encoder is built per
+    /// stripe through an object_encoder. Payload i of the encoder of a
+    /// stripe is stored in shard i, at the offset of the stripe in the
+    /// shard. Every shard therefore holds one record of
+    /// max_payload_size() bytes per stripe.
+    ///
+    /// With a systematic encoder, e.g. the rs_encoder, the first k
+    /// payloads are the uncoded symbols, so the first k shards hold the
+    /// data of the object, and the payloads of the Reed-Solomon codes
+    /// are ordered by generator matrix row, so any k shards can be used
+    /// to reconstruct the object, see the shard_decoder. With RLNC
+    /// encoders the parity shards are random combinations and any k
+    /// shards only decode with high probability.
+    ///
+    /// The stripes are encoded in batches, the encoders of a batch are
+    /// built in sequence, after which the encoding and the writes to the
+    /// shards are spread over the threads of a block_executor.
+    template<class ObjectData, class EncoderType>
+    class shard_encoder : boost::noncopyable
+    {
+    public:
+
+        /// The factory used to build the encoders
+        typedef typename EncoderType::factory factory_type;
+
+        /// Pointer to an encoder
+        typedef typename EncoderType::pointer pointer_type;
+
+        /// The object data
+        typedef ObjectData object_data;
+
+        /// The object encoder producing the encoders of the stripes
+        typedef object_encoder<object_data, EncoderType,
+                               stripe_partitioning_scheme>
+            object_encoder_type;
+
+    public:
+
+        /// Constructor
+        /// @param factory The encoder factory, the number of data shards
+        ///        is its maximum number of symbols
+        /// @param data The object data
+        /// @param parity_shards The number of parity shards
+        /// @param executor The executor running the encoding
+        /// @param batch The number of stripes encoded at a time, if zero
+        ///        four stripes per thread of the executor are used
+        shard_encoder(factory_type &factory, const object_data &data,
+                      uint32_t parity_shards, block_executor &executor,
+                      uint32_t batch = 0)
+            : m_encoder(factory, data),
+              m_data_shards(factory.max_symbols()),
+              m_parity_shards(parity_shards),
+              m_record_size(factory.max_payload_size()),
+              m_executor(executor),
+              m_batch(batch ? batch : 4 * executor.threads())
+        {
+            assert(m_data_shards > 0);
+            assert(m_parity_shards > 0);
+            assert(m_record_size > 0);
+            assert(m_batch > 0);
+        }
+
+        /// @return The number of data shards
+        uint32_t data_shards() const
+        {
+            return m_data_shards;
+        }
+
+        /// @return The number of parity shards
+        uint32_t parity_shards() const
+        {
+            return m_parity_shards;
+        }
+
+        /// @return The total number of shards
+        uint32_t shards() const
+        {
+            return m_data_shards + m_parity_shards;
+        }
+
+        /// @return The number of stripes
+        uint32_t stripes() const
+        {
+            return m_encoder.encoders();
+        }
+
+        /// @return The size in bytes of the record of a stripe in a shard
+        uint32_t record_size() const
+        {
+            return m_record_size;
+        }
+
+        /// @return The size in bytes of a shard
+        uint64_t shard_size() const
+        {
+            return uint64_t(stripes()) * m_record_size;
+        }
+
+        /// @return The size in bytes of the object
+        uint64_t object_size() const
+        {
+            return m_encoder.object_size();
+        }
+
+        /// Encodes the object and writes the shards, existing files are
+        /// truncated
+        /// @param filenames The files of the shards, the data shards
+        ///        first
+        void write(const std::vector<std::string> &filenames)
+        {
+            assert(filenames.size() == shards());
+
+            std::vector<boost::shared_ptr<writable_file> > files;
+
+            for(const auto &filename : filenames)
+            {
+                files.push_back(boost::make_shared<writable_file>(
+                    filename, shard_size()));
+            }
+
+            std::vector<pointer_type> encoders(m_batch);
+
+            std::vector<std::vector<uint8_t> > payloads(
+                m_batch, std::vector<uint8_t>(m_record_size));
+
+            for(uint32_t first = 0; first < stripes(); first += m_batch)
+            {
+                uint32_t count = std::min(m_batch, stripes() - first);
+
+                // The factory is not thread-safe, so the encoders are
+                // built on this thread
+                for(uint32_t i = 0; i < count; ++i)
+                {
+                    encoders[i] = m_encoder.build(first + i);
+                }
+
+                m_executor.run(count, [&](uint32_t i)
+                    {
+                        write_stripe(first + i, encoders[i],
+                                     &payloads[i][0], files);
+                    });
+            }
+        }
+
+    private:
+
+        /// Writes the payloads of a stripe to the shards
+        /// @param stripe The stripe
+        /// @param encoder The encoder of the stripe
+        /// @param payload Buffer for a payload
+        /// @param files The shard files
+        void write_stripe(
+            uint32_t stripe, pointer_type &encoder, uint8_t *payload,
+            const std::vector<boost::shared_ptr<writable_file> > &files)
+        {
+            assert(encoder);
+            assert(payload != 0);
+
+            uint64_t offset = uint64_t(stripe) * m_record_size;
+
+            for(uint32_t i = 0; i < files.size(); ++i)
+            {
+                encoder->encode(payload);
+                files[i]->write(payload, m_record_size, offset);
+            }
+        }
+
+    private:
+
+        /// Builds the encoders of the stripes
+        object_encoder_type m_encoder;
+
+        /// The number of data shards
+        uint32_t m_data_shards;
+
+        /// The number of parity shards
+        uint32_t m_parity_shards;
+
+        /// The size of a record in bytes
+        uint32_t m_record_size;
+
+        /// The executor running the encoding
+        block_executor &m_executor;
+
+        /// The number of stripes encoded at a time
+        uint32_t m_batch;
+
+    };
+
+}
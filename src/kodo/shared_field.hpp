@@ -0,0 +1,33 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+namespace kodo
+{
+
+    /// Returns the finite field implementation shared by all factories
+    /// of the process.
+    ///
+    /// The implementations hold the log, exp and multiplication tables
+    /// of the field, which are immutable once constructed. Building them
+    /// per factory, e.g. per thread, costs start-up time and memory, and
+    /// every copy competes for the shared cache. The instance is
+    /// constructed on first use, which is thread safe, and kept alive
+    /// by the factories and coders holding it.
+    /// @return The finite field implementation
+    template<class FieldImpl>
+    inline const boost::shared_ptr<FieldImpl>& shared_field()
+    {
+        static const boost::shared_ptr<FieldImpl> field =
+            boost::make_shared<FieldImpl>();
+
+        return field;
+    }
+
+}
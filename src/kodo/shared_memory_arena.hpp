@@ -0,0 +1,469 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cerrno>
+#include <atomic>
+#include <limits>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @brief Block slots in shared memory (Linux), so a decoding
+    ///        process can hand decoded blocks to a consumer process
+    ///        without copying them.
+    ///
+    /// The arena is an anonymous memory file (memfd), optionally backed
+    /// by huge pages (hugetlbfs), divided into slots of equal size. The
+    /// producer creates the arena and passes fd() to the consumer, e.g.
+    /// over a Unix socket or by fork(), which maps the same memory by
+    /// attaching to the descriptor.
+    ///
+    /// A slot is free, acquired by the producer while a block is
+    /// decoded into it, or published once the block is decoded. The
+    /// state of the slots lives in the shared memory and is changed
+    /// atomically, so both processes see the same state. The producer
+    /// publishes a slot with publish(), which writes the slot index to
+    /// the notification descriptor, e.g. the pipe which used to carry
+    /// the blocks. The consumer reads the slots with wait_published()
+    /// and hands them back with release() when it is done with them.
+    class shared_memory_arena : boost::noncopyable
+    {
+    public:
+
+        /// The constants of the arena, unlike a static member an
+        /// enumerator needs no definition when bound to a reference
+        enum
+        {
+            /// Returned by acquire() if no slot is free
+            no_slot = std::numeric_limits<uint32_t>::max()
+        };
+
+        /// The states of a slot
+        enum slot_state
+        {
+            /// The slot may be acquired by the producer
+            free_slot = 0,
+
+            /// The producer is decoding a block into the slot
+            acquired_slot = 1,
+
+            /// The slot holds a decoded block for the consumer
+            published_slot = 2
+        };
+
+    public:
+
+        /// Creates a new arena
+        /// @param name The name of the memory file, only used for
+        ///        debugging, e.g. in /proc/<pid>/fd
+        /// @param slots The number of slots
+        /// @param slot_size The size of a slot in bytes, rounded up to
+        ///        whole pages
+        /// @param huge_pages If true the arena is backed by huge pages
+        ///        when the system has some reserved, otherwise by
+        ///        normal pages
+        shared_memory_arena(const std::string &name, uint32_t slots,
+                            uint32_t slot_size, bool huge_pages = false)
+            : m_fd(-1),
+              m_notification(-1),
+              m_data(0),
+              m_size(0),
+              m_header(0)
+        {
+            assert(slots > 0);
+            assert(slot_size > 0);
+
+            uint32_t page_size = normal_page_size;
+
+            if(huge_pages)
+            {
+                m_fd = create_file(name, hugetlb_flag);
+                page_size = huge_page_size;
+            }
+
+            if(m_fd < 0)
+            {
+                m_fd = create_file(name, 0);
+                page_size = normal_page_size;
+            }
+
+            assert(m_fd >= 0);
+
+            uint32_t data_offset = round_up(
+                sizeof(arena_header) + slots * sizeof(slot_header),
+                page_size);
+
+            uint64_t size = data_offset +
+                uint64_t(slots) * round_up(slot_size, page_size);
+
+            int result = ::ftruncate(m_fd, static_cast<off_t>(size));
+            assert(result == 0);
+            (void) result;
+
+            map(size);
+
+            m_header->m_magic = arena_magic;
+            m_header->m_slots = slots;
+            m_header->m_slot_size = round_up(slot_size, page_size);
+            m_header->m_data_offset = data_offset;
+
+            for(uint32_t i = 0; i < slots; ++i)
+            {
+                slot_header &s = m_header->slot(i);
+                s.m_state.store(free_slot, std::memory_order_relaxed);
+                s.m_block_id = 0;
+                s.m_bytes = 0;
+            }
+        }
+
+        /// Attaches to an arena created by another process
+        /// @param fd The descriptor of the arena, see fd(). The arena
+        ///        uses its own duplicate, so the caller may close it.
+        explicit shared_memory_arena(int fd)
+            : m_fd(::dup(fd)),
+              m_notification(-1),
+              m_data(0),
+              m_size(0),
+              m_header(0)
+        {
+            assert(m_fd >= 0);
+
+            struct stat info;
+            int result = ::fstat(m_fd, &info);
+            assert(result == 0);
+            (void) result;
+
+            map(info.st_size);
+
+            assert(m_header->m_magic == arena_magic);
+        }
+
+        /// Unmaps the arena, the memory is freed when the last process
+        /// has unmapped it
+        ~shared_memory_arena()
+        {
+            if(m_data != 0)
+            {
+                ::munmap(m_data, m_size);
+            }
+
+            if(m_fd >= 0)
+            {
+                ::close(m_fd);
+            }
+        }
+
+        /// @return The descriptor of the arena, passed to the consumer
+        int fd() const
+        {
+            return m_fd;
+        }
+
+        /// @return The number of slots
+        uint32_t slots() const
+        {
+            return m_header->m_slots;
+        }
+
+        /// @return The size of a slot in bytes
+        uint32_t slot_size() const
+        {
+            return m_header->m_slot_size;
+        }
+
+        /// Sets the descriptor carrying the published slot indices, the
+        /// write end of a pipe or socket for the producer and the read
+        /// end for the consumer. It is owned by the caller.
+        /// @param fd The descriptor
+        void set_notification(int fd)
+        {
+            m_notification = fd;
+        }
+
+        /// @param slot The slot
+        /// @return The data of the slot
+        uint8_t* slot_data(uint32_t slot) const
+        {
+            assert(slot < slots());
+            return m_data + m_header->m_data_offset +
+                uint64_t(slot) * m_header->m_slot_size;
+        }
+
+        /// @param slot The slot
+        /// @return The storage of the slot
+        sak::mutable_storage slot_storage(uint32_t slot) const
+        {
+            return sak::storage(slot_data(slot), slot_size());
+        }
+
+        /// @param slot The slot
+        /// @return The state of the slot
+        slot_state state(uint32_t slot) const
+        {
+            assert(slot < slots());
+            return static_cast<slot_state>(
+                m_header->slot(slot).m_state.load(std::memory_order_acquire));
+        }
+
+        /// @param slot A published slot
+        /// @return The block id given to publish()
+        uint32_t block_id(uint32_t slot) const
+        {
+            assert(state(slot) == published_slot);
+            return m_header->slot(slot).m_block_id;
+        }
+
+        /// @param slot A published slot
+        /// @return The number of bytes given to publish()
+        uint32_t bytes(uint32_t slot) const
+        {
+            assert(state(slot) == published_slot);
+            return m_header->slot(slot).m_bytes;
+        }
+
+        /// Acquires a free slot for the producer
+        /// @return The slot, or no_slot if all slots are in use
+        uint32_t acquire()
+        {
+            for(uint32_t i = 0; i < slots(); ++i)
+            {
+                uint32_t expected = free_slot;
+
+                if(m_header->slot(i).m_state.compare_exchange_strong(
+                       expected, acquired_slot, std::memory_order_acquire))
+                {
+                    return i;
+                }
+            }
+
+            return no_slot;
+        }
+
+        /// Publishes a decoded block to the consumer, and writes the
+        /// slot index to the notification descriptor if one is set
+        /// @param slot An acquired slot
+        /// @param block_id The id of the block, e.g. the decoder id in
+        ///        the object decoder
+        /// @param bytes The number of bytes of the block used
+        /// @return False if the notification could not be written
+        bool publish(uint32_t slot, uint32_t block_id, uint32_t bytes)
+        {
+            assert(state(slot) == acquired_slot);
+            assert(bytes <= slot_size());
+
+            slot_header &s = m_header->slot(slot);
+            s.m_block_id = block_id;
+            s.m_bytes = bytes;
+            s.m_state.store(published_slot, std::memory_order_release);
+
+            if(m_notification < 0)
+                return true;
+
+            // Writes of up to PIPE_BUF bytes to a pipe are atomic, so
+            // several producers may share one
+            ssize_t result;
+            do
+            {
+                result = ::write(m_notification, &slot, sizeof(slot));
+            }
+            while(result < 0 && errno == EINTR);
+
+            return result == static_cast<ssize_t>(sizeof(slot));
+        }
+
+        /// Waits for the next published slot on the notification
+        /// descriptor. Notifications of slots which are not in the
+        /// arena or not published are dropped.
+        /// @param slot Set to the published slot
+        /// @return False if the descriptor was closed or failed
+        bool wait_published(uint32_t &slot)
+        {
+            assert(m_notification >= 0);
+
+            while(true)
+            {
+                if(!read_notification(slot))
+                    return false;
+
+                // The index comes from another process and addresses
+                // the shared memory, so it is checked in release
+                // builds too
+                if(slot < slots() && state(slot) == published_slot)
+                    return true;
+            }
+        }
+
+        /// Hands a slot back for reuse, by the consumer once it is done
+        /// with a published block or by the producer to give up an
+        /// acquired slot
+        /// @param slot The slot
+        void release(uint32_t slot)
+        {
+            assert(state(slot) != free_slot);
+
+            m_header->slot(slot).m_state.store(
+                free_slot, std::memory_order_release);
+        }
+
+    private:
+
+        /// Reads a slot index from the notification descriptor
+        /// @param slot Set to the slot index read
+        /// @return False if the descriptor was closed or failed
+        bool read_notification(uint32_t &slot)
+        {
+            uint8_t *data = reinterpret_cast<uint8_t*>(&slot);
+            uint32_t read = 0;
+
+            while(read < sizeof(slot))
+            {
+                ssize_t result = ::read(m_notification, data + read,
+                                        sizeof(slot) - read);
+
+                if(result < 0 && errno == EINTR)
+                    continue;
+
+                if(result <= 0)
+                    return false;
+
+                read += static_cast<uint32_t>(result);
+            }
+
+            return true;
+        }
+
+    private:
+
+        /// The state of a slot in the shared memory
+        struct slot_header
+        {
+            /// The slot_state
+            std::atomic<uint32_t> m_state;
+
+            /// The block id of a published slot
+            uint32_t m_block_id;
+
+            /// The bytes used of a published slot
+            uint32_t m_bytes;
+        };
+
+        /// The start of the shared memory, followed by the slot headers
+        struct arena_header
+        {
+            /// Identifies an arena
+            uint32_t m_magic;
+
+            /// The number of slots
+            uint32_t m_slots;
+
+            /// The size of a slot in bytes
+            uint32_t m_slot_size;
+
+            /// The offset in bytes of the first slot
+            uint32_t m_data_offset;
+
+            /// @return The header of a slot
+            slot_header& slot(uint32_t index)
+            {
+                return reinterpret_cast<slot_header*>(this + 1)[index];
+            }
+        };
+
+        // The processes only share the memory, so the state must not
+        // depend on a lock in either of them
+        static_assert(ATOMIC_INT_LOCK_FREE == 2,
+                      "The slot state must be lock free");
+
+        /// Identifies an arena, "kodo" in ASCII
+        static const uint32_t arena_magic = 0x6b6f646f;
+
+        /// The size of a normal page
+        static const uint32_t normal_page_size = 4096;
+
+        /// The size of a huge page
+        static const uint32_t huge_page_size = 2 * 1024 * 1024;
+
+        /// MFD_HUGETLB from linux/memfd.h
+        static const uint32_t hugetlb_flag = 0x0004;
+
+        /// @return The size rounded up to whole pages
+        static uint32_t round_up(uint64_t size, uint32_t page_size)
+        {
+            uint64_t rounded = ((size + page_size - 1) / page_size) *
+                page_size;
+
+            assert(rounded <= std::numeric_limits<uint32_t>::max());
+            return static_cast<uint32_t>(rounded);
+        }
+
+        /// Creates an anonymous memory file
+        /// @param name The name of the file
+        /// @param flags The memfd flags besides MFD_CLOEXEC
+        /// @return The descriptor, negative on errors
+        static int create_file(const std::string &name, uint32_t flags)
+        {
+#if defined(SYS_memfd_create)
+            // MFD_CLOEXEC from linux/memfd.h, the descriptor is passed
+            // explicitly to the consumer
+            const uint32_t cloexec_flag = 0x0001;
+
+            return static_cast<int>(::syscall(
+                SYS_memfd_create, name.c_str(), cloexec_flag | flags));
+#else
+            (void) name;
+            (void) flags;
+            return -1;
+#endif
+        }
+
+        /// Maps the memory file
+        /// @param size The size of the file
+        void map(uint64_t size)
+        {
+            m_size = static_cast<size_t>(size);
+
+            void *data = ::mmap(0, m_size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, m_fd, 0);
+            assert(data != MAP_FAILED);
+
+            m_data = static_cast<uint8_t*>(data);
+            m_header = reinterpret_cast<arena_header*>(m_data);
+        }
+
+    private:
+
+        /// The descriptor of the memory file
+        int m_fd;
+
+        /// The descriptor carrying the published slots
+        int m_notification;
+
+        /// The mapping
+        uint8_t *m_data;
+
+        /// The size of the mapping in bytes
+        size_t m_size;
+
+        /// The header at the start of the mapping
+        arena_header *m_header;
+
+    };
+
+}
@@ -0,0 +1,187 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <sak/storage.hpp>
+
+#include "object_decoder.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+#include "has_deep_symbol_storage.hpp"
+#include "has_shallow_symbol_storage.hpp"
+#include "shared_memory_arena.hpp"
+
+namespace kodo
+{
+
+    /// @brief Object decoder placing the decoded blocks in the slots of
+    ///        a shared_memory_arena, where a consumer process maps them.
+    ///
+    /// Every decoder built gets a slot of the arena. A decoder using
+    /// the shallow_symbol_storage decodes directly in the slot, so the
+    /// block is never copied. A decoder using the deep_symbol_storage
+    /// decodes in its own buffer, which is copied once to the slot when
+    /// the block is published. Either way the block is no longer copied
+    /// through a pipe to the consumer, only the slot index is.
+    ///
+    /// When a decoder is complete the block is handed over with
+    /// publish(), and the consumer finds it with
+    /// shared_memory_arena::wait_published(). The slots of the blocks
+    /// not published are released when the object decoder is
+    /// destroyed.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class shared_memory_decoder :
+        public object_decoder<DecoderType, BlockPartitioning>
+    {
+    public:
+
+        /// The base class
+        typedef object_decoder<DecoderType, BlockPartitioning> base_decoder;
+
+        /// The pointer to the decoder
+        typedef typename base_decoder::pointer pointer;
+
+        /// The factory of the decoders
+        typedef typename base_decoder::factory factory;
+
+        /// True if the decoders decode directly in the slots
+        static const bool in_place =
+            has_mutable_shallow_symbol_storage<DecoderType>::value;
+
+        static_assert(in_place || has_deep_symbol_storage<DecoderType>::value,
+                      "The decoders must use the shallow or the deep "
+                      "symbol storage");
+
+        /// Access the partitioning scheme
+        using base_decoder::m_partitioning;
+
+    public:
+
+        /// Constructs a new shared memory decoder
+        /// @param decoder_factory The decoder factory to use
+        /// @param object_size The size of the object in bytes
+        /// @param arena The arena of the decoded blocks, its slots must
+        ///        hold the largest block of the decoders. It must
+        ///        outlive the object decoder.
+        shared_memory_decoder(factory &decoder_factory,
+                              uint64_t object_size,
+                              shared_memory_arena &arena)
+            : base_decoder(decoder_factory, object_size),
+              m_arena(arena),
+              m_slots(base_decoder::decoders(), shared_memory_arena::no_slot)
+        {
+            assert(m_arena.slot_size() >= decoder_factory.max_block_size());
+        }
+
+        /// Releases the slots of the blocks not published
+        ~shared_memory_decoder()
+        {
+            for(uint32_t slot : m_slots)
+            {
+                if(slot != shared_memory_arena::no_slot)
+                {
+                    m_arena.release(slot);
+                }
+            }
+        }
+
+        /// Builds a decoder, and acquires a slot of the arena for its
+        /// block
+        /// @param decoder_id Specifies the decoder to build
+        /// @return The decoder, or an empty pointer if no slot is free
+        pointer build(uint32_t decoder_id)
+        {
+            assert(decoder_id < base_decoder::decoders());
+            assert(m_slots[decoder_id] == shared_memory_arena::no_slot);
+
+            uint32_t slot = m_arena.acquire();
+
+            if(slot == shared_memory_arena::no_slot)
+                return pointer();
+
+            m_slots[decoder_id] = slot;
+
+            auto decoder = base_decoder::build(decoder_id);
+
+            attach(decoder, decoder_id, slot,
+                   std::integral_constant<bool, in_place>());
+
+            return decoder;
+        }
+
+        /// Publishes the block of a complete decoder to the consumer
+        /// @param decoder_id The id of the decoder
+        /// @param decoder The decoder
+        /// @return False if the notification could not be written
+        bool publish(uint32_t decoder_id, const pointer &decoder)
+        {
+            assert(decoder_id < base_decoder::decoders());
+            assert(m_slots[decoder_id] != shared_memory_arena::no_slot);
+            assert(decoder->is_complete());
+
+            uint32_t slot = m_slots[decoder_id];
+            m_slots[decoder_id] = shared_memory_arena::no_slot;
+
+            uint32_t bytes_used = m_partitioning.bytes_used(decoder_id);
+
+            if(!in_place)
+            {
+                decoder->copy_symbols(
+                    sak::storage(m_arena.slot_data(slot), bytes_used));
+            }
+
+            return m_arena.publish(slot, decoder_id, bytes_used);
+        }
+
+        /// @param decoder_id The id of the decoder
+        /// @return The slot of the block, no_slot if the decoder is not
+        ///         built or its block is published
+        uint32_t slot(uint32_t decoder_id) const
+        {
+            assert(decoder_id < base_decoder::decoders());
+            return m_slots[decoder_id];
+        }
+
+    private:
+
+        /// Points a shallow storage decoder to its slot
+        void attach(pointer &decoder, uint32_t decoder_id, uint32_t slot,
+                    std::true_type)
+        {
+            uint32_t block_size = m_partitioning.block_size(decoder_id);
+
+            // A slot may hold an earlier block, and the decoders need
+            // zero initialized memory
+            std::memset(m_arena.slot_data(slot), 0, block_size);
+
+            decoder->set_symbols(
+                sak::storage(m_arena.slot_data(slot), block_size));
+        }
+
+        /// A deep storage decoder is copied to its slot when published
+        void attach(pointer&, uint32_t, uint32_t, std::false_type)
+        { }
+
+    private:
+
+        /// The arena of the decoded blocks
+        shared_memory_arena &m_arena;
+
+        /// The slot of every decoder
+        std::vector<uint32_t> m_slots;
+
+    };
+
+}
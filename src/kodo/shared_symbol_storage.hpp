@@ -0,0 +1,83 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <sak/storage.hpp>
+
+#include "shallow_symbol_storage.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_storage_layers
+    /// @brief Const shallow storage referring to a reference counted
+    ///        block shared by several encoders.
+    ///
+    /// Serving several receivers with independent coded streams of the
+    /// same block does not require a copy of the block per encoder: the
+    /// block is kept once in a shared buffer and every encoder only
+    /// holds the symbol pointers and its own generator and systematic
+    /// state. The shared block stays alive as long as one of the
+    /// encoders refers to it, an encoder recycled by the factory pool
+    /// releases it when built again. The block must not be modified
+    /// while it is shared.
+    template<class SuperCoder>
+    class shared_symbol_storage
+        : public const_shallow_symbol_storage<SuperCoder>
+    {
+    public:
+
+        /// The actual SuperCoder type
+        typedef const_shallow_symbol_storage<SuperCoder> Super;
+
+        /// The block shared between the encoders
+        typedef std::vector<uint8_t> block_type;
+
+        /// Pointer to a shared block
+        typedef boost::shared_ptr<const block_type> block_pointer;
+
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            Super::initialize(the_factory);
+            m_shared_block.reset();
+        }
+
+        /// Sets the symbols of the encoder to a shared block
+        /// @param block The block, which must be block_size() bytes
+        void set_shared_symbols(const block_pointer &block)
+        {
+            assert(block);
+            assert(block->size() == Super::block_size());
+
+            m_shared_block = block;
+            Super::set_symbols(sak::storage(*block));
+        }
+
+        /// @return The shared block of the encoder, or an empty pointer
+        ///         if none is set
+        const block_pointer& shared_symbols() const
+        {
+            return m_shared_block;
+        }
+
+    protected:
+
+        /// The shared block referred to by the symbol pointers
+        block_pointer m_shared_block;
+
+    };
+
+}
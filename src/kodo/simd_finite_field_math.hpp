@@ -0,0 +1,622 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <fifi/field_types.hpp>
+
+#include "finite_field_math.hpp"
+#include "region_kernels.hpp"
+
+namespace kodo
+{
+
+    /// Traits class giving the number of bytes per element handled by
+    /// the region kernels for a field, zero means that the field is not
+    /// supported by the kernels.
+    template<class Field>
+    struct region_width
+        : std::integral_constant<uint32_t, 0>
+    { };
+
+    /// binary4 stores two elements per byte, each nibble is looked up
+    /// in its own table
+    template<>
+    struct region_width<fifi::binary4>
+        : std::integral_constant<uint32_t, 1>
+    { };
+
+    template<>
+    struct region_width<fifi::binary8>
+        : std::integral_constant<uint32_t, 1>
+    { };
+
+    template<>
+    struct region_width<fifi::binary16>
+        : std::integral_constant<uint32_t, 2>
+    { };
+
+    /// @ingroup finite_field_layers
+    /// @brief Finite field layer using vectorized split table kernels
+    ///        for the multiplication of buffers with a constant.
+    ///
+    /// The instruction set is selected once when the factory is
+    /// constructed, based on the CPU the code runs on. This means that
+    /// the same binary uses the fastest kernels available on e.g. both
+    /// older and newer x86 CPUs. The kernels are available for the
+    /// binary4, binary8 and binary16 fields, and with AVX2 for the
+    /// prime2325 field where the elements are multiplied directly and
+    /// reduced without lookup tables. For other fields or if no
+    /// supported instruction set is found, the layer falls back to the
+    /// finite_field_math implementation.
+    ///
+    /// The layer is a drop-in replacement for the finite_field_math
+    /// layer i.e. any stack can use it by changing finite_field_math to
+    /// simd_finite_field_math.
+    template<class FieldImpl, class SuperCoder>
+    class simd_finite_field_math
+        : public finite_field_math<FieldImpl, SuperCoder>
+    {
+    public:
+
+        /// The layer we extend
+        typedef finite_field_math<FieldImpl, SuperCoder> Super;
+
+        /// @copydoc layer::field_type
+        typedef typename Super::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename Super::value_type value_type;
+
+        /// The number of bytes per element used by the kernels
+        static const uint32_t width = region_width<field_type>::value;
+
+        /// The size of the lookup tables for one coefficient
+        static const uint32_t tables_size =
+            width == 2 ? region_w2_tables_size : region_w1_tables_size;
+
+        /// True if the prime2325 kernels may be used
+        static const bool prime =
+            std::is_same<field_type, fifi::prime2325>::value;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer selects the instruction set used by the
+        /// coders it builds
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size),
+                  m_simd_level(detect_simd_level())
+            { }
+
+            /// @return The instruction set used by coders built by
+            ///         this factory
+            simd_level get_simd_level() const
+            {
+                return m_simd_level;
+            }
+
+            /// Selects the instruction set used by coders built after
+            /// this call, e.g. to compare the different kernels.
+            /// @param level The instruction set, must be supported by
+            ///        the running CPU
+            void set_simd_level(simd_level level)
+            {
+                assert(is_simd_level_supported(level));
+                m_simd_level = level;
+            }
+
+        protected:
+
+            /// The instruction set used
+            simd_level m_simd_level;
+        };
+
+    public:
+
+        /// Constructor
+        simd_finite_field_math()
+            : m_multiply_kernel(0),
+              m_multiply_add_kernel(0),
+              m_prime_multiply(0),
+              m_prime_multiply_add(0),
+              m_prime_add(0),
+              m_prime_subtract(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            Super::construct(the_factory);
+
+            region_kernels kernels(the_factory.get_simd_level());
+
+            if(width == 1)
+            {
+                m_multiply_kernel = kernels.m_w1_multiply;
+                m_multiply_add_kernel = kernels.m_w1_multiply_add;
+            }
+            else if(width == 2)
+            {
+                m_multiply_kernel = kernels.m_w2_multiply;
+                m_multiply_add_kernel = kernels.m_w2_multiply_add;
+            }
+            else if(prime)
+            {
+                m_prime_multiply = kernels.m_prime_multiply;
+                m_prime_multiply_add = kernels.m_prime_multiply_add;
+                m_prime_add = kernels.m_prime_add;
+                m_prime_subtract = kernels.m_prime_subtract;
+            }
+
+            m_tables.resize(tables_size);
+        }
+
+        /// @copydoc layer::multiply(value_type*,value_type,uint32_t)
+        void multiply(value_type *symbol_dest, value_type coefficient,
+                      uint32_t symbol_length)
+        {
+            if(m_prime_multiply)
+            {
+                assert(symbol_dest != 0);
+                assert(symbol_length > 0);
+
+                uint32_t *dest = prime_elements(symbol_dest);
+                m_prime_multiply(coefficient, dest, dest, symbol_length);
+                return;
+            }
+
+            if(!m_multiply_kernel)
+            {
+                Super::multiply(symbol_dest, coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_length > 0);
+
+            build_tables(coefficient, &m_tables[0]);
+
+            uint8_t *dest = reinterpret_cast<uint8_t*>(symbol_dest);
+            m_multiply_kernel(&m_tables[0], dest, dest,
+                              symbol_length * sizeof(value_type));
+        }
+
+        /// @copydoc layer::multipy_add(value_type *, const value_type*,
+        ///                             value_type, uint32_t)
+        void multiply_add(value_type *symbol_dest,
+                          const value_type *symbol_src,
+                          value_type coefficient, uint32_t symbol_length)
+        {
+            if(m_prime_multiply_add)
+            {
+                assert(symbol_dest != 0);
+                assert(symbol_src != 0);
+                assert(symbol_length > 0);
+
+                m_prime_multiply_add(coefficient, prime_elements(symbol_dest),
+                                     prime_elements(symbol_src),
+                                     symbol_length);
+                return;
+            }
+
+            if(!m_multiply_add_kernel)
+            {
+                Super::multiply_add(symbol_dest, symbol_src,
+                                    coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+            assert(symbol_length > 0);
+
+            build_tables(coefficient, &m_tables[0]);
+
+            m_multiply_add_kernel(
+                &m_tables[0], reinterpret_cast<uint8_t*>(symbol_dest),
+                reinterpret_cast<const uint8_t*>(symbol_src),
+                symbol_length * sizeof(value_type));
+        }
+
+        /// @copydoc layer::multiply_subtract(value_type*, const value_type*,
+        ///                                   value_type, uint32_t)
+        void multiply_subtract(value_type *symbol_dest,
+                               const value_type *symbol_src,
+                               value_type coefficient,
+                               uint32_t symbol_length)
+        {
+            if(m_prime_multiply_add)
+            {
+                assert(symbol_dest != symbol_src);
+
+                // dest - c * src = dest + (p - c) * src
+                if(coefficient != 0)
+                {
+                    value_type negated = static_cast<value_type>(
+                        region_prime2325 - coefficient);
+
+                    multiply_add(symbol_dest, symbol_src, negated,
+                                 symbol_length);
+                }
+                return;
+            }
+
+            if(!m_multiply_add_kernel)
+            {
+                Super::multiply_subtract(symbol_dest, symbol_src,
+                                         coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != symbol_src);
+
+            // In the binary extension fields subtraction and addition
+            // are the same operation
+            multiply_add(symbol_dest, symbol_src, coefficient,
+                         symbol_length);
+        }
+
+        /// @copydoc layer::multiply_copy(value_type*, const value_type*,
+        ///                              value_type, uint32_t)
+        void multiply_copy(value_type *symbol_dest,
+                           const value_type *symbol_src,
+                           value_type coefficient, uint32_t symbol_length)
+        {
+            if(m_prime_multiply)
+            {
+                assert(symbol_dest != 0);
+                assert(symbol_src != 0);
+                assert(symbol_length > 0);
+
+                // The prime2325 multiply kernel works in place
+                std::copy_n(symbol_src, symbol_length, symbol_dest);
+
+                uint32_t *dest = prime_elements(symbol_dest);
+                m_prime_multiply(coefficient, dest, dest, symbol_length);
+                return;
+            }
+
+            if(!m_multiply_kernel)
+            {
+                Super::multiply_copy(symbol_dest, symbol_src,
+                                     coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+            assert(symbol_length > 0);
+
+            build_tables(coefficient, &m_tables[0]);
+
+            m_multiply_kernel(
+                &m_tables[0], reinterpret_cast<uint8_t*>(symbol_dest),
+                reinterpret_cast<const uint8_t*>(symbol_src),
+                symbol_length * sizeof(value_type));
+        }
+
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(value_type *symbol_dest,
+                                  const value_type **symbols_src,
+                                  const value_type *coefficients,
+                                  uint32_t sources, uint32_t symbol_length)
+        {
+            if(m_prime_multiply_add)
+            {
+                prime_combine_sources(symbol_dest, symbols_src,
+                                      coefficients, sources,
+                                      symbol_length, false);
+                return;
+            }
+
+            if(!m_multiply_add_kernel)
+            {
+                Super::multiply_add_sources(symbol_dest, symbols_src,
+                                            coefficients, sources,
+                                            symbol_length);
+                return;
+            }
+
+            combine_sources(symbol_dest, symbols_src, coefficients,
+                            sources, symbol_length, false);
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(value_type *symbol_dest,
+                              const value_type **symbols_src,
+                              const value_type *coefficients,
+                              uint32_t sources, uint32_t symbol_length)
+        {
+            if(sources == 0 || (!m_prime_multiply && !m_multiply_kernel))
+            {
+                Super::multiply_sources(symbol_dest, symbols_src,
+                                        coefficients, sources,
+                                        symbol_length);
+                return;
+            }
+
+            if(m_prime_multiply)
+            {
+                prime_combine_sources(symbol_dest, symbols_src,
+                                      coefficients, sources,
+                                      symbol_length, true);
+                return;
+            }
+
+            combine_sources(symbol_dest, symbols_src, coefficients,
+                            sources, symbol_length, true);
+        }
+
+        /// @copydoc layer::add(value_type*, const value_type*, uint32_t)
+        void add(value_type *symbol_dest, const value_type *symbol_src,
+                 uint32_t symbol_length)
+        {
+            if(!m_prime_add)
+            {
+                Super::add(symbol_dest, symbol_src, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+            assert(symbol_length > 0);
+
+            m_prime_add(0, prime_elements(symbol_dest),
+                        prime_elements(symbol_src), symbol_length);
+        }
+
+        /// @copydoc layer::subtract(value_type*, const value_type*,
+        ///                          uint32_t)
+        void subtract(value_type *symbol_dest, const value_type *symbol_src,
+                      uint32_t symbol_length)
+        {
+            if(!m_prime_subtract)
+            {
+                Super::subtract(symbol_dest, symbol_src, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+            assert(symbol_length > 0);
+
+            m_prime_subtract(0, prime_elements(symbol_dest),
+                             prime_elements(symbol_src), symbol_length);
+        }
+
+        /// @return true if the vectorized kernels are used by this coder
+        bool has_simd_kernels() const
+        {
+            return m_multiply_kernel != 0 || m_prime_multiply != 0;
+        }
+
+    protected:
+
+        /// The table based implementation of multiply_add_sources() and
+        /// multiply_sources()
+        /// @param symbol_dest The destination symbol
+        /// @param symbols_src The source symbols
+        /// @param coefficients The coefficients of the sources
+        /// @param sources The number of sources
+        /// @param symbol_length The length of the symbols
+        /// @param copy_first If true the first source is written to the
+        ///        destination with the multiply kernel instead of added
+        void combine_sources(value_type *symbol_dest,
+                             const value_type **symbols_src,
+                             const value_type *coefficients,
+                             uint32_t sources, uint32_t symbol_length,
+                             bool copy_first)
+        {
+            assert(m_multiply_kernel);
+            assert(m_multiply_add_kernel);
+            assert(symbol_dest != 0);
+            assert(symbols_src != 0);
+            assert(coefficients != 0);
+            assert(symbol_length > 0);
+
+            // The tables of all sources are built up front so they
+            // can be reused for every tile, the buffer only grows so
+            // the steady state does not allocate
+            if(m_tables.size() < sources * tables_size)
+            {
+                m_tables.resize(sources * tables_size);
+            }
+
+            for(uint32_t i = 0; i < sources; ++i)
+            {
+                build_tables(coefficients[i], &m_tables[i * tables_size]);
+            }
+
+            const uint32_t tile_length =
+                std::max<uint32_t>(1U, Super::tile_size / sizeof(value_type));
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += tile_length)
+            {
+                uint32_t length =
+                    std::min(tile_length, symbol_length - offset);
+
+                uint8_t *dest =
+                    reinterpret_cast<uint8_t*>(symbol_dest + offset);
+
+                for(uint32_t i = 0; i < sources; ++i)
+                {
+                    assert(symbols_src[i] != 0);
+
+                    region_kernel kernel = (copy_first && i == 0) ?
+                        m_multiply_kernel : m_multiply_add_kernel;
+
+                    kernel(&m_tables[i * tables_size], dest,
+                           reinterpret_cast<const uint8_t*>(
+                               symbols_src[i] + offset),
+                           length * sizeof(value_type));
+                }
+            }
+        }
+
+        /// The prime2325 version of multiply_add_sources() and
+        /// multiply_sources(), which adds the sources a tile at a time
+        /// like the table based kernels
+        /// @copydetails combine_sources()
+        void prime_combine_sources(value_type *symbol_dest,
+                                   const value_type **symbols_src,
+                                   const value_type *coefficients,
+                                   uint32_t sources, uint32_t symbol_length,
+                                   bool copy_first)
+        {
+            assert(symbol_dest != 0);
+            assert(symbols_src != 0);
+            assert(coefficients != 0);
+            assert(symbol_length > 0);
+
+            const uint32_t tile_length =
+                std::max<uint32_t>(1U, Super::tile_size / sizeof(value_type));
+
+            for(uint32_t offset = 0; offset < symbol_length;
+                offset += tile_length)
+            {
+                uint32_t length =
+                    std::min(tile_length, symbol_length - offset);
+
+                uint32_t *dest = prime_elements(symbol_dest + offset);
+
+                for(uint32_t i = 0; i < sources; ++i)
+                {
+                    assert(symbols_src[i] != 0);
+
+                    const uint32_t *src =
+                        prime_elements(symbols_src[i] + offset);
+
+                    if(copy_first && i == 0)
+                    {
+                        // The multiply kernel works in place
+                        std::copy_n(src, length, dest);
+                        m_prime_multiply(coefficients[i], dest, dest,
+                                         length);
+                        continue;
+                    }
+
+                    if(coefficients[i] == 0)
+                        continue;
+
+                    m_prime_multiply_add(coefficients[i], dest, src, length);
+                }
+            }
+        }
+
+        /// @return The elements as used by the prime2325 kernels, the
+        ///         kernels are only selected if value_type is uint32_t
+        static uint32_t* prime_elements(value_type *elements)
+        {
+            return reinterpret_cast<uint32_t*>(elements);
+        }
+
+        /// @copydoc prime_elements(value_type*)
+        static const uint32_t* prime_elements(const value_type *elements)
+        {
+            return reinterpret_cast<const uint32_t*>(elements);
+        }
+
+        /// Builds the lookup tables for the split table kernels, see
+        /// region_kernel for the layout.
+        /// @param coefficient The constant to multiply with
+        /// @param tables The buffer for the tables, must be of
+        ///        tables_size bytes
+        void build_tables(value_type coefficient, uint8_t *tables)
+        {
+            assert(Super::m_field);
+            assert(tables != 0);
+
+            if(std::is_same<field_type, fifi::binary4>::value)
+            {
+                // Each nibble is an element of its own
+                for(uint32_t x = 0; x < 16; ++x)
+                {
+                    uint8_t p = static_cast<uint8_t>(
+                        Super::m_field->multiply(
+                            coefficient, static_cast<value_type>(x)));
+
+                    tables[x] = p;
+                    tables[16 + x] = static_cast<uint8_t>(p << 4);
+                }
+            }
+            else if(width == 1)
+            {
+                for(uint32_t x = 0; x < 16; ++x)
+                {
+                    tables[x] = static_cast<uint8_t>(
+                        Super::m_field->multiply(
+                            coefficient, static_cast<value_type>(x)));
+
+                    tables[16 + x] = static_cast<uint8_t>(
+                        Super::m_field->multiply(
+                            coefficient, static_cast<value_type>(x << 4)));
+                }
+            }
+            else
+            {
+                for(uint32_t k = 0; k < 4; ++k)
+                {
+                    for(uint32_t x = 0; x < 16; ++x)
+                    {
+                        uint32_t p = Super::m_field->multiply(
+                            coefficient,
+                            static_cast<value_type>(x << (4 * k)));
+
+                        tables[k * 16 + x] = p & 0xff;
+                        tables[64 + k * 16 + x] = (p >> 8) & 0xff;
+                    }
+                }
+            }
+        }
+
+    protected:
+
+        /// The kernel used for multiply(), multiply_copy() and the first
+        /// source of multiply_sources()
+        region_kernel m_multiply_kernel;
+
+        /// The kernel used for multiply_add() and multiply_subtract()
+        region_kernel m_multiply_add_kernel;
+
+        /// The prime2325 kernel used for multiply(), multiply_copy() and
+        /// the first source of multiply_sources()
+        prime_region_kernel m_prime_multiply;
+
+        /// The prime2325 kernel used for multiply_add(),
+        /// multiply_subtract() and multiply_add_sources()
+        prime_region_kernel m_prime_multiply_add;
+
+        /// The prime2325 kernel used for add()
+        prime_region_kernel m_prime_add;
+
+        /// The prime2325 kernel used for subtract()
+        prime_region_kernel m_prime_subtract;
+
+        /// The lookup tables
+        std::vector<uint8_t> m_tables;
+
+    };
+
+}
@@ -0,0 +1,256 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+namespace kodo
+{
+
+    /// @brief Factory front-end keeping a factory, and thereby a pool
+    ///        of coders, per size class of the blocks.
+    ///
+    /// A coder allocates its storage for the maximum number of symbols
+    /// and the maximum symbol size of its factory when it is
+    /// constructed, so a small block, e.g. the last block of an object
+    /// or a small object, holds a coder sized for the largest block.
+    /// This factory divides the maximum number of symbols and the
+    /// maximum symbol size into size classes, each a half of the
+    /// previous one, and keeps a factory of the Coder for every
+    /// combination. After set_symbols() and set_symbol_size(), build()
+    /// takes the coder from the smallest class the block fits, so the
+    /// memory of a coder is at most twice that of its block in each
+    /// dimension.
+    ///
+    /// The symbol sizes of the classes are rounded up to a multiple of
+    /// symbol_size_granularity, so they suit every field.
+    ///
+    /// The object coders take the factory type from the coder stack,
+    /// use size_class_coder to give a stack this factory.
+    template<class Coder>
+    class size_class_factory : boost::noncopyable
+    {
+    public:
+
+        /// The factory of a size class
+        typedef typename Coder::factory class_factory;
+
+        /// Pointer to a coder
+        typedef typename Coder::pointer pointer;
+
+        /// The symbol sizes of the classes are a multiple of this
+        static const uint32_t symbol_size_granularity = 16;
+
+    public:
+
+        /// Constructs the factories of all size classes
+        /// @param max_symbols The maximum number of symbols
+        /// @param max_symbol_size The maximum symbol size in bytes
+        /// @param classes The largest number of size classes of the
+        ///        symbols and of the symbol size
+        size_class_factory(uint32_t max_symbols, uint32_t max_symbol_size,
+                           uint32_t classes = 4)
+            : m_max_symbols(max_symbols),
+              m_max_symbol_size(max_symbol_size),
+              m_symbols(max_symbols),
+              m_symbol_size(max_symbol_size)
+        {
+            assert(max_symbols > 0);
+            assert(max_symbol_size > 0);
+            assert(classes > 0);
+
+            // The classes in increasing order, the last one is the
+            // maximum
+            for(uint32_t i = classes; i-- > 0;)
+            {
+                uint32_t symbols = ((max_symbols - 1) >> i) + 1;
+
+                if(m_class_symbols.empty() ||
+                   symbols > m_class_symbols.back())
+                {
+                    m_class_symbols.push_back(symbols);
+                }
+
+                uint32_t symbol_size = ((max_symbol_size - 1) >> i) + 1;
+
+                symbol_size = std::min(max_symbol_size,
+                    ((symbol_size - 1) / symbol_size_granularity + 1) *
+                    symbol_size_granularity);
+
+                if(m_class_symbol_sizes.empty() ||
+                   symbol_size > m_class_symbol_sizes.back())
+                {
+                    m_class_symbol_sizes.push_back(symbol_size);
+                }
+            }
+
+            for(uint32_t symbols : m_class_symbols)
+            {
+                for(uint32_t symbol_size : m_class_symbol_sizes)
+                {
+                    m_factories.push_back(
+                        boost::make_shared<class_factory>(
+                            symbols, symbol_size));
+                }
+            }
+        }
+
+        /// @return The maximum number of symbols
+        uint32_t max_symbols() const
+        {
+            return m_max_symbols;
+        }
+
+        /// @return The maximum symbol size in bytes
+        uint32_t max_symbol_size() const
+        {
+            return m_max_symbol_size;
+        }
+
+        /// @return The maximum payload size of the coders, that of the
+        ///         largest class
+        uint32_t max_payload_size() const
+        {
+            return m_factories.back()->max_payload_size();
+        }
+
+        /// Sets the number of symbols of the coders built next
+        /// @param symbols The number of symbols
+        void set_symbols(uint32_t symbols)
+        {
+            assert(symbols > 0);
+            assert(symbols <= m_max_symbols);
+            m_symbols = symbols;
+        }
+
+        /// Sets the symbol size of the coders built next
+        /// @param symbol_size The symbol size in bytes
+        void set_symbol_size(uint32_t symbol_size)
+        {
+            assert(symbol_size > 0);
+            assert(symbol_size <= m_max_symbol_size);
+            m_symbol_size = symbol_size;
+        }
+
+        /// @return The number of symbols of the coders built next
+        uint32_t symbols() const
+        {
+            return m_symbols;
+        }
+
+        /// @return The symbol size of the coders built next
+        uint32_t symbol_size() const
+        {
+            return m_symbol_size;
+        }
+
+        /// Builds a coder from the smallest size class fitting the
+        /// number of symbols and the symbol size
+        /// @return The coder
+        pointer build()
+        {
+            class_factory &factory = size_class(m_symbols, m_symbol_size);
+
+            factory.set_symbols(m_symbols);
+            factory.set_symbol_size(m_symbol_size);
+
+            return factory.build();
+        }
+
+        /// @return The number of size classes
+        uint32_t size_classes() const
+        {
+            return static_cast<uint32_t>(m_factories.size());
+        }
+
+        /// @param index The index of a size class
+        /// @return The factory of the size class, e.g. to configure it
+        class_factory& size_class(uint32_t index)
+        {
+            assert(index < size_classes());
+            return *m_factories[index];
+        }
+
+        /// @param symbols A number of symbols
+        /// @param symbol_size A symbol size in bytes
+        /// @return The factory of the smallest size class fitting a
+        ///         block
+        class_factory& size_class(uint32_t symbols, uint32_t symbol_size)
+        {
+            assert(symbols <= m_max_symbols);
+            assert(symbol_size <= m_max_symbol_size);
+
+            uint32_t symbols_class = static_cast<uint32_t>(
+                std::lower_bound(m_class_symbols.begin(),
+                                 m_class_symbols.end(), symbols) -
+                m_class_symbols.begin());
+
+            uint32_t symbol_size_class = static_cast<uint32_t>(
+                std::lower_bound(m_class_symbol_sizes.begin(),
+                                 m_class_symbol_sizes.end(), symbol_size) -
+                m_class_symbol_sizes.begin());
+
+            assert(symbols_class < m_class_symbols.size());
+            assert(symbol_size_class < m_class_symbol_sizes.size());
+
+            uint32_t index = symbols_class *
+                static_cast<uint32_t>(m_class_symbol_sizes.size()) +
+                symbol_size_class;
+
+            return *m_factories[index];
+        }
+
+    private:
+
+        /// The maximum number of symbols
+        uint32_t m_max_symbols;
+
+        /// The maximum symbol size in bytes
+        uint32_t m_max_symbol_size;
+
+        /// The number of symbols of the coders built next
+        uint32_t m_symbols;
+
+        /// The symbol size of the coders built next
+        uint32_t m_symbol_size;
+
+        /// The maximum number of symbols of the classes, increasing
+        std::vector<uint32_t> m_class_symbols;
+
+        /// The maximum symbol size of the classes, increasing
+        std::vector<uint32_t> m_class_symbol_sizes;
+
+        /// The factories of the classes, by symbols and then by symbol
+        /// size
+        std::vector<boost::shared_ptr<class_factory> > m_factories;
+
+    };
+
+    /// @brief A coder stack whose factory is the size_class_factory,
+    ///        for the object coders which take the factory type from
+    ///        the stack, e.g.
+    ///        object_decoder<size_class_coder<full_rlnc_decoder<F> > >.
+    template<class Coder>
+    class size_class_coder : public Coder
+    {
+    public:
+
+        /// The factory
+        typedef size_class_factory<Coder> factory;
+
+        /// Pointer to a coder, the coders are of the original stack
+        typedef typename Coder::pointer pointer;
+
+    };
+
+}
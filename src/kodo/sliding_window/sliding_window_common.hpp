@@ -0,0 +1,236 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <fifi/default_field.hpp>
+#include <fifi/fifi_utils.hpp>
+#include <sak/convert_endian.hpp>
+
+namespace kodo
+{
+
+    /// @brief The header format and the coefficient generation shared by
+    ///        the sliding_window_encoder and the sliding_window_decoder.
+    ///
+    /// The source symbols are numbered by a sequence number which
+    /// increases by one for every symbol entering the window. The window
+    /// holds the symbols [begin, end) and symbol s is kept at position
+    /// s % window_capacity of the ring buffers. Every payload carries
+    /// the window bounds of the encoder at the time it was produced, so
+    /// the decoder learns which symbols have left the window from any
+    /// payload received.
+    ///
+    /// The header is laid out after the symbol data as
+    ///
+    ///     [flag][begin][end][id]
+    ///
+    /// where the flag tells whether the payload is an uncoded symbol,
+    /// in which case the id is its sequence number, or a coded symbol,
+    /// in which case the id is the seed of the coding coefficients over
+    /// the symbols [begin, end). All fields are big endian.
+    template<class Field>
+    class sliding_window_common
+    {
+    public:
+
+        /// The field type
+        typedef Field field_type;
+
+        /// The value type of the field
+        typedef typename field_type::value_type value_type;
+
+        /// The finite field implementation
+        typedef typename fifi::default_field<field_type>::type field_impl;
+
+        /// The flag type
+        typedef uint8_t flag_type;
+
+        /// The sequence number type
+        typedef uint32_t sequence_type;
+
+        /// The seed type
+        typedef boost::random::mt19937::result_type seed_type;
+
+        /// The flag of an uncoded symbol
+        static const flag_type uncoded_flag = 0xff;
+
+        /// The flag of a coded symbol
+        static const flag_type coded_flag = 0x00;
+
+        /// The parsed header of a payload
+        struct header
+        {
+            /// The flag of the payload
+            flag_type m_flag;
+
+            /// The first symbol of the window
+            sequence_type m_begin;
+
+            /// One past the last symbol of the window
+            sequence_type m_end;
+
+            /// The sequence number of an uncoded symbol or the seed of
+            /// a coded symbol
+            uint32_t m_id;
+        };
+
+    public:
+
+        /// Constructor
+        /// @param window_capacity The maximum number of symbols in the
+        ///        window
+        /// @param symbol_size The size of a symbol in bytes
+        sliding_window_common(uint32_t window_capacity,
+                              uint32_t symbol_size)
+            : m_window_capacity(window_capacity),
+              m_symbol_size(symbol_size),
+              m_symbol_length(fifi::size_to_length<field_type>(symbol_size)),
+              m_coefficients_length(
+                  fifi::elements_to_length<field_type>(window_capacity)),
+              m_value_distribution(field_type::min_value,
+                                   field_type::max_value)
+        {
+            assert(m_window_capacity > 0);
+            assert(m_symbol_size > 0);
+
+            // The symbol must hold a whole number of field values
+            assert(fifi::length_to_size<field_type>(m_symbol_length) ==
+                   m_symbol_size);
+        }
+
+        /// @return The maximum number of symbols in the window
+        uint32_t window_capacity() const
+        {
+            return m_window_capacity;
+        }
+
+        /// @return The size of a symbol in bytes
+        uint32_t symbol_size() const
+        {
+            return m_symbol_size;
+        }
+
+        /// @return The size of the header in bytes
+        uint32_t header_size() const
+        {
+            return sizeof(flag_type) + 2 * sizeof(sequence_type) +
+                sizeof(uint32_t);
+        }
+
+        /// @return The size of a payload in bytes
+        uint32_t payload_size() const
+        {
+            return m_symbol_size + header_size();
+        }
+
+    protected:
+
+        /// @param sequence The sequence number of a symbol
+        /// @return The position of the symbol in the ring buffers
+        uint32_t slot(sequence_type sequence) const
+        {
+            return sequence % m_window_capacity;
+        }
+
+        /// Writes a header
+        /// @param h The header
+        /// @param data The buffer of the header
+        void write_header(const header &h, uint8_t *data) const
+        {
+            assert(data != 0);
+
+            sak::big_endian::put<flag_type>(h.m_flag, data);
+            data += sizeof(flag_type);
+            sak::big_endian::put<sequence_type>(h.m_begin, data);
+            data += sizeof(sequence_type);
+            sak::big_endian::put<sequence_type>(h.m_end, data);
+            data += sizeof(sequence_type);
+            sak::big_endian::put<uint32_t>(h.m_id, data);
+        }
+
+        /// Reads a header
+        /// @param data The buffer of the header
+        /// @return The header
+        header read_header(const uint8_t *data) const
+        {
+            assert(data != 0);
+
+            header h;
+            h.m_flag = sak::big_endian::get<flag_type>(data);
+            data += sizeof(flag_type);
+            h.m_begin = sak::big_endian::get<sequence_type>(data);
+            data += sizeof(sequence_type);
+            h.m_end = sak::big_endian::get<sequence_type>(data);
+            data += sizeof(sequence_type);
+            h.m_id = sak::big_endian::get<uint32_t>(data);
+
+            return h;
+        }
+
+        /// Generates the coding coefficients of the symbols [begin, end)
+        /// from a seed, the coefficient of symbol s is stored at
+        /// slot(s) and the coefficients of the other positions are zero
+        /// @param seed The seed
+        /// @param begin The first symbol
+        /// @param end One past the last symbol
+        /// @param coefficients The coefficient buffer of
+        ///        m_coefficients_length values
+        void generate(seed_type seed, sequence_type begin,
+                      sequence_type end, value_type *coefficients)
+        {
+            assert(coefficients != 0);
+            assert(end - begin <= m_window_capacity);
+
+            std::fill_n(coefficients, m_coefficients_length, 0);
+
+            m_random_generator.seed(seed);
+
+            for(sequence_type s = begin; s != end; ++s)
+            {
+                value_type c = m_value_distribution(m_random_generator);
+                fifi::set_value<field_type>(coefficients, slot(s), c);
+            }
+        }
+
+    protected:
+
+        /// The maximum number of symbols in the window
+        uint32_t m_window_capacity;
+
+        /// The size of a symbol in bytes
+        uint32_t m_symbol_size;
+
+        /// The length of a symbol in field values
+        uint32_t m_symbol_length;
+
+        /// The length of a coefficient vector in field values
+        uint32_t m_coefficients_length;
+
+        /// The finite field implementation
+        field_impl m_field;
+
+    private:
+
+        /// The type of the value_type distribution
+        typedef boost::random::uniform_int_distribution<value_type>
+            value_type_distribution;
+
+        /// Distribution that generates random values from a finite field
+        value_type_distribution m_value_distribution;
+
+        /// The random generator
+        boost::random::mt19937 m_random_generator;
+
+    };
+
+}
@@ -0,0 +1,510 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <fifi/arithmetics.hpp>
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "sliding_window_common.hpp"
+
+namespace kodo
+{
+
+    /// @brief Decodes the payloads of the sliding_window_encoder.
+    ///
+    /// The decoder keeps the received symbols in reduced echelon form
+    /// over the window, where the pivot of a row is its oldest non-zero
+    /// coefficient. Every row is stored at the position of its pivot
+    /// and only has non-zero coefficients for its pivot and the newer
+    /// symbols which are not pivots. When a symbol leaves the window it
+    /// is therefore the pivot of at most one row and no other row
+    /// depends on it, so the row is simply dropped and the position is
+    /// reused for the symbols entering the window. The window of the
+    /// decoder follows the bounds carried in the payloads.
+    ///
+    /// A symbol is decoded when its row has no other non-zero
+    /// coefficient. The symbol decoded callback is invoked as soon as
+    /// this happens, the symbol stays available through symbol() until
+    /// it leaves the window. Symbols which leave the window before they
+    /// are decoded are lost.
+    ///
+    /// Coded payloads combining symbols which have already left the
+    /// window of the decoder, i.e. payloads received out of order, are
+    /// ignored.
+    template<class Field>
+    class sliding_window_decoder
+        : public sliding_window_common<Field>, boost::noncopyable
+    {
+    public:
+
+        /// The common part of the encoder and decoder
+        typedef sliding_window_common<Field> common_type;
+
+        /// @copydoc sliding_window_common::field_type
+        typedef typename common_type::field_type field_type;
+
+        /// @copydoc sliding_window_common::value_type
+        typedef typename common_type::value_type value_type;
+
+        /// @copydoc sliding_window_common::sequence_type
+        typedef typename common_type::sequence_type sequence_type;
+
+        /// @copydoc sliding_window_common::header
+        typedef typename common_type::header header;
+
+        /// The symbol decoded callback function, invoked once for every
+        /// decoded symbol with its sequence number and data
+        typedef std::function<void (sequence_type, const uint8_t*)>
+            symbol_decoded_callback;
+
+    public:
+
+        /// @copydoc sliding_window_common::sliding_window_common(
+        ///              uint32_t,uint32_t)
+        sliding_window_decoder(uint32_t window_capacity,
+                               uint32_t symbol_size)
+            : common_type(window_capacity, symbol_size),
+              m_coefficients(window_capacity *
+                             common_type::m_coefficients_length, 0),
+              m_symbols(window_capacity * symbol_size, 0),
+              m_pivots(window_capacity, false),
+              m_decoded(window_capacity, false),
+              m_row_coefficients(common_type::m_coefficients_length, 0),
+              m_row_symbol(common_type::m_symbol_length, 0),
+              m_temp(std::max(common_type::m_symbol_length,
+                              common_type::m_coefficients_length), 0),
+              m_begin(0),
+              m_end(0),
+              m_rank(0),
+              m_symbols_decoded(0),
+              m_symbols_lost(0),
+              m_callback_func(nullptr)
+        {
+            m_changed.reserve(window_capacity);
+        }
+
+        /// Decodes a payload of the sliding_window_encoder
+        /// @param payload The payload of payload_size() bytes
+        void decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            header h = common_type::read_header(
+                payload + common_type::m_symbol_size);
+
+            assert(h.m_end - h.m_begin <= common_type::m_window_capacity);
+
+            if(is_before(h.m_begin, m_begin))
+            {
+                // The payload may depend on symbols which have left the
+                // window, only an uncoded symbol still in the window is
+                // useful
+                if(h.m_flag != common_type::uncoded_flag ||
+                   is_before(h.m_id, m_begin))
+                {
+                    return;
+                }
+
+                h.m_begin = m_begin;
+            }
+
+            slide(h.m_begin, h.m_end);
+
+            std::copy_n(payload, common_type::m_symbol_size,
+                        reinterpret_cast<uint8_t*>(&m_row_symbol[0]));
+
+            if(h.m_flag == common_type::uncoded_flag)
+            {
+                assert(h.m_id - m_begin < m_end - m_begin);
+
+                if(m_decoded[common_type::slot(h.m_id)])
+                {
+                    return;
+                }
+
+                std::fill(m_row_coefficients.begin(),
+                          m_row_coefficients.end(), 0);
+
+                fifi::set_value<field_type>(
+                    &m_row_coefficients[0], common_type::slot(h.m_id), 1);
+            }
+            else
+            {
+                common_type::generate(h.m_id, h.m_begin, h.m_end,
+                                      &m_row_coefficients[0]);
+            }
+
+            insert_row();
+        }
+
+        /// @return The first symbol in the window
+        sequence_type window_begin() const
+        {
+            return m_begin;
+        }
+
+        /// @return One past the last symbol in the window
+        sequence_type window_end() const
+        {
+            return m_end;
+        }
+
+        /// @return The number of symbols in the window
+        uint32_t window_size() const
+        {
+            return m_end - m_begin;
+        }
+
+        /// @return The number of linearly independent symbols received
+        ///         for the symbols in the window
+        uint32_t rank() const
+        {
+            return m_rank;
+        }
+
+        /// @param sequence The sequence number of a symbol
+        /// @return True if the symbol is in the window and decoded
+        bool is_decoded(sequence_type sequence) const
+        {
+            return in_window(sequence) &&
+                m_decoded[common_type::slot(sequence)];
+        }
+
+        /// @param sequence The sequence number of a decoded symbol in the
+        ///        window
+        /// @return The data of the symbol
+        const uint8_t* symbol(sequence_type sequence) const
+        {
+            assert(in_window(sequence));
+            return &m_symbols[common_type::slot(sequence) *
+                              common_type::m_symbol_size];
+        }
+
+        /// @return The number of symbols decoded
+        uint32_t symbols_decoded() const
+        {
+            return m_symbols_decoded;
+        }
+
+        /// @return The number of symbols which left the window without
+        ///         being decoded
+        uint32_t symbols_lost() const
+        {
+            return m_symbols_lost;
+        }
+
+        /// Set the symbol decoded callback function
+        /// @param callback The callback function
+        void set_symbol_decoded_callback(
+            const symbol_decoded_callback &callback)
+        {
+            m_callback_func = callback;
+        }
+
+    protected:
+
+        /// @return True if sequence number a is before b
+        static bool is_before(sequence_type a, sequence_type b)
+        {
+            return static_cast<int32_t>(a - b) < 0;
+        }
+
+        /// @return True if the symbol is in the window
+        bool in_window(sequence_type sequence) const
+        {
+            return sequence - m_begin < m_end - m_begin;
+        }
+
+        /// @param sequence The sequence number of a symbol in the window
+        /// @return The coefficients of the row with the symbol as pivot
+        value_type* row_coefficients(sequence_type sequence)
+        {
+            return &m_coefficients[common_type::slot(sequence) *
+                                   common_type::m_coefficients_length];
+        }
+
+        /// @param sequence The sequence number of a symbol in the window
+        /// @return The data of the row with the symbol as pivot
+        value_type* row_symbol(sequence_type sequence)
+        {
+            return reinterpret_cast<value_type*>(
+                &m_symbols[common_type::slot(sequence) *
+                           common_type::m_symbol_size]);
+        }
+
+        /// Moves the window to the bounds of a payload, dropping the
+        /// rows of the symbols leaving the window
+        /// @param begin The first symbol of the window of the payload
+        /// @param end One past the last symbol of the window of the
+        ///        payload
+        void slide(sequence_type begin, sequence_type end)
+        {
+            while(is_before(m_begin, begin))
+            {
+                if(m_begin == m_end)
+                {
+                    // No symbol of the gap was ever received
+                    m_symbols_lost += begin - m_begin;
+                    m_begin = begin;
+                    m_end = begin;
+                    break;
+                }
+
+                retire();
+            }
+
+            if(is_before(m_end, end))
+            {
+                m_end = end;
+            }
+
+            assert(m_end - m_begin <= common_type::m_window_capacity);
+        }
+
+        /// Removes the oldest symbol from the window
+        void retire()
+        {
+            uint32_t s = common_type::slot(m_begin);
+
+            if(!m_decoded[s])
+            {
+                ++m_symbols_lost;
+            }
+
+            if(m_pivots[s])
+            {
+                // The row is the only one depending on the symbol, the
+                // coefficients are cleared for the symbol entering the
+                // position
+                std::fill_n(row_coefficients(m_begin),
+                            common_type::m_coefficients_length, 0);
+
+                m_pivots[s] = false;
+                --m_rank;
+            }
+
+            m_decoded[s] = false;
+            ++m_begin;
+        }
+
+        /// Subtracts a multiple of one row from another
+        /// @param c The multiple
+        /// @param dest_coefficients The coefficients of the destination
+        /// @param dest_symbol The data of the destination
+        /// @param src_coefficients The coefficients of the source
+        /// @param src_symbol The data of the source
+        void subtract_row(value_type c, value_type *dest_coefficients,
+                          value_type *dest_symbol,
+                          const value_type *src_coefficients,
+                          const value_type *src_symbol)
+        {
+            uint32_t cl = common_type::m_coefficients_length;
+            uint32_t sl = common_type::m_symbol_length;
+
+            if(fifi::is_binary<field_type>::value)
+            {
+                fifi::subtract(common_type::m_field,
+                               dest_coefficients, src_coefficients, cl);
+                fifi::subtract(common_type::m_field,
+                               dest_symbol, src_symbol, sl);
+            }
+            else
+            {
+                fifi::multiply_subtract(common_type::m_field, c,
+                                        dest_coefficients, src_coefficients,
+                                        &m_temp[0], cl);
+                fifi::multiply_subtract(common_type::m_field, c,
+                                        dest_symbol, src_symbol,
+                                        &m_temp[0], sl);
+            }
+        }
+
+        /// Eliminates the received row with the rows in the window and
+        /// stores it at its pivot
+        void insert_row()
+        {
+            value_type *coefficients = &m_row_coefficients[0];
+            value_type *symbol = &m_row_symbol[0];
+
+            bool found = false;
+            sequence_type pivot = 0;
+
+            // The rows only depend on newer symbols, so a single pass
+            // from the oldest symbol eliminates all the pivots
+            for(sequence_type s = m_begin; s != m_end; ++s)
+            {
+                uint32_t position = common_type::slot(s);
+
+                value_type c =
+                    fifi::get_value<field_type>(coefficients, position);
+
+                if(!c)
+                {
+                    continue;
+                }
+
+                if(m_pivots[position])
+                {
+                    subtract_row(c, coefficients, symbol,
+                                 row_coefficients(s), row_symbol(s));
+                }
+                else if(!found)
+                {
+                    found = true;
+                    pivot = s;
+                }
+            }
+
+            if(!found)
+            {
+                // The row was not linearly independent
+                return;
+            }
+
+            uint32_t position = common_type::slot(pivot);
+
+            if(!fifi::is_binary<field_type>::value)
+            {
+                value_type c =
+                    fifi::get_value<field_type>(coefficients, position);
+                value_type inverse = common_type::m_field.invert(c);
+
+                fifi::multiply_constant(
+                    common_type::m_field, inverse, coefficients,
+                    common_type::m_coefficients_length);
+                fifi::multiply_constant(
+                    common_type::m_field, inverse, symbol,
+                    common_type::m_symbol_length);
+            }
+
+            std::copy(m_row_coefficients.begin(), m_row_coefficients.end(),
+                      row_coefficients(pivot));
+            std::copy(m_row_symbol.begin(), m_row_symbol.end(),
+                      row_symbol(pivot));
+
+            m_pivots[position] = true;
+            ++m_rank;
+
+            m_changed.clear();
+            m_changed.push_back(pivot);
+
+            // Only the rows of older pivots can depend on the new pivot
+            for(sequence_type s = m_begin; s != pivot; ++s)
+            {
+                if(!m_pivots[common_type::slot(s)])
+                {
+                    continue;
+                }
+
+                value_type *dest = row_coefficients(s);
+                value_type c = fifi::get_value<field_type>(dest, position);
+
+                if(!c)
+                {
+                    continue;
+                }
+
+                subtract_row(c, dest, row_symbol(s),
+                             row_coefficients(pivot), row_symbol(pivot));
+
+                m_changed.push_back(s);
+            }
+
+            for(sequence_type s : m_changed)
+            {
+                update_decoded(s);
+            }
+        }
+
+        /// Marks the symbol of a row as decoded if the row has no other
+        /// non-zero coefficient
+        /// @param pivot The pivot of the row
+        void update_decoded(sequence_type pivot)
+        {
+            uint32_t position = common_type::slot(pivot);
+            assert(m_pivots[position]);
+
+            if(m_decoded[position])
+            {
+                return;
+            }
+
+            const value_type *coefficients = row_coefficients(pivot);
+
+            for(sequence_type s = pivot + 1; s != m_end; ++s)
+            {
+                if(fifi::get_value<field_type>(
+                       coefficients, common_type::slot(s)))
+                {
+                    return;
+                }
+            }
+
+            m_decoded[position] = true;
+            ++m_symbols_decoded;
+
+            if(m_callback_func)
+            {
+                m_callback_func(pivot, symbol(pivot));
+            }
+        }
+
+    private:
+
+        /// The coefficients of the rows, stored at their pivots
+        std::vector<value_type> m_coefficients;
+
+        /// The data of the rows, stored at their pivots
+        std::vector<uint8_t> m_symbols;
+
+        /// True for the positions holding a row
+        std::vector<bool> m_pivots;
+
+        /// True for the positions holding a decoded symbol
+        std::vector<bool> m_decoded;
+
+        /// The coefficients of the row being inserted
+        std::vector<value_type> m_row_coefficients;
+
+        /// The data of the row being inserted
+        std::vector<value_type> m_row_symbol;
+
+        /// Temporary buffer for the multiplications
+        std::vector<value_type> m_temp;
+
+        /// The pivots of the rows changed by the last insertion
+        std::vector<sequence_type> m_changed;
+
+        /// The first symbol in the window
+        sequence_type m_begin;
+
+        /// One past the last symbol in the window
+        sequence_type m_end;
+
+        /// The number of rows in the window
+        uint32_t m_rank;
+
+        /// The number of symbols decoded
+        uint32_t m_symbols_decoded;
+
+        /// The number of symbols lost
+        uint32_t m_symbols_lost;
+
+        /// The symbol decoded callback function
+        symbol_decoded_callback m_callback_func;
+
+    };
+
+}
@@ -0,0 +1,275 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <fifi/arithmetics.hpp>
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+#include <sak/storage.hpp>
+
+#include "sliding_window_common.hpp"
+
+namespace kodo
+{
+
+    /// @brief Encodes a stream of source symbols over a sliding window.
+    ///
+    /// Instead of dividing the stream into blocks the application pushes
+    /// the source symbols into the window as they are produced and pops
+    /// the oldest symbols when they are no longer useful to the
+    /// receiver, e.g. when they are acknowledged or their play-out
+    /// deadline has passed. The coded symbols are random combinations of
+    /// the symbols currently in the window, so a lost symbol can be
+    /// recovered as soon as enough coded symbols have been received,
+    /// without waiting for the rest of a generation. The decoding delay
+    /// is thereby bounded by the window and not by a block size.
+    ///
+    /// With the systematic mode on, which is the default, every symbol
+    /// is first sent uncoded once and coded symbols are produced when
+    /// all the symbols in the window have been sent, i.e. the
+    /// application decides the amount of redundancy by the number of
+    /// calls to encode() between the calls to push_symbol().
+    template<class Field>
+    class sliding_window_encoder
+        : public sliding_window_common<Field>, boost::noncopyable
+    {
+    public:
+
+        /// The common part of the encoder and decoder
+        typedef sliding_window_common<Field> common_type;
+
+        /// @copydoc sliding_window_common::field_type
+        typedef typename common_type::field_type field_type;
+
+        /// @copydoc sliding_window_common::value_type
+        typedef typename common_type::value_type value_type;
+
+        /// @copydoc sliding_window_common::sequence_type
+        typedef typename common_type::sequence_type sequence_type;
+
+        /// @copydoc sliding_window_common::header
+        typedef typename common_type::header header;
+
+    public:
+
+        /// @copydoc sliding_window_common::sliding_window_common(
+        ///              uint32_t,uint32_t)
+        sliding_window_encoder(uint32_t window_capacity,
+                               uint32_t symbol_size)
+            : common_type(window_capacity, symbol_size),
+              m_symbols(window_capacity * symbol_size, 0),
+              m_coefficients(common_type::m_coefficients_length, 0),
+              m_temp(common_type::m_symbol_length, 0),
+              m_begin(0),
+              m_end(0),
+              m_next_uncoded(0),
+              m_seed(0),
+              m_systematic(true)
+        { }
+
+        /// @return The first symbol in the window
+        sequence_type window_begin() const
+        {
+            return m_begin;
+        }
+
+        /// @return One past the last symbol in the window, i.e. the
+        ///         sequence number of the next symbol pushed
+        sequence_type window_end() const
+        {
+            return m_end;
+        }
+
+        /// @return The number of symbols in the window
+        uint32_t window_size() const
+        {
+            return m_end - m_begin;
+        }
+
+        /// @return True if no more symbols can be pushed before the
+        ///         oldest is popped
+        bool is_window_full() const
+        {
+            return window_size() == common_type::m_window_capacity;
+        }
+
+        /// Adds a symbol to the window, a symbol shorter than the
+        /// symbol size is zero padded
+        /// @param symbol The symbol data
+        /// @return The sequence number of the symbol
+        sequence_type push_symbol(const sak::const_storage &symbol)
+        {
+            assert(!is_window_full());
+            assert(symbol.m_data != 0);
+            assert(symbol.m_size <= common_type::m_symbol_size);
+
+            uint8_t *data = symbol_data(m_end);
+
+            std::copy_n(symbol.m_data, symbol.m_size, data);
+            std::fill(data + symbol.m_size,
+                      data + common_type::m_symbol_size, 0);
+
+            return m_end++;
+        }
+
+        /// Removes the oldest symbol from the window
+        void pop_symbol()
+        {
+            assert(window_size() > 0);
+            ++m_begin;
+        }
+
+        /// @return True if the symbols are sent uncoded before coding
+        bool is_systematic_on() const
+        {
+            return m_systematic;
+        }
+
+        /// Send the symbols uncoded before coding
+        void set_systematic_on()
+        {
+            m_systematic = true;
+        }
+
+        /// Only send coded symbols
+        void set_systematic_off()
+        {
+            m_systematic = false;
+        }
+
+        /// Produces a payload from the symbols in the window
+        /// @param payload The buffer of payload_size() bytes
+        /// @return The number of bytes used
+        uint32_t encode(uint8_t *payload)
+        {
+            assert(payload != 0);
+            assert(window_size() > 0);
+
+            header h;
+            h.m_begin = m_begin;
+            h.m_end = m_end;
+
+            // Symbols popped before they were sent are skipped
+            m_next_uncoded = std::max(m_next_uncoded, m_begin);
+
+            if(m_systematic && m_next_uncoded != m_end)
+            {
+                h.m_flag = common_type::uncoded_flag;
+                h.m_id = m_next_uncoded;
+
+                std::copy_n(symbol_data(m_next_uncoded),
+                            common_type::m_symbol_size, payload);
+
+                ++m_next_uncoded;
+            }
+            else
+            {
+                h.m_flag = common_type::coded_flag;
+                h.m_id = m_seed++;
+
+                encode_symbol(h, payload);
+            }
+
+            common_type::write_header(
+                h, payload + common_type::m_symbol_size);
+
+            return common_type::payload_size();
+        }
+
+        /// @param sequence The sequence number of a symbol in the window
+        /// @return The data of the symbol
+        const uint8_t* symbol(sequence_type sequence) const
+        {
+            assert(sequence - m_begin < window_size());
+            return &m_symbols[common_type::slot(sequence) *
+                              common_type::m_symbol_size];
+        }
+
+    protected:
+
+        /// @param sequence The sequence number of a symbol
+        /// @return The storage of the symbol in the ring buffer
+        uint8_t* symbol_data(sequence_type sequence)
+        {
+            return &m_symbols[common_type::slot(sequence) *
+                              common_type::m_symbol_size];
+        }
+
+        /// Combines the symbols of the window with the coefficients
+        /// given by the seed of the header
+        /// @param h The header of the coded symbol
+        /// @param symbol_data The destination of the coded symbol
+        void encode_symbol(const header &h, uint8_t *symbol_data)
+        {
+            common_type::generate(h.m_id, h.m_begin, h.m_end,
+                                  &m_coefficients[0]);
+
+            std::fill_n(symbol_data, common_type::m_symbol_size, 0);
+
+            value_type *dest = reinterpret_cast<value_type*>(symbol_data);
+            uint32_t length = common_type::m_symbol_length;
+
+            for(sequence_type s = h.m_begin; s != h.m_end; ++s)
+            {
+                value_type c = fifi::get_value<field_type>(
+                    &m_coefficients[0], common_type::slot(s));
+
+                if(!c)
+                {
+                    continue;
+                }
+
+                const value_type *src =
+                    reinterpret_cast<const value_type*>(symbol(s));
+
+                if(fifi::is_binary<field_type>::value)
+                {
+                    fifi::add(common_type::m_field, dest, src, length);
+                }
+                else
+                {
+                    fifi::multiply_add(common_type::m_field, c, dest, src,
+                                       &m_temp[0], length);
+                }
+            }
+        }
+
+    private:
+
+        /// The ring buffer of the symbols in the window
+        std::vector<uint8_t> m_symbols;
+
+        /// The coefficients of the current coded symbol
+        std::vector<value_type> m_coefficients;
+
+        /// Temporary buffer for the multiplications
+        std::vector<value_type> m_temp;
+
+        /// The first symbol in the window
+        sequence_type m_begin;
+
+        /// One past the last symbol in the window
+        sequence_type m_end;
+
+        /// The next symbol to send uncoded
+        sequence_type m_next_uncoded;
+
+        /// The seed of the next coded symbol
+        uint32_t m_seed;
+
+        /// True if the symbols are sent uncoded first
+        bool m_systematic;
+
+    };
+
+}
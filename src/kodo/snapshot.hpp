@@ -0,0 +1,154 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include <sak/storage.hpp>
+
+namespace kodo
+{
+
+    /// @defgroup snapshot Snapshot and restore of the coder state
+    ///
+    /// The layers holding state of an encoder or decoder implement
+    ///
+    ///   uint32_t snapshot_size() const
+    ///   uint8_t* write_snapshot(uint8_t *buffer) const
+    ///   const uint8_t* read_snapshot(const uint8_t *buffer)
+    ///
+    /// which first call the layer below and then append their own
+    /// state, the final factory layers terminate the calls. The state
+    /// is written as plain memory in host byte order, so e.g. a
+    /// snapshot in a memory mapped file is restored with a few memory
+    /// copies. A snapshot is only restored into a coder of the same
+    /// stack, built with the same number of symbols and symbol size,
+    /// on the same architecture. read_snapshot() returns null if the
+    /// snapshot does not match the coder.
+
+    /// Writes a value to a snapshot
+    /// @param value The value
+    /// @param buffer The position in the snapshot
+    /// @return The position following the value
+    template<class ValueType>
+    inline uint8_t* write_snapshot_value(ValueType value, uint8_t *buffer)
+    {
+        assert(buffer != 0);
+        std::memcpy(buffer, &value, sizeof(ValueType));
+        return buffer + sizeof(ValueType);
+    }
+
+    /// Reads a value from a snapshot
+    /// @param buffer The position in the snapshot
+    /// @param value Set to the value
+    /// @return The position following the value
+    template<class ValueType>
+    inline const uint8_t* read_snapshot_value(const uint8_t *buffer,
+                                              ValueType &value)
+    {
+        assert(buffer != 0);
+        std::memcpy(&value, buffer, sizeof(ValueType));
+        return buffer + sizeof(ValueType);
+    }
+
+    /// @return The size in bytes of a bitmap of a number of flags
+    /// @param flags The number of flags
+    inline uint32_t snapshot_bitmap_size(uint32_t flags)
+    {
+        return (flags + 7) / 8;
+    }
+
+    /// Writes flags to a snapshot as a bitmap, flag i is bit i % 8 of
+    /// byte i / 8
+    /// @param flags The flags
+    /// @param count The number of flags to write
+    /// @param buffer The position in the snapshot
+    /// @return The position following the bitmap
+    inline uint8_t* write_snapshot_bitmap(const std::vector<bool> &flags,
+                                          uint32_t count, uint8_t *buffer)
+    {
+        assert(buffer != 0);
+        assert(count <= flags.size());
+
+        uint32_t size = snapshot_bitmap_size(count);
+        std::memset(buffer, 0, size);
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            if(flags[i])
+            {
+                buffer[i / 8] |= uint8_t(1) << (i % 8);
+            }
+        }
+
+        return buffer + size;
+    }
+
+    /// Reads flags from a bitmap written by write_snapshot_bitmap()
+    /// @param buffer The position in the snapshot
+    /// @param count The number of flags to read
+    /// @param flags Flags 0 to count - 1 are set from the bitmap
+    /// @return The position following the bitmap
+    inline const uint8_t* read_snapshot_bitmap(const uint8_t *buffer,
+                                               uint32_t count,
+                                               std::vector<bool> &flags)
+    {
+        assert(buffer != 0);
+        assert(count <= flags.size());
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            flags[i] = (buffer[i / 8] >> (i % 8)) & 1U;
+        }
+
+        return buffer + snapshot_bitmap_size(count);
+    }
+
+    /// Takes a snapshot of a coder
+    /// @ingroup snapshot
+    /// @param coder The coder
+    /// @return The snapshot
+    template<class Coder>
+    inline std::vector<uint8_t> snapshot(const Coder &coder)
+    {
+        assert(coder);
+
+        std::vector<uint8_t> buffer(coder->snapshot_size());
+
+        uint8_t *end = coder->write_snapshot(buffer.data());
+        assert(end == buffer.data() + buffer.size());
+        (void) end;
+
+        return buffer;
+    }
+
+    /// Restores a coder from a snapshot, the coder must have been built
+    /// with the same number of symbols and symbol size as the coder of
+    /// the snapshot
+    /// @ingroup snapshot
+    /// @param coder The coder
+    /// @param storage The snapshot
+    /// @return true if the snapshot was restored, false if it does not
+    ///         match the coder in which case the coder must be built
+    ///         again before it is used
+    template<class Coder>
+    inline bool restore(const Coder &coder, const sak::const_storage &storage)
+    {
+        assert(coder);
+        assert(storage.m_data != 0);
+
+        if(storage.m_size != coder->snapshot_size())
+        {
+            return false;
+        }
+
+        return coder->read_snapshot(storage.m_data) != 0;
+    }
+
+}
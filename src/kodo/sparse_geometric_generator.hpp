@@ -0,0 +1,222 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Generates uniformly distributed coefficients with a specific
+    ///        density, in time proportional to the number of non-zero
+    ///        coefficients.
+    ///
+    /// Where the sparse_uniform_generator makes a Bernoulli draw for
+    /// every symbol, this layer draws the distance to the next non-zero
+    /// coefficient from a geometric distribution. The positions and
+    /// values of the non-zero coefficients produced by the last call to
+    /// generate() or generate_partial() are kept in a compact list
+    /// which the sparse_symbol_id_encoder passes on to the encoder, so
+    /// that the encoder does not have to scan the coefficient vector.
+    template<class SuperCoder>
+    class sparse_geometric_generator : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The random generator used
+        typedef boost::random::mt19937 generator_type;
+
+        /// @copydoc layer::seed_type
+        typedef generator_type::result_type seed_type;
+
+    public:
+
+        /// Constructor
+        sparse_geometric_generator()
+            : m_value_distribution(1, field_type::max_value)
+        {
+            set_density(0.5);
+        }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_indices.reserve(the_factory.max_symbols());
+            m_values.reserve(the_factory.max_symbols());
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            generate_coefficients(coefficients, false);
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate_partial(uint8_t *coefficients)
+        {
+            generate_coefficients(coefficients, true);
+        }
+
+        /// @copydoc layer::seed(seed_type)
+        void seed(seed_type seed_value)
+        {
+            m_random_generator.seed(seed_value);
+        }
+
+        /// Set the density of the coefficients generated
+        /// @param density coefficients density
+        void set_density(double density)
+        {
+            assert(density > 0);
+            assert(density <= 1.0);
+
+            m_density = density;
+            m_log_complement = density < 1.0 ? std::log(1.0 - density) : 0;
+        }
+
+        /// Get the density of the coefficients generated
+        /// @return the density of the generator
+        double get_density() const
+        {
+            return m_density;
+        }
+
+        /// @return The number of non-zero coefficients generated by the
+        ///         last call to generate() or generate_partial()
+        uint32_t nonzero_count() const
+        {
+            return static_cast<uint32_t>(m_indices.size());
+        }
+
+        /// @return The symbol indices of the non-zero coefficients in
+        ///         increasing order
+        const uint32_t* nonzero_indices() const
+        {
+            return m_indices.empty() ? 0 : &m_indices[0];
+        }
+
+        /// @return The values of the non-zero coefficients in the same
+        ///         order as the indices
+        const value_type* nonzero_values() const
+        {
+            return m_values.empty() ? 0 : &m_values[0];
+        }
+
+    protected:
+
+        /// Generates the coefficients and the list of non-zero
+        /// coefficients
+        /// @param coefficients The coefficient buffer
+        /// @param partial If true only coefficients for symbols which
+        ///        are pivots are generated
+        void generate_coefficients(uint8_t *coefficients, bool partial)
+        {
+            assert(coefficients != 0);
+
+            // Since we will not set all coefficients we should ensure
+            // that the non specified ones are zero
+            std::fill_n(coefficients, SuperCoder::coefficients_size(), 0);
+
+            m_indices.clear();
+            m_values.clear();
+
+            value_type* c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            // Every index is selected independently with probability
+            // density, so also with partial generation each of the
+            // pivot symbols is selected with that probability
+            for(uint32_t i = next_skip(symbols); i < symbols;
+                i += 1 + next_skip(symbols - i - 1))
+            {
+                if(partial && !SuperCoder::symbol_pivot(i))
+                {
+                    continue;
+                }
+
+                value_type coefficient = 1;
+
+                if(!fifi::is_binary<field_type>::value)
+                {
+                    coefficient = m_value_distribution(m_random_generator);
+                }
+
+                fifi::set_value<field_type>(c, i, coefficient);
+
+                m_indices.push_back(i);
+                m_values.push_back(coefficient);
+            }
+        }
+
+        /// @return The number of zero coefficients before the next
+        ///         non-zero coefficient, at most limit
+        /// @param limit The number of symbols left
+        uint32_t next_skip(uint32_t limit)
+        {
+            if(m_density >= 1.0)
+            {
+                return 0;
+            }
+
+            // uniform_01 gives values in [0,1) so we use 1 - u to avoid
+            // taking the logarithm of zero
+            double u = 1.0 - m_uniform(m_random_generator);
+            double skip = std::floor(std::log(u) / m_log_complement);
+
+            return skip < limit ? static_cast<uint32_t>(skip) : limit;
+        }
+
+    private:
+
+        /// The density of the coefficients
+        double m_density;
+
+        /// The logarithm of one minus the density
+        double m_log_complement;
+
+        /// Distribution used for the geometric skips
+        boost::random::uniform_01<double> m_uniform;
+
+        /// The type of the value_type distribution
+        typedef boost::random::uniform_int_distribution<value_type>
+            value_type_distribution;
+
+        /// Distribution that generates random values from a finite field
+        value_type_distribution m_value_distribution;
+
+        /// The random generator
+        boost::random::mt19937 m_random_generator;
+
+        /// The indices of the non-zero coefficients
+        std::vector<uint32_t> m_indices;
+
+        /// The values of the non-zero coefficients
+        std::vector<value_type> m_values;
+
+    };
+}
@@ -0,0 +1,54 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "symbol_id_decoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_header_layers
+    ///
+    /// @brief Reads the symbol id from the symbol header and decodes
+    ///        the symbol from the list of non-zero coefficients kept by
+    ///        the coefficient generator.
+    ///
+    /// This is the decoding counterpart of the sparse_symbol_id_encoder,
+    /// used with a seed based symbol id so that the generator of the
+    /// decoder reproduces the coefficients. It calls the
+    /// layer::decode_symbol(uint8_t*, const uint32_t*,
+    /// const value_type*, uint32_t) function so that the decoder does
+    /// not have to scan the coefficient vector, see the
+    /// inactivation_decoder.
+    template<class SuperCoder>
+    class sparse_symbol_id_decoder : public symbol_id_decoder<SuperCoder>
+    {
+    public:
+
+        /// @copydoc layer::decode(uint8_t*, uint8_t*)
+        void decode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint8_t *coefficients = 0;
+
+            SuperCoder::read_id(symbol_header, &coefficients);
+
+            assert(coefficients != 0);
+
+            SuperCoder::decode_symbol(symbol_data,
+                                      SuperCoder::nonzero_indices(),
+                                      SuperCoder::nonzero_values(),
+                                      SuperCoder::nonzero_count());
+        }
+
+    };
+
+}
@@ -0,0 +1,54 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "symbol_id_encoder.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_header_layers
+    ///
+    /// @brief Writes the symbol id into the symbol header and encodes
+    ///        the symbol from the list of non-zero coefficients kept by
+    ///        the coefficient generator.
+    ///
+    /// This layer is used together with the sparse_geometric_generator,
+    /// it calls the layer::encode_symbol(uint8_t*, const uint32_t*,
+    /// const value_type*, uint32_t) function so that the encoder does
+    /// not have to scan the coefficient vector for non-zero values.
+    template<class SuperCoder>
+    class sparse_symbol_id_encoder : public symbol_id_encoder<SuperCoder>
+    {
+    public:
+
+        /// @copydoc layer::encode(uint8_t*, uint8_t*)
+        uint32_t encode(uint8_t *symbol_data, uint8_t *symbol_header)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+
+            uint8_t *coefficients = 0;
+
+            uint32_t bytes_used =
+                SuperCoder::write_id(symbol_header, &coefficients);
+
+            assert(coefficients != 0);
+
+            SuperCoder::encode_symbol(symbol_data,
+                                      SuperCoder::nonzero_indices(),
+                                      SuperCoder::nonzero_values(),
+                                      SuperCoder::nonzero_count());
+
+            return bytes_used;
+        }
+
+    };
+
+}
@@ -20,6 +20,11 @@ namespace kodo
     /// @ingroup coefficient_generator_layers
     /// @brief Generate uniformly distributed coefficients with a specific
     /// density
+    ///
+    /// As in the uniform_generator the first coefficient vectors of a
+    /// block may be restricted to the binary subfield, see
+    /// set_subfield_vectors(). The non-zero coefficients of those
+    /// vectors are one, so the density is kept.
     template<class SuperCoder>
     class sparse_uniform_generator : public SuperCoder
     {
@@ -42,9 +47,19 @@ namespace kodo
         /// Constructor
         sparse_uniform_generator()
             : m_bernoulli(0.5),
-              m_value_distribution(1, field_type::max_value)
+              m_value_distribution(1, field_type::max_value),
+              m_subfield_vectors(0),
+              m_generated(0)
         { }
 
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_generated = 0;
+        }
+
         /// @copydoc layer::generate(uint8_t*)
         void generate(uint8_t *coefficients)
         {
@@ -56,11 +71,13 @@ namespace kodo
 
             value_type* c = reinterpret_cast<value_type*>(coefficients);
 
+            bool subfield = next_is_subfield();
+
             for (uint32_t i = 0; i < SuperCoder::symbols(); ++i)
             {
                 if (m_bernoulli(m_random_generator))
                 {
-                    if (fifi::is_binary<field_type>::value)
+                    if (subfield)
                     {
                         fifi::set_value<field_type>(c, i, 1);
                     }
@@ -88,6 +105,7 @@ namespace kodo
             value_type* c = reinterpret_cast<value_type*>(coefficients);
 
             uint32_t symbols = SuperCoder::symbols();
+            bool subfield = next_is_subfield();
 
             for (uint32_t i = 0; i < symbols; ++i)
             {
@@ -98,7 +116,7 @@ namespace kodo
 
                 if (m_bernoulli(m_random_generator))
                 {
-                    if (fifi::is_binary<field_type>::value)
+                    if (subfield)
                     {
                         fifi::set_value<field_type>(c, i, 1);
                     }
@@ -136,6 +154,38 @@ namespace kodo
             return m_bernoulli.p();
         }
 
+        /// Sets the number of coefficient vectors of every block with
+        /// coefficients from the binary subfield. By default there are
+        /// none.
+        /// @param vectors The number of vectors
+        void set_subfield_vectors(uint32_t vectors)
+        {
+            m_subfield_vectors = vectors;
+        }
+
+        /// @return The number of vectors of every block with coefficients
+        ///         from the binary subfield
+        uint32_t subfield_vectors() const
+        {
+            return m_subfield_vectors;
+        }
+
+    private:
+
+        /// Counts a generated vector
+        /// @return True if its coefficients are of the binary subfield,
+        ///         always for the binary field
+        bool next_is_subfield()
+        {
+            if(m_generated < m_subfield_vectors)
+            {
+                ++m_generated;
+                return true;
+            }
+
+            return fifi::is_binary<field_type>::value;
+        }
+
     private:
 
         /// The distribution controlling the density of the coefficients
@@ -151,6 +201,12 @@ namespace kodo
         /// The random generator
         boost::random::mt19937 m_random_generator;
 
+        /// The number of vectors of a block from the binary subfield
+        uint32_t m_subfield_vectors;
+
+        /// The number of vectors generated for the block
+        uint32_t m_generated;
+
     };
 }
 
@@ -7,6 +7,8 @@
 
 #include <fifi/fifi_utils.hpp>
 
+#include "snapshot.hpp"
+
 namespace kodo
 {
 
@@ -160,6 +162,45 @@ namespace kodo
             return m_symbols * m_symbol_size;
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() + 2 * sizeof(uint32_t);
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            buffer = SuperCoder::write_snapshot(buffer);
+            buffer = write_snapshot_value(m_symbols, buffer);
+            return write_snapshot_value(m_symbol_size, buffer);
+        }
+
+        /// Checks that the snapshot was taken of a block with the same
+        /// number of symbols and symbol size
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            uint32_t symbols = 0;
+            uint32_t symbol_size = 0;
+
+            buffer = read_snapshot_value(buffer, symbols);
+            buffer = read_snapshot_value(buffer, symbol_size);
+
+            if(symbols != m_symbols || symbol_size != m_symbol_size)
+            {
+                return 0;
+            }
+
+            return buffer;
+        }
+
     protected:
 
         /// The number of symbols store
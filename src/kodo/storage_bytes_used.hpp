@@ -7,6 +7,8 @@
 
 #include <cstdint>
 
+#include "snapshot.hpp"
+
 namespace kodo
 {
 
@@ -47,6 +49,40 @@ namespace kodo
             return m_bytes_used;
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() + sizeof(uint32_t);
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            buffer = SuperCoder::write_snapshot(buffer);
+            return write_snapshot_value(m_bytes_used, buffer);
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            uint32_t bytes_used = 0;
+            buffer = read_snapshot_value(buffer, bytes_used);
+
+            if(bytes_used > SuperCoder::block_size())
+            {
+                return 0;
+            }
+
+            m_bytes_used = bytes_used;
+            return buffer;
+        }
+
     private:
 
         /// The number of bytes used
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cassert>
+
 #include <sak/storage.hpp>
 
 namespace kodo
@@ -20,6 +23,9 @@ namespace kodo
     /// Note that when used together with shallow_symbol_storage
     /// encoders the caller must ensure that the memory buffer remains
     /// valid throughout the life-time of the storage_reader object.
+    ///
+    /// A sak::const_storage holds at most 4 GB, larger memory buffers,
+    /// e.g. a mapped file, are given as a pointer and a 64 bit size.
     template<class EncoderType>
     class storage_reader
     {
@@ -34,34 +40,46 @@ namespace kodo
         /// wrapped by the const_storage object.
         /// @param storage the memory buffer to use
         storage_reader(const sak::const_storage &storage)
-            : m_storage(storage)
+            : m_data(storage.m_data),
+              m_size(storage.m_size)
+        {
+            assert(m_size > 0);
+            assert(m_data != 0);
+        }
+
+        /// Creates a new storage reader using a memory buffer
+        /// @param data the memory buffer to use
+        /// @param size the size of the memory buffer in bytes
+        storage_reader(const uint8_t *data, uint64_t size)
+            : m_data(data),
+              m_size(size)
         {
-            assert(m_storage.m_size > 0);
-            assert(m_storage.m_data != 0);
+            assert(m_size > 0);
+            assert(m_data != 0);
         }
 
         /// @return the size of the storage object in bytes
-        uint32_t size() const
+        uint64_t size() const
         {
-            return m_storage.m_size;
+            return m_size;
         }
 
         /// Initializes the encoder with data from the storage object.
         /// @param encoder to be initialized
         /// @param offset in bytes into the storage object
         /// @param size the number of bytes to use
-        void read(pointer &encoder, uint32_t offset, uint32_t size)
+        void read(pointer &encoder, uint64_t offset, uint32_t size)
         {
             assert(encoder);
-            assert(offset < m_storage.m_size);
+            assert(offset < m_size);
             assert(size > 0);
 
-            uint32_t remaining_bytes = m_storage.m_size - offset;
+            uint64_t remaining_bytes = m_size - offset;
 
             assert(size <= remaining_bytes);
 
             sak::const_storage storage;
-            storage.m_data = m_storage.m_data + offset;
+            storage.m_data = m_data + offset;
             storage.m_size = size;
 
             encoder->set_symbols(storage);
@@ -74,7 +92,10 @@ namespace kodo
     private:
 
         /// The memory buffer
-        sak::const_storage m_storage;
+        const uint8_t *m_data;
+
+        /// The size of the memory buffer in bytes
+        uint64_t m_size;
 
     };
 
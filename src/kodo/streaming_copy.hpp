@@ -0,0 +1,98 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    #define KODO_STREAMING_COPY_X86
+    #include <emmintrin.h>
+    #include <xmmintrin.h>
+#endif
+
+namespace kodo
+{
+
+    /// The distance in bytes by which streaming_copy() prefetches the
+    /// source by default
+    const uint32_t streaming_prefetch_distance = 512;
+
+    /// Copies a buffer whose destination is not read again soon, e.g. a
+    /// decoded block copied out of a decoder. On x86-64 the destination
+    /// is written with non-temporal stores, which bypass the caches, and
+    /// the source is prefetched with the non-temporal hint, so the copy
+    /// does not evict the working sets of the other coders on the core.
+    /// The stores are fenced before returning, so the data is visible
+    /// to other threads like after a normal copy. Elsewhere this is a
+    /// normal copy.
+    /// @param dest The destination buffer
+    /// @param src The source buffer
+    /// @param size The number of bytes to copy
+    /// @param prefetch_distance How far ahead of the copy the source is
+    ///        prefetched in bytes, zero disables the prefetching, e.g.
+    ///        to leave the memory bandwidth to other threads
+    inline void streaming_copy(
+        uint8_t *dest, const uint8_t *src, uint64_t size,
+        uint32_t prefetch_distance = streaming_prefetch_distance)
+    {
+        assert(size == 0 || dest != 0);
+        assert(size == 0 || src != 0);
+
+#if defined(KODO_STREAMING_COPY_X86)
+        // Streaming a small copy costs more than the cache lines saved
+        if(size < 256)
+        {
+            std::copy_n(src, size, dest);
+            return;
+        }
+
+        // Copy up to the first 16 byte aligned destination byte
+        uint64_t head = (16 - (reinterpret_cast<uintptr_t>(dest) & 15)) & 15;
+        std::copy_n(src, head, dest);
+
+        dest += head;
+        src += head;
+        size -= head;
+
+        uint64_t blocks = size / 64;
+
+        for(uint64_t i = 0; i < blocks; ++i)
+        {
+            if(prefetch_distance > 0)
+            {
+                _mm_prefetch(reinterpret_cast<const char*>(
+                    src + prefetch_distance), _MM_HINT_NTA);
+            }
+
+            const __m128i *in = reinterpret_cast<const __m128i*>(src);
+            __m128i *out = reinterpret_cast<__m128i*>(dest);
+
+            __m128i a = _mm_loadu_si128(in);
+            __m128i b = _mm_loadu_si128(in + 1);
+            __m128i c = _mm_loadu_si128(in + 2);
+            __m128i d = _mm_loadu_si128(in + 3);
+
+            _mm_stream_si128(out, a);
+            _mm_stream_si128(out + 1, b);
+            _mm_stream_si128(out + 2, c);
+            _mm_stream_si128(out + 3, d);
+
+            dest += 64;
+            src += 64;
+        }
+
+        _mm_sfence();
+
+        std::copy_n(src, size % 64, dest);
+#else
+        (void) prefetch_distance;
+        std::copy_n(src, size, dest);
+#endif
+    }
+
+}
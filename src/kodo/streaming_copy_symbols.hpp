@@ -0,0 +1,89 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <sak/storage.hpp>
+
+#include "streaming_copy.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup symbol_storage_layers
+    /// @brief Copies the symbols out of the storage with
+    ///        streaming_copy(), i.e. non-temporal stores.
+    ///
+    /// A decoder copies its decoded block out once, into a buffer it
+    /// never reads again, so a normal copy of a multi-MB block only
+    /// evicts the working sets of the other decoders on the core. The
+    /// layer is placed above the symbol storage, any of the storage
+    /// layers providing layer::symbol(uint32_t) const. Symbols adjacent
+    /// in memory, as in the deep_symbol_storage, are copied in one run.
+    template<class SuperCoder>
+    class streaming_copy_symbols : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::copy_symbols(const sak::mutable_storage&)
+        void copy_symbols(const sak::mutable_storage &dest) const
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            uint32_t size = std::min(dest.m_size, SuperCoder::block_size());
+            uint32_t symbol_size = SuperCoder::symbol_size();
+
+            uint8_t *out = dest.m_data;
+
+            // The current run of symbols which are adjacent in memory
+            const uint8_t *run = SuperCoder::symbol(0);
+            uint32_t run_size = 0;
+
+            for(uint32_t i = 0; size > 0; ++i)
+            {
+                const uint8_t *symbol = SuperCoder::symbol(i);
+                assert(symbol != 0);
+
+                uint32_t symbol_bytes = std::min(size, symbol_size);
+
+                if(symbol != run + run_size)
+                {
+                    streaming_copy(out, run, run_size);
+
+                    out += run_size;
+                    run = symbol;
+                    run_size = 0;
+                }
+
+                run_size += symbol_bytes;
+                size -= symbol_bytes;
+            }
+
+            streaming_copy(out, run, run_size);
+        }
+
+        /// @copydoc layer::copy_symbol(uint32_t,
+        ///                             const sak::mutable_storage&)
+        void copy_symbol(uint32_t index,
+                         const sak::mutable_storage &dest) const
+        {
+            assert(dest.m_size > 0);
+            assert(dest.m_data != 0);
+
+            const uint8_t *symbol = SuperCoder::symbol(index);
+            assert(symbol != 0);
+
+            streaming_copy(dest.m_data, symbol,
+                           std::min(dest.m_size, SuperCoder::symbol_size()));
+        }
+
+    };
+
+}
@@ -0,0 +1,178 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#ifndef KODO_STRIPE_PARTITIONING_SCHEME_HPP
+#define KODO_STRIPE_PARTITIONING_SCHEME_HPP
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace kodo
+{
+
+    /// @ingroup block_partitioning_implementation
+    /// @brief Block partitioning scheme where every block has the
+    ///        maximum number of symbols and the maximum symbol size.
+    ///
+    /// Used when the symbols of the blocks are stored in shards, where
+    /// symbol i of every block (stripe) goes to shard i. The last block
+    /// is padded with zeros, i.e. its bytes_used() is smaller than its
+    /// block_size().
+    class stripe_partitioning_scheme
+    {
+    public:
+
+        /// Create an uninitialized partitioning scheme
+        stripe_partitioning_scheme();
+
+        /// Constructor
+        /// @param max_symbols the number of symbols in a block
+        /// @param max_symbol_size the size in bytes of a symbol
+        /// @param object_size the size in bytes of the whole object
+        stripe_partitioning_scheme(uint32_t max_symbols,
+                                   uint32_t max_symbol_size,
+                                   uint64_t object_size);
+
+        /// @copydoc block_partitioning::symbols(uint32_t) const
+        uint32_t symbols(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::symbol_size(uint32_t) const
+        uint32_t symbol_size(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::block_size(uint32_t) const
+        uint32_t block_size(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::bytes_offset(uint32_t) const
+        uint64_t byte_offset(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::bytes_used(uint32_t) const
+        uint32_t bytes_used(uint32_t block_id) const;
+
+        /// @copydoc block_partitioning::blocks() const
+        uint32_t blocks() const;
+
+        /// @copydoc block_partitioning::object_size() const
+        uint64_t object_size() const;
+
+        /// @copydoc block_partitioning::total_symbols() const
+        uint32_t total_symbols() const;
+
+        /// @copydoc block_partitioning::total_block_size() const
+        uint64_t total_block_size() const;
+
+    private:
+
+        /// The number of symbols per block
+        uint32_t m_max_symbols;
+
+        /// The size of a symbol in bytes
+        uint32_t m_max_symbol_size;
+
+        /// The size of the object in bytes
+        uint64_t m_object_size;
+
+        /// The total number of blocks in the object
+        uint32_t m_total_blocks;
+    };
+
+    inline stripe_partitioning_scheme::stripe_partitioning_scheme()
+        : m_max_symbols(0),
+          m_max_symbol_size(0),
+          m_object_size(0),
+          m_total_blocks(0)
+    { }
+
+    inline stripe_partitioning_scheme::stripe_partitioning_scheme(
+        uint32_t max_symbols,
+        uint32_t max_symbol_size,
+        uint64_t object_size)
+        : m_max_symbols(max_symbols),
+          m_max_symbol_size(max_symbol_size),
+          m_object_size(object_size)
+    {
+        assert(m_max_symbols > 0);
+        assert(m_max_symbol_size > 0);
+        assert(m_object_size > 0);
+
+        uint32_t max_block_size = m_max_symbols * m_max_symbol_size;
+
+        // ceil(x/y) = ((x - 1) / y) + 1
+        m_total_blocks = static_cast<uint32_t>(
+            ((m_object_size - 1) / max_block_size) + 1);
+    }
+
+    inline uint32_t
+    stripe_partitioning_scheme::symbols(uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+        (void) block_id;
+
+        return m_max_symbols;
+    }
+
+    inline uint32_t
+    stripe_partitioning_scheme::symbol_size(uint32_t /*block_id*/) const
+    {
+        return m_max_symbol_size;
+    }
+
+    inline uint32_t
+    stripe_partitioning_scheme::block_size(uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+        return symbols(block_id) * symbol_size(block_id);
+    }
+
+    inline uint64_t
+    stripe_partitioning_scheme::byte_offset(uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+        return uint64_t(block_id) * m_max_symbols * m_max_symbol_size;
+    }
+
+    inline uint32_t
+    stripe_partitioning_scheme::bytes_used(uint32_t block_id) const
+    {
+        assert(block_id < m_total_blocks);
+
+        uint64_t offset = byte_offset(block_id);
+
+        assert(offset < m_object_size);
+        uint64_t remaining = m_object_size - offset;
+
+        return static_cast<uint32_t>(
+            std::min<uint64_t>(remaining, block_size(block_id)));
+    }
+
+    inline uint32_t
+    stripe_partitioning_scheme::blocks() const
+    {
+        assert(m_total_blocks > 0);
+        return m_total_blocks;
+    }
+
+    inline uint64_t
+    stripe_partitioning_scheme::object_size() const
+    {
+        assert(m_object_size > 0);
+        return m_object_size;
+    }
+
+    inline uint32_t
+    stripe_partitioning_scheme::total_symbols() const
+    {
+        return m_total_blocks * m_max_symbols;
+    }
+
+    inline uint64_t
+    stripe_partitioning_scheme::total_block_size() const
+    {
+        return uint64_t(total_symbols()) * m_max_symbol_size;
+    }
+
+}
+
+#endif
@@ -0,0 +1,416 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <fifi/arithmetics.hpp>
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include "block_executor.hpp"
+#include "finite_field_math.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup finite_field_layers
+    /// @brief Finite field layer splitting the operations on large
+    ///        symbols into stripes processed on the threads of a
+    ///        block_executor.
+    ///
+    /// Operations on buffers of at least two stripes are divided into
+    /// stripes of the stripe size, 64 kB by default, which are
+    /// processed in parallel. Stripe i is always queued at the same
+    /// worker, so the byte ranges of the symbols touched by a worker
+    /// stay in the caches of its core from one operation to the next.
+    /// Shorter buffers, in particular the coefficient vectors, are
+    /// processed on the calling thread. Every stripe uses its own part
+    /// of the temporary symbol of the finite_field_math layer.
+    ///
+    /// Without an executor, or with an executor of a single thread,
+    /// the layer is the finite_field_math layer. The executor must not
+    /// be the one running the coder, since the runs of an executor
+    /// cannot be nested. The layer is a drop-in replacement for the
+    /// finite_field_math layer.
+    template<class FieldImpl, class SuperCoder>
+    class striped_finite_field_math
+        : public finite_field_math<FieldImpl, SuperCoder>
+    {
+    public:
+
+        /// The layer we extend
+        typedef finite_field_math<FieldImpl, SuperCoder> Super;
+
+        /// @copydoc layer::field_type
+        typedef typename Super::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename Super::value_type value_type;
+
+        /// The default size of a stripe in bytes
+        static const uint32_t default_stripe_size = 65536;
+
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer holding the executor and stripe size used
+        /// by the coders it builds
+        class factory : public Super::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : Super::factory(max_symbols, max_symbol_size),
+                  m_stripe_executor(0),
+                  m_stripe_size(default_stripe_size)
+            { }
+
+            /// Sets the executor processing the stripes of the coders
+            /// built after this call
+            /// @param executor The executor, or null for processing the
+            ///        operations on the calling thread
+            void set_stripe_executor(block_executor *executor)
+            {
+                m_stripe_executor = executor;
+            }
+
+            /// @return The executor processing the stripes or null if
+            ///         none is set
+            block_executor* stripe_executor() const
+            {
+                return m_stripe_executor;
+            }
+
+            /// Sets the stripe size of the coders built after this call
+            /// @param stripe_size The size of a stripe in bytes
+            void set_stripe_size(uint32_t stripe_size)
+            {
+                assert(stripe_size > 0);
+                m_stripe_size = stripe_size;
+            }
+
+            /// @return The size of a stripe in bytes
+            uint32_t stripe_size() const
+            {
+                return m_stripe_size;
+            }
+
+        protected:
+
+            /// The executor processing the stripes
+            block_executor *m_stripe_executor;
+
+            /// The size of a stripe in bytes
+            uint32_t m_stripe_size;
+        };
+
+    public:
+
+        /// Constructor
+        striped_finite_field_math()
+            : m_stripe_executor(0),
+              m_stripe_length(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            Super::initialize(the_factory);
+
+            m_stripe_executor = the_factory.stripe_executor();
+            m_stripe_length = std::max<uint32_t>(
+                1U, fifi::size_to_length<field_type>(
+                    the_factory.stripe_size()));
+        }
+
+        /// @copydoc layer::multiply(value_type*,value_type,uint32_t)
+        void multiply(value_type *symbol_dest, value_type coefficient,
+                      uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::multiply(symbol_dest, coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    fifi::multiply_constant(*Super::m_field, coefficient,
+                                            symbol_dest + offset, length);
+                });
+        }
+
+        /// @copydoc layer::multipy_add(value_type *, const value_type*,
+        ///                             value_type, uint32_t)
+        void multiply_add(value_type *symbol_dest,
+                          const value_type *symbol_src,
+                          value_type coefficient, uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::multiply_add(symbol_dest, symbol_src, coefficient,
+                                    symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    fifi::multiply_add(*Super::m_field, coefficient,
+                                       symbol_dest + offset,
+                                       symbol_src + offset,
+                                       Super::temp_symbol(length),
+                                       length);
+                });
+        }
+
+        /// @copydoc layer::multiply_subtract(value_type*, const value_type*,
+        ///                                   value_type, uint32_t)
+        void multiply_subtract(value_type *symbol_dest,
+                               const value_type *symbol_src,
+                               value_type coefficient,
+                               uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::multiply_subtract(symbol_dest, symbol_src,
+                                         coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+            assert(symbol_dest != symbol_src);
+
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    fifi::multiply_subtract(*Super::m_field, coefficient,
+                                            symbol_dest + offset,
+                                            symbol_src + offset,
+                                            Super::temp_symbol(length),
+                                            length);
+                });
+        }
+
+        /// @copydoc layer::multiply_copy(value_type*, const value_type*,
+        ///                              value_type, uint32_t)
+        void multiply_copy(value_type *symbol_dest,
+                           const value_type *symbol_src,
+                           value_type coefficient, uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::multiply_copy(symbol_dest, symbol_src,
+                                     coefficient, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    Super::multiply_copy(symbol_dest + offset,
+                                         symbol_src + offset,
+                                         coefficient, length);
+                });
+        }
+
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(value_type *symbol_dest,
+                                  const value_type **symbols_src,
+                                  const value_type *coefficients,
+                                  uint32_t sources, uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::multiply_add_sources(symbol_dest, symbols_src,
+                                            coefficients, sources,
+                                            symbol_length);
+                return;
+            }
+
+            stripe_sources(symbol_dest, symbols_src, coefficients,
+                           sources, symbol_length, false);
+        }
+
+        /// @copydoc layer::multiply_sources(value_type*,
+        ///                                 const value_type**,
+        ///                                 const value_type*,
+        ///                                 uint32_t, uint32_t)
+        void multiply_sources(value_type *symbol_dest,
+                              const value_type **symbols_src,
+                              const value_type *coefficients,
+                              uint32_t sources, uint32_t symbol_length)
+        {
+            if(sources == 0 || !is_striped(symbol_length))
+            {
+                Super::multiply_sources(symbol_dest, symbols_src,
+                                        coefficients, sources,
+                                        symbol_length);
+                return;
+            }
+
+            stripe_sources(symbol_dest, symbols_src, coefficients,
+                           sources, symbol_length, true);
+        }
+
+        /// @copydoc layer::add(value_type*, const value_type *, uint32_t)
+        void add(value_type *symbol_dest, const value_type *symbol_src,
+                 uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::add(symbol_dest, symbol_src, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    fifi::add(*Super::m_field, symbol_dest + offset,
+                              symbol_src + offset, length);
+                });
+        }
+
+        /// @copydoc layer::subtract(value_type*,const value_type*, uint32_t)
+        void subtract(value_type *symbol_dest, const value_type *symbol_src,
+                      uint32_t symbol_length)
+        {
+            if(!is_striped(symbol_length))
+            {
+                Super::subtract(symbol_dest, symbol_src, symbol_length);
+                return;
+            }
+
+            assert(symbol_dest != 0);
+            assert(symbol_src != 0);
+
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    fifi::subtract(*Super::m_field, symbol_dest + offset,
+                                   symbol_src + offset, length);
+                });
+        }
+
+        /// @param symbol_length The length of a buffer
+        /// @return True if an operation on the buffer is split into
+        ///         stripes
+        bool is_striped(uint32_t symbol_length) const
+        {
+            return m_stripe_executor != 0 &&
+                m_stripe_executor->threads() > 1 &&
+                symbol_length >= 2 * m_stripe_length;
+        }
+
+    protected:
+
+        /// Implements multiply_add_sources() and multiply_sources() for
+        /// striped buffers
+        /// @param symbol_dest The destination symbol
+        /// @param symbols_src The source symbols
+        /// @param coefficients The coefficients of the sources
+        /// @param sources The number of sources
+        /// @param symbol_length The length of the symbols
+        /// @param copy_first If true the first source is copied to the
+        ///        destination instead of added to it
+        void stripe_sources(value_type *symbol_dest,
+                            const value_type **symbols_src,
+                            const value_type *coefficients,
+                            uint32_t sources, uint32_t symbol_length,
+                            bool copy_first)
+        {
+            assert(symbol_dest != 0);
+            assert(symbols_src != 0);
+            assert(coefficients != 0);
+
+            const uint32_t tile_length =
+                std::max<uint32_t>(1U, Super::tile_size / sizeof(value_type));
+
+            // Within a stripe the destination is processed in tiles as
+            // done by the finite_field_math layer
+            run_stripes(symbol_length, [&](uint32_t offset, uint32_t length)
+                {
+                    uint32_t end = offset + length;
+
+                    for(uint32_t o = offset; o < end; o += tile_length)
+                    {
+                        uint32_t l = std::min(tile_length, end - o);
+
+                        for(uint32_t i = 0; i < sources; ++i)
+                        {
+                            assert(symbols_src[i] != 0);
+
+                            if(copy_first && i == 0)
+                            {
+                                Super::multiply_copy(
+                                    symbol_dest + o, symbols_src[i] + o,
+                                    coefficients[i], l);
+                            }
+                            else if(fifi::is_binary<field_type>::value)
+                            {
+                                fifi::add(*Super::m_field, symbol_dest + o,
+                                          symbols_src[i] + o, l);
+                            }
+                            else
+                            {
+                                fifi::multiply_add(
+                                    *Super::m_field, coefficients[i],
+                                    symbol_dest + o, symbols_src[i] + o,
+                                    Super::temp_symbol(l), l);
+                            }
+                        }
+                    }
+                });
+        }
+
+        /// Runs a function for every stripe of a buffer on the executor
+        /// @param symbol_length The length of the buffer
+        /// @param function The function invoked with the offset and
+        ///        length of a stripe
+        template<class Function>
+        void run_stripes(uint32_t symbol_length, const Function &function)
+        {
+            assert(m_stripe_executor);
+            assert(m_stripe_length > 0);
+
+            uint32_t stripes =
+                (symbol_length + m_stripe_length - 1) / m_stripe_length;
+
+            m_stripe_executor->run(stripes, [&](uint32_t stripe)
+                {
+                    uint32_t offset = stripe * m_stripe_length;
+
+                    function(offset, std::min(m_stripe_length,
+                                              symbol_length - offset));
+                });
+        }
+
+    protected:
+
+        /// The executor processing the stripes
+        block_executor *m_stripe_executor;
+
+        /// The length of a stripe in field elements
+        uint32_t m_stripe_length;
+
+    };
+
+}
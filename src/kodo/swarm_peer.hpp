@@ -0,0 +1,363 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/storage.hpp>
+
+#include "block_id_header.hpp"
+#include "object_decoder.hpp"
+#include "rfc5052_partitioning_scheme.hpp"
+
+namespace kodo
+{
+
+    /// @brief A peer of a swarm cooperatively downloading an object.
+    ///
+    /// The peer decodes the payloads of the origin, an
+    /// interleaved_object_encoder, and of the other peers, and serves
+    /// recoded payloads of its partially decoded blocks to the other
+    /// peers. Every payload starts with the id of its block, as in the
+    /// payloads of the interleaved_object_encoder. The origin only needs
+    /// to send every symbol once to some peer, the peers spread the
+    /// symbols among themselves, so the capacity of the swarm grows with
+    /// the number of peers instead of being limited by the origin.
+    ///
+    /// The peers exchange compact feedback, the pivot bitmaps of all
+    /// their blocks, see pivot_feedback_writer. From the feedback of a
+    /// neighbour a peer computes how many of its pivots the neighbour
+    /// is missing, which is used to select the neighbour to download
+    /// from, available_symbols(), and the block to serve,
+    /// serve(). A pivot the neighbour is missing does not guarantee that
+    /// a recoded symbol is innovative for it, but a block where it has
+    /// all the pivots of the peer is never served.
+    ///
+    /// The DecoderType must provide recode() and write_feedback(), e.g.
+    /// the feedback_full_rlnc_decoder. The decoders of all blocks are
+    /// kept while the peer lives, so it keeps serving after it is
+    /// complete.
+    template
+    <
+        class DecoderType,
+        class BlockPartitioning = rfc5052_partitioning_scheme
+    >
+    class swarm_peer : boost::noncopyable
+    {
+    public:
+
+        /// The type of factory used to build decoders
+        typedef typename DecoderType::factory factory;
+
+        /// Pointer to a decoder
+        typedef typename DecoderType::pointer pointer;
+
+        /// The object decoder building the block decoders
+        typedef object_decoder<DecoderType, BlockPartitioning>
+            object_decoder_type;
+
+    public:
+
+        /// Constructs a new peer and builds the decoders of all blocks
+        /// @param decoder_factory The decoder factory to use
+        /// @param object_size The size in bytes of the object
+        swarm_peer(factory &decoder_factory, uint64_t object_size)
+            : m_object_decoder(decoder_factory, object_size),
+              m_payload_size(0),
+              m_feedback_size(0),
+              m_next_block(0)
+        {
+            uint32_t blocks = m_object_decoder.decoders();
+
+            m_id_size = block_id_size(blocks);
+
+            m_decoders.resize(blocks);
+            m_feedback_offsets.resize(blocks);
+
+            for(uint32_t i = 0; i < blocks; ++i)
+            {
+                m_decoders[i] = m_object_decoder.build(i);
+
+                m_payload_size = std::max(
+                    m_payload_size, m_decoders[i]->payload_size());
+
+                m_feedback_offsets[i] = m_feedback_size;
+                m_feedback_size += m_decoders[i]->feedback_size();
+            }
+        }
+
+        /// @return The number of blocks of the object
+        uint32_t blocks() const
+        {
+            return static_cast<uint32_t>(m_decoders.size());
+        }
+
+        /// @return The size in bytes of the block id of a payload
+        uint32_t id_size() const
+        {
+            return m_id_size;
+        }
+
+        /// @return The size of the largest payload including the block id
+        uint32_t payload_size() const
+        {
+            return m_id_size + m_payload_size;
+        }
+
+        /// @return The size in bytes of the feedback of the peer
+        uint32_t feedback_size() const
+        {
+            return m_feedback_size;
+        }
+
+        /// @return The decoder of a block
+        /// @param block_id The block
+        pointer decoder(uint32_t block_id) const
+        {
+            assert(block_id < blocks());
+            return m_decoders[block_id];
+        }
+
+        /// @return True if all blocks of the object are decoded
+        bool is_complete() const
+        {
+            for(const auto& d : m_decoders)
+            {
+                if(!d->is_complete())
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// @return The sum of the ranks of the blocks
+        uint32_t rank() const
+        {
+            uint32_t rank = 0;
+
+            for(const auto& d : m_decoders)
+            {
+                rank += d->rank();
+            }
+
+            return rank;
+        }
+
+        /// Decodes a payload of the origin or of another peer
+        /// @param payload The payload, which is modified by the decoder
+        /// @return The block id of the payload
+        uint32_t decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            uint32_t block_id = read_block_id(m_id_size, payload);
+            assert(block_id < blocks());
+
+            m_decoders[block_id]->decode(payload + m_id_size);
+            return block_id;
+        }
+
+        /// Writes the feedback of the peer, the pivot bitmaps of the
+        /// blocks one after the other
+        /// @param feedback The buffer of at least feedback_size() bytes
+        /// @return The number of bytes written
+        uint32_t write_feedback(uint8_t *feedback) const
+        {
+            assert(feedback != 0);
+
+            for(uint32_t i = 0; i < blocks(); ++i)
+            {
+                m_decoders[i]->write_feedback(
+                    feedback + m_feedback_offsets[i]);
+            }
+
+            return m_feedback_size;
+        }
+
+        /// @param feedback The feedback of another peer
+        /// @return The number of pivots of the peer the other peer is
+        ///         missing, i.e. how much the peer can serve it
+        uint32_t missing_symbols(const uint8_t *feedback) const
+        {
+            assert(feedback != 0);
+
+            uint32_t missing = 0;
+
+            for(uint32_t i = 0; i < blocks(); ++i)
+            {
+                missing += missing_block_symbols(i, feedback);
+            }
+
+            return missing;
+        }
+
+        /// @param feedback The feedback of another peer
+        /// @return The number of pivots of the other peer this peer is
+        ///         missing, i.e. how much the other peer can serve it.
+        ///         The neighbour with the most available symbols is the
+        ///         best to download from.
+        uint32_t available_symbols(const uint8_t *feedback) const
+        {
+            assert(feedback != 0);
+
+            uint32_t available = 0;
+
+            for(uint32_t i = 0; i < blocks(); ++i)
+            {
+                const uint8_t *bitmap = feedback + m_feedback_offsets[i];
+                const pointer &d = m_decoders[i];
+
+                for(uint32_t j = 0; j < d->symbols(); ++j)
+                {
+                    if(has_pivot(bitmap, j) && !d->symbol_pivot(j))
+                        ++available;
+                }
+            }
+
+            return available;
+        }
+
+        /// Recodes a payload for another peer from the block where the
+        /// other peer is missing the most pivots, the blocks with equal
+        /// counts are served in turn
+        /// @param feedback The feedback of the other peer
+        /// @param payload The buffer of at least payload_size() bytes
+        /// @return The number of bytes used, zero if the peer has no
+        ///         pivot the other peer is missing
+        uint32_t serve(const uint8_t *feedback, uint8_t *payload)
+        {
+            assert(feedback != 0);
+            assert(payload != 0);
+
+            uint32_t best = 0;
+            uint32_t best_missing = 0;
+
+            for(uint32_t n = 0; n < blocks(); ++n)
+            {
+                uint32_t i = (m_next_block + n) % blocks();
+                uint32_t missing = missing_block_symbols(i, feedback);
+
+                if(missing > best_missing)
+                {
+                    best = i;
+                    best_missing = missing;
+                }
+            }
+
+            if(best_missing == 0)
+                return 0;
+
+            m_next_block = (best + 1) % blocks();
+
+            return serve_block(best, payload);
+        }
+
+        /// Recodes a payload of a block
+        /// @param block_id The block, its rank must be non-zero
+        /// @param payload The buffer of at least payload_size() bytes
+        /// @return The number of bytes used
+        uint32_t serve_block(uint32_t block_id, uint8_t *payload)
+        {
+            assert(block_id < blocks());
+            assert(payload != 0);
+
+            const pointer &d = m_decoders[block_id];
+            assert(d->rank() > 0);
+
+            write_block_id(block_id, m_id_size, payload);
+            d->recode(payload + m_id_size);
+
+            return m_id_size + d->payload_size();
+        }
+
+        /// Copies the decoded object
+        /// @param object The buffer of object_size() bytes
+        void copy_object(const sak::mutable_storage &object) const
+        {
+            assert(object.m_size == m_object_decoder.object_size());
+
+            uint32_t offset = 0;
+
+            for(const auto& d : m_decoders)
+            {
+                uint32_t bytes = d->bytes_used();
+
+                d->copy_symbols(
+                    sak::storage(object.m_data + offset, bytes));
+
+                offset += bytes;
+            }
+
+            assert(offset == object.m_size);
+        }
+
+        /// @return The size in bytes of the object
+        uint64_t object_size() const
+        {
+            return m_object_decoder.object_size();
+        }
+
+    private:
+
+        /// @param bitmap The pivot bitmap of a block
+        /// @param index The index of a symbol
+        /// @return True if the bitmap holds a pivot for the symbol
+        static bool has_pivot(const uint8_t *bitmap, uint32_t index)
+        {
+            return (bitmap[index / 8] >> (index % 8)) & 1U;
+        }
+
+        /// @param block_id The block
+        /// @param feedback The feedback of another peer
+        /// @return The number of pivots of the block the other peer is
+        ///         missing
+        uint32_t missing_block_symbols(uint32_t block_id,
+                                       const uint8_t *feedback) const
+        {
+            const uint8_t *bitmap = feedback + m_feedback_offsets[block_id];
+            const pointer &d = m_decoders[block_id];
+
+            uint32_t missing = 0;
+
+            for(uint32_t j = 0; j < d->symbols(); ++j)
+            {
+                if(d->symbol_pivot(j) && !has_pivot(bitmap, j))
+                    ++missing;
+            }
+
+            return missing;
+        }
+
+    private:
+
+        /// The object decoder building the block decoders
+        object_decoder_type m_object_decoder;
+
+        /// The decoders of the blocks
+        std::vector<pointer> m_decoders;
+
+        /// The offset of the pivot bitmap of every block in the feedback
+        std::vector<uint32_t> m_feedback_offsets;
+
+        /// The size of the block id
+        uint32_t m_id_size;
+
+        /// The size of the largest block payload
+        uint32_t m_payload_size;
+
+        /// The size of the feedback
+        uint32_t m_feedback_size;
+
+        /// The first block considered by the next serve()
+        uint32_t m_next_block;
+    };
+
+}
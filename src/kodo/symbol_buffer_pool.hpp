@@ -0,0 +1,130 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/aligned_allocator.hpp>
+
+namespace kodo
+{
+
+    /// @brief Pool of fixed size buffers exchanged between a receiver
+    ///        and the decoders adopting the received buffers.
+    ///
+    /// The receiver acquires a buffer, receives a payload into it and
+    /// hands it to a decoder using the adopting_symbol_storage, see
+    /// adopting_payload_decoder::decode_adopt(). The decoder keeps the
+    /// buffer as a symbol and hands back the buffer it displaced, which
+    /// the receiver releases or receives the next payload into. The
+    /// buffers are allocated on demand, aligned, and only freed with the
+    /// pool, so a running receiver and decoder do not allocate.
+    ///
+    /// The pool is not thread-safe, the receiver and the decoders must
+    /// use it from the same thread.
+    class symbol_buffer_pool : boost::noncopyable
+    {
+    public:
+
+        /// Constructs a new pool
+        /// @param buffer_size The size of the buffers in bytes, e.g.
+        ///        layer::factory::max_payload_size() of the decoders
+        symbol_buffer_pool(uint32_t buffer_size)
+            : m_buffer_size(buffer_size),
+              m_external(0)
+        {
+            assert(m_buffer_size > 0);
+        }
+
+        /// @return The size of the buffers in bytes
+        uint32_t buffer_size() const
+        {
+            return m_buffer_size;
+        }
+
+        /// @return A buffer of buffer_size() bytes, its content is
+        ///         undefined
+        uint8_t* acquire()
+        {
+            if(m_free.empty())
+            {
+                m_buffers.push_back(aligned_vector(m_buffer_size));
+                return &m_buffers.back()[0];
+            }
+
+            uint8_t *buffer = m_free.back();
+            m_free.pop_back();
+
+            return buffer;
+        }
+
+        /// Adds a buffer owned by the caller, e.g. a frame of a NIC
+        /// ring, so the decoders adopt and hand back buffers of the ring
+        /// instead of buffers allocated by the pool. The buffer must
+        /// outlive the pool.
+        /// @param buffer A buffer of at least buffer_size() bytes
+        void add_buffer(uint8_t *buffer)
+        {
+            assert(buffer != 0);
+
+            m_free.push_back(buffer);
+            ++m_external;
+        }
+
+        /// Returns a buffer to the pool
+        /// @param buffer A buffer acquired from the pool
+        void release(uint8_t *buffer)
+        {
+            assert(buffer != 0);
+            assert(m_free.size() < m_buffers.size() + m_external);
+
+            m_free.push_back(buffer);
+        }
+
+        /// @return The number of buffers allocated by the pool
+        uint32_t buffers() const
+        {
+            return static_cast<uint32_t>(m_buffers.size());
+        }
+
+        /// @return The number of buffers added by add_buffer()
+        uint32_t external_buffers() const
+        {
+            return m_external;
+        }
+
+        /// @return The number of buffers in the pool which are not
+        ///         acquired
+        uint32_t free_buffers() const
+        {
+            return static_cast<uint32_t>(m_free.size());
+        }
+
+    private:
+
+        /// The storage type of a buffer
+        typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
+            aligned_vector;
+
+        /// The size of the buffers
+        uint32_t m_buffer_size;
+
+        /// The buffers allocated by the pool, moving a buffer does not
+        /// move its data
+        std::vector<aligned_vector> m_buffers;
+
+        /// The buffers not acquired
+        std::vector<uint8_t*> m_free;
+
+        /// The number of buffers added by the caller
+        uint32_t m_external;
+    };
+
+}
@@ -0,0 +1,246 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Tracks which symbols are fully decoded and allows a
+    ///        callback function to be invoked as soon as a symbol
+    ///        becomes available.
+    ///
+    /// A symbol is decoded when the coefficient vector stored for its
+    /// pivot is the unit vector, i.e. when the data is the original
+    /// source symbol. With the linear_block_decoder this happens before
+    /// the full rank is reached, e.g. for uncoded symbols or when the
+    /// coded symbols do not depend on the missing symbols. This allows
+    /// the application to consume decoded symbols, e.g. an in-order
+    /// prefix of the block, before the decoding is complete.
+    ///
+    /// The layer must be placed above the codec layer and requires the
+    /// coefficient storage API.
+    template<class SuperCoder>
+    class symbol_decoded_callback_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// The symbol decoded callback function. The callback is invoked
+        /// once for every symbol when it becomes decoded and provides
+        /// the index of the symbol
+        typedef std::function<void (uint32_t)> symbol_decoded_callback;
+
+    public:
+
+        /// Constructor
+        symbol_decoded_callback_decoder()
+            : m_callback_func(nullptr)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_decoded.resize(the_factory.max_symbols(), false);
+            m_new_decoded.reserve(the_factory.max_symbols());
+        }
+
+        /// Reset the decoded symbols and the callback function
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill(m_decoded.begin(), m_decoded.end(), false);
+            m_symbols_decoded = 0;
+            m_decoded_prefix = 0;
+
+            m_callback_func = nullptr;
+        }
+
+        /// Invoke the symbol decoded callback for the new symbols
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *coefficients)
+        {
+            uint32_t rank = SuperCoder::rank();
+
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+
+            if(rank < SuperCoder::rank())
+            {
+                update_decoded();
+            }
+        }
+
+        /// Invoke the symbol decoded callback for the new symbol
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            uint32_t rank = SuperCoder::rank();
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(rank < SuperCoder::rank())
+            {
+                update_decoded();
+            }
+        }
+
+        /// @param index The index of a symbol
+        /// @return true if the symbol is fully decoded
+        bool is_symbol_decoded(uint32_t index) const
+        {
+            assert(index < SuperCoder::symbols());
+            return m_decoded[index];
+        }
+
+        /// @return The number of fully decoded symbols
+        uint32_t symbols_decoded() const
+        {
+            return m_symbols_decoded;
+        }
+
+        /// @return The number of symbols from the start of the block
+        ///         which are all fully decoded, i.e. symbols 0 to
+        ///         decoded_prefix() - 1 may be consumed
+        uint32_t decoded_prefix() const
+        {
+            return m_decoded_prefix;
+        }
+
+        /// Set symbol decoded callback function
+        /// @param callback symbol decoded callback function
+        void set_symbol_decoded_callback(
+            const symbol_decoded_callback &callback)
+        {
+            assert(callback);
+
+            m_callback_func = callback;
+        }
+
+        /// Reset symbol decoded callback function
+        void reset_symbol_decoded_callback()
+        {
+            m_callback_func = nullptr;
+        }
+
+    private:
+
+        /// Finds the symbols which became decoded, updates the prefix
+        /// and invokes the callback function for them in order of the
+        /// symbol index
+        void update_decoded()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            m_new_decoded.clear();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(m_decoded[i] || !is_unit_vector(i))
+                {
+                    continue;
+                }
+
+                m_decoded[i] = true;
+                m_new_decoded.push_back(i);
+                ++m_symbols_decoded;
+            }
+
+            while(m_decoded_prefix < symbols && m_decoded[m_decoded_prefix])
+            {
+                ++m_decoded_prefix;
+            }
+
+            if(!m_callback_func)
+            {
+                return;
+            }
+
+            // The callback is invoked after the state is updated, so it
+            // may query the layer
+            for(uint32_t index : m_new_decoded)
+            {
+                m_callback_func(index);
+            }
+        }
+
+        /// @param index The pivot index
+        /// @return true if the symbol at the pivot index is decoded
+        bool is_unit_vector(uint32_t index) const
+        {
+            if(!SuperCoder::symbol_pivot(index))
+            {
+                return false;
+            }
+
+            if(!SuperCoder::symbol_coded(index))
+            {
+                return true;
+            }
+
+            // The elimination keeps the pivot columns of the other rows
+            // zero, so only the non-pivot columns needs to be checked
+            const value_type *coefficients =
+                SuperCoder::coefficients_value(index);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t j = 0; j < symbols; ++j)
+            {
+                if(j == index || SuperCoder::symbol_pivot(j))
+                {
+                    continue;
+                }
+
+                if(fifi::get_value<field_type>(coefficients, j))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+
+        /// Symbol decoded callback function
+        symbol_decoded_callback m_callback_func;
+
+        /// Tracks which symbols are decoded
+        std::vector<bool> m_decoded;
+
+        /// The symbols decoded by the latest decode_symbol() call
+        std::vector<uint32_t> m_new_decoded;
+
+        /// The number of decoded symbols
+        uint32_t m_symbols_decoded;
+
+        /// The length of the decoded prefix
+        uint32_t m_decoded_prefix;
+
+    };
+
+}
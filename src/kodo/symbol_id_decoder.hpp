@@ -62,6 +62,13 @@ namespace kodo
             return SuperCoder::id_size();
         }
 
+        /// @return The offset of the symbol id in the header of a coded
+        ///         symbol, the id is written at the start of the header
+        uint32_t symbol_id_offset() const
+        {
+            return 0;
+        }
+
     };
 
 }
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
+
 #include <sak/convert_endian.hpp>
 
 #include "systematic_base_coder.hpp"
@@ -93,6 +95,39 @@ namespace kodo
             return SuperCoder::header_size() +
                 sizeof(flag_type) + sizeof(counter_type);
         }
+
+        /// Reads the systematic flag of a symbol header without decoding
+        /// the symbol
+        /// @param symbol_header The symbol header
+        /// @param symbol_index Set to the index of the symbol if it is
+        ///        systematic
+        /// @return true if the symbol is systematic
+        bool read_systematic_index(const uint8_t *symbol_header,
+                                   uint32_t *symbol_index) const
+        {
+            assert(symbol_header != 0);
+            assert(symbol_index != 0);
+
+            flag_type flag =
+                sak::big_endian::get<flag_type>(symbol_header);
+
+            if(flag != systematic_base_coder::systematic_flag)
+            {
+                return false;
+            }
+
+            *symbol_index = sak::big_endian::get<counter_type>(
+                symbol_header + sizeof(flag_type));
+
+            return true;
+        }
+
+        /// @return The offset of the symbol id in the header of a coded
+        ///         symbol, which follows the systematic flag
+        uint32_t symbol_id_offset() const
+        {
+            return SuperCoder::symbol_id_offset() + sizeof(flag_type);
+        }
     };
 
 }
@@ -14,6 +14,7 @@
 
 #include "systematic_base_coder.hpp"
 #include "systematic_operations.hpp"
+#include "snapshot.hpp"
 
 namespace kodo
 {
@@ -110,6 +111,41 @@ namespace kodo
             }
         }
 
+        /// Encodes a symbol without copying systematic symbols
+        /// @copydoc payload_encoder::encode_in_place(
+        ///     uint8_t*,uint8_t*,const uint8_t**)
+        uint32_t encode_in_place(uint8_t *symbol_data,
+                                 uint8_t *symbol_header,
+                                 const uint8_t **symbol_reference)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_header != 0);
+            assert(symbol_reference != 0);
+
+            bool in_systematic_phase =
+                m_systematic_count < SuperCoder::rank();
+
+            if(m_systematic && in_systematic_phase)
+            {
+                uint32_t header_bytes =
+                    write_systematic_header(symbol_header);
+
+                *symbol_reference =
+                    SuperCoder::encode_symbol_in_place(m_systematic_count);
+
+                ++m_systematic_count;
+
+                return header_bytes;
+            }
+            else
+            {
+                *symbol_reference = symbol_data;
+
+                return encode_non_systematic(symbol_data,
+                                             symbol_header);
+            }
+        }
+
         /// @return, true if the encoder is in systematic mode
         bool is_systematic_on() const
         {
@@ -135,6 +171,13 @@ namespace kodo
                 sizeof(flag_type) + sizeof(counter_type);
         }
 
+        /// @return The offset of the symbol id in the header of a coded
+        ///         symbol, which follows the systematic flag
+        uint32_t symbol_id_offset() const
+        {
+            return SuperCoder::symbol_id_offset() + sizeof(flag_type);
+        }
+
         /// @return The number of systematically encoded packets produced
         ///         by this encoder
         void systematic_count()
@@ -142,6 +185,37 @@ namespace kodo
             return m_systematic_count;
         }
 
+        /// @copydoc layer::snapshot_size() const
+        uint32_t snapshot_size() const
+        {
+            return SuperCoder::snapshot_size() +
+                sizeof(uint8_t) + sizeof(uint32_t);
+        }
+
+        /// @copydoc layer::write_snapshot(uint8_t*) const
+        uint8_t* write_snapshot(uint8_t *buffer) const
+        {
+            buffer = SuperCoder::write_snapshot(buffer);
+            buffer = write_snapshot_value<uint8_t>(m_systematic, buffer);
+            return write_snapshot_value(m_systematic_count, buffer);
+        }
+
+        /// @copydoc layer::read_snapshot(const uint8_t*)
+        const uint8_t* read_snapshot(const uint8_t *buffer)
+        {
+            buffer = SuperCoder::read_snapshot(buffer);
+            if(buffer == 0)
+            {
+                return 0;
+            }
+
+            uint8_t systematic = 0;
+            buffer = read_snapshot_value(buffer, systematic);
+            m_systematic = systematic != 0;
+
+            return read_snapshot_value(buffer, m_systematic_count);
+        }
+
 
     protected:
 
@@ -153,6 +227,22 @@ namespace kodo
             assert(symbol_data != 0);
             assert(symbol_header != 0);
 
+            uint32_t header_bytes = write_systematic_header(symbol_header);
+
+            SuperCoder::encode_symbol(symbol_data, m_systematic_count);
+
+            ++m_systematic_count;
+
+            return header_bytes;
+        }
+
+        /// Writes the header of the next systematic packet
+        /// @param symbol_header The buffer for the symbol header
+        /// @return The number of bytes used in the symbol header
+        uint32_t write_systematic_header(uint8_t *symbol_header)
+        {
+            assert(symbol_header != 0);
+
             /// Flag systematic packet
             sak::big_endian::put<flag_type>(
                 systematic_base_coder::systematic_flag, symbol_header);
@@ -161,10 +251,6 @@ namespace kodo
             sak::big_endian::put<counter_type>(
                 m_systematic_count, symbol_header + sizeof(flag_type));
 
-            SuperCoder::encode_symbol(symbol_data, m_systematic_count);
-
-            ++m_systematic_count;
-
             return sizeof(flag_type) + sizeof(counter_type);
         }
 
@@ -0,0 +1,122 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "decoder_telemetry.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Counts the received, non-innovative and swap decoded
+    ///        symbols of a decoder.
+    ///
+    /// The counters are kept for the current generation and reset when
+    /// the decoder is initialized, telemetry() returns them as a
+    /// decoder_telemetry snapshot. The bytes of the finite field
+    /// operations are read from the operations_profile, so the layer
+    /// must be placed above the linear_block_decoder in a stack
+    /// containing the finite_field_counter layer.
+    template<class SuperCoder>
+    class telemetry_decoder : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_telemetry = decoder_telemetry();
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            uint32_t rank = SuperCoder::rank();
+            uint64_t bytes = SuperCoder::get_operations_profile().bytes();
+
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+
+            ++m_telemetry.m_coded;
+            update_telemetry(rank, bytes);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            uint32_t rank = SuperCoder::rank();
+            uint64_t bytes = SuperCoder::get_operations_profile().bytes();
+
+            // The linear_block_decoder swaps a coded symbol at the pivot
+            // out and decodes it again
+            if(SuperCoder::symbol_pivot(symbol_index) &&
+               SuperCoder::symbol_coded(symbol_index))
+            {
+                ++m_telemetry.m_swap_decodes;
+            }
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            ++m_telemetry.m_systematic;
+            update_telemetry(rank, bytes);
+        }
+
+        /// @return The counters of the current generation
+        decoder_telemetry telemetry() const
+        {
+            return m_telemetry;
+        }
+
+        /// Resets the counters of the current generation
+        void reset_telemetry()
+        {
+            m_telemetry = decoder_telemetry();
+        }
+
+    private:
+
+        /// Updates the counters after a symbol was decoded
+        /// @param old_rank The rank before the symbol was decoded
+        /// @param old_bytes The bytes processed before the symbol was
+        ///        decoded
+        void update_telemetry(uint32_t old_rank, uint64_t old_bytes)
+        {
+            uint64_t bytes = SuperCoder::get_operations_profile().bytes();
+
+            assert(bytes >= old_bytes);
+            uint64_t used = bytes - old_bytes;
+
+            ++m_telemetry.m_received;
+            m_telemetry.m_bytes += used;
+
+            if(SuperCoder::rank() == old_rank)
+            {
+                ++m_telemetry.m_non_innovative;
+                m_telemetry.m_non_innovative_bytes += used;
+            }
+        }
+
+    private:
+
+        /// The counters of the current generation
+        decoder_telemetry m_telemetry;
+
+    };
+
+}
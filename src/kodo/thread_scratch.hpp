@@ -0,0 +1,76 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <sak/aligned_allocator.hpp>
+
+namespace kodo
+{
+
+    /// @brief Scratch memory of the calling thread, shared by all the
+    ///        coders used on the thread.
+    ///
+    /// Layers which need a buffer only during a single call, e.g. for
+    /// the intermediate products of the finite field operations, take
+    /// it from here instead of allocating it per coder, so an idle
+    /// coder only holds its actual state. Every Tag selects a separate
+    /// buffer, so a layer holding a buffer while calling the layers
+    /// below does not share it with them. The buffer grows to the
+    /// largest size requested on the thread and is never shrunk.
+    template<class Tag>
+    class thread_scratch
+    {
+    public:
+
+        /// @param size The number of bytes needed
+        /// @return The buffer of the calling thread and tag, which is
+        ///         aligned to 16 bytes and valid until the next call
+        ///         with the same tag on the thread
+        static uint8_t* data(uint32_t size)
+        {
+            buffer_type &buffer = storage();
+
+            if(buffer.size() < size)
+            {
+                buffer.resize(size);
+            }
+
+            return buffer.data();
+        }
+
+        /// @param length The number of values needed
+        /// @return The buffer as an array of values, see data(uint32_t)
+        template<class ValueType>
+        static ValueType* values(uint32_t length)
+        {
+            return reinterpret_cast<ValueType*>(
+                data(length * sizeof(ValueType)));
+        }
+
+        /// @return The size in bytes of the buffer of the calling thread
+        static uint32_t size()
+        {
+            return static_cast<uint32_t>(storage().size());
+        }
+
+    private:
+
+        /// The type of the buffer
+        typedef std::vector<uint8_t, sak::aligned_allocator<uint8_t> >
+            buffer_type;
+
+        /// @return The buffer of the calling thread
+        static buffer_type& storage()
+        {
+            static thread_local buffer_type buffer;
+            return buffer;
+        }
+    };
+
+}
@@ -0,0 +1,113 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "payload_trace.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup payload_codec_layers
+    ///
+    /// @brief Records the payloads passed to the decoder in a payload
+    ///        trace, see payload_trace_writer.
+    ///
+    /// Every initialize() records a new generation and every decode()
+    /// records the payload before it is decoded, since the decoders
+    /// below may modify it. Placed below the payload_batch_decoder the
+    /// payloads of a batch are recorded in the order they are decoded.
+    /// The trace captures the arrival order, the duplicates and the
+    /// mix of systematic, coded and recoded payloads seen by a decoder
+    /// or recoder in production, and can be replayed into any stack
+    /// reading the same payload format with the replay benchmark.
+    ///
+    /// No trace is recorded if no writer is set on the factory, so the
+    /// layer costs a branch per payload when capturing is off.
+    template<class SuperCoder>
+    class trace_capture_decoder : public SuperCoder
+    {
+    public:
+
+        /// @ingroup factory_layers
+        /// The factory layer holding the trace writer
+        class factory : public SuperCoder::factory
+        {
+        public:
+
+            /// @copydoc layer::factory::factory(uint32_t,uint32_t)
+            factory(uint32_t max_symbols, uint32_t max_symbol_size)
+                : SuperCoder::factory(max_symbols, max_symbol_size),
+                  m_trace_writer(0)
+            { }
+
+            /// Sets the writer of the coders initialized after this call
+            /// @param writer The writer, must outlive the coders, or null
+            ///        for not recording a trace
+            void set_trace_writer(payload_trace_writer *writer)
+            {
+                m_trace_writer = writer;
+            }
+
+            /// @return The trace writer or null if none is set
+            payload_trace_writer* trace_writer() const
+            {
+                return m_trace_writer;
+            }
+
+        protected:
+
+            /// The trace writer
+            payload_trace_writer *m_trace_writer;
+
+        };
+
+    public:
+
+        /// Constructor
+        trace_capture_decoder()
+            : m_trace_writer(0)
+        { }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_trace_writer = the_factory.trace_writer();
+
+            if(m_trace_writer)
+            {
+                m_trace_writer->write_generation(
+                    SuperCoder::symbols(), SuperCoder::symbol_size());
+            }
+        }
+
+        /// @copydoc layer::decode(uint8_t*)
+        void decode(uint8_t *payload)
+        {
+            assert(payload != 0);
+
+            if(m_trace_writer)
+            {
+                m_trace_writer->write_payload(
+                    payload, SuperCoder::payload_size());
+            }
+
+            SuperCoder::decode(payload);
+        }
+
+    protected:
+
+        /// The trace writer or null if none is set
+        payload_trace_writer *m_trace_writer;
+
+    };
+
+}
@@ -0,0 +1,197 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include "trace_ring.hpp"
+
+namespace kodo
+{
+
+    /// @ingroup codec_layers
+    /// @brief Records binary trace events of the decoding in the
+    ///        trace_ring of the calling thread.
+    ///
+    /// Unlike the debug layers, which print the decoder state to a
+    /// stream, the layer only stores a 16 byte event with a time stamp
+    /// per event in a lock-free ring, so it can stay enabled under
+    /// load. A collector thread drains the rings with
+    /// trace_collector::drain() and writes them to a trace file, which
+    /// is inspected offline with the decode_trace example.
+    ///
+    /// Every symbol records a received event followed by either a
+    /// pivot_found or a non_innovative event, uncoded symbols replacing
+    /// a coded symbol also record a swap_decode event. The layer must
+    /// be placed above the linear_block_decoder, the decoders are told
+    /// apart by the id set with set_trace_id().
+    template<class SuperCoder>
+    class trace_decoder : public SuperCoder
+    {
+    public:
+
+        /// Constructor
+        trace_decoder()
+            : m_trace_id(0)
+        { }
+
+        /// @copydoc layer::construct(Factory&)
+        template<class Factory>
+        void construct(Factory &the_factory)
+        {
+            SuperCoder::construct(the_factory);
+
+            m_pivots.resize(the_factory.max_symbols(), false);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            std::fill(m_pivots.begin(), m_pivots.end(), false);
+            m_trace_id = 0;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint8_t *coefficients)
+        {
+            assert(symbol_data != 0);
+            assert(coefficients != 0);
+
+            trace_ring &ring = trace_collector::thread_ring();
+            uint32_t rank = SuperCoder::rank();
+
+            ring.record(trace_event_type::received, m_trace_id, rank);
+
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+
+            if(rank == SuperCoder::rank())
+            {
+                ring.record(trace_event_type::non_innovative,
+                            m_trace_id, rank);
+                return;
+            }
+
+            ring.record(trace_event_type::pivot_found, m_trace_id,
+                        find_new_pivot());
+
+            record_complete(ring);
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint32_t)
+        void decode_symbol(uint8_t *symbol_data,
+                           uint32_t symbol_index)
+        {
+            assert(symbol_data != 0);
+            assert(symbol_index < SuperCoder::symbols());
+
+            trace_ring &ring = trace_collector::thread_ring();
+            uint32_t rank = SuperCoder::rank();
+
+            ring.record(trace_event_type::received, m_trace_id, rank);
+
+            // The linear_block_decoder swaps a coded symbol at the pivot
+            // out and decodes it again
+            bool swap = SuperCoder::symbol_pivot(symbol_index) &&
+                SuperCoder::symbol_coded(symbol_index);
+
+            SuperCoder::decode_symbol(symbol_data, symbol_index);
+
+            if(swap)
+            {
+                ring.record(trace_event_type::swap_decode, m_trace_id,
+                            symbol_index);
+            }
+
+            if(rank == SuperCoder::rank())
+            {
+                ring.record(trace_event_type::non_innovative,
+                            m_trace_id, rank);
+                return;
+            }
+
+            // A swapped out symbol is decoded again and may find a new
+            // pivot, otherwise the pivot is the index of the symbol
+            uint32_t pivot = symbol_index;
+
+            if(swap)
+            {
+                pivot = find_new_pivot();
+            }
+            else
+            {
+                m_pivots[symbol_index] = true;
+            }
+
+            ring.record(trace_event_type::pivot_found, m_trace_id, pivot);
+
+            record_complete(ring);
+        }
+
+        /// Sets the id recorded in the events of the decoder, the id is
+        /// reset to zero when the decoder is initialized
+        /// @param trace_id The id
+        void set_trace_id(uint32_t trace_id)
+        {
+            m_trace_id = trace_id;
+        }
+
+        /// @return The id recorded in the events of the decoder
+        uint32_t trace_id() const
+        {
+            return m_trace_id;
+        }
+
+    private:
+
+        /// Records the complete event if the decoder reached full rank
+        /// @param ring The ring of the calling thread
+        void record_complete(trace_ring &ring)
+        {
+            if(SuperCoder::is_complete())
+            {
+                ring.record(trace_event_type::complete, m_trace_id,
+                            SuperCoder::rank());
+            }
+        }
+
+        /// @return The pivot found by the latest symbol. Only the pivot
+        ///         flags are read, which is cheap compared to the
+        ///         elimination which found the pivot.
+        uint32_t find_new_pivot()
+        {
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(SuperCoder::symbol_pivot(i) && !m_pivots[i])
+                {
+                    m_pivots[i] = true;
+                    return i;
+                }
+            }
+
+            assert(0 && "The rank increased without a new pivot");
+            return symbols;
+        }
+
+    private:
+
+        /// The id recorded in the events
+        uint32_t m_trace_id;
+
+        /// The pivots recorded in the events
+        std::vector<bool> m_pivots;
+
+    };
+
+}
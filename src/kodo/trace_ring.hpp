@@ -0,0 +1,414 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <atomic>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "cycle_counter.hpp"
+
+namespace kodo
+{
+
+    /// The events recorded by the trace_decoder
+    enum class trace_event_type : uint8_t
+    {
+        /// A symbol was passed to the decoder, the value is the rank
+        /// before the symbol was decoded
+        received,
+
+        /// The symbol increased the rank, the value is the pivot of the
+        /// symbol
+        pivot_found,
+
+        /// The symbol did not increase the rank, the value is the rank
+        non_innovative,
+
+        /// An uncoded symbol replaced a coded symbol at its pivot, which
+        /// is decoded again, the value is the pivot
+        swap_decode,
+
+        /// The decoder reached full rank, the value is the rank
+        complete
+    };
+
+    /// A binary trace event of 16 bytes
+    struct trace_event
+    {
+        /// The time stamp counter when the event was recorded, see
+        /// read_cycle_counter()
+        uint64_t m_timestamp;
+
+        /// The trace id of the decoder
+        uint32_t m_coder;
+
+        /// The rank or pivot, depending on the type
+        uint16_t m_value;
+
+        /// The trace_event_type
+        uint8_t m_type;
+
+        /// Unused, keeps the size of the event fixed
+        uint8_t m_reserved;
+    };
+
+    static_assert(sizeof(trace_event) == 16,
+                  "The trace events are written to files as is");
+
+    /// @brief Lock-free single-producer/single-consumer ring of trace
+    ///        events.
+    ///
+    /// The thread decoding writes the events and a collector thread
+    /// drains them, see trace_collector. Recording an event is a
+    /// couple of stores and never blocks: if the ring is full the event
+    /// is dropped and counted, so tracing cannot slow down the decoding
+    /// beyond the cost of the stores.
+    class trace_ring : boost::noncopyable
+    {
+    public:
+
+        /// The size of a cache line in bytes
+        static const uint32_t cache_line_size = 64;
+
+    public:
+
+        /// Constructs a new ring
+        /// @param events The minimum number of events, rounded up to a
+        ///        power of two
+        trace_ring(uint32_t events)
+        {
+            assert(events > 0);
+
+            uint32_t capacity = 1;
+            while(capacity < events)
+            {
+                capacity *= 2;
+            }
+
+            m_mask = capacity - 1;
+            m_events.resize(capacity);
+
+            m_producer.m_position.store(0, std::memory_order_relaxed);
+            m_producer.m_cached = 0;
+            m_consumer.m_position.store(0, std::memory_order_relaxed);
+            m_consumer.m_cached = 0;
+
+            m_dropped.store(0, std::memory_order_relaxed);
+        }
+
+        /// @return The number of events the ring holds
+        uint32_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+        /// Producer: records an event, or drops it if the ring is full
+        /// @param type The type of the event
+        /// @param coder The trace id of the decoder
+        /// @param value The rank or pivot
+        void record(trace_event_type type, uint32_t coder, uint32_t value)
+        {
+            uint32_t position =
+                m_producer.m_position.load(std::memory_order_relaxed);
+
+            // Only read the position of the consumer if the cached
+            // value says the ring is full
+            if(position - m_producer.m_cached > m_mask)
+            {
+                m_producer.m_cached =
+                    m_consumer.m_position.load(std::memory_order_acquire);
+
+                if(position - m_producer.m_cached > m_mask)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            trace_event &event = m_events[position & m_mask];
+            event.m_timestamp = read_cycle_counter();
+            event.m_coder = coder;
+            event.m_value = static_cast<uint16_t>(value);
+            event.m_type = static_cast<uint8_t>(type);
+            event.m_reserved = 0;
+
+            m_producer.m_position.store(
+                position + 1, std::memory_order_release);
+        }
+
+        /// Consumer: moves the recorded events to a buffer
+        /// @param events The buffer the events are appended to
+        /// @return The number of events moved
+        uint32_t drain(std::vector<trace_event> &events)
+        {
+            uint32_t position =
+                m_consumer.m_position.load(std::memory_order_relaxed);
+
+            m_consumer.m_cached =
+                m_producer.m_position.load(std::memory_order_acquire);
+
+            uint32_t count = m_consumer.m_cached - position;
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                events.push_back(m_events[(position + i) & m_mask]);
+            }
+
+            m_consumer.m_position.store(
+                position + count, std::memory_order_release);
+
+            return count;
+        }
+
+        /// @return The number of events dropped since the ring was full
+        uint64_t dropped() const
+        {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+
+        /// The position of one side of the ring, and the last seen
+        /// position of the other side, on a cache line of its own
+        struct side
+        {
+            /// The number of events written (producer) or read
+            /// (consumer)
+            std::atomic<uint32_t> m_position;
+
+            /// The last position seen of the other side, only used by
+            /// the owning thread
+            uint32_t m_cached;
+
+            /// Keeps the other side off this cache line
+            uint8_t m_padding[cache_line_size -
+                              sizeof(std::atomic<uint32_t>) -
+                              sizeof(uint32_t)];
+        };
+
+        /// Mask selecting the event of a position
+        uint32_t m_mask;
+
+        /// The events
+        std::vector<trace_event> m_events;
+
+        /// Keeps the positions off the cache lines of the members above,
+        /// which are only read after construction
+        uint8_t m_padding[cache_line_size];
+
+        /// The producer position
+        side m_producer;
+
+        /// The consumer position
+        side m_consumer;
+
+        /// The number of dropped events
+        std::atomic<uint64_t> m_dropped;
+
+    };
+
+    /// @brief Gives every thread its own trace_ring and drains the rings
+    ///        of all threads.
+    ///
+    /// A thread registers its ring the first time it records an event,
+    /// which is the only time the collector lock is taken by the
+    /// decoding threads. The rings are kept until the process exits, so
+    /// the events of finished threads are not lost.
+    class trace_collector
+    {
+    public:
+
+        /// The default number of events in the ring of a thread
+        static const uint32_t default_ring_events = 1 << 16;
+
+    public:
+
+        /// @return The ring of the calling thread
+        static trace_ring& thread_ring()
+        {
+            static thread_local trace_ring *ring = register_ring();
+            return *ring;
+        }
+
+        /// Moves the events of all threads to a buffer. The events of
+        /// each thread are in order, the threads are not merged.
+        /// @param events The buffer the events are appended to
+        /// @return The number of events moved
+        static uint32_t drain(std::vector<trace_event> &events)
+        {
+            state &s = instance();
+            std::lock_guard<std::mutex> lock(s.m_mutex);
+
+            uint32_t count = 0;
+
+            for(const auto &ring : s.m_rings)
+            {
+                count += ring->drain(events);
+            }
+
+            return count;
+        }
+
+        /// @return The number of events dropped by all threads
+        static uint64_t dropped()
+        {
+            state &s = instance();
+            std::lock_guard<std::mutex> lock(s.m_mutex);
+
+            uint64_t count = 0;
+
+            for(const auto &ring : s.m_rings)
+            {
+                count += ring->dropped();
+            }
+
+            return count;
+        }
+
+        /// Sets the number of events in the rings of the threads which
+        /// have not recorded any event yet
+        /// @param events The number of events
+        static void set_ring_events(uint32_t events)
+        {
+            assert(events > 0);
+
+            state &s = instance();
+            std::lock_guard<std::mutex> lock(s.m_mutex);
+
+            s.m_ring_events = events;
+        }
+
+    private:
+
+        /// The rings of all threads
+        struct state
+        {
+            state()
+                : m_ring_events(default_ring_events)
+            { }
+
+            /// Protects the members
+            std::mutex m_mutex;
+
+            /// The rings
+            std::vector<std::unique_ptr<trace_ring> > m_rings;
+
+            /// The number of events of new rings
+            uint32_t m_ring_events;
+        };
+
+        /// @return The state shared by all threads
+        static state& instance()
+        {
+            static state s;
+            return s;
+        }
+
+        /// @return A new ring for the calling thread
+        static trace_ring* register_ring()
+        {
+            state &s = instance();
+            std::lock_guard<std::mutex> lock(s.m_mutex);
+
+            s.m_rings.push_back(std::unique_ptr<trace_ring>(
+                new trace_ring(s.m_ring_events)));
+
+            return s.m_rings.back().get();
+        }
+
+    };
+
+    /// The header of a trace file, followed by the events
+    struct trace_file_header
+    {
+        /// Identifies a trace file
+        char m_magic[4];
+
+        /// The version of the format
+        uint32_t m_version;
+
+        /// The rate of the time stamps, see cycle_counter_ticks_per_ns()
+        double m_ticks_per_ns;
+
+        /// The number of events dropped when the file was written
+        uint64_t m_dropped;
+    };
+
+    /// The magic bytes of a trace file
+    static const char trace_file_magic[4] = { 'K', 'T', 'R', 'C' };
+
+    /// The version of the trace file format
+    static const uint32_t trace_file_version = 1;
+
+    /// Writes the header of a trace file. The events are then appended
+    /// as they are drained, using write_trace_events().
+    /// @param out The stream opened in binary mode
+    /// @param ticks_per_ns The rate of the time stamps
+    /// @param dropped The number of dropped events
+    inline void write_trace_header(std::ostream &out, double ticks_per_ns,
+                                   uint64_t dropped = 0)
+    {
+        trace_file_header header;
+        std::memcpy(header.m_magic, trace_file_magic, sizeof(header.m_magic));
+        header.m_version = trace_file_version;
+        header.m_ticks_per_ns = ticks_per_ns;
+        header.m_dropped = dropped;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    /// Appends events to a trace file
+    /// @param out The stream opened in binary mode
+    /// @param events The events
+    inline void write_trace_events(std::ostream &out,
+                                   const std::vector<trace_event> &events)
+    {
+        if(events.empty())
+        {
+            return;
+        }
+
+        out.write(reinterpret_cast<const char*>(&events[0]),
+                  events.size() * sizeof(trace_event));
+    }
+
+    /// Reads a trace file
+    /// @param in The stream opened in binary mode
+    /// @param header The header read
+    /// @param events The buffer the events are appended to
+    /// @return false if the stream is not a trace file
+    inline bool read_trace(std::istream &in, trace_file_header &header,
+                           std::vector<trace_event> &events)
+    {
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if(!in || std::memcmp(header.m_magic, trace_file_magic,
+                              sizeof(header.m_magic)) != 0 ||
+           header.m_version != trace_file_version)
+        {
+            return false;
+        }
+
+        trace_event event;
+
+        while(in.read(reinterpret_cast<char*>(&event), sizeof(event)))
+        {
+            events.push_back(event);
+        }
+
+        return true;
+    }
+
+}
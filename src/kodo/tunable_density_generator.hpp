@@ -0,0 +1,215 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Raises the density of a sparse generator as the rank of
+    ///        the receiver approaches the number of symbols.
+    ///
+    /// A sparse coded symbol is cheap to encode and decode, but once
+    /// the receiver misses only a few symbols it is unlikely to
+    /// combine any of them and is then often non-innovative. The layer
+    /// sets the density before each generated vector so the expected
+    /// number of non-zero coefficients among the k - r symbols the
+    /// receiver is missing stays at a target, i.e.
+    ///
+    ///   density = max(base, min(1 - 1/q, target / (k - r)))
+    ///
+    /// where r is the estimated rank of the receiver and q the field
+    /// size. The density 1 - 1/q is that of a uniformly random vector,
+    /// denser vectors are not more likely to be innovative and e.g. in
+    /// the binary field the density 1 always gives the same vector.
+    /// Early on the base density is used, and only the last coded
+    /// symbols of a generation become dense, so the average number of
+    /// non-zero coefficients grows with target * ln(k) rather than
+    /// with k.
+    ///
+    /// The rank is estimated from the number of symbols encoded, which
+    /// requires the encode_symbol_tracker layer below, scaled with the
+    /// expected erasure rate of the link. A rank reported by the
+    /// receiver, e.g. as part of its feedback, replaces the estimate.
+    ///
+    /// The layer is placed directly above a coefficient generator with
+    /// a set_density(double) function, e.g. the
+    /// sparse_uniform_generator or the sparse_geometric_generator.
+    template<class SuperCoder>
+    class tunable_density_generator : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+    public:
+
+        /// Constructor
+        tunable_density_generator()
+            : m_base_density(0.5),
+              m_target_nonzeros(4.0),
+              m_erasure_rate(0.0),
+              m_receiver_rank(0),
+              m_rank_encoded(0),
+              m_density(0.5)
+        {
+            SuperCoder::set_density(m_base_density);
+        }
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+
+            m_receiver_rank = 0;
+            m_rank_encoded = 0;
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            update_density();
+            SuperCoder::generate(coefficients);
+        }
+
+        /// @copydoc layer::generate_partial(uint8_t*)
+        void generate_partial(uint8_t *coefficients)
+        {
+            update_density();
+            SuperCoder::generate_partial(coefficients);
+        }
+
+        /// Sets the density used while the receiver misses many
+        /// symbols
+        /// @param density The base density
+        void set_density(double density)
+        {
+            assert(density > 0);
+            assert(density <= 1.0);
+
+            m_base_density = density;
+        }
+
+        /// @return The base density
+        double get_density() const
+        {
+            return m_base_density;
+        }
+
+        /// Sets the expected number of non-zero coefficients among the
+        /// symbols the receiver is missing, higher values lower the
+        /// number of non-innovative symbols near the end of a
+        /// generation at the cost of denser vectors
+        /// @param target The expected number of non-zero coefficients
+        void set_target_nonzeros(double target)
+        {
+            assert(target > 0);
+            m_target_nonzeros = target;
+        }
+
+        /// @return The expected number of non-zero coefficients among
+        ///         the missing symbols
+        double target_nonzeros() const
+        {
+            return m_target_nonzeros;
+        }
+
+        /// Sets the expected fraction of encoded symbols lost on the
+        /// way to the receiver
+        /// @param erasure_rate The erasure rate in [0, 1)
+        void set_erasure_rate(double erasure_rate)
+        {
+            assert(erasure_rate >= 0.0);
+            assert(erasure_rate < 1.0);
+
+            m_erasure_rate = erasure_rate;
+        }
+
+        /// Sets the rank reported by the receiver, the symbols encoded
+        /// from now on are added to it
+        /// @param rank The rank of the receiver
+        void set_receiver_rank(uint32_t rank)
+        {
+            assert(rank <= SuperCoder::symbols());
+
+            m_receiver_rank = rank;
+            m_rank_encoded = SuperCoder::encode_symbol_count();
+        }
+
+        /// @return The estimated rank of the receiver
+        double receiver_rank() const
+        {
+            uint32_t encoded =
+                SuperCoder::encode_symbol_count() - m_rank_encoded;
+
+            double rank = m_receiver_rank + encoded * (1.0 - m_erasure_rate);
+            return std::min(rank, double(SuperCoder::symbols()));
+        }
+
+        /// @return The density used for the last generated vector
+        double current_density() const
+        {
+            return m_density;
+        }
+
+        /// @return The density of a uniformly random vector, which is
+        ///         used when the receiver misses few symbols
+        static double max_density()
+        {
+            return 1.0 - 1.0 / double(field_type::order);
+        }
+
+    protected:
+
+        /// Sets the density of the generator from the estimated rank
+        void update_density()
+        {
+            // At least one symbol is assumed missing, since the
+            // estimate may be ahead of the receiver
+            double missing = std::max(
+                1.0, double(SuperCoder::symbols()) - receiver_rank());
+
+            double density = std::max(
+                m_base_density,
+                std::min(max_density(), m_target_nonzeros / missing));
+
+            if(density != m_density)
+            {
+                m_density = density;
+                SuperCoder::set_density(density);
+            }
+        }
+
+    protected:
+
+        /// The density used while many symbols are missing
+        double m_base_density;
+
+        /// The expected number of non-zero coefficients among the
+        /// missing symbols
+        double m_target_nonzeros;
+
+        /// The expected erasure rate of the link
+        double m_erasure_rate;
+
+        /// The rank last reported by the receiver
+        uint32_t m_receiver_rank;
+
+        /// The number of symbols encoded when the rank was reported
+        uint32_t m_rank_encoded;
+
+        /// The density set on the generator
+        double m_density;
+
+    };
+
+}
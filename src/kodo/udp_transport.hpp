@@ -0,0 +1,495 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <sak/convert_endian.hpp>
+
+namespace kodo
+{
+
+    /// @brief The wire format used by the udp_sender and udp_receiver.
+    ///
+    /// Every datagram carries one payload, zero padded to the
+    /// payload_size() of the coder, followed by the block id:
+    ///
+    /// @code
+    ///   +---------------------------------+------------+
+    ///   |   payload (payload_size bytes)  |  block id  |
+    ///   +---------------------------------+------------+
+    /// @endcode
+    ///
+    /// The block id is placed last so the symbol data keeps the
+    /// alignment of the receive buffer. Padding the payloads gives all
+    /// datagrams of a block the same size, which is required for UDP
+    /// segmentation offload.
+    struct udp_datagram
+    {
+        /// The type of the block id
+        typedef uint32_t block_id_type;
+
+        /// @param payload_size The payload size of the coder
+        /// @return The size in bytes of a datagram
+        static uint32_t size(uint32_t payload_size)
+        {
+            return payload_size + sizeof(block_id_type);
+        }
+    };
+
+    /// @brief Sends the payloads of encoders in batches on a connected
+    ///        UDP socket (Linux).
+    ///
+    /// Sending one datagram per sendto() call makes the system call the
+    /// bottleneck at high rates. The udp_sender encodes a batch of
+    /// payloads into one buffer and passes them to the kernel in a
+    /// single sendmmsg() call. If segmentation offload is enabled the
+    /// batch is passed as one large buffer which the kernel, or the
+    /// network card, splits into datagrams (UDP_SEGMENT).
+    ///
+    /// The socket is owned by the caller and must be connected.
+    class udp_sender : boost::noncopyable
+    {
+    public:
+
+        /// The maximum number of segments in one UDP_SEGMENT buffer
+        static const uint32_t max_segments = 64;
+
+        /// The maximum size of one UDP_SEGMENT buffer
+        static const uint32_t max_segment_buffer = 65000;
+
+    public:
+
+        /// Constructs a new sender
+        /// @param socket A connected UDP socket
+        /// @param max_payload_size The maximum payload size of the
+        ///        encoders, see layer::factory::max_payload_size()
+        /// @param batch_size The maximum number of payloads passed to
+        ///        the kernel in one call
+        udp_sender(int socket, uint32_t max_payload_size,
+                   uint32_t batch_size = 64)
+            : m_socket(socket),
+              m_max_payload_size(max_payload_size),
+              m_batch_size(batch_size),
+              m_segmentation(false)
+        {
+            assert(m_socket >= 0);
+            assert(m_max_payload_size > 0);
+            assert(m_batch_size > 0);
+
+            uint32_t datagram_size = udp_datagram::size(max_payload_size);
+
+            m_buffer.resize(m_batch_size * datagram_size);
+            m_iovecs.resize(m_batch_size);
+            m_messages.resize(m_batch_size);
+        }
+
+        /// Enables or disables UDP segmentation offload
+        /// @param enable True to enable segmentation offload
+        /// @return True if segmentation offload is used
+        bool set_segmentation(bool enable)
+        {
+#ifdef UDP_SEGMENT
+            if(enable)
+            {
+                // The option can be queried if the kernel supports it
+                int size = 0;
+                socklen_t length = sizeof(size);
+
+                enable = ::getsockopt(m_socket, SOL_UDP, UDP_SEGMENT,
+                                      &size, &length) == 0;
+            }
+
+            m_segmentation = enable;
+#else
+            (void) enable;
+            m_segmentation = false;
+#endif
+            return m_segmentation;
+        }
+
+        /// @return True if segmentation offload is used
+        bool segmentation() const
+        {
+            return m_segmentation;
+        }
+
+        /// Encodes and sends a number of payloads from an encoder
+        /// @param encoder The encoder
+        /// @param block_id The id of the block, used by the receiver to
+        ///        find the decoder
+        /// @param count The number of payloads to send
+        /// @return The number of payloads sent, less than count if the
+        ///         socket returned an error
+        template<class EncoderPointer>
+        uint32_t send(const EncoderPointer &encoder, uint32_t block_id,
+                      uint32_t count)
+        {
+            assert(encoder);
+            assert(encoder->payload_size() <= m_max_payload_size);
+
+            uint32_t payload_size = encoder->payload_size();
+            uint32_t datagram_size = udp_datagram::size(payload_size);
+            uint32_t batch_size = m_batch_size;
+
+            if(m_segmentation)
+            {
+                batch_size = std::min(batch_size, max_segments);
+                batch_size = std::min(
+                    batch_size, max_segment_buffer / datagram_size);
+                batch_size = std::max(batch_size, 1U);
+            }
+
+            uint32_t sent = 0;
+
+            while(sent < count)
+            {
+                uint32_t batch = std::min(batch_size, count - sent);
+
+                for(uint32_t i = 0; i < batch; ++i)
+                {
+                    uint8_t *datagram = &m_buffer[i * datagram_size];
+
+                    uint32_t used = encoder->encode(datagram);
+                    assert(used <= payload_size);
+
+                    std::fill(datagram + used, datagram + payload_size, 0);
+
+                    sak::big_endian::put<udp_datagram::block_id_type>(
+                        block_id, datagram + payload_size);
+                }
+
+                uint32_t batch_sent = m_segmentation ?
+                    send_segments(batch, datagram_size) :
+                    send_messages(batch, datagram_size);
+
+                sent += batch_sent;
+
+                if(batch_sent < batch)
+                {
+                    break;
+                }
+            }
+
+            return sent;
+        }
+
+        /// Sends payloads from all the encoders of an object encoder
+        /// @param object_encoder The object encoder
+        /// @param count The number of payloads to send per encoder
+        /// @return The number of payloads sent
+        template<class ObjectEncoder>
+        uint32_t send_object(ObjectEncoder &object_encoder, uint32_t count)
+        {
+            uint32_t sent = 0;
+
+            for(uint32_t i = 0; i < object_encoder.encoders(); ++i)
+            {
+                auto encoder = object_encoder.build(i);
+
+                uint32_t block_sent = send(encoder, i, count);
+                sent += block_sent;
+
+                if(block_sent < count)
+                {
+                    break;
+                }
+            }
+
+            return sent;
+        }
+
+    private:
+
+        /// Sends the datagrams in the buffer using sendmmsg()
+        /// @param count The number of datagrams in the buffer
+        /// @param datagram_size The size of the datagrams in bytes
+        /// @return The number of datagrams sent
+        uint32_t send_messages(uint32_t count, uint32_t datagram_size)
+        {
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                m_iovecs[i].iov_base = &m_buffer[i * datagram_size];
+                m_iovecs[i].iov_len = datagram_size;
+
+                std::memset(&m_messages[i], 0, sizeof(mmsghdr));
+                m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+                m_messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            uint32_t sent = 0;
+
+            while(sent < count)
+            {
+                int result = ::sendmmsg(
+                    m_socket, &m_messages[sent], count - sent, 0);
+
+                if(result < 0)
+                {
+                    if(errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    break;
+                }
+
+                sent += static_cast<uint32_t>(result);
+            }
+
+            return sent;
+        }
+
+        /// Sends the datagrams in the buffer as one UDP_SEGMENT buffer
+        /// @param count The number of datagrams in the buffer
+        /// @param datagram_size The size of the datagrams in bytes
+        /// @return The number of datagrams sent
+        uint32_t send_segments(uint32_t count, uint32_t datagram_size)
+        {
+#ifdef UDP_SEGMENT
+            iovec buffer;
+            buffer.iov_base = &m_buffer[0];
+            buffer.iov_len = count * datagram_size;
+
+            uint8_t control[CMSG_SPACE(sizeof(uint16_t))];
+            std::memset(control, 0, sizeof(control));
+
+            msghdr message;
+            std::memset(&message, 0, sizeof(message));
+            message.msg_iov = &buffer;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_UDP;
+            header->cmsg_type = UDP_SEGMENT;
+            header->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+            uint16_t segment_size = static_cast<uint16_t>(datagram_size);
+            std::memcpy(CMSG_DATA(header), &segment_size,
+                        sizeof(segment_size));
+
+            while(true)
+            {
+                ssize_t result = ::sendmsg(m_socket, &message, 0);
+
+                if(result < 0)
+                {
+                    if(errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    return 0;
+                }
+
+                // A datagram socket sends the whole buffer or nothing
+                assert(result == ssize_t(count * datagram_size));
+                return count;
+            }
+#else
+            // set_segmentation() does not enable segmentation offload
+            // without kernel support
+            return send_messages(count, datagram_size);
+#endif
+        }
+
+    private:
+
+        /// The socket
+        int m_socket;
+
+        /// The maximum payload size
+        uint32_t m_max_payload_size;
+
+        /// The maximum number of payloads sent in one call
+        uint32_t m_batch_size;
+
+        /// True if segmentation offload is used
+        bool m_segmentation;
+
+        /// The buffer holding a batch of datagrams
+        std::vector<uint8_t> m_buffer;
+
+        /// The buffers of the messages
+        std::vector<iovec> m_iovecs;
+
+        /// The messages of a batch
+        std::vector<mmsghdr> m_messages;
+
+    };
+
+    /// @brief Receives datagrams sent by a udp_sender in batches and
+    ///        dispatches the payloads by block id (Linux).
+    ///
+    /// A batch of datagrams is received with a single recvmmsg() call
+    /// into a buffer which is reused for every batch. The socket is
+    /// owned by the caller, a receive timeout set on the socket
+    /// (SO_RCVTIMEO) makes receive() return 0 when no data arrives.
+    class udp_receiver : boost::noncopyable
+    {
+    public:
+
+        /// Constructs a new receiver
+        /// @param socket A bound UDP socket
+        /// @param max_payload_size The maximum payload size of the
+        ///        decoders, see layer::factory::max_payload_size()
+        /// @param batch_size The maximum number of datagrams received
+        ///        in one call
+        udp_receiver(int socket, uint32_t max_payload_size,
+                     uint32_t batch_size = 64)
+            : m_socket(socket),
+              m_datagram_size(udp_datagram::size(max_payload_size)),
+              m_batch_size(batch_size)
+        {
+            assert(m_socket >= 0);
+            assert(max_payload_size > 0);
+            assert(m_batch_size > 0);
+
+            m_buffer.resize(m_batch_size * m_datagram_size);
+            m_iovecs.resize(m_batch_size);
+            m_messages.resize(m_batch_size);
+
+            for(uint32_t i = 0; i < m_batch_size; ++i)
+            {
+                m_iovecs[i].iov_base = &m_buffer[i * m_datagram_size];
+                m_iovecs[i].iov_len = m_datagram_size;
+            }
+        }
+
+        /// Receives a batch of datagrams, waits until at least one
+        /// datagram is available
+        /// @param function Invoked as function(block_id, payload, size)
+        ///        for every datagram, where size is the number of bytes
+        ///        of the payload
+        /// @return The number of datagrams received
+        template<class Function>
+        uint32_t receive(const Function &function)
+        {
+            for(uint32_t i = 0; i < m_batch_size; ++i)
+            {
+                std::memset(&m_messages[i], 0, sizeof(mmsghdr));
+                m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+                m_messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int result;
+
+            do
+            {
+                result = ::recvmmsg(m_socket, &m_messages[0], m_batch_size,
+                                    MSG_WAITFORONE, 0);
+            }
+            while(result < 0 && errno == EINTR);
+
+            if(result <= 0)
+            {
+                return 0;
+            }
+
+            uint32_t received = static_cast<uint32_t>(result);
+
+            for(uint32_t i = 0; i < received; ++i)
+            {
+                uint32_t size = m_messages[i].msg_len;
+
+                // Ignore truncated datagrams and datagrams which are
+                // too short to carry a block id
+                if((m_messages[i].msg_hdr.msg_flags & MSG_TRUNC) ||
+                   size <= sizeof(udp_datagram::block_id_type))
+                {
+                    continue;
+                }
+
+                size -= sizeof(udp_datagram::block_id_type);
+
+                uint8_t *payload = &m_buffer[i * m_datagram_size];
+
+                uint32_t block_id =
+                    sak::big_endian::get<udp_datagram::block_id_type>(
+                        payload + size);
+
+                function(block_id, payload, size);
+            }
+
+            return received;
+        }
+
+        /// Receives a batch of datagrams and passes the payloads to the
+        /// decoders of an object decoder. The decoders are built when
+        /// the first payload of a block arrives.
+        /// @param object_decoder The object decoder
+        /// @param decoders The decoders, indexed by block id. Resized
+        ///        to the number of decoders of the object decoder.
+        /// @return The number of datagrams received
+        template<class ObjectDecoder>
+        uint32_t receive(ObjectDecoder &object_decoder,
+                         std::vector<typename ObjectDecoder::pointer>
+                             &decoders)
+        {
+            decoders.resize(object_decoder.decoders());
+
+            return receive([&](uint32_t block_id, uint8_t *payload,
+                               uint32_t size)
+                {
+                    if(block_id >= decoders.size())
+                    {
+                        return;
+                    }
+
+                    auto &decoder = decoders[block_id];
+
+                    if(!decoder)
+                    {
+                        decoder = object_decoder.build(block_id);
+                    }
+
+                    if(decoder->is_complete() ||
+                       size < decoder->payload_size())
+                    {
+                        return;
+                    }
+
+                    decoder->decode(payload);
+                });
+        }
+
+    private:
+
+        /// The socket
+        int m_socket;
+
+        /// The size of the receive buffer of one datagram
+        uint32_t m_datagram_size;
+
+        /// The maximum number of datagrams received in one call
+        uint32_t m_batch_size;
+
+        /// The buffer holding a batch of datagrams
+        std::vector<uint8_t> m_buffer;
+
+        /// The buffers of the messages
+        std::vector<iovec> m_iovecs;
+
+        /// The messages of a batch
+        std::vector<mmsghdr> m_messages;
+
+    };
+
+}
@@ -6,16 +6,29 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
+#include <algorithm>
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
+#include <fifi/is_binary.hpp>
+#include <fifi/fifi_utils.hpp>
+
 namespace kodo
 {
 
     /// @ingroup coefficient_generator_layers
     /// @brief Generates an uniform random coefficient (from the chosen
     /// Finite Field) for every symbol.
+    ///
+    /// The first coefficient vectors of a block may be restricted to the
+    /// binary subfield {0,1}, see set_subfield_vectors(), so encoding
+    /// and decoding them only needs XOR while the symbols still decode
+    /// with any decoder of the field. A binary vector is innovative with
+    /// probability about 1/2 once the receiver misses few symbols, the
+    /// last vectors before the block completes should therefore be of
+    /// the full field.
     template<class SuperCoder>
     class uniform_generator : public SuperCoder
     {
@@ -39,15 +52,43 @@ namespace kodo
         uniform_generator()
             : m_distribution(),
               m_value_distribution(field_type::min_value,
-                                   field_type::max_value)
+                                   field_type::max_value),
+              m_subfield_vectors(0),
+              m_generated(0)
         { }
 
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory& the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_generated = 0;
+        }
+
         /// @copydoc layer::generate(uint8_t*)
         void generate(uint8_t *coefficients)
         {
             assert(coefficients != 0);
 
             uint32_t size = SuperCoder::coefficients_size();
+
+            if(next_is_subfield())
+            {
+                std::fill_n(coefficients, size, 0);
+
+                value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+                for(uint32_t i = 0; i < SuperCoder::symbols(); ++i)
+                {
+                    value_type coefficient =
+                        m_distribution(m_random_generator) & 1;
+
+                    fifi::set_value<field_type>(c, i, coefficient);
+                }
+
+                return;
+            }
+
             for(uint32_t i = 0; i < size; ++i)
             {
                 coefficients[i] = m_distribution(m_random_generator);
@@ -67,6 +108,7 @@ namespace kodo
             value_type *c = reinterpret_cast<value_type*>(coefficients);
 
             uint32_t symbols = SuperCoder::symbols();
+            bool subfield = next_is_subfield();
 
             for(uint32_t i = 0; i < symbols; ++i)
             {
@@ -78,6 +120,11 @@ namespace kodo
                 value_type coefficient =
                     m_value_distribution(m_random_generator);
 
+                if(subfield)
+                {
+                    coefficient &= 1;
+                }
+
                 fifi::set_value<field_type>(c, i, coefficient);
             }
         }
@@ -88,6 +135,37 @@ namespace kodo
             m_random_generator.seed(seed_value);
         }
 
+        /// Sets the number of coefficient vectors of every block with
+        /// coefficients from the binary subfield, e.g. a few less than
+        /// the number of symbols. By default there are none.
+        /// @param vectors The number of vectors
+        void set_subfield_vectors(uint32_t vectors)
+        {
+            m_subfield_vectors = vectors;
+        }
+
+        /// @return The number of vectors of every block with coefficients
+        ///         from the binary subfield
+        uint32_t subfield_vectors() const
+        {
+            return m_subfield_vectors;
+        }
+
+    private:
+
+        /// Counts a generated vector
+        /// @return True if its coefficients are of the binary subfield
+        bool next_is_subfield()
+        {
+            if(m_generated >= m_subfield_vectors)
+            {
+                return false;
+            }
+
+            ++m_generated;
+            return !fifi::is_binary<field_type>::value;
+        }
+
     private:
 
         /// The type of the uint8_t distribution
@@ -107,6 +185,12 @@ namespace kodo
         /// The random generator
         boost::random::mt19937 m_random_generator;
 
+        /// The number of vectors of a block from the binary subfield
+        uint32_t m_subfield_vectors;
+
+        /// The number of vectors generated for the block
+        uint32_t m_generated;
+
     };
 }
 
@@ -0,0 +1,175 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <fifi/fifi_utils.hpp>
+
+namespace kodo
+{
+
+    /// @ingroup coefficient_generator_layers
+    /// @brief Generates uniform random coefficients using a xorshift64*
+    ///        generator, filling the coefficient buffer eight bytes at a
+    ///        time.
+    ///
+    /// The layer is a faster alternative to the uniform_generator for
+    /// cases where the coefficient generation shows up in profiles
+    /// e.g. seed based codes with small symbols. The sequence of
+    /// coefficients produced from a seed is fixed and independent of the
+    /// platform, so encoders and decoders built on different machines
+    /// interoperate as long as both use this layer:
+    ///
+    /// - Seeding: the 64 bit state is the splitmix64 mix of the seed,
+    ///   i.e. z = seed + 0x9E3779B97F4A7C15,
+    ///   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9,
+    ///   z = (z ^ (z >> 27)) * 0x94D049BB133111EB,
+    ///   state = z ^ (z >> 31). A zero state is replaced by
+    ///   0x9E3779B97F4A7C15.
+    /// - Each draw advances the state with x ^= x >> 12, x ^= x << 25,
+    ///   x ^= x >> 27 and outputs x * 0x2545F4914F6CDD1D.
+    /// - generate() writes the draws as little-endian 64 bit words, the
+    ///   last draw is truncated to the remaining bytes.
+    /// - generate_partial() makes one draw per pivot symbol in order of
+    ///   the symbol index and uses the upper 32 bits masked to the
+    ///   smallest power of two covering the field, draws greater than
+    ///   the field maximum are rejected and redrawn.
+    template<class SuperCoder>
+    class xorshift_uniform_generator : public SuperCoder
+    {
+    public:
+
+        /// @copydoc layer::field_type
+        typedef typename SuperCoder::field_type field_type;
+
+        /// @copydoc layer::value_type
+        typedef typename SuperCoder::value_type value_type;
+
+        /// @copydoc layer::seed_type
+        typedef uint32_t seed_type;
+
+    public:
+
+        /// Constructor
+        xorshift_uniform_generator()
+        {
+            seed(0);
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            uint32_t size = SuperCoder::coefficients_size();
+            uint32_t i = 0;
+
+            for(; i + 8 <= size; i += 8)
+            {
+                put_word(next(), coefficients + i, 8);
+            }
+
+            if(i < size)
+            {
+                put_word(next(), coefficients + i, size - i);
+            }
+        }
+
+        /// @copydoc layer::generate(uint8_t*)
+        void generate_partial(uint8_t *coefficients)
+        {
+            assert(coefficients != 0);
+
+            // Since we will not set all coefficients we should ensure
+            // that the non specified ones are zero
+            std::fill_n(
+                coefficients, SuperCoder::coefficients_size(), 0);
+
+            value_type *c = reinterpret_cast<value_type*>(coefficients);
+
+            uint32_t symbols = SuperCoder::symbols();
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                if(!SuperCoder::symbol_pivot(i))
+                {
+                    continue;
+                }
+
+                fifi::set_value<field_type>(c, i, next_value());
+            }
+        }
+
+        /// @copydoc layer::seed(seed_type)
+        void seed(seed_type seed_value)
+        {
+            uint64_t z = uint64_t(seed_value) + 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z = z ^ (z >> 31);
+
+            m_state = z ? z : 0x9E3779B97F4A7C15ULL;
+        }
+
+    protected:
+
+        /// @return The next 64 bit output of the generator
+        uint64_t next()
+        {
+            m_state ^= m_state >> 12;
+            m_state ^= m_state << 25;
+            m_state ^= m_state >> 27;
+            return m_state * 0x2545F4914F6CDD1DULL;
+        }
+
+        /// @return A uniform random value from the field
+        value_type next_value()
+        {
+            const uint32_t max_value = field_type::max_value;
+
+            // Smallest mask of all ones covering the maximum value
+            uint32_t mask = max_value;
+            mask |= mask >> 1;
+            mask |= mask >> 2;
+            mask |= mask >> 4;
+            mask |= mask >> 8;
+            mask |= mask >> 16;
+
+            while(true)
+            {
+                uint32_t value = uint32_t(next() >> 32) & mask;
+
+                if(value <= max_value)
+                {
+                    return static_cast<value_type>(value);
+                }
+            }
+        }
+
+        /// Writes the lowest bytes of a word in little-endian order
+        /// @param word The word to write
+        /// @param data The destination buffer
+        /// @param size The number of bytes to write, at most eight
+        static void put_word(uint64_t word, uint8_t *data, uint32_t size)
+        {
+            assert(size <= 8);
+
+            for(uint32_t i = 0; i < size; ++i)
+            {
+                data[i] = static_cast<uint8_t>(word >> (8 * i));
+            }
+        }
+
+    protected:
+
+        /// The generator state
+        uint64_t m_state;
+
+    };
+}
@@ -12,6 +12,10 @@ namespace kodo
 
     /// @ingroup codec_layers
     /// @brief Zeros the symbol data buffer
+    ///
+    /// The linear_block_encoder and the linear_block_batch_encoder
+    /// overwrite the symbol buffer, so the layer is not needed above
+    /// them. It is kept for encoders which add to the symbol buffer.
     template<class SuperCoder>
     class zero_symbol_encoder : public SuperCoder
     {
@@ -30,6 +34,22 @@ namespace kodo
             SuperCoder::encode_symbol(symbol_data, coefficients);
         }
 
+        /// Zero the incoming symbol data buffer and forward
+        /// the encode_symbol() call.
+        ///
+        /// @copydoc layer::encode_symbol(uint8_t*, const uint32_t*,
+        ///                              const value_type*, uint32_t)
+        void encode_symbol(uint8_t *symbol_data, const uint32_t *indices,
+                           const typename SuperCoder::value_type *coefficients,
+                           uint32_t count)
+        {
+            assert(symbol_data != 0);
+
+            std::fill_n(symbol_data, SuperCoder::symbol_size(), 0);
+            SuperCoder::encode_symbol(symbol_data, indices,
+                                      coefficients, count);
+        }
+
         /// Not implemented in this layer - the systematic encode will
         /// typically copy directly into symbol_data buffer. Therefore
         /// we don't have to worry about junk bytes existing in the buffer
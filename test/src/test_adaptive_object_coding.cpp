@@ -0,0 +1,192 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_adaptive_object_coding.cpp Unit test for the
+///       generation_size_controller and the adaptive object coders
+
+/// Tests:
+///   - generation_size_controller::report_feedback()
+///   - generation_size_controller::report_cpu_load()
+///   - write_adaptive_block_header() / read_adaptive_block_header()
+///   - adaptive_object_encoder / adaptive_object_decoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/adaptive_block_header.hpp>
+#include <kodo/adaptive_object_decoder.hpp>
+#include <kodo/adaptive_object_encoder.hpp>
+#include <kodo/generation_size_controller.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+TEST(TestGenerationSizeController, starts_at_max_and_clamps)
+{
+    kodo::generation_size_controller controller(8, 64);
+
+    EXPECT_EQ(64U, controller.symbols());
+
+    controller.set_symbols(1);
+    EXPECT_EQ(8U, controller.symbols());
+
+    controller.set_symbols(1000);
+    EXPECT_EQ(64U, controller.symbols());
+}
+
+TEST(TestGenerationSizeController, shrinks_under_latency_limit)
+{
+    kodo::generation_size_controller controller(4, 256);
+    controller.set_max_latency(0.01);
+
+    // 256 symbols decoded in 0.16 seconds, the latency limit is met
+    // with 64 symbols, but the size at most halves per step
+    kodo::block_feedback feedback;
+    feedback.m_decode_latency = 0.16;
+
+    controller.report_feedback(256, feedback);
+    EXPECT_EQ(128U, controller.symbols());
+
+    feedback.m_decode_latency = 0.04;
+    controller.report_feedback(128, feedback);
+    EXPECT_EQ(64U, controller.symbols());
+}
+
+TEST(TestGenerationSizeController, shrinks_under_cpu_limit)
+{
+    kodo::generation_size_controller controller(4, 256);
+    controller.set_max_cpu_load(0.5);
+
+    controller.report_cpu_load(256, 0.75);
+
+    // The load of 0.5 is predicted for 170 symbols
+    EXPECT_GE(controller.symbols(), 169U);
+    EXPECT_LE(controller.symbols(), 171U);
+}
+
+TEST(TestGenerationSizeController, grows_under_low_loss)
+{
+    kodo::generation_size_controller controller(4, 256);
+    controller.set_symbols(16);
+
+    kodo::block_feedback feedback;
+    feedback.m_loss_rate = 0.01;
+
+    controller.report_feedback(16, feedback);
+    EXPECT_EQ(20U, controller.symbols());
+
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        controller.report_feedback(controller.symbols(), feedback);
+    }
+
+    EXPECT_EQ(256U, controller.symbols());
+}
+
+TEST(TestGenerationSizeController, holds_under_high_loss)
+{
+    kodo::generation_size_controller controller(4, 256);
+    controller.set_symbols(16);
+
+    kodo::block_feedback feedback;
+    feedback.m_loss_rate = 0.2;
+
+    controller.report_feedback(16, feedback);
+    EXPECT_EQ(16U, controller.symbols());
+    EXPECT_DOUBLE_EQ(0.2, controller.loss_rate());
+}
+
+TEST(TestAdaptiveBlockHeader, write_and_read)
+{
+    kodo::adaptive_block_header header;
+    header.m_block_id = 7;
+    header.m_symbols = 33;
+    header.m_byte_offset = 0x100000001ULL;
+    header.m_sequence = 12;
+
+    std::vector<uint8_t> buffer(kodo::adaptive_block_header_size);
+    kodo::write_adaptive_block_header(header, &buffer[0]);
+
+    kodo::adaptive_block_header read =
+        kodo::read_adaptive_block_header(&buffer[0]);
+
+    EXPECT_EQ(header.m_block_id, read.m_block_id);
+    EXPECT_EQ(header.m_symbols, read.m_symbols);
+    EXPECT_EQ(header.m_byte_offset, read.m_byte_offset);
+    EXPECT_EQ(header.m_sequence, read.m_sequence);
+}
+
+TEST(TestAdaptiveObjectCoding, round_trip_with_changing_sizes)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_type;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    typedef kodo::storage_reader<encoder_type> object_data;
+
+    uint32_t max_symbols = 32;
+    uint32_t symbol_size = 100;
+
+    std::vector<uint8_t> data_in = random_vector(10000);
+
+    encoder_type::factory encoder_factory(max_symbols, symbol_size);
+    decoder_type::factory decoder_factory(max_symbols, symbol_size);
+
+    kodo::generation_size_controller controller(2, max_symbols);
+
+    kodo::adaptive_object_encoder<object_data, encoder_type>
+        obj_encoder(encoder_factory,
+                    object_data(sak::storage(data_in)), controller);
+
+    kodo::adaptive_object_decoder<decoder_type>
+        obj_decoder(decoder_factory, data_in.size());
+
+    std::vector<uint8_t> payload(obj_encoder.payload_size());
+    std::vector<uint8_t> data_out(data_in.size());
+
+    std::vector<uint32_t> sizes;
+
+    while(obj_encoder.next_block())
+    {
+        sizes.push_back(obj_encoder.encoder()->symbols());
+
+        uint32_t block = obj_encoder.block();
+
+        while(!obj_decoder.has_block(block) ||
+              !obj_decoder.is_block_complete(block))
+        {
+            obj_encoder.encode(&payload[0]);
+
+            EXPECT_EQ(block, obj_decoder.decode(&payload[0]));
+        }
+
+        EXPECT_EQ(obj_encoder.encoder()->bytes_used(),
+                  obj_decoder.bytes_used(block));
+
+        obj_decoder.decoder(block)->copy_symbols(
+            sak::storage(&data_out[obj_decoder.byte_offset(block)],
+                         obj_decoder.bytes_used(block)));
+
+        kodo::block_feedback feedback = obj_decoder.feedback(block);
+        EXPECT_DOUBLE_EQ(0.0, feedback.m_loss_rate);
+
+        controller.report_feedback(sizes.back(), feedback);
+
+        // The CPU load measured in the test varies, so the size is
+        // forced to change between the blocks
+        controller.set_symbols(block % 2 == 0 ? 5 : max_symbols);
+
+        obj_decoder.release_block(block);
+    }
+
+    EXPECT_TRUE(obj_decoder.is_complete());
+    EXPECT_TRUE(data_out == data_in);
+
+    ASSERT_GT(sizes.size(), 2U);
+    EXPECT_EQ(max_symbols, sizes[0]);
+    EXPECT_NE(sizes[0], sizes[1]);
+}
@@ -0,0 +1,163 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_adopting_symbol_storage.cpp Unit tests for the decoders
+///       adopting the received buffers
+
+#include <cstdint>
+#include <vector>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes payloads received into pool buffers and checks that the
+/// buffers are exchanged instead of copied
+template<class Field>
+void test_adopting_decoder(uint32_t symbols, uint32_t symbol_size,
+                           bool systematic)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::adopting_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto pool = boost::make_shared<kodo::symbol_buffer_pool>(
+        decoder_factory.max_payload_size());
+
+    decoder_factory.set_buffer_pool(pool);
+    EXPECT_TRUE(decoder_factory.buffer_pool() == pool);
+
+    auto encoder = encoder_factory.build();
+
+    if(!systematic)
+        encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    // Decode two blocks with the same decoder, the second after it is
+    // recycled by the factory
+    for(uint32_t block = 0; block < 2; ++block)
+    {
+        auto decoder = decoder_factory.build();
+        EXPECT_TRUE(decoder->buffer_pool() == pool);
+
+        // Every symbol of the decoder holds a buffer
+        EXPECT_EQ(symbols, pool->buffers() - pool->free_buffers());
+
+        uint8_t *buffer = pool->acquire();
+        std::set<uint8_t*> received;
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(buffer);
+
+            uint32_t rank = decoder->rank();
+            uint8_t *returned = decoder->decode_adopt(buffer);
+
+            if(decoder->rank() == rank)
+            {
+                // A payload which is not innovative is handed back
+                EXPECT_EQ(buffer, returned);
+            }
+            else
+            {
+                // The payload was adopted as a symbol
+                EXPECT_NE(buffer, returned);
+                received.insert(buffer);
+            }
+
+            buffer = returned;
+        }
+
+        pool->release(buffer);
+
+        // The decoder holds the adopted buffers and no buffer was
+        // allocated while decoding
+        uint32_t adopted = 0;
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            if(received.count(decoder->symbol(i)))
+                ++adopted;
+        }
+
+        EXPECT_GT(adopted, 0U);
+        EXPECT_EQ(symbols + 1, pool->buffers());
+        EXPECT_EQ(symbols, pool->buffers() - pool->free_buffers());
+
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data_in);
+
+        if(systematic)
+        {
+            // The systematic symbols are adopted where they belong
+            EXPECT_EQ(symbols, adopted);
+        }
+    }
+}
+
+TEST(TestAdoptingSymbolStorage, test_adopting_decoder)
+{
+    test_adopting_decoder<fifi::binary>(32, 160, true);
+    test_adopting_decoder<fifi::binary>(32, 160, false);
+    test_adopting_decoder<fifi::binary8>(32, 160, true);
+    test_adopting_decoder<fifi::binary8>(32, 160, false);
+    test_adopting_decoder<fifi::binary16>(16, 160, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_adopting_decoder<fifi::binary8>(symbols, symbol_size, false);
+}
+
+/// The decoder copies the payloads which do not come from its pool
+TEST(TestAdoptingSymbolStorage, test_plain_decode)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::adopting_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 100;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    // Without a pool set, the factory creates one for the payloads
+    ASSERT_TRUE(decoder_factory.buffer_pool());
+    EXPECT_EQ(decoder_factory.max_payload_size(),
+              decoder_factory.buffer_pool()->buffer_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        EXPECT_NE(&payload[0], decoder->symbol(i));
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
@@ -0,0 +1,128 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_aggregate_payload.cpp Unit test for the payloads packing
+///       several symbols with a shared header
+
+/// Tests:
+///   - aggregate_payload_encoder::encode(uint8_t*)
+///   - aggregate_payload_decoder::decode(uint8_t*)
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Sends a block in payloads of several symbols, checking that the
+/// systematic symbols share the aggregate header
+template<class Encoder, class Decoder>
+void test_aggregate_payload(uint32_t symbols, uint32_t symbol_size,
+                            uint32_t payload_symbols)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    encoder_factory.set_payload_symbols(payload_symbols);
+    decoder_factory.set_payload_symbols(payload_symbols);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(payload_symbols, encoder->payload_symbols());
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+    EXPECT_LE(encoder->payload_size(), encoder_factory.max_payload_size());
+
+    uint32_t aggregate_header_size = Encoder::aggregate_header_size;
+
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint32_t payloads = 0;
+
+    while(!decoder->is_complete())
+    {
+        uint32_t bytes_used = encoder->encode(&payload[0]);
+
+        EXPECT_LE(bytes_used, encoder->payload_size());
+
+        // Payloads of systematic symbols only hold the shared header
+        if((payloads + 1) * payload_symbols <= symbols)
+        {
+            EXPECT_EQ(payload_symbols * symbol_size + aggregate_header_size,
+                      bytes_used);
+        }
+
+        decoder->decode(&payload[0]);
+        ++payloads;
+    }
+
+    // The systematic symbols decode the block, unless the decoder needs
+    // a few coded symbols after the last of them
+    uint32_t systematic_payloads =
+        (symbols + payload_symbols - 1) / payload_symbols;
+
+    EXPECT_GE(payloads, systematic_payloads);
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), data_out.begin()));
+
+    // Coded payloads with a lost payload
+    encoder = encoder_factory.build();
+    decoder = decoder_factory.build();
+
+    encoder->set_symbols(sak::storage(data));
+    encoder->set_systematic_off();
+
+    encoder->encode(&payload[0]);
+
+    while(!decoder->is_complete())
+    {
+        uint32_t bytes_used = encoder->encode(&payload[0]);
+
+        EXPECT_LE(bytes_used, encoder->payload_size());
+        EXPECT_GT(bytes_used, payload_symbols * symbol_size +
+                  aggregate_header_size);
+
+        decoder->decode(&payload[0]);
+    }
+
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), data_out.begin()));
+}
+
+TEST(TestAggregatePayload, test_aggregate_payload)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_aggregate_payload<
+        kodo::aggregate_full_rlnc_encoder<fifi::binary>,
+        kodo::aggregate_full_rlnc_decoder<fifi::binary> >(
+            symbols, symbol_size, 1);
+
+    test_aggregate_payload<
+        kodo::aggregate_full_rlnc_encoder<fifi::binary8>,
+        kodo::aggregate_full_rlnc_decoder<fifi::binary8> >(
+            symbols, symbol_size, 3);
+
+    // Eight symbols of 1 KB fill a jumbo frame
+    test_aggregate_payload<
+        kodo::aggregate_full_rlnc_encoder<fifi::binary8>,
+        kodo::aggregate_full_rlnc_decoder<fifi::binary8> >(
+            32, 1024, 8);
+
+    test_aggregate_payload<
+        kodo::aggregate_full_rlnc_encoder<fifi::binary16>,
+        kodo::aggregate_full_rlnc_decoder<fifi::binary16> >(
+            symbols, symbol_size, 5);
+}
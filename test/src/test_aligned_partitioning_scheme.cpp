@@ -0,0 +1,163 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_aligned_partitioning_scheme.cpp Unit tests for the aligned
+///       block partitioning scheme
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/aligned_partitioning_scheme.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Checks that the blocks are aligned, cover the object contiguously and
+/// that the padding is below a symbol
+template<uint32_t Alignment>
+void check_partitioning(uint32_t max_symbols, uint32_t max_symbol_size,
+                        uint64_t object_size)
+{
+    kodo::aligned_partitioning_scheme<Alignment> partitioning(
+        max_symbols, max_symbol_size, object_size);
+
+    ASSERT_TRUE(partitioning.blocks() > 0);
+
+    uint64_t offset = 0;
+    uint32_t symbols = 0;
+
+    for(uint32_t i = 0; i < partitioning.blocks(); ++i)
+    {
+        uint32_t symbol_size = partitioning.symbol_size(i);
+
+        EXPECT_LE(symbol_size, max_symbol_size);
+        EXPECT_LE(partitioning.symbols(i), max_symbols);
+        EXPECT_GT(partitioning.bytes_used(i), 0U);
+
+        if(max_symbol_size >= Alignment)
+        {
+            EXPECT_EQ(0U, symbol_size % Alignment);
+        }
+
+        if(i > 0)
+        {
+            EXPECT_GE(partitioning.symbols(i - 1),
+                      partitioning.symbols(i));
+        }
+
+        EXPECT_EQ(offset, partitioning.byte_offset(i));
+        offset += partitioning.bytes_used(i);
+        symbols += partitioning.symbols(i);
+    }
+
+    EXPECT_EQ(object_size, offset);
+    EXPECT_EQ(partitioning.total_symbols(), symbols);
+    EXPECT_EQ(partitioning.total_block_size() - object_size,
+              partitioning.padding());
+    EXPECT_LT(partitioning.padding(), partitioning.symbol_size(0));
+}
+
+TEST(TestAlignedPartitioningScheme, partition_in_hand)
+{
+    // The RFC 5052 scheme uses 16 blocks of 1500 bytes
+    kodo::aligned_partitioning_scheme<32> partitioning(16, 1500, 123456);
+
+    // 1500 is aligned down to 1472, 84 symbols cover the object, of at
+    // least 1470 bytes which is aligned up to 1472
+    EXPECT_EQ(6U, partitioning.blocks());
+    EXPECT_EQ(84U, partitioning.total_symbols());
+    EXPECT_EQ(1472U, partitioning.symbol_size(0));
+
+    EXPECT_EQ(14U, partitioning.symbols(0));
+    EXPECT_EQ(14U, partitioning.symbols(5));
+
+    EXPECT_EQ(84U * 1472U - 123456U, partitioning.padding());
+    EXPECT_DOUBLE_EQ(192.0 / 123456, partitioning.padding_overhead());
+}
+
+TEST(TestAlignedPartitioningScheme, partition_random)
+{
+    check_partitioning<32>(16, 1500, 123456);
+    check_partitioning<32>(16, 1000, 16 * 1000 + 1);
+    check_partitioning<64>(1, 64, 1);
+    check_partitioning<64>(10, 20, 1000);
+    check_partitioning<32>(255, 33, 100000);
+
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        uint32_t max_symbols = (rand() % 64) + 1;
+        uint32_t max_symbol_size = (rand() % 3000) + 1;
+        uint32_t object_size = (rand() % 1000000) + 1;
+
+        check_partitioning<16>(max_symbols, max_symbol_size, object_size);
+        check_partitioning<32>(max_symbols, max_symbol_size, object_size);
+        check_partitioning<64>(max_symbols, max_symbol_size, object_size);
+    }
+}
+
+/// Objects larger than 4 GB are partitioned with 64 bit offsets
+TEST(TestAlignedPartitioningScheme, partition_large_object)
+{
+    check_partitioning<32>(1024, 1400, 300ULL * 1000 * 1000 * 1000 + 7);
+    check_partitioning<64>(64, 9000, (1ULL << 32) + 1);
+}
+
+/// Encodes and decodes an object with the aligned partitioning
+TEST(TestAlignedPartitioningScheme, object_codes)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+    typedef kodo::aligned_partitioning_scheme<> partitioning_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+
+    uint32_t symbols = rand_symbols(32);
+    uint32_t symbol_size = rand_symbol_size() + 31;
+    uint32_t object_size = rand_nonzero(symbols * symbol_size * 4);
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+    std::vector<uint8_t> data_out(object_size, '\0');
+
+    kodo::object_encoder<storage_reader, encoder_t, partitioning_t>
+        object_encoder(encoder_factory,
+                       storage_reader(sak::storage(data_in)));
+
+    kodo::object_decoder<decoder_t, partitioning_t>
+        object_decoder(decoder_factory, object_size);
+
+    partitioning_t partitioning(symbols, symbol_size, object_size);
+
+    EXPECT_EQ(object_encoder.encoders(), object_decoder.decoders());
+
+    for(uint32_t i = 0; i < object_encoder.encoders(); ++i)
+    {
+        auto encoder = object_encoder.build(i);
+        auto decoder = object_decoder.build(i);
+
+        EXPECT_EQ(0U, encoder->symbol_size() % 32);
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+        }
+
+        decoder->copy_symbols(
+            sak::storage(&data_out[partitioning.byte_offset(i)],
+                         partitioning.bytes_used(i)));
+    }
+
+    EXPECT_TRUE(data_in == data_out);
+}
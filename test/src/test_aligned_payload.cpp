@@ -0,0 +1,196 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_aligned_payload.cpp Unit tests for the aligned payload
+///       encoder and decoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sak/aligned_allocator.hpp>
+#include <sak/is_aligned.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/aligned_payload_encoder.hpp>
+#include <kodo/aligned_payload_decoder.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Layer counting the coded symbols decoded with unaligned
+    /// coding coefficients
+    template<class SuperCoder>
+    class unaligned_coefficients_counter : public SuperCoder
+    {
+    public:
+
+        /// Pull up the decode_symbol() functions
+        using SuperCoder::decode_symbol;
+
+        /// @copydoc layer::initialize(Factory&)
+        template<class Factory>
+        void initialize(Factory &the_factory)
+        {
+            SuperCoder::initialize(the_factory);
+            m_unaligned = 0;
+        }
+
+        /// @copydoc layer::decode_symbol(uint8_t*,uint8_t*)
+        void decode_symbol(uint8_t *symbol_data, uint8_t *coefficients)
+        {
+            if(!sak::is_aligned(coefficients))
+                ++m_unaligned;
+
+            SuperCoder::decode_symbol(symbol_data, coefficients);
+        }
+
+        /// @return The number of unaligned coefficient vectors
+        uint32_t unaligned() const
+        {
+            return m_unaligned;
+        }
+
+    protected:
+
+        /// The number of unaligned coefficient vectors
+        uint32_t m_unaligned;
+    };
+
+    template<class Field>
+    class aligned_full_rlnc_encoder :
+        public aligned_payload_encoder<
+               systematic_encoder<
+               symbol_id_encoder<
+               plain_symbol_id_writer<
+               uniform_generator<
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               coefficient_info<
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               final_coder_factory_pool<
+               aligned_full_rlnc_encoder<Field>
+                   > > > > > > > > > > > > > > > >
+    { };
+
+    template<class Field>
+    class aligned_full_rlnc_decoder :
+        public aligned_payload_decoder<
+               systematic_decoder<
+               symbol_id_decoder<
+               plain_symbol_id_reader<
+               unaligned_coefficients_counter<
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               coefficient_storage<
+               coefficient_info<
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               final_coder_factory_pool<
+               aligned_full_rlnc_decoder<Field>
+                   > > > > > > > > > > > > > > >
+    { };
+
+}
+
+/// Decodes coded symbols from aligned payload buffers and checks that
+/// the symbol data and coding coefficients are aligned
+template<class Field>
+void test_aligned_payload(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::aligned_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::aligned_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(encoder->header_offset(), decoder->header_offset());
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    EXPECT_TRUE(encoder->payload_size() <= encoder_factory.max_payload_size());
+    EXPECT_TRUE(decoder->payload_size() <= decoder_factory.max_payload_size());
+
+    // The symbol id of coded symbols follows the systematic flag
+    EXPECT_EQ(1U, decoder->symbol_id_offset());
+    EXPECT_TRUE(encoder->header_offset() >= symbol_size);
+    EXPECT_EQ(0U, (decoder->header_offset() + 1) % 16);
+
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t, sak::aligned_allocator<uint8_t> > payload(
+        encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        uint32_t bytes_used = encoder->encode(&payload[0]);
+        EXPECT_TRUE(bytes_used <= encoder->payload_size());
+
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_EQ(0U, decoder->unaligned());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestAlignedPayload, test_alignment)
+{
+    test_aligned_payload<fifi::binary>(16, 1);
+    test_aligned_payload<fifi::binary8>(32, 15);
+    test_aligned_payload<fifi::binary8>(32, 16);
+    test_aligned_payload<fifi::binary16>(32, 34);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_aligned_payload<fifi::binary>(symbols, symbol_size);
+    test_aligned_payload<fifi::binary8>(symbols, symbol_size);
+    test_aligned_payload<fifi::binary16>(symbols, symbol_size);
+}
+
+TEST(TestAlignedPayload, test_basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::aligned_full_rlnc_encoder<fifi::binary>,
+                     kodo::aligned_full_rlnc_decoder<fifi::binary> >(
+                         symbols, symbol_size);
+
+    invoke_basic_api<kodo::aligned_full_rlnc_encoder<fifi::binary8>,
+                     kodo::aligned_full_rlnc_decoder<fifi::binary8> >(
+                         symbols, symbol_size);
+}
+
+TEST(TestAlignedPayload, test_systematic)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<kodo::aligned_full_rlnc_encoder<fifi::binary8>,
+                      kodo::aligned_full_rlnc_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+}
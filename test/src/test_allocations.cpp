@@ -0,0 +1,209 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_allocations.cpp Unit tests checking that the coder stacks
+///       do not allocate once their factory pool is warm
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+#include <kodo/rs/cauchy_reed_solomon_codes.hpp>
+#include <kodo/nocode/carousel_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    /// The number of calls of the global operator new of the tests
+    std::atomic<uint64_t> allocations(0);
+}
+
+// The replacement operator new and delete count the allocations of the
+// entire test program, the tests only look at the difference across
+// the operations they run
+void* operator new(std::size_t size)
+{
+    ++allocations;
+
+    void *data = std::malloc(size ? size : 1);
+
+    if(data == 0)
+    {
+        throw std::bad_alloc();
+    }
+
+    return data;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+/// @return The allocations done so far
+uint64_t allocation_count()
+{
+    return allocations.load();
+}
+
+/// Passes a payload through the recoder
+template<class Recoder>
+void recode_payload(Recoder &recoder, uint8_t *payload, std::true_type)
+{
+    recoder->decode(payload);
+    recoder->recode(payload);
+}
+
+/// Used for the stacks which do not recode
+template<class Recoder>
+void recode_payload(Recoder&, uint8_t*, std::false_type)
+{ }
+
+/// Builds an encoder and a decoder and decodes a block, optionally
+/// passing the symbols through a recoder
+/// @return The number of allocations done by build(), encode(),
+///         decode(), recode() and the release of the coders
+template<class Encoder, class Decoder, bool Recode>
+uint64_t run_block(typename Encoder::factory &encoder_factory,
+                   typename Decoder::factory &decoder_factory,
+                   const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> payload(encoder_factory.max_payload_size());
+
+    uint64_t before = allocation_count();
+
+    {
+        auto encoder = encoder_factory.build();
+        auto decoder = decoder_factory.build();
+        auto recoder = decoder_factory.build();
+
+        encoder->set_symbols(
+            sak::storage(&data[0], encoder->block_size()));
+
+        uint32_t count = 0;
+        uint32_t max_count = 4 * encoder->symbols() + 50;
+
+        while(!decoder->is_complete() && count++ < max_count)
+        {
+            encoder->encode(&payload[0]);
+
+            recode_payload(recoder, &payload[0],
+                           std::integral_constant<bool, Recode>());
+            decoder->decode(&payload[0]);
+        }
+
+        EXPECT_TRUE(decoder->is_complete());
+    }
+
+    return allocation_count() - before;
+}
+
+/// Checks that after a warm up block a second block does not allocate
+template<class Encoder, class Decoder, bool Recode = false>
+void test_steady_state(uint32_t symbols, uint32_t symbol_size)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    std::vector<uint8_t> data = random_vector(symbols * symbol_size);
+
+    // Constructs the coders and their pools
+    run_block<Encoder, Decoder, Recode>(
+        encoder_factory, decoder_factory, data);
+
+    EXPECT_EQ(0U, (run_block<Encoder, Decoder, Recode>(
+        encoder_factory, decoder_factory, data)));
+}
+
+template<template <class> class Encoder, template <class> class Decoder,
+         bool Recode = false>
+void test_steady_state_fields()
+{
+    test_steady_state<Encoder<fifi::binary>, Decoder<fifi::binary>,
+                      Recode>(32, 160);
+    test_steady_state<Encoder<fifi::binary8>, Decoder<fifi::binary8>,
+                      Recode>(16, 160);
+    test_steady_state<Encoder<fifi::binary16>, Decoder<fifi::binary16>,
+                      Recode>(8, 160);
+}
+
+/// The paged decoder with the default memory policy
+template<class Field>
+using paged_decoder = kodo::paged_full_rlnc_decoder<Field>;
+
+TEST(TestAllocations, full_rlnc)
+{
+    test_steady_state_fields<kodo::full_rlnc_encoder,
+                             kodo::full_rlnc_decoder>();
+
+    test_steady_state_fields<kodo::full_rlnc_encoder,
+                             kodo::full_rlnc_decoder, true>();
+
+    test_steady_state_fields<kodo::shared_full_rlnc_encoder,
+                             kodo::full_rlnc_decoder_hybrid>();
+
+    test_steady_state_fields<kodo::simd_full_rlnc_encoder,
+                             kodo::simd_full_rlnc_decoder>();
+
+    test_steady_state_fields<kodo::sparse_full_rlnc_encoder,
+                             kodo::markowitz_full_rlnc_decoder, true>();
+
+    test_steady_state_fields<kodo::sparse_full_rlnc_encoder,
+                             kodo::sparse_full_rlnc_decoder>();
+
+    test_steady_state_fields<kodo::tunable_sparse_full_rlnc_encoder,
+                             paged_decoder>();
+}
+
+TEST(TestAllocations, seed_rlnc)
+{
+    test_steady_state_fields<kodo::seed_rlnc_encoder,
+                             kodo::seed_rlnc_decoder>();
+
+    test_steady_state_fields<kodo::seed_rlnc_xorshift_encoder,
+                             kodo::seed_rlnc_xorshift_decoder>();
+
+    test_steady_state_fields<kodo::simd_seed_rlnc_encoder,
+                             kodo::simd_seed_rlnc_decoder>();
+}
+
+TEST(TestAllocations, reed_solomon)
+{
+    test_steady_state<kodo::rs_encoder<fifi::binary8>,
+                      kodo::rs_decoder<fifi::binary8> >(16, 160);
+
+    test_steady_state<kodo::rs_encoder<fifi::binary8>,
+                      kodo::rs_inverse_decoder<fifi::binary8> >(
+                          16, 160);
+
+    test_steady_state<kodo::cauchy_rs_encoder<fifi::binary8>,
+                      kodo::cauchy_rs_decoder<fifi::binary8> >(
+                          16, 160);
+}
+
+TEST(TestAllocations, carousel)
+{
+    test_steady_state<kodo::nocode_carousel_encoder,
+                      kodo::nocode_carousel_decoder>(16, 160);
+}
@@ -0,0 +1,155 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_band_codes.cpp Unit tests for the band RLNC codes
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/band_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes and decodes a block with a given band width
+template<class Field>
+void test_band_codes(uint32_t symbols, uint32_t symbol_size,
+                     uint32_t band_width, bool systematic)
+{
+    typedef kodo::band_rlnc_encoder<Field> encoder_t;
+    typedef kodo::band_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    encoder_factory.set_band_width(band_width);
+    decoder_factory.set_band_width(band_width);
+
+    typename encoder_t::pointer encoder = encoder_factory.build();
+    typename decoder_t::pointer decoder = decoder_factory.build();
+
+    uint32_t width = std::min(band_width, symbols);
+
+    EXPECT_EQ(width, encoder->band_width());
+    EXPECT_EQ(width, decoder->band_width());
+
+    // Only the offset and the band are sent
+    uint32_t id_size = 4 + fifi::elements_to_size<Field>(width);
+    EXPECT_EQ(id_size, encoder->id_size());
+    EXPECT_EQ(id_size, decoder->id_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    if(!systematic)
+    {
+        kodo::set_systematic_off(encoder);
+    }
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        // Lose some of the payloads
+        if(rand() % 4 == 0)
+            continue;
+
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestBandCodes, decode)
+{
+    test_band_codes<fifi::binary>(64, 100, 8, false);
+    test_band_codes<fifi::binary8>(100, 160, 16, false);
+    test_band_codes<fifi::binary16>(32, 40, 4, false);
+
+    test_band_codes<fifi::binary>(64, 100, 8, true);
+    test_band_codes<fifi::binary8>(100, 160, 16, true);
+    test_band_codes<fifi::binary16>(32, 40, 4, true);
+
+    // A band spanning the whole block and a band of a single symbol
+    test_band_codes<fifi::binary8>(16, 100, 64, false);
+    test_band_codes<fifi::binary8>(16, 100, 1, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+    uint32_t band_width = (rand() % symbols) + 1;
+
+    test_band_codes<fifi::binary>(symbols, symbol_size, band_width, false);
+    test_band_codes<fifi::binary8>(symbols, symbol_size, band_width, true);
+}
+
+/// Tests that an uncoded symbol received at the pivot of a coded
+/// symbol does not lose the rank of the coded symbol
+TEST(TestBandCodes, swap)
+{
+    typedef kodo::band_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::band_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 32;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    encoder_factory.set_band_width(8);
+    decoder_factory.set_band_width(8);
+
+    encoder_t::pointer encoder = encoder_factory.build();
+    decoder_t::pointer decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(decoder->rank() < symbols / 2)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    // Pass the uncoded symbols at the pivots of the coded symbols
+    for(uint32_t i = 0; i < symbols && !decoder->is_complete(); ++i)
+    {
+        if(!decoder->symbol_pivot(i) || !decoder->symbol_coded(i))
+            continue;
+
+        uint32_t rank = decoder->rank();
+
+        decoder->decode_symbol(&data_in[i * symbol_size], i);
+
+        EXPECT_GE(decoder->rank(), rank);
+
+        if(!decoder->is_complete())
+        {
+            EXPECT_FALSE(decoder->symbol_coded(i));
+        }
+    }
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
@@ -0,0 +1,34 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_bit_scan.cpp Unit tests for the bit scan helpers
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <kodo/bit_scan.hpp>
+
+TEST(TestBitScan, count_trailing_zeros)
+{
+    EXPECT_EQ(0U, kodo::count_trailing_zeros(1U));
+    EXPECT_EQ(3U, kodo::count_trailing_zeros(0x18U));
+    EXPECT_EQ(63U, kodo::count_trailing_zeros(uint64_t(1) << 63));
+    EXPECT_EQ(32U, kodo::count_trailing_zeros(0xffffffff00000000ULL));
+}
+
+TEST(TestBitScan, load_word)
+{
+    uint8_t data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+
+    EXPECT_EQ(0x0807060504030201ULL, kodo::load_word(data, 8));
+    EXPECT_EQ(0x030201ULL, kodo::load_word(data, 3));
+    EXPECT_EQ(0ULL, kodo::load_word(data, 0));
+
+    // The first non-zero byte is found from the trailing zeros
+    uint8_t sparse[] = { 0, 0, 0, 0, 0, 0x10, 0, 0x01 };
+    EXPECT_EQ(5U, kodo::count_trailing_zeros(
+                  kodo::load_word(sparse, 8)) / 8);
+}
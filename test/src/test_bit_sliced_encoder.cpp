@@ -0,0 +1,113 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_bit_sliced_encoder.cpp Unit tests for the bit sliced
+///       symbol layout
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/bit_slice.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+TEST(TestBitSlicedEncoder, bit_slice)
+{
+    uint32_t size = 64;
+    uint32_t plane_size = size / kodo::bit_planes;
+
+    std::vector<uint8_t> bytes = random_vector(size);
+    std::vector<uint8_t> planes(size);
+    std::vector<uint8_t> back(size);
+
+    kodo::bit_slice(&planes[0], &bytes[0], size);
+
+    // Bit e of plane i is bit i of byte e
+    for(uint32_t e = 0; e < size; ++e)
+    {
+        for(uint32_t i = 0; i < kodo::bit_planes; ++i)
+        {
+            uint8_t plane_bit =
+                (planes[i * plane_size + e / 8] >> (e % 8)) & 1U;
+
+            EXPECT_EQ((bytes[e] >> i) & 1U, plane_bit);
+        }
+    }
+
+    kodo::bit_unslice(&back[0], &planes[0], size);
+    EXPECT_TRUE(back == bytes);
+}
+
+/// The payloads of the bit sliced encoder are those of the
+/// full_rlnc_encoder
+void test_bit_sliced_encoder(uint32_t symbols, uint32_t symbol_size,
+                             bool systematic)
+{
+    typedef kodo::bit_sliced_full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_encoder<fifi::binary8> reference_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    reference_t::factory reference_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto reference = reference_factory.build();
+    auto decoder = decoder_factory.build();
+
+    ASSERT_EQ(reference->payload_size(), encoder->payload_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+    encoder->set_symbols(sak::storage(data_in));
+    reference->set_symbols(sak::storage(data_in));
+
+    encoder->seed(7);
+    reference->seed(7);
+
+    if(!systematic)
+    {
+        kodo::set_systematic_off(encoder);
+        kodo::set_systematic_off(reference);
+    }
+
+    // The symbols are read back as bytes
+    std::vector<uint8_t> data_copy(encoder->block_size());
+    encoder->copy_symbols(sak::storage(data_copy));
+    EXPECT_TRUE(data_copy == data_in);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> expected(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        reference->encode(&expected[0]);
+
+        EXPECT_TRUE(payload == expected);
+
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestBitSlicedEncoder, test_encode_decode)
+{
+    test_bit_sliced_encoder(16, 160, true);
+    test_bit_sliced_encoder(16, 160, false);
+    test_bit_sliced_encoder(1, 8, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size() * 8;
+
+    test_bit_sliced_encoder(symbols, symbol_size, false);
+}
@@ -0,0 +1,210 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_bounded_object_decoder.cpp Unit tests for the bounded
+///       object decoder
+
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <kodo/bounded_object_decoder.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes an object where the payloads of the blocks are interleaved
+/// round-robin, with a budget of the given number of decoders
+template<class Field>
+void test_bounded_object_decoder(uint32_t symbols, uint32_t symbol_size,
+                                 uint32_t object_size, uint32_t budget,
+                                 const std::string &spill_directory)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+    typedef kodo::object_encoder<storage_reader, encoder_t>
+        object_encoder;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+    std::vector<uint8_t> data_out(object_size, '\0');
+
+    object_encoder encoder(encoder_factory,
+                           storage_reader(sak::storage(data_in)));
+
+    uint32_t blocks = encoder.encoders();
+
+    std::vector<typename encoder_t::pointer> encoders;
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        encoders.push_back(encoder.build(i));
+        kodo::set_systematic_off(encoders.back());
+    }
+
+    // The budget of a few full decoders
+    uint64_t coefficients_size = (symbols * Field::degree + 7) / 8;
+    uint64_t decoder_memory =
+        symbols * symbol_size + symbols * coefficients_size;
+    uint64_t memory_budget = budget * decoder_memory;
+
+    kodo::bounded_object_decoder<decoder_t> decoder(
+        decoder_factory, sak::storage(data_out), memory_budget);
+
+    decoder.set_spill_directory(spill_directory);
+
+    EXPECT_EQ(blocks, decoder.blocks());
+    EXPECT_EQ(memory_budget, decoder.memory_budget());
+
+    std::vector<uint8_t> payload(encoders[0]->payload_size());
+
+    while(!decoder.is_complete())
+    {
+        for(uint32_t i = 0; i < blocks; ++i)
+        {
+            if(decoder.is_block_complete(i))
+            {
+                continue;
+            }
+
+            encoders[i]->encode(&payload[0]);
+
+            if(decoder.decode(i, &payload[0]))
+            {
+                EXPECT_TRUE(decoder.is_block_complete(i));
+            }
+
+            EXPECT_LE(decoder.memory_used(), memory_budget);
+            EXPECT_LE(decoder.live_decoders(), budget);
+        }
+    }
+
+    // The completed decoders are released at once
+    EXPECT_EQ(0U, decoder.live_decoders());
+    EXPECT_EQ(0U, decoder.memory_used());
+
+    if(blocks > budget)
+    {
+        EXPECT_GT(decoder.spills(), 0U);
+    }
+    else
+    {
+        EXPECT_EQ(0U, decoder.spills());
+    }
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestBoundedObjectDecoder, spill_to_memory)
+{
+    test_bounded_object_decoder<fifi::binary8>(16, 32, 16 * 32 * 6, 2, "");
+    test_bounded_object_decoder<fifi::binary8>(16, 32, 16 * 32 * 3, 3, "");
+    test_bounded_object_decoder<fifi::binary>(32, 16, 32 * 16 * 5 + 7, 1,
+                                              "");
+    test_bounded_object_decoder<fifi::binary16>(10, 40, 10 * 40 * 4, 2,
+                                                "");
+}
+
+TEST(TestBoundedObjectDecoder, spill_to_file)
+{
+    std::string directory =
+        boost::filesystem::temp_directory_path().string();
+
+    test_bounded_object_decoder<fifi::binary8>(16, 32, 16 * 32 * 6, 2,
+                                               directory);
+
+    uint32_t symbols = rand_symbols(64);
+    uint32_t symbol_size = rand_symbol_size();
+    uint32_t object_size = rand_nonzero(symbols * symbol_size * 8);
+
+    test_bounded_object_decoder<fifi::binary8>(
+        symbols, symbol_size, object_size, 3, directory);
+}
+
+/// Checks that a spilled decoder keeps its rank when it is restored
+TEST(TestBoundedObjectDecoder, restore_rank)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 8;
+    uint32_t symbol_size = 16;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(2 * symbols * symbol_size);
+    std::vector<uint8_t> data_out(data_in.size(), '\0');
+
+    auto encoder = encoder_factory.build();
+    encoder->set_symbols(sak::storage(&data_in[0], symbols * symbol_size));
+
+    // Room for a single decoder
+    kodo::bounded_object_decoder<decoder_t> decoder(
+        decoder_factory, sak::storage(data_out),
+        symbols * symbol_size + symbols * symbols);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // Three systematic and two coded symbols for block 0
+    for(uint32_t i = 0; i < 5; ++i)
+    {
+        if(i == 3)
+        {
+            kodo::set_systematic_off(encoder);
+        }
+
+        encoder->encode(&payload[0]);
+        EXPECT_FALSE(decoder.decode(0, &payload[0]));
+    }
+
+    // A payload of block 1 spills block 0
+    auto encoder_two = encoder_factory.build();
+    encoder_two->set_symbols(
+        sak::storage(&data_in[symbols * symbol_size],
+                     symbols * symbol_size));
+
+    encoder_two->encode(&payload[0]);
+    decoder.decode(1, &payload[0]);
+
+    EXPECT_TRUE(decoder.is_block_spilled(0));
+    EXPECT_FALSE(decoder.is_block_spilled(1));
+    EXPECT_EQ(1U, decoder.spills());
+
+    // The restored decoder has the rank of the spilled one, so block 0
+    // cannot complete in less than the three missing symbols
+    for(uint32_t i = 0; i < 2; ++i)
+    {
+        encoder->encode(&payload[0]);
+        EXPECT_FALSE(decoder.decode(0, &payload[0]));
+    }
+
+    uint32_t extra = 0;
+
+    do
+    {
+        encoder->encode(&payload[0]);
+        ++extra;
+    }
+    while(!decoder.decode(0, &payload[0]));
+
+    // A lost rank would take several more symbols
+    EXPECT_LE(extra, 3U);
+
+    EXPECT_TRUE(std::equal(data_out.begin(),
+                           data_out.begin() + symbols * symbol_size,
+                           data_in.begin()));
+}
@@ -0,0 +1,132 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_buffered_recoder.cpp Unit tests for the buffered recoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/buffered_recoder.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Relays the payloads of an encoder through a buffered recoder and
+/// decodes the recoded payloads only
+/// @param symbols The number of symbols
+/// @param symbol_size The size of a symbol
+/// @param capacity The capacity of the recoder
+/// @param received The number of payloads given to the recoder
+/// @param systematic True if the encoder sends the symbols uncoded first
+template<class Field>
+void test_buffered_recoder(uint32_t symbols, uint32_t symbol_size,
+                           uint32_t capacity, uint32_t received,
+                           bool systematic)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    if(!systematic)
+    {
+        encoder->set_systematic_off();
+    }
+
+    kodo::buffered_recoder<Field> recoder(symbols, symbol_size, capacity);
+
+    EXPECT_EQ(symbols, recoder.symbols());
+    EXPECT_EQ(symbol_size, recoder.symbol_size());
+    EXPECT_EQ(capacity, recoder.capacity());
+    EXPECT_EQ(0U, recoder.buffered());
+    EXPECT_EQ(encoder->payload_size(), recoder.payload_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < received; ++i)
+    {
+        encoder->encode(&payload[0]);
+        recoder.receive(&payload[0]);
+    }
+
+    EXPECT_TRUE(recoder.buffered() <= std::min(capacity, received));
+
+    // The rank of the decoder is bounded by the buffered payloads
+    for(uint32_t i = 0; i < 4 * symbols + 40; ++i)
+    {
+        recoder.recode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_TRUE(decoder->rank() <= recoder.buffered());
+
+    if(decoder->is_complete())
+    {
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data_in);
+    }
+
+    // Buffering the whole generation uncoded lets the decoder complete
+    if(systematic && capacity >= symbols && received >= symbols)
+    {
+        EXPECT_TRUE(decoder->is_complete());
+    }
+}
+
+TEST(TestBufferedRecoder, systematic)
+{
+    test_buffered_recoder<fifi::binary>(16, 16, 16, 16, true);
+    test_buffered_recoder<fifi::binary8>(16, 16, 16, 16, true);
+    test_buffered_recoder<fifi::binary16>(16, 16, 16, 16, true);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_buffered_recoder<fifi::binary8>(
+        symbols, symbol_size, symbols, symbols, true);
+}
+
+TEST(TestBufferedRecoder, coded)
+{
+    test_buffered_recoder<fifi::binary>(16, 16, 20, 40, false);
+    test_buffered_recoder<fifi::binary8>(16, 16, 20, 40, false);
+    test_buffered_recoder<fifi::binary16>(16, 16, 20, 40, false);
+}
+
+TEST(TestBufferedRecoder, bounded)
+{
+    // The decoder may not get more than the buffered payloads
+    test_buffered_recoder<fifi::binary8>(32, 16, 4, 100, false);
+    test_buffered_recoder<fifi::binary8>(32, 16, 4, 2, false);
+    test_buffered_recoder<fifi::binary16>(32, 16, 8, 100, true);
+}
+
+TEST(TestBufferedRecoder, empty)
+{
+    kodo::buffered_recoder<fifi::binary8> recoder(10, 16, 4);
+
+    std::vector<uint8_t> payload(recoder.payload_size(), 0xAA);
+    EXPECT_EQ(16U + 1U + 10U, recoder.recode(&payload[0]));
+
+    for(uint32_t i = 0; i < 16U + 1U + 10U; ++i)
+    {
+        EXPECT_EQ(0U, payload[i]);
+    }
+
+    // An all-zero coefficient vector is not buffered
+    recoder.receive(&payload[0]);
+    EXPECT_EQ(0U, recoder.buffered());
+}
@@ -6,6 +6,8 @@
 /// @file test_carousel_codes.cpp Unit tests for the carousel nocode scheme
 
 #include <ctime>
+#include <algorithm>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -38,3 +40,67 @@ TEST(TestNoCodeCarouselCodes, basic_api)
 }
 
 
+/// Sends the symbols as views into the storage of the encoder and
+/// checks they are handed out round-robin without copying
+static void test_encode_view(uint32_t symbols, uint32_t symbol_size)
+{
+    kodo::nocode_carousel_encoder::factory encoder_factory(
+        symbols, symbol_size);
+
+    kodo::nocode_carousel_decoder::factory decoder_factory(
+        symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> header(encoder->header_size());
+    std::vector<uint8_t> symbol_data(encoder->symbol_size());
+
+    // Two rounds of the carousel
+    for(uint32_t i = 0; i < 2 * symbols; ++i)
+    {
+        sak::const_storage view;
+
+        uint32_t header_bytes = encoder->encode_view(&header[0], view);
+        EXPECT_EQ(encoder->header_size(), header_bytes);
+
+        EXPECT_TRUE(view.m_data == encoder->symbol(i % symbols));
+        EXPECT_EQ(encoder->symbol_size(), view.m_size);
+
+        // The transport receives the symbol into its own buffer
+        std::copy(view.m_data, view.m_data + view.m_size,
+                  symbol_data.begin());
+
+        decoder->decode(&symbol_data[0], &header[0]);
+    }
+
+    // The carousel continues with the first symbol
+    const uint8_t *reference = 0;
+
+    uint32_t header_bytes = encoder->encode_in_place(
+        &symbol_data[0], &header[0], &reference);
+
+    EXPECT_EQ(encoder->header_size(), header_bytes);
+    EXPECT_TRUE(reference == encoder->symbol(0));
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestNoCodeCarouselCodes, encode_view)
+{
+    test_encode_view(32, 1600);
+    test_encode_view(1, 1600);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_encode_view(symbols, symbol_size);
+}
@@ -0,0 +1,160 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_checksum.cpp Unit tests for the CRC32C and the checksum
+///       layers
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/crc32c.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Checks the CRC32C against the check value of the Castagnoli
+/// polynomial and the hardware implementation against the portable one
+TEST(TestChecksum, crc32c)
+{
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+    EXPECT_EQ(0xe3069283U, kodo::crc32c_portable(0, check, sizeof(check)));
+    EXPECT_EQ(0xe3069283U, kodo::crc32c(check, sizeof(check)));
+
+    std::vector<uint8_t> data = random_vector(1000);
+
+    uint32_t crc = kodo::crc32c_portable(0, &data[0], 1000);
+
+    EXPECT_EQ(crc, kodo::crc32c(&data[0], 1000));
+
+    // A buffer may be processed in parts
+    EXPECT_EQ(crc, kodo::crc32c(kodo::crc32c(&data[0], 333),
+                                &data[333], 667));
+}
+
+/// Decodes a block and checks that every symbol is verified
+template<class Field>
+void test_checksum_decode(uint32_t symbols, uint32_t symbol_size,
+                          bool systematic)
+{
+    typedef kodo::checksum_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::checksum_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    if(!systematic)
+    {
+        kodo::set_systematic_off(encoder);
+    }
+
+    EXPECT_EQ(symbols * 4U, encoder->checksums_size());
+    EXPECT_EQ(encoder->checksums_size(), decoder->checksums_size());
+
+    std::vector<uint8_t> checksums(encoder->checksums_size());
+    encoder->write_checksums(&checksums[0]);
+    decoder->read_checksums(&checksums[0]);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        // The systematic symbols are verified as they arrive
+        if(systematic && !decoder->is_complete())
+        {
+            EXPECT_TRUE(decoder->is_symbol_verified(decoder->rank() - 1));
+        }
+    }
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        EXPECT_TRUE(decoder->is_symbol_verified(i));
+        EXPECT_EQ(encoder->symbol_checksum(i),
+                  kodo::crc32c(encoder->symbol(i), symbol_size));
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+    EXPECT_TRUE(decoder->is_intact());
+    EXPECT_EQ(0U, decoder->checksum_failures());
+}
+
+TEST(TestChecksum, decode)
+{
+    test_checksum_decode<fifi::binary>(16, 100, false);
+    test_checksum_decode<fifi::binary8>(16, 100, false);
+    test_checksum_decode<fifi::binary8>(16, 100, true);
+    test_checksum_decode<fifi::binary16>(16, 100, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_checksum_decode<fifi::binary8>(symbols, symbol_size, false);
+    test_checksum_decode<fifi::binary8>(symbols, symbol_size, true);
+}
+
+/// A corrupted coded payload makes the decoder fail the verification
+TEST(TestChecksum, corrupted)
+{
+    typedef kodo::checksum_full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::checksum_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 8;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> checksums(encoder->checksums_size());
+    encoder->write_checksums(&checksums[0]);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        // The symbol data is at the start of the payload
+        if(decoder->rank() == 0)
+        {
+            payload[0] ^= 0x80;
+        }
+
+        decoder->decode(&payload[0]);
+    }
+
+    // The checksums may also be set after the decoding
+    EXPECT_FALSE(decoder->is_intact());
+    decoder->read_checksums(&checksums[0]);
+
+    EXPECT_FALSE(decoder->is_intact());
+    EXPECT_GT(decoder->checksum_failures(), 0U);
+
+    // The verification is reset when the decoder is reused
+    decoder.reset();
+    decoder = decoder_factory.build();
+    EXPECT_EQ(0U, decoder->checksum_failures());
+    EXPECT_FALSE(decoder->is_symbol_verified(0));
+}
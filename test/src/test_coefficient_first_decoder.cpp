@@ -0,0 +1,125 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_coefficient_first_decoder.cpp Unit tests for the
+///       coefficient_first_decoder layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/coefficient_first_decoder.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// RLNC decoder which checks whether incoming symbols are
+    /// innovative before operating on the symbol data
+    template<class Field>
+    class full_rlnc_decoder_coefficient_first
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 coefficient_first_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 full_rlnc_decoder_coefficient_first<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+}
+
+template<class Field>
+void test_coefficient_first_decoder(uint32_t symbols, uint32_t symbol_size)
+{
+    invoke_basic_api<
+        kodo::full_rlnc_encoder<Field>,
+        kodo::full_rlnc_decoder_coefficient_first<Field>
+        >(symbols, symbol_size);
+
+    invoke_out_of_order_raw<
+        kodo::full_rlnc_encoder<Field>,
+        kodo::full_rlnc_decoder_coefficient_first<Field>
+        >(symbols, symbol_size);
+}
+
+/// Tests that decoding works with the layer in place
+TEST(TestCoefficientFirstDecoder, basic_api)
+{
+    test_coefficient_first_decoder<fifi::binary>(32, 1600);
+    test_coefficient_first_decoder<fifi::binary8>(32, 1600);
+    test_coefficient_first_decoder<fifi::binary16>(32, 1600);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_coefficient_first_decoder<fifi::binary8>(symbols, symbol_size);
+}
+
+/// Tests that a duplicate symbol is rejected without touching the
+/// symbol data
+TEST(TestCoefficientFirstDecoder, non_innovative)
+{
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 160;
+
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_type;
+    typedef kodo::full_rlnc_decoder_coefficient_first<fifi::binary8>
+        decoder_type;
+
+    encoder_type::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    decoder_type::factory decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    encoder->encode(&payload[0]);
+
+    // The payload is modified during decoding so keep a copy
+    std::vector<uint8_t> duplicate = payload;
+
+    decoder->decode(&payload[0]);
+    EXPECT_EQ(1U, decoder->rank());
+    EXPECT_EQ(0U, decoder->non_innovative_symbols());
+    EXPECT_EQ(0U, decoder->skipped_operations());
+
+    decoder->decode(&duplicate[0]);
+    EXPECT_EQ(1U, decoder->rank());
+    EXPECT_EQ(1U, decoder->non_innovative_symbols());
+    EXPECT_EQ(1U, decoder->skipped_operations());
+
+    // The counters must be reset when the decoder is reused
+    decoder->initialize(decoder_factory);
+    EXPECT_EQ(0U, decoder->non_innovative_symbols());
+    EXPECT_EQ(0U, decoder->skipped_operations());
+}
@@ -10,6 +10,7 @@
 
 #include <gtest/gtest.h>
 
+#include <sak/is_aligned.hpp>
 
 #include <kodo/final_coder_factory.hpp>
 #include <kodo/final_coder_factory_pool.hpp>
@@ -141,6 +142,9 @@ struct api_coefficients_storage
 
                 s = sak::storage(const_coder->coefficients_value(i), size);
                 EXPECT_TRUE(sak::equal(zero_storage, s));
+
+                // The vectors share one buffer but must all be aligned
+                EXPECT_TRUE(sak::is_aligned(coder->coefficients(i)));
             }
 
             // Create some random coefficients, one for every symbol
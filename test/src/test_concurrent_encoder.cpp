@@ -0,0 +1,140 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_concurrent_encoder.cpp Unit tests for the concurrent
+///       encoder
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include <sak/convert_endian.hpp>
+
+#include <kodo/concurrent_encoder.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes one block on several threads and decodes the payloads of
+/// all threads with a single decoder
+template<class Field>
+void test_concurrent_encoder(uint32_t symbols, uint32_t symbol_size,
+                             uint32_t threads)
+{
+    typedef kodo::concurrent_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+    typedef kodo::concurrent_encoder<encoder_t> concurrent_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    typename encoder_t::block_pointer block =
+        boost::make_shared<typename encoder_t::block_type>(
+            random_vector(encoder_factory.max_block_size()));
+
+    concurrent_t encoder(encoder_factory, block, threads);
+    EXPECT_EQ(threads, encoder.contexts());
+    EXPECT_EQ(0U, encoder.systematic_count());
+
+    uint32_t payload_size = encoder.context(0)->payload_size();
+
+    // Every thread encodes as many payloads as there are symbols
+    std::vector<std::vector<uint8_t> > payloads(threads,
+        std::vector<uint8_t>(symbols * payload_size));
+
+    std::vector<std::thread> workers;
+
+    for(uint32_t i = 0; i < threads; ++i)
+    {
+        workers.push_back(std::thread([&, i]()
+            {
+                const auto &context = encoder.context(i);
+
+                for(uint32_t j = 0; j < symbols; ++j)
+                {
+                    context->encode(&payloads[i][j * payload_size]);
+                }
+            }));
+    }
+
+    for(auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    EXPECT_EQ(symbols, encoder.systematic_count());
+
+    // Every systematic symbol was encoded by exactly one thread. The
+    // payload of the payload_encoder starts with the symbol data,
+    // followed by the systematic header.
+    std::vector<uint32_t> systematic(symbols, 0);
+
+    for(uint32_t i = 0; i < threads; ++i)
+    {
+        for(uint32_t j = 0; j < symbols; ++j)
+        {
+            const uint8_t *header =
+                &payloads[i][j * payload_size + symbol_size];
+
+            if(header[0] != kodo::systematic_base_coder::systematic_flag)
+                continue;
+
+            uint32_t index = sak::big_endian::get<
+                kodo::systematic_base_coder::counter_type>(header + 1);
+
+            ASSERT_LT(index, symbols);
+            ++systematic[index];
+        }
+    }
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        EXPECT_EQ(1U, systematic[i]);
+    }
+
+    auto decoder = decoder_factory.build();
+
+    for(uint32_t i = 0; i < threads && !decoder->is_complete(); ++i)
+    {
+        for(uint32_t j = 0; j < symbols && !decoder->is_complete(); ++j)
+        {
+            decoder->decode(&payloads[i][j * payload_size]);
+        }
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == *block);
+
+    // After a reset the systematic symbols are sent again
+    encoder.reset_systematic();
+    EXPECT_EQ(0U, encoder.systematic_count());
+
+    std::vector<uint8_t> payload(payload_size);
+    encoder.context(threads - 1)->encode(&payload[0]);
+
+    EXPECT_EQ(1U, encoder.systematic_count());
+    EXPECT_TRUE(payload[symbol_size] ==
+                kodo::systematic_base_coder::systematic_flag);
+}
+
+TEST(TestConcurrentEncoder, test_concurrent_encoder)
+{
+    test_concurrent_encoder<fifi::binary>(32, 160, 4);
+    test_concurrent_encoder<fifi::binary8>(32, 160, 4);
+    test_concurrent_encoder<fifi::binary16>(16, 160, 2);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_concurrent_encoder<fifi::binary8>(symbols, symbol_size, 3);
+}
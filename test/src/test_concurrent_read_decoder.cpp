@@ -0,0 +1,197 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_concurrent_read_decoder.cpp Unit test for the
+///       concurrent_read_decoder layer
+
+/// Tests:
+///   - layer::decode_symbol(uint8_t*,uint8_t*)
+///   - layer::decode_symbol(uint8_t*,uint32_t)
+///   - layer::is_symbol_ready(uint32_t) const
+///   - layer::ready_symbol(uint32_t) const
+///   - layer::copy_ready_symbol(uint32_t,const sak::mutable_storage&)
+///   - layer::symbols_ready() const
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Returns the systematic payloads of a block followed by as many
+/// coded payloads, in a random order
+template<class Encoder>
+std::vector<std::vector<uint8_t> > mixed_payloads(Encoder &encoder)
+{
+    std::vector<std::vector<uint8_t> > payloads(2 * encoder->symbols());
+
+    for(uint32_t i = 0; i < payloads.size(); ++i)
+    {
+        if(i == encoder->symbols())
+        {
+            encoder->set_systematic_off();
+        }
+
+        payloads[i].resize(encoder->payload_size());
+        encoder->encode(&payloads[i][0]);
+    }
+
+    std::random_shuffle(payloads.begin(), payloads.end());
+
+    return payloads;
+}
+
+/// Checks the published symbols while decoding on one thread
+template<class Field>
+void test_publish(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::concurrent_read_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    std::vector<std::vector<uint8_t> > payloads = mixed_payloads(encoder);
+
+    std::vector<uint8_t> symbol(symbol_size);
+
+    for(auto &payload : payloads)
+    {
+        if(decoder->is_complete())
+        {
+            break;
+        }
+
+        decoder->decode(&payload[0]);
+
+        uint32_t ready = 0;
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            if(!decoder->is_symbol_ready(i))
+            {
+                EXPECT_TRUE(decoder->ready_symbol(i) == 0);
+                continue;
+            }
+
+            ++ready;
+
+            // Published symbols are decoded and never change
+            const uint8_t *original = &data[i * symbol_size];
+
+            EXPECT_TRUE(std::equal(original, original + symbol_size,
+                                   decoder->ready_symbol(i)));
+
+            EXPECT_TRUE(decoder->copy_ready_symbol(
+                            i, sak::storage(symbol)));
+
+            EXPECT_TRUE(std::equal(symbol.begin(), symbol.end(),
+                                   original));
+        }
+
+        EXPECT_EQ(ready, decoder->symbols_ready());
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+    EXPECT_EQ(symbols, decoder->symbols_ready());
+
+    // A recycled decoder publishes nothing
+    decoder.reset();
+    decoder = decoder_factory.build();
+
+    EXPECT_EQ(0U, decoder->symbols_ready());
+    EXPECT_FALSE(decoder->is_symbol_ready(0));
+}
+
+TEST(TestConcurrentReadDecoder, test_publish)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_publish<fifi::binary>(symbols, symbol_size);
+    test_publish<fifi::binary8>(symbols, symbol_size);
+    test_publish<fifi::binary16>(symbols, symbol_size);
+}
+
+/// Reads the published symbols on another thread while decoding
+TEST(TestConcurrentReadDecoder, test_concurrent_read)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::concurrent_read_full_rlnc_decoder<fifi::binary8>
+        decoder_t;
+
+    uint32_t symbols = 64;
+    uint32_t symbol_size = 1400;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    std::vector<std::vector<uint8_t> > payloads = mixed_payloads(encoder);
+
+    std::atomic<uint32_t> mismatches(0);
+
+    std::thread reader([&]()
+        {
+            std::vector<bool> checked(symbols, false);
+            uint32_t read = 0;
+
+            while(read < symbols)
+            {
+                for(uint32_t i = 0; i < symbols; ++i)
+                {
+                    const uint8_t *symbol = decoder->ready_symbol(i);
+
+                    if(symbol == 0 || checked[i])
+                    {
+                        continue;
+                    }
+
+                    const uint8_t *original = &data[i * symbol_size];
+
+                    if(!std::equal(original, original + symbol_size,
+                                   symbol))
+                    {
+                        ++mismatches;
+                    }
+
+                    checked[i] = true;
+                    ++read;
+                }
+            }
+        });
+
+    for(auto &payload : payloads)
+    {
+        if(decoder->is_complete())
+        {
+            break;
+        }
+
+        decoder->decode(&payload[0]);
+    }
+
+    reader.join();
+
+    EXPECT_TRUE(decoder->is_complete());
+    EXPECT_EQ(0U, mismatches.load());
+}
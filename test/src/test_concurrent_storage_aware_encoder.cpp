@@ -0,0 +1,154 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_concurrent_storage_aware_encoder.cpp Unit tests for the
+///       concurrent_storage_aware_encoder
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/concurrent_storage_aware_encoder.hpp>
+#include <kodo/storage_aware_generator.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// The on-the-fly encoder of the encode_on_the_fly example, with
+    /// the symbols set by a producer thread
+    template<class Field>
+    class concurrent_on_the_fly_encoder
+        : public // Payload Codec API
+                 payload_encoder<
+                 // Codec Header API
+                 systematic_encoder<
+                 symbol_id_encoder<
+                 // Symbol ID API
+                 plain_symbol_id_writer<
+                 // Coefficient Generator API
+                 storage_aware_generator<
+                 uniform_generator<
+                 // Codec API
+                 encode_symbol_tracker<
+                 zero_symbol_encoder<
+                 linear_block_encoder<
+                 concurrent_storage_aware_encoder<
+                 // Coefficient Storage API
+                 coefficient_info<
+                 // Symbol Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 concurrent_on_the_fly_encoder<Field>
+                     > > > > > > > > > > > > > > > > >
+    { };
+}
+
+/// Tests:
+///   - layer::rank() const
+///   - layer::symbol_pivot(uint32_t) const
+TEST(TestConcurrentStorageAwareEncoder, rank)
+{
+    typedef kodo::concurrent_on_the_fly_encoder<fifi::binary8> encoder_t;
+
+    encoder_t::factory factory(10, 100);
+    auto encoder = factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    auto symbols = sak::split_storage(sak::storage(data_in), 100);
+
+    EXPECT_EQ(0U, encoder->rank());
+    EXPECT_FALSE(encoder->symbol_pivot(0));
+
+    encoder->set_symbol(0, symbols[0]);
+    encoder->set_symbol(1, symbols[1]);
+
+    EXPECT_EQ(2U, encoder->rank());
+    EXPECT_TRUE(encoder->symbol_pivot(1));
+    EXPECT_FALSE(encoder->symbol_pivot(2));
+
+    encoder->set_symbols(sak::storage(data_in));
+    EXPECT_EQ(10U, encoder->rank());
+
+    // A new block starts without symbols
+    encoder = factory.build();
+    EXPECT_EQ(0U, encoder->rank());
+}
+
+/// Sets the symbols on a producer thread while the payloads are
+/// encoded and decoded on this thread
+template<class Field>
+void test_concurrent_on_the_fly(uint32_t symbols, uint32_t symbol_size,
+                                bool systematic)
+{
+    typedef kodo::concurrent_on_the_fly_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    if(!systematic)
+    {
+        encoder->set_systematic_off();
+    }
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    auto symbol_storage =
+        sak::split_storage(sak::storage(data_in), symbol_size);
+
+    std::thread producer([&]
+        {
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                encoder->set_symbol(i, symbol_storage[i]);
+                std::this_thread::yield();
+            }
+        });
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        // The decoder never gets ahead of the symbols set
+        EXPECT_TRUE(decoder->rank() <= encoder->rank());
+    }
+
+    producer.join();
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestConcurrentStorageAwareEncoder, threads)
+{
+    test_concurrent_on_the_fly<fifi::binary8>(32, 1600, true);
+    test_concurrent_on_the_fly<fifi::binary8>(32, 1600, false);
+    test_concurrent_on_the_fly<fifi::binary>(32, 1600, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_concurrent_on_the_fly<fifi::binary16>(symbols, symbol_size, false);
+}
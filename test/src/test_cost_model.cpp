@@ -0,0 +1,234 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_cost_model.cpp Unit tests for the cost model of the
+///       coder stacks
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/cost_model.hpp>
+#include <kodo/finite_field_counter.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Full vector RLNC encoder counting the finite field operations
+    template<class Field>
+    class full_rlnc_encoder_cost :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_counter<
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               full_rlnc_encoder_cost<Field>
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+    /// Full vector RLNC decoder counting the finite field operations
+    template<class Field>
+    class full_rlnc_decoder_cost :
+        public // Payload API
+               payload_decoder<
+               // Codec Header API
+               systematic_decoder<
+               symbol_id_decoder<
+               // Symbol ID API
+               plain_symbol_id_reader<
+               // Codec API
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               // Coefficient Storage API
+               coefficient_storage<
+               coefficient_info<
+               // Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_counter<
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               full_rlnc_decoder_cost<Field>
+                   > > > > > > > > > > > > > > >
+    { };
+
+}
+
+/// @return A profile of a generation following the model exactly
+kodo::operations_profile model_profile(uint32_t symbols,
+                                       uint32_t symbol_size)
+{
+    kodo::operations_profile profile;
+
+    // 2 + k/4 bytes of symbol data and k + k^2 / 2 coefficient bytes
+    // are processed per delivered byte respectively symbol
+    double k = symbols;
+
+    profile.m_multiply_add.m_symbol.m_bytes =
+        uint64_t((2.0 + k / 4.0) * k * symbol_size);
+    profile.m_multiply_add.m_symbol.m_calls = 100;
+    profile.m_multiply_add.m_symbol.m_samples = 10;
+    profile.m_multiply_add.m_symbol.m_sampled_ticks =
+        profile.m_multiply_add.m_symbol.m_bytes / 10;
+
+    profile.m_multiply.m_coefficient.m_bytes =
+        uint64_t((k + k * k / 2.0) * k);
+
+    return profile;
+}
+
+TEST(TestCostModel, fit)
+{
+    kodo::cost_model model;
+    model.set_ticks_per_ns(2.0);
+
+    uint32_t symbol_size = 1000;
+
+    model.add_sample(16, symbol_size, model_profile(16, symbol_size));
+    model.add_sample(64, symbol_size, model_profile(64, symbol_size));
+    model.add_sample(32, symbol_size, model_profile(32, symbol_size));
+
+    EXPECT_NEAR(2.0 + 100 / 4.0, model.symbol_bytes(100, symbol_size),
+                1e-6);
+    EXPECT_NEAR((100 + 100 * 100 / 2.0) / 200,
+                model.coefficient_bytes(100, 200), 1e-6);
+
+    // All symbol operations were timed at 1 tick per byte, no rate is
+    // known for the coefficients
+    EXPECT_DOUBLE_EQ(0.5, model.symbol_ns_per_byte());
+    EXPECT_DOUBLE_EQ(0.0, model.coefficient_ns_per_byte());
+
+    kodo::cost_estimate cost = model.estimate(100, 200);
+    EXPECT_NEAR(0.5 * (2.0 + 100 / 4.0), cost.m_nanoseconds, 1e-6);
+
+    // The multiply_add reads two buffers and writes one, the multiply
+    // reads and writes one
+    EXPECT_NEAR(3 * (2.0 + 100 / 4.0) + 2 * (100 + 100 * 100 / 2.0) / 200,
+                cost.m_memory_bytes, 1e-6);
+
+    model.set_rates(1.0, 2.0);
+    cost = model.estimate(100, 200);
+    EXPECT_NEAR((2.0 + 100 / 4.0) + 2.0 * (100 + 100 * 100 / 2.0) / 200,
+                cost.m_nanoseconds, 1e-6);
+
+    // The largest generation within 10 ns, 2 + k/4 + (k + k^2/2) / 50
+    EXPECT_EQ(17U, model.max_symbols(100, 10.0, 1000));
+    EXPECT_EQ(0U, model.max_symbols(100, 1.0, 1000));
+}
+
+TEST(TestCostModel, single_generation_size)
+{
+    kodo::cost_model model;
+    model.add_sample(16, 100, model_profile(16, 100));
+
+    // Only the term growing with the generation size is fitted
+    EXPECT_NEAR(2.0 + 16 / 4.0, model.symbol_bytes(16, 100), 1e-6);
+    EXPECT_NEAR(2.0 * (2.0 + 16 / 4.0), model.symbol_bytes(32, 100), 1e-6);
+}
+
+/// Calibrates the models of a field and compares them with a
+/// generation size which was not sampled
+template<class Field>
+void test_calibrate(uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder_cost<Field> encoder_type;
+    typedef kodo::full_rlnc_decoder_cost<Field> decoder_type;
+
+    kodo::cost_model encoder_model;
+    kodo::cost_model decoder_model;
+
+    std::vector<uint32_t> symbols = { 8, 16, 32, 64 };
+
+    kodo::calibrate_cost_models<encoder_type, decoder_type>(
+        encoder_model, decoder_model, symbols, symbol_size, 4);
+
+    EXPECT_TRUE(encoder_model.symbol_ns_per_byte() > 0);
+    EXPECT_TRUE(decoder_model.symbol_ns_per_byte() > 0);
+
+    EXPECT_TRUE(encoder_model.estimate(48, symbol_size).m_nanoseconds > 0);
+    EXPECT_TRUE(decoder_model.estimate(48, symbol_size).m_memory_bytes > 0);
+
+    // Count a generation of 48 symbols
+    typename encoder_type::factory encoder_factory(48, symbol_size);
+    typename decoder_type::factory decoder_factory(48, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    encoder->reset_operations_counter();
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    double delivered = double(encoder->block_size());
+
+    auto check = [&](const kodo::cost_model &model,
+                     const kodo::operations_profile &profile)
+        {
+            double measured = (profile.m_multiply.m_symbol.m_bytes +
+                profile.m_multiply_add.m_symbol.m_bytes +
+                profile.m_add.m_symbol.m_bytes +
+                profile.m_multiply_subtract.m_symbol.m_bytes +
+                profile.m_subtract.m_symbol.m_bytes) / delivered;
+
+            double estimated = model.symbol_bytes(48, symbol_size);
+
+            EXPECT_NEAR(measured, estimated, 0.2 * measured);
+        };
+
+    check(encoder_model, encoder->get_operations_profile());
+    check(decoder_model, decoder->get_operations_profile());
+
+    // Larger generations cost more per byte
+    EXPECT_TRUE(decoder_model.estimate(128, symbol_size).m_memory_bytes >
+                decoder_model.estimate(16, symbol_size).m_memory_bytes);
+}
+
+TEST(TestCostModel, calibrate)
+{
+    test_calibrate<fifi::binary>(100);
+    test_calibrate<fifi::binary8>(100);
+    test_calibrate<fifi::binary16>(100);
+}
@@ -0,0 +1,258 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_data_plane.cpp Unit test for the data plane and the
+///       data_plane_full_rlnc_encoder
+
+/// Tests:
+///   - host_data_plane::multiply_block()
+///   - data_plane_batch_encoder::end_batch()
+///   - data_plane_finite_field_math::multiply_block()
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/data_plane.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    /// A host_data_plane counting the blocks it computes
+    template<class FieldImpl>
+    class counting_data_plane : public kodo::host_data_plane<FieldImpl>
+    {
+    public:
+
+        typedef kodo::host_data_plane<FieldImpl> Super;
+        typedef typename Super::value_type value_type;
+
+        counting_data_plane(uint32_t tile_size)
+            : Super(tile_size),
+              m_blocks(0)
+        { }
+
+        void multiply_block(value_type **destinations, uint32_t count,
+                            const value_type **symbols_src,
+                            uint32_t sources, const value_type *matrix,
+                            uint32_t symbol_length)
+        {
+            ++m_blocks;
+            Super::multiply_block(destinations, count, symbols_src,
+                                  sources, matrix, symbol_length);
+        }
+
+        uint32_t m_blocks;
+    };
+}
+
+/// Compares the tiled product of the host_data_plane with a product
+/// computed one destination at a time
+template<class Field>
+void test_multiply_block(uint32_t count, uint32_t sources,
+                         uint32_t symbol_size, uint32_t tile_size)
+{
+    typedef typename fifi::default_field<Field>::type field_impl;
+    typedef typename Field::value_type value_type;
+
+    kodo::host_data_plane<field_impl> plane(tile_size);
+    field_impl field;
+
+    uint32_t length = fifi::size_to_length<Field>(symbol_size);
+
+    std::vector<std::vector<value_type> > src(sources);
+    std::vector<const value_type*> src_ptrs(sources);
+
+    for(uint32_t i = 0; i < sources; ++i)
+    {
+        std::vector<uint8_t> data = random_vector(symbol_size);
+        src[i].resize(length);
+        std::copy_n(reinterpret_cast<value_type*>(&data[0]), length,
+                    &src[i][0]);
+        src_ptrs[i] = &src[i][0];
+    }
+
+    // Every third entry is zero and the last row is all zeros
+    std::vector<value_type> matrix(count * sources);
+
+    for(uint32_t j = 0; j < count; ++j)
+    {
+        for(uint32_t i = 0; i < sources; ++i)
+        {
+            value_type value = rand() % (Field::max_value + 1);
+
+            if((j * sources + i) % 3 == 0 || j + 1 == count)
+            {
+                value = 0;
+            }
+
+            matrix[j * sources + i] = value;
+        }
+    }
+
+    std::vector<std::vector<value_type> > dest(
+        count, std::vector<value_type>(length, 1));
+    std::vector<value_type*> dest_ptrs(count);
+
+    for(uint32_t j = 0; j < count; ++j)
+    {
+        dest_ptrs[j] = &dest[j][0];
+    }
+
+    plane.multiply_block(&dest_ptrs[0], count, &src_ptrs[0], sources,
+                         &matrix[0], length);
+
+    std::vector<value_type> temp(length);
+
+    for(uint32_t j = 0; j < count; ++j)
+    {
+        std::vector<value_type> expected(length, 0);
+
+        for(uint32_t i = 0; i < sources; ++i)
+        {
+            value_type value = matrix[j * sources + i];
+
+            if(value == 0)
+            {
+                continue;
+            }
+
+            fifi::multiply_add(field, value, &expected[0], &src[i][0],
+                               &temp[0], length);
+        }
+
+        EXPECT_TRUE(expected == dest[j]);
+    }
+}
+
+TEST(TestDataPlane, multiply_block)
+{
+    test_multiply_block<fifi::binary>(4, 8, 1600, 64);
+    test_multiply_block<fifi::binary8>(4, 8, 1600, 64);
+    test_multiply_block<fifi::binary8>(1, 1, 100, 16384);
+    test_multiply_block<fifi::binary16>(5, 3, 1000, 300);
+}
+
+/// Encodes batches with the data_plane_full_rlnc_encoder and checks
+/// that they decode and how many blocks the data plane computed
+template<class Field>
+void test_batch_encode(uint32_t symbols, uint32_t symbol_size,
+                       uint32_t batch_size, bool offload)
+{
+    typedef kodo::data_plane_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+    typedef typename fifi::default_field<Field>::type field_impl;
+
+    counting_data_plane<field_impl> plane(256);
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    encoder_factory.set_data_plane(&plane);
+    encoder_factory.set_offload_size(offload ? symbol_size : symbol_size + 1);
+
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(&plane, encoder->data_plane());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<std::vector<uint8_t> > payloads(
+        batch_size, std::vector<uint8_t>(encoder->payload_size()));
+
+    std::vector<uint8_t*> buffers(batch_size);
+    for(uint32_t i = 0; i < batch_size; ++i)
+    {
+        buffers[i] = &payloads[i][0];
+    }
+
+    uint32_t batches = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&buffers[0], batch_size);
+        ++batches;
+
+        for(uint32_t i = 0; i < batch_size; ++i)
+        {
+            decoder->decode(buffers[i]);
+        }
+    }
+
+    // One block per batch when offloaded, none otherwise
+    EXPECT_EQ(offload ? batches : 0U, plane.m_blocks);
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestDataPlane, batch_encode)
+{
+    test_batch_encode<fifi::binary>(32, 1600, 8, true);
+    test_batch_encode<fifi::binary8>(32, 1600, 8, true);
+    test_batch_encode<fifi::binary16>(16, 1600, 5, true);
+    test_batch_encode<fifi::binary8>(1, 1600, 3, true);
+
+    test_batch_encode<fifi::binary8>(32, 1600, 8, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_batch_encode<fifi::binary8>(symbols, symbol_size, 4, true);
+}
+
+/// Checks that the encoder works on the calling thread without a data
+/// plane, both for single payloads and batches
+TEST(TestDataPlane, no_data_plane)
+{
+    typedef kodo::data_plane_full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 1000;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_TRUE(encoder->data_plane() == 0);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> first(encoder->payload_size());
+    std::vector<uint8_t> second(encoder->payload_size());
+    uint8_t *buffers[] = { &first[0], &second[0] };
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&first[0]);
+        decoder->decode(&first[0]);
+
+        encoder->encode(buffers, 2);
+        decoder->decode(&first[0]);
+        decoder->decode(&second[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
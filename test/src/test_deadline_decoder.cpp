@@ -0,0 +1,167 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_deadline_decoder.cpp Unit tests for the deadline_decoder
+
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/deadline_decoder.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes an object whose blocks have different deadlines
+TEST(TestDeadlineDecoder, test_deadline_decoder)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+    typedef kodo::object_encoder<storage_reader, encoder_t> object_encoder;
+    typedef kodo::object_decoder<decoder_t> object_decoder;
+
+    typedef kodo::deadline_decoder<object_decoder> deadline_decoder;
+    typedef deadline_decoder::time_point time_point;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 64;
+    uint32_t object_size = 4 * max_symbols * max_symbol_size;
+
+    encoder_t::factory encoder_factory(max_symbols, max_symbol_size);
+    decoder_t::factory decoder_factory(max_symbols, max_symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    storage_reader reader(sak::storage(data_in));
+    object_encoder encoders(encoder_factory, reader);
+    object_decoder decoders(decoder_factory, object_size);
+
+    deadline_decoder deadlines(decoders);
+
+    ASSERT_EQ(4U, deadlines.blocks());
+
+    std::vector<encoder_t::pointer> generations;
+
+    for(uint32_t i = 0; i < encoders.encoders(); ++i)
+    {
+        generations.push_back(encoders.build(i));
+    }
+
+    time_point now = time_point();
+    auto budget = std::chrono::hours(1);
+
+    // Block 0 is due first, then block 3, and block 1 will expire
+    deadlines.set_deadline(0, now + std::chrono::seconds(1));
+    deadlines.set_deadline(1, now + std::chrono::seconds(20));
+    deadlines.set_deadline(3, now + std::chrono::seconds(10));
+
+    EXPECT_EQ(time_point::max(), deadlines.deadline(2));
+
+    std::vector<uint8_t> payload(encoder_factory.max_payload_size());
+
+    // The systematic payloads of all blocks arrive
+    for(uint32_t i = 0; i < max_symbols; ++i)
+    {
+        for(uint32_t j = 0; j < generations.size(); ++j)
+        {
+            uint32_t size = generations[j]->encode(&payload[0]);
+            EXPECT_TRUE(deadlines.receive(j, &payload[0], size, now));
+        }
+    }
+
+    EXPECT_EQ(4 * max_symbols, deadlines.queued());
+
+    // Decoding one block worth of payloads completes the earliest
+    // deadline first
+    EXPECT_EQ(max_symbols, deadlines.run(now, budget, max_symbols));
+
+    EXPECT_TRUE(deadlines.is_complete(0));
+    EXPECT_FALSE(deadlines.is_complete(3));
+    EXPECT_EQ(0U, deadlines.queued(0));
+    EXPECT_EQ(max_symbols, deadlines.queued(3));
+
+    // Block 0 is complete, so its payloads are shed
+    uint32_t size = generations[0]->encode(&payload[0]);
+    EXPECT_FALSE(deadlines.receive(0, &payload[0], size, now));
+    EXPECT_EQ(1U, deadlines.statistics().m_shed_complete);
+
+    // Block 3 is next
+    EXPECT_EQ(max_symbols, deadlines.run(now, budget, max_symbols));
+    EXPECT_TRUE(deadlines.is_complete(3));
+    EXPECT_FALSE(deadlines.is_complete(1));
+
+    // Block 1 expires, its queue is shed without decoding
+    now += std::chrono::seconds(30);
+
+    EXPECT_EQ(max_symbols, deadlines.run(now, budget));
+
+    EXPECT_FALSE(deadlines.is_complete(1));
+    EXPECT_TRUE(deadlines.is_complete(2));
+    EXPECT_EQ(0U, deadlines.queued());
+
+    size = generations[1]->encode(&payload[0]);
+    EXPECT_FALSE(deadlines.receive(1, &payload[0], size, now));
+
+    const kodo::deadline_statistics &statistics = deadlines.statistics();
+
+    EXPECT_EQ(4 * max_symbols + 2, statistics.m_received);
+    EXPECT_EQ(3 * max_symbols, statistics.m_decoded);
+    EXPECT_EQ(max_symbols + 1, statistics.m_shed_expired);
+    EXPECT_EQ(1U, statistics.m_shed_complete);
+    EXPECT_EQ(max_symbols + 2, statistics.shed());
+    EXPECT_EQ(3U, statistics.m_completed_blocks);
+    EXPECT_EQ(1U, statistics.m_expired_blocks);
+
+    // The decoded blocks hold the object data
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, object_size);
+
+    for(uint32_t i = 0; i < deadlines.blocks(); ++i)
+    {
+        if(!deadlines.is_complete(i))
+            continue;
+
+        std::vector<uint8_t> data_out(partitioning.bytes_used(i));
+        deadlines.decoder(i)->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(std::equal(data_out.begin(), data_out.end(),
+                               &data_in[partitioning.byte_offset(i)]));
+    }
+}
+
+/// Payloads arriving after the deadline of their block are shed
+TEST(TestDeadlineDecoder, test_expired_on_receive)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+    typedef kodo::object_decoder<decoder_t> object_decoder;
+    typedef kodo::deadline_decoder<object_decoder> deadline_decoder;
+
+    decoder_t::factory decoder_factory(8, 32);
+    object_decoder decoders(decoder_factory, 8 * 32);
+
+    deadline_decoder deadlines(decoders);
+    ASSERT_EQ(1U, deadlines.blocks());
+
+    auto now = deadline_decoder::time_point();
+    deadlines.set_deadline(0, now);
+
+    std::vector<uint8_t> payload(decoder_factory.max_payload_size(), 0);
+
+    uint32_t size = static_cast<uint32_t>(payload.size());
+
+    EXPECT_FALSE(deadlines.receive(0, &payload[0], size, now));
+    EXPECT_EQ(0U, deadlines.queued());
+    EXPECT_EQ(1U, deadlines.statistics().m_shed_expired);
+    EXPECT_EQ(1U, deadlines.statistics().m_expired_blocks);
+    EXPECT_EQ(0U, deadlines.run(now, std::chrono::seconds(1)));
+}
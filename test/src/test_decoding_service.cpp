@@ -0,0 +1,262 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_decoding_service.cpp Unit test for the decoding_service
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/decoding_service.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rfc5052_partitioning_scheme.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes a number of sessions at the same time
+template<class Field>
+void test_decoding_service(uint32_t max_symbols, uint32_t max_symbol_size,
+                           uint32_t sessions, uint32_t threads)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+    typedef kodo::object_encoder<storage_reader, encoder_t> object_encoder;
+
+    typedef kodo::decoding_service<decoder_t> service_t;
+
+    typename encoder_t::factory encoder_factory(
+        max_symbols, max_symbol_size);
+
+    std::vector<std::vector<uint8_t> > data_in(sessions);
+    std::vector<std::vector<uint8_t> > data_out(sessions);
+
+    uint32_t total_blocks = 0;
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        uint32_t object_size =
+            rand_nonzero(max_symbols * max_symbol_size * 4);
+
+        data_in[i] = random_vector(object_size);
+        data_out[i].resize(object_size);
+
+        kodo::rfc5052_partitioning_scheme partitioning(
+            max_symbols, max_symbol_size, object_size);
+
+        total_blocks += partitioning.blocks();
+    }
+
+    std::atomic<uint32_t> completed(0);
+
+    auto callback = [&](uint32_t session_id, uint32_t block_id,
+                        const typename decoder_t::pointer &decoder)
+        {
+            ASSERT_TRUE(session_id < sessions);
+            ASSERT_TRUE(decoder->is_complete());
+
+            kodo::rfc5052_partitioning_scheme partitioning(
+                max_symbols, max_symbol_size, data_out[session_id].size());
+
+            // The blocks are copied to disjoint parts of the output
+            decoder->copy_symbols(sak::storage(
+                &data_out[session_id][partitioning.byte_offset(block_id)],
+                partitioning.bytes_used(block_id)));
+
+            ++completed;
+        };
+
+    service_t service(max_symbols, max_symbol_size, callback, threads, 64);
+
+    if(threads > 0)
+    {
+        EXPECT_EQ(threads, service.workers());
+    }
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        service.open_session(i, data_in[i].size());
+    }
+
+    std::vector<storage_reader> readers;
+    std::vector<std::unique_ptr<object_encoder> > encoders;
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        readers.push_back(storage_reader(sak::storage(data_in[i])));
+    }
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        encoders.emplace_back(
+            new object_encoder(encoder_factory, readers[i]));
+    }
+
+    std::vector<uint8_t> payload(encoder_factory.max_payload_size());
+
+    // Interleave the payloads of all generations of all sessions, the
+    // encoders are not systematic so redundant payloads are useful
+    std::vector<std::vector<typename encoder_t::pointer> > generations(
+        sessions);
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        for(uint32_t j = 0; j < encoders[i]->encoders(); ++j)
+        {
+            generations[i].push_back(encoders[i]->build(j));
+            generations[i].back()->set_systematic_off();
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    while(completed.load() < total_blocks)
+    {
+        for(uint32_t i = 0; i < sessions; ++i)
+        {
+            for(uint32_t j = 0; j < generations[i].size(); ++j)
+            {
+                uint32_t size = generations[i][j]->encode(&payload[0]);
+
+                while(!service.decode(i, j, &payload[0], size))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ASSERT_TRUE(elapsed < std::chrono::seconds(60));
+    }
+
+    EXPECT_EQ(total_blocks, completed.load());
+
+    // Completed generations drop further payloads
+    uint32_t size = generations[0][0]->encode(&payload[0]);
+    service.decode(0, 0, &payload[0], size);
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        service.close_session(i);
+    }
+
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        EXPECT_TRUE(data_in[i] == data_out[i]);
+    }
+}
+
+TEST(TestDecodingService, decode_sessions)
+{
+    test_decoding_service<fifi::binary8>(16, 100, 10, 4);
+    test_decoding_service<fifi::binary>(8, 200, 5, 1);
+    test_decoding_service<fifi::binary16>(10, 64, 3, 0);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_decoding_service<fifi::binary8>(symbols, symbol_size, 4, 2);
+}
+
+/// Payloads which are not of the payload size of their decoder are
+/// dropped, also when they fit the slots of the queue
+TEST(TestDecodingService, drop_invalid_sizes)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    typedef kodo::decoding_service<decoder_t> service_t;
+
+    // Objects of a single symbol, so the decoders have smaller
+    // payloads than the slots sized for two symbols
+    uint32_t symbol_size = 100;
+
+    encoder_t::factory encoder_factory(1, symbol_size);
+    auto encoder = encoder_factory.build();
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(symbol_size);
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> data_out(symbol_size);
+
+    std::atomic<uint32_t> completed(0);
+    std::atomic<bool> dropped(false);
+
+    auto callback = [&](uint32_t session_id, uint32_t,
+                        const decoder_t::pointer &decoder)
+        {
+            if(session_id == 1)
+            {
+                // The payloads of session 0 queued before were handled
+                dropped = (completed.load() == 0);
+                return;
+            }
+
+            decoder->copy_symbols(sak::storage(data_out));
+            ++completed;
+        };
+
+    // A single worker with a single slot, so every payload is processed
+    // in order and written over the previous one
+    service_t service(2, symbol_size, callback, 1, 1);
+
+    service.open_session(0, symbol_size);
+    service.open_session(1, symbol_size);
+
+    std::vector<uint8_t> payload(encoder_factory.max_payload_size() + 1);
+    uint32_t size = encoder->encode(&payload[0]);
+
+    ASSERT_EQ(encoder->payload_size(), size);
+
+    // An oversized payload followed by the same payload truncated by a
+    // byte, which would leave the slot holding the complete payload
+    while(!service.decode(0, 0, &payload[0], size + 1))
+    {
+        std::this_thread::yield();
+    }
+
+    while(!service.decode(0, 0, &payload[0], size - 1))
+    {
+        std::this_thread::yield();
+    }
+
+    // A payload larger than the slots is rejected right away
+    std::vector<uint8_t> large(symbol_size * 4);
+    EXPECT_FALSE(service.decode(0, 0, &large[0],
+                                static_cast<uint32_t>(large.size())));
+
+    // Completing session 1 shows that session 0 is still incomplete,
+    // the service copies the payload so it may be queued again
+    while(!service.decode(1, 0, &payload[0], size))
+    {
+        std::this_thread::yield();
+    }
+
+    while(!service.decode(0, 0, &payload[0], size))
+    {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    while(completed.load() == 0)
+    {
+        std::this_thread::yield();
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ASSERT_TRUE(elapsed < std::chrono::seconds(60));
+    }
+
+    EXPECT_TRUE(dropped.load());
+    EXPECT_TRUE(data_in == data_out);
+}
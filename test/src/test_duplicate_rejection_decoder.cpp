@@ -0,0 +1,204 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_duplicate_rejection_decoder.cpp Unit tests for the early
+///       rejection of non-innovative packets
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/duplicate_rejection_decoder.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Full vector RLNC decoder rejecting duplicate packets
+    template<class Field>
+    class rejecting_rlnc_decoder :
+        public // Payload API
+               payload_decoder<
+               // Codec Header API
+               duplicate_rejection_decoder<
+               systematic_decoder<
+               symbol_id_decoder<
+               // Symbol ID API
+               plain_symbol_id_reader<
+               // Codec API
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               // Coefficient Storage API
+               coefficient_storage<
+               coefficient_info<
+               // Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               rejecting_rlnc_decoder<Field>
+               > > > > > > > > > > > > > > >
+    { };
+
+    /// Seed based RLNC decoder rejecting duplicate seeds
+    template<class Field>
+    class rejecting_seed_rlnc_decoder :
+        public // Payload API
+               payload_decoder<
+               // Codec Header API
+               duplicate_rejection_decoder<
+               systematic_decoder<
+               symbol_id_decoder<
+               // Symbol ID API
+               seed_symbol_id_reader<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               // Coefficient Storage API
+               coefficient_storage<
+               coefficient_info<
+               // Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               rejecting_seed_rlnc_decoder<Field>
+               > > > > > > > > > > > > > > > >
+    { };
+}
+
+/// Decodes every coded packet twice and checks that the copies are
+/// rejected without touching the symbol data
+template<class Encoder, class Decoder>
+void invoke_duplicates(uint32_t symbols, uint32_t symbol_size)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    uint32_t rejected = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        std::vector<uint8_t> copy = payload;
+        std::vector<uint8_t> duplicate = payload;
+        decoder->decode(&payload[0]);
+
+        uint32_t rank = decoder->rank();
+        decoder->decode(&duplicate[0]);
+        ++rejected;
+
+        EXPECT_EQ(rank, decoder->rank());
+        EXPECT_EQ(rejected, decoder->rejected_packets());
+
+        // The decoder works on the symbol data in place, a rejected
+        // packet is left as received
+        EXPECT_TRUE(copy == duplicate);
+    }
+
+    // Packets after completion are rejected
+    encoder->encode(&payload[0]);
+    std::vector<uint8_t> copy = payload;
+
+    decoder->decode(&payload[0]);
+    EXPECT_EQ(rejected + 1, decoder->rejected_packets());
+    EXPECT_TRUE(copy == payload);
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(data_in == data_out);
+
+    // The rejection state is reset when the decoder is built again
+    decoder = decoder_factory.build();
+    EXPECT_EQ(0U, decoder->rejected_packets());
+}
+
+TEST(TestDuplicateRejectionDecoder, full_vector)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_duplicates<
+        kodo::full_rlnc_encoder<fifi::binary>,
+        kodo::rejecting_rlnc_decoder<fifi::binary> >(
+            symbols, symbol_size);
+
+    invoke_duplicates<
+        kodo::full_rlnc_encoder<fifi::binary8>,
+        kodo::rejecting_rlnc_decoder<fifi::binary8> >(
+            symbols, symbol_size);
+}
+
+TEST(TestDuplicateRejectionDecoder, seed)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_duplicates<
+        kodo::seed_rlnc_encoder<fifi::binary8>,
+        kodo::rejecting_seed_rlnc_decoder<fifi::binary8> >(
+            symbols, symbol_size);
+
+    invoke_duplicates<
+        kodo::seed_rlnc_encoder<fifi::binary16>,
+        kodo::rejecting_seed_rlnc_decoder<fifi::binary16> >(
+            symbols, symbol_size);
+}
+
+/// Systematic packets are passed to the codec layers
+TEST(TestDuplicateRejectionDecoder, systematic)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::rejecting_rlnc_decoder<fifi::binary8> decoder_t;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_EQ(symbols, decoder->rank());
+    EXPECT_EQ(0U, decoder->rejected_packets());
+}
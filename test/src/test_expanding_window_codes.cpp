@@ -0,0 +1,222 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_expanding_window_codes.cpp Unit tests for the expanding
+///       window RLNC codes
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/expanding_window_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes and decodes a block with the given windows
+template<class Field>
+void test_expanding_window_codes(uint32_t symbols, uint32_t symbol_size,
+                                 const std::vector<uint32_t> &windows,
+                                 bool systematic)
+{
+    typedef kodo::expanding_window_rlnc_encoder<Field> encoder_t;
+    typedef kodo::expanding_window_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    encoder_factory.set_windows(windows);
+
+    typename encoder_t::pointer encoder = encoder_factory.build();
+    typename decoder_t::pointer decoder = decoder_factory.build();
+
+    // The last window always spans the block
+    ASSERT_GT(encoder->windows(), 0U);
+    EXPECT_EQ(symbols, encoder->window_size(encoder->windows() - 1));
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    if(!systematic)
+    {
+        kodo::set_systematic_off(encoder);
+    }
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint32_t decoded_prefix = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        // Lose some of the payloads
+        if(rand() % 4 == 0)
+            continue;
+
+        decoder->decode(&payload[0]);
+
+        EXPECT_GE(decoder->decoded_prefix(), decoded_prefix);
+        decoded_prefix = decoder->decoded_prefix();
+
+        // The decoded prefix holds the original symbols
+        EXPECT_TRUE(std::equal(
+            decoder->symbol(0),
+            decoder->symbol(0) + decoded_prefix * symbol_size,
+            data_in.begin()));
+    }
+
+    EXPECT_EQ(symbols, decoder->decoded_prefix());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestExpandingWindowCodes, decode)
+{
+    std::vector<uint32_t> windows = {8, 24, 64};
+
+    test_expanding_window_codes<fifi::binary>(64, 100, windows, false);
+    test_expanding_window_codes<fifi::binary8>(64, 160, windows, false);
+    test_expanding_window_codes<fifi::binary16>(64, 40, windows, false);
+
+    test_expanding_window_codes<fifi::binary>(64, 100, windows, true);
+    test_expanding_window_codes<fifi::binary8>(64, 160, windows, true);
+
+    // Windows larger than the block, and a single window
+    test_expanding_window_codes<fifi::binary8>(16, 100, windows, false);
+    test_expanding_window_codes<fifi::binary8>(
+        32, 100, std::vector<uint32_t>(), false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    std::vector<uint32_t> random_windows =
+        {(rand() % symbols) + 1, symbols};
+
+    std::sort(random_windows.begin(), random_windows.end());
+
+    test_expanding_window_codes<fifi::binary>(
+        symbols, symbol_size, random_windows, false);
+    test_expanding_window_codes<fifi::binary8>(
+        symbols, symbol_size, random_windows, true);
+}
+
+/// Tests that the window of the base layer decodes long before the
+/// block is complete
+TEST(TestExpandingWindowCodes, early_window)
+{
+    typedef kodo::expanding_window_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::expanding_window_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 64;
+    uint32_t symbol_size = 100;
+    uint32_t base_window = 8;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    // Half of the vectors only code the base layer
+    encoder_factory.set_windows({base_window, 32, symbols}, {2, 1, 1});
+
+    encoder_t::pointer encoder = encoder_factory.build();
+    decoder_t::pointer decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint32_t received = 0;
+
+    while(!decoder->is_window_decoded(base_window))
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        ++received;
+    }
+
+    EXPECT_FALSE(decoder->is_complete());
+    EXPECT_LT(decoder->rank(), symbols);
+    EXPECT_LT(received, symbols);
+
+    EXPECT_TRUE(std::equal(
+        decoder->symbol(0), decoder->symbol(0) + base_window * symbol_size,
+        data_in.begin()));
+
+    // The decoded symbols are uncoded, so they are not decoded again
+    for(uint32_t i = 0; i < base_window; ++i)
+    {
+        EXPECT_TRUE(decoder->symbol_pivot(i));
+        EXPECT_FALSE(decoder->symbol_coded(i));
+    }
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+/// Tests that an uncoded symbol received at the pivot of a coded
+/// symbol takes its place
+TEST(TestExpandingWindowCodes, systematic_swap)
+{
+    typedef kodo::expanding_window_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::expanding_window_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 32;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    encoder_t::pointer encoder = encoder_factory.build();
+    decoder_t::pointer decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(decoder->rank() < symbols / 2)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_EQ(0U, decoder->decoded_prefix());
+
+    // The first symbol is a window of its own once it is uncoded
+    decoder->decode_symbol(&data_in[0], 0U);
+
+    EXPECT_EQ(symbols / 2 + 1, decoder->rank());
+    EXPECT_GE(decoder->decoded_prefix(), 1U);
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
@@ -7,12 +7,58 @@
 
 #include <gtest/gtest.h>
 
+#include <kodo/file_decoder.hpp>
 #include <kodo/file_encoder.hpp>
+#include <kodo/mmap_file_encoder.hpp>
 #include <kodo/object_decoder.hpp>
+#include <kodo/partial_shallow_symbol_storage.hpp>
+#include <kodo/read_ahead_file_encoder.hpp>
+#include <kodo/segment_file_encoder.hpp>
 #include <kodo/rlnc/full_vector_codes.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// RLNC encoder using shallow storage so that the symbols can point
+    /// directly into a memory mapped file
+    template<class Field>
+    class shallow_rlnc_encoder :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               partial_shallow_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               shallow_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+}
+
 // Tests that encoding and decoding a file withe the file encoder
 // works.
 TEST(TestFileEncoder, test_file_encoder)
@@ -107,3 +153,399 @@ TEST(TestFileEncoder, test_file_encoder)
 
 
 
+
+// Tests that encoding and decoding a memory mapped file works, with the
+// blocks built both in order and in random order
+TEST(TestFileEncoder, test_mmap_file_encoder)
+{
+    std::string encode_filename = "encode-mmap-file";
+
+    uint32_t size = rand_nonzero(5000);
+    std::vector<uint8_t> data_in(size);
+
+    for(auto &e : data_in)
+    {
+        e = rand() % 256;
+    }
+
+    std::ofstream encode_file;
+    encode_file.open(encode_filename, std::ios::binary);
+    encode_file.write(reinterpret_cast<char*>(&data_in[0]), size);
+    encode_file.close();
+
+    typedef kodo::shallow_rlnc_encoder<fifi::binary8>
+        encoder_t;
+
+    typedef kodo::full_rlnc_decoder<fifi::binary8>
+        decoder_t;
+
+    typedef kodo::mmap_file_encoder<encoder_t>
+        file_encoder_t;
+
+    typedef kodo::object_decoder<decoder_t>
+        object_decoder_t;
+
+    const kodo::mmap_access accesses[] =
+        { kodo::mmap_access::sequential, kodo::mmap_access::random };
+
+    for(auto access : accesses)
+    {
+        uint32_t max_symbols = 16;
+        uint32_t max_symbol_size = 50;
+
+        file_encoder_t::factory encoder_factory(
+            max_symbols, max_symbol_size);
+
+        file_encoder_t file_encoder(
+            encoder_factory, encode_filename, access);
+
+        EXPECT_EQ(size, file_encoder.object_size());
+
+        object_decoder_t::factory decoder_factory(
+            max_symbols, max_symbol_size);
+
+        object_decoder_t object_decoder(decoder_factory, size);
+
+        EXPECT_EQ(object_decoder.decoders(), file_encoder.encoders());
+
+        kodo::rfc5052_partitioning_scheme partitioning(
+            max_symbols, max_symbol_size, size);
+
+        std::vector<uint8_t> data_out(size);
+        uint32_t offset = 0;
+
+        for(uint32_t j = 0; j < file_encoder.encoders(); ++j)
+        {
+            uint32_t i = access == kodo::mmap_access::sequential ?
+                j : file_encoder.encoders() - j - 1;
+
+            auto encoder = file_encoder.build(i);
+            auto decoder = object_decoder.build(i);
+
+            EXPECT_EQ(encoder->bytes_used(), decoder->bytes_used());
+
+            std::vector<uint8_t> payload(encoder->payload_size());
+
+            while(!decoder->is_complete())
+            {
+                encoder->encode(&payload[0]);
+                decoder->decode(&payload[0]);
+            }
+
+            auto storage = sak::storage(
+                &data_out[partitioning.byte_offset(i)],
+                decoder->bytes_used());
+
+            decoder->copy_symbols(storage);
+            offset += decoder->bytes_used();
+        }
+
+        EXPECT_EQ(size, offset);
+        EXPECT_TRUE(data_in == data_out);
+    }
+
+    boost::filesystem::remove(encode_filename);
+}
+
+// Tests that the read-ahead file encoder gives the encoders the right
+// data when the blocks are built in order, backwards and at random
+TEST(TestFileEncoder, test_read_ahead_file_encoder)
+{
+    std::string encode_filename = "encode-read-ahead-file";
+
+    uint32_t size = 10000 + rand_nonzero(5000);
+    std::vector<uint8_t> data_in(size);
+
+    for(auto &e : data_in)
+    {
+        e = rand() % 256;
+    }
+
+    std::ofstream encode_file;
+    encode_file.open(encode_filename, std::ios::binary);
+    encode_file.write(reinterpret_cast<char*>(&data_in[0]), size);
+    encode_file.close();
+
+    typedef kodo::full_rlnc_encoder<fifi::binary8>
+        encoder_t;
+
+    typedef kodo::read_ahead_file_encoder<encoder_t>
+        file_encoder_t;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 40;
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, size);
+
+    for(uint32_t depth = 1; depth < 6; depth += 2)
+    {
+        file_encoder_t::factory encoder_factory(
+            max_symbols, max_symbol_size);
+
+        file_encoder_t file_encoder(
+            encoder_factory, encode_filename, depth);
+
+        EXPECT_EQ(size, file_encoder.object_size());
+        EXPECT_EQ(partitioning.blocks(), file_encoder.encoders());
+
+        std::vector<uint32_t> order;
+        for(uint32_t i = 0; i < file_encoder.encoders(); ++i)
+        {
+            order.push_back(i);
+        }
+
+        for(uint32_t i = 0; i < file_encoder.encoders(); ++i)
+        {
+            order.push_back(file_encoder.encoders() - i - 1);
+        }
+
+        for(uint32_t i = 0; i < file_encoder.encoders(); ++i)
+        {
+            order.push_back(rand() % file_encoder.encoders());
+        }
+
+        for(uint32_t i : order)
+        {
+            auto encoder = file_encoder.build(i);
+
+            uint32_t bytes_used = partitioning.bytes_used(i);
+            EXPECT_EQ(bytes_used, encoder->bytes_used());
+
+            std::vector<uint8_t> data_out(encoder->block_size());
+            encoder->copy_symbols(sak::storage(data_out));
+
+            EXPECT_TRUE(std::equal(
+                data_out.begin(), data_out.begin() + bytes_used,
+                data_in.begin() + partitioning.byte_offset(i)));
+        }
+    }
+
+    boost::filesystem::remove(encode_filename);
+}
+
+// Tests that the file decoder writes the decoded blocks to the file
+// and releases the decoders
+template<template<class> class FileWriter>
+void test_file_decoder(const std::string &encode_filename,
+                       const std::string &decode_filename)
+{
+    uint32_t size = 1000 + rand_nonzero(5000);
+    std::vector<uint8_t> data_in(size);
+
+    for(auto &e : data_in)
+    {
+        e = rand() % 256;
+    }
+
+    std::ofstream encode_file;
+    encode_file.open(encode_filename, std::ios::binary);
+    encode_file.write(reinterpret_cast<char*>(&data_in[0]), size);
+    encode_file.close();
+
+    typedef kodo::full_rlnc_encoder<fifi::binary8>
+        encoder_t;
+
+    typedef kodo::full_rlnc_decoder<fifi::binary8>
+        decoder_t;
+
+    typedef kodo::file_encoder<encoder_t>
+        file_encoder_t;
+
+    typedef kodo::file_decoder<decoder_t,
+        kodo::rfc5052_partitioning_scheme, FileWriter<decoder_t> >
+        file_decoder_t;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 40;
+
+    {
+        file_encoder_t::factory encoder_factory(
+            max_symbols, max_symbol_size);
+
+        file_encoder_t file_encoder(encoder_factory, encode_filename);
+
+        typename file_decoder_t::factory decoder_factory(
+            max_symbols, max_symbol_size);
+
+        file_decoder_t file_decoder(
+            decoder_factory, decode_filename, size);
+
+        EXPECT_EQ(file_decoder.decoders(), file_encoder.encoders());
+
+        // Decode the blocks backwards to write the file out of order
+        for(uint32_t j = 0; j < file_encoder.encoders(); ++j)
+        {
+            uint32_t i = file_encoder.encoders() - j - 1;
+
+            auto encoder = file_encoder.build(i);
+            auto decoder = file_decoder.build(i);
+
+            std::vector<uint8_t> payload(encoder->payload_size());
+
+            bool written = false;
+            while(!written)
+            {
+                encoder->encode(&payload[0]);
+                written = file_decoder.decode(i, decoder, &payload[0]);
+            }
+
+            // The decoder is returned to the factory right away
+            EXPECT_FALSE(decoder);
+            EXPECT_EQ(1U, decoder_factory.pool().unused_resources());
+        }
+
+        EXPECT_EQ(1U, decoder_factory.pool().total_resources());
+    }
+
+    std::ifstream decode_file(decode_filename, std::ios::binary);
+    std::vector<uint8_t> data_out(size);
+    decode_file.read(reinterpret_cast<char*>(&data_out[0]), size);
+
+    EXPECT_EQ(size, static_cast<uint32_t>(decode_file.gcount()));
+    EXPECT_TRUE(data_in == data_out);
+
+    decode_file.close();
+
+    boost::filesystem::remove(encode_filename);
+    boost::filesystem::remove(decode_filename);
+}
+
+TEST(TestFileEncoder, test_file_decoder)
+{
+    test_file_decoder<kodo::file_writer>(
+        "encode-file-decoder", "decode-file-decoder");
+}
+
+TEST(TestFileEncoder, test_mmap_file_decoder)
+{
+    test_file_decoder<kodo::mmap_file_writer>(
+        "encode-mmap-file-decoder", "decode-mmap-file-decoder");
+}
+
+// Tests that a file which cannot be created is reported
+TEST(TestFileEncoder, test_file_writer_error)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    EXPECT_THROW(kodo::file_writer<decoder_t>(
+                     "no-such-directory/decode-file-writer-error", 100),
+                 std::system_error);
+}
+
+// Tests that the segment file encoder describes the systematic symbols
+// by their position in the file and only reads the blocks needing coded
+// symbols
+TEST(TestFileEncoder, test_segment_file_encoder)
+{
+    std::string encode_filename = "encode-segment-file";
+
+    uint32_t size = 1000 + rand_nonzero(5000);
+    std::vector<uint8_t> data_in(size);
+
+    for(auto &e : data_in)
+    {
+        e = rand() % 256;
+    }
+
+    std::ofstream encode_file;
+    encode_file.open(encode_filename, std::ios::binary);
+    encode_file.write(reinterpret_cast<char*>(&data_in[0]), size);
+    encode_file.close();
+
+    typedef kodo::full_rlnc_encoder<fifi::binary8>
+        encoder_t;
+
+    typedef kodo::full_rlnc_decoder<fifi::binary8>
+        decoder_t;
+
+    typedef kodo::segment_file_encoder<encoder_t>
+        file_encoder_t;
+
+    typedef kodo::object_decoder<decoder_t>
+        object_decoder_t;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 40;
+
+    file_encoder_t::factory encoder_factory(
+        max_symbols, max_symbol_size);
+
+    file_encoder_t file_encoder(encoder_factory, encode_filename);
+
+    EXPECT_EQ(size, file_encoder.object_size());
+
+    object_decoder_t::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    object_decoder_t object_decoder(decoder_factory, size);
+
+    EXPECT_EQ(object_decoder.decoders(), file_encoder.blocks());
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, size);
+
+    std::vector<uint8_t> data_out(size);
+
+    for(uint32_t i = 0; i < file_encoder.blocks(); ++i)
+    {
+        auto decoder = object_decoder.build(i);
+
+        uint32_t symbol_size = file_encoder.symbol_size(i);
+        EXPECT_EQ(decoder->symbol_size(), symbol_size);
+
+        std::vector<uint8_t> payload(
+            symbol_size + file_encoder.max_header_size());
+
+        // Every third symbol is lost, except in the last block
+        bool lossy = i + 1 < file_encoder.blocks();
+        uint32_t sent = 0;
+
+        while(!decoder->is_complete())
+        {
+            kodo::file_segment segment;
+
+            file_encoder.encode(i, &payload[0], &payload[symbol_size],
+                                segment);
+
+            if(segment.m_length + segment.m_padding > 0)
+            {
+                EXPECT_EQ(symbol_size, segment.m_length + segment.m_padding);
+                EXPECT_FALSE(file_encoder.has_encoder(i));
+
+                // The transport sends the segment from the file
+                std::copy_n(&data_in[segment.m_offset], segment.m_length,
+                            &payload[0]);
+
+                std::fill_n(&payload[segment.m_length], segment.m_padding,
+                            0);
+            }
+            else
+            {
+                EXPECT_TRUE(lossy);
+                EXPECT_TRUE(file_encoder.has_encoder(i));
+            }
+
+            if(!lossy || sent++ % 3 != 0)
+            {
+                decoder->decode(&payload[0]);
+            }
+        }
+
+        EXPECT_EQ(lossy, file_encoder.has_encoder(i));
+        EXPECT_EQ(decoder->symbols(), file_encoder.systematic_count(i));
+
+        file_encoder.release_encoder(i);
+        EXPECT_FALSE(file_encoder.has_encoder(i));
+
+        auto storage = sak::storage(
+            &data_out[partitioning.byte_offset(i)],
+            decoder->bytes_used());
+
+        decoder->copy_symbols(storage);
+    }
+
+    EXPECT_TRUE(data_in == data_out);
+
+    boost::filesystem::remove(encode_filename);
+}
@@ -0,0 +1,218 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_final_coder_factory_pool.cpp Unit tests for the coder pool
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Tests that reserved coders are built without constructing new ones
+TEST(TestFinalCoderFactoryPool, reserve)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    decoder_type::factory factory(16, 1400);
+
+    factory.reserve(4);
+
+    EXPECT_EQ(4U, factory.pool().total_resources());
+    EXPECT_EQ(4U, factory.pool().unused_resources());
+
+    {
+        std::vector<decoder_type::pointer> decoders;
+
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            decoders.push_back(factory.build());
+            EXPECT_EQ(0U, decoders.back()->rank());
+        }
+
+        EXPECT_EQ(4U, factory.pool().total_resources());
+        EXPECT_EQ(0U, factory.pool().unused_resources());
+
+        // Only the coders missing from the pool are constructed
+        factory.reserve(1);
+        EXPECT_EQ(5U, factory.pool().total_resources());
+    }
+
+    EXPECT_EQ(5U, factory.pool().unused_resources());
+
+    // Reserving fewer coders than are unused does nothing
+    factory.reserve(2);
+    EXPECT_EQ(5U, factory.pool().total_resources());
+    EXPECT_EQ(5U, factory.pool().unused_resources());
+}
+
+/// Tests that coders may outlive the factory which built them
+TEST(TestFinalCoderFactoryPool, coder_outlives_factory)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    decoder_type::pointer decoder;
+
+    {
+        decoder_type::factory factory(16, 1400);
+        decoder = factory.build();
+
+        // The unused coders are deleted with the factory
+        factory.reserve(2);
+        EXPECT_EQ(3U, factory.pool().total_resources());
+        EXPECT_EQ(2U, factory.pool().unused_resources());
+    }
+
+    EXPECT_EQ(0U, decoder->rank());
+    decoder.reset();
+}
+
+/// Tests that a coder built with slabs holds its storage in its slab
+TEST(TestFinalCoderFactoryPool, slabs)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_type;
+    typedef kodo::slab_full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 1400;
+
+    encoder_type::factory encoder_factory(symbols, symbol_size);
+
+    decoder_type::pointer decoder;
+
+    {
+        decoder_type::factory decoder_factory(symbols, symbol_size);
+
+        EXPECT_FALSE(decoder_factory.pool().uses_slabs());
+        decoder_factory.pool().enable_slabs();
+        EXPECT_TRUE(decoder_factory.pool().uses_slabs());
+
+        decoder_factory.reserve(2);
+
+        // The first coder sized the slabs to hold all its storage
+        std::size_t slab_size = decoder_factory.pool().slab_size();
+        EXPECT_GE(slab_size, symbols * symbol_size + sizeof(decoder_type));
+
+        decoder = decoder_factory.build();
+
+        const uint8_t *begin = reinterpret_cast<const uint8_t*>(
+            decoder.get());
+
+        const uint8_t *symbol = decoder->symbol(0);
+        const uint8_t *coefficients = decoder->coefficients(0);
+
+        EXPECT_TRUE(symbol > begin && symbol < begin + slab_size);
+        EXPECT_TRUE(coefficients > begin &&
+                    coefficients < begin + slab_size);
+    }
+
+    // The decoder outlives the factory and decodes as usual
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+
+    decoder.reset();
+}
+
+/// Tests:
+///   - coder_pool::shrink(uint32_t)
+///   - coder_pool::trim()
+///   - coder_pool::set_max_unused(uint32_t)
+TEST(TestFinalCoderFactoryPool, release_unused)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    decoder_type::factory factory(16, 1400);
+
+    // A peak of coders in use
+    factory.reserve(10);
+    EXPECT_EQ(10U, factory.pool().total_resources());
+
+    EXPECT_EQ(6U, factory.pool().shrink(4));
+    EXPECT_EQ(4U, factory.pool().total_resources());
+    EXPECT_EQ(4U, factory.pool().unused_resources());
+
+    // Nothing to trim on the first call
+    EXPECT_EQ(0U, factory.pool().trim());
+
+    {
+        // Two coders are used in the period, the other two stay
+        // unused and are deleted by the next trim
+        auto first = factory.build();
+        auto second = factory.build();
+    }
+
+    EXPECT_EQ(2U, factory.pool().trim());
+    EXPECT_EQ(2U, factory.pool().total_resources());
+
+    // No coder was used since
+    EXPECT_EQ(2U, factory.pool().trim());
+    EXPECT_EQ(0U, factory.pool().total_resources());
+
+    factory.pool().set_max_unused(1);
+
+    {
+        std::vector<decoder_type::pointer> decoders;
+
+        for(uint32_t i = 0; i < 3; ++i)
+        {
+            decoders.push_back(factory.build());
+        }
+
+        EXPECT_EQ(3U, factory.pool().total_resources());
+    }
+
+    // Only one of the released coders is kept
+    EXPECT_EQ(1U, factory.pool().total_resources());
+    EXPECT_EQ(1U, factory.pool().unused_resources());
+
+    factory.reserve(5);
+    EXPECT_EQ(1U, factory.pool().unused_resources());
+}
+
+/// Tests that the pool shrinks on memory pressure
+TEST(TestFinalCoderFactoryPool, memory_pressure)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    uint32_t subscriptions = kodo::memory_pressure::subscriptions();
+
+    {
+        decoder_type::factory factory(16, 1400);
+        factory.release_on_memory_pressure(1);
+
+        EXPECT_EQ(subscriptions + 1,
+                  kodo::memory_pressure::subscriptions());
+
+        factory.reserve(4);
+        auto decoder = factory.build();
+
+        kodo::memory_pressure::signal();
+
+        EXPECT_EQ(1U, factory.pool().unused_resources());
+        EXPECT_EQ(2U, factory.pool().total_resources());
+        EXPECT_EQ(0U, decoder->rank());
+    }
+
+    // The factory unsubscribed when it was destroyed
+    EXPECT_EQ(subscriptions, kodo::memory_pressure::subscriptions());
+}
@@ -0,0 +1,374 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_final_coder_factory_sharded_pool.cpp Unit tests for the
+///       thread-safe coder pool
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/final_coder_factory_sharded_pool.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+#include "test_reuse.hpp"
+
+namespace kodo
+{
+
+    /// RLNC encoder using the sharded pool
+    template<class Field>
+    class sharded_rlnc_encoder :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_sharded_pool<
+               // Final type
+               sharded_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+    /// RLNC decoder using the sharded pool, the payload_recoder is not
+    /// used since it changes the factory when building the coders
+    template<class Field>
+    class sharded_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_sharded_pool<
+                 // Final type
+                 sharded_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > >
+    { };
+
+}
+
+/// Tests that the coders are recycled
+TEST(TestFinalCoderFactoryShardedPool, recycle)
+{
+    typedef kodo::sharded_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::factory factory(10, 100);
+
+    EXPECT_EQ(0U, factory.total_coders());
+    EXPECT_EQ(0U, factory.unused_coders());
+
+    {
+        auto a = factory.build();
+        auto b = factory.build();
+
+        EXPECT_EQ(2U, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+    }
+
+    EXPECT_EQ(2U, factory.total_coders());
+    EXPECT_EQ(2U, factory.unused_coders());
+
+    auto c = factory.build();
+
+    EXPECT_EQ(2U, factory.total_coders());
+    EXPECT_EQ(1U, factory.unused_coders());
+
+    // More coders than fit in a shard are kept in the overflow stack
+    const uint32_t coders = 3 * encoder_type::coder_pool::shard_capacity;
+
+    {
+        std::vector<encoder_type::pointer> encoders;
+
+        for(uint32_t i = 0; i < coders; ++i)
+        {
+            encoders.push_back(factory.build());
+        }
+    }
+
+    EXPECT_EQ(coders + 1, factory.total_coders());
+    EXPECT_EQ(coders, factory.unused_coders());
+
+    {
+        std::vector<encoder_type::pointer> encoders;
+
+        for(uint32_t i = 0; i < coders; ++i)
+        {
+            encoders.push_back(factory.build());
+        }
+
+        EXPECT_EQ(0U, factory.unused_coders());
+    }
+
+    EXPECT_EQ(coders + 1, factory.total_coders());
+}
+
+/// Tests that reserved coders are built without constructing new ones
+TEST(TestFinalCoderFactoryShardedPool, reserve)
+{
+    typedef kodo::sharded_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::factory factory(10, 100);
+
+    const uint32_t coders = 2 * encoder_type::coder_pool::shard_capacity;
+
+    factory.reserve(coders);
+
+    EXPECT_EQ(coders, factory.total_coders());
+    EXPECT_EQ(coders, factory.unused_coders());
+
+    {
+        std::vector<encoder_type::pointer> encoders;
+
+        for(uint32_t i = 0; i < coders; ++i)
+        {
+            encoders.push_back(factory.build());
+        }
+
+        EXPECT_EQ(coders, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+
+        // Only the coders missing from the pool are constructed
+        factory.reserve(2);
+        EXPECT_EQ(coders + 2, factory.total_coders());
+    }
+
+    factory.reserve(coders);
+    EXPECT_EQ(coders + 2, factory.total_coders());
+    EXPECT_EQ(coders + 2, factory.unused_coders());
+}
+
+/// Tests that the nodes of the coders are allocated in several chunks
+/// when many coders are in use at the same time
+TEST(TestFinalCoderFactoryShardedPool, chunks)
+{
+    typedef kodo::sharded_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::factory factory(10, 100);
+
+    const uint32_t coders = 2 * encoder_type::coder_pool::chunk_size + 1;
+
+    {
+        std::vector<encoder_type::pointer> encoders;
+
+        for(uint32_t i = 0; i < coders; ++i)
+        {
+            encoders.push_back(factory.build());
+            EXPECT_EQ(10U, encoders.back()->symbols());
+        }
+
+        EXPECT_EQ(coders, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+    }
+
+    EXPECT_EQ(coders, factory.total_coders());
+    EXPECT_EQ(coders, factory.unused_coders());
+
+    // The coders of all the chunks are reused
+    {
+        std::vector<encoder_type::pointer> encoders;
+
+        for(uint32_t i = 0; i < coders; ++i)
+        {
+            encoders.push_back(factory.build());
+        }
+
+        EXPECT_EQ(coders, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+    }
+
+    EXPECT_EQ(coders, factory.unused_coders());
+}
+
+/// Tests that coders built when all the nodes of the pool are in use
+/// are not pooled but deleted when released
+TEST(TestFinalCoderFactoryShardedPool, full_pool)
+{
+    typedef kodo::sharded_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::factory factory(1, 1);
+
+    const uint32_t nodes = encoder_type::coder_pool::chunk_size *
+        encoder_type::coder_pool::max_chunks;
+
+    {
+        std::vector<encoder_type::pointer> encoders;
+        encoders.reserve(nodes + 2);
+
+        for(uint32_t i = 0; i < nodes + 2; ++i)
+        {
+            encoders.push_back(factory.build());
+        }
+
+        EXPECT_EQ(1U, encoders.back()->symbols());
+        EXPECT_EQ(nodes, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+
+        // No coders can be reserved in a full pool
+        factory.reserve(1);
+        EXPECT_EQ(nodes, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+    }
+
+    EXPECT_EQ(nodes, factory.total_coders());
+    EXPECT_EQ(nodes, factory.unused_coders());
+}
+
+/// Tests that coders outliving their factory are deleted safely
+TEST(TestFinalCoderFactoryShardedPool, coder_outlives_factory)
+{
+    typedef kodo::sharded_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::pointer encoder;
+
+    {
+        encoder_type::factory factory(10, 100);
+        encoder = factory.build();
+    }
+
+    EXPECT_EQ(10U, encoder->symbols());
+    encoder.reset();
+}
+
+TEST(TestFinalCoderFactoryShardedPool, reuse)
+{
+    test_reuse<
+        kodo::sharded_rlnc_encoder,
+        kodo::sharded_rlnc_decoder>(rand_symbols(), rand_symbol_size());
+}
+
+/// Tests that a single factory can serve several threads, and that
+/// coders may be released on a different thread than where they
+/// were built
+TEST(TestFinalCoderFactoryShardedPool, threads)
+{
+    typedef kodo::sharded_rlnc_encoder<fifi::binary8> encoder_type;
+    typedef kodo::sharded_rlnc_decoder<fifi::binary8> decoder_type;
+
+    const uint32_t symbols = 16;
+    const uint32_t symbol_size = 160;
+    const uint32_t threads = 8;
+    const uint32_t rounds = 50;
+
+    encoder_type::factory encoder_factory(symbols, symbol_size);
+    decoder_type::factory decoder_factory(symbols, symbol_size);
+
+    std::vector<std::vector<encoder_type::pointer> > handed_over(threads);
+    std::vector<uint32_t> failures(threads, 0);
+    std::vector<std::thread> workers;
+
+    for(uint32_t t = 0; t < threads; ++t)
+    {
+        workers.push_back(std::thread([&, t]()
+        {
+            std::vector<uint8_t> data_in(symbols * symbol_size);
+            std::vector<uint8_t> data_out(symbols * symbol_size);
+
+            for(uint32_t r = 0; r < rounds; ++r)
+            {
+                auto encoder = encoder_factory.build();
+                auto decoder = decoder_factory.build();
+
+                for(uint32_t i = 0; i < data_in.size(); ++i)
+                {
+                    data_in[i] = static_cast<uint8_t>(t * 31 + r * 7 + i);
+                }
+
+                encoder->set_symbols(sak::storage(data_in));
+
+                std::vector<uint8_t> payload(encoder->payload_size());
+
+                while(!decoder->is_complete())
+                {
+                    encoder->encode(&payload[0]);
+                    decoder->decode(&payload[0]);
+                }
+
+                decoder->copy_symbols(sak::storage(data_out));
+
+                if(data_in != data_out)
+                {
+                    ++failures[t];
+                }
+
+                // Keep some of the encoders to release them on the
+                // main thread
+                if(r % 10 == 0)
+                {
+                    handed_over[t].push_back(encoder);
+                }
+            }
+        }));
+    }
+
+    for(auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for(uint32_t t = 0; t < threads; ++t)
+    {
+        EXPECT_EQ(0U, failures[t]);
+    }
+
+    uint32_t held = 0;
+    for(auto &encoders : handed_over)
+    {
+        held += static_cast<uint32_t>(encoders.size());
+    }
+
+    EXPECT_EQ(encoder_factory.total_coders() - held,
+              encoder_factory.unused_coders());
+
+    handed_over.clear();
+
+    EXPECT_EQ(encoder_factory.total_coders(),
+              encoder_factory.unused_coders());
+
+    EXPECT_EQ(decoder_factory.total_coders(),
+              decoder_factory.unused_coders());
+
+    // Every thread keeps at most one encoder and decoder in use
+    // besides the handed over ones
+    EXPECT_LE(decoder_factory.total_coders(), threads);
+    EXPECT_LE(encoder_factory.total_coders(), threads + held);
+}
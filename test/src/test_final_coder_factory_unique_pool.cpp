@@ -0,0 +1,196 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_final_coder_factory_unique_pool.cpp Unit tests for the
+///       coder pool returning move-only handles
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/final_coder_factory_unique_pool.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// RLNC encoder using the unique pool
+    template<class Field>
+    class unique_rlnc_encoder :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_unique_pool<
+               // Final type
+               unique_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+    /// RLNC decoder using the unique pool, the payload_recoder is not
+    /// used since it copies the pointer of the recoding stack
+    template<class Field>
+    class unique_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_unique_pool<
+                 // Final type
+                 unique_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > >
+    { };
+
+}
+
+/// Tests that the coders are recycled and that the handles move
+TEST(TestFinalCoderFactoryUniquePool, recycle)
+{
+    typedef kodo::unique_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::factory factory(10, 100);
+
+    EXPECT_EQ(0U, factory.total_coders());
+    EXPECT_EQ(0U, factory.unused_coders());
+
+    {
+        auto a = factory.build();
+        auto b = factory.build();
+
+        EXPECT_EQ(2U, factory.total_coders());
+        EXPECT_EQ(0U, factory.unused_coders());
+
+        encoder_type::pointer c = std::move(a);
+        EXPECT_TRUE(a.get() == 0);
+        EXPECT_TRUE(c.get() != 0);
+
+        // Assigning over a handle releases its coder
+        c = std::move(b);
+        EXPECT_EQ(1U, factory.unused_coders());
+
+        c.reset();
+        EXPECT_TRUE(c.get() == 0);
+        EXPECT_EQ(2U, factory.unused_coders());
+    }
+
+    std::vector<encoder_type::pointer> encoders;
+
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        encoders.push_back(factory.build());
+        EXPECT_EQ(10U, encoders.back()->symbols());
+    }
+
+    EXPECT_EQ(3U, factory.total_coders());
+    EXPECT_EQ(0U, factory.unused_coders());
+
+    encoders.clear();
+
+    EXPECT_EQ(3U, factory.total_coders());
+    EXPECT_EQ(3U, factory.unused_coders());
+
+    // Reserving fewer coders than are unused does nothing
+    factory.reserve(2);
+    EXPECT_EQ(3U, factory.total_coders());
+
+    factory.reserve(5);
+    EXPECT_EQ(5U, factory.total_coders());
+    EXPECT_EQ(5U, factory.unused_coders());
+}
+
+/// Tests that coders outliving their factory are deleted safely
+TEST(TestFinalCoderFactoryUniquePool, coder_outlives_factory)
+{
+    typedef kodo::unique_rlnc_encoder<fifi::binary8> encoder_type;
+
+    encoder_type::pointer encoder;
+
+    {
+        encoder_type::factory factory(10, 100);
+        encoder = factory.build();
+    }
+
+    EXPECT_EQ(10U, encoder->symbols());
+    encoder.reset();
+}
+
+/// Tests that the recycled coders encode and decode a block
+TEST(TestFinalCoderFactoryUniquePool, decode)
+{
+    typedef kodo::unique_rlnc_encoder<fifi::binary8> encoder_type;
+    typedef kodo::unique_rlnc_decoder<fifi::binary8> decoder_type;
+
+    const uint32_t symbols = 16;
+    const uint32_t symbol_size = 160;
+
+    encoder_type::factory encoder_factory(symbols, symbol_size);
+    decoder_type::factory decoder_factory(symbols, symbol_size);
+
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        auto encoder = encoder_factory.build();
+        auto decoder = decoder_factory.build();
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+        std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+        encoder->set_symbols(sak::storage(data_in));
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+        }
+
+        std::vector<uint8_t> data_out(decoder->block_size());
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_in == data_out);
+    }
+
+    EXPECT_EQ(1U, encoder_factory.total_coders());
+    EXPECT_EQ(1U, decoder_factory.total_coders());
+}
@@ -11,8 +11,10 @@
 #include <gtest/gtest.h>
 
 #include <fifi/field_types.hpp>
+#include <fifi/is_binary.hpp>
 
 #include <kodo/operations_counter.hpp>
+#include <kodo/operations_profile.hpp>
 #include <kodo/finite_field_counter.hpp>
 
 #include "operations_counter_helper.hpp"
@@ -36,7 +38,21 @@ namespace kodo
 
         /// Dummy factory
         struct factory
-        {};
+        {
+            /// Constructor
+            factory(uint32_t symbol_size = 0)
+                : m_symbol_size(symbol_size)
+            { }
+
+            /// @copydoc layer::factory::symbol_size() const
+            uint32_t symbol_size() const
+            {
+                return m_symbol_size;
+            }
+
+            /// The symbol size
+            uint32_t m_symbol_size;
+        };
 
     public:
 
@@ -68,6 +84,22 @@ namespace kodo
             (void) symbol_length;
         }
 
+        /// @copydoc layer::multiply_add_sources(value_type*,
+        ///                                     const value_type**,
+        ///                                     const value_type*,
+        ///                                     uint32_t, uint32_t)
+        void multiply_add_sources(value_type *symbol_dest,
+                                  const value_type **symbols_src,
+                                  const value_type *coefficients,
+                                  uint32_t sources, uint32_t symbol_length)
+        {
+            (void) symbol_dest;
+            (void) symbols_src;
+            (void) coefficients;
+            (void) sources;
+            (void) symbol_length;
+        }
+
         /// @copydoc layer::add(value_type*, const value_type *, uint32_t)
         void add(value_type *symbol_dest, const value_type *symbol_src,
                  uint32_t symbol_length)
@@ -184,5 +216,187 @@ TEST(TestFiniteFieldCounter, invoke_counters)
     test_values(counter, 0U);
 }
 
+/// Helper function invoking the fused multiply add of the finite
+/// field stack
+template<class Field>
+void invoke_multiply_add_sources()
+{
+    kodo::counter_test_stack<Field> stack;
+
+    typedef typename Field::value_type value_type;
+
+    value_type *dummy_ptr = 0;
+    const value_type **dummy_sources = 0;
+    const value_type *dummy_coefficients = 0;
+    uint32_t dummy_length = 0;
+
+    stack.multiply_add_sources(dummy_ptr, dummy_sources,
+                               dummy_coefficients, 5U, dummy_length);
+
+    auto counter = stack.get_operations_counter();
+
+    // Each source is counted as a separate operation
+    if(fifi::is_binary<Field>::value)
+    {
+        EXPECT_EQ(5U, counter.m_add);
+        EXPECT_EQ(0U, counter.m_multiply_add);
+    }
+    else
+    {
+        EXPECT_EQ(0U, counter.m_add);
+        EXPECT_EQ(5U, counter.m_multiply_add);
+    }
+}
+
+/// Run the tests for the fused multiply add counter
+TEST(TestFiniteFieldCounter, multiply_add_sources)
+{
+    invoke_multiply_add_sources<fifi::binary>();
+    invoke_multiply_add_sources<fifi::binary8>();
+    invoke_multiply_add_sources<fifi::binary16>();
+}
+
+/// Helper function checking the profile of the operations on the
+/// symbol data and the coefficient vectors
+template<class Field>
+void invoke_operations_profile()
+{
+    typedef typename Field::value_type value_type;
+
+    kodo::counter_test_stack<Field> stack;
+
+    // Symbols of 8 field elements
+    typename kodo::counter_test_stack<Field>::factory f(
+        8 * sizeof(value_type));
+    stack.initialize(f);
+
+    value_type *dummy_ptr = 0;
+    const value_type **dummy_sources = 0;
+    const value_type *dummy_coefficients = 0;
+    value_type dummy_coefficient = 0;
+
+    stack.multiply(dummy_ptr, dummy_coefficient, 8);
+    stack.multiply(dummy_ptr, dummy_coefficient, 2);
+    stack.multiply_add(dummy_ptr, dummy_ptr, dummy_coefficient, 8);
+    stack.add(dummy_ptr, dummy_ptr, 2);
+    stack.multiply_subtract(dummy_ptr, dummy_ptr, dummy_coefficient, 8);
+    stack.subtract(dummy_ptr, dummy_ptr, 2);
+    stack.multiply_add_sources(dummy_ptr, dummy_sources,
+                               dummy_coefficients, 3, 8);
+
+    kodo::operations_profile profile = stack.get_operations_profile();
+
+    EXPECT_EQ(1U, profile.m_multiply.m_symbol.m_calls);
+    EXPECT_EQ(8U * sizeof(value_type), profile.m_multiply.m_symbol.m_bytes);
+    EXPECT_EQ(1U, profile.m_multiply.m_coefficient.m_calls);
+    EXPECT_EQ(2U * sizeof(value_type),
+              profile.m_multiply.m_coefficient.m_bytes);
+
+    EXPECT_EQ(8U * sizeof(value_type),
+              profile.m_multiply_subtract.m_symbol.m_bytes);
+    EXPECT_EQ(0U, profile.m_multiply_subtract.m_coefficient.m_bytes);
+
+    EXPECT_EQ(0U, profile.m_subtract.m_symbol.m_bytes);
+    EXPECT_EQ(2U * sizeof(value_type),
+              profile.m_subtract.m_coefficient.m_bytes);
+
+    // The fused operation processes the destination once per source
+    if(fifi::is_binary<Field>::value)
+    {
+        EXPECT_EQ(24U * sizeof(value_type), profile.m_add.m_symbol.m_bytes);
+        EXPECT_EQ(2U * sizeof(value_type),
+                  profile.m_add.m_coefficient.m_bytes);
+        EXPECT_EQ(8U * sizeof(value_type),
+                  profile.m_multiply_add.m_symbol.m_bytes);
+    }
+    else
+    {
+        EXPECT_EQ(2U * sizeof(value_type),
+                  profile.m_add.m_coefficient.m_bytes);
+        EXPECT_EQ(32U * sizeof(value_type),
+                  profile.m_multiply_add.m_symbol.m_bytes);
+        EXPECT_EQ(2U, profile.m_multiply_add.m_symbol.m_calls);
+    }
+
+    // Nothing is timed by default
+    EXPECT_EQ(0U, profile.m_multiply.m_symbol.m_samples);
+    EXPECT_EQ(0.0, profile.m_multiply.m_symbol.estimated_ticks());
+
+    stack.reset_operations_counter();
+    profile = stack.get_operations_profile();
+
+    EXPECT_EQ(0U, profile.m_multiply.m_symbol.m_calls);
+    EXPECT_EQ(0U, profile.m_multiply.m_symbol.m_bytes);
+}
+
+/// Run the tests for the operations profile
+TEST(TestFiniteFieldCounter, operations_profile)
+{
+    invoke_operations_profile<fifi::binary>();
+    invoke_operations_profile<fifi::binary8>();
+    invoke_operations_profile<fifi::binary16>();
+}
+
+/// Checks that every n'th call is timed and that the interval is kept
+/// through the initialization
+TEST(TestFiniteFieldCounter, timing_sample_interval)
+{
+    typedef fifi::binary8::value_type value_type;
+
+    kodo::counter_test_stack<fifi::binary8> stack;
+    EXPECT_EQ(0U, stack.timing_sample_interval());
+
+    stack.set_timing_sample_interval(3);
 
+    kodo::counter_test_stack<fifi::binary8>::factory f(10);
+    stack.initialize(f);
+
+    EXPECT_EQ(3U, stack.timing_sample_interval());
+
+    value_type *dummy_ptr = 0;
+
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        stack.add(dummy_ptr, dummy_ptr, 10);
+        stack.add(dummy_ptr, dummy_ptr, 4);
+    }
+
+    kodo::operations_profile profile = stack.get_operations_profile();
+
+    EXPECT_EQ(10U, profile.m_add.m_symbol.m_calls);
+    EXPECT_EQ(3U, profile.m_add.m_symbol.m_samples);
+    EXPECT_EQ(3U, profile.m_add.m_coefficient.m_samples);
 
+    EXPECT_TRUE(profile.m_add.m_symbol.estimated_ticks() >=
+                double(profile.m_add.m_symbol.m_sampled_ticks));
+
+    stack.set_timing_sample_interval(0);
+    stack.reset_operations_counter();
+    stack.add(dummy_ptr, dummy_ptr, 10);
+
+    profile = stack.get_operations_profile();
+    EXPECT_EQ(0U, profile.m_add.m_symbol.m_samples);
+}
+
+/// Tests the arithmetic of the operations profile
+TEST(TestFiniteFieldCounter, operations_profile_arithmetic)
+{
+    kodo::operations_profile a;
+    a.m_add.m_symbol.m_bytes = 100;
+    a.m_add.m_symbol.m_calls = 4;
+    a.m_multiply.m_coefficient.m_sampled_ticks = 50;
+    a.m_multiply.m_coefficient.m_samples = 1;
+    a.m_multiply.m_coefficient.m_calls = 2;
+
+    EXPECT_EQ(100.0, a.m_multiply.m_coefficient.estimated_ticks());
+
+    kodo::operations_profile b = a + a;
+    EXPECT_EQ(200U, b.m_add.m_symbol.m_bytes);
+    EXPECT_EQ(8U, b.m_add.m_symbol.m_calls);
+    EXPECT_EQ(100U, b.m_multiply.m_coefficient.m_sampled_ticks);
+
+    b = b - a;
+    EXPECT_EQ(100U, b.m_add.m_symbol.m_bytes);
+    EXPECT_EQ(4U, b.m_add.m_symbol.m_calls);
+    EXPECT_EQ(1U, b.m_multiply.m_coefficient.m_samples);
+}
@@ -0,0 +1,260 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_frame_ring_transport.cpp Unit tests for the
+///       frame_ring_sender and frame_ring_receiver
+
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/frame_ring_transport.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/storage_encoder.hpp>
+#include <kodo/rfc5052_partitioning_scheme.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// A frame ring in memory where the frames sent are received, in place
+/// of the rings of a NIC
+class loopback_ring
+{
+public:
+
+    loopback_ring(uint32_t frames, uint32_t spare_frames,
+                  uint32_t frame_size)
+        : m_frame_size(frame_size),
+          m_memory(frames * frame_size)
+    {
+        for(uint32_t i = 0; i < frames; ++i)
+        {
+            uint8_t *frame = &m_memory[i * frame_size];
+
+            if(i < spare_frames)
+                m_spare.push_back(frame);
+            else
+                m_free.push_back(frame);
+        }
+    }
+
+    uint32_t frame_size() const
+    {
+        return m_frame_size;
+    }
+
+    uint32_t reserve(kodo::ring_frame *frames, uint32_t count)
+    {
+        count = std::min(count, static_cast<uint32_t>(m_free.size()));
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            frames[i].m_data = m_free.back();
+            frames[i].m_size = m_frame_size;
+            m_free.pop_back();
+        }
+
+        return count;
+    }
+
+    void submit(const kodo::ring_frame *frames, uint32_t count)
+    {
+        m_sent.insert(m_sent.end(), frames, frames + count);
+    }
+
+    uint32_t receive(kodo::ring_frame *frames, uint32_t count)
+    {
+        count = std::min(count, static_cast<uint32_t>(m_sent.size()));
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            frames[i] = m_sent.front();
+            m_sent.pop_front();
+        }
+
+        return count;
+    }
+
+    void refill(uint8_t *data)
+    {
+        EXPECT_TRUE(owns(data));
+
+        uint32_t offset = static_cast<uint32_t>(data - &m_memory[0]);
+        EXPECT_EQ(0U, offset % m_frame_size);
+
+        m_free.push_back(data);
+    }
+
+    uint8_t* spare()
+    {
+        if(m_spare.empty())
+            return 0;
+
+        uint8_t *frame = m_spare.back();
+        m_spare.pop_back();
+
+        return frame;
+    }
+
+    bool owns(const uint8_t *data) const
+    {
+        return data >= &m_memory[0] &&
+            data < &m_memory[0] + m_memory.size();
+    }
+
+    uint32_t free_frames() const
+    {
+        return static_cast<uint32_t>(m_free.size());
+    }
+
+    uint32_t pending() const
+    {
+        return static_cast<uint32_t>(m_sent.size());
+    }
+
+private:
+
+    uint32_t m_frame_size;
+    std::vector<uint8_t> m_memory;
+    std::vector<uint8_t*> m_free;
+    std::vector<uint8_t*> m_spare;
+    std::deque<kodo::ring_frame> m_sent;
+};
+
+/// Receives the pending frames, the decoders adopt the frames
+template<class Receiver, class ObjectDecoder, class Decoders>
+void receive_frames(Receiver &receiver, ObjectDecoder &decoder,
+                    Decoders &decoders, std::true_type)
+{
+    receiver.receive_adopt(decoder, decoders);
+}
+
+/// Receives the pending frames, decoding them in place
+template<class Receiver, class ObjectDecoder, class Decoders>
+void receive_frames(Receiver &receiver, ObjectDecoder &decoder,
+                    Decoders &decoders, std::false_type)
+{
+    receiver.receive(decoder, decoders);
+}
+
+/// Sends an object through a loopback ring and decodes it in place or
+/// adopting the frames, only the stacks with decode_adopt() may adopt
+/// @param prepare Invoked as prepare(decoder_factory, ring) before the
+///        decoders are built
+template<class Decoder, bool Adopt, class Prepare>
+void test_frame_ring(uint32_t max_symbols, uint32_t max_symbol_size,
+                     uint32_t object_size, const Prepare &prepare)
+{
+    typedef kodo::storage_encoder<
+        kodo::full_rlnc_encoder<fifi::binary8>,
+        kodo::rfc5052_partitioning_scheme> storage_encoder;
+
+    typedef kodo::object_decoder<
+        Decoder, kodo::rfc5052_partitioning_scheme> object_decoder;
+
+    typename storage_encoder::factory encoder_factory(
+        max_symbols, max_symbol_size);
+
+    typename object_decoder::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+    storage_encoder encoder(encoder_factory, sak::storage(data_in));
+
+    object_decoder decoder(decoder_factory, object_size);
+
+    uint32_t frame_size = kodo::udp_datagram::size(
+        decoder_factory.max_payload_size());
+
+    // Spare frames for the symbols of every decoder
+    uint32_t spare_frames = decoder.decoders() * max_symbols;
+
+    loopback_ring ring(64 + spare_frames, spare_frames, frame_size);
+
+    prepare(decoder_factory, ring);
+
+    kodo::frame_ring_sender<loopback_ring> sender(ring, 16);
+    kodo::frame_ring_receiver<loopback_ring> receiver(ring, 16);
+
+    std::vector<typename object_decoder::pointer> decoders;
+
+    for(uint32_t i = 0; i < encoder.encoders(); ++i)
+    {
+        auto e = encoder.build(i);
+        e->set_systematic_off();
+
+        while(decoders.size() <= i || !decoders[i] ||
+              !decoders[i]->is_complete())
+        {
+            EXPECT_TRUE(sender.send(e, i, 8) > 0);
+
+            while(ring.pending() > 0)
+            {
+                receive_frames(receiver, decoder, decoders,
+                               std::integral_constant<bool, Adopt>());
+            }
+        }
+    }
+
+    // Every frame received went back to the ring
+    EXPECT_EQ(64U, ring.free_frames());
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, object_size);
+
+    std::vector<uint8_t> data_out(object_size);
+
+    for(uint32_t i = 0; i < decoders.size(); ++i)
+    {
+        ASSERT_TRUE(decoders[i]->is_complete());
+
+        decoders[i]->copy_symbols(sak::storage(
+            &data_out[partitioning.byte_offset(i)],
+            partitioning.bytes_used(i)));
+    }
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestFrameRingTransport, decode_in_place)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    test_frame_ring<decoder_t, false>(16, 160, 16 * 160 * 3 + 5,
+        [](decoder_t::factory&, loopback_ring&) { });
+}
+
+TEST(TestFrameRingTransport, decode_adopt)
+{
+    typedef kodo::adopting_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 160;
+    uint32_t object_size = symbols * symbol_size * 3 + 5;
+
+    boost::shared_ptr<kodo::symbol_buffer_pool> pool;
+
+    test_frame_ring<decoder_t, true>(symbols, symbol_size, object_size,
+        [&](decoder_t::factory &factory, loopback_ring &ring)
+        {
+            // The decoders only hold frames of the ring
+            pool = boost::make_shared<kodo::symbol_buffer_pool>(
+                factory.max_payload_size());
+
+            uint32_t spare_frames = 4 * symbols;
+            EXPECT_EQ(spare_frames,
+                      kodo::add_spare_frames(ring, *pool, spare_frames));
+
+            factory.set_buffer_pool(pool);
+        });
+
+    // No buffer was allocated outside the ring
+    EXPECT_EQ(0U, pool->buffers());
+    EXPECT_EQ(4 * symbols, pool->external_buffers());
+}
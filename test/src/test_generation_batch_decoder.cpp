@@ -0,0 +1,176 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_generation_batch_decoder.cpp Unit test for the
+///       generation_batch_decoder
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/generation_batch_decoder.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes many generations with full vector encoders and decodes them
+/// in lockstep, some generations receive uncoded, linearly dependent or
+/// no symbols in a step
+template<class Field>
+void test_generation_batch_decoder(uint32_t generations, uint32_t symbols,
+                                   uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::generation_batch_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+
+    std::vector<typename encoder_t::pointer> encoders;
+    std::vector<std::vector<uint8_t> > data_in;
+
+    for(uint32_t g = 0; g < generations; ++g)
+    {
+        auto encoder = encoder_factory.build();
+
+        data_in.push_back(random_vector(encoder->block_size()));
+        encoder->set_symbols(sak::storage(data_in.back()));
+
+        encoders.push_back(encoder);
+    }
+
+    decoder_t decoder(generations, symbols, symbol_size);
+
+    EXPECT_EQ(generations, decoder.generations());
+    EXPECT_EQ(symbols, decoder.symbols());
+    EXPECT_EQ(symbol_size, decoder.symbol_size());
+    EXPECT_EQ(0U, decoder.complete_generations());
+
+    std::vector<uint8_t> symbol(encoders[0]->symbol_size());
+    std::vector<uint8_t> coefficients(encoders[0]->coefficients_size());
+
+    // Each generation needs at least symbols steps
+    for(uint32_t step = 0; step < 20 * symbols; ++step)
+    {
+        if(decoder.complete_generations() == generations)
+        {
+            break;
+        }
+
+        for(uint32_t g = 0; g < generations; ++g)
+        {
+            uint32_t choice = rand() % 8;
+
+            if(choice == 0)
+            {
+                continue;
+            }
+
+            if(choice == 1)
+            {
+                uint32_t index = rand() % symbols;
+                decoder.stage_uncoded_symbol(
+                    g, encoders[g]->symbol(index), index);
+                continue;
+            }
+
+            if(choice == 2)
+            {
+                // A zero symbol is always linearly dependent
+                std::fill(coefficients.begin(), coefficients.end(), 0);
+            }
+            else
+            {
+                // The random_vector fixes its first bytes, which would
+                // make the symbols linearly dependent
+                for(auto &c : coefficients)
+                {
+                    c = rand() % 256;
+                }
+            }
+
+            encoders[g]->encode_symbol(&symbol[0], &coefficients[0]);
+            decoder.stage_symbol(g, &symbol[0], &coefficients[0]);
+        }
+
+        decoder.decode();
+    }
+
+    EXPECT_EQ(generations, decoder.complete_generations());
+
+    for(uint32_t g = 0; g < generations; ++g)
+    {
+        EXPECT_TRUE(decoder.is_complete(g));
+        EXPECT_EQ(symbols, decoder.rank(g));
+
+        std::vector<uint8_t> data_out(data_in[g].size(), 0);
+        decoder.copy_symbols(g, sak::storage(data_out));
+
+        EXPECT_TRUE(data_in[g] == data_out);
+    }
+
+    decoder.reset();
+
+    EXPECT_EQ(0U, decoder.complete_generations());
+    EXPECT_EQ(0U, decoder.rank(0));
+}
+
+TEST(TestGenerationBatchDecoder, decode)
+{
+    test_generation_batch_decoder<fifi::binary>(1, 1, 1);
+    test_generation_batch_decoder<fifi::binary8>(1, 1, 1);
+
+    test_generation_batch_decoder<fifi::binary>(100, 8, 32);
+    test_generation_batch_decoder<fifi::binary8>(100, 16, 32);
+
+    uint32_t generations = rand_symbols(200);
+    uint32_t symbols = rand_symbols(16);
+    uint32_t symbol_size = rand_symbol_size(64);
+
+    test_generation_batch_decoder<fifi::binary>(
+        generations, symbols, symbol_size);
+
+    test_generation_batch_decoder<fifi::binary8>(
+        generations, symbols, symbol_size);
+}
+
+/// Checks that the lane-wise multiplication matches the field
+TEST(TestGenerationBatchDecoder, lane_arithmetic)
+{
+    // A generation with one symbol of one byte decodes the symbol
+    // divided by its coefficient
+    const uint32_t generations = 256;
+
+    kodo::generation_batch_decoder<fifi::binary8> decoder(
+        generations, 1, 1);
+
+    fifi::default_field<fifi::binary8>::type field;
+
+    std::vector<uint8_t> expected(generations);
+
+    for(uint32_t g = 0; g < generations; ++g)
+    {
+        uint8_t coefficient = uint8_t(1 + g % 255);
+        uint8_t value = uint8_t(g * 31 + 7);
+
+        uint8_t data = field.multiply(coefficient, value);
+        decoder.stage_symbol(g, &data, &coefficient);
+
+        expected[g] = value;
+    }
+
+    decoder.decode();
+
+    for(uint32_t g = 0; g < generations; ++g)
+    {
+        ASSERT_TRUE(decoder.is_complete(g));
+
+        uint8_t value = 0;
+        decoder.copy_symbols(g, sak::storage(&value, 1));
+
+        EXPECT_EQ(expected[g], value);
+    }
+}
@@ -0,0 +1,140 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_generation_ring.cpp Unit test for the generation_ring and
+///       the generation_stream
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/generation_ring.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Tests the slots of the ring
+TEST(TestGenerationRing, slots)
+{
+    kodo::generation_ring ring(3, 10, 100);
+
+    EXPECT_EQ(3U, ring.slots());
+    EXPECT_EQ(10U, ring.symbols());
+    EXPECT_EQ(100U, ring.symbol_size());
+    EXPECT_EQ(1000U, ring.block_size());
+
+    // Generations the size of the ring apart share a slot
+    EXPECT_EQ(ring.slot(1).m_data, ring.slot(4).m_data);
+    EXPECT_TRUE(ring.slot(0).m_data != ring.slot(1).m_data);
+    EXPECT_EQ(1000U, ring.slot(2).m_size);
+
+    EXPECT_EQ(ring.slot(5).m_data + 300, ring.symbol(5, 3).m_data);
+    EXPECT_EQ(100U, ring.symbol(5, 3).m_size);
+}
+
+/// Streams a number of generations through the rings of an encoder and
+/// a decoder, the encoder codes the symbols as they are produced
+template<class Field>
+void test_stream(uint32_t symbols, uint32_t symbol_size, bool systematic)
+{
+    typedef kodo::ring_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::ring_full_rlnc_decoder<Field> decoder_t;
+
+    uint32_t slots = 3;
+    uint32_t generations = 10;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    kodo::generation_ring encoder_ring(slots, symbols, symbol_size);
+    kodo::generation_ring decoder_ring(slots, symbols, symbol_size);
+
+    kodo::generation_stream<encoder_t> encoder_stream(
+        encoder_factory, encoder_ring);
+
+    kodo::generation_stream<decoder_t> decoder_stream(
+        decoder_factory, decoder_ring);
+
+    // The coders are built once and reused for every generation
+    auto encoder = encoder_stream.coder();
+    auto decoder = decoder_stream.coder();
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t g = 0; g < generations; ++g)
+    {
+        encoder_stream.rebind(g);
+        decoder_stream.rebind(g);
+        decoder_stream.set_symbols();
+
+        // Without the systematic phase every payload is coded from the
+        // symbols set so far
+        if(!systematic)
+        {
+            encoder->set_systematic_off();
+        }
+
+        EXPECT_EQ(g, encoder_stream.generation());
+        EXPECT_EQ(encoder.get(), encoder_stream.coder().get());
+        EXPECT_EQ(decoder.get(), decoder_stream.coder().get());
+
+        EXPECT_EQ(0U, encoder->rank());
+        EXPECT_EQ(0U, decoder->rank());
+        EXPECT_FALSE(decoder->is_complete());
+
+        std::vector<uint8_t> data = random_vector(encoder->block_size());
+
+        // The producer writes the symbols into the slot one by one and
+        // a payload is sent for each
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            sak::mutable_storage symbol = encoder_ring.symbol(g, i);
+
+            std::copy(&data[i * symbol_size],
+                      &data[i * symbol_size] + symbol_size,
+                      symbol.m_data);
+
+            encoder_stream.set_symbol(i);
+
+            EXPECT_EQ(i + 1, encoder->rank());
+
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+
+            // The coded symbols may only combine the symbols set
+            EXPECT_LE(decoder->rank(), encoder->rank());
+        }
+
+        EXPECT_EQ(symbols, encoder->rank());
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+        }
+
+        // The decoder decoded into the slot of the generation
+        sak::mutable_storage slot = decoder_stream.slot();
+
+        EXPECT_EQ(decoder_ring.slot(g).m_data, slot.m_data);
+        EXPECT_TRUE(std::equal(data.begin(), data.end(), slot.m_data));
+    }
+}
+
+TEST(TestGenerationRing, stream)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_stream<fifi::binary>(symbols, symbol_size, true);
+    test_stream<fifi::binary8>(symbols, symbol_size, true);
+    test_stream<fifi::binary16>(symbols, symbol_size, true);
+
+    test_stream<fifi::binary>(symbols, symbol_size, false);
+    test_stream<fifi::binary8>(symbols, symbol_size, false);
+    test_stream<fifi::binary16>(symbols, symbol_size, false);
+}
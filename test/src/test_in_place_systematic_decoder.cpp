@@ -0,0 +1,158 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_in_place_systematic_decoder.cpp Unit tests for receiving
+///       systematic symbols directly into the decoding buffer
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/in_place_systematic_decoder.hpp>
+#include <kodo/shallow_symbol_storage.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Decoder stack with shallow storage receiving systematic symbols
+    /// in place
+    template<class Field>
+    class in_place_rlnc_decoder :
+        public // Payload API
+               payload_decoder<
+               // Codec Header API
+               in_place_systematic_decoder<
+               systematic_decoder<
+               symbol_id_decoder<
+               // Symbol ID API
+               plain_symbol_id_reader<
+               // Codec API
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               // Coefficient Storage API
+               coefficient_storage<
+               coefficient_info<
+               // Storage API
+               mutable_shallow_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               in_place_rlnc_decoder<Field>
+               > > > > > > > > > > > > > > >
+    { };
+}
+
+/// Sends symbols from an encoder to a decoder, the symbol data is
+/// "received" into the predicted destination as with recvmsg(). Every
+/// loss'th symbol is lost.
+/// @return The number of symbols which were decoded in place
+template<class Field>
+uint32_t invoke_in_place(uint32_t symbols, uint32_t symbol_size,
+                         uint32_t loss)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::in_place_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    std::vector<uint8_t> data_out(decoder->block_size(), 0);
+
+    encoder->set_symbols(sak::storage(data_in));
+    decoder->set_symbols(sak::storage(data_out));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> header(decoder->header_size());
+
+    uint32_t in_place = 0;
+    uint32_t sent = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        ++sent;
+
+        if(loss && (sent % loss) == 0)
+        {
+            continue;
+        }
+
+        uint8_t *destination = decoder->systematic_destination();
+        uint8_t *symbol_data = destination;
+
+        if(symbol_data == 0)
+        {
+            symbol_data = &payload[0];
+        }
+        else
+        {
+            std::memcpy(symbol_data, &payload[0], symbol_size);
+        }
+
+        std::memcpy(&header[0], &payload[symbol_size], header.size());
+
+        uint32_t rank = decoder->rank();
+        decoder->decode_in_place(symbol_data, &header[0]);
+
+        // A symbol decoded in place leaves its data where it was
+        // received, and the pivot is its destination
+        if(destination != 0 && decoder->rank() > rank &&
+           std::memcmp(destination, &data_in[destination - &data_out[0]],
+                       symbol_size) == 0 &&
+           std::memcmp(destination, &payload[0], symbol_size) == 0)
+        {
+            ++in_place;
+        }
+    }
+
+    EXPECT_TRUE(data_in == data_out);
+
+    return in_place;
+}
+
+TEST(TestInPlaceSystematicDecoder, no_loss)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    EXPECT_EQ(symbols, invoke_in_place<fifi::binary>(
+                  symbols, symbol_size, 0));
+    EXPECT_EQ(symbols, invoke_in_place<fifi::binary8>(
+                  symbols, symbol_size, 0));
+    EXPECT_EQ(symbols, invoke_in_place<fifi::binary16>(
+                  symbols, symbol_size, 0));
+}
+
+TEST(TestInPlaceSystematicDecoder, loss)
+{
+    uint32_t symbols = rand_symbols() + 4;
+    uint32_t symbol_size = rand_symbol_size();
+
+    // After a loss the prediction misses one symbol, which is then
+    // moved out of the decoding buffer, and the following symbols are
+    // again received in place
+    uint32_t in_place =
+        invoke_in_place<fifi::binary8>(symbols, symbol_size, 3);
+
+    EXPECT_GT(in_place, 0U);
+    EXPECT_LT(in_place, symbols);
+
+    invoke_in_place<fifi::binary>(symbols, symbol_size, 2);
+    invoke_in_place<fifi::binary16>(symbols, symbol_size, 5);
+}
@@ -0,0 +1,170 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_inactivation_decoder.cpp Unit tests for the
+///       inactivation_decoder and the sparse full vector codes
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes a generation of sparse symbols, without the systematic
+/// phase, and checks the size of the dense core
+template<class Field>
+void test_sparse_generation(uint32_t symbols, uint32_t symbol_size,
+                            double density)
+{
+    typedef kodo::sparse_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::sparse_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    encoder->set_systematic_off();
+    encoder->set_density(density);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint32_t encoded = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        ++encoded;
+        ASSERT_TRUE(encoded < 2 * symbols + 100);
+    }
+
+    EXPECT_EQ(symbols, decoder->rank());
+    EXPECT_TRUE(decoder->inactive_symbols() <= symbols);
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        EXPECT_TRUE(decoder->symbol_pivot(i));
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestInactivationDecoder, test_sparse_generation)
+{
+    test_sparse_generation<fifi::binary>(1, 10, 0.5);
+    test_sparse_generation<fifi::binary8>(1, 10, 0.5);
+
+    test_sparse_generation<fifi::binary>(64, 16, 0.1);
+    test_sparse_generation<fifi::binary8>(64, 16, 0.1);
+    test_sparse_generation<fifi::binary16>(64, 16, 0.1);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size(100);
+
+    test_sparse_generation<fifi::binary>(symbols, symbol_size, 0.3);
+    test_sparse_generation<fifi::binary8>(symbols, symbol_size, 0.3);
+}
+
+/// A large generation with a few non-zero coefficients per symbol is
+/// mostly decoded by the peeling
+TEST(TestInactivationDecoder, test_large_sparse_generation)
+{
+    uint32_t symbols = 1024;
+
+    typedef kodo::sparse_full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::sparse_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    encoder_t::factory encoder_factory(symbols, 8);
+    decoder_t::factory decoder_factory(symbols, 8);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    encoder->set_systematic_off();
+    encoder->set_density(8.0 / symbols);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_TRUE(decoder->inactive_symbols() < symbols / 2);
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestInactivationDecoder, test_basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::sparse_full_rlnc_encoder<fifi::binary>,
+                     kodo::sparse_full_rlnc_decoder<fifi::binary> >(
+                         symbols, symbol_size);
+
+    invoke_basic_api<kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+                     kodo::sparse_full_rlnc_decoder<fifi::binary8> >(
+                         symbols, symbol_size);
+
+    // The decoder also decodes dense symbols
+    invoke_basic_api<kodo::full_rlnc_encoder<fifi::binary8>,
+                     kodo::sparse_full_rlnc_decoder<fifi::binary8> >(
+                         symbols, symbol_size);
+}
+
+TEST(TestInactivationDecoder, test_out_of_order_raw)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_out_of_order_raw<kodo::sparse_full_rlnc_encoder<fifi::binary>,
+                            kodo::sparse_full_rlnc_decoder<fifi::binary> >(
+                                symbols, symbol_size);
+
+    invoke_out_of_order_raw<kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+                            kodo::sparse_full_rlnc_decoder<fifi::binary8> >(
+                                symbols, symbol_size);
+}
+
+TEST(TestInactivationDecoder, test_initialize)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_initialize<kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+                      kodo::sparse_full_rlnc_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+}
+
+TEST(TestInactivationDecoder, test_systematic)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+                      kodo::sparse_full_rlnc_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+}
@@ -0,0 +1,146 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_interleaved_object_xyz.cpp Unit tests for the interleaved
+///       object encoder and decoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/interleaved_object_decoder.hpp>
+#include <kodo/interleaved_object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+
+    typedef kodo::interleaved_object_encoder<storage_reader, encoder_t>
+        object_encoder_t;
+
+    typedef kodo::interleaved_object_decoder<decoder_t> object_decoder_t;
+}
+
+TEST(TestInterleavedObject, block_id_size)
+{
+    EXPECT_EQ(1U, kodo::block_id_size(1));
+    EXPECT_EQ(1U, kodo::block_id_size(256));
+    EXPECT_EQ(2U, kodo::block_id_size(257));
+    EXPECT_EQ(2U, kodo::block_id_size(65536));
+    EXPECT_EQ(4U, kodo::block_id_size(65537));
+
+    uint8_t buffer[4];
+
+    for(uint32_t size : {1U, 2U, 4U})
+    {
+        kodo::write_block_id(200, size, buffer);
+        EXPECT_EQ(200U, kodo::read_block_id(size, buffer));
+    }
+
+    kodo::write_block_id(70000, 4, buffer);
+    EXPECT_EQ(70000U, kodo::read_block_id(4, buffer));
+}
+
+TEST(TestInterleavedObject, schedule)
+{
+    uint32_t symbols = 4;
+    uint32_t symbol_size = 8;
+
+    std::vector<uint8_t> data_in = random_vector(5 * symbols * symbol_size);
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    object_encoder_t encoder(encoder_factory,
+                             storage_reader(sak::storage(data_in)));
+
+    EXPECT_EQ(5U, encoder.blocks());
+    EXPECT_EQ(1U, encoder.id_size());
+
+    // Round-robin with equal priorities
+    for(uint32_t i = 0; i < 15; ++i)
+    {
+        EXPECT_EQ(i % 5, encoder.next_block());
+    }
+
+    // Block 1 is twice as frequent and block 3 is not scheduled
+    encoder.set_priority(1, 2);
+    encoder.set_priority(3, 0);
+
+    std::vector<uint32_t> picks(5, 0);
+
+    for(uint32_t i = 0; i < 50; ++i)
+    {
+        ++picks[encoder.next_block()];
+    }
+
+    EXPECT_EQ(10U, picks[0]);
+    EXPECT_EQ(20U, picks[1]);
+    EXPECT_EQ(10U, picks[2]);
+    EXPECT_EQ(0U, picks[3]);
+    EXPECT_EQ(10U, picks[4]);
+
+    for(uint32_t i = 0; i < 5; ++i)
+    {
+        encoder.set_priority(i, 0);
+    }
+
+    EXPECT_FALSE(encoder.has_scheduled_blocks());
+}
+
+/// Streams an object over a channel with bursts of losses
+TEST(TestInterleavedObject, burst_losses)
+{
+    uint32_t symbols = rand_symbols(32);
+    uint32_t symbol_size = rand_symbol_size();
+    uint32_t object_size = rand_nonzero(symbols * symbol_size * 10);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+    std::vector<uint8_t> data_out(object_size, '\0');
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    object_encoder_t encoder(encoder_factory,
+                             storage_reader(sak::storage(data_in)));
+    object_decoder_t decoder(decoder_factory, sak::storage(data_out));
+
+    EXPECT_EQ(encoder.blocks(), decoder.blocks());
+    EXPECT_EQ(encoder.id_size(), decoder.id_size());
+
+    std::vector<uint8_t> payload(encoder.payload_size());
+
+    uint32_t sent = 0;
+
+    while(!decoder.is_complete())
+    {
+        uint32_t block = encoder.next_block();
+        encoder.encode(block, &payload[0]);
+        ++sent;
+
+        // Every tenth payload starts a burst of three losses
+        if(sent % 10 < 3)
+        {
+            continue;
+        }
+
+        EXPECT_EQ(block, decoder.decode(&payload[0]));
+
+        // Acknowledged blocks are no longer sent
+        if(decoder.is_block_complete(block))
+        {
+            encoder.set_priority(block, 0);
+        }
+    }
+
+    EXPECT_EQ(0U, decoder.block_decoders().live_decoders());
+    EXPECT_TRUE(data_in == data_out);
+}
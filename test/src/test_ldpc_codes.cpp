@@ -0,0 +1,210 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_ldpc_codes.cpp Unit tests for the LDPC-staircase codes
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/ldpc/ldpc_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Checks the degrees of the parity check matrix and that the same
+/// seed gives the same matrix
+TEST(TestLdpcCodes, test_matrix)
+{
+    uint32_t symbols = 1000;
+    uint32_t repair_symbols = 500;
+
+    kodo::ldpc_staircase_matrix matrix(symbols, repair_symbols, 3, 1234);
+
+    EXPECT_EQ(symbols, matrix.symbols());
+    EXPECT_EQ(repair_symbols, matrix.repair_symbols());
+    EXPECT_EQ(symbols + repair_symbols, matrix.code_length());
+
+    uint32_t ones = 0;
+
+    for(uint32_t j = 0; j < symbols; ++j)
+    {
+        EXPECT_EQ(3U, matrix.column(j).size());
+    }
+
+    for(uint32_t r = 0; r < repair_symbols; ++r)
+    {
+        const std::vector<uint32_t> &row = matrix.row(r);
+
+        EXPECT_GE(row.size(), 2U);
+        EXPECT_TRUE(std::is_sorted(row.begin(), row.end()));
+
+        for(uint32_t j : row)
+        {
+            const std::vector<uint32_t> &column = matrix.column(j);
+            EXPECT_TRUE(std::binary_search(column.begin(), column.end(), r));
+        }
+
+        ones += static_cast<uint32_t>(row.size());
+    }
+
+    EXPECT_EQ(3 * symbols, ones);
+
+    kodo::ldpc_staircase_matrix same(symbols, repair_symbols, 3, 1234);
+
+    for(uint32_t r = 0; r < repair_symbols; ++r)
+    {
+        EXPECT_TRUE(matrix.row(r) == same.row(r));
+    }
+
+    // Small blocks use fewer rows per column than the left degree
+    kodo::ldpc_staircase_matrix small(2, 1, 3, 1);
+
+    EXPECT_EQ(2U, small.row(0).size());
+}
+
+/// Encodes every symbol of a block, receives them in a random order,
+/// i.e. with random erasures, and returns the number of symbols needed
+uint32_t test_ldpc_block(uint32_t symbols, uint32_t symbol_size,
+                         double code_rate)
+{
+    typedef kodo::ldpc_encoder encoder_t;
+    typedef kodo::ldpc_decoder decoder_t;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    encoder_factory.set_code_rate(code_rate);
+    decoder_factory.set_code_rate(code_rate);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(encoder->code_length(), decoder->code_length());
+    EXPECT_GE(encoder->code_length() * code_rate, symbols - 1e-6);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<std::vector<uint8_t> > payloads(encoder->code_length());
+
+    for(auto &payload : payloads)
+    {
+        payload.resize(encoder->payload_size());
+        encoder->encode(&payload[0]);
+    }
+
+    std::random_shuffle(payloads.begin(), payloads.end());
+
+    uint32_t received = 0;
+
+    for(auto &payload : payloads)
+    {
+        if(decoder->is_complete())
+            break;
+
+        decoder->decode(&payload[0]);
+        ++received;
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+    EXPECT_EQ(received, decoder->received_symbols());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+
+    return received;
+}
+
+TEST(TestLdpcCodes, test_encode_decode)
+{
+    test_ldpc_block(1, 10, 0.5);
+    test_ldpc_block(2, 10, 2.0 / 3.0);
+    test_ldpc_block(100, 16, 0.5);
+    test_ldpc_block(100, 16, 0.9);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size(100);
+
+    test_ldpc_block(symbols, symbol_size, 2.0 / 3.0);
+}
+
+/// A large block decodes with few extra symbols
+TEST(TestLdpcCodes, test_large_block)
+{
+    uint32_t symbols = 2000;
+    uint32_t received = test_ldpc_block(symbols, 16, 2.0 / 3.0);
+
+    EXPECT_LT(received, symbols + symbols / 5);
+}
+
+/// The repair symbols are the staircase sums of the rows
+TEST(TestLdpcCodes, test_repair_symbols)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    kodo::ldpc_encoder::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    const kodo::ldpc_staircase_matrix &matrix =
+        encoder->parity_check_matrix();
+
+    std::vector<uint8_t> sum(symbol_size, 0);
+
+    for(uint32_t r = 0; r < encoder->repair_symbols(); ++r)
+    {
+        for(uint32_t j : matrix.row(r))
+        {
+            for(uint32_t i = 0; i < symbol_size; ++i)
+                sum[i] ^= data_in[j * symbol_size + i];
+        }
+
+        const uint8_t *repair = encoder->repair_symbol(r);
+        EXPECT_TRUE(std::equal(sum.begin(), sum.end(), repair));
+    }
+}
+
+TEST(TestLdpcCodes, test_basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::ldpc_encoder, kodo::ldpc_decoder>(
+        symbols, symbol_size);
+}
+
+TEST(TestLdpcCodes, test_out_of_order_raw)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_out_of_order_raw<kodo::ldpc_encoder, kodo::ldpc_decoder>(
+        symbols, symbol_size);
+}
+
+TEST(TestLdpcCodes, test_initialize)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_initialize<kodo::ldpc_encoder, kodo::ldpc_decoder>(
+        symbols, symbol_size);
+}
+
+TEST(TestLdpcCodes, test_systematic)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<kodo::ldpc_encoder, kodo::ldpc_decoder>(
+        symbols, symbol_size);
+}
@@ -0,0 +1,146 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_linear_block_decoder.cpp Unit tests for the
+///       linear_block_decoder layer
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes sparse coded symbols, whose encoding vectors have long runs
+/// of zero coefficients skipped by the word scans of the decoder
+template<class Field>
+void test_sparse_decoding(uint32_t symbols, uint32_t symbol_size,
+                          double density)
+{
+    typedef kodo::sparse_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    encoder->set_density(density);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> symbol(symbol_size);
+
+    // Every other symbol is received uncoded, such that the scans skip
+    // both uncoded and coded pivots
+    for(uint32_t i = 0; i < symbols; i += 2)
+    {
+        std::copy(data_in.begin() + i * symbol_size,
+                  data_in.begin() + (i + 1) * symbol_size,
+                  symbol.begin());
+
+        decoder->decode_symbol(&symbol[0], i);
+    }
+
+    encoder->set_systematic_off();
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestLinearBlockDecoder, test_sparse_decoding)
+{
+    test_sparse_decoding<fifi::binary>(1024, 16, 0.01);
+    test_sparse_decoding<fifi::binary>(67, 16, 0.1);
+    test_sparse_decoding<fifi::binary8>(130, 16, 0.05);
+    test_sparse_decoding<fifi::binary16>(70, 16, 0.05);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_sparse_decoding<fifi::binary>(symbols, symbol_size, 0.1);
+    test_sparse_decoding<fifi::binary8>(symbols, symbol_size, 0.1);
+}
+
+/// Decodes coded symbols followed by the uncoded symbols in random
+/// order, so the uncoded symbols are backward substituted into the
+/// coded symbols and swapped with them
+template<class Field>
+void test_coded_then_uncoded(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < symbols / 2; ++i)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint32_t> order(symbols);
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        order[i] = i;
+    }
+
+    std::random_shuffle(order.begin(), order.end());
+
+    std::vector<uint8_t> symbol(symbol_size);
+
+    for(uint32_t i : order)
+    {
+        std::copy(data_in.begin() + i * symbol_size,
+                  data_in.begin() + (i + 1) * symbol_size,
+                  symbol.begin());
+
+        decoder->decode_symbol(&symbol[0], i);
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestLinearBlockDecoder, test_coded_then_uncoded)
+{
+    test_coded_then_uncoded<fifi::binary>(67, 16);
+    test_coded_then_uncoded<fifi::binary8>(32, 16);
+    test_coded_then_uncoded<fifi::binary16>(16, 16);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_coded_then_uncoded<fifi::binary8>(symbols, symbol_size);
+}
@@ -0,0 +1,149 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_linear_block_decoder_blocked.cpp Unit tests for the
+///       linear_block_decoder_blocked layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes a block and checks that the symbols are decoded at full
+/// rank
+template<class Field>
+void test_blocked_decoder(uint32_t symbols, uint32_t symbol_size,
+                          bool systematic)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::blocked_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+
+    if(!systematic)
+        encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // Decode two blocks, the second with a recycled decoder
+    for(uint32_t block = 0; block < 2; ++block)
+    {
+        auto decoder = decoder_factory.build();
+        EXPECT_EQ(0U, decoder->rank());
+
+        while(!decoder->is_complete())
+        {
+            uint32_t rank = decoder->rank();
+
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+
+            EXPECT_TRUE(decoder->rank() <= rank + 1);
+        }
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            EXPECT_TRUE(decoder->symbol_pivot(i));
+        }
+
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data_in);
+    }
+}
+
+TEST(TestLinearBlockDecoderBlocked, test_decode)
+{
+    test_blocked_decoder<fifi::binary>(1, 16, false);
+    test_blocked_decoder<fifi::binary8>(1, 16, false);
+
+    test_blocked_decoder<fifi::binary>(64, 160, false);
+    test_blocked_decoder<fifi::binary8>(64, 160, true);
+    test_blocked_decoder<fifi::binary8>(64, 160, false);
+    test_blocked_decoder<fifi::binary16>(64, 160, false);
+
+    // Large enough for several tiles and blocks of rows
+    test_blocked_decoder<fifi::binary8>(512, 2048, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_blocked_decoder<fifi::binary8>(symbols, symbol_size, false);
+}
+
+/// The decoder rejects the symbols which are not innovative
+TEST(TestLinearBlockDecoderBlocked, test_dependent_symbols)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::blocked_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 8;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    encoder->set_systematic_off();
+
+    for(uint32_t i = 0; i < symbols / 2; ++i)
+    {
+        encoder->encode(&payload[0]);
+
+        std::vector<uint8_t> copy = payload;
+
+        decoder->decode(&payload[0]);
+        EXPECT_EQ(i + 1, decoder->rank());
+
+        // The same coded symbol again is not innovative
+        decoder->decode(&copy[0]);
+        EXPECT_EQ(i + 1, decoder->rank());
+    }
+
+    EXPECT_FALSE(decoder->is_complete());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestLinearBlockDecoderBlocked, test_basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::full_rlnc_encoder<fifi::binary8>,
+                     kodo::blocked_full_rlnc_decoder<fifi::binary8> >(
+                         symbols, symbol_size);
+
+    invoke_basic_api<kodo::full_rlnc_encoder<fifi::binary16>,
+                     kodo::blocked_full_rlnc_decoder<fifi::binary16> >(
+                         symbols, symbol_size);
+}
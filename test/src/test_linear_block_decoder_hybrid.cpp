@@ -0,0 +1,152 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_linear_block_decoder_hybrid.cpp Unit tests for the
+///       linear_block_decoder_hybrid layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes coded symbols and checks the backward substitution is
+/// delayed below the threshold and spread over the symbols above it
+template<class Field>
+void test_hybrid_schedule(uint32_t symbols, uint32_t symbol_size,
+                          uint32_t threshold)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder_hybrid<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(symbols / 2, decoder->backward_substitution_threshold());
+
+    decoder->set_backward_substitution_threshold(threshold);
+    EXPECT_EQ(threshold, decoder->backward_substitution_threshold());
+
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // The most pivots reduced by one symbol
+    uint32_t chunk = 0;
+
+    while(!decoder->is_complete())
+    {
+        uint32_t pending = decoder->pending_backward_substitutions();
+        uint32_t rank = decoder->rank();
+
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        if(decoder->rank() < threshold)
+        {
+            EXPECT_EQ(decoder->rank(),
+                      decoder->pending_backward_substitutions());
+        }
+        else if(decoder->rank() > rank)
+        {
+            uint32_t reduced =
+                pending + 1 - decoder->pending_backward_substitutions();
+            chunk = std::max(chunk, reduced);
+        }
+    }
+
+    EXPECT_EQ(0U, decoder->pending_backward_substitutions());
+
+    // The pending pivots at the threshold are spread over the symbols
+    // needed after it
+    uint32_t remaining = symbols - threshold + 1;
+    EXPECT_TRUE(chunk <= (threshold + remaining - 1) / remaining + 1);
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestLinearBlockDecoderHybrid, test_schedule)
+{
+    test_hybrid_schedule<fifi::binary>(1, 10, 1);
+    test_hybrid_schedule<fifi::binary8>(1, 10, 0);
+
+    test_hybrid_schedule<fifi::binary>(64, 16, 32);
+    test_hybrid_schedule<fifi::binary8>(64, 16, 32);
+    test_hybrid_schedule<fifi::binary16>(64, 16, 32);
+
+    // Eager and delayed
+    test_hybrid_schedule<fifi::binary8>(32, 16, 0);
+    test_hybrid_schedule<fifi::binary8>(32, 16, 32);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_hybrid_schedule<fifi::binary>(symbols, symbol_size, symbols / 4);
+    test_hybrid_schedule<fifi::binary8>(symbols, symbol_size, symbols / 4);
+}
+
+TEST(TestLinearBlockDecoderHybrid, test_basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::full_rlnc_encoder<fifi::binary>,
+                     kodo::full_rlnc_decoder_hybrid<fifi::binary> >(
+                         symbols, symbol_size);
+
+    invoke_basic_api<kodo::full_rlnc_encoder<fifi::binary8>,
+                     kodo::full_rlnc_decoder_hybrid<fifi::binary8> >(
+                         symbols, symbol_size);
+
+    invoke_basic_api<kodo::full_rlnc_encoder<fifi::binary16>,
+                     kodo::full_rlnc_decoder_hybrid<fifi::binary16> >(
+                         symbols, symbol_size);
+}
+
+TEST(TestLinearBlockDecoderHybrid, test_out_of_order_raw)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_out_of_order_raw<kodo::full_rlnc_encoder<fifi::binary>,
+                            kodo::full_rlnc_decoder_hybrid<fifi::binary> >(
+                                symbols, symbol_size);
+
+    invoke_out_of_order_raw<kodo::full_rlnc_encoder<fifi::binary8>,
+                            kodo::full_rlnc_decoder_hybrid<fifi::binary8> >(
+                                symbols, symbol_size);
+}
+
+TEST(TestLinearBlockDecoderHybrid, test_initialize)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_initialize<kodo::full_rlnc_encoder<fifi::binary8>,
+                      kodo::full_rlnc_decoder_hybrid<fifi::binary8> >(
+                          symbols, symbol_size);
+}
+
+TEST(TestLinearBlockDecoderHybrid, test_systematic)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<kodo::full_rlnc_encoder<fifi::binary8>,
+                      kodo::full_rlnc_decoder_hybrid<fifi::binary8> >(
+                          symbols, symbol_size);
+}
@@ -0,0 +1,182 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_linear_block_decoder_logged.cpp Unit tests for the
+///       linear_block_decoder_logged layer and the operation_log
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/shared_field.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes a block replaying the log when the decoder is complete
+template<class Field>
+void test_logged_decoder(uint32_t symbols, uint32_t symbol_size,
+                         bool systematic)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::logged_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+
+    if(!systematic)
+        encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // Decode two blocks, the second with a recycled decoder
+    for(uint32_t block = 0; block < 2; ++block)
+    {
+        auto decoder = decoder_factory.build();
+        EXPECT_EQ(0U, decoder->rank());
+        EXPECT_EQ(0U, decoder->decoding_log().size());
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+
+            uint32_t rank = decoder->rank();
+            uint32_t operations = decoder->decoding_log().size();
+
+            decoder->decode(&payload[0]);
+
+            // A symbol which is not innovative records nothing
+            if(decoder->rank() == rank)
+            {
+                EXPECT_EQ(operations, decoder->decoding_log().size());
+            }
+        }
+
+        EXPECT_EQ(decoder->decoding_log().size(),
+                  decoder->operations_replayed());
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            EXPECT_TRUE(decoder->symbol_pivot(i));
+        }
+
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data_in);
+    }
+}
+
+TEST(TestLinearBlockDecoderLogged, test_decode)
+{
+    test_logged_decoder<fifi::binary>(1, 16, false);
+    test_logged_decoder<fifi::binary8>(1, 16, false);
+
+    test_logged_decoder<fifi::binary>(32, 160, false);
+    test_logged_decoder<fifi::binary8>(32, 160, true);
+    test_logged_decoder<fifi::binary8>(32, 160, false);
+    test_logged_decoder<fifi::binary16>(32, 160, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_logged_decoder<fifi::binary8>(symbols, symbol_size, false);
+}
+
+/// Replays the log of a deferred decoder on a separate copy of the
+/// received symbols, in two batches
+template<class Field>
+void test_deferred_replay(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::logged_full_rlnc_decoder<Field> decoder_t;
+
+    typedef typename fifi::default_field<Field>::type field_impl;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    encoder->set_systematic_off();
+    decoder->set_replay_deferred(true);
+
+    EXPECT_TRUE(decoder->is_replay_deferred());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // The data plane keeps every received symbol, the symbol data
+    // starts the payload
+    std::vector<std::vector<uint8_t> > received;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        received.push_back(std::vector<uint8_t>(
+            payload.begin(), payload.begin() + symbol_size));
+
+        decoder->decode(&payload[0]);
+    }
+
+    // Nothing was replayed by the decoder
+    EXPECT_EQ(0U, decoder->operations_replayed());
+
+    const auto &log = decoder->decoding_log();
+    ASSERT_EQ(symbols, log.slots());
+
+    std::vector<std::vector<uint8_t> > slots(symbols);
+    std::vector<uint8_t*> pointers(symbols);
+
+    for(uint32_t s = 0; s < symbols; ++s)
+    {
+        ASSERT_TRUE(log.slot_source(s) < received.size());
+
+        slots[s] = received[log.slot_source(s)];
+        pointers[s] = &slots[s][0];
+    }
+
+    auto field = kodo::shared_field<field_impl>();
+
+    uint32_t half = log.size() / 2;
+    log.replay(*field, &pointers[0], symbol_size, 0, half);
+    log.replay(*field, &pointers[0], symbol_size, half, log.size());
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        const std::vector<uint8_t> &symbol = slots[log.pivot_slot(i)];
+
+        EXPECT_TRUE(std::equal(symbol.begin(), symbol.end(),
+                               &data_in[i * symbol_size]));
+    }
+
+    // The decoder may also replay the log on its own storage
+    decoder->replay_log();
+    EXPECT_EQ(log.size(), decoder->operations_replayed());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestLinearBlockDecoderLogged, test_deferred_replay)
+{
+    test_deferred_replay<fifi::binary>(16, 64);
+    test_deferred_replay<fifi::binary8>(16, 64);
+    test_deferred_replay<fifi::binary16>(16, 64);
+    test_deferred_replay<fifi::binary8>(100, 160);
+}
@@ -0,0 +1,144 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_linear_block_decoder_m4ri.cpp Unit tests for the M4RI
+///       linear block decoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/linear_block_decoder_m4ri.hpp>
+#include <kodo/snapshot.hpp>
+
+#include "basic_api_test_helper.hpp"
+#include "test_reuse.hpp"
+
+namespace kodo
+{
+
+    /// RLNC decoder using the Method of Four Russians for the forward
+    /// substitution
+    template<class Field>
+    class full_rlnc_decoder_m4ri
+        : public // Payload API
+                 payload_recoder<recoding_stack,
+                 payload_decoder<
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder_m4ri<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 full_rlnc_decoder_m4ri<Field>
+                     > > > > > > > > > > > > > > > >
+    { };
+
+}
+
+void test_m4ri_decoder(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary> encoder_type;
+    typedef kodo::full_rlnc_decoder_m4ri<fifi::binary> decoder_type;
+
+    invoke_basic_api<encoder_type, decoder_type>(symbols, symbol_size);
+    invoke_out_of_order_raw<encoder_type, decoder_type>(
+        symbols, symbol_size);
+    invoke_initialize<encoder_type, decoder_type>(symbols, symbol_size);
+    invoke_systematic<encoder_type, decoder_type>(symbols, symbol_size);
+    invoke_reuse<encoder_type, decoder_type>(symbols, symbol_size);
+}
+
+/// Tests that the decoder produces the original data also when the
+/// number of symbols is not a multiple of the block width
+TEST(TestLinearBlockDecoderM4ri, decode)
+{
+    test_m4ri_decoder(1, 1600);
+    test_m4ri_decoder(3, 160);
+    test_m4ri_decoder(32, 1600);
+    test_m4ri_decoder(130, 64);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_m4ri_decoder(symbols, symbol_size);
+}
+
+/// Tests that the tables built from the symbols of a decoder are not
+/// used after a snapshot of another decoder is restored into it
+TEST(TestLinearBlockDecoderM4ri, read_snapshot)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary> encoder_type;
+    typedef kodo::full_rlnc_decoder_m4ri<fifi::binary> decoder_type;
+
+    uint32_t symbols = 32;
+    uint32_t symbol_size = 160;
+
+    encoder_type::factory encoder_factory(symbols, symbol_size);
+    decoder_type::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+    auto other = decoder_factory.build();
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // The decoder builds the tables of the first blocks from one block
+    // of data
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    while(decoder->rank() < symbols / 2)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    // The other decoder is half way with another block of data
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+    encoder->initialize(encoder_factory);
+    encoder->set_symbols(sak::storage(data_in));
+
+    while(other->rank() < symbols / 2)
+    {
+        encoder->encode(&payload[0]);
+        other->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> snapshot = kodo::snapshot(other);
+    ASSERT_TRUE(kodo::restore(decoder, sak::storage(snapshot)));
+
+    kodo::set_systematic_off(encoder);
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
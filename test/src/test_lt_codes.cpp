@@ -0,0 +1,231 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_lt_codes.cpp Unit tests for the LT fountain codes and the
+///       robust soliton generator
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/lt/lt_codes.hpp>
+#include <kodo/robust_soliton_generator.hpp>
+
+#include "coefficient_generator_helper.hpp"
+
+namespace kodo
+{
+
+    // Robust soliton generator
+    template<class Field>
+    class robust_soliton_generator_stack :
+        public robust_soliton_generator<
+               fake_codec_layer<
+               coefficient_info<
+               fake_symbol_storage<
+               storage_block_info<
+               finite_field_info<Field,
+               final_coder_factory_pool<
+               robust_soliton_generator_stack<Field>
+               > > > > > > >
+    { };
+
+}
+
+/// Tests that the list of non-zero coefficients matches the generated
+/// coefficient vector and that the degrees follow the distribution
+template<class Coder>
+struct api_soliton_degrees
+{
+
+    typedef typename Coder::factory factory_type;
+    typedef typename Coder::pointer pointer_type;
+    typedef typename Coder::field_type field_type;
+    typedef typename Coder::value_type value_type;
+
+    api_soliton_degrees(uint32_t max_symbols, uint32_t max_symbol_size)
+        : m_factory(max_symbols, max_symbol_size)
+    { }
+
+    void run()
+    {
+        m_factory.set_symbols(m_factory.max_symbols());
+        m_factory.set_symbol_size(m_factory.max_symbol_size());
+
+        pointer_type coder = m_factory.build();
+
+        std::vector<uint8_t> coefficients(coder->coefficients_size());
+        const value_type *c =
+            reinterpret_cast<const value_type*>(&coefficients[0]);
+
+        uint32_t total = 0;
+        uint32_t ones = 0;
+        uint32_t rounds = 500;
+
+        coder->seed(0);
+
+        for(uint32_t round = 0; round < rounds; ++round)
+        {
+            coder->generate(&coefficients[0]);
+
+            uint32_t count = coder->nonzero_count();
+            ASSERT_TRUE(count > 0);
+
+            total += count;
+            ones += count == 1;
+
+            uint32_t next = 0;
+            for(uint32_t i = 0; i < coder->symbols(); ++i)
+            {
+                value_type value = fifi::get_value<field_type>(c, i);
+
+                if(!value)
+                    continue;
+
+                ASSERT_TRUE(next < count);
+                EXPECT_EQ(i, coder->nonzero_indices()[next]);
+                EXPECT_EQ(value, coder->nonzero_values()[next]);
+                ++next;
+            }
+
+            EXPECT_EQ(next, count);
+        }
+
+        // The average degree is logarithmic in the number of symbols
+        double average = double(total) / rounds;
+        EXPECT_GT(average, 0.5 * coder->average_degree());
+        EXPECT_LT(average, 2.0 * coder->average_degree());
+        EXPECT_LT(coder->average_degree(), 0.1 * coder->symbols());
+
+        // Degree one symbols are needed to start the peeling
+        EXPECT_GT(ones, 0U);
+    }
+
+private:
+
+    // The factory
+    factory_type m_factory;
+
+};
+
+TEST(TestLtCodes, robust_soliton_generator)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    run_test<kodo::robust_soliton_generator_stack, api_generate>(
+        symbols, symbol_size);
+
+    run_test<kodo::robust_soliton_generator_stack, api_soliton_degrees>(
+        1000, 10);
+}
+
+/// Decodes a single block without the systematic phase and returns the
+/// number of symbols needed
+template<class Field>
+uint32_t test_lt_block(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::lt_encoder<Field> encoder_t;
+    typedef kodo::lt_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint32_t encoded = 0;
+
+    while(!decoder->is_complete() && encoded < 2 * symbols + 100)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        ++encoded;
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+
+    return encoded;
+}
+
+TEST(TestLtCodes, test_encode_decode)
+{
+    test_lt_block<fifi::binary>(1, 10);
+    test_lt_block<fifi::binary8>(1, 10);
+
+    test_lt_block<fifi::binary>(100, 16);
+    test_lt_block<fifi::binary8>(100, 16);
+    test_lt_block<fifi::binary16>(100, 16);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size(100);
+
+    test_lt_block<fifi::binary>(symbols, symbol_size);
+    test_lt_block<fifi::binary8>(symbols, symbol_size);
+}
+
+/// A megabyte object is encoded as one block
+TEST(TestLtCodes, test_single_block_object)
+{
+    uint32_t symbols = 4096;
+    uint32_t encoded = test_lt_block<fifi::binary>(symbols, 256);
+
+    // The inactivation keeps the overhead small
+    EXPECT_LT(encoded, symbols + symbols / 10);
+}
+
+TEST(TestLtCodes, test_basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::lt_encoder<fifi::binary>,
+                     kodo::lt_decoder<fifi::binary> >(symbols, symbol_size);
+
+    invoke_basic_api<kodo::lt_encoder<fifi::binary8>,
+                     kodo::lt_decoder<fifi::binary8> >(symbols, symbol_size);
+}
+
+TEST(TestLtCodes, test_out_of_order_raw)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_out_of_order_raw<kodo::lt_encoder<fifi::binary>,
+                            kodo::lt_decoder<fifi::binary> >(
+                                symbols, symbol_size);
+}
+
+TEST(TestLtCodes, test_initialize)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_initialize<kodo::lt_encoder<fifi::binary>,
+                      kodo::lt_decoder<fifi::binary> >(symbols, symbol_size);
+}
+
+TEST(TestLtCodes, test_systematic)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<kodo::lt_encoder<fifi::binary>,
+                      kodo::lt_decoder<fifi::binary> >(symbols, symbol_size);
+}
@@ -0,0 +1,199 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_markowitz_pivot_decoder.cpp Unit tests for the pivot
+///       selection lowering the fill-in of sparse symbols
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// @return The number of non-zero coefficients of the coded symbols
+///         stored in a decoder
+template<class Decoder>
+uint32_t stored_nonzeros(Decoder &decoder)
+{
+    typedef typename Decoder::element_type::field_type field_type;
+
+    uint32_t nonzeros = 0;
+
+    for(uint32_t i = 0; i < decoder->symbols(); ++i)
+    {
+        if(!decoder->symbol_pivot(i) || !decoder->symbol_coded(i))
+            continue;
+
+        for(uint32_t j = 0; j < decoder->symbols(); ++j)
+        {
+            if(fifi::get_value<field_type>(
+                   decoder->coefficients_value(i), j))
+            {
+                ++nonzeros;
+            }
+        }
+    }
+
+    return nonzeros;
+}
+
+/// Checks the column counts against the stored coded symbols
+template<class Decoder>
+void check_column_counts(Decoder &decoder)
+{
+    typedef typename Decoder::element_type::field_type field_type;
+
+    for(uint32_t j = 0; j < decoder->symbols(); ++j)
+    {
+        uint32_t count = 0;
+
+        for(uint32_t i = 0; i < decoder->symbols(); ++i)
+        {
+            if(!decoder->symbol_pivot(i) || !decoder->symbol_coded(i))
+                continue;
+
+            if(fifi::get_value<field_type>(
+                   decoder->coefficients_value(i), j))
+            {
+                ++count;
+            }
+        }
+
+        EXPECT_EQ(count, decoder->column_count(j));
+    }
+}
+
+/// Decodes the same sparse symbols with the linear_block_decoder and
+/// with the Markowitz pivots, and compares the fill-in
+template<class Field>
+void test_fill_in(uint32_t symbols, double density)
+{
+    uint32_t symbol_size = 16;
+
+    typename kodo::sparse_full_rlnc_encoder<Field>::factory
+        encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+    kodo::set_systematic_off(encoder);
+    encoder->set_density(density);
+
+    typename kodo::full_rlnc_decoder<Field>::factory
+        reference_factory(symbols, symbol_size);
+    auto reference = reference_factory.build();
+
+    typename kodo::markowitz_full_rlnc_decoder<Field>::factory
+        decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(decoder->rank() < (3 * symbols) / 4)
+    {
+        encoder->encode(&payload[0]);
+
+        std::vector<uint8_t> copy = payload;
+        reference->decode(&copy[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    // The rank only depends on the subspace of the received symbols
+    EXPECT_EQ(reference->rank(), decoder->rank());
+    EXPECT_LT(stored_nonzeros(decoder), stored_nonzeros(reference));
+
+    check_column_counts(decoder);
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestMarkowitzPivotDecoder, fill_in)
+{
+    test_fill_in<fifi::binary>(128, 3.0 / 128);
+    test_fill_in<fifi::binary8>(128, 3.0 / 128);
+    test_fill_in<fifi::binary16>(64, 3.0 / 64);
+}
+
+/// Systematic symbols replacing coded symbols keep the column counts
+/// up to date
+TEST(TestMarkowitzPivotDecoder, systematic_swap)
+{
+    uint32_t symbols = 32;
+    uint32_t symbol_size = 16;
+
+    typedef fifi::binary8 field_type;
+
+    kodo::sparse_full_rlnc_encoder<field_type>::factory
+        encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+    encoder->set_density(0.1);
+
+    kodo::markowitz_full_rlnc_decoder<field_type>::factory
+        decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<std::vector<uint8_t> > systematic;
+
+    // Keep the systematic symbols and start with coded ones
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        encoder->encode(&payload[0]);
+        systematic.push_back(payload);
+    }
+
+    for(uint32_t i = 0; i < symbols / 2; ++i)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    check_column_counts(decoder);
+
+    for(auto &s : systematic)
+    {
+        decoder->decode(&s[0]);
+        check_column_counts(decoder);
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestMarkowitzPivotDecoder, api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+                      kodo::markowitz_full_rlnc_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+
+    invoke_out_of_order_raw<
+        kodo::sparse_full_rlnc_encoder<fifi::binary>,
+        kodo::markowitz_full_rlnc_decoder<fifi::binary> >(
+            symbols, symbol_size);
+
+    invoke_initialize<kodo::sparse_full_rlnc_encoder<fifi::binary8>,
+                      kodo::markowitz_full_rlnc_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+}
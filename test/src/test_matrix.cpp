@@ -6,14 +6,18 @@
 /// @file test_matrix.cpp Unit tests for the kodo::matrix class
 
 #include <cstdint>
+#include <cstdlib>
 #include <ctime>
 #include <algorithm>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <kodo/matrix.hpp>
+#include <kodo/matrix_operations.hpp>
 
 #include <fifi/fifi_utils.hpp>
+#include <fifi/default_field.hpp>
 
 TEST(TestMatrix, invoke_api)
 {
@@ -34,6 +38,16 @@ TEST(TestMatrix, invoke_api)
     ASSERT_EQ(row_size, m.row_size());
     ASSERT_EQ(row_length, m.row_length());
 
+    // The rows are aligned and padded
+    ASSERT_GE(m.row_stride(), m.row_size());
+    ASSERT_EQ(0U, m.row_stride() % kodo::matrix<field_type>::row_alignment);
+
+    for(uint32_t i = 0; i < rows; ++i)
+    {
+        ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(m.row(i)) %
+                  kodo::matrix<field_type>::row_alignment);
+    }
+
     // Set all the elements
     for(uint32_t i = 0; i < rows; ++i)
     {
@@ -92,3 +106,138 @@ TEST(TestMatrix, invoke_api)
 }
 
 
+
+/// Fills a matrix with random elements
+template<class Field>
+void random_matrix(kodo::matrix<Field> &m)
+{
+    typedef typename Field::value_type value_type;
+
+    for(uint32_t i = 0; i < m.rows(); ++i)
+    {
+        for(uint32_t j = 0; j < m.columns(); ++j)
+        {
+            value_type v = static_cast<value_type>(rand() % Field::order);
+            m.set_element(i, j, v);
+        }
+    }
+}
+
+/// @return True if the matrix is the identity
+template<class Field>
+bool is_identity(const kodo::matrix<Field> &m)
+{
+    for(uint32_t i = 0; i < m.rows(); ++i)
+    {
+        for(uint32_t j = 0; j < m.columns(); ++j)
+        {
+            if(m.element(i, j) != (i == j ? 1U : 0U))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/// @return True if the matrices hold the same elements
+template<class Field>
+bool equal_matrices(const kodo::matrix<Field> &a,
+                    const kodo::matrix<Field> &b)
+{
+    if(a.rows() != b.rows() || a.columns() != b.columns())
+        return false;
+
+    for(uint32_t i = 0; i < a.rows(); ++i)
+    {
+        if(!std::equal(a.row(i), a.row(i) + a.row_size(), b.row(i)))
+            return false;
+    }
+
+    return true;
+}
+
+/// Checks the multiply and inversion kernels against each other
+template<class Field>
+void test_matrix_operations(uint32_t size, uint32_t columns)
+{
+    typedef Field field_type;
+    typedef typename field_type::value_type value_type;
+    typedef kodo::matrix<field_type> matrix_type;
+
+    typename fifi::default_field<field_type>::type field;
+
+    // Draw random matrices until an invertible one is found, at least
+    // a quarter of the binary matrices are invertible
+    matrix_type a(size, size);
+    matrix_type inverse(size, size);
+
+    do
+    {
+        random_matrix(a);
+    }
+    while(!kodo::invert_matrix(field, a, inverse));
+
+    matrix_type product(size, size);
+
+    kodo::multiply_matrices(field, inverse, a, product);
+    EXPECT_TRUE(is_identity(product));
+
+    kodo::multiply_matrices(field, a, inverse, product);
+    EXPECT_TRUE(is_identity(product));
+
+    // Multiplying with the inverse undoes the multiplication of a wide
+    // matrix
+    matrix_type b(size, columns);
+    random_matrix(b);
+
+    matrix_type ab(size, columns);
+    matrix_type b_out(size, columns);
+
+    kodo::multiply_matrices(field, a, b, ab);
+    kodo::multiply_matrices(field, inverse, ab, b_out);
+
+    EXPECT_TRUE(equal_matrices(b, b_out));
+
+    // The rows of b stored one after the other as a block of symbols
+    // give the rows of a * b
+    uint32_t symbol_size = b.row_size();
+
+    std::vector<uint8_t> block(size * symbol_size);
+    std::vector<uint8_t> coded(size * symbol_size);
+
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        std::copy_n(b.row(i), symbol_size, &block[i * symbol_size]);
+    }
+
+    kodo::multiply_block(field, a, &block[0], &coded[0], symbol_size);
+
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(std::equal(ab.row(i), ab.row(i) + symbol_size,
+                               &coded[i * symbol_size]));
+    }
+
+    // A matrix with two equal rows is singular
+    if(size > 1)
+    {
+        std::copy_n(a.row(0), a.row_size(), a.row(size - 1));
+        EXPECT_FALSE(kodo::invert_matrix(field, a, inverse));
+    }
+
+    value_type zero = 0U;
+    matrix_type z(1, 1);
+    z.set_element(0, 0, zero);
+
+    matrix_type z_inverse(1, 1);
+    EXPECT_FALSE(kodo::invert_matrix(field, z, z_inverse));
+}
+
+TEST(TestMatrix, matrix_operations)
+{
+    test_matrix_operations<fifi::binary>(16, 1500);
+    test_matrix_operations<fifi::binary8>(1, 10);
+    test_matrix_operations<fifi::binary8>(32, 1500);
+    test_matrix_operations<fifi::binary8>(50, 3000);
+    test_matrix_operations<fifi::binary16>(20, 700);
+}
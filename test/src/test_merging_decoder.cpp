@@ -0,0 +1,169 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_merging_decoder.cpp Unit test for the merging_decoder layer
+
+/// Tests:
+///   - layer::merge(Decoder&)
+
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes the payloads of a block with a decoder per path, each on its
+/// own thread, and merges the decoders
+template<class Field>
+void test_merge(uint32_t symbols, uint32_t symbol_size, uint32_t paths)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::merging_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    // Every path gets some of the systematic and coded payloads
+    std::vector<std::vector<std::vector<uint8_t> > > payloads(paths);
+
+    uint32_t total = symbols + 2 * paths;
+
+    for(uint32_t i = 0; i < total; ++i)
+    {
+        if(i == symbols / 2)
+        {
+            kodo::set_systematic_off(encoder);
+        }
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+        encoder->encode(&payload[0]);
+
+        payloads[rand() % paths].push_back(payload);
+    }
+
+    std::vector<typename decoder_t::pointer> decoders;
+
+    for(uint32_t p = 0; p < paths; ++p)
+    {
+        decoders.push_back(decoder_factory.build());
+    }
+
+    std::vector<std::thread> threads;
+
+    for(uint32_t p = 0; p < paths; ++p)
+    {
+        threads.push_back(std::thread([&, p]()
+            {
+                for(auto &payload : payloads[p])
+                {
+                    decoders[p]->decode(&payload[0]);
+                }
+            }));
+    }
+
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    auto &decoder = decoders[0];
+
+    for(uint32_t p = 1; p < paths; ++p)
+    {
+        uint32_t rank = decoder->rank();
+        uint32_t other_rank = decoders[p]->rank();
+
+        uint32_t merged = decoder->merge(*decoders[p]);
+
+        EXPECT_EQ(rank + merged, decoder->rank());
+        EXPECT_LE(merged, other_rank);
+
+        // The other decoder is not changed
+        EXPECT_EQ(other_rank, decoders[p]->rank());
+    }
+
+    // Merging again adds nothing
+    for(uint32_t p = 1; p < paths; ++p)
+    {
+        EXPECT_EQ(0U, decoder->merge(*decoders[p]));
+    }
+
+    // A few extra payloads if the paths together were not enough
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestMergingDecoder, merge)
+{
+    test_merge<fifi::binary>(32, 160, 3);
+    test_merge<fifi::binary8>(32, 160, 3);
+    test_merge<fifi::binary16>(32, 160, 2);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_merge<fifi::binary8>(symbols, symbol_size, 4);
+}
+
+/// Tests that merging a complete decoder completes an empty one
+TEST(TestMergingDecoder, merge_complete)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::merging_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 100;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto complete = decoder_factory.build();
+    auto empty = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!complete->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        complete->decode(&payload[0]);
+    }
+
+    EXPECT_EQ(symbols, empty->merge(*complete));
+    EXPECT_TRUE(empty->is_complete());
+
+    // Nothing is merged into a complete decoder
+    EXPECT_EQ(0U, empty->merge(*complete));
+
+    std::vector<uint8_t> data_out(empty->block_size(), '\0');
+    empty->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
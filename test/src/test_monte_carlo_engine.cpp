@@ -0,0 +1,142 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_monte_carlo_engine.cpp Unit tests for the engine running
+///       independent trials in parallel
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/monte_carlo_engine.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+TEST(TestMonteCarloEngine, trial_seed)
+{
+    std::set<uint32_t> seeds;
+
+    for(uint32_t i = 0; i < 1000; ++i)
+    {
+        seeds.insert(kodo::trial_seed(42, i));
+        seeds.insert(kodo::trial_seed(43, i));
+    }
+
+    EXPECT_EQ(2000U, seeds.size());
+    EXPECT_EQ(kodo::trial_seed(7, 3), kodo::trial_seed(7, 3));
+}
+
+/// Every trial runs once and the results do not depend on the
+/// number of threads
+TEST(TestMonteCarloEngine, run)
+{
+    typedef kodo::monte_carlo_engine<uint32_t> engine_type;
+
+    std::vector<uint32_t> reference;
+
+    for(uint32_t threads : { 1U, 3U, 8U })
+    {
+        engine_type engine(threads);
+        EXPECT_EQ(threads, engine.threads());
+
+        std::atomic<uint32_t> lanes(0);
+
+        auto results = engine.run(100, 1234, [&]
+            {
+                ++lanes;
+                return [](uint32_t index,
+                          engine_type::generator_type &generator)
+                    {
+                        return index + 1000 * (generator() % 1000);
+                    };
+            });
+
+        ASSERT_EQ(100U, results.size());
+        EXPECT_TRUE(lanes <= threads);
+
+        for(uint32_t i = 0; i < results.size(); ++i)
+        {
+            EXPECT_EQ(i, results[i] % 1000);
+        }
+
+        if(reference.empty())
+        {
+            reference = results;
+        }
+
+        EXPECT_TRUE(reference == results);
+    }
+
+    engine_type engine(2);
+    EXPECT_TRUE(engine.run(0, 1, [] {
+        return [](uint32_t, engine_type::generator_type&)
+            { return 0U; }; }).empty());
+}
+
+/// Decodes generations in parallel, each lane with its own coders
+TEST(TestMonteCarloEngine, decoding)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary> encoder_type;
+    typedef kodo::full_rlnc_decoder<fifi::binary> decoder_type;
+    typedef kodo::monte_carlo_engine<uint32_t> engine_type;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 1;
+
+    auto make_trial = [&]
+        {
+            auto encoders = std::make_shared<encoder_type::factory>(
+                symbols, symbol_size);
+            auto decoders = std::make_shared<decoder_type::factory>(
+                symbols, symbol_size);
+
+            return [=](uint32_t, engine_type::generator_type &random)
+                {
+                    auto encoder = encoders->build();
+                    auto decoder = decoders->build();
+                    kodo::set_systematic_off(encoder);
+                    encoder->seed(random());
+
+                    std::vector<uint8_t> data(encoder->block_size(), 'x');
+                    encoder->set_symbols(sak::storage(data));
+
+                    std::vector<uint8_t> payload(encoder->payload_size());
+                    uint32_t used = 0;
+
+                    while(!decoder->is_complete())
+                    {
+                        encoder->encode(&payload[0]);
+                        decoder->decode(&payload[0]);
+                        ++used;
+                    }
+
+                    return used;
+                };
+        };
+
+    engine_type engine(4);
+    auto first = engine.run(200, 99, make_trial);
+    auto second = engine.run(200, 99, make_trial);
+
+    EXPECT_TRUE(first == second);
+
+    double mean = 0;
+    for(uint32_t used : first)
+    {
+        EXPECT_TRUE(used >= symbols);
+        mean += used;
+    }
+    mean /= first.size();
+
+    // A random binary generation needs about 1.6 extra symbols
+    EXPECT_TRUE(mean > symbols + 0.8);
+    EXPECT_TRUE(mean < symbols + 2.5);
+
+    // Another seed gives other generations
+    EXPECT_FALSE(first == engine.run(200, 100, make_trial));
+}
@@ -0,0 +1,166 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_multi_block_decoder.cpp Unit test for the
+///       multi_block_decoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/multi_block_decoder.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/stripe_partitioning_scheme.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes the blocks of an object with seed encoders and decodes them
+/// together
+template<class Field>
+void test_multi_block_decoder(uint32_t symbols, uint32_t symbol_size,
+                              uint32_t object_size, bool systematic)
+{
+    typedef kodo::seed_rlnc_encoder<Field> encoder_t;
+    typedef kodo::seed_rlnc_decoder<Field> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+
+    typedef kodo::object_encoder<storage_reader, encoder_t,
+        kodo::stripe_partitioning_scheme> object_encoder;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    object_encoder encoder(encoder_factory,
+                           storage_reader(sak::storage(data_in)));
+
+    uint32_t blocks = encoder.encoders();
+
+    std::vector<typename encoder_t::pointer> encoders;
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        encoders.push_back(encoder.build(i));
+
+        if(!systematic)
+        {
+            kodo::set_systematic_off(encoders.back());
+        }
+    }
+
+    kodo::multi_block_decoder<decoder_t> decoder(
+        blocks, symbols, symbol_size);
+
+    EXPECT_EQ(blocks, decoder.blocks());
+    EXPECT_EQ(symbols, decoder.symbols());
+    EXPECT_EQ(symbol_size, decoder.symbol_size());
+    EXPECT_EQ(encoders[0]->payload_size(), decoder.payload_size());
+
+    std::vector<std::vector<uint8_t> > buffers(
+        blocks, std::vector<uint8_t>(decoder.payload_size()));
+
+    std::vector<uint8_t*> payloads(blocks);
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        payloads[i] = &buffers[i][0];
+    }
+
+    uint32_t encoded = 0;
+
+    while(!decoder.is_complete())
+    {
+        for(uint32_t i = 0; i < blocks; ++i)
+        {
+            encoders[i]->encode(payloads[i]);
+        }
+
+        // Lose every third payload of all the blocks
+        if(encoded % 3 != 2)
+        {
+            decoder.decode(&payloads[0]);
+        }
+
+        ++encoded;
+        ASSERT_TRUE(encoded < symbols * 100);
+    }
+
+    EXPECT_EQ(symbols, decoder.rank());
+
+    kodo::stripe_partitioning_scheme partitioning(
+        symbols, symbol_size, object_size);
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        uint32_t offset = partitioning.byte_offset(i);
+        uint32_t bytes_used = partitioning.bytes_used(i);
+
+        std::vector<uint8_t> data_out(bytes_used);
+        decoder.copy_symbols(i, sak::storage(data_out));
+
+        EXPECT_TRUE(std::equal(data_out.begin(), data_out.end(),
+                               data_in.begin() + offset));
+    }
+}
+
+TEST(TestMultiBlockDecoder, decode)
+{
+    test_multi_block_decoder<fifi::binary>(16, 100, 16 * 100 * 7, false);
+    test_multi_block_decoder<fifi::binary8>(16, 100, 16 * 100 * 7, true);
+    test_multi_block_decoder<fifi::binary16>(10, 64, 5000, false);
+
+    uint32_t symbols = rand_symbols(64);
+    uint32_t symbol_size = rand_symbol_size(200);
+    uint32_t object_size = rand_nonzero(symbols * symbol_size * 8);
+
+    test_multi_block_decoder<fifi::binary8>(
+        symbols, symbol_size, object_size, false);
+    test_multi_block_decoder<fifi::binary8>(
+        symbols, symbol_size, object_size, true);
+}
+
+TEST(TestMultiBlockDecoder, reset)
+{
+    typedef kodo::seed_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::seed_rlnc_decoder<fifi::binary8> decoder_t;
+
+    encoder_t::factory encoder_factory(10, 50);
+    kodo::multi_block_decoder<decoder_t> decoder(2, 10, 50);
+
+    for(uint32_t round = 0; round < 3; ++round)
+    {
+        decoder.reset();
+        EXPECT_EQ(0U, decoder.rank());
+
+        std::vector<uint8_t> data_in = random_vector(2 * 500);
+
+        auto first = encoder_factory.build();
+        auto second = encoder_factory.build();
+
+        first->set_symbols(sak::storage(&data_in[0], 500));
+        second->set_symbols(sak::storage(&data_in[500], 500));
+
+        std::vector<uint8_t> a(decoder.payload_size());
+        std::vector<uint8_t> b(decoder.payload_size());
+        uint8_t *payloads[] = {&a[0], &b[0]};
+
+        while(!decoder.is_complete())
+        {
+            first->encode(payloads[0]);
+            second->encode(payloads[1]);
+            decoder.decode(payloads);
+        }
+
+        std::vector<uint8_t> data_out(2 * 500);
+        decoder.copy_symbols(0, sak::storage(&data_out[0], 500));
+        decoder.copy_symbols(1, sak::storage(&data_out[500], 500));
+
+        EXPECT_TRUE(data_in == data_out);
+    }
+}
@@ -0,0 +1,226 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_object_transfer.cpp Unit test for the event_loop and the
+///       object transfers running on it
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <kodo/event_loop.hpp>
+#include <kodo/object_transfer.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Tests the tasks and the handlers of the event loop
+TEST(TestObjectTransfer, event_loop)
+{
+    kodo::event_loop loop;
+
+    EXPECT_TRUE(loop.empty());
+
+    std::vector<uint32_t> order;
+
+    // Tasks posted by a task run in the next iteration
+    loop.post([&]()
+        {
+            order.push_back(0);
+            loop.post([&]() { order.push_back(2); });
+        });
+
+    loop.post([&]() { order.push_back(1); });
+
+    EXPECT_EQ(2U, loop.run_once(0));
+    EXPECT_EQ(2U, order.size());
+
+    EXPECT_EQ(1U, loop.run_once(0));
+    ASSERT_EQ(3U, order.size());
+    EXPECT_EQ(2U, order[2]);
+
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    uint32_t reads = 0;
+
+    EXPECT_TRUE(loop.add(fds[0], EPOLLIN, [&](uint32_t events)
+        {
+            EXPECT_TRUE((events & EPOLLIN) != 0);
+
+            char c;
+            EXPECT_EQ(1, ::read(fds[0], &c, 1));
+
+            ++reads;
+            loop.remove(fds[0]);
+        }));
+
+    EXPECT_TRUE(loop.contains(fds[0]));
+    EXPECT_EQ(0U, loop.run_once(0));
+
+    EXPECT_EQ(1, ::write(fds[1], "x", 1));
+
+    // The handler removes the pipe, so run() returns
+    loop.run();
+
+    EXPECT_EQ(1U, reads);
+    EXPECT_FALSE(loop.contains(fds[0]));
+    EXPECT_TRUE(loop.empty());
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+/// A pair of UDP sockets on the loopback interface, the sender is
+/// connected to the receiver
+struct transfer_socket_pair
+{
+    transfer_socket_pair()
+    {
+        m_receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+        m_sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+        EXPECT_TRUE(m_receiver >= 0);
+        EXPECT_TRUE(m_sender >= 0);
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+
+        EXPECT_EQ(0, ::bind(m_receiver, (sockaddr*) &address,
+                            sizeof(address)));
+
+        socklen_t length = sizeof(address);
+        EXPECT_EQ(0, ::getsockname(m_receiver, (sockaddr*) &address,
+                                   &length));
+
+        EXPECT_EQ(0, ::connect(m_sender, (sockaddr*) &address,
+                               sizeof(address)));
+
+        int buffer_size = 4 * 1024 * 1024;
+        ::setsockopt(m_receiver, SOL_SOCKET, SO_RCVBUF,
+                     &buffer_size, sizeof(buffer_size));
+    }
+
+    ~transfer_socket_pair()
+    {
+        ::close(m_receiver);
+        ::close(m_sender);
+    }
+
+    int m_receiver;
+    int m_sender;
+};
+
+/// Runs a number of object transfers on one event loop
+TEST(TestObjectTransfer, concurrent_transfers)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+    typedef kodo::object_encoder<storage_reader, encoder_t> object_encoder;
+    typedef kodo::object_decoder<decoder_t> object_decoder;
+
+    typedef kodo::object_send_transfer<object_encoder> send_transfer;
+    typedef kodo::object_receive_transfer<object_decoder>
+        receive_transfer;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 1400;
+    uint32_t object_size = 50000;
+    uint32_t transfers = 8;
+
+    encoder_t::factory encoder_factory(max_symbols, max_symbol_size);
+    decoder_t::factory decoder_factory(max_symbols, max_symbol_size);
+
+    kodo::event_loop loop;
+
+    std::vector<std::vector<uint8_t> > data_in(transfers);
+    std::vector<std::vector<uint8_t> > data_out(transfers);
+
+    std::vector<std::unique_ptr<transfer_socket_pair> > sockets;
+    std::vector<std::unique_ptr<storage_reader> > readers;
+    std::vector<std::unique_ptr<object_encoder> > encoders;
+    std::vector<std::unique_ptr<object_decoder> > decoders;
+    std::vector<std::unique_ptr<send_transfer> > senders;
+    std::vector<std::unique_ptr<receive_transfer> > receivers;
+
+    uint32_t sent = 0;
+    uint32_t received = 0;
+
+    for(uint32_t i = 0; i < transfers; ++i)
+    {
+        data_in[i] = random_vector(object_size);
+        data_out[i].resize(object_size);
+
+        sockets.emplace_back(new transfer_socket_pair);
+
+        readers.emplace_back(
+            new storage_reader(sak::storage(data_in[i])));
+
+        encoders.emplace_back(
+            new object_encoder(encoder_factory, *readers[i]));
+
+        decoders.emplace_back(
+            new object_decoder(decoder_factory, object_size));
+
+        // The encoders are systematic, so a few extra payloads per
+        // block are enough without loss
+        senders.emplace_back(new send_transfer(
+            loop, sockets[i]->m_sender, *encoders[i],
+            encoder_factory.max_payload_size(), max_symbols + 4, 4));
+
+        receivers.emplace_back(new receive_transfer(
+            loop, sockets[i]->m_receiver, *decoders[i],
+            decoder_factory.max_payload_size(),
+            sak::storage(data_out[i])));
+
+        receivers[i]->start([&](bool success)
+            {
+                EXPECT_TRUE(success);
+                ++received;
+            });
+
+        senders[i]->start([&](bool success)
+            {
+                EXPECT_TRUE(success);
+                ++sent;
+            });
+    }
+
+    // Stop if a payload is lost instead of waiting forever
+    while(!loop.empty())
+    {
+        if(loop.run_once(1000) == 0)
+        {
+            break;
+        }
+    }
+
+    EXPECT_EQ(transfers, sent);
+    EXPECT_EQ(transfers, received);
+
+    for(uint32_t i = 0; i < transfers; ++i)
+    {
+        EXPECT_TRUE(senders[i]->is_complete());
+        EXPECT_TRUE(receivers[i]->is_complete());
+
+        EXPECT_EQ(decoders[i]->decoders(), receivers[i]->blocks_written());
+        EXPECT_TRUE(data_in[i] == data_out[i]);
+    }
+}
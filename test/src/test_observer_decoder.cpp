@@ -0,0 +1,160 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_observer_decoder.cpp Unit tests for the observer_decoder
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/observer_decoder.hpp>
+#include <kodo/linear_block_decoder.hpp>
+#include <kodo/coefficient_storage.hpp>
+#include <kodo/coefficient_info.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/deep_symbol_storage.hpp>
+#include <kodo/storage_bytes_used.hpp>
+#include <kodo/storage_block_info.hpp>
+#include <kodo/final_coder_factory_pool.hpp>
+
+namespace kodo
+{
+
+    /// Observer recording the hooks invoked
+    struct recording_observer : public null_decoder_observer
+    {
+        static const bool observes_symbols = true;
+
+        void on_rank_changed(uint32_t rank)
+        {
+            m_ranks.push_back(rank);
+        }
+
+        void on_symbol_decoded(uint32_t index)
+        {
+            m_decoded.push_back(index);
+        }
+
+        void on_complete()
+        {
+            ++m_completed;
+        }
+
+        recording_observer()
+            : m_completed(0)
+        { }
+
+        /// The ranks passed to on_rank_changed()
+        std::vector<uint32_t> m_ranks;
+
+        /// The indices passed to on_symbol_decoded()
+        std::vector<uint32_t> m_decoded;
+
+        /// The number of on_complete() calls
+        uint32_t m_completed;
+    };
+
+    /// Decoder stack with an observer
+    template<class Field, class Observer>
+    class observer_decoder_stack
+        : public // Codec API
+                 observer_decoder<Observer,
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 observer_decoder_stack<Field, Observer>
+                     > > > > > > > > > >
+    { };
+
+}
+
+/// Tests the order and arguments of the hooks
+TEST(TestObserverDecoder, hooks)
+{
+    typedef kodo::observer_decoder_stack<
+        fifi::binary8, kodo::recording_observer> decoder_type;
+
+    const uint32_t symbols = 4;
+    const uint32_t symbol_size = 8;
+
+    decoder_type::factory factory(symbols, symbol_size);
+    auto decoder = factory.build();
+
+    std::vector<uint8_t> data(symbol_size, 1);
+    const kodo::recording_observer &observer = decoder->observer();
+
+    decoder->decode_symbol(&data[0], 1U);
+
+    EXPECT_EQ(std::vector<uint32_t>({1}), observer.m_ranks);
+    EXPECT_EQ(std::vector<uint32_t>({1}), observer.m_decoded);
+
+    // A symbol which does not increase the rank is not reported
+    decoder->decode_symbol(&data[0], 1U);
+    EXPECT_EQ(1U, observer.m_ranks.size());
+
+    // The coded symbol depends on the missing symbol 2
+    std::vector<uint8_t> coefficients = {1, 0, 1, 0};
+    decoder->decode_symbol(&data[0], &coefficients[0]);
+
+    EXPECT_EQ(std::vector<uint32_t>({1, 2}), observer.m_ranks);
+    EXPECT_EQ(std::vector<uint32_t>({1}), observer.m_decoded);
+
+    // Receiving symbol 2 also decodes symbol 0
+    decoder->decode_symbol(&data[0], 2U);
+
+    EXPECT_EQ(std::vector<uint32_t>({1, 2, 3}), observer.m_ranks);
+    EXPECT_EQ(std::vector<uint32_t>({1, 0, 2}), observer.m_decoded);
+    EXPECT_EQ(0U, observer.m_completed);
+
+    decoder->decode_symbol(&data[0], 3U);
+
+    EXPECT_EQ(std::vector<uint32_t>({1, 2, 3, 4}), observer.m_ranks);
+    EXPECT_EQ(std::vector<uint32_t>({1, 0, 2, 3}), observer.m_decoded);
+    EXPECT_EQ(1U, observer.m_completed);
+
+    // The observer is reset when the decoder is built again
+    decoder.reset();
+    decoder = factory.build();
+
+    EXPECT_TRUE(decoder->observer().m_ranks.empty());
+    EXPECT_EQ(0U, decoder->observer().m_completed);
+}
+
+/// Tests that the stack decodes with the null observer
+TEST(TestObserverDecoder, null_observer)
+{
+    typedef kodo::observer_decoder_stack<
+        fifi::binary8, kodo::null_decoder_observer> decoder_type;
+
+    const uint32_t symbols = 4;
+    const uint32_t symbol_size = 8;
+
+    decoder_type::factory factory(symbols, symbol_size);
+    auto decoder = factory.build();
+
+    std::vector<uint8_t> data(symbol_size, 1);
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        decoder->decode_symbol(&data[0], i);
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+}
@@ -0,0 +1,214 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_overlapping_generations.cpp Unit tests for the
+///       overlapping generation encoder and decoder
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/overlapping_generation_scheme.hpp>
+#include <kodo/overlapping_generation_encoder.hpp>
+#include <kodo/overlapping_generation_decoder.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Checks that the generations cover the object and that the shared
+/// symbols are the first symbols of the next generation
+TEST(TestOverlappingGenerations, scheme)
+{
+    uint32_t max_symbols = 16;
+    uint32_t symbol_size = 100;
+    uint32_t object_size = 10000;
+    uint32_t overlap = 4;
+
+    kodo::overlapping_generation_scheme<> scheme(
+        overlap, max_symbols, symbol_size, object_size);
+
+    uint32_t generations = scheme.generations();
+    EXPECT_GT(generations, 1U);
+
+    uint32_t base_bytes = 0;
+
+    for(uint32_t g = 0; g < generations; ++g)
+    {
+        EXPECT_LE(scheme.symbols(g), max_symbols);
+        EXPECT_EQ(symbol_size, scheme.symbol_size(g));
+        EXPECT_EQ(base_bytes, scheme.byte_offset(g));
+
+        if(g + 1 < generations)
+        {
+            EXPECT_EQ(overlap, scheme.shared_symbols(g));
+
+            // The shared symbols are at the start of the next generation
+            EXPECT_EQ(scheme.byte_offset(g + 1),
+                      scheme.byte_offset(g) +
+                      scheme.base_symbols(g) * symbol_size);
+        }
+        else
+        {
+            EXPECT_EQ(0U, scheme.shared_symbols(g));
+        }
+
+        EXPECT_GE(scheme.bytes_used(g), scheme.base_bytes_used(g));
+        base_bytes += scheme.base_bytes_used(g);
+    }
+
+    EXPECT_EQ(object_size, base_bytes);
+}
+
+/// Encodes and decodes an object where every generation loses payloads
+template<class Field>
+void test_overlapping_generations(uint32_t max_symbols,
+                                  uint32_t max_symbol_size,
+                                  uint32_t object_size,
+                                  uint32_t overlap)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::overlapping_full_rlnc_decoder<Field> decoder_t;
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    typename encoder_t::factory encoder_factory(
+        max_symbols, max_symbol_size);
+    typename decoder_t::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    kodo::overlapping_generation_encoder<encoder_t> obj_encoder(
+        overlap, encoder_factory, sak::storage(data_in));
+
+    kodo::overlapping_generation_decoder<decoder_t> obj_decoder(
+        overlap, decoder_factory, object_size);
+
+    EXPECT_EQ(obj_encoder.encoders(), obj_decoder.decoders());
+    EXPECT_EQ(object_size, obj_decoder.object_size());
+
+    uint32_t generations = obj_encoder.encoders();
+
+    std::vector<typename encoder_t::pointer> encoders(generations);
+    std::vector<std::vector<uint8_t> > payloads(generations);
+
+    for(uint32_t i = 0; i < generations; ++i)
+    {
+        encoders[i] = obj_encoder.build(i);
+
+        EXPECT_EQ(encoders[i]->symbols(),
+                  obj_decoder.decoder(i)->symbols());
+        EXPECT_EQ(encoders[i]->bytes_used(),
+                  obj_decoder.decoder(i)->bytes_used());
+
+        payloads[i].resize(encoders[i]->payload_size());
+    }
+
+    while(!obj_decoder.is_complete())
+    {
+        for(uint32_t i = 0; i < generations; ++i)
+        {
+            encoders[i]->encode(&payloads[i][0]);
+
+            // Every generation loses about a third of its payloads
+            if(rand() % 3 == 0)
+                continue;
+
+            obj_decoder.decode(i, &payloads[i][0]);
+        }
+    }
+
+    std::vector<uint8_t> data_out(object_size, '\0');
+    obj_decoder.copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestOverlappingGenerations, decode)
+{
+    test_overlapping_generations<fifi::binary>(16, 64, 16 * 64 * 8, 4);
+    test_overlapping_generations<fifi::binary8>(32, 100, 32 * 100 * 6, 8);
+    test_overlapping_generations<fifi::binary16>(8, 40, 8 * 40 * 5, 2);
+
+    // Without overlap and with a single generation
+    test_overlapping_generations<fifi::binary8>(16, 100, 16 * 100 * 4, 0);
+    test_overlapping_generations<fifi::binary8>(32, 100, 1000, 4);
+
+    uint32_t symbols = rand_symbols() + 1;
+    uint32_t symbol_size = rand_symbol_size();
+    uint32_t object_size = symbols * symbol_size * ((rand() % 5) + 1);
+    object_size -= rand() % symbol_size;
+
+    test_overlapping_generations<fifi::binary8>(
+        symbols, symbol_size, object_size, rand() % symbols);
+}
+
+/// Tests that the shared symbols are passed to the adjacent
+/// generations as soon as they are decoded
+TEST(TestOverlappingGenerations, propagation)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::overlapping_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 32;
+    uint32_t overlap = 4;
+    uint32_t object_size = (max_symbols - overlap) * max_symbol_size * 3;
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    encoder_t::factory encoder_factory(max_symbols, max_symbol_size);
+    decoder_t::factory decoder_factory(max_symbols, max_symbol_size);
+
+    kodo::overlapping_generation_encoder<encoder_t> obj_encoder(
+        overlap, encoder_factory, sak::storage(data_in));
+
+    kodo::overlapping_generation_decoder<decoder_t> obj_decoder(
+        overlap, decoder_factory, object_size);
+
+    ASSERT_EQ(3U, obj_decoder.decoders());
+
+    // A systematic symbol of the middle generation which is shared
+    // with the first generation is passed on before the middle
+    // generation is complete
+    encoder_t::pointer encoder = obj_encoder.build(1);
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    encoder->encode(&payload[0]);
+    obj_decoder.decode(1, &payload[0]);
+
+    EXPECT_EQ(1U, obj_decoder.decoder(0)->rank());
+    EXPECT_EQ(1U, obj_decoder.symbols_forwarded());
+
+    // Completing the middle generation passes the remaining shared
+    // symbols to both neighbours
+    kodo::set_systematic_off(encoder);
+
+    while(!obj_decoder.is_complete(1))
+    {
+        encoder->encode(&payload[0]);
+        obj_decoder.decode(1, &payload[0]);
+    }
+
+    EXPECT_EQ(overlap, obj_decoder.decoder(0)->rank());
+    EXPECT_EQ(overlap, obj_decoder.decoder(2)->rank());
+    EXPECT_EQ(2 * overlap, obj_decoder.symbols_forwarded());
+
+    // The first generation now only needs its base symbols
+    encoder = obj_encoder.build(0);
+    kodo::set_systematic_off(encoder);
+
+    uint32_t received = 0;
+
+    while(!obj_decoder.is_complete(0))
+    {
+        encoder->encode(&payload[0]);
+        obj_decoder.decode(0, &payload[0]);
+        ++received;
+    }
+
+    EXPECT_GE(received, obj_decoder.scheme().base_symbols(0));
+    EXPECT_FALSE(obj_decoder.is_complete());
+}
@@ -0,0 +1,130 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_page_allocator.cpp Unit tests for the page allocator and
+///       the memory policies
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include <kodo/has_deep_symbol_storage.hpp>
+#include <kodo/page_allocator.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Checks that allocations of a policy are zero and writable
+template<class MemoryPolicy>
+void test_page_allocation(uint32_t size)
+{
+    typedef std::vector<uint8_t, kodo::page_allocator<uint8_t, MemoryPolicy> >
+        vector_type;
+
+    vector_type data;
+    data.resize(size);
+
+    EXPECT_TRUE(std::all_of(data.begin(), data.end(),
+                            [](uint8_t v) { return v == 0; }));
+
+    std::fill(data.begin(), data.end(), 0xab);
+    EXPECT_EQ(0xab, data[size - 1]);
+
+    // Values given to resize() are written
+    vector_type filled;
+    filled.resize(size, 7);
+    EXPECT_EQ(7, filled[size / 2]);
+}
+
+TEST(TestPageAllocator, policies)
+{
+    test_page_allocation<kodo::first_touch_memory>(100);
+    test_page_allocation<kodo::first_touch_memory>(1000000);
+    test_page_allocation<kodo::huge_page_memory>(1000);
+    test_page_allocation<kodo::huge_page_memory>(5000000);
+    test_page_allocation<kodo::numa_node_memory<0> >(1000000);
+    test_page_allocation<
+        kodo::numa_node_memory<0, kodo::huge_page_memory> >(3000000);
+}
+
+#if defined(__linux__)
+
+/// Tests that mapped allocations are aligned and that the pages are not
+/// touched before they are used
+TEST(TestPageAllocator, first_touch)
+{
+    kodo::page_allocator<uint8_t, kodo::huge_page_memory> huge;
+
+    uint32_t huge_size = 3 * 1024 * 1024;
+    uint8_t *huge_data = huge.allocate(huge_size);
+
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(huge_data) % (2 * 1024 * 1024));
+    huge.deallocate(huge_data, huge_size);
+
+    std::vector<uint8_t, kodo::page_allocator<uint8_t> > data;
+
+    uint32_t page = static_cast<uint32_t>(::sysconf(_SC_PAGESIZE));
+    data.resize(64 * page);
+
+    std::vector<unsigned char> resident(64);
+    ASSERT_EQ(0, ::mincore(&data[0], data.size(), &resident[0]));
+
+    for(unsigned char r : resident)
+    {
+        EXPECT_EQ(0, r & 1);
+    }
+}
+
+#endif
+
+/// Decodes with the storage allocated by the page allocator
+template<class MemoryPolicy>
+void test_paged_decoder(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::paged_full_rlnc_decoder<fifi::binary8, MemoryPolicy>
+        decoder_t;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_TRUE(kodo::has_deep_symbol_storage<decoder_t>::value);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestPageAllocator, paged_decoder)
+{
+    test_paged_decoder<kodo::huge_page_memory>(32, 1400);
+    test_paged_decoder<kodo::first_touch_memory>(
+        rand_symbols(), rand_symbol_size());
+    test_paged_decoder<kodo::numa_node_memory<0> >(64, 4096);
+}
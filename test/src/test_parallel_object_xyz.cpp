@@ -0,0 +1,155 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_parallel_object_xyz.cpp Unit tests for the block executor
+///       and the parallel object encoder and decoder
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/block_executor.hpp>
+#include <kodo/parallel_object_decoder.hpp>
+#include <kodo/parallel_object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Tests that every task of a run is invoked exactly once
+TEST(TestBlockExecutor, run)
+{
+    kodo::block_executor executor(4);
+    EXPECT_EQ(4U, executor.threads());
+
+    for(uint32_t tasks = 0; tasks < 100; tasks += 7)
+    {
+        std::vector<std::atomic<uint32_t> > invoked(tasks);
+
+        for(auto &i : invoked)
+        {
+            i = 0;
+        }
+
+        executor.run(tasks, [&](uint32_t task)
+            {
+                ++invoked[task];
+            });
+
+        for(auto &i : invoked)
+        {
+            EXPECT_EQ(1U, i.load());
+        }
+    }
+}
+
+/// Tests that idle workers steal the tasks queued at a busy worker
+TEST(TestBlockExecutor, steal)
+{
+    kodo::block_executor executor(4);
+
+    // All tasks are queued at the first worker
+    std::vector<uint32_t> tasks;
+    for(uint32_t i = 0; i < 16; ++i)
+    {
+        tasks.push_back(i * executor.threads());
+    }
+
+    std::mutex mutex;
+    std::vector<std::thread::id> workers;
+
+    executor.run(tasks, [&](uint32_t task)
+        {
+            (void) task;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(std::find(workers.begin(), workers.end(),
+                         std::this_thread::get_id()) == workers.end())
+            {
+                workers.push_back(std::this_thread::get_id());
+            }
+        });
+
+    EXPECT_GT(workers.size(), 1U);
+}
+
+/// Encodes and decodes an object with the parallel object coders
+template<class Field>
+void test_parallel_object(uint32_t max_symbols, uint32_t max_symbol_size,
+                          uint32_t object_size, uint32_t threads)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typedef kodo::parallel_object_encoder<
+        kodo::storage_reader<encoder_t>, encoder_t> object_encoder_t;
+
+    typedef kodo::parallel_object_decoder<decoder_t> object_decoder_t;
+
+    kodo::block_executor executor(threads);
+
+    typename encoder_t::factory encoder_factory(
+        max_symbols, max_symbol_size);
+
+    typename decoder_t::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    kodo::storage_reader<encoder_t> reader(sak::storage(data_in));
+
+    object_encoder_t encoder(encoder_factory, reader, executor);
+    object_decoder_t decoder(decoder_factory, object_size, executor);
+
+    EXPECT_EQ(encoder.encoders(), decoder.decoders());
+    EXPECT_EQ(object_size, encoder.object_size());
+    EXPECT_EQ(object_size, decoder.object_size());
+
+    uint32_t blocks = encoder.encoders();
+
+    std::vector<std::vector<uint8_t> > buffers(blocks);
+    std::vector<uint8_t*> payloads(blocks);
+    std::vector<uint32_t> decoder_ids(blocks);
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        buffers[i].resize(encoder.encoder(i)->payload_size());
+        payloads[i] = &buffers[i][0];
+        decoder_ids[i] = i;
+    }
+
+    while(!decoder.is_complete())
+    {
+        encoder.encode(&payloads[0]);
+        decoder.decode(&decoder_ids[0], &payloads[0], blocks);
+    }
+
+    std::vector<uint8_t> data_out(object_size);
+    decoder.copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestParallelObjectCoders, encode_decode)
+{
+    test_parallel_object<fifi::binary>(16, 100, 12345, 4);
+    test_parallel_object<fifi::binary8>(16, 100, 12345, 4);
+    test_parallel_object<fifi::binary8>(32, 1400, 1000000, 3);
+    test_parallel_object<fifi::binary16>(10, 64, 640, 2);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+    uint32_t object_size = rand_nonzero(symbols * symbol_size * 10);
+
+    test_parallel_object<fifi::binary8>(
+        symbols, symbol_size, object_size, 0);
+}
@@ -0,0 +1,116 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_payload_cache.cpp Unit tests for the payload cache
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/payload_cache.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes the payloads taken from a payload cache, alternating
+/// between copies and payloads used in place
+template<class Encoder, class Decoder>
+void test_payload_cache(uint32_t symbols, uint32_t symbol_size,
+                        uint32_t capacity)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    {
+        kodo::payload_cache<Encoder> cache(encoder, capacity);
+
+        EXPECT_EQ(capacity, cache.capacity());
+        EXPECT_EQ(encoder->payload_size(), cache.payload_size());
+
+        uint32_t taken = 0;
+
+        while(!decoder->is_complete())
+        {
+            uint32_t bytes_used = 0;
+
+            if(taken % 3 == 0)
+            {
+                bytes_used = cache.take(&payload[0]);
+            }
+            else if(taken % 3 == 1)
+            {
+                const uint8_t *cached = 0;
+                bytes_used = cache.front(&cached);
+
+                std::copy(cached, cached + bytes_used, payload.begin());
+                cache.pop();
+            }
+            else
+            {
+                // Wait for the background thread
+                while((bytes_used = cache.try_take(&payload[0])) == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            EXPECT_TRUE(bytes_used > 0);
+            EXPECT_TRUE(bytes_used <= encoder->payload_size());
+            EXPECT_TRUE(cache.size() <= capacity);
+
+            decoder->decode(&payload[0]);
+            ++taken;
+        }
+
+        // The cache is filled up to its capacity
+        while(cache.size() < capacity)
+        {
+            std::this_thread::yield();
+        }
+
+        EXPECT_EQ(capacity, cache.size());
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestPayloadCache, test_full_rlnc)
+{
+    test_payload_cache<kodo::full_rlnc_encoder<fifi::binary8>,
+                       kodo::full_rlnc_decoder<fifi::binary8> >(
+                           32, 160, 1);
+
+    test_payload_cache<kodo::full_rlnc_encoder<fifi::binary8>,
+                       kodo::full_rlnc_decoder<fifi::binary8> >(
+                           32, 160, 8);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_payload_cache<kodo::full_rlnc_encoder<fifi::binary>,
+                       kodo::full_rlnc_decoder<fifi::binary> >(
+                           symbols, symbol_size, 16);
+}
+
+TEST(TestPayloadCache, test_reed_solomon)
+{
+    test_payload_cache<kodo::rs_encoder<fifi::binary8>,
+                       kodo::rs_decoder<fifi::binary8> >(32, 160, 4);
+}
@@ -0,0 +1,147 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_payload_ring.cpp Unit test for the payload_ring
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/payload_ring.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Tests:
+///   - payload_ring::begin_write()
+///   - payload_ring::commit_write(uint32_t)
+///   - payload_ring::begin_read(uint32_t*)
+///   - payload_ring::commit_read()
+TEST(TestPayloadRing, full_and_empty)
+{
+    kodo::payload_ring ring(3, 100);
+
+    EXPECT_EQ(4U, ring.slots());
+    EXPECT_EQ(100U, ring.max_payload_size());
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(ring.begin_read() == 0);
+
+    // Run a few times around the ring
+    for(uint32_t round = 0; round < 3; ++round)
+    {
+        std::vector<uint8_t*> slots;
+
+        for(uint32_t i = 0; i < ring.slots(); ++i)
+        {
+            uint8_t *slot = ring.begin_write();
+            ASSERT_TRUE(slot != 0);
+
+            // The slots are aligned to the cache line
+            EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(slot) %
+                      kodo::payload_ring::cache_line_size);
+
+            slot[0] = static_cast<uint8_t>(i);
+            ring.commit_write(i + 1);
+            slots.push_back(slot);
+        }
+
+        EXPECT_TRUE(ring.begin_write() == 0);
+        EXPECT_FALSE(ring.empty());
+
+        for(uint32_t i = 0; i < ring.slots(); ++i)
+        {
+            uint32_t size = 0;
+            uint8_t *slot = ring.begin_read(&size);
+
+            ASSERT_TRUE(slot != 0);
+            EXPECT_EQ(slots[i], slot);
+            EXPECT_EQ(i + 1, size);
+            EXPECT_EQ(i, slot[0]);
+
+            ring.commit_read();
+        }
+
+        EXPECT_TRUE(ring.empty());
+        EXPECT_TRUE(ring.begin_read() == 0);
+    }
+}
+
+/// Encodes on one thread and decodes out of the ring on another
+template<class Encoder, class Decoder>
+void test_payload_ring_threads(uint32_t symbols, uint32_t symbol_size)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    // Make the ring smaller than the number of payloads
+    kodo::payload_ring ring(4, decoder_factory.max_payload_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+    encoder->set_systematic_off();
+
+    std::atomic<bool> complete(false);
+
+    std::thread producer([&]
+        {
+            while(!complete.load())
+            {
+                uint8_t *slot = ring.begin_write();
+
+                if(slot == 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ring.commit_write(encoder->encode(slot));
+            }
+        });
+
+    while(!decoder->is_complete())
+    {
+        uint32_t size = 0;
+        uint8_t *payload = ring.begin_read(&size);
+
+        if(payload == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        EXPECT_TRUE(size <= decoder->payload_size());
+
+        decoder->decode(payload);
+        ring.commit_read();
+    }
+
+    complete = true;
+    producer.join();
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestPayloadRing, threads)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_payload_ring_threads<
+        kodo::full_rlnc_encoder<fifi::binary>,
+        kodo::full_rlnc_decoder<fifi::binary> >(symbols, symbol_size);
+
+    test_payload_ring_threads<
+        kodo::full_rlnc_encoder<fifi::binary8>,
+        kodo::full_rlnc_decoder<fifi::binary8> >(symbols, symbol_size);
+}
@@ -0,0 +1,135 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_payload_scatter_gather.cpp Unit test for encoding and
+///       decoding with separate symbol data and symbol header buffers
+
+/// Tests:
+///   - payload_encoder::encode(uint8_t*,uint8_t*)
+///   - payload_encoder::encode_in_place(uint8_t*,uint8_t*,const uint8_t**)
+///   - payload_decoder::decode(uint8_t*,uint8_t*)
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Sends the symbols through separate header and data buffers and
+/// checks that systematic symbols are referenced in the encoder storage
+template<class Encoder, class Decoder>
+void test_scatter_gather(uint32_t symbols, uint32_t symbol_size)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    std::vector<uint8_t> symbol_data(encoder->symbol_size());
+    std::vector<uint8_t> symbol_header(encoder->header_size());
+
+    // The received symbol is decoded in place, so it must be a copy
+    std::vector<uint8_t> received(decoder->symbol_size());
+
+    uint32_t systematic = 0;
+
+    while(!decoder->is_complete())
+    {
+        const uint8_t *reference = 0;
+
+        uint32_t header_bytes = encoder->encode_in_place(
+            &symbol_data[0], &symbol_header[0], &reference);
+
+        EXPECT_TRUE(header_bytes > 0);
+        EXPECT_TRUE(header_bytes <= encoder->header_size());
+        ASSERT_TRUE(reference != 0);
+
+        if(reference != &symbol_data[0])
+        {
+            // Systematic symbols point into the encoder storage
+            EXPECT_EQ(reference, encoder->symbol(systematic));
+            ++systematic;
+        }
+
+        std::copy(reference, reference + encoder->symbol_size(),
+                  received.begin());
+
+        decoder->decode(&received[0], &symbol_header[0]);
+    }
+
+    EXPECT_EQ(systematic, symbols);
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), data_out.begin()));
+
+    // Without systematic symbols the coded data is written to the
+    // symbol data buffer
+    encoder = encoder_factory.build();
+    decoder = decoder_factory.build();
+
+    encoder->set_symbols(sak::storage(data));
+    encoder->set_systematic_off();
+
+    while(!decoder->is_complete())
+    {
+        const uint8_t *reference = 0;
+
+        encoder->encode_in_place(
+            &symbol_data[0], &symbol_header[0], &reference);
+
+        EXPECT_EQ(reference, &symbol_data[0]);
+
+        decoder->decode(&symbol_data[0], &symbol_header[0]);
+    }
+
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), data_out.begin()));
+
+    // The split encode() uses the same buffers as the payload API
+    encoder = encoder_factory.build();
+    decoder = decoder_factory.build();
+
+    encoder->set_symbols(sak::storage(data));
+
+    while(!decoder->is_complete())
+    {
+        uint32_t header_bytes =
+            encoder->encode(&symbol_data[0], &symbol_header[0]);
+
+        EXPECT_TRUE(header_bytes <= encoder->header_size());
+
+        decoder->decode(&symbol_data[0], &symbol_header[0]);
+    }
+
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), data_out.begin()));
+}
+
+TEST(TestPayloadScatterGather, test_scatter_gather)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_scatter_gather<
+        kodo::full_rlnc_encoder<fifi::binary>,
+        kodo::full_rlnc_decoder<fifi::binary> >(symbols, symbol_size);
+
+    test_scatter_gather<
+        kodo::full_rlnc_encoder<fifi::binary8>,
+        kodo::full_rlnc_decoder<fifi::binary8> >(symbols, symbol_size);
+
+    test_scatter_gather<
+        kodo::full_rlnc_encoder<fifi::binary16>,
+        kodo::full_rlnc_decoder<fifi::binary16> >(symbols, symbol_size);
+}
@@ -0,0 +1,193 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_payload_trace.cpp Unit test for the payload trace and the
+///       trace_capture_decoder layer
+
+/// Tests:
+///   - payload_trace_writer / payload_trace::load()
+///   - trace_capture_decoder::decode()
+
+#include <cstdint>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/payload_trace.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+TEST(TestPayloadTrace, write_and_load)
+{
+    std::stringstream stream;
+    kodo::payload_trace_writer writer(stream);
+
+    std::vector<uint8_t> first = random_vector(300);
+    std::vector<uint8_t> second = random_vector(5);
+    std::vector<uint8_t> third = random_vector(1000);
+
+    writer.write_generation(16, 300);
+    writer.write_payload(&first[0], 300);
+    writer.write_payload(&second[0], 5);
+    writer.write_generation(200, 1000);
+    writer.write_payload(&third[0], 1000);
+
+    EXPECT_TRUE(writer.good());
+    EXPECT_EQ(3U, writer.payloads());
+
+    kodo::payload_trace trace;
+    ASSERT_TRUE(trace.load(stream));
+
+    ASSERT_EQ(2U, trace.generations());
+    ASSERT_EQ(3U, trace.payloads());
+    EXPECT_EQ(1000U, trace.max_payload_size());
+
+    EXPECT_EQ(16U, trace.generation_at(0).m_symbols);
+    EXPECT_EQ(300U, trace.generation_at(0).m_symbol_size);
+    EXPECT_EQ(0U, trace.generation_at(0).m_first_payload);
+    EXPECT_EQ(2U, trace.generation_at(0).m_payloads);
+
+    EXPECT_EQ(200U, trace.generation_at(1).m_symbols);
+    EXPECT_EQ(1000U, trace.generation_at(1).m_symbol_size);
+    EXPECT_EQ(2U, trace.generation_at(1).m_first_payload);
+    EXPECT_EQ(1U, trace.generation_at(1).m_payloads);
+
+    EXPECT_EQ(300U, trace.payload_at(0).m_size);
+    EXPECT_EQ(5U, trace.payload_at(1).m_size);
+    EXPECT_EQ(1000U, trace.payload_at(2).m_size);
+
+    EXPECT_TRUE(std::equal(first.begin(), first.end(),
+                           trace.payload_data(0)));
+    EXPECT_TRUE(std::equal(second.begin(), second.end(),
+                           trace.payload_data(1)));
+    EXPECT_TRUE(std::equal(third.begin(), third.end(),
+                           trace.payload_data(2)));
+}
+
+TEST(TestPayloadTrace, reject_invalid_traces)
+{
+    kodo::payload_trace trace;
+
+    {
+        std::stringstream stream("KPTX\x01");
+        EXPECT_FALSE(trace.load(stream));
+    }
+
+    // A payload before any generation
+    {
+        std::stringstream stream;
+        kodo::payload_trace_writer writer(stream);
+
+        std::vector<uint8_t> payload = random_vector(10);
+        writer.write_payload(&payload[0], 10);
+
+        EXPECT_FALSE(trace.load(stream));
+    }
+
+    // A truncated payload
+    {
+        std::stringstream stream;
+        kodo::payload_trace_writer writer(stream);
+
+        std::vector<uint8_t> payload = random_vector(10);
+        writer.write_generation(4, 10);
+        writer.write_payload(&payload[0], 10);
+
+        std::string data = stream.str();
+        std::stringstream truncated(data.substr(0, data.size() - 1));
+
+        EXPECT_FALSE(trace.load(truncated));
+    }
+}
+
+TEST(TestPayloadTrace, capture_and_replay)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_type;
+    typedef kodo::trace_capture_full_rlnc_decoder<fifi::binary8>
+        capture_type;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_type;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 160;
+
+    encoder_type::factory encoder_factory(symbols, symbol_size);
+    capture_type::factory capture_factory(symbols, symbol_size);
+    decoder_type::factory decoder_factory(symbols, symbol_size);
+
+    std::stringstream stream;
+    kodo::payload_trace_writer writer(stream);
+    capture_factory.set_trace_writer(&writer);
+
+    encoder_type::pointer encoder = encoder_factory.build();
+    capture_type::pointer capture = capture_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    uint32_t decoded = 0;
+
+    while(!capture->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        // Drop every third payload and decode every fifth twice
+        ++decoded;
+
+        if(decoded % 3 == 0)
+            continue;
+
+        std::vector<uint8_t> copy = payload;
+        capture->decode(&copy[0]);
+
+        if(decoded % 5 == 0 && !capture->is_complete())
+        {
+            copy = payload;
+            capture->decode(&copy[0]);
+        }
+    }
+
+    kodo::payload_trace trace;
+    ASSERT_TRUE(trace.load(stream));
+
+    ASSERT_EQ(1U, trace.generations());
+    EXPECT_EQ(writer.payloads(), trace.payloads());
+    EXPECT_EQ(symbols, trace.generation_at(0).m_symbols);
+    EXPECT_EQ(symbol_size, trace.generation_at(0).m_symbol_size);
+
+    // Replaying the trace decodes the block after the same payloads
+    decoder_type::pointer decoder = decoder_factory.build();
+
+    for(uint32_t i = 0; i < trace.payloads(); ++i)
+    {
+        EXPECT_FALSE(decoder->is_complete());
+        EXPECT_EQ(capture->payload_size(), trace.payload_at(i).m_size);
+
+        std::vector<uint8_t> copy(trace.payload_data(i),
+                                  trace.payload_data(i) +
+                                  trace.payload_at(i).m_size);
+
+        decoder->decode(&copy[0]);
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+
+    // No trace is recorded without a writer
+    capture_factory.set_trace_writer(0);
+    capture->initialize(capture_factory);
+
+    encoder->encode(&payload[0]);
+    capture->decode(&payload[0]);
+
+    EXPECT_EQ(trace.payloads(), writer.payloads());
+}
@@ -0,0 +1,149 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_pivot_feedback.cpp Unit tests for the pivot feedback
+///       layers
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Checks that after the feedback of a partially decoded decoder every
+/// encoded symbol is innovative for it
+template<class Field>
+void test_feedback_innovative(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::feedback_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::feedback_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(kodo::pivot_feedback_size(symbols),
+              decoder_factory.max_feedback_size());
+    EXPECT_EQ(decoder->feedback_size(), encoder->feedback_size());
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> feedback(decoder->feedback_size());
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+    encoder->set_symbols(sak::storage(data_in));
+    kodo::set_systematic_off(encoder);
+
+    EXPECT_EQ(symbols, encoder->feedback_missing_symbols());
+
+    // Decode half the block without feedback
+    while(decoder->rank() < symbols / 2)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    while(!decoder->is_complete())
+    {
+        EXPECT_EQ(feedback.size(),
+                  decoder->write_feedback(&feedback[0]));
+
+        encoder->read_feedback(&feedback[0]);
+        EXPECT_EQ(symbols - decoder->rank(),
+                  encoder->feedback_missing_symbols());
+
+        uint32_t rank = decoder->rank();
+
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        EXPECT_EQ(rank + 1, decoder->rank());
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestPivotFeedback, innovative)
+{
+    test_feedback_innovative<fifi::binary>(32, 64);
+    test_feedback_innovative<fifi::binary8>(32, 64);
+    test_feedback_innovative<fifi::binary16>(20, 64);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_feedback_innovative<fifi::binary>(symbols, symbol_size);
+    test_feedback_innovative<fifi::binary8>(symbols, symbol_size);
+}
+
+/// Checks the bitmap written for the uncoded symbols received in the
+/// systematic phase and that the feedback is cleared on initialize
+TEST(TestPivotFeedback, bitmap)
+{
+    typedef kodo::feedback_full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::feedback_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 12;
+    uint32_t symbol_size = 16;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> feedback(decoder->feedback_size());
+    EXPECT_EQ(2U, feedback.size());
+
+    // The systematic symbols 0 to 9, losing 1 and 8
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        encoder->encode(&payload[0]);
+
+        if(i != 1 && i != 8)
+        {
+            decoder->decode(&payload[0]);
+        }
+    }
+
+    decoder->write_feedback(&feedback[0]);
+    EXPECT_EQ(0xfdU, feedback[0]);
+    EXPECT_EQ(0x02U, feedback[1]);
+
+    encoder->read_feedback(&feedback[0]);
+    EXPECT_EQ(4U, encoder->feedback_missing_symbols());
+
+    // The coded symbols only cover the missing symbols 1, 8, 10, 11
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> coefficients(encoder->coefficients_size());
+
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        encoder->generate(&coefficients[0]);
+
+        for(uint32_t j = 0; j < symbols; ++j)
+        {
+            if(j != 1 && j != 8 && j != 10 && j != 11)
+            {
+                EXPECT_EQ(0U, coefficients[j]);
+            }
+        }
+    }
+
+    encoder = encoder_factory.build();
+    EXPECT_EQ(symbols, encoder->feedback_missing_symbols());
+}
@@ -0,0 +1,220 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_prime2325_mapping.cpp Unit tests for the mapping of
+///       arbitrary data to the prime2325 field
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/prime2325_mapping.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Full vector prime2325 RLNC encoder mapping the data to the field
+    class mapping_prime2325_encoder :
+        public // Payload Codec API
+               prime2325_mapping_encoder<
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               uniform_generator<
+               // Codec API
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               simd_finite_field_math<
+                   fifi::default_field<fifi::prime2325>::type,
+               finite_field_info<fifi::prime2325,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               mapping_prime2325_encoder
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+    /// Full vector prime2325 RLNC decoder unmapping the data
+    class mapping_prime2325_decoder :
+        public // Payload API
+               prime2325_mapping_decoder<
+               payload_decoder<
+               // Codec Header API
+               systematic_decoder<
+               symbol_id_decoder<
+               // Symbol ID API
+               plain_symbol_id_reader<
+               // Codec API
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               // Coefficient Storage API
+               coefficient_storage<
+               coefficient_info<
+               // Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               simd_finite_field_math<
+                   fifi::default_field<fifi::prime2325>::type,
+               finite_field_info<fifi::prime2325,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               mapping_prime2325_decoder
+                   > > > > > > > > > > > > > > >
+    { };
+}
+
+/// Checks that the mask maps every word of the data below the prime
+/// and back
+void check_mask(std::vector<uint32_t> words)
+{
+    const std::vector<uint32_t> original = words;
+
+    uint32_t size = static_cast<uint32_t>(words.size() * sizeof(uint32_t));
+    uint8_t *data = reinterpret_cast<uint8_t*>(&words[0]);
+
+    kodo::prime2325_mask_search search(
+        static_cast<uint32_t>(words.size()));
+    search.insert(data, size);
+
+    kodo::prime2325_apply_mask(data, size, search.mask());
+
+    for(auto word : words)
+    {
+        EXPECT_TRUE(word < fifi::prime2325::prime);
+    }
+
+    kodo::prime2325_apply_mask(data, size, search.mask());
+    EXPECT_TRUE(original == words);
+}
+
+TEST(TestPrime2325Mapping, mask)
+{
+    // Words which are not field elements
+    check_mask(std::vector<uint32_t>(1, 0xffffffffU));
+    check_mask(std::vector<uint32_t>(100, fifi::prime2325::prime));
+
+    // Every value of the top bits but one
+    std::vector<uint32_t> words;
+    for(uint32_t i = 0; i < 1024; ++i)
+    {
+        if(i != 77)
+            words.push_back((i << 22) | 0x3fffffU);
+    }
+    check_mask(words);
+
+    for(uint32_t count = 1; count < 2000; count += 37)
+    {
+        std::vector<uint8_t> random = random_vector(count * 4);
+
+        std::vector<uint32_t> random_words(count);
+        std::memcpy(&random_words[0], &random[0], random.size());
+
+        random_words[count - 1] = 0xfffffffbU;
+        check_mask(random_words);
+    }
+}
+
+TEST(TestPrime2325Mapping, apply_mask_tail)
+{
+    std::vector<uint8_t> data = random_vector(23);
+    std::vector<uint8_t> masked = data;
+
+    kodo::prime2325_apply_mask(&masked[0], 23, 0x12345678U);
+
+    for(uint32_t i = 0; i < 20; i += 4)
+    {
+        uint32_t word;
+        uint32_t original;
+        std::memcpy(&word, &masked[i], 4);
+        std::memcpy(&original, &data[i], 4);
+        EXPECT_EQ(original ^ 0x12345678U, word);
+    }
+
+    kodo::prime2325_apply_mask(&masked[0], 23, 0x12345678U);
+    EXPECT_TRUE(data == masked);
+}
+
+/// Codes data containing words above the prime through the mapping
+/// layers
+void test_mapping_roundtrip(uint32_t symbols, uint32_t symbol_size)
+{
+    kodo::mapping_prime2325_encoder::factory
+        encoder_factory(symbols, symbol_size);
+    kodo::mapping_prime2325_decoder::factory
+        decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    std::fill(data_in.begin(), data_in.begin() + 8, 0xff);
+
+    encoder->set_symbols(sak::storage(data_in));
+    decoder->set_prime2325_mask(encoder->prime2325_mask());
+
+    // The symbols are elements of the field
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        const uint8_t *symbol = encoder->symbol(i);
+        for(uint32_t j = 0; j < symbol_size; j += 4)
+        {
+            uint32_t word;
+            std::memcpy(&word, symbol + j, sizeof(word));
+            EXPECT_TRUE(word < fifi::prime2325::prime);
+        }
+    }
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(data_in == data_out);
+
+    std::vector<uint8_t> symbol_out(symbol_size);
+    decoder->copy_symbol(symbols - 1, sak::storage(symbol_out));
+    EXPECT_TRUE(std::equal(symbol_out.begin(), symbol_out.end(),
+                           data_in.end() - symbol_size));
+}
+
+TEST(TestPrime2325Mapping, roundtrip)
+{
+    test_mapping_roundtrip(1, 4);
+    test_mapping_roundtrip(16, 1600);
+    test_mapping_roundtrip(32, 1400);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = 4 * (rand_symbol_size() / 4 + 1);
+    test_mapping_roundtrip(symbols, symbol_size);
+}
@@ -0,0 +1,158 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_profiling_layer.cpp Unit tests for the profiling_layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/profiling_layer.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Tag of the profiling layer below the payload layer
+    struct payload_profile_tag {};
+
+    /// Tag of the profiling layer below the symbol id layer
+    struct symbol_id_profile_tag {};
+
+    /// Full RLNC decoder profiling the codec header and the symbol id
+    /// layers
+    template<class Field>
+    class profiled_full_rlnc_decoder
+        : public // Payload API
+                 payload_decoder<
+                 profiling_layer<payload_profile_tag,
+                 // Codec Header API
+                 systematic_decoder<
+                 symbol_id_decoder<
+                 profiling_layer<symbol_id_profile_tag,
+                 // Symbol ID API
+                 plain_symbol_id_reader<
+                 // Codec API
+                 aligned_coefficients_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 profiled_full_rlnc_decoder<Field>
+                     > > > > > > > > > > > > > > > >
+    {};
+
+}
+
+/// Decodes a block and checks the calls seen by both profiling layers
+template<class Field>
+void test_profiling_layer(uint32_t symbols, uint32_t symbol_size,
+                          bool systematic)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::profiled_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    if(!systematic)
+        encoder->set_systematic_off();
+
+    kodo::layer_costs<kodo::payload_profile_tag>(*decoder)
+        .m_sample_interval = 2;
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint32_t payloads = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+        ++payloads;
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+
+    const kodo::layer_profile &outer =
+        kodo::layer_costs<kodo::payload_profile_tag>(*decoder);
+
+    const kodo::layer_profile &inner =
+        kodo::layer_costs<kodo::symbol_id_profile_tag>(*decoder);
+
+    // The payload decoder decodes every payload with the symbol data and
+    // the header
+    EXPECT_EQ(payloads, outer.m_decode.m_calls);
+    EXPECT_EQ(uint64_t(payloads) * decoder->symbol_size(),
+              outer.m_decode.m_bytes);
+    EXPECT_EQ(payloads / 2, outer.m_decode.m_samples);
+    EXPECT_EQ(0U, outer.m_encode.m_calls);
+
+    // The inner layer is not sampled
+    EXPECT_EQ(0U, inner.m_decode_symbol.m_samples);
+    EXPECT_EQ(0U, inner.m_read_id.m_samples);
+    EXPECT_EQ(0.0, inner.estimated_ticks());
+
+    // Systematic symbols bypass the symbol id and are decoded uncoded,
+    // the others are decoded with their coefficients
+    EXPECT_EQ(inner.m_read_id.m_calls, inner.m_decode_symbol.m_calls);
+    EXPECT_EQ(0U, inner.m_read_id.m_bytes);
+
+    if(systematic)
+    {
+        EXPECT_EQ(0U, inner.m_read_id.m_calls);
+        EXPECT_EQ(payloads, inner.m_decode_uncoded.m_calls);
+    }
+    else
+    {
+        EXPECT_EQ(payloads, inner.m_read_id.m_calls);
+        EXPECT_EQ(0U, inner.m_decode_uncoded.m_calls);
+    }
+
+    // The costs are cleared when the decoder is recycled, the interval
+    // is kept
+    decoder.reset();
+    decoder = decoder_factory.build();
+
+    const kodo::layer_profile &recycled =
+        kodo::layer_costs<kodo::payload_profile_tag>(*decoder);
+
+    EXPECT_EQ(0U, recycled.m_decode.m_calls);
+    EXPECT_EQ(2U, recycled.m_sample_interval);
+}
+
+TEST(TestProfilingLayer, test_profiling_layer)
+{
+    test_profiling_layer<fifi::binary>(16, 160, true);
+    test_profiling_layer<fifi::binary>(16, 160, false);
+    test_profiling_layer<fifi::binary8>(32, 160, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_profiling_layer<fifi::binary8>(symbols, symbol_size, true);
+}
@@ -10,6 +10,8 @@
 #include <kodo/random_annex_base.hpp>
 #include <kodo/random_annex_encoder.hpp>
 #include <kodo/random_annex_decoder.hpp>
+#include <kodo/parallel_random_annex_decoder.hpp>
+#include <kodo/block_executor.hpp>
 #include <kodo/rfc5052_partitioning_scheme.hpp>
 #include <kodo/rlnc/full_vector_codes.hpp>
 
@@ -223,4 +225,143 @@ TEST(TestRandomAnnexCoder, construct_and_invoke_the_basic_api)
     test_random_annex_coders(symbols, symbol_size, multiplier);
 }
 
+/// Decodes a random annex object in parallel with losses
+template<class Field>
+void invoke_parallel_random_annex(uint32_t max_symbols,
+                                  uint32_t max_symbol_size,
+                                  uint32_t object_size,
+                                  uint32_t annex_size,
+                                  uint32_t threads)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typedef kodo::random_annex_encoder<
+        encoder_t, kodo::rfc5052_partitioning_scheme> object_encoder_t;
+
+    typedef kodo::parallel_random_annex_decoder<decoder_t>
+        object_decoder_t;
+
+    kodo::block_executor executor(threads);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    typename encoder_t::factory encoder_factory(
+        max_symbols, max_symbol_size);
+    typename decoder_t::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    object_encoder_t obj_encoder(
+        annex_size, encoder_factory, sak::storage(data_in));
+
+    object_decoder_t obj_decoder(
+        annex_size, decoder_factory, object_size, executor);
+
+    EXPECT_EQ(obj_encoder.encoders(), obj_decoder.decoders());
+
+    uint32_t blocks = obj_encoder.encoders();
+
+    std::vector<typename encoder_t::pointer> encoders(blocks);
+    std::vector<std::vector<uint8_t> > buffers(blocks);
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        encoders[i] = obj_encoder.build(i);
+
+        if(kodo::is_systematic_encoder(encoders[i]))
+            kodo::set_systematic_off(encoders[i]);
+
+        buffers[i].resize(encoders[i]->payload_size());
+    }
+
+    std::vector<uint8_t*> payloads;
+    std::vector<uint32_t> decoder_ids;
+
+    while(!obj_decoder.is_complete())
+    {
+        payloads.clear();
+        decoder_ids.clear();
+
+        for(uint32_t i = 0; i < blocks; ++i)
+        {
+            encoders[i]->encode(&buffers[i][0]);
+
+            // Every block loses about a third of its payloads
+            if(obj_decoder.is_complete(i) || rand() % 3 == 0)
+                continue;
+
+            payloads.push_back(&buffers[i][0]);
+            decoder_ids.push_back(i);
+        }
+
+        if(payloads.empty())
+            continue;
 
+        obj_decoder.decode(&decoder_ids[0], &payloads[0],
+                           static_cast<uint32_t>(payloads.size()));
+    }
+
+    std::vector<uint8_t> data_out(object_size, '\0');
+    obj_decoder.copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestRandomAnnexCoder, parallel_decode)
+{
+    invoke_parallel_random_annex<fifi::binary>(16, 64, 16 * 64 * 8, 4, 4);
+    invoke_parallel_random_annex<fifi::binary8>(32, 100, 32 * 100 * 6, 8, 3);
+    invoke_parallel_random_annex<fifi::binary16>(8, 40, 8 * 40 * 5, 2, 2);
+
+    // A single block without annex
+    invoke_parallel_random_annex<fifi::binary8>(32, 100, 1000, 0, 2);
+}
+
+/// Tests that a completed block passes its annex symbols to the blocks
+/// sharing them
+TEST(TestRandomAnnexCoder, parallel_propagation)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t max_symbols = 16;
+    uint32_t max_symbol_size = 32;
+    uint32_t object_size = max_symbols * max_symbol_size * 4;
+    uint32_t annex_size = 4;
+
+    kodo::block_executor executor(2);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    encoder_t::factory encoder_factory(max_symbols, max_symbol_size);
+    decoder_t::factory decoder_factory(max_symbols, max_symbol_size);
+
+    kodo::random_annex_encoder<encoder_t, kodo::rfc5052_partitioning_scheme>
+        obj_encoder(annex_size, encoder_factory, sak::storage(data_in));
+
+    kodo::parallel_random_annex_decoder<decoder_t>
+        obj_decoder(annex_size, decoder_factory, object_size, executor);
+
+    encoder_t::pointer encoder = obj_encoder.build(0);
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    uint8_t *payloads[] = { &payload[0] };
+    uint32_t decoder_ids[] = { 0 };
+
+    while(!obj_decoder.is_complete(0))
+    {
+        encoder->encode(&payload[0]);
+        obj_decoder.decode(decoder_ids, payloads, 1);
+    }
+
+    // The annex of block 0 holds symbols of the other blocks, which
+    // received them without any payload
+    uint32_t rank = 0;
+    for(uint32_t i = 1; i < obj_decoder.decoders(); ++i)
+    {
+        EXPECT_FALSE(obj_decoder.is_complete(i));
+        rank += obj_decoder.decoder(i)->rank();
+    }
+
+    EXPECT_GE(rank, annex_size);
+}
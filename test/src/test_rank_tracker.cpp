@@ -0,0 +1,193 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rank_tracker.cpp Unit tests for the rank tracker stacks
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+#include <kodo/rlnc/seed_codes.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Feeds the same payloads to a decoder and a rank tracker and checks
+/// that they agree on the rank after every symbol
+template<class Encoder, class Decoder, class Tracker>
+void test_rank_tracker(uint32_t symbols, uint32_t symbol_size,
+                       bool systematic)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+    typename Tracker::factory tracker_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+    auto tracker = tracker_factory.build();
+
+    if(!systematic)
+    {
+        kodo::set_systematic_off(encoder);
+    }
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> header(decoder->header_size());
+
+    typedef kodo::systematic_base_coder coder;
+
+    uint32_t count = 0;
+
+    while(!decoder->is_complete())
+    {
+        ASSERT_TRUE(count++ < 4 * symbols + 100);
+
+        encoder->encode(&payload[0]);
+
+        // Drop some of the symbols
+        if((rand() % 4) == 0)
+        {
+            continue;
+        }
+
+        // The decoder modifies the header of the payload
+        std::copy_n(payload.begin() + decoder->symbol_size(),
+                    header.size(), header.begin());
+
+        decoder->decode(&payload[0]);
+
+        uint8_t flag = sak::big_endian::get<coder::flag_type>(&header[0]);
+
+        if(flag == coder::systematic_flag)
+        {
+            uint32_t index = sak::big_endian::get<coder::counter_type>(
+                &header[sizeof(coder::flag_type)]);
+
+            tracker->decode_uncoded(index);
+        }
+        else
+        {
+            uint8_t *symbol_id = &header[decoder->symbol_id_offset()];
+
+            bool innovative = tracker->is_innovative_id(symbol_id);
+            uint32_t rank = tracker->rank();
+
+            EXPECT_EQ(innovative, tracker->decode_id(symbol_id));
+            EXPECT_EQ(rank + (innovative ? 1U : 0U), tracker->rank());
+        }
+
+        EXPECT_EQ(decoder->rank(), tracker->rank());
+
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            EXPECT_EQ(decoder->symbol_pivot(i), tracker->symbol_pivot(i));
+        }
+    }
+
+    EXPECT_TRUE(tracker->is_complete());
+}
+
+template<class Field>
+void test_rank_trackers(uint32_t symbols, uint32_t symbol_size)
+{
+    for(bool systematic : { true, false })
+    {
+        test_rank_tracker<
+            kodo::full_rlnc_encoder<Field>,
+            kodo::full_rlnc_decoder<Field>,
+            kodo::plain_rank_tracker<Field> >(
+                symbols, symbol_size, systematic);
+
+        test_rank_tracker<
+            kodo::seed_rlnc_encoder<Field>,
+            kodo::seed_rlnc_decoder<Field>,
+            kodo::seed_rank_tracker<Field> >(
+                symbols, symbol_size, systematic);
+    }
+}
+
+TEST(TestRankTracker, rank)
+{
+    test_rank_trackers<fifi::binary>(1, 1);
+    test_rank_trackers<fifi::binary>(33, 10);
+    test_rank_trackers<fifi::binary8>(1, 1);
+    test_rank_trackers<fifi::binary8>(20, 16);
+    test_rank_trackers<fifi::binary16>(1, 2);
+    test_rank_trackers<fifi::binary16>(12, 30);
+
+    for(bool systematic : { true, false })
+    {
+        test_rank_tracker<
+            kodo::rs_encoder<fifi::binary8>,
+            kodo::rs_decoder<fifi::binary8>,
+            kodo::rs_rank_tracker<fifi::binary8> >(
+                16, 10, systematic);
+    }
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_rank_trackers<fifi::binary>(symbols, symbol_size);
+    test_rank_trackers<fifi::binary8>(symbols, symbol_size);
+}
+
+/// Adds coefficient vectors directly, in batches and as uncoded
+/// symbols
+TEST(TestRankTracker, coefficients)
+{
+    typedef kodo::plain_rank_tracker<fifi::binary8> tracker_type;
+
+    uint32_t symbols = 4;
+
+    tracker_type::factory factory(symbols, 1);
+    auto tracker = factory.build();
+
+    uint32_t size = tracker->coefficients_size();
+    EXPECT_EQ(symbols, size);
+
+    std::vector<uint8_t> a = { 0, 3, 5, 0 };
+    std::vector<uint8_t> b = { 0, 6, 10, 0 };
+    std::vector<uint8_t> c = { 0, 0, 7, 0 };
+    std::vector<uint8_t> zero(size, 0);
+
+    EXPECT_FALSE(tracker->is_innovative(&zero[0]));
+    EXPECT_TRUE(tracker->is_innovative(&a[0]));
+    EXPECT_EQ(3U, a[1]);
+
+    // Vector b is a multiple of a, it is reduced to zero
+    uint8_t *ids[] = { &a[0], &b[0], &zero[0] };
+    EXPECT_EQ(1U, tracker->decode_ids(ids, 3));
+    EXPECT_EQ(1U, tracker->rank());
+    EXPECT_TRUE(tracker->symbol_pivot(1));
+    EXPECT_FALSE(tracker->symbol_pivot(2));
+
+    EXPECT_TRUE(tracker->is_innovative(&c[0]));
+    EXPECT_TRUE(tracker->decode_uncoded(1));
+    EXPECT_TRUE(tracker->symbol_pivot(2));
+    EXPECT_FALSE(tracker->decode_uncoded(2));
+    EXPECT_EQ(2U, tracker->rank());
+    EXPECT_FALSE(tracker->is_innovative(&c[0]));
+
+    EXPECT_TRUE(tracker->decode_uncoded(0));
+    EXPECT_FALSE(tracker->decode_uncoded(0));
+    EXPECT_FALSE(tracker->is_complete());
+
+    std::vector<uint8_t> d = { 1, 1, 1, 1 };
+    uint8_t *last[] = { &d[0], &a[0] };
+    EXPECT_EQ(1U, tracker->decode_ids(last, 2));
+    EXPECT_TRUE(tracker->is_complete());
+    EXPECT_FALSE(tracker->decode_uncoded(3));
+
+    // A rebuilt tracker starts empty
+    tracker = factory.build();
+    EXPECT_EQ(0U, tracker->rank());
+    EXPECT_FALSE(tracker->symbol_pivot(1));
+}
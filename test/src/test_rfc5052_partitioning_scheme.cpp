@@ -86,3 +86,29 @@ TEST(TestRfc5052PartitioningScheme, partition_size)
     }
 }
 
+TEST(TestRfc5052PartitioningScheme, partition_large_object)
+{
+    // An object larger than 4 GB, the offsets of the blocks exceed
+    // 32 bit while the blocks themselves do not
+    uint32_t max_symbols = 1000;
+    uint32_t max_symbol_size = 1400;
+    uint64_t object_size = 500ULL * 1000 * 1000 * 1000 + 123;
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, object_size);
+
+    EXPECT_EQ(object_size, partitioning.object_size());
+    EXPECT_GE(partitioning.total_block_size(), object_size);
+
+    uint64_t offset = 0;
+
+    for(uint32_t i = 0; i < partitioning.blocks(); ++i)
+    {
+        ASSERT_EQ(offset, partitioning.byte_offset(i));
+        ASSERT_LE(partitioning.bytes_used(i), partitioning.block_size(i));
+
+        offset += partitioning.bytes_used(i);
+    }
+
+    EXPECT_EQ(object_size, offset);
+}
@@ -0,0 +1,69 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rlnc_fixed_full_vector_codes.cpp Unit tests for the full
+///       vector codes with a block geometry fixed at compile-time
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/fixed_full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Runs the basic API tests for a fixed geometry
+template<class Field, uint32_t Symbols, uint32_t SymbolSize>
+void test_fixed_full_vector_codes()
+{
+    typedef kodo::fixed_full_rlnc_encoder<Field, Symbols, SymbolSize>
+        encoder_t;
+
+    typedef kodo::fixed_full_rlnc_decoder<Field, Symbols, SymbolSize>
+        decoder_t;
+
+    EXPECT_EQ(Symbols, encoder_t::fixed_symbols);
+    EXPECT_EQ(SymbolSize, encoder_t::fixed_symbol_size);
+    EXPECT_EQ(Symbols * SymbolSize, decoder_t::fixed_block_size);
+    EXPECT_EQ(SymbolSize / sizeof(typename Field::value_type),
+              decoder_t::fixed_symbol_length);
+
+    invoke_basic_api<encoder_t, decoder_t>(Symbols, SymbolSize);
+    invoke_out_of_order_raw<encoder_t, decoder_t>(Symbols, SymbolSize);
+    invoke_initialize<encoder_t, decoder_t>(Symbols, SymbolSize);
+    invoke_systematic<encoder_t, decoder_t>(Symbols, SymbolSize);
+}
+
+TEST(TestRlncFixedFullVectorCodes, test_construct)
+{
+    typedef kodo::fixed_full_rlnc_encoder<fifi::binary8, 32, 1280>
+        encoder_t;
+
+    typedef kodo::fixed_full_rlnc_decoder<fifi::binary8, 32, 1280>
+        decoder_t;
+
+    encoder_t::factory encoder_factory(32, 1280);
+    decoder_t::factory decoder_factory(32, 1280);
+
+    EXPECT_EQ(32U, encoder_factory.symbols());
+    EXPECT_EQ(1280U, encoder_factory.symbol_size());
+    EXPECT_EQ(32U * 1280U, decoder_factory.max_block_size());
+    EXPECT_EQ(32U, decoder_factory.max_coefficients_size());
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(32U, encoder->coefficients_size());
+    EXPECT_EQ(32U, decoder->coefficients_length());
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+}
+
+TEST(TestRlncFixedFullVectorCodes, test_basic_api)
+{
+    test_fixed_full_vector_codes<fifi::binary8, 32, 1280>();
+    test_fixed_full_vector_codes<fifi::binary, 20, 160>();
+    test_fixed_full_vector_codes<fifi::binary16, 5, 32>();
+    test_fixed_full_vector_codes<fifi::binary8, 1, 1>();
+}
@@ -8,6 +8,8 @@
 ///       vector codes (i.e. Network Coding encoders and decoders).
 
 #include <ctime>
+#include <cstring>
+#include <algorithm>
 
 #include <gtest/gtest.h>
 
@@ -17,6 +19,7 @@
 #include <kodo/payload_recoder.hpp>
 #include <kodo/partial_shallow_symbol_storage.hpp>
 #include <kodo/linear_block_decoder_delayed.hpp>
+#include <kodo/block_executor.hpp>
 #include <kodo/storage_aware_generator.hpp>
 #include <kodo/shallow_symbol_storage.hpp>
 #include <kodo/has_shallow_symbol_storage.hpp>
@@ -175,6 +178,12 @@ void test_coders(uint32_t symbols, uint32_t symbol_size)
             Decoder<fifi::binary>
             >(symbols, symbol_size);
 
+    invoke_basic_api
+        <
+            Encoder<fifi::binary4>,
+            Decoder<fifi::binary4>
+            >(symbols, symbol_size);
+
     invoke_basic_api
         <
             Encoder<fifi::binary8>,
@@ -213,6 +222,23 @@ void test_coders(uint32_t symbols, uint32_t symbol_size)
         kodo::full_rlnc_encoder,
         kodo::full_rlnc_decoder_delayed
         >(symbols, symbol_size);
+
+    // The vectorized region kernels
+    test_coders<
+        kodo::simd_full_rlnc_encoder,
+        kodo::simd_full_rlnc_decoder
+        >(symbols, symbol_size);
+
+    // The pivots chosen for low fill-in
+    test_coders<
+        kodo::sparse_full_rlnc_encoder,
+        kodo::markowitz_full_rlnc_decoder
+        >(symbols, symbol_size);
+    // The coefficient vectors only stored for the coded symbols
+    test_coders<
+        kodo::full_rlnc_encoder,
+        kodo::pooled_full_rlnc_decoder
+        >(symbols, symbol_size);
 }
 
 /// Tests the basic API functionality this mean basic encoding
@@ -222,6 +248,9 @@ TEST(TestRlncFullVectorCodes, basic_api)
     test_coders(32, 1600);
     test_coders(1, 1600);
 
+    // Symbols spanning several of the tiles used when encoding
+    test_coders(8, 10000);
+
     uint32_t symbols = rand_symbols();
     uint32_t symbol_size = rand_symbol_size();
 
@@ -242,6 +271,12 @@ void test_initialize(uint32_t symbols, uint32_t symbol_size)
             Decoder<fifi::binary>
             >(symbols, symbol_size);
 
+    invoke_initialize
+        <
+            Encoder<fifi::binary4>,
+            Decoder<fifi::binary4>
+            >(symbols, symbol_size);
+
     invoke_initialize
         <
             Encoder<fifi::binary8>,
@@ -274,6 +309,10 @@ void test_initialize(uint32_t symbols, uint32_t symbol_size)
         kodo::full_rlnc_encoder,
         kodo::full_rlnc_decoder_delayed>(symbols, symbol_size);
 
+    test_initialize<
+        kodo::full_rlnc_encoder,
+        kodo::pooled_full_rlnc_decoder>(symbols, symbol_size);
+
 }
 
 /// Test that the encoders and decoders initialize() function can be used
@@ -333,6 +372,11 @@ void test_coders_systematic(uint32_t symbols, uint32_t symbol_size)
         kodo::full_rlnc_decoder_delayed
         >(symbols, symbol_size);
 
+    test_coders_systematic<
+        kodo::full_rlnc_encoder,
+        kodo::pooled_full_rlnc_decoder
+        >(symbols, symbol_size);
+
 }
 
 /// Tests that an encoder producing systematic packets is handled
@@ -388,6 +432,11 @@ void test_coders_raw(uint32_t symbols, uint32_t symbol_size)
         kodo::full_rlnc_encoder,
         kodo::full_rlnc_decoder_delayed
         >(symbols, symbol_size);
+
+    test_coders_raw<
+        kodo::full_rlnc_encoder,
+        kodo::pooled_full_rlnc_decoder
+        >(symbols, symbol_size);
 }
 
 /// Tests whether mixed un-coded and coded packets are correctly handled
@@ -497,6 +546,10 @@ void test_recoders(recoding_parameters param)
         Encoder<fifi::binary>,
         Decoder<fifi::binary> >(param);
 
+    invoke_recoding<
+        Encoder<fifi::binary4>,
+        Decoder<fifi::binary4> >(param);
+
     invoke_recoding<
         Encoder<fifi::binary8>,
         Decoder<fifi::binary8> >(param);
@@ -520,6 +573,14 @@ void test_recoders(recoding_parameters param)
         kodo::full_rlnc_encoder,
         kodo::full_rlnc_decoder>(param);
 
+    test_recoders<
+        kodo::simd_full_rlnc_encoder,
+        kodo::simd_full_rlnc_decoder>(param);
+
+    test_recoders<
+        kodo::full_rlnc_encoder,
+        kodo::markowitz_full_rlnc_decoder>(param);
+
     test_recoders<
         kodo::full_rlnc_encoder,
         kodo::full_rlnc_decoder_delayed>(param);
@@ -575,6 +636,59 @@ TEST(TestRlncFullVectorCodes, recoding_simple)
 }
 
 
+/// Recodes into payloads at every offset from a 16 byte boundary, so
+/// the recoded symbol id is built both directly in the payload and in
+/// the scratch buffer used for unaligned payloads
+template<class Field>
+inline void invoke_recoding_alignment(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> buffer(encoder->payload_size() + 16);
+
+    for(uint32_t offset = 0; offset < 16; ++offset)
+    {
+        auto decoder_one = decoder_factory.build();
+        auto decoder_two = decoder_factory.build();
+
+        uint8_t *payload = &buffer[offset];
+
+        while(!decoder_two->is_complete())
+        {
+            encoder->encode(payload);
+            decoder_one->decode(payload);
+
+            decoder_one->recode(payload);
+            decoder_two->decode(payload);
+        }
+
+        std::vector<uint8_t> data_out(decoder_two->block_size());
+        decoder_two->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_in == data_out);
+    }
+}
+
+TEST(TestRlncFullVectorCodes, recoding_alignment)
+{
+    invoke_recoding_alignment<fifi::binary>(16, 32);
+    invoke_recoding_alignment<fifi::binary8>(16, 32);
+    invoke_recoding_alignment<fifi::binary16>(16, 32);
+    invoke_recoding_alignment<fifi::binary8>(rand_symbols(),
+                                             rand_symbol_size());
+}
+
+
 template
     <
     template <class> class Encoder,
@@ -699,5 +813,745 @@ TEST(TestRlncFullVectorCodes, test_reuse_incomplete)
     test_reuse_incomplete(symbols, symbol_size);
 }
 
+/// Helper checking that payloads produced in batches decode
+/// correctly
+template<class Encoder, class Decoder>
+void invoke_batch_encode(uint32_t symbols, uint32_t symbol_size,
+                         uint32_t batch_size)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<std::vector<uint8_t> > payloads(
+        batch_size, std::vector<uint8_t>(encoder->payload_size()));
+
+    std::vector<uint8_t*> buffers(batch_size);
+    for(uint32_t i = 0; i < batch_size; ++i)
+    {
+        buffers[i] = &payloads[i][0];
+    }
+
+    std::vector<uint32_t> bytes_used(batch_size);
+
+    // The first batch contains the systematic symbols as well
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&buffers[0], batch_size, &bytes_used[0]);
+
+        for(uint32_t i = 0; i < batch_size; ++i)
+        {
+            EXPECT_TRUE(bytes_used[i] > 0);
+            EXPECT_TRUE(bytes_used[i] <= encoder->payload_size());
+
+            decoder->decode(buffers[i]);
+        }
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(std::equal(data_out.begin(), data_out.end(),
+                           data_in.begin()));
+}
+
+template<class Field>
+void test_batch_encode(uint32_t symbols, uint32_t symbol_size)
+{
+    invoke_batch_encode<
+        kodo::full_rlnc_encoder<Field>,
+        kodo::full_rlnc_decoder<Field>
+        >(symbols, symbol_size, 1);
+
+    invoke_batch_encode<
+        kodo::full_rlnc_encoder<Field>,
+        kodo::full_rlnc_decoder<Field>
+        >(symbols, symbol_size, 8);
+
+    invoke_batch_encode<
+        kodo::full_rlnc_encoder<Field>,
+        kodo::full_rlnc_decoder<Field>
+        >(symbols, symbol_size, symbols + 3);
+}
+
+/// Tests that the encoder can produce a number of payloads in one
+/// call
+TEST(TestRlncFullVectorCodes, batch_encode)
+{
+    test_batch_encode<fifi::binary>(32, 1600);
+    test_batch_encode<fifi::binary8>(32, 1600);
+    test_batch_encode<fifi::binary16>(32, 1600);
+    test_batch_encode<fifi::binary8>(1, 1600);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_batch_encode<fifi::binary8>(symbols, symbol_size);
+}
+
+/// Decodes batches of payloads where the coded symbols arrive before
+/// the systematic symbols and some payloads are repeated
+template<class Field>
+void test_batch_decode(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    // The systematic symbols followed by a few coded symbols, where
+    // every other systematic symbol is lost
+    uint32_t count = symbols + 4;
+
+    std::vector<std::vector<uint8_t> > payloads(
+        count, std::vector<uint8_t>(encoder->payload_size()));
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        encoder->encode(&payloads[i][0]);
+    }
+
+    std::vector<uint8_t*> batch;
+
+    for(uint32_t i = symbols; i < count; ++i)
+    {
+        batch.push_back(&payloads[i][0]);
+    }
+
+    for(uint32_t i = 0; i < symbols; i += 2)
+    {
+        batch.push_back(&payloads[i][0]);
+    }
+
+    // A repeated systematic symbol is skipped
+    std::vector<uint8_t> repeated = payloads[0];
+    batch.push_back(&repeated[0]);
+
+    uint32_t decoded = decoder->decode(&batch[0], batch.size());
+
+    EXPECT_LT(decoded, batch.size());
+    // The coded symbols may not all be innovative with fifi::binary
+    EXPECT_GE(decoder->rank(), (symbols + 1) / 2);
+    EXPECT_LE(decoder->rank(),
+              std::min(symbols, count - symbols + (symbols + 1) / 2));
+
+    // The systematic symbols already decoded are skipped
+    batch.clear();
+
+    for(uint32_t i = 0; i < symbols; i += 2)
+    {
+        batch.push_back(&payloads[i][0]);
+    }
+
+    if(!decoder->is_complete())
+    {
+        uint32_t rank = decoder->rank();
+        EXPECT_EQ(0U, decoder->decode(&batch[0], batch.size()));
+        EXPECT_EQ(rank, decoder->rank());
+    }
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payloads[0][0]);
+        encoder->encode(&payloads[1][0]);
+
+        uint8_t *buffers[] = { &payloads[0][0], &payloads[1][0] };
+        decoder->decode(buffers, 2);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestRlncFullVectorCodes, batch_decode)
+{
+    test_batch_decode<fifi::binary>(16, 100);
+    test_batch_decode<fifi::binary8>(32, 100);
+    test_batch_decode<fifi::binary16>(8, 100);
+    test_batch_decode<fifi::binary8>(1, 100);
+}
+
+/// Helper checking that the delayed decoder decodes with the final
+/// backward substitution split over the threads of an executor
+template<class Field>
+void test_striped_backward_substitute(uint32_t symbols,
+                                      uint32_t symbol_size,
+                                      kodo::block_executor &executor)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder_delayed<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    EXPECT_TRUE(decoder_factory.backward_substitution_executor() == 0);
+    decoder_factory.set_backward_substitution_executor(&executor);
+    EXPECT_TRUE(decoder_factory.backward_substitution_executor() ==
+                &executor);
+
+    // The decoder is reused to check the operations of the previous
+    // block are not applied again
+    for(uint32_t run = 0; run < 2; ++run)
+    {
+        auto encoder = encoder_factory.build();
+        auto decoder = decoder_factory.build();
+
+        std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+        encoder->set_symbols(sak::storage(data_in));
+
+        encoder->set_systematic_off();
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+
+        for(uint32_t i = 0; i < symbols / 2; ++i)
+        {
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+        }
+
+        // Some symbols are received uncoded, also at the pivots of
+        // coded symbols
+        for(uint32_t i = 0; i < symbols; i += 3)
+        {
+            encoder->copy_symbol(i, sak::storage(payload));
+            decoder->decode_symbol(&payload[0], i);
+        }
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+        }
+
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data_in);
+    }
+}
+
+/// Tests the final backward substitution on several threads
+TEST(TestRlncFullVectorCodes, striped_backward_substitute)
+{
+    kodo::block_executor executor(4);
+
+    test_striped_backward_substitute<fifi::binary>(32, 4096, executor);
+    test_striped_backward_substitute<fifi::binary8>(32, 5000, executor);
+    test_striped_backward_substitute<fifi::binary16>(16, 3002, executor);
+
+    // Too small for more than one stripe
+    test_striped_backward_substitute<fifi::binary8>(16, 1600, executor);
+    test_striped_backward_substitute<fifi::binary8>(1, 8192, executor);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_striped_backward_substitute<fifi::binary8>(
+        symbols, symbol_size * 8, executor);
+}
+
+template<class Field>
+void test_progressive_backward_substitute(uint32_t symbols,
+                                          uint32_t symbol_size,
+                                          uint32_t stripe_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder_delayed<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    EXPECT_EQ(0U, decoder_factory.progressive_stripe_size());
+    decoder_factory.set_progressive_stripe_size(stripe_size);
+    EXPECT_EQ(stripe_size, decoder_factory.progressive_stripe_size());
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    uint32_t stripes = decoder->stripe_count();
+    uint32_t stripe_bytes = decoder->stripe_size();
+
+    EXPECT_GT(stripe_bytes, 0U);
+    EXPECT_EQ((decoder->symbol_size() + stripe_bytes - 1) / stripe_bytes,
+              stripes);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    encoder->set_systematic_off();
+
+    // The stripes are decoded in order, and a decoded stripe holds the
+    // source data in every symbol when the callback is invoked
+    std::vector<uint32_t> decoded;
+
+    auto callback = [&](uint32_t stripe)
+        {
+            EXPECT_EQ(stripe + 1, decoder->stripes_decoded());
+
+            uint32_t offset = stripe * stripe_bytes;
+            uint32_t size = std::min(stripe_bytes,
+                                     decoder->symbol_size() - offset);
+
+            for(uint32_t i = 0; i < symbols; ++i)
+            {
+                EXPECT_EQ(0, memcmp(decoder->symbol(i) + offset,
+                                    encoder->symbol(i) + offset, size));
+            }
+
+            decoded.push_back(stripe);
+        };
+
+    decoder->set_stripe_decoded_callback(callback);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        EXPECT_EQ(0U, decoder->stripes_decoded());
+
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_EQ(stripes, decoder->stripes_decoded());
+    EXPECT_EQ(stripes, decoded.size());
+
+    for(uint32_t i = 0; i < decoded.size(); ++i)
+    {
+        EXPECT_EQ(i, decoded[i]);
+    }
 
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
 
+    EXPECT_TRUE(data_out == data_in);
+
+    // The callback is reset when the decoder is reused
+    decoder.reset();
+    decoder = decoder_factory.build();
+    EXPECT_EQ(0U, decoder->stripes_decoded());
+}
+
+/// Tests the final backward substitution a stripe at a time
+TEST(TestRlncFullVectorCodes, progressive_backward_substitute)
+{
+    test_progressive_backward_substitute<fifi::binary>(32, 4096, 1024);
+    test_progressive_backward_substitute<fifi::binary8>(32, 5000, 1024);
+    test_progressive_backward_substitute<fifi::binary16>(16, 3002, 999);
+    test_progressive_backward_substitute<fifi::binary8>(16, 100, 1);
+    test_progressive_backward_substitute<fifi::binary8>(16, 100, 200);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_progressive_backward_substitute<fifi::binary8>(
+        symbols, symbol_size, 64);
+}
+
+template<class Field>
+void test_on_demand_decoding(uint32_t symbols, uint32_t symbol_size,
+                             bool systematic)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder_delayed<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    EXPECT_FALSE(decoder_factory.on_demand_decoding());
+    decoder_factory.set_on_demand_decoding(true);
+    EXPECT_TRUE(decoder_factory.on_demand_decoding());
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_TRUE(decoder->is_on_demand());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    if(!systematic)
+        encoder->set_systematic_off();
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> symbol(decoder->symbol_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        // A symbol decoded before the decoder is complete is correct
+        for(uint32_t i = 0; i < symbols; ++i)
+        {
+            if(decoder->decode_symbol_on_demand(i, &symbol[0]))
+            {
+                EXPECT_EQ(0, memcmp(&symbol[0], encoder->symbol(i),
+                                    symbol_size));
+            }
+        }
+    }
+
+    // Every symbol is decoded on demand in any order
+    for(uint32_t i = symbols; i --> 0;)
+    {
+        std::fill(symbol.begin(), symbol.end(), 0);
+
+        EXPECT_TRUE(decoder->decode_symbol_on_demand(i, &symbol[0]));
+        EXPECT_EQ(0, memcmp(&symbol[0], encoder->symbol(i), symbol_size));
+    }
+
+    // The storage is decoded on request, after which the symbols are
+    // still decoded on demand
+    decoder->decode_remaining();
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+
+    EXPECT_TRUE(decoder->decode_symbol_on_demand(0, &symbol[0]));
+    EXPECT_EQ(0, memcmp(&symbol[0], encoder->symbol(0), symbol_size));
+}
+
+/// Tests decoding single symbols without the final backward
+/// substitution
+TEST(TestRlncFullVectorCodes, on_demand_decoding)
+{
+    test_on_demand_decoding<fifi::binary>(32, 160, false);
+    test_on_demand_decoding<fifi::binary8>(32, 160, false);
+    test_on_demand_decoding<fifi::binary8>(32, 160, true);
+    test_on_demand_decoding<fifi::binary16>(16, 160, false);
+    test_on_demand_decoding<fifi::binary8>(1, 16, false);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_on_demand_decoding<fifi::binary8>(symbols, symbol_size, false);
+}
+
+/// Tests that the pooled_full_rlnc_decoder only holds the coefficient
+/// vectors of the coded symbols and releases them when complete
+template<class Field>
+void test_pooled_coefficients(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::pooled_full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // Every other systematic symbol is lost
+    uint32_t uncoded = 0;
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        encoder->encode(&payload[0]);
+
+        if(i % 2 == 1)
+            continue;
+
+        decoder->decode(&payload[0]);
+        ++uncoded;
+    }
+
+    EXPECT_EQ(uncoded, decoder->rank());
+
+    if(!decoder->is_complete())
+    {
+        EXPECT_EQ(0U, decoder->coefficient_rows());
+    }
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        if(!decoder->is_complete())
+        {
+            EXPECT_EQ(decoder->rank() - uncoded,
+                      decoder->coefficient_rows());
+        }
+    }
+
+    EXPECT_EQ(0U, decoder->coefficient_rows());
+    EXPECT_EQ(0U, decoder->coefficient_pool_rows());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+
+    // A released vector is rebuilt as a unit vector
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        auto vector = decoder->coefficients_value(i);
+
+        for(uint32_t j = 0; j < symbols; ++j)
+        {
+            EXPECT_EQ(i == j ? 1U : 0U,
+                      fifi::get_value<Field>(vector, j));
+        }
+    }
+}
+
+TEST(TestRlncFullVectorCodes, pooled_coefficients)
+{
+    test_pooled_coefficients<fifi::binary>(32, 160);
+    test_pooled_coefficients<fifi::binary8>(32, 160);
+    test_pooled_coefficients<fifi::binary16>(20, 160);
+    test_pooled_coefficients<fifi::binary8>(1, 160);
+}
+
+/// Tests that the recoding stack is only built when a decoder recodes,
+/// and that a recycled decoder keeps or drops it as set on the factory
+TEST(TestRlncFullVectorCodes, lazy_recoding_stack)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 100;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    EXPECT_TRUE(decoder_factory.keep_recode_stack());
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_FALSE(decoder->is_recoding_enabled());
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    encoder->encode(&payload[0]);
+    decoder->decode(&payload[0]);
+
+    // The first recode builds the stack, the payload size is unchanged
+    decoder->recode(&payload[0]);
+
+    EXPECT_TRUE(decoder->is_recoding_enabled());
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    // A recycled decoder keeps the stack
+    decoder.reset();
+    decoder = decoder_factory.build();
+
+    EXPECT_EQ(1U, decoder_factory.pool().total_resources());
+    EXPECT_TRUE(decoder->is_recoding_enabled());
+
+    // Unless the factory drops it
+    decoder_factory.set_keep_recode_stack(false);
+
+    decoder.reset();
+    decoder = decoder_factory.build();
+
+    EXPECT_FALSE(decoder->is_recoding_enabled());
+
+    decoder->enable_recoding();
+    EXPECT_TRUE(decoder->is_recoding_enabled());
+
+    // The recoded symbols decode as before
+    auto decoder_two = decoder_factory.build();
+
+    while(!decoder_two->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+
+        decoder->recode(&payload[0]);
+        decoder_two->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder_two->block_size(), '\0');
+    decoder_two->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+/// Tests that a relay recoding few of its stored symbols per recoded
+/// symbol keeps the symbols of a sparse encoder sparse
+TEST(TestRlncFullVectorCodes, sparse_recoding)
+{
+    typedef kodo::sparse_full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::markowitz_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 64;
+    uint32_t symbol_size = 100;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    EXPECT_EQ(0U, decoder_factory.recode_factory().recoding_rows());
+    decoder_factory.recode_factory().set_recoding_rows(2);
+
+    auto encoder = encoder_factory.build();
+    auto relay = decoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    encoder->set_density(0.1);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < 20 * symbols && !decoder->is_complete(); ++i)
+    {
+        encoder->encode(&payload[0]);
+        relay->decode(&payload[0]);
+
+        relay->recode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    EXPECT_TRUE(decoder->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+
+    EXPECT_EQ(2U, relay->recoder()->recoding_rows());
+    EXPECT_GT(relay->recoder()->recoded_density(), 0.0);
+    EXPECT_LT(relay->recoder()->recoded_density(), 0.5);
+
+    // The rows are picked by a generator seeded with the recoder
+    std::vector<uint8_t> first(relay->payload_size());
+    std::vector<uint8_t> second(relay->payload_size());
+
+    relay->recoder()->seed(42);
+    relay->recode(&first[0]);
+
+    relay->recoder()->seed(42);
+    relay->recode(&second[0]);
+
+    EXPECT_TRUE(first == second);
+}
+
+/// Checks that coded symbols updated with the change of a source symbol
+/// are the symbols coded from the changed block
+template<class Field>
+void test_update_symbol(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    uint32_t repair_symbols = 4;
+
+    std::vector<std::vector<uint8_t> > coefficients(
+        repair_symbols, std::vector<uint8_t>(encoder->coefficients_size()));
+
+    std::vector<std::vector<uint8_t> > repair(
+        repair_symbols, std::vector<uint8_t>(encoder->symbol_size()));
+
+    for(uint32_t j = 0; j < repair_symbols; ++j)
+    {
+        encoder->generate(&coefficients[j][0]);
+        encoder->encode_symbol(&repair[j][0], &coefficients[j][0]);
+    }
+
+    // Change one source symbol and update the repair symbols with the
+    // XOR of the old and new symbol
+    uint32_t index = rand_nonzero(symbols) - 1;
+    uint8_t *source = &data_in[index * encoder->symbol_size()];
+
+    std::vector<uint8_t> new_source = random_vector(encoder->symbol_size());
+    std::vector<uint8_t> delta(encoder->symbol_size());
+
+    for(uint32_t i = 0; i < delta.size(); ++i)
+        delta[i] = source[i] ^ new_source[i];
+
+    for(uint32_t j = 0; j < repair_symbols; ++j)
+        encoder->update_symbol(&repair[j][0], &coefficients[j][0],
+                               index, &delta[0]);
+
+    encoder->set_symbol(index, sak::storage(new_source));
+
+    std::vector<uint8_t> expected(encoder->symbol_size());
+
+    for(uint32_t j = 0; j < repair_symbols; ++j)
+    {
+        encoder->encode_symbol(&expected[0], &coefficients[j][0]);
+        EXPECT_TRUE(expected == repair[j]);
+    }
+}
+
+TEST(TestRlncFullVectorCodes, test_update_symbol)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_update_symbol<fifi::binary>(symbols, symbol_size);
+    test_update_symbol<fifi::binary8>(symbols, symbol_size);
+    test_update_symbol<fifi::binary16>(symbols, symbol_size);
+}
+
+/// Checks that a block coded mostly with coefficients of the binary
+/// subfield decodes with a decoder of the full field
+TEST(TestRlncFullVectorCodes, test_subfield_vectors)
+{
+    uint32_t symbols = 32;
+    uint32_t symbol_size = 160;
+
+    kodo::full_rlnc_encoder<fifi::binary8>::factory encoder_factory(
+        symbols, symbol_size);
+
+    kodo::full_rlnc_decoder<fifi::binary8>::factory decoder_factory(
+        symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    // The last symbols needed are of the full field
+    encoder->set_subfield_vectors(symbols - 2);
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
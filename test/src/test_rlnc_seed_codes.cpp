@@ -4,6 +4,8 @@
 // http://www.steinwurf.com/licensing
 
 #include <ctime>
+#include <algorithm>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <kodo/rlnc/seed_codes.hpp>
@@ -29,6 +31,42 @@ static void test_coders(uint32_t symbols, uint32_t symbol_size)
             kodo::seed_rlnc_encoder<fifi::binary16>,
             kodo::seed_rlnc_decoder<fifi::binary16>
             >(symbols, symbol_size);
+
+    invoke_basic_api
+        <
+            kodo::seed_rlnc_encoder<fifi::binary4>,
+            kodo::seed_rlnc_decoder<fifi::binary4>
+            >(symbols, symbol_size);
+
+    invoke_basic_api
+        <
+            kodo::simd_seed_rlnc_encoder<fifi::binary4>,
+            kodo::simd_seed_rlnc_decoder<fifi::binary4>
+            >(symbols, symbol_size);
+
+    invoke_basic_api
+        <
+            kodo::simd_seed_rlnc_encoder<fifi::binary8>,
+            kodo::simd_seed_rlnc_decoder<fifi::binary8>
+            >(symbols, symbol_size);
+
+    invoke_basic_api
+        <
+            kodo::seed_rlnc_xorshift_encoder<fifi::binary>,
+            kodo::seed_rlnc_xorshift_decoder<fifi::binary>
+            >(symbols, symbol_size);
+
+    invoke_basic_api
+        <
+            kodo::seed_rlnc_xorshift_encoder<fifi::binary8>,
+            kodo::seed_rlnc_xorshift_decoder<fifi::binary8>
+            >(symbols, symbol_size);
+
+    invoke_basic_api
+        <
+            kodo::seed_rlnc_xorshift_encoder<fifi::binary16>,
+            kodo::seed_rlnc_xorshift_decoder<fifi::binary16>
+            >(symbols, symbol_size);
 }
 
 
@@ -67,6 +105,12 @@ static void test_coders_systematic(uint32_t symbols, uint32_t symbol_size)
             kodo::seed_rlnc_decoder<fifi::binary16>
             >(symbols, symbol_size);
 
+    invoke_systematic
+        <
+            kodo::simd_seed_rlnc_encoder<fifi::binary4>,
+            kodo::simd_seed_rlnc_decoder<fifi::binary4>
+            >(symbols, symbol_size);
+
 }
 
 TEST(TestRlncSeedCodes, systematic)
@@ -82,3 +126,144 @@ TEST(TestRlncSeedCodes, systematic)
     test_coders_systematic(symbols, symbol_size);
 }
 
+
+/// Decodes two blocks with the same seed schedule, every payload being
+/// received twice, and checks the duplicate seeds are rejected and the
+/// seeds of the second block read from the cache. The cache must hold
+/// the seeds of the first block.
+template<class Encoder, class Decoder>
+void test_seed_cache(uint32_t symbols, uint32_t symbol_size,
+                     uint32_t cache_size)
+{
+    // The seeds used by the previous block
+    uint32_t previous = 0;
+
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    EXPECT_EQ(0U, decoder_factory.seed_cache_size());
+    EXPECT_FALSE(decoder_factory.reject_duplicate_seeds());
+
+    decoder_factory.set_seed_cache_size(cache_size);
+    decoder_factory.set_reject_duplicate_seeds(true);
+
+    for(uint32_t block = 0; block < 2; ++block)
+    {
+        auto encoder = encoder_factory.build();
+        auto decoder = decoder_factory.build();
+
+        encoder->set_systematic_off();
+
+        std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+        encoder->set_symbols(sak::storage(data_in));
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+        std::vector<uint8_t> duplicate(encoder->payload_size());
+
+        uint32_t encoded = 0;
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+            duplicate = payload;
+            ++encoded;
+
+            decoder->decode(&payload[0]);
+
+            uint32_t rank = decoder->rank();
+            decoder->decode(&duplicate[0]);
+
+            EXPECT_EQ(rank, decoder->rank());
+        }
+
+        EXPECT_EQ(encoded, decoder->duplicate_seeds());
+
+        // The seeds restart from zero in every block
+        EXPECT_TRUE(previous <= cache_size);
+        EXPECT_EQ(std::min(encoded, previous), decoder->seed_cache_hits());
+        previous = encoded;
+
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data_in);
+    }
+}
+
+TEST(TestRlncSeedCodes, seed_cache)
+{
+    test_seed_cache<kodo::seed_rlnc_encoder<fifi::binary8>,
+                    kodo::seed_rlnc_decoder<fifi::binary8> >(32, 160, 64);
+
+    test_seed_cache<kodo::seed_rlnc_encoder<fifi::binary>,
+                    kodo::seed_rlnc_decoder<fifi::binary> >(32, 160, 1000);
+
+    test_seed_cache<kodo::seed_rlnc_encoder<fifi::binary16>,
+                    kodo::seed_rlnc_decoder<fifi::binary16> >(32, 160, 64);
+}
+
+/// Encodes and decodes a block where the seeds are derived from the
+/// sequence numbers of the payloads, some of which are lost
+template<class Field>
+void test_implicit_seed(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::implicit_seed_rlnc_encoder<Field> encoder_t;
+    typedef kodo::implicit_seed_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    // The coded payloads carry no seed
+    EXPECT_EQ(0U, encoder->id_size());
+    EXPECT_EQ(0U, decoder->id_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // The sequence numbers need not start at zero
+    uint32_t sequence_number = rand();
+
+    while(!decoder->is_complete())
+    {
+        encoder->set_sequence_number(sequence_number);
+        encoder->encode(&payload[0]);
+
+        if(rand() % 4 != 0)
+        {
+            decoder->set_sequence_number(sequence_number);
+            decoder->decode(&payload[0]);
+        }
+
+        ++sequence_number;
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_out == data_in);
+}
+
+TEST(TestRlncSeedCodes, implicit_seed)
+{
+    test_implicit_seed<fifi::binary>(32, 160);
+    test_implicit_seed<fifi::binary8>(32, 160);
+    test_implicit_seed<fifi::binary16>(32, 160);
+
+    test_implicit_seed<fifi::binary8>(1, 160);
+    test_implicit_seed<fifi::binary8>(rand_symbols(), rand_symbol_size());
+
+    typedef kodo::implicit_seed_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::seed_rlnc_encoder<fifi::binary8> seed_encoder_t;
+
+    // The coded payloads are smaller than those of the seed encoder
+    encoder_t::factory encoder_factory(32, 160);
+    seed_encoder_t::factory seed_encoder_factory(32, 160);
+
+    EXPECT_LT(encoder_factory.max_payload_size(),
+              seed_encoder_factory.max_payload_size());
+}
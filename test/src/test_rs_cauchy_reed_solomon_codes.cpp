@@ -0,0 +1,164 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rs_cauchy_reed_solomon_codes.cpp Unit tests for the Cauchy
+///       Reed-Solomon codes and the bitmatrix_math layer
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rs/cauchy_reed_solomon_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes and decodes a block where the payloads produced from the
+/// listed rows are erased
+template<class Field>
+void test_cauchy_codes(uint32_t symbols, uint32_t symbol_size,
+                       const std::vector<uint32_t> &erased)
+{
+    typedef kodo::cauchy_rs_encoder<Field> encoder_t;
+    typedef kodo::cauchy_rs_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+    encoder->set_symbols(sak::storage(data_in));
+
+    // Without the systematic phase the row of a payload is its position
+    // in the stream
+    kodo::set_systematic_off(encoder);
+
+    uint32_t row = 0;
+
+    while(!decoder->is_complete())
+    {
+        ASSERT_TRUE(row < Field::order - 1);
+
+        encoder->encode(&payload[0]);
+
+        if(std::find(erased.begin(), erased.end(), row) == erased.end())
+        {
+            decoder->decode(&payload[0]);
+        }
+
+        ++row;
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+/// Checks that the bit matrix expansion is a representation of the
+/// field, i.e. that applying b and then a equals applying a * b, and
+/// that it distributes over the addition of coefficients
+template<class Field>
+void test_bitmatrix_math(uint32_t symbol_size)
+{
+    typedef kodo::cauchy_rs_decoder<Field> decoder_t;
+    typedef typename Field::value_type value_type;
+
+    typename decoder_t::factory decoder_factory(10, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    typename fifi::default_field<Field>::type field;
+
+    uint32_t length = symbol_size / sizeof(value_type);
+
+    std::vector<uint8_t> src = random_vector(symbol_size);
+    const value_type *s = reinterpret_cast<const value_type*>(&src[0]);
+
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        value_type a = rand_nonzero(Field::max_value);
+        value_type b = rand_nonzero(Field::max_value);
+
+        std::vector<value_type> ab(length, 0);
+        std::vector<value_type> a_b(length, 0);
+        std::vector<value_type> b_only(length, 0);
+
+        decoder->multiply_add(&ab[0], s, field.multiply(a, b), length);
+
+        decoder->multiply_add(&b_only[0], s, b, length);
+        decoder->multiply_add(&a_b[0], &b_only[0], a, length);
+
+        EXPECT_TRUE(ab == a_b);
+
+        std::vector<value_type> sum(length, 0);
+        std::vector<value_type> separate(length, 0);
+
+        decoder->multiply_add(&sum[0], s, a ^ b, length);
+
+        decoder->multiply_add(&separate[0], s, a, length);
+        decoder->multiply_add(&separate[0], s, b, length);
+
+        EXPECT_TRUE(sum == separate);
+    }
+
+    // The identity is a copy
+    std::vector<value_type> copy(length, 0);
+    decoder->multiply_add(&copy[0], s, 1U, length);
+
+    EXPECT_TRUE(std::equal(copy.begin(), copy.end(), s));
+}
+
+TEST(TestCauchyReedSolomonCodes, test_bitmatrix_math)
+{
+    test_bitmatrix_math<fifi::binary8>(64);
+    test_bitmatrix_math<fifi::binary8>(1280);
+    test_bitmatrix_math<fifi::binary16>(64);
+}
+
+TEST(TestCauchyReedSolomonCodes, test_encode_decode)
+{
+    // Nothing erased
+    test_cauchy_codes<fifi::binary8>(10, 80, std::vector<uint32_t>());
+
+    std::vector<uint32_t> erased = {0, 3, 4, 11};
+    test_cauchy_codes<fifi::binary8>(10, 80, erased);
+
+    // Only parity symbols received
+    erased = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    test_cauchy_codes<fifi::binary8>(10, 1280, erased);
+    test_cauchy_codes<fifi::binary16>(10, 320, erased);
+
+    uint32_t symbols = rand_symbols(200);
+    uint32_t symbol_size = rand_symbol_size() * 8;
+
+    erased.clear();
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        if(rand() % 2)
+        {
+            erased.push_back(i);
+        }
+    }
+
+    test_cauchy_codes<fifi::binary8>(symbols, symbol_size, erased);
+}
+
+TEST(TestCauchyReedSolomonCodes, test_systematic)
+{
+    uint32_t symbols = rand_symbols(200);
+    uint32_t symbol_size = rand_symbol_size() * 8;
+
+    invoke_systematic<kodo::cauchy_rs_encoder<fifi::binary8>,
+                      kodo::cauchy_rs_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+}
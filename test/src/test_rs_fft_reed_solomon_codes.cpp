@@ -0,0 +1,153 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rs_fft_reed_solomon_codes.cpp Unit tests for the FFT based
+///       Reed-Solomon codes
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rs/fft_reed_solomon_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes all symbols of a block and decodes it from a random subset
+/// of symbols, erasing as many symbols as there are parity symbols
+void test_fft_codes(uint32_t symbols, uint32_t symbol_size,
+                    uint32_t parity_symbols)
+{
+    typedef kodo::fft_rs_encoder<fifi::binary16> encoder_t;
+    typedef kodo::fft_rs_decoder<fifi::binary16> decoder_t;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    encoder_factory.set_parity_symbols(parity_symbols);
+    decoder_factory.set_parity_symbols(parity_symbols);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    uint32_t total = symbols + encoder->max_parity_symbols();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<std::vector<uint8_t> > payloads(
+        total, std::vector<uint8_t>(encoder->payload_size()));
+
+    for(auto &payload : payloads)
+    {
+        encoder->encode(&payload[0]);
+    }
+
+    std::random_shuffle(payloads.begin(), payloads.end());
+
+    uint32_t received = 0;
+
+    for(auto &payload : payloads)
+    {
+        if(decoder->is_complete())
+        {
+            break;
+        }
+
+        decoder->decode(&payload[0]);
+        ++received;
+    }
+
+    // The code is MDS, any k symbols decode the block
+    EXPECT_TRUE(decoder->is_complete());
+    EXPECT_EQ(symbols, received);
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestFftReedSolomonCodes, parity_symbols)
+{
+    // The default follows the wide Reed-Solomon code length
+    EXPECT_EQ(245U, kodo::fft_reed_solomon_parity_symbols(10));
+    EXPECT_EQ(1000U, kodo::fft_reed_solomon_parity_symbols(1000));
+
+    // Unless the parity symbols, rounded up to a power of two, and the
+    // source symbols do not fit in the field
+    EXPECT_EQ(16384U, kodo::fft_reed_solomon_parity_symbols(40000));
+    EXPECT_EQ(4096U, kodo::fft_reed_solomon_parity_symbols(60000));
+}
+
+TEST(TestFftReedSolomonCodes, test_encode_decode)
+{
+    test_fft_codes(1, 32, 1);
+    test_fft_codes(10, 32, 4);
+    test_fft_codes(10, 100, 0);
+    test_fft_codes(255, 64, 0);
+    test_fft_codes(1000, 32, 24);
+    test_fft_codes(2, 64, 100);
+
+    // Symbols larger than a tile of the transforms
+    test_fft_codes(20, 40000, 12);
+
+    // An archival code with thousands of symbols
+    test_fft_codes(3000, 16, 1096);
+}
+
+TEST(TestFftReedSolomonCodes, test_parity_symbols)
+{
+    typedef kodo::fft_rs_encoder<fifi::binary16> encoder_t;
+
+    uint32_t symbols = 600;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    EXPECT_EQ(600U, encoder->max_parity_symbols());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    uint32_t count = 5;
+    uint32_t first = 590;
+
+    std::vector<std::vector<uint8_t> > parity(
+        count, std::vector<uint8_t>(symbol_size));
+    std::vector<uint8_t*> parity_ptr;
+
+    for(auto &p : parity)
+    {
+        parity_ptr.push_back(&p[0]);
+    }
+
+    encoder->encode_parity_symbols(&parity_ptr[0], first, count);
+
+    // The parity symbols equal the payloads of their index
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < symbols + first + count; ++i)
+    {
+        encoder->encode(&payload[0]);
+
+        if(i >= symbols + first)
+        {
+            EXPECT_TRUE(std::equal(parity[i - symbols - first].begin(),
+                                   parity[i - symbols - first].end(),
+                                   payload.begin()));
+        }
+    }
+}
+
+TEST(TestFftReedSolomonCodes, test_systematic)
+{
+    invoke_systematic<kodo::fft_rs_encoder<fifi::binary16>,
+                      kodo::fft_rs_decoder<fifi::binary16> >(400, 32);
+}
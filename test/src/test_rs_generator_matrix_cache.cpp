@@ -0,0 +1,151 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rs_generator_matrix_cache.cpp Unit tests for the
+///       process-wide generator matrix cache
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/rs/systematic_vandermonde_matrix.hpp>
+#include <kodo/rs/generator_matrix_cache.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/final_coder_factory.hpp>
+
+namespace kodo
+{
+
+    template<class Field>
+    class shared_vandermonde_stack
+        : public systematic_vandermonde_matrix<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 shared_vandermonde_stack<Field>
+                     > > > >
+    { };
+
+}
+
+/// The cache of the systematic Vandermonde matrices over a field
+template<class Field>
+kodo::generator_matrix_cache<Field, kodo::systematic_vandermonde_matrix_tag>&
+vandermonde_cache()
+{
+    return kodo::generator_matrix_cache<
+        Field, kodo::systematic_vandermonde_matrix_tag>::instance();
+}
+
+/// @return True if the two matrices hold the same elements
+template<class Matrix>
+bool equal_matrices(const Matrix &a, const Matrix &b)
+{
+    if(a.rows() != b.rows() || a.columns() != b.columns())
+        return false;
+
+    for(uint32_t i = 0; i < a.rows(); ++i)
+    {
+        for(uint32_t j = 0; j < a.columns(); ++j)
+        {
+            if(a.element(i, j) != b.element(i, j))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+TEST(TestRsGeneratorMatrixCache, shared_between_factories)
+{
+    typedef kodo::shared_vandermonde_stack<fifi::binary8> stack_type;
+
+    vandermonde_cache<fifi::binary8>().clear();
+
+    stack_type::factory factory_one(20, 100);
+    stack_type::factory factory_two(10, 1600);
+
+    auto matrix_one = factory_one.construct_matrix(10);
+    EXPECT_EQ(1U, vandermonde_cache<fifi::binary8>().size());
+
+    auto matrix_two = factory_two.construct_matrix(10);
+    EXPECT_TRUE(matrix_one == matrix_two);
+    EXPECT_EQ(1U, vandermonde_cache<fifi::binary8>().size());
+
+    // The matrix is systematic
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        for(uint32_t j = 0; j < 10; ++j)
+        {
+            EXPECT_EQ(i == j ? 1U : 0U, matrix_one->element(i, j));
+        }
+    }
+
+    // A new matrix is constructed after clearing the cache
+    vandermonde_cache<fifi::binary8>().clear();
+
+    auto matrix_three = factory_two.construct_matrix(10);
+    EXPECT_FALSE(matrix_one == matrix_three);
+    EXPECT_TRUE(equal_matrices(*matrix_one, *matrix_three));
+
+    factory_one.precompute_matrices(5);
+    EXPECT_EQ(6U, vandermonde_cache<fifi::binary8>().size());
+
+    vandermonde_cache<fifi::binary8>().clear();
+}
+
+TEST(TestRsGeneratorMatrixCache, save_and_load)
+{
+    typedef kodo::shared_vandermonde_stack<fifi::binary8> stack_type;
+
+    std::string filename = "test_rs_generator_matrix_cache.bin";
+
+    vandermonde_cache<fifi::binary8>().clear();
+
+    stack_type::factory factory(32, 100);
+    factory.precompute_matrices(4);
+
+    auto expected = factory.construct_matrix(4);
+
+    EXPECT_TRUE(stack_type::factory::save_matrices(filename));
+
+    vandermonde_cache<fifi::binary8>().clear();
+    EXPECT_EQ(0U, vandermonde_cache<fifi::binary8>().size());
+
+    EXPECT_TRUE(stack_type::factory::load_matrices(filename));
+    EXPECT_EQ(4U, vandermonde_cache<fifi::binary8>().size());
+
+    // The loaded matrix is used without constructing it
+    auto loaded = vandermonde_cache<fifi::binary8>().find(4);
+    ASSERT_TRUE(bool(loaded));
+    EXPECT_TRUE(equal_matrices(*expected, *loaded));
+    EXPECT_TRUE(loaded == factory.construct_matrix(4));
+
+    // A file of another field is rejected
+    EXPECT_FALSE(vandermonde_cache<fifi::binary16>().load(filename));
+    EXPECT_EQ(0U, vandermonde_cache<fifi::binary16>().size());
+
+    // As are missing and truncated files
+    EXPECT_FALSE(stack_type::factory::load_matrices(filename + ".none"));
+
+    {
+        std::ofstream truncated(filename, std::ios::binary);
+        uint32_t header[] = { 0x4b474d31, 1, 3 };
+        truncated.write(reinterpret_cast<const char*>(header),
+                        sizeof(header));
+    }
+
+    vandermonde_cache<fifi::binary8>().clear();
+    EXPECT_FALSE(stack_type::factory::load_matrices(filename));
+    EXPECT_EQ(0U, vandermonde_cache<fifi::binary8>().size());
+
+    std::remove(filename.c_str());
+}
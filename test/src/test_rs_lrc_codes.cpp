@@ -0,0 +1,198 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rs_lrc_codes.cpp Unit tests for the locally repairable
+///       codes
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rs/lrc_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+TEST(TestLrcCodes, test_layout)
+{
+    // Ten symbols in groups of four, the last group has two symbols
+    kodo::lrc_layout layout(10, 4);
+
+    EXPECT_EQ(3U, layout.groups());
+    EXPECT_EQ(13U, layout.first_global_row());
+
+    EXPECT_EQ(2U, layout.group(9));
+    EXPECT_EQ(1U, layout.group(11));
+    EXPECT_EQ(8U, layout.group_begin(2));
+    EXPECT_EQ(10U, layout.group_end(2));
+
+    EXPECT_TRUE(layout.is_local_row(12));
+    EXPECT_FALSE(layout.is_local_row(9));
+    EXPECT_TRUE(layout.is_global_row(13));
+
+    std::vector<uint32_t> rows = {4, 6, 7, 11};
+    EXPECT_TRUE(layout.repair_rows(5) == rows);
+
+    rows = {8, 9};
+    EXPECT_TRUE(layout.repair_rows(12) == rows);
+
+    std::vector<bool> lost(16, false);
+    lost[5] = true;
+    EXPECT_TRUE(layout.is_locally_repairable(5, lost));
+
+    lost[7] = true;
+    EXPECT_FALSE(layout.is_locally_repairable(5, lost));
+    EXPECT_FALSE(layout.is_locally_repairable(14, lost));
+
+    // Symbol 1 is repaired locally, symbols 5 and 7 globally
+    lost[1] = true;
+    std::vector<uint32_t> order = layout.read_order(lost);
+
+    rows = {0, 2, 3, 10};
+    ASSERT_EQ(16U - 3U, order.size());
+    EXPECT_TRUE(std::equal(rows.begin(), rows.end(), order.begin()));
+}
+
+/// Encodes a block and decodes it from the rows which are not lost,
+/// read in the order preferring local repair
+/// @return The number of rows read until the lost source symbols were
+///         decoded
+template<class Field>
+uint32_t test_lrc_repair(uint32_t symbols, uint32_t symbol_size,
+                         const std::vector<uint32_t> &lost_rows)
+{
+    typedef kodo::lrc_encoder<Field> encoder_t;
+    typedef kodo::lrc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    // Without the systematic phase the row of a payload is its position
+    // in the stream
+    kodo::set_systematic_off(encoder);
+
+    kodo::lrc_layout layout = decoder->layout();
+    uint32_t rows = layout.first_global_row() + 2;
+
+    std::vector<std::vector<uint8_t> > payloads(rows);
+
+    for(auto &payload : payloads)
+    {
+        payload.resize(encoder->payload_size());
+        encoder->encode(&payload[0]);
+    }
+
+    // The decoder modifies the payloads, the parities are compared to
+    // the payloads as they were encoded
+    const std::vector<std::vector<uint8_t> > encoded = payloads;
+
+    std::vector<bool> lost(rows, false);
+
+    for(uint32_t row : lost_rows)
+    {
+        lost[row] = true;
+    }
+
+    std::vector<uint32_t> order = layout.read_order(lost);
+    uint32_t read = 0;
+
+    auto repaired = [&]()
+        {
+            for(uint32_t row : lost_rows)
+            {
+                if(row < symbols && !decoder->is_symbol_decoded(row))
+                    return false;
+            }
+            return true;
+        };
+
+    for(uint32_t row : order)
+    {
+        if(repaired())
+            break;
+
+        decoder->decode(&payloads[row][0]);
+        ++read;
+    }
+
+    EXPECT_TRUE(repaired());
+
+    for(uint32_t row : lost_rows)
+    {
+        if(row >= symbols)
+            continue;
+
+        EXPECT_TRUE(std::equal(
+            decoder->symbol(row), decoder->symbol(row) + symbol_size,
+            &data_in[row * symbol_size]));
+    }
+
+    // The parities computed in one pass match the encoded payloads
+    uint32_t parities = rows - symbols;
+
+    std::vector<std::vector<uint8_t> > parity(
+        parities, std::vector<uint8_t>(symbol_size));
+    std::vector<uint8_t*> parity_ptr;
+
+    for(auto &p : parity)
+    {
+        parity_ptr.push_back(&p[0]);
+    }
+
+    encoder->encode_parity_symbols(&parity_ptr[0], 0, parities);
+
+    for(uint32_t i = 0; i < parities; ++i)
+    {
+        EXPECT_TRUE(std::equal(parity[i].begin(), parity[i].end(),
+                               encoded[symbols + i].begin()));
+    }
+
+    return read;
+}
+
+TEST(TestLrcCodes, test_local_repair)
+{
+    // A symbol lost alone in its group is repaired from the four other
+    // rows of the group
+    std::vector<uint32_t> lost = {5};
+    EXPECT_EQ(4U, test_lrc_repair<fifi::binary8>(16, 160, lost));
+
+    lost = {0, 9, 15};
+    EXPECT_EQ(12U, test_lrc_repair<fifi::binary8>(16, 160, lost));
+
+    // The local parities may be lost
+    lost = {3, 17};
+    EXPECT_EQ(4U, test_lrc_repair<fifi::binary16>(16, 160, lost));
+}
+
+TEST(TestLrcCodes, test_global_repair)
+{
+    // Two symbols of one group need the global parities
+    std::vector<uint32_t> lost = {4, 6};
+    EXPECT_LE(16U, test_lrc_repair<fifi::binary8>(16, 160, lost));
+
+    lost = {0, 1, 20};
+    EXPECT_LE(16U, test_lrc_repair<fifi::binary8>(18, 160, lost));
+}
+
+TEST(TestLrcCodes, test_encode_decode)
+{
+    typedef kodo::lrc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::lrc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = rand_symbols(200);
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_systematic<encoder_t, decoder_t>(symbols, symbol_size);
+}
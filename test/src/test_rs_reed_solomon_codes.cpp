@@ -79,3 +79,240 @@ TEST(TestReedSolomonCodes, test_encode_decode)
 
 }
 
+
+/// Decodes a number of blocks through the rs_inverse_decoder where the
+/// payloads produced from the listed rows are erased
+/// @return The number of decoding matrices cached by the factory
+template<class Field>
+uint32_t test_inverse_decoder(uint32_t symbols, uint32_t symbol_size,
+                              const std::vector<uint32_t> &erased,
+                              uint32_t blocks)
+{
+    typedef kodo::rs_encoder<Field> encoder_t;
+    typedef kodo::rs_inverse_decoder<Field> decoder_t;
+
+    static typename encoder_t::factory encoder_factory(
+        Field::order - 2, 1600);
+
+    static typename decoder_t::factory decoder_factory(
+        Field::order - 2, 1600);
+
+    encoder_factory.set_symbols(symbols);
+    encoder_factory.set_symbol_size(symbol_size);
+
+    decoder_factory.set_symbols(symbols);
+    decoder_factory.set_symbol_size(symbol_size);
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        auto encoder = encoder_factory.build();
+        auto decoder = decoder_factory.build();
+
+        EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+        std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+        encoder->set_symbols(sak::storage(data_in));
+
+        // Without the systematic phase the row of a payload is its
+        // position in the stream
+        kodo::set_systematic_off(encoder);
+
+        uint32_t row = 0;
+
+        while(!decoder->is_complete())
+        {
+            if(row == Field::order - 1)
+            {
+                ADD_FAILURE() << "the rows of the code are exhausted";
+                break;
+            }
+
+            encoder->encode(&payload[0]);
+
+            if(std::find(erased.begin(), erased.end(), row) ==
+               erased.end())
+            {
+                decoder->decode(&payload[0]);
+            }
+
+            ++row;
+        }
+
+        EXPECT_EQ(symbols, decoder->rank());
+
+        std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+        decoder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_in == data_out);
+    }
+
+    return decoder_factory.cached_inverses();
+}
+
+TEST(TestReedSolomonCodes, test_inverse_decoder)
+{
+    // Nothing erased, no inversion needed
+    EXPECT_EQ(0U, test_inverse_decoder<fifi::binary8>(
+                  10, 100, std::vector<uint32_t>(), 3));
+
+    // The same erasure pattern reuses a single decoding matrix
+    std::vector<uint32_t> erased = {0, 3, 4, 11};
+
+    EXPECT_EQ(1U, test_inverse_decoder<fifi::binary8>(
+                  10, 100, erased, 10));
+
+    erased = {9};
+
+    EXPECT_EQ(2U, test_inverse_decoder<fifi::binary8>(
+                  10, 100, erased, 5));
+
+    // All source symbols erased
+    erased = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    EXPECT_EQ(3U, test_inverse_decoder<fifi::binary8>(
+                  10, 100, erased, 2));
+
+    uint32_t symbols = rand_symbols(100);
+    uint32_t symbol_size = rand_symbol_size();
+
+    erased.clear();
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        if(rand() % 2)
+        {
+            erased.push_back(i);
+        }
+    }
+
+    test_inverse_decoder<fifi::binary8>(symbols, symbol_size, erased, 3);
+}
+
+TEST(TestReedSolomonCodes, test_inverse_decoder_basic_api)
+{
+    uint32_t symbols = rand_symbols(255);
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::rs_encoder<fifi::binary8>,
+                     kodo::rs_inverse_decoder<fifi::binary8> >(
+                         symbols, symbol_size);
+
+    invoke_systematic<kodo::rs_encoder<fifi::binary8>,
+                      kodo::rs_inverse_decoder<fifi::binary8> >(
+                          symbols, symbol_size);
+}
+
+/// Checks that the parity symbols computed in one pass are the symbols
+/// coded one at a time after the systematic symbols
+template<class Field>
+void test_parity_symbols(uint32_t symbols, uint32_t symbol_size,
+                         uint32_t first, uint32_t count)
+{
+    typedef kodo::rs_encoder<Field> encoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    EXPECT_EQ(Field::order - 1 - symbols, encoder->max_parity_symbols());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<std::vector<uint8_t> > parity(
+        count, std::vector<uint8_t>(encoder->symbol_size(), 'x'));
+
+    std::vector<uint8_t*> parity_symbols;
+    for(uint32_t j = 0; j < count; ++j)
+        parity_symbols.push_back(&parity[j][0]);
+
+    encoder->encode_parity_symbols(&parity_symbols[0], first, count);
+
+    // With the systematic phase off, symbol i is coded with row i of
+    // the generator matrix
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < symbols + first + count; ++i)
+    {
+        encoder->encode(&payload[0]);
+
+        if(i < symbols + first)
+            continue;
+
+        std::vector<uint8_t> expected(
+            payload.begin(), payload.begin() + encoder->symbol_size());
+
+        EXPECT_TRUE(expected == parity[i - symbols - first]);
+    }
+}
+
+TEST(TestReedSolomonCodes, test_parity_symbols)
+{
+    test_parity_symbols<fifi::binary8>(10, 1600, 0, 4);
+    test_parity_symbols<fifi::binary8>(10, 16, 3, 2);
+
+    // Symbols of several tiles with a partial last tile
+    test_parity_symbols<fifi::binary8>(32, 10000, 0, 8);
+
+    uint32_t symbols = rand_symbols(200);
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_parity_symbols<fifi::binary8>(symbols, symbol_size, 0,
+                                       std::min(20U, 255U - symbols));
+}
+
+/// Checks that parity symbols updated after a small write are those
+/// computed from the changed block
+TEST(TestReedSolomonCodes, test_update_parity_symbols)
+{
+    typedef kodo::rs_encoder<fifi::binary8> encoder_t;
+
+    uint32_t symbols = 10;
+    uint32_t symbol_size = 1600;
+    uint32_t parities = 4;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<std::vector<uint8_t> > parity(
+        parities, std::vector<uint8_t>(symbol_size));
+
+    std::vector<uint8_t*> parity_symbols;
+    for(uint32_t j = 0; j < parities; ++j)
+        parity_symbols.push_back(&parity[j][0]);
+
+    encoder->encode_parity_symbols(&parity_symbols[0], 0, parities);
+
+    // Overwrite 16 bytes of symbol 3, the delta is zero elsewhere
+    uint32_t index = 3;
+    std::vector<uint8_t> delta(symbol_size, 0);
+
+    for(uint32_t i = 100; i < 116; ++i)
+    {
+        uint8_t value = static_cast<uint8_t>(rand());
+        delta[i] = data_in[index * symbol_size + i] ^ value;
+        data_in[index * symbol_size + i] = value;
+    }
+
+    encoder->update_parity_symbols(&parity_symbols[0], 0, parities,
+                                   index, &delta[0]);
+
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<std::vector<uint8_t> > expected(
+        parities, std::vector<uint8_t>(symbol_size));
+
+    std::vector<uint8_t*> expected_symbols;
+    for(uint32_t j = 0; j < parities; ++j)
+        expected_symbols.push_back(&expected[j][0]);
+
+    encoder->encode_parity_symbols(&expected_symbols[0], 0, parities);
+
+    EXPECT_TRUE(expected == parity);
+}
@@ -0,0 +1,152 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_rs_wide_reed_solomon_codes.cpp Unit tests for the
+///       Reed-Solomon codes with generations above 255 symbols
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rs/reed_solomon_codes.hpp>
+#include <kodo/rs/wide_reed_solomon_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes and decodes a block without the systematic phase, where
+/// the first payloads are erased
+template<class Encoder, class Decoder>
+void test_wide_codes(uint32_t symbols, uint32_t symbol_size,
+                     uint32_t erased)
+{
+    typename Encoder::factory encoder_factory(symbols, symbol_size);
+    typename Decoder::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+
+    encoder->set_symbols(sak::storage(data_in));
+    kodo::set_systematic_off(encoder);
+
+    uint32_t rows = encoder->max_parity_symbols() + symbols;
+    uint32_t row = 0;
+
+    while(!decoder->is_complete())
+    {
+        ASSERT_TRUE(row < rows);
+
+        encoder->encode(&payload[0]);
+
+        if(row >= erased)
+        {
+            decoder->decode(&payload[0]);
+        }
+
+        ++row;
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestWideReedSolomonCodes, code_length)
+{
+    // The small fields keep the full length
+    EXPECT_EQ(255U, kodo::reed_solomon_code_length<fifi::binary8>(1));
+    EXPECT_EQ(255U, kodo::reed_solomon_code_length<fifi::binary8>(254));
+    EXPECT_EQ(15U, kodo::reed_solomon_code_length<fifi::binary4>(10));
+
+    // The code length over binary16 is twice the symbols, but at
+    // least the binary8 length
+    EXPECT_EQ(255U, kodo::reed_solomon_code_length<fifi::binary16>(10));
+    EXPECT_EQ(255U, kodo::reed_solomon_code_length<fifi::binary16>(127));
+    EXPECT_EQ(2000U,
+              kodo::reed_solomon_code_length<fifi::binary16>(1000));
+    EXPECT_EQ(65535U,
+              kodo::reed_solomon_code_length<fifi::binary16>(40000));
+}
+
+TEST(TestWideReedSolomonCodes, test_encode_decode)
+{
+    typedef kodo::wide_rs_encoder<fifi::binary16> encoder_t;
+    typedef kodo::wide_rs_decoder<fifi::binary16> decoder_t;
+
+    test_wide_codes<encoder_t, decoder_t>(10, 32, 0);
+    test_wide_codes<encoder_t, decoder_t>(300, 64, 150);
+
+    // Only parity symbols received
+    test_wide_codes<encoder_t, decoder_t>(256, 32, 256);
+    test_wide_codes<encoder_t, decoder_t>(1000, 32, 1000);
+}
+
+TEST(TestWideReedSolomonCodes, test_parity_symbols)
+{
+    typedef kodo::wide_rs_encoder<fifi::binary16> encoder_t;
+
+    uint32_t symbols = 600;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    EXPECT_EQ(600U, encoder->max_parity_symbols());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    uint32_t count = 5;
+    uint32_t first = 590;
+
+    std::vector<std::vector<uint8_t> > parity(
+        count, std::vector<uint8_t>(symbol_size));
+    std::vector<uint8_t*> parity_ptr;
+
+    for(auto &p : parity)
+    {
+        parity_ptr.push_back(&p[0]);
+    }
+
+    encoder->encode_parity_symbols(&parity_ptr[0], first, count);
+
+    // The parity symbols equal the payloads of their rows
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < symbols + first + count; ++i)
+    {
+        encoder->encode(&payload[0]);
+
+        if(i >= symbols + first)
+        {
+            EXPECT_TRUE(std::equal(parity[i - symbols - first].begin(),
+                                   parity[i - symbols - first].end(),
+                                   payload.begin()));
+        }
+    }
+}
+
+TEST(TestWideReedSolomonCodes, test_systematic)
+{
+    invoke_systematic<kodo::wide_rs_encoder<fifi::binary16>,
+                      kodo::wide_rs_decoder<fifi::binary16> >(400, 32);
+}
+
+TEST(TestWideReedSolomonCodes, test_vandermonde_binary16)
+{
+    // The systematic Vandermonde codes also support binary16 with the
+    // shortened code length
+    test_wide_codes<kodo::rs_encoder<fifi::binary16>,
+                    kodo::rs_decoder<fifi::binary16> >(20, 32, 10);
+}
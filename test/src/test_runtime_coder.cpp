@@ -0,0 +1,121 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_runtime_coder.cpp Unit test for the runtime_encoder and
+///       runtime_decoder interfaces
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/runtime_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Encodes and decodes a block in batches through the runtime
+/// interfaces
+void test_runtime_coder(kodo::runtime_code code, kodo::runtime_field field,
+                        uint32_t symbols, uint32_t symbol_size)
+{
+    auto encoder_factory = kodo::make_runtime_encoder_factory(
+        code, field, symbols, symbol_size);
+
+    auto decoder_factory = kodo::make_runtime_decoder_factory(
+        code, field, symbols, symbol_size);
+
+    ASSERT_TRUE((bool) encoder_factory);
+    ASSERT_TRUE((bool) decoder_factory);
+
+    EXPECT_EQ(symbols, encoder_factory->max_symbols());
+    EXPECT_EQ(symbol_size, encoder_factory->max_symbol_size());
+    EXPECT_EQ(encoder_factory->max_payload_size(),
+              decoder_factory->max_payload_size());
+
+    auto encoder = encoder_factory->build();
+    auto decoder = decoder_factory->build();
+
+    EXPECT_EQ(symbols, encoder->symbols());
+    EXPECT_EQ(symbol_size, decoder->symbol_size());
+    EXPECT_EQ(encoder->block_size(), decoder->block_size());
+    EXPECT_EQ(encoder->payload_size(), decoder->payload_size());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    EXPECT_EQ(symbols, encoder->rank());
+
+    const uint32_t batch = 4;
+
+    std::vector<std::vector<uint8_t> > buffers(
+        batch, std::vector<uint8_t>(encoder->payload_size()));
+
+    std::vector<uint8_t*> payloads(batch);
+    std::vector<uint32_t> bytes_used(batch);
+
+    for(uint32_t i = 0; i < batch; ++i)
+    {
+        payloads[i] = &buffers[i][0];
+    }
+
+    uint32_t encoded = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payloads[0], batch, &bytes_used[0]);
+
+        for(uint32_t i = 0; i < batch; ++i)
+        {
+            EXPECT_TRUE(bytes_used[i] > 0);
+            EXPECT_TRUE(bytes_used[i] <= encoder->payload_size());
+        }
+
+        decoder->decode(&payloads[0], batch);
+
+        encoded += batch;
+        ASSERT_TRUE(encoded < symbols * 100);
+    }
+
+    EXPECT_EQ(symbols, decoder->rank());
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestRuntimeCoder, encode_decode)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_runtime_coder(kodo::runtime_code::full_rlnc,
+                       kodo::runtime_field::binary, symbols, symbol_size);
+    test_runtime_coder(kodo::runtime_code::full_rlnc,
+                       kodo::runtime_field::binary8, symbols, symbol_size);
+    test_runtime_coder(kodo::runtime_code::full_rlnc,
+                       kodo::runtime_field::binary16, symbols, symbol_size);
+
+    test_runtime_coder(kodo::runtime_code::seed_rlnc,
+                       kodo::runtime_field::binary, symbols, symbol_size);
+    test_runtime_coder(kodo::runtime_code::seed_rlnc,
+                       kodo::runtime_field::binary8, symbols, symbol_size);
+    test_runtime_coder(kodo::runtime_code::seed_rlnc,
+                       kodo::runtime_field::binary16, symbols, symbol_size);
+
+    test_runtime_coder(kodo::runtime_code::reed_solomon,
+                       kodo::runtime_field::binary8, symbols, symbol_size);
+}
+
+TEST(TestRuntimeCoder, unsupported_field)
+{
+    EXPECT_FALSE((bool) kodo::make_runtime_encoder_factory(
+                     kodo::runtime_code::reed_solomon,
+                     kodo::runtime_field::binary16, 10, 100));
+
+    EXPECT_FALSE((bool) kodo::make_runtime_decoder_factory(
+                     kodo::runtime_code::reed_solomon,
+                     kodo::runtime_field::binary, 10, 100));
+}
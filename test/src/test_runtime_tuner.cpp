@@ -0,0 +1,191 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_runtime_tuner.cpp Unit tests for the runtime_tuner and
+///       the runtime_profile
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/runtime_tuner.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+TEST(TestRuntimeTuner, profile_roundtrip)
+{
+    kodo::runtime_profile profile;
+    profile.m_code = kodo::runtime_code::seed_rlnc;
+    profile.m_field = kodo::runtime_field::binary16;
+    profile.m_symbols = 64;
+    profile.m_symbol_size = 700;
+    profile.m_goodput = 1.5e8;
+    profile.m_latency = 0.25;
+
+    std::stringstream stream;
+    kodo::write_runtime_profile(stream, profile);
+
+    kodo::runtime_profile read;
+    EXPECT_TRUE(kodo::read_runtime_profile(stream, read));
+
+    EXPECT_TRUE(read.m_code == kodo::runtime_code::seed_rlnc);
+    EXPECT_TRUE(read.m_field == kodo::runtime_field::binary16);
+    EXPECT_EQ(64U, read.m_symbols);
+    EXPECT_EQ(700U, read.m_symbol_size);
+    EXPECT_DOUBLE_EQ(1.5e8, read.m_goodput);
+    EXPECT_DOUBLE_EQ(0.25, read.m_latency);
+
+    // Missing keys keep their value
+    std::stringstream partial("symbols 10\n");
+    EXPECT_TRUE(kodo::read_runtime_profile(partial, read));
+    EXPECT_EQ(10U, read.m_symbols);
+    EXPECT_EQ(700U, read.m_symbol_size);
+
+    // Invalid profiles leave the profile unchanged
+    std::stringstream unknown_field("field binary7\nsymbols 3\n");
+    EXPECT_FALSE(kodo::read_runtime_profile(unknown_field, read));
+    EXPECT_EQ(10U, read.m_symbols);
+
+    std::stringstream unknown_key("symbol 3\n");
+    EXPECT_FALSE(kodo::read_runtime_profile(unknown_key, read));
+
+    std::stringstream zero_symbols("symbols 0\n");
+    EXPECT_FALSE(kodo::read_runtime_profile(zero_symbols, read));
+    EXPECT_EQ(10U, read.m_symbols);
+}
+
+TEST(TestRuntimeTuner, profile_file)
+{
+    std::string path = testing::TempDir() + "kodo_runtime_profile.txt";
+
+    kodo::runtime_profile profile;
+    profile.m_code = kodo::runtime_code::reed_solomon;
+    profile.m_symbols = 20;
+
+    EXPECT_TRUE(kodo::save_runtime_profile(path, profile));
+
+    kodo::runtime_profile loaded;
+    EXPECT_TRUE(kodo::load_runtime_profile(path, loaded));
+    EXPECT_TRUE(loaded.m_code == kodo::runtime_code::reed_solomon);
+    EXPECT_EQ(20U, loaded.m_symbols);
+
+    std::remove(path.c_str());
+    EXPECT_FALSE(kodo::load_runtime_profile(path, loaded));
+
+    // The factories of the loaded profile
+    auto encoder_factory = kodo::make_runtime_encoder_factory(loaded);
+    auto decoder_factory = kodo::make_runtime_decoder_factory(loaded);
+    ASSERT_TRUE((bool) encoder_factory);
+    ASSERT_TRUE((bool) decoder_factory);
+    EXPECT_EQ(20U, encoder_factory->max_symbols());
+    EXPECT_EQ(loaded.m_symbol_size, decoder_factory->max_symbol_size());
+}
+
+TEST(TestRuntimeTuner, default_candidates)
+{
+    kodo::runtime_tuner tuner;
+    tuner.add_default_candidates(512, 1024);
+
+    // 6 generation sizes, 3 symbol sizes, 6 RLNC and 1 RS
+    // configuration for the 4 generation sizes below 256
+    EXPECT_EQ(6U * 3U * 6U + 4U * 3U, tuner.candidates().size());
+
+    for(const auto &candidate : tuner.candidates())
+    {
+        EXPECT_TRUE(candidate.m_symbols >= 16);
+        EXPECT_TRUE(candidate.m_symbols <= 512);
+        EXPECT_TRUE(candidate.m_symbol_size >= 256);
+        EXPECT_TRUE(candidate.m_symbol_size <= 1024);
+    }
+}
+
+TEST(TestRuntimeTuner, tune)
+{
+    kodo::runtime_tuner tuner;
+    tuner.set_calibration_time(0.001);
+    tuner.set_loss_rate(0.1);
+
+    tuner.add_candidate(kodo::runtime_code::full_rlnc,
+                        kodo::runtime_field::binary, 16, 200);
+    tuner.add_candidate(kodo::runtime_code::seed_rlnc,
+                        kodo::runtime_field::binary8, 32, 100);
+    tuner.add_candidate(kodo::runtime_code::reed_solomon,
+                        kodo::runtime_field::binary8, 8, 400);
+
+    // Not supported and skipped
+    tuner.add_candidate(kodo::runtime_code::reed_solomon,
+                        kodo::runtime_field::binary16, 8, 400);
+
+    kodo::runtime_profile profile;
+    ASSERT_TRUE(tuner.tune(profile));
+    ASSERT_EQ(3U, tuner.results().size());
+
+    for(const auto &result : tuner.results())
+    {
+        EXPECT_TRUE(result.m_goodput > 0);
+        EXPECT_TRUE(result.m_latency > 0);
+        EXPECT_TRUE(result.m_goodput <= profile.m_goodput);
+    }
+
+    // The chosen profile codes data through the runtime factories
+    auto encoder = kodo::make_runtime_encoder_factory(profile)->build();
+    auto decoder = kodo::make_runtime_decoder_factory(profile)->build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    uint8_t *payloads = &payload[0];
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payloads, 1);
+        decoder->decode(&payloads, 1);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestRuntimeTuner, constraints)
+{
+    kodo::runtime_tuner tuner;
+    tuner.set_calibration_time(0.001);
+
+    tuner.add_candidate(kodo::runtime_code::full_rlnc,
+                        kodo::runtime_field::binary8, 16, 1000);
+    tuner.add_candidate(kodo::runtime_code::full_rlnc,
+                        kodo::runtime_field::binary8, 1, 10);
+
+    // The link limits the goodput and adds the time to send the
+    // payloads to the latency
+    double link_rate = 1000.0;
+    tuner.set_link_rate(link_rate);
+
+    kodo::runtime_profile profile;
+    ASSERT_TRUE(tuner.tune(profile));
+
+    for(const auto &result : tuner.results())
+    {
+        EXPECT_TRUE(result.m_goodput <= link_rate);
+        EXPECT_TRUE(result.m_latency >=
+                    result.m_symbols * result.m_symbol_size / link_rate);
+    }
+
+    // Only the small generation is sent within the latency
+    tuner.set_max_latency(1.0);
+    ASSERT_TRUE(tuner.tune(profile));
+    EXPECT_EQ(1U, profile.m_symbols);
+
+    // No candidate is fast enough
+    tuner.set_max_latency(1e-3);
+    profile.m_symbols = 5;
+    EXPECT_FALSE(tuner.tune(profile));
+    EXPECT_EQ(5U, profile.m_symbols);
+}
@@ -0,0 +1,234 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_send_scheduler.cpp Unit tests for the send scheduler
+
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/send_scheduler.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    typedef kodo::send_scheduler<encoder_t::pointer> scheduler_t;
+
+    typedef scheduler_t::time_point time_point;
+}
+
+/// A payload waits until the bucket holds its size
+TEST(TestSendScheduler, token_bucket)
+{
+    time_point now = scheduler_t::clock_type::now();
+
+    // 1000 bytes per second
+    kodo::token_bucket bucket(1000, 100, now);
+
+    EXPECT_TRUE(bucket.is_ready(100));
+    bucket.consume(60);
+
+    EXPECT_TRUE(bucket.is_ready(40));
+    EXPECT_FALSE(bucket.is_ready(50));
+
+    time_point ready = bucket.ready_time(now, 50);
+    EXPECT_GT(ready, now + std::chrono::microseconds(9900));
+    EXPECT_LE(ready, now + std::chrono::microseconds(10100));
+
+    bucket.refill(now + std::chrono::milliseconds(10));
+    EXPECT_TRUE(bucket.is_ready(50));
+
+    // A payload larger than the burst is sent once the bucket is full
+    bucket.consume(50);
+    EXPECT_FALSE(bucket.is_ready(1000));
+
+    bucket.refill(now + std::chrono::milliseconds(110));
+    EXPECT_TRUE(bucket.is_ready(1000));
+}
+
+/// The sessions share the link in proportion to their weights
+TEST(TestSendScheduler, weighted_fair_queuing)
+{
+    encoder_t::factory factory(16, 100);
+
+    auto a = factory.build();
+    auto b = factory.build();
+
+    std::vector<uint8_t> data = random_vector(a->block_size());
+    a->set_symbols(sak::storage(data));
+    b->set_symbols(sak::storage(data));
+
+    // The systematic payloads are smaller than payload_size()
+    a->set_systematic_off();
+    b->set_systematic_off();
+
+    time_point now = scheduler_t::clock_type::now();
+    scheduler_t scheduler(factory.max_payload_size(), 0, 0, now);
+
+    uint32_t id_a = scheduler.add_session(a, 1);
+    uint32_t id_b = scheduler.add_session(b, 3);
+
+    EXPECT_EQ(2U, scheduler.sessions());
+
+    std::map<uint32_t, uint32_t> sent;
+
+    uint32_t count = scheduler.send(now,
+        [&](uint32_t id, const uint8_t*, uint32_t size)
+        {
+            EXPECT_EQ(a->payload_size(), size);
+            ++sent[id];
+        }, 400);
+
+    EXPECT_EQ(400U, count);
+    EXPECT_NEAR(100, sent[id_a], 1);
+    EXPECT_NEAR(300, sent[id_b], 1);
+
+    // A session added later does not catch up on the earlier payloads
+    auto c = factory.build();
+    c->set_symbols(sak::storage(data));
+    c->set_systematic_off();
+
+    uint32_t id_c = scheduler.add_session(c, 1);
+    sent.clear();
+
+    scheduler.send(now, [&](uint32_t id, const uint8_t*, uint32_t)
+        { ++sent[id]; }, 50);
+
+    EXPECT_NEAR(10, sent[id_a], 1);
+    EXPECT_NEAR(30, sent[id_b], 1);
+    EXPECT_NEAR(10, sent[id_c], 1);
+
+    EXPECT_TRUE(scheduler.remove_session(id_b));
+    EXPECT_FALSE(scheduler.remove_session(id_b));
+    EXPECT_EQ(2U, scheduler.sessions());
+}
+
+/// The link is paced by its token bucket
+TEST(TestSendScheduler, pacing)
+{
+    encoder_t::factory factory(16, 100);
+
+    auto encoder = factory.build();
+
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    // Every payload is coded and of payload_size() bytes
+    encoder->set_systematic_off();
+
+    uint32_t payload_size = encoder->payload_size();
+
+    // One payload per millisecond
+    time_point now = scheduler_t::clock_type::now();
+    scheduler_t scheduler(factory.max_payload_size(),
+                          1000 * payload_size, payload_size, now);
+
+    scheduler.add_session(encoder);
+
+    auto ignore = [](uint32_t, const uint8_t*, uint32_t) { };
+
+    EXPECT_EQ(1U, scheduler.send(now, ignore));
+    EXPECT_EQ(0U, scheduler.send(now, ignore));
+
+    time_point next = scheduler.next_send_time(now);
+    EXPECT_GT(next, now);
+    EXPECT_LE(next, now + std::chrono::microseconds(1100));
+
+    uint32_t sent = 0;
+
+    for(uint32_t i = 1; i <= 100; ++i)
+    {
+        sent += scheduler.send(now + std::chrono::milliseconds(i), ignore);
+    }
+
+    EXPECT_EQ(100U, sent);
+
+    // Idle time does not accumulate beyond the burst
+    now += std::chrono::seconds(2);
+    EXPECT_EQ(1U, scheduler.send(now, ignore));
+
+    // A session limited to half the link leaves the rest to the others
+    auto limited = factory.build();
+    limited->set_symbols(sak::storage(data));
+    limited->set_systematic_off();
+
+    uint32_t id = scheduler.add_session(
+        limited, 100, scheduler_t::unlimited, 500 * payload_size,
+        payload_size, now);
+
+    std::map<uint32_t, uint32_t> count;
+
+    for(uint32_t i = 1; i <= 100; ++i)
+    {
+        scheduler.send(now + std::chrono::milliseconds(i),
+            [&](uint32_t session, const uint8_t*, uint32_t)
+            { ++count[session]; });
+    }
+
+    EXPECT_NEAR(50, count[id], 2);
+    EXPECT_EQ(100U, count[0] + count[id]);
+}
+
+/// The payloads are encoded when sent and the sessions are removed when
+/// their budget is used
+TEST(TestSendScheduler, budget)
+{
+    uint32_t symbols = 16;
+
+    encoder_t::factory encoder_factory(symbols, 100);
+    decoder_t::factory decoder_factory(symbols, 100);
+
+    time_point now = scheduler_t::clock_type::now();
+    scheduler_t scheduler(encoder_factory.max_payload_size(), 0, 0, now);
+
+    std::vector<std::vector<uint8_t> > data;
+    std::vector<decoder_t::pointer> decoders;
+    std::vector<encoder_t::pointer> encoders;
+
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        encoders.push_back(encoder_factory.build());
+        decoders.push_back(decoder_factory.build());
+
+        data.push_back(random_vector(encoders[i]->block_size()));
+        encoders[i]->set_symbols(sak::storage(data[i]));
+
+        // The systematic symbols need no redundancy
+        EXPECT_EQ(i, scheduler.add_session(encoders[i], 1, symbols));
+    }
+
+    scheduler.set_budget(2, symbols / 2);
+
+    uint32_t sent = scheduler.send(now,
+        [&](uint32_t id, const uint8_t *payload, uint32_t size)
+        {
+            std::vector<uint8_t> copy(payload, payload + size);
+            decoders[id]->decode(&copy[0]);
+        });
+
+    EXPECT_EQ(2 * symbols + symbols / 2, sent);
+    EXPECT_EQ(0U, scheduler.sessions());
+    EXPECT_TRUE(scheduler.next_send_time(now) == time_point::max());
+
+    for(uint32_t i = 0; i < 2; ++i)
+    {
+        ASSERT_TRUE(decoders[i]->is_complete());
+
+        std::vector<uint8_t> data_out(decoders[i]->block_size());
+        decoders[i]->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == data[i]);
+    }
+
+    EXPECT_EQ(symbols / 2, decoders[2]->rank());
+}
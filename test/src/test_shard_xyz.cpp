@@ -0,0 +1,190 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_shard_xyz.cpp Unit tests for the shard_encoder,
+///       shard_decoder and stripe_partitioning_scheme
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <gtest/gtest.h>
+
+#include <kodo/block_executor.hpp>
+#include <kodo/file_writer.hpp>
+#include <kodo/shard_decoder.hpp>
+#include <kodo/shard_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/stripe_partitioning_scheme.hpp>
+#include <kodo/rs/reed_solomon_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+TEST(TestShard, stripe_partitioning_scheme)
+{
+    kodo::stripe_partitioning_scheme partitioning(10, 100, 2500);
+
+    EXPECT_EQ(3U, partitioning.blocks());
+    EXPECT_EQ(30U, partitioning.total_symbols());
+
+    for(uint32_t i = 0; i < partitioning.blocks(); ++i)
+    {
+        EXPECT_EQ(10U, partitioning.symbols(i));
+        EXPECT_EQ(100U, partitioning.symbol_size(i));
+        EXPECT_EQ(i * 1000U, partitioning.byte_offset(i));
+    }
+
+    EXPECT_EQ(1000U, partitioning.bytes_used(1));
+    EXPECT_EQ(500U, partitioning.bytes_used(2));
+}
+
+/// Writes the shards of an object, loses some of them and reconstructs
+/// the object from the rest
+/// @param lost The shards which are lost
+/// @return True if the object was reconstructed
+template<class Decoder>
+bool test_shards(uint32_t data_shards, uint32_t parity_shards,
+                 uint32_t symbol_size, uint32_t object_size,
+                 const std::vector<uint32_t> &lost)
+{
+    typedef kodo::rs_encoder<fifi::binary8> encoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+
+    typedef kodo::shard_encoder<storage_reader, encoder_t> shard_encoder;
+    typedef kodo::shard_decoder<Decoder> shard_decoder;
+
+    kodo::block_executor executor(4);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    std::vector<std::string> shards;
+
+    for(uint32_t i = 0; i < data_shards + parity_shards; ++i)
+    {
+        shards.push_back("shard-" + std::to_string(i));
+    }
+
+    {
+        encoder_t::factory encoder_factory(data_shards, symbol_size);
+
+        shard_encoder encoder(encoder_factory,
+                              storage_reader(sak::storage(data_in)),
+                              parity_shards, executor, 3);
+
+        EXPECT_EQ(data_shards + parity_shards, encoder.shards());
+
+        encoder.write(shards);
+
+        for(const auto &shard : shards)
+        {
+            EXPECT_EQ(encoder.shard_size(),
+                      boost::filesystem::file_size(shard));
+        }
+    }
+
+    // The data is stored uncoded in the data shards
+    {
+        std::ifstream shard(shards[0], std::ios::binary);
+        std::vector<uint8_t> symbol(symbol_size);
+        shard.read(reinterpret_cast<char*>(&symbol[0]), symbol_size);
+
+        uint32_t size = std::min(symbol_size, object_size);
+
+        EXPECT_TRUE(std::equal(symbol.begin(), symbol.begin() + size,
+                               data_in.begin()));
+    }
+
+    // A lost shard is either missing or given without a name
+    for(uint32_t i = 0; i < lost.size(); ++i)
+    {
+        boost::filesystem::remove(shards[lost[i]]);
+
+        if(i % 2)
+        {
+            shards[lost[i]].clear();
+        }
+    }
+
+    std::string decode_filename = "decode-shards";
+    bool decoded = false;
+
+    {
+        typename Decoder::factory decoder_factory(
+            data_shards, symbol_size);
+
+        shard_decoder decoder(decoder_factory, object_size,
+                              parity_shards, executor, 2);
+
+        kodo::file_writer<Decoder> writer(decode_filename, object_size);
+
+        decoded = decoder.decode(shards, writer);
+    }
+
+    if(decoded)
+    {
+        std::ifstream decode_file(decode_filename, std::ios::binary);
+        std::vector<uint8_t> data_out(object_size);
+        decode_file.read(reinterpret_cast<char*>(&data_out[0]),
+                         object_size);
+
+        EXPECT_TRUE(data_in == data_out);
+    }
+
+    for(const auto &shard : shards)
+    {
+        if(!shard.empty())
+        {
+            boost::filesystem::remove(shard);
+        }
+    }
+
+    boost::filesystem::remove(decode_filename);
+
+    return decoded;
+}
+
+TEST(TestShard, encode_decode)
+{
+    typedef kodo::rs_decoder<fifi::binary8> rs_decoder;
+    typedef kodo::rs_inverse_decoder<fifi::binary8> rs_inverse_decoder;
+
+    std::vector<uint32_t> lost;
+
+    EXPECT_TRUE(test_shards<rs_decoder>(8, 4, 100, 12345, lost));
+
+    lost = {1, 5, 8, 11};
+    EXPECT_TRUE(test_shards<rs_decoder>(8, 4, 100, 12345, lost));
+    EXPECT_TRUE(test_shards<rs_inverse_decoder>(8, 4, 100, 12345, lost));
+
+    lost = {0, 1, 2};
+    EXPECT_TRUE(test_shards<rs_inverse_decoder>(6, 3, 64, 50, lost));
+
+    // Too many shards lost
+    lost = {0, 2, 4, 6, 9};
+    EXPECT_FALSE(test_shards<rs_decoder>(8, 4, 100, 12345, lost));
+
+    uint32_t data_shards = rand_symbols(20);
+    uint32_t parity_shards = rand_nonzero(4);
+    uint32_t object_size = rand_nonzero(100000);
+
+    lost.clear();
+
+    for(uint32_t i = 0; i < parity_shards; ++i)
+    {
+        uint32_t shard = rand() % (data_shards + parity_shards);
+
+        if(std::find(lost.begin(), lost.end(), shard) == lost.end())
+        {
+            lost.push_back(shard);
+        }
+    }
+
+    EXPECT_TRUE(test_shards<rs_inverse_decoder>(
+                    data_shards, parity_shards, 200, object_size, lost));
+}
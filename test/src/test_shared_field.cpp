@@ -0,0 +1,131 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_shared_field.cpp Unit tests for the process-wide finite
+///       field implementations
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/shared_field.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    typedef fifi::default_field<fifi::binary8>::type binary8_impl;
+    typedef fifi::default_field<fifi::binary16>::type binary16_impl;
+}
+
+/// Every thread gets the same instance of a field
+TEST(TestSharedField, one_instance)
+{
+    const binary8_impl *field = kodo::shared_field<binary8_impl>().get();
+    ASSERT_TRUE(field != 0);
+
+    std::vector<const binary8_impl*> fields(4, 0);
+    std::vector<std::thread> threads;
+
+    for(uint32_t i = 0; i < fields.size(); ++i)
+    {
+        threads.push_back(std::thread([&fields, i]()
+            {
+                fields[i] = kodo::shared_field<binary8_impl>().get();
+            }));
+    }
+
+    for(auto &t : threads)
+    {
+        t.join();
+    }
+
+    for(const auto *f : fields)
+    {
+        EXPECT_EQ(field, f);
+    }
+
+    // The fields have an instance each
+    EXPECT_TRUE(static_cast<const void*>(field) !=
+                static_cast<const void*>(
+                    kodo::shared_field<binary16_impl>().get()));
+
+    // The tables of the shared instance are the tables of the field
+    binary8_impl local;
+
+    for(uint32_t a = 1; a < 256; a += 7)
+    {
+        EXPECT_EQ(local.invert(a), field->invert(a));
+
+        for(uint32_t b = 0; b < 256; b += 13)
+        {
+            EXPECT_EQ(local.multiply(a, b), field->multiply(a, b));
+        }
+    }
+}
+
+/// Coders of factories built on several threads code with the shared
+/// field
+TEST(TestSharedField, factories_on_threads)
+{
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 160;
+
+    // Not a std::vector<bool>, the threads write separate elements
+    std::vector<uint8_t> decoded(4, 0);
+    std::vector<std::thread> threads;
+
+    for(uint32_t i = 0; i < decoded.size(); ++i)
+    {
+        threads.push_back(std::thread([&decoded, i, symbols, symbol_size]()
+            {
+                typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+                typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+                encoder_t::factory encoder_factory(symbols, symbol_size);
+                decoder_t::factory decoder_factory(symbols, symbol_size);
+
+                auto encoder = encoder_factory.build();
+                auto decoder = decoder_factory.build();
+
+                encoder->set_systematic_off();
+
+                std::vector<uint8_t> data_in(encoder->block_size());
+
+                for(uint32_t j = 0; j < data_in.size(); ++j)
+                {
+                    data_in[j] = static_cast<uint8_t>(j * (i + 1));
+                }
+
+                encoder->set_symbols(sak::storage(data_in));
+
+                std::vector<uint8_t> payload(encoder->payload_size());
+
+                while(!decoder->is_complete())
+                {
+                    encoder->encode(&payload[0]);
+                    decoder->decode(&payload[0]);
+                }
+
+                std::vector<uint8_t> data_out(decoder->block_size());
+                decoder->copy_symbols(sak::storage(data_out));
+
+                decoded[i] = data_out == data_in ? 1 : 0;
+            }));
+    }
+
+    for(auto &t : threads)
+    {
+        t.join();
+    }
+
+    for(uint8_t d : decoded)
+    {
+        EXPECT_EQ(1U, d);
+    }
+}
@@ -0,0 +1,258 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_shared_memory_decoder.cpp Unit tests for the
+///       shared_memory_arena and the shared_memory_decoder
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <kodo/shared_memory_arena.hpp>
+#include <kodo/shared_memory_decoder.hpp>
+#include <kodo/storage_encoder.hpp>
+#include <kodo/rfc5052_partitioning_scheme.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Decoder stack decoding directly in the slots of the arena
+    template<class Field>
+    class arena_rlnc_decoder :
+        public // Payload API
+               payload_recoder<recoding_stack,
+               payload_decoder<
+               // Codec Header API
+               systematic_decoder<
+               symbol_id_decoder<
+               // Symbol ID API
+               plain_symbol_id_reader<
+               // Codec API
+               aligned_coefficients_decoder<
+               linear_block_decoder<
+               // Coefficient Storage API
+               coefficient_storage<
+               coefficient_info<
+               // Storage API
+               mutable_shallow_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               arena_rlnc_decoder<Field>
+               > > > > > > > > > > > > > > >
+    { };
+}
+
+TEST(TestSharedMemoryArena, acquire_and_release)
+{
+    kodo::shared_memory_arena arena("test_arena", 3, 1000);
+
+    EXPECT_EQ(3U, arena.slots());
+    EXPECT_TRUE(arena.slot_size() >= 1000U);
+
+    uint32_t first = arena.acquire();
+    uint32_t second = arena.acquire();
+    uint32_t third = arena.acquire();
+
+    EXPECT_NE(first, second);
+    EXPECT_NE(second, third);
+    EXPECT_EQ(kodo::shared_memory_arena::acquired_slot,
+              arena.state(first));
+
+    EXPECT_EQ(kodo::shared_memory_arena::no_slot, arena.acquire());
+
+    arena.release(second);
+    EXPECT_EQ(kodo::shared_memory_arena::free_slot, arena.state(second));
+    EXPECT_EQ(second, arena.acquire());
+
+    // A second mapping of the arena sees the same slots
+    kodo::shared_memory_arena consumer(arena.fd());
+
+    EXPECT_EQ(arena.slots(), consumer.slots());
+    EXPECT_EQ(arena.slot_size(), consumer.slot_size());
+
+    arena.slot_data(first)[0] = 42;
+    EXPECT_TRUE(arena.publish(first, 7, 1));
+
+    EXPECT_EQ(kodo::shared_memory_arena::published_slot,
+              consumer.state(first));
+    EXPECT_EQ(7U, consumer.block_id(first));
+    EXPECT_EQ(1U, consumer.bytes(first));
+    EXPECT_EQ(42, consumer.slot_data(first)[0]);
+
+    consumer.release(first);
+    EXPECT_EQ(kodo::shared_memory_arena::free_slot, arena.state(first));
+}
+
+/// Tests that notifications of invalid slots are dropped by the
+/// consumer
+TEST(TestSharedMemoryArena, drop_invalid_notifications)
+{
+    int notification[2];
+    ASSERT_EQ(0, ::pipe(notification));
+
+    kodo::shared_memory_arena producer("test_arena", 2, 1000);
+    kodo::shared_memory_arena consumer(producer.fd());
+    consumer.set_notification(notification[0]);
+
+    uint32_t first = producer.acquire();
+    uint32_t second = producer.acquire();
+
+    // A slot outside the arena and a slot which is not published
+    uint32_t invalid[] = { 2, kodo::shared_memory_arena::no_slot, first };
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(invalid)),
+              ::write(notification[1], invalid, sizeof(invalid)));
+
+    producer.set_notification(notification[1]);
+    EXPECT_TRUE(producer.publish(second, 3, 10));
+
+    uint32_t slot = 0;
+    ASSERT_TRUE(consumer.wait_published(slot));
+    EXPECT_EQ(second, slot);
+    EXPECT_EQ(3U, consumer.block_id(slot));
+
+    // Only invalid notifications before the descriptor is closed
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(invalid)),
+              ::write(notification[1], invalid, sizeof(invalid)));
+    ::close(notification[1]);
+
+    EXPECT_FALSE(consumer.wait_published(slot));
+
+    ::close(notification[0]);
+}
+
+/// Decodes an object into the arena and reads the published blocks
+/// through a second mapping, as the consumer process would
+template<class Decoder>
+void test_shared_memory_decoder(uint32_t max_symbols,
+                                uint32_t max_symbol_size,
+                                uint32_t object_size)
+{
+    typedef kodo::storage_encoder<
+        kodo::full_rlnc_encoder<fifi::binary8>,
+        kodo::rfc5052_partitioning_scheme> storage_encoder;
+
+    typedef kodo::shared_memory_decoder<
+        Decoder, kodo::rfc5052_partitioning_scheme> object_decoder;
+
+    typename storage_encoder::factory encoder_factory(
+        max_symbols, max_symbol_size);
+
+    typename object_decoder::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    storage_encoder encoder(encoder_factory, sak::storage(data_in));
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, object_size);
+
+    int notification[2];
+    ASSERT_EQ(0, ::pipe(notification));
+
+    // Two slots, so the slots are reused for larger objects
+    kodo::shared_memory_arena producer(
+        "test_decoder", 2, decoder_factory.max_block_size());
+    producer.set_notification(notification[1]);
+
+    kodo::shared_memory_arena consumer(producer.fd());
+    consumer.set_notification(notification[0]);
+
+    {
+        object_decoder decoder(decoder_factory, object_size, producer);
+
+        EXPECT_EQ(encoder.encoders(), decoder.decoders());
+
+        for(uint32_t i = 0; i < encoder.encoders(); ++i)
+        {
+            auto e = encoder.build(i);
+            auto d = decoder.build(i);
+
+            ASSERT_TRUE((bool) d);
+            EXPECT_NE(kodo::shared_memory_arena::no_slot, decoder.slot(i));
+
+            e->set_systematic_off();
+
+            std::vector<uint8_t> payload(e->payload_size());
+
+            while(!d->is_complete())
+            {
+                e->encode(&payload[0]);
+                d->decode(&payload[0]);
+            }
+
+            EXPECT_TRUE(decoder.publish(i, d));
+            EXPECT_EQ(kodo::shared_memory_arena::no_slot, decoder.slot(i));
+
+            uint32_t slot = 0;
+            ASSERT_TRUE(consumer.wait_published(slot));
+
+            uint32_t offset = partitioning.byte_offset(i);
+            uint32_t bytes = partitioning.bytes_used(i);
+
+            EXPECT_EQ(i, consumer.block_id(slot));
+            EXPECT_EQ(bytes, consumer.bytes(slot));
+
+            const uint8_t *block = consumer.slot_data(slot);
+
+            EXPECT_TRUE(std::equal(block, block + bytes,
+                                   &data_in[offset]));
+
+            consumer.release(slot);
+        }
+
+        // A block not published keeps its slot until the object
+        // decoder is destroyed
+        decoder.build(0);
+        EXPECT_EQ(kodo::shared_memory_arena::acquired_slot,
+                  producer.state(decoder.slot(0)));
+    }
+
+    for(uint32_t i = 0; i < producer.slots(); ++i)
+    {
+        EXPECT_EQ(kodo::shared_memory_arena::free_slot, producer.state(i));
+    }
+
+    ::close(notification[0]);
+    ::close(notification[1]);
+}
+
+TEST(TestSharedMemoryDecoder, shallow_storage)
+{
+    test_shared_memory_decoder<kodo::arena_rlnc_decoder<fifi::binary8> >(
+        32, 1600, 2);
+
+    test_shared_memory_decoder<kodo::arena_rlnc_decoder<fifi::binary8> >(
+        32, 160, 32 * 160 * 5 + 7);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+    uint32_t object_size = rand_nonzero(symbols * symbol_size * 4);
+
+    test_shared_memory_decoder<kodo::arena_rlnc_decoder<fifi::binary8> >(
+        symbols, symbol_size, object_size);
+}
+
+TEST(TestSharedMemoryDecoder, deep_storage)
+{
+    test_shared_memory_decoder<kodo::full_rlnc_decoder<fifi::binary8> >(
+        32, 1600, 2);
+
+    test_shared_memory_decoder<kodo::full_rlnc_decoder<fifi::binary8> >(
+        32, 160, 32 * 160 * 5 + 7);
+}
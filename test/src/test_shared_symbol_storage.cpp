@@ -0,0 +1,107 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_shared_symbol_storage.cpp Unit tests for the shared
+///       symbol storage
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Decodes the independent coded streams of several encoders sharing
+/// one block
+template<class Field>
+void test_shared_encoders(uint32_t symbols, uint32_t symbol_size,
+                          uint32_t receivers)
+{
+    typedef kodo::shared_full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    typename encoder_t::block_pointer block =
+        boost::make_shared<typename encoder_t::block_type>(
+            random_vector(encoder_factory.max_block_size()));
+
+    std::vector<typename encoder_t::pointer> encoders;
+    std::vector<typename decoder_t::pointer> decoders;
+
+    for(uint32_t i = 0; i < receivers; ++i)
+    {
+        auto encoder = encoder_factory.build();
+        EXPECT_FALSE(encoder->shared_symbols());
+
+        encoder->set_shared_symbols(block);
+        encoder->seed(i);
+        encoder->set_systematic_off();
+
+        EXPECT_TRUE(encoder->shared_symbols() == block);
+        EXPECT_TRUE(encoder->symbol(0) == &(*block)[0]);
+
+        encoders.push_back(encoder);
+        decoders.push_back(decoder_factory.build());
+    }
+
+    EXPECT_EQ(receivers + 1, block.use_count());
+
+    std::vector<uint8_t> payload(encoders[0]->payload_size());
+    std::vector<uint8_t> first_payload(encoders[0]->payload_size());
+
+    for(uint32_t i = 0; i < receivers; ++i)
+    {
+        encoders[i]->encode(&payload[0]);
+
+        // The receivers get different coded streams
+        if(i == 0)
+        {
+            first_payload = payload;
+        }
+        else if(symbols > 1)
+        {
+            EXPECT_FALSE(payload == first_payload);
+        }
+
+        decoders[i]->decode(&payload[0]);
+
+        while(!decoders[i]->is_complete())
+        {
+            encoders[i]->encode(&payload[0]);
+            decoders[i]->decode(&payload[0]);
+        }
+
+        std::vector<uint8_t> data_out(decoders[i]->block_size(), '\0');
+        decoders[i]->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(data_out == *block);
+    }
+
+    // A recycled encoder releases the block when it is built again,
+    // until then it is kept by the factory pool
+    encoders.clear();
+
+    auto encoder = encoder_factory.build();
+    EXPECT_FALSE(encoder->shared_symbols());
+    EXPECT_EQ(receivers, block.use_count());
+}
+
+TEST(TestSharedSymbolStorage, test_shared_encoders)
+{
+    test_shared_encoders<fifi::binary>(32, 160, 4);
+    test_shared_encoders<fifi::binary8>(32, 160, 4);
+    test_shared_encoders<fifi::binary16>(1, 160, 2);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_shared_encoders<fifi::binary8>(symbols, symbol_size, 3);
+}
@@ -0,0 +1,237 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_simd_finite_field_math.cpp Unit tests for the
+///       vectorized finite field layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/final_coder_factory.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/simd_finite_field_math.hpp>
+#include <kodo/storage_block_info.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Stack using the plain finite field layer
+    template<class Field>
+    class reference_math_stack
+        : public storage_block_info<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 reference_math_stack<Field>
+                     > > > >
+    { };
+
+    /// Stack using the vectorized finite field layer
+    template<class Field>
+    class simd_math_stack
+        : public storage_block_info<
+                 simd_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 simd_math_stack<Field>
+                     > > > >
+    { };
+
+}
+
+/// @return A random prime2325 element
+inline uint32_t rand_prime2325()
+{
+    uint64_t value = (uint64_t(rand()) << 32) ^ (uint64_t(rand()) << 16) ^
+        uint64_t(rand());
+
+    return static_cast<uint32_t>(value % fifi::prime2325::prime);
+}
+
+/// Compares the results of the vectorized layer with the plain
+/// finite_field_math layer for buffers of the given length
+template<class Field>
+void check_simd_math(kodo::simd_level level, uint32_t length)
+{
+    typedef typename Field::value_type value_type;
+
+    uint32_t symbol_size = (length + 1) * sizeof(value_type);
+
+    typename kodo::reference_math_stack<Field>::factory
+        reference_factory(4, symbol_size);
+    auto reference = reference_factory.build();
+
+    typename kodo::simd_math_stack<Field>::factory
+        simd_factory(4, symbol_size);
+    simd_factory.set_simd_level(level);
+    auto simd = simd_factory.build();
+
+    // The prime2325 kernels are only available from AVX2
+    bool kernels = level != kodo::simd_level::none;
+    if(std::is_same<Field, fifi::prime2325>::value)
+    {
+        kernels = level == kodo::simd_level::avx2 ||
+            level == kodo::simd_level::avx512;
+    }
+
+    EXPECT_EQ(kernels, simd->has_simd_kernels());
+
+    // Use an offset of one element to test unaligned buffers
+    std::vector<value_type> src(length + 1);
+    std::vector<value_type> src_two(length + 1);
+    std::vector<value_type> expected(length + 1);
+    std::vector<value_type> result(length + 1);
+
+    for(uint32_t i = 0; i <= length; ++i)
+    {
+        src[i] = rand() % (uint32_t(Field::max_value) + 1);
+        src_two[i] = rand() % (uint32_t(Field::max_value) + 1);
+        expected[i] = rand() % (uint32_t(Field::max_value) + 1);
+    }
+
+    value_type coefficient = static_cast<value_type>(
+        (rand() % Field::max_value) + 1);
+
+    value_type coefficient_two = static_cast<value_type>(
+        (rand() % Field::max_value) + 1);
+
+    // Packed binary4 elements use the full byte
+    if(std::is_same<Field, fifi::binary4>::value)
+    {
+        for(uint32_t i = 0; i <= length; ++i)
+        {
+            src[i] = rand() % 256;
+            src_two[i] = rand() % 256;
+            expected[i] = rand() % 256;
+        }
+    }
+
+    // Use the full range of prime2325 elements, which rand() does not
+    // cover, including the largest ones
+    if(std::is_same<Field, fifi::prime2325>::value)
+    {
+        for(uint32_t i = 0; i <= length; ++i)
+        {
+            src[i] = rand_prime2325();
+            src_two[i] = rand_prime2325();
+            expected[i] = rand_prime2325();
+        }
+
+        src[length] = Field::max_value;
+        expected[0] = Field::max_value;
+
+        coefficient = Field::max_value;
+        coefficient_two = static_cast<value_type>(
+            (rand_prime2325() % Field::max_value) + 1);
+    }
+
+    result = expected;
+    reference->multiply_add(&expected[1], &src[1], coefficient, length);
+    simd->multiply_add(&result[1], &src[1], coefficient, length);
+    EXPECT_TRUE(expected == result);
+
+    reference->multiply_subtract(&expected[1], &src[1],
+                                 coefficient_two, length);
+    simd->multiply_subtract(&result[1], &src[1], coefficient_two, length);
+    EXPECT_TRUE(expected == result);
+
+    reference->add(&expected[1], &src_two[1], length);
+    simd->add(&result[1], &src_two[1], length);
+    EXPECT_TRUE(expected == result);
+
+    reference->subtract(&expected[1], &src[1], length);
+    simd->subtract(&result[1], &src[1], length);
+    EXPECT_TRUE(expected == result);
+
+    reference->multiply(&expected[1], coefficient, length);
+    simd->multiply(&result[1], coefficient, length);
+    EXPECT_TRUE(expected == result);
+
+    const value_type *sources[] = { &src[1], &src_two[1] };
+    value_type coefficients[] = { coefficient, coefficient_two };
+
+    reference->multiply_add_sources(&expected[1], sources, coefficients,
+                                    2, length);
+    simd->multiply_add_sources(&result[1], sources, coefficients,
+                               2, length);
+    EXPECT_TRUE(expected == result);
+
+    // The destination initialising operations must not read the
+    // destination, which still holds the previous results
+    reference->multiply_copy(&expected[1], &src_two[1], coefficient,
+                             length);
+    simd->multiply_copy(&result[1], &src_two[1], coefficient, length);
+    EXPECT_TRUE(expected == result);
+
+    reference->multiply_sources(&expected[1], sources, coefficients,
+                                2, length);
+    simd->multiply_sources(&result[1], sources, coefficients, 2, length);
+    EXPECT_TRUE(expected == result);
+
+    // The sum written by multiply_sources() is the first source scaled
+    // with multiply_copy() plus the others
+    std::vector<value_type> combined(expected);
+    reference->multiply_copy(&combined[1], &src[1], coefficient, length);
+    reference->multiply_add(&combined[1], &src_two[1], coefficient_two,
+                            length);
+    EXPECT_TRUE(expected == combined);
+}
+
+template<class Field>
+void test_simd_math(kodo::simd_level level)
+{
+    for(uint32_t length = 1; length < 300; ++length)
+    {
+        check_simd_math<Field>(level, length);
+    }
+
+    check_simd_math<Field>(level, 1400 / sizeof(typename Field::value_type));
+    check_simd_math<Field>(level, 5000);
+}
+
+/// Tests all the instruction sets supported by the CPU
+TEST(TestSimdFiniteFieldMath, kernels)
+{
+    const kodo::simd_level levels[] =
+        {
+            kodo::simd_level::none,
+            kodo::simd_level::ssse3,
+            kodo::simd_level::avx2,
+            kodo::simd_level::avx512,
+            kodo::simd_level::neon
+        };
+
+    for(auto level : levels)
+    {
+        if(!kodo::is_simd_level_supported(level))
+            continue;
+
+        test_simd_math<fifi::binary4>(level);
+        test_simd_math<fifi::binary8>(level);
+        test_simd_math<fifi::binary16>(level);
+        test_simd_math<fifi::prime2325>(level);
+    }
+}
+
+/// Tests that the fields without kernels fall back to the
+/// finite_field_math layer
+TEST(TestSimdFiniteFieldMath, fallback)
+{
+    typedef kodo::simd_math_stack<fifi::binary> stack_type;
+
+    stack_type::factory factory(4, 100);
+    EXPECT_EQ(kodo::detect_simd_level(), factory.get_simd_level());
+
+    auto stack = factory.build();
+    EXPECT_FALSE(stack->has_simd_kernels());
+}
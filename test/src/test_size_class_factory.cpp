@@ -0,0 +1,131 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_size_class_factory.cpp Unit tests for the
+///       size_class_factory
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/size_class_factory.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Tests:
+///   - size_class_factory::size_class(uint32_t, uint32_t)
+///   - size_class_factory::build()
+TEST(TestSizeClassFactory, size_classes)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    kodo::size_class_factory<decoder_t> factory(32, 1600);
+
+    EXPECT_EQ(32U, factory.max_symbols());
+    EXPECT_EQ(1600U, factory.max_symbol_size());
+    EXPECT_EQ(16U, factory.size_classes());
+
+    // The symbols are classed as 4, 8, 16 and 32, the symbol sizes as
+    // 208, 400, 800 and 1600
+    auto &smallest = factory.size_class(1, 1);
+    EXPECT_EQ(4U, smallest.max_symbols());
+    EXPECT_EQ(208U, smallest.max_symbol_size());
+
+    auto &small = factory.size_class(5, 208);
+    EXPECT_EQ(8U, small.max_symbols());
+    EXPECT_EQ(208U, small.max_symbol_size());
+
+    auto &largest = factory.size_class(17, 801);
+    EXPECT_EQ(32U, largest.max_symbols());
+    EXPECT_EQ(1600U, largest.max_symbol_size());
+
+    factory.set_symbols(5);
+    factory.set_symbol_size(100);
+
+    auto decoder = factory.build();
+
+    EXPECT_EQ(5U, decoder->symbols());
+    EXPECT_EQ(100U, decoder->symbol_size());
+
+    // Only the small class constructed a coder
+    EXPECT_EQ(1U, small.pool().total_resources());
+    EXPECT_EQ(0U, largest.pool().total_resources());
+
+    // Fewer classes than requested if the maximum is small
+    kodo::size_class_factory<decoder_t> tiny(2, 16);
+    EXPECT_EQ(2U, tiny.size_classes());
+}
+
+/// Codes an object with the coders of the size classes
+void test_size_class_object(uint32_t symbols, uint32_t symbol_size,
+                            uint32_t object_size)
+{
+    typedef kodo::size_class_coder<
+        kodo::full_rlnc_encoder<fifi::binary8> > encoder_t;
+    typedef kodo::size_class_coder<
+        kodo::full_rlnc_decoder<fifi::binary8> > decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+    std::vector<uint8_t> data_out(object_size, '\0');
+
+    kodo::object_encoder<storage_reader, encoder_t> object_encoder(
+        encoder_factory, storage_reader(sak::storage(data_in)));
+
+    kodo::object_decoder<decoder_t> object_decoder(
+        decoder_factory, object_size);
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        symbols, symbol_size, object_size);
+
+    EXPECT_EQ(object_encoder.encoders(), object_decoder.decoders());
+
+    for(uint32_t i = 0; i < object_encoder.encoders(); ++i)
+    {
+        auto encoder = object_encoder.build(i);
+        auto decoder = object_decoder.build(i);
+
+        EXPECT_EQ(partitioning.symbols(i), decoder->symbols());
+
+        encoder->set_systematic_off();
+
+        std::vector<uint8_t> payload(encoder->payload_size());
+
+        while(!decoder->is_complete())
+        {
+            encoder->encode(&payload[0]);
+            decoder->decode(&payload[0]);
+        }
+
+        decoder->copy_symbols(sak::storage(
+            &data_out[partitioning.byte_offset(i)],
+            partitioning.bytes_used(i)));
+    }
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestSizeClassFactory, object_codes)
+{
+    test_size_class_object(32, 160, 32 * 160 * 3 + 2 * 160);
+
+    // A small object only uses the smallest class
+    test_size_class_object(32, 1600, 3 * 1600 + 1);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_size_class_object(symbols, symbol_size,
+                           rand_nonzero(symbols * symbol_size * 4));
+}
@@ -0,0 +1,273 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_sliding_window_codes.cpp Unit tests for the sliding window
+///       encoder and decoder
+
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/sliding_window/sliding_window_encoder.hpp>
+#include <kodo/sliding_window/sliding_window_decoder.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Collects the symbols delivered by the symbol decoded callback
+struct delivered_symbols
+{
+    void operator()(uint32_t sequence, const uint8_t *data)
+    {
+        if(sequence >= m_symbols.size())
+        {
+            m_symbols.resize(sequence + 1);
+        }
+
+        // Every symbol must only be delivered once
+        EXPECT_TRUE(m_symbols[sequence].empty());
+        m_symbols[sequence].assign(data, data + m_symbol_size);
+    }
+
+    uint32_t m_symbol_size;
+    std::vector<std::vector<uint8_t> > m_symbols;
+};
+
+/// Streams symbols through a lossy channel, after every new symbol the
+/// encoder sends the symbol uncoded and a number of coded symbols
+template<class Field>
+void test_sliding_window_stream(uint32_t window, uint32_t symbol_size,
+                                uint32_t symbols, uint32_t redundancy,
+                                uint32_t loss_percent)
+{
+    kodo::sliding_window_encoder<Field> encoder(window, symbol_size);
+    kodo::sliding_window_decoder<Field> decoder(window, symbol_size);
+
+    EXPECT_EQ(window, encoder.window_capacity());
+    EXPECT_EQ(symbol_size, decoder.symbol_size());
+    EXPECT_EQ(encoder.payload_size(), decoder.payload_size());
+
+    delivered_symbols delivered;
+    delivered.m_symbol_size = symbol_size;
+
+    decoder.set_symbol_decoded_callback(
+        [&](uint32_t sequence, const uint8_t *data)
+        {
+            // The symbol is delivered before it leaves the window
+            EXPECT_TRUE(decoder.is_decoded(sequence));
+            EXPECT_LT(sequence - decoder.window_begin(), window);
+            delivered(sequence, data);
+        });
+
+    std::vector<std::vector<uint8_t> > data_in;
+    std::vector<uint8_t> payload(encoder.payload_size());
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        if(encoder.is_window_full())
+        {
+            encoder.pop_symbol();
+        }
+
+        data_in.push_back(random_vector(symbol_size));
+        EXPECT_EQ(i, encoder.push_symbol(sak::storage(data_in.back())));
+
+        EXPECT_EQ(encoder.window_end() - encoder.window_begin(),
+                  encoder.window_size());
+        EXPECT_GE(window, encoder.window_size());
+
+        for(uint32_t j = 0; j < 1 + redundancy; ++j)
+        {
+            EXPECT_EQ(payload.size(), encoder.encode(&payload[0]));
+
+            if(uint32_t(rand() % 100) < loss_percent)
+            {
+                continue;
+            }
+
+            decoder.decode(&payload[0]);
+
+            EXPECT_GE(window, decoder.window_size());
+            EXPECT_GE(decoder.window_size(), decoder.rank());
+        }
+    }
+
+    // All the decoded symbols are correct
+    uint32_t decoded = 0;
+    for(uint32_t i = 0; i < delivered.m_symbols.size(); ++i)
+    {
+        if(delivered.m_symbols[i].empty())
+        {
+            continue;
+        }
+
+        EXPECT_TRUE(delivered.m_symbols[i] == data_in[i]);
+        ++decoded;
+    }
+
+    EXPECT_EQ(decoded, decoder.symbols_decoded());
+    EXPECT_GE(symbols, decoder.symbols_decoded() + decoder.symbols_lost());
+
+    if(loss_percent == 0)
+    {
+        EXPECT_EQ(symbols, decoder.symbols_decoded());
+        EXPECT_EQ(0U, decoder.symbols_lost());
+    }
+    else
+    {
+        // The redundancy recovers nearly all the lost symbols
+        EXPECT_LE(symbols - symbols / 20, decoder.symbols_decoded());
+    }
+}
+
+TEST(TestSlidingWindowCodes, stream)
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    test_sliding_window_stream<fifi::binary>(16, 64, 200, 0, 0);
+    test_sliding_window_stream<fifi::binary8>(16, 64, 200, 0, 0);
+    test_sliding_window_stream<fifi::binary16>(16, 64, 200, 0, 0);
+
+    test_sliding_window_stream<fifi::binary>(32, 64, 500, 1, 10);
+    test_sliding_window_stream<fifi::binary8>(16, 64, 500, 1, 20);
+    test_sliding_window_stream<fifi::binary16>(16, 64, 500, 1, 20);
+    test_sliding_window_stream<fifi::binary8>(1, 32, 100, 2, 10);
+}
+
+/// Checks the recovery of a lost symbol and the retiring of the
+/// symbols leaving the window
+template<class Field>
+void test_sliding_window_recovery()
+{
+    uint32_t window = 4;
+    uint32_t symbol_size = 16;
+
+    kodo::sliding_window_encoder<Field> encoder(window, symbol_size);
+    kodo::sliding_window_decoder<Field> decoder(window, symbol_size);
+
+    std::vector<std::vector<uint8_t> > data_in;
+    std::vector<uint8_t> payload(encoder.payload_size());
+
+    for(uint32_t i = 0; i < window; ++i)
+    {
+        data_in.push_back(random_vector(symbol_size));
+        encoder.push_symbol(sak::storage(data_in.back()));
+    }
+
+    EXPECT_TRUE(encoder.is_window_full());
+
+    // Symbol 1 is lost
+    for(uint32_t i = 0; i < window; ++i)
+    {
+        encoder.encode(&payload[0]);
+
+        if(i != 1)
+        {
+            decoder.decode(&payload[0]);
+        }
+    }
+
+    EXPECT_EQ(0U, decoder.window_begin());
+    EXPECT_EQ(window, decoder.window_end());
+    EXPECT_EQ(window - 1, decoder.rank());
+    EXPECT_TRUE(decoder.is_decoded(0));
+    EXPECT_FALSE(decoder.is_decoded(1));
+
+    // Coded symbols until the lost symbol is recovered, a coded symbol
+    // is linearly dependent with probability 1/q
+    for(uint32_t i = 0; i < 100 && !decoder.is_decoded(1); ++i)
+    {
+        encoder.encode(&payload[0]);
+        decoder.decode(&payload[0]);
+    }
+
+    EXPECT_TRUE(decoder.is_decoded(1));
+    EXPECT_EQ(window, decoder.rank());
+    EXPECT_EQ(window, decoder.symbols_decoded());
+
+    for(uint32_t i = 0; i < window; ++i)
+    {
+        EXPECT_TRUE(std::equal(data_in[i].begin(), data_in[i].end(),
+                               decoder.symbol(i)));
+    }
+
+    // The window moves by two symbols, the first new symbol is lost and
+    // the decoder learns about the move from the second
+    encoder.pop_symbol();
+    encoder.pop_symbol();
+
+    for(uint32_t i = 0; i < 2; ++i)
+    {
+        data_in.push_back(random_vector(symbol_size));
+        encoder.push_symbol(sak::storage(data_in.back()));
+    }
+
+    encoder.encode(&payload[0]);
+    std::vector<uint8_t> reordered = payload;
+
+    encoder.encode(&payload[0]);
+    decoder.decode(&payload[0]);
+
+    EXPECT_EQ(2U, decoder.window_begin());
+    EXPECT_EQ(6U, decoder.window_end());
+    EXPECT_FALSE(decoder.is_decoded(0));
+    EXPECT_TRUE(decoder.is_decoded(2));
+    EXPECT_TRUE(decoder.is_decoded(5));
+    EXPECT_FALSE(decoder.is_decoded(4));
+
+    // Coded symbols over the current window recover symbol 4
+    encoder.set_systematic_off();
+    EXPECT_FALSE(encoder.is_systematic_on());
+
+    for(uint32_t i = 0; i < 100 && !decoder.is_decoded(4); ++i)
+    {
+        encoder.encode(&payload[0]);
+        decoder.decode(&payload[0]);
+    }
+
+    EXPECT_TRUE(decoder.is_decoded(4));
+    EXPECT_TRUE(std::equal(data_in[4].begin(), data_in[4].end(),
+                           decoder.symbol(4)));
+
+    // The window jumps past all the symbols, the undecoded symbols are
+    // lost and the old payload is ignored
+    for(uint32_t i = 0; i < 6; ++i)
+    {
+        encoder.pop_symbol();
+        data_in.push_back(random_vector(symbol_size));
+        encoder.push_symbol(sak::storage(data_in.back()));
+    }
+
+    // Popping symbols which were never sent
+    encoder.pop_symbol();
+    encoder.pop_symbol();
+
+    encoder.set_systematic_on();
+    encoder.encode(&payload[0]);
+    decoder.decode(&payload[0]);
+
+    EXPECT_EQ(encoder.window_begin(), decoder.window_begin());
+    EXPECT_EQ(encoder.window_end(), decoder.window_end());
+    EXPECT_TRUE(decoder.is_decoded(encoder.window_begin()));
+    EXPECT_EQ(1U, decoder.rank());
+
+    // Symbols 6 to 9 were never received
+    EXPECT_EQ(encoder.window_begin() - 6, decoder.symbols_lost());
+
+    uint32_t decoded = decoder.symbols_decoded();
+    decoder.decode(&reordered[0]);
+    EXPECT_EQ(encoder.window_begin(), decoder.window_begin());
+    EXPECT_EQ(decoded, decoder.symbols_decoded());
+    EXPECT_EQ(1U, decoder.rank());
+}
+
+TEST(TestSlidingWindowCodes, recovery)
+{
+    test_sliding_window_recovery<fifi::binary>();
+    test_sliding_window_recovery<fifi::binary8>();
+    test_sliding_window_recovery<fifi::binary16>();
+}
@@ -0,0 +1,187 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_snapshot.cpp Unit tests for the snapshot and restore of
+///       encoders and decoders
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/snapshot.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Restores a partially decoded decoder into a decoder of another
+/// factory, and completes both with the same payloads
+template<class Field>
+void test_snapshot_decoder(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::full_rlnc_encoder<Field> encoder_t;
+    typedef kodo::full_rlnc_decoder<Field> decoder_t;
+
+    typename encoder_t::factory encoder_factory(symbols, symbol_size);
+    typename decoder_t::factory decoder_factory(symbols, symbol_size);
+    typename decoder_t::factory failover_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    decoder->set_bytes_used(encoder->block_size() - 1);
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // Half the symbols arrive systematically, then coded symbols
+    // until the decoder is half way
+    for(uint32_t i = 0; i < symbols / 2; ++i)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    kodo::set_systematic_off(encoder);
+
+    while(decoder->rank() < (symbols + 1) / 2)
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> snapshot = kodo::snapshot(decoder);
+    EXPECT_EQ(decoder->snapshot_size(), snapshot.size());
+
+    auto failover = failover_factory.build();
+    ASSERT_TRUE(kodo::restore(failover, sak::storage(snapshot)));
+
+    EXPECT_EQ(decoder->rank(), failover->rank());
+    EXPECT_EQ(decoder->bytes_used(), failover->bytes_used());
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        EXPECT_EQ(decoder->symbol_pivot(i), failover->symbol_pivot(i));
+    }
+
+    // A snapshot of the restored decoder is identical
+    EXPECT_TRUE(snapshot == kodo::snapshot(failover));
+
+    std::vector<uint8_t> copy(payload.size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        copy = payload;
+
+        decoder->decode(&payload[0]);
+        failover->decode(&copy[0]);
+
+        EXPECT_EQ(decoder->rank(), failover->rank());
+    }
+
+    EXPECT_TRUE(failover->is_complete());
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    failover->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestSnapshot, decoder)
+{
+    test_snapshot_decoder<fifi::binary>(1, 16);
+    test_snapshot_decoder<fifi::binary>(33, 40);
+    test_snapshot_decoder<fifi::binary8>(32, 100);
+    test_snapshot_decoder<fifi::binary16>(20, 64);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_snapshot_decoder<fifi::binary8>(symbols, symbol_size);
+}
+
+/// A restored encoder continues the systematic phase where the snapshot
+/// was taken
+TEST(TestSnapshot, encoder)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 64;
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    encoder_t::factory failover_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    for(uint32_t i = 0; i < 5; ++i)
+    {
+        encoder->encode(&payload[0]);
+    }
+
+    std::vector<uint8_t> snapshot = kodo::snapshot(encoder);
+
+    auto failover = failover_factory.build();
+    ASSERT_TRUE(kodo::restore(failover, sak::storage(snapshot)));
+
+    EXPECT_TRUE(failover->is_symbols_initialized());
+
+    // The next systematic payloads are identical
+    std::vector<uint8_t> failover_payload(failover->payload_size());
+
+    for(uint32_t i = 5; i < symbols; ++i)
+    {
+        uint32_t bytes = encoder->encode(&payload[0]);
+        EXPECT_EQ(bytes, failover->encode(&failover_payload[0]));
+
+        EXPECT_TRUE(std::equal(payload.begin(), payload.begin() + bytes,
+                               failover_payload.begin()));
+    }
+}
+
+/// A snapshot is not restored into a coder of another block
+TEST(TestSnapshot, mismatch)
+{
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    decoder_t::factory decoder_factory(16, 64);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> snapshot = kodo::snapshot(decoder);
+
+    // Another number of symbols and symbol size
+    decoder_factory.set_symbols(8);
+    decoder_factory.set_symbol_size(32);
+    auto other = decoder_factory.build();
+
+    EXPECT_FALSE(kodo::restore(other, sak::storage(snapshot)));
+
+    // A corrupted rank
+    decoder_factory.set_symbols(16);
+    decoder_factory.set_symbol_size(64);
+    auto same = decoder_factory.build();
+
+    EXPECT_TRUE(kodo::restore(same, sak::storage(snapshot)));
+
+    // The rank is followed by the maximum pivot and two bitmaps
+    uint32_t rank_offset = static_cast<uint32_t>(snapshot.size()) -
+        sizeof(uint32_t) - 2 * kodo::snapshot_bitmap_size(16) -
+        sizeof(uint32_t);
+
+    uint32_t rank = 3;
+    std::copy_n(reinterpret_cast<uint8_t*>(&rank), sizeof(rank),
+                &snapshot[rank_offset]);
+
+    EXPECT_FALSE(kodo::restore(same, sak::storage(snapshot)));
+}
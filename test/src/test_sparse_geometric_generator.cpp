@@ -0,0 +1,218 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_sparse_geometric_generator.cpp Unit tests for the sparse
+///       geometric coefficient generator
+
+#include <kodo/sparse_geometric_generator.hpp>
+#include <kodo/sparse_symbol_id_encoder.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "coefficient_generator_helper.hpp"
+
+namespace kodo
+{
+
+    // Sparse geometric generator
+    template<class Field>
+    class sparse_geometric_generator_stack :
+        public sparse_geometric_generator<
+               fake_codec_layer<
+               coefficient_info<
+               fake_symbol_storage<
+               storage_block_info<
+               finite_field_info<Field,
+               final_coder_factory<
+               sparse_geometric_generator_stack<Field>
+               > > > > > > >
+    { };
+
+    template<class Field>
+    class sparse_geometric_generator_stack_pool :
+        public sparse_geometric_generator<
+               fake_codec_layer<
+               coefficient_info<
+               fake_symbol_storage<
+               storage_block_info<
+               finite_field_info<Field,
+               final_coder_factory_pool<
+               sparse_geometric_generator_stack_pool<Field>
+               > > > > > > >
+    { };
+
+    /// RLNC encoder passing the non-zero coefficients of the sparse
+    /// generator directly to the encoder
+    template<class Field>
+    class sparse_geometric_rlnc_encoder :
+        public // Payload Codec API
+               payload_encoder<
+               // Codec Header API
+               systematic_encoder<
+               sparse_symbol_id_encoder<
+               // Symbol ID API
+               plain_symbol_id_writer<
+               // Coefficient Generator API
+               sparse_geometric_generator<
+               // Codec API
+               encode_symbol_tracker<
+               zero_symbol_encoder<
+               linear_block_encoder<
+               storage_aware_encoder<
+               // Coefficient Storage API
+               coefficient_info<
+               // Symbol Storage API
+               deep_symbol_storage<
+               storage_bytes_used<
+               storage_block_info<
+               // Finite Field API
+               finite_field_math<typename fifi::default_field<Field>::type,
+               finite_field_info<Field,
+               // Factory API
+               final_coder_factory_pool<
+               // Final type
+               sparse_geometric_rlnc_encoder<Field
+                   > > > > > > > > > > > > > > > > >
+    { };
+
+}
+
+/// Tests that the list of non-zero coefficients matches the generated
+/// coefficient vector and that the density is respected
+template<class Coder>
+struct api_nonzero_list
+{
+
+    typedef typename Coder::factory factory_type;
+    typedef typename Coder::pointer pointer_type;
+    typedef typename Coder::field_type field_type;
+    typedef typename Coder::value_type value_type;
+
+    api_nonzero_list(uint32_t max_symbols, uint32_t max_symbol_size)
+        : m_factory(max_symbols, max_symbol_size)
+    { }
+
+    void run()
+    {
+        m_factory.set_symbols(m_factory.max_symbols());
+        m_factory.set_symbol_size(m_factory.max_symbol_size());
+
+        pointer_type coder = m_factory.build();
+
+        std::vector<uint8_t> coefficients(coder->coefficients_size());
+        const value_type *c =
+            reinterpret_cast<const value_type*>(&coefficients[0]);
+
+        uint32_t total = 0;
+        uint32_t rounds = 200;
+
+        coder->set_density(0.1);
+        coder->seed(0);
+
+        for(uint32_t round = 0; round < rounds; ++round)
+        {
+            coder->generate(&coefficients[0]);
+
+            uint32_t count = coder->nonzero_count();
+            total += count;
+
+            uint32_t next = 0;
+            for(uint32_t i = 0; i < coder->symbols(); ++i)
+            {
+                value_type value = fifi::get_value<field_type>(c, i);
+
+                if(!value)
+                    continue;
+
+                ASSERT_TRUE(next < count);
+                EXPECT_EQ(i, coder->nonzero_indices()[next]);
+                EXPECT_EQ(value, coder->nonzero_values()[next]);
+                ++next;
+            }
+
+            EXPECT_EQ(next, count);
+        }
+
+        // The average density should be close to the one selected
+        double density = double(total) / (rounds * coder->symbols());
+        EXPECT_GT(density, 0.07);
+        EXPECT_LT(density, 0.13);
+
+        coder->set_density(1.0);
+        coder->generate(&coefficients[0]);
+        EXPECT_EQ(coder->symbols(), coder->nonzero_count());
+    }
+
+private:
+
+    // The factory
+    factory_type m_factory;
+
+};
+
+/// Run the tests typical coefficients stack
+TEST(TestCoefficientGenerator, sparse_geometric_generator_stack)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    // API tests:
+    run_test<
+        kodo::sparse_geometric_generator_stack,
+        api_generate>(symbols, symbol_size);
+
+    run_test<
+        kodo::sparse_geometric_generator_stack_pool,
+        api_generate>(symbols, symbol_size);
+
+    run_test<
+        kodo::sparse_geometric_generator_stack,
+        api_nonzero_list>(512, 100);
+}
+
+/// Tests encoding from the list of non-zero coefficients
+template<class Field>
+void test_sparse_geometric_encoder(uint32_t symbols, uint32_t symbol_size)
+{
+    typedef kodo::sparse_geometric_rlnc_encoder<Field> encoder_type;
+    typedef kodo::full_rlnc_decoder<Field> decoder_type;
+
+    typename encoder_type::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    typename decoder_type::factory decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    encoder->set_density(0.3);
+    encoder->set_systematic_off();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size(), '\0');
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(std::equal(data_out.begin(), data_out.end(),
+                           data_in.begin()));
+}
+
+TEST(TestCoefficientGenerator, sparse_geometric_encoder)
+{
+    test_sparse_geometric_encoder<fifi::binary>(32, 160);
+    test_sparse_geometric_encoder<fifi::binary8>(32, 160);
+    test_sparse_geometric_encoder<fifi::binary16>(32, 160);
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    test_sparse_geometric_encoder<fifi::binary8>(symbols, symbol_size);
+}
@@ -160,3 +160,42 @@ TEST(TestCoefficientGenerator, density_sparse_uniform_generator_stack)
 
 
 
+
+/// Checks that the first vectors of a block are of the binary subfield
+/// and keep the density
+TEST(TestCoefficientGenerator, subfield_sparse_uniform_generator_stack)
+{
+    typedef kodo::sparse_uniform_generator_stack<fifi::binary8> stack_type;
+
+    stack_type::factory factory(64, 100);
+    auto coder = factory.build();
+
+    coder->set_subfield_vectors(2);
+    coder->set_density(0.5);
+
+    std::vector<uint8_t> coefficients(coder->coefficients_size());
+
+    for(uint32_t j = 0; j < 3; ++j)
+    {
+        coder->generate(&coefficients[0]);
+
+        uint32_t ones = 0;
+        uint32_t full_field = 0;
+
+        for(uint32_t i = 0; i < coder->symbols(); ++i)
+        {
+            ones += coefficients[i] == 1 ? 1 : 0;
+            full_field += coefficients[i] > 1 ? 1 : 0;
+        }
+
+        if(j < 2)
+        {
+            EXPECT_EQ(0U, full_field);
+            EXPECT_GT(ones, 8U);
+        }
+        else
+        {
+            EXPECT_GT(full_field, 0U);
+        }
+    }
+}
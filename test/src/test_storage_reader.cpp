@@ -49,7 +49,7 @@ public:
 
 /// Tests:
 ///  - storage_reader::size() const
-///  - storage_reader::read(pointer, uint32_t, uint32_t)
+///  - storage_reader::read(pointer, uint64_t, uint32_t)
 TEST(TestStorageReader, test_storage_reader)
 {
     uint32_t data_size = 1000;
@@ -85,6 +85,17 @@ TEST(TestStorageReader, test_storage_reader)
     EXPECT_TRUE(sak::equal(encoder->m_symbol_storage,
                            sak::storage(&data[random_offset], random_size)));
 
+    // A buffer given as a pointer and a 64 bit size
+    kodo::storage_reader<dummy_encoder> pointer_reader(
+        &data[0], uint64_t(data_size));
+
+    EXPECT_EQ(uint64_t(data_size), pointer_reader.size());
+
+    pointer_reader.read(encoder, 990U, 10U);
+
+    EXPECT_EQ(encoder->m_bytes_used, 10U);
+    EXPECT_TRUE(sak::equal(encoder->m_symbol_storage,
+                           sak::storage(&data[990], 10U)));
 }
 
 
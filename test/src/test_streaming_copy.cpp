@@ -0,0 +1,100 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_streaming_copy.cpp Unit tests for the streaming_copy()
+///       function and the streaming_copy_symbols layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/streaming_copy.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Copies every combination of small offsets and sizes around the
+/// thresholds of the streaming loop
+TEST(TestStreamingCopy, copy)
+{
+    std::vector<uint8_t> src = random_vector(4096 + 64);
+
+    uint32_t sizes[] = { 0, 1, 63, 255, 256, 257, 1000, 4096 };
+
+    for(uint32_t size : sizes)
+    {
+        for(uint32_t src_offset = 0; src_offset < 3; ++src_offset)
+        {
+            for(uint32_t dest_offset = 0; dest_offset < 17; ++dest_offset)
+            {
+                std::vector<uint8_t> dest(4096 + 64, 'x');
+
+                kodo::streaming_copy(&dest[dest_offset], &src[src_offset],
+                                     size, dest_offset % 2 ? 0 : 512);
+
+                EXPECT_TRUE(std::equal(src.begin() + src_offset,
+                                       src.begin() + src_offset + size,
+                                       dest.begin() + dest_offset));
+
+                // Nothing around the destination is written
+                for(uint32_t i = 0; i < dest_offset; ++i)
+                    EXPECT_EQ('x', dest[i]);
+
+                for(uint32_t i = dest_offset + size; i < dest.size(); ++i)
+                    EXPECT_EQ('x', dest[i]);
+            }
+        }
+    }
+}
+
+/// Decodes a block and copies it out with the streaming copy
+TEST(TestStreamingCopy, streaming_full_rlnc_decoder)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::streaming_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+
+    EXPECT_TRUE(data_in == data_out);
+
+    // A partial block and a single symbol
+    uint32_t size = rand_nonzero(decoder->block_size());
+
+    std::vector<uint8_t> partial(size);
+    decoder->copy_symbols(sak::storage(partial));
+
+    EXPECT_TRUE(std::equal(partial.begin(), partial.end(),
+                           data_in.begin()));
+
+    uint32_t index = rand_nonzero(symbols) - 1;
+
+    std::vector<uint8_t> symbol(symbol_size);
+    decoder->copy_symbol(index, sak::storage(symbol));
+
+    EXPECT_TRUE(std::equal(symbol.begin(), symbol.end(),
+                           data_in.begin() + index * symbol_size));
+}
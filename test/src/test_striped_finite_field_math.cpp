@@ -0,0 +1,173 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_striped_finite_field_math.cpp Unit tests for the
+///       striped finite field layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/block_executor.hpp>
+#include <kodo/final_coder_factory.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/striped_finite_field_math.hpp>
+#include <kodo/storage_block_info.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace kodo
+{
+
+    /// Stack using the plain finite field layer
+    template<class Field>
+    class plain_math_stack
+        : public storage_block_info<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 plain_math_stack<Field>
+                     > > > >
+    { };
+
+    /// Stack using the striped finite field layer
+    template<class Field>
+    class striped_math_stack
+        : public storage_block_info<
+                 striped_finite_field_math<
+                     typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 striped_math_stack<Field>
+                     > > > >
+    { };
+
+}
+
+/// Compares the results of the striped layer with the plain
+/// finite_field_math layer for buffers of the given length
+template<class Field>
+void check_striped_math(kodo::block_executor &executor,
+                        uint32_t stripe_size, uint32_t length)
+{
+    typedef typename Field::value_type value_type;
+
+    uint32_t symbol_size = length * sizeof(value_type);
+
+    typename kodo::plain_math_stack<Field>::factory
+        plain_factory(4, symbol_size);
+    auto plain = plain_factory.build();
+
+    typename kodo::striped_math_stack<Field>::factory
+        striped_factory(4, symbol_size);
+
+    EXPECT_TRUE(striped_factory.stripe_executor() == 0);
+    EXPECT_EQ(65536U, striped_factory.stripe_size());
+
+    striped_factory.set_stripe_executor(&executor);
+    striped_factory.set_stripe_size(stripe_size);
+    auto striped = striped_factory.build();
+
+    uint32_t stripe_length = stripe_size / sizeof(value_type);
+    EXPECT_EQ(length >= 2 * stripe_length, striped->is_striped(length));
+
+    std::vector<value_type> src(length);
+    std::vector<value_type> src_two(length);
+    std::vector<value_type> expected(length);
+    std::vector<value_type> result(length);
+
+    for(uint32_t i = 0; i < length; ++i)
+    {
+        src[i] = rand() % (uint32_t(Field::max_value) + 1);
+        src_two[i] = rand() % (uint32_t(Field::max_value) + 1);
+        expected[i] = rand() % (uint32_t(Field::max_value) + 1);
+    }
+
+    value_type coefficient = static_cast<value_type>(
+        (rand() % Field::max_value) + 1);
+
+    value_type coefficient_two = static_cast<value_type>(
+        (rand() % Field::max_value) + 1);
+
+    result = expected;
+    plain->multiply_add(&expected[0], &src[0], coefficient, length);
+    striped->multiply_add(&result[0], &src[0], coefficient, length);
+    EXPECT_TRUE(expected == result);
+
+    plain->multiply_subtract(&expected[0], &src_two[0],
+                             coefficient_two, length);
+    striped->multiply_subtract(&result[0], &src_two[0],
+                               coefficient_two, length);
+    EXPECT_TRUE(expected == result);
+
+    plain->multiply(&expected[0], coefficient, length);
+    striped->multiply(&result[0], coefficient, length);
+    EXPECT_TRUE(expected == result);
+
+    plain->add(&expected[0], &src[0], length);
+    striped->add(&result[0], &src[0], length);
+    EXPECT_TRUE(expected == result);
+
+    plain->subtract(&expected[0], &src_two[0], length);
+    striped->subtract(&result[0], &src_two[0], length);
+    EXPECT_TRUE(expected == result);
+
+    const value_type *sources[] = { &src[0], &src_two[0] };
+    value_type coefficients[] = { coefficient, coefficient_two };
+
+    plain->multiply_add_sources(&expected[0], sources, coefficients,
+                                2, length);
+    striped->multiply_add_sources(&result[0], sources, coefficients,
+                                  2, length);
+    EXPECT_TRUE(expected == result);
+}
+
+template<class Field>
+void test_striped_math(kodo::block_executor &executor)
+{
+    // Below, at and above two stripes and with a partial last stripe
+    check_striped_math<Field>(executor, 256, 100);
+    check_striped_math<Field>(executor, 256, 512 / sizeof(
+        typename Field::value_type));
+    check_striped_math<Field>(executor, 256, 5000);
+
+    // Stripes smaller than a tile
+    check_striped_math<Field>(executor, 1024, 20000);
+
+    // Stripes of several tiles
+    check_striped_math<Field>(executor, 10000, 30001);
+}
+
+TEST(TestStripedFiniteFieldMath, stripes)
+{
+    kodo::block_executor executor(4);
+
+    test_striped_math<fifi::binary>(executor);
+    test_striped_math<fifi::binary8>(executor);
+    test_striped_math<fifi::binary16>(executor);
+}
+
+/// Tests that the layer falls back to the finite_field_math layer
+/// without an executor or with a single thread
+TEST(TestStripedFiniteFieldMath, fallback)
+{
+    typedef kodo::striped_math_stack<fifi::binary8> stack_type;
+
+    stack_type::factory factory(4, 1 << 20);
+    factory.set_stripe_size(1024);
+
+    auto stack = factory.build();
+    EXPECT_FALSE(stack->is_striped(1 << 20));
+
+    kodo::block_executor executor(1);
+    factory.set_stripe_executor(&executor);
+
+    stack = factory.build();
+    EXPECT_FALSE(stack->is_striped(1 << 20));
+}
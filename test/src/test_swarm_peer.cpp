@@ -0,0 +1,154 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_swarm_peer.cpp Unit tests for the swarm peer
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <kodo/swarm_peer.hpp>
+#include <kodo/interleaved_object_encoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::feedback_full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    typedef kodo::storage_reader<encoder_t> storage_reader;
+
+    typedef kodo::interleaved_object_encoder<storage_reader, encoder_t>
+        origin_t;
+
+    typedef kodo::swarm_peer<decoder_t> peer_t;
+}
+
+/// The origin sends every symbol to a single peer, the peers complete
+/// the object by exchanging recoded payloads
+TEST(TestSwarmPeer, cooperative_download)
+{
+    uint32_t symbols = 16;
+    uint32_t symbol_size = 64;
+    uint32_t object_size = 3 * symbols * symbol_size + 100;
+    uint32_t peers = 3;
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    origin_t origin(encoder_factory, storage_reader(sak::storage(data_in)));
+
+    std::vector<std::shared_ptr<peer_t> > swarm;
+
+    for(uint32_t i = 0; i < peers; ++i)
+    {
+        swarm.push_back(
+            std::make_shared<peer_t>(decoder_factory, object_size));
+    }
+
+    EXPECT_EQ(origin.blocks(), swarm[0]->blocks());
+    EXPECT_EQ(origin.id_size(), swarm[0]->id_size());
+
+    uint32_t total_symbols = 0;
+
+    for(uint32_t i = 0; i < origin.blocks(); ++i)
+    {
+        total_symbols += swarm[0]->decoder(i)->symbols();
+    }
+
+    std::vector<uint8_t> payload(
+        std::max(origin.payload_size(), swarm[0]->payload_size()));
+
+    // The systematic symbols are spread over the peers, so no peer
+    // can decode without the others
+    for(uint32_t i = 0; i < total_symbols; ++i)
+    {
+        origin.encode(&payload[0]);
+        swarm[i % peers]->decode(&payload[0]);
+    }
+
+    for(const auto& peer : swarm)
+    {
+        EXPECT_FALSE(peer->is_complete());
+    }
+
+    std::vector<uint8_t> feedback(swarm[0]->feedback_size());
+
+    // Every peer downloads from the neighbour with the most symbols
+    // it is missing
+    uint32_t rounds = 0;
+
+    while(rounds < 10 * total_symbols)
+    {
+        bool complete = true;
+
+        for(uint32_t i = 0; i < peers; ++i)
+        {
+            if(swarm[i]->is_complete())
+                continue;
+
+            complete = false;
+
+            swarm[i]->write_feedback(&feedback[0]);
+
+            uint32_t best = i;
+            uint32_t best_missing = 0;
+
+            for(uint32_t j = 0; j < peers; ++j)
+            {
+                if(j == i)
+                    continue;
+
+                uint32_t missing = swarm[j]->missing_symbols(&feedback[0]);
+
+                if(missing > best_missing)
+                {
+                    best = j;
+                    best_missing = missing;
+                }
+            }
+
+            ASSERT_NE(best, i);
+
+            uint32_t rank = swarm[i]->rank();
+
+            uint32_t used = swarm[best]->serve(&feedback[0], &payload[0]);
+            EXPECT_GT(used, 0U);
+            EXPECT_LE(used, swarm[best]->payload_size());
+
+            swarm[i]->decode(&payload[0]);
+            EXPECT_GE(swarm[i]->rank(), rank);
+        }
+
+        if(complete)
+            break;
+
+        ++rounds;
+    }
+
+    for(const auto& peer : swarm)
+    {
+        ASSERT_TRUE(peer->is_complete());
+
+        std::vector<uint8_t> data_out(object_size, '\0');
+        peer->copy_object(sak::storage(data_out));
+
+        EXPECT_TRUE(std::equal(data_out.begin(), data_out.end(),
+                               data_in.begin()));
+    }
+
+    // A complete peer has nothing to serve to another complete peer
+    swarm[0]->write_feedback(&feedback[0]);
+    EXPECT_EQ(0U, swarm[1]->missing_symbols(&feedback[0]));
+    EXPECT_EQ(0U, swarm[1]->available_symbols(&feedback[0]));
+    EXPECT_EQ(0U, swarm[1]->serve(&feedback[0], &payload[0]));
+}
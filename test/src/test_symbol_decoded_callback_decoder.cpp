@@ -0,0 +1,204 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_symbol_decoded_callback_decoder.cpp Unit test for the
+///       symbol_decoded_callback_decoder layer
+
+/// Tests:
+///   - layer::decode_symbol(uint8_t*,uint8_t*)
+///   - layer::decode_symbol(uint8_t*,uint32_t)
+///   - layer::is_symbol_decoded(uint32_t) const
+///   - layer::symbols_decoded() const
+///   - layer::decoded_prefix() const
+///   - layer::set_symbol_decoded_callback()
+///   - layer::reset_symbol_decoded_callback()
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+#include <fifi/fifi_utils.hpp>
+
+#include <kodo/symbol_decoded_callback_decoder.hpp>
+#include <kodo/linear_block_decoder.hpp>
+#include <kodo/coefficient_storage.hpp>
+#include <kodo/coefficient_info.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/deep_symbol_storage.hpp>
+#include <kodo/storage_bytes_used.hpp>
+#include <kodo/storage_block_info.hpp>
+#include <kodo/final_coder_factory_pool.hpp>
+
+/// Here we define the stacks which should be tested.
+namespace kodo
+{
+    template<class Field>
+    class symbol_decoded_callback_decoder_stack
+        : public // Codec API
+                 symbol_decoded_callback_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage api
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 symbol_decoded_callback_decoder_stack<Field>
+                     > > > > > > > > > >
+    {};
+}
+
+/// Collects the indices reported by the callback
+struct symbol_decoded_log
+{
+    void operator()(uint32_t index)
+    {
+        m_indices.push_back(index);
+    }
+
+    std::vector<uint32_t> m_indices;
+};
+
+/// Decodes a sequence of symbols where coded symbols become decoded
+/// before the decoder is complete. All coefficients are one, so the
+/// coded symbols are the xor of the original symbols in all fields.
+template<class Field>
+void test_symbol_decoded_callback(uint32_t symbol_size)
+{
+    typedef kodo::symbol_decoded_callback_decoder_stack<Field> decoder_type;
+    typedef typename Field::value_type value_type;
+
+    const uint32_t symbols = 4;
+
+    typename decoder_type::factory decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<std::vector<uint8_t> > data(symbols);
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        data[i].resize(symbol_size);
+        for(uint32_t j = 0; j < symbol_size; ++j)
+        {
+            data[i][j] = static_cast<uint8_t>(rand());
+        }
+    }
+
+    std::vector<uint8_t> coefficients(decoder->coefficients_size());
+    std::vector<uint8_t> symbol(symbol_size);
+
+    symbol_decoded_log log;
+    decoder->set_symbol_decoded_callback(std::ref(log));
+
+    EXPECT_EQ(decoder->symbols_decoded(), 0U);
+    EXPECT_EQ(decoder->decoded_prefix(), 0U);
+
+    // A coded symbol which only depends on symbol 0 is decoded at once
+    std::fill(coefficients.begin(), coefficients.end(), 0);
+    fifi::set_value<Field>(
+        reinterpret_cast<value_type*>(&coefficients[0]), 0, 1U);
+
+    symbol = data[0];
+    decoder->decode_symbol(&symbol[0], &coefficients[0]);
+
+    ASSERT_EQ(log.m_indices.size(), 1U);
+    EXPECT_EQ(log.m_indices[0], 0U);
+    EXPECT_TRUE(decoder->is_symbol_decoded(0));
+    EXPECT_EQ(decoder->symbols_decoded(), 1U);
+    EXPECT_EQ(decoder->decoded_prefix(), 1U);
+
+    // Uncoded symbol 2, the prefix stops at the missing symbol 1
+    symbol = data[2];
+    decoder->decode_symbol(&symbol[0], 2U);
+
+    ASSERT_EQ(log.m_indices.size(), 2U);
+    EXPECT_EQ(log.m_indices[1], 2U);
+    EXPECT_FALSE(decoder->is_symbol_decoded(1));
+    EXPECT_TRUE(decoder->is_symbol_decoded(2));
+    EXPECT_EQ(decoder->symbols_decoded(), 2U);
+    EXPECT_EQ(decoder->decoded_prefix(), 1U);
+
+    // Coded symbol 1 + 3 increases the rank but decodes nothing
+    std::fill(coefficients.begin(), coefficients.end(), 0);
+    fifi::set_value<Field>(
+        reinterpret_cast<value_type*>(&coefficients[0]), 1, 1U);
+    fifi::set_value<Field>(
+        reinterpret_cast<value_type*>(&coefficients[0]), 3, 1U);
+
+    for(uint32_t j = 0; j < symbol_size; ++j)
+    {
+        symbol[j] = data[1][j] ^ data[3][j];
+    }
+
+    decoder->decode_symbol(&symbol[0], &coefficients[0]);
+
+    EXPECT_EQ(decoder->rank(), 3U);
+    EXPECT_EQ(log.m_indices.size(), 2U);
+    EXPECT_EQ(decoder->symbols_decoded(), 2U);
+    EXPECT_EQ(decoder->decoded_prefix(), 1U);
+
+    // A linearly dependent symbol does not invoke the callback
+    symbol = data[2];
+    decoder->decode_symbol(&symbol[0], 2U);
+    EXPECT_EQ(log.m_indices.size(), 2U);
+
+    // Uncoded symbol 3 also decodes symbol 1
+    symbol = data[3];
+    decoder->decode_symbol(&symbol[0], 3U);
+
+    EXPECT_TRUE(decoder->is_complete());
+    ASSERT_EQ(log.m_indices.size(), 4U);
+    EXPECT_EQ(log.m_indices[2], 1U);
+    EXPECT_EQ(log.m_indices[3], 3U);
+    EXPECT_EQ(decoder->symbols_decoded(), symbols);
+    EXPECT_EQ(decoder->decoded_prefix(), symbols);
+
+    for(uint32_t i = 0; i < symbols; ++i)
+    {
+        EXPECT_TRUE(decoder->is_symbol_decoded(i));
+        EXPECT_TRUE(std::equal(data[i].begin(), data[i].end(),
+                               decoder->symbol(i)));
+    }
+
+    // A recycled decoder starts over without a callback
+    decoder.reset();
+    decoder = decoder_factory.build();
+
+    EXPECT_EQ(decoder->symbols_decoded(), 0U);
+    EXPECT_EQ(decoder->decoded_prefix(), 0U);
+    EXPECT_FALSE(decoder->is_symbol_decoded(0));
+
+    symbol = data[0];
+    decoder->decode_symbol(&symbol[0], 0U);
+    EXPECT_EQ(decoder->symbols_decoded(), 1U);
+    EXPECT_EQ(log.m_indices.size(), 4U);
+
+    decoder->set_symbol_decoded_callback(std::ref(log));
+    decoder->reset_symbol_decoded_callback();
+
+    symbol = data[1];
+    decoder->decode_symbol(&symbol[0], 1U);
+    EXPECT_EQ(decoder->decoded_prefix(), 2U);
+    EXPECT_EQ(log.m_indices.size(), 4U);
+}
+
+TEST(TestSymbolDecodedCallbackDecoder, test_symbol_decoded_callback)
+{
+    test_symbol_decoded_callback<fifi::binary>(10);
+    test_symbol_decoded_callback<fifi::binary8>(10);
+    test_symbol_decoded_callback<fifi::binary16>(10);
+}
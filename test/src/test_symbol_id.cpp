@@ -6,6 +6,8 @@
 /// @file test_symbol_id.cpp Unit tests for the Symbol ID API
 
 #include <cstdint>
+#include <algorithm>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -15,6 +17,9 @@
 #include <kodo/final_coder_factory_pool.hpp>
 #include <kodo/plain_symbol_id_reader.hpp>
 #include <kodo/plain_symbol_id_writer.hpp>
+#include <kodo/compact_symbol_id_reader.hpp>
+#include <kodo/compact_symbol_id_writer.hpp>
+#include <kodo/sparse_uniform_generator.hpp>
 #include <kodo/uniform_generator.hpp>
 #include <kodo/coefficient_storage.hpp>
 #include <kodo/coefficient_info.hpp>
@@ -45,6 +50,32 @@ namespace kodo
                      > > > > > > >
     { };
 
+    template<class Field>
+    class compact_uniform_stack
+        : public compact_symbol_id_reader<
+                 compact_symbol_id_writer<
+                 uniform_generator<
+                 coefficient_info<
+                 storage_block_info<
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 compact_uniform_stack<Field>
+                     > > > > > > >
+    { };
+
+    template<class Field>
+    class compact_sparse_stack
+        : public compact_symbol_id_reader<
+                 compact_symbol_id_writer<
+                 sparse_uniform_generator<
+                 coefficient_info<
+                 storage_block_info<
+                 finite_field_info<Field,
+                 final_coder_factory<
+                 compact_sparse_stack<Field>
+                     > > > > > > >
+    { };
+
     template<class Field>
     class rs_vandermond_nonsystematic_stack
         : public reed_solomon_symbol_id_reader<
@@ -175,3 +206,92 @@ TEST(TestSymbolId, test_rs_stack)
 
 }
 
+
+/// Run the tests for the compact symbol id stacks
+TEST(TestSymbolId, test_compact_stack)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    // API tests:
+    run_test<kodo::compact_uniform_stack, api_symbol_id>(
+        symbols, symbol_size);
+
+    run_test<kodo::compact_sparse_stack, api_symbol_id>(
+        symbols, symbol_size);
+}
+
+/// Writes a symbol id with one coder and reads it with another, and
+/// checks that the sparse format is chosen for sparse vectors
+template<class Field>
+void test_compact_symbol_id(uint32_t symbols, double density)
+{
+    typedef kodo::compact_sparse_stack<Field> stack_type;
+
+    typename stack_type::factory factory(symbols, 10);
+
+    auto writer = factory.build();
+    auto reader = factory.build();
+
+    writer->set_density(density);
+
+    EXPECT_EQ(factory.max_id_size(), writer->id_size());
+    EXPECT_EQ(1 + writer->coefficients_size(), writer->id_size());
+
+    std::vector<uint8_t> id(writer->id_size());
+
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        uint8_t *coefficients_out = 0;
+        uint8_t *coefficients_in = 0;
+
+        uint32_t bytes_used = writer->write_id(&id[0], &coefficients_out);
+        EXPECT_TRUE(bytes_used <= writer->id_size());
+
+        uint32_t nonzeros = 0;
+        for(uint32_t j = 0; j < symbols; ++j)
+        {
+            if(fifi::get_value<Field>(
+                   reinterpret_cast<typename Field::value_type*>(
+                       coefficients_out), j))
+            {
+                ++nonzeros;
+            }
+        }
+
+        uint32_t sparse_size = stack_type::sparse_id_size(nonzeros);
+        EXPECT_EQ(std::min(sparse_size, writer->id_size()), bytes_used);
+
+        // Data beyond the bytes used must not be read
+        std::vector<uint8_t> received(id.begin(), id.begin() + bytes_used);
+        received.resize(id.size(), 0xff);
+
+        reader->read_id(&received[0], &coefficients_in);
+
+        EXPECT_TRUE(coefficients_in != coefficients_out);
+
+        auto storage_out =
+            sak::storage(coefficients_out, writer->coefficients_size());
+
+        auto storage_in =
+            sak::storage(coefficients_in, reader->coefficients_size());
+
+        EXPECT_TRUE(sak::equal(storage_out, storage_in));
+    }
+}
+
+TEST(TestSymbolId, test_compact_format)
+{
+    // Sparse vectors
+    test_compact_symbol_id<fifi::binary>(512, 0.01);
+    test_compact_symbol_id<fifi::binary8>(512, 0.05);
+    test_compact_symbol_id<fifi::binary16>(512, 0.05);
+
+    // Dense vectors
+    test_compact_symbol_id<fifi::binary>(512, 0.5);
+    test_compact_symbol_id<fifi::binary8>(512, 1.0);
+    test_compact_symbol_id<fifi::binary16>(512, 1.0);
+
+    test_compact_symbol_id<fifi::binary8>(1, 1.0);
+    test_compact_symbol_id<fifi::binary8>(rand_symbols(), 0.2);
+}
@@ -6,6 +6,7 @@
 /// @file test_symbol_storage_xyz.cpp Unit tests for the symbol storage
 
 #include <cstdint>
+#include <algorithm>
 
 #include <gtest/gtest.h>
 
@@ -1539,6 +1540,73 @@ private:
 
 
 
+/// Tests that the symbols of a recycled coder are zero until set,
+/// also when the coder is reused with a different block layout
+template<class Coder>
+struct reuse_zeroed_symbols
+{
+
+    typedef typename Coder::factory factory_type;
+    typedef typename Coder::pointer pointer_type;
+
+    reuse_zeroed_symbols(uint32_t max_symbols, uint32_t max_symbol_size)
+        : m_factory(max_symbols, max_symbol_size)
+    { }
+
+    void run()
+    {
+        // Fill the entire buffer with data
+        pointer_type coder = m_factory.build();
+
+        auto data = random_vector(coder->block_size());
+        coder->set_symbols(sak::storage(data));
+
+        // Build with different from max values
+        uint32_t symbols =
+            rand_symbols(m_factory.max_symbols());
+        uint32_t symbol_size =
+            rand_symbol_size(m_factory.max_symbol_size());
+
+        m_factory.set_symbols(symbols);
+        m_factory.set_symbol_size(symbol_size);
+
+        coder = m_factory.build();
+
+        auto symbol = random_vector(coder->symbol_size());
+        uint32_t index = rand() % coder->symbols();
+
+        coder->set_symbol(index, sak::storage(symbol));
+
+        const pointer_type &const_coder = coder;
+
+        for(uint32_t i = 0; i < const_coder->symbols(); ++i)
+        {
+            const uint8_t *s = const_coder->symbol(i);
+
+            for(uint32_t j = 0; j < const_coder->symbol_size(); ++j)
+            {
+                uint8_t expected = i == index ? symbol[j] : 0;
+                EXPECT_EQ(expected, s[j]);
+            }
+        }
+
+        // A coder which only reads its symbols should also see zeros
+        coder = m_factory.build();
+
+        std::vector<uint8_t> data_out(coder->block_size(), 0xff);
+        coder->copy_symbols(sak::storage(data_out));
+
+        EXPECT_TRUE(std::all_of(data_out.begin(), data_out.end(),
+                                [](uint8_t v) { return v == 0; }));
+    }
+
+private:
+
+    // The factory
+    factory_type m_factory;
+
+};
+
 /// Helper function for running all the API and related tests
 /// which are compatible with the deep stack.
 template<template <class> class Stack>
@@ -1595,6 +1663,8 @@ void run_deep_stack_tests()
     // Other tests
     run_test<Stack, set_partial_data>(
         symbols, symbol_size);
+    run_test<Stack, reuse_zeroed_symbols>(
+        symbols, symbol_size);
 
 }
 
@@ -0,0 +1,135 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_telemetry_decoder.cpp Unit tests for the
+///       kodo::telemetry_decoder layer
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/telemetry_decoder.hpp>
+#include <kodo/linear_block_decoder.hpp>
+#include <kodo/coefficient_storage.hpp>
+#include <kodo/coefficient_info.hpp>
+#include <kodo/finite_field_counter.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/deep_symbol_storage.hpp>
+#include <kodo/storage_bytes_used.hpp>
+#include <kodo/storage_block_info.hpp>
+#include <kodo/final_coder_factory_pool.hpp>
+
+namespace kodo
+{
+
+    /// Decoder stack with the telemetry layer and the finite field
+    /// counter it reads the bytes from
+    template<class Field>
+    class telemetry_decoder_stack
+        : public // Codec API
+                 telemetry_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_counter<
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 telemetry_decoder_stack<Field>
+                     > > > > > > > > > > >
+    { };
+
+}
+
+/// Tests the counters for coded, non-innovative and swapped symbols
+TEST(TestTelemetryDecoder, counters)
+{
+    typedef kodo::telemetry_decoder_stack<fifi::binary8> decoder_t;
+
+    uint32_t symbols = 4;
+    uint32_t symbol_size = 8;
+
+    decoder_t::factory factory(symbols, symbol_size);
+    auto decoder = factory.build();
+
+    kodo::decoder_telemetry telemetry = decoder->telemetry();
+    EXPECT_EQ(0U, telemetry.m_received);
+    EXPECT_EQ(0U, telemetry.m_bytes);
+
+    std::vector<uint8_t> symbol(symbol_size, 'a');
+    std::vector<uint8_t> coefficients(decoder->coefficients_size(), 0);
+
+    // A coded symbol with the pivot at index 0
+    coefficients[0] = 1;
+    coefficients[1] = 2;
+    decoder->decode_symbol(&symbol[0], &coefficients[0]);
+
+    telemetry = decoder->telemetry();
+    EXPECT_EQ(1U, telemetry.m_received);
+    EXPECT_EQ(1U, telemetry.m_coded);
+    EXPECT_EQ(0U, telemetry.m_non_innovative);
+    EXPECT_EQ(0U, telemetry.m_non_innovative_bytes);
+
+    // The same symbol again is reduced to zero
+    std::fill(symbol.begin(), symbol.end(), 'a');
+    std::fill(coefficients.begin(), coefficients.end(), 0);
+    coefficients[0] = 1;
+    coefficients[1] = 2;
+    decoder->decode_symbol(&symbol[0], &coefficients[0]);
+
+    telemetry = decoder->telemetry();
+    EXPECT_EQ(2U, telemetry.m_received);
+    EXPECT_EQ(2U, telemetry.m_coded);
+    EXPECT_EQ(1U, telemetry.m_non_innovative);
+    EXPECT_TRUE(telemetry.m_non_innovative_bytes > 0);
+    EXPECT_TRUE(telemetry.m_bytes >= telemetry.m_non_innovative_bytes);
+
+    // A systematic symbol at the coded pivot is swapped in
+    std::fill(symbol.begin(), symbol.end(), 'b');
+    decoder->decode_symbol(&symbol[0], 0U);
+
+    telemetry = decoder->telemetry();
+    EXPECT_EQ(3U, telemetry.m_received);
+    EXPECT_EQ(1U, telemetry.m_systematic);
+    EXPECT_EQ(1U, telemetry.m_swap_decodes);
+    EXPECT_EQ(2U, decoder->rank());
+
+    // A duplicate systematic symbol costs nothing
+    uint64_t wasted = telemetry.m_non_innovative_bytes;
+    decoder->decode_symbol(&symbol[0], 0U);
+
+    telemetry = decoder->telemetry();
+    EXPECT_EQ(4U, telemetry.m_received);
+    EXPECT_EQ(2U, telemetry.m_systematic);
+    EXPECT_EQ(1U, telemetry.m_swap_decodes);
+    EXPECT_EQ(2U, telemetry.m_non_innovative);
+    EXPECT_EQ(wasted, telemetry.m_non_innovative_bytes);
+
+    // A new generation starts from zero
+    decoder = factory.build();
+
+    telemetry = decoder->telemetry();
+    EXPECT_EQ(0U, telemetry.m_received);
+    EXPECT_EQ(0U, telemetry.m_non_innovative);
+    EXPECT_EQ(0U, telemetry.m_swap_decodes);
+
+    decoder->decode_symbol(&symbol[0], 1U);
+    EXPECT_EQ(1U, decoder->telemetry().m_received);
+
+    decoder->reset_telemetry();
+    EXPECT_EQ(0U, decoder->telemetry().m_received);
+}
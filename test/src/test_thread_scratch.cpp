@@ -0,0 +1,118 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_thread_scratch.cpp Unit tests for the per-thread scratch
+///       buffers
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sak/is_aligned.hpp>
+
+#include <kodo/thread_scratch.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+namespace
+{
+    struct first_tag { };
+    struct second_tag { };
+}
+
+/// Checks that a buffer is reused on a thread and grows on demand
+TEST(TestThreadScratch, reuse_and_grow)
+{
+    typedef kodo::thread_scratch<first_tag> scratch_t;
+
+    uint8_t *small = scratch_t::data(10);
+    EXPECT_TRUE(sak::is_aligned(small));
+    EXPECT_GE(scratch_t::size(), 10U);
+
+    EXPECT_EQ(small, scratch_t::data(5));
+    EXPECT_EQ(small, scratch_t::data(10));
+
+    scratch_t::data(100000);
+    EXPECT_GE(scratch_t::size(), 100000U);
+
+    // The buffer is never shrunk
+    scratch_t::data(1);
+    EXPECT_GE(scratch_t::size(), 100000U);
+
+    EXPECT_EQ(reinterpret_cast<uint32_t*>(scratch_t::data(1)),
+              scratch_t::values<uint32_t>(1000));
+}
+
+/// Checks that the tags and threads have separate buffers
+TEST(TestThreadScratch, separate_buffers)
+{
+    uint8_t *first = kodo::thread_scratch<first_tag>::data(64);
+    uint8_t *second = kodo::thread_scratch<second_tag>::data(64);
+
+    EXPECT_NE(first, second);
+
+    uint8_t *other = 0;
+    std::thread thread([&other]()
+        {
+            other = kodo::thread_scratch<first_tag>::data(64);
+        });
+    thread.join();
+
+    EXPECT_NE(first, other);
+}
+
+/// Checks that coders sharing the scratch of a thread decode
+/// interleaved, including recoding
+TEST(TestThreadScratch, interleaved_coders)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    decoder_t::factory decoder_factory(symbols, symbol_size);
+
+    auto encoder = encoder_factory.build();
+    auto first = decoder_factory.build();
+    auto second = decoder_factory.build();
+
+    kodo::set_systematic_off(encoder);
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    std::vector<uint8_t> recoded(first->payload_size());
+
+    while(!second->is_complete())
+    {
+        encoder->encode(&payload[0]);
+
+        if(!first->is_complete())
+        {
+            first->decode(&payload[0]);
+        }
+
+        // The second decoder only receives recoded symbols
+        first->recode(&recoded[0]);
+        second->decode(&recoded[0]);
+    }
+
+    EXPECT_TRUE(first->is_complete());
+
+    std::vector<uint8_t> data_first(first->block_size());
+    std::vector<uint8_t> data_second(second->block_size());
+
+    first->copy_symbols(sak::storage(data_first));
+    second->copy_symbols(sak::storage(data_second));
+
+    EXPECT_TRUE(data_in == data_first);
+    EXPECT_TRUE(data_in == data_second);
+}
@@ -0,0 +1,150 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_trace_decoder.cpp Unit tests for the trace_decoder and
+///       the trace_ring
+
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fifi/default_field.hpp>
+
+#include <kodo/trace_decoder.hpp>
+#include <kodo/linear_block_decoder.hpp>
+#include <kodo/coefficient_storage.hpp>
+#include <kodo/coefficient_info.hpp>
+#include <kodo/finite_field_math.hpp>
+#include <kodo/finite_field_info.hpp>
+#include <kodo/deep_symbol_storage.hpp>
+#include <kodo/storage_bytes_used.hpp>
+#include <kodo/storage_block_info.hpp>
+#include <kodo/final_coder_factory_pool.hpp>
+
+namespace kodo
+{
+
+    /// Decoder stack recording trace events
+    template<class Field>
+    class trace_decoder_stack
+        : public // Codec API
+                 trace_decoder<
+                 linear_block_decoder<
+                 // Coefficient Storage API
+                 coefficient_storage<
+                 coefficient_info<
+                 // Storage API
+                 deep_symbol_storage<
+                 storage_bytes_used<
+                 storage_block_info<
+                 // Finite Field Math API
+                 finite_field_math<typename fifi::default_field<Field>::type,
+                 finite_field_info<Field,
+                 // Factory API
+                 final_coder_factory_pool<
+                 // Final type
+                 trace_decoder_stack<Field>
+                     > > > > > > > > > >
+    { };
+
+}
+
+/// Tests that a full ring drops events and that the events are drained
+/// in order
+TEST(TestTraceRing, record_and_drain)
+{
+    kodo::trace_ring ring(3);
+    EXPECT_EQ(4U, ring.capacity());
+
+    for(uint32_t i = 0; i < 6; ++i)
+    {
+        ring.record(kodo::trace_event_type::received, 7, i);
+    }
+
+    EXPECT_EQ(2U, ring.dropped());
+
+    std::vector<kodo::trace_event> events;
+    EXPECT_EQ(4U, ring.drain(events));
+    ASSERT_EQ(4U, events.size());
+
+    for(uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(7U, events[i].m_coder);
+        EXPECT_EQ(i, events[i].m_value);
+    }
+
+    EXPECT_LE(events[0].m_timestamp, events[3].m_timestamp);
+
+    // The drained events make room for new events
+    ring.record(kodo::trace_event_type::complete, 7, 4);
+    EXPECT_EQ(1U, ring.drain(events));
+    EXPECT_EQ(0U, ring.drain(events));
+}
+
+/// Tests the events recorded while decoding
+TEST(TestTraceDecoder, events)
+{
+    typedef kodo::trace_decoder_stack<fifi::binary8> decoder_type;
+
+    const uint32_t symbols = 3;
+    const uint32_t symbol_size = 8;
+
+    decoder_type::factory factory(symbols, symbol_size);
+    auto decoder = factory.build();
+    decoder->set_trace_id(42);
+
+    // Discard the events of other tests on this thread
+    std::vector<kodo::trace_event> events;
+    kodo::trace_collector::drain(events);
+    events.clear();
+
+    std::vector<uint8_t> data(symbol_size, 1);
+
+    std::vector<uint8_t> coefficients = {0, 1, 1};
+    decoder->decode_symbol(&data[0], &coefficients[0]);
+
+    coefficients = {0, 1, 1};
+    decoder->decode_symbol(&data[0], &coefficients[0]);
+
+    // The uncoded symbol replaces the coded symbol at pivot 1, which
+    // then finds pivot 2
+    decoder->decode_symbol(&data[0], 1U);
+    decoder->decode_symbol(&data[0], 0U);
+
+    kodo::trace_collector::drain(events);
+
+    typedef kodo::trace_event_type type;
+
+    std::vector<std::pair<type, uint32_t> > expected = {
+        {type::received, 0}, {type::pivot_found, 1},
+        {type::received, 1}, {type::non_innovative, 1},
+        {type::received, 1}, {type::swap_decode, 1}, {type::pivot_found, 2},
+        {type::received, 2}, {type::pivot_found, 0}, {type::complete, 3}};
+
+    ASSERT_EQ(expected.size(), events.size());
+
+    for(uint32_t i = 0; i < events.size(); ++i)
+    {
+        EXPECT_EQ(static_cast<uint8_t>(expected[i].first),
+                  events[i].m_type);
+        EXPECT_EQ(expected[i].second, events[i].m_value);
+        EXPECT_EQ(42U, events[i].m_coder);
+    }
+
+    // The events survive a trace file
+    std::stringstream file;
+    kodo::write_trace_header(file, 1.0, 0);
+    kodo::write_trace_events(file, events);
+
+    kodo::trace_file_header header;
+    std::vector<kodo::trace_event> read_events;
+
+    EXPECT_TRUE(kodo::read_trace(file, header, read_events));
+    EXPECT_EQ(1.0, header.m_ticks_per_ns);
+    ASSERT_EQ(events.size(), read_events.size());
+    EXPECT_EQ(events.back().m_timestamp, read_events.back().m_timestamp);
+}
@@ -0,0 +1,136 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_tunable_density_generator.cpp Unit tests for the
+///       generator raising the density with the receiver rank
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// Counts the payloads needed to decode a block
+template<class Encoder>
+uint32_t payloads_needed(Encoder &encoder, uint32_t symbols,
+                         uint32_t symbol_size)
+{
+    kodo::full_rlnc_decoder<fifi::binary>::factory
+        decoder_factory(symbols, symbol_size);
+    auto decoder = decoder_factory.build();
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+    uint32_t payloads = 0;
+
+    while(!decoder->is_complete())
+    {
+        encoder->encode(&payload[0]);
+        decoder->decode(&payload[0]);
+        ++payloads;
+    }
+
+    std::vector<uint8_t> data_out(decoder->block_size());
+    decoder->copy_symbols(sak::storage(data_out));
+    EXPECT_TRUE(data_in == data_out);
+
+    return payloads;
+}
+
+TEST(TestTunableDensityGenerator, density)
+{
+    uint32_t symbols = 64;
+
+    typedef kodo::tunable_sparse_full_rlnc_encoder<fifi::binary8>
+        encoder_type;
+
+    encoder_type::factory factory(symbols, 100);
+    auto encoder = factory.build();
+    kodo::set_systematic_off(encoder);
+
+    encoder->set_density(0.1);
+    encoder->set_target_nonzeros(4.0);
+    EXPECT_EQ(0.1, encoder->get_density());
+
+    std::vector<uint8_t> data_in = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data_in));
+
+    std::vector<uint8_t> payload(encoder->payload_size());
+
+    // The base density is used while many symbols are missing
+    encoder->encode(&payload[0]);
+    EXPECT_EQ(0.1, encoder->current_density());
+
+    double last = encoder->current_density();
+    for(uint32_t i = 1; i < symbols; ++i)
+    {
+        encoder->encode(&payload[0]);
+        EXPECT_GE(encoder->current_density(), last);
+        last = encoder->current_density();
+    }
+
+    // The last symbols are dense
+    EXPECT_EQ(encoder_type::max_density(), encoder->current_density());
+    EXPECT_EQ(double(symbols), encoder->receiver_rank());
+
+    // A reported rank replaces the estimate
+    encoder->set_receiver_rank(16);
+    EXPECT_EQ(16.0, encoder->receiver_rank());
+
+    encoder->set_erasure_rate(0.5);
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        encoder->encode(&payload[0]);
+    }
+    EXPECT_EQ(20.0, encoder->receiver_rank());
+    EXPECT_EQ(0.1, encoder->current_density());
+
+    // The estimate is reset when the encoder is built again
+    encoder = factory.build();
+    EXPECT_EQ(0.0, encoder->receiver_rank());
+}
+
+TEST(TestTunableDensityGenerator, overhead)
+{
+    uint32_t symbols = 64;
+    uint32_t symbol_size = 64;
+    double density = 0.02;
+
+    kodo::sparse_full_rlnc_encoder<fifi::binary>::factory
+        sparse_factory(symbols, symbol_size);
+    auto sparse = sparse_factory.build();
+    kodo::set_systematic_off(sparse);
+    sparse->set_density(density);
+
+    kodo::tunable_sparse_full_rlnc_encoder<fifi::binary>::factory
+        tunable_factory(symbols, symbol_size);
+    auto tunable = tunable_factory.build();
+    kodo::set_systematic_off(tunable);
+    tunable->set_density(density);
+
+    // With a fixed low density every symbol has to be combined at
+    // least once, which takes far more than the number of symbols
+    EXPECT_LT(payloads_needed(tunable, symbols, symbol_size),
+              payloads_needed(sparse, symbols, symbol_size));
+}
+
+TEST(TestTunableDensityGenerator, basic_api)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    invoke_basic_api<kodo::tunable_sparse_full_rlnc_encoder<fifi::binary>,
+                     kodo::full_rlnc_decoder<fifi::binary> >(
+                         symbols, symbol_size);
+
+    invoke_basic_api<kodo::tunable_sparse_full_rlnc_encoder<fifi::binary8>,
+                     kodo::sparse_full_rlnc_decoder<fifi::binary8> >(
+                         symbols, symbol_size);
+}
@@ -0,0 +1,220 @@
+// Copyright Steinwurf ApS 2011-2013.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+/// @file test_udp_transport.cpp Unit test for the udp_sender and
+///       udp_receiver
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <kodo/udp_transport.hpp>
+#include <kodo/object_encoder.hpp>
+#include <kodo/object_decoder.hpp>
+#include <kodo/storage_reader.hpp>
+#include <kodo/rfc5052_partitioning_scheme.hpp>
+#include <kodo/rlnc/full_vector_codes.hpp>
+
+#include "basic_api_test_helper.hpp"
+
+/// A pair of UDP sockets on the loopback interface, the sender is
+/// connected to the receiver
+struct udp_socket_pair
+{
+    udp_socket_pair()
+    {
+        m_receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+        m_sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+        EXPECT_TRUE(m_receiver >= 0);
+        EXPECT_TRUE(m_sender >= 0);
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+
+        EXPECT_EQ(0, ::bind(m_receiver, (sockaddr*) &address,
+                            sizeof(address)));
+
+        socklen_t length = sizeof(address);
+        EXPECT_EQ(0, ::getsockname(m_receiver, (sockaddr*) &address,
+                                   &length));
+
+        EXPECT_EQ(0, ::connect(m_sender, (sockaddr*) &address,
+                               sizeof(address)));
+
+        // Do not block forever if a datagram is lost
+        timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+
+        ::setsockopt(m_receiver, SOL_SOCKET, SO_RCVTIMEO,
+                     &timeout, sizeof(timeout));
+
+        int buffer_size = 4 * 1024 * 1024;
+        ::setsockopt(m_receiver, SOL_SOCKET, SO_RCVBUF,
+                     &buffer_size, sizeof(buffer_size));
+    }
+
+    ~udp_socket_pair()
+    {
+        ::close(m_receiver);
+        ::close(m_sender);
+    }
+
+    int m_receiver;
+    int m_sender;
+};
+
+/// Sends an object from an object encoder to an object decoder
+template<class Encoder, class Decoder>
+void test_udp_object(uint32_t max_symbols, uint32_t max_symbol_size,
+                     uint32_t object_size, bool segmentation)
+{
+    typedef kodo::storage_reader<Encoder> storage_reader;
+
+    typedef kodo::object_encoder<storage_reader, Encoder>
+        object_encoder;
+
+    typedef kodo::object_decoder<Decoder>
+        object_decoder;
+
+    typename Encoder::factory encoder_factory(
+        max_symbols, max_symbol_size);
+
+    typename Decoder::factory decoder_factory(
+        max_symbols, max_symbol_size);
+
+    std::vector<uint8_t> data_in = random_vector(object_size);
+    storage_reader reader(sak::storage(data_in));
+
+    object_encoder obj_encoder(encoder_factory, reader);
+    object_decoder obj_decoder(decoder_factory, object_size);
+
+    udp_socket_pair sockets;
+
+    kodo::udp_sender sender(
+        sockets.m_sender, encoder_factory.max_payload_size(), 16);
+
+    kodo::udp_receiver receiver(
+        sockets.m_receiver, decoder_factory.max_payload_size(), 16);
+
+    if(segmentation && !sender.set_segmentation(true))
+    {
+        // Segmentation offload is not supported by the kernel
+        return;
+    }
+
+    EXPECT_EQ(segmentation, sender.segmentation());
+
+    // The encoders are systematic, so a few extra payloads per block
+    // are enough without loss
+    uint32_t count = max_symbols + 2;
+    uint32_t blocks = obj_encoder.encoders();
+
+    EXPECT_EQ(blocks * count, sender.send_object(obj_encoder, count));
+
+    std::vector<typename Decoder::pointer> decoders;
+    uint32_t received = 0;
+
+    while(received < blocks * count)
+    {
+        uint32_t batch = receiver.receive(obj_decoder, decoders);
+
+        if(batch == 0)
+        {
+            break;
+        }
+
+        received += batch;
+    }
+
+    EXPECT_EQ(blocks * count, received);
+    ASSERT_EQ(blocks, decoders.size());
+
+    kodo::rfc5052_partitioning_scheme partitioning(
+        max_symbols, max_symbol_size, object_size);
+
+    std::vector<uint8_t> data_out(object_size);
+
+    for(uint32_t i = 0; i < blocks; ++i)
+    {
+        ASSERT_TRUE((bool) decoders[i]);
+        ASSERT_TRUE(decoders[i]->is_complete());
+
+        decoders[i]->copy_symbols(
+            sak::storage(&data_out[0] + partitioning.byte_offset(i),
+                         partitioning.bytes_used(i)));
+    }
+
+    EXPECT_TRUE(data_in == data_out);
+}
+
+TEST(TestUdpTransport, send_receive_object)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary8> encoder_t;
+    typedef kodo::full_rlnc_decoder<fifi::binary8> decoder_t;
+
+    test_udp_object<encoder_t, decoder_t>(16, 1400, 100000, false);
+    test_udp_object<encoder_t, decoder_t>(16, 1400, 100000, true);
+    test_udp_object<encoder_t, decoder_t>(8, 100, 1234, false);
+    test_udp_object<encoder_t, decoder_t>(8, 100, 1234, true);
+}
+
+TEST(TestUdpTransport, dispatch_block_id)
+{
+    typedef kodo::full_rlnc_encoder<fifi::binary> encoder_t;
+
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    encoder_t::factory encoder_factory(symbols, symbol_size);
+    auto encoder = encoder_factory.build();
+
+    std::vector<uint8_t> data = random_vector(encoder->block_size());
+    encoder->set_symbols(sak::storage(data));
+
+    udp_socket_pair sockets;
+
+    kodo::udp_sender sender(
+        sockets.m_sender, encoder_factory.max_payload_size());
+
+    kodo::udp_receiver receiver(
+        sockets.m_receiver, encoder_factory.max_payload_size());
+
+    EXPECT_EQ(3U, sender.send(encoder, 7, 3));
+
+    uint32_t received = 0;
+
+    while(received < 3)
+    {
+        uint32_t batch = receiver.receive(
+            [&](uint32_t block_id, uint8_t *payload, uint32_t size)
+            {
+                EXPECT_EQ(7U, block_id);
+                EXPECT_EQ(encoder->payload_size(), size);
+                EXPECT_TRUE(payload != 0);
+            });
+
+        if(batch == 0)
+        {
+            break;
+        }
+
+        received += batch;
+    }
+
+    EXPECT_EQ(3U, received);
+}
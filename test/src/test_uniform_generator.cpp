@@ -6,6 +6,8 @@
 /// @file coefficient_generator.hpp Unit tests for the uniform coefficient
 ///       generators
 
+#include <kodo/xorshift_uniform_generator.hpp>
+
 #include "coefficient_generator_helper.hpp"
 
 namespace kodo
@@ -38,6 +40,33 @@ namespace kodo
                > > > > > > >
     { };
 
+    // Xorshift uniform generator
+    template<class Field>
+    class xorshift_generator_stack :
+        public xorshift_uniform_generator<
+               fake_codec_layer<
+               coefficient_info<
+               fake_symbol_storage<
+               storage_block_info<
+               finite_field_info<Field,
+               final_coder_factory<
+               xorshift_generator_stack<Field>
+               > > > > > > >
+    { };
+
+    template<class Field>
+    class xorshift_generator_stack_pool :
+        public xorshift_uniform_generator<
+               fake_codec_layer<
+               coefficient_info<
+               fake_symbol_storage<
+               storage_block_info<
+               finite_field_info<Field,
+               final_coder_factory_pool<
+               xorshift_generator_stack_pool<Field>
+               > > > > > > >
+    { };
+
 }
 
 /// Run the tests typical coefficients stack
@@ -56,3 +85,99 @@ TEST(TestCoefficientGenerator, test_uniform_generator_stack)
         api_generate>(symbols, symbol_size);
 }
 
+/// Run the tests for the xorshift generator stack
+TEST(TestCoefficientGenerator, test_xorshift_generator_stack)
+{
+    uint32_t symbols = rand_symbols();
+    uint32_t symbol_size = rand_symbol_size();
+
+    // API tests:
+    run_test<
+        kodo::xorshift_generator_stack,
+        api_generate>(symbols, symbol_size);
+
+    run_test<
+        kodo::xorshift_generator_stack_pool,
+        api_generate>(symbols, symbol_size);
+}
+
+/// Tests that the coefficients generated from a seed do not change,
+/// since encoders and decoders depend on this mapping
+TEST(TestCoefficientGenerator, test_xorshift_generator_sequence)
+{
+    typedef kodo::xorshift_generator_stack<fifi::binary8> stack_type;
+
+    stack_type::factory factory(12, 100);
+    auto coder = factory.build();
+
+    ASSERT_EQ(12U, coder->coefficients_size());
+
+    std::vector<uint8_t> coefficients(coder->coefficients_size());
+
+    const uint8_t seed_zero[] =
+        { 0xd0, 0x82, 0x06, 0x55, 0x0d, 0xb4,
+          0xbc, 0x7b, 0xfd, 0xc9, 0x0c, 0xd0 };
+
+    coder->seed(0);
+    coder->generate(&coefficients[0]);
+    EXPECT_TRUE(std::equal(coefficients.begin(), coefficients.end(),
+                           seed_zero));
+
+    const uint8_t seed_forty_two[] =
+        { 0xa2, 0x97, 0xf6, 0xc4, 0xe7, 0xec,
+          0xb0, 0x31, 0x03, 0x6f, 0x68, 0xcb };
+
+    coder->seed(42);
+    coder->generate(&coefficients[0]);
+    EXPECT_TRUE(std::equal(coefficients.begin(), coefficients.end(),
+                           seed_forty_two));
+}
+
+/// Checks that the first vectors of a block are of the binary subfield
+template<class Coder>
+void test_subfield_vectors()
+{
+    typedef typename Coder::field_type field_type;
+    typedef typename Coder::value_type value_type;
+
+    typename Coder::factory factory(64, 100);
+    auto coder = factory.build();
+
+    EXPECT_EQ(0U, coder->subfield_vectors());
+    coder->set_subfield_vectors(3);
+    EXPECT_EQ(3U, coder->subfield_vectors());
+
+    std::vector<uint8_t> coefficients(coder->coefficients_size());
+    const value_type *c =
+        reinterpret_cast<const value_type*>(&coefficients[0]);
+
+    for(uint32_t block = 0; block < 2; ++block)
+    {
+        for(uint32_t j = 0; j < 4; ++j)
+        {
+            coder->generate(&coefficients[0]);
+
+            uint32_t full_field = 0;
+
+            for(uint32_t i = 0; i < coder->symbols(); ++i)
+            {
+                if(fifi::get_value<field_type>(c, i) > 1)
+                    ++full_field;
+            }
+
+            if(j < 3)
+                EXPECT_EQ(0U, full_field);
+            else
+                EXPECT_GT(full_field, 0U);
+        }
+
+        // The count starts over with the next block
+        coder->initialize(factory);
+    }
+}
+
+TEST(TestCoefficientGenerator, test_uniform_generator_subfield)
+{
+    test_subfield_vectors<kodo::uniform_generator_stack<fifi::binary8> >();
+    test_subfield_vectors<kodo::uniform_generator_stack<fifi::binary16> >();
+}